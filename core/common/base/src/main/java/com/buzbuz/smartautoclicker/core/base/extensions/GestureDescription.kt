@@ -40,6 +40,65 @@ fun GestureDescription.Builder.buildSingleStroke(path: Path, durationMs: Long, s
     return build()
 }
 
+/**
+ * Coalesces sequential strokes into a single multi-stroke [GestureDescription].
+ *
+ * Each stroke starts after the end of the previous one and its own delay, giving the whole sequence to the system in a
+ * single dispatch instead of waiting for the completion of each gesture before dispatching the next one.
+ *
+ * @param maxDurationMs the maximum duration of the batched gesture. As a dispatched gesture can't be interrupted by
+ * its caller, this bounds the time the sequence continues after its caller have been cancelled.
+ */
+class GestureSequenceBuilder(maxDurationMs: Long = MAXIMUM_STROKE_DURATION_MS) {
+
+    private val maxDurationMs: Long = min(maxDurationMs, GestureDescription.getMaxGestureDuration())
+    private val strokes: MutableList<GestureDescription.StrokeDescription> = mutableListOf()
+
+    /** The duration of the gesture built from the current strokes, from its dispatch to the end of its last stroke. */
+    var durationMs: Long = 0L
+        private set
+
+    /** The number of strokes in the current sequence. */
+    val strokeCount: Int
+        get() = strokes.size
+
+    /** Tells if a stroke of [durationMs] starting [delayMs] after the end of the previous one can be added. */
+    fun canAdd(durationMs: Long, delayMs: Long = 0L): Boolean =
+        strokes.size < GestureDescription.getMaxStrokeCount() &&
+                getStartTime(delayMs) + durationMs.toNormalizedStrokeDurationMs() <= maxDurationMs
+
+    /**
+     * Add a stroke at the end of the sequence. [canAdd] must be checked before.
+     *
+     * @param path the path of the stroke.
+     * @param durationMs the duration of the stroke.
+     * @param delayMs the delay between the end of the previous stroke and the start of this one.
+     */
+    fun add(path: Path, durationMs: Long, delayMs: Long = 0L) {
+        val startTime = getStartTime(delayMs)
+        val normalizedDurationMs = durationMs.toNormalizedStrokeDurationMs()
+
+        strokes.add(GestureDescription.StrokeDescription(path, startTime, normalizedDurationMs))
+        this.durationMs = startTime + normalizedDurationMs
+    }
+
+    /** Build the gesture from the current strokes and clear them for the next sequence. */
+    fun build(): GestureDescription {
+        val gesture = GestureDescription.Builder().apply { strokes.forEach(::addStroke) }.build()
+        clear()
+        return gesture
+    }
+
+    /** Clear the current strokes. */
+    fun clear() {
+        strokes.clear()
+        durationMs = 0L
+    }
+
+    private fun getStartTime(delayMs: Long): Long =
+        if (strokes.isEmpty()) 0L else durationMs + max(0, delayMs)
+}
+
 private fun Long.toNormalizedStrokeStartTime(): Long =
     max(0, this)
 
@@ -18,6 +18,7 @@ package com.buzbuz.smartautoclicker.core.bitmaps
 
 import android.graphics.Bitmap
 import com.buzbuz.smartautoclicker.core.base.Dumpable
+import java.io.File
 
 /** Manages the bitmaps for the application. */
 interface BitmapRepository : Dumpable {
@@ -45,6 +46,42 @@ interface BitmapRepository : Dumpable {
      */
     suspend fun getImageConditionBitmap(path: String, width: Int, height: Int) : Bitmap?
 
+    /**
+     * Load a bitmap without caching it.
+     * If it was already loaded, returns the value from the cache. If not, load it from the persistent memory without
+     * inserting it in the cache, for the bitmaps kept elsewhere once processed, such as the detection templates.
+     *
+     * @param path the path of the bitmap.
+     * @param width the width of the bitmap.
+     * @param height the height of the bitmap.
+     *
+     * @return the loaded bitmap, or null if the path is invalid
+     */
+    suspend fun loadImageConditionBitmap(path: String, width: Int, height: Int) : Bitmap?
+
+    /**
+     * Load the thumbnail of a bitmap, for the condition lists.
+     * The thumbnails are kept in their own memory cache, and on the disk once created: showing them never evicts the
+     * full size bitmaps from the cache, nor decodes them once their thumbnail exists. The bitmaps already small enough
+     * are their own thumbnail.
+     *
+     * @param path the path of the bitmap.
+     * @param width the width of the bitmap.
+     * @param height the height of the bitmap.
+     *
+     * @return the thumbnail, or null if the path is invalid
+     */
+    suspend fun getImageConditionThumbnail(path: String, width: Int, height: Int) : Bitmap?
+
+    /**
+     * Get the file of a bitmap, holding its raw ARGB_8888 pixels, for the native code reading it without any bitmap.
+     *
+     * @param path the path of the bitmap.
+     *
+     * @return the file of the bitmap, or null if the path is invalid
+     */
+    fun getImageConditionFile(path: String): File?
+
     /**
      * Get the bitmap for the display recorder
      *
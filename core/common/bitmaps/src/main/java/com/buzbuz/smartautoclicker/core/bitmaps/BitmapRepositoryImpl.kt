@@ -17,14 +17,18 @@
 package com.buzbuz.smartautoclicker.core.bitmaps
 
 import android.graphics.Bitmap
+import android.util.Size
 import com.buzbuz.smartautoclicker.core.base.addDumpTabulationLvl
 import kotlinx.coroutines.runBlocking
+import java.io.File
 import java.io.PrintWriter
 import javax.inject.Inject
 
 internal class BitmapRepositoryImpl @Inject constructor(
     private val bitmapLRUCache: BitmapLRUCache,
     private val conditionBitmapsDataSource: ConditionBitmapsDataSource,
+    private val thumbnailLRUCache: ThumbnailLRUCache,
+    private val conditionThumbnailsDataSource: ConditionThumbnailsDataSource,
 ) : BitmapRepository {
 
     override suspend fun saveImageConditionBitmap(bitmap: Bitmap, prefix: String): String {
@@ -38,6 +42,44 @@ internal class BitmapRepositoryImpl @Inject constructor(
             runBlocking { conditionBitmapsDataSource.loadBitmap(path, width, height) }
         }
 
+    override suspend fun loadImageConditionBitmap(path: String, width: Int, height: Int): Bitmap? =
+        bitmapLRUCache.get(path) ?: conditionBitmapsDataSource.loadBitmap(path, width, height)
+
+    override suspend fun getImageConditionThumbnail(path: String, width: Int, height: Int): Bitmap? {
+        val thumbnailSize = conditionThumbnailsDataSource.getThumbnailSize(width, height)
+        val thumbnailName = conditionThumbnailsDataSource.getThumbnailName(path, thumbnailSize)
+        thumbnailLRUCache.get(thumbnailName)?.let { return it }
+
+        val isOwnThumbnail = thumbnailSize.width == width && thumbnailSize.height == height
+        val thumbnail =
+            if (isOwnThumbnail) loadImageConditionBitmap(path, width, height)
+            else conditionThumbnailsDataSource.loadThumbnail(thumbnailName, thumbnailSize)
+                ?: createImageConditionThumbnail(path, width, height, thumbnailName, thumbnailSize)
+
+        return thumbnail?.also { thumbnailLRUCache.put(thumbnailName, it) }
+    }
+
+    /** Downscale a bitmap into its thumbnail, without caching the full size bitmap, and save it on the disk. */
+    private suspend fun createImageConditionThumbnail(
+        path: String,
+        width: Int,
+        height: Int,
+        thumbnailName: String,
+        thumbnailSize: Size,
+    ): Bitmap? {
+        val cachedBitmap = bitmapLRUCache.get(path)
+        val bitmap = cachedBitmap ?: conditionBitmapsDataSource.loadBitmap(path, width, height) ?: return null
+
+        val thumbnail = Bitmap.createScaledBitmap(bitmap, thumbnailSize.width, thumbnailSize.height, true)
+        if (cachedBitmap == null) bitmap.recycle()
+        conditionThumbnailsDataSource.saveThumbnail(thumbnailName, thumbnail)
+
+        return thumbnail
+    }
+
+    override fun getImageConditionFile(path: String): File? =
+        conditionBitmapsDataSource.getBitmapFile(path)
+
     override fun getDisplayRecorderBitmap(width: Int, height: Int): Bitmap =
         bitmapLRUCache.getOrDefault(getDisplayRecorderKey(width, height)) {
             Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888)
@@ -45,10 +87,16 @@ internal class BitmapRepositoryImpl @Inject constructor(
 
     override suspend fun deleteImageConditionBitmaps(paths: List<String>) {
         conditionBitmapsDataSource.deleteBitmaps(paths)
+
+        conditionThumbnailsDataSource.deleteThumbnails(paths)
+        thumbnailLRUCache.snapshot().keys
+            .filter { name -> paths.any { path -> conditionThumbnailsDataSource.isThumbnailOf(name, path) } }
+            .forEach(thumbnailLRUCache::remove)
     }
 
     override fun releaseCache() {
         bitmapLRUCache.evictAll()
+        thumbnailLRUCache.evictAll()
     }
 
     override fun dump(writer: PrintWriter, prefix: CharSequence) {
@@ -60,6 +108,10 @@ internal class BitmapRepositoryImpl @Inject constructor(
                 .append("- cacheSize=[${bitmapLRUCache.size()}/${bitmapLRUCache.maxSize()}]; ")
                 .append("hit/miss=[${bitmapLRUCache.hitCount()}/${bitmapLRUCache.missCount()}]; ")
                 .println()
+            append(contentPrefix)
+                .append("- thumbnailsCacheSize=[${thumbnailLRUCache.size()}/${thumbnailLRUCache.maxSize()}]; ")
+                .append("hit/miss=[${thumbnailLRUCache.hitCount()}/${thumbnailLRUCache.missCount()}]; ")
+                .println()
         }
     }
 
@@ -37,13 +37,25 @@ internal class ConditionBitmapsDataSource @Inject constructor(
     private val appDataDir: File,
 ) {
 
+    /**
+     * Save the pixels of a bitmap in a file named after their content: the conditions with the same pixels, such as the
+     * copied ones, share the same file. It is deleted once no condition in the database uses its path anymore.
+     *
+     * @return the path of the file.
+     */
     suspend fun saveBitmap(bitmap: Bitmap, prefix: String) : String {
         val uncompressedBuffer = ByteBuffer.allocateDirect(bitmap.byteCount)
         bitmap.copyPixelsToBuffer(uncompressedBuffer)
         uncompressedBuffer.position(0)
 
-        val path = "$prefix${uncompressedBuffer.hashCode()}"
-        val file = File(appDataDir, path)
+        // A file of another size can't have the same pixels, the next hash value is used instead of replacing it
+        var contentHash = ConditionContentHash().apply { update(uncompressedBuffer) }.getValue()
+        var file = File(appDataDir, getConditionFileName(contentHash, prefix))
+        while (file.exists() && file.length() != bitmap.byteCount.toLong()) {
+            file = File(appDataDir, getConditionFileName(++contentHash, prefix))
+        }
+
+        val path = file.name
         if (!file.exists()) {
             Log.d(TAG, "Saving $path")
 
@@ -84,6 +96,9 @@ internal class ConditionBitmapsDataSource @Inject constructor(
         }
     }
 
+    fun getBitmapFile(path: String): File? =
+        File(appDataDir, path).takeIf { it.exists() }
+
     suspend fun deleteBitmaps(paths: List<String>) {
         paths.forEach { path ->
             val file = File(appDataDir, path)
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.bitmaps
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/**
+ * Computes the hash of the pixels of a condition bitmap, naming its file: the conditions with the same pixels share
+ * the same file. The content can be provided in several parts, such as when it is streamed.
+ *
+ * This is the 64 bits FNV-1a hash of the content read as big endian 64 bits words, and of its remaining bytes.
+ * Wider than [ByteBuffer.hashCode], the different pixels of all the conditions of the application are unlikely to
+ * share a hash.
+ */
+class ConditionContentHash {
+
+    private var hash: Long = HASH_OFFSET_BASIS
+    /** The bytes of the word being read, not hashed yet. */
+    private var word: Long = 0
+    /** The number of bytes in [word]. */
+    private var wordLength: Int = 0
+
+    /** Hash the remaining bytes of a buffer, leaving its position and byte order unchanged. */
+    fun update(buffer: ByteBuffer) {
+        val start = buffer.position()
+        val order = buffer.order()
+
+        buffer.order(ByteOrder.BIG_ENDIAN)
+        while (wordLength != 0 && buffer.hasRemaining()) update(buffer.get())
+        repeat(buffer.remaining() / Long.SIZE_BYTES) { hash = (hash xor buffer.getLong()) * HASH_PRIME }
+        while (buffer.hasRemaining()) update(buffer.get())
+
+        buffer.order(order)
+        buffer.position(start)
+    }
+
+    /** Hash a part of an array. */
+    fun update(bytes: ByteArray, offset: Int = 0, length: Int = bytes.size) {
+        for (index in offset until offset + length) update(bytes[index])
+    }
+
+    /** @return the hash of all the bytes provided since the creation. */
+    fun getValue(): Long {
+        // The bytes of the last partial word are hashed one by one
+        var result = hash
+        for (byteIndex in wordLength - 1 downTo 0) {
+            result = (result xor (word shr (byteIndex * Byte.SIZE_BITS)).toByte().toLong()) * HASH_PRIME
+        }
+
+        return result
+    }
+
+    private fun update(byte: Byte) {
+        word = (word shl Byte.SIZE_BITS) or (byte.toLong() and 0xFF)
+        if (++wordLength < Long.SIZE_BYTES) return
+
+        hash = (hash xor word) * HASH_PRIME
+        word = 0
+        wordLength = 0
+    }
+}
+
+/** @return the name of the file of the condition pixels with this hash, see [ConditionContentHash]. */
+fun getConditionFileName(contentHash: Long, prefix: String = CONDITION_FILE_PREFIX): String =
+    "$prefix$contentHash"
+
+private const val HASH_OFFSET_BASIS = -0x340d631b7bdddcdbL
+private const val HASH_PRIME = 0x100000001b3L
@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.bitmaps
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.util.Log
+import android.util.Size
+
+import com.buzbuz.smartautoclicker.core.base.di.Dispatcher
+import com.buzbuz.smartautoclicker.core.base.di.HiltCoroutineDispatchers.IO
+
+import dagger.hilt.android.qualifiers.ApplicationContext
+
+import kotlinx.coroutines.CoroutineDispatcher
+import kotlinx.coroutines.withContext
+
+import java.io.File
+import java.io.FileInputStream
+import java.io.FileOutputStream
+import java.nio.ByteBuffer
+import javax.inject.Inject
+import kotlin.math.max
+import kotlin.math.roundToInt
+
+
+/**
+ * Keeps the downscaled versions of the condition bitmaps shown in the lists, in the application cache directory.
+ * They are stored as raw ARGB_8888 pixels like the condition files, named after the condition file and their size:
+ * the condition file being named after its content, a thumbnail is never outdated.
+ */
+internal class ConditionThumbnailsDataSource @Inject constructor(
+    @Dispatcher(IO) private val ioDispatcher: CoroutineDispatcher,
+    @ApplicationContext context: Context,
+) {
+
+    private val thumbnailsDir: File = File(context.cacheDir, THUMBNAILS_DIR_NAME)
+
+    /** @return the size of the thumbnail of a condition, the condition size if it is already small enough. */
+    fun getThumbnailSize(width: Int, height: Int): Size {
+        val longestSide = max(width, height)
+        if (longestSide <= THUMBNAIL_MAX_SIZE_PX) return Size(width, height)
+
+        val ratio = THUMBNAIL_MAX_SIZE_PX.toDouble() / longestSide
+        return Size(
+            (width * ratio).roundToInt().coerceAtLeast(1),
+            (height * ratio).roundToInt().coerceAtLeast(1),
+        )
+    }
+
+    /** @return the name of the thumbnail of a condition file, for this thumbnail size. */
+    fun getThumbnailName(path: String, size: Size): String =
+        "${path}_${size.width}x${size.height}"
+
+    suspend fun loadThumbnail(name: String, size: Size): Bitmap? = withContext(ioDispatcher) {
+        val file = File(thumbnailsDir, name)
+        if (!file.exists()) return@withContext null
+
+        // Partially written by a previous process, it is created again
+        if (file.length() != size.width * size.height * BYTES_PER_PIXEL.toLong()) {
+            Log.w(TAG, "Invalid thumbnail $name, deleting it")
+            file.delete()
+            return@withContext null
+        }
+
+        FileInputStream(file).use {
+            val buffer = ByteBuffer.allocateDirect(file.length().toInt())
+            it.channel.read(buffer)
+            buffer.position(0)
+
+            Bitmap.createBitmap(size.width, size.height, Bitmap.Config.ARGB_8888).apply {
+                copyPixelsFromBuffer(buffer)
+            }
+        }
+    }
+
+    suspend fun saveThumbnail(name: String, thumbnail: Bitmap) {
+        val buffer = ByteBuffer.allocateDirect(thumbnail.byteCount)
+        thumbnail.copyPixelsToBuffer(buffer)
+        buffer.position(0)
+
+        withContext(ioDispatcher) {
+            if (!thumbnailsDir.exists() && !thumbnailsDir.mkdirs()) {
+                Log.e(TAG, "Can't create thumbnails directory")
+                return@withContext
+            }
+
+            Log.d(TAG, "Saving thumbnail $name")
+            FileOutputStream(File(thumbnailsDir, name)).use {
+                it.channel.write(buffer)
+            }
+        }
+    }
+
+    /** Delete the thumbnails of all sizes of the condition files. */
+    suspend fun deleteThumbnails(paths: List<String>) {
+        if (paths.isEmpty()) return
+
+        withContext(ioDispatcher) {
+            thumbnailsDir.listFiles()?.forEach { file ->
+                if (paths.none { path -> isThumbnailOf(file.name, path) }) return@forEach
+
+                Log.d(TAG, "Deleting thumbnail ${file.name}")
+                file.delete()
+            }
+        }
+    }
+
+    /** @return true if the thumbnail with this name is one of the condition file. */
+    fun isThumbnailOf(name: String, path: String): Boolean =
+        name.startsWith("${path}_")
+}
+
+/** The size of the longest side of the condition thumbnails, in pixels. */
+private const val THUMBNAIL_MAX_SIZE_PX = 256
+/** The number of bytes of an ARGB_8888 pixel. */
+private const val BYTES_PER_PIXEL = 4
+/** The directory of the thumbnails, in the application cache directory. */
+private const val THUMBNAILS_DIR_NAME = "condition_thumbnails"
+private const val TAG = "ConditionThumbnailsDataSource"
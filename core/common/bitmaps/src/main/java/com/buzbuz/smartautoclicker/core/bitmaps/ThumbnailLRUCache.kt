@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.bitmaps
+
+import android.graphics.Bitmap
+import android.util.LruCache
+import javax.inject.Inject
+
+
+/**
+ * Cache for the condition thumbnails shown in the lists, with its own small memory budget: browsing the lists never
+ * evicts the full size bitmaps from the [BitmapLRUCache].
+ */
+internal class ThumbnailLRUCache @Inject constructor() : LruCache<String, Bitmap>(
+    ((Runtime.getRuntime().maxMemory() / 1024).toInt() * THUMBNAIL_CACHE_SIZE_RATIO).toInt()
+) {
+
+    override fun sizeOf(key: String, bitmap: Bitmap): Int {
+        // The cache size will be measured in kilobytes rather than number of items.
+        return bitmap.byteCount / 1024
+    }
+}
+
+/** The ratio of the total application size for the size of the thumbnail cache in the memory. */
+private const val THUMBNAIL_CACHE_SIZE_RATIO = 0.05
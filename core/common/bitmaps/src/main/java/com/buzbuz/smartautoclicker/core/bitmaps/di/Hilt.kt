@@ -21,6 +21,8 @@ import com.buzbuz.smartautoclicker.core.bitmaps.BitmapLRUCache
 import com.buzbuz.smartautoclicker.core.bitmaps.BitmapRepository
 import com.buzbuz.smartautoclicker.core.bitmaps.BitmapRepositoryImpl
 import com.buzbuz.smartautoclicker.core.bitmaps.ConditionBitmapsDataSource
+import com.buzbuz.smartautoclicker.core.bitmaps.ConditionThumbnailsDataSource
+import com.buzbuz.smartautoclicker.core.bitmaps.ThumbnailLRUCache
 
 import dagger.Module
 import dagger.Provides
@@ -45,5 +47,12 @@ object BitmapsHiltModule {
     internal fun providesBitmapRepository(
         bitmapLRUCache: BitmapLRUCache,
         conditionBitmapsDataSource: ConditionBitmapsDataSource,
-    ): BitmapRepository = BitmapRepositoryImpl(bitmapLRUCache, conditionBitmapsDataSource)
+        thumbnailLRUCache: ThumbnailLRUCache,
+        conditionThumbnailsDataSource: ConditionThumbnailsDataSource,
+    ): BitmapRepository = BitmapRepositoryImpl(
+        bitmapLRUCache,
+        conditionBitmapsDataSource,
+        thumbnailLRUCache,
+        conditionThumbnailsDataSource,
+    )
 }
\ No newline at end of file
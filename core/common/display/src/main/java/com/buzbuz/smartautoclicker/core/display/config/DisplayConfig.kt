@@ -17,6 +17,7 @@
 package com.buzbuz.smartautoclicker.core.display.config
 
 import android.graphics.Point
+import android.graphics.Rect
 import android.os.Build
 import android.view.RoundedCorner
 import androidx.annotation.RequiresApi
@@ -26,6 +27,8 @@ data class DisplayConfig(
     val sizePx: Point,
     val orientation: Int,
     val safeInsetTopPx: Int,
+    /** The distance of the system bars and display cutout to each edge of the display. */
+    val systemInsetsPx: Rect,
     val roundedCorners: Map<Corner, DisplayRoundedCorner?>,
 )
 
@@ -29,6 +29,7 @@ internal fun PrintWriter.append(prefix: CharSequence, displayConfig: DisplayConf
     append(contentPrefix).append("Size (Px): ").append(displayConfig.sizePx.toString()).println()
     append(contentPrefix).append("Orientation: ").append(displayConfig.orientation.toOrientationString()).println()
     append(contentPrefix).append("Safe inset top (Px): ").append(displayConfig.safeInsetTopPx.toString()).println()
+    append(contentPrefix).append("System insets (Px): ").append(displayConfig.systemInsetsPx.toShortString()).println()
     displayConfig.roundedCorners.entries.forEach { (corner, roundedCorner) ->
         roundedCorner?.let { append(contentPrefix).append(corner, roundedCorner).println() }
     }
@@ -23,10 +23,12 @@ import android.content.Intent
 import android.content.IntentFilter
 import android.content.res.Configuration
 import android.graphics.Point
+import android.graphics.Rect
 import android.hardware.display.DisplayManager
 import android.os.Build
 import android.util.Log
 import android.view.Surface
+import android.view.WindowInsets
 import android.view.WindowManager
 
 import com.buzbuz.smartautoclicker.core.base.Dumpable
@@ -125,6 +127,7 @@ class DisplayConfigManager @Inject constructor(
             sizePx = getCurrentDisplaySize(),
             orientation = getCurrentDisplayOrientation(),
             safeInsetTopPx = getCurrentDisplaySafeInsetTop(),
+            systemInsetsPx = getCurrentDisplaySystemInsets(),
             roundedCorners = buildMap {
                 put(Corner.TOP_LEFT, getCurrentDisplayRoundedCorner(Corner.TOP_LEFT))
                 put(Corner.TOP_RIGHT, getCurrentDisplayRoundedCorner(Corner.TOP_RIGHT))
@@ -154,6 +157,21 @@ class DisplayConfigManager @Inject constructor(
     private fun getCurrentDisplaySafeInsetTop(): Int =
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) display.cutout?.safeInsetTop ?: 0 else 0
 
+    /**
+     * @return the insets of the system bars and display cutout, even when the bars are hidden: the detection areas
+     * must not change each time an application shows or hides them. Only the cutout is known before Android R.
+     */
+    private fun getCurrentDisplaySystemInsets(): Rect =
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.R) {
+            windowManager.currentWindowMetrics.windowInsets
+                .getInsetsIgnoringVisibility(WindowInsets.Type.systemBars() or WindowInsets.Type.displayCutout())
+                .let { insets -> Rect(insets.left, insets.top, insets.right, insets.bottom) }
+        } else if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            display.cutout?.let { cutout ->
+                Rect(cutout.safeInsetLeft, cutout.safeInsetTop, cutout.safeInsetRight, cutout.safeInsetBottom)
+            } ?: Rect()
+        } else Rect()
+
     /** @return the rounded corner of the given position. Returns null if there is none. */
     private fun getCurrentDisplayRoundedCorner(corner: Corner): DisplayRoundedCorner? =
         if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.S) {
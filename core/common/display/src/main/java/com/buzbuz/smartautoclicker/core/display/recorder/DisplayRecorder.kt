@@ -26,10 +26,12 @@ import android.media.ImageReader
 import android.media.projection.MediaProjection
 import android.media.projection.MediaProjectionManager
 import android.util.Log
+import android.view.Surface
 import androidx.annotation.MainThread
 import androidx.annotation.WorkerThread
 
 import kotlinx.coroutines.sync.Mutex
+import kotlinx.coroutines.withTimeoutOrNull
 import kotlinx.coroutines.sync.withLock
 import javax.inject.Inject
 import javax.inject.Singleton
@@ -62,6 +64,16 @@ class DisplayRecorder @Inject internal constructor(
     private var virtualDisplay: VirtualDisplay? = null
     /** Listener to notify upon projection ends. */
     private var stopListener: (() -> Unit)? = null
+    /** Tells if the frames are relayed to the image reader only when they change, see [GpuFrameGate]. */
+    private var isGpuFrameGateEnabled: Boolean = false
+    /** Relays the changing frames of the [virtualDisplay] to the image reader, null if disabled. */
+    private var gpuFrameGate: GpuFrameGate? = null
+    /** Tells if a reader is kept ready for the other orientation, making the resize on rotation a swap. */
+    private var isRotatedReaderEnabled: Boolean = false
+    /** The surface of the consumer of the frames rendered instead of the image reader, null if none. */
+    private var consumerSurface: Surface? = null
+    /** Tells if the screen record is paused with [setScreenRecordPaused]. */
+    private var isPaused: Boolean = false
 
     /**
      * Start the media projection.
@@ -104,8 +116,17 @@ class DisplayRecorder @Inject internal constructor(
      *
      * @param context the Android context.
      * @param displaySize the size of the display, in pixels.
+     * @param gpuFrameGateEnabled true to compare the frames on the GPU, and only provide the ones with a changing
+     *                            content, see [GpuFrameGate].
+     * @param rotatedReaderEnabled true to keep the images reader of the other orientation, at the cost of its buffers,
+     *                             for the display to be rendered again right after a rotation.
      */
-    suspend fun startScreenRecord(context: Context, displaySize: Point): Unit = mutex.withLock {
+    suspend fun startScreenRecord(
+        context: Context,
+        displaySize: Point,
+        gpuFrameGateEnabled: Boolean = false,
+        rotatedReaderEnabled: Boolean = false,
+    ): Unit = mutex.withLock {
         if (!mediaProjectionProxy.isMediaProjectionStarted() || virtualDisplay != null) {
             Log.w(TAG, "Attempting to start screen record while already started.")
             return
@@ -113,42 +134,116 @@ class DisplayRecorder @Inject internal constructor(
 
         Log.d(TAG, "Start screen record with display size $displaySize")
 
-        imageReaderProxy.resize(displaySize)
+        isGpuFrameGateEnabled = gpuFrameGateEnabled
+        isRotatedReaderEnabled = rotatedReaderEnabled
+        imageReaderProxy.resize(displaySize, prepareRotated = isRotatedReaderEnabled)
         virtualDisplay = mediaProjectionProxy.createVirtualDisplay(
             displaySize = displaySize,
             densityDpi = context.resources.configuration.densityDpi,
-            surface = imageReaderProxy.surface,
+            surface = newRecordSurface(displaySize),
         )
     }
 
-    suspend fun resizeDisplay(context: Context, displaySize: Point): Unit = mutex.withLock {
+    /**
+     * Resize the screen record.
+     * The screen can be captured downscaled, it is then rendered by the compositor at the capture size, and the frames
+     * are smaller than the screen.
+     *
+     * @param context the Android context.
+     * @param displaySize the size of the display, in pixels.
+     * @param captureSize the size of the captured frames, in pixels. Lower or equal to the display size, with the same
+     *                    aspect ratio.
+     */
+    suspend fun resizeDisplay(context: Context, displaySize: Point, captureSize: Point = displaySize): Unit =
+        mutex.withLock {
+            val vDisplay = virtualDisplay ?: return
+
+            Log.d(TAG, "Resizing virtual display to $captureSize for display size $displaySize")
+
+            // The previous frame gate can only be released once the display no longer renders into it. The consumer
+            // frames would have the previous size.
+            vDisplay.surface = null
+            consumerSurface = null
+            isPaused = false
+            releaseGpuFrameGate()
+            imageReaderProxy.resize(captureSize, displaySize, isRotatedReaderEnabled)
+            vDisplay.surface = newRecordSurface(captureSize)
+            vDisplay.resize(
+                captureSize.x,
+                captureSize.y,
+                context.resources.configuration.densityDpi,
+            )
+        }
+
+    /**
+     * Pause or resume the screen record, without releasing it.
+     * While paused, the virtual display has no surface and the compositor doesn't render any frame for it.
+     *
+     * @param paused true to pause the screen record, false to resume it.
+     */
+    suspend fun setScreenRecordPaused(paused: Boolean): Unit = mutex.withLock {
         val vDisplay = virtualDisplay ?: return
 
-        Log.d(TAG, "Resizing virtual display to $displaySize")
+        Log.d(TAG, "Screen record paused=$paused")
+        isPaused = paused
+        vDisplay.surface = getRecordSurface()
+    }
 
-        imageReaderProxy.resize(displaySize)
-        vDisplay.surface = imageReaderProxy.surface
-        vDisplay.resize(
-            displaySize.x,
-            displaySize.y,
-            context.resources.configuration.densityDpi,
-        )
+    /**
+     * Render the screen record into the surface of another consumer of the frames, such as a native image reader,
+     * instead of the image reader of this recorder. The [GpuFrameGate] is bypassed, and the frames and screenshots of
+     * this recorder are not updated until the consumer is removed. It is also removed when the display is resized.
+     *
+     * @param surface the surface of the consumer, with the size of the captured frames. Null to remove it.
+     */
+    suspend fun setFrameConsumerSurface(surface: Surface?): Unit = mutex.withLock {
+        val vDisplay = virtualDisplay ?: return
+        if (surface === consumerSurface) return
+
+        Log.d(TAG, "Frame consumer surface ${if (surface != null) "set" else "removed"}")
+        consumerSurface = surface
+        vDisplay.surface = getRecordSurface()
     }
 
-    /** @return the last image of the screen, or null if they have been processed. */
-    suspend fun acquireLatestBitmap(): Bitmap? = mutex.withLock {
-        imageReaderProxy.getLastFrame()
+    /**
+     * Suspend until the screen content changes, or until the timeout expires. Returns immediately if a new frame was
+     * rendered since the last call to [acquireLatestScreenFrame].
+     * Not synchronized with the other calls, the display can be resized or stopped while waiting.
+     *
+     * @param timeoutMs the maximum time to wait, in milliseconds.
+     *
+     * @return true if a new frame is available, false if the timeout expired.
+     */
+    suspend fun awaitNewScreenFrame(timeoutMs: Long): Boolean =
+        withTimeoutOrNull(timeoutMs) { imageReaderProxy.awaitNewFrame() } != null
+
+    /** @return the statistics of the arrival of the frames since the screen record was started or resized. */
+    fun getFrameArrivalStats(): FrameArrivalStats =
+        imageReaderProxy.getFrameArrivalStats()
+
+    /**
+     * @return the last frame of the screen, without copy of its content. It is valid until the second next call to
+     *         this method returning a new frame, or until the screen record is stopped.
+     */
+    suspend fun acquireLatestScreenFrame(): ScreenFrame? = mutex.withLock {
+        imageReaderProxy.getLastScreenFrame()
     }
 
+    /**
+     * Take a screenshot of the screen, waiting for the first frame if none has been rendered yet.
+     * The screenshot is a copy of the frame, it is not reused once the completion returns.
+     *
+     * @param completion called with the screenshot.
+     */
     suspend fun takeScreenshot(completion: suspend (Bitmap) -> Unit) {
-        var finished = false
-        do {
-            imageReaderProxy.getLastFrame()?.let { screenFrame ->
-                completion(screenFrame)
-                finished = true
+        while (true) {
+            mutex.withLock { imageReaderProxy.getLastFrame() }?.let { screenshot ->
+                completion(screenshot)
+                return
             }
 
-        } while (!finished)
+            imageReaderProxy.awaitNewFrame()
+        }
     }
 
     /**
@@ -162,9 +257,31 @@ class DisplayRecorder @Inject internal constructor(
             release()
             virtualDisplay = null
         }
+        consumerSurface = null
+        isPaused = false
+        releaseGpuFrameGate()
         imageReaderProxy.close()
     }
 
+    /**
+     * Get the surface the virtual display renders into, in front of the current image reader.
+     * @param size the size of the frames, in pixels.
+     */
+    private fun newRecordSurface(size: Point): Surface {
+        gpuFrameGate = if (isGpuFrameGateEnabled) GpuFrameGate(imageReaderProxy.surface, size) else null
+
+        return gpuFrameGate?.inputSurface ?: imageReaderProxy.surface
+    }
+
+    /** @return the surface the virtual display must currently render into, null while paused. */
+    private fun getRecordSurface(): Surface? =
+        if (isPaused) null else consumerSurface ?: gpuFrameGate?.inputSurface ?: imageReaderProxy.surface
+
+    private fun releaseGpuFrameGate() {
+        gpuFrameGate?.release()
+        gpuFrameGate = null
+    }
+
     /**
      * Stop the media projection previously started with [startProjection].
      *
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.display.recorder
+
+/**
+ * Statistics of the arrival of the frames in the ImageReader, measured when they are available, before being
+ * acquired. The intervals are the delays between two consecutive frames.
+ *
+ * @param frameCount the number of frames received since the screen record was started or resized.
+ * @param meanIntervalMs the mean interval between two frames, in milliseconds. 0 until two frames are received.
+ * @param maxIntervalMs the longest interval between two frames, in milliseconds. 0 until two frames are received.
+ * @param meanAcquireLatencyMs the mean delay between the arrival of the frames and their acquisition, in milliseconds.
+ * @param readerDepth the maximum number of images of the ImageReader.
+ * @param readerUsage the HardwareBuffer usage flags of the ImageReader images, 0 if they are the default ones.
+ */
+data class FrameArrivalStats(
+    val frameCount: Long,
+    val meanIntervalMs: Double,
+    val maxIntervalMs: Double,
+    val meanAcquireLatencyMs: Double = 0.0,
+    val readerDepth: Int = 0,
+    val readerUsage: Long = 0,
+)
@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.display.recorder
+
+import android.graphics.Point
+import android.graphics.SurfaceTexture
+import android.opengl.EGL14
+import android.opengl.EGLConfig
+import android.opengl.EGLContext
+import android.opengl.EGLDisplay
+import android.opengl.EGLExt
+import android.opengl.EGLSurface
+import android.opengl.GLES11Ext
+import android.opengl.GLES20
+import android.opengl.Matrix
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.SystemClock
+import android.util.Log
+import android.view.Surface
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import java.nio.FloatBuffer
+import java.util.concurrent.CountDownLatch
+
+/**
+ * Relays the frames of the virtual display to the [ImageReaderProxy] only when their content changes.
+ *
+ * The virtual display renders into the [inputSurface], backed by a GL texture. For each frame, a low resolution
+ * signature is computed on the GPU by halving the frame until it is smaller than [SIGNATURE_MAX_SIZE], each pass
+ * averaging 2x2 pixels with the linear filtering, and only this signature is read back. The full frame is drawn into
+ * the output surface only if its signature is different from the one of the last relayed frame, or if none have been
+ * relayed since [FORCED_FRAME_INTERVAL_MS], bounding the time a change too small for the signature is missed.
+ *
+ * The frames dropped this way never reach the image reader: they are neither copied nor read by the CPU.
+ *
+ * @param outputSurface the surface of the image reader receiving the relayed frames.
+ * @param size the size of the frames, in pixels.
+ */
+internal class GpuFrameGate(outputSurface: Surface, private val size: Point) {
+
+    /** Thread owning the GL context, receiving the frames of the virtual display. */
+    private val glThread = HandlerThread(GL_THREAD_NAME).apply { start() }
+    private val glHandler = Handler(glThread.looper)
+
+    private var eglDisplay: EGLDisplay = EGL14.EGL_NO_DISPLAY
+    private var eglContext: EGLContext = EGL14.EGL_NO_CONTEXT
+    private var outputEglSurface: EGLSurface = EGL14.EGL_NO_SURFACE
+
+    /** The texture the virtual display renders into. */
+    private var inputTextureId: Int = 0
+    private lateinit var inputSurfaceTexture: SurfaceTexture
+    /** The surface to give to the virtual display. */
+    lateinit var inputSurface: Surface
+        private set
+
+    private var externalProgram: Int = 0
+    private var texture2dProgram: Int = 0
+    private val vertices: FloatBuffer = ByteBuffer.allocateDirect(QUAD_VERTICES.size * Float.SIZE_BYTES)
+        .order(ByteOrder.nativeOrder()).asFloatBuffer().apply { put(QUAD_VERTICES).position(0) }
+    private val inputTextureMatrix: FloatArray = FloatArray(16)
+    private val identityMatrix: FloatArray = FloatArray(16).apply { Matrix.setIdentityM(this, 0) }
+
+    /** The sizes of the halving passes, the last one being the size of the signature. */
+    private val levelSizes: List<Point> = getLevelSizes(size)
+    private val levelTextureIds: IntArray = IntArray(levelSizes.size)
+    private val levelFramebufferIds: IntArray = IntArray(levelSizes.size)
+
+    /** The signature of the current frame, read back from the last level. */
+    private val signature: ByteBuffer =
+        ByteBuffer.allocateDirect(levelSizes.last().x * levelSizes.last().y * 4).order(ByteOrder.nativeOrder())
+    /** The signature of the last relayed frame. */
+    private val relayedSignature: ByteArray = ByteArray(signature.capacity())
+    private val currentSignature: ByteArray = ByteArray(signature.capacity())
+    /** The time the last frame was relayed, in milliseconds of [SystemClock.elapsedRealtime]. 0 if none was. */
+    private var lastRelayTimeMs: Long = 0
+
+    /** The number of frames drawn into the output surface. */
+    @Volatile private var relayedFrameCount: Long = 0
+    /** The number of frames dropped because their signature was unchanged. */
+    @Volatile private var droppedFrameCount: Long = 0
+
+    init {
+        val setupLatch = CountDownLatch(1)
+        glHandler.post {
+            setupEgl(outputSurface)
+            setupInput()
+            setupPrograms()
+            setupLevels()
+            setupLatch.countDown()
+        }
+        setupLatch.await()
+    }
+
+    /** Release all GL resources. The [inputSurface] must no longer be used by the virtual display. */
+    fun release() {
+        Log.d(TAG, "Releasing, relayed=$relayedFrameCount; dropped=$droppedFrameCount")
+
+        glHandler.post {
+            inputSurfaceTexture.setOnFrameAvailableListener(null)
+            GLES20.glDeleteFramebuffers(levelFramebufferIds.size, levelFramebufferIds, 0)
+            GLES20.glDeleteTextures(levelTextureIds.size, levelTextureIds, 0)
+            GLES20.glDeleteTextures(1, intArrayOf(inputTextureId), 0)
+            GLES20.glDeleteProgram(externalProgram)
+            GLES20.glDeleteProgram(texture2dProgram)
+            inputSurface.release()
+            inputSurfaceTexture.release()
+
+            EGL14.eglMakeCurrent(eglDisplay, EGL14.EGL_NO_SURFACE, EGL14.EGL_NO_SURFACE, EGL14.EGL_NO_CONTEXT)
+            EGL14.eglDestroySurface(eglDisplay, outputEglSurface)
+            EGL14.eglDestroyContext(eglDisplay, eglContext)
+            EGL14.eglReleaseThread()
+        }
+        glThread.quitSafely()
+    }
+
+    /** Called on the [glThread] for each frame rendered by the virtual display. */
+    private fun onInputFrameAvailable() {
+        inputSurfaceTexture.updateTexImage()
+        inputSurfaceTexture.getTransformMatrix(inputTextureMatrix)
+
+        val nowMs = SystemClock.elapsedRealtime()
+        if (!updateSignature() && lastRelayTimeMs != 0L && nowMs - lastRelayTimeMs < FORCED_FRAME_INTERVAL_MS) {
+            droppedFrameCount++
+            return
+        }
+
+        GLES20.glBindFramebuffer(GLES20.GL_FRAMEBUFFER, 0)
+        GLES20.glViewport(0, 0, size.x, size.y)
+        drawQuad(externalProgram, GLES11Ext.GL_TEXTURE_EXTERNAL_OES, inputTextureId, inputTextureMatrix)
+        // The timestamp of the frame is kept, the image reader receives the rendering time of the virtual display
+        EGLExt.eglPresentationTimeANDROID(eglDisplay, outputEglSurface, inputSurfaceTexture.timestamp)
+        EGL14.eglSwapBuffers(eglDisplay, outputEglSurface)
+
+        System.arraycopy(currentSignature, 0, relayedSignature, 0, currentSignature.size)
+        lastRelayTimeMs = nowMs
+        relayedFrameCount++
+    }
+
+    /**
+     * Compute the signature of the current input frame.
+     * @return true if it is different from the signature of the last relayed frame.
+     */
+    private fun updateSignature(): Boolean {
+        levelSizes.forEachIndexed { index, levelSize ->
+            GLES20.glBindFramebuffer(GLES20.GL_FRAMEBUFFER, levelFramebufferIds[index])
+            GLES20.glViewport(0, 0, levelSize.x, levelSize.y)
+
+            if (index == 0) {
+                drawQuad(externalProgram, GLES11Ext.GL_TEXTURE_EXTERNAL_OES, inputTextureId, inputTextureMatrix)
+            } else {
+                drawQuad(texture2dProgram, GLES20.GL_TEXTURE_2D, levelTextureIds[index - 1], identityMatrix)
+            }
+        }
+
+        val signatureSize = levelSizes.last()
+        signature.position(0)
+        GLES20.glReadPixels(
+            0, 0, signatureSize.x, signatureSize.y, GLES20.GL_RGBA, GLES20.GL_UNSIGNED_BYTE, signature)
+        signature.position(0)
+        signature.get(currentSignature)
+
+        return !currentSignature.contentEquals(relayedSignature)
+    }
+
+    private fun drawQuad(program: Int, textureTarget: Int, textureId: Int, textureMatrix: FloatArray) {
+        GLES20.glUseProgram(program)
+        GLES20.glActiveTexture(GLES20.GL_TEXTURE0)
+        GLES20.glBindTexture(textureTarget, textureId)
+
+        val positionLocation = GLES20.glGetAttribLocation(program, "aPosition")
+        val texCoordLocation = GLES20.glGetAttribLocation(program, "aTexCoord")
+        vertices.position(0)
+        GLES20.glVertexAttribPointer(positionLocation, 2, GLES20.GL_FLOAT, false, VERTEX_STRIDE_BYTES, vertices)
+        GLES20.glEnableVertexAttribArray(positionLocation)
+        vertices.position(2)
+        GLES20.glVertexAttribPointer(texCoordLocation, 2, GLES20.GL_FLOAT, false, VERTEX_STRIDE_BYTES, vertices)
+        GLES20.glEnableVertexAttribArray(texCoordLocation)
+        GLES20.glUniformMatrix4fv(GLES20.glGetUniformLocation(program, "uTexMatrix"), 1, false, textureMatrix, 0)
+        GLES20.glUniform1i(GLES20.glGetUniformLocation(program, "uTexture"), 0)
+
+        GLES20.glDrawArrays(GLES20.GL_TRIANGLE_STRIP, 0, 4)
+
+        GLES20.glDisableVertexAttribArray(positionLocation)
+        GLES20.glDisableVertexAttribArray(texCoordLocation)
+    }
+
+    private fun setupEgl(outputSurface: Surface) {
+        eglDisplay = EGL14.eglGetDisplay(EGL14.EGL_DEFAULT_DISPLAY)
+        val version = IntArray(2)
+        EGL14.eglInitialize(eglDisplay, version, 0, version, 1)
+
+        val configs = arrayOfNulls<EGLConfig>(1)
+        val configCount = IntArray(1)
+        EGL14.eglChooseConfig(eglDisplay, EGL_CONFIG_ATTRIBUTES, 0, configs, 0, 1, configCount, 0)
+        val config = configs[0] ?: throw IllegalStateException("No EGL config for the frame gate")
+
+        eglContext = EGL14.eglCreateContext(
+            eglDisplay, config, EGL14.EGL_NO_CONTEXT,
+            intArrayOf(EGL14.EGL_CONTEXT_CLIENT_VERSION, 2, EGL14.EGL_NONE), 0,
+        )
+        outputEglSurface = EGL14.eglCreateWindowSurface(
+            eglDisplay, config, outputSurface, intArrayOf(EGL14.EGL_NONE), 0)
+        EGL14.eglMakeCurrent(eglDisplay, outputEglSurface, outputEglSurface, eglContext)
+    }
+
+    private fun setupInput() {
+        inputTextureId = newTexture(GLES11Ext.GL_TEXTURE_EXTERNAL_OES)
+        inputSurfaceTexture = SurfaceTexture(inputTextureId).apply {
+            setDefaultBufferSize(size.x, size.y)
+            setOnFrameAvailableListener({ onInputFrameAvailable() }, glHandler)
+        }
+        inputSurface = Surface(inputSurfaceTexture)
+    }
+
+    private fun setupPrograms() {
+        externalProgram = newProgram(VERTEX_SHADER, FRAGMENT_SHADER_EXTERNAL)
+        texture2dProgram = newProgram(VERTEX_SHADER, FRAGMENT_SHADER_2D)
+    }
+
+    private fun setupLevels() {
+        GLES20.glGenFramebuffers(levelFramebufferIds.size, levelFramebufferIds, 0)
+        levelSizes.forEachIndexed { index, levelSize ->
+            levelTextureIds[index] = newTexture(GLES20.GL_TEXTURE_2D)
+            GLES20.glTexImage2D(GLES20.GL_TEXTURE_2D, 0, GLES20.GL_RGBA, levelSize.x, levelSize.y, 0,
+                GLES20.GL_RGBA, GLES20.GL_UNSIGNED_BYTE, null)
+
+            GLES20.glBindFramebuffer(GLES20.GL_FRAMEBUFFER, levelFramebufferIds[index])
+            GLES20.glFramebufferTexture2D(GLES20.GL_FRAMEBUFFER, GLES20.GL_COLOR_ATTACHMENT0, GLES20.GL_TEXTURE_2D,
+                levelTextureIds[index], 0)
+        }
+        GLES20.glBindFramebuffer(GLES20.GL_FRAMEBUFFER, 0)
+    }
+
+    /** Create a texture with a linear filtering, averaging the pixels when sampled between them. */
+    private fun newTexture(target: Int): Int {
+        val textureIds = IntArray(1)
+        GLES20.glGenTextures(1, textureIds, 0)
+        GLES20.glBindTexture(target, textureIds[0])
+        GLES20.glTexParameteri(target, GLES20.GL_TEXTURE_MIN_FILTER, GLES20.GL_LINEAR)
+        GLES20.glTexParameteri(target, GLES20.GL_TEXTURE_MAG_FILTER, GLES20.GL_LINEAR)
+        GLES20.glTexParameteri(target, GLES20.GL_TEXTURE_WRAP_S, GLES20.GL_CLAMP_TO_EDGE)
+        GLES20.glTexParameteri(target, GLES20.GL_TEXTURE_WRAP_T, GLES20.GL_CLAMP_TO_EDGE)
+        return textureIds[0]
+    }
+
+    private fun newProgram(vertexSource: String, fragmentSource: String): Int {
+        val program = GLES20.glCreateProgram()
+        GLES20.glAttachShader(program, newShader(GLES20.GL_VERTEX_SHADER, vertexSource))
+        GLES20.glAttachShader(program, newShader(GLES20.GL_FRAGMENT_SHADER, fragmentSource))
+        GLES20.glLinkProgram(program)
+
+        val linkStatus = IntArray(1)
+        GLES20.glGetProgramiv(program, GLES20.GL_LINK_STATUS, linkStatus, 0)
+        if (linkStatus[0] != GLES20.GL_TRUE) {
+            throw IllegalStateException("Can't link frame gate program: ${GLES20.glGetProgramInfoLog(program)}")
+        }
+        return program
+    }
+
+    private fun newShader(type: Int, source: String): Int {
+        val shader = GLES20.glCreateShader(type)
+        GLES20.glShaderSource(shader, source)
+        GLES20.glCompileShader(shader)
+
+        val compileStatus = IntArray(1)
+        GLES20.glGetShaderiv(shader, GLES20.GL_COMPILE_STATUS, compileStatus, 0)
+        if (compileStatus[0] != GLES20.GL_TRUE) {
+            throw IllegalStateException("Can't compile frame gate shader: ${GLES20.glGetShaderInfoLog(shader)}")
+        }
+        return shader
+    }
+}
+
+/** @return the sizes of the successive halving of [size], until both dimensions are below [SIGNATURE_MAX_SIZE]. */
+private fun getLevelSizes(size: Point): List<Point> = buildList {
+    var levelSize = size
+    do {
+        levelSize = Point((levelSize.x + 1) / 2, (levelSize.y + 1) / 2)
+        add(levelSize)
+    } while (levelSize.x > SIGNATURE_MAX_SIZE || levelSize.y > SIGNATURE_MAX_SIZE)
+}
+
+/** The maximum width and height of the frames signature. */
+private const val SIGNATURE_MAX_SIZE = 64
+/** The maximum time between two relayed frames while frames are rendered, in milliseconds. */
+private const val FORCED_FRAME_INTERVAL_MS = 500L
+/** EGL attribute telling the config can render into a surface consumed by a video encoder or an image reader. */
+private const val EGL_RECORDABLE_ANDROID = 0x3142
+
+private val EGL_CONFIG_ATTRIBUTES = intArrayOf(
+    EGL14.EGL_RED_SIZE, 8,
+    EGL14.EGL_GREEN_SIZE, 8,
+    EGL14.EGL_BLUE_SIZE, 8,
+    EGL14.EGL_ALPHA_SIZE, 8,
+    EGL14.EGL_RENDERABLE_TYPE, EGL14.EGL_OPENGL_ES2_BIT,
+    EGL_RECORDABLE_ANDROID, 1,
+    EGL14.EGL_NONE,
+)
+
+/** Full viewport triangle strip, with interleaved positions and texture coordinates. */
+private val QUAD_VERTICES = floatArrayOf(
+    -1f, -1f, 0f, 0f,
+    1f, -1f, 1f, 0f,
+    -1f, 1f, 0f, 1f,
+    1f, 1f, 1f, 1f,
+)
+private const val VERTEX_STRIDE_BYTES = 4 * Float.SIZE_BYTES
+
+private const val VERTEX_SHADER = """
+attribute vec4 aPosition;
+attribute vec4 aTexCoord;
+uniform mat4 uTexMatrix;
+varying vec2 vTexCoord;
+void main() {
+    gl_Position = aPosition;
+    vTexCoord = (uTexMatrix * aTexCoord).xy;
+}
+"""
+
+private const val FRAGMENT_SHADER_EXTERNAL = """
+#extension GL_OES_EGL_image_external : require
+precision mediump float;
+varying vec2 vTexCoord;
+uniform samplerExternalOES uTexture;
+void main() {
+    gl_FragColor = texture2D(uTexture, vTexCoord);
+}
+"""
+
+private const val FRAGMENT_SHADER_2D = """
+precision mediump float;
+varying vec2 vTexCoord;
+uniform sampler2D uTexture;
+void main() {
+    gl_FragColor = texture2D(uTexture, vTexCoord);
+}
+"""
+
+private const val GL_THREAD_NAME = "GpuFrameGate"
+private const val TAG = "GpuFrameGate"
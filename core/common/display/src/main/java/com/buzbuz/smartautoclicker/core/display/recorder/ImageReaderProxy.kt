@@ -19,12 +19,20 @@ package com.buzbuz.smartautoclicker.core.display.recorder
 import android.graphics.Bitmap
 import android.graphics.PixelFormat
 import android.graphics.Point
+import android.hardware.HardwareBuffer
 import android.hardware.display.VirtualDisplay
 import android.media.Image
 import android.media.ImageReader
+import android.os.Build
+import android.os.Handler
+import android.os.HandlerThread
+import android.os.SystemClock
 import android.util.Log
 import android.view.Surface
 import com.buzbuz.smartautoclicker.core.bitmaps.BitmapRepository
+
+import kotlinx.coroutines.channels.Channel
+
 import javax.inject.Inject
 
 
@@ -34,35 +42,240 @@ internal class ImageReaderProxy @Inject constructor(
 
     /** Allow access to [Image] rendered into the surface view of the [VirtualDisplay] */
     private var imageReader: ImageReader? = null
+    /** The reader prepared for the images of the other orientation, swapped with [imageReader] on rotation. */
+    private var rotatedImageReader: ImageReader? = null
     /** The last frame received from the active [imageReader]. */
     private var lastFrame: Bitmap? = null
+    /** The last frame received from the active [imageReader], kept acquired to be read without copy. */
+    private var lastScreenFrame: ScreenFrame? = null
+    /** The frame before [lastScreenFrame], kept acquired while the detection of the previous image completes. */
+    private var previousScreenFrame: ScreenFrame? = null
+    /** The size of the screen rendered in the images of the [imageReader]. */
+    private var screenSize: Point = Point()
+
+    /** Thread receiving the new image notifications of the [imageReader]. */
+    private var listenerThread: HandlerThread? = null
+    /** Signaled each time a new image is available in the [imageReader]. Conflated, the images are not queued. */
+    private val frameAvailable = Channel<Unit>(Channel.CONFLATED)
+
+    /** Guards the frame arrival statistics, updated on the [listenerThread]. */
+    private val arrivalLock = Any()
+    /** The number of images received since the last resize. */
+    private var arrivalCount: Long = 0
+    /** The arrival time of the last image, in nanoseconds of [SystemClock.elapsedRealtimeNanos]. */
+    private var lastArrivalNs: Long = 0
+    /** The sum of the intervals between the images received, in nanoseconds. */
+    private var arrivalIntervalsSumNs: Long = 0
+    /** The longest interval between two images received, in nanoseconds. */
+    private var maxArrivalIntervalNs: Long = 0
+    /** The number of new images acquired since the last resize. */
+    private var acquireCount: Long = 0
+    /** The sum of the delays between the arrival of the images and their acquisition, in nanoseconds. */
+    private var acquireLatenciesSumNs: Long = 0
+
+    /** The maximum number of images of the reader, adapted to the acquisition latency on each resize. */
+    private var maxImages: Int = MIN_MAX_IMAGES
 
     val surface: Surface
         get() = imageReader!!.surface
 
-    fun resize(size: Point) {
-        imageReader?.close()
-        imageReader = ImageReader.newInstance(size.x, size.y, PixelFormat.RGBA_8888, 2)
+    /**
+     * Use a reader for the provided size.
+     * The current and rotated readers are reused when they have this size, the others are closed and a new one is
+     * created.
+     *
+     * @param size the size of the images, in pixels.
+     * @param screenSize the size of the screen rendered in those images. Bigger than [size] when it is downscaled.
+     * @param prepareRotated true to keep a reader ready for the rotated size, the next rotation then only swaps them.
+     */
+    fun resize(size: Point, screenSize: Point = size, prepareRotated: Boolean = false) {
+        releaseScreenFrame()
+        maxImages = getAdaptedMaxImages()
+
+        val rotatedSize = Point(size.y, size.x)
+        val previousReaders = listOfNotNull(imageReader, rotatedImageReader)
+        val reader = previousReaders.find { reader -> reader.hasSize(size, maxImages) } ?: newImageReader(size)
+        val rotatedReader =
+            if (!prepareRotated || rotatedSize == size) null
+            else previousReaders.find { reader -> reader.hasSize(rotatedSize, maxImages) }
+                ?: newImageReader(rotatedSize)
+        previousReaders.forEach { previous -> if (previous !== reader && previous !== rotatedReader) previous.close() }
+
+        // The rendering of the previous orientation might still be queued in the swapped reader
+        rotatedReader?.setOnImageAvailableListener(null, null)
+        reader.acquireLatestImage()?.close()
+        frameAvailable.tryReceive()
+        reader.setOnImageAvailableListener({ onImageAvailable() }, getListenerHandler())
+
+        if (reader === rotatedImageReader) Log.d(TAG, "Rotated reader swapped for size $size")
+        imageReader = reader
+        rotatedImageReader = rotatedReader
+        this.screenSize = Point(screenSize)
+        resetFrameArrivalStats()
     }
 
     fun close() {
+        releaseScreenFrame()
         imageReader?.close()
         imageReader = null
+        rotatedImageReader?.close()
+        rotatedImageReader = null
         lastFrame = null
+        listenerThread?.quitSafely()
+        listenerThread = null
     }
 
+    /**
+     * Suspend until a new image is available in the reader, or return immediately if one was received since the last
+     * call to [getLastScreenFrame] or [getLastFrame]. The image itself is not acquired.
+     */
+    suspend fun awaitNewFrame() {
+        frameAvailable.receive()
+    }
+
+    /** @return the statistics of the arrival of the images since the reader was created. */
+    fun getFrameArrivalStats(): FrameArrivalStats = synchronized(arrivalLock) {
+        val intervalCount = arrivalCount - 1
+        FrameArrivalStats(
+            frameCount = arrivalCount,
+            meanIntervalMs = if (intervalCount > 0) arrivalIntervalsSumNs / intervalCount / NANOS_PER_MILLI else 0.0,
+            maxIntervalMs = maxArrivalIntervalNs / NANOS_PER_MILLI,
+            meanAcquireLatencyMs =
+                if (acquireCount > 0) acquireLatenciesSumNs / acquireCount / NANOS_PER_MILLI else 0.0,
+            readerDepth = maxImages,
+            readerUsage = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) READER_USAGE else 0,
+        )
+    }
+
+    /** Get a copy of the last frame, or the previous copy if there is no new frame. Null if none was rendered yet. */
     fun getLastFrame(): Bitmap? {
         val reader = imageReader ?: run {
             Log.e(TAG, "Can't get last frame, ImageReader is null")
             return null
         }
 
+        frameAvailable.tryReceive()
         return reader.acquireLatestImage()
             ?.use { image -> image.toBitmap().also { lastFrame = it } }
             ?: lastFrame
     }
 
+    /**
+     * Get the last frame without copying its pixels.
+     * The frame returned by this method before the previous one is released, except if there is no new frame, in which
+     * case the previous one is returned again. Both the last and the previous frames are then acquired, allowing to
+     * read the next frame while the current one is still in use.
+     */
+    fun getLastScreenFrame(): ScreenFrame? {
+        val reader = imageReader ?: run {
+            Log.e(TAG, "Can't get last screen frame, ImageReader is null")
+            return null
+        }
+
+        // Consumed before acquiring, an image received meanwhile signals it again and isn't missed by awaitNewFrame
+        frameAvailable.tryReceive()
+        val image = reader.acquireLatestImage()
+            ?: return lastScreenFrame?.apply { latestTimeNs = System.nanoTime() }
+        onImageAcquired()
+        previousScreenFrame?.close()
+        previousScreenFrame = lastScreenFrame
+        return ScreenFrame(image, screenSize).also { lastScreenFrame = it }
+    }
+
+    /** Called on the [listenerThread] when a new image is queued in the reader. */
+    private fun onImageAvailable() {
+        val arrivalNs = SystemClock.elapsedRealtimeNanos()
+        synchronized(arrivalLock) {
+            if (arrivalCount > 0) {
+                val intervalNs = arrivalNs - lastArrivalNs
+                arrivalIntervalsSumNs += intervalNs
+                if (intervalNs > maxArrivalIntervalNs) maxArrivalIntervalNs = intervalNs
+            }
+            lastArrivalNs = arrivalNs
+            arrivalCount++
+        }
+
+        frameAvailable.trySend(Unit)
+    }
+
+    /** Called when the latest image is acquired, the last one that arrived. */
+    private fun onImageAcquired(): Unit = synchronized(arrivalLock) {
+        if (arrivalCount == 0L) return
+
+        acquireLatenciesSumNs += SystemClock.elapsedRealtimeNanos() - lastArrivalNs
+        acquireCount++
+    }
+
+    private fun resetFrameArrivalStats(): Unit = synchronized(arrivalLock) {
+        arrivalCount = 0
+        lastArrivalNs = 0
+        arrivalIntervalsSumNs = 0
+        maxArrivalIntervalNs = 0
+        acquireCount = 0
+        acquireLatenciesSumNs = 0
+    }
+
+    /**
+     * Get the number of images of the next reader, from the latencies measured with the current one.
+     *
+     * Two images are kept acquired as [ScreenFrame] and acquireLatestImage requires two more. When the images wait
+     * longer than a frame interval before being acquired, the producer can run out of buffers while the detection
+     * holds the frames, an extra one is added. It is removed once the images are acquired quickly again.
+     */
+    private fun getAdaptedMaxImages(): Int = synchronized(arrivalLock) {
+        if (acquireCount < ADAPTATION_MIN_FRAME_COUNT || arrivalCount < 2) return maxImages
+
+        val meanIntervalNs = arrivalIntervalsSumNs / (arrivalCount - 1)
+        val meanAcquireLatencyNs = acquireLatenciesSumNs / acquireCount
+        val adapted = when {
+            meanAcquireLatencyNs > meanIntervalNs -> maxImages + 1
+            meanAcquireLatencyNs < meanIntervalNs / 4 -> maxImages - 1
+            else -> maxImages
+        }.coerceIn(MIN_MAX_IMAGES, MAX_MAX_IMAGES)
+
+        if (adapted != maxImages) {
+            Log.i(TAG, "Reader depth $maxImages -> $adapted, acquire latency=${meanAcquireLatencyNs}ns; " +
+                    "interval=${meanIntervalNs}ns")
+        }
+        adapted
+    }
+
+    /** The images are read by the CPU on each frame, they are mapped with a cached memory when possible. */
+    private fun newImageReader(size: Point): ImageReader =
+        if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) {
+            ImageReader.newInstance(size.x, size.y, PixelFormat.RGBA_8888, maxImages, READER_USAGE)
+        } else {
+            ImageReader.newInstance(size.x, size.y, PixelFormat.RGBA_8888, maxImages)
+        }
+
+    private fun ImageReader.hasSize(size: Point, depth: Int): Boolean =
+        width == size.x && height == size.y && maxImages == depth
+
+    private fun getListenerHandler(): Handler {
+        val thread = listenerThread ?: HandlerThread(LISTENER_THREAD_NAME).also { thread ->
+            thread.start()
+            listenerThread = thread
+        }
+
+        return Handler(thread.looper)
+    }
+
+    private fun releaseScreenFrame() {
+        previousScreenFrame?.close()
+        previousScreenFrame = null
+        lastScreenFrame?.close()
+        lastScreenFrame = null
+    }
+
     private fun Image.toBitmap(): Bitmap {
+        // Without row padding, the pixels are copied in the returned bitmap directly
+        if (planes[0].rowStride == planes[0].pixelStride * width) {
+            return Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888).apply {
+                copyPixelsFromBuffer(planes[0].buffer)
+            }
+        }
+
+        // Otherwise, in a bitmap including the padding, cropped in the returned one
         val imageWidth = width + (planes[0].rowStride - planes[0].pixelStride * width) / planes[0].pixelStride
         val bitmap = bitmapRepository.getDisplayRecorderBitmap(imageWidth, height).apply {
             copyPixelsFromBuffer(planes[0].buffer)
@@ -72,4 +285,19 @@ internal class ImageReaderProxy @Inject constructor(
     }
 }
 
+/**
+ * Minimum number of images in the reader. Two can be kept acquired as [ScreenFrame], while acquireLatestImage still
+ * requires two free slots to drop the outdated ones.
+ */
+private const val MIN_MAX_IMAGES = 4
+/** Maximum number of images in the reader, when the detection holds the frames for a long time. */
+private const val MAX_MAX_IMAGES = 6
+/** Minimum number of acquired images to adapt the number of images of the next reader. */
+private const val ADAPTATION_MIN_FRAME_COUNT = 30
+/** Usage of the reader images, read by the CPU for each detected frame. */
+private const val READER_USAGE = HardwareBuffer.USAGE_CPU_READ_OFTEN
+/** Name of the thread receiving the new image notifications. */
+private const val LISTENER_THREAD_NAME = "ImageReaderListener"
+/** Number of nanoseconds in a millisecond. */
+private const val NANOS_PER_MILLI = 1_000_000.0
 private const val TAG = "ImageReaderProxy"
\ No newline at end of file
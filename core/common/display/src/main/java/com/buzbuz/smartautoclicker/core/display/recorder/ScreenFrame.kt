@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2024 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.display.recorder
+
+import android.graphics.Point
+import android.media.Image
+import java.nio.ByteBuffer
+
+/**
+ * A frame of the screen, backed by the [Image] of the ImageReader.
+ *
+ * The pixels are not copied: [buffer] is directly mapped on the image memory, in RGBA_8888, with each row starting
+ * every [rowStride] bytes. It remains valid while the next frame is acquired, until the one after it is acquired or
+ * the screen record is stopped.
+ */
+class ScreenFrame internal constructor(
+    private val image: Image,
+    screenSize: Point,
+) : AutoCloseable {
+
+    /** The width of the frame, in pixels. */
+    val width: Int = image.width
+    /** The height of the frame, in pixels. */
+    val height: Int = image.height
+    /** The width of the screen in the frame, in pixels. Bigger than [width] when the screen is captured smaller. */
+    val screenWidth: Int = screenSize.x
+    /** The height of the screen in the frame, in pixels. Bigger than [height] when the screen is captured smaller. */
+    val screenHeight: Int = screenSize.y
+    /** The direct buffer containing the frame pixels. */
+    val buffer: ByteBuffer = image.planes[0].buffer
+    /** The number of bytes between the start of two consecutive rows in [buffer]. */
+    val rowStride: Int = image.planes[0].rowStride
+    /** The time the frame was rendered, in nanoseconds of the [System.nanoTime] time base. */
+    val timestampNs: Long = image.timestamp
+    /**
+     * The last time the frame was acquired as the latest one, in nanoseconds of the [System.nanoTime] time base. The
+     * screen content is known to be the frame one at that time, even long after its rendering if it is unchanged.
+     */
+    var latestTimeNs: Long = System.nanoTime()
+        internal set
+
+    override fun close() {
+        image.close()
+    }
+}
@@ -20,6 +20,7 @@ import android.content.BroadcastReceiver
 import android.content.Context
 import android.content.Intent
 import android.content.res.Configuration
+import android.graphics.Insets
 import android.graphics.Point
 import android.graphics.Rect
 import android.hardware.display.DisplayManager
@@ -62,6 +63,8 @@ class DisplayConfigManagerTests {
     private companion object {
         private const val DISPLAY_SIZE_X = 800
         private const val DISPLAY_SIZE_Y = 600
+        private const val STATUS_BAR_HEIGHT = 24
+        private const val NAVIGATION_BAR_HEIGHT = 48
     }
 
     private interface OrientationListener {
@@ -103,6 +106,8 @@ class DisplayConfigManagerTests {
         val mockRoundedCorner = Mockito.mock(RoundedCorner::class.java)
         mockWhen(mockWindowMetrics.windowInsets).thenReturn(mockWindowInsets)
         mockWhen(mockWindowInsets.getRoundedCorner(anyInt())).thenReturn(mockRoundedCorner)
+        mockWhen(mockWindowInsets.getInsetsIgnoringVisibility(anyInt()))
+            .thenReturn(Insets.of(0, STATUS_BAR_HEIGHT, 0, NAVIGATION_BAR_HEIGHT))
         mockWhen(mockRoundedCorner.center).thenReturn(Point(0, 0))
         mockWhen(mockRoundedCorner.radius).thenReturn(5)
     }
@@ -258,6 +263,28 @@ class DisplayConfigManagerTests {
         verify(mockOrientationListener).onOrientationChanged()
     }
 
+    @Test
+    fun getSystemInsets_modern() {
+        mockWhen(mockDisplay.rotation).thenReturn(Surface.ROTATION_0)
+        mockCurrentWindowMetrics()
+        displayConfigManager = DisplayConfigManager(mockContext)
+
+        assertEquals(
+            Rect(0, STATUS_BAR_HEIGHT, 0, NAVIGATION_BAR_HEIGHT),
+            displayConfigManager.displayConfig.systemInsetsPx,
+        )
+    }
+
+    @Test
+    @Config(sdk = [Build.VERSION_CODES.Q])
+    fun getSystemInsets_legacy_noCutout() {
+        mockWhen(mockDisplay.rotation).thenReturn(Surface.ROTATION_0)
+        mockLegacyGetDisplaySize()
+        displayConfigManager = DisplayConfigManager(mockContext)
+
+        assertEquals(Rect(), displayConfigManager.displayConfig.systemInsetsPx)
+    }
+
     @Test
     fun orientationChanged_sameOrientation() {
         mockWhen(mockDisplay.rotation).thenReturn(Surface.ROTATION_0)
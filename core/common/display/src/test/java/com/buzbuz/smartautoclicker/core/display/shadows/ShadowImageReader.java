@@ -17,6 +17,7 @@
 package com.buzbuz.smartautoclicker.core.display.shadows;
 
 import android.media.ImageReader;
+import android.os.Build;
 
 import androidx.annotation.NonNull;
 import androidx.annotation.Nullable;
@@ -60,6 +61,12 @@ public class ShadowImageReader {
         return mockImageReader;
     }
 
+    @NonNull
+    @Implementation(minSdk = Build.VERSION_CODES.Q)
+    public static ImageReader newInstance(int width, int height, int format, int maxImages, long usage) {
+        return newInstance(width, height, format, maxImages);
+    }
+
     /** Call this method between each tests to clean the mock. */
     @Resetter
     public static void reset() {
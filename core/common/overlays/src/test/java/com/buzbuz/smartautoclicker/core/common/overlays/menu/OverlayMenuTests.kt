@@ -20,6 +20,7 @@ import android.content.Context
 import android.content.SharedPreferences
 import android.content.res.Resources
 import android.graphics.Point
+import android.graphics.Rect
 import android.os.Build
 import android.view.LayoutInflater
 import android.view.View
@@ -70,6 +71,7 @@ class OverlayMenuTests {
             sizePx = Point(TEST_DATA_DISPLAY_WIDTH, TEST_DATA_DISPLAY_HEIGHT),
             orientation = 0,
             safeInsetTopPx = 0,
+            systemInsetsPx = Rect(),
             roundedCorners = emptyMap(),
         )
     }
@@ -40,4 +40,160 @@ interface SettingsRepository {
     val isInputBlockWorkaroundEnabledFlow: Flow<Boolean>
     fun isInputBlockWorkaroundEnabled(): Boolean
     fun toggleInputBlockWorkaround()
+
+    val isPyramidMatchingEnabledFlow: Flow<Boolean>
+    fun isPyramidMatchingEnabled(): Boolean
+    fun togglePyramidMatching()
+
+    val isMultiScaleMatchingEnabledFlow: Flow<Boolean>
+    fun isMultiScaleMatchingEnabled(): Boolean
+    fun toggleMultiScaleMatching()
+
+    val isHistogramColorVerificationEnabledFlow: Flow<Boolean>
+    fun isHistogramColorVerificationEnabled(): Boolean
+    fun toggleHistogramColorVerification()
+
+    val isScaledColorVerificationEnabledFlow: Flow<Boolean>
+    fun isScaledColorVerificationEnabled(): Boolean
+    fun toggleScaledColorVerification()
+
+    val isDownscaledCaptureEnabledFlow: Flow<Boolean>
+    fun isDownscaledCaptureEnabled(): Boolean
+    fun toggleDownscaledCapture()
+
+    val isIntegerMatchingEnabledFlow: Flow<Boolean>
+    fun isIntegerMatchingEnabled(): Boolean
+    fun toggleIntegerMatching()
+
+    val isSparseMatchingEnabledFlow: Flow<Boolean>
+    fun isSparseMatchingEnabled(): Boolean
+    fun toggleSparseMatching()
+
+    val isBinaryMatchingEnabledFlow: Flow<Boolean>
+    fun isBinaryMatchingEnabled(): Boolean
+    fun toggleBinaryMatching()
+
+    val isChamferMatchingEnabledFlow: Flow<Boolean>
+    fun isChamferMatchingEnabled(): Boolean
+    fun toggleChamferMatching()
+
+    val isMotionCompensationEnabledFlow: Flow<Boolean>
+    fun isMotionCompensationEnabled(): Boolean
+    fun toggleMotionCompensation()
+
+    val isRotatedReaderEnabledFlow: Flow<Boolean>
+    fun isRotatedReaderEnabled(): Boolean
+    fun toggleRotatedReader()
+
+    val isIdleConditionsCompactionEnabledFlow: Flow<Boolean>
+    fun isIdleConditionsCompactionEnabled(): Boolean
+    fun toggleIdleConditionsCompaction()
+
+    val isTriggerOnlyCapturePauseEnabledFlow: Flow<Boolean>
+    fun isTriggerOnlyCapturePauseEnabled(): Boolean
+    fun toggleTriggerOnlyCapturePause()
+
+    val isNativeScreenReaderEnabledFlow: Flow<Boolean>
+    fun isNativeScreenReaderEnabled(): Boolean
+    fun toggleNativeScreenReader()
+
+    val isAnimatedAreasExclusionEnabledFlow: Flow<Boolean>
+    fun isAnimatedAreasExclusionEnabled(): Boolean
+    fun toggleAnimatedAreasExclusion()
+
+    val isSystemBarsExclusionEnabledFlow: Flow<Boolean>
+    fun isSystemBarsExclusionEnabled(): Boolean
+    fun toggleSystemBarsExclusion()
+
+    val isScreenStatesGatingEnabledFlow: Flow<Boolean>
+    fun isScreenStatesGatingEnabled(): Boolean
+    fun toggleScreenStatesGating()
+
+    val isGpuMatchingEnabledFlow: Flow<Boolean>
+    fun isGpuMatchingEnabled(): Boolean
+    fun toggleGpuMatching()
+
+    val isNnapiMatchingEnabledFlow: Flow<Boolean>
+    fun isNnapiMatchingEnabled(): Boolean
+    fun toggleNnapiMatching()
+
+    val isAdaptiveFramePacingEnabledFlow: Flow<Boolean>
+    fun isAdaptiveFramePacingEnabled(): Boolean
+    fun toggleAdaptiveFramePacing()
+
+    val isThermalQualityScalingEnabledFlow: Flow<Boolean>
+    fun isThermalQualityScalingEnabled(): Boolean
+    fun toggleThermalQualityScaling()
+
+    val isPerformanceThreadsEnabledFlow: Flow<Boolean>
+    fun isPerformanceThreadsEnabled(): Boolean
+    fun togglePerformanceThreads()
+
+    val isDetectorMemoryBudgetEnabledFlow: Flow<Boolean>
+    fun isDetectorMemoryBudgetEnabled(): Boolean
+    fun toggleDetectorMemoryBudget()
+
+    val isDetectionCaptureEnabledFlow: Flow<Boolean>
+    fun isDetectionCaptureEnabled(): Boolean
+    fun toggleDetectionCapture()
+
+    val isSpeculativeEventsEnabledFlow: Flow<Boolean>
+    fun isSpeculativeEventsEnabled(): Boolean
+    fun toggleSpeculativeEvents()
+
+    val isStaleFrameDroppingEnabledFlow: Flow<Boolean>
+    fun isStaleFrameDroppingEnabled(): Boolean
+    fun toggleStaleFrameDropping()
+
+    val isDetectionQualityTuningEnabledFlow: Flow<Boolean>
+    fun isDetectionQualityTuningEnabled(): Boolean
+    fun toggleDetectionQualityTuning()
+
+    val isFirstHitMatchingEnabledFlow: Flow<Boolean>
+    fun isFirstHitMatchingEnabled(): Boolean
+    fun toggleFirstHitMatching()
+
+    val isLearnedAreaMatchingEnabledFlow: Flow<Boolean>
+    fun isLearnedAreaMatchingEnabled(): Boolean
+    fun toggleLearnedAreaMatching()
+
+    val isIntegerScaleRatioEnabledFlow: Flow<Boolean>
+    fun isIntegerScaleRatioEnabled(): Boolean
+    fun toggleIntegerScaleRatio()
+
+    val isConditionTimeBudgetEnabledFlow: Flow<Boolean>
+    fun isConditionTimeBudgetEnabled(): Boolean
+    fun toggleConditionTimeBudget()
+
+    val isPreciseDumbTimingEnabledFlow: Flow<Boolean>
+    fun isPreciseDumbTimingEnabled(): Boolean
+    fun togglePreciseDumbTiming()
+
+    val isGestureBatchingEnabledFlow: Flow<Boolean>
+    fun isGestureBatchingEnabled(): Boolean
+    fun toggleGestureBatching()
+
+    val isActionsOverlapEnabledFlow: Flow<Boolean>
+    fun isActionsOverlapEnabled(): Boolean
+    fun toggleActionsOverlap()
+
+    val isDetectionGateEnabledFlow: Flow<Boolean>
+    fun isDetectionGateEnabled(): Boolean
+    fun toggleDetectionGate()
+
+    val isGpuFrameGateEnabledFlow: Flow<Boolean>
+    fun isGpuFrameGateEnabled(): Boolean
+    fun toggleGpuFrameGate()
+
+    val isScreenChangeWaitEnabledFlow: Flow<Boolean>
+    fun isScreenChangeWaitEnabled(): Boolean
+    fun toggleScreenChangeWait()
+
+    val isFrameAllocatorEnabledFlow: Flow<Boolean>
+    fun isFrameAllocatorEnabled(): Boolean
+    fun toggleFrameAllocator()
+
+    val isConditionPrefilterEnabledFlow: Flow<Boolean>
+    fun isConditionPrefilterEnabled(): Boolean
+    fun toggleConditionPrefilter()
 }
\ No newline at end of file
@@ -58,6 +58,199 @@ internal class SettingsRepositoryImpl @Inject constructor(
         .stateIn(coroutineScope, SharingStarted.Eagerly, false)
     override val isInputBlockWorkaroundEnabledFlow: Flow<Boolean> = _isInputBlockWorkaroundEnabledFlow
 
+    private val _isPyramidMatchingEnabledFlow: StateFlow<Boolean> = dataSource.isPyramidMatchingEnabled()
+        .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isPyramidMatchingEnabledFlow: Flow<Boolean> = _isPyramidMatchingEnabledFlow
+
+    private val _isMultiScaleMatchingEnabledFlow: StateFlow<Boolean> = dataSource.isMultiScaleMatchingEnabled()
+        .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isMultiScaleMatchingEnabledFlow: Flow<Boolean> = _isMultiScaleMatchingEnabledFlow
+
+    private val _isHistogramColorVerificationEnabledFlow: StateFlow<Boolean> =
+        dataSource.isHistogramColorVerificationEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isHistogramColorVerificationEnabledFlow: Flow<Boolean> = _isHistogramColorVerificationEnabledFlow
+
+    private val _isScaledColorVerificationEnabledFlow: StateFlow<Boolean> =
+        dataSource.isScaledColorVerificationEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isScaledColorVerificationEnabledFlow: Flow<Boolean> = _isScaledColorVerificationEnabledFlow
+
+    private val _isDownscaledCaptureEnabledFlow: StateFlow<Boolean> =
+        dataSource.isDownscaledCaptureEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isDownscaledCaptureEnabledFlow: Flow<Boolean> = _isDownscaledCaptureEnabledFlow
+
+    private val _isIntegerMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isIntegerMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isIntegerMatchingEnabledFlow: Flow<Boolean> = _isIntegerMatchingEnabledFlow
+
+    private val _isSparseMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isSparseMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isSparseMatchingEnabledFlow: Flow<Boolean> = _isSparseMatchingEnabledFlow
+
+    private val _isBinaryMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isBinaryMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isBinaryMatchingEnabledFlow: Flow<Boolean> = _isBinaryMatchingEnabledFlow
+
+    private val _isChamferMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isChamferMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isChamferMatchingEnabledFlow: Flow<Boolean> = _isChamferMatchingEnabledFlow
+
+    private val _isMotionCompensationEnabledFlow: StateFlow<Boolean> =
+        dataSource.isMotionCompensationEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isMotionCompensationEnabledFlow: Flow<Boolean> = _isMotionCompensationEnabledFlow
+
+    private val _isRotatedReaderEnabledFlow: StateFlow<Boolean> =
+        dataSource.isRotatedReaderEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isRotatedReaderEnabledFlow: Flow<Boolean> = _isRotatedReaderEnabledFlow
+
+    private val _isIdleConditionsCompactionEnabledFlow: StateFlow<Boolean> =
+        dataSource.isIdleConditionsCompactionEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isIdleConditionsCompactionEnabledFlow: Flow<Boolean> = _isIdleConditionsCompactionEnabledFlow
+
+    private val _isTriggerOnlyCapturePauseEnabledFlow: StateFlow<Boolean> =
+        dataSource.isTriggerOnlyCapturePauseEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isTriggerOnlyCapturePauseEnabledFlow: Flow<Boolean> = _isTriggerOnlyCapturePauseEnabledFlow
+
+    private val _isNativeScreenReaderEnabledFlow: StateFlow<Boolean> =
+        dataSource.isNativeScreenReaderEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isNativeScreenReaderEnabledFlow: Flow<Boolean> = _isNativeScreenReaderEnabledFlow
+
+    private val _isAnimatedAreasExclusionEnabledFlow: StateFlow<Boolean> =
+        dataSource.isAnimatedAreasExclusionEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isAnimatedAreasExclusionEnabledFlow: Flow<Boolean> = _isAnimatedAreasExclusionEnabledFlow
+
+    private val _isSystemBarsExclusionEnabledFlow: StateFlow<Boolean> =
+        dataSource.isSystemBarsExclusionEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, true)
+    override val isSystemBarsExclusionEnabledFlow: Flow<Boolean> = _isSystemBarsExclusionEnabledFlow
+
+    private val _isScreenStatesGatingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isScreenStatesGatingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isScreenStatesGatingEnabledFlow: Flow<Boolean> = _isScreenStatesGatingEnabledFlow
+
+    private val _isGpuMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isGpuMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isGpuMatchingEnabledFlow: Flow<Boolean> = _isGpuMatchingEnabledFlow
+
+    private val _isNnapiMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isNnapiMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isNnapiMatchingEnabledFlow: Flow<Boolean> = _isNnapiMatchingEnabledFlow
+
+    private val _isAdaptiveFramePacingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isAdaptiveFramePacingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isAdaptiveFramePacingEnabledFlow: Flow<Boolean> = _isAdaptiveFramePacingEnabledFlow
+
+    private val _isThermalQualityScalingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isThermalQualityScalingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isThermalQualityScalingEnabledFlow: Flow<Boolean> = _isThermalQualityScalingEnabledFlow
+
+    private val _isPerformanceThreadsEnabledFlow: StateFlow<Boolean> =
+        dataSource.isPerformanceThreadsEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isPerformanceThreadsEnabledFlow: Flow<Boolean> = _isPerformanceThreadsEnabledFlow
+
+    private val _isDetectorMemoryBudgetEnabledFlow: StateFlow<Boolean> =
+        dataSource.isDetectorMemoryBudgetEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isDetectorMemoryBudgetEnabledFlow: Flow<Boolean> = _isDetectorMemoryBudgetEnabledFlow
+
+    private val _isDetectionCaptureEnabledFlow: StateFlow<Boolean> =
+        dataSource.isDetectionCaptureEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isDetectionCaptureEnabledFlow: Flow<Boolean> = _isDetectionCaptureEnabledFlow
+
+    private val _isSpeculativeEventsEnabledFlow: StateFlow<Boolean> =
+        dataSource.isSpeculativeEventsEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isSpeculativeEventsEnabledFlow: Flow<Boolean> = _isSpeculativeEventsEnabledFlow
+
+    private val _isStaleFrameDroppingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isStaleFrameDroppingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isStaleFrameDroppingEnabledFlow: Flow<Boolean> = _isStaleFrameDroppingEnabledFlow
+
+    private val _isDetectionQualityTuningEnabledFlow: StateFlow<Boolean> =
+        dataSource.isDetectionQualityTuningEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isDetectionQualityTuningEnabledFlow: Flow<Boolean> = _isDetectionQualityTuningEnabledFlow
+
+    private val _isFirstHitMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isFirstHitMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isFirstHitMatchingEnabledFlow: Flow<Boolean> = _isFirstHitMatchingEnabledFlow
+
+    private val _isLearnedAreaMatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isLearnedAreaMatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isLearnedAreaMatchingEnabledFlow: Flow<Boolean> = _isLearnedAreaMatchingEnabledFlow
+
+    private val _isIntegerScaleRatioEnabledFlow: StateFlow<Boolean> =
+        dataSource.isIntegerScaleRatioEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isIntegerScaleRatioEnabledFlow: Flow<Boolean> = _isIntegerScaleRatioEnabledFlow
+
+    private val _isConditionTimeBudgetEnabledFlow: StateFlow<Boolean> =
+        dataSource.isConditionTimeBudgetEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isConditionTimeBudgetEnabledFlow: Flow<Boolean> = _isConditionTimeBudgetEnabledFlow
+
+    private val _isPreciseDumbTimingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isPreciseDumbTimingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isPreciseDumbTimingEnabledFlow: Flow<Boolean> = _isPreciseDumbTimingEnabledFlow
+
+    private val _isGestureBatchingEnabledFlow: StateFlow<Boolean> =
+        dataSource.isGestureBatchingEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isGestureBatchingEnabledFlow: Flow<Boolean> = _isGestureBatchingEnabledFlow
+
+    private val _isActionsOverlapEnabledFlow: StateFlow<Boolean> =
+        dataSource.isActionsOverlapEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isActionsOverlapEnabledFlow: Flow<Boolean> = _isActionsOverlapEnabledFlow
+
+    private val _isDetectionGateEnabledFlow: StateFlow<Boolean> =
+        dataSource.isDetectionGateEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isDetectionGateEnabledFlow: Flow<Boolean> = _isDetectionGateEnabledFlow
+
+    private val _isGpuFrameGateEnabledFlow: StateFlow<Boolean> =
+        dataSource.isGpuFrameGateEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isGpuFrameGateEnabledFlow: Flow<Boolean> = _isGpuFrameGateEnabledFlow
+
+    private val _isScreenChangeWaitEnabledFlow: StateFlow<Boolean> =
+        dataSource.isScreenChangeWaitEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isScreenChangeWaitEnabledFlow: Flow<Boolean> = _isScreenChangeWaitEnabledFlow
+
+    private val _isFrameAllocatorEnabledFlow: StateFlow<Boolean> =
+        dataSource.isFrameAllocatorEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isFrameAllocatorEnabledFlow: Flow<Boolean> = _isFrameAllocatorEnabledFlow
+
+    private val _isConditionPrefilterEnabledFlow: StateFlow<Boolean> =
+        dataSource.isConditionPrefilterEnabled()
+            .stateIn(coroutineScope, SharingStarted.Eagerly, false)
+    override val isConditionPrefilterEnabledFlow: Flow<Boolean> = _isConditionPrefilterEnabledFlow
+
 
     override fun isFilterScenarioUiEnabled(): Boolean =
         _isFilterScenarioUiEnabled.value
@@ -108,4 +301,356 @@ internal class SettingsRepositoryImpl @Inject constructor(
             dataSource.toggleInputBlockWorkaround()
         }
     }
+
+
+    override fun isPyramidMatchingEnabled(): Boolean =
+        _isPyramidMatchingEnabledFlow.value
+
+    override fun togglePyramidMatching() {
+        coroutineScope.launch {
+            dataSource.togglePyramidMatching()
+        }
+    }
+
+    override fun isMultiScaleMatchingEnabled(): Boolean =
+        _isMultiScaleMatchingEnabledFlow.value
+
+    override fun toggleMultiScaleMatching() {
+        coroutineScope.launch {
+            dataSource.toggleMultiScaleMatching()
+        }
+    }
+
+    override fun isHistogramColorVerificationEnabled(): Boolean =
+        _isHistogramColorVerificationEnabledFlow.value
+
+    override fun toggleHistogramColorVerification() {
+        coroutineScope.launch {
+            dataSource.toggleHistogramColorVerification()
+        }
+    }
+
+    override fun isScaledColorVerificationEnabled(): Boolean =
+        _isScaledColorVerificationEnabledFlow.value
+
+    override fun toggleScaledColorVerification() {
+        coroutineScope.launch {
+            dataSource.toggleScaledColorVerification()
+        }
+    }
+
+    override fun isDownscaledCaptureEnabled(): Boolean =
+        _isDownscaledCaptureEnabledFlow.value
+
+    override fun toggleDownscaledCapture() {
+        coroutineScope.launch {
+            dataSource.toggleDownscaledCapture()
+        }
+    }
+
+    override fun isIntegerMatchingEnabled(): Boolean =
+        _isIntegerMatchingEnabledFlow.value
+
+    override fun toggleIntegerMatching() {
+        coroutineScope.launch {
+            dataSource.toggleIntegerMatching()
+        }
+    }
+
+    override fun isSparseMatchingEnabled(): Boolean =
+        _isSparseMatchingEnabledFlow.value
+
+    override fun toggleSparseMatching() {
+        coroutineScope.launch {
+            dataSource.toggleSparseMatching()
+        }
+    }
+
+    override fun isBinaryMatchingEnabled(): Boolean =
+        _isBinaryMatchingEnabledFlow.value
+
+    override fun toggleBinaryMatching() {
+        coroutineScope.launch {
+            dataSource.toggleBinaryMatching()
+        }
+    }
+
+    override fun isChamferMatchingEnabled(): Boolean =
+        _isChamferMatchingEnabledFlow.value
+
+    override fun toggleChamferMatching() {
+        coroutineScope.launch {
+            dataSource.toggleChamferMatching()
+        }
+    }
+
+    override fun isMotionCompensationEnabled(): Boolean =
+        _isMotionCompensationEnabledFlow.value
+
+    override fun toggleMotionCompensation() {
+        coroutineScope.launch {
+            dataSource.toggleMotionCompensation()
+        }
+    }
+
+    override fun isRotatedReaderEnabled(): Boolean =
+        _isRotatedReaderEnabledFlow.value
+
+    override fun toggleRotatedReader() {
+        coroutineScope.launch {
+            dataSource.toggleRotatedReader()
+        }
+    }
+
+    override fun isIdleConditionsCompactionEnabled(): Boolean =
+        _isIdleConditionsCompactionEnabledFlow.value
+
+    override fun toggleIdleConditionsCompaction() {
+        coroutineScope.launch {
+            dataSource.toggleIdleConditionsCompaction()
+        }
+    }
+
+    override fun isTriggerOnlyCapturePauseEnabled(): Boolean =
+        _isTriggerOnlyCapturePauseEnabledFlow.value
+
+    override fun toggleTriggerOnlyCapturePause() {
+        coroutineScope.launch {
+            dataSource.toggleTriggerOnlyCapturePause()
+        }
+    }
+
+    override fun isNativeScreenReaderEnabled(): Boolean =
+        _isNativeScreenReaderEnabledFlow.value
+
+    override fun toggleNativeScreenReader() {
+        coroutineScope.launch {
+            dataSource.toggleNativeScreenReader()
+        }
+    }
+
+    override fun isAnimatedAreasExclusionEnabled(): Boolean =
+        _isAnimatedAreasExclusionEnabledFlow.value
+
+    override fun toggleAnimatedAreasExclusion() {
+        coroutineScope.launch {
+            dataSource.toggleAnimatedAreasExclusion()
+        }
+    }
+
+    override fun isSystemBarsExclusionEnabled(): Boolean =
+        _isSystemBarsExclusionEnabledFlow.value
+
+    override fun toggleSystemBarsExclusion() {
+        coroutineScope.launch {
+            dataSource.toggleSystemBarsExclusion()
+        }
+    }
+
+    override fun isScreenStatesGatingEnabled(): Boolean =
+        _isScreenStatesGatingEnabledFlow.value
+
+    override fun toggleScreenStatesGating() {
+        coroutineScope.launch {
+            dataSource.toggleScreenStatesGating()
+        }
+    }
+
+    override fun isGpuMatchingEnabled(): Boolean =
+        _isGpuMatchingEnabledFlow.value
+
+    override fun toggleGpuMatching() {
+        coroutineScope.launch {
+            dataSource.toggleGpuMatching()
+        }
+    }
+
+    override fun isNnapiMatchingEnabled(): Boolean =
+        _isNnapiMatchingEnabledFlow.value
+
+    override fun toggleNnapiMatching() {
+        coroutineScope.launch {
+            dataSource.toggleNnapiMatching()
+        }
+    }
+
+    override fun isAdaptiveFramePacingEnabled(): Boolean =
+        _isAdaptiveFramePacingEnabledFlow.value
+
+    override fun toggleAdaptiveFramePacing() {
+        coroutineScope.launch {
+            dataSource.toggleAdaptiveFramePacing()
+        }
+    }
+
+    override fun isThermalQualityScalingEnabled(): Boolean =
+        _isThermalQualityScalingEnabledFlow.value
+
+    override fun toggleThermalQualityScaling() {
+        coroutineScope.launch {
+            dataSource.toggleThermalQualityScaling()
+        }
+    }
+
+    override fun isPerformanceThreadsEnabled(): Boolean =
+        _isPerformanceThreadsEnabledFlow.value
+
+    override fun togglePerformanceThreads() {
+        coroutineScope.launch {
+            dataSource.togglePerformanceThreads()
+        }
+    }
+
+    override fun isDetectorMemoryBudgetEnabled(): Boolean =
+        _isDetectorMemoryBudgetEnabledFlow.value
+
+    override fun toggleDetectorMemoryBudget() {
+        coroutineScope.launch {
+            dataSource.toggleDetectorMemoryBudget()
+        }
+    }
+
+    override fun isDetectionCaptureEnabled(): Boolean =
+        _isDetectionCaptureEnabledFlow.value
+
+    override fun toggleDetectionCapture() {
+        coroutineScope.launch {
+            dataSource.toggleDetectionCapture()
+        }
+    }
+
+    override fun isSpeculativeEventsEnabled(): Boolean =
+        _isSpeculativeEventsEnabledFlow.value
+
+    override fun toggleSpeculativeEvents() {
+        coroutineScope.launch {
+            dataSource.toggleSpeculativeEvents()
+        }
+    }
+
+    override fun isStaleFrameDroppingEnabled(): Boolean =
+        _isStaleFrameDroppingEnabledFlow.value
+
+    override fun toggleStaleFrameDropping() {
+        coroutineScope.launch {
+            dataSource.toggleStaleFrameDropping()
+        }
+    }
+
+    override fun isDetectionQualityTuningEnabled(): Boolean =
+        _isDetectionQualityTuningEnabledFlow.value
+
+    override fun toggleDetectionQualityTuning() {
+        coroutineScope.launch {
+            dataSource.toggleDetectionQualityTuning()
+        }
+    }
+
+    override fun isFirstHitMatchingEnabled(): Boolean =
+        _isFirstHitMatchingEnabledFlow.value
+
+    override fun toggleFirstHitMatching() {
+        coroutineScope.launch {
+            dataSource.toggleFirstHitMatching()
+        }
+    }
+
+    override fun isLearnedAreaMatchingEnabled(): Boolean =
+        _isLearnedAreaMatchingEnabledFlow.value
+
+    override fun toggleLearnedAreaMatching() {
+        coroutineScope.launch {
+            dataSource.toggleLearnedAreaMatching()
+        }
+    }
+
+    override fun isIntegerScaleRatioEnabled(): Boolean =
+        _isIntegerScaleRatioEnabledFlow.value
+
+    override fun toggleIntegerScaleRatio() {
+        coroutineScope.launch {
+            dataSource.toggleIntegerScaleRatio()
+        }
+    }
+
+    override fun isConditionTimeBudgetEnabled(): Boolean =
+        _isConditionTimeBudgetEnabledFlow.value
+
+    override fun toggleConditionTimeBudget() {
+        coroutineScope.launch {
+            dataSource.toggleConditionTimeBudget()
+        }
+    }
+
+    override fun isPreciseDumbTimingEnabled(): Boolean =
+        _isPreciseDumbTimingEnabledFlow.value
+
+    override fun togglePreciseDumbTiming() {
+        coroutineScope.launch {
+            dataSource.togglePreciseDumbTiming()
+        }
+    }
+
+    override fun isGestureBatchingEnabled(): Boolean =
+        _isGestureBatchingEnabledFlow.value
+
+    override fun toggleGestureBatching() {
+        coroutineScope.launch {
+            dataSource.toggleGestureBatching()
+        }
+    }
+
+    override fun isActionsOverlapEnabled(): Boolean =
+        _isActionsOverlapEnabledFlow.value
+
+    override fun toggleActionsOverlap() {
+        coroutineScope.launch {
+            dataSource.toggleActionsOverlap()
+        }
+    }
+
+    override fun isDetectionGateEnabled(): Boolean =
+        _isDetectionGateEnabledFlow.value
+
+    override fun toggleDetectionGate() {
+        coroutineScope.launch {
+            dataSource.toggleDetectionGate()
+        }
+    }
+
+    override fun isGpuFrameGateEnabled(): Boolean =
+        _isGpuFrameGateEnabledFlow.value
+
+    override fun toggleGpuFrameGate() {
+        coroutineScope.launch {
+            dataSource.toggleGpuFrameGate()
+        }
+    }
+
+    override fun isScreenChangeWaitEnabled(): Boolean =
+        _isScreenChangeWaitEnabledFlow.value
+
+    override fun toggleScreenChangeWait() {
+        coroutineScope.launch {
+            dataSource.toggleScreenChangeWait()
+        }
+    }
+
+    override fun isFrameAllocatorEnabled(): Boolean =
+        _isFrameAllocatorEnabledFlow.value
+
+    override fun toggleFrameAllocator() {
+        coroutineScope.launch {
+            dataSource.toggleFrameAllocator()
+        }
+    }
+
+    override fun isConditionPrefilterEnabled(): Boolean =
+        _isConditionPrefilterEnabledFlow.value
+
+    override fun toggleConditionPrefilter() {
+        coroutineScope.launch {
+            dataSource.toggleConditionPrefilter()
+        }
+    }
 }
\ No newline at end of file
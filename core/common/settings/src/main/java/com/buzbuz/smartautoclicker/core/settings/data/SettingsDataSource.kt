@@ -53,6 +53,84 @@ internal class SettingsDataSource @Inject constructor(
             booleanPreferencesKey("forceEntireScreen")
         val KEY_INPUT_BLOCK_WORKAROUND: Preferences.Key<Boolean> =
             booleanPreferencesKey("inputBlockWorkaround")
+        val KEY_PYRAMID_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("pyramidMatching")
+        val KEY_MULTI_SCALE_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("multiScaleMatching")
+        val KEY_HISTOGRAM_COLOR_VERIFICATION: Preferences.Key<Boolean> =
+            booleanPreferencesKey("histogramColorVerification")
+        val KEY_SCALED_COLOR_VERIFICATION: Preferences.Key<Boolean> =
+            booleanPreferencesKey("scaledColorVerification")
+        val KEY_DOWNSCALED_CAPTURE: Preferences.Key<Boolean> =
+            booleanPreferencesKey("downscaledCapture")
+        val KEY_INTEGER_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("integerMatching")
+        val KEY_SPARSE_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("sparseMatching")
+        val KEY_BINARY_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("binaryMatching")
+        val KEY_CHAMFER_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("chamferMatching")
+        val KEY_MOTION_COMPENSATION: Preferences.Key<Boolean> =
+            booleanPreferencesKey("motionCompensation")
+        val KEY_ROTATED_READER: Preferences.Key<Boolean> =
+            booleanPreferencesKey("rotatedReader")
+        val KEY_IDLE_CONDITIONS_COMPACTION: Preferences.Key<Boolean> =
+            booleanPreferencesKey("idleConditionsCompaction")
+        val KEY_TRIGGER_ONLY_CAPTURE_PAUSE: Preferences.Key<Boolean> =
+            booleanPreferencesKey("triggerOnlyCapturePause")
+        val KEY_NATIVE_SCREEN_READER: Preferences.Key<Boolean> =
+            booleanPreferencesKey("nativeScreenReader")
+        val KEY_ANIMATED_AREAS_EXCLUSION: Preferences.Key<Boolean> =
+            booleanPreferencesKey("animatedAreasExclusion")
+        val KEY_SYSTEM_BARS_EXCLUSION: Preferences.Key<Boolean> =
+            booleanPreferencesKey("systemBarsExclusion")
+        val KEY_SCREEN_STATES_GATING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("screenStatesGating")
+        val KEY_GPU_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("gpu_matching")
+        val KEY_NNAPI_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("nnapi_matching")
+        val KEY_ADAPTIVE_FRAME_PACING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("adaptive_frame_pacing")
+        val KEY_THERMAL_QUALITY_SCALING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("thermal_quality_scaling")
+        val KEY_PERFORMANCE_THREADS: Preferences.Key<Boolean> =
+            booleanPreferencesKey("performance_threads")
+        val KEY_DETECTOR_MEMORY_BUDGET: Preferences.Key<Boolean> =
+            booleanPreferencesKey("detector_memory_budget")
+        val KEY_DETECTION_CAPTURE: Preferences.Key<Boolean> =
+            booleanPreferencesKey("detection_capture")
+        val KEY_SPECULATIVE_EVENTS: Preferences.Key<Boolean> =
+            booleanPreferencesKey("speculative_events")
+        val KEY_STALE_FRAME_DROPPING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("stale_frame_dropping")
+        val KEY_DETECTION_QUALITY_TUNING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("detection_quality_tuning")
+        val KEY_FIRST_HIT_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("first_hit_matching")
+        val KEY_LEARNED_AREA_MATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("learned_area_matching")
+        val KEY_INTEGER_SCALE_RATIO: Preferences.Key<Boolean> =
+            booleanPreferencesKey("integer_scale_ratio")
+        val KEY_CONDITION_TIME_BUDGET: Preferences.Key<Boolean> =
+            booleanPreferencesKey("condition_time_budget")
+        val KEY_PRECISE_DUMB_TIMING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("precise_dumb_timing")
+        val KEY_GESTURE_BATCHING: Preferences.Key<Boolean> =
+            booleanPreferencesKey("gesture_batching")
+        val KEY_ACTIONS_OVERLAP: Preferences.Key<Boolean> =
+            booleanPreferencesKey("actions_overlap")
+        val KEY_DETECTION_GATE: Preferences.Key<Boolean> =
+            booleanPreferencesKey("detection_gate")
+        val KEY_GPU_FRAME_GATE: Preferences.Key<Boolean> =
+            booleanPreferencesKey("gpu_frame_gate")
+        val KEY_SCREEN_CHANGE_WAIT: Preferences.Key<Boolean> =
+            booleanPreferencesKey("screen_change_wait")
+        val KEY_FRAME_ALLOCATOR: Preferences.Key<Boolean> =
+            booleanPreferencesKey("frame_allocator")
+        val KEY_CONDITION_PREFILTER: Preferences.Key<Boolean> =
+            booleanPreferencesKey("condition_prefilter")
     }
 
     private val dataStore: PreferencesDataStore =
@@ -104,4 +182,316 @@ internal class SettingsDataSource @Inject constructor(
             preferences[KEY_INPUT_BLOCK_WORKAROUND] = !(preferences[KEY_INPUT_BLOCK_WORKAROUND] ?: isImpactedByInputBlock())
         }
     }
+
+    internal fun isPyramidMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_PYRAMID_MATCHING] ?: false }
+
+    internal suspend fun togglePyramidMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_PYRAMID_MATCHING] = !(preferences[KEY_PYRAMID_MATCHING] ?: false)
+        }
+
+    internal fun isMultiScaleMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_MULTI_SCALE_MATCHING] ?: false }
+
+    internal suspend fun toggleMultiScaleMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_MULTI_SCALE_MATCHING] = !(preferences[KEY_MULTI_SCALE_MATCHING] ?: false)
+        }
+
+    internal fun isHistogramColorVerificationEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_HISTOGRAM_COLOR_VERIFICATION] ?: false }
+
+    internal suspend fun toggleHistogramColorVerification() =
+        dataStore.edit { preferences ->
+            preferences[KEY_HISTOGRAM_COLOR_VERIFICATION] = !(preferences[KEY_HISTOGRAM_COLOR_VERIFICATION] ?: false)
+        }
+
+    internal fun isScaledColorVerificationEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_SCALED_COLOR_VERIFICATION] ?: false }
+
+    internal suspend fun toggleScaledColorVerification() =
+        dataStore.edit { preferences ->
+            preferences[KEY_SCALED_COLOR_VERIFICATION] = !(preferences[KEY_SCALED_COLOR_VERIFICATION] ?: false)
+        }
+
+    internal fun isDownscaledCaptureEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_DOWNSCALED_CAPTURE] ?: false }
+
+    internal suspend fun toggleDownscaledCapture() =
+        dataStore.edit { preferences ->
+            preferences[KEY_DOWNSCALED_CAPTURE] = !(preferences[KEY_DOWNSCALED_CAPTURE] ?: false)
+        }
+
+    internal fun isIntegerMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_INTEGER_MATCHING] ?: false }
+
+    internal suspend fun toggleIntegerMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_INTEGER_MATCHING] = !(preferences[KEY_INTEGER_MATCHING] ?: false)
+        }
+
+    internal fun isSparseMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_SPARSE_MATCHING] ?: false }
+
+    internal suspend fun toggleSparseMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_SPARSE_MATCHING] = !(preferences[KEY_SPARSE_MATCHING] ?: false)
+        }
+
+    internal fun isBinaryMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_BINARY_MATCHING] ?: false }
+
+    internal suspend fun toggleBinaryMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_BINARY_MATCHING] = !(preferences[KEY_BINARY_MATCHING] ?: false)
+        }
+
+    internal fun isChamferMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_CHAMFER_MATCHING] ?: false }
+
+    internal suspend fun toggleChamferMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_CHAMFER_MATCHING] = !(preferences[KEY_CHAMFER_MATCHING] ?: false)
+        }
+
+    internal fun isMotionCompensationEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_MOTION_COMPENSATION] ?: false }
+
+    internal suspend fun toggleMotionCompensation() =
+        dataStore.edit { preferences ->
+            preferences[KEY_MOTION_COMPENSATION] = !(preferences[KEY_MOTION_COMPENSATION] ?: false)
+        }
+
+    internal fun isRotatedReaderEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_ROTATED_READER] ?: false }
+
+    internal suspend fun toggleRotatedReader() =
+        dataStore.edit { preferences ->
+            preferences[KEY_ROTATED_READER] = !(preferences[KEY_ROTATED_READER] ?: false)
+        }
+
+    internal fun isIdleConditionsCompactionEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_IDLE_CONDITIONS_COMPACTION] ?: false }
+
+    internal suspend fun toggleIdleConditionsCompaction() =
+        dataStore.edit { preferences ->
+            preferences[KEY_IDLE_CONDITIONS_COMPACTION] = !(preferences[KEY_IDLE_CONDITIONS_COMPACTION] ?: false)
+        }
+
+    internal fun isTriggerOnlyCapturePauseEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_TRIGGER_ONLY_CAPTURE_PAUSE] ?: false }
+
+    internal suspend fun toggleTriggerOnlyCapturePause() =
+        dataStore.edit { preferences ->
+            preferences[KEY_TRIGGER_ONLY_CAPTURE_PAUSE] = !(preferences[KEY_TRIGGER_ONLY_CAPTURE_PAUSE] ?: false)
+        }
+
+    internal fun isNativeScreenReaderEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_NATIVE_SCREEN_READER] ?: false }
+
+    internal suspend fun toggleNativeScreenReader() =
+        dataStore.edit { preferences ->
+            preferences[KEY_NATIVE_SCREEN_READER] = !(preferences[KEY_NATIVE_SCREEN_READER] ?: false)
+        }
+
+    internal fun isAnimatedAreasExclusionEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_ANIMATED_AREAS_EXCLUSION] ?: false }
+
+    internal suspend fun toggleAnimatedAreasExclusion() =
+        dataStore.edit { preferences ->
+            preferences[KEY_ANIMATED_AREAS_EXCLUSION] = !(preferences[KEY_ANIMATED_AREAS_EXCLUSION] ?: false)
+        }
+
+    internal fun isSystemBarsExclusionEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_SYSTEM_BARS_EXCLUSION] ?: true }
+
+    internal suspend fun toggleSystemBarsExclusion() =
+        dataStore.edit { preferences ->
+            preferences[KEY_SYSTEM_BARS_EXCLUSION] = !(preferences[KEY_SYSTEM_BARS_EXCLUSION] ?: true)
+        }
+
+    internal fun isScreenStatesGatingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_SCREEN_STATES_GATING] ?: false }
+
+    internal suspend fun toggleScreenStatesGating() =
+        dataStore.edit { preferences ->
+            preferences[KEY_SCREEN_STATES_GATING] = !(preferences[KEY_SCREEN_STATES_GATING] ?: false)
+        }
+
+    internal fun isGpuMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_GPU_MATCHING] ?: false }
+
+    internal suspend fun toggleGpuMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_GPU_MATCHING] = !(preferences[KEY_GPU_MATCHING] ?: false)
+        }
+
+    internal fun isNnapiMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_NNAPI_MATCHING] ?: false }
+
+    internal suspend fun toggleNnapiMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_NNAPI_MATCHING] = !(preferences[KEY_NNAPI_MATCHING] ?: false)
+        }
+
+    internal fun isAdaptiveFramePacingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_ADAPTIVE_FRAME_PACING] ?: false }
+
+    internal suspend fun toggleAdaptiveFramePacing() =
+        dataStore.edit { preferences ->
+            preferences[KEY_ADAPTIVE_FRAME_PACING] = !(preferences[KEY_ADAPTIVE_FRAME_PACING] ?: false)
+        }
+
+    internal fun isThermalQualityScalingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_THERMAL_QUALITY_SCALING] ?: false }
+
+    internal suspend fun toggleThermalQualityScaling() =
+        dataStore.edit { preferences ->
+            preferences[KEY_THERMAL_QUALITY_SCALING] = !(preferences[KEY_THERMAL_QUALITY_SCALING] ?: false)
+        }
+
+    internal fun isPerformanceThreadsEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_PERFORMANCE_THREADS] ?: false }
+
+    internal suspend fun togglePerformanceThreads() =
+        dataStore.edit { preferences ->
+            preferences[KEY_PERFORMANCE_THREADS] = !(preferences[KEY_PERFORMANCE_THREADS] ?: false)
+        }
+
+    internal fun isDetectorMemoryBudgetEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_DETECTOR_MEMORY_BUDGET] ?: false }
+
+    internal suspend fun toggleDetectorMemoryBudget() =
+        dataStore.edit { preferences ->
+            preferences[KEY_DETECTOR_MEMORY_BUDGET] = !(preferences[KEY_DETECTOR_MEMORY_BUDGET] ?: false)
+        }
+
+    internal fun isDetectionCaptureEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_DETECTION_CAPTURE] ?: false }
+
+    internal suspend fun toggleDetectionCapture() =
+        dataStore.edit { preferences ->
+            preferences[KEY_DETECTION_CAPTURE] = !(preferences[KEY_DETECTION_CAPTURE] ?: false)
+        }
+
+    internal fun isSpeculativeEventsEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_SPECULATIVE_EVENTS] ?: false }
+
+    internal suspend fun toggleSpeculativeEvents() =
+        dataStore.edit { preferences ->
+            preferences[KEY_SPECULATIVE_EVENTS] = !(preferences[KEY_SPECULATIVE_EVENTS] ?: false)
+        }
+
+    internal fun isStaleFrameDroppingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_STALE_FRAME_DROPPING] ?: false }
+
+    internal suspend fun toggleStaleFrameDropping() =
+        dataStore.edit { preferences ->
+            preferences[KEY_STALE_FRAME_DROPPING] = !(preferences[KEY_STALE_FRAME_DROPPING] ?: false)
+        }
+
+    internal fun isDetectionQualityTuningEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_DETECTION_QUALITY_TUNING] ?: false }
+
+    internal suspend fun toggleDetectionQualityTuning() =
+        dataStore.edit { preferences ->
+            preferences[KEY_DETECTION_QUALITY_TUNING] = !(preferences[KEY_DETECTION_QUALITY_TUNING] ?: false)
+        }
+
+    internal fun isFirstHitMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_FIRST_HIT_MATCHING] ?: false }
+
+    internal suspend fun toggleFirstHitMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_FIRST_HIT_MATCHING] = !(preferences[KEY_FIRST_HIT_MATCHING] ?: false)
+        }
+
+    internal fun isLearnedAreaMatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_LEARNED_AREA_MATCHING] ?: false }
+
+    internal suspend fun toggleLearnedAreaMatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_LEARNED_AREA_MATCHING] = !(preferences[KEY_LEARNED_AREA_MATCHING] ?: false)
+        }
+
+    internal fun isIntegerScaleRatioEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_INTEGER_SCALE_RATIO] ?: false }
+
+    internal suspend fun toggleIntegerScaleRatio() =
+        dataStore.edit { preferences ->
+            preferences[KEY_INTEGER_SCALE_RATIO] = !(preferences[KEY_INTEGER_SCALE_RATIO] ?: false)
+        }
+
+    internal fun isConditionTimeBudgetEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_CONDITION_TIME_BUDGET] ?: false }
+
+    internal suspend fun toggleConditionTimeBudget() =
+        dataStore.edit { preferences ->
+            preferences[KEY_CONDITION_TIME_BUDGET] = !(preferences[KEY_CONDITION_TIME_BUDGET] ?: false)
+        }
+
+    internal fun isPreciseDumbTimingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_PRECISE_DUMB_TIMING] ?: false }
+
+    internal suspend fun togglePreciseDumbTiming() =
+        dataStore.edit { preferences ->
+            preferences[KEY_PRECISE_DUMB_TIMING] = !(preferences[KEY_PRECISE_DUMB_TIMING] ?: false)
+        }
+
+    internal fun isGestureBatchingEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_GESTURE_BATCHING] ?: false }
+
+    internal suspend fun toggleGestureBatching() =
+        dataStore.edit { preferences ->
+            preferences[KEY_GESTURE_BATCHING] = !(preferences[KEY_GESTURE_BATCHING] ?: false)
+        }
+
+    internal fun isActionsOverlapEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_ACTIONS_OVERLAP] ?: false }
+
+    internal suspend fun toggleActionsOverlap() =
+        dataStore.edit { preferences ->
+            preferences[KEY_ACTIONS_OVERLAP] = !(preferences[KEY_ACTIONS_OVERLAP] ?: false)
+        }
+
+    internal fun isDetectionGateEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_DETECTION_GATE] ?: false }
+
+    internal suspend fun toggleDetectionGate() =
+        dataStore.edit { preferences ->
+            preferences[KEY_DETECTION_GATE] = !(preferences[KEY_DETECTION_GATE] ?: false)
+        }
+
+    internal fun isGpuFrameGateEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_GPU_FRAME_GATE] ?: false }
+
+    internal suspend fun toggleGpuFrameGate() =
+        dataStore.edit { preferences ->
+            preferences[KEY_GPU_FRAME_GATE] = !(preferences[KEY_GPU_FRAME_GATE] ?: false)
+        }
+
+    internal fun isScreenChangeWaitEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_SCREEN_CHANGE_WAIT] ?: false }
+
+    internal suspend fun toggleScreenChangeWait() =
+        dataStore.edit { preferences ->
+            preferences[KEY_SCREEN_CHANGE_WAIT] = !(preferences[KEY_SCREEN_CHANGE_WAIT] ?: false)
+        }
+
+    internal fun isFrameAllocatorEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_FRAME_ALLOCATOR] ?: false }
+
+    internal suspend fun toggleFrameAllocator() =
+        dataStore.edit { preferences ->
+            preferences[KEY_FRAME_ALLOCATOR] = !(preferences[KEY_FRAME_ALLOCATOR] ?: false)
+        }
+
+    internal fun isConditionPrefilterEnabled(): Flow<Boolean> =
+        dataStore.data.map { preferences -> preferences[KEY_CONDITION_PREFILTER] ?: false }
+
+    internal suspend fun toggleConditionPrefilter() =
+        dataStore.edit { preferences ->
+            preferences[KEY_CONDITION_PREFILTER] = !(preferences[KEY_CONDITION_PREFILTER] ?: false)
+        }
 }
\ No newline at end of file
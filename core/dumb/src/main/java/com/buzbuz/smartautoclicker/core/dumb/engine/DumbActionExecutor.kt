@@ -21,6 +21,7 @@ import android.graphics.Path
 import android.util.Log
 
 import com.buzbuz.smartautoclicker.core.base.AndroidExecutor
+import com.buzbuz.smartautoclicker.core.base.extensions.GestureSequenceBuilder
 import com.buzbuz.smartautoclicker.core.base.extensions.buildSingleStroke
 import com.buzbuz.smartautoclicker.core.base.extensions.nextIntInOffset
 import com.buzbuz.smartautoclicker.core.base.extensions.nextLongInOffset
@@ -29,16 +30,17 @@ import com.buzbuz.smartautoclicker.core.base.extensions.safeMoveTo
 import com.buzbuz.smartautoclicker.core.base.workarounds.UnblockGestureScheduler
 import com.buzbuz.smartautoclicker.core.base.workarounds.buildUnblockGesture
 import com.buzbuz.smartautoclicker.core.dumb.domain.model.DumbAction
-import com.buzbuz.smartautoclicker.core.dumb.domain.model.Repeatable
+import com.buzbuz.smartautoclicker.core.dumb.domain.model.RepeatableWithDelay
 
 import kotlinx.coroutines.Dispatchers
-import kotlinx.coroutines.delay
 import kotlinx.coroutines.withContext
 import kotlin.random.Random
 
 internal class DumbActionExecutor(
     private val androidExecutor: AndroidExecutor,
+    private val timeline: DumbActionTimeline,
     unblockWorkaroundEnabled: Boolean,
+    gestureBatchingEnabled: Boolean = false,
 ) {
 
     private val random: Random = Random(System.currentTimeMillis())
@@ -48,6 +50,11 @@ internal class DumbActionExecutor(
         if (unblockWorkaroundEnabled) UnblockGestureScheduler()
         else null
 
+    /** Coalesces the repetitions of a gesture into a single dispatch, null if batching is disabled. */
+    private val gestureSequenceBuilder: GestureSequenceBuilder? =
+        if (gestureBatchingEnabled) GestureSequenceBuilder(MAX_BATCHED_GESTURE_DURATION_MS)
+        else null
+
 
     suspend fun onScenarioLoopFinished() {
         if (unblockGestureScheduler?.shouldTrigger() == true) {
@@ -70,37 +77,71 @@ internal class DumbActionExecutor(
     }
 
     private suspend fun executeDumbClick(dumbClick: DumbAction.DumbClick) {
-        val clickGesture = GestureDescription.Builder().buildSingleStroke(
+        executeRepeatableGesture(
             path = Path().apply { moveTo(dumbClick.position.x, dumbClick.position.y) },
             durationMs = dumbClick.pressDurationMs.randomizeDurationIfNeeded(),
+            repeatable = dumbClick,
         )
-
-        executeRepeatableGesture(clickGesture, dumbClick)
     }
 
     private suspend fun executeDumbSwipe(dumbSwipe: DumbAction.DumbSwipe) {
-        val swipeGesture = GestureDescription.Builder().buildSingleStroke(
+        executeRepeatableGesture(
             path = Path().apply {
                 moveTo(dumbSwipe.fromPosition.x, dumbSwipe.fromPosition.y)
                 lineTo(dumbSwipe.toPosition.x, dumbSwipe.toPosition.y)
             },
             durationMs = dumbSwipe.swipeDurationMs.randomizeDurationIfNeeded(),
+            repeatable = dumbSwipe,
         )
-
-        executeRepeatableGesture(swipeGesture, dumbSwipe)
     }
 
     private suspend fun executeDumbPause(dumbPause: DumbAction.DumbPause) {
-        delay(dumbPause.pauseDurationMs.randomizeDurationIfNeeded())
+        timeline.pause(dumbPause.pauseDurationMs.randomizeDurationIfNeeded())
+    }
+
+    private suspend fun executeRepeatableGesture(path: Path, durationMs: Long, repeatable: RepeatableWithDelay) {
+        if (gestureSequenceBuilder != null && (repeatable.isRepeatInfinite || repeatable.repeatCount > 1)) {
+            executeBatchedRepeatableGesture(gestureSequenceBuilder, path, durationMs, repeatable)
+            return
+        }
+
+        val gesture = GestureDescription.Builder().buildSingleStroke(path, durationMs)
+        repeatable.repeat(timeline) {
+            timeline.onGesture(durationMs)
+            withContext(Dispatchers.Main) {
+                androidExecutor.executeGesture(gesture)
+            }
+        }
     }
 
-    private suspend fun executeRepeatableGesture(gesture: GestureDescription, repeatable: Repeatable) {
-        repeatable.repeat {
+    /**
+     * Execute the repetitions of a gesture by batches of strokes, each one separated by the repeat delay, instead of
+     * waiting for the completion of each repetition before dispatching the next one.
+     */
+    private suspend fun executeBatchedRepeatableGesture(
+        builder: GestureSequenceBuilder,
+        path: Path,
+        durationMs: Long,
+        repeatable: RepeatableWithDelay,
+    ) {
+        var remainingCount = repeatable.repeatCount
+        while (repeatable.isRepeatInfinite || remainingCount > 0) {
+            do {
+                builder.add(path, durationMs, repeatable.repeatDelayMs)
+                if (!repeatable.isRepeatInfinite) remainingCount--
+            } while ((repeatable.isRepeatInfinite || remainingCount > 0)
+                && builder.canAdd(durationMs, repeatable.repeatDelayMs))
+
+            timeline.onGesture(builder.durationMs)
+            val gesture = builder.build()
             withContext(Dispatchers.Main) {
                 androidExecutor.executeGesture(gesture)
             }
+
+            if (repeatable.repeatDelayMs > 0) timeline.pause(repeatable.repeatDelayMs)
         }
     }
+
     private fun Path.moveTo(x: Int, y: Int) {
         if (!randomize) safeMoveTo(x, y)
         else safeMoveTo(
@@ -125,5 +166,7 @@ internal class DumbActionExecutor(
 
 private const val RANDOMIZATION_POSITION_MAX_OFFSET_PX = 5
 private const val RANDOMIZATION_DURATION_MAX_OFFSET_MS = 5L
+/** Bounds the time a batched gesture keeps being executed after the scenario is stopped. */
+private const val MAX_BATCHED_GESTURE_DURATION_MS = 1_000L
 
 private const val TAG = "DumbActionExecutor"
\ No newline at end of file
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.dumb.engine
+
+import com.buzbuz.smartautoclicker.core.base.addDumpTabulationLvl
+
+import kotlinx.coroutines.delay
+
+import java.io.PrintWriter
+import java.util.concurrent.locks.LockSupport
+import kotlin.math.sqrt
+
+/**
+ * Paces the dumb actions on absolute deadlines of the monotonic clock.
+ *
+ * Each gesture and pause advances the deadline by its expected duration instead of waiting from the current time, so
+ * the dispatch overhead of the gestures and the wake up latency of the waits are absorbed by the next pause rather
+ * than accumulating over the repetitions. When the actions are late by more than the next pause, the timeline is
+ * re-based on the current time instead of chaining the actions without any pause to catch up.
+ *
+ * @param preciseWait true to finish the waits by parking the current thread. This should only be used when the
+ * actions are executed on a dedicated thread, as it blocks it for the last milliseconds of each wait.
+ */
+internal class DumbActionTimeline(private val preciseWait: Boolean) {
+
+    /** The statistics on the wake up latency of the waits. */
+    val jitter: JitterStatistics = JitterStatistics()
+
+    /** The monotonic time the current action is expected to end at, in nanoseconds. */
+    private var deadlineNs: Long = System.nanoTime()
+
+    /** Re-base the timeline on the current time. Must be called when the actions execution starts. */
+    fun start() {
+        deadlineNs = System.nanoTime()
+        jitter.reset()
+    }
+
+    /** Notify the timeline of a gesture expected to last [durationMs] after the end of the previous action. */
+    fun onGesture(durationMs: Long) {
+        deadlineNs += durationMs.msToNs()
+    }
+
+    /** Wait for [durationMs] after the end of the previous action, compensating its lateness. */
+    suspend fun pause(durationMs: Long) {
+        deadlineNs += durationMs.msToNs()
+
+        var remainingNs = deadlineNs - System.nanoTime()
+        if (remainingNs <= 0) {
+            jitter.onDeadlineMissed()
+            deadlineNs -= remainingNs
+            return
+        }
+
+        val coarseWaitNs = if (preciseWait) remainingNs - PRECISE_WAIT_WINDOW_NS else remainingNs
+        if (coarseWaitNs > 0) delay((coarseWaitNs + NS_PER_MS - 1) / NS_PER_MS)
+
+        if (preciseWait) {
+            remainingNs = deadlineNs - System.nanoTime()
+            while (remainingNs > 0) {
+                LockSupport.parkNanos(remainingNs)
+                remainingNs = deadlineNs - System.nanoTime()
+            }
+        }
+
+        jitter.onWakeUp(System.nanoTime() - deadlineNs)
+    }
+
+    private fun Long.msToNs(): Long = this * NS_PER_MS
+}
+
+/** Running statistics on the lateness of the timeline waits, in nanoseconds. */
+internal class JitterStatistics {
+
+    /** The number of waits that reached their deadline. */
+    var count: Long = 0L
+        private set
+    /** The number of waits skipped because the actions were already late. */
+    var missedCount: Long = 0L
+        private set
+    /** The worst lateness measured. */
+    var maxNs: Long = 0L
+        private set
+
+    private var meanNs: Double = 0.0
+    private var squaredDeviationSum: Double = 0.0
+
+    fun reset() {
+        count = 0L
+        missedCount = 0L
+        maxNs = 0L
+        meanNs = 0.0
+        squaredDeviationSum = 0.0
+    }
+
+    internal fun onDeadlineMissed() {
+        missedCount++
+    }
+
+    internal fun onWakeUp(latenessNs: Long) {
+        count++
+        if (latenessNs > maxNs) maxNs = latenessNs
+
+        val delta = latenessNs - meanNs
+        meanNs += delta / count
+        squaredDeviationSum += delta * (latenessNs - meanNs)
+    }
+
+    fun meanUs(): Double = meanNs / NS_PER_US
+    fun stdDevUs(): Double = if (count > 1) sqrt(squaredDeviationSum / (count - 1)) / NS_PER_US else 0.0
+    fun maxUs(): Double = maxNs.toDouble() / NS_PER_US
+
+    override fun toString(): String =
+        "waits=$count; missed=$missedCount; mean=%.1fus; stdDev=%.1fus; max=%.1fus"
+            .format(meanUs(), stdDevUs(), maxUs())
+
+    fun dump(writer: PrintWriter, prefix: CharSequence) {
+        writer.append(prefix.addDumpTabulationLvl()).append("- jitter: ").println(toString())
+    }
+}
+
+/** The duration before the deadline finished by parking the thread in precise mode. */
+private const val PRECISE_WAIT_WINDOW_NS = 2_000_000L
+private const val NS_PER_MS = 1_000_000L
+private const val NS_PER_US = 1_000.0
@@ -16,6 +16,7 @@
  */
 package com.buzbuz.smartautoclicker.core.dumb.engine
 
+import android.os.Process
 import android.util.Log
 
 import com.buzbuz.smartautoclicker.core.base.AndroidExecutor
@@ -28,8 +29,10 @@ import com.buzbuz.smartautoclicker.core.settings.SettingsRepository
 
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.ExecutorCoroutineDispatcher
 import kotlinx.coroutines.ExperimentalCoroutinesApi
 import kotlinx.coroutines.Job
+import kotlinx.coroutines.asCoroutineDispatcher
 import kotlinx.coroutines.cancel
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.flow.Flow
@@ -41,6 +44,7 @@ import kotlinx.coroutines.launch
 import kotlin.time.Duration.Companion.minutes
 
 import java.io.PrintWriter
+import java.util.concurrent.Executors
 import javax.inject.Inject
 import javax.inject.Singleton
 
@@ -53,6 +57,10 @@ class DumbEngine @Inject constructor(
 
     /** Execute the dumb actions. */
     private var dumbActionExecutor: DumbActionExecutor? = null
+    /** Paces the dumb actions on absolute deadlines. */
+    private var dumbActionTimeline: DumbActionTimeline? = null
+    /** Dedicated high priority thread executing the actions, if precise timing is enabled. */
+    private var timerDispatcher: ExecutorCoroutineDispatcher? = null
 
     /** Coroutine scope for the dumb scenario processing. */
     private var processingScope: CoroutineScope? = null
@@ -74,7 +82,17 @@ class DumbEngine @Inject constructor(
     val isRunning: StateFlow<Boolean> = _isRunning
 
     fun init(androidExecutor: AndroidExecutor, dumbScenario: DumbScenario) {
-        dumbActionExecutor = DumbActionExecutor(androidExecutor, settingsRepository.isInputBlockWorkaroundEnabled())
+        val preciseTiming = settingsRepository.isPreciseDumbTimingEnabled()
+        timerDispatcher?.close()
+        timerDispatcher = if (preciseTiming) newTimerDispatcher() else null
+        dumbActionTimeline = DumbActionTimeline(preciseWait = preciseTiming).also { timeline ->
+            dumbActionExecutor = DumbActionExecutor(
+                androidExecutor = androidExecutor,
+                timeline = timeline,
+                unblockWorkaroundEnabled = settingsRepository.isInputBlockWorkaroundEnabled(),
+                gestureBatchingEnabled = settingsRepository.isGestureBatchingEnabled(),
+            )
+        }
         dumbScenarioDbId.value = dumbScenario.id.databaseId
 
         processingScope = CoroutineScope(Dispatchers.IO)
@@ -105,7 +123,7 @@ class DumbEngine @Inject constructor(
         if (!isRunning.value) return
         _isRunning.value = false
 
-        Log.d(TAG, "stopDumbScenario")
+        Log.d(TAG, "stopDumbScenario, timing ${dumbActionTimeline?.jitter}")
 
         timeoutJob?.cancel()
         timeoutJob = null
@@ -124,6 +142,9 @@ class DumbEngine @Inject constructor(
         processingScope = null
 
         dumbActionExecutor = null
+        dumbActionTimeline = null
+        timerDispatcher?.close()
+        timerDispatcher = null
     }
 
     private fun startEngine(scenario: DumbScenario) {
@@ -145,7 +166,8 @@ class DumbEngine @Inject constructor(
         }
 
     private fun startScenarioExecutionJob(dumbScenario: DumbScenario): Job? =
-        processingScope?.launch {
+        processingScope?.launch(timerDispatcher ?: Dispatchers.IO) {
+            dumbActionTimeline?.start()
             dumbScenario.repeat {
                 dumbScenario.dumbActions.forEach { dumbAction ->
                     dumbActionExecutor?.executeDumbAction(dumbAction, dumbScenario.randomize)
@@ -168,7 +190,19 @@ class DumbEngine @Inject constructor(
                 .append("isRunning=${isRunning.value}; ")
                 .println()
         }
+        dumbActionTimeline?.jitter?.dump(writer, prefix)
     }
 }
 
+/** Creates the dispatcher of the thread dedicated to the dumb actions pacing. */
+private fun newTimerDispatcher(): ExecutorCoroutineDispatcher =
+    Executors.newSingleThreadScheduledExecutor { runnable ->
+        Thread({
+            Process.setThreadPriority(Process.THREAD_PRIORITY_DISPLAY)
+            runnable.run()
+        }, TIMER_THREAD_NAME)
+    }.asCoroutineDispatcher()
+
+private const val TIMER_THREAD_NAME = "DumbActionTimer"
+
 private const val TAG = "DumbEngine"
\ No newline at end of file
@@ -20,22 +20,32 @@ import com.buzbuz.smartautoclicker.core.dumb.domain.model.Repeatable
 import com.buzbuz.smartautoclicker.core.dumb.domain.model.RepeatableWithDelay
 import kotlinx.coroutines.delay
 
-internal suspend fun Repeatable.repeat(action: suspend () -> Unit): Unit =
+/**
+ * Repeat the [action] according to this [Repeatable] configuration.
+ *
+ * @param timeline the timeline pacing the repeat delays on absolute deadlines. If null, the delays are waited from the
+ * end of each action.
+ */
+internal suspend fun Repeatable.repeat(
+    timeline: DumbActionTimeline? = null,
+    action: suspend () -> Unit,
+): Unit =
     when {
         isRepeatInfinite -> while (true) {
             action()
-            delayNextActionIfNeeded()
+            delayNextActionIfNeeded(timeline)
         }
         repeatCount > 0 -> repeat(repeatCount) {
             action()
-            delayNextActionIfNeeded()
+            delayNextActionIfNeeded(timeline)
         }
         else -> Unit
     }
 
-private suspend fun Repeatable.delayNextActionIfNeeded() {
+private suspend fun Repeatable.delayNextActionIfNeeded(timeline: DumbActionTimeline?) {
     if (this !is RepeatableWithDelay) return
     if (repeatDelayMs == 0L) return
 
-    delay(repeatDelayMs)
+    if (timeline != null) timeline.pause(repeatDelayMs)
+    else delay(repeatDelayMs)
 }
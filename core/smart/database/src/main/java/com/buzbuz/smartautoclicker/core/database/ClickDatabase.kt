@@ -50,9 +50,15 @@ import javax.inject.Singleton
         AutoMigration (from = 13, to = 14),
         AutoMigration (from = 14, to = 15),
         AutoMigration (from = 15, to = 16),
+        AutoMigration (from = 16, to = 17),
+        AutoMigration (from = 17, to = 18),
+        AutoMigration (from = 18, to = 19),
+        AutoMigration (from = 19, to = 20),
+        AutoMigration (from = 20, to = 21),
+        AutoMigration (from = 21, to = 22),
     ]
 )
 abstract class ClickDatabase : ScenarioDatabase()
 
 /** Current version of the database. */
-const val CLICK_DATABASE_VERSION = 16
\ No newline at end of file
+const val CLICK_DATABASE_VERSION = 22
\ No newline at end of file
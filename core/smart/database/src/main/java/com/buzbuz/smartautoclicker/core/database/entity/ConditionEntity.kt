@@ -49,6 +49,21 @@ import kotlinx.serialization.Serializable
  * @param detectionType the type of detection. Can be any of the values defined in
  *                      [com.buzbuz.smartautoclicker.domain.DetectionType].
  * @param shouldBeDetected true if this condition should be detected to be true, false if it should not be found.
+ * @param rotationCount the number of orientations the condition is searched at, null or 1 for its own one only.
+ * @param matchingMetric the similarity measured for the condition, null for the correlation. Can be any of the values
+ *                       defined in [com.buzbuz.smartautoclicker.core.domain.model.MatchingMetric].
+ * @param isTextInArea true if the name of the condition is searched in the text of its detection area, without its
+ *                     bitmap. Only for the IN_AREA detection type, null for false.
+ * @param isFeatureMatching true if the condition is detected with its feature points instead of its pixels, null for
+ *                          false.
+ * @param anchorConditionId the identifier of the image condition of the same event locating this one, null for none.
+ *                          Not a foreign key: the referenced condition is saved with this one, and a reference to a
+ *                          removed condition is ignored.
+ * @param anchorAreaLeft the left coordinate of the area to detect the condition in, relative to the center of its
+ *                       anchor detection. Null if there is no anchor.
+ * @param anchorAreaTop the top coordinate of the area relative to the anchor. Null if there is no anchor.
+ * @param anchorAreaRight the right coordinate of the area relative to the anchor. Null if there is no anchor.
+ * @param anchorAreaBottom the bottom coordinate of the area relative to the anchor. Null if there is no anchor.
  */
 @Entity(
     tableName = CONDITION_TABLE,
@@ -81,6 +96,15 @@ data class ConditionEntity(
     @ColumnInfo(name = "detection_area_top") val detectionAreaTop: Int? = null,
     @ColumnInfo(name = "detection_area_right") val detectionAreaRight: Int? = null,
     @ColumnInfo(name = "detection_area_bottom") val detectionAreaBottom: Int? = null,
+    @ColumnInfo(name = "rotation_count") val rotationCount: Int? = null,
+    @ColumnInfo(name = "matching_metric") val matchingMetric: Int? = null,
+    @ColumnInfo(name = "text_in_area") val isTextInArea: Boolean? = null,
+    @ColumnInfo(name = "feature_matching") val isFeatureMatching: Boolean? = null,
+    @ColumnInfo(name = "anchor_condition_id") val anchorConditionId: Long? = null,
+    @ColumnInfo(name = "anchor_area_left") val anchorAreaLeft: Int? = null,
+    @ColumnInfo(name = "anchor_area_top") val anchorAreaTop: Int? = null,
+    @ColumnInfo(name = "anchor_area_right") val anchorAreaRight: Int? = null,
+    @ColumnInfo(name = "anchor_area_bottom") val anchorAreaBottom: Int? = null,
 
     // ConditionType.ON_BROADCAST_RECEIVED
     @ColumnInfo(name = "broadcast_action") val broadcastAction: String? = null,
@@ -53,6 +53,10 @@ import kotlinx.serialization.Serializable
  *                       enabled via an action TOGGLE_EVENT to be evaluated.
  * @param keepDetecting only for [EventType.IMAGE_EVENT]. If true, keep interpreting the next events in the list with
  *                      the current screen frame. If false, stops and start over the event list with the next frame.
+ * @param detectionFrameInterval only for [EventType.IMAGE_EVENT]. The number of screen frames between two detections
+ *                               of this event, null or 1 to detect it on every frame.
+ * @param detectionMinIntervalMs only for [EventType.IMAGE_EVENT]. The minimum duration in milliseconds between two
+ *                               detections of this event, null or 0 for none.
  */
 @Entity(
     tableName = EVENT_TABLE,
@@ -74,6 +78,8 @@ data class EventEntity(
     @ColumnInfo(name = "enabled_on_start", defaultValue="1") var enabledOnStart: Boolean = true,
     @ColumnInfo(name = "type") val type: EventType,
     @ColumnInfo(name = "keep_detecting") val keepDetecting: Boolean? = null,
+    @ColumnInfo(name = "detection_frame_interval") val detectionFrameInterval: Int? = null,
+    @ColumnInfo(name = "detection_min_interval_ms") val detectionMinIntervalMs: Long? = null,
 ) : EntityWithId
 
 /**
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.database.migrations
+
+import android.os.Build
+
+import androidx.room.testing.MigrationTestHelper
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+
+import com.buzbuz.smartautoclicker.core.database.ClickDatabase
+import com.buzbuz.smartautoclicker.core.database.entity.EventType
+import com.buzbuz.smartautoclicker.core.database.utils.assertColumnEquals
+import com.buzbuz.smartautoclicker.core.database.utils.assertColumnNull
+import com.buzbuz.smartautoclicker.core.database.utils.assertCountEquals
+
+import org.junit.Rule
+import org.junit.Test
+import org.junit.runner.RunWith
+import org.robolectric.annotation.Config
+
+/** Tests the auto migration from 16 to 17, adding the detection intervals to the events. */
+@RunWith(AndroidJUnit4::class)
+@Config(sdk = [Build.VERSION_CODES.Q])
+class Migration16to17Tests {
+
+    private companion object {
+        private const val TEST_DB = "migration-test"
+
+        private const val OLD_DB_VERSION = 16
+        private const val NEW_DB_VERSION = 17
+
+        private const val EVENT_ID = 12L
+        private const val SCENARIO_ID = 2L
+        private const val EVENT_NAME = "toto"
+        private const val EVENT_OPERATOR = 1
+        private const val EVENT_PRIORITY = 3
+    }
+
+    @get:Rule
+    val helper: MigrationTestHelper = MigrationTestHelper(
+        InstrumentationRegistry.getInstrumentation(),
+        ClickDatabase::class.java,
+    )
+
+    @Test
+    fun migrate_event_detection_intervals() {
+        // Insert in v16 and close
+        helper.createDatabase(TEST_DB, OLD_DB_VERSION).use { dbV16 ->
+            dbV16.execSQL(
+                """
+                    INSERT INTO event_table (id, scenario_id, name, operator, priority, enabled_on_start, type, keep_detecting)
+                    VALUES ($EVENT_ID, $SCENARIO_ID, "$EVENT_NAME", $EVENT_OPERATOR, $EVENT_PRIORITY, 1, "${EventType.IMAGE_EVENT}", 1)
+                """.trimIndent()
+            )
+        }
+
+        // Migrate to v17 and verify
+        helper.runMigrationsAndValidate(TEST_DB, NEW_DB_VERSION, true).use { dbV17 ->
+            dbV17.query("SELECT * FROM event_table").use { cursor ->
+                cursor.assertCountEquals(1)
+                cursor.moveToFirst()
+
+                cursor.assertColumnEquals(EVENT_ID, "id")
+                cursor.assertColumnEquals(SCENARIO_ID, "scenario_id")
+                cursor.assertColumnEquals(EVENT_NAME, "name")
+                cursor.assertColumnEquals(EVENT_OPERATOR, "operator")
+                cursor.assertColumnEquals(EVENT_PRIORITY, "priority")
+                cursor.assertColumnEquals(true, "enabled_on_start")
+                cursor.assertColumnEquals(EventType.IMAGE_EVENT, "type")
+                cursor.assertColumnEquals(true, "keep_detecting")
+                cursor.assertColumnNull("detection_frame_interval")
+                cursor.assertColumnNull("detection_min_interval_ms")
+            }
+        }
+    }
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.database.migrations
+
+import android.os.Build
+
+import androidx.room.testing.MigrationTestHelper
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.platform.app.InstrumentationRegistry
+
+import com.buzbuz.smartautoclicker.core.database.ClickDatabase
+import com.buzbuz.smartautoclicker.core.database.entity.ConditionType
+import com.buzbuz.smartautoclicker.core.database.utils.assertColumnEquals
+import com.buzbuz.smartautoclicker.core.database.utils.assertColumnNull
+import com.buzbuz.smartautoclicker.core.database.utils.assertCountEquals
+
+import org.junit.Rule
+import org.junit.Test
+import org.junit.runner.RunWith
+import org.robolectric.annotation.Config
+
+/** Tests the auto migration from 20 to 21, adding the feature matching flag to the conditions. */
+@RunWith(AndroidJUnit4::class)
+@Config(sdk = [Build.VERSION_CODES.Q])
+class Migration20to21Tests {
+
+    private companion object {
+        private const val TEST_DB = "migration-test"
+
+        private const val OLD_DB_VERSION = 20
+        private const val NEW_DB_VERSION = 21
+
+        private const val CONDITION_ID = 12L
+        private const val EVENT_ID = 2L
+        private const val CONDITION_NAME = "toto"
+        private const val CONDITION_PATH = "/toto/tutu"
+        private const val CONDITION_THRESHOLD = 4
+        private const val CONDITION_DETECTION_TYPE = 2
+    }
+
+    @get:Rule
+    val helper: MigrationTestHelper = MigrationTestHelper(
+        InstrumentationRegistry.getInstrumentation(),
+        ClickDatabase::class.java,
+    )
+
+    @Test
+    fun migrate_condition_feature_matching() {
+        // Insert in v20 and close
+        helper.createDatabase(TEST_DB, OLD_DB_VERSION).use { dbV20 ->
+            dbV20.execSQL(
+                """
+                    INSERT INTO condition_table (id, eventId, name, type, priority, path, area_left, area_top, area_right, area_bottom, threshold, detection_type, shouldBeDetected)
+                    VALUES ($CONDITION_ID, $EVENT_ID, "$CONDITION_NAME", "${ConditionType.ON_IMAGE_DETECTED}", 0, "$CONDITION_PATH", 1, 2, 3, 4, $CONDITION_THRESHOLD, $CONDITION_DETECTION_TYPE, 1)
+                """.trimIndent()
+            )
+        }
+
+        // Migrate to v21 and verify
+        helper.runMigrationsAndValidate(TEST_DB, NEW_DB_VERSION, true).use { dbV21 ->
+            dbV21.query("SELECT * FROM condition_table").use { cursor ->
+                cursor.assertCountEquals(1)
+                cursor.moveToFirst()
+
+                cursor.assertColumnEquals(CONDITION_ID, "id")
+                cursor.assertColumnEquals(EVENT_ID, "eventId")
+                cursor.assertColumnEquals(CONDITION_NAME, "name")
+                cursor.assertColumnEquals(ConditionType.ON_IMAGE_DETECTED, "type")
+                cursor.assertColumnEquals(CONDITION_PATH, "path")
+                cursor.assertColumnEquals(CONDITION_THRESHOLD, "threshold")
+                cursor.assertColumnEquals(CONDITION_DETECTION_TYPE, "detection_type")
+                cursor.assertColumnEquals(true, "shouldBeDetected")
+                cursor.assertColumnNull("feature_matching")
+            }
+        }
+    }
+}
@@ -20,8 +20,12 @@ plugins {
     alias(libs.plugins.buzbuz.androidLibrary)
     alias(libs.plugins.buzbuz.androidLocalTest)
     alias(libs.plugins.buzbuz.sourceDownload)
+    alias(libs.plugins.buzbuz.buildParameters)
 }
 
+// Build Tesseract and Leptonica from sources and link them into the native library, instead of the prebuilts
+val isTesseractFromSource = buildParameters["detectionTesseractFromSource"].asBoolean()
+
 sourceDownload {
     projects {
         register("openCv") {
@@ -32,16 +36,52 @@ sourceDownload {
             unzipPath = File("src/release/opencv")
             requiredForTask = "configureCMakeRelease"
         }
+        if (isTesseractFromSource) {
+            register("leptonica") {
+                projectAccount = "DanBloomberg"
+                projectName = "leptonica"
+                projectVersion = libs.versions.leptonicaSources.get()
+
+                unzipPath = File("src/release/leptonica")
+                requiredForTask = "configureCMake"
+            }
+            register("tesseract") {
+                projectAccount = "tesseract-ocr"
+                projectName = "tesseract"
+                projectVersion = libs.versions.tesseractSources.get()
+
+                unzipPath = File("src/release/tesseract")
+                requiredForTask = "configureCMake"
+            }
+        }
     }
 }
 
+// Execution profile of the detection used by the release native build, see generateNativeDetectionProfile
+val nativeProfile = File(projectDir, "src/pgo/detection.profdata")
+val isNativeProfileGeneration = buildParameters["detectionNativePgoGenerate"].asBoolean()
+val isNativeProfileUsed = !isNativeProfileGeneration && !buildParameters["disableNativePgo"].asBoolean()
+        && nativeProfile.exists()
+
 android {
     namespace = "com.buzbuz.smartautoclicker.core.detection"
 
+    // Allows to run the instrumented tests and benchmarks against the release native build
+    testBuildType = buildParameters["detectionTestBuildType"].asString() ?: "debug"
+
     defaultConfig {
         externalNativeBuild {
             cmake {
-
+                // Build the native detector benchmark executable, see src/benchmark/run_detector_benchmark.sh
+                arguments("-DSMART_DETECTION_BENCHMARK=${if (buildParameters["detectionNativeBenchmark"].asBoolean()) "ON" else "OFF"}")
+                // Instrument the native detection with trace sections and counters, see src/main/cpp/utils/trace.hpp
+                arguments("-DSMART_DETECTION_TRACING=${if (buildParameters["detectionNativeTracing"].asBoolean()) "ON" else "OFF"}")
+                // Build the Vulkan compute backend of the template matching, see src/main/cpp/gpu/vulkan_matcher.hpp
+                arguments("-DSMART_DETECTION_VULKAN=${if (buildParameters["detectionNativeVulkan"].asBoolean()) "ON" else "OFF"}")
+                // Build the NNAPI accelerator backend of the template matching, see src/main/cpp/gpu/nnapi_matcher.hpp
+                arguments("-DSMART_DETECTION_NNAPI=${if (buildParameters["detectionNativeNnapi"].asBoolean()) "ON" else "OFF"}")
+                // Link Tesseract and Leptonica built from sources into the native library
+                arguments("-DSMART_TESSERACT_FROM_SOURCE=${if (isTesseractFromSource) "ON" else "OFF"}")
             }
         }
     }
@@ -66,13 +106,12 @@ android {
                             "-DOPENCV_ENABLE_NONFREE=OFF",
                             "-DBUILD_opencv_ittnotify=OFF",
                             "-DBUILD_ITT=OFF",
-                            "-DCV_DISABLE_OPTIMIZATION=ON",
+                            "-DSMART_OPENCV_OPTIMIZED=${if (buildParameters["disableOpenCvOptimizations"].asBoolean()) "OFF" else "ON"}",
                             "-DWITH_CUDA=OFF",
                             "-DWITH_OPENCL=OFF",
                             "-DWITH_OPENCLAMDFFT=OFF",
                             "-DWITH_OPENCLAMDBLAS=OFF",
                             "-DWITH_VA_INTEL=OFF",
-                            "-DCPU_BASELINE_DISABLE=ON",
                             "-DENABLE_SSE=OFF",
                             "-DENABLE_SSE2=OFF",
                             "-DBUILD_TESTING=OFF",
@@ -105,7 +144,9 @@ android {
                             "-DBUILD_JAVA=OFF",
                             "-DBUILD_ANDROID_EXAMPLES=OFF",
                             "-DBUILD_ANDROID_PROJECTS=OFF",
-                            "-DBUILD_SHARED_LIBS=ON"
+                            "-DSMART_NATIVE_LTO=${if (buildParameters["disableNativeLto"].asBoolean()) "OFF" else "ON"}",
+                            "-DSMART_NATIVE_PGO_GENERATE=${if (isNativeProfileGeneration) "ON" else "OFF"}",
+                            "-DSMART_NATIVE_PGO_PROFILE=${if (isNativeProfileUsed) nativeProfile.absolutePath else ""}"
                     )
                 }
             }
@@ -119,7 +160,31 @@ android {
     }
 }
 
+// Record the execution profile of the detection by replaying a detection capture with the instrumented library:
+// ./gradlew :core:smart:detection:generateNativeDetectionProfile -PdetectionNativePgoGenerate=true \
+//     -PdetectionNativeBenchmark=true -PdetectionPgoCapture=<path to detection_capture.kdrc>
+tasks.register<Exec>("generateNativeDetectionProfile") {
+    group = "build"
+    description = "Record the execution profile used by the profile guided optimization of the native detection."
+    dependsOn("externalNativeBuildRelease")
+
+    val capture = buildParameters["detectionPgoCapture"].asString()
+    doFirst {
+        if (!isNativeProfileGeneration || !buildParameters["detectionNativeBenchmark"].asBoolean() || capture == null)
+            throw GradleException("Profile generation requires -PdetectionNativePgoGenerate=true " +
+                    "-PdetectionNativeBenchmark=true and -PdetectionPgoCapture=<capture path>")
+        environment("ANDROID_NDK", android.ndkDirectory.absolutePath)
+    }
+
+    environment("PGO", "1")
+    environment("SKIP_BUILD", "1")
+    environment("CAPTURE", capture ?: "")
+    environment("PGO_PROFILE", nativeProfile.absolutePath)
+    commandLine("sh", File(projectDir, "src/benchmark/run_detector_benchmark.sh").absolutePath, "Release")
+}
+
 dependencies {
     implementation(libs.androidx.annotation)
-    implementation(libs.tesseract)
+    // Only provides the shared libraries of Tesseract and Leptonica, not needed when they are linked statically
+    if (!isTesseractFromSource) implementation(libs.tesseract)
 }
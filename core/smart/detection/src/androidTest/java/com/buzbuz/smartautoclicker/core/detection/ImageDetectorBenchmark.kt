@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.os.Build
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.filters.LargeTest
+import androidx.test.platform.app.InstrumentationRegistry
+import com.buzbuz.smartautoclicker.core.detection.data.DetectionResolution
+import com.buzbuz.smartautoclicker.core.detection.data.TestImage
+import com.buzbuz.smartautoclicker.core.detection.utils.EnergySampler
+import com.buzbuz.smartautoclicker.core.detection.utils.loadTestBitmap
+import com.buzbuz.smartautoclicker.core.detection.utils.setScreenMetrics
+import org.junit.After
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.io.File
+
+/**
+ * Measure the time spent by the native detector on the test images.
+ *
+ * Run it against both OpenCV builds to compare them:
+ * ./gradlew :core:smart:detection:connectedAndroidTest -PdetectionTestBuildType=release
+ * ./gradlew :core:smart:detection:connectedAndroidTest -PdetectionTestBuildType=release -PdisableOpenCvOptimizations=true
+ *
+ * The native library loading and the first detection are only cold for the first test of the process, compare the
+ * link time optimized library with the regular one by running [benchmarkLibraryLoadAndFirstDetection] alone:
+ * ./gradlew :core:smart:detection:connectedAndroidTest -PdetectionTestBuildType=release \
+ *     -Pandroid.testInstrumentationRunnerArguments.class=com.buzbuz.smartautoclicker.core.detection.ImageDetectorBenchmark#benchmarkLibraryLoadAndFirstDetection
+ * ./gradlew :core:smart:detection:connectedAndroidTest -PdetectionTestBuildType=release -PdisableNativeLto=true \
+ *     -Pandroid.testInstrumentationRunnerArguments.class=com.buzbuz.smartautoclicker.core.detection.ImageDetectorBenchmark#benchmarkLibraryLoadAndFirstDetection
+ *
+ * The same way, compare the Tesseract prebuilts with Tesseract built from sources and linked in the library by adding
+ * -PdetectionTesseractFromSource=true. The native libraries size includes the prebuilts shared libraries, if any.
+ *
+ * The energy per detection is reported by [benchmarkScreen1Condition1FullScreen] when the device is unplugged, run it
+ * over adb wifi with the screen on and the other applications closed.
+ */
+@LargeTest
+@RunWith(AndroidJUnit4::class)
+class ImageDetectorBenchmark {
+
+    private companion object {
+        /** Allow to always returns the best match, even if not up to standards. */
+        private const val TEST_DETECTION_THRESHOLD_ALL = 100
+        /** Identifier of the condition for the detector template cache. */
+        private const val TEST_CONDITION_ID = 1L
+
+        /** Number of detections executed before measuring, to get the caches and cpu frequency up. */
+        private const val WARMUP_ITERATIONS = 5
+        /** Number of measured detections per resolution. */
+        private const val MEASURED_ITERATIONS = 30
+        /** Number of detections per resolution for the energy measure, long enough for the battery current updates. */
+        private const val ENERGY_ITERATIONS = 200
+        /** Duration of the measure of the idle device power, subtracted from the energy of the detections. */
+        private const val IDLE_POWER_DURATION_MS = 3000L
+
+        /** Time of the first detector instantiation of the process, including the loading of the native library. */
+        private var firstInstantiationTimeNs: Long? = null
+    }
+
+    private lateinit var context: Context
+    private lateinit var testedDetector: ImageDetector
+
+    @Before
+    fun setUp() {
+        context = InstrumentationRegistry.getInstrumentation().targetContext
+
+        val instantiationStartTimeNs = System.nanoTime()
+        testedDetector = NativeDetector.newInstance() ?:
+            throw IllegalStateException("Can't instantiate detector for benchmark")
+        if (firstInstantiationTimeNs == null) firstInstantiationTimeNs = System.nanoTime() - instantiationStartTimeNs
+
+        testedDetector.init()
+    }
+
+    @After
+    fun tearDown() {
+        testedDetector.close()
+    }
+
+    @Test
+    fun benchmarkScreen1Condition1FullScreen() {
+        val screenBitmap = context.loadTestBitmap(TestImage.Screen.TutorialWithTarget)
+        val conditionBitmap = context.loadTestBitmap(TestImage.Condition.TutorialTargetBlue)
+
+        val energySampler = EnergySampler(context)
+        energySampler.measureIdlePower(IDLE_POWER_DURATION_MS)
+
+        println("---------- Detection benchmark START (${Build.SUPPORTED_ABIS.first()}) ----------  ")
+        DetectionResolution.entries.forEach { resolution ->
+            testedDetector.setScreenMetrics(screenBitmap, resolution.value)
+
+            repeat(WARMUP_ITERATIONS) { testedDetector.detect(screenBitmap, conditionBitmap) }
+            val setupTimesNs = LongArray(MEASURED_ITERATIONS)
+            val detectionTimesNs = LongArray(MEASURED_ITERATIONS)
+            repeat(MEASURED_ITERATIONS) { i ->
+                testedDetector.detect(screenBitmap, conditionBitmap) { setupTimeNs, detectionTimeNs ->
+                    setupTimesNs[i] = setupTimeNs
+                    detectionTimesNs[i] = detectionTimeNs
+                }
+            }
+
+            println("$resolution(${resolution.value}): " +
+                    "setup median=${setupTimesNs.medianMs()}ms; detection median=${detectionTimesNs.medianMs()}ms; " +
+                    "detection min=${detectionTimesNs.min().toMs()}ms; detection max=${detectionTimesNs.max().toMs()}ms")
+
+            if (!energySampler.isAvailable) return@forEach
+            val energyMj = energySampler.measure {
+                repeat(ENERGY_ITERATIONS) { testedDetector.detect(screenBitmap, conditionBitmap) }
+            } ?: return@forEach
+            val detectionEnergyMj = "%.3f".format(energyMj / ENERGY_ITERATIONS)
+            println("$resolution(${resolution.value}): energy=${detectionEnergyMj}mJ/detection")
+        }
+        println("---------- Detection benchmark END ----------  ")
+    }
+
+    @Test
+    fun benchmarkLibraryLoadAndFirstDetection() {
+        val screenBitmap = context.loadTestBitmap(TestImage.Screen.TutorialWithTarget)
+        val conditionBitmap = context.loadTestBitmap(TestImage.Condition.TutorialTargetBlue)
+        val library = File(context.applicationInfo.nativeLibraryDir, "libsmartautoclicker.so")
+
+        testedDetector.setScreenMetrics(screenBitmap, DetectionResolution.AVERAGE.value)
+        var firstSetupTimeNs = 0L
+        var firstDetectionTimeNs = 0L
+        testedDetector.detect(screenBitmap, conditionBitmap) { setupTimeNs, detectionTimeNs ->
+            firstSetupTimeNs = setupTimeNs
+            firstDetectionTimeNs = detectionTimeNs
+        }
+
+        println("---------- Library load benchmark (${Build.SUPPORTED_ABIS.first()}) ----------  ")
+        val librariesSize = File(context.applicationInfo.nativeLibraryDir).listFiles()?.sumOf { it.length() } ?: 0L
+        println("library size=${library.length() / 1024}KiB; native libraries size=${librariesSize / 1024}KiB; " +
+                "first instantiation=${firstInstantiationTimeNs?.toMs()}ms; " +
+                "first setup=${firstSetupTimeNs.toMs()}ms; first detection=${firstDetectionTimeNs.toMs()}ms")
+    }
+
+    private inline fun ImageDetector.detect(
+        screenBitmap: Bitmap,
+        conditionBitmap: Bitmap,
+        onMeasured: (setupTimeNs: Long, detectionTimeNs: Long) -> Unit = { _, _ -> },
+    ) {
+        val startTimeNs = System.nanoTime()
+        setupDetection(screenBitmap)
+        val setupEndTimeNs = System.nanoTime()
+        detectCondition(TEST_CONDITION_ID, conditionBitmap, TEST_DETECTION_THRESHOLD_ALL)
+        val endTimeNs = System.nanoTime()
+
+        onMeasured(setupEndTimeNs - startTimeNs, endTimeNs - setupEndTimeNs)
+    }
+
+    private fun LongArray.medianMs(): String =
+        sorted()[size / 2].toMs()
+
+    private fun Long.toMs(): String =
+        "%.2f".format(this / 1_000_000.0)
+}
@@ -18,16 +18,24 @@ package com.buzbuz.smartautoclicker.core.detection
 
 import android.content.Context
 import android.graphics.Point
+import android.os.SystemClock
 import androidx.test.ext.junit.runners.AndroidJUnit4
 import androidx.test.filters.LargeTest
 import androidx.test.platform.app.InstrumentationRegistry
 import com.buzbuz.smartautoclicker.core.detection.data.ActualDetectionResults
+import com.buzbuz.smartautoclicker.core.detection.data.DetectionCorpus
+import com.buzbuz.smartautoclicker.core.detection.data.DetectionResolution
 import com.buzbuz.smartautoclicker.core.detection.data.TestImage
 import com.buzbuz.smartautoclicker.core.detection.data.isValid
+import com.buzbuz.smartautoclicker.core.detection.data.loadDetectionCorpus
 import com.buzbuz.smartautoclicker.core.detection.utils.loadTestBitmap
+import com.buzbuz.smartautoclicker.core.detection.utils.scrolledUp
 import com.buzbuz.smartautoclicker.core.detection.utils.setScreenMetrics
 import org.junit.After
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertNotEquals
 import org.junit.Assert.assertTrue
+import org.junit.Assume.assumeTrue
 import org.junit.Before
 import org.junit.Test
 import org.junit.runner.RunWith
@@ -40,8 +48,39 @@ class ImageDetectorTests {
     private companion object {
         /** Allow to always returns the best match, even if not up to standards. */
         private const val TEST_DETECTION_THRESHOLD_ALL = 100
+        /** Identifier of the condition for the detector template cache. */
+        private const val TEST_CONDITION_ID = 1L
+        /** The threshold of the corpus detections, the not detected samples must be rejected with it. */
+        private const val CORPUS_DETECTION_THRESHOLD = 10
+        /** The scroll of the screen between the two detections of the motion compensation test, in pixels. */
+        private const val TEST_SCROLL_OFFSET = 96
+        /** The quality of the corpus detections, the sweep of the native benchmark measures the other ones. */
+        private val CORPUS_DETECTION_QUALITY = DetectionResolution.AVERAGE
     }
 
+    /** The matching modes compared on the detection corpus, enabled on a new detector. */
+    private enum class CorpusMatchingMode(val enable: ImageDetector.() -> Boolean) {
+        DEFAULT({ true }),
+        PYRAMID({ setPyramidMatchingEnabled(true); true }),
+        SPARSE({ setSparseMatchingEnabled(true); true }),
+        BINARY({ setBinaryMatchingEnabled(true); true }),
+        CHAMFER({ setChamferMatchingEnabled(true); true }),
+        INTEGER({ setIntegerMatchingEnabled(true); true }),
+        // Only on the builds and devices with the Vulkan compute support or a NNAPI accelerator
+        GPU({ setGpuMatchingEnabled(true) }),
+        NNAPI({ setNnapiMatchingEnabled(true) }),
+    }
+
+    /** The results of the detection corpus with a matching mode. */
+    private data class CorpusModeResults(
+        val mode: CorpusMatchingMode,
+        val validCount: Int,
+        val detectedCount: Int,
+        val meanConfidence: Double,
+        val medianDurationMs: Double,
+        val matchBackends: Set<MatchBackendType>,
+    )
+
     private lateinit var context: Context
     private lateinit var testedDetector: ImageDetector
 
@@ -76,6 +115,228 @@ class ImageDetectorTests {
         results.verify()
     }
 
+    @Test
+    fun verifyScreen1Condition1FullScreenIntegerMatching() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        testedDetector.setIntegerMatchingEnabled(true)
+
+        // When
+        val results = testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        results.verify()
+    }
+
+    @Test
+    fun verifyScreen1Condition1FullScreenGpuMatching() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        // Only on the builds and devices with the Vulkan compute support
+        assumeTrue(testedDetector.setGpuMatchingEnabled(true))
+
+        // When
+        val results = testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        results.verify()
+    }
+
+    @Test
+    fun verifyScreen1Condition1FullScreenNnapiMatching() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        // Only on the builds and devices with a NNAPI accelerator
+        assumeTrue(testedDetector.setNnapiMatchingEnabled(true))
+
+        // When
+        val results = testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        results.verify()
+    }
+
+    @Test
+    fun verifyScreen1Condition1FullScreenSparseMatching() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        testedDetector.setSparseMatchingEnabled(true)
+
+        // When
+        val results = testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        results.verify()
+    }
+
+    @Test
+    fun verifyScreen1Condition1FullScreenBinaryMatching() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        testedDetector.setBinaryMatchingEnabled(true)
+
+        // When
+        val results = testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        results.verify()
+    }
+
+    @Test
+    fun verifyScreen1Condition1FullScreenChamferMatching() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        testedDetector.setChamferMatchingEnabled(true)
+
+        // When
+        val results = testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        results.verify()
+    }
+
+    @Test
+    fun verifyScreen1Condition1ScrolledScreenMotionCompensation() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+        val expectedResults = conditionImage.expectedResults.getValue(screenImage)
+        val (quality, expectedConfidence) = expectedResults.resultsForQualities.entries.first()
+        val screenBitmap = context.loadTestBitmap(screenImage)
+        val conditionBitmap = context.loadTestBitmap(conditionImage)
+        testedDetector.setMotionCompensationEnabled(true)
+        testedDetector.setScreenMetrics(screenBitmap, quality.value)
+
+        // When
+        testedDetector.setupDetection(screenBitmap)
+        testedDetector.detectCondition(TEST_CONDITION_ID, conditionBitmap, TEST_DETECTION_THRESHOLD_ALL)
+        testedDetector.setupDetection(screenBitmap.scrolledUp(TEST_SCROLL_OFFSET))
+        val results = testedDetector.detectCondition(TEST_CONDITION_ID, conditionBitmap, TEST_DETECTION_THRESHOLD_ALL)
+
+        // Then
+        listOf(
+            ActualDetectionResults(
+                resolution = quality,
+                expectedCenterPosition = Point(
+                    expectedResults.centerPosition.x,
+                    expectedResults.centerPosition.y - TEST_SCROLL_OFFSET,
+                ),
+                actualCenterPosition = Point(results.position),
+                expectedConfidence = expectedConfidence,
+                actualConfidence = results.confidenceRate,
+            )
+        ).verify()
+    }
+
+    @Test
+    fun verifyConditionStatisticsMatchBackend() {
+        // Given
+        val screenImage = TestImage.Screen.TutorialWithTarget
+        val conditionImage = TestImage.Condition.TutorialTargetBlue
+
+        // When
+        testedDetector.executeImageDetectionTest(
+            screenImage = screenImage,
+            conditionImage = conditionImage,
+            threshold = TEST_DETECTION_THRESHOLD_ALL,
+        )
+
+        // Then
+        val statistics = testedDetector.getConditionStatistics().first { it.conditionId == TEST_CONDITION_ID }
+        assertNotEquals(MatchBackendType.NONE, statistics.matchBackend)
+    }
+
+    @Test
+    fun verifyDetectionCorpusMatchingModes() {
+        // Given
+        val corpus = context.loadDetectionCorpus()
+
+        // When
+        val results = CorpusMatchingMode.entries.mapNotNull { mode -> executeCorpusDetectionTest(corpus, mode) }
+
+        // Then
+        results.verify(corpus)
+    }
+
+    /** @return the results of the corpus with a new detector in a matching mode, null if it is not available. */
+    private fun executeCorpusDetectionTest(corpus: DetectionCorpus, mode: CorpusMatchingMode): CorpusModeResults? {
+        val detector = NativeDetector.newInstance() ?:
+            throw IllegalStateException("Can't instantiate detector for tests")
+
+        try {
+            detector.init()
+            if (!mode.enable(detector)) return null
+
+            var validCount = 0
+            var detectedCount = 0
+            var confidenceSum = 0.0
+            val durationsNs = mutableListOf<Long>()
+            corpus.samples.forEachIndexed { index, sample ->
+                val screenBitmap = context.loadTestBitmap(sample.screen)
+                val conditionBitmap = context.loadTestBitmap(sample.condition)
+                detector.setScreenMetrics(screenBitmap, CORPUS_DETECTION_QUALITY.value)
+                detector.setupDetection(screenBitmap)
+
+                // A new condition for each sample, its processing is measured as in the first detection of a scenario
+                val startNs = SystemClock.elapsedRealtimeNanos()
+                val result = detector.detectCondition(index + 1L, conditionBitmap, CORPUS_DETECTION_THRESHOLD)
+                durationsNs.add(SystemClock.elapsedRealtimeNanos() - startNs)
+
+                val isValid = sample.isValid(result.isDetected, result.position, result.confidenceRate)
+                if (isValid) validCount++
+                if (result.isDetected) {
+                    detectedCount++
+                    confidenceSum += result.confidenceRate
+                }
+                println("$mode ${sample.screen.name}/${sample.condition.name}: Detected=${result.isDetected}/" +
+                        "${sample.isDetected}; Confidence=${result.confidenceRate}/[${sample.minConfidence}, " +
+                        "${sample.maxConfidence}]; Position=${result.position}/${sample.centerPosition}; " +
+                        "isValid=$isValid")
+            }
+
+            return CorpusModeResults(
+                mode = mode,
+                validCount = validCount,
+                detectedCount = detectedCount,
+                meanConfidence = if (detectedCount > 0) confidenceSum / detectedCount else 0.0,
+                medianDurationMs = durationsNs.sorted()[durationsNs.size / 2] / 1_000_000.0,
+                matchBackends = detector.getConditionStatistics().map { it.matchBackend }.toSet(),
+            )
+        } finally {
+            detector.close()
+        }
+    }
+
     private fun ImageDetector.executeImageDetectionTest(
         screenImage: TestImage.Screen,
         conditionImage: TestImage.Condition,
@@ -89,7 +350,7 @@ class ImageDetectorTests {
                 setScreenMetrics(screenBitmap, quality.value)
                 setupDetection(screenBitmap)
 
-                val results = detectCondition(conditionBitmap, threshold)
+                val results = detectCondition(TEST_CONDITION_ID, conditionBitmap, threshold)
                 add(ActualDetectionResults(
                     resolution = quality,
                     expectedCenterPosition = expectedResults.centerPosition,
@@ -101,6 +362,26 @@ class ImageDetectorTests {
         }
     } ?: emptyList()
 
+    /** Print the results of each mode side by side with the default one, and verify all are expected. */
+    private fun List<CorpusModeResults>.verify(corpus: DetectionCorpus) {
+        val reference = first { it.mode == CorpusMatchingMode.DEFAULT }
+        println("---------- Detection corpus v${corpus.version} results START ----------  ")
+        forEach { result ->
+            println("${result.mode}: Valid=${result.validCount}/${corpus.samples.size}; " +
+                    "Detected=${result.detectedCount} (${result.detectedCount - reference.detectedCount}); " +
+                    "Confidence=%.4f (%+.4f); ".format(result.meanConfidence,
+                        result.meanConfidence - reference.meanConfidence) +
+                    "Median=%.3fms (x%.2f); ".format(result.medianDurationMs,
+                        result.medianDurationMs / reference.medianDurationMs) +
+                    "Backends=${result.matchBackends}")
+        }
+        println("---------- Detection corpus v${corpus.version} results END ----------  ")
+
+        forEach { result ->
+            assertEquals("Detection corpus failed in mode ${result.mode}", corpus.samples.size, result.validCount)
+        }
+    }
+
     private fun List<ActualDetectionResults>.verify() {
         var globalResult = true
         println("---------- Detection results START ----------  ")
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import android.content.Context
+import android.graphics.Bitmap
+import android.graphics.Rect
+import android.os.Build
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import androidx.test.filters.LargeTest
+import androidx.test.platform.app.InstrumentationRegistry
+import com.buzbuz.smartautoclicker.core.detection.data.DetectionResolution
+import com.buzbuz.smartautoclicker.core.detection.data.TestImage
+import com.buzbuz.smartautoclicker.core.detection.utils.loadTestBitmap
+import com.buzbuz.smartautoclicker.core.detection.utils.setScreenMetrics
+import org.junit.After
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import java.nio.ByteBuffer
+
+/**
+ * Measure the fixed costs around the native detection, the ones that do not depend on the matching itself.
+ *
+ * The condition is searched at its exact position in a small area, as for the exact conditions, so the matching is
+ * as cheap as possible and the measures are mostly the crossing of the JNI. Each call channel is compared: a call per
+ * condition with its bitmap, a concurrent call without bitmap, and a batch of conditions with a single call.
+ *
+ * ./gradlew :core:smart:detection:connectedAndroidTest -PdetectionTestBuildType=release \
+ *     -Pandroid.testInstrumentationRunnerArguments.class=com.buzbuz.smartautoclicker.core.detection.JniOverheadBenchmark
+ */
+@LargeTest
+@RunWith(AndroidJUnit4::class)
+class JniOverheadBenchmark {
+
+    private companion object {
+        /** Allow to always returns the best match, so the batch is never short-circuited. */
+        private const val TEST_DETECTION_THRESHOLD_ALL = 100
+        /** Identifier of the condition for the detector template cache. */
+        private const val TEST_CONDITION_ID = 1L
+        /** Number of conditions in the measured batch, all the same one. */
+        private const val BATCH_SIZE = 8
+
+        /** Number of executions before measuring, to get the JIT, the caches and the cpu frequency up. */
+        private const val WARMUP_ITERATIONS = 200
+        /** Number of measured executions of each step. */
+        private const val MEASURED_ITERATIONS = 2000
+        /** Number of measured executions of the screen setup steps, copying the whole screen. */
+        private const val SCREEN_MEASURED_ITERATIONS = 30
+    }
+
+    private lateinit var context: Context
+    private lateinit var testedDetector: ImageDetector
+
+    private lateinit var screenBitmap: Bitmap
+    private lateinit var conditionBitmap: Bitmap
+    /** The exact area of the condition on the screen. */
+    private lateinit var conditionArea: Rect
+
+    @Before
+    fun setUp() {
+        context = InstrumentationRegistry.getInstrumentation().targetContext
+        testedDetector = NativeDetector.newInstance() ?:
+            throw IllegalStateException("Can't instantiate detector for benchmark")
+        testedDetector.init()
+
+        screenBitmap = context.loadTestBitmap(TestImage.Screen.TutorialWithTarget)
+        conditionBitmap = context.loadTestBitmap(TestImage.Condition.TutorialTargetBlue)
+        testedDetector.setScreenMetrics(screenBitmap, DetectionResolution.AVERAGE.value)
+        testedDetector.setupDetection(screenBitmap)
+
+        // Processed once here, the measured calls find it in the template cache
+        val center = testedDetector.detectCondition(TEST_CONDITION_ID, conditionBitmap, TEST_DETECTION_THRESHOLD_ALL)
+            .position
+        conditionArea = Rect(
+            center.x - conditionBitmap.width / 2,
+            center.y - conditionBitmap.height / 2,
+            center.x + (conditionBitmap.width + 1) / 2,
+            center.y + (conditionBitmap.height + 1) / 2,
+        )
+    }
+
+    @After
+    fun tearDown() {
+        testedDetector.close()
+    }
+
+    @Test
+    fun benchmarkJniOverhead() {
+        println("---------- JNI overhead benchmark START (${Build.SUPPORTED_ABIS.first()}) ----------  ")
+
+        // A native call without any work: the JNI transition, the detector lookup and the lifecycle lock
+        report("native call", measure { testedDetector.getFrameDelayMs() })
+        report("template cache lookup", measure { testedDetector.isConditionCached(TEST_CONDITION_ID) })
+
+        // The result is written in the result buffer and read back into the detector result
+        report("detect (per condition)", measure {
+            testedDetector.detectCondition(
+                TEST_CONDITION_ID, conditionBitmap, conditionArea, TEST_DETECTION_THRESHOLD_ALL)
+        })
+        report("detect (concurrent)", measure {
+            testedDetector.detectConditionConcurrently(TEST_CONDITION_ID, conditionArea, TEST_DETECTION_THRESHOLD_ALL)
+        })
+
+        val batch = DetectionBatch(BATCH_SIZE)
+        repeat(BATCH_SIZE) {
+            batch.add(TEST_CONDITION_ID, conditionBitmap, conditionArea, TEST_DETECTION_THRESHOLD_ALL, true)
+        }
+        report("detect (batch, per condition)", measure { testedDetector.detectConditions(batch) }, BATCH_SIZE)
+
+        // The copy kept by the callers of the single condition detections, the detector result being reused
+        val result = testedDetector.detectCondition(TEST_CONDITION_ID, conditionBitmap, TEST_DETECTION_THRESHOLD_ALL)
+        report("DetectionResult.copy", measure { result.copy() })
+
+        // The bitmap is locked and copied, the buffer is processed without copy
+        val screenBuffer = ByteBuffer.allocateDirect(screenBitmap.byteCount)
+        screenBitmap.copyPixelsToBuffer(screenBuffer)
+        report("setupDetection (bitmap)", measure(SCREEN_MEASURED_ITERATIONS) {
+            testedDetector.setupDetection(screenBitmap)
+        })
+        report("setupDetection (buffer)", measure(SCREEN_MEASURED_ITERATIONS) {
+            testedDetector.setupDetection(screenBuffer, screenBitmap.width, screenBitmap.height, screenBitmap.rowBytes)
+        })
+
+        println("---------- JNI overhead benchmark END ----------  ")
+    }
+
+    /** @return the duration of each measured execution of the step, in nanoseconds. */
+    private inline fun measure(iterations: Int = MEASURED_ITERATIONS, step: () -> Unit): LongArray {
+        repeat(minOf(WARMUP_ITERATIONS, iterations)) { step() }
+
+        return LongArray(iterations) {
+            val startTimeNs = System.nanoTime()
+            step()
+            System.nanoTime() - startTimeNs
+        }
+    }
+
+    /** Print the stats of a step, divided by the number of conditions it detects. */
+    private fun report(step: String, durationsNs: LongArray, conditionCount: Int = 1) {
+        val sortedDurationsNs = durationsNs.sorted()
+        println("$step: median=${sortedDurationsNs[sortedDurationsNs.size / 2].toUs(conditionCount)}us; " +
+                "min=${sortedDurationsNs.first().toUs(conditionCount)}us; " +
+                "p90=${sortedDurationsNs[sortedDurationsNs.size * 9 / 10].toUs(conditionCount)}us")
+    }
+
+    private fun Long.toUs(conditionCount: Int): String =
+        "%.2f".format(this / 1_000.0 / conditionCount)
+}
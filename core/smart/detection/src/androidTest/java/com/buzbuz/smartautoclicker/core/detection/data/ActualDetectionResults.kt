@@ -30,7 +30,11 @@ internal data class ActualDetectionResults(
 internal fun ActualDetectionResults.isValid(): Boolean =
     actualConfidence >= expectedConfidence && isCenterPositionValid(expectedCenterPosition, actualCenterPosition)
 
-private fun isCenterPositionValid(expected: Point, actual: Point, delta: Int = TOLERATED_SCALING_ERROR_PIXELS): Boolean =
+internal fun isCenterPositionValid(
+    expected: Point,
+    actual: Point,
+    delta: Int = TOLERATED_SCALING_ERROR_PIXELS,
+): Boolean =
     isCenterPositionValid(expected.x, actual.x, delta) && isCenterPositionValid(expected.y, actual.y, delta)
 
 private fun isCenterPositionValid(expected: Int, actual: Int, delta: Int) : Boolean =
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection.data
+
+import android.content.Context
+import android.graphics.Point
+import androidx.annotation.RawRes
+
+import com.buzbuz.smartautoclicker.core.detection.test.R
+
+/**
+ * The samples of the detection corpus, shared with the native benchmark sweep.
+ * Read from the manifest [R.raw.detection_corpus], see benchmark_corpus.hpp for its format.
+ *
+ * @param version the version of the expected results, to compare the reports measured on the same corpus only.
+ */
+internal data class DetectionCorpus(
+    val version: Int,
+    val samples: List<CorpusSample>,
+)
+
+/**
+ * A condition searched on a screen of the corpus, with its expected result.
+ * @param minConfidence the minimum expected confidence of the detected condition, between 0 and 1.
+ * @param maxConfidence the maximum expected confidence of the detected condition, between 0 and 1.
+ */
+internal data class CorpusSample(
+    val screen: CorpusImage,
+    val condition: CorpusImage,
+    val isDetected: Boolean,
+    val centerPosition: Point,
+    val minConfidence: Double,
+    val maxConfidence: Double,
+)
+
+/** A raw image of the corpus, named as in the manifest. */
+internal data class CorpusImage(
+    val name: String,
+    @RawRes val fileRes: Int,
+    val size: Point,
+)
+
+internal fun CorpusSample.isValid(isDetected: Boolean, centerPosition: Point, confidence: Double): Boolean =
+    when {
+        this.isDetected != isDetected -> false
+        !isDetected -> true
+        else -> confidence in minConfidence..maxConfidence && isCenterPositionValid(this.centerPosition, centerPosition)
+    }
+
+internal fun Context.loadDetectionCorpus(): DetectionCorpus {
+    var version = 1
+    val samples = mutableListOf<CorpusSample>()
+
+    resources.openRawResource(R.raw.detection_corpus).bufferedReader().useLines { lines ->
+        lines.forEachIndexed { index, line ->
+            if (line.isBlank() || line.startsWith('#')) return@forEachIndexed
+
+            val values = line.trim().split(Regex("\\s+"))
+            if (values.first() == CORPUS_VERSION_KEYWORD) {
+                version = values.getOrNull(1)?.toIntOrNull()
+                    ?: throw IllegalArgumentException("Invalid corpus version at line ${index + 1}")
+                return@forEachIndexed
+            }
+
+            samples.add(values.toCorpusSample()
+                ?: throw IllegalArgumentException("Invalid corpus sample at line ${index + 1}"))
+        }
+    }
+
+    return DetectionCorpus(version, samples)
+}
+
+private fun List<String>.toCorpusSample(): CorpusSample? {
+    if (size != CORPUS_SAMPLE_VALUES_COUNT && size != CORPUS_SAMPLE_VALUES_COUNT + 2) return null
+
+    return CorpusSample(
+        screen = toCorpusImage(0) ?: return null,
+        condition = toCorpusImage(3) ?: return null,
+        isDetected = get(6) == "1",
+        centerPosition = Point(get(7).toIntOrNull() ?: return null, get(8).toIntOrNull() ?: return null),
+        minConfidence = getOrNull(9)?.let { it.toDoubleOrNull() ?: return null } ?: 0.0,
+        maxConfidence = getOrNull(10)?.let { it.toDoubleOrNull() ?: return null } ?: 1.0,
+    )
+}
+
+/** The images of the manifest are named as their raw resources. */
+private fun List<String>.toCorpusImage(index: Int): CorpusImage? {
+    val name = get(index)
+    val fileRes = try {
+        R.raw::class.java.getField(name).getInt(null)
+    } catch (ex: ReflectiveOperationException) {
+        return null
+    }
+
+    return CorpusImage(
+        name = name,
+        fileRes = fileRes,
+        size = Point(get(index + 1).toIntOrNull() ?: return null, get(index + 2).toIntOrNull() ?: return null),
+    )
+}
+
+private const val CORPUS_VERSION_KEYWORD = "version"
+private const val CORPUS_SAMPLE_VALUES_COUNT = 9
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection.utils
+
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import android.os.BatteryManager
+import android.os.SystemClock
+import java.util.concurrent.atomic.AtomicBoolean
+import kotlin.math.absoluteValue
+
+/**
+ * Measures the energy consumed by the device while a benchmarked block is executed, from the battery current of
+ * [BatteryManager.BATTERY_PROPERTY_CURRENT_NOW] and the battery voltage.
+ *
+ * The current is sampled every [SAMPLE_PERIOD_MS] on a thread, but the fuel gauge updates it every few hundred
+ * milliseconds: the measured block must run for seconds. The power of the idle device, measured with
+ * [measureIdlePower], is subtracted from the measures. The device must be unplugged, the values are null otherwise.
+ */
+internal class EnergySampler(context: Context) {
+
+    private companion object {
+        /** Period of the sampling of the battery current. */
+        private const val SAMPLE_PERIOD_MS = 10L
+    }
+
+    private val batteryManager: BatteryManager = context.getSystemService(BatteryManager::class.java)
+    /** The battery state when the sampler is created, the voltage only changes slowly during a benchmark. */
+    private val batteryState: Intent? = context.registerReceiver(null, IntentFilter(Intent.ACTION_BATTERY_CHANGED))
+
+    /** The battery voltage, in volts. */
+    private val voltage: Double = (batteryState?.getIntExtra(BatteryManager.EXTRA_VOLTAGE, 0) ?: 0) / 1000.0
+    /** The power of the idle device, in milliwatts. */
+    private var idlePowerMw: Double = 0.0
+
+    /** True if the battery current can be read, and isn't the charging one. */
+    val isAvailable: Boolean =
+        voltage > 0 && batteryState?.getIntExtra(BatteryManager.EXTRA_PLUGGED, 0) == 0 &&
+                batteryManager.getLongProperty(BatteryManager.BATTERY_PROPERTY_CURRENT_NOW).let { current ->
+                    current != 0L && current != Long.MIN_VALUE
+                }
+
+    /** Measure the power of the device while nothing is executed, subtracted from the next measures. */
+    fun measureIdlePower(durationMs: Long) {
+        if (!isAvailable) return
+
+        idlePowerMw = 0.0
+        val idleEnergyMj = sample { SystemClock.sleep(durationMs) }
+        idlePowerMw = idleEnergyMj / durationMs * 1000
+    }
+
+    /** @return the energy consumed by [block], in millijoules, without the idle power, or null if not available. */
+    fun measure(block: () -> Unit): Double? {
+        if (!isAvailable) {
+            block()
+            return null
+        }
+
+        val startTimeMs = SystemClock.elapsedRealtime()
+        val energyMj = sample(block)
+        val durationMs = SystemClock.elapsedRealtime() - startTimeMs
+
+        return (energyMj - idlePowerMw * durationMs / 1000).coerceAtLeast(0.0)
+    }
+
+    /** @return the energy consumed while [block] is executed, in millijoules. */
+    private fun sample(block: () -> Unit): Double {
+        val isSampling = AtomicBoolean(true)
+        var energyMj = 0.0
+
+        val sampler = Thread {
+            var sampleTimeNs = SystemClock.elapsedRealtimeNanos()
+            while (isSampling.get()) {
+                SystemClock.sleep(SAMPLE_PERIOD_MS)
+
+                val timeNs = SystemClock.elapsedRealtimeNanos()
+                // In microamperes, negative when discharging on some devices and positive on others
+                val currentMa = batteryManager.getLongProperty(BatteryManager.BATTERY_PROPERTY_CURRENT_NOW)
+                    .absoluteValue / 1000.0
+                energyMj += currentMa * voltage * (timeNs - sampleTimeNs) / 1_000_000_000.0
+                sampleTimeNs = timeNs
+            }
+        }
+
+        sampler.start()
+        try {
+            block()
+        } finally {
+            isSampling.set(false)
+            sampler.join()
+        }
+
+        return energyMj
+    }
+}
@@ -18,21 +18,31 @@ package com.buzbuz.smartautoclicker.core.detection.utils
 
 import android.content.Context
 import android.graphics.Bitmap
+import android.graphics.Canvas
+import android.graphics.Point
+import androidx.annotation.RawRes
 import com.buzbuz.smartautoclicker.core.detection.ImageDetector
+import com.buzbuz.smartautoclicker.core.detection.data.CorpusImage
 import com.buzbuz.smartautoclicker.core.detection.data.TestImage
 import java.nio.ByteBuffer
 import java.nio.channels.Channels
 
 
-internal fun Context.loadTestBitmap(image: TestImage) : Bitmap {
-    return resources.openRawResource(image.fileRes).use { inputStream ->
+internal fun Context.loadTestBitmap(image: TestImage) : Bitmap =
+    loadTestBitmap(image.fileRes, image.size)
+
+internal fun Context.loadTestBitmap(image: CorpusImage) : Bitmap =
+    loadTestBitmap(image.fileRes, image.size)
+
+private fun Context.loadTestBitmap(@RawRes fileRes: Int, size: Point) : Bitmap {
+    return resources.openRawResource(fileRes).use { inputStream ->
         val channel = Channels.newChannel(inputStream)
         val buffer = ByteBuffer.allocateDirect(inputStream.available())
         channel.read(buffer)
         buffer.position(0)
 
         try {
-            Bitmap.createBitmap(image.size.x, image.size.y, Bitmap.Config.ARGB_8888).apply {
+            Bitmap.createBitmap(size.x, size.y, Bitmap.Config.ARGB_8888).apply {
                 copyPixelsFromBuffer(buffer)
             }
         } catch (rEx: RuntimeException) {
@@ -41,6 +51,12 @@ internal fun Context.loadTestBitmap(image: TestImage) : Bitmap {
     }
 }
 
+/** @return a copy of this bitmap with its content scrolled up, the exposed bottom rows being transparent. */
+internal fun Bitmap.scrolledUp(offset: Int): Bitmap =
+    Bitmap.createBitmap(width, height, Bitmap.Config.ARGB_8888).also { scrolled ->
+        Canvas(scrolled).drawBitmap(this, 0f, -offset.toFloat(), null)
+    }
+
 internal fun ImageDetector.setScreenMetrics(screenBitmap: Bitmap, quality: Double) {
     setScreenMetrics(
         metricsKey = "testTag",
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "benchmark_corpus.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The keyword of the manifest version line. */
+static const std::string VERSION_KEYWORD = "version ";
+
+bool RawImage::load(const std::string& path, int width, int height, RawImage& result) {
+    if (width <= 0 || height <= 0) {
+        fprintf(stderr, "Invalid size %dx%d for image %s\n", width, height, path.c_str());
+        return false;
+    }
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        fprintf(stderr, "Can't open image %s\n", path.c_str());
+        return false;
+    }
+
+    result.width = width;
+    result.height = height;
+    result.pixels.resize(result.getRowStride() * height);
+    size_t readSize = fread(result.pixels.data(), 1, result.pixels.size(), file);
+
+    // The file must contain exactly the expected pixels, a size mismatch means the provided size is wrong
+    bool isEndOfFile = fgetc(file) == EOF;
+    fclose(file);
+    if (readSize != result.pixels.size() || !isEndOfFile) {
+        fprintf(stderr, "Image %s is not a %dx%d raw RGBA image\n", path.c_str(), width, height);
+        return false;
+    }
+
+    size_t nameStart = path.find_last_of('/');
+    result.name = nameStart == std::string::npos ? path : path.substr(nameStart + 1);
+    return true;
+}
+
+RawImage* BenchmarkCorpus::loadImage(const std::string& path, int width, int height) {
+    for (size_t i = 0; i < imagePaths.size(); i++) {
+        if (imagePaths[i] != path) continue;
+        if (images[i]->width == width && images[i]->height == height) return images[i].get();
+
+        fprintf(stderr, "Image %s is declared with different sizes\n", path.c_str());
+        return nullptr;
+    }
+
+    auto image = std::make_unique<RawImage>();
+    if (!RawImage::load(path, width, height, *image)) return nullptr;
+
+    imagePaths.push_back(path);
+    images.push_back(std::move(image));
+    return images.back().get();
+}
+
+bool BenchmarkCorpus::load(const std::string& path, BenchmarkCorpus& result) {
+    std::ifstream manifest(path);
+    if (!manifest) {
+        fprintf(stderr, "Can't open corpus %s\n", path.c_str());
+        return false;
+    }
+
+    const size_t directoryEnd = path.find_last_of('/');
+    const std::string directory = directoryEnd == std::string::npos ? "" : path.substr(0, directoryEnd + 1);
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(manifest, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream values(line);
+        if (line.compare(0, VERSION_KEYWORD.size(), VERSION_KEYWORD) == 0) {
+            std::string keyword;
+            if (result.samples.empty() && values >> keyword >> result.version
+                    && result.version > 0 && result.version <= SUPPORTED_VERSION) {
+                continue;
+            }
+            fprintf(stderr, "Unsupported version at line %d of corpus %s\n", lineNumber, path.c_str());
+            return false;
+        }
+
+        std::string screenFile, conditionFile;
+        int screenWidth, screenHeight, conditionWidth, conditionHeight, isDetected;
+        CorpusSample sample;
+        if (!(values >> screenFile >> screenWidth >> screenHeight >> conditionFile >> conditionWidth
+                     >> conditionHeight >> isDetected >> sample.centerX >> sample.centerY)) {
+            fprintf(stderr, "Invalid sample at line %d of corpus %s\n", lineNumber, path.c_str());
+            return false;
+        }
+
+        // The confidence band is optional, but must be complete and valid when provided
+        if (values >> sample.minConfidence) {
+            if (!(values >> sample.maxConfidence) || sample.minConfidence < 0 || sample.maxConfidence > 1
+                    || sample.minConfidence > sample.maxConfidence) {
+                fprintf(stderr, "Invalid confidence band at line %d of corpus %s\n", lineNumber, path.c_str());
+                return false;
+            }
+        }
+
+        sample.isDetected = isDetected != 0;
+        sample.screen = result.loadImage(directory + screenFile, screenWidth, screenHeight);
+        sample.condition = result.loadImage(directory + conditionFile, conditionWidth, conditionHeight);
+        if (sample.screen == nullptr || sample.condition == nullptr) return false;
+
+        result.samples.push_back(sample);
+    }
+
+    if (result.samples.empty()) {
+        fprintf(stderr, "Corpus %s has no samples\n", path.c_str());
+        return false;
+    }
+    return true;
+}
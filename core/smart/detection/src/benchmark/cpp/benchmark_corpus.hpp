@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_BENCHMARK_CORPUS_HPP
+#define KLICK_R_BENCHMARK_CORPUS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace smartautoclicker {
+
+    /**
+     * A raw RGBA image of the benchmark corpus.
+     * Same format as the instrumented tests images: the pixels are stored without header nor row padding, the size
+     * is provided along with the file.
+     */
+    class RawImage {
+
+    public:
+        /** The name of the file, used in the reports. */
+        std::string name;
+        int width = 0;
+        int height = 0;
+        std::vector<uint8_t> pixels;
+
+        size_t getRowStride() const { return (size_t) width * 4; }
+
+        /**
+         * Load a raw image file.
+         *
+         * @param path the path of the file.
+         * @param width the width of the image, in pixels.
+         * @param height the height of the image, in pixels.
+         * @param result the image to fill.
+         *
+         * @return true if the file has been read, false if it can't be read or if its size doesn't match.
+         */
+        static bool load(const std::string& path, int width, int height, RawImage& result);
+    };
+
+    /** A condition searched on a screen of the corpus, with its expected result. */
+    struct CorpusSample {
+        RawImage* screen = nullptr;
+        RawImage* condition = nullptr;
+        /** True if the condition is on the screen. */
+        bool isDetected = false;
+        /** The expected center of the detected condition, in screen coordinates. */
+        int centerX = 0;
+        int centerY = 0;
+        /** The expected confidence band of the detected condition, between 0 and 1. */
+        double minConfidence = 0;
+        double maxConfidence = 1;
+    };
+
+    /**
+     * The samples of a corpus manifest, with their images.
+     *
+     * The manifest is a text file with one sample per line, the paths being relative to the manifest directory:
+     *   <screen file> <width> <height> <condition file> <width> <height> <detected 0|1> <center x> <center y>
+     *   [<min confidence> <max confidence>]
+     * Empty lines and lines starting with '#' are ignored. An image used by several samples is loaded once.
+     * The samples can be preceded by a "version <number>" line, the version of the expected results, printed in the
+     * reports to know which corpus they have been measured on. The versions up to [SUPPORTED_VERSION] are supported.
+     */
+    class BenchmarkCorpus {
+
+    private:
+        /** The loaded images, the samples points on them. */
+        std::vector<std::unique_ptr<RawImage>> images;
+        std::vector<std::string> imagePaths;
+
+        RawImage* loadImage(const std::string& path, int width, int height);
+
+    public:
+        /** The last version of the manifest format that can be read. */
+        static constexpr int SUPPORTED_VERSION = 1;
+
+        /** The version of the manifest, 1 if not declared. */
+        int version = 1;
+        std::vector<CorpusSample> samples;
+
+        /**
+         * Load a corpus manifest and all its images.
+         *
+         * @param path the path of the manifest.
+         * @param result the corpus to fill.
+         *
+         * @return true if the manifest and all its images have been read, false if one of them is invalid.
+         */
+        static bool load(const std::string& path, BenchmarkCorpus& result);
+    };
+}
+
+#endif //KLICK_R_BENCHMARK_CORPUS_HPP
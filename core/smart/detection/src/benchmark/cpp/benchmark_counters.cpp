@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark_counters.hpp"
+
+using namespace smartautoclicker;
+
+
+#ifdef __linux__
+
+static int openEvent(uint32_t type, uint64_t config) {
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.inherit = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    // The calling process and its threads, on any cpu
+    return (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+static uint64_t getCacheReadMissConfig(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+
+HardwareCounters::HardwareCounters() : eventFds() {
+    eventFds[CYCLES] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    eventFds[INSTRUCTIONS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    eventFds[L1D_MISSES] = openEvent(PERF_TYPE_HW_CACHE, getCacheReadMissConfig(PERF_COUNT_HW_CACHE_L1D));
+    // The L2 of most mobile cpus, or their L3 when they have one
+    eventFds[LAST_LEVEL_MISSES] = openEvent(PERF_TYPE_HW_CACHE, getCacheReadMissConfig(PERF_COUNT_HW_CACHE_LL));
+    eventFds[FRONTEND_STALLS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND);
+    eventFds[BACKEND_STALLS] = openEvent(PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND);
+}
+
+HardwareCounters::~HardwareCounters() {
+    for (int fd : eventFds) if (fd >= 0) close(fd);
+}
+
+void HardwareCounters::reset() {
+    for (int fd : eventFds) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+}
+
+void HardwareCounters::enable() {
+    for (int fd : eventFds) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+void HardwareCounters::disable() {
+    for (int fd : eventFds) if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+}
+
+double HardwareCounters::read(Event event, int executions) const {
+    const int fd = eventFds[event];
+    if (fd < 0 || executions <= 0) return -1;
+
+    // The count, then the times the event was enabled and actually counted
+    uint64_t values[3] = { 0, 0, 0 };
+    if (::read(fd, values, sizeof(values)) != sizeof(values) || values[2] == 0) return -1;
+
+    return (double) values[0] * ((double) values[1] / (double) values[2]) / executions;
+}
+
+#else
+
+HardwareCounters::HardwareCounters() : eventFds() {
+    eventFds.fill(-1);
+}
+
+HardwareCounters::~HardwareCounters() = default;
+
+void HardwareCounters::reset() {}
+
+void HardwareCounters::enable() {}
+
+void HardwareCounters::disable() {}
+
+double HardwareCounters::read(Event, int) const {
+    return -1;
+}
+
+#endif
+
+std::unique_ptr<HardwareCounters> HardwareCounters::open() {
+    std::unique_ptr<HardwareCounters> counters(new HardwareCounters());
+    for (int fd : counters->eventFds) if (fd >= 0) return counters;
+
+    return nullptr;
+}
+
+CounterValues HardwareCounters::read(int executions) const {
+    CounterValues values;
+    values.cycles = read(CYCLES, executions);
+    values.instructions = read(INSTRUCTIONS, executions);
+    values.l1dMisses = read(L1D_MISSES, executions);
+    values.lastLevelMisses = read(LAST_LEVEL_MISSES, executions);
+    values.frontendStalls = read(FRONTEND_STALLS, executions);
+    values.backendStalls = read(BACKEND_STALLS, executions);
+    return values;
+}
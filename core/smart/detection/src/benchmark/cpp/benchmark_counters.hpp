@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_BENCHMARK_COUNTERS_HPP
+#define KLICK_R_BENCHMARK_COUNTERS_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace smartautoclicker {
+
+    /** The hardware events counted for a benchmarked step, per execution. Negative when the event is not counted. */
+    struct CounterValues {
+        double cycles = -1;
+        double instructions = -1;
+        double l1dMisses = -1;
+        double lastLevelMisses = -1;
+        double frontendStalls = -1;
+        double backendStalls = -1;
+    };
+
+    /**
+     * Hardware performance counters of the cpu, read with perf_event_open.
+     *
+     * The events of the benchmark process are counted in user space, including the threads it creates after the
+     * counters are opened, as the ones of the detector thread pool. Each event is opened on its own, the ones not
+     * supported by the cpu or its kernel driver are skipped. When the cpu has less counters than events, the kernel
+     * multiplexes them and the values are scaled by the time they were counted.
+     * On Android, the counters are only accessible to the shell once `setprop security.perf_harden 0` is set.
+     */
+    class HardwareCounters {
+
+    private:
+        enum Event {
+            CYCLES,
+            INSTRUCTIONS,
+            L1D_MISSES,
+            LAST_LEVEL_MISSES,
+            FRONTEND_STALLS,
+            BACKEND_STALLS,
+            EVENT_COUNT,
+        };
+
+        /** The file descriptors of the events, -1 for the ones that can't be counted. */
+        std::array<int, EVENT_COUNT> eventFds;
+
+        HardwareCounters();
+
+        /** @return the count of an event per execution, scaled if it was multiplexed, or -1 if it isn't counted. */
+        double read(Event event, int executions) const;
+
+    public:
+        /** @return the counters, or null if none of the events can be counted on this device. */
+        static std::unique_ptr<HardwareCounters> open();
+
+        ~HardwareCounters();
+
+        HardwareCounters(const HardwareCounters&) = delete;
+        HardwareCounters& operator=(const HardwareCounters&) = delete;
+
+        /** Set all counts to zero, before counting a new step. */
+        void reset();
+        /** Start counting the events. */
+        void enable();
+        /** Stop counting the events, the counts are kept until the next [reset]. */
+        void disable();
+
+        /** @return the counts since the last [reset], per execution of the counted step. */
+        CounterValues read(int executions) const;
+    };
+
+    /**
+     * Count the hardware events of a step.
+     *
+     * @param counters the counters, reset by this call.
+     * @param iterations the number of counted executions.
+     * @param prepare called before each execution, not counted.
+     * @param step the step to count.
+     *
+     * @return the counts per execution.
+     */
+    template <typename Prepare, typename Step>
+    CounterValues measureCounters(HardwareCounters& counters, int iterations, Prepare&& prepare, Step&& step) {
+        counters.reset();
+        for (int i = 0; i < iterations; i++) {
+            prepare();
+            counters.enable();
+            step();
+            counters.disable();
+        }
+
+        return counters.read(iterations);
+    }
+}
+
+#endif //KLICK_R_BENCHMARK_COUNTERS_HPP
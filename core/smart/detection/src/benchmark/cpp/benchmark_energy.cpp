@@ -0,0 +1,204 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <unistd.h>
+
+#include "benchmark_energy.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The battery power supply, with the values of the BatteryManager properties. */
+static constexpr char const* BATTERY_DIR = "/sys/class/power_supply/battery/";
+/** The industrial I/O devices, the power monitors are among them. */
+static constexpr char const* IIO_DEVICES_DIR = "/sys/bus/iio/devices/";
+/** The file of a power monitor with its rails energy counters. */
+static constexpr char const* RAILS_ENERGY_FILE = "energy_value";
+
+/** @return the integer value of a sysfs node, or false if it can't be read. */
+static bool readValue(const std::string& path, long long& value) {
+    FILE* file = fopen(path.c_str(), "r");
+    if (file == nullptr) return false;
+
+    const bool isRead = fscanf(file, "%lld", &value) == 1;
+    fclose(file);
+    return isRead;
+}
+
+static bool isReadable(const std::string& path) {
+    return access(path.c_str(), R_OK) == 0;
+}
+
+static double getElapsedMs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+std::unique_ptr<EnergyMeter> EnergyMeter::open() {
+    std::unique_ptr<EnergyMeter> meter(new EnergyMeter());
+
+    const std::string batteryDir = BATTERY_DIR;
+    long long value;
+    if (readValue(batteryDir + "current_now", value) && readValue(batteryDir + "voltage_now", value)) {
+        meter->batteryCurrentPath = batteryDir + "current_now";
+        meter->batteryVoltagePath = batteryDir + "voltage_now";
+    }
+
+    if (DIR* devices = opendir(IIO_DEVICES_DIR)) {
+        while (dirent* device = readdir(devices)) {
+            if (strncmp(device->d_name, "iio:device", strlen("iio:device")) != 0) continue;
+
+            const std::string path = std::string(IIO_DEVICES_DIR) + device->d_name + "/" + RAILS_ENERGY_FILE;
+            if (isReadable(path)) meter->railsEnergyPaths.push_back(path);
+        }
+        closedir(devices);
+    }
+
+    if (meter->batteryCurrentPath.empty() && meter->railsEnergyPaths.empty()) return nullptr;
+    if (meter->readRailsMicrojoules() < 0) meter->railsEnergyPaths.clear();
+
+    printf("Energy meter: battery=%s, power monitors=%zu\n",
+           meter->batteryCurrentPath.empty() ? "no" : "yes", meter->railsEnergyPaths.size());
+    if (!meter->batteryCurrentPath.empty()) {
+        meter->isSampling = true;
+        meter->sampleTime = std::chrono::steady_clock::now();
+        meter->sampler = std::thread(&EnergyMeter::sample, meter.get());
+    }
+
+    return meter;
+}
+
+EnergyMeter::~EnergyMeter() {
+    isSampling = false;
+    if (sampler.joinable()) sampler.join();
+}
+
+void EnergyMeter::sample() {
+    while (isSampling) {
+        const double milliwatts = readBatteryMilliwatts();
+        {
+            std::lock_guard<std::mutex> lock(measureMutex);
+            const auto now = std::chrono::steady_clock::now();
+            // Only the part of the sample period after the enabling is part of the measure
+            if (isEnabled && milliwatts >= 0) {
+                batteryMicrojoules += milliwatts * getElapsedMs(std::max(sampleTime, enableTime), now);
+            }
+            sampleTime = now;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(SAMPLE_PERIOD_MS));
+    }
+}
+
+double EnergyMeter::readBatteryMilliwatts() const {
+    long long currentUa;
+    long long voltageUv;
+    if (!readValue(batteryCurrentPath, currentUa) || !readValue(batteryVoltagePath, voltageUv)) return -1;
+
+    // Negative while discharging on most devices, positive on the other ones
+    return std::fabs((double) currentUa) * (double) voltageUv / 1e9;
+}
+
+double EnergyMeter::readRailsMicrojoules() const {
+    if (railsEnergyPaths.empty()) return -1;
+
+    // A timestamp line, then a line per rail: "CH<index>(T=<timestamp>)[<rail name>], <energy in microjoules>"
+    double microjoules = 0;
+    char line[256];
+    for (const std::string& path : railsEnergyPaths) {
+        FILE* file = fopen(path.c_str(), "r");
+        if (file == nullptr) return -1;
+
+        while (fgets(line, sizeof(line), file) != nullptr) {
+            if (strncmp(line, "CH", 2) != 0) continue;
+
+            const char* value = strrchr(line, ',');
+            if (value != nullptr) microjoules += strtod(value + 1, nullptr);
+        }
+        fclose(file);
+    }
+
+    return microjoules;
+}
+
+void EnergyMeter::measureIdlePower(int durationMs) {
+    idleBatteryMilliwatts = 0;
+    idleRailsMilliwatts = 0;
+
+    reset();
+    enable();
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMs));
+    disable();
+
+    std::lock_guard<std::mutex> lock(measureMutex);
+    if (enabledMs <= 0) return;
+    idleBatteryMilliwatts = batteryMicrojoules / enabledMs;
+    idleRailsMilliwatts = railsMicrojoules / enabledMs;
+    printf("Idle power: battery=%.1fmW, rails=%.1fmW\n", idleBatteryMilliwatts, idleRailsMilliwatts);
+}
+
+void EnergyMeter::reset() {
+    std::lock_guard<std::mutex> lock(measureMutex);
+    batteryMicrojoules = 0;
+    railsMicrojoules = 0;
+    enabledMs = 0;
+}
+
+void EnergyMeter::enable() {
+    const double rails = readRailsMicrojoules();
+
+    std::lock_guard<std::mutex> lock(measureMutex);
+    enableRailsMicrojoules = rails;
+    enableTime = std::chrono::steady_clock::now();
+    isEnabled = true;
+}
+
+void EnergyMeter::disable() {
+    const auto now = std::chrono::steady_clock::now();
+    const double rails = readRailsMicrojoules();
+    const double milliwatts = batteryCurrentPath.empty() ? -1 : readBatteryMilliwatts();
+
+    std::lock_guard<std::mutex> lock(measureMutex);
+    if (!isEnabled) return;
+
+    // The end of the last sample period, with the current battery power
+    if (milliwatts >= 0) batteryMicrojoules += milliwatts * getElapsedMs(std::max(sampleTime, enableTime), now);
+    if (rails >= 0 && enableRailsMicrojoules >= 0) railsMicrojoules += rails - enableRailsMicrojoules;
+    enabledMs += getElapsedMs(enableTime, now);
+    sampleTime = now;
+    isEnabled = false;
+}
+
+EnergyValues EnergyMeter::read(int executions) const {
+    EnergyValues values;
+    if (executions <= 0) return values;
+
+    std::lock_guard<std::mutex> lock(measureMutex);
+    if (!batteryCurrentPath.empty()) {
+        values.batteryMillijoules = std::max(0.0, batteryMicrojoules - idleBatteryMilliwatts * enabledMs)
+                / 1000 / executions;
+    }
+    if (!railsEnergyPaths.empty()) {
+        values.railsMillijoules = std::max(0.0, railsMicrojoules - idleRailsMilliwatts * enabledMs)
+                / 1000 / executions;
+    }
+    return values;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KLICK_R_BENCHMARK_ENERGY_HPP
+#define KLICK_R_BENCHMARK_ENERGY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace smartautoclicker {
+
+    /** The energy measured for a benchmarked step, per execution, in millijoules. Negative when not measured. */
+    struct EnergyValues {
+        /** The energy of the whole device, from the battery current and voltage. */
+        double batteryMillijoules = -1;
+        /** The energy of all the power rails of the on device power monitor, when the device has one. */
+        double railsMillijoules = -1;
+
+        /** @return the most precise measure, the rails one if measured, or -1 if none is. */
+        double getMillijoules() const { return railsMillijoules >= 0 ? railsMillijoules : batteryMillijoules; }
+        /** @return the name of the measure of [getMillijoules]. */
+        const char* getSource() const { return railsMillijoules >= 0 ? "rails" : "battery"; }
+    };
+
+    /**
+     * Measures the energy consumed by the device while a step is executed, from the sysfs nodes readable by the shell.
+     *
+     * The battery current and voltage, the values of the BatteryManager CURRENT_NOW property, are sampled every
+     * [SAMPLE_PERIOD_MS] on a thread. They are updated by the fuel gauge every few hundred milliseconds, the steps
+     * must then be measured over seconds, with enough iterations. The on device power monitor (ODPM) of recent devices
+     * accumulates the energy of each power rail in its counters: they are read when the measure starts and stops, and
+     * are precise for the short steps.
+     *
+     * The power of the idle device, measured by [measureIdlePower], is subtracted from both: the values are the energy
+     * consumed by the step, not by the screen and the other components.
+     */
+    class EnergyMeter {
+
+    private:
+        /** Period of the sampling of the battery current and voltage. */
+        static constexpr int SAMPLE_PERIOD_MS = 5;
+
+        /** The battery current, in microamperes, and voltage, in microvolts. Empty if not readable. */
+        std::string batteryCurrentPath;
+        std::string batteryVoltagePath;
+        /** The energy counters files of the power monitors, one per monitor chip. */
+        std::vector<std::string> railsEnergyPaths;
+
+        /** Samples the battery power while [isSampling]. */
+        std::thread sampler;
+        std::atomic<bool> isSampling = false;
+
+        /** Protects the measure, updated by the sampler and by [enable] and [disable]. */
+        mutable std::mutex measureMutex;
+        /** True between [enable] and [disable], the battery samples are accumulated. */
+        bool isEnabled = false;
+        /** The energy measured since the last [reset], in microjoules. */
+        double batteryMicrojoules = 0;
+        double railsMicrojoules = 0;
+        /** The time measured since the last [reset]. */
+        double enabledMs = 0;
+        /** The rails counters and the time when the measure was enabled. */
+        double enableRailsMicrojoules = 0;
+        std::chrono::steady_clock::time_point enableTime;
+        /** The time of the last battery sample. */
+        std::chrono::steady_clock::time_point sampleTime;
+
+        /** The power of the idle device, subtracted from the measures. */
+        double idleBatteryMilliwatts = 0;
+        double idleRailsMilliwatts = 0;
+
+        EnergyMeter() = default;
+
+        void sample();
+        /** @return the battery power, in milliwatts, or -1 if it can't be read. */
+        double readBatteryMilliwatts() const;
+        /** @return the sum of the rails energy counters, in microjoules, or -1 if there is none. */
+        double readRailsMicrojoules() const;
+
+    public:
+        /** @return the meter, or null if neither the battery nor the power monitor can be read on this device. */
+        static std::unique_ptr<EnergyMeter> open();
+
+        ~EnergyMeter();
+
+        EnergyMeter(const EnergyMeter&) = delete;
+        EnergyMeter& operator=(const EnergyMeter&) = delete;
+
+        /**
+         * Measure the power of the device while the benchmark waits, subtracted from the next measures.
+         * @param durationMs the duration of the measure, long enough for a few updates of the battery values.
+         */
+        void measureIdlePower(int durationMs);
+
+        /** Set the measured energy to zero, before measuring a new step. */
+        void reset();
+        /** Start measuring the energy. */
+        void enable();
+        /** Stop measuring the energy, the measure is kept until the next [reset]. */
+        void disable();
+
+        /** @return the energy measured since the last [reset], per execution of the measured step. */
+        EnergyValues read(int executions) const;
+    };
+}
+
+#endif //KLICK_R_BENCHMARK_ENERGY_HPP
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_BENCHMARK_TIMER_HPP
+#define KLICK_R_BENCHMARK_TIMER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace smartautoclicker {
+
+    /** The measured durations of a benchmarked step, in microseconds. */
+    struct BenchmarkStats {
+        double medianUs = 0;
+        double p90Us = 0;
+        double p99Us = 0;
+        double minUs = 0;
+        double maxUs = 0;
+        double meanUs = 0;
+    };
+
+    /**
+     * Compute the stats of measured durations.
+     *
+     * @param durationsUs the durations, in microseconds. Sorted by this call, must not be empty.
+     */
+    inline BenchmarkStats computeStats(std::vector<double>& durationsUs) {
+        BenchmarkStats stats;
+        for (double durationUs : durationsUs) stats.meanUs += durationUs;
+        stats.meanUs /= (double) durationsUs.size();
+
+        std::sort(durationsUs.begin(), durationsUs.end());
+        stats.medianUs = durationsUs[durationsUs.size() / 2];
+        stats.p90Us = durationsUs[durationsUs.size() * 90 / 100];
+        stats.p99Us = durationsUs[durationsUs.size() * 99 / 100];
+        stats.minUs = durationsUs.front();
+        stats.maxUs = durationsUs.back();
+        return stats;
+    }
+
+    /** @return the duration since a start time, in microseconds. */
+    inline double getElapsedUs(const std::chrono::steady_clock::time_point& start) {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /**
+     * Measure the execution time of a step.
+     *
+     * @param warmupIterations the number of executions before measuring, to get the caches and cpu frequency up.
+     * @param measuredIterations the number of measured executions.
+     * @param prepare called before each execution, not measured. Allows to reset the state modified by the step.
+     * @param step the step to measure.
+     *
+     * @return the stats of the measured executions.
+     */
+    template <typename Prepare, typename Step>
+    BenchmarkStats measure(int warmupIterations, int measuredIterations, Prepare&& prepare, Step&& step) {
+        for (int i = 0; i < warmupIterations; i++) {
+            prepare();
+            step();
+        }
+
+        std::vector<double> durationsUs(std::max(measuredIterations, 1));
+        for (double& durationUs : durationsUs) {
+            prepare();
+            auto start = std::chrono::steady_clock::now();
+            step();
+            durationUs = getElapsedUs(start);
+        }
+
+        return computeStats(durationsUs);
+    }
+
+    /** Same as [measure], for a step without state to reset between executions. */
+    template <typename Step>
+    BenchmarkStats measure(int warmupIterations, int measuredIterations, Step&& step) {
+        return measure(warmupIterations, measuredIterations, [] {}, std::forward<Step>(step));
+    }
+}
+
+#endif //KLICK_R_BENCHMARK_TIMER_HPP
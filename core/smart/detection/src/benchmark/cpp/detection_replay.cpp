@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+#include "detection_replay.hpp"
+
+using namespace smartautoclicker;
+
+
+static void report(const char* step, std::vector<double>& durationsUs) {
+    const BenchmarkStats stats = computeStats(durationsUs);
+    printf("  %-26s median=%9.3fms  min=%9.3fms  max=%9.3fms  mean=%9.3fms\n",
+           step, stats.medianUs / 1000, stats.minUs / 1000, stats.maxUs / 1000, stats.meanUs / 1000);
+}
+
+DetectionReplay::DetectionReplay(DetectorBenchmark::Config config) : config(std::move(config)) {
+    unsigned int threadCount = this->config.threadCount < 0
+            ? ThreadPool::getDefaultThreadCount()
+            : (unsigned int) this->config.threadCount;
+    if (threadCount > 0) detector.threadPool = std::make_unique<ThreadPool>(threadCount);
+    for (std::shared_ptr<DetectionImage>& image : detector.screenImages) image->isTileHashingEnabled = true;
+    printf("Detector thread pool: %u threads\n", threadCount);
+
+    if (this->config.energy) {
+        energyMeter = EnergyMeter::open();
+        if (energyMeter) energyMeter->measureIdlePower(IDLE_POWER_DURATION_MS);
+        else printf("Energy meter: neither the battery nor a power monitor can be read\n");
+    }
+}
+
+void DetectionReplay::run(const DetectionCapture& capture) {
+    const cv::Size& screenSize = capture.getScreenSize();
+    // Before the scale ratio computation, the other options are applied once it is known
+    detector.setIntegerScaleRatioEnabled(capture.getMatchingOptions().isIntegerScaleRatioEnabled);
+    detector.scaleRatioManager.computeScaleRatio(
+            (u_int32_t) screenSize.width, (u_int32_t) screenSize.height, capture.getDetectionQuality(), METRICS_TAG);
+    detector.screenSize = screenSize;
+    const double scaleRatio = detector.scaleRatioManager.getScaleRatio();
+    applyMatchingOptions(capture.getMatchingOptions());
+    processTemplates(capture, scaleRatio);
+
+    const std::vector<const DetectionCapture::Frame*> frames = capture.getFrames();
+    printf("\nCapture: screen %dx%d, quality=%.0f, scaleRatio=%.4f, %zu frames, %zu conditions\n",
+           screenSize.width, screenSize.height, capture.getDetectionQuality(), scaleRatio, frames.size(),
+           templates.size());
+
+    std::vector<ReplayedFrame> measures(frames.size());
+    for (size_t i = 0; i < frames.size(); i++) measures[i].detections.resize(frames[i]->detections.size());
+
+    for (int i = 0; i < config.warmupIterations; i++) replay(frames, scaleRatio, nullptr);
+    const int iterations = std::max(config.measuredIterations, 1);
+    if (energyMeter) {
+        energyMeter->reset();
+        energyMeter->enable();
+    }
+    for (int i = 0; i < iterations; i++) replay(frames, scaleRatio, &measures);
+    if (energyMeter) energyMeter->disable();
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        const DetectionCapture::Frame& frame = *frames[i];
+        ReplayedFrame& frameMeasures = measures[i];
+        printf("\nFrame %zu (%dx%d), %zu detections\n",
+               i, frame.pixels.cols, frame.pixels.rows, frame.detections.size());
+
+        report("setScreenImage", frameMeasures.processingDurationsUs);
+        for (size_t j = 0; j < frame.detections.size(); j++) {
+            const DetectionCapture::Detection& detection = frame.detections[j];
+            ReplayedDetection& detectionMeasures = frameMeasures.detections[j];
+
+            char step[32];
+            snprintf(step, sizeof(step), "condition %lld", (long long) detection.conditionId);
+            if (detectionMeasures.durationsUs.empty()) {
+                printf("  %-26s not captured, skipped\n", step);
+                continue;
+            }
+
+            report(step, detectionMeasures.durationsUs);
+            const ConditionResult& result = detectionMeasures.result;
+            printf("  %-26s threshold=%d, detected=%d at [%d, %d], confidence=%.4f\n",
+                   "", detection.threshold, result.isDetected, result.centerX, result.centerY, result.confidenceRate);
+        }
+        report("total", frameMeasures.totalDurationsUs);
+    }
+
+    if (energyMeter && !frames.empty()) {
+        const EnergyValues energy = energyMeter->read(iterations * (int) frames.size());
+        if (energy.getMillijoules() >= 0) {
+            printf("\nEnergy: %.3fmJ/frame (%s)\n", energy.getMillijoules(), energy.getSource());
+        }
+    }
+}
+
+void DetectionReplay::applyMatchingOptions(const DetectionCapture::MatchingOptions& options) {
+    detector.setPyramidMatchingEnabled(options.isPyramidMatchingEnabled);
+    detector.setSparseMatchingEnabled(options.isSparseMatchingEnabled);
+    detector.setBinaryMatchingEnabled(options.isBinaryMatchingEnabled);
+    detector.setChamferMatchingEnabled(options.isChamferMatchingEnabled);
+    detector.setMotionCompensationEnabled(options.isMotionCompensationEnabled);
+    detector.setHistogramColorVerificationEnabled(options.isHistogramColorVerificationEnabled);
+    detector.setScaledColorVerificationEnabled(options.isScaledColorVerificationEnabled);
+    detector.setIntegerMatchingEnabled(options.isIntegerMatchingEnabled);
+    detector.setFirstHitMatchingEnabled(options.isFirstHitMatchingEnabled);
+    detector.setLearnedAreaMatchingEnabled(options.isLearnedAreaMatchingEnabled);
+    detector.setTemplateScales(options.templateScales);
+
+    printf("Matching options: pyramid=%d, sparse=%d, binary=%d, chamfer=%d, motion=%d, histogram=%d, "
+           "scaledColor=%d, integer=%d, firstHit=%d, learnedArea=%d, integerRatio=%d, scales=%zu\n",
+           options.isPyramidMatchingEnabled, options.isSparseMatchingEnabled, options.isBinaryMatchingEnabled,
+           options.isChamferMatchingEnabled, options.isMotionCompensationEnabled,
+           options.isHistogramColorVerificationEnabled, options.isScaledColorVerificationEnabled,
+           options.isIntegerMatchingEnabled, options.isFirstHitMatchingEnabled, options.isLearnedAreaMatchingEnabled,
+           options.isIntegerScaleRatioEnabled, options.templateScales.size());
+}
+
+void DetectionReplay::processTemplates(const DetectionCapture& capture, double scaleRatio) {
+    // Processed once before replaying, like the conditions prepared at the scenario start
+    templates.clear();
+    for (const DetectionCapture::Frame* frame : capture.getFrames()) {
+        for (const DetectionCapture::Detection& detection : frame->detections) {
+            if (templates.find(detection.conditionId) != templates.end()) continue;
+
+            const cv::Mat* pixels = capture.getTemplate(detection.conditionId);
+            if (pixels == nullptr) continue;
+
+            auto conditionTemplate = std::make_unique<ConditionTemplate>();
+            conditionTemplate->processPixels(pixels->data, pixels->cols, pixels->rows, pixels->step, scaleRatio);
+            templates[detection.conditionId] = std::move(conditionTemplate);
+        }
+    }
+}
+
+void DetectionReplay::replay(const std::vector<const DetectionCapture::Frame*>& frames, double scaleRatio,
+                             std::vector<ReplayedFrame>* measures) {
+
+    // The histories and memos of the previous iteration would be reused by the first frames
+    detector.matchHistories.clear();
+    detector.matchMemo.clear();
+    detector.screenSignature.clear();
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        const DetectionCapture::Frame& frame = *frames[i];
+        const auto frameStart = std::chrono::steady_clock::now();
+
+        // Same processing as Detector::setScreenImage
+        DetectionImage& image = detector.getBackScreenImage();
+        image.processPixels(frame.pixels.data, frame.pixels.cols, frame.pixels.rows, frame.pixels.step,
+                            frame.fullSize, scaleRatio, detector.threadPool.get());
+        detector.swapScreenImages(image, FramePacer::getTimeNanos());
+        const double processingUs = getElapsedUs(frameStart);
+
+        for (size_t j = 0; j < frame.detections.size(); j++) {
+            const DetectionCapture::Detection& detection = frame.detections[j];
+            auto conditionTemplate = templates.find(detection.conditionId);
+            if (conditionTemplate == templates.end()) continue;
+
+            // Same matching as Detector::match, without the GPU backend
+            const auto detectionStart = std::chrono::steady_clock::now();
+            detector.mainContext.detectionRoi.setFullSize(detection.roi, scaleRatio);
+            const ConditionResult result = detector.matchTemplate(
+                    *conditionTemplate->second, detector.mainContext, detection.threshold, scaleRatio,
+                    detector.matchHistories[detection.conditionId], false);
+            const double detectionUs = getElapsedUs(detectionStart);
+
+            if (measures == nullptr) continue;
+            ReplayedDetection& detectionMeasures = (*measures)[i].detections[j];
+            detectionMeasures.durationsUs.push_back(detectionUs);
+            detectionMeasures.result = result;
+        }
+
+        if (measures == nullptr) continue;
+        (*measures)[i].processingDurationsUs.push_back(processingUs);
+        (*measures)[i].totalDurationsUs.push_back(getElapsedUs(frameStart));
+    }
+}
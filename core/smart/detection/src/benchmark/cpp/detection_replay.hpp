@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DETECTION_REPLAY_HPP
+#define KLICK_R_DETECTION_REPLAY_HPP
+
+#include <memory>
+#include <unordered_map>
+
+#include "benchmark_energy.hpp"
+#include "benchmark_timer.hpp"
+#include "detector_benchmark.hpp"
+#include "../../main/cpp/detection/detection_capture.hpp"
+#include "../../main/cpp/detection/detector.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Replay the detections of a [DetectionCapture] recorded in the application, and measure them.
+     *
+     * Each iteration replays all captured screen images in order, starting from an empty detector state, so the
+     * histories and memos of the conditions evolve the same way as during the capture. The screen images are processed
+     * the same way as the JNI calls do, and the conditions are matched on the calling thread, one after the other.
+     */
+    class DetectionReplay {
+
+    private:
+        /** Tag for the scaling ratio manager, the replay is part of the application. */
+        static constexpr char const* METRICS_TAG = "com.buzbuz.smartautoclicker.benchmark";
+        /** Duration of the measure of the idle device power, subtracted from the energy of the frames. */
+        static constexpr int IDLE_POWER_DURATION_MS = 3000;
+
+        /** The measured durations of a captured detection, and its result in the last iteration. */
+        struct ReplayedDetection {
+            std::vector<double> durationsUs;
+            ConditionResult result;
+        };
+
+        /** The measured durations of a captured screen image and its detections. */
+        struct ReplayedFrame {
+            std::vector<double> processingDurationsUs;
+            std::vector<double> totalDurationsUs;
+            std::vector<ReplayedDetection> detections;
+        };
+
+        const DetectorBenchmark::Config config;
+        Detector detector = Detector();
+        /** The captured conditions, processed at the capture scale ratio. */
+        std::unordered_map<int64_t, std::unique_ptr<ConditionTemplate>> templates;
+        /** The energy meter, null if the energy is not requested or can't be measured. */
+        std::unique_ptr<EnergyMeter> energyMeter;
+
+        void applyMatchingOptions(const DetectionCapture::MatchingOptions& options);
+        void processTemplates(const DetectionCapture& capture, double scaleRatio);
+        void replay(const std::vector<const DetectionCapture::Frame*>& frames, double scaleRatio,
+                    std::vector<ReplayedFrame>* measures);
+
+    public:
+        /** Only the iterations and the threads of the config are used, the thresholds are the captured ones. */
+        explicit DetectionReplay(DetectorBenchmark::Config config);
+
+        DetectionReplay(const DetectionReplay&) = delete;
+        DetectionReplay& operator=(const DetectionReplay&) = delete;
+
+        /** Replay and measure all detections of a capture, and print the report. */
+        void run(const DetectionCapture& capture);
+    };
+}
+
+#endif //KLICK_R_DETECTION_REPLAY_HPP
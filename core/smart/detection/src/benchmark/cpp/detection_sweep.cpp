@@ -0,0 +1,330 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+
+#include "detection_sweep.hpp"
+
+using namespace smartautoclicker;
+
+
+/** All matching modes, swept in this order. */
+static constexpr DetectionSweep::MatchingMode MATCHING_MODES[] = {
+        DetectionSweep::MatchingMode::DEFAULT,
+        DetectionSweep::MatchingMode::PYRAMID,
+        DetectionSweep::MatchingMode::SPARSE,
+        DetectionSweep::MatchingMode::INTEGER,
+        DetectionSweep::MatchingMode::BINARY,
+        DetectionSweep::MatchingMode::CHAMFER,
+        DetectionSweep::MatchingMode::OPENCV,
+        DetectionSweep::MatchingMode::FFT,
+        DetectionSweep::MatchingMode::SMALL_TEMPLATE,
+        DetectionSweep::MatchingMode::BOUNDED,
+        DetectionSweep::MatchingMode::GEMM,
+        DetectionSweep::MatchingMode::SQDIFF_NORMED,
+        DetectionSweep::MatchingMode::SAD,
+};
+
+DetectionSweep::DetectionSweep(DetectorBenchmark::Config config) : config(std::move(config)) {
+    setThreadCount(this->config.threadCount);
+    for (std::shared_ptr<DetectionImage>& image : detector.screenImages) image->isTileHashingEnabled = true;
+
+    if (this->config.energy) {
+        energyMeter = EnergyMeter::open();
+        if (energyMeter) energyMeter->measureIdlePower(IDLE_POWER_DURATION_MS);
+        else printf("Energy meter: neither the battery nor a power monitor can be read\n");
+    }
+}
+
+void DetectionSweep::setThreadCount(int count) {
+    const unsigned int poolThreadCount = count < 0 ? ThreadPool::getDefaultThreadCount() : (unsigned int) count;
+    if (detector.threadPool != nullptr && threadCount == (int) poolThreadCount) return;
+
+    detector.threadPool.reset();
+    if (poolThreadCount > 0) detector.threadPool = std::make_unique<ThreadPool>(poolThreadCount);
+    threadCount = (int) poolThreadCount;
+    printf("Detector thread pool: %u threads\n", poolThreadCount);
+}
+
+bool DetectionSweep::run(BenchmarkCorpus& corpus, const std::vector<double>& qualities,
+                         const std::vector<int>& thresholds, const std::vector<int>& threadCounts,
+                         const std::string& reportPath) {
+
+    printf("\nCorpus: version %d, %zu samples, %zu qualities, %zu thresholds, %zu thread counts\n",
+           corpus.version, corpus.samples.size(), qualities.size(), thresholds.size(),
+           std::max(threadCounts.size(), (size_t) 1));
+
+    std::vector<ConfigurationReport> reports;
+    const std::vector<int> sweptThreadCounts = threadCounts.empty() ? std::vector<int> { config.threadCount }
+                                                                    : threadCounts;
+    for (int count : sweptThreadCounts) {
+        setThreadCount(count);
+        for (double quality : qualities) {
+            // The default mode is swept first, the other ones are compared to it
+            const size_t defaultReportsStart = reports.size();
+            for (MatchingMode mode : MATCHING_MODES) {
+                for (size_t i = 0; i < thresholds.size(); i++) {
+                    ConfigurationReport& report = reports.emplace_back(run(corpus, quality, mode, thresholds[i]));
+                    computeDeltas(report, reports[defaultReportsStart + i]);
+                    printf("  threads=%-2d quality=%-6.0f %-14s threshold=%-3d p50=%8.3fms p90=%8.3fms "
+                           "p99=%8.3fms memory=%6.1fMB hit=%d miss=%d falsePositive=%d reject=%d "
+                           "positionError=%.1f/%.1fpx confidence=%.3f outOfBand=%d",
+                           report.threadCount, quality, getName(mode), thresholds[i], report.latency.medianUs / 1000,
+                           report.latency.p90Us / 1000, report.latency.p99Us / 1000,
+                           (double) report.maxMemoryBytes / (1024 * 1024), report.hitCount, report.missCount,
+                           report.falsePositiveCount, report.rejectCount, report.meanPositionError,
+                           report.maxPositionError, report.meanConfidence, report.outOfBandCount);
+                    if (report.energy.getMillijoules() >= 0) {
+                        printf(" energy=%.3fmJ(%s)", report.energy.getMillijoules(), report.energy.getSource());
+                    }
+                    printf("\n");
+                    if (mode == MatchingMode::DEFAULT) continue;
+
+                    printf("  %-54s vs default: latency=x%.2f hit=%+d falsePositive=%+d confidence=%+.3f",
+                           "", report.latencyRatio, report.hitDelta, report.falsePositiveDelta,
+                           report.meanConfidenceDelta);
+                    if (getForcedBackend(mode) != MatchBackendType::NONE) {
+                        printf(" backend=%d/%zu", report.forcedBackendCount, corpus.samples.size());
+                    }
+                    printf("\n");
+                }
+            }
+        }
+    }
+    applyMatchingMode(MatchingMode::DEFAULT);
+
+    if (reportPath.empty()) return true;
+
+    FILE* file = fopen(reportPath.c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Can't open report %s\n", reportPath.c_str());
+        return false;
+    }
+
+    const std::string jsonExtension = ".json";
+    const bool isJson = reportPath.size() >= jsonExtension.size()
+            && reportPath.compare(reportPath.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0;
+    if (isJson) writeJson(file, reports);
+    else writeCsv(file, reports);
+
+    const bool isWritten = ferror(file) == 0;
+    fclose(file);
+    if (isWritten) printf("\nReport written to %s\n", reportPath.c_str());
+    return isWritten;
+}
+
+void DetectionSweep::applyMatchingMode(MatchingMode mode) {
+    detector.setPyramidMatchingEnabled(mode == MatchingMode::PYRAMID);
+    detector.setSparseMatchingEnabled(mode == MatchingMode::SPARSE);
+    detector.setIntegerMatchingEnabled(mode == MatchingMode::INTEGER);
+    detector.setBinaryMatchingEnabled(mode == MatchingMode::BINARY);
+    detector.setChamferMatchingEnabled(mode == MatchingMode::CHAMFER);
+    detector.matchBackends.setForcedBackend(getForcedBackend(mode));
+}
+
+DetectionSweep::ConfigurationReport DetectionSweep::run(BenchmarkCorpus& corpus, double quality, MatchingMode mode,
+                                                        int threshold) {
+
+    ConfigurationReport report;
+    report.threadCount = threadCount;
+    report.quality = quality;
+    report.mode = mode;
+    report.threshold = threshold;
+    applyMatchingMode(mode);
+
+    // The energy of the measured detections only, the screen and condition processing are not part of them
+    if (energyMeter) energyMeter->reset();
+    std::vector<double> durationsUs;
+    double positionErrorSum = 0;
+    double confidenceSum = 0;
+    const MatchBackendType forcedBackend = getForcedBackend(mode);
+    const MatchingMetric metric = getMetric(mode);
+    for (const CorpusSample& sample : corpus.samples) {
+        RawImage& screen = *sample.screen;
+        RawImage& condition = *sample.condition;
+
+        detector.scaleRatioManager.computeScaleRatio(
+                (u_int32_t) screen.width, (u_int32_t) screen.height, quality, METRICS_TAG);
+        const double scaleRatio = detector.scaleRatioManager.getScaleRatio();
+
+        // Same processing as Detector::setScreenImage
+        detector.screenSignature.clear();
+        detector.screenImage->processPixels(
+                screen.pixels.data(), screen.width, screen.height, screen.getRowStride(), scaleRatio,
+                detector.threadPool.get());
+        detector.updateScreenSignature(*detector.screenImage);
+        detector.screenImage->frameIndex = detector.screenSignature.getFrameIndex();
+
+        ConditionTemplate conditionTemplate;
+        conditionTemplate.processPixels(
+                condition.pixels.data(), condition.width, condition.height, condition.getRowStride(), scaleRatio);
+
+        // A condition bigger than the screen is never detected
+        ConditionResult result;
+        const cv::Size& scaledCondition = conditionTemplate.image.scaledSize;
+        const cv::Size& scaledScreen = detector.screenImage->scaledSize;
+        if (scaledCondition.width <= scaledScreen.width && scaledCondition.height <= scaledScreen.height) {
+            MatchingContext& context = detector.mainContext;
+            context.detectionRoi.setFullSize(detector.screenImage->fullSizeRoi, scaleRatio);
+
+            // A new history and memo for each execution, or the previous result would be reused
+            Detector::MatchHistory history;
+            auto resetHistory = [&] {
+                history = Detector::MatchHistory();
+                history.metric = metric;
+                detector.matchMemo.clear();
+            };
+            auto match = [&] {
+                result = detector.matchTemplate(conditionTemplate, context, threshold, scaleRatio, history, false);
+            };
+
+            for (int i = 0; i < config.warmupIterations; i++) {
+                resetHistory();
+                match();
+            }
+            if (energyMeter) energyMeter->enable();
+            for (int i = 0; i < std::max(config.measuredIterations, 1); i++) {
+                resetHistory();
+                const auto start = std::chrono::steady_clock::now();
+                match();
+                durationsUs.push_back(getElapsedUs(start));
+            }
+            if (energyMeter) energyMeter->disable();
+
+            if (forcedBackend != MatchBackendType::NONE && context.matchBackendType == forcedBackend) {
+                report.forcedBackendCount++;
+            }
+        }
+
+        report.maxMemoryBytes = std::max(
+                report.maxMemoryBytes,
+                detector.computeMemoryUsage().getTotal() + (int64_t) conditionTemplate.getMemorySize());
+
+        if (sample.isDetected && result.isDetected) {
+            const double positionError = std::hypot(result.centerX - sample.centerX, result.centerY - sample.centerY);
+            positionErrorSum += positionError;
+            report.maxPositionError = std::max(report.maxPositionError, positionError);
+            confidenceSum += result.confidenceRate;
+            if (result.confidenceRate < sample.minConfidence || result.confidenceRate > sample.maxConfidence) {
+                report.outOfBandCount++;
+            }
+            report.hitCount++;
+        } else if (sample.isDetected) {
+            report.missCount++;
+        } else if (result.isDetected) {
+            report.falsePositiveCount++;
+        } else {
+            report.rejectCount++;
+        }
+    }
+
+    if (!durationsUs.empty()) report.latency = computeStats(durationsUs);
+    if (energyMeter) report.energy = energyMeter->read((int) durationsUs.size());
+    if (report.hitCount > 0) {
+        report.meanPositionError = positionErrorSum / report.hitCount;
+        report.meanConfidence = confidenceSum / report.hitCount;
+    }
+    return report;
+}
+
+void DetectionSweep::computeDeltas(ConfigurationReport& report, const ConfigurationReport& reference) {
+    report.hitDelta = report.hitCount - reference.hitCount;
+    report.falsePositiveDelta = report.falsePositiveCount - reference.falsePositiveCount;
+    report.meanConfidenceDelta = report.meanConfidence - reference.meanConfidence;
+    report.latencyRatio = reference.latency.medianUs > 0 ? report.latency.medianUs / reference.latency.medianUs : 0;
+}
+
+const char* DetectionSweep::getName(MatchingMode mode) {
+    switch (mode) {
+        case MatchingMode::PYRAMID: return "pyramid";
+        case MatchingMode::SPARSE: return "sparse";
+        case MatchingMode::INTEGER: return "integer";
+        case MatchingMode::BINARY: return "binary";
+        case MatchingMode::CHAMFER: return "chamfer";
+        case MatchingMode::OPENCV: return "opencv";
+        case MatchingMode::FFT: return "fft";
+        case MatchingMode::SMALL_TEMPLATE: return "small_template";
+        case MatchingMode::BOUNDED: return "bounded";
+        case MatchingMode::GEMM: return "gemm";
+        case MatchingMode::SQDIFF_NORMED: return "sqdiff_normed";
+        case MatchingMode::SAD: return "sad";
+        case MatchingMode::DEFAULT:
+        default: return "default";
+    }
+}
+
+MatchBackendType DetectionSweep::getForcedBackend(MatchingMode mode) {
+    switch (mode) {
+        case MatchingMode::OPENCV: return MatchBackendType::OPENCV;
+        case MatchingMode::FFT: return MatchBackendType::FFT;
+        case MatchingMode::SMALL_TEMPLATE: return MatchBackendType::SMALL_TEMPLATE;
+        case MatchingMode::BOUNDED: return MatchBackendType::BOUNDED;
+        case MatchingMode::GEMM: return MatchBackendType::GEMM;
+        default: return MatchBackendType::NONE;
+    }
+}
+
+MatchingMetric DetectionSweep::getMetric(MatchingMode mode) {
+    switch (mode) {
+        case MatchingMode::SQDIFF_NORMED: return MatchingMetric::SQDIFF_NORMED;
+        case MatchingMode::SAD: return MatchingMetric::SAD;
+        default: return MatchingMetric::CCOEFF_NORMED;
+    }
+}
+
+void DetectionSweep::writeCsv(FILE* file, const std::vector<ConfigurationReport>& reports) {
+    fprintf(file, "quality,mode,threshold,p50_ms,p90_ms,p99_ms,max_ms,memory_bytes,hits,misses,false_positives,"
+                  "rejects,mean_position_error_px,max_position_error_px,mean_confidence,out_of_band,forced_backend,"
+                  "latency_ratio,hit_delta,false_positive_delta,mean_confidence_delta,threads,battery_mj,rails_mj\n");
+    for (const ConfigurationReport& report : reports) {
+        fprintf(file, "%.0f,%s,%d,%.3f,%.3f,%.3f,%.3f,%lld,%d,%d,%d,%d,%.2f,%.2f,%.4f,%d,%d,%.3f,%d,%d,%.4f,"
+                      "%d,%.4f,%.4f\n",
+                report.quality, getName(report.mode), report.threshold, report.latency.medianUs / 1000,
+                report.latency.p90Us / 1000, report.latency.p99Us / 1000, report.latency.maxUs / 1000,
+                (long long) report.maxMemoryBytes, report.hitCount, report.missCount, report.falsePositiveCount,
+                report.rejectCount, report.meanPositionError, report.maxPositionError, report.meanConfidence,
+                report.outOfBandCount, report.forcedBackendCount, report.latencyRatio, report.hitDelta,
+                report.falsePositiveDelta, report.meanConfidenceDelta, report.threadCount,
+                report.energy.batteryMillijoules, report.energy.railsMillijoules);
+    }
+}
+
+void DetectionSweep::writeJson(FILE* file, const std::vector<ConfigurationReport>& reports) {
+    fprintf(file, "[\n");
+    for (size_t i = 0; i < reports.size(); i++) {
+        const ConfigurationReport& report = reports[i];
+        fprintf(file, "  {\"quality\": %.0f, \"mode\": \"%s\", \"threshold\": %d, "
+                      "\"p50Ms\": %.3f, \"p90Ms\": %.3f, \"p99Ms\": %.3f, \"maxMs\": %.3f, \"memoryBytes\": %lld, "
+                      "\"hits\": %d, \"misses\": %d, \"falsePositives\": %d, \"rejects\": %d, "
+                      "\"meanPositionErrorPx\": %.2f, \"maxPositionErrorPx\": %.2f, \"meanConfidence\": %.4f, "
+                      "\"outOfBand\": %d, \"forcedBackend\": %d, \"latencyRatio\": %.3f, \"hitDelta\": %d, "
+                      "\"falsePositiveDelta\": %d, \"meanConfidenceDelta\": %.4f, \"threads\": %d, "
+                      "\"batteryMj\": %.4f, \"railsMj\": %.4f}%s\n",
+                report.quality, getName(report.mode), report.threshold, report.latency.medianUs / 1000,
+                report.latency.p90Us / 1000, report.latency.p99Us / 1000, report.latency.maxUs / 1000,
+                (long long) report.maxMemoryBytes, report.hitCount, report.missCount, report.falsePositiveCount,
+                report.rejectCount, report.meanPositionError, report.maxPositionError, report.meanConfidence,
+                report.outOfBandCount, report.forcedBackendCount, report.latencyRatio, report.hitDelta,
+                report.falsePositiveDelta, report.meanConfidenceDelta, report.threadCount,
+                report.energy.batteryMillijoules, report.energy.railsMillijoules, i + 1 < reports.size() ? "," : "");
+    }
+    fprintf(file, "]\n");
+}
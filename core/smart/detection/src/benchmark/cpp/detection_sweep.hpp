@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DETECTION_SWEEP_HPP
+#define KLICK_R_DETECTION_SWEEP_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_corpus.hpp"
+#include "benchmark_energy.hpp"
+#include "benchmark_timer.hpp"
+#include "detector_benchmark.hpp"
+#include "../../main/cpp/detection/detector.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Detect all samples of a [BenchmarkCorpus] for each combination of thread count, detection quality, matching mode
+     * and threshold, and report the latency, memory, energy and accuracy of each configuration. The report allows to
+     * choose the default detection options from the trade-off between their latency, their energy and their accuracy.
+     *
+     * Each sample is matched like a single condition detection on the whole screen, with a new history each time.
+     * The modes forcing a backend match each sample with it when it supports it, and their accuracy and latency are
+     * reported relatively to the default mode, to verify a backend against the expected results before enabling it.
+     * The metric modes do the same for the difference metrics of the conditions.
+     */
+    class DetectionSweep {
+
+    public:
+        /** The matching options of a configuration, the ones changing the matching backends and results. */
+        enum class MatchingMode {
+            DEFAULT,
+            PYRAMID,
+            SPARSE,
+            INTEGER,
+            BINARY,
+            CHAMFER,
+            /** The samples are matched with a single backend, see [MatchBackendSelector::setForcedBackend]. */
+            OPENCV,
+            FFT,
+            SMALL_TEMPLATE,
+            BOUNDED,
+            GEMM,
+            /**
+             * The samples are matched with another [MatchingMetric], see [Detector::setConditionMetrics]. Their hits
+             * and false positives relatively to the default mode calibrate the thresholds of the metric.
+             */
+            SQDIFF_NORMED,
+            SAD,
+        };
+
+    private:
+        /** Tag for the scaling ratio manager, the sweep is part of the application. */
+        static constexpr char const* METRICS_TAG = "com.buzbuz.smartautoclicker.benchmark";
+        /** Duration of the measure of the idle device power, subtracted from the energy of the configurations. */
+        static constexpr int IDLE_POWER_DURATION_MS = 3000;
+
+        /** The measures of the corpus for a configuration. */
+        struct ConfigurationReport {
+            /** The threads of the detector thread pool, 0 without it. */
+            int threadCount = 0;
+            double quality = 0;
+            MatchingMode mode = MatchingMode::DEFAULT;
+            int threshold = 0;
+            /** The latency of all measured detections of all samples. */
+            BenchmarkStats latency;
+            /** The maximum memory of the detector and the processed condition during a sample, in bytes. */
+            int64_t maxMemoryBytes = 0;
+            /** The energy of each measured detection, when the energy is measured. */
+            EnergyValues energy;
+            /** Expected detections found, at any position. */
+            int hitCount = 0;
+            /** Expected detections not found. */
+            int missCount = 0;
+            /** Detections of conditions that are not on the screen. */
+            int falsePositiveCount = 0;
+            /** Conditions not on the screen, and not found. */
+            int rejectCount = 0;
+            /** The mean and maximum distances of the hits with their expected position, in screen pixels. */
+            double meanPositionError = 0;
+            double maxPositionError = 0;
+            /** The mean confidence of the hits, between 0 and 1. */
+            double meanConfidence = 0;
+            /** Hits with a confidence out of the expected band of their sample. */
+            int outOfBandCount = 0;
+            /** Samples matched by the backend of the mode, the other ones by the cheapest one. Forced modes only. */
+            int forcedBackendCount = 0;
+
+            /** The differences with the default mode of the same quality and threshold, positive if higher. */
+            int hitDelta = 0;
+            int falsePositiveDelta = 0;
+            double meanConfidenceDelta = 0;
+            /** The median latency divided by the default mode one, 0 if it can't be computed. */
+            double latencyRatio = 0;
+        };
+
+        const DetectorBenchmark::Config config;
+        Detector detector = Detector();
+        /** The threads of the current detector thread pool, 0 without it. */
+        int threadCount = 0;
+        /** The energy meter, null if the energy is not requested or can't be measured. */
+        std::unique_ptr<EnergyMeter> energyMeter;
+
+        /** Replace the detector thread pool. Negative to use the device default, 0 to remove it. */
+        void setThreadCount(int count);
+        void applyMatchingMode(MatchingMode mode);
+        ConfigurationReport run(BenchmarkCorpus& corpus, double quality, MatchingMode mode, int threshold);
+
+        static const char* getName(MatchingMode mode);
+        /** @return the backend forced by a mode, NONE if the cheapest one is selected. */
+        static MatchBackendType getForcedBackend(MatchingMode mode);
+        /** @return the metric the samples are matched with by a mode. */
+        static MatchingMetric getMetric(MatchingMode mode);
+        static void computeDeltas(ConfigurationReport& report, const ConfigurationReport& reference);
+        static void writeCsv(FILE* file, const std::vector<ConfigurationReport>& reports);
+        static void writeJson(FILE* file, const std::vector<ConfigurationReport>& reports);
+
+    public:
+        /** The iterations, the threads and the energy of the config are used, the thresholds are the swept ones. */
+        explicit DetectionSweep(DetectorBenchmark::Config config);
+
+        DetectionSweep(const DetectionSweep&) = delete;
+        DetectionSweep& operator=(const DetectionSweep&) = delete;
+
+        /**
+         * Sweep all configurations on a corpus, print a summary of each one and write the report.
+         *
+         * @param corpus the samples to detect.
+         * @param qualities the detection qualities to sweep.
+         * @param thresholds the detection thresholds to sweep.
+         * @param threadCounts the thread counts of the detector thread pool to sweep, see [setThreadCount]. Empty for
+         *                     the one of the config.
+         * @param reportPath the report file, in JSON if it ends with ".json", in CSV otherwise. Empty for none.
+         *
+         * @return true if the report has been written, or if none is requested.
+         */
+        bool run(BenchmarkCorpus& corpus, const std::vector<double>& qualities, const std::vector<int>& thresholds,
+                 const std::vector<int>& threadCounts, const std::string& reportPath);
+    };
+}
+
+#endif //KLICK_R_DETECTION_SWEEP_HPP
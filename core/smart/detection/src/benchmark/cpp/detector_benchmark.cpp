@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <utility>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "detector_benchmark.hpp"
+#include "../../main/cpp/detection/gemm_matcher.hpp"
+#include "../../main/cpp/utils/cpu_features.hpp"
+#include "../../main/cpp/utils/frame_allocator.hpp"
+
+#ifdef SMART_DETECTION_VULKAN
+#include "../../main/cpp/gpu/vulkan_matcher.hpp"
+#endif
+
+using namespace smartautoclicker;
+
+
+DetectorBenchmark::DetectorBenchmark(Config config) : config(std::move(config)) {
+    // Opened before the thread pool is created, the events of its threads are counted with the ones of the caller
+    if (this->config.hardwareCounters) {
+        counters = HardwareCounters::open();
+        printf("Hardware counters: %s\n", counters ? "yes" : "unavailable");
+    }
+
+    unsigned int threadCount = this->config.threadCount < 0
+            ? ThreadPool::getDefaultThreadCount()
+            : (unsigned int) this->config.threadCount;
+    if (threadCount > 0) detector.threadPool = std::make_unique<ThreadPool>(threadCount);
+    for (std::shared_ptr<DetectionImage>& image : detector.screenImages) image->isTileHashingEnabled = true;
+    printf("Detector thread pool: %u threads\n", threadCount);
+    // The integer matchers use them when available, their accuracy is reported against cv::matchTemplate
+    printf("Dot product instructions: %s\n", CpuFeatures::hasDotProduct() ? "yes" : "no");
+
+    if (this->config.tessDataPath.empty()) return;
+
+    // Same engines as the detector text conditions
+    OcrEnginePool::Config ocrConfig;
+    ocrConfig.dataPath = this->config.tessDataPath;
+    ocrConfig.language = this->config.tessLanguage;
+    // Loading the trained data is most of the text recognition startup, compared between the Tesseract builds
+    const auto ocrStart = std::chrono::steady_clock::now();
+    ocrEngine = OcrEnginePool::getInstance().acquire(ocrConfig);
+    if (!ocrEngine) {
+        fprintf(stderr, "Can't initialize the OCR engine with %s\n", this->config.tessDataPath.c_str());
+        return;
+    }
+    printf("OCR engine initialization: %.2fms\n", getElapsedUs(ocrStart) / 1000.0);
+}
+
+bool DetectorBenchmark::isOcrReady() const {
+    return config.tessDataPath.empty() || ocrEngine;
+}
+
+void DetectorBenchmark::run(RawImage& screen, RawImage& condition, double detectionQuality) {
+    const int warmup = config.warmupIterations;
+    const int iterations = config.measuredIterations;
+
+    detector.scaleRatioManager.computeScaleRatio(
+            (u_int32_t) screen.width, (u_int32_t) screen.height, detectionQuality, METRICS_TAG);
+    const double scaleRatio = detector.scaleRatioManager.getScaleRatio();
+    detector.screenSignature.clear();
+
+    printf("\n%s (%dx%d) / %s (%dx%d), quality=%.0f, scaleRatio=%.4f\n",
+           screen.name.c_str(), screen.width, screen.height,
+           condition.name.c_str(), condition.width, condition.height,
+           std::min(detectionQuality, (double) std::max(screen.width, screen.height)), scaleRatio);
+
+    // Same processing as Detector::setScreenImage
+    const double screenPixelCount = (double) screen.width * screen.height;
+    auto setScreenImage = [&] {
+        detector.screenImage->processPixels(
+                screen.pixels.data(), screen.width, screen.height, screen.getRowStride(), scaleRatio,
+                detector.threadPool.get());
+        detector.updateScreenSignature(*detector.screenImage);
+        detector.screenImage->frameIndex = detector.screenSignature.getFrameIndex();
+    };
+    report("setScreenImage", measure(warmup, iterations, setScreenImage));
+    countEvents("setScreenImage", screenPixelCount, setScreenImage);
+
+    // Same processing as Detector::copyScreenImage, with the planes from the default and the frame allocators
+    const PixelsBuffer screenPixels = { screen.pixels.data(), screen.width, screen.height, screen.getRowStride() };
+    DetectionImage copiedImage;
+    report("copyScreenImage", measure(warmup, iterations, [&] {
+        copiedImage.processPixelsCopy(screenPixels, scaleRatio, detector.threadPool.get());
+    }));
+    copiedImage.planesAllocator = &FrameAllocator::getInstance();
+    auto copyScreenImage = [&] {
+        copiedImage.processPixelsCopy(screenPixels, scaleRatio, detector.threadPool.get());
+    };
+    report("copyScreenImage (frame allocator)", measure(warmup, iterations, copyScreenImage));
+    countEvents("copyScreenImage (frame allocator)", screenPixelCount, copyScreenImage);
+
+    // Same estimation as Detector::onScreenImageSet, alternately with a copy of the screen image scrolled up
+    const cv::Mat& scaledGray = *detector.screenImage->scaledGray;
+    const int scrollRows = scaledGray.rows / GLOBAL_MOTION_SCROLL_DIVISOR;
+    cv::Mat scrolledGray = cv::Mat::zeros(scaledGray.size(), CV_8UC1);
+    scaledGray.rowRange(scrollRows, scaledGray.rows).copyTo(scrolledGray.rowRange(0, scaledGray.rows - scrollRows));
+    FrameSignature motionSignature;
+    GlobalMotion globalMotion;
+    motionSignature.update(scaledGray);
+    globalMotion.update(scaledGray, motionSignature);
+    bool isScrolled = false;
+    report("globalMotion", measure(warmup, iterations, [&] {
+        isScrolled = !isScrolled;
+        const cv::Mat& image = isScrolled ? scrolledGray : scaledGray;
+        motionSignature.update(image);
+        globalMotion.update(image, motionSignature);
+    }));
+    printf("  %-26s shift=(%d, %d)/%d, found=%d\n", "", globalMotion.getShift().x, globalMotion.getShift().y,
+           isScrolled ? -scrollRows : scrollRows, globalMotion.isShiftedAt(motionSignature.getFrameIndex()));
+
+    ConditionTemplate conditionTemplate;
+    auto processTemplate = [&] {
+        conditionTemplate.processPixels(
+                condition.pixels.data(), condition.width, condition.height, condition.getRowStride(), scaleRatio);
+    };
+    report("processTemplate", measure(warmup, iterations, processTemplate));
+    countEvents("processTemplate", (double) condition.width * condition.height, processTemplate);
+
+    const cv::Size& scaledCondition = conditionTemplate.image.scaledSize;
+    const cv::Size& scaledScreen = detector.screenImage->scaledSize;
+    if (scaledCondition.width > scaledScreen.width || scaledCondition.height > scaledScreen.height) {
+        printf("  Condition is bigger than the screen, skipping matching\n");
+        return;
+    }
+
+    MatchingContext& context = detector.mainContext;
+    context.detectionRoi.setFullSize(detector.screenImage->fullSizeRoi, scaleRatio);
+
+    // A new history and memo for each execution, or the previous result would be reused
+    Detector::MatchHistory history;
+    auto resetHistory = [&] {
+        history = Detector::MatchHistory();
+        detector.matchMemo.clear();
+    };
+    // Each matching mode is counted as the whole matching of the condition, read on the scaled screen
+    const double scaledPixelCount = (double) scaledScreen.area();
+    ConditionResult matchResult;
+    auto match = [&] {
+        matchResult = detector.matchTemplate(conditionTemplate, context, config.threshold, scaleRatio, history, false);
+    };
+
+    detector.isPyramidMatchingEnabled = false;
+    BenchmarkStats stats = measure(warmup, iterations, resetHistory, match);
+    const ConditionResult singleScaleResult = matchResult;
+    reportMatch("match", stats, singleScaleResult);
+    countEvents("match", scaledPixelCount, resetHistory, match);
+
+    detector.isPyramidMatchingEnabled = true;
+    stats = measure(warmup, iterations, resetHistory, match);
+    reportMatch(conditionTemplate.coarseScaledGray.empty() ? "match (pyramid, fallback)" : "match (pyramid)",
+                stats, matchResult);
+    if (!conditionTemplate.coarseScaledGray.empty()) {
+        printf("  %-26s downscale factor=%d\n", "", conditionTemplate.coarseFactor);
+    }
+    countEvents("match (pyramid)", scaledPixelCount, resetHistory, match);
+    detector.isPyramidMatchingEnabled = false;
+
+    detector.isSparseMatchingEnabled = true;
+    stats = measure(warmup, iterations, resetHistory, match);
+    reportMatch(conditionTemplate.sparseGray.isEmpty() ? "match (sparse, fallback)" : "match (sparse)",
+                stats, matchResult);
+    countEvents("match (sparse)", scaledPixelCount, resetHistory, match);
+    detector.isSparseMatchingEnabled = false;
+
+    detector.isBinaryMatchingEnabled = true;
+    stats = measure(warmup, iterations, resetHistory, match);
+    reportMatch(conditionTemplate.binaryGray.isEmpty() ? "match (binary, fallback)" : "match (binary)",
+                stats, matchResult);
+    countEvents("match (binary)", scaledPixelCount, resetHistory, match);
+    detector.isBinaryMatchingEnabled = false;
+
+    // Computed once per frame for all the chamfer matchings, measured apart as they reuse it
+    cv::Mat edgeDistances;
+    report("edgeDistances", measure(warmup, iterations, [&] {
+        ChamferTemplate::computeDistances(*detector.screenImage->scaledGray, edgeDistances);
+    }));
+
+    detector.isChamferMatchingEnabled = true;
+    stats = measure(warmup, iterations, resetHistory, match);
+    reportMatch(conditionTemplate.chamferGray.isEmpty() ? "match (chamfer, fallback)" : "match (chamfer)",
+                stats, matchResult);
+    countEvents("match (chamfer)", scaledPixelCount, resetHistory, match);
+    detector.isChamferMatchingEnabled = false;
+
+    ConditionResult featuresResult;
+    stats = measure(warmup, iterations, resetHistory, [&] {
+        featuresResult = detector.matchTemplate(
+                conditionTemplate, context, config.threshold, scaleRatio, history, true);
+    });
+    reportMatch("match (features)", stats, featuresResult);
+
+    // The matching steps, on the whole screen
+    detector.screenImage->getCropping(context.detectionRoi, context.croppedScaledGray, context.croppedFullSizeColor);
+    const cv::Mat& conditionGray = *conditionTemplate.image.scaledGray;
+    MatchingResults& matchingResults = context.matchingResults;
+    cv::Mat* results = nullptr;
+    auto computeMatchingResults = [&] {
+        context.scratchArena.reset();
+        results = matchingResults.initResults(context.croppedScaledGray, conditionGray, context.scratchArena);
+        cv::matchTemplate(context.croppedScaledGray, conditionGray, *results, cv::TM_CCOEFF_NORMED);
+    };
+
+    const MatchRequest request = {
+            &context.croppedScaledGray, &conditionTemplate, Detector::getMinConfidence(config.threshold) };
+    printf("  %-26s %s\n", "selected backend", detector.matchBackends.select(request, context).getName());
+
+    const double croppedPixelCount = (double) context.croppedScaledGray.total();
+    report("cv::matchTemplate", measure(warmup, iterations, computeMatchingResults));
+    countEvents("cv::matchTemplate", croppedPixelCount, computeMatchingResults);
+    // Reference of the matching results, for the accuracy of the integer matchers
+    const cv::Mat referenceResults = results->clone();
+    auto fftMatch = [&] {
+        context.scratchArena.reset();
+        const cv::Mat spectrum = conditionTemplate.getSpectrum(
+                FftMatcher::getTransformSize(context.croppedScaledGray.size()));
+        context.fftMatcher.match(
+                context.croppedScaledGray,
+                conditionGray,
+                spectrum,
+                *matchingResults.initResults(context.croppedScaledGray, conditionGray, context.scratchArena));
+    };
+    report("FftMatcher", measure(warmup, iterations, fftMatch));
+    countEvents("FftMatcher", croppedPixelCount, fftMatch);
+    if (SmallTemplateMatcher::isSupported(conditionGray.size())) {
+        report("SmallTemplateMatcher", measure(warmup, iterations, [&] {
+            context.scratchArena.reset();
+            context.smallTemplateMatcher.match(
+                    context.croppedScaledGray,
+                    conditionGray,
+                    conditionTemplate.grayStatistics,
+                    *(results = matchingResults.initResults(
+                            context.croppedScaledGray, conditionGray, context.scratchArena)));
+        }));
+        reportAccuracy(referenceResults, *results);
+    }
+    if (IntegerMatcher::isSupported(conditionGray.size())) {
+        auto integerMatch = [&] {
+            context.scratchArena.reset();
+            context.integerMatcher.match(
+                    context.croppedScaledGray,
+                    conditionGray,
+                    conditionTemplate.grayStatistics,
+                    *(results = matchingResults.initResults(
+                            context.croppedScaledGray, conditionGray, context.scratchArena)));
+        };
+        report("IntegerMatcher", measure(warmup, iterations, integerMatch));
+        reportAccuracy(referenceResults, *results);
+        countEvents("IntegerMatcher", croppedPixelCount, integerMatch);
+        // With the candidates extraction, without the results matrix
+        report("IntegerMatcher (streamed)", measure(warmup, iterations, [&] {
+            matchingResults.beginStreaming(request.getResultsSize(), request.minConfidence);
+            context.integerMatcher.matchStreamed(
+                    context.croppedScaledGray, conditionGray, conditionTemplate.grayStatistics, matchingResults);
+            matchingResults.endStreaming();
+        }));
+    }
+    if (GemmMatcher::isSupported(conditionGray.size())) {
+        // The same condition several times, as the small conditions of a detection searched in the same area
+        static constexpr size_t GEMM_BENCHMARK_BATCH_SIZE = 4;
+        GemmMatcher gemmMatcher;
+        std::vector<cv::Mat> gemmResults(GEMM_BENCHMARK_BATCH_SIZE);
+        std::vector<GemmMatcher::Job> gemmJobs;
+        for (cv::Mat& gemmResult : gemmResults) {
+            gemmJobs.push_back({ &conditionGray, &conditionTemplate.grayStatistics, &gemmResult });
+        }
+        report("GemmMatcher (4 conditions)", measure(warmup, iterations, [&] {
+            gemmMatcher.match(context.croppedScaledGray, gemmJobs);
+        }));
+        reportAccuracy(referenceResults, gemmResults.front());
+    }
+
+    // A single position, as for the exact conditions
+    cv::Point referenceMaxLoc;
+    cv::minMaxLoc(referenceResults, nullptr, nullptr, nullptr, &referenceMaxLoc);
+    float positionValue = 0;
+    report("matchPosition", measure(warmup, iterations, [&] {
+        positionValue = IntegerMatcher::matchPosition(
+                context.croppedScaledGray, referenceMaxLoc, conditionGray, conditionTemplate.grayStatistics);
+    }));
+    printf("  %-26s diff with cv::matchTemplate=%.6f\n", "",
+           std::abs(positionValue - referenceResults.at<float>(referenceMaxLoc)));
+
+    // The integral images are computed once per screen image, only the selection of the positions is measured
+    cv::Mat sums, squaredSums;
+    detector.screenImage->getScaledGrayIntegrals(sums, squaredSums);
+    size_t prefilteredCount = 0;
+    report("PositionPrefilter", measure(warmup, iterations, [&] {
+        prefilteredCount = context.positionPrefilter.filter(
+                sums, squaredSums, context.detectionRoi.scaled, conditionGray.size(), conditionTemplate.grayStatistics,
+                config.threshold * 255.0 * 3 / 100 + PREFILTER_MEAN_MARGIN).size();
+    }));
+    printf("  %-26s kept %zu of %zu positions\n", "", prefilteredCount, referenceResults.total());
+    if (!conditionTemplate.exactPixelsHash.isEmpty() && detector.screenImage->colorScale == 1.0) {
+        bool isExactFound = false;
+        cv::Point exactLocation;
+        report("ExactPixelMatcher", measure(warmup, iterations, [&] {
+            isExactFound = context.exactPixelMatcher.find(
+                    context.croppedFullSizeColor, conditionTemplate.exactPixelsHash, exactLocation);
+        }));
+        printf("  %-26s found=%d\n", "", isExactFound);
+
+        // Built once per screen image for all conditions, then probed by each of them
+        TileHashIndex tileIndex;
+        report("TileHashIndex::build", measure(warmup, iterations, [&] {
+            tileIndex.build(*detector.screenImage->fullSizeColor);
+        }));
+        if (!conditionTemplate.exactTiles.isEmpty()) {
+            bool isIndexed = false;
+            report("TileHashIndex::find", measure(warmup, iterations, [&] {
+                isIndexed = tileIndex.find(*detector.screenImage->fullSizeColor, conditionTemplate.exactTiles,
+                                           conditionTemplate.exactPixelsHash, context.detectionRoi.fullSize,
+                                           context.tileCandidates, exactLocation, isExactFound);
+            }));
+            printf("  %-26s indexed=%d found=%d\n", "", isIndexed, isExactFound);
+        }
+    }
+#ifdef SMART_DETECTION_VULKAN
+    // The screen and the condition are uploaded during the warmup, only the dispatch and the results are measured
+    std::unique_ptr<VulkanMatcher> vulkanMatcher = VulkanMatcher::create();
+    const cv::Rect vulkanArea = context.detectionRoi.scaled & detector.screenImage->scaledRoi;
+    if (vulkanMatcher && vulkanMatcher->isBatchSupported(vulkanArea.size(), conditionGray.size())) {
+        cv::Mat vulkanResults;
+        std::vector<MatchBackend::Job> vulkanJobs = { { &conditionTemplate, vulkanArea, &vulkanResults } };
+        report("VulkanMatcher", measure(warmup, iterations, [&] {
+            vulkanMatcher->matchBatch(*detector.screenImage, vulkanJobs);
+        }));
+        reportAccuracy(referenceResults, vulkanResults);
+    }
+#endif
+    if (!conditionTemplate.sparseGray.isEmpty()) {
+        report("SparseMatcher", measure(warmup, iterations, [&] {
+            context.scratchArena.reset();
+            context.sparseMatcher.match(
+                    context.croppedScaledGray,
+                    conditionTemplate.sparseGray,
+                    *matchingResults.initResults(context.croppedScaledGray, conditionGray, context.scratchArena));
+        }));
+    }
+    if (conditionGray.rows >= 2) {
+        // With at least the bounded matching confidence, even if the threshold of the benchmark is looser
+        const double minConfidence = std::max(
+                Detector::getMinConfidence(config.threshold), BOUNDED_MATCHING_MIN_CONFIDENCE);
+        report("BoundedMatcher", measure(warmup, iterations, [&] {
+            context.scratchArena.reset();
+            context.boundedMatcher.match(
+                    context.croppedScaledGray,
+                    conditionGray,
+                    minConfidence,
+                    *matchingResults.initResults(context.croppedScaledGray, conditionGray, context.scratchArena));
+        }));
+    }
+    report("locate candidates x10", measure(warmup, iterations, computeMatchingResults, [&] {
+        matchingResults.extractCandidates(Detector::getMinConfidence(config.threshold));
+        for (int i = 0; i < LOCATED_CANDIDATES_COUNT; i++) {
+            if (!matchingResults.locateNextCandidate(conditionGray, scaleRatio)) break;
+        }
+    }));
+    // A new frame index for each iteration, forcing all levels to be computed again
+    const uint64_t screenFrameIndex = detector.screenImage->frameIndex;
+    report("pyramid levels", measure(warmup, iterations, [&] {
+        detector.screenImage->frameIndex++;
+        detector.screenImage->getCoarseScaledGray(1 << PYRAMID_LEVELS_COUNT);
+    }));
+    detector.screenImage->frameIndex = screenFrameIndex;
+    // A new frame index for each iteration, forcing the sums to be computed again
+    uint64_t colorIntegralFrame = 0;
+    report("ColorIntegral", measure(warmup, iterations, [&] {
+        detector.screenColorIntegral.update(*detector.screenImage->fullSizeColor, ++colorIntegralFrame);
+    }));
+    report("ColorIntegral (scaled)", measure(warmup, iterations, [&] {
+        detector.screenColorIntegral.update(
+                *detector.screenImage->fullSizeColor, ++colorIntegralFrame, detector.screenImage->scaledSize);
+    }));
+    report("getCandidateColorDiff", measure(warmup, iterations, [&] {
+        detector.getCandidateColorDiff(conditionTemplate, context);
+    }));
+    // The template full size color is released once processed, use a screen area of the same size
+    const cv::Mat candidateColor = (*detector.screenImage->fullSizeColor)(
+            cv::Rect(0, 0, conditionTemplate.image.fullSizeRoi.width, conditionTemplate.image.fullSizeRoi.height)
+            & cv::Rect(0, 0, detector.screenImage->fullSizeColor->cols, detector.screenImage->fullSizeColor->rows));
+    report("ColorHistogram", measure(warmup, iterations, [&] {
+        ColorHistogram candidateHistogram;
+        candidateHistogram.compute(candidateColor);
+    }));
+
+    if (ocrEngine) benchmarkOcr(conditionTemplate, singleScaleResult);
+}
+
+void DetectorBenchmark::benchmarkOcr(const ConditionTemplate& conditionTemplate, const ConditionResult& matchResult) {
+    // Recognize the text in the area of the best match, at full size
+    const cv::Size conditionSize = conditionTemplate.image.fullSizeRoi.size();
+    const cv::Rect ocrRoi = cv::Rect(
+            matchResult.centerX - conditionSize.width / 2,
+            matchResult.centerY - conditionSize.height / 2,
+            conditionSize.width,
+            conditionSize.height) & detector.screenImage->fullSizeRoi;
+    if (ocrRoi.empty()) return;
+
+    const int warmup = std::min(config.warmupIterations, 1);
+    const int iterations = std::min(config.measuredIterations, OCR_MAX_ITERATIONS);
+    const cv::Mat ocrImage = (*detector.screenImage->fullSizeColor)(ocrRoi);
+    report("ocrPreprocessing", measure(warmup, config.measuredIterations, [&] {
+        detector.ocrPreprocessor.process(ocrImage);
+    }));
+
+    std::string text;
+    const cv::Mat& preprocessedImage = detector.ocrPreprocessor.process(ocrImage);
+    report("ocr", measure(warmup, iterations, [&] {
+        Detector::recognizeText(*ocrEngine, preprocessedImage, nullptr, text);
+    }));
+
+    // Same area on an unchanged screen, the text comes from the detector cache
+    detector.ocrTextCache.clear();
+    detector.ocrTextCache.put(OcrTextCache::hash(ocrImage), text);
+    report("ocr (cached)", measure(warmup, config.measuredIterations, [&] {
+        detector.ocrTextCache.find(OcrTextCache::hash(ocrImage));
+    }));
+}
+
+void DetectorBenchmark::report(const char* step, const BenchmarkStats& stats) {
+    printf("  %-26s median=%9.3fms  min=%9.3fms  max=%9.3fms  mean=%9.3fms\n",
+           step, stats.medianUs / 1000, stats.minUs / 1000, stats.maxUs / 1000, stats.meanUs / 1000);
+}
+
+void DetectorBenchmark::reportCounters(const char* step, const CounterValues& values, double pixelCount) {
+    auto ratio = [](double value, double total) { return value >= 0 && total > 0 ? value / total : -1; };
+    auto print = [](const char* name, double value, const char* format) {
+        if (value < 0) printf("  %s=n/a", name);
+        else printf(format, name, value);
+    };
+
+    // The bytes of the last level cache misses are the ones read from the memory, compared to its bandwidth
+    printf("  %-26s", step);
+    print("ipc", ratio(values.instructions, values.cycles), "  %s=%.2f");
+    print("cycles/px", ratio(values.cycles, pixelCount), "  %s=%.2f");
+    print("l1d misses/px", ratio(values.l1dMisses, pixelCount), "  %s=%.3f");
+    print("dram bytes/px", ratio(values.lastLevelMisses * CACHE_LINE_SIZE, pixelCount), "  %s=%.2f");
+    print("frontend stalls", ratio(values.frontendStalls * 100, values.cycles), "  %s=%.0f%%");
+    print("backend stalls", ratio(values.backendStalls * 100, values.cycles), "  %s=%.0f%%");
+    printf("\n");
+}
+
+void DetectorBenchmark::reportAccuracy(const cv::Mat& referenceResults, const cv::Mat& results) {
+    printf("  %-26s max diff with cv::matchTemplate=%.6f\n", "", cv::norm(referenceResults, results, cv::NORM_INF));
+}
+
+void DetectorBenchmark::reportMatch(const char* step, const BenchmarkStats& stats, const ConditionResult& result) {
+    report(step, stats);
+    printf("  %-26s detected=%d at [%d, %d], confidence=%.4f\n",
+           "", result.isDetected, result.centerX, result.centerY, result.confidenceRate);
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DETECTOR_BENCHMARK_HPP
+#define KLICK_R_DETECTOR_BENCHMARK_HPP
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "benchmark_corpus.hpp"
+#include "benchmark_counters.hpp"
+#include "benchmark_timer.hpp"
+#include "../../main/cpp/detection/detector.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Measure each step of the [Detector] on raw images, outside of the JVM.
+     * The steps are executed the same way as the JNI calls do, but without the bitmaps and java results objects.
+     */
+    class DetectorBenchmark {
+
+    public:
+        struct Config {
+            /** Number of executions of each step before measuring. */
+            int warmupIterations = 5;
+            /** Number of measured executions of each step. */
+            int measuredIterations = 30;
+            /** The detection threshold. The default one always returns the best match, like the instrumented tests. */
+            int threshold = 100;
+            /** Number of threads for the detector thread pool. Negative to use the device default, 0 to disable it. */
+            int threadCount = -1;
+            /** The directory containing the tesseract trained data. Empty to skip the OCR step. */
+            std::string tessDataPath;
+            /** The language of the OCR engine. */
+            std::string tessLanguage = "eng";
+            /** True to count the hardware events of the main steps, executed again apart from the measured ones. */
+            bool hardwareCounters = false;
+            /** True to measure the energy of the sweep configurations and of the replays, see [EnergyMeter]. */
+            bool energy = false;
+        };
+
+    private:
+        /** Tag for the scaling ratio manager, the benchmark is part of the application. */
+        static constexpr char const* METRICS_TAG = "com.buzbuz.smartautoclicker.benchmark";
+        /** Number of candidates located in the matching results by the candidates location step. */
+        static constexpr int LOCATED_CANDIDATES_COUNT = 10;
+        /** Maximum number of measured executions of the OCR step, a lot slower than the matching. */
+        static constexpr int OCR_MAX_ITERATIONS = 10;
+        /** The scroll of the screen measured by the global motion estimation, relative to its height. */
+        static constexpr int GLOBAL_MOTION_SCROLL_DIVISOR = 8;
+        /** Size of the cache lines, the bytes read from the memory for each last level cache miss. */
+        static constexpr int CACHE_LINE_SIZE = 64;
+
+        const Config config;
+        Detector detector = Detector();
+        /** The OCR engine, empty if the OCR step is skipped. */
+        OcrEnginePool::Lease ocrEngine;
+        /** The hardware counters, null if they are not requested or can't be opened. */
+        std::unique_ptr<HardwareCounters> counters;
+
+        void benchmarkOcr(const ConditionTemplate& conditionTemplate, const ConditionResult& matchResult);
+
+        /**
+         * Count the hardware events of a step when the counters are enabled, and report them.
+         * @param pixelCount the number of pixels processed by the step, for the per pixel values.
+         */
+        template <typename Prepare, typename Step>
+        void countEvents(const char* step, double pixelCount, Prepare&& prepare, Step&& execute) {
+            if (!counters) return;
+            reportCounters(step, measureCounters(*counters, config.measuredIterations, prepare, execute), pixelCount);
+        }
+
+        /** Same as [countEvents], for a step without state to reset between executions. */
+        template <typename Step>
+        void countEvents(const char* step, double pixelCount, Step&& execute) {
+            countEvents(step, pixelCount, [] {}, std::forward<Step>(execute));
+        }
+
+        static void report(const char* step, const BenchmarkStats& stats);
+        static void reportCounters(const char* step, const CounterValues& values, double pixelCount);
+        static void reportAccuracy(const cv::Mat& referenceResults, const cv::Mat& results);
+        static void reportMatch(const char* step, const BenchmarkStats& stats, const ConditionResult& result);
+
+    public:
+        explicit DetectorBenchmark(Config config);
+
+        DetectorBenchmark(const DetectorBenchmark&) = delete;
+        DetectorBenchmark& operator=(const DetectorBenchmark&) = delete;
+
+        /** @return true if the OCR engine is ready, or if the OCR step is not requested. */
+        bool isOcrReady() const;
+
+        /**
+         * Measure all detector steps for a condition on a screen, at a detection quality.
+         * The images pixels are not copied and must remain valid during the run.
+         */
+        void run(RawImage& screen, RawImage& condition, double detectionQuality);
+    };
+}
+
+#endif //KLICK_R_DETECTOR_BENCHMARK_HPP
@@ -0,0 +1,323 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "benchmark_corpus.hpp"
+#include "detection_replay.hpp"
+#include "detection_sweep.hpp"
+#include "detector_benchmark.hpp"
+#include "scaling_benchmark.hpp"
+
+using namespace smartautoclicker;
+
+/*
+ * Native benchmark of the detector, executed on the device outside of the application:
+ *
+ * detector_benchmark --screen <file> <width> <height> --condition <file> <width> <height> [options]
+ * detector_benchmark --replay <file> [options]
+ * detector_benchmark --sweep <corpus> [--sweep-threshold <value>]... [--sweep-threads <count>]... [--report <file>]
+ *                    [options]
+ * detector_benchmark --scaling [--scaling-conditions <count>]... [--scaling-size <width> <height>]...
+ *                    [--scaling-template <size>] [--scaling-roi <type>] [--scaling-threshold <value>]
+ *                    [--report <file>] [options]
+ *
+ *   --screen, --condition  a raw RGBA image, in the instrumented tests format. Can be repeated, each condition is
+ *                          benchmarked against each screen.
+ *   --replay <file>        a detection capture written by the application with the detection capture setting, its
+ *                          detections are replayed instead of benchmarking the steps. Can be repeated.
+ *   --sweep <corpus>       a corpus manifest, see BenchmarkCorpus. Its samples are detected with each combination of
+ *                          quality, matching mode and threshold instead of benchmarking the steps.
+ *   --sweep-threshold <value>  a detection threshold of the sweep. Can be repeated, defaults to 5, 10 and 20.
+ *   --sweep-threads <count>    a thread count of the detector thread pool for the sweep. Can be repeated, defaults to
+ *                              the --threads value.
+ *   --scaling              detect generated scenarios on generated screens, see SyntheticWorkload, for each
+ *                          combination of conditions count and frame size instead of benchmarking the steps.
+ *                          Fails if a whole screen batch of several text conditions is not detected in parallel.
+ *   --scaling-conditions <count>    a conditions count of the scaling scenarios. Can be repeated, defaults to 1, 10,
+ *                                   100 and 1000.
+ *   --scaling-size <width> <height> a frame size of the scaling screens. Can be repeated, defaults to 720p, 1080p,
+ *                                   1440p and 4K.
+ *   --scaling-template <size>       the conditions size on a 1080 pixels wide screen.
+ *   --scaling-roi <type>            the conditions areas: whole_screen, in_area, exact or mixed.
+ *   --scaling-threshold <value>     the conditions detection threshold.
+ *   --report <file>        the file of the sweep or scaling report, in JSON if it ends with .json, in CSV otherwise.
+ *   --quality <value>      a detection quality. Can be repeated, defaults to the instrumented tests resolutions. The
+ *                          scaling benchmark uses the first one, the scenarios default quality otherwise.
+ *   --warmup <count>       executions of each step before measuring.
+ *   --iterations <count>   measured executions of each step.
+ *   --threshold <value>    the detection threshold.
+ *   --threads <count>      threads of the detector thread pool, 0 to disable it.
+ *   --tessdata <dir>       the tesseract trained data directory, enables the OCR step.
+ *   --language <lang>      the OCR language.
+ *   --counters             count the hardware events of the main steps with perf_event_open, and report their
+ *                          instructions per cycle, cache misses and memory bytes per pixel.
+ *   --energy               measure the energy of the replayed frames and of the sweep detections, from the battery
+ *                          current and voltage, and from the power rails on the devices with a power monitor. The
+ *                          device must be unplugged, or the battery current is the charging one.
+ *
+ * See run_detector_benchmark.sh to build, push and run it with the instrumented tests images, or to replay a capture.
+ */
+
+/** Same values as the instrumented tests DetectionResolution. */
+static const std::vector<double> DEFAULT_QUALITIES = {
+        std::numeric_limits<double>::max(), 2500, 2112, 1723, 1501, 1262, 1014, 723, 400,
+};
+
+/** Thresholds of the sweep, from the strict ones of the exact conditions to the loosest default ones. */
+static const std::vector<int> DEFAULT_SWEEP_THRESHOLDS = { 5, 10, 20 };
+
+/** Conditions counts of the scaling benchmark, from a single condition to the largest scenarios. */
+static const std::vector<int> DEFAULT_SCALING_CONDITIONS = { 1, 10, 100, 1000 };
+/** Frame sizes of the scaling benchmark, portrait screens from 720p to 4K. */
+static const std::vector<cv::Size> DEFAULT_SCALING_SIZES = {
+        cv::Size(720, 1280), cv::Size(1080, 1920), cv::Size(1440, 2560), cv::Size(2160, 3840),
+};
+/** The default detection quality of the scenarios, used by the scaling benchmark without --quality. */
+static constexpr double DEFAULT_SCALING_QUALITY = 1200;
+
+static void printUsage(const char* executable) {
+    fprintf(stderr,
+            "Usage: %s --screen <file> <width> <height> --condition <file> <width> <height> "
+            "[--quality <value>]... [--warmup <count>] [--iterations <count>] [--threshold <value>] "
+            "[--threads <count>] [--tessdata <dir> [--language <lang>]] [--counters]\n"
+            "       %s --replay <file> [--warmup <count>] [--iterations <count>] [--threads <count>] [--energy]\n"
+            "       %s --sweep <corpus> [--sweep-threshold <value>]... [--sweep-threads <count>]... "
+            "[--report <file>] [--quality <value>]... [--warmup <count>] [--iterations <count>] "
+            "[--threads <count>] [--energy]\n"
+            "       %s --scaling [--scaling-conditions <count>]... [--scaling-size <width> <height>]... "
+            "[--scaling-template <size>] [--scaling-roi <whole_screen|in_area|exact|mixed>] "
+            "[--scaling-threshold <value>] [--report <file>] [--quality <value>] [--warmup <count>] "
+            "[--iterations <count>] [--threads <count>]\n",
+            executable, executable, executable, executable);
+}
+
+static bool parseInt(const char* value, int& result) {
+    char* end = nullptr;
+    long parsed = strtol(value, &end, 10);
+    if (end == value || *end != '\0') return false;
+
+    result = (int) parsed;
+    return true;
+}
+
+static bool parseRoiType(const char* value, SyntheticWorkload::RoiType& result) {
+    static constexpr SyntheticWorkload::RoiType ROI_TYPES[] = {
+            SyntheticWorkload::RoiType::WHOLE_SCREEN,
+            SyntheticWorkload::RoiType::IN_AREA,
+            SyntheticWorkload::RoiType::EXACT,
+            SyntheticWorkload::RoiType::MIXED,
+    };
+
+    for (SyntheticWorkload::RoiType roiType : ROI_TYPES) {
+        if (strcmp(value, SyntheticWorkload::getName(roiType)) != 0) continue;
+
+        result = roiType;
+        return true;
+    }
+    return false;
+}
+
+static bool parseImage(char** argv, int argc, int& index, std::vector<RawImage>& images) {
+    int width;
+    int height;
+    if (index + 3 >= argc || !parseInt(argv[index + 2], width) || !parseInt(argv[index + 3], height)) return false;
+
+    images.emplace_back();
+    if (!RawImage::load(argv[index + 1], width, height, images.back())) return false;
+
+    index += 3;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<RawImage> screens;
+    std::vector<RawImage> conditions;
+    std::vector<double> qualities;
+    std::vector<std::string> replays;
+    std::string sweepCorpus;
+    std::vector<int> sweepThresholds;
+    std::vector<int> sweepThreadCounts;
+    bool isScaling = false;
+    std::vector<int> scalingConditionCounts;
+    std::vector<cv::Size> scalingSizes;
+    SyntheticWorkload::Config scalingWorkload;
+    std::string reportPath;
+    DetectorBenchmark::Config config;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        bool isValid;
+
+        if (strcmp(arg, "--screen") == 0) {
+            isValid = parseImage(argv, argc, i, screens);
+        } else if (strcmp(arg, "--condition") == 0) {
+            isValid = parseImage(argv, argc, i, conditions);
+        } else if (strcmp(arg, "--replay") == 0 && hasValue) {
+            replays.emplace_back(argv[++i]);
+            isValid = true;
+        } else if (strcmp(arg, "--sweep") == 0 && hasValue) {
+            sweepCorpus = argv[++i];
+            isValid = true;
+        } else if (strcmp(arg, "--sweep-threshold") == 0 && hasValue) {
+            int threshold;
+            isValid = parseInt(argv[++i], threshold) && threshold >= 0 && threshold <= 100;
+            sweepThresholds.push_back(threshold);
+        } else if (strcmp(arg, "--sweep-threads") == 0 && hasValue) {
+            int threadCount;
+            isValid = parseInt(argv[++i], threadCount) && threadCount >= 0;
+            sweepThreadCounts.push_back(threadCount);
+        } else if (strcmp(arg, "--scaling") == 0) {
+            isScaling = true;
+            isValid = true;
+        } else if (strcmp(arg, "--scaling-conditions") == 0 && hasValue) {
+            int conditionCount;
+            isValid = parseInt(argv[++i], conditionCount) && conditionCount > 0;
+            scalingConditionCounts.push_back(conditionCount);
+        } else if (strcmp(arg, "--scaling-size") == 0 && i + 2 < argc) {
+            cv::Size size;
+            isValid = parseInt(argv[i + 1], size.width) && parseInt(argv[i + 2], size.height)
+                    && size.width > 0 && size.height > 0;
+            scalingSizes.push_back(size);
+            i += 2;
+        } else if (strcmp(arg, "--scaling-template") == 0 && hasValue) {
+            isValid = parseInt(argv[++i], scalingWorkload.templateSize) && scalingWorkload.templateSize > 0;
+        } else if (strcmp(arg, "--scaling-roi") == 0 && hasValue) {
+            isValid = parseRoiType(argv[++i], scalingWorkload.roiType);
+        } else if (strcmp(arg, "--scaling-threshold") == 0 && hasValue) {
+            isValid = parseInt(argv[++i], scalingWorkload.threshold) && scalingWorkload.threshold >= 0
+                    && scalingWorkload.threshold <= 100;
+        } else if (strcmp(arg, "--report") == 0 && hasValue) {
+            reportPath = argv[++i];
+            isValid = true;
+        } else if (strcmp(arg, "--quality") == 0 && hasValue) {
+            int quality;
+            isValid = parseInt(argv[++i], quality) && quality > 0;
+            qualities.push_back(quality);
+        } else if (strcmp(arg, "--warmup") == 0 && hasValue) {
+            isValid = parseInt(argv[++i], config.warmupIterations) && config.warmupIterations >= 0;
+        } else if (strcmp(arg, "--iterations") == 0 && hasValue) {
+            isValid = parseInt(argv[++i], config.measuredIterations) && config.measuredIterations > 0;
+        } else if (strcmp(arg, "--threshold") == 0 && hasValue) {
+            isValid = parseInt(argv[++i], config.threshold);
+        } else if (strcmp(arg, "--threads") == 0 && hasValue) {
+            isValid = parseInt(argv[++i], config.threadCount);
+        } else if (strcmp(arg, "--tessdata") == 0 && hasValue) {
+            config.tessDataPath = argv[++i];
+            isValid = true;
+        } else if (strcmp(arg, "--language") == 0 && hasValue) {
+            config.tessLanguage = argv[++i];
+            isValid = true;
+        } else if (strcmp(arg, "--counters") == 0) {
+            config.hardwareCounters = true;
+            isValid = true;
+        } else if (strcmp(arg, "--energy") == 0) {
+            config.energy = true;
+            isValid = true;
+        } else {
+            isValid = false;
+        }
+
+        if (!isValid) {
+            fprintf(stderr, "Invalid argument %s\n", arg);
+            printUsage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (!replays.empty()) {
+        DetectionReplay replay(config);
+
+        printf("---------- Detection replay START ----------\n");
+        for (const std::string& path : replays) {
+            DetectionCapture capture;
+            if (!capture.read(path)) {
+                fprintf(stderr, "Invalid detection capture %s\n", path.c_str());
+                return EXIT_FAILURE;
+            }
+
+            printf("\n%s\n", path.c_str());
+            replay.run(capture);
+        }
+        printf("---------- Detection replay END ----------\n");
+
+        return EXIT_SUCCESS;
+    }
+
+    if (!sweepCorpus.empty()) {
+        BenchmarkCorpus corpus;
+        if (!BenchmarkCorpus::load(sweepCorpus, corpus)) return EXIT_FAILURE;
+        if (sweepThresholds.empty()) sweepThresholds = DEFAULT_SWEEP_THRESHOLDS;
+        if (qualities.empty()) {
+            // The full size quality as the largest screen of the corpus, to be reported with its value
+            int maxScreenDimension = 0;
+            for (const CorpusSample& sample : corpus.samples) {
+                maxScreenDimension = std::max({ maxScreenDimension, sample.screen->width, sample.screen->height });
+            }
+            for (double quality : DEFAULT_QUALITIES) {
+                qualities.push_back(std::min(quality, (double) maxScreenDimension));
+            }
+        }
+
+        DetectionSweep sweep(config);
+        printf("---------- Detection sweep START ----------\n");
+        const bool isReported = sweep.run(corpus, qualities, sweepThresholds, sweepThreadCounts, reportPath);
+        printf("---------- Detection sweep END ----------\n");
+
+        return isReported ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (isScaling) {
+        if (scalingConditionCounts.empty()) scalingConditionCounts = DEFAULT_SCALING_CONDITIONS;
+        if (scalingSizes.empty()) scalingSizes = DEFAULT_SCALING_SIZES;
+        const double quality = qualities.empty() ? DEFAULT_SCALING_QUALITY : qualities.front();
+
+        ScalingBenchmark scaling(config);
+        printf("---------- Scaling benchmark START ----------\n");
+        const bool isReported = scaling.run(scalingConditionCounts, scalingSizes, scalingWorkload, quality,
+                                            reportPath);
+        printf("---------- Scaling benchmark END ----------\n");
+
+        return isReported ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (screens.empty() || conditions.empty()) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (qualities.empty()) qualities = DEFAULT_QUALITIES;
+
+    DetectorBenchmark benchmark(config);
+    if (!benchmark.isOcrReady()) return EXIT_FAILURE;
+
+    printf("---------- Detector benchmark START ----------\n");
+    for (RawImage& screen : screens) {
+        for (RawImage& condition : conditions) {
+            for (double quality : qualities) benchmark.run(screen, condition, quality);
+        }
+    }
+    printf("---------- Detector benchmark END ----------\n");
+
+    return EXIT_SUCCESS;
+}
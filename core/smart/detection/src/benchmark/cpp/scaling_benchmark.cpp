@@ -0,0 +1,230 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <utility>
+
+#include "scaling_benchmark.hpp"
+
+using namespace smartautoclicker;
+
+
+ScalingBenchmark::ScalingBenchmark(DetectorBenchmark::Config config) : config(std::move(config)) {}
+
+int ScalingBenchmark::setThreadCount(Detector& detector, int count) {
+    const unsigned int poolThreadCount = count < 0 ? ThreadPool::getDefaultThreadCount() : (unsigned int) count;
+    detector.threadPool.reset();
+    if (poolThreadCount > 0) detector.threadPool = std::make_unique<ThreadPool>(poolThreadCount);
+    return (int) poolThreadCount;
+}
+
+void ScalingBenchmark::resetDetections(Detector& detector) {
+    detector.clearMatchHistories();
+    detector.matchMemo.clear();
+}
+
+bool ScalingBenchmark::isBatchParallel(Detector& detector, const ScenarioPlan& plan) {
+    if (detector.threadPool == nullptr) return true;
+
+    const auto event = std::find_if(plan.events.begin(), plan.events.end(),
+            [](const PlannedEvent& plannedEvent) { return plannedEvent.conditionCount > 1; });
+    if (event == plan.events.end()) return true;
+
+    // The processing identifies each image condition with its name
+    static const std::string identifying = "benchmark";
+    const auto firstRequest = plan.conditions.begin() + event->firstCondition;
+    std::vector<DetectionRequest> requests(firstRequest, firstRequest + event->conditionCount);
+    for (DetectionRequest& request : requests) {
+        request.roi = cv::Rect();
+        request.identifying = &identifying;
+    }
+
+    // Only prepared for the workers, a serial batch leaves them empty
+    std::vector<ConditionResult> results;
+    detector.batchConditions.clear();
+    detector.detectBatch(requests, BATCH_OPERATOR_AND, results, 0);
+    return detector.batchConditions.size() == requests.size();
+}
+
+bool ScalingBenchmark::run(const std::vector<int>& conditionCounts, const std::vector<cv::Size>& frameSizes,
+                           const SyntheticWorkload::Config& workloadConfig, double quality,
+                           const std::string& reportPath) {
+
+    printf("\nSynthetic workloads: %zu conditions counts, %zu frame sizes, template=%dpx roi=%s threshold=%d "
+           "absent=%d%% quality=%.0f\n",
+           conditionCounts.size(), frameSizes.size(), workloadConfig.templateSize,
+           SyntheticWorkload::getName(workloadConfig.roiType), workloadConfig.threshold,
+           workloadConfig.absentPercent, quality);
+
+    std::vector<ScalingReport> reports;
+    bool isEveryBatchParallel = true;
+    for (const cv::Size& frameSize : frameSizes) {
+        for (int conditionCount : conditionCounts) {
+            // A new detector for each combination, without the caches and histories of the previous one
+            auto detector = std::make_unique<Detector>();
+            const ScalingReport& report = reports.emplace_back(
+                    run(*detector, frameSize, conditionCount, workloadConfig, quality));
+
+            printf("  %4dx%-4d conditions=%-4d screen=%8.3fms prepare=%9.3fms sequential=%9.3fms "
+                   "plan=%9.3fms steady=%9.3fms perCondition=%7.1fus memory=%6.1fMB hit=%d miss=%d "
+                   "falsePositive=%d reject=%d",
+                   report.width, report.height, report.conditionCount, report.screen.medianUs / 1000,
+                   report.prepare.medianUs / 1000, report.sequential.medianUs / 1000,
+                   report.planCold.medianUs / 1000, report.planSteady.medianUs / 1000,
+                   report.planCold.medianUs / report.conditionCount, (double) report.memoryBytes / (1024 * 1024),
+                   report.hitCount, report.missCount, report.falsePositiveCount, report.rejectCount);
+            if (report.pixelsNeededCount > 0) printf(" pixelsNeeded=%d", report.pixelsNeededCount);
+            if (!report.isBatchParallel) printf(" serialBatch");
+            printf("\n");
+            isEveryBatchParallel &= report.isBatchParallel;
+        }
+    }
+
+    if (!isEveryBatchParallel) fprintf(stderr, "Whole screen batches have been detected serially\n");
+    if (reportPath.empty()) return isEveryBatchParallel;
+
+    FILE* file = fopen(reportPath.c_str(), "w");
+    if (file == nullptr) {
+        fprintf(stderr, "Can't open report %s\n", reportPath.c_str());
+        return false;
+    }
+
+    const std::string jsonExtension = ".json";
+    const bool isJson = reportPath.size() >= jsonExtension.size()
+            && reportPath.compare(reportPath.size() - jsonExtension.size(), jsonExtension.size(), jsonExtension) == 0;
+    if (isJson) writeJson(file, reports);
+    else writeCsv(file, reports);
+
+    const bool isWritten = ferror(file) == 0;
+    fclose(file);
+    if (isWritten) printf("\nReport written to %s\n", reportPath.c_str());
+    return isWritten && isEveryBatchParallel;
+}
+
+ScalingBenchmark::ScalingReport ScalingBenchmark::run(Detector& detector, const cv::Size& frameSize,
+                                                      int conditionCount,
+                                                      const SyntheticWorkload::Config& workloadConfig,
+                                                      double quality) {
+
+    SyntheticWorkload::Config generation = workloadConfig;
+    generation.conditionCount = conditionCount;
+    workload.generate(frameSize.width, frameSize.height, generation);
+
+    ScalingReport report;
+    report.width = frameSize.width;
+    report.height = frameSize.height;
+    report.conditionCount = conditionCount;
+    report.quality = quality;
+    report.threadCount = setThreadCount(detector, config.threadCount);
+    report.iterations = std::clamp(MAX_MEASURED_DETECTIONS / std::max(conditionCount, 1), MIN_MEASURED_ITERATIONS,
+                                   std::max(config.measuredIterations, MIN_MEASURED_ITERATIONS));
+    const int warmupIterations = std::min(config.warmupIterations, report.iterations);
+
+    const RawImage& screen = workload.screen;
+    const PixelsBuffer screenPixels { (uint8_t*) screen.pixels.data(), screen.width, screen.height,
+                                      screen.getRowStride() };
+    detector.setScreenMetrics(METRICS_TAG, screen.width, screen.height, quality);
+
+    // The signature is cleared so the unchanged screen is processed again each time
+    report.screen = measure(warmupIterations, report.iterations,
+            [&] { detector.screenSignature.clear(); },
+            [&] { detector.setScreenImage(screenPixels); });
+
+    const std::vector<const PixelsBuffer*> conditionPixels = [&] {
+        std::vector<const PixelsBuffer*> pixels;
+        for (const PixelsBuffer& buffer : workload.conditionBuffers) pixels.push_back(&buffer);
+        return pixels;
+    }();
+    report.prepare = measure(warmupIterations, report.iterations,
+            [&] { detector.removeTemplates(workload.conditionIds); },
+            [&] { detector.prepareTemplates(workload.conditionIds, conditionPixels); });
+
+    std::vector<ConditionResult> results(conditionCount);
+    report.sequential = measure(warmupIterations, report.iterations,
+            [&] { resetDetections(detector); },
+            [&] {
+                for (int i = 0; i < conditionCount; i++) {
+                    const DetectionRequest& request = workload.plan.conditions[i];
+                    results[i] = request.roi.empty()
+                            ? detector.detectCondition(request.conditionId, request.conditionPixels, request.threshold)
+                            : detector.detectCondition(request.conditionId, request.conditionPixels, request.roi,
+                                                       request.threshold);
+                }
+            });
+
+    for (int i = 0; i < conditionCount; i++) {
+        if (workload.isPresent[i] && results[i].isDetected) report.hitCount++;
+        else if (workload.isPresent[i]) report.missCount++;
+        else if (results[i].isDetected) report.falsePositiveCount++;
+        else report.rejectCount++;
+    }
+
+    // Same handling of the evicted templates as the processing, they are prepared again and the plan detected again
+    std::vector<ConditionResult> planResults;
+    std::vector<int> processedCounts;
+    auto detectPlan = [&] {
+        if (detector.detectScenario(workload.plan, planResults, processedCounts) != SCENARIO_PIXELS_NEEDED) return;
+
+        report.pixelsNeededCount++;
+        detector.prepareTemplates(workload.conditionIds, conditionPixels);
+        detector.detectScenario(workload.plan, planResults, processedCounts);
+    };
+    report.planCold = measure(warmupIterations, report.iterations,
+            [&] { resetDetections(detector); },
+            detectPlan);
+    report.planSteady = measure(warmupIterations, report.iterations,
+            [&] { detector.setScreenImage(screenPixels); },
+            detectPlan);
+
+    report.memoryBytes = detector.computeMemoryUsage().getTotal();
+    report.isBatchParallel = isBatchParallel(detector, workload.plan);
+    return report;
+}
+
+void ScalingBenchmark::writeCsv(FILE* file, const std::vector<ScalingReport>& reports) {
+    fprintf(file, "width,height,conditions,quality,threads,iterations,screen_ms,prepare_ms,sequential_ms,"
+                  "plan_ms,plan_p90_ms,steady_ms,plan_per_condition_us,memory_bytes,hits,misses,false_positives,"
+                  "rejects,pixels_needed\n");
+    for (const ScalingReport& report : reports) {
+        fprintf(file, "%d,%d,%d,%.0f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f,%lld,%d,%d,%d,%d,%d\n",
+                report.width, report.height, report.conditionCount, report.quality, report.threadCount,
+                report.iterations, report.screen.medianUs / 1000, report.prepare.medianUs / 1000,
+                report.sequential.medianUs / 1000, report.planCold.medianUs / 1000, report.planCold.p90Us / 1000,
+                report.planSteady.medianUs / 1000, report.planCold.medianUs / report.conditionCount,
+                (long long) report.memoryBytes, report.hitCount, report.missCount, report.falsePositiveCount,
+                report.rejectCount, report.pixelsNeededCount);
+    }
+}
+
+void ScalingBenchmark::writeJson(FILE* file, const std::vector<ScalingReport>& reports) {
+    fprintf(file, "[\n");
+    for (size_t i = 0; i < reports.size(); i++) {
+        const ScalingReport& report = reports[i];
+        fprintf(file, "  {\"width\": %d, \"height\": %d, \"conditions\": %d, \"quality\": %.0f, \"threads\": %d, "
+                      "\"iterations\": %d, \"screenMs\": %.3f, \"prepareMs\": %.3f, \"sequentialMs\": %.3f, "
+                      "\"planMs\": %.3f, \"planP90Ms\": %.3f, \"steadyMs\": %.3f, \"planPerConditionUs\": %.2f, "
+                      "\"memoryBytes\": %lld, \"hits\": %d, \"misses\": %d, \"falsePositives\": %d, "
+                      "\"rejects\": %d, \"pixelsNeeded\": %d}%s\n",
+                report.width, report.height, report.conditionCount, report.quality, report.threadCount,
+                report.iterations, report.screen.medianUs / 1000, report.prepare.medianUs / 1000,
+                report.sequential.medianUs / 1000, report.planCold.medianUs / 1000, report.planCold.p90Us / 1000,
+                report.planSteady.medianUs / 1000, report.planCold.medianUs / report.conditionCount,
+                (long long) report.memoryBytes, report.hitCount, report.missCount, report.falsePositiveCount,
+                report.rejectCount, report.pixelsNeededCount, i + 1 < reports.size() ? "," : "");
+    }
+    fprintf(file, "]\n");
+}
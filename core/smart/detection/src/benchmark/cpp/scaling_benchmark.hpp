@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCALING_BENCHMARK_HPP
+#define KLICK_R_SCALING_BENCHMARK_HPP
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/core/types.hpp>
+
+#include "benchmark_timer.hpp"
+#include "detector_benchmark.hpp"
+#include "synthetic_workload.hpp"
+#include "../../main/cpp/detection/detector.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Measure how the detection of a scenario scales with its number of conditions and with the size of the frames,
+     * on [SyntheticWorkload]s generated for each combination of them.
+     *
+     * Each combination is measured on a new detector, for the steps the processing executes for each frame: the
+     * screen image processing, the templates preparation, the detection of each condition one after the other like
+     * the JNI calls of the conditions, and the detection of the whole scenario plan with [Detector::detectScenario],
+     * with a new history each time and in the steady state of an unchanged screen. The report has one line per
+     * combination, to plot the latencies against the conditions count and the frame size.
+     */
+    class ScalingBenchmark {
+
+    private:
+        /** Tag for the scaling ratio manager, the benchmark is part of the application. */
+        static constexpr char const* METRICS_TAG = "com.buzbuz.smartautoclicker.benchmark";
+        /**
+         * Maximum number of conditions detections of a measured step, its iterations are reduced for the large
+         * scenarios to keep the run in minutes. They are never less than [MIN_MEASURED_ITERATIONS].
+         */
+        static constexpr int MAX_MEASURED_DETECTIONS = 2000;
+        static constexpr int MIN_MEASURED_ITERATIONS = 3;
+
+        /** The measures of a conditions count on a frame size. */
+        struct ScalingReport {
+            int width = 0;
+            int height = 0;
+            int conditionCount = 0;
+            double quality = 0;
+            /** The threads of the detector thread pool, 0 without it. */
+            int threadCount = 0;
+            /** The measured executions of each step. */
+            int iterations = 0;
+            BenchmarkStats screen;
+            BenchmarkStats prepare;
+            /** All conditions detected one after the other, with a new history each time. */
+            BenchmarkStats sequential;
+            /** The scenario plan detected with a new history each time. */
+            BenchmarkStats planCold;
+            /** The scenario plan detected again on the same screen, with the histories of the previous detection. */
+            BenchmarkStats planSteady;
+            /** The memory of the detector after the detections, in bytes. */
+            int64_t memoryBytes = 0;
+            /** The results of the sequential detections, against the generated positions of the conditions. */
+            int hitCount = 0;
+            int missCount = 0;
+            int falsePositiveCount = 0;
+            int rejectCount = 0;
+            /** The plan detections that had to prepare the templates again, evicted from the templates cache. */
+            int pixelsNeededCount = 0;
+            /** False if a whole screen batch of text conditions have been detected serially, see [isBatchParallel]. */
+            bool isBatchParallel = true;
+        };
+
+        const DetectorBenchmark::Config config;
+        SyntheticWorkload workload;
+
+        ScalingReport run(Detector& detector, const cv::Size& frameSize, int conditionCount,
+                          const SyntheticWorkload::Config& workloadConfig, double quality);
+
+        /** Replace the detector thread pool. Negative to use the device default, 0 to remove it. */
+        static int setThreadCount(Detector& detector, int count);
+        /** Forget the previous detections, so the next ones are made again instead of being reused. */
+        static void resetDetections(Detector& detector);
+        /**
+         * Detect the conditions of the first event with several of them as a whole screen batch, each one identified
+         * by a text like the image conditions of the processing batches, and check the workers have matched them.
+         *
+         * @return true if the batch is detected in parallel, or if the detector has no thread pool or the plan no
+         *         event with several conditions.
+         */
+        static bool isBatchParallel(Detector& detector, const ScenarioPlan& plan);
+        static void writeCsv(FILE* file, const std::vector<ScalingReport>& reports);
+        static void writeJson(FILE* file, const std::vector<ScalingReport>& reports);
+
+    public:
+        /** The iterations and the threads of the config are used, the threshold is the workload one. */
+        explicit ScalingBenchmark(DetectorBenchmark::Config config);
+
+        ScalingBenchmark(const ScalingBenchmark&) = delete;
+        ScalingBenchmark& operator=(const ScalingBenchmark&) = delete;
+
+        /**
+         * Measure each combination of conditions count and frame size, print a summary of each one and write the
+         * report.
+         *
+         * @param conditionCounts the numbers of conditions of the generated scenarios.
+         * @param frameSizes the sizes of the generated screens.
+         * @param workloadConfig the options of the generated workloads, its conditions count is replaced by each one
+         *                       of [conditionCounts].
+         * @param quality the detection quality.
+         * @param reportPath the report file, in JSON if it ends with ".json", in CSV otherwise. Empty for none.
+         *
+         * @return true if the report has been written, or if none is requested, and all whole screen batches have been
+         *         detected in parallel.
+         */
+        bool run(const std::vector<int>& conditionCounts, const std::vector<cv::Size>& frameSizes,
+                 const SyntheticWorkload::Config& workloadConfig, double quality, const std::string& reportPath);
+    };
+}
+
+#endif //KLICK_R_SCALING_BENCHMARK_HPP
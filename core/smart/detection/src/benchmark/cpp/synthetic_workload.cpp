@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <string>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "synthetic_workload.hpp"
+#include "../../main/cpp/detection/detector.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The width of the screen the layout sizes are defined for, they are scaled with the screen width. */
+static constexpr int REFERENCE_WIDTH = 1080;
+static constexpr int STATUS_BAR_HEIGHT = 72;
+static constexpr int CARD_HEIGHT = 220;
+static constexpr int CARD_MARGIN = 32;
+static constexpr int BUTTON_WIDTH = 240;
+static constexpr int MAX_CARD_COLUMNS = 3;
+static constexpr double FONT_SCALE = 1.2;
+
+/** The text of the cards and buttons. */
+static const char* const WORDS[] = {
+        "Play", "Settings", "Level 12", "Score", "Collect", "Reward", "Shop", "Daily bonus", "Start", "Continue",
+};
+static constexpr int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+/** Incremented for each generated plan, the detector rebuilds its plan tables only when the revision changes. */
+static uint64_t lastPlanRevision = 0;
+
+static cv::Scalar getRandomColor(cv::RNG& rng, int minLevel, int maxLevel) {
+    return { (double) rng.uniform(minLevel, maxLevel), (double) rng.uniform(minLevel, maxLevel),
+             (double) rng.uniform(minLevel, maxLevel), 255 };
+}
+
+/** Set the alpha channel of RGBA pixels to opaque, after a processing changing all channels. */
+static void setOpaque(cv::Mat& image) {
+    cv::insertChannel(cv::Mat(image.size(), CV_8UC1, cv::Scalar(255)), image, 3);
+}
+
+static void drawText(cv::Mat& image, const char* text, const cv::Point& origin, double scale,
+                     const cv::Scalar& color) {
+    cv::putText(image, text, origin, cv::FONT_HERSHEY_SIMPLEX, FONT_SCALE * scale, color,
+                std::max(1, (int) (2 * scale)), cv::LINE_AA);
+}
+
+/** Draw a card of the layout, and add its elements to the ones the conditions are cropped from. */
+static void drawCard(cv::Mat& image, const cv::Rect& card, double scale, cv::RNG& rng,
+                     std::vector<cv::Rect>& elements) {
+
+    const cv::Scalar textColor = getRandomColor(rng, 0, 64);
+    cv::rectangle(image, card, getRandomColor(rng, 192, 256), cv::FILLED);
+    cv::rectangle(image, card, getRandomColor(rng, 96, 160), std::max(1, (int) (3 * scale)));
+    elements.push_back(card);
+
+    const int padding = card.height / 8;
+    const cv::Rect icon(card.x + padding, card.y + padding, card.height - padding * 2, card.height - padding * 2);
+    if (rng.uniform(0, 2) == 0) {
+        cv::circle(image, (icon.tl() + icon.br()) / 2, icon.width / 2, getRandomColor(rng, 32, 256), cv::FILLED,
+                   cv::LINE_AA);
+    } else {
+        cv::rectangle(image, icon, getRandomColor(rng, 32, 256), cv::FILLED);
+    }
+    cv::rectangle(image, cv::Rect(icon.x + icon.width / 4, icon.y + icon.height / 4, icon.width / 2, icon.height / 2),
+                  getRandomColor(rng, 0, 256), cv::FILLED);
+    elements.push_back(icon);
+
+    const int textX = icon.br().x + padding;
+    if (textX >= card.br().x - padding) return;
+
+    const int lineHeight = card.height / 4;
+    drawText(image, WORDS[rng.uniform(0, WORD_COUNT)], cv::Point(textX, card.y + lineHeight), scale, textColor);
+    drawText(image, WORDS[rng.uniform(0, WORD_COUNT)], cv::Point(textX, card.y + lineHeight * 2), scale * 0.7,
+             textColor);
+    elements.emplace_back(textX, card.y + padding, card.br().x - padding - textX, lineHeight * 2 - padding);
+
+    const int buttonWidth = std::min(card.br().x - padding - textX, (int) (BUTTON_WIDTH * scale));
+    if (buttonWidth <= 0) return;
+
+    const cv::Rect button(textX, card.y + lineHeight * 2 + padding, buttonWidth, lineHeight + padding);
+    cv::rectangle(image, button, getRandomColor(rng, 0, 192), cv::FILLED);
+    drawText(image, WORDS[rng.uniform(0, WORD_COUNT)], cv::Point(button.x + padding, button.br().y - padding),
+             scale * 0.8, cv::Scalar(255, 255, 255, 255));
+    elements.push_back(button);
+}
+
+void SyntheticWorkload::generate(int width, int height, const Config& config) {
+    cv::RNG rng(config.seed);
+    const double scale = (double) width / REFERENCE_WIDTH;
+
+    screen.name = "synthetic_" + std::to_string(width) + "x" + std::to_string(height);
+    screen.width = width;
+    screen.height = height;
+    screen.pixels.assign(screen.getRowStride() * height, 0);
+    cv::Mat image(height, width, CV_8UC4, screen.pixels.data());
+
+    // Vertical gradient background
+    const cv::Scalar top = getRandomColor(rng, 128, 256);
+    const cv::Scalar bottom = getRandomColor(rng, 0, 128);
+    for (int y = 0; y < height; y++) {
+        const double ratio = height > 1 ? (double) y / (height - 1) : 0;
+        image.row(y).setTo(top * (1 - ratio) + bottom * ratio);
+    }
+
+    std::vector<cv::Rect> elements = { cv::Rect(0, 0, width, height) };
+    const int statusBarHeight = std::max(1, (int) (STATUS_BAR_HEIGHT * scale));
+    cv::rectangle(image, cv::Rect(0, 0, width, statusBarHeight), getRandomColor(rng, 0, 48), cv::FILLED);
+    drawText(image, "12:34", cv::Point(statusBarHeight / 2, statusBarHeight * 3 / 4), scale,
+             cv::Scalar(255, 255, 255, 255));
+    elements.emplace_back(0, 0, statusBarHeight * 4, statusBarHeight);
+
+    // Rows of cards, with a random number of columns each
+    const int margin = std::max(1, (int) (CARD_MARGIN * scale));
+    const int cardHeight = std::max(8, (int) (CARD_HEIGHT * scale));
+    for (int y = statusBarHeight + margin; y + cardHeight <= height - margin; y += cardHeight + margin) {
+        const int columns = rng.uniform(1, MAX_CARD_COLUMNS + 1);
+        const int cardWidth = (width - margin * (columns + 1)) / columns;
+        if (cardWidth < cardHeight) continue;
+
+        for (int column = 0; column < columns; column++) {
+            drawCard(image, cv::Rect(margin + column * (cardWidth + margin), y, cardWidth, cardHeight), scale, rng,
+                     elements);
+        }
+    }
+
+    if (config.noiseAmplitude > 0) {
+        cv::Mat noise(height, width, CV_16SC4);
+        rng.fill(noise, cv::RNG::UNIFORM, -config.noiseAmplitude, config.noiseAmplitude + 1);
+        cv::Mat noisy;
+        image.convertTo(noisy, CV_16SC4);
+        noisy += noise;
+        noisy.convertTo(image, CV_8UC4);
+        setOpaque(image);
+    }
+
+    // Conditions cropped around the elements, the absent ones with their colors inverted
+    const int conditionSize = std::min({ std::max(8, (int) (config.templateSize * scale)), width, height });
+    conditions.clear();
+    conditions.resize(config.conditionCount);
+    conditionBuffers.resize(config.conditionCount);
+    conditionIds.resize(config.conditionCount);
+    isPresent.resize(config.conditionCount);
+    positions.resize(config.conditionCount);
+    for (int i = 0; i < config.conditionCount; i++) {
+        const cv::Rect& element = elements[rng.uniform(0, (int) elements.size())];
+        const int jitter = conditionSize / 4;
+        const int x = element.x + element.width / 2 - conditionSize / 2 + rng.uniform(-jitter, jitter + 1);
+        const int y = element.y + element.height / 2 - conditionSize / 2 + rng.uniform(-jitter, jitter + 1);
+        positions[i] = cv::Rect(std::clamp(x, 0, width - conditionSize), std::clamp(y, 0, height - conditionSize),
+                                conditionSize, conditionSize);
+        isPresent[i] = rng.uniform(0, 100) >= config.absentPercent;
+        conditionIds[i] = i + 1;
+
+        RawImage& condition = conditions[i];
+        condition.name = "condition_" + std::to_string(i + 1);
+        condition.width = conditionSize;
+        condition.height = conditionSize;
+        condition.pixels.resize(condition.getRowStride() * conditionSize);
+        cv::Mat conditionImage(conditionSize, conditionSize, CV_8UC4, condition.pixels.data());
+        image(positions[i]).copyTo(conditionImage);
+        if (!isPresent[i]) {
+            cv::bitwise_not(conditionImage, conditionImage);
+            setOpaque(conditionImage);
+        }
+
+        conditionBuffers[i] = PixelsBuffer {
+                condition.pixels.data(), condition.width, condition.height, condition.getRowStride() };
+    }
+
+    plan.clear();
+    plan.revision = ++lastPlanRevision;
+    const int conditionsPerEvent = std::max(config.conditionsPerEvent, 1);
+    for (int first = 0; first < config.conditionCount; first += conditionsPerEvent) {
+        PlannedEvent& event = plan.events.emplace_back();
+        event.eventId = (int64_t) plan.events.size();
+        event.conditionOperator = BATCH_OPERATOR_AND;
+        // All events are evaluated, as if none of them was fulfilled
+        event.keepDetecting = true;
+        event.firstCondition = first;
+        event.conditionCount = std::min(conditionsPerEvent, config.conditionCount - first);
+    }
+    for (int i = 0; i < config.conditionCount; i++) {
+        DetectionRequest& request = plan.conditions.emplace_back();
+        request.conditionId = conditionIds[i];
+        request.conditionPixels = &conditionBuffers[i];
+        request.roi = getRoi(getRoiType(config, i), positions[i]);
+        request.threshold = config.threshold;
+    }
+}
+
+SyntheticWorkload::RoiType SyntheticWorkload::getRoiType(const Config& config, int conditionIndex) const {
+    if (config.roiType != RoiType::MIXED) return config.roiType;
+
+    static constexpr RoiType MIXED_TYPES[] = { RoiType::WHOLE_SCREEN, RoiType::IN_AREA, RoiType::EXACT };
+    return MIXED_TYPES[conditionIndex % 3];
+}
+
+cv::Rect SyntheticWorkload::getRoi(RoiType roiType, const cv::Rect& position) const {
+    switch (roiType) {
+        case RoiType::EXACT:
+            return position;
+        case RoiType::IN_AREA: {
+            const cv::Rect area(position.x - position.width, position.y - position.height, position.width * 3,
+                                position.height * 3);
+            return area & cv::Rect(0, 0, screen.width, screen.height);
+        }
+        case RoiType::WHOLE_SCREEN:
+        default:
+            return {};
+    }
+}
+
+const char* SyntheticWorkload::getName(RoiType roiType) {
+    switch (roiType) {
+        case RoiType::WHOLE_SCREEN: return "whole_screen";
+        case RoiType::IN_AREA: return "in_area";
+        case RoiType::EXACT: return "exact";
+        case RoiType::MIXED:
+        default: return "mixed";
+    }
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SYNTHETIC_WORKLOAD_HPP
+#define KLICK_R_SYNTHETIC_WORKLOAD_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/types.hpp>
+
+#include "benchmark_corpus.hpp"
+#include "../../main/cpp/types/pixels_buffer.hpp"
+#include "../../main/cpp/types/scenario_plan.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * A generated screen and a scenario of conditions on it, to measure how the detection scales with the number of
+     * conditions and with the frame size without having to capture a corpus for each of them.
+     *
+     * The screen looks like an application layout: a gradient background, a status bar, cards with an icon and text
+     * lines, and buttons, with some noise over them. The conditions are cropped from its elements so they are found
+     * at their position, and the absent ones are cropped the same way with their colors inverted. The conditions are
+     * grouped in events of the scenario plan, see [Config::conditionsPerEvent].
+     */
+    class SyntheticWorkload {
+
+    public:
+        /** The area the conditions are searched in. */
+        enum class RoiType {
+            /** The whole screen, like the conditions detected anywhere. */
+            WHOLE_SCREEN,
+            /** An area around the condition position, like the conditions detected in an area. */
+            IN_AREA,
+            /** The condition position, like the exact conditions. */
+            EXACT,
+            /** Each type in turn. */
+            MIXED,
+        };
+
+        struct Config {
+            int conditionCount = 10;
+            /** The size of the conditions on a 1080 pixels wide screen, scaled with the width of the screen. */
+            int templateSize = 96;
+            RoiType roiType = RoiType::MIXED;
+            /** The detection threshold of all conditions. */
+            int threshold = 10;
+            /** The percentage of conditions that are not on the screen. */
+            int absentPercent = 25;
+            /** The number of conditions of each event, detected with the AND operator. */
+            int conditionsPerEvent = 4;
+            /** The amplitude of the noise over the screen, in color levels. */
+            int noiseAmplitude = 6;
+            /** The seed of the generation, the same seed and sizes always give the same workload. */
+            uint32_t seed = 1;
+        };
+
+        RawImage screen;
+        std::vector<RawImage> conditions;
+        std::vector<PixelsBuffer> conditionBuffers;
+        std::vector<int64_t> conditionIds;
+        /** True for the conditions cropped from the screen, at the same index than their identifier. */
+        std::vector<bool> isPresent;
+        /** The area of the conditions on the screen, at the same index than their identifier. */
+        std::vector<cv::Rect> positions;
+        /** The events of the scenario, its requests pointing to the [conditionBuffers]. */
+        ScenarioPlan plan;
+
+        SyntheticWorkload() = default;
+        SyntheticWorkload(const SyntheticWorkload&) = delete;
+        SyntheticWorkload& operator=(const SyntheticWorkload&) = delete;
+
+        /**
+         * Generate a workload, replacing the current one.
+         *
+         * @param width the width of the screen, in pixels.
+         * @param height the height of the screen, in pixels.
+         * @param config the options of the generation.
+         */
+        void generate(int width, int height, const Config& config);
+
+        static const char* getName(RoiType roiType);
+
+    private:
+        RoiType getRoiType(const Config& config, int conditionIndex) const;
+        cv::Rect getRoi(RoiType roiType, const cv::Rect& position) const;
+    };
+}
+
+#endif //KLICK_R_SYNTHETIC_WORKLOAD_HPP
@@ -0,0 +1,182 @@
+#!/usr/bin/env sh
+#
+# Copyright (C) 2025 Kevin Buzeau
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Build the native detector benchmark, push it to the connected device with the instrumented tests images, and run it.
+#
+# Usage: run_detector_benchmark.sh [Debug|Release] [benchmark options...]
+# Only the release build measures the optimized OpenCV, the debug one uses the prebuilts.
+# Extra options are forwarded to the benchmark, e.g. --quality 1501 --iterations 100 --threads 0
+#
+# With CAPTURE set to a detection capture written by the application detection capture setting, its detections are
+# replayed instead of the instrumented tests images ones:
+#   adb pull /sdcard/Android/data/<application id>/files/detection_capture.kdrc
+#   CAPTURE=detection_capture.kdrc run_detector_benchmark.sh Release
+#
+# With SWEEP set to a corpus manifest (see benchmark_corpus.hpp), its directory is pushed and its samples are detected
+# with each quality, matching mode and threshold. The report is written with --report, and pulled by the caller:
+#   SWEEP=corpus/manifest.txt run_detector_benchmark.sh Release --report sweep.csv
+# The corpus of the instrumented tests, with their expected results, is swept with:
+#   SWEEP=src/androidTest/res/raw/detection_corpus.txt run_detector_benchmark.sh Release --report sweep.csv
+# The sqdiff_normed and sad modes of the report calibrate the thresholds of the difference metrics against the
+# correlation: their hits and false positives at each threshold are compared to the default mode ones.
+#
+# With SCALING set, generated scenarios from 1 to 1000 conditions are detected on generated screens from 720p to 4K,
+# without any image to push. The report has one line per combination, to plot the latencies against them:
+#   SCALING=1 run_detector_benchmark.sh Release --report scaling.csv
+#
+# With HOST set, the detection core and the benchmark are built and run on this machine instead, against the system
+# OpenCV and tesseract, without any device:
+#   HOST=1 run_detector_benchmark.sh Release
+#
+# With PGO set, the library is built instrumented, the capture is replayed to record the execution profile of the
+# detection, and the merged profile is written to src/pgo/detection.profdata, used by the next release builds. The
+# llvm-profdata of the NDK is used, from ANDROID_NDK or LLVM_PROFDATA:
+#   PGO=1 CAPTURE=detection_capture.kdrc ANDROID_NDK=<ndk path> run_detector_benchmark.sh Release
+# With TESSERACT_FROM_SOURCE set, Tesseract and Leptonica are built from sources and linked statically, to compare the
+# OCR engine initialization and the ocr steps with the ones of the tesseract4android prebuilts:
+#   TESSERACT_FROM_SOURCE=1 run_detector_benchmark.sh Release --tessdata <trained data directory>
+# The hardware counters of the main steps are reported with --counters. On the device, the shell can only open them
+# once they are allowed:
+#   adb shell setprop security.perf_harden 0
+#   run_detector_benchmark.sh Release --counters
+# The energy per frame of a replay, and per detection of each sweep configuration, is reported with --energy. The
+# device must be unplugged, over adb wifi, with the screen on and the other applications closed: the battery current is
+# sampled, and the power rails counters are read on the devices with a power monitor (e.g. Pixel 6 and newer). The
+# sweep compares the thread counts of the detector thread pool with --sweep-threads:
+#   adb tcpip 5555 && adb connect <device ip>:5555
+#   SWEEP=src/androidTest/res/raw/detection_corpus.txt run_detector_benchmark.sh Release --energy \
+#       --sweep-threads 0 --sweep-threads 2 --sweep-threads 4 --report sweep.csv
+# SKIP_BUILD skips the gradle build, when it is already made by the generateNativeDetectionProfile gradle task.
+
+set -e
+
+BUILD_TYPE="${1:-Release}"
+[ $# -gt 0 ] && shift
+
+MODULE_DIR="$(cd "$(dirname "$0")/../.." && pwd)"
+PROJECT_DIR="$(cd "$MODULE_DIR/../../.." && pwd)"
+RAW_DIR="$MODULE_DIR/src/androidTest/res/raw"
+DEVICE_DIR="/data/local/tmp/detector_benchmark"
+PGO_PROFILE="${PGO_PROFILE:-$MODULE_DIR/src/pgo/detection.profdata}"
+
+if [ -n "$HOST" ]; then
+    HOST_BUILD_DIR="$MODULE_DIR/build/host_benchmark/$BUILD_TYPE"
+    cmake -S "$MODULE_DIR/src" -B "$HOST_BUILD_DIR" -DCMAKE_BUILD_TYPE="$BUILD_TYPE"
+    cmake --build "$HOST_BUILD_DIR" --target detector_benchmark -j
+
+    if [ -n "$CAPTURE" ]; then
+        exec "$HOST_BUILD_DIR/detector_benchmark" --replay "$CAPTURE" "$@"
+    fi
+    if [ -n "$SWEEP" ]; then
+        exec "$HOST_BUILD_DIR/detector_benchmark" --sweep "$SWEEP" "$@"
+    fi
+    if [ -n "$SCALING" ]; then
+        exec "$HOST_BUILD_DIR/detector_benchmark" --scaling "$@"
+    fi
+    exec "$HOST_BUILD_DIR/detector_benchmark" \
+        --screen "$RAW_DIR/screen_1" 1344 2992 \
+        --condition "$RAW_DIR/condition_1" 198 192 \
+        "$@"
+fi
+
+ABI="$(adb shell getprop ro.product.cpu.abi | tr -d '\r')"
+
+if [ -n "$PGO" ] && [ -z "$CAPTURE" ]; then
+    echo "The execution profile is recorded by replaying a detection capture, set CAPTURE" >&2
+    exit 1
+fi
+if [ -z "$SKIP_BUILD" ]; then
+    "$PROJECT_DIR/gradlew" -p "$PROJECT_DIR" ":core:smart:detection:externalNativeBuild$BUILD_TYPE" \
+        -PdetectionNativeBenchmark=true \
+        -PdetectionNativePgoGenerate="$([ -n "$PGO" ] && echo true || echo false)" \
+        -PdetectionTesseractFromSource="$([ -n "$TESSERACT_FROM_SOURCE" ] && echo true || echo false)"
+fi
+
+# The release native build directory is named after the default cmake build type of the variant, RelWithDebInfo. Each
+# set of cmake arguments has its own directory, the last built one is used.
+if [ "$BUILD_TYPE" = "Debug" ]; then CXX_DIR="Debug"; else CXX_DIR="Rel*"; fi
+BENCHMARK="$(find "$MODULE_DIR/build/intermediates/cxx" -path "*/cxx/$CXX_DIR/*/obj/$ABI/detector_benchmark" -type f \
+    -exec ls -t {} + | head -n 1)"
+if [ -z "$BENCHMARK" ]; then
+    echo "Can't find the detector_benchmark executable for $ABI" >&2
+    exit 1
+fi
+LIBS_DIR="$(dirname "$BENCHMARK")"
+
+adb shell mkdir -p "$DEVICE_DIR"
+adb push "$BENCHMARK" "$LIBS_DIR"/*.so "$DEVICE_DIR/"
+if [ "$BUILD_TYPE" = "Debug" ]; then
+    adb push "$MODULE_DIR/src/debug/opencv/libs/$ABI/"*.so "$DEVICE_DIR/"
+fi
+
+if [ -n "$PGO" ]; then
+    adb push "$CAPTURE" "$DEVICE_DIR/"
+    adb shell "rm -f $DEVICE_DIR/*.profraw"
+    adb shell "cd $DEVICE_DIR && chmod +x detector_benchmark && LD_LIBRARY_PATH=. \
+        LLVM_PROFILE_FILE=$DEVICE_DIR/detection-%p.profraw ./detector_benchmark \
+        --replay $(basename "$CAPTURE") \
+        $*"
+
+    PROFRAW_DIR="$MODULE_DIR/build/pgo/profraw"
+    rm -rf "$PROFRAW_DIR" && mkdir -p "$PROFRAW_DIR"
+    for PROFRAW in $(adb shell "ls $DEVICE_DIR/*.profraw" | tr -d '\r'); do
+        adb pull "$PROFRAW" "$PROFRAW_DIR/"
+    done
+
+    if [ -z "$LLVM_PROFDATA" ]; then
+        LLVM_PROFDATA="$(find "$ANDROID_NDK/toolchains/llvm/prebuilt" -name llvm-profdata -type f | head -n 1)"
+    fi
+    if [ -z "$LLVM_PROFDATA" ]; then
+        echo "Can't find llvm-profdata, set ANDROID_NDK or LLVM_PROFDATA" >&2
+        exit 1
+    fi
+    mkdir -p "$(dirname "$PGO_PROFILE")"
+    "$LLVM_PROFDATA" merge -output="$PGO_PROFILE" "$PROFRAW_DIR"/*.profraw
+    echo "Execution profile written to $PGO_PROFILE"
+    exit 0
+fi
+
+if [ -n "$CAPTURE" ]; then
+    adb push "$CAPTURE" "$DEVICE_DIR/"
+    adb shell "cd $DEVICE_DIR && chmod +x detector_benchmark && LD_LIBRARY_PATH=. ./detector_benchmark \
+        --replay $(basename "$CAPTURE") \
+        $*"
+    exit 0
+fi
+
+if [ -n "$SWEEP" ]; then
+    SWEEP_DIR="$(cd "$(dirname "$SWEEP")" && pwd)"
+    adb shell rm -rf "$DEVICE_DIR/sweep"
+    adb push "$SWEEP_DIR" "$DEVICE_DIR/sweep"
+    adb shell "cd $DEVICE_DIR && chmod +x detector_benchmark && LD_LIBRARY_PATH=. ./detector_benchmark \
+        --sweep sweep/$(basename "$SWEEP") \
+        $*"
+    exit 0
+fi
+
+if [ -n "$SCALING" ]; then
+    adb shell "cd $DEVICE_DIR && chmod +x detector_benchmark && LD_LIBRARY_PATH=. ./detector_benchmark --scaling $*"
+    exit 0
+fi
+
+adb push "$RAW_DIR/screen_1" "$RAW_DIR/condition_1" "$DEVICE_DIR/"
+
+# Image sizes are the same as in the instrumented tests TestImages
+adb shell "cd $DEVICE_DIR && chmod +x detector_benchmark && LD_LIBRARY_PATH=. ./detector_benchmark \
+    --screen screen_1 1344 2992 \
+    --condition condition_1 198 192 \
+    $*"
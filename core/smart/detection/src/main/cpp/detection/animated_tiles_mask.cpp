@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "animated_tiles_mask.hpp"
+
+using namespace smartautoclicker;
+
+void AnimatedTilesMask::setLearningEnabled(bool enabled) {
+    if (isLearningEnabled == enabled) return;
+
+    isLearningEnabled = enabled;
+    clear();
+}
+
+void AnimatedTilesMask::setUserAreas(const std::vector<cv::Rect>& areas) {
+    userAreas = areas;
+    // Computed again in the tiles of the next image
+    userTiles.clear();
+    coverageRevision = 0;
+}
+
+void AnimatedTilesMask::update(const FrameSignature& signature, const ConditionTileIndex& coverage, double scaleRatio) {
+    const cv::Size& size = signature.getImageSize();
+    const size_t tileCount = FrameSignature::getTileCount(size);
+    if (size != imageSize) {
+        imageSize = size;
+        changeCounts.assign(tileCount, 0);
+        learningFrameCount = 0;
+        animatedTiles.assign(tileCount, 0);
+        userTiles.clear();
+        excludedTiles.clear();
+        coverageRevision = 0;
+    }
+
+    if (userTiles.size() != tileCount) {
+        userTiles.assign(tileCount, 0);
+        const int tileColumns = (size.width + FrameSignature::TILE_SIZE - 1) / FrameSignature::TILE_SIZE;
+        const cv::Rect imageRoi(0, 0, size.width, size.height);
+        for (const cv::Rect& area : userAreas) {
+            const cv::Rect scaledArea = cv::Rect(
+                    (int) std::floor(area.x * scaleRatio),
+                    (int) std::floor(area.y * scaleRatio),
+                    (int) std::ceil(area.width * scaleRatio),
+                    (int) std::ceil(area.height * scaleRatio)) & imageRoi;
+            if (scaledArea.empty()) continue;
+
+            const int lastColumn = (scaledArea.x + scaledArea.width - 1) / FrameSignature::TILE_SIZE;
+            const int lastRow = (scaledArea.y + scaledArea.height - 1) / FrameSignature::TILE_SIZE;
+            for (int tileY = scaledArea.y / FrameSignature::TILE_SIZE; tileY <= lastRow; tileY++) {
+                for (int tileX = scaledArea.x / FrameSignature::TILE_SIZE; tileX <= lastColumn; tileX++) {
+                    userTiles[(size_t) tileY * tileColumns + tileX] = 1;
+                }
+            }
+        }
+    }
+
+    // Counted over a window instead of forever, a tile stops being animated once its animation has stopped
+    bool isAnimatedChanged = false;
+    if (isLearningEnabled && signature.hasPrevious()) {
+        const std::vector<uint8_t>& dirtyTiles = signature.getDirtyTiles();
+        for (size_t tile = 0; tile < tileCount; tile++) changeCounts[tile] += dirtyTiles[tile];
+
+        if (++learningFrameCount >= LEARNING_FRAMES) {
+            for (size_t tile = 0; tile < tileCount; tile++) {
+                const uint8_t isAnimated = changeCounts[tile] >= ANIMATED_MIN_CHANGES ? 1 : 0;
+                isAnimatedChanged = isAnimatedChanged || isAnimated != animatedTiles[tile];
+                animatedTiles[tile] = isAnimated;
+            }
+            std::fill(changeCounts.begin(), changeCounts.end(), 0);
+            learningFrameCount = 0;
+        }
+    }
+
+    // Without the areas of the conditions, the results of any tile might depend on its changes
+    if (!coverage.isBuilt(coverage.getRevision(), size)) {
+        excludedTiles.clear();
+        coverageRevision = 0;
+        return;
+    }
+    if (isAnimatedChanged || coverageRevision != coverage.getRevision()) updateExcludedTiles(coverage);
+}
+
+void AnimatedTilesMask::updateExcludedTiles(const ConditionTileIndex& coverage) {
+    coverageRevision = coverage.getRevision();
+    excludedTiles.assign(animatedTiles.size(), 0);
+
+    bool hasExcludedTiles = false;
+    for (size_t tile = 0; tile < excludedTiles.size(); tile++) {
+        if ((animatedTiles[tile] == 0 && userTiles[tile] == 0) || coverage.isCovered(tile)) continue;
+
+        excludedTiles[tile] = 1;
+        hasExcludedTiles = true;
+    }
+
+    if (!hasExcludedTiles) excludedTiles.clear();
+}
+
+bool AnimatedTilesMask::isUnchanged(const FrameSignature& signature) const {
+    const std::vector<uint8_t>& dirtyTiles = signature.getDirtyTiles();
+    if (!signature.hasPrevious() || excludedTiles.size() != dirtyTiles.size()) return false;
+
+    for (size_t tile = 0; tile < dirtyTiles.size(); tile++) {
+        if (dirtyTiles[tile] != 0 && excludedTiles[tile] == 0) return false;
+    }
+
+    return true;
+}
+
+size_t AnimatedTilesMask::getMemorySize() const {
+    return changeCounts.capacity() * sizeof(uint16_t) + animatedTiles.capacity() + userTiles.capacity()
+            + excludedTiles.capacity() + userAreas.capacity() * sizeof(cv::Rect);
+}
+
+void AnimatedTilesMask::clear() {
+    imageSize = cv::Size(0, 0);
+    changeCounts.clear();
+    learningFrameCount = 0;
+    animatedTiles.clear();
+    userTiles.clear();
+    excludedTiles.clear();
+    coverageRevision = 0;
+}
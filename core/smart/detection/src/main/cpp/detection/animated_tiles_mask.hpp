@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_ANIMATED_TILES_MASK_HPP
+#define KLICK_R_ANIMATED_TILES_MASK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/types.hpp>
+
+#include "condition_tile_index.hpp"
+#include "frame_signature.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Tiles of the [FrameSignature] whose changes are ignored when telling if the screen is unchanged. Blinking
+     * cursors, clocks or idle animations of the screen would make each image look different from the previous one.
+     *
+     * The excluded tiles are the animated ones, learned from how often they change over [LEARNING_FRAMES] images,
+     * and the ones of the areas provided by the user. A tile overlapped by the area of a condition of the
+     * [ConditionTileIndex] is never excluded: its changes can change the results of the detection.
+     */
+    class AnimatedTilesMask {
+
+    private:
+        /** The number of screen images the changes of the tiles are counted over before updating the animated ones. */
+        static constexpr int LEARNING_FRAMES = 32;
+        /** The number of changes of a tile during [LEARNING_FRAMES] images making it an animated tile. */
+        static constexpr uint16_t ANIMATED_MIN_CHANGES = LEARNING_FRAMES / 4;
+
+        /** True to learn the animated tiles. */
+        bool isLearningEnabled = false;
+        /** The areas to exclude provided by the user, in full size coordinates. */
+        std::vector<cv::Rect> userAreas;
+
+        /** The size of the images the tiles are computed for, in scaled pixels. */
+        cv::Size imageSize = cv::Size(0, 0);
+        /** The number of changes of each tile since the start of the current learning window, row by row. */
+        std::vector<uint16_t> changeCounts;
+        /** The number of images in the current learning window. */
+        int learningFrameCount = 0;
+        /** For each tile, 1 if it has been learned as animated, 0 if not. */
+        std::vector<uint8_t> animatedTiles;
+        /** For each tile, 1 if it is in the [userAreas], 0 if not. */
+        std::vector<uint8_t> userTiles;
+        /** For each tile, 1 if its changes are ignored, 0 if not. Empty if no tile is excluded. */
+        std::vector<uint8_t> excludedTiles;
+        /** The revision of the conditions [excludedTiles] have been computed with, 0 if none. */
+        uint64_t coverageRevision = 0;
+
+        /** Compute [excludedTiles] from the animated and user tiles not covered by the conditions of [coverage]. */
+        void updateExcludedTiles(const ConditionTileIndex& coverage);
+
+    public:
+        AnimatedTilesMask() = default;
+
+        /** @return true if some tiles can be excluded: the learning is enabled or the user has provided areas. */
+        bool isActive() const { return isLearningEnabled || !userAreas.empty(); }
+
+        /**
+         * Enable or disable the learning of the animated tiles. Disabling it forgets the learned ones.
+         *
+         * @param enabled true to learn the animated tiles, false to only exclude the user areas.
+         */
+        void setLearningEnabled(bool enabled);
+
+        /**
+         * Set the areas of the screen whose changes are ignored, in addition to the learned ones.
+         *
+         * @param areas the areas to exclude, in full size coordinates. Empty to only exclude the learned tiles.
+         */
+        void setUserAreas(const std::vector<cv::Rect>& areas);
+
+        /**
+         * Count the changes of the tiles of a new screen image, updating the animated tiles at the end of each
+         * learning window, and the excluded tiles when the conditions of [coverage] have changed.
+         *
+         * @param signature the signature of the screen, updated with the new image.
+         * @param coverage the areas of the detected conditions. Without conditions of the size of the signature, no
+         *                 tile is excluded.
+         * @param scaleRatio the scale ratio of the image of the signature.
+         */
+        void update(const FrameSignature& signature, const ConditionTileIndex& coverage, double scaleRatio);
+
+        /**
+         * Tells if the screen is unchanged when ignoring the changes of the excluded tiles.
+         *
+         * @param signature the signature of the screen, updated with the new image.
+         *
+         * @return true if only excluded tiles have changed since the previous image, false if not or if there was no
+         *         previous image.
+         */
+        bool isUnchanged(const FrameSignature& signature) const;
+
+        /** @return for each tile, row by row, 1 if its changes are ignored, 0 if not. Empty if no tile is excluded. */
+        const std::vector<uint8_t>& getExcludedTiles() const { return excludedTiles; }
+
+        /** @return the memory of the tiles of this mask, in bytes. */
+        size_t getMemorySize() const;
+
+        /** Forget the learned tiles, keeping the user areas. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_ANIMATED_TILES_MASK_HPP
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "binary_matcher.hpp"
+#include "../types/memory_usage.hpp"
+
+using namespace smartautoclicker;
+
+
+/** Number of pixels packed in a word. */
+static constexpr int WORD_BITS = 64;
+
+/** @return the number of set bits of a word. */
+static inline uint32_t countBits(uint64_t word) {
+#if defined(__aarch64__)
+    return vaddv_u8(vcnt_u8(vcreate_u8(word)));
+#else
+    return (uint32_t) __builtin_popcountll(word);
+#endif
+}
+
+void BinaryMatcher::match(const cv::Mat& image, const BinaryTemplate& templ, cv::Mat& results) {
+    const cv::Size& templSize = templ.getSize();
+    const int resultRows = image.rows - templSize.height + 1;
+    const int resultCols = image.cols - templSize.width + 1;
+    if (resultRows <= 0 || resultCols <= 0) return;
+
+    BinaryTemplate::binarize(image, binaryImage);
+    const int imageRowWordCount = (image.cols + WORD_BITS - 1) / WORD_BITS + 1;
+    BinaryTemplate::pack(binaryImage, imageRowWordCount, imageWords);
+
+    const int templRowWordCount = templ.getRowWordCount();
+    const uint64_t* templWords = templ.getWords().data();
+    const int lastWordBits = templSize.width - (templRowWordCount - 1) * WORD_BITS;
+    const uint64_t lastWordMask = lastWordBits == WORD_BITS ? ~0ull : (1ull << lastWordBits) - 1;
+    const auto area = (float) templSize.area();
+
+    for (int y = 0; y < resultRows; y++) {
+        auto* resultRow = results.ptr<float>(y);
+
+        for (int x = 0; x < resultCols; x++) {
+            const int firstWord = x / WORD_BITS;
+            const int shift = x % WORD_BITS;
+            uint32_t differentBits = 0;
+
+            for (int templY = 0; templY < templSize.height; templY++) {
+                const uint64_t* imageRow = imageWords.data() + (size_t) (y + templY) * imageRowWordCount + firstWord;
+                const uint64_t* templRow = templWords + (size_t) templY * templRowWordCount;
+
+                // The image bits of the template row, realigned on the position. The next word always exists.
+                for (int i = 0; i < templRowWordCount; i++) {
+                    uint64_t imageBits = shift == 0
+                            ? imageRow[i]
+                            : (imageRow[i] >> shift) | (imageRow[i + 1] << (WORD_BITS - shift));
+                    if (i == templRowWordCount - 1) imageBits &= lastWordMask;
+                    differentBits += countBits(imageBits ^ templRow[i]);
+                }
+            }
+
+            resultRow[x] = 1.0f - (float) differentBits / area;
+        }
+    }
+}
+
+size_t BinaryMatcher::getMemorySize() const {
+    return getMatMemorySize(binaryImage) + imageWords.capacity() * sizeof(uint64_t);
+}
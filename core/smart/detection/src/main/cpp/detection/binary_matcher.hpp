@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_BINARY_MATCHER_HPP
+#define KLICK_R_BINARY_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "binary_template.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Template matching of the bits of a [BinaryTemplate] with the bits of the screen.
+     *
+     * The image is binarized and packed like the template, and the result of each position is the part of the
+     * template bits equal to the image ones, from the population count of their XOR, with the NEON vcnt on arm64.
+     * The results rank the positions, but they are not the dense confidences, and the best positions must be verified
+     * with a dense matching.
+     */
+    class BinaryMatcher {
+
+    private:
+        /** The binarized image of the last matching. */
+        cv::Mat binaryImage = cv::Mat();
+        /** The packed rows of [binaryImage], with an additional word per row for the unaligned reads. */
+        std::vector<uint64_t> imageWords;
+
+    public:
+        /**
+         * Match the binary template in the image.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the bits of the template to search, not empty.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const BinaryTemplate& templ, cv::Mat& results);
+
+        /** @return the memory of the image bits kept between the matchings, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_BINARY_MATCHER_HPP
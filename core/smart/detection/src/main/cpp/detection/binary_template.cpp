@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <opencv2/imgproc.hpp>
+
+#include "binary_template.hpp"
+
+using namespace smartautoclicker;
+
+
+/** Number of pixels packed in a word. */
+static constexpr int WORD_BITS = 64;
+
+void BinaryTemplate::binarize(const cv::Mat& image, cv::Mat& result) {
+    cv::adaptiveThreshold(image, result, 1, cv::ADAPTIVE_THRESH_MEAN_C, cv::THRESH_BINARY,
+                          THRESHOLD_BLOCK_SIZE, -THRESHOLD_OFFSET);
+}
+
+void BinaryTemplate::pack(const cv::Mat& binary, int rowWordCount, std::vector<uint64_t>& result) {
+    result.assign((size_t) binary.rows * rowWordCount, 0);
+
+    for (int y = 0; y < binary.rows; y++) {
+        const auto* row = binary.ptr<uint8_t>(y);
+        uint64_t* rowWords = result.data() + (size_t) y * rowWordCount;
+        for (int x = 0; x < binary.cols; x++) {
+            rowWords[x / WORD_BITS] |= (uint64_t) row[x] << (x % WORD_BITS);
+        }
+    }
+}
+
+void BinaryTemplate::compute(const cv::Mat& templ) {
+    size = templ.size();
+    rowWordCount = 0;
+    words.clear();
+    words.shrink_to_fit();
+    if (templ.total() < MIN_TEMPLATE_AREA) return;
+
+    cv::Mat binary;
+    binarize(templ, binary);
+    const double setBitsRatio = (double) cv::countNonZero(binary) / (double) binary.total();
+    if (setBitsRatio < MIN_SET_BITS_RATIO || setBitsRatio > MAX_SET_BITS_RATIO) return;
+
+    rowWordCount = (templ.cols + WORD_BITS - 1) / WORD_BITS;
+    pack(binary, rowWordCount, words);
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_BINARY_TEMPLATE_HPP
+#define KLICK_R_BINARY_TEMPLATE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * The bits of a gray template binarized with an adaptive threshold, for the binary matching.
+     *
+     * The high contrast conditions, such as texts, icons and outlines, are mostly defined by which of their pixels are
+     * brighter than their neighbourhood. Those bits are packed by 64 in each row, and compared with the bits of the
+     * screen by the [BinaryMatcher] with a XOR and a population count, for the cost of a single multiply add of the
+     * dense correlation per 64 pixels.
+     */
+    class BinaryTemplate {
+
+    private:
+        /** Minimum template area. Below, the dense matchers are fast enough. */
+        static constexpr int MIN_TEMPLATE_AREA = 32 * 32;
+        /**
+         * Bounds of the part of set bits of a high contrast template. Out of them, the template is mostly flat or
+         * textured, and its bits are not enough to find it.
+         */
+        static constexpr double MIN_SET_BITS_RATIO = 0.05;
+        static constexpr double MAX_SET_BITS_RATIO = 0.95;
+
+        /** The size of the template, in pixels. */
+        cv::Size size = cv::Size(0, 0);
+        /** The number of words of each row of [words]. */
+        int rowWordCount = 0;
+        /** The bits of the template, row by row. The bits after the template width in the last word are not set. */
+        std::vector<uint64_t> words;
+
+    public:
+        /** Side of the neighbourhood of the adaptive threshold, in pixels. Odd. */
+        static constexpr int THRESHOLD_BLOCK_SIZE = 15;
+        /** A pixel bit is set if it is brighter than this above the mean of its neighbourhood. */
+        static constexpr double THRESHOLD_OFFSET = 4;
+
+        /**
+         * Binarize a gray image, in the same way for the templates and the screen. Set pixels are 1, the others 0.
+         *
+         * @param image the image to binarize, in 8 bits gray.
+         * @param result the binarized image, in 8 bits of the image size.
+         */
+        static void binarize(const cv::Mat& image, cv::Mat& result);
+
+        /**
+         * Pack the bits of a binarized image, 64 pixels per word in each row.
+         *
+         * @param binary the binarized image, see [binarize].
+         * @param rowWordCount the number of words of each row, at least the image width divided by 64.
+         * @param result the packed rows, resized to the image height times [rowWordCount].
+         */
+        static void pack(const cv::Mat& binary, int rowWordCount, std::vector<uint64_t>& result);
+
+        /**
+         * Binarize and pack a template.
+         * Nothing is kept if the template is too small, or if it is not a high contrast one.
+         *
+         * @param templ the template, in 8 bits gray.
+         */
+        void compute(const cv::Mat& templ);
+
+        /** @return true if no bit is kept, the template must be matched with the other matchers. */
+        bool isEmpty() const { return words.empty(); }
+
+        const cv::Size& getSize() const { return size; }
+        int getRowWordCount() const { return rowWordCount; }
+        const std::vector<uint64_t>& getWords() const { return words; }
+        size_t getMemorySize() const { return words.capacity() * sizeof(uint64_t); }
+    };
+}
+
+#endif //KLICK_R_BINARY_TEMPLATE_HPP
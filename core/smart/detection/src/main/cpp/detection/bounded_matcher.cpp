@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "bounded_matcher.hpp"
+
+using namespace smartautoclicker;
+
+
+/** @return the sum of the values of the area with the provided integral image. */
+static inline double getAreaSum(const double* top, const double* bottom, int left, int right) {
+    return bottom[right] - bottom[left] - top[right] + top[left];
+}
+
+void BoundedMatcher::match(const cv::Mat& image, const cv::Mat& templ, double minConfidence, cv::Mat& results) {
+    const int resultRows = image.rows - templ.rows + 1;
+    const int resultCols = image.cols - templ.cols + 1;
+    const int headRows = std::max(templ.rows / HEAD_ROWS_DIVISOR, 1);
+    const auto area = (double) templ.total();
+    const auto tailArea = (double) ((templ.rows - headRows) * templ.cols);
+
+    // Template statistics, on the whole template and on its tail rows
+    double templSum = 0, templSquaredSum = 0, tailSum = 0, tailSquaredSum = 0;
+    for (int y = 0; y < templ.rows; y++) {
+        const auto* row = templ.ptr<uint8_t>(y);
+        double rowSum = 0, rowSquaredSum = 0;
+        for (int x = 0; x < templ.cols; x++) {
+            rowSum += row[x];
+            rowSquaredSum += row[x] * row[x];
+        }
+
+        templSum += rowSum;
+        templSquaredSum += rowSquaredSum;
+        if (y >= headRows) {
+            tailSum += rowSum;
+            tailSquaredSum += rowSquaredSum;
+        }
+    }
+
+    // Same as OpenCv, a template without variance matches everywhere
+    const double templNormSquared = templSquaredSum - templSum * templSum / area;
+    if (templNormSquared / area < DBL_EPSILON) {
+        results.setTo(cv::Scalar(1));
+        return;
+    }
+
+    const double templMean = templSum / area;
+    const double templNorm = std::sqrt(templNormSquared);
+    // Sum and centered norm of the tail rows of the zero mean template
+    const double tailOffset = tailSum - tailArea * templMean;
+    const double tailNorm = std::sqrt(std::max(tailSquaredSum - tailSum * tailSum / tailArea, 0.0));
+
+    cv::integral(image, sums, squaredSums, CV_64F, CV_64F);
+    cv::matchTemplate(
+            image.rowRange(0, resultRows + headRows - 1),
+            templ.rowRange(0, headRows),
+            headCorrelation,
+            cv::TM_CCORR);
+
+    remainingPositions.clear();
+    const auto maxRemainingCount = (size_t) ((double) results.total() * MAX_REMAINING_RATIO);
+
+    for (int y = 0; y < resultRows; y++) {
+        const auto* sumsTop = sums.ptr<double>(y);
+        const auto* sumsMiddle = sums.ptr<double>(y + headRows);
+        const auto* sumsBottom = sums.ptr<double>(y + templ.rows);
+        const auto* squaredSumsTop = squaredSums.ptr<double>(y);
+        const auto* squaredSumsMiddle = squaredSums.ptr<double>(y + headRows);
+        const auto* squaredSumsBottom = squaredSums.ptr<double>(y + templ.rows);
+        const auto* headRow = headCorrelation.ptr<float>(y);
+        auto* resultRow = results.ptr<float>(y);
+
+        for (int x = 0; x < resultCols; x++) {
+            const int right = x + templ.cols;
+            const double windowSum = getAreaSum(sumsTop, sumsBottom, x, right);
+            const double windowSquaredSum = getAreaSum(squaredSumsTop, squaredSumsBottom, x, right);
+            const double tailWindowSum = getAreaSum(sumsMiddle, sumsBottom, x, right);
+            const double tailWindowSquaredSum = getAreaSum(squaredSumsMiddle, squaredSumsBottom, x, right);
+
+            // Same denominator as OpenCv
+            const double norm = std::sqrt(std::max(windowSquaredSum - windowSum * windowSum / area, 0.0)) * templNorm;
+
+            // Exact correlation of the head, and Cauchy-Schwarz bound of the tail with the centered tail window
+            const double headValue = headRow[x] - templMean * (windowSum - tailWindowSum);
+            const double tailWindowNorm = std::sqrt(
+                    std::max(tailWindowSquaredSum - tailWindowSum * tailWindowSum / tailArea, 0.0));
+            const double bound = headValue
+                    + tailWindowSum / tailArea * tailOffset
+                    + tailWindowNorm * tailNorm
+                    + CORRELATION_RELATIVE_ERROR * headRow[x];
+
+            if (norm > 0 && bound < minConfidence * norm) {
+                resultRow[x] = (float) std::max(bound / norm, -1.0);
+                continue;
+            }
+
+            // Too many positions to verify, the bounds are not selective enough for this image
+            remainingPositions.push_back(y * resultCols + x);
+            if (remainingPositions.size() > maxRemainingCount) {
+                cv::matchTemplate(image, templ, results, cv::TM_CCOEFF_NORMED);
+                return;
+            }
+        }
+    }
+
+    for (int position : remainingPositions) {
+        const int y = position / resultCols;
+        const int x = position % resultCols;
+        const int right = x + templ.cols;
+
+        const double windowSum = getAreaSum(sums.ptr<double>(y), sums.ptr<double>(y + templ.rows), x, right);
+        const double windowSquaredSum = getAreaSum(
+                squaredSums.ptr<double>(y), squaredSums.ptr<double>(y + templ.rows), x, right);
+        const double norm = std::sqrt(std::max(windowSquaredSum - windowSum * windowSum / area, 0.0)) * templNorm;
+
+        results.at<float>(y, x) = (float) computeExactValue(image, templ, x, y, templMean, windowSum, norm);
+    }
+}
+
+double BoundedMatcher::computeExactValue(const cv::Mat& image, const cv::Mat& templ, int x, int y, double templMean,
+                                         double windowSum, double norm) {
+    int64_t correlation = 0;
+    for (int templY = 0; templY < templ.rows; templY++) {
+        const auto* imageRow = image.ptr<uint8_t>(y + templY) + x;
+        const auto* templRow = templ.ptr<uint8_t>(templY);
+
+        int rowCorrelation = 0;
+        for (int templX = 0; templX < templ.cols; templX++) rowCorrelation += imageRow[templX] * templRow[templX];
+        correlation += rowCorrelation;
+    }
+
+    // Same normalization as OpenCv, including for the windows without variance
+    const double value = (double) correlation - templMean * windowSum;
+    if (std::fabs(value) < norm) return value / norm;
+    if (std::fabs(value) < norm * 1.125) return value > 0 ? 1 : -1;
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_BOUNDED_MATCHER_HPP
+#define KLICK_R_BOUNDED_MATCHER_HPP
+
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /** Minimum confidence from which the bounded matching prunes enough positions to be faster than OpenCv. */
+    static constexpr double BOUNDED_MATCHING_MIN_CONFIDENCE = 0.8;
+
+    /**
+     * Template matching with the TM_CCOEFF_NORMED semantics, skipping the positions that can't reach a minimum
+     * confidence.
+     *
+     * The correlation is first computed with the head rows of the template only. For each position, the correlation
+     * of the remaining rows is bounded using Cauchy-Schwarz with the window energy from integral images. Positions
+     * whose bound is below the minimum confidence are pruned, and the exact correlation is computed for the others.
+     */
+    class BoundedMatcher {
+
+    private:
+        /** The template is split in head and tail, the head being this fraction of its rows. */
+        static constexpr int HEAD_ROWS_DIVISOR = 4;
+        /** Above this ratio of remaining positions, the complete OpenCv matching is faster. */
+        static constexpr double MAX_REMAINING_RATIO = 0.25;
+        /** Relative error of the OpenCv float correlation, kept as a margin to never prune a valid position. */
+        static constexpr double CORRELATION_RELATIVE_ERROR = 1e-5;
+
+        /** Integral images of the image and its square. */
+        cv::Mat sums;
+        cv::Mat squaredSums;
+        /** Raw correlation of the template head rows. */
+        cv::Mat headCorrelation;
+        /** Positions of the results that can reach the minimum confidence, as index in the results. */
+        std::vector<int> remainingPositions;
+
+        static double computeExactValue(const cv::Mat& image, const cv::Mat& templ, int x, int y, double templMean,
+                                        double windowSum, double norm);
+
+    public:
+        /**
+         * Match the template in the image.
+         * The results have the same values as cv::matchTemplate with TM_CCOEFF_NORMED for all positions that can be
+         * above the minimum confidence. For the pruned ones, an upper bound of their value, below the minimum
+         * confidence, is set instead.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the template to search, in 8 bits gray, with at least two rows.
+         * @param minConfidence the minimum confidence of the positions to keep, in ]0..1].
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const cv::Mat& templ, double minConfidence, cv::Mat& results);
+    };
+}
+
+#endif //KLICK_R_BOUNDED_MATCHER_HPP
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/core.hpp>
+
+#include "chamfer_matcher.hpp"
+
+using namespace smartautoclicker;
+
+
+void ChamferMatcher::match(const cv::Mat& distances, const ChamferTemplate& templ, cv::Mat& results) {
+    const std::vector<cv::Point>& points = templ.getPoints();
+    const double maxSum = (double) points.size() * ChamferTemplate::MAX_DISTANCE * ChamferTemplate::DISTANCE_SCALE;
+    rowSums.resize(results.cols);
+
+    for (int y = 0; y < results.rows; y++) {
+        // Point by point over the whole row of positions, each inner loop is a contiguous vectorized addition
+        std::fill(rowSums.begin(), rowSums.end(), 0);
+        for (const cv::Point& point : points) {
+            const auto* distancesRow = distances.ptr<uint8_t>(y + point.y) + point.x;
+            for (int x = 0; x < results.cols; x++) rowSums[x] += distancesRow[x];
+        }
+
+        auto* resultsRow = results.ptr<float>(y);
+        for (int x = 0; x < results.cols; x++) resultsRow[x] = (float) (1.0 - rowSums[x] / maxSum);
+    }
+}
+
+int ChamferMatcher::countEdges(const cv::Mat& distances) {
+    return (int) distances.total() - cv::countNonZero(distances);
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CHAMFER_MATCHER_HPP
+#define KLICK_R_CHAMFER_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "chamfer_template.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Template matching of the edge points of a [ChamferTemplate] with the edge distances of the screen.
+     *
+     * The result of each position is 1 minus the mean distance of the template edge points to the closest screen
+     * edge, relative to [ChamferTemplate::MAX_DISTANCE]. It is 1 when all template edges are on screen edges, whatever
+     * the colors around them.
+     */
+    class ChamferMatcher {
+
+    private:
+        /** The sums of the distances of one row of positions, kept between the matchings. */
+        std::vector<uint32_t> rowSums;
+
+    public:
+        /**
+         * Match the edge points of the template in the distances of an image.
+         *
+         * @param distances the edge distances of the image to search in, from [ChamferTemplate::computeDistances].
+         * @param templ the edge points of the template to search, not empty.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& distances, const ChamferTemplate& templ, cv::Mat& results);
+
+        /**
+         * Count the edge pixels in an area of the edge distances, to reject the positions whose edges are mostly
+         * clutter, such as texts, where any shape finds close edges.
+         *
+         * @param distances the edge distances of the area, from [ChamferTemplate::computeDistances].
+         */
+        static int countEdges(const cv::Mat& distances);
+
+        /** @return the memory of the row sums kept between the matchings, in bytes. */
+        size_t getMemorySize() const { return rowSums.capacity() * sizeof(uint32_t); }
+    };
+}
+
+#endif //KLICK_R_CHAMFER_MATCHER_HPP
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <opencv2/imgproc.hpp>
+
+#include "chamfer_template.hpp"
+
+using namespace smartautoclicker;
+
+
+void ChamferTemplate::computeEdges(const cv::Mat& image, cv::Mat& edges) {
+    cv::Canny(image, edges, CANNY_LOW_THRESHOLD, CANNY_HIGH_THRESHOLD);
+}
+
+void ChamferTemplate::computeDistances(const cv::Mat& image, cv::Mat& distances) {
+    cv::Mat edges;
+    computeEdges(image, edges);
+
+    // The distance transform measures the distance to the closest zero pixel, the edges must be the zeros
+    cv::Mat floatDistances;
+    cv::bitwise_not(edges, edges);
+    cv::distanceTransform(edges, floatDistances, cv::DIST_L2, cv::DIST_MASK_3);
+    cv::min(floatDistances, MAX_DISTANCE, floatDistances);
+    floatDistances.convertTo(distances, CV_8U, DISTANCE_SCALE);
+}
+
+void ChamferTemplate::compute(const cv::Mat& templ) {
+    size = templ.size();
+    edgeCount = 0;
+    points.clear();
+    points.shrink_to_fit();
+    if (templ.total() < MIN_TEMPLATE_AREA) return;
+
+    cv::Mat edges;
+    computeEdges(templ, edges);
+    std::vector<cv::Point> edgePoints;
+    cv::findNonZero(edges, edgePoints);
+    if ((int) edgePoints.size() < MIN_EDGE_POINTS
+            || (double) edgePoints.size() > MAX_EDGE_RATIO * (double) templ.total()) return;
+
+    edgeCount = (int) edgePoints.size();
+    if (edgeCount <= MAX_EDGE_POINTS) {
+        points = std::move(edgePoints);
+        return;
+    }
+
+    points.reserve(MAX_EDGE_POINTS);
+    for (int i = 0; i < MAX_EDGE_POINTS; i++) {
+        points.push_back(edgePoints[(size_t) i * edgeCount / MAX_EDGE_POINTS]);
+    }
+}
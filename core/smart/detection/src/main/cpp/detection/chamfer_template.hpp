@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CHAMFER_TEMPLATE_HPP
+#define KLICK_R_CHAMFER_TEMPLATE_HPP
+
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * The edge points of a gray template, for the chamfer matching.
+     *
+     * Games often recolor the fills and gradients of their buttons while keeping their shapes, and the gray
+     * correlation of the recolored condition fails. Its edges stay at the same place: the template is matched with
+     * the distances of the screen pixels to their closest edge, computed once per frame for all conditions by
+     * [computeDistances], and summed at the template edge points by the [ChamferMatcher].
+     */
+    class ChamferTemplate {
+
+    private:
+        /** Minimum template area. Below, the edges are too few to tell the shape. */
+        static constexpr int MIN_TEMPLATE_AREA = 24 * 24;
+        /** Minimum number of edge points. Below, the template has no shape to match. */
+        static constexpr int MIN_EDGE_POINTS = 32;
+        /** Maximum part of edge pixels. Above, the template is textured and its edges are found everywhere. */
+        static constexpr double MAX_EDGE_RATIO = 0.3;
+        /** Maximum number of edge points kept, evenly picked along the edges, bounding the cost of each position. */
+        static constexpr int MAX_EDGE_POINTS = 512;
+
+        /** The size of the template, in pixels. */
+        cv::Size size = cv::Size(0, 0);
+        /** The kept edge points, row by row. */
+        std::vector<cv::Point> points;
+        /** The number of edge pixels of the template, before picking the [points]. */
+        int edgeCount = 0;
+
+    public:
+        /** Gradient thresholds of the Canny edge detection, low then high. */
+        static constexpr double CANNY_LOW_THRESHOLD = 40;
+        static constexpr double CANNY_HIGH_THRESHOLD = 120;
+        /** Distance to an edge above which the pixels are as far, in pixels. Bounds the cost of a missing edge. */
+        static constexpr int MAX_DISTANCE = 8;
+        /** Factor of the distances stored in 8 bits, keeping their fractional part. */
+        static constexpr int DISTANCE_SCALE = 16;
+
+        /**
+         * Detect the edges of a gray image, in the same way for the templates and the screen.
+         *
+         * @param image the image to detect the edges of, in 8 bits gray.
+         * @param edges the edges, non zero on the edge pixels, in 8 bits of the image size.
+         */
+        static void computeEdges(const cv::Mat& image, cv::Mat& edges);
+
+        /**
+         * Compute the distance of each pixel of a gray image to its closest edge, truncated at [MAX_DISTANCE].
+         *
+         * @param image the image to compute the distances of, in 8 bits gray.
+         * @param distances the distances times [DISTANCE_SCALE], in 8 bits of the image size. 0 on the edges.
+         */
+        static void computeDistances(const cv::Mat& image, cv::Mat& distances);
+
+        /**
+         * Detect and keep the edge points of a template.
+         * Nothing is kept if the template is too small, or if it has too few or too many edges.
+         *
+         * @param templ the template, in 8 bits gray.
+         */
+        void compute(const cv::Mat& templ);
+
+        /** @return true if no edge point is kept, the template must be matched with the other matchers. */
+        bool isEmpty() const { return points.empty(); }
+
+        const cv::Size& getSize() const { return size; }
+        const std::vector<cv::Point>& getPoints() const { return points; }
+        int getEdgeCount() const { return edgeCount; }
+        size_t getMemorySize() const { return points.capacity() * sizeof(cv::Point); }
+    };
+}
+
+#endif //KLICK_R_CHAMFER_TEMPLATE_HPP
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "color_histogram.hpp"
+
+using namespace smartautoclicker;
+
+/** Shift from a channel value to its bin index. */
+static constexpr int BIN_SHIFT = 4;
+static_assert((256 >> BIN_SHIFT) == COLOR_HISTOGRAM_BINS);
+
+
+void ColorHistogram::compute(const cv::Mat& rgba) {
+    uint32_t counts[CHANNELS][COLOR_HISTOGRAM_BINS] = {};
+
+    for (int y = 0; y < rgba.rows; y++) {
+        const uint8_t* row = rgba.ptr<uint8_t>(y);
+        int x = 0;
+
+#if defined(__ARM_NEON)
+        // The bin indexes of 16 pixels are computed at once, only the increments remain scalar
+        uint8_t binIndexes[CHANNELS][16];
+        for (; x + 16 <= rgba.cols; x += 16) {
+            const uint8x16x4_t pixels = vld4q_u8(row + x * 4);
+            vst1q_u8(binIndexes[0], vshrq_n_u8(pixels.val[0], BIN_SHIFT));
+            vst1q_u8(binIndexes[1], vshrq_n_u8(pixels.val[1], BIN_SHIFT));
+            vst1q_u8(binIndexes[2], vshrq_n_u8(pixels.val[2], BIN_SHIFT));
+
+            for (int i = 0; i < 16; i++) {
+                counts[0][binIndexes[0][i]]++;
+                counts[1][binIndexes[1][i]]++;
+                counts[2][binIndexes[2][i]]++;
+            }
+        }
+#endif
+
+        for (; x < rgba.cols; x++) {
+            const uint8_t* pixel = row + x * 4;
+            for (int c = 0; c < CHANNELS; c++) counts[c][pixel[c] >> BIN_SHIFT]++;
+        }
+    }
+
+    const float pixelCount = (float) rgba.total();
+    for (int c = 0; c < CHANNELS; c++) {
+        for (int bin = 0; bin < COLOR_HISTOGRAM_BINS; bin++) {
+            bins[c * COLOR_HISTOGRAM_BINS + bin] = pixelCount > 0 ? (float) counts[c][bin] / pixelCount : 0.f;
+        }
+    }
+}
+
+void ColorHistogram::compute(const cv::Mat& rgba, const cv::Mat& mask) {
+    uint32_t counts[CHANNELS][COLOR_HISTOGRAM_BINS] = {};
+    uint32_t pixelCount = 0;
+
+    // Only for the masked conditions, the mask breaks the vector loads
+    for (int y = 0; y < rgba.rows; y++) {
+        const uint8_t* row = rgba.ptr<uint8_t>(y);
+        const uint8_t* maskRow = mask.ptr<uint8_t>(y);
+        for (int x = 0; x < rgba.cols; x++) {
+            if (maskRow[x] == 0) continue;
+
+            const uint8_t* pixel = row + x * 4;
+            for (int c = 0; c < CHANNELS; c++) counts[c][pixel[c] >> BIN_SHIFT]++;
+            pixelCount++;
+        }
+    }
+
+    for (int c = 0; c < CHANNELS; c++) {
+        for (int bin = 0; bin < COLOR_HISTOGRAM_BINS; bin++) {
+            bins[c * COLOR_HISTOGRAM_BINS + bin] = pixelCount > 0 ? (float) counts[c][bin] / (float) pixelCount : 0.f;
+        }
+    }
+}
+
+double ColorHistogram::getDiff(const ColorHistogram& other) const {
+    double intersection = 0;
+    for (size_t i = 0; i < bins.size(); i++) {
+        intersection += std::min(bins[i], other.bins[i]);
+    }
+
+    return std::max(0.0, 1.0 - intersection / CHANNELS) * 100;
+}
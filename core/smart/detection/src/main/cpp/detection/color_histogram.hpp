@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_COLOR_HISTOGRAM_HPP
+#define KLICK_R_COLOR_HISTOGRAM_HPP
+
+#include <array>
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /** Number of bins per color channel of a [ColorHistogram]. Each bin covers 16 consecutive channel values. */
+    static constexpr int COLOR_HISTOGRAM_BINS = 16;
+
+    /**
+     * Compact histograms of the color channels of a RGBA image, normalized by its pixels count.
+     * Unlike the color means, it tells apart two areas with the same average color but a different distribution, such
+     * as a gradient and a plain color.
+     */
+    class ColorHistogram {
+
+    public:
+        /** Number of channels in the histogram, the alpha channel is ignored. */
+        static constexpr int CHANNELS = 3;
+
+        /** The proportion of pixels in each bin, channel after channel. Each channel sums to 1. */
+        std::array<float, CHANNELS * COLOR_HISTOGRAM_BINS> bins = {};
+
+        ColorHistogram() = default;
+
+        /** Compute the histogram of an image, in CV_8UC4. An empty image gives a histogram with all bins at 0. */
+        void compute(const cv::Mat& rgba);
+
+        /**
+         * Compute the histogram of the pixels of an image in a mask, normalized by their count.
+         *
+         * @param rgba the image, in CV_8UC4.
+         * @param mask the pixels to count, in 8 bits of the image size. Non zero pixels are counted.
+         */
+        void compute(const cv::Mat& rgba, const cv::Mat& mask);
+
+        /**
+         * Get the percentage of difference with another histogram, from the intersection of each channel.
+         * Result is expressed in [0..100], 0 for identical distributions.
+         */
+        double getDiff(const ColorHistogram& other) const;
+    };
+}
+
+#endif //KLICK_R_COLOR_HISTOGRAM_HPP
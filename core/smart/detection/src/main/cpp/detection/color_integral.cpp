@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "color_integral.hpp"
+#include "../types/memory_usage.hpp"
+
+using namespace smartautoclicker;
+
+
+void ColorIntegral::update(const cv::Mat& rgba, uint64_t imageFrameIndex) {
+    update(rgba, imageFrameIndex, rgba.size());
+}
+
+void ColorIntegral::update(const cv::Mat& rgba, uint64_t imageFrameIndex, const cv::Size& size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isComputed && frameIndex == imageFrameIndex && width == size.width && height == size.height) return;
+
+    if (size != rgba.size()) {
+        // A single read of the image, the sums are then computed on the few downscaled pixels
+        cv::resize(rgba, scaledRgba, size, 0, 0, cv::INTER_AREA);
+        compute(scaledRgba);
+    } else {
+        scaledRgba.release();
+        compute(rgba);
+    }
+
+    frameIndex = imageFrameIndex;
+    isComputed = true;
+}
+
+void ColorIntegral::compute(const cv::Mat& rgba) {
+    width = rgba.cols;
+    height = rgba.rows;
+
+    const size_t sumsStride = (size_t) (width + 1) * CHANNELS;
+    sums.resize(sumsStride * (height + 1));
+    std::fill(sums.begin(), sums.begin() + (long) sumsStride, 0);
+
+    // Each sum is the sum of its row prefix and of the sum above it. Unsigned overflow wraps, see class doc.
+    for (int y = 0; y < height; y++) {
+        const uint8_t* pixel = rgba.ptr<uint8_t>(y);
+        const uint32_t* above = sums.data() + sumsStride * y;
+        uint32_t* current = sums.data() + sumsStride * (y + 1);
+
+        uint32_t rowSums[CHANNELS] = {0, 0, 0};
+        for (int c = 0; c < CHANNELS; c++) current[c] = 0;
+
+        for (int x = 0; x < width; x++, pixel += 4) {
+            above += CHANNELS;
+            current += CHANNELS;
+            for (int c = 0; c < CHANNELS; c++) {
+                rowSums[c] += pixel[c];
+                current[c] = above[c] + rowSums[c];
+            }
+        }
+    }
+}
+
+cv::Scalar ColorIntegral::getMeans(const cv::Rect& roi) const {
+    const cv::Rect area = roi & cv::Rect(0, 0, width, height);
+    if (area.empty()) return {};
+
+    const size_t sumsStride = (size_t) (width + 1) * CHANNELS;
+    const uint32_t* topLeft = sums.data() + sumsStride * area.y + (size_t) area.x * CHANNELS;
+    const uint32_t* topRight = topLeft + (size_t) area.width * CHANNELS;
+    const uint32_t* bottomLeft = topLeft + sumsStride * area.height;
+    const uint32_t* bottomRight = topRight + sumsStride * area.height;
+
+    const double pixelCount = (double) area.area();
+    cv::Scalar means;
+    for (int c = 0; c < CHANNELS; c++) {
+        means.val[c] = (double) (uint32_t) (bottomRight[c] - bottomLeft[c] - topRight[c] + topLeft[c]) / pixelCount;
+    }
+
+    return means;
+}
+
+size_t ColorIntegral::getMemorySize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sums.capacity() * sizeof(uint32_t) + getMatMemorySize(scaledRgba);
+}
+
+void ColorIntegral::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::vector<uint32_t>().swap(sums);
+    scaledRgba.release();
+    width = 0;
+    height = 0;
+    isComputed = false;
+}
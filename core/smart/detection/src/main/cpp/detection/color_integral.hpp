@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_COLOR_INTEGRAL_HPP
+#define KLICK_R_COLOR_INTEGRAL_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * Summed area table of the color channels of a RGBA image, giving the color means of any area in constant time.
+     * The image can be downscaled before summing, the color means of an area are then approximated from the means of
+     * the downscaled pixels it covers. It divides the memory written by the square of the scale ratio.
+     *
+     * The sums are kept modulo 2^32: the difference of the corners of an area is exact as long as the real sum of the
+     * area fits in 32 bits, which is always the case for screen images.
+     */
+    class ColorIntegral {
+
+    private:
+        /** Number of summed channels, the alpha channel is ignored. */
+        static constexpr int CHANNELS = 3;
+
+        /** Guards the computation of the sums, requested concurrently by the batch workers. */
+        mutable std::mutex mutex;
+
+        /** The downscaled image, when the sums are not computed at the image size. */
+        cv::Mat scaledRgba = cv::Mat();
+        /** The sums of the image, (width + 1) x (height + 1) x [CHANNELS], with a leading zero row and column. */
+        std::vector<uint32_t> sums;
+        int width = 0;
+        int height = 0;
+
+        /** True if [sums] are the ones of the image of [frameIndex], at [width] x [height]. */
+        bool isComputed = false;
+        uint64_t frameIndex = 0;
+
+        void compute(const cv::Mat& rgba);
+
+    public:
+        ColorIntegral() = default;
+
+        /**
+         * Compute the sums of an image, if they are not for this frame already.
+         * Can be called concurrently, the sums are computed only once per frame.
+         *
+         * @param rgba the image, in CV_8UC4.
+         * @param imageFrameIndex the index of the image, from [FrameSignature::getFrameIndex].
+         */
+        void update(const cv::Mat& rgba, uint64_t imageFrameIndex);
+
+        /**
+         * Compute the sums of an image downscaled to the provided size, if they are not for this frame already.
+         * Can be called concurrently, the sums are computed only once per frame.
+         *
+         * @param rgba the image, in CV_8UC4.
+         * @param imageFrameIndex the index of the image, from [FrameSignature::getFrameIndex].
+         * @param size the size of the summed image, usually lower than the image size. The areas provided to
+         *             [getMeans] are then in the coordinates of this size.
+         */
+        void update(const cv::Mat& rgba, uint64_t imageFrameIndex, const cv::Size& size);
+
+        /**
+         * Get the color means of an area of the image, same as cv::mean on this area.
+         * Must be called after [update] for the current frame.
+         *
+         * @param roi the area, in image coordinates. Clipped to the image.
+         */
+        cv::Scalar getMeans(const cv::Rect& roi) const;
+
+        /** @return the memory of the sums and of the downscaled image, in bytes. */
+        size_t getMemorySize() const;
+
+        /** Drop the sums, the downscaled image, and their memory. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_COLOR_INTEGRAL_HPP
@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "condition_file.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+
+ConditionFile::ConditionFile(ConditionFile&& other) noexcept :
+        mapping(std::exchange(other.mapping, nullptr)),
+        mappingSize(std::exchange(other.mappingSize, 0)),
+        pixels(std::exchange(other.pixels, PixelsBuffer())) {}
+
+ConditionFile& ConditionFile::operator=(ConditionFile&& other) noexcept {
+    if (this == &other) return *this;
+
+    close();
+    mapping = std::exchange(other.mapping, nullptr);
+    mappingSize = std::exchange(other.mappingSize, 0);
+    pixels = std::exchange(other.pixels, PixelsBuffer());
+    return *this;
+}
+
+ConditionFile::~ConditionFile() {
+    close();
+}
+
+bool ConditionFile::open(const std::string& path, int width, int height) {
+    close();
+    if (width <= 0 || height <= 0) return false;
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOGE(LOG_TAG, "Can't open condition file %1$s", path.c_str());
+        return false;
+    }
+
+    const size_t rowStride = (size_t) width * 4;
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || (size_t) fileStat.st_size < rowStride * height) {
+        LOGE(LOG_TAG, "Condition file %1$s is too small for %2$dx%3$d", path.c_str(), width, height);
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping remains valid once the file is closed
+    const size_t size = rowStride * height;
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        LOGE(LOG_TAG, "Can't map condition file %1$s", path.c_str());
+        return false;
+    }
+
+    // The files of a scenario are all mapped before being processed, their pages are read ahead meanwhile instead of
+    // faulting one by one during the processing
+    madvise(mapped, size, MADV_WILLNEED);
+
+    mapping = static_cast<uint8_t*>(mapped);
+    mappingSize = size;
+    pixels = { mapping, width, height, rowStride };
+    return true;
+}
+
+void ConditionFile::close() {
+    if (mapping == nullptr) return;
+
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+    pixels = PixelsBuffer();
+}
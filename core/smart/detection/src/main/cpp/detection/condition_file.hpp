@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KLICK_R_CONDITION_FILE_HPP
+#define KLICK_R_CONDITION_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "../types/pixels_buffer.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The file of a condition image, as saved by the application: its RGBA 8888 pixels, row by row without padding.
+     *
+     * The file is mapped in memory once opened, and its pixels are used in place to process the condition template.
+     * The condition bitmap is then never created on the java side, nor copied.
+     */
+    class ConditionFile {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "ConditionFile";
+
+        uint8_t* mapping = nullptr;
+        size_t mappingSize = 0;
+        PixelsBuffer pixels = PixelsBuffer();
+
+    public:
+        ConditionFile() = default;
+        ConditionFile(const ConditionFile&) = delete;
+        ConditionFile& operator=(const ConditionFile&) = delete;
+        ConditionFile(ConditionFile&& other) noexcept;
+        ConditionFile& operator=(ConditionFile&& other) noexcept;
+        ~ConditionFile();
+
+        /**
+         * Map the file of a condition image, closing the previous one.
+         *
+         * @param path the path of the file.
+         * @param width the width of the condition image.
+         * @param height the height of the condition image.
+         *
+         * @return true if the file is mapped, false if it can't be read or its size doesn't match the image one.
+         */
+        bool open(const std::string& path, int width, int height);
+
+        /** Unmap the file, the pixels can't be used anymore. */
+        void close();
+
+        /** @return the pixels of the mapped file, or nullptr if no file is opened. */
+        const PixelsBuffer* getPixels() const { return mapping != nullptr ? &pixels : nullptr; }
+    };
+}
+
+#endif //KLICK_R_CONDITION_FILE_HPP
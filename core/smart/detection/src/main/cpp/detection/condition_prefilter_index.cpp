@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+#include "condition_prefilter_index.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+void ConditionPrefilterIndex::setLevels(LevelBitset& levels, int first, int last) {
+    first = std::max(first, 0);
+    last = std::min(last, WORD_COUNT * WORD_BITS - 1);
+    for (int level = first; level <= last; level++) levels[level / WORD_BITS] |= 1ULL << (level % WORD_BITS);
+}
+
+bool ConditionPrefilterIndex::isCovered(const LevelBitset& levels, const LevelBitset& needed) {
+    for (int i = 0; i < WORD_COUNT; i++) {
+        if ((levels[i] & needed[i]) != needed[i]) return false;
+    }
+    return true;
+}
+
+bool ConditionPrefilterIndex::isIntersecting(const LevelBitset& levels, const LevelBitset& other) {
+    uint64_t intersection = 0;
+    for (int i = 0; i < WORD_COUNT; i++) intersection |= levels[i] & other[i];
+    return intersection != 0;
+}
+
+void ConditionPrefilterIndex::add(int conditionIndex, const cv::Rect& area, const cv::Size& templateSize,
+                                  const TemplateStatistics& templateStatistics, double maxMeanDiff) {
+
+    Group key;
+    key.area = area;
+    key.templateSize = templateSize;
+
+    Descriptor descriptor;
+    descriptor.conditionIndex = conditionIndex;
+    descriptor.isFlat = templateStatistics.isFlat();
+    // A level is the integer part of a window mean, one more on each side keeps the rounding of the means exact
+    const double mean = (double) templateStatistics.getSum() / (double) std::max(templateSize.area(), 1);
+    setLevels(descriptor.levels, (int) std::floor(mean - maxMeanDiff) - 1, (int) std::floor(mean + maxMeanDiff) + 1);
+
+    addedConditions.emplace_back(key, descriptor);
+}
+
+void ConditionPrefilterIndex::build(uint64_t planRevision, const cv::Size& screenSize, bool allConditionsAdded) {
+    revision = planRevision;
+    imageSize = screenSize;
+    isComplete = allConditionsAdded;
+    descriptors.clear();
+    groups.clear();
+
+    // The areas out of the screen are not matched at all, their windows can't be computed
+    const cv::Rect screenRoi(0, 0, screenSize.width, screenSize.height);
+    addedConditions.erase(
+            std::remove_if(addedConditions.begin(), addedConditions.end(), [&screenRoi] (const auto& condition) {
+                return condition.first.area.empty() || (condition.first.area & screenRoi) != condition.first.area;
+            }),
+            addedConditions.end());
+
+    const auto getKey = [] (const Group& group) {
+        return std::make_tuple(group.area.x, group.area.y, group.area.width, group.area.height,
+                               group.templateSize.width, group.templateSize.height);
+    };
+    std::sort(addedConditions.begin(), addedConditions.end(), [&getKey] (const auto& left, const auto& right) {
+        return getKey(left.first) < getKey(right.first);
+    });
+
+    for (size_t first = 0; first < addedConditions.size();) {
+        const Group& key = addedConditions[first].first;
+        size_t last = first + 1;
+        while (last < addedConditions.size() && getKey(addedConditions[last].first) == getKey(key)) last++;
+
+        if ((int) (last - first) >= MIN_GROUP_SIZE) {
+            Group group = key;
+            group.first = (int) descriptors.size();
+            group.count = (int) (last - first);
+            for (size_t i = first; i < last; i++) {
+                const Descriptor& descriptor = addedConditions[i].second;
+                LevelBitset& needed = descriptor.isFlat ? group.neededFlatLevels : group.neededLevels;
+                for (int word = 0; word < WORD_COUNT; word++) needed[word] |= descriptor.levels[word];
+                descriptors.push_back(descriptor);
+            }
+            groups.push_back(group);
+        }
+        first = last;
+    }
+
+    addedConditions.clear();
+}
+
+void ConditionPrefilterIndex::computeWindowLevels(const cv::Mat& sums, const cv::Mat& squaredSums,
+                                                  const Group& group, LevelBitset& levels,
+                                                  LevelBitset& variedLevels) {
+
+    levels.fill(0);
+    variedLevels.fill(0);
+
+    const cv::Rect& area = group.area;
+    const cv::Size& templSize = group.templateSize;
+    const int resultCols = area.width - templSize.width + 1;
+    const int resultRows = area.height - templSize.height + 1;
+    if (resultCols <= 0 || resultRows <= 0) return;
+
+    const auto templArea = (int64_t) templSize.area();
+    const double inverseArea = 1.0 / (double) templArea;
+    for (int y = 0; y < resultRows; y++) {
+        const int* sumsTop = sums.ptr<int>(area.y + y) + area.x;
+        const int* sumsBottom = sums.ptr<int>(area.y + y + templSize.height) + area.x;
+        const auto* squaredSumsTop = squaredSums.ptr<double>(area.y + y) + area.x;
+        const auto* squaredSumsBottom = squaredSums.ptr<double>(area.y + y + templSize.height) + area.x;
+
+        for (int x = 0; x < resultCols; x++) {
+            const int64_t windowSum = (int64_t) sumsBottom[x + templSize.width] - sumsBottom[x]
+                    - sumsTop[x + templSize.width] + sumsTop[x];
+            const int level = std::min((int) ((double) windowSum * inverseArea), WORD_COUNT * WORD_BITS - 1);
+            const uint64_t levelBit = 1ULL << (level % WORD_BITS);
+            levels[level / WORD_BITS] |= levelBit;
+
+            const auto windowSquaredSum = (int64_t) (squaredSumsBottom[x + templSize.width] - squaredSumsBottom[x]
+                    - squaredSumsTop[x + templSize.width] + squaredSumsTop[x]);
+            if (templArea * windowSquaredSum - windowSum * windowSum > 0) variedLevels[level / WORD_BITS] |= levelBit;
+        }
+
+        // No condition of the group can be proven absent anymore
+        if (isCovered(variedLevels, group.neededLevels) && isCovered(levels, group.neededFlatLevels)) return;
+    }
+}
+
+void ConditionPrefilterIndex::findAbsentConditions(const cv::Mat& sums, const cv::Mat& squaredSums,
+                                                   const std::vector<bool>& isNeeded,
+                                                   std::vector<int>& absentConditions) const {
+
+    TRACE_SECTION("findAbsentConditions");
+    absentConditions.clear();
+
+    LevelBitset levels, variedLevels;
+    for (const Group& group : groups) {
+        const auto first = descriptors.begin() + group.first;
+        const auto last = first + group.count;
+        const bool isGroupNeeded = std::any_of(first, last, [&isNeeded] (const Descriptor& descriptor) {
+            return descriptor.conditionIndex < (int) isNeeded.size() && isNeeded[descriptor.conditionIndex];
+        });
+        if (!isGroupNeeded) continue;
+
+        computeWindowLevels(sums, squaredSums, group, levels, variedLevels);
+        for (auto descriptor = first; descriptor != last; descriptor++) {
+            if (descriptor->conditionIndex >= (int) isNeeded.size() || !isNeeded[descriptor->conditionIndex]) continue;
+
+            const LevelBitset& windowLevels = descriptor->isFlat ? levels : variedLevels;
+            if (!isIntersecting(descriptor->levels, windowLevels)) {
+                absentConditions.push_back(descriptor->conditionIndex);
+            }
+        }
+    }
+}
+
+size_t ConditionPrefilterIndex::getMemorySize() const {
+    return descriptors.capacity() * sizeof(Descriptor) + groups.capacity() * sizeof(Group)
+            + addedConditions.capacity() * sizeof(std::pair<Group, Descriptor>);
+}
+
+void ConditionPrefilterIndex::clear() {
+    revision = 0;
+    isComplete = false;
+    addedConditions.clear();
+    descriptors.clear();
+    groups.clear();
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KLICK_R_CONDITION_PREFILTER_INDEX_HPP
+#define KLICK_R_CONDITION_PREFILTER_INDEX_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "template_statistics.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Index of the conditions of a scenario plan searched with the same template size in the same area, to prove
+     * most of them absent with a single pass over the window statistics of that area.
+     *
+     * Each condition is described by the range of window gray means that can pass its color verification, as a
+     * bitset of the 256 gray levels. For each screen image, each group of conditions computes the bitset of the gray
+     * levels of its area windows, from the integral images. A condition whose range intersects no window level can't
+     * be detected, as for [PositionPrefilter::hasPosition], and this is checked word by word for all the conditions of
+     * the group at the cost of a single check.
+     */
+    class ConditionPrefilterIndex {
+
+    private:
+        /** The minimum number of conditions in a group, the smaller ones are proven absent one by one. */
+        static constexpr int MIN_GROUP_SIZE = 4;
+        /** Number of gray levels in a bitset word. */
+        static constexpr int WORD_BITS = 64;
+        /** Number of words of a gray levels bitset. */
+        static constexpr int WORD_COUNT = 256 / WORD_BITS;
+
+        /** A bitset of the window gray levels, the integer part of the window means. */
+        using LevelBitset = std::array<uint64_t, WORD_COUNT>;
+
+        /** A condition of the index. */
+        struct Descriptor {
+            /** The index of the condition in the plan. */
+            int conditionIndex = 0;
+            /** The gray levels of the windows that could pass the condition color verification. */
+            LevelBitset levels {};
+            /** True if the template have no variance, it then also matches the flat windows. */
+            bool isFlat = false;
+        };
+
+        /** The conditions searched with the same template size in the same area. */
+        struct Group {
+            /** The detection area of the conditions, in scaled screen coordinates. */
+            cv::Rect area = cv::Rect();
+            /** The scaled size of the templates of the conditions. */
+            cv::Size templateSize = cv::Size();
+            /** The index of the first condition of the group in [descriptors]. */
+            int first = 0;
+            /** The number of conditions of the group. */
+            int count = 0;
+            /** The gray levels needed by the non flat conditions of the group, all of them checked when covered. */
+            LevelBitset neededLevels {};
+            /** The gray levels needed by the flat conditions of the group. */
+            LevelBitset neededFlatLevels {};
+        };
+
+        /** The identifier of the indexed conditions, 0 if the index is not built. */
+        uint64_t revision = 0;
+        /** The size of the screen images the index is built for, in scaled pixels. */
+        cv::Size imageSize = cv::Size(0, 0);
+        /** False if some conditions templates were not available yet, the index must be built again. */
+        bool isComplete = false;
+        /** The conditions added since the last build, with their group key. */
+        std::vector<std::pair<Group, Descriptor>> addedConditions;
+        /** The conditions of all groups, group by group. */
+        std::vector<Descriptor> descriptors;
+        /** The groups of at least [MIN_GROUP_SIZE] conditions. */
+        std::vector<Group> groups;
+
+        /** Set the bits of the gray levels from [first] to [last] included, clamped to the valid levels. */
+        static void setLevels(LevelBitset& levels, int first, int last);
+        /** @return true if all [needed] levels are set in [levels]. */
+        static bool isCovered(const LevelBitset& levels, const LevelBitset& needed);
+        /** @return true if a level is set in both bitsets. */
+        static bool isIntersecting(const LevelBitset& levels, const LevelBitset& other);
+
+        /**
+         * Compute the gray levels of the windows of a group area, stopping once the levels needed by its conditions
+         * are all set.
+         *
+         * @param levels the levels of all windows.
+         * @param variedLevels the levels of the windows with some variance.
+         */
+        static void computeWindowLevels(const cv::Mat& sums, const cv::Mat& squaredSums, const Group& group,
+                                        LevelBitset& levels, LevelBitset& variedLevels);
+
+    public:
+        ConditionPrefilterIndex() = default;
+
+        /**
+         * Add a condition to the next [build].
+         *
+         * @param conditionIndex the index of the condition in the plan.
+         * @param area the detection area of the condition, in scaled screen coordinates.
+         * @param templateSize the scaled size of the condition template.
+         * @param templateStatistics the statistics of the condition template.
+         * @param maxMeanDiff the maximum difference between the template mean and a window one that can pass the
+         *                    color verification.
+         */
+        void add(int conditionIndex, const cv::Rect& area, const cv::Size& templateSize,
+                 const TemplateStatistics& templateStatistics, double maxMeanDiff);
+
+        /**
+         * Group the conditions added since the last build, replacing the previous ones.
+         *
+         * @param planRevision the identifier of the indexed conditions, see [isBuilt]. Must not be 0.
+         * @param screenSize the size of the screen images, in scaled pixels.
+         * @param allConditionsAdded false if some conditions could not be described yet. The index is then used,
+         *                           but reported as not built to be built again on the next screen image.
+         */
+        void build(uint64_t planRevision, const cv::Size& screenSize, bool allConditionsAdded);
+
+        /** @return true if the index have been built completely for this revision and this screen size. */
+        bool isBuilt(uint64_t planRevision, const cv::Size& screenSize) const {
+            return revision != 0 && isComplete && revision == planRevision && imageSize == screenSize;
+        }
+
+        /** @return true if the index has no group of conditions, there is nothing to prove. */
+        bool isEmpty() const { return groups.empty(); }
+
+        /**
+         * Find the conditions that can't be detected on a screen image.
+         *
+         * @param sums the integral of the scaled gray screen image.
+         * @param squaredSums the squared integral of the scaled gray screen image.
+         * @param isNeeded true for each plan condition that must be matched on this screen image. The groups without
+         *                 any needed condition are not computed.
+         * @param absentConditions filled with the plan indexes of the needed conditions proven absent.
+         */
+        void findAbsentConditions(const cv::Mat& sums, const cv::Mat& squaredSums, const std::vector<bool>& isNeeded,
+                                  std::vector<int>& absentConditions) const;
+
+        /** @return the memory of the descriptors of this index, in bytes. */
+        size_t getMemorySize() const;
+
+        /** Remove all conditions from the index. It must be built again before being used. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_CONDITION_PREFILTER_INDEX_HPP
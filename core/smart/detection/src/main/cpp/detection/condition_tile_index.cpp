@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "condition_tile_index.hpp"
+
+using namespace smartautoclicker;
+
+void ConditionTileIndex::build(uint64_t planRevision, const cv::Size& screenSize, const std::vector<cv::Rect>& areas) {
+    revision = planRevision;
+    imageSize = screenSize;
+    conditionCount = (int) areas.size();
+    wordCount = (conditionCount + WORD_BITS - 1) / WORD_BITS;
+
+    const int tileColumns = (screenSize.width + FrameSignature::TILE_SIZE - 1) / FrameSignature::TILE_SIZE;
+    tileConditions.assign(FrameSignature::getTileCount(screenSize) * wordCount, 0);
+    unboundedConditions.assign(wordCount, 0);
+    dirtyConditions.assign(wordCount, 0);
+
+    const cv::Rect screenRoi(0, 0, screenSize.width, screenSize.height);
+    for (int i = 0; i < conditionCount; i++) {
+        const uint64_t conditionBit = 1ULL << (i % WORD_BITS);
+        const cv::Rect area = areas[i] & screenRoi;
+        if (area.empty()) {
+            unboundedConditions[i / WORD_BITS] |= conditionBit;
+            continue;
+        }
+
+        const int lastColumn = (area.x + area.width - 1) / FrameSignature::TILE_SIZE;
+        const int lastRow = (area.y + area.height - 1) / FrameSignature::TILE_SIZE;
+        for (int tileY = area.y / FrameSignature::TILE_SIZE; tileY <= lastRow; tileY++) {
+            for (int tileX = area.x / FrameSignature::TILE_SIZE; tileX <= lastColumn; tileX++) {
+                const size_t tile = (size_t) tileY * tileColumns + tileX;
+                tileConditions[tile * wordCount + i / WORD_BITS] |= conditionBit;
+            }
+        }
+    }
+}
+
+bool ConditionTileIndex::computeDirtyConditions(const FrameSignature& signature) {
+    const std::vector<uint8_t>& dirtyTiles = signature.getDirtyTiles();
+    if (revision == 0 || !signature.hasPrevious() || signature.getImageSize() != imageSize) return false;
+
+    std::copy(unboundedConditions.begin(), unboundedConditions.end(), dirtyConditions.begin());
+    for (size_t tile = 0; tile < dirtyTiles.size(); tile++) {
+        if (dirtyTiles[tile] == 0) continue;
+
+        const uint64_t* conditions = tileConditions.data() + tile * wordCount;
+        for (int word = 0; word < wordCount; word++) dirtyConditions[word] |= conditions[word];
+    }
+
+    return true;
+}
+
+bool ConditionTileIndex::isCovered(size_t tile) const {
+    const uint64_t* conditions = tileConditions.data() + tile * wordCount;
+    for (int word = 0; word < wordCount; word++) {
+        if (unboundedConditions[word] != 0 || conditions[word] != 0) return true;
+    }
+
+    return false;
+}
+
+size_t ConditionTileIndex::getMemorySize() const {
+    return (tileConditions.capacity() + unboundedConditions.capacity() + dirtyConditions.capacity())
+            * sizeof(uint64_t);
+}
+
+void ConditionTileIndex::clear() {
+    revision = 0;
+    imageSize = cv::Size(0, 0);
+    conditionCount = 0;
+    wordCount = 0;
+    tileConditions.clear();
+    unboundedConditions.clear();
+    dirtyConditions.clear();
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CONDITION_TILE_INDEX_HPP
+#define KLICK_R_CONDITION_TILE_INDEX_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/types.hpp>
+
+#include "frame_signature.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Spatial index of the conditions of a scenario plan over the tiles of the [FrameSignature]. Each tile has the
+     * bitset of the conditions whose area overlaps it, so the conditions touched by the changes of a screen image are
+     * the union of the bitsets of its dirty tiles, instead of checking the tiles of each condition area.
+     */
+    class ConditionTileIndex {
+
+    private:
+        /** Number of conditions in a bitset word. */
+        static constexpr int WORD_BITS = 64;
+
+        /** The identifier of the indexed conditions, 0 if the index is not built. */
+        uint64_t revision = 0;
+        /** The size of the screen images the index is built for, in scaled pixels. */
+        cv::Size imageSize = cv::Size(0, 0);
+        /** The number of indexed conditions. */
+        int conditionCount = 0;
+        /** The number of words of each bitset. */
+        int wordCount = 0;
+        /** The bitset of the conditions of each tile, [wordCount] words per tile, row by row. */
+        std::vector<uint64_t> tileConditions;
+        /** The bitset of the conditions without a known area, always touched by the changes. */
+        std::vector<uint64_t> unboundedConditions;
+        /** The bitset of the conditions touched by the changes of the last screen image. */
+        std::vector<uint64_t> dirtyConditions;
+
+    public:
+        ConditionTileIndex() = default;
+
+        /**
+         * Index the conditions of a plan, replacing the previous ones.
+         *
+         * @param planRevision the identifier of the indexed conditions, see [isBuilt]. Must not be 0.
+         * @param screenSize the size of the screen images, in scaled pixels.
+         * @param areas the area of each condition, in scaled screen coordinates. Empty for the conditions whose area
+         *              is only known during the detection, always reported as dirty.
+         */
+        void build(uint64_t planRevision, const cv::Size& screenSize, const std::vector<cv::Rect>& areas);
+
+        /** @return the identifier of the indexed conditions, 0 if the index is not built. */
+        uint64_t getRevision() const { return revision; }
+
+        /** @return true if the index have been built for this revision of the conditions and this screen size. */
+        bool isBuilt(uint64_t planRevision, const cv::Size& screenSize) const {
+            return revision != 0 && revision == planRevision && imageSize == screenSize;
+        }
+
+        /**
+         * Compute the conditions touched by the changes of the last screen image, read with [isDirty].
+         *
+         * @param signature the signature of the last screen image.
+         *
+         * @return false if the changes are not known: there is no previous image of the size of the index to compare
+         * the last one with. All conditions must be considered dirty.
+         */
+        bool computeDirtyConditions(const FrameSignature& signature);
+
+        /** @return true if the condition at [index] is touched by the changes of the last screen image. */
+        bool isDirty(int index) const {
+            return index >= conditionCount || (dirtyConditions[index / WORD_BITS] >> (index % WORD_BITS) & 1) != 0;
+        }
+
+        /**
+         * Tells if the changes of a tile can change the results of the indexed conditions.
+         *
+         * @param tile the index of the tile, row by row.
+         *
+         * @return true if the area of a condition overlaps the tile, or if a condition has no known area.
+         */
+        bool isCovered(size_t tile) const;
+
+        /** @return the memory of the bitsets of this index, in bytes. */
+        size_t getMemorySize() const;
+
+        /** Remove all conditions from the index. It must be built again before being used. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_CONDITION_TILE_INDEX_HPP
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "cpu_match_backends.hpp"
+#include "detection_image.hpp"
+
+using namespace smartautoclicker;
+
+
+/** @return the cost of the OpenCv direct correlation of a request. */
+static double getDirectCost(const MatchRequest& request) {
+    return (double) request.getResultsSize().area() * request.condition->image.scaledGray->total();
+}
+
+double OpenCvMatchBackend::getCost(const MatchRequest& request) const {
+    return getDirectCost(request);
+}
+
+void OpenCvMatchBackend::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    cv::matchTemplate(*request.image, *request.condition->image.scaledGray, results, cv::TM_CCOEFF_NORMED);
+}
+
+bool FftMatchBackend::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return request.condition->image.scaledGray->total() >= FFT_MATCHING_MIN_TEMPLATE_AREA;
+}
+
+double FftMatchBackend::getCost(const MatchRequest& request) const {
+    return FftMatcher::getCost(request.image->size());
+}
+
+void FftMatchBackend::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    const cv::Size transformSize = FftMatcher::getTransformSize(request.image->size());
+    const cv::Mat spectrum = request.condition->getSpectrum(transformSize);
+
+    FftImageTransforms imageTransforms;
+    if (context.sharedAreaImage != nullptr
+            && context.sharedAreaImage->getFftTransforms(*request.image, transformSize, imageTransforms)) {
+        context.fftMatcher.match(imageTransforms, *request.condition->image.scaledGray, spectrum, results);
+        return;
+    }
+
+    context.fftMatcher.match(*request.image, *request.condition->image.scaledGray, spectrum, results);
+}
+
+bool SmallTemplateMatchBackend::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return SmallTemplateMatcher::isSupported(request.condition->image.scaledGray->size());
+}
+
+double SmallTemplateMatchBackend::getCost(const MatchRequest& request) const {
+    return getDirectCost(request) * SMALL_TEMPLATE_COST_FACTOR;
+}
+
+void SmallTemplateMatchBackend::match(const MatchRequest& request, MatchingContext& context,
+                                      cv::Mat& results) const {
+
+    context.smallTemplateMatcher.match(
+            *request.image, *request.condition->image.scaledGray, request.condition->grayStatistics, results);
+}
+
+bool IntegerMatchBackend::matchStreamed(const MatchRequest& request, MatchingContext& context) const {
+    MatchingResults& results = context.matchingResults;
+    results.beginStreaming(request.getResultsSize(), request.minConfidence);
+    context.integerMatcher.matchStreamed(
+            *request.image, *request.condition->image.scaledGray, request.condition->grayStatistics, results);
+    results.endStreaming();
+
+    return true;
+}
+
+bool IntegerMatchBackend::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return IntegerMatcher::isSupported(request.condition->image.scaledGray->size());
+}
+
+double IntegerMatchBackend::getCost(const MatchRequest& request) const {
+    return getDirectCost(request) * INTEGER_COST_FACTOR;
+}
+
+void IntegerMatchBackend::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    context.integerMatcher.match(
+            *request.image, *request.condition->image.scaledGray, request.condition->grayStatistics, results);
+}
+
+bool BoundedMatchBackend::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return request.minConfidence >= BOUNDED_MATCHING_MIN_CONFIDENCE && request.condition->image.scaledGray->rows >= 2;
+}
+
+double BoundedMatchBackend::getCost(const MatchRequest& request) const {
+    return getDirectCost(request) * BOUNDED_COST_FACTOR;
+}
+
+void BoundedMatchBackend::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    context.boundedMatcher.match(*request.image, *request.condition->image.scaledGray, request.minConfidence, results);
+}
+
+bool GemmMatchBackend::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return context.backendTemplate == request.condition && context.backendResults.size() == request.getResultsSize();
+}
+
+double GemmMatchBackend::getCost(const MatchRequest& request) const {
+    return (double) request.getResultsSize().area();
+}
+
+void GemmMatchBackend::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    context.backendResults.copyTo(results);
+}
+
+bool GemmMatchBackend::isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const {
+    return GemmMatcher::isSupported(templateSize)
+        && areaSize.width >= templateSize.width && areaSize.height >= templateSize.height;
+}
+
+bool GemmMatchBackend::matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) {
+    for (Batch& batch : batches) {
+        batch.jobs.clear();
+        batch.backendJobs.clear();
+    }
+
+    size_t batchCount = 0;
+    for (Job& job : jobs) {
+        const cv::Mat& templ = *job.conditionTemplate->image.scaledGray;
+        const cv::Size batchSize = GemmMatcher::getBatchSize(templ.size());
+
+        auto batch = std::find_if(batches.begin(), batches.begin() + (long) batchCount, [&] (const Batch& other) {
+            return other.area == job.area && other.batchSize == batchSize;
+        });
+        if (batch == batches.begin() + (long) batchCount) {
+            if (batchCount == batches.size()) batches.emplace_back();
+            batch = batches.begin() + (long) batchCount++;
+            batch->area = job.area;
+            batch->batchSize = batchSize;
+        }
+        batch->jobs.push_back({ &templ, &job.conditionTemplate->grayStatistics, job.results });
+        batch->backendJobs.push_back(&job);
+    }
+
+    for (size_t i = 0; i < batchCount; i++) {
+        Batch& batch = batches[i];
+        if (batch.jobs.size() < GEMM_MIN_BATCH_SIZE) {
+            // Matched alone by the workers, with the other backends
+            for (Job* job : batch.backendJobs) job->results->release();
+            continue;
+        }
+
+        gemmMatcher.match((*screenImage.scaledGray)(batch.area), batch.jobs);
+    }
+
+    return true;
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CPU_MATCH_BACKENDS_HPP
+#define KLICK_R_CPU_MATCH_BACKENDS_HPP
+
+#include <vector>
+
+#include "gemm_matcher.hpp"
+#include "match_backend.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The cost factors of the CPU backends, relative to the OpenCv direct correlation. Measured with the detector
+     * benchmark on arm64 devices; without NEON, the specialized kernels are scalar and lose most of their advantage.
+     */
+#if defined(__ARM_NEON)
+    static constexpr double SMALL_TEMPLATE_COST_FACTOR = 0.25;
+    static constexpr double INTEGER_COST_FACTOR = 0.5;
+#else
+    static constexpr double SMALL_TEMPLATE_COST_FACTOR = 0.9;
+    static constexpr double INTEGER_COST_FACTOR = 1.5;
+#endif
+    /** The bounded matching verifies the head rows of all positions, then only the remaining ones. */
+    static constexpr double BOUNDED_COST_FACTOR = 0.75;
+
+    /** The OpenCv template matching. Supports all requests, it is the fallback of the selector. */
+    class OpenCvMatchBackend : public MatchBackend {
+
+    public:
+        MatchBackendType getType() const override { return MatchBackendType::OPENCV; }
+        const char* getName() const override { return "opencv"; }
+        uint32_t getCapabilities() const override { return 0; }
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override { return true; }
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+        bool isBandSplittable() const override { return true; }
+    };
+
+    /** The [FftMatcher] of the matching context, for the big conditions. */
+    class FftMatchBackend : public MatchBackend {
+
+    public:
+        MatchBackendType getType() const override { return MatchBackendType::FFT; }
+        const char* getName() const override { return "fft"; }
+        uint32_t getCapabilities() const override { return 0; }
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+    };
+
+    /** The [SmallTemplateMatcher] of the matching context. */
+    class SmallTemplateMatchBackend : public MatchBackend {
+
+    public:
+        MatchBackendType getType() const override { return MatchBackendType::SMALL_TEMPLATE; }
+        const char* getName() const override { return "small"; }
+        uint32_t getCapabilities() const override { return 0; }
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+        bool isBandSplittable() const override { return true; }
+    };
+
+    /** The [IntegerMatcher] of the matching context. */
+    class IntegerMatchBackend : public MatchBackend {
+
+    public:
+        MatchBackendType getType() const override { return MatchBackendType::INTEGER; }
+        const char* getName() const override { return "integer"; }
+        uint32_t getCapabilities() const override { return CAPABILITY_INTEGER; }
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+        bool matchStreamed(const MatchRequest& request, MatchingContext& context) const override;
+        bool isBandSplittable() const override { return true; }
+    };
+
+    /** The [BoundedMatcher] of the matching context, for the requests with a tight minimum confidence. */
+    class BoundedMatchBackend : public MatchBackend {
+
+    public:
+        MatchBackendType getType() const override { return MatchBackendType::BOUNDED; }
+        const char* getName() const override { return "bounded"; }
+        uint32_t getCapabilities() const override { return CAPABILITY_PRUNED; }
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+        bool isBandSplittable() const override { return true; }
+    };
+
+    /**
+     * The [GemmMatcher], computing all small conditions searched in the same area of a detection at once. Only the
+     * batches of at least [GEMM_MIN_BATCH_SIZE] conditions are computed, the results of the other jobs are released.
+     * It runs on the detection thread before the workers, so it is enabled with the integer matching only.
+     */
+    class GemmMatchBackend : public MatchBackend {
+
+    private:
+        /** The batches of a detection, the jobs with the same area and batch size. */
+        struct Batch {
+            cv::Rect area;
+            cv::Size batchSize;
+            std::vector<GemmMatcher::Job> jobs;
+            std::vector<Job*> backendJobs;
+        };
+
+        GemmMatcher gemmMatcher = GemmMatcher();
+        /** The batches of the last [matchBatch]. Kept between the detections to avoid allocations. */
+        std::vector<Batch> batches;
+
+    public:
+        MatchBackendType getType() const override { return MatchBackendType::GEMM; }
+        const char* getName() const override { return "gemm"; }
+        uint32_t getCapabilities() const override { return CAPABILITY_BATCH | CAPABILITY_INTEGER; }
+        /** @return true if the results of the requested condition have been computed by [matchBatch]. */
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        /** @return the cost of copying the results computed by [matchBatch]. */
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+
+        bool matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) override;
+        bool isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const override;
+    };
+}
+
+#endif //KLICK_R_CPU_MATCH_BACKENDS_HPP
@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <utility>
+
+#include "detection_capture.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+
+void DetectionCapture::setCapacity(size_t frameCount) {
+    frames.clear();
+    frames.resize(frameCount);
+    nextFrameIndex = 0;
+    this->frameCount = 0;
+    templates.clear();
+}
+
+void DetectionCapture::setScreenMetrics(const cv::Size& size, double quality) {
+    screenSize = size;
+    detectionQuality = quality;
+}
+
+void DetectionCapture::addFrame(const cv::Mat& pixels, const cv::Size& fullSize) {
+    if (frames.empty()) return;
+
+    // Reallocated only if the size of the screen images changed
+    Frame& frame = frames[nextFrameIndex];
+    pixels.copyTo(frame.pixels);
+    frame.fullSize = fullSize;
+    frame.detections.clear();
+
+    nextFrameIndex = (nextFrameIndex + 1) % frames.size();
+    if (frameCount < frames.size()) frameCount++;
+}
+
+void DetectionCapture::addTemplate(int64_t conditionId, const PixelsBuffer* conditionPixels) {
+    if (conditionPixels == nullptr || !conditionPixels->isValid() || !isTemplateNeeded(conditionId)) return;
+
+    // Copied without the row padding, the caller pixels are only valid during this call
+    cv::Mat(conditionPixels->height, conditionPixels->width, CV_8UC4, conditionPixels->pixels,
+            conditionPixels->rowStride).copyTo(templates[conditionId]);
+}
+
+void DetectionCapture::addDetection(int64_t conditionId, const PixelsBuffer* conditionPixels, const cv::Rect& roi,
+                                    int threshold) {
+
+    if (frameCount == 0) return;
+
+    addTemplate(conditionId, conditionPixels);
+    Frame& lastFrame = frames[(nextFrameIndex + frames.size() - 1) % frames.size()];
+    lastFrame.detections.push_back({ conditionId, roi, threshold });
+}
+
+void DetectionCapture::clear() {
+    setCapacity(frames.size());
+}
+
+std::vector<const DetectionCapture::Frame*> DetectionCapture::getFrames() const {
+    std::vector<const Frame*> orderedFrames;
+    orderedFrames.reserve(frameCount);
+
+    // The oldest image is the next one to be replaced once the ring is full
+    const size_t oldestIndex = (nextFrameIndex + frames.size() - frameCount) % std::max(frames.size(), (size_t) 1);
+    for (size_t i = 0; i < frameCount; i++) orderedFrames.push_back(&frames[(oldestIndex + i) % frames.size()]);
+
+    return orderedFrames;
+}
+
+bool DetectionCapture::isTemplateNeeded(int64_t conditionId) const {
+    return !frames.empty() && templates.find(conditionId) == templates.end();
+}
+
+const cv::Mat* DetectionCapture::getTemplate(int64_t conditionId) const {
+    auto conditionTemplate = templates.find(conditionId);
+    return conditionTemplate == templates.end() ? nullptr : &conditionTemplate->second;
+}
+
+bool DetectionCapture::write(const std::string& path, const MatchingOptions& options) const {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        LOGE(LOG_TAG, "Can't create detection capture %1$s", path.c_str());
+        return false;
+    }
+
+    uint32_t optionFlags = 0;
+    if (options.isPyramidMatchingEnabled) optionFlags |= OPTION_PYRAMID_MATCHING;
+    if (options.isSparseMatchingEnabled) optionFlags |= OPTION_SPARSE_MATCHING;
+    if (options.isHistogramColorVerificationEnabled) optionFlags |= OPTION_HISTOGRAM_COLOR_VERIFICATION;
+    if (options.isScaledColorVerificationEnabled) optionFlags |= OPTION_SCALED_COLOR_VERIFICATION;
+    if (options.isIntegerMatchingEnabled) optionFlags |= OPTION_INTEGER_MATCHING;
+    if (options.isFirstHitMatchingEnabled) optionFlags |= OPTION_FIRST_HIT_MATCHING;
+    if (options.isLearnedAreaMatchingEnabled) optionFlags |= OPTION_LEARNED_AREA_MATCHING;
+    if (options.isIntegerScaleRatioEnabled) optionFlags |= OPTION_INTEGER_SCALE_RATIO;
+    if (options.isBinaryMatchingEnabled) optionFlags |= OPTION_BINARY_MATCHING;
+    if (options.isChamferMatchingEnabled) optionFlags |= OPTION_CHAMFER_MATCHING;
+    if (options.isMotionCompensationEnabled) optionFlags |= OPTION_MOTION_COMPENSATION;
+
+    const Header header = {
+            MAGIC, VERSION, (uint32_t) frameCount, (uint32_t) templates.size(), screenSize.width, screenSize.height,
+            optionFlags, (uint32_t) options.templateScales.size(), detectionQuality };
+    bool isWritten = fwrite(&header, sizeof(Header), 1, file) == 1
+            && (options.templateScales.empty() || fwrite(options.templateScales.data(), sizeof(double),
+                    options.templateScales.size(), file) == options.templateScales.size());
+
+    for (auto it = templates.begin(); it != templates.end() && isWritten; it++) {
+        const TemplateEntry entry = { (int64_t) it->first, it->second.cols, it->second.rows };
+        isWritten = fwrite(&entry, sizeof(TemplateEntry), 1, file) == 1 && writeMat(file, it->second);
+    }
+
+    const std::vector<const Frame*> orderedFrames = getFrames();
+    for (size_t i = 0; i < orderedFrames.size() && isWritten; i++) {
+        const Frame& frame = *orderedFrames[i];
+        const FrameEntry entry = {
+                frame.pixels.cols, frame.pixels.rows, frame.fullSize.width, frame.fullSize.height,
+                (uint32_t) frame.detections.size(), 0 };
+        isWritten = fwrite(&entry, sizeof(FrameEntry), 1, file) == 1;
+
+        for (size_t j = 0; j < frame.detections.size() && isWritten; j++) {
+            const Detection& detection = frame.detections[j];
+            const DetectionEntry detectionEntry = {
+                    (int64_t) detection.conditionId,
+                    detection.roi.x, detection.roi.y, detection.roi.width, detection.roi.height,
+                    detection.threshold, 0 };
+            isWritten = fwrite(&detectionEntry, sizeof(DetectionEntry), 1, file) == 1;
+        }
+
+        isWritten = isWritten && writeMat(file, frame.pixels);
+    }
+
+    isWritten = fclose(file) == 0 && isWritten;
+    if (!isWritten) {
+        LOGE(LOG_TAG, "Can't write detection capture %1$s", path.c_str());
+        remove(path.c_str());
+        return false;
+    }
+
+    LOGD(LOG_TAG, "Detection capture written with %1$d frames and %2$d templates",
+         (int) frameCount, (int) templates.size());
+    return true;
+}
+
+bool DetectionCapture::read(const std::string& path) {
+    setCapacity(0);
+
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+
+    Header header = {};
+    bool isRead = fread(&header, sizeof(Header), 1, file) == 1
+            && header.magic == MAGIC && header.version == VERSION
+            && header.screenWidth > 0 && header.screenHeight > 0;
+
+    MatchingOptions options;
+    options.isPyramidMatchingEnabled = (header.optionFlags & OPTION_PYRAMID_MATCHING) != 0;
+    options.isSparseMatchingEnabled = (header.optionFlags & OPTION_SPARSE_MATCHING) != 0;
+    options.isHistogramColorVerificationEnabled = (header.optionFlags & OPTION_HISTOGRAM_COLOR_VERIFICATION) != 0;
+    options.isScaledColorVerificationEnabled = (header.optionFlags & OPTION_SCALED_COLOR_VERIFICATION) != 0;
+    options.isIntegerMatchingEnabled = (header.optionFlags & OPTION_INTEGER_MATCHING) != 0;
+    options.isFirstHitMatchingEnabled = (header.optionFlags & OPTION_FIRST_HIT_MATCHING) != 0;
+    options.isLearnedAreaMatchingEnabled = (header.optionFlags & OPTION_LEARNED_AREA_MATCHING) != 0;
+    options.isIntegerScaleRatioEnabled = (header.optionFlags & OPTION_INTEGER_SCALE_RATIO) != 0;
+    options.isBinaryMatchingEnabled = (header.optionFlags & OPTION_BINARY_MATCHING) != 0;
+    options.isChamferMatchingEnabled = (header.optionFlags & OPTION_CHAMFER_MATCHING) != 0;
+    options.isMotionCompensationEnabled = (header.optionFlags & OPTION_MOTION_COMPENSATION) != 0;
+    for (uint32_t i = 0; i < header.templateScaleCount && isRead; i++) {
+        double scale = 0;
+        isRead = fread(&scale, sizeof(double), 1, file) == 1;
+        options.templateScales.push_back(scale);
+    }
+
+    for (uint32_t i = 0; i < header.templateCount && isRead; i++) {
+        TemplateEntry entry = {};
+        isRead = fread(&entry, sizeof(TemplateEntry), 1, file) == 1
+                && readMat(file, entry.width, entry.height, templates[entry.conditionId]);
+    }
+
+    for (uint32_t i = 0; i < header.frameCount && isRead; i++) {
+        FrameEntry entry = {};
+        isRead = fread(&entry, sizeof(FrameEntry), 1, file) == 1
+                && entry.fullSizeWidth >= entry.width && entry.fullSizeHeight >= entry.height;
+
+        // Added while reading, the counts of an invalid file can't allocate more than its content
+        frames.emplace_back();
+        Frame& frame = frames.back();
+        frame.fullSize = cv::Size(entry.fullSizeWidth, entry.fullSizeHeight);
+        for (uint32_t j = 0; j < entry.detectionCount && isRead; j++) {
+            DetectionEntry detectionEntry = {};
+            isRead = fread(&detectionEntry, sizeof(DetectionEntry), 1, file) == 1;
+            frame.detections.push_back({
+                    detectionEntry.conditionId,
+                    cv::Rect(detectionEntry.x, detectionEntry.y, detectionEntry.width, detectionEntry.height),
+                    detectionEntry.threshold });
+        }
+
+        isRead = isRead && readMat(file, entry.width, entry.height, frame.pixels);
+    }
+
+    fclose(file);
+    if (!isRead) {
+        LOGE(LOG_TAG, "Invalid detection capture %1$s", path.c_str());
+        setCapacity(0);
+        return false;
+    }
+
+    screenSize = cv::Size(header.screenWidth, header.screenHeight);
+    detectionQuality = header.detectionQuality;
+    matchingOptions = std::move(options);
+    frameCount = frames.size();
+    return true;
+}
+
+bool DetectionCapture::writeMat(FILE* file, const cv::Mat& image) {
+    const size_t rowLength = (size_t) image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; y++) {
+        if (fwrite(image.ptr<uint8_t>(y), 1, rowLength, file) != rowLength) return false;
+    }
+
+    return true;
+}
+
+bool DetectionCapture::readMat(FILE* file, int width, int height, cv::Mat& result) {
+    if (width <= 0 || height <= 0) return false;
+
+    result.create(height, width, CV_8UC4);
+    return fread(result.data, result.elemSize(), result.total(), file) == result.total();
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DETECTION_CAPTURE_HPP
+#define KLICK_R_DETECTION_CAPTURE_HPP
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "../types/pixels_buffer.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Record of the last screen images of a detection session, with the image conditions detected on each one, to
+     * replay exactly the same matchings outside of the application.
+     *
+     * The screen images are kept in a ring of [setCapacity] images, the oldest one is replaced by each new screen
+     * image. The conditions pixels are kept for the whole session, as they are only provided once to the detector.
+     * Text conditions are not recorded, their results depend on the OCR trained data.
+     *
+     * File layout, in native byte order: a [Header], [Header::templateScaleCount] doubles, [Header::templateCount]
+     * [TemplateEntry] each followed by its RGBA pixels, and then [Header::frameCount] [FrameEntry] each followed by
+     * its [DetectionEntry] and its RGBA pixels. Pixels are stored row by row without padding, the frames from the
+     * oldest to the newest one.
+     */
+    class DetectionCapture {
+
+    public:
+        /** An image condition detected on a screen image. */
+        struct Detection {
+            int64_t conditionId = 0;
+            /** The detection area, in full size coordinates. */
+            cv::Rect roi;
+            int threshold = 0;
+        };
+
+        /** A screen image, with the conditions detected on it. */
+        struct Frame {
+            /** The RGBA pixels of the screen image, smaller than [fullSize] if the screen is captured downscaled. */
+            cv::Mat pixels;
+            /** The size of the screen, for the full size coordinates of the detections. */
+            cv::Size fullSize;
+            std::vector<Detection> detections;
+        };
+
+        /** The matching options of the detector during the capture, the ones changing the matchings results. */
+        struct MatchingOptions {
+            bool isPyramidMatchingEnabled = false;
+            bool isSparseMatchingEnabled = false;
+            bool isBinaryMatchingEnabled = false;
+            bool isChamferMatchingEnabled = false;
+            bool isMotionCompensationEnabled = false;
+            bool isHistogramColorVerificationEnabled = false;
+            bool isScaledColorVerificationEnabled = false;
+            bool isIntegerMatchingEnabled = false;
+            bool isFirstHitMatchingEnabled = false;
+            bool isLearnedAreaMatchingEnabled = false;
+            bool isIntegerScaleRatioEnabled = false;
+            std::vector<double> templateScales;
+        };
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "DetectionCapture";
+
+        /** "KDRC" */
+        static constexpr uint32_t MAGIC = 0x4352444b;
+        /** Incremented for each change in the layout. Captures with another version can't be read. */
+        static constexpr uint32_t VERSION = 1;
+
+        static constexpr uint32_t OPTION_PYRAMID_MATCHING = 1 << 0;
+        static constexpr uint32_t OPTION_SPARSE_MATCHING = 1 << 1;
+        static constexpr uint32_t OPTION_HISTOGRAM_COLOR_VERIFICATION = 1 << 2;
+        static constexpr uint32_t OPTION_SCALED_COLOR_VERIFICATION = 1 << 3;
+        static constexpr uint32_t OPTION_INTEGER_MATCHING = 1 << 4;
+        static constexpr uint32_t OPTION_FIRST_HIT_MATCHING = 1 << 5;
+        static constexpr uint32_t OPTION_LEARNED_AREA_MATCHING = 1 << 6;
+        static constexpr uint32_t OPTION_INTEGER_SCALE_RATIO = 1 << 7;
+        static constexpr uint32_t OPTION_BINARY_MATCHING = 1 << 8;
+        static constexpr uint32_t OPTION_CHAMFER_MATCHING = 1 << 9;
+        static constexpr uint32_t OPTION_MOTION_COMPENSATION = 1 << 10;
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t frameCount;
+            uint32_t templateCount;
+            int32_t screenWidth;
+            int32_t screenHeight;
+            /** The OPTION flags of the [MatchingOptions]. */
+            uint32_t optionFlags;
+            uint32_t templateScaleCount;
+            /** The detection quality of the scenario, the scale ratio is computed from it and the screen size. */
+            double detectionQuality;
+        };
+
+        struct TemplateEntry {
+            int64_t conditionId;
+            int32_t width;
+            int32_t height;
+        };
+
+        struct FrameEntry {
+            int32_t width;
+            int32_t height;
+            int32_t fullSizeWidth;
+            int32_t fullSizeHeight;
+            uint32_t detectionCount;
+            uint32_t reserved;
+        };
+
+        struct DetectionEntry {
+            int64_t conditionId;
+            int32_t x;
+            int32_t y;
+            int32_t width;
+            int32_t height;
+            int32_t threshold;
+            int32_t reserved;
+        };
+
+        cv::Size screenSize = cv::Size(0, 0);
+        double detectionQuality = 0;
+        /** The matching options read from a capture file. */
+        MatchingOptions matchingOptions;
+        /** The ring of screen images. Their pixels are reused from one image to another of the same size. */
+        std::vector<Frame> frames;
+        /** Index in [frames] of the next screen image to record. */
+        size_t nextFrameIndex = 0;
+        /** Number of screen images recorded in [frames], up to its size. */
+        size_t frameCount = 0;
+        /** The RGBA pixels of the conditions, per condition identifier. */
+        std::unordered_map<int64_t, cv::Mat> templates;
+
+        static bool writeMat(FILE* file, const cv::Mat& image);
+        static bool readMat(FILE* file, int width, int height, cv::Mat& result);
+
+    public:
+        DetectionCapture() = default;
+
+        DetectionCapture(const DetectionCapture&) = delete;
+        DetectionCapture& operator=(const DetectionCapture&) = delete;
+
+        /**
+         * Set the number of screen images kept by the capture, dropping the recorded ones.
+         *
+         * @param frameCount the number of the last screen images to keep, 0 to disable the capture.
+         */
+        void setCapacity(size_t frameCount);
+
+        bool isEnabled() const { return !frames.empty(); }
+
+        /** Set the screen metrics of the next screen images. */
+        void setScreenMetrics(const cv::Size& size, double quality);
+
+        /**
+         * Record a new screen image, replacing the oldest one if the ring is full.
+         *
+         * @param pixels the RGBA pixels of the screen image, copied.
+         * @param fullSize the size of the screen.
+         */
+        void addFrame(const cv::Mat& pixels, const cv::Size& fullSize);
+
+        /**
+         * Record the pixels of a condition, copied if they are not recorded yet. The detections of a condition
+         * without pixels can't be replayed.
+         *
+         * @param conditionPixels the pixels of the condition, can be null if it is already processed by the detector.
+         */
+        void addTemplate(int64_t conditionId, const PixelsBuffer* conditionPixels);
+
+        /** Record the detection of an image condition on the last screen image, and its pixels with [addTemplate]. */
+        void addDetection(int64_t conditionId, const PixelsBuffer* conditionPixels, const cv::Rect& roi, int threshold);
+
+        /** @return true if the capture is enabled and the pixels of the condition are not recorded yet. */
+        bool isTemplateNeeded(int64_t conditionId) const;
+
+        /** Drop all recorded screen images and conditions, keeping the capacity. */
+        void clear();
+
+        const cv::Size& getScreenSize() const { return screenSize; }
+        double getDetectionQuality() const { return detectionQuality; }
+        /** @return the matching options of the capture file read with [read]. */
+        const MatchingOptions& getMatchingOptions() const { return matchingOptions; }
+
+        /** @return the recorded screen images, from the oldest to the newest one. */
+        std::vector<const Frame*> getFrames() const;
+
+        /** @return the RGBA pixels of a condition, or nullptr if they have not been recorded. */
+        const cv::Mat* getTemplate(int64_t conditionId) const;
+
+        /**
+         * Write the recorded screen images and conditions into a file.
+         *
+         * @param path the path of the capture file.
+         * @param options the current matching options of the detector.
+         *
+         * @return true if the file has been written.
+         */
+        bool write(const std::string& path, const MatchingOptions& options) const;
+
+        /**
+         * Read a capture file, replacing the recorded content. The capacity becomes the number of screen images read.
+         *
+         * @return true if the file is a valid capture, false if not. The capture is then empty.
+         */
+        bool read(const std::string& path);
+    };
+}
+
+#endif //KLICK_R_DETECTION_CAPTURE_HPP
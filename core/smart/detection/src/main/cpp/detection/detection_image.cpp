@@ -15,13 +15,18 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <android/bitmap.h>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include "chamfer_template.hpp"
 #include "detection_image.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/trace.hpp"
 
 using namespace smartautoclicker;
 
+/** Number of scaled pixels computed around each region, covering the rounding of the conditions scaled rois. */
+static constexpr int SCALED_REGION_MARGIN = 2;
+
 
 bool DetectionImage::isFullSizeContains(const cv::Rect& roi) const {
     return isRoiContains(fullSizeRoi, roi);
@@ -35,74 +40,329 @@ bool DetectionImage::isCroppedScaledContains(const cv::Size& size) const {
     return croppedScaledGray->cols >= size.width && croppedScaledGray->rows >= size.height;
 }
 
+size_t DetectionImage::getMemorySize() const {
+    std::lock_guard<std::mutex> pyramidLock(pyramidMutex);
+    std::lock_guard<std::mutex> integralsLock(integralsMutex);
+    std::lock_guard<std::mutex> edgeDistancesLock(edgeDistancesMutex);
+    std::lock_guard<std::mutex> tileIndexLock(tileIndexMutex);
+    std::lock_guard<std::mutex> fftTransformsLock(fftTransformsMutex);
+    size_t size = getMatMemorySize(*fullSizeColor) + getMatMemorySize(*scaledGray)
+            + getMatMemorySize(scaledGraySums) + getMatMemorySize(scaledGraySquaredSums)
+            + getMatMemorySize(edgeDistances)
+            + scaledGrayConverter.getMemorySize() + tileIndex.getMemorySize();
+    for (const cv::Mat& level : pyramidLevels) size += getMatMemorySize(level);
+    for (const std::shared_ptr<AreaFftTransforms>& entry : areaFftTransforms) {
+        std::lock_guard<std::mutex> entryLock(entry->mutex);
+        size += getMatMemorySize(entry->transforms.spectrum) + getMatMemorySize(entry->transforms.sums)
+                + getMatMemorySize(entry->transforms.squaredSums);
+    }
+
+    return size;
+}
+
+size_t DetectionImage::getPyramidMemorySize() const {
+    std::lock_guard<std::mutex> lock(pyramidMutex);
+    size_t size = 0;
+    for (const cv::Mat& level : pyramidLevels) size += getMatMemorySize(level);
+
+    return size;
+}
+
+void DetectionImage::releasePyramidLevels() {
+    std::lock_guard<std::mutex> lock(pyramidMutex);
+    pyramidStatistics.onEvicted(pyramidLevelsCount);
+    pyramidLevelsCount = 0;
+    for (cv::Mat& level : pyramidLevels) level.release();
+}
+
 bool DetectionImage::isRoiContains(const cv::Rect& roi, const cv::Rect& other) {
     return roi.x <= other.x && roi.y <= other.y && roi.width >= other.width && roi.height >= other.height;
 }
 
-void DetectionImage::readBitmapInfo(JNIEnv *env, jobject bitmap, AndroidBitmapInfo* result) {
-    try {
-        CV_Assert(AndroidBitmap_getInfo(env, bitmap, result) >= 0);
-        CV_Assert(result->format == ANDROID_BITMAP_FORMAT_RGBA_8888);
-    } catch (...) {
-        jclass je = env->FindClass("java/lang/Exception");
-        env->ThrowNew(je, "Android Bitmap exception in JNI code {readBitmapInfo}");
+cv::Rect DetectionImage::toScaledRegion(const cv::Rect& region, double scaleRatio) {
+    // Rounded outwards with a margin, the scaled rois of the conditions are rounded to the nearest pixel
+    const int left = cvFloor(region.x * scaleRatio) - SCALED_REGION_MARGIN;
+    const int top = cvFloor(region.y * scaleRatio) - SCALED_REGION_MARGIN;
+    const int right = cvCeil((region.x + region.width) * scaleRatio) + SCALED_REGION_MARGIN;
+    const int bottom = cvCeil((region.y + region.height) * scaleRatio) + SCALED_REGION_MARGIN;
+
+    return { left, top, right - left, bottom - top };
+}
+
+void DetectionImage::setRegions(const std::vector<cv::Rect>& fullSizeRegions) {
+    regions = fullSizeRegions;
+    isRegionsCleared = false;
+}
+
+void DetectionImage::copySettings(const DetectionImage& other) {
+    setRegions(other.regions);
+    isTileHashingEnabled = other.isTileHashingEnabled;
+    isScaledColorOnly = other.isScaledColorOnly;
+    planesAllocator = other.planesAllocator;
+}
+
+void DetectionImage::applyPlanesAllocator(cv::Mat& plane) const {
+    cv::MatAllocator* allocator = planesAllocator != nullptr ? planesAllocator : cv::Mat::getDefaultAllocator();
+    if (plane.u != nullptr && plane.u->currAllocator != allocator) plane.release();
+    plane.allocator = planesAllocator;
+}
+
+void DetectionImage::processPixelsCopy(const PixelsBuffer& pixels, double scaleRatio, ThreadPool* threadPool) {
+    fullSizeRoi.width = pixels.width;
+    fullSizeRoi.height = pixels.height;
+    colorScale = 1.0;
+
+    // Previous image might have been a header on external pixels, never write into them
+    if (fullSizeColor->u == nullptr) fullSizeColor->release();
+    applyPlanesAllocator(*fullSizeColor);
+    const cv::Mat pixelsImage(pixels.height, pixels.width, CV_8UC4, pixels.pixels, pixels.rowStride);
+    if (!isScaledColorOnly) {
+        pixelsImage.copyTo(*fullSizeColor);
+        computeScaledGray(scaleRatio, threadPool);
+        return;
     }
+
+    // Converted from the caller pixels directly, only their downscaled copy is kept. Its memory is reused.
+    cv::Mat scaledColor = *fullSizeColor;
+    *fullSizeColor = pixelsImage;
+    computeScaledGray(scaleRatio, threadPool);
+
+    TRACE_SECTION("scaledColor");
+    if (scaledRegions.empty()) {
+        cv::resize(pixelsImage, scaledColor, scaledSize, 0, 0, cv::INTER_AREA);
+    } else {
+        // Only the regions are read by the detection, the rest of the copy is never downscaled
+        scaledColor.create(scaledSize, CV_8UC4);
+        const double fullSizeFactorX = (double) fullSizeRoi.width / scaledSize.width;
+        const double fullSizeFactorY = (double) fullSizeRoi.height / scaledSize.height;
+        for (const cv::Rect& scaledRegion : scaledRegions) {
+            if (scaledRegion.empty()) continue;
+
+            const int left = cvFloor(scaledRegion.x * fullSizeFactorX);
+            const int top = cvFloor(scaledRegion.y * fullSizeFactorY);
+            const cv::Rect fullSizeRegion = cv::Rect(left, top,
+                    cvCeil((scaledRegion.x + scaledRegion.width) * fullSizeFactorX) - left,
+                    cvCeil((scaledRegion.y + scaledRegion.height) * fullSizeFactorY) - top) & fullSizeRoi;
+            cv::Mat scaledColorRegion = scaledColor(scaledRegion);
+            cv::resize(pixelsImage(fullSizeRegion), scaledColorRegion, scaledRegion.size(), 0, 0, cv::INTER_AREA);
+        }
+    }
+    *fullSizeColor = scaledColor;
+    colorScale = (double) scaledSize.width / fullSizeRoi.width;
+}
+
+void DetectionImage::processPixels(uint8_t* pixels, int width, int height, size_t rowStride, double scaleRatio,
+                                   ThreadPool* threadPool) {
+    processPixels(pixels, width, height, rowStride, cv::Size(width, height), scaleRatio, threadPool);
 }
 
-void DetectionImage::processBitmap(JNIEnv *env, jobject bitmap, double scaleRatio) {
-    // Read bitmap & fill fullSize color Mat
-    AndroidBitmapInfo info;
-    readBitmapInfo(env, bitmap, &info);
-    fillFullSizeColor(env, bitmap, &info);
+void DetectionImage::processPixels(uint8_t* pixels, int width, int height, size_t rowStride, const cv::Size& fullSize,
+                                   double scaleRatio, ThreadPool* threadPool) {
+    fullSizeRoi.width = fullSize.width;
+    fullSizeRoi.height = fullSize.height;
+    colorScale = fullSize.width == width ? 1.0 : (double) width / fullSize.width;
 
-    // Fill fullSize gray Mat
-    computeFullSizeGray();
+    // Only a header on the pixels, the color conversion will read them directly
+    *fullSizeColor = cv::Mat(height, width, CV_8UC4, pixels, rowStride);
 
-    // Fill scaled gray Mat
-    computeScaledGray(scaleRatio);
+    computeScaledGray(scaleRatio, threadPool);
 }
 
 void DetectionImage::setCropping(const ScalableRoi& cropRoi) {
-    *croppedFullSizeColor = (*fullSizeColor)(cropRoi.fullSize & fullSizeRoi);
+    *croppedFullSizeColor = (*fullSizeColor)(toColorRoi(cropRoi.fullSize & fullSizeRoi)
+            & cv::Rect(0, 0, fullSizeColor->cols, fullSizeColor->rows));
     *croppedScaledGray = (*scaledGray)(cropRoi.scaled & scaledRoi);
 
     cropScaledSize.width = croppedScaledGray->cols;
     cropScaledSize.height = croppedScaledGray->rows;
 }
 
-void DetectionImage::fillFullSizeColor(JNIEnv *env, jobject bitmap, AndroidBitmapInfo* bitmapInfo) {
-    try {
-        fullSizeRoi.width = (int) bitmapInfo->width;
-        fullSizeRoi.height = (int) bitmapInfo->height;
+void DetectionImage::getCropping(const ScalableRoi& cropRoi, cv::Mat& croppedScaled, cv::Mat& croppedFullSize) const {
+    croppedFullSize = (*fullSizeColor)(toColorRoi(cropRoi.fullSize & fullSizeRoi)
+            & cv::Rect(0, 0, fullSizeColor->cols, fullSizeColor->rows));
+    croppedScaled = (*scaledGray)(cropRoi.scaled & scaledRoi);
+}
+
+const cv::Mat& DetectionImage::getCoarseScaledGray(int factor) {
+    static const cv::Mat EMPTY_LEVEL = cv::Mat();
 
-        void *pixels = nullptr;
-        CV_Assert(AndroidBitmap_lockPixels(env, bitmap, &pixels) >= 0);
+    int levelIndex = 0;
+    while (levelIndex < PYRAMID_LEVELS_COUNT && (2 << levelIndex) != factor) levelIndex++;
+    if (levelIndex == PYRAMID_LEVELS_COUNT) return EMPTY_LEVEL;
+
+    std::lock_guard<std::mutex> lock(pyramidMutex);
+    if (pyramidFrameIndex != frameIndex) {
+        pyramidStatistics.onEvicted(pyramidLevelsCount);
+        pyramidLevelsCount = 0;
+        pyramidFrameIndex = frameIndex;
+    }
+    if (levelIndex < pyramidLevelsCount) {
+        pyramidStatistics.onHit();
+        return pyramidLevels[levelIndex];
+    }
 
-        fullSizeColor->create(fullSizeRoi.height, fullSizeRoi.width, CV_8UC4);
-        memcpy(fullSizeColor->data, pixels, fullSizeRoi.height * fullSizeRoi.width * 4);
+    pyramidStatistics.onMiss();
 
-        AndroidBitmap_unlockPixels(env, bitmap);
-    } catch (...) {
-        AndroidBitmap_unlockPixels(env, bitmap);
+    TRACE_SECTION("pyramidLevels");
+    for (; pyramidLevelsCount <= levelIndex; pyramidLevelsCount++) {
+        const cv::Mat& previous = pyramidLevelsCount == 0 ? *scaledGray : pyramidLevels[pyramidLevelsCount - 1];
+        cv::Mat& level = pyramidLevels[pyramidLevelsCount];
 
-        jclass je = env->FindClass("java/lang/Exception");
-        env->ThrowNew(je, "Android Bitmap exception in JNI code {fillFullSizeColor}");
+        // Without the incomplete border blocks, each pixel is the mean of a single 2x2 block of the previous level
+        const cv::Size levelSize(previous.cols / 2, previous.rows / 2);
+        if (levelSize.empty()) {
+            level.release();
+            continue;
+        }
+        cv::resize(previous(cv::Rect(0, 0, levelSize.width * 2, levelSize.height * 2)), level, levelSize, 0, 0,
+                   cv::INTER_AREA);
     }
+
+    return pyramidLevels[levelIndex];
 }
 
-void DetectionImage::computeFullSizeGray() const {
-    fullSizeGray->create(fullSizeColor->rows, fullSizeColor->cols, CV_8UC1);
-    cv::cvtColor(*fullSizeColor, *fullSizeGray, cv::COLOR_RGBA2GRAY);
+void DetectionImage::getScaledGrayIntegrals(cv::Mat& sums, cv::Mat& squaredSums) {
+    std::lock_guard<std::mutex> lock(integralsMutex);
+    if (scaledGraySums.empty() || integralsFrameIndex != frameIndex) {
+        TRACE_SECTION("scaledGrayIntegrals");
+
+        // New matrices, the previous ones might still be used by another thread
+        scaledGraySums = cv::Mat();
+        scaledGraySquaredSums = cv::Mat();
+        cv::integral(*scaledGray, scaledGraySums, scaledGraySquaredSums, CV_32S, CV_64F);
+        integralsFrameIndex = frameIndex;
+    }
+
+    sums = scaledGraySums;
+    squaredSums = scaledGraySquaredSums;
 }
 
-void DetectionImage::computeScaledGray(double scaleRatio) {
+bool DetectionImage::getEdgeDistances(const cv::Mat& croppedScaled, cv::Mat& distances) {
+    if (croppedScaled.empty() || croppedScaled.datastart != scaledGray->datastart) return false;
+
+    cv::Size wholeSize;
+    cv::Point offset;
+    croppedScaled.locateROI(wholeSize, offset);
+
+    std::lock_guard<std::mutex> lock(edgeDistancesMutex);
+    if (edgeDistances.empty() || edgeDistancesFrameIndex != frameIndex) {
+        TRACE_SECTION("edgeDistances");
+
+        // New matrix, the previous one might still be used by another thread
+        edgeDistances = cv::Mat();
+        ChamferTemplate::computeDistances(*scaledGray, edgeDistances);
+        edgeDistancesFrameIndex = frameIndex;
+    }
+
+    distances = edgeDistances(cv::Rect(offset, croppedScaled.size()));
+    return true;
+}
+
+const TileHashIndex& DetectionImage::getTileIndex() {
+    std::lock_guard<std::mutex> lock(tileIndexMutex);
+    if (tileIndex.isEmpty() || tileIndexFrameIndex != frameIndex) {
+        tileIndex.build(*fullSizeColor);
+        tileIndexFrameIndex = frameIndex;
+    }
+
+    return tileIndex;
+}
+
+bool DetectionImage::getFftTransforms(const cv::Mat& croppedScaled, const cv::Size& transformSize,
+                                      FftImageTransforms& transforms) {
+
+    if (croppedScaled.empty() || croppedScaled.datastart != scaledGray->datastart) return false;
+
+    cv::Size wholeSize;
+    cv::Point offset;
+    croppedScaled.locateROI(wholeSize, offset);
+    const cv::Rect area(offset, croppedScaled.size());
+
+    // Only the lookup is under the shared lock, the matchings of the other areas continue during the computation
+    std::shared_ptr<AreaFftTransforms> entry;
+    {
+        std::lock_guard<std::mutex> lock(fftTransformsMutex);
+        if (fftTransformsFrameIndex != frameIndex) {
+            areaFftTransforms.clear();
+            fftTransformsFrameIndex = frameIndex;
+        }
+
+        for (const std::shared_ptr<AreaFftTransforms>& candidate : areaFftTransforms) {
+            if (candidate->area == area && candidate->transformSize == transformSize) {
+                entry = candidate;
+                break;
+            }
+        }
+        if (entry == nullptr) {
+            if (areaFftTransforms.size() >= FFT_TRANSFORMS_AREAS_COUNT) {
+                areaFftTransforms.erase(areaFftTransforms.begin());
+            }
+            entry = std::make_shared<AreaFftTransforms>();
+            entry->area = area;
+            entry->transformSize = transformSize;
+            areaFftTransforms.push_back(entry);
+        }
+    }
+
+    std::lock_guard<std::mutex> entryLock(entry->mutex);
+    if (!entry->isComputed) {
+        TRACE_SECTION("areaFftTransforms");
+
+        cv::Mat paddedImage;
+        FftMatcher::computeImageTransforms(croppedScaled, transformSize, paddedImage, entry->transforms);
+        entry->isComputed = true;
+    }
+
+    transforms = entry->transforms;
+    return true;
+}
+
+cv::Rect DetectionImage::toColorRoi(const cv::Rect& roi) const {
+    if (colorScale == 1.0) return roi;
+
+    return {
+        cvFloor(roi.x * colorScale),
+        cvFloor(roi.y * colorScale),
+        std::max(1, cvRound(roi.width * colorScale)),
+        std::max(1, cvRound(roi.height * colorScale)),
+    };
+}
+
+void DetectionImage::computeScaledGray(double scaleRatio, ThreadPool* threadPool) {
+    TRACE_SECTION("scaledGray");
+
     // Calculate new dimensions and ensure non-zero dimensions
     scaledSize.width = std::max(1, cvRound(fullSizeRoi.width * scaleRatio));
     scaledSize.height = std::max(1, cvRound(fullSizeRoi.height * scaleRatio));
     scaledRoi.width = scaledSize.width;
     scaledRoi.height = scaledSize.height;
+    applyPlanesAllocator(*scaledGray);
+    scaledRegions.clear();
+
+    // Convert to gray and resize in a single pass, and store result in scaledGray
+    if (regions.empty() && isTileHashingEnabled) {
+        tileHashes.resize(FrameSignature::getTileCount(scaledSize));
+        scaledGrayConverter.convert(*fullSizeColor, *scaledGray, scaledSize, threadPool, FrameSignature::TILE_SIZE,
+                                    [this](int firstRow, int endRow) {
+            FrameSignature::computeTileHashes(*scaledGray, firstRow, endRow, tileHashes.data());
+        });
+        return;
+    }
 
-    // Resize and store result in scaledGray
-    scaledGray->create(scaledSize, CV_8UC1);
-    cv::resize(*fullSizeGray, *scaledGray, scaledSize, 0, 0, cv::INTER_AREA);
+    // The regions are not hashed while converted, the signature will be computed on the whole image
+    tileHashes.clear();
+    if (regions.empty()) {
+        scaledGrayConverter.convert(*fullSizeColor, *scaledGray, scaledSize, threadPool);
+        return;
+    }
+
+    if (!isRegionsCleared || scaledGray->size() != scaledSize || scaledGray->type() != CV_8UC1) {
+        scaledGray->create(scaledSize, CV_8UC1);
+        scaledGray->setTo(cv::Scalar(0));
+        isRegionsCleared = true;
+    }
+    for (const cv::Rect& region : regions) {
+        scaledRegions.push_back(toScaledRegion(region, scaleRatio) & scaledRoi);
+        scaledGrayConverter.convert(*fullSizeColor, *scaledGray, scaledSize, scaledRegions.back(), threadPool);
+    }
 }
@@ -18,25 +18,98 @@
 #ifndef KLICK_R_DETECTION_IMAGE_HPP
 #define KLICK_R_DETECTION_IMAGE_HPP
 
-#include <jni.h>
-#include <android/bitmap.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <opencv2/core/types.hpp>
 
+#include "fft_matcher.hpp"
+#include "frame_signature.hpp"
+#include "tile_hash_index.hpp"
+#include "../types/cache_statistics.hpp"
+#include "../types/pixels_buffer.hpp"
 #include "../types/scalable_roi.hpp"
+#include "../utils/scaled_gray_converter.hpp"
+#include "../utils/thread_pool.hpp"
 
 namespace smartautoclicker {
 
+    /** Number of downscaled levels of the screen image pyramid, the last one being at 1/16 of [scaledGray]. */
+    static constexpr int PYRAMID_LEVELS_COUNT = 4;
+    /** Number of detection areas with their FFT transforms kept for the same image, see [getFftTransforms]. */
+    static constexpr size_t FFT_TRANSFORMS_AREAS_COUNT = 4;
+
     class DetectionImage {
 
         private:
-            void fillFullSizeColor(JNIEnv *env, jobject bitmap, AndroidBitmapInfo* bitmapInfo);
-            void computeFullSizeGray() const;
-            void computeScaledGray(double scaleRatio);
+            /** Converts [fullSizeColor] into [scaledGray], without full size gray intermediate image. */
+            ScaledGrayConverter scaledGrayConverter = ScaledGrayConverter();
+
+            /** The areas of [scaledGray] to compute, in full size coordinates. Empty to compute the whole image. */
+            std::vector<cv::Rect> regions;
+            /**
+             * True once [scaledGray] have been cleared for [regions]. Outside of them, it stays black from one image
+             * to another and is never compared as changed.
+             */
+            bool isRegionsCleared = false;
+            /** The areas of [scaledGray] computed for [regions] by the last processing. Empty for the whole image. */
+            std::vector<cv::Rect> scaledRegions;
+
+            /** Guards the lazy computation of [pyramidLevels], requested by the concurrent matchings. */
+            mutable std::mutex pyramidMutex;
+            /**
+             * The levels of the pyramid of [scaledGray], level n being downscaled by 2^(n + 1). Only the first
+             * [pyramidLevelsCount] levels are computed for the image of [pyramidFrameIndex].
+             */
+            std::array<cv::Mat, PYRAMID_LEVELS_COUNT> pyramidLevels;
+            int pyramidLevelsCount = 0;
+            uint64_t pyramidFrameIndex = 0;
+            /** The lookups of the [pyramidLevels], and the levels dropped when the image changes. */
+            CacheStatistics pyramidStatistics;
+
+            /** Guards the lazy computation of the integral images, requested by the concurrent matchings. */
+            mutable std::mutex integralsMutex;
+            /** The integral images of [scaledGray] and of its square, for the image of [integralsFrameIndex]. */
+            cv::Mat scaledGraySums = cv::Mat();
+            cv::Mat scaledGraySquaredSums = cv::Mat();
+            uint64_t integralsFrameIndex = 0;
+
+            /** Guards the lazy computation of [edgeDistances], requested by the concurrent matchings. */
+            mutable std::mutex edgeDistancesMutex;
+            /** The distances of [scaledGray] to the closest edges, for the image of [edgeDistancesFrameIndex]. */
+            cv::Mat edgeDistances = cv::Mat();
+            uint64_t edgeDistancesFrameIndex = 0;
+
+            /** Guards the lazy build of [tileIndex], requested by the concurrent matchings. */
+            mutable std::mutex tileIndexMutex;
+            /** The index of the tiles of [fullSizeColor], for the image of [tileIndexFrameIndex]. */
+            TileHashIndex tileIndex = TileHashIndex();
+            uint64_t tileIndexFrameIndex = 0;
+
+            /** The FFT transforms of an area of [scaledGray], computed by the first matching requesting them. */
+            struct AreaFftTransforms {
+                cv::Rect area = cv::Rect();
+                cv::Size transformSize = cv::Size();
+                /** Guards the computation of [transforms], the other areas can be computed concurrently. */
+                std::mutex mutex;
+                bool isComputed = false;
+                FftImageTransforms transforms = FftImageTransforms();
+            };
+            /** Guards [areaFftTransforms], requested by the concurrent matchings. */
+            mutable std::mutex fftTransformsMutex;
+            /** The transforms of the last areas requested for the image of [fftTransformsFrameIndex], oldest first. */
+            std::vector<std::shared_ptr<AreaFftTransforms>> areaFftTransforms;
+            uint64_t fftTransformsFrameIndex = 0;
+
+            void computeScaledGray(double scaleRatio, ThreadPool* threadPool);
+            /** Set [planesAllocator] on a plane, releasing it if it was allocated by another one. */
+            void applyPlanesAllocator(cv::Mat& plane) const;
             static bool isRoiContains(const cv::Rect& roi, const cv::Rect& other);
+            static cv::Rect toScaledRegion(const cv::Rect& region, double scaleRatio);
 
         public:
             std::unique_ptr<cv::Mat> fullSizeColor = std::make_unique<cv::Mat>();
-            std::unique_ptr<cv::Mat> fullSizeGray = std::make_unique<cv::Mat>();
             std::unique_ptr<cv::Mat> scaledGray = std::make_unique<cv::Mat>();
 
             std::unique_ptr<cv::Mat> croppedFullSizeColor = std::make_unique<cv::Mat>();
@@ -46,19 +119,162 @@ namespace smartautoclicker {
             cv::Rect scaledRoi = cv::Rect(0, 0, 0, 0);
             cv::Size scaledSize = cv::Size(0, 0);
             cv::Size cropScaledSize = cv::Size(0, 0);
+            /**
+             * Size of [fullSizeColor] relative to [fullSizeRoi]. Lower than 1 when the screen is captured downscaled,
+             * the full size coordinates must then be converted with [toColorRoi] to read the color pixels.
+             */
+            double colorScale = 1.0;
+
+            /**
+             * The index of the frame in this image, from [FrameBroker::newFrameIndex]. Unique in the process, as the
+             * image can be read by several detectors. 0 if it is not set yet.
+             */
+            uint64_t frameIndex = 0;
+
+            /** True to compute the [tileHashes] of the scaled gray image while processing it. */
+            bool isTileHashingEnabled = false;
+            /**
+             * The [FrameSignature] tile hashes of [scaledGray], computed band by band during its conversion when
+             * enabled, while the band is still in the cache. Empty if they are not computed for the current image.
+             */
+            std::vector<uint64_t> tileHashes;
+
+            /**
+             * True to only keep a copy of the color pixels downscaled at the scale ratio in [processPixelsCopy], for
+             * the scaled color verification. [fullSizeColor] is then at [colorScale], like a screen captured
+             * downscaled, and the full resolution frame is never copied.
+             */
+            bool isScaledColorOnly = false;
+
+            /**
+             * The allocator of the [fullSizeColor] copy and of [scaledGray], nullptr for the OpenCv default one. The
+             * planes allocated by another one are allocated again on the next processing.
+             */
+            cv::MatAllocator* planesAllocator = nullptr;
 
             DetectionImage() = default;
 
-            static void readBitmapInfo(JNIEnv *env, jobject bitmap, AndroidBitmapInfo* result) ;
+            /**
+             * Process an image from RGBA pixels, copied in the full size color image, or downscaled in it if
+             * [isScaledColorOnly]. The pixels can be released once this call returns. The scaled gray image is
+             * computed on the thread pool, if provided.
+             */
+            void processPixelsCopy(const PixelsBuffer& pixels, double scaleRatio, ThreadPool* threadPool = nullptr);
 
-            void processBitmap(JNIEnv *env, jobject bitmap, double scaleRatio);
+            /**
+             * Process an image from RGBA pixels, without copying them.
+             * The full size color image refers to the pixels, they must remain valid while this image is used.
+             */
+            void processPixels(uint8_t* pixels, int width, int height, size_t rowStride, double scaleRatio,
+                               ThreadPool* threadPool = nullptr);
+
+            /**
+             * Process an image from RGBA pixels of a screen captured downscaled, without copying them.
+             * The full size coordinates of this image are the ones of the screen, the color pixels are at [colorScale].
+             *
+             * @param fullSize the size of the screen, bigger or equal to the pixels size.
+             */
+            void processPixels(uint8_t* pixels, int width, int height, size_t rowStride, const cv::Size& fullSize,
+                               double scaleRatio, ThreadPool* threadPool = nullptr);
+
+            /**
+             * Only compute the scaled gray image in some areas of the image, leaving it black elsewhere. Applied from
+             * the next processing, the conditions must then only be searched in those areas.
+             *
+             * @param fullSizeRegions the areas to compute, in full size coordinates. Empty to compute the whole image.
+             */
+            void setRegions(const std::vector<cv::Rect>& fullSizeRegions);
+            /** @return the areas computed by the processing, in full size coordinates. Empty for the whole image. */
+            const std::vector<cv::Rect>& getRegions() const { return regions; }
+            /**
+             * @return the areas of [scaledGray] computed by the last processing, in scaled coordinates. Empty for the
+             * whole image.
+             */
+            const std::vector<cv::Rect>& getScaledRegions() const { return scaledRegions; }
+
+            /**
+             * Apply the processing settings of another image: its regions, tile hashing, color pixels and planes
+             * allocator. Its content is not copied, it is only applied from the next processing.
+             */
+            void copySettings(const DetectionImage& other);
 
             void setCropping(const ScalableRoi& cropRoi);
+            /** Get views on the scaled gray and full size color images cropped to the provided roi. */
+            void getCropping(const ScalableRoi& cropRoi, cv::Mat& croppedScaled, cv::Mat& croppedFullSize) const;
+            /**
+             * Get a level of the pyramid of [scaledGray], for the coarse matchings. The levels are computed once per
+             * image of [frameIndex], each one from the previous one, up to the deepest requested one, and shared by all
+             * conditions. It can be called by concurrent matchings. Pixel (x, y) of the result is the mean of the
+             * factor x factor block starting at (x * factor, y * factor) in [scaledGray], rounded at each level.
+             *
+             * @param factor the downscale factor of the level, a power of 2 up to 2^[PYRAMID_LEVELS_COUNT].
+             *
+             * @return the level, empty if the factor is not supported or bigger than the image.
+             */
+            const cv::Mat& getCoarseScaledGray(int factor);
+
+            /**
+             * Get the integral images of [scaledGray] and of its square, for the window statistics of the matching
+             * positions. Computed on the first call for the image of [frameIndex] and shared by all following ones, it
+             * can be called by concurrent matchings.
+             *
+             * @param sums set to the integral of [scaledGray], in CV_32S.
+             * @param squaredSums set to the integral of its square, in CV_64F. Exact, as its values are below 2^53.
+             */
+            void getScaledGrayIntegrals(cv::Mat& sums, cv::Mat& squaredSums);
+
+            /**
+             * Get the distances of the pixels of a detection area to their closest edge, for the chamfer matching of
+             * all conditions. The edge map and its distance transform are computed once for the whole [scaledGray] on
+             * the first call for the image of [frameIndex] and shared by all following ones, it can be called by
+             * concurrent matchings.
+             *
+             * @param croppedScaled the detection area, a view on [scaledGray] from [getCropping].
+             * @param distances set to a view on the distances of the area, see [ChamferTemplate::computeDistances].
+             *
+             * @return false if the area is not a view on [scaledGray], true if the distances are set.
+             */
+            bool getEdgeDistances(const cv::Mat& croppedScaled, cv::Mat& distances);
+
+            /**
+             * Get the index of the tiles of [fullSizeColor], for the exact pixel matching of all conditions. Built on
+             * the first call for the image of [frameIndex] and shared by all following ones, it can be called by
+             * concurrent matchings.
+             */
+            const TileHashIndex& getTileIndex();
+
+            /**
+             * Get the FFT transforms of a detection area, for the FFT matching of all conditions searched in it.
+             * Computed on the first call for the area in the image of [frameIndex] and shared by all following ones, it
+             * can be called by concurrent matchings. Only the last [FFT_TRANSFORMS_AREAS_COUNT] areas are kept.
+             *
+             * @param croppedScaled the detection area, a view on [scaledGray] from [getCropping].
+             * @param transformSize the size of the transforms, from [FftMatcher::getTransformSize].
+             * @param transforms set to the transforms of the area.
+             *
+             * @return false if the area is not a view on [scaledGray], true if the transforms are set.
+             */
+            bool getFftTransforms(const cv::Mat& croppedScaled, const cv::Size& transformSize,
+                                  FftImageTransforms& transforms);
+
+            /** Convert an area in full size coordinates into [fullSizeColor] coordinates. Not clipped. */
+            cv::Rect toColorRoi(const cv::Rect& roi) const;
 
             bool isFullSizeContains(const cv::Rect& roi) const;
             bool isScaledContains(const cv::Rect& roi) const;
             bool isCroppedScaledContains(const cv::Size& size) const;
 
+            /** @return the memory of the images owned by this image, in bytes. Pixels of the caller excluded. */
+            size_t getMemorySize() const;
+
+            /** @return the memory of the computed pyramid levels, in bytes. */
+            size_t getPyramidMemorySize() const;
+            /** Release the computed pyramid levels, they are computed again by the next coarse matching. */
+            void releasePyramidLevels();
+
+            /** @return the lookups of the pyramid levels by the coarse matchings, since the creation of this image. */
+            const CacheStatistics& getPyramidStatistics() const { return pyramidStatistics; }
+
 
 
     };
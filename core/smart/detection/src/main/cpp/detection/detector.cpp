@@ -15,213 +15,3380 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <cctype>
+#include <functional>
+#include <unistd.h>
 #include <opencv2/imgproc/imgproc_c.h>
 #include <tesseract/baseapi.h>
-#include <leptonica/allheaders.h>
+#include <tesseract/ocrclass.h>
 
+#include "../utils/frame_allocator.hpp"
 #include "../utils/log.h"
 #include "../utils/scaling.hpp"
+#include "../utils/trace.hpp"
+#include "cpu_match_backends.hpp"
 #include "detector.hpp"
 
+#ifdef SMART_DETECTION_VULKAN
+#include "../gpu/vulkan_matcher.hpp"
+#endif
+#ifdef SMART_DETECTION_NNAPI
+#include "../gpu/nnapi_matcher.hpp"
+#endif
+
 
 using namespace smartautoclicker;
 
+/** @return true if a detection deadline is set and passed. 0 means no deadline. */
+static bool isDeadlineExpired(int64_t deadlineNanos) {
+    return deadlineNanos > 0 && ConditionStatistics::getTimeNanos() > deadlineNanos;
+}
+
+/** @return the arena size fitting the scratch matrices of a condition matching for a scaled screen size. */
+static size_t getScratchArenaSize(int scaledWidth, int scaledHeight) {
+    const int coarseWidth = scaledWidth / PYRAMID_MIN_DOWNSCALE_FACTOR;
+    const int coarseHeight = scaledHeight / PYRAMID_MIN_DOWNSCALE_FACTOR;
+    const int refinedLength = PYRAMID_REFINE_MARGIN * PYRAMID_MAX_DOWNSCALE_FACTOR * 2 + 1;
+    const int sparseRefinedLength = SPARSE_REFINE_MARGIN * 2 + 1;
+    const int binaryRefinedLength = BINARY_REFINE_MARGIN * 2 + 1;
+    const int chamferRefinedLength = CHAMFER_REFINE_MARGIN * 2 + 1;
+
+    // The results of the smallest condition on the whole screen, or the pyramid levels and refinements, or the sparse
+    // binary or chamfer results and their dense verifications
+    return ScratchArena::getMatSize(scaledHeight, scaledWidth, CV_32F)
+            + ScratchArena::getMatSize(coarseHeight, coarseWidth, CV_8U)
+            + ScratchArena::getMatSize(coarseHeight, coarseWidth, CV_32F)
+            + ScratchArena::getMatSize(refinedLength, refinedLength, CV_32F) * PYRAMID_CANDIDATES_COUNT
+            + std::max({
+                    ScratchArena::getMatSize(sparseRefinedLength, sparseRefinedLength, CV_32F)
+                            * SPARSE_CANDIDATES_COUNT,
+                    ScratchArena::getMatSize(binaryRefinedLength, binaryRefinedLength, CV_32F)
+                            * BINARY_CANDIDATES_COUNT,
+                    ScratchArena::getMatSize(chamferRefinedLength, chamferRefinedLength, CV_32F)
+                            * CHAMFER_CANDIDATES_COUNT });
+}
+
+void Detector::initialize() {
+    unsigned int threadCount = ThreadPool::getDefaultThreadCount();
+    if (threadCount > 0) threadPool = std::make_unique<ThreadPool>(threadCount);
+    for (std::shared_ptr<DetectionImage>& image : screenImages) image->isTileHashingEnabled = true;
+    LOGD(LOG_TAG, "Initialized");
+}
+
+void Detector::release() {
+    screenImagePreparer.cancel();
+    threadPool.reset();
+    workerContexts.clear();
+    clearMatchHistories();
+    matchMemo.clear();
+    matchBackends.removeBackend(MatchBackendType::VULKAN);
+    performanceHintSession.close();
+    templateCache.release();
+    ocrTextCache.clear();
+    mainContext.ocrPreprocessor = OcrPreprocessor();
+    mainContext.textRegionProposer = TextRegionProposer();
+    workerOcrEngines.clear();
+    screenColorIntegral.clear();
+    detectionCapture.setCapacity(0);
+    LOGD(LOG_TAG, "Released");
+}
+
+void Detector::setScreenMetrics(const std::string& metricsTag, int width, int height, double detectionQuality) {
+    scaleRatioManager.computeScaleRatio(
+            (u_int32_t) width,
+            (u_int32_t) height,
+            detectionQuality,
+            metricsTag.c_str());
+
+    LOGD(LOG_TAG,
+         "Screen metrics defined: FullSize=[%1$d/%2$d], Quality=%3$f, scaleRatio=%4$f",
+         width, height, detectionQuality, scaleRatioManager.getScaleRatio());
+
+    screenSize = cv::Size(width, height);
+    screenDetectionQuality = (int64_t) detectionQuality;
+    screenMetricsTag = metricsTag;
+    detectionCapture.setScreenMetrics(screenSize, detectionQuality);
+
+    // Scale ratio might have changed, previous screen images can't be compared with the next ones
+    screenSignature.clear();
+    globalMotion.clear();
+    animatedTilesMask.clear();
+    screenStates.clear();
+    ocrTextCache.clear();
+    framePacer.clear();
+    planTileIndex.clear();
+    planPrefilterIndex.clear();
+
+    // Allocated once for the worst case of both orientations, the matchings of the next frames and the ones after a
+    // rotation won't allocate their scratch matrices
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+    const int scaledWidth = cvRound(width * scaleRatio);
+    const int scaledHeight = cvRound(height * scaleRatio);
+    scratchArenaSize = std::max(
+            getScratchArenaSize(scaledWidth, scaledHeight),
+            getScratchArenaSize(scaledHeight, scaledWidth));
+    mainContext.scratchArena.reserve(scratchArenaSize);
+    for (MatchingContext& context : workerContexts) context.scratchArena.reserve(scratchArenaSize);
+}
+
+bool Detector::copyScreenImage(const PixelsBuffer& screenPixels) {
+    TRACE_SECTION("setScreenImage");
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    const int64_t startNanos = FramePacer::getTimeNanos();
+
+    // The back image might be filled in the background
+    screenImagePreparer.cancel();
+    if (!screenPixels.isValid()) {
+        screenSignature.clear();
+        return false;
+    }
+
+    DetectionImage& nextImage = getBackScreenImage();
+    nextImage.processPixelsCopy(screenPixels, scaleRatioManager.getScaleRatio(), threadPool.get());
+
+    return swapScreenImages(nextImage, startNanos);
+}
+
+bool Detector::setScreenImage(const PixelsBuffer& screenPixels, int64_t frameId) {
+    TRACE_SECTION("setScreenImage");
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    const int64_t startNanos = FramePacer::getTimeNanos();
+
+    if (!screenPixels.isValid()) {
+        screenSignature.clear();
+        return false;
+    }
+
+    // Already processed in the background if it was prepared during the previous detection
+    const int width = screenPixels.width;
+    const int height = screenPixels.height;
+    const cv::Size fullSize = getScreenFullSize(width, height);
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+    const bool isShared = frameId != 0;
+    const FrameBroker::Key frameKey = isShared
+            ? FrameBroker::getKey(frameId, screenPixels, fullSize, scaleRatio, *screenImages[frontScreenImageIndex])
+            : FrameBroker::Key();
+    DetectionImage* nextImage = screenImagePreparer.take(
+            screenPixels.pixels, width, height, screenPixels.rowStride, fullSize, scaleRatio);
+
+    // Already processed by another detector set with the same frame, its image is only read
+    if (nextImage == nullptr && isShared) {
+        std::shared_ptr<DetectionImage> brokerImage = FrameBroker::getInstance().find(frameKey);
+        if (brokerImage != nullptr) return useBrokerScreenImage(std::move(brokerImage), startNanos);
+    }
+
+    if (nextImage == nullptr) {
+        nextImage = &getBackScreenImage();
+        nextImage->processPixels(
+                screenPixels.pixels, width, height, screenPixels.rowStride, fullSize, scaleRatio, threadPool.get());
+    }
+
+    return swapScreenImages(*nextImage, startNanos, isShared ? &frameKey : nullptr);
+}
+
+bool Detector::prepareScreenImage(const PixelsBuffer& screenPixels, int64_t frameId) {
+    if (!screenPixels.isValid()) return false;
+
+    const cv::Size fullSize = getScreenFullSize(screenPixels.width, screenPixels.height);
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+    // The back image is only filled when the next one is set, instead of being kept ready between two frames
+    if (memoryPressure >= MEMORY_PRESSURE_FRAMES) return false;
+    if (frameId != 0 && FrameBroker::getInstance().find(FrameBroker::getKey(
+            frameId, screenPixels, fullSize, scaleRatio, *screenImages[frontScreenImageIndex])) != nullptr) {
+        return false;
+    }
+
+    screenImagePreparer.prepare(screenPixels.pixels, screenPixels.width, screenPixels.height, screenPixels.rowStride,
+                                fullSize, scaleRatio, getBackScreenImage());
+    return true;
+}
+
+void Detector::cancelScreenImagePreparation() {
+    screenImagePreparer.cancel();
+}
+
+void Detector::setScreenRegions(const std::vector<cv::Rect>& regions) {
+    // Overlapping areas are merged, their common pixels would be computed twice
+    std::vector<cv::Rect> mergedRegions;
+    for (const cv::Rect& region : regions) {
+        if (region.empty()) continue;
+
+        cv::Rect merged = region;
+        for (size_t i = 0; i < mergedRegions.size();) {
+            if ((mergedRegions[i] & merged).empty()) {
+                i++;
+                continue;
+            }
+
+            // The bigger area might overlap areas already checked, check all of them again
+            merged |= mergedRegions[i];
+            mergedRegions.erase(mergedRegions.begin() + (long) i);
+            i = 0;
+        }
+        mergedRegions.push_back(merged);
+    }
+
+    // The back image is written by the preparation, and would be prepared with the previous regions
+    screenImagePreparer.cancel();
+    for (std::shared_ptr<DetectionImage>& image : screenImages) image->setRegions(mergedRegions);
+
+    LOGD(LOG_TAG, "Screen regions defined: %1$zu regions", mergedRegions.size());
+}
+
+void Detector::setExcludedAreas(const std::vector<cv::Rect>& areas) {
+    animatedTilesMask.setUserAreas(areas);
+    LOGD(LOG_TAG, "Excluded areas defined: %1$zu areas", areas.size());
+}
+
+int Detector::classifyScreenState() {
+    TRACE_SECTION("classifyScreenState");
+    return screenStates.classify(*screenImage->scaledGray);
+}
+
+void Detector::setScreenInsets(int left, int top, int right, int bottom) {
+    screenInsets = ScreenInsets { std::max(left, 0), std::max(top, 0), std::max(right, 0), std::max(bottom, 0) };
+    LOGD(LOG_TAG, "Screen insets defined: %1$d %2$d %3$d %4$d", left, top, right, bottom);
+}
+
+cv::Size Detector::getScreenFullSize(int width, int height) const {
+    // A frame smaller than the screen metrics is the screen captured downscaled, results stay in screen coordinates
+    if (width < screenSize.width && height <= screenSize.height) return screenSize;
+    return { width, height };
+}
+
+DetectionImage& Detector::getBackScreenImage() {
+    std::shared_ptr<DetectionImage>& backImage = screenImages[(frontScreenImageIndex + 1) % SCREEN_IMAGES_COUNT];
+
+    // Withdrawn from the broker when it stopped being the front one, but another detector might still read it
+    if (backImage.use_count() > 1) {
+        auto image = std::make_shared<DetectionImage>();
+        image->copySettings(*backImage);
+        backImage = std::move(image);
+    }
+
+    return *backImage;
+}
+
+bool Detector::swapScreenImages(DetectionImage& image, int64_t startNanos, const FrameBroker::Key* frameKey) {
+    FrameBroker& frameBroker = FrameBroker::getInstance();
+    const bool isUnchanged = updateScreenSignature(image);
+    image.frameIndex = frameBroker.newFrameIndex();
+
+    // The previous front image will be written again, the other detectors must not find it anymore
+    frameBroker.withdraw(screenImages[frontScreenImageIndex].get());
+    frontScreenImageIndex = (frontScreenImageIndex + 1) % SCREEN_IMAGES_COUNT;
+    brokerScreenImage.reset();
+    screenImage = &image;
+    if (frameKey != nullptr) frameBroker.publish(*frameKey, screenImages[frontScreenImageIndex]);
+
+    onScreenImageSet(isUnchanged, startNanos);
+    return isUnchanged;
+}
+
+bool Detector::useBrokerScreenImage(std::shared_ptr<DetectionImage> image, int64_t startNanos) {
+    // Published once its tile hashes have been consumed, the signature is computed from its gray pixels, read only
+    const bool isUnchanged = updateScreenSignature(*image);
+
+    FrameBroker::getInstance().withdraw(screenImages[frontScreenImageIndex].get());
+    brokerScreenImage = std::move(image);
+    screenImage = brokerScreenImage.get();
+
+    onScreenImageSet(isUnchanged, startNanos);
+    return isUnchanged;
+}
+
+void Detector::onScreenImageSet(bool isUnchanged, int64_t startNanos) {
+    regionChangeWaiter.onScreenImage(
+            screenSignature, animatedTilesMask.getExcludedTiles(), scaleRatioManager.getScaleRatio());
+    framePacer.onFrameStarted(startNanos, isUnchanged);
+    frameTelemetry.beginFrame(screenSignature.getFrameIndex(), startNanos, FramePacer::getTimeNanos(), isUnchanged);
+
+    // The shift is estimated on the whole scaled image, it is black outside of the regions
+    if (isMotionCompensationEnabled) {
+        if (screenImage->getRegions().empty()) globalMotion.update(*screenImage->scaledGray, screenSignature);
+        else globalMotion.clear();
+    }
+    if (detectionCapture.isEnabled()) {
+        detectionCapture.addFrame(*screenImage->fullSizeColor, screenImage->fullSizeRoi.size());
+    }
+
+    // No template is referenced between two frames, the ones not detected during the last one can be evicted
+    enforceMemoryBudget();
+    updateMemoryPressure();
+    templateCache.trim();
+}
+
+bool Detector::updateScreenSignature(DetectionImage& image) {
+    bool isUnchanged;
+    if (image.tileHashes.empty()) {
+        // Outside of its regions, the scaled gray image stays black and doesn't need to be hashed
+        isUnchanged = screenSignature.update(*image.scaledGray, image.getScaledRegions());
+    } else {
+        // The hashes now contain the previous ones, they are not the ones of this image anymore
+        isUnchanged = screenSignature.update(image.scaledSize, image.tileHashes);
+        image.tileHashes.clear();
+    }
+    if (!animatedTilesMask.isActive()) return isUnchanged;
+
+    // The tiles of the last detected plan are never excluded, the results of its conditions are still valid
+    animatedTilesMask.update(screenSignature, planTileIndex, scaleRatioManager.getScaleRatio());
+    return isUnchanged || animatedTilesMask.isUnchanged(screenSignature);
+}
+
+void Detector::setPyramidMatchingEnabled(bool enabled) {
+    isPyramidMatchingEnabled = enabled;
+}
+
+void Detector::setSparseMatchingEnabled(bool enabled) {
+    isSparseMatchingEnabled = enabled;
+}
+
+void Detector::setBinaryMatchingEnabled(bool enabled) {
+    isBinaryMatchingEnabled = enabled;
+}
+
+void Detector::setChamferMatchingEnabled(bool enabled) {
+    isChamferMatchingEnabled = enabled;
+}
+
+void Detector::setMotionCompensationEnabled(bool enabled) {
+    isMotionCompensationEnabled = enabled;
+    if (!enabled) globalMotion.clear();
+}
+
+void Detector::setAnimatedAreasExclusionEnabled(bool enabled) {
+    animatedTilesMask.setLearningEnabled(enabled);
+}
+
+void Detector::setFirstHitMatchingEnabled(bool enabled) {
+    isFirstHitMatchingEnabled = enabled;
+}
+
+void Detector::setLearnedAreaMatchingEnabled(bool enabled) {
+    isLearnedAreaMatchingEnabled = enabled;
+}
+
+void Detector::setConditionPrefilterEnabled(bool enabled) {
+    isConditionPrefilterEnabled = enabled;
+    if (!enabled) planPrefilterIndex.clear();
+}
+
+void Detector::setIntegerScaleRatioEnabled(bool enabled) {
+    isIntegerScaleRatioEnabled = enabled;
+    scaleRatioManager.setIntegerRatioEnabled(enabled);
+}
+
+void Detector::setDetectionCancelled(bool cancelled) {
+    isDetectionCancelled.store(cancelled, std::memory_order_relaxed);
+    if (cancelled) regionChangeWaiter.wakeUp();
+}
+
+bool Detector::waitForRegionChange(const cv::Rect& roi, double changeThreshold, int64_t timeoutNanos) {
+    TRACE_SECTION("waitForRegionChange");
+    if (isDetectionCancelled.load(std::memory_order_relaxed)) return false;
+    return regionChangeWaiter.wait(roi, changeThreshold, timeoutNanos, isDetectionCancelled);
+}
+
+bool Detector::isDetectionStopped(int64_t deadlineNanos) const {
+    return isDetectionCancelled.load(std::memory_order_relaxed) || isDeadlineExpired(deadlineNanos);
+}
+
+bool Detector::isOverTimeBudget(const MatchHistory& history, int64_t matchingStart) const {
+    if (conditionTimeBudgetNanos <= 0) return false;
+
+    const int64_t elapsedNanos = ConditionStatistics::getTimeNanos() - matchingStart;
+    return elapsedNanos + history.completeMatchingNanos > conditionTimeBudgetNanos;
+}
+
+void Detector::updateCompleteMatching(MatchHistory& history, int64_t matchingNanos, bool isDegraded) {
+    history.completeMatchingNanos = isDegraded ? history.completeMatchingNanos / 2 : matchingNanos;
+}
+
+void Detector::setTemplateScales(const std::vector<double>& scales) {
+    templateScales.clear();
+    for (double scale : scales) {
+        // The condition size is always matched first
+        if (scale > 0 && scale != 1.0) templateScales.push_back(scale);
+    }
+
+    // Previous results might have been found at a scale that is no longer searched
+    clearMatchHistories();
+    matchMemo.clear();
+}
+
+void Detector::setExactMatchingJitter(int pixels) {
+    exactMatchingJitter = std::max(pixels, 0);
+
+    // The exact areas are not the same anymore
+    clearMatchHistories();
+    matchMemo.clear();
+}
+
+void Detector::setExactPixelMatchingEnabled(bool enabled) {
+    if (isExactPixelMatchingEnabled == enabled) return;
+    isExactPixelMatchingEnabled = enabled;
+
+    // The near exact conditions found by correlation might not have the exact pixels
+    clearMatchHistories();
+    matchMemo.clear();
+}
+
+void Detector::setHistogramColorVerificationEnabled(bool enabled) {
+    if (isHistogramColorVerificationEnabled == enabled) return;
+    isHistogramColorVerificationEnabled = enabled;
+
+    // Previous results have been verified with the other color verification
+    clearMatchHistories();
+    matchMemo.clear();
+}
+
+void Detector::setScaledColorVerificationEnabled(bool enabled) {
+    if (isScaledColorVerificationEnabled == enabled) return;
+    isScaledColorVerificationEnabled = enabled;
+    for (std::shared_ptr<DetectionImage>& image : screenImages) image->isScaledColorOnly = enabled;
+
+    // Previous results have been verified with the other color means
+    clearMatchHistories();
+    matchMemo.clear();
+}
+
+void Detector::setFrameAllocatorEnabled(bool enabled) {
+    cv::MatAllocator* allocator = enabled ? &FrameAllocator::getInstance() : nullptr;
+    for (std::shared_ptr<DetectionImage>& image : screenImages) image->planesAllocator = allocator;
+
+    // Only the released blocks are cached, the ones of the planes still used by other detectors are kept
+    if (!enabled) FrameAllocator::getInstance().trim();
+}
+
+void Detector::setIntegerMatchingEnabled(bool enabled) {
+    if (matchBackends.isCapabilityEnabled(MatchBackend::CAPABILITY_INTEGER) == enabled) return;
+    matchBackends.setCapabilityEnabled(MatchBackend::CAPABILITY_INTEGER, enabled);
+
+    // Previous results have been computed with the other correlation, their confidences might slightly differ
+    clearMatchHistories();
+    matchMemo.clear();
+}
+
+bool Detector::setGpuMatchingEnabled(bool enabled) {
+#ifdef SMART_DETECTION_VULKAN
+    if ((matchBackends.getBackend(MatchBackendType::VULKAN) != nullptr) == enabled) return enabled;
+
+    if (enabled) {
+        std::unique_ptr<VulkanMatcher> vulkanMatcher = VulkanMatcher::create();
+        if (!vulkanMatcher) return false;
+        matchBackends.addBackend(std::move(vulkanMatcher));
+    } else {
+        matchBackends.removeBackend(MatchBackendType::VULKAN);
+    }
+
+    // Same as the integer matching, the confidences of the previous results might slightly differ
+    clearMatchHistories();
+    matchMemo.clear();
+    return enabled;
+#else
+    if (enabled) LOGW(LOG_TAG, "GPU matching is not available in this build");
+    return false;
+#endif
+}
+
+bool Detector::setNnapiMatchingEnabled(bool enabled) {
+#ifdef SMART_DETECTION_NNAPI
+    if ((matchBackends.getBackend(MatchBackendType::NNAPI) != nullptr) == enabled) return enabled;
+
+    if (enabled) {
+        std::unique_ptr<NnapiMatcher> nnapiMatcher = NnapiMatcher::create();
+        if (!nnapiMatcher) return false;
+        matchBackends.addBackend(std::move(nnapiMatcher));
+    } else {
+        matchBackends.removeBackend(MatchBackendType::NNAPI);
+    }
+
+    // The candidates are correlated again in integers, their confidences might slightly differ
+    clearMatchHistories();
+    matchMemo.clear();
+    return enabled;
+#else
+    if (enabled) LOGW(LOG_TAG, "NNAPI matching is not available in this build");
+    return false;
+#endif
+}
+
+void Detector::setTargetDetectionRate(double detectionsPerSecond) {
+    framePacer.setTargetRate(detectionsPerSecond);
+    LOGD(LOG_TAG, "Target detection rate defined: %1$f", detectionsPerSecond);
+}
+
+int64_t Detector::getFrameDelayMs() {
+    const bool isFrameCompleted = framePacer.isFrameStarted();
+    const int64_t delayMs = framePacer.completeFrame();
+    if (isFrameCompleted) frameTelemetry.completeFrame(FramePacer::getTimeNanos());
+    if (isFrameCompleted && isPerformanceHintEnabled) reportFrameCost();
+
+    return delayMs;
+}
+
+void Detector::reportFrameCost() {
+    // Without pacing, the frames are expected to be detected at the display rate
+    const int64_t targetNanos = framePacer.getTargetInterval() > 0
+            ? framePacer.getTargetInterval() : PERFORMANCE_HINT_DEFAULT_TARGET_NANOS;
+
+    if (!performanceHintSession.isOpened()) {
+        std::vector<int32_t> threadIds;
+        if (threadPool != nullptr) threadIds = threadPool->getThreadIds();
+        threadIds.push_back((int32_t) gettid());
+
+        if (!performanceHintSession.open(threadIds, targetNanos)) {
+            isPerformanceHintEnabled = false;
+            return;
+        }
+    }
+
+    performanceHintSession.setTargetDuration(targetNanos);
+    performanceHintSession.reportActualDuration(framePacer.getLastFrameCost());
+}
+
+void Detector::setThreadCount(int threadCount) {
+    const unsigned int count = threadCount < 0
+            ? ThreadPool::getDefaultThreadCount()
+            : std::min((unsigned int) threadCount, ThreadPool::getMaxThreadCount());
+    if (threadPool != nullptr && (unsigned int) threadPool->getWorkerCount() == count + 1) return;
+
+    // The batch workers contexts are created again for the new workers, the performance hints for the new threads
+    threadPool.reset();
+    if (count > 0) {
+        threadPool = std::make_unique<ThreadPool>(count);
+        threadPool->setThreadPolicy(threadPolicy);
+    }
+    workerContexts.clear();
+    performanceHintSession.close();
+
+    LOGD(LOG_TAG, "Thread count defined: %1$u", count);
+}
+
+void Detector::setThreadPolicy(const ThreadPolicy& policy) {
+    threadPolicy = policy;
+    if (threadPool != nullptr) threadPool->setThreadPolicy(policy);
+
+    LOGD(LOG_TAG, "Thread policy defined: preferBigCores=%1$d, priority=%2$d", policy.preferBigCores, policy.priority);
+}
+
+bool Detector::setPerformanceHintEnabled(bool enabled) {
+    isPerformanceHintEnabled = enabled && PerformanceHintSession::isSupported();
+    if (!isPerformanceHintEnabled) performanceHintSession.close();
+    if (enabled && !isPerformanceHintEnabled) LOGW(LOG_TAG, "Performance hints are not supported by this device");
+
+    return isPerformanceHintEnabled;
+}
+
+void Detector::setMemoryBudget(size_t budget) {
+    memoryBudget = budget;
+    isOverMemoryBudget = false;
+    if (budget == 0) templateCache.setMemoryBudget(TemplateCache::DEFAULT_MEMORY_BUDGET);
+
+    LOGD(LOG_TAG, "Memory budget defined: %1$zu bytes", budget);
+}
+
+void Detector::setMemoryPressure(int pressure) {
+    requestedMemoryPressure = std::clamp(pressure, (int) MEMORY_PRESSURE_NONE, (int) MEMORY_PRESSURE_FRAMES);
+}
+
+void Detector::setConditionTimeBudget(int64_t budgetNanos) {
+    conditionTimeBudgetNanos = std::max(budgetNanos, (int64_t) 0);
+    LOGD(LOG_TAG, "Condition time budget defined: %1$lld ns", (long long) conditionTimeBudgetNanos);
+}
+
+std::vector<int64_t> Detector::getMemoryUsage() const {
+    const MemoryUsage usage = computeMemoryUsage();
+    return {
+        usage.screenImages,
+        usage.colorIntegral,
+        usage.templates,
+        usage.matchingScratch,
+        usage.ocrEngines,
+        usage.ocrTexts,
+        usage.budget,
+    };
+}
+
+MemoryUsage Detector::computeMemoryUsage() const {
+    MemoryUsage usage;
+    for (const std::shared_ptr<DetectionImage>& image : screenImages) {
+        usage.screenImages += (int64_t) image->getMemorySize();
+    }
+    usage.screenImages += (int64_t) FrameAllocator::getInstance().getCachedSize();
+    usage.colorIntegral = (int64_t) screenColorIntegral.getMemorySize();
+    usage.templates = (int64_t) templateCache.getMemorySize();
+    usage.matchingScratch = (int64_t) mainContext.getMemorySize();
+    for (const MatchingContext& context : workerContexts) usage.matchingScratch += (int64_t) context.getMemorySize();
+    usage.ocrEngines = (int64_t) OcrEnginePool::getInstance().getMemorySize();
+    usage.ocrTexts = (int64_t) ocrTextCache.getMemorySize();
+    usage.budget = (int64_t) memoryBudget;
+
+    return usage;
+}
+
+void Detector::enforceMemoryBudget() {
+    if (memoryBudget == 0) return;
+
+    const MemoryUsage usage = computeMemoryUsage();
+    const size_t otherSize = (size_t) (usage.getTotal() - usage.templates - usage.ocrTexts);
+    const bool isOverBudget = otherSize >= memoryBudget;
+
+    // The templates detected on the last frame are still kept by the cache, even with an empty budget
+    templateCache.setMemoryBudget(isOverBudget ? 0 : memoryBudget - otherSize);
+    if (isOverBudget) ocrTextCache.clear();
+
+    if (isOverBudget && !isOverMemoryBudget) {
+        LOGW(LOG_TAG, "Memory budget of %1$zu bytes exceeded by the detection, %2$zu bytes used",
+             memoryBudget, otherSize);
+    }
+    isOverMemoryBudget = isOverBudget;
+}
+
+void Detector::updateMemoryPressure() {
+    const int64_t nowNanos = FramePacer::getTimeNanos();
+    const int requested = requestedMemoryPressure.exchange(-1);
+    if (requested >= 0) {
+        memoryPressureNanos = nowNanos;
+        if (requested != memoryPressure) setMemoryPressureLevel(requested);
+    } else if (memoryPressure > MEMORY_PRESSURE_NONE && nowNanos - memoryPressureNanos >= MEMORY_PRESSURE_HOLD_NANOS) {
+        memoryPressureNanos = nowNanos;
+        setMemoryPressureLevel(memoryPressure - 1);
+    }
+
+    // Shed again on each screen image, as its matchings fill the caches back
+    if (memoryPressure >= MEMORY_PRESSURE_OCR_TEXTS) ocrTextCache.clear();
+    if (memoryPressure >= MEMORY_PRESSURE_TEMPLATES) templateCache.setMemoryBudget(0);
+    if (memoryPressure >= MEMORY_PRESSURE_FRAMES) {
+        // The previous front image, not read anymore by this detector. Another one might still read it from the broker
+        screenImagePreparer.cancel();
+        std::shared_ptr<DetectionImage>& backImage = screenImages[(frontScreenImageIndex + 1) % SCREEN_IMAGES_COUNT];
+        auto image = std::make_shared<DetectionImage>();
+        image->copySettings(*backImage);
+        backImage = std::move(image);
+        FrameAllocator::getInstance().trim();
+    }
+}
+
+void Detector::setMemoryPressureLevel(int pressure) {
+    const size_t usedSize = (size_t) computeMemoryUsage().getTotal();
+    if (pressure > memoryPressure) {
+        LOGI(LOG_TAG, "Memory pressure %1$d -> %2$d, shedding caches, %3$zu bytes used",
+             memoryPressure.load(), pressure, usedSize);
+    } else {
+        LOGI(LOG_TAG, "Memory pressure %1$d -> %2$d, regrowing caches, %3$zu bytes used",
+             memoryPressure.load(), pressure, usedSize);
+    }
+
+    // The coarse matchings are skipped from now on, their levels won't be computed again
+    if (pressure >= MEMORY_PRESSURE_PYRAMID && memoryPressure < MEMORY_PRESSURE_PYRAMID) {
+        for (const std::shared_ptr<DetectionImage>& image : screenImages) image->releasePyramidLevels();
+    }
+    // With a budget, the template cache one is computed again by the next enforcement
+    if (pressure < MEMORY_PRESSURE_TEMPLATES && memoryPressure >= MEMORY_PRESSURE_TEMPLATES && memoryBudget == 0) {
+        templateCache.setMemoryBudget(TemplateCache::DEFAULT_MEMORY_BUDGET);
+    }
+
+    memoryPressure = pressure;
+    frameTelemetry.setMemoryPressure(pressure);
+}
+
+void Detector::setCaptureFrameCount(int frameCount) {
+    detectionCapture.setCapacity((size_t) std::max(frameCount, 0));
+    LOGD(LOG_TAG, "Detection capture frame count set to %1$d", std::max(frameCount, 0));
+}
+
+bool Detector::writeCapture(const std::string& path) const {
+    if (!detectionCapture.isEnabled()) return false;
+
+    DetectionCapture::MatchingOptions options;
+    options.isPyramidMatchingEnabled = isPyramidMatchingEnabled;
+    options.isSparseMatchingEnabled = isSparseMatchingEnabled;
+    options.isBinaryMatchingEnabled = isBinaryMatchingEnabled;
+    options.isChamferMatchingEnabled = isChamferMatchingEnabled;
+    options.isMotionCompensationEnabled = isMotionCompensationEnabled;
+    options.isHistogramColorVerificationEnabled = isHistogramColorVerificationEnabled;
+    options.isScaledColorVerificationEnabled = isScaledColorVerificationEnabled;
+    options.isIntegerMatchingEnabled = matchBackends.isCapabilityEnabled(MatchBackend::CAPABILITY_INTEGER);
+    options.isFirstHitMatchingEnabled = isFirstHitMatchingEnabled;
+    options.isLearnedAreaMatchingEnabled = isLearnedAreaMatchingEnabled;
+    options.isIntegerScaleRatioEnabled = isIntegerScaleRatioEnabled;
+    options.templateScales = templateScales;
+
+    return detectionCapture.write(path, options);
+}
+
+double Detector::suggestDetectionQuality(const std::vector<double>& qualities, int positionTolerance) const {
+    const double captureQuality = detectionCapture.getDetectionQuality();
+    if (!detectionCapture.isEnabled() || detectionCapture.getFrames().empty()) return 0;
+
+    std::vector<ConditionResult> baseline;
+    replayCapture(captureQuality, baseline);
+
+    std::vector<double> sortedQualities = qualities;
+    std::sort(sortedQualities.begin(), sortedQualities.end(), std::greater<>());
+
+    double suggestedQuality = captureQuality;
+    std::vector<ConditionResult> results;
+    for (double quality : sortedQualities) {
+        if (quality >= captureQuality) continue;
+
+        replayCapture(quality, results);
+        bool isMatchingBaseline = results.size() == baseline.size();
+        for (size_t i = 0; isMatchingBaseline && i < results.size(); i++) {
+            const ConditionResult& result = results[i];
+            const ConditionResult& expected = baseline[i];
+            isMatchingBaseline = result.isDetected == expected.isDetected && (!expected.isDetected
+                    || (std::abs(result.centerX - expected.centerX) <= positionTolerance
+                        && std::abs(result.centerY - expected.centerY) <= positionTolerance));
+        }
+
+        // A lower quality keeps less details, it won't match again once a detection differs
+        if (!isMatchingBaseline) break;
+        suggestedQuality = quality;
+    }
+
+    LOGD(LOG_TAG, "Detection quality suggested: %1$f, captured at %2$f with %3$zu detections",
+         suggestedQuality, captureQuality, baseline.size());
+    return suggestedQuality;
+}
+
+void Detector::replayCapture(double quality, std::vector<ConditionResult>& results) const {
+    results.clear();
+
+    // A detector of its own, the histories and images of this one must not be changed by the replay
+    Detector replayDetector;
+    replayDetector.setIntegerScaleRatioEnabled(isIntegerScaleRatioEnabled);
+    replayDetector.scaleRatioManager.computeScaleRatio(
+            (u_int32_t) screenSize.width, (u_int32_t) screenSize.height, quality, screenMetricsTag.c_str());
+    replayDetector.screenSize = screenSize;
+    replayDetector.isPyramidMatchingEnabled = isPyramidMatchingEnabled;
+    replayDetector.isSparseMatchingEnabled = isSparseMatchingEnabled;
+    replayDetector.isBinaryMatchingEnabled = isBinaryMatchingEnabled;
+    replayDetector.isChamferMatchingEnabled = isChamferMatchingEnabled;
+    replayDetector.isMotionCompensationEnabled = isMotionCompensationEnabled;
+    replayDetector.isFirstHitMatchingEnabled = isFirstHitMatchingEnabled;
+    replayDetector.isLearnedAreaMatchingEnabled = isLearnedAreaMatchingEnabled;
+    replayDetector.isHistogramColorVerificationEnabled = isHistogramColorVerificationEnabled;
+    replayDetector.isScaledColorVerificationEnabled = isScaledColorVerificationEnabled;
+    replayDetector.setIntegerMatchingEnabled(matchBackends.isCapabilityEnabled(MatchBackend::CAPABILITY_INTEGER));
+    replayDetector.templateScales = templateScales;
+    replayDetector.conditionRotations = conditionRotations;
+    replayDetector.conditionMetrics = conditionMetrics;
+    const double scaleRatio = replayDetector.scaleRatioManager.getScaleRatio();
+
+    std::unordered_map<int64_t, ConditionTemplate> templates;
+    for (const DetectionCapture::Frame* frame : detectionCapture.getFrames()) {
+        // Same processing as setScreenImage
+        DetectionImage& image = replayDetector.getBackScreenImage();
+        image.processPixels(frame->pixels.data, frame->pixels.cols, frame->pixels.rows, frame->pixels.step,
+                            frame->fullSize, scaleRatio);
+        replayDetector.swapScreenImages(image, FramePacer::getTimeNanos());
+
+        for (const DetectionCapture::Detection& detection : frame->detections) {
+            auto conditionTemplate = templates.find(detection.conditionId);
+            if (conditionTemplate == templates.end()) {
+                const cv::Mat* pixels = detectionCapture.getTemplate(detection.conditionId);
+                if (pixels == nullptr) {
+                    results.emplace_back();
+                    continue;
+                }
+
+                conditionTemplate = templates.try_emplace(detection.conditionId).first;
+                conditionTemplate->second.processPixels(pixels->data, pixels->cols, pixels->rows, pixels->step,
+                                                        scaleRatio);
+            }
+
+            replayDetector.mainContext.detectionRoi.setFullSize(detection.roi, scaleRatio);
+            results.push_back(replayDetector.matchTemplate(
+                    conditionTemplate->second, replayDetector.mainContext, detection.threshold, scaleRatio,
+                    replayDetector.getMatchHistory(detection.conditionId), false));
+        }
+    }
+}
+
+void Detector::setOcrConfig(const OcrEnginePool::Config& config) {
+    if (ocrConfig == config) return;
+
+    // Another engine might not recognize the same texts
+    ocrConfig = config;
+    ocrTextCache.clear();
+}
+
+int Detector::prewarm(const std::vector<OcrEnginePool::Config>& ocrConfigs) {
+    // OpenCV allocates its thread pool and dispatch tables on its first calls, not on the first detection frame
+    cv::Mat image(PREWARM_IMAGE_SIZE, PREWARM_IMAGE_SIZE, CV_8UC1, cv::Scalar(0));
+    cv::Mat result;
+    cv::matchTemplate(image, image(cv::Rect(0, 0, PREWARM_IMAGE_SIZE / 2, PREWARM_IMAGE_SIZE / 2)),
+                      result, cv::TM_CCOEFF_NORMED);
+    cv::resize(image, result, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+
+    int readyCount = 0;
+    for (const auto& config : ocrConfigs) {
+        // The lease is given back right away, the engine stays in the pool for the detections
+        if (OcrEnginePool::getInstance().acquire(config)) readyCount++;
+    }
+
+    LOGD(LOG_TAG, "Prewarmed: %1$d/%2$zu OCR engines ready", readyCount, ocrConfigs.size());
+    return readyCount;
+}
+
+bool Detector::openTemplatePack(const std::string& path) {
+    return templateCache.openPack(path);
+}
+
+bool Detector::writeTemplatePack(const std::string& path) const {
+    return templateCache.writePack(path);
+}
+
+std::vector<int64_t> Detector::getPackedConditionIds() const {
+    return templateCache.getPackedConditionIds(scaleRatioManager.getScaleRatio());
+}
+
+bool Detector::isTemplateCached(int64_t conditionId) const {
+    return templateCache.contains(conditionId, scaleRatioManager.getScaleRatio());
+}
+
+bool Detector::isConditionPixelsNeeded(int64_t conditionId) const {
+    return templateCache.isPixelsNeeded(conditionId, scaleRatioManager.getScaleRatio())
+        || detectionCapture.isTemplateNeeded(conditionId);
+}
+
+int Detector::prepareTemplates(const std::vector<int64_t>& conditionIds,
+                               const std::vector<const PixelsBuffer*>& conditionPixels) {
+
+    TRACE_SECTION("prepareTemplates");
+
+    if (detectionCapture.isEnabled()) {
+        for (size_t i = 0; i < conditionIds.size() && i < conditionPixels.size(); i++) {
+            detectionCapture.addTemplate(conditionIds[i], conditionPixels[i]);
+        }
+    }
+
+    const int preparedCount = templateCache.prepare(
+            conditionIds, conditionPixels, scaleRatioManager.getScaleRatio(), threadPool.get());
+    prepareRotationVariants(conditionIds);
+
+    return preparedCount;
+}
+
+int Detector::prepareTemplateFiles(const std::vector<int64_t>& conditionIds,
+                                   const std::vector<std::string>& conditionPaths,
+                                   const std::vector<cv::Size>& conditionSizes) {
+
+    TRACE_SECTION("prepareTemplateFiles");
+
+    // Mapped until the templates are processed, no pixels are read here
+    const size_t count = conditionIds.size();
+    std::vector<ConditionFile> files(count);
+    std::vector<const PixelsBuffer*> pixels(count, nullptr);
+    // The conditions with the same bitmap share its file, it is mapped once
+    std::unordered_map<std::string, size_t> openedPaths;
+    for (size_t i = 0; i < count && i < conditionPaths.size() && i < conditionSizes.size(); i++) {
+        if (conditionPaths[i].empty() || !isConditionPixelsNeeded(conditionIds[i])) continue;
+
+        const cv::Size& size = conditionSizes[i];
+        auto opened = openedPaths.find(conditionPaths[i]);
+        if (opened != openedPaths.end() && conditionSizes[opened->second] == size) {
+            pixels[i] = pixels[opened->second];
+            continue;
+        }
+
+        if (files[i].open(conditionPaths[i], size.width, size.height)) pixels[i] = files[i].getPixels();
+        openedPaths.emplace(conditionPaths[i], i);
+    }
+
+    return prepareTemplates(conditionIds, pixels);
+}
+
+void Detector::setIdleTemplates(const std::vector<int64_t>& conditionIds) {
+    TRACE_SECTION("setIdleTemplates");
+
+    templateCache.setIdleConditions(conditionIds, threadPool.get());
+}
+
+void Detector::setConditionRotations(const std::vector<int64_t>& conditionIds,
+                                     const std::vector<int>& rotationCounts) {
+
+    conditionRotations.clear();
+    for (size_t i = 0; i < conditionIds.size() && i < rotationCounts.size(); i++) {
+        const int rotationCount = std::clamp(rotationCounts[i], 1, CONDITION_MAX_ROTATIONS);
+        if (rotationCount > 1) conditionRotations[conditionIds[i]] = rotationCount;
+    }
+
+    // The previous results were searched at other orientations, they are not reused
+    for (auto& [conditionId, history] : matchHistories) {
+        const auto rotations = conditionRotations.find(conditionId);
+        const int rotationCount = rotations != conditionRotations.end() ? rotations->second : 1;
+        if (history.rotationCount == rotationCount) continue;
+
+        history.rotationCount = rotationCount;
+        history.isValid = false;
+    }
+    prepareRotationVariants(conditionIds);
+
+    LOGD(LOG_TAG, "Condition rotations defined: %1$zu conditions", conditionRotations.size());
+}
+
+void Detector::setConditionMetrics(const std::vector<int64_t>& conditionIds, const std::vector<int>& metrics) {
+    conditionMetrics.clear();
+    for (size_t i = 0; i < conditionIds.size() && i < metrics.size(); i++) {
+        if (metrics[i] <= 0 || metrics[i] >= MATCHING_METRIC_COUNT) continue;
+        conditionMetrics[conditionIds[i]] = (MatchingMetric) metrics[i];
+    }
+
+    // The previous results have other confidences, they are not reused
+    for (auto& [conditionId, history] : matchHistories) {
+        const auto metric = conditionMetrics.find(conditionId);
+        const MatchingMetric conditionMetric =
+                metric != conditionMetrics.end() ? metric->second : MatchingMetric::CCOEFF_NORMED;
+        if (history.metric == conditionMetric) continue;
+
+        history.metric = conditionMetric;
+        history.isValid = false;
+    }
+
+    LOGD(LOG_TAG, "Condition metrics defined: %1$zu conditions", conditionMetrics.size());
+}
+
+void Detector::prepareRotationVariants(const std::vector<int64_t>& conditionIds) {
+    if (conditionRotations.empty()) return;
+    TRACE_SECTION("prepareRotationVariants");
+
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+    for (int64_t conditionId : conditionIds) {
+        const auto rotations = conditionRotations.find(conditionId);
+        if (rotations == conditionRotations.end()) continue;
+
+        // Not cached yet, its variants are created during its first matching
+        const ConditionTemplate* condition = templateCache.find(conditionId, scaleRatio);
+        if (condition == nullptr) continue;
+
+        const int rotationCount = rotations->second;
+        for (int i = 1; i < rotationCount; i++) condition->getRotationVariant(getRotationAngle(i, rotationCount));
+    }
+}
+
+void Detector::removeTemplates(const std::vector<int64_t>& conditionIds) {
+    TRACE_SECTION("removeTemplates");
+
+    templateCache.remove(conditionIds);
+
+    // The matchings learned on the previous bitmap don't apply to the new one, the plan table looks them up again
+    for (int64_t conditionId : conditionIds) {
+        if (matchHistories.erase(conditionId) == 0) continue;
+
+        for (size_t i = 0; i < planConditions.conditionIds.size(); i++) {
+            if (planConditions.conditionIds[i] == conditionId) planConditions.histories[i] = nullptr;
+        }
+    }
+}
+
+std::vector<int64_t> Detector::getConditionCounters() const {
+    std::vector<int64_t> values;
+
+#ifdef SMART_DETECTION_TRACING
+    values.reserve(matchHistories.size() * CONDITION_COUNTERS_STRIDE);
+    for (const auto& history : matchHistories) {
+        const ConditionCounters& counters = history.second.counters;
+        values.insert(values.end(), {
+            history.first,
+            counters.matchingCount,
+            counters.reusedCount,
+            counters.candidateCount,
+            counters.matchingNanos,
+        });
+    }
+#endif
+
+    return values;
+}
+
+std::vector<int64_t> Detector::getOcrEngineStatistics() {
+    const OcrEnginePool::Statistics statistics = OcrEnginePool::getInstance().getStatistics();
+    return {
+        statistics.engineCount,
+        statistics.mappedEngineCount,
+        statistics.totalInitNanos,
+        statistics.maxInitNanos,
+    };
+}
+
+std::vector<int64_t> Detector::getCacheStatistics() const {
+    int64_t pyramidHits = 0;
+    int64_t pyramidMisses = 0;
+    int64_t pyramidEvictions = 0;
+    int64_t pyramidSize = 0;
+    for (const std::shared_ptr<DetectionImage>& image : screenImages) {
+        const CacheStatistics& statistics = image->getPyramidStatistics();
+        pyramidHits += statistics.getHitCount();
+        pyramidMisses += statistics.getMissCount();
+        pyramidEvictions += statistics.getEvictionCount();
+        pyramidSize += (int64_t) image->getPyramidMemorySize();
+    }
+
+    const CacheStatistics& templates = templateCache.getStatistics();
+    const CacheStatistics& ocrTexts = ocrTextCache.getStatistics();
+    const CacheStatistics& memo = matchMemo.getStatistics();
+
+    // In the CacheType order
+    return {
+        templates.getHitCount(), templates.getMissCount(), templates.getEvictionCount(),
+        (int64_t) templateCache.getMemorySize(),
+        ocrTexts.getHitCount(), ocrTexts.getMissCount(), ocrTexts.getEvictionCount(),
+        (int64_t) ocrTextCache.getMemorySize(),
+        memo.getHitCount(), memo.getMissCount(), memo.getEvictionCount(), (int64_t) matchMemo.getMemorySize(),
+        frameDiffStatistics.getHitCount(), frameDiffStatistics.getMissCount(), frameDiffStatistics.getEvictionCount(),
+        (int64_t) (screenSignature.getMemorySize() + planTileIndex.getMemorySize() + globalMotion.getMemorySize()
+                + animatedTilesMask.getMemorySize()),
+        pyramidHits, pyramidMisses, pyramidEvictions, pyramidSize,
+    };
+}
+
+std::vector<int64_t> Detector::getConditionStatistics() const {
+    std::vector<int64_t> values;
+    values.reserve(matchHistories.size() * CONDITION_STATISTICS_STRIDE);
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+
+    for (const auto& history : matchHistories) {
+        const ConditionStatisticsSummary summary = history.second.statistics.getSummary();
+        if (summary.sampleCount == 0) continue;
+
+        // The last match has the size of the condition
+        cv::Rect learnedArea;
+        ScalableRoi learnedRoi;
+        if (getLearnedArea(history.second, history.second.heatmapRoi, history.second.matchRoi.size(), learnedArea)) {
+            learnedRoi.setScaled(learnedArea.x, learnedArea.y, learnedArea.width, learnedArea.height, scaleRatio);
+        }
+
+        values.insert(values.end(), {
+            history.first,
+            summary.matchingCount,
+            summary.sampleCount,
+            summary.medianNanos,
+            summary.p95Nanos,
+            summary.minNanos,
+            summary.maxNanos,
+            summary.candidateCount,
+            summary.ocrNanos,
+            summary.matchBackend,
+            summary.minDetectionQuality,
+            learnedRoi.fullSize.x,
+            learnedRoi.fullSize.y,
+            learnedRoi.fullSize.width,
+            learnedRoi.fullSize.height,
+        });
+    }
+
+    return values;
+}
+
+ConditionResult Detector::detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels, int threshold) {
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    mainContext.detectionRoi.setFullSize(getWholeScreenRoi(), scaleRatioManager.getScaleRatio());
+    return match(conditionId, conditionPixels, threshold, false);
+}
+
+ConditionResult Detector::detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels,
+                                          const cv::Rect& roi, int threshold) {
+
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    mainContext.detectionRoi.setFullSize(roi, scaleRatioManager.getScaleRatio());
+    return match(conditionId, conditionPixels, threshold, false);
+}
+
+ConditionResult Detector::detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels,
+                                          const std::string& identifying) {
+
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    mainContext.detectionRoi.setFullSize(getWholeScreenRoi(), scaleRatioManager.getScaleRatio());
+    return match(conditionId, conditionPixels, identifying, nullptr);
+}
+
+ConditionResult Detector::detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels,
+                                          const cv::Rect& roi, const std::string& identifying) {
+
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    mainContext.detectionRoi.setFullSize(roi, scaleRatioManager.getScaleRatio());
+    return match(conditionId, conditionPixels, identifying, nullptr);
+}
+
+ConditionResult Detector::detectText(int64_t conditionId, const cv::Rect& roi, const std::string& identifying,
+                                    const OcrOptions* ocrOptions) {
+
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    setBatchDetectionRoi(roi, mainContext.detectionRoi);
+    return matchText(mainContext, identifying, ocrOptions, getMatchHistory(conditionId));
+}
+
+int Detector::detectAllOccurrences(int64_t conditionId, const PixelsBuffer* conditionPixels, const cv::Rect& roi,
+                                   int threshold, std::vector<ConditionResult>& occurrences) {
+
+    TRACE_SECTION("detectAllOccurrences");
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    occurrences.clear();
+
+    MatchingContext& context = mainContext;
+    setBatchDetectionRoi(roi, context.detectionRoi);
+    if (detectionCapture.isEnabled()) {
+        detectionCapture.addDetection(conditionId, conditionPixels, context.detectionRoi.fullSize, threshold);
+    }
+
+    const ConditionTemplate* condition = getTemplate(conditionId, conditionPixels);
+    if (condition == nullptr) return 0;
+
+    const ScalableRoi& detectionRoi = context.detectionRoi;
+    if (!screenImage->isFullSizeContains(detectionRoi.fullSize)
+            || !screenImage->isScaledContains(detectionRoi.scaled)) {
+        LOGE_LIMITED(LOG_TAG, "Detection ROI is invalid, skipping condition");
+        return 0;
+    }
+    screenImage->getCropping(detectionRoi, context.croppedScaledGray, context.croppedFullSizeColor);
+    if (!context.isCroppedScaledContains(condition->image.scaledSize)) {
+        LOGE_LIMITED(LOG_TAG, "Condition is bigger than screen image, skipping it");
+        return 0;
+    }
+
+    const int64_t matchingStart = ConditionStatistics::getTimeNanos();
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+    const cv::Mat& scaledCondition = *condition->image.scaledGray;
+    MatchingResults& matchingResults = context.matchingResults;
+    context.scratchArena.reset();
+    context.candidateCount = 0;
+
+    // A single matching of the whole area, all its candidates above the threshold are extracted at once
+    const double minConfidence = getMinConfidence(threshold);
+    const MatchRequest request = { &context.croppedScaledGray, condition, minConfidence };
+    const MatchBackend& backend = matchBackends.select(request, context);
+    cv::Mat* results = matchingResults.initResults(context.croppedScaledGray, scaledCondition, context.scratchArena);
+    MatchBackendType backendType = MatchBackendType::MASKED;
+    if (condition->isMasked()) {
+        context.sparseMatcher.match(context.croppedScaledGray, condition->maskedGray, *results);
+    } else {
+        matchInBands(backend, request, context, *results);
+        backendType = backend.getType();
+    }
+    matchingResults.extractCandidates(minConfidence);
+
+    // The overlapping candidates are suppressed while locating them, the located ones are distinct occurrences
+    while (!isDetectionStopped() && matchingResults.locateNextCandidate(scaledCondition, scaleRatio)) {
+        if (!screenImage->isScaledContains(matchingResults.roi.scaled)) continue;
+        context.candidateCount++;
+
+        if (!isCandidateColorMatching(*condition, context, threshold)) continue;
+        occurrences.push_back({
+                true,
+                detectionRoi.fullSize.x + matchingResults.roi.fullSizeCenterX(),
+                detectionRoi.fullSize.y + matchingResults.roi.fullSizeCenterY(),
+                matchingResults.maxVal,
+        });
+    }
+
+    MatchHistory& history = getMatchHistory(conditionId);
+    const int64_t matchingNanos = ConditionStatistics::getTimeNanos() - matchingStart;
+    history.statistics.addMatching(
+            matchingNanos, context.candidateCount, 0, backendType, screenDetectionQuality);
+    frameTelemetry.onMatchComputed(backendType, matchingNanos);
+    TRACE_COUNTERS(
+            history.counters.matchingCount++;
+            history.counters.candidateCount += context.candidateCount;
+            history.counters.matchingNanos += matchingNanos);
+
+    return (int) occurrences.size();
+}
+
+ConditionResult Detector::detectConditionConcurrently(int64_t conditionId, const cv::Rect& roi, int threshold) const {
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+
+    const ConditionTemplate* condition = templateCache.find(conditionId, scaleRatio);
+    if (condition == nullptr) {
+        LOGE_LIMITED(LOG_TAG, "Condition %1$lld is not cached, it can't be detected concurrently",
+                     (long long) conditionId);
+        return {};
+    }
+
+    // Owned by this call, the shared state is only read. The history is empty, this matching is not reused.
+    MatchingContext context;
+    MatchHistory history;
+    setBatchDetectionRoi(roi, context.detectionRoi);
+    return matchTemplate(*condition, context, threshold, scaleRatio, history, false);
+}
+
+int Detector::detectBatch(const std::vector<DetectionRequest>& requests, int conditionOperator,
+                          std::vector<ConditionResult>& results, int64_t deadlineNanos) {
+
+    TRACE_SECTION("detectBatch");
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+
+    results.resize(requests.size());
+    if (threadPool != nullptr && requests.size() > 1) {
+        return detectBatchParallel(requests, conditionOperator, results, deadlineNanos);
+    }
+    return detectBatchSerial(requests, conditionOperator, results, deadlineNanos);
+}
+
+int Detector::detectScenario(const ScenarioPlan& plan, std::vector<ConditionResult>& results,
+                             std::vector<int>& processedCounts) {
+
+    TRACE_SECTION("detectScenario");
+    updatePlanConditions(plan);
+
+    // The templates of the skipped events are not used, they can be evicted
+    const size_t conditionCount = planConditions.conditionIds.size();
+    for (size_t i = 0; i < conditionCount; i++) {
+        if (planConditions.isScheduled[i] && !(planConditions.flags[i] & PLAN_CONDITION_TEXT_IN_AREA)
+                && isConditionPixelsNeeded(planConditions.conditionIds[i])) return SCENARIO_PIXELS_NEEDED;
+    }
+
+    results.resize(plan.conditions.size());
+    processedCounts.assign(plan.events.size(), 0);
+
+    markUnchangedConditions(plan);
+    prefilterPlanConditions(plan);
+    const std::vector<DetectionRequest>& conditions = resolveAnchors(plan);
+    if (isDetectionStopped(plan.deadlineNanos)) return SCENARIO_FRAME_EXPIRED;
+
+    int evaluatedCount = getSpeculativeEventCount(plan);
+    if (evaluatedCount > 0) {
+        const int stoppingEvent = detectEventsSpeculative(plan, conditions, evaluatedCount, results, processedCounts);
+        if (isDetectionStopped(plan.deadlineNanos)) return SCENARIO_FRAME_EXPIRED;
+        if (stoppingEvent >= 0) return stoppingEvent + 1;
+    }
+
+    for (auto event = plan.events.begin() + evaluatedCount; event != plan.events.end(); event++) {
+        evaluatedCount++;
+        if (event->isSkipped || event->conditionCount <= 0) continue;
+
+        const auto firstRequest = conditions.begin() + event->firstCondition;
+        eventRequests.assign(firstRequest, firstRequest + event->conditionCount);
+        const int processedCount = detectBatch(eventRequests, event->conditionOperator, eventResults,
+                                               plan.deadlineNanos);
+        // Even if the event is fulfilled, its actions would be executed for a screen that might no longer exist
+        if (isDetectionStopped(plan.deadlineNanos)) return SCENARIO_FRAME_EXPIRED;
+
+        std::copy_n(eventResults.begin(), processedCount, results.begin() + event->firstCondition);
+        processedCounts[evaluatedCount - 1] = processedCount;
+
+        if (!event->keepDetecting && isBatchFulfilled(
+                eventRequests.data(), event->conditionOperator, eventResults.data(), processedCount)) break;
+    }
+
+    return evaluatedCount;
+}
+
+void Detector::updatePlanConditions(const ScenarioPlan& plan) {
+    PlanConditionTable& table = planConditions;
+    const size_t conditionCount = plan.conditions.size();
+    if (plan.revision == 0 || table.revision != plan.revision || table.conditionIds.size() != conditionCount) {
+        table.revision = plan.revision;
+        table.conditionIds.resize(conditionCount);
+        table.thresholds.resize(conditionCount);
+        table.flags.resize(conditionCount);
+        for (size_t i = 0; i < conditionCount; i++) {
+            const DetectionRequest& request = plan.conditions[i];
+            table.conditionIds[i] = request.conditionId;
+            table.thresholds[i] = request.threshold;
+            table.flags[i] = (request.identifying != nullptr ? PLAN_CONDITION_TEXT : 0)
+                    | (request.isTextInArea ? PLAN_CONDITION_TEXT_IN_AREA : 0)
+                    | (request.isFeatureMatching ? PLAN_CONDITION_FEATURES : 0)
+                    | (request.anchorIndex >= 0 ? PLAN_CONDITION_ANCHORED : 0);
+        }
+        table.histories.assign(conditionCount, nullptr);
+    }
+
+    // The histories are never moved by the map, only the ones created since the previous screen image are looked up
+    for (size_t i = 0; i < conditionCount; i++) {
+        if (table.histories[i] != nullptr) continue;
+
+        auto history = matchHistories.find(table.conditionIds[i]);
+        if (history != matchHistories.end()) table.histories[i] = &history->second;
+    }
+
+    table.isScheduled.resize(conditionCount);
+    for (const PlannedEvent& event : plan.events) {
+        std::fill_n(table.isScheduled.begin() + event.firstCondition, event.conditionCount, !event.isSkipped);
+    }
+}
+
+void Detector::clearMatchHistories() {
+    matchHistories.clear();
+    std::fill(planConditions.histories.begin(), planConditions.histories.end(), nullptr);
+}
+
+Detector::MatchHistory& Detector::getMatchHistory(int64_t conditionId) {
+    auto [history, isCreated] = matchHistories.try_emplace(conditionId);
+    if (isCreated) {
+        const auto rotations = conditionRotations.find(conditionId);
+        if (rotations != conditionRotations.end()) history->second.rotationCount = rotations->second;
+        const auto metric = conditionMetrics.find(conditionId);
+        if (metric != conditionMetrics.end()) history->second.metric = metric->second;
+    }
+
+    return history->second;
+}
+
+const std::vector<DetectionRequest>& Detector::resolveAnchors(const ScenarioPlan& plan) {
+    if (!plan.hasAnchoredConditions) return plan.conditions;
+
+    TRACE_SECTION("resolveAnchors");
+    anchoredRequests.assign(plan.conditions.begin(), plan.conditions.end());
+    anchorResults.resize(plan.conditions.size());
+    isAnchorDetected.assign(plan.conditions.size(), false);
+
+    for (const PlannedEvent& event : plan.events) {
+        if (event.isSkipped) continue;
+
+        for (int i = event.firstCondition; i < event.firstCondition + event.conditionCount; i++) {
+            DetectionRequest& request = anchoredRequests[i];
+            if (request.anchorIndex < 0) continue;
+
+            // Shared by all the dependent conditions, and reused from its history when its own event is evaluated
+            if (!isAnchorDetected[request.anchorIndex]) {
+                anchorResults[request.anchorIndex] = detectRequest(plan.conditions[request.anchorIndex]);
+                isAnchorDetected[request.anchorIndex] = true;
+            }
+
+            const ConditionResult& anchor = anchorResults[request.anchorIndex];
+            request.roi = (request.anchorArea + cv::Point(anchor.centerX, anchor.centerY)) & screenImage->fullSizeRoi;
+            // An empty area is the whole screen for the batches, the dependent condition can't be searched there
+            request.isAnchorMissing = !anchor.isDetected || request.roi.empty();
+        }
+    }
+
+    return anchoredRequests;
+}
+
+void Detector::markUnchangedConditions(const ScenarioPlan& plan) {
+    if (plan.revision == 0 || !screenSignature.hasPrevious()) return;
+
+    const cv::Size& imageSize = screenSignature.getImageSize();
+    if (!planTileIndex.isBuilt(plan.revision, imageSize)) {
+        TRACE_SECTION("buildPlanTileIndex");
+        const double scaleRatio = scaleRatioManager.getScaleRatio();
+        planTileAreas.resize(plan.conditions.size());
+
+        for (size_t i = 0; i < plan.conditions.size(); i++) {
+            const DetectionRequest& request = plan.conditions[i];
+            // The area of an anchored condition follows its anchor, it changes with each screen image
+            if (request.anchorIndex >= 0) {
+                planTileAreas[i] = cv::Rect();
+                continue;
+            }
+
+            // Expanded by the template size, it covers the exact areas jitter and the positions on the area borders
+            ScalableRoi roi;
+            setBatchDetectionRoi(request.roi, roi);
+            const ConditionTemplate* condition = request.isTextInArea
+                    ? nullptr
+                    : templateCache.get(request.conditionId, nullptr, scaleRatio);
+            const cv::Size margin = condition == nullptr
+                    ? cv::Size(EXACT_MATCHING_MAX_JITTER, EXACT_MATCHING_MAX_JITTER)
+                    : cv::Size(std::max(condition->image.scaledSize.width, EXACT_MATCHING_MAX_JITTER),
+                               std::max(condition->image.scaledSize.height, EXACT_MATCHING_MAX_JITTER));
+            planTileAreas[i] = cv::Rect(
+                    roi.scaled.x - margin.width,
+                    roi.scaled.y - margin.height,
+                    roi.scaled.width + margin.width * 2,
+                    roi.scaled.height + margin.height * 2);
+        }
+        planTileIndex.build(plan.revision, imageSize, planTileAreas);
+    }
+
+    if (!planTileIndex.computeDirtyConditions(screenSignature)) return;
+    const uint64_t frameIndex = screenSignature.getFrameIndex();
+    for (size_t i = 0; i < planConditions.histories.size(); i++) {
+        // Never matched conditions have nothing to reuse
+        MatchHistory* history = planConditions.histories[i];
+        if (history != nullptr && !planTileIndex.isDirty((int) i)) history->unchangedFrameIndex = frameIndex;
+    }
+}
+
+void Detector::prefilterPlanConditions(const ScenarioPlan& plan) {
+    if (!isConditionPrefilterEnabled || plan.revision == 0 || !templateScales.empty()) return;
+
+    const cv::Size imageSize = screenImage->scaledRoi.size();
+    if (!planPrefilterIndex.isBuilt(plan.revision, imageSize)) {
+        TRACE_SECTION("buildPlanPrefilterIndex");
+        const double scaleRatio = scaleRatioManager.getScaleRatio();
+        planPrefilterAreas.assign(plan.conditions.size(), cv::Rect());
+        bool isComplete = true;
+
+        for (size_t i = 0; i < plan.conditions.size(); i++) {
+            const DetectionRequest& request = plan.conditions[i];
+            // Only the template matched conditions with an area known before the detection. The text of a text
+            // condition is searched in its best candidates whatever their confidence, the proof can't apply to it:
+            // its candidates are ranked by matchText instead.
+            if (request.anchorIndex >= 0 || request.isTextInArea || request.identifying != nullptr
+                    || request.isFeatureMatching || conditionRotations.count(request.conditionId) != 0) continue;
+
+            // Not loaded yet, the index is built again with it on the next screen image
+            const ConditionTemplate* condition = templateCache.get(request.conditionId, nullptr, scaleRatio);
+            if (condition == nullptr) {
+                isComplete = false;
+                continue;
+            }
+            // Its statistics include the transparent pixels, they can't prove its absence
+            if (condition->isMasked()) continue;
+
+            // The area searched by matchTemplate, the proof must be for the same one
+            ScalableRoi roi;
+            setBatchDetectionRoi(request.roi, roi);
+            if (exactMatchingJitter > 0) addExactAreaJitter(*condition, roi, scaleRatio);
+            planPrefilterAreas[i] = roi.scaled;
+
+            const double maxMeanDiff = request.threshold * 255.0 * 3 / 100 + PREFILTER_MEAN_MARGIN;
+            planPrefilterIndex.add((int) i, roi.scaled, condition->image.scaledGray->size(),
+                                   condition->grayStatistics, maxMeanDiff);
+        }
+        planPrefilterIndex.build(plan.revision, imageSize, isComplete);
+    }
+    if (planPrefilterIndex.isEmpty()) return;
+
+    // The conditions of the skipped events and the unchanged ones are not matched on this screen image
+    const uint64_t frameIndex = screenSignature.getFrameIndex();
+    const size_t conditionCount = planConditions.histories.size();
+    isPlanConditionNeeded.resize(conditionCount);
+    for (size_t i = 0; i < conditionCount; i++) {
+        const MatchHistory* history = planConditions.histories[i];
+        isPlanConditionNeeded[i] = planConditions.isScheduled[i]
+                && (history == nullptr || history->unchangedFrameIndex != frameIndex);
+    }
+
+    cv::Mat sums, squaredSums;
+    screenImage->getScaledGrayIntegrals(sums, squaredSums);
+    planPrefilterIndex.findAbsentConditions(sums, squaredSums, isPlanConditionNeeded, planAbsentConditions);
+
+    for (int i : planAbsentConditions) {
+        // Created for the conditions never matched yet, they are matched right after with their proof
+        MatchHistory*& history = planConditions.histories[i];
+        if (history == nullptr) history = &getMatchHistory(planConditions.conditionIds[i]);
+        history->absentFrameIndex = frameIndex;
+        history->absentRoi = planPrefilterAreas[i];
+        history->absentThreshold = planConditions.thresholds[i];
+    }
+}
+
+int Detector::getSpeculativeEventCount(const ScenarioPlan& plan) const {
+    if (threadPool == nullptr) return 0;
+
+    const int maxCount = std::min({ plan.speculativeEventCount, (int) plan.events.size(),
+                                    SCENARIO_MAX_SPECULATIVE_EVENTS });
+    int eventCount = 0;
+    int conditionCount = 0;
+    for (; eventCount < maxCount; eventCount++) conditionCount += plan.events[eventCount].conditionCount;
+
+    // A single condition can't be matched concurrently
+    return conditionCount > 1 ? eventCount : 0;
+}
+
+int Detector::detectEventsSpeculative(const ScenarioPlan& plan, const std::vector<DetectionRequest>& conditions,
+                                      int eventCount, std::vector<ConditionResult>& results,
+                                      std::vector<int>& processedCounts) {
+
+    TRACE_SECTION("detectEventsSpeculative");
+    const ScopedThreadPolicy callerPolicy(threadPolicy);
+
+    // The conditions of the first events are the first ones of the plan, matched as a single batch
+    const PlannedEvent& lastEvent = plan.events[eventCount - 1];
+    const int conditionCount = lastEvent.firstCondition + lastEvent.conditionCount;
+    prepareBatchConditions(conditions.data(), conditionCount);
+    prepareWorkerContexts();
+
+    std::array<SpeculativeEvent, SCENARIO_MAX_SPECULATIVE_EVENTS> speculativeEvents;
+    speculativeEventIndexes.resize(conditionCount);
+    for (int i = 0; i < eventCount; i++) {
+        const PlannedEvent& event = plan.events[i];
+        // Without any condition to match, a skipped event is never fulfilled
+        const int decidingIndex = event.isSkipped ? -1 : event.conditionCount;
+        speculativeEvents[i].decidingIndex.store(decidingIndex, std::memory_order_relaxed);
+        std::fill_n(speculativeEventIndexes.begin() + event.firstCondition, event.conditionCount, i);
+    }
+
+    // Lowest index of a fulfilled event stopping the evaluation. Events after it are not needed anymore.
+    std::atomic<int> stoppingIndex(eventCount);
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+
+    threadPool->parallelFor(conditionCount, [&](int taskIndex, int workerIndex) {
+        const int eventIndex = speculativeEventIndexes[taskIndex];
+        if (eventIndex > stoppingIndex.load(std::memory_order_relaxed)) return;
+        // The results are dropped by the caller once the deadline is passed
+        if (isDetectionStopped(plan.deadlineNanos)) return;
+
+        const PlannedEvent& event = plan.events[eventIndex];
+        SpeculativeEvent& speculativeEvent = speculativeEvents[eventIndex];
+        const int conditionIndex = taskIndex - event.firstCondition;
+        if (conditionIndex > speculativeEvent.decidingIndex.load(std::memory_order_relaxed)) return;
+
+        const BatchCondition& condition = batchConditions[taskIndex];
+        ConditionResult& result = results[taskIndex];
+        const int64_t detectionStart = ConditionStatistics::getTimeNanos();
+        result = detectBatchCondition(condition, workerContexts[workerIndex], scaleRatio);
+        result.detectionNanos = ConditionStatistics::getTimeNanos() - detectionStart;
+
+        bool isEventFulfilled = false;
+        if (isBatchOperatorDecided(result, condition.shouldBeDetected, event.conditionOperator)) {
+            int currentIndex = speculativeEvent.decidingIndex.load();
+            while (conditionIndex < currentIndex
+                    && !speculativeEvent.decidingIndex.compare_exchange_weak(currentIndex, conditionIndex));
+            isEventFulfilled = event.conditionOperator == BATCH_OPERATOR_OR;
+        } else if (event.conditionOperator == BATCH_OPERATOR_AND) {
+            isEventFulfilled = speculativeEvent.fulfilledCount.fetch_add(1) + 1 == event.conditionCount;
+        }
+
+        if (isEventFulfilled && !event.keepDetecting) {
+            int currentIndex = stoppingIndex.load();
+            while (eventIndex < currentIndex && !stoppingIndex.compare_exchange_weak(currentIndex, eventIndex));
+        }
+    });
+
+    // All events up to the stopping one have been evaluated, as the stopping index only decreases
+    for (int i = 0; i < eventCount; i++) {
+        const PlannedEvent& event = plan.events[i];
+        const int processedCount = std::min(speculativeEvents[i].decidingIndex.load() + 1, event.conditionCount);
+        processedCounts[i] = processedCount;
+
+        if (!event.keepDetecting && isBatchFulfilled(conditions.data() + event.firstCondition,
+                event.conditionOperator, results.data() + event.firstCondition, processedCount)) return i;
+    }
+
+    return -1;
+}
+
+int Detector::detectBatchSerial(const std::vector<DetectionRequest>& requests, int conditionOperator,
+                                std::vector<ConditionResult>& results, int64_t deadlineNanos) {
+
+    int processedCount = 0;
+    for (size_t i = 0; i < requests.size(); i++) {
+        if (i > 0 && isDetectionStopped(deadlineNanos)) break;
+        const DetectionRequest& request = requests[i];
+        ConditionResult& result = results[i];
+        const int64_t detectionStart = ConditionStatistics::getTimeNanos();
+        result = detectRequest(request);
+        result.detectionNanos = ConditionStatistics::getTimeNanos() - detectionStart;
+        processedCount++;
+
+        if (isBatchOperatorDecided(result, request.shouldBeDetected, conditionOperator)) break;
+    }
+
+    return processedCount;
+}
+
+int Detector::detectBatchParallel(const std::vector<DetectionRequest>& requests, int conditionOperator,
+                                  std::vector<ConditionResult>& results, int64_t deadlineNanos) {
+
+    const int count = (int) requests.size();
+    prepareBatchConditions(requests.data(), count);
+    prepareWorkerContexts();
+
+    // Lowest index of a condition deciding the operator result. Conditions after it are not needed anymore.
+    std::atomic<int> decidingIndex(count);
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+
+    threadPool->parallelFor(count, [&](int taskIndex, int workerIndex) {
+        if (taskIndex > decidingIndex.load(std::memory_order_relaxed)) return;
+        // The results are dropped by the caller once the deadline is passed
+        if (isDetectionStopped(deadlineNanos)) return;
+
+        const BatchCondition& condition = batchConditions[taskIndex];
+        ConditionResult& result = results[taskIndex];
+        const int64_t detectionStart = ConditionStatistics::getTimeNanos();
+        result = detectBatchCondition(condition, workerContexts[workerIndex], scaleRatio);
+        result.detectionNanos = ConditionStatistics::getTimeNanos() - detectionStart;
+
+        if (isBatchOperatorDecided(result, condition.shouldBeDetected, conditionOperator)) {
+            int currentIndex = decidingIndex.load();
+            while (taskIndex < currentIndex && !decidingIndex.compare_exchange_weak(currentIndex, taskIndex));
+        }
+    });
+
+    // All conditions up to the deciding one have been matched, as the deciding index only decreases
+    return std::min(decidingIndex.load() + 1, count);
+}
+
+ConditionResult Detector::detectRequest(const DetectionRequest& request) {
+    if (request.isAnchorMissing || isDetectionStopped()) return {};
+    setBatchDetectionRoi(request.roi, mainContext.detectionRoi);
+
+    if (request.identifying != nullptr && request.isTextInArea) {
+        return matchText(mainContext, *request.identifying, request.ocrOptions, getMatchHistory(request.conditionId));
+    }
+    if (request.identifying != nullptr) {
+        return match(request.conditionId, request.conditionPixels, *request.identifying, request.ocrOptions);
+    }
+    return match(request.conditionId, request.conditionPixels, request.threshold, request.isFeatureMatching,
+                 !request.shouldBeDetected);
+}
+
+ConditionResult Detector::detectBatchCondition(const BatchCondition& condition, MatchingContext& context,
+                                               double scaleRatio) {
+
+    if (condition.isAnchorMissing) return {};
+    context.detectionRoi = condition.detectionRoi;
+
+    // Each worker recognizes the text candidates of its conditions serially, with an engine leased from the pool
+    if (condition.isTextInArea) {
+        return matchText(context, *condition.identifying, condition.ocrOptions, *condition.history);
+    }
+    if (condition.conditionTemplate == nullptr) return {};
+    if (condition.identifying != nullptr) {
+        return matchText(*condition.conditionTemplate, context, *condition.identifying, condition.ocrOptions,
+                         *condition.history);
+    }
+
+    context.backendTemplate = condition.backendResults.empty() ? nullptr : condition.conditionTemplate;
+    context.backendResults = condition.backendResults;
+    context.sharedAreaImage = condition.isAreaShared ? screenImage : nullptr;
+    ConditionResult result = matchTemplate(*condition.conditionTemplate, context, condition.threshold, scaleRatio,
+                                           *condition.history, condition.isFeatureMatching,
+                                           !condition.shouldBeDetected);
+    context.backendTemplate = nullptr;
+    context.sharedAreaImage = nullptr;
+    return result;
+}
+
+void Detector::prepareBatchConditions(const DetectionRequest* requests, int count) {
+    batchConditions.resize(count);
+    for (int i = 0; i < count; i++) {
+        const DetectionRequest& request = requests[i];
+        BatchCondition& condition = batchConditions[i];
+
+        setBatchDetectionRoi(request.roi, condition.detectionRoi);
+        condition.threshold = request.threshold;
+
+        if (detectionCapture.isEnabled()) {
+            detectionCapture.addDetection(
+                    request.conditionId, request.conditionPixels, condition.detectionRoi.fullSize, condition.threshold);
+        }
+        condition.isTextInArea = request.isTextInArea && request.identifying != nullptr;
+        condition.isAnchorMissing = request.isAnchorMissing;
+        condition.conditionTemplate = request.isAnchorMissing || condition.isTextInArea
+                ? nullptr
+                : getTemplate(request.conditionId, request.conditionPixels);
+        condition.history = &getMatchHistory(request.conditionId);
+
+        condition.shouldBeDetected = request.shouldBeDetected;
+        condition.isFeatureMatching = request.isFeatureMatching;
+        condition.identifying = request.identifying;
+        condition.ocrOptions = request.ocrOptions;
+        condition.isAreaShared = false;
+    }
+
+    // The conditions searched in the same area share its preprocessing, computed by the first one matched. The text
+    // conditions don't use it.
+    for (int i = 0; i < count; i++) {
+        BatchCondition& condition = batchConditions[i];
+        if (condition.conditionTemplate == nullptr || condition.isFeatureMatching
+                || condition.identifying != nullptr) continue;
+
+        for (int j = i + 1; j < count && !condition.isAreaShared; j++) {
+            BatchCondition& other = batchConditions[j];
+            if (other.conditionTemplate == nullptr || other.isFeatureMatching || other.identifying != nullptr) {
+                continue;
+            }
+            if (other.detectionRoi.scaled != condition.detectionRoi.scaled) continue;
+
+            condition.isAreaShared = true;
+            other.isAreaShared = true;
+        }
+    }
+
+    // All conditions of the batch at once, before the workers matching them. The feature and text matching don't use
+    // them.
+    if (MatchBackend* batchBackend = matchBackends.getBatchBackend()) {
+        backendJobs.clear();
+        for (int i = 0; i < count; i++) {
+            BatchCondition& condition = batchConditions[i];
+            const bool isCorrelated = !condition.isFeatureMatching && condition.identifying == nullptr
+                    && condition.history->metric == MatchingMetric::CCOEFF_NORMED;
+            addBackendJob(*batchBackend, isCorrelated ? condition.conditionTemplate : nullptr,
+                          condition.detectionRoi, condition.backendResults);
+        }
+        runBackendJobs(*batchBackend);
+    }
+}
+
+void Detector::prepareWorkerContexts() const {
+    auto workerCount = (size_t) threadPool->getWorkerCount();
+    if (workerContexts.size() != workerCount) {
+        workerContexts.resize(workerCount);
+        for (MatchingContext& context : workerContexts) context.scratchArena.reserve(scratchArenaSize);
+    }
+}
+
+void Detector::setBatchDetectionRoi(const cv::Rect& conditionRoi, ScalableRoi& roi) const {
+    if (conditionRoi.width <= 0 || conditionRoi.height <= 0) {
+        roi.setFullSize(getWholeScreenRoi(), scaleRatioManager.getScaleRatio());
+    } else {
+        roi.setFullSize(conditionRoi, scaleRatioManager.getScaleRatio());
+    }
+}
+
+cv::Rect Detector::getWholeScreenRoi() const {
+    const cv::Rect& screenRoi = screenImage->fullSizeRoi;
+    const cv::Rect contentArea = cv::Rect(
+            screenRoi.x + screenInsets.left,
+            screenRoi.y + screenInsets.top,
+            screenRoi.width - screenInsets.left - screenInsets.right,
+            screenRoi.height - screenInsets.top - screenInsets.bottom) & screenRoi;
+
+    return contentArea.empty() ? screenRoi : contentArea;
+}
+
+bool Detector::isBatchFulfilled(const DetectionRequest* requests, int conditionOperator,
+                                const ConditionResult* results, int processedCount) {
+
+    if (processedCount <= 0) return false;
+
+    // Without a deciding condition, all of them have been processed with the same fulfilled state
+    const int last = processedCount - 1;
+    const bool isLastDeciding =
+            isBatchOperatorDecided(results[last], requests[last].shouldBeDetected, conditionOperator);
+    return isLastDeciding == (conditionOperator == BATCH_OPERATOR_OR);
+}
+
+bool Detector::isBatchOperatorDecided(const ConditionResult& result, bool shouldBeDetected, int conditionOperator) {
+    bool isFulfilled = result.isDetected == shouldBeDetected;
+    return (conditionOperator == BATCH_OPERATOR_OR && isFulfilled)
+        || (conditionOperator == BATCH_OPERATOR_AND && !isFulfilled);
+}
+
+ConditionResult Detector::match(int64_t conditionId, const PixelsBuffer* conditionPixels, int threshold,
+                                bool isFeatureMatching, bool isAbsenceExpected) {
+
+    if (detectionCapture.isEnabled()) {
+        detectionCapture.addDetection(conditionId, conditionPixels, mainContext.detectionRoi.fullSize, threshold);
+    }
+
+    const ConditionTemplate* condition = getTemplate(conditionId, conditionPixels);
+    if (condition == nullptr) return {};
+
+    MatchHistory& history = getMatchHistory(conditionId);
+    MatchBackend* batchBackend = matchBackends.getBatchBackend();
+    if (batchBackend != nullptr && !isFeatureMatching && history.metric == MatchingMetric::CCOEFF_NORMED) {
+        backendJobs.clear();
+        addBackendJob(*batchBackend, condition, mainContext.detectionRoi, mainContext.backendResults);
+        runBackendJobs(*batchBackend);
+        mainContext.backendTemplate = mainContext.backendResults.empty() ? nullptr : condition;
+    }
+
+    const ConditionResult result = matchTemplate(*condition, mainContext, threshold, scaleRatioManager.getScaleRatio(),
+                                                 history, isFeatureMatching, isAbsenceExpected);
+    mainContext.backendTemplate = nullptr;
+    return result;
+}
+
+void Detector::addBackendJob(const MatchBackend& batchBackend, const ConditionTemplate* conditionTemplate,
+                             const ScalableRoi& detectionRoi, cv::Mat& results) {
+
+    const cv::Rect area = detectionRoi.scaled & screenImage->scaledRoi;
+    if (conditionTemplate == nullptr || conditionTemplate->isMasked()
+            || !batchBackend.isBatchSupported(area.size(), conditionTemplate->image.scaledGray->size())) {
+        results.release();
+        return;
+    }
+
+    backendJobs.push_back({ conditionTemplate, area, &results });
+}
+
+void Detector::runBackendJobs(MatchBackend& batchBackend) {
+    if (backendJobs.empty() || batchBackend.matchBatch(*screenImage, backendJobs)) return;
+
+    LOGW_LIMITED(LOG_TAG, "Match backend %1$s failed, matching on the CPU", batchBackend.getName());
+    for (MatchBackend::Job& job : backendJobs) job.results->release();
+}
+
+const ConditionTemplate* Detector::getTemplate(int64_t conditionId, const PixelsBuffer* conditionPixels) {
+    // The pixels are only processed if the template is not in the cache yet
+    const ConditionTemplate* condition = templateCache.get(
+            conditionId, conditionPixels, scaleRatioManager.getScaleRatio());
+
+    if (condition == nullptr) LOGE_LIMITED(LOG_TAG, "Condition pixels can't be processed, skipping it");
+    return condition;
+}
+
+ConditionResult Detector::matchTemplate(const ConditionTemplate& condition, MatchingContext& context,
+                                        int threshold, double scaleRatio, MatchHistory& history,
+                                        bool isFeatureMatching, bool isAbsenceExpected) const {
+
+    // An area of the condition size only allows its exact position, give it some room for the slightly moving UIs
+    if (exactMatchingJitter > 0) addExactAreaJitter(condition, context.detectionRoi, scaleRatio);
+
+    const ScalableRoi& detectionRoi = context.detectionRoi;
+    MatchingResults& matchingResults = context.matchingResults;
+
+    // Check of dimensions are valid
+    if (!screenImage->isFullSizeContains(detectionRoi.fullSize)
+            || !screenImage->isScaledContains(detectionRoi.scaled)) {
+        LOGE_LIMITED(LOG_TAG, "Detection ROI is invalid, skipping condition");
+        return {};
+    }
+
+    // Crop the scaled gray current image to only get the detection area and verify it is equals or bigger than the condition
+    screenImage->getCropping(detectionRoi, context.croppedScaledGray, context.croppedFullSizeColor);
+    if (!context.isCroppedScaledContains(condition.image.scaledSize)) {
+        LOGE_LIMITED(LOG_TAG, "Condition is bigger than screen image, skipping it");
+        return {};
+    }
+
+    const uint64_t frameIndex = screenSignature.getFrameIndex();
+    const bool isSameSearch = history.isValid && history.threshold == threshold
+            && history.detectionRoi == detectionRoi.scaled;
+    const bool isFromPreviousFrame = isSameSearch && history.frameIndex + 1 == frameIndex;
+
+    // Already matched on this screen image, or nothing changed in the detection area since the previous one
+    if (isSameSearch && history.frameIndex == frameIndex) {
+        TRACE_COUNTERS(history.counters.reusedCount++);
+        frameTelemetry.onMatchReused();
+        frameDiffStatistics.onHit();
+        return history.result;
+    }
+    // A degraded result is matched again, the complete matching might fit in the budget on this screen image
+    if (isFromPreviousFrame && !history.result.isDegraded
+            && (history.unchangedFrameIndex == frameIndex || !screenSignature.isDirty(detectionRoi.scaled))) {
+        TRACE_COUNTERS(history.counters.reusedCount++);
+        frameTelemetry.onMatchReused();
+        frameDiffStatistics.onHit();
+        history.frameIndex = frameIndex;
+        return history.result;
+    }
+    frameDiffStatistics.onMiss();
+
+    // Another condition with the same bitmap might have already been searched in this area on this screen image.
+    // The feature matching, the searches at several orientations and the other metrics give other results, they have
+    // their own entries.
+    uint64_t memoHash = isFeatureMatching ? ~condition.contentHash : condition.contentHash;
+    if (history.rotationCount > 1) memoHash ^= (uint64_t) history.rotationCount * 0x9E3779B97F4A7C15ULL;
+    if (history.metric != MatchingMetric::CCOEFF_NORMED) memoHash ^= (uint64_t) history.metric * 0xC2B2AE3D27D4EB4FULL;
+    MatchMemo::Entry memoEntry;
+    if (matchMemo.find(frameIndex, memoHash, detectionRoi.scaled, threshold, memoEntry)) {
+        TRACE_COUNTERS(history.counters.reusedCount++);
+        frameTelemetry.onMatchReused();
+        setHistory(history, frameIndex, detectionRoi.scaled, threshold, memoEntry);
+        return history.result;
+    }
+
+    TRACE_SECTION("matchCondition");
+    const int64_t matchingStart = ConditionStatistics::getTimeNanos();
+    context.candidateCount = 0;
+    context.matchBackendType = MatchBackendType::NONE;
+    context.budgetDeadlineNanos = conditionTimeBudgetNanos > 0 ? matchingStart + conditionTimeBudgetNanos : 0;
+    context.isDegraded = false;
+
+    // The scratch matrices of the previous condition matched with this context are not needed anymore
+    context.scratchArena.reset();
+
+    // The previous match might have been at another scale or orientation, its variant is cached with the condition
+    const ConditionTemplate* historyCondition = history.result.angle != 0
+            ? condition.getRotationVariant(history.result.angle)
+            : condition.getScaleVariant(history.templateScale);
+    // The neighbourhood matching correlates the transparent corners of the rotated variants too
+    if (historyCondition != nullptr && historyCondition->isMasked()) historyCondition = nullptr;
+
+    bool isFound;
+    double matchedScale = 1.0;
+    int matchedAngle = 0;
+    if (isFeatureMatching) {
+        isFound = matchFeatures(condition, context, threshold, scaleRatio, frameIndex);
+        context.matchBackendType = MatchBackendType::FEATURES;
+    } else if (condition.isMasked()) {
+        // The other matchings correlate the transparent pixels too
+        isFound = matchMasked(condition, context, threshold, scaleRatio);
+        context.matchBackendType = MatchBackendType::MASKED;
+    } else if (history.metric != MatchingMetric::CCOEFF_NORMED) {
+        // The other matchings, and the proofs and reuses bounded by the correlation, are for the correlation only
+        isFound = matchDifference(condition, context, threshold, scaleRatio, history.metric);
+        context.matchBackendType = MatchBackendType::DIFFERENCE;
+    } else if (proveAbsence(condition, context, threshold, scaleRatio, history, isAbsenceExpected)) {
+        isFound = false;
+        context.matchBackendType = MatchBackendType::ABSENCE_PROOF;
+    } else if (isMotionCompensationEnabled && isFromPreviousFrame && !history.result.isDegraded
+            && matchGlobalMotion(condition, context, threshold, scaleRatio, history, isFound)) {
+        if (isFound) {
+            matchedScale = history.templateScale;
+            matchedAngle = history.result.angle;
+        }
+        context.matchBackendType = MatchBackendType::GLOBAL_MOTION;
+    } else if (isFromPreviousFrame && history.result.isDetected && historyCondition != nullptr
+            && matchHistoryNeighbourhood(*historyCondition, context, threshold, scaleRatio, history)) {
+        isFound = true;
+        matchedScale = history.templateScale;
+        matchedAngle = history.result.angle;
+        context.matchBackendType = MatchBackendType::NEIGHBOURHOOD;
+    } else if (isLearnedAreaMatchingEnabled && !isAbsenceExpected
+            && matchLearnedArea(condition, context, threshold, scaleRatio, history)) {
+        isFound = true;
+        context.matchBackendType = MatchBackendType::LEARNED_AREA;
+    } else {
+        // Lasting as long as the previous complete matching would exceed the budget, only the coarse level is searched
+        const bool isOverBudget = isOverTimeBudget(history, matchingStart);
+        if (matchDirect(condition, context, threshold, scaleRatio, isFound)) {
+            context.matchBackendType = MatchBackendType::DIRECT;
+        } else if (matchExactPixels(condition, context, threshold, scaleRatio, isFound)) {
+            context.matchBackendType = MatchBackendType::EXACT_PIXELS;
+        } else if (isFirstHitMatchingEnabled && !isAbsenceExpected
+                && matchFirstHit(condition, context, threshold, scaleRatio, history, isFound)) {
+            context.matchBackendType = MatchBackendType::FIRST_HIT;
+        } else if ((isPyramidMatchingEnabled || isOverBudget) && memoryPressure < MEMORY_PRESSURE_PYRAMID
+                && matchPyramid(condition, context, threshold, scaleRatio, isFound)) {
+            context.matchBackendType = MatchBackendType::PYRAMID;
+            context.isDegraded = !isPyramidMatchingEnabled;
+        } else if (isChamferMatchingEnabled && matchChamfer(condition, context, threshold, scaleRatio, isFound)) {
+            context.matchBackendType = MatchBackendType::CHAMFER;
+        } else if (isBinaryMatchingEnabled && matchBinary(condition, context, threshold, scaleRatio, isFound)) {
+            context.matchBackendType = MatchBackendType::BINARY;
+        } else if (isSparseMatchingEnabled && matchSparse(condition, context, threshold, scaleRatio, isFound)) {
+            context.matchBackendType = MatchBackendType::SPARSE;
+        } else {
+            isFound = matchSingleScale(condition, context, threshold, scaleRatio);
+        }
+        if (!isFound && !templateScales.empty()) {
+            if (isOverBudget) context.isDegraded = true;
+            else isFound = matchScaleVariants(condition, context, threshold, scaleRatio, matchedScale);
+        }
+    }
+    if (!isFound && history.rotationCount > 1 && history.metric == MatchingMetric::CCOEFF_NORMED
+            && !isFeatureMatching) {
+        if (isOverTimeBudget(history, matchingStart)) context.isDegraded = true;
+        else isFound = matchRotationVariants(
+                condition, context, threshold, scaleRatio, history.rotationCount, matchedAngle);
+    }
+
+    memoEntry.result = {
+            isFound,
+            detectionRoi.fullSize.x + matchingResults.roi.fullSizeCenterX(),
+            detectionRoi.fullSize.y + matchingResults.roi.fullSizeCenterY(),
+            matchingResults.maxVal,
+            context.isDegraded,
+    };
+    memoEntry.result.angle = matchedAngle;
+    memoEntry.matchRoi = matchingResults.roi.scaled + detectionRoi.scaled.tl();
+    memoEntry.templateScale = matchedScale;
+    if (!context.isDegraded) matchMemo.put(frameIndex, memoHash, detectionRoi.scaled, threshold, memoEntry);
+    if (isFound) addHeatmapHit(history, detectionRoi.scaled, memoEntry.matchRoi);
+    setHistory(history, frameIndex, detectionRoi.scaled, threshold, memoEntry);
+
+    const int64_t matchingNanos = ConditionStatistics::getTimeNanos() - matchingStart;
+    updateCompleteMatching(history, matchingNanos, context.isDegraded);
+    history.statistics.addMatching(matchingNanos, context.candidateCount, 0, context.matchBackendType,
+                                   screenDetectionQuality);
+    frameTelemetry.onMatchComputed(context.matchBackendType, matchingNanos);
+    TRACE_COUNTERS(
+            history.counters.matchingCount++;
+            history.counters.candidateCount += context.candidateCount;
+            history.counters.matchingNanos += matchingNanos);
+
+    return history.result;
+}
+
+void Detector::addHeatmapHit(MatchHistory& history, const cv::Rect& detectionRoi, const cv::Rect& matchRoi) {
+    if (history.heatmapRoi != detectionRoi) {
+        history.hitHeatmap.fill(0);
+        history.heatmapRoi = detectionRoi;
+    }
+
+    const cv::Size positionsSize(
+            std::max(detectionRoi.width - matchRoi.width + 1, 1),
+            std::max(detectionRoi.height - matchRoi.height + 1, 1));
+    uint16_t& hits = history.hitHeatmap[getHeatmapCell(matchRoi.tl() - detectionRoi.tl(), positionsSize)];
+
+    // Keep the most recent positions relevant, the condition might have moved for good
+    if (hits == UINT16_MAX) {
+        for (uint16_t& cellHits : history.hitHeatmap) cellHits /= 2;
+    }
+    hits++;
+}
+
+bool Detector::getLearnedArea(const MatchHistory& history, const cv::Rect& detectionRoi,
+                              const cv::Size& conditionSize, cv::Rect& area) {
+
+    if (history.heatmapRoi != detectionRoi || detectionRoi.empty()) return false;
+
+    int totalHits = 0;
+    for (uint16_t hits : history.hitHeatmap) totalHits += hits;
+    if (totalHits < LEARNED_AREA_MIN_HITS) return false;
+
+    // The bounds of the cells with most of the hits, the rare positions are ignored
+    int minCellX = FIRST_HIT_HEATMAP_SIZE, minCellY = FIRST_HIT_HEATMAP_SIZE, maxCellX = -1, maxCellY = -1;
+    for (int cell = 0; cell < (int) history.hitHeatmap.size(); cell++) {
+        if (history.hitHeatmap[cell] * LEARNED_AREA_NOISE_DIVISOR < totalHits) continue;
+
+        minCellX = std::min(minCellX, cell % FIRST_HIT_HEATMAP_SIZE);
+        minCellY = std::min(minCellY, cell / FIRST_HIT_HEATMAP_SIZE);
+        maxCellX = std::max(maxCellX, cell % FIRST_HIT_HEATMAP_SIZE);
+        maxCellY = std::max(maxCellY, cell / FIRST_HIT_HEATMAP_SIZE);
+    }
+    if (maxCellX < 0) return false;
+
+    // Rounded outwards, the positions of the cells must all be in the area
+    const cv::Size positionsSize(
+            std::max(detectionRoi.width - conditionSize.width + 1, 1),
+            std::max(detectionRoi.height - conditionSize.height + 1, 1));
+    const int x = minCellX * positionsSize.width / FIRST_HIT_HEATMAP_SIZE;
+    const int y = minCellY * positionsSize.height / FIRST_HIT_HEATMAP_SIZE;
+    const cv::Rect positions(
+            x,
+            y,
+            ((maxCellX + 1) * positionsSize.width + FIRST_HIT_HEATMAP_SIZE - 1) / FIRST_HIT_HEATMAP_SIZE - x,
+            ((maxCellY + 1) * positionsSize.height + FIRST_HIT_HEATMAP_SIZE - 1) / FIRST_HIT_HEATMAP_SIZE - y);
+    if (positions.area() > positionsSize.area() * LEARNED_AREA_MAX_RATIO) return false;
+
+    area = cv::Rect(
+            detectionRoi.x + positions.x,
+            detectionRoi.y + positions.y,
+            positions.width + conditionSize.width - 1,
+            positions.height + conditionSize.height - 1);
+    return true;
+}
+
+int Detector::getHeatmapCell(const cv::Point& position, const cv::Size& positionsSize) {
+    const int cellX = std::clamp(position.x * FIRST_HIT_HEATMAP_SIZE / positionsSize.width,
+                                 0, FIRST_HIT_HEATMAP_SIZE - 1);
+    const int cellY = std::clamp(position.y * FIRST_HIT_HEATMAP_SIZE / positionsSize.height,
+                                 0, FIRST_HIT_HEATMAP_SIZE - 1);
+    return cellY * FIRST_HIT_HEATMAP_SIZE + cellX;
+}
+
+void Detector::setHistory(MatchHistory& history, uint64_t frameIndex, const cv::Rect& detectionRoi, int threshold,
+                          const MatchMemo::Entry& matching) {
+    // Found elsewhere than on the previous screen image, the condition moves
+    const bool isMoved = history.isValid && history.result.isDetected && matching.matchRoi != history.matchRoi;
+    history.isTracking = matching.result.isDetected && (history.isTracking || isMoved);
+
+    history.isValid = true;
+    history.frameIndex = frameIndex;
+    history.detectionRoi = detectionRoi;
+    history.threshold = threshold;
+    history.matchRoi = matching.matchRoi;
+    history.templateScale = matching.templateScale;
+    history.result = matching.result;
+}
+
+bool Detector::matchHistoryNeighbourhood(const ConditionTemplate& condition, MatchingContext& context,
+                                         int threshold, double scaleRatio, const MatchHistory& history) const {
+
+    TRACE_SECTION("matchNeighbourhood");
+
+    // The neighbourhood of the previous match, in the detection area
+    const cv::Rect& detectionRoi = context.detectionRoi.scaled;
+    const cv::Rect neighbourhood = cv::Rect(
+            history.matchRoi.x - HISTORY_NEIGHBOURHOOD_MARGIN,
+            history.matchRoi.y - HISTORY_NEIGHBOURHOOD_MARGIN,
+            history.matchRoi.width + HISTORY_NEIGHBOURHOOD_MARGIN * 2,
+            history.matchRoi.height + HISTORY_NEIGHBOURHOOD_MARGIN * 2) & detectionRoi;
+    if (!screenSignature.isDirty(neighbourhood)) {
+        return matchWindow(condition, context, threshold, scaleRatio, neighbourhood);
+    }
+    if (!history.isTracking) return false;
+
+    // A moving condition is usually close to its previous position, way smaller to search than the detection area
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    const int trackingMargin = std::max(TRACKING_MIN_MARGIN, std::max(scaledCondition.cols, scaledCondition.rows));
+    const cv::Rect trackingWindow = cv::Rect(
+            history.matchRoi.x - trackingMargin,
+            history.matchRoi.y - trackingMargin,
+            history.matchRoi.width + trackingMargin * 2,
+            history.matchRoi.height + trackingMargin * 2) & detectionRoi;
+
+    TRACE_SECTION("matchTracking");
+    return matchWindow(condition, context, threshold, scaleRatio, trackingWindow);
+}
+
+bool Detector::matchGlobalMotion(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                                 double scaleRatio, const MatchHistory& history, bool& isFound) const {
+
+    if (!globalMotion.isShiftedAt(screenSignature.getFrameIndex())) return false;
+    TRACE_SECTION("matchGlobalMotion");
+
+    const cv::Rect& detectionRoi = context.detectionRoi.scaled;
+    MatchingResults& matchingResults = context.matchingResults;
+
+    // Found on the previous screen image, it is still there if its content moved with the screen
+    if (history.result.isDetected) {
+        const cv::Rect movedRoi = history.matchRoi + globalMotion.getShift();
+        if ((movedRoi & detectionRoi) != movedRoi || !globalMotion.isMoved(movedRoi)) return false;
+
+        matchingResults.clear();
+        matchingResults.maxVal = history.result.confidenceRate;
+        matchingResults.maxLoc = movedRoi.tl() - detectionRoi.tl();
+        matchingResults.roi.setScaled(
+                matchingResults.maxLoc.x, matchingResults.maxLoc.y, movedRoi.width, movedRoi.height, scaleRatio);
+        isFound = true;
+        return true;
+    }
+
+    // Not found on the previous screen image, only the positions touching the exposed parts are new. The other scales
+    // of the condition would have to be searched in them too, as well as its other orientations.
+    if (!templateScales.empty() || history.rotationCount > 1) return false;
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    std::vector<cv::Rect>& bands = context.exposedBands;
+    globalMotion.getExposedBands(detectionRoi, bands);
+
+    int64_t searchedArea = 0;
+    for (cv::Rect& band : bands) {
+        band = cv::Rect(
+                band.x - scaledCondition.cols + 1,
+                band.y - scaledCondition.rows + 1,
+                band.width + (scaledCondition.cols - 1) * 2,
+                band.height + (scaledCondition.rows - 1) * 2) & detectionRoi;
+        searchedArea += band.area();
+    }
+    if ((double) searchedArea > detectionRoi.area() * GLOBAL_MOTION_MAX_SEARCH_RATIO) return false;
+
+    // Still absent if it isn't in any of them, with the best candidate of the previous screen image when all moved
+    double bestVal = history.result.confidenceRate;
+    cv::Point bestLoc = history.matchRoi.tl() - detectionRoi.tl();
+    ScalableRoi bestRoi;
+    bestRoi.setScaled(bestLoc.x, bestLoc.y, history.matchRoi.width, history.matchRoi.height, scaleRatio);
+    if (!bands.empty()) bestVal = -1;
+
+    isFound = false;
+    for (const cv::Rect& band : bands) {
+        if (matchWindow(condition, context, threshold, scaleRatio, band)) {
+            isFound = true;
+            return true;
+        }
+
+        if (matchingResults.maxVal > bestVal) {
+            bestVal = matchingResults.maxVal;
+            bestLoc = matchingResults.maxLoc;
+            bestRoi = matchingResults.roi;
+        }
+    }
+
+    matchingResults.maxVal = bestVal;
+    matchingResults.maxLoc = bestLoc;
+    matchingResults.roi = bestRoi;
+    return true;
+}
+
+bool Detector::matchWindow(const ConditionTemplate& condition, MatchingContext& context,
+                           int threshold, double scaleRatio, const cv::Rect& window) const {
+
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    if (window.width < scaledCondition.cols || window.height < scaledCondition.rows) return false;
+
+    // Relative to the cropped detection area
+    const cv::Rect croppedWindow = window - context.detectionRoi.scaled.tl();
+    context.refinedResults = context.scratchArena.allocate(
+            croppedWindow.height - scaledCondition.rows + 1,
+            croppedWindow.width - scaledCondition.cols + 1,
+            CV_32F);
+    cv::matchTemplate(
+            context.croppedScaledGray(croppedWindow),
+            scaledCondition,
+            context.refinedResults,
+            cv::TM_CCOEFF_NORMED);
+
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+
+    cv::Point maxLoc;
+    cv::minMaxLoc(context.refinedResults, nullptr, &matchingResults.maxVal, nullptr, &maxLoc);
+    matchingResults.maxLoc = maxLoc + croppedWindow.tl();
+    matchingResults.roi.setScaled(
+            matchingResults.maxLoc.x, matchingResults.maxLoc.y, scaledCondition.cols, scaledCondition.rows, scaleRatio);
+
+    // Same validation as the complete matching candidates
+    context.candidateCount++;
+    return screenImage->isScaledContains(matchingResults.roi.scaled)
+           && isResultAboveThreshold(matchingResults, threshold)
+           && isCandidateColorMatching(condition, context, threshold);
+}
+
+bool Detector::matchSingleScale(const ConditionTemplate& condition, MatchingContext& context,
+                                int threshold, double scaleRatio) const {
+
+    MatchingResults& matchingResults = context.matchingResults;
+
+    // Get the matching results, and the candidates above the threshold in a single pass. The streamed backends
+    // extract them while matching, without the results matrix.
+    const double minConfidence = getMinConfidence(threshold);
+    {
+        TRACE_SECTION("matchTemplate");
+        const MatchRequest request = { &context.croppedScaledGray, &condition, minConfidence };
+        const MatchBackend& backend = matchBackends.select(request, context);
+        if (matchPrefiltered(condition, context, threshold, backend.getCost(request))) {
+            TRACE_SECTION("candidates");
+            matchingResults.extractCandidates(minConfidence);
+        } else if (backend.matchStreamed(request, context)) {
+            context.matchBackendType = backend.getType();
+        } else {
+            cv::Mat* results = matchingResults.initResults(
+                    context.croppedScaledGray, *condition.image.scaledGray, context.scratchArena);
+            matchInBands(backend, request, context, *results);
+            context.matchBackendType = backend.getType();
+
+            TRACE_SECTION("candidates");
+            matchingResults.extractCandidates(minConfidence);
+        }
+    }
+
+    return verifyCandidates(condition, context, threshold, scaleRatio);
+}
+
+void Detector::matchInBands(const MatchBackend& backend, const MatchRequest& request, MatchingContext& context,
+                            cv::Mat& results) const {
+
+    // The workers contexts are used by the batches tasks, the bands of their matchings are computed serially
+    const int workerCount = threadPool != nullptr ? threadPool->getWorkerCount() : 1;
+    const int bandCount = std::min(workerCount, results.rows / RESULT_BAND_MIN_ROWS);
+    if (&context != &mainContext || bandCount <= 1 || !backend.isBandSplittable()
+            || backend.getCost(request) < RESULT_BANDS_MIN_COST) {
+        backend.match(request, context, results);
+        return;
+    }
+
+    TRACE_SECTION("matchInBands");
+    prepareWorkerContexts();
+    const int templateRows = request.condition->image.scaledGray->rows;
+    threadPool->parallelFor(bandCount, [&](int bandIndex, int workerIndex) {
+        const int firstRow = results.rows * bandIndex / bandCount;
+        const int endRow = results.rows * (bandIndex + 1) / bandCount;
+
+        // The image rows of the band positions, overlapping the next band by the template height
+        const cv::Mat bandImage = request.image->rowRange(firstRow, endRow + templateRows - 1);
+        cv::Mat bandResults = results.rowRange(firstRow, endRow);
+        const MatchRequest bandRequest = { &bandImage, request.condition, request.minConfidence };
+        backend.match(bandRequest, workerContexts[workerIndex], bandResults);
+    });
+}
+
+bool Detector::verifyCandidates(const ConditionTemplate& condition, MatchingContext& context,
+                                int threshold, double scaleRatio) const {
+
+    MatchingResults& matchingResults = context.matchingResults;
+
+    // Until a condition is detected or no candidate is left
+    while (!isDetectionStopped() && matchingResults.locateNextCandidate(*condition.image.scaledGray, scaleRatio)) {
+        // If the found Roi is out of bounds, invalid match, keep looking
+        if (!screenImage->isScaledContains(matchingResults.roi.scaled)) {
+            continue;
+        }
+        // Out of time budget, the candidates verified so far are the degraded result
+        if (context.candidateCount > 0 && isDeadlineExpired(context.budgetDeadlineNanos)) {
+            context.isDegraded = true;
+            break;
+        }
+        context.candidateCount++;
+
+        // Check if the colors are matching in the candidate area. If not, continue to search
+        if (isCandidateColorMatching(condition, context, threshold)) {
+            return true;
+        }
+    }
+
+    return false;
+}
 
-void Detector::initialize(JNIEnv *env, jobject results) {
-    detectionResult.attachToJavaObject(env, results);
-    tessBaseAPI = new tesseract::TessBaseAPI();
-    tessBaseAPI->Init(NULL, "chi_sim"); // Use "eng" for English, change as needed
-    LOGD(LOG_TAG, "Initialized");
+bool Detector::matchMasked(const ConditionTemplate& condition, MatchingContext& context,
+                           int threshold, double scaleRatio) const {
+
+    // The correlation of the opaque pixels is the confidence of the condition, the candidates are extracted from it
+    const double minConfidence = getMinConfidence(threshold);
+    {
+        TRACE_SECTION("matchMasked");
+        cv::Mat* results = context.matchingResults.initResults(
+                context.croppedScaledGray, *condition.image.scaledGray, context.scratchArena);
+        context.sparseMatcher.match(context.croppedScaledGray, condition.maskedGray, *results);
+
+        TRACE_SECTION("candidates");
+        context.matchingResults.extractCandidates(minConfidence);
+    }
+
+    return verifyCandidates(condition, context, threshold, scaleRatio);
 }
 
-void Detector::release(JNIEnv *env) {
-    detectionResult.detachFromJavaObject(env);
-    LOGD(LOG_TAG, "Released");
+bool Detector::matchDifference(const ConditionTemplate& condition, MatchingContext& context,
+                               int threshold, double scaleRatio, MatchingMetric metric) const {
+
+    // Same minimum confidence as the correlation, the difference metrics are similarities between 0 and 1 too
+    const double minConfidence = getMinConfidence(threshold);
+    {
+        TRACE_SECTION("matchDifference");
+        cv::Mat* results = context.matchingResults.initResults(
+                context.croppedScaledGray, *condition.image.scaledGray, context.scratchArena);
+        context.differenceMatcher.match(
+                context.croppedScaledGray, *condition.image.scaledGray, metric, minConfidence, *results);
+
+        TRACE_SECTION("candidates");
+        context.matchingResults.extractCandidates(minConfidence);
+    }
+
+    return verifyCandidates(condition, context, threshold, scaleRatio);
 }
 
-void Detector::setScreenMetrics(JNIEnv *env, jstring metricsTag, jobject screenBitmap, double detectionQuality) {
-    const char *tag = env->GetStringUTFChars(metricsTag, nullptr);
+bool Detector::matchScaleVariants(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                                  double scaleRatio, double& matchedScale) const {
 
-    AndroidBitmapInfo bitmapInfo;
-    DetectionImage::readBitmapInfo(env, screenBitmap, &bitmapInfo);
+    TRACE_SECTION("matchScaleVariants");
+    MatchingResults& matchingResults = context.matchingResults;
 
-    scaleRatioManager.computeScaleRatio(
-            bitmapInfo.width,
-            bitmapInfo.height,
-            detectionQuality,
-            tag);
+    // The rejected candidate at the condition size is the reference, a variant must be better to be reported
+    bool isBestFound = false;
+    double bestMaxVal = matchingResults.maxVal;
+    cv::Point bestMaxLoc = matchingResults.maxLoc;
+    ScalableRoi bestRoi = matchingResults.roi;
+    matchedScale = 1.0;
 
-    LOGD(LOG_TAG,
-         "Screen metrics defined: FullSize=[%1$d/%2$d], Quality=%3$f, scaleRatio=%4$f",
-         bitmapInfo.width, bitmapInfo.height, detectionQuality, scaleRatioManager.getScaleRatio());
+    for (double templateScale : templateScales) {
+        const ConditionTemplate* variant = condition.getScaleVariant(templateScale);
+        if (variant == nullptr || !context.isCroppedScaledContains(variant->image.scaledSize)) continue;
 
-    env->ReleaseStringUTFChars(metricsTag, tag);
-}
+        const bool isVariantFound = matchSingleScale(*variant, context, threshold, scaleRatio);
 
-void Detector::setScreenImage(JNIEnv *env, jobject screenBitmap) {
-    screenImage.processBitmap(env, screenBitmap, scaleRatioManager.getScaleRatio());
-}
+        // A validated candidate is always better than a rejected one, whatever its confidence
+        if ((isVariantFound && !isBestFound)
+                || (isVariantFound == isBestFound && matchingResults.maxVal > bestMaxVal)) {
+            isBestFound = isVariantFound;
+            bestMaxVal = matchingResults.maxVal;
+            bestMaxLoc = matchingResults.maxLoc;
+            bestRoi = matchingResults.roi;
+            matchedScale = templateScale;
+        }
+    }
 
-void Detector::detectCondition(JNIEnv *env, jobject conditionBitmap, int threshold) {
-    detectionRoi.setFullSize(screenImage.fullSizeRoi, scaleRatioManager.getScaleRatio());
-    match(env, conditionBitmap, threshold);
+    matchingResults.maxVal = bestMaxVal;
+    matchingResults.maxLoc = bestMaxLoc;
+    matchingResults.roi = bestRoi;
+    return isBestFound;
 }
 
-void Detector::detectCondition(JNIEnv *env, jobject conditionBitmap, int x, int y, int width, int height, int threshold) {
-    detectionRoi.setFullSize(x, y, width, height, scaleRatioManager.getScaleRatio());
-    match(env, conditionBitmap, threshold);
-}
+bool Detector::matchRotationVariants(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                                     double scaleRatio, int rotationCount, int& matchedAngle) const {
+
+    TRACE_SECTION("matchRotationVariants");
+    MatchingResults& matchingResults = context.matchingResults;
+
+    // The rejected candidate at the condition orientation is the reference, a variant must be better to be reported
+    bool isBestFound = false;
+    double bestMaxVal = matchingResults.maxVal;
+    cv::Point bestMaxLoc = matchingResults.maxLoc;
+    ScalableRoi bestRoi = matchingResults.roi;
+    matchedAngle = 0;
+
+    for (int i = 1; i < rotationCount; i++) {
+        const int angle = getRotationAngle(i, rotationCount);
+        const ConditionTemplate* variant = condition.getRotationVariant(angle);
+        if (variant == nullptr || !context.isCroppedScaledContains(variant->image.scaledSize)) continue;
+
+        // Apart from the quarter turns, the corners of the rotated condition are transparent
+        const bool isVariantFound = variant->isMasked()
+                ? matchMasked(*variant, context, threshold, scaleRatio)
+                : matchSingleScale(*variant, context, threshold, scaleRatio);
 
-void Detector::detectCondition(JNIEnv *env, jobject conditionImage, std::string identifying) {
-    detectionRoi.setFullSize(screenImage.fullSizeRoi, scaleRatioManager.getScaleRatio());
-    match(env, conditionBitmap, identifying);
+        // A validated candidate is always better than a rejected one, whatever its confidence
+        if ((isVariantFound && !isBestFound)
+                || (isVariantFound == isBestFound && matchingResults.maxVal > bestMaxVal)) {
+            isBestFound = isVariantFound;
+            bestMaxVal = matchingResults.maxVal;
+            bestMaxLoc = matchingResults.maxLoc;
+            bestRoi = matchingResults.roi;
+            matchedAngle = angle;
+        }
+    }
+
+    matchingResults.maxVal = bestMaxVal;
+    matchingResults.maxLoc = bestMaxLoc;
+    matchingResults.roi = bestRoi;
+    return isBestFound;
 }
 
-void Detector::detectCondition(JNIEnv *env, jobject conditionBitmap, int x, int y, int width, int height, std::string identifying) {
-    detectionRoi.setFullSize(x, y, width, height, scaleRatioManager.getScaleRatio());
-    match(env, conditionBitmap, identifying);
+int Detector::getRotationAngle(int index, int rotationCount) {
+    return cvRound(index * 360.0 / rotationCount) % 360;
 }
 
-void Detector::match(JNIEnv *env, jobject conditionBitmap, int threshold) {
-    // Check of dimensions are valid
-    if (!screenImage.isFullSizeContains(detectionRoi.fullSize) || !screenImage.isScaledContains(detectionRoi.scaled)) {
-        LOGE(LOG_TAG, "Detection ROI is invalid, skipping condition");
-        detectionResult.clearResults(env);
-        return;
+cv::Point Detector::getCoarseScaledGray(MatchingContext& context, int factor) const {
+    // The screen pyramid level is shared by all conditions, the area is rounded to the blocks starting in it
+    cv::Size screenSize;
+    cv::Point offset;
+    context.croppedScaledGray.locateROI(screenSize, offset);
+    if (context.croppedScaledGray.datastart == screenImage->scaledGray->datastart) {
+        const cv::Mat& coarseScreen = screenImage->getCoarseScaledGray(factor);
+        const int left = (offset.x + factor - 1) / factor;
+        const int top = (offset.y + factor - 1) / factor;
+        const cv::Rect coarseRoi = cv::Rect(
+                left,
+                top,
+                std::max((offset.x + context.croppedScaledGray.cols) / factor - left, 0),
+                std::max((offset.y + context.croppedScaledGray.rows) / factor - top, 0))
+                        & cv::Rect(0, 0, coarseScreen.cols, coarseScreen.rows);
+
+        context.coarseScaledGray = coarseScreen(coarseRoi);
+        return coarseRoi.tl() * factor - offset;
+    }
+
+    // Not a view on the screen image, its pyramid can't be used
+    const cv::Size coarseSize(context.croppedScaledGray.cols / factor, context.croppedScaledGray.rows / factor);
+    context.coarseScaledGray = context.scratchArena.allocate(coarseSize.height, coarseSize.width, CV_8U);
+    if (!coarseSize.empty()) {
+        cv::resize(context.croppedScaledGray, context.coarseScaledGray, coarseSize, 0, 0, cv::INTER_AREA);
     }
+    return { 0, 0 };
+}
 
-    // Read condition bitmap image
-    conditionImage.processBitmap(env, conditionBitmap, scaleRatioManager.getScaleRatio());
+bool Detector::matchPyramid(const ConditionTemplate& condition, MatchingContext& context,
+                            int threshold, double scaleRatio, bool& isFound) const {
 
-    // Crop the scaled gray current image to only get the detection area and verify it is equals or bigger than the condition
-    screenImage.setCropping(detectionRoi);
-    if (!screenImage.isCroppedScaledContains(conditionImage.scaledSize)) {
-        LOGE(LOG_TAG, "Condition is bigger than screen image, skipping it");
-        detectionResult.clearResults(env);
-        return;
+    if (condition.coarseScaledGray.empty()) return false;
+    TRACE_SECTION("matchPyramid");
+
+    // Get the coarse level of the detection area, and verify the condition still fits in it
+    const int factor = condition.coarseFactor;
+    const cv::Point coarseShift = getCoarseScaledGray(context, factor);
+    const cv::Mat& coarseScaledGray = context.coarseScaledGray;
+    if (coarseScaledGray.cols < condition.coarseScaledGray.cols
+            || coarseScaledGray.rows < condition.coarseScaledGray.rows) {
+        return false;
     }
 
-    // Get the matching results
+    context.coarseResults = context.scratchArena.allocate(
+            coarseScaledGray.rows - condition.coarseScaledGray.rows + 1,
+            coarseScaledGray.cols - condition.coarseScaledGray.cols + 1,
+            CV_32F);
     cv::matchTemplate(
-            *screenImage.croppedScaledGray,
-            *conditionImage.scaledGray,
-            *matchingResults.initResults(*screenImage.croppedScaledGray, *conditionImage.scaledGray),
+            context.coarseScaledGray,
+            condition.coarseScaledGray,
+            context.coarseResults,
             cv::TM_CCOEFF_NORMED);
 
-    // Until a condition is detected or none fits
-    bool isFound = false;
-    while (true) {
-        // Find new best matching candidate location
-        matchingResults.locateNextMinMax(*conditionImage.scaledGray, scaleRatioManager.getScaleRatio());
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    const cv::Rect croppedRoi(0, 0, context.croppedScaledGray.cols, context.croppedScaledGray.rows);
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
 
-        // If the found Roi is out of bounds, invalid match, keep looking
-        if (!screenImage.isScaledContains(matchingResults.roi.scaled)) {
-            continue;
+    double bestRefinedVal = -1;
+    cv::Point bestRefinedLoc = cv::Point(0, 0);
+    isFound = false;
+
+    for (int i = 0; i < PYRAMID_CANDIDATES_COUNT; i++) {
+        // Find the next best coarse candidate, and remove its neighbourhood so it isn't found again
+        double coarseMaxVal;
+        cv::Point coarseMaxLoc;
+        cv::minMaxLoc(context.coarseResults, nullptr, &coarseMaxVal, nullptr, &coarseMaxLoc);
+        cv::rectangle(
+                context.coarseResults,
+                cv::Rect(
+                        coarseMaxLoc.x - condition.coarseScaledGray.cols / 2,
+                        coarseMaxLoc.y - condition.coarseScaledGray.rows / 2,
+                        condition.coarseScaledGray.cols,
+                        condition.coarseScaledGray.rows),
+                cv::Scalar(-1),
+                cv::FILLED);
+
+        // Refine the candidate at scaled resolution, around its position only
+        const int refineMargin = PYRAMID_REFINE_MARGIN * factor;
+        cv::Rect refineWindow = cv::Rect(
+                coarseMaxLoc.x * factor + coarseShift.x - refineMargin,
+                coarseMaxLoc.y * factor + coarseShift.y - refineMargin,
+                scaledCondition.cols + refineMargin * 2,
+                scaledCondition.rows + refineMargin * 2) & croppedRoi;
+        if (refineWindow.width < scaledCondition.cols || refineWindow.height < scaledCondition.rows) continue;
+
+        if (refineCandidate(condition, context, threshold, scaleRatio, refineWindow)) {
+            isFound = true;
+            return true;
         }
 
-        // If the maximum for the whole picture is below the threshold, we will never find.
-        if (!isResultAboveThreshold(matchingResults, threshold)) {
-            isFound = false;
-            break;
+        if (matchingResults.maxVal > bestRefinedVal) {
+            bestRefinedVal = matchingResults.maxVal;
+            bestRefinedLoc = matchingResults.maxLoc;
         }
+    }
 
-        // Check if the colors are matching in the candidate area. If not, continue to search
-        double colorDiff = getColorDiff(*screenImage.croppedFullSizeColor, *conditionImage.fullSizeColor);
-        if (colorDiff < threshold) {
+    // Nothing found, report the best candidate
+    matchingResults.maxVal = std::max(bestRefinedVal, 0.0);
+    matchingResults.maxLoc = bestRefinedLoc;
+    matchingResults.roi.setScaled(
+            bestRefinedLoc.x, bestRefinedLoc.y, scaledCondition.cols, scaledCondition.rows, scaleRatio);
+    return true;
+}
+
+bool Detector::matchFirstHit(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                             double scaleRatio, const MatchHistory& history, bool& isFound) const {
+
+    // The results of a batch backend are already computed, reading them is cheaper than any tile
+    if (context.backendTemplate == &condition) return false;
+    // Without any previous hit in this area, all tiles are as likely and the condition is maybe not there at all
+    const cv::Rect& detectionRoi = context.detectionRoi.scaled;
+    if (history.heatmapRoi != detectionRoi) return false;
+
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    const cv::Size positionsSize(
+            context.croppedScaledGray.cols - scaledCondition.cols + 1,
+            context.croppedScaledGray.rows - scaledCondition.rows + 1);
+    const cv::Size tileSize(
+            std::max(scaledCondition.cols * FIRST_HIT_TILE_FACTOR, FIRST_HIT_MIN_TILE_SIZE),
+            std::max(scaledCondition.rows * FIRST_HIT_TILE_FACTOR, FIRST_HIT_MIN_TILE_SIZE));
+    const int tileCols = (positionsSize.width + tileSize.width - 1) / tileSize.width;
+    const int tileRows = (positionsSize.height + tileSize.height - 1) / tileSize.height;
+    if (tileCols * tileRows < FIRST_HIT_MIN_TILES) return false;
+
+    TRACE_SECTION("matchFirstHit");
+
+    // The tile of the last hit goes first, then the tiles by decreasing hits. Ties keep the reading order.
+    const cv::Point lastHit = history.matchRoi.tl() - detectionRoi.tl();
+    const int lastHitTile = history.result.isDetected
+            ? std::clamp(lastHit.y / tileSize.height, 0, tileRows - 1) * tileCols
+                    + std::clamp(lastHit.x / tileSize.width, 0, tileCols - 1)
+            : -1;
+    std::vector<std::pair<int, int>>& tiles = context.firstHitTiles;
+    tiles.clear();
+    for (int tile = 0; tile < tileCols * tileRows; tile++) {
+        const cv::Point tileCenter(
+                (tile % tileCols) * tileSize.width + tileSize.width / 2,
+                (tile / tileCols) * tileSize.height + tileSize.height / 2);
+        const int hits = tile == lastHitTile
+                ? INT32_MAX
+                : history.hitHeatmap[getHeatmapCell(tileCenter, positionsSize)];
+        tiles.emplace_back(hits, tile);
+    }
+    std::stable_sort(tiles.begin(), tiles.end(), [](const std::pair<int, int>& lhs, const std::pair<int, int>& rhs) {
+        return lhs.first > rhs.first;
+    });
+
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+
+    double bestTileVal = -1;
+    cv::Point bestTileLoc = cv::Point(0, 0);
+    isFound = false;
+
+    for (const std::pair<int, int>& tile : tiles) {
+        // The window of a tile contains all the condition positions starting in it
+        const cv::Point tilePosition(
+                (tile.second % tileCols) * tileSize.width,
+                (tile.second / tileCols) * tileSize.height);
+        const cv::Rect tileWindow(
+                tilePosition.x,
+                tilePosition.y,
+                std::min(tileSize.width, positionsSize.width - tilePosition.x) + scaledCondition.cols - 1,
+                std::min(tileSize.height, positionsSize.height - tilePosition.y) + scaledCondition.rows - 1);
+
+        if (refineCandidate(condition, context, threshold, scaleRatio, tileWindow)) {
             isFound = true;
-            break;
+            return true;
+        }
+
+        // Only the best position of the tile have been verified, another one above the threshold might have the
+        // right colors. The complete matching checks all of them.
+        if (isResultAboveThreshold(matchingResults, threshold)) return false;
+
+        if (matchingResults.maxVal > bestTileVal) {
+            bestTileVal = matchingResults.maxVal;
+            bestTileLoc = matchingResults.maxLoc;
         }
     }
 
-    // Set the results to the java object
-    detectionResult.setResults(
-            env,
-            isFound,
-            detectionRoi.fullSize.x + matchingResults.roi.fullSizeCenterX(),
-            detectionRoi.fullSize.y + matchingResults.roi.fullSizeCenterY(),
-            matchingResults.maxVal);
+    // Nothing found, report the best position of all tiles
+    matchingResults.maxVal = std::max(bestTileVal, 0.0);
+    matchingResults.maxLoc = bestTileLoc;
+    matchingResults.roi.setScaled(
+            bestTileLoc.x, bestTileLoc.y, scaledCondition.cols, scaledCondition.rows, scaleRatio);
+    return true;
 }
 
-void Detector::match(JNIEnv *env, jobject conditionBitmap, std::string identifying) {
-    // Check of dimensions are valid
-    if (!screenImage.isFullSizeContains(detectionRoi.fullSize) || !screenImage.isScaledContains(detectionRoi.scaled)) {
-        LOGE(LOG_TAG, "Detection ROI is invalid, skipping condition");
-        detectionResult.clearResults(env);
-        return;
+bool Detector::matchLearnedArea(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                                double scaleRatio, MatchHistory& history) const {
+
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    cv::Rect learnedArea;
+    if (!getLearnedArea(history, context.detectionRoi.scaled, scaledCondition.size(), learnedArea)) return false;
+
+    TRACE_SECTION("matchLearnedArea");
+    if (matchWindow(condition, context, threshold, scaleRatio, learnedArea)) return true;
+
+    // The condition might have moved for good, each miss halves the trust in the learned area
+    for (uint16_t& hits : history.hitHeatmap) hits /= 2;
+    return false;
+}
+
+bool Detector::matchSparse(const ConditionTemplate& condition, MatchingContext& context,
+                           int threshold, double scaleRatio, bool& isFound) const {
+
+    if (condition.sparseGray.isEmpty()) return false;
+    TRACE_SECTION("matchSparse");
+
+    // Rank the positions with the informative pixels of the condition only
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    context.sparseResults = context.scratchArena.allocate(
+            context.croppedScaledGray.rows - scaledCondition.rows + 1,
+            context.croppedScaledGray.cols - scaledCondition.cols + 1,
+            CV_32F);
+    context.sparseMatcher.match(context.croppedScaledGray, condition.sparseGray, context.sparseResults);
+
+    isFound = verifyRankedCandidates(
+            condition, context, threshold, scaleRatio, context.sparseResults, SPARSE_CANDIDATES_COUNT,
+            SPARSE_REFINE_MARGIN);
+    return true;
+}
+
+bool Detector::matchBinary(const ConditionTemplate& condition, MatchingContext& context,
+                           int threshold, double scaleRatio, bool& isFound) const {
+
+    if (condition.binaryGray.isEmpty()) return false;
+    TRACE_SECTION("matchBinary");
+
+    // Rank the positions with the bits of the condition only
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    context.binaryResults = context.scratchArena.allocate(
+            context.croppedScaledGray.rows - scaledCondition.rows + 1,
+            context.croppedScaledGray.cols - scaledCondition.cols + 1,
+            CV_32F);
+    context.binaryMatcher.match(context.croppedScaledGray, condition.binaryGray, context.binaryResults);
+
+    isFound = verifyRankedCandidates(
+            condition, context, threshold, scaleRatio, context.binaryResults, BINARY_CANDIDATES_COUNT,
+            BINARY_REFINE_MARGIN);
+    return true;
+}
+
+bool Detector::matchChamfer(const ConditionTemplate& condition, MatchingContext& context,
+                            int threshold, double scaleRatio, bool& isFound) const {
+
+    if (condition.chamferGray.isEmpty()) return false;
+    cv::Mat distances;
+    if (!screenImage->getEdgeDistances(context.croppedScaledGray, distances)) return false;
+    TRACE_SECTION("matchChamfer");
+
+    // Rank the positions with the edges of the condition only
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    context.chamferResults = context.scratchArena.allocate(
+            context.croppedScaledGray.rows - scaledCondition.rows + 1,
+            context.croppedScaledGray.cols - scaledCondition.cols + 1,
+            CV_32F);
+    context.chamferMatcher.match(distances, condition.chamferGray, context.chamferResults);
+
+    // The ranking is changed by the verification, keep the best shape first
+    double shapeMaxVal;
+    cv::Point shapeMaxLoc;
+    cv::minMaxLoc(context.chamferResults, nullptr, &shapeMaxVal, nullptr, &shapeMaxLoc);
+
+    isFound = verifyRankedCandidates(
+            condition, context, threshold, scaleRatio, context.chamferResults, CHAMFER_CANDIDATES_COUNT,
+            CHAMFER_REFINE_MARGIN);
+    if (isFound || shapeMaxVal <= getMinConfidence(threshold)) return true;
+
+    // No candidate have the condition colors, it might have been recolored: its shape alone must be distinct enough
+    const cv::Rect shapeRoi(shapeMaxLoc, scaledCondition.size());
+    const int screenEdgeCount = ChamferMatcher::countEdges(distances(shapeRoi));
+    if (screenEdgeCount > condition.chamferGray.getEdgeCount() * CHAMFER_MAX_CLUTTER_RATIO) return true;
+
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.maxVal = shapeMaxVal;
+    matchingResults.maxLoc = shapeMaxLoc;
+    matchingResults.roi.setScaled(
+            shapeMaxLoc.x, shapeMaxLoc.y, scaledCondition.cols, scaledCondition.rows, scaleRatio);
+    context.candidateCount++;
+    isFound = screenImage->isScaledContains(matchingResults.roi.scaled);
+    return true;
+}
+
+bool Detector::verifyRankedCandidates(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                                      double scaleRatio, cv::Mat& ranking, int candidateCount,
+                                      int refineMargin) const {
+
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    const cv::Rect croppedRoi(0, 0, context.croppedScaledGray.cols, context.croppedScaledGray.rows);
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+
+    double bestRefinedVal = -1;
+    cv::Point bestRefinedLoc = cv::Point(0, 0);
+
+    for (int i = 0; i < candidateCount; i++) {
+        // Find the next best ranked candidate, and remove its neighbourhood so it isn't found again
+        double rankingMaxVal;
+        cv::Point rankingMaxLoc;
+        cv::minMaxLoc(ranking, nullptr, &rankingMaxVal, nullptr, &rankingMaxLoc);
+        if (rankingMaxVal < 0) break;
+        cv::rectangle(
+                ranking,
+                cv::Rect(
+                        rankingMaxLoc.x - scaledCondition.cols / 2,
+                        rankingMaxLoc.y - scaledCondition.rows / 2,
+                        scaledCondition.cols,
+                        scaledCondition.rows),
+                cv::Scalar(-1),
+                cv::FILLED);
+
+        // Verify the candidate with the dense matching, around its position only
+        const cv::Rect refineWindow = cv::Rect(
+                rankingMaxLoc.x - refineMargin,
+                rankingMaxLoc.y - refineMargin,
+                scaledCondition.cols + refineMargin * 2,
+                scaledCondition.rows + refineMargin * 2) & croppedRoi;
+
+        if (refineCandidate(condition, context, threshold, scaleRatio, refineWindow)) return true;
+
+        if (matchingResults.maxVal > bestRefinedVal) {
+            bestRefinedVal = matchingResults.maxVal;
+            bestRefinedLoc = matchingResults.maxLoc;
+        }
+    }
+
+    // Nothing found, report the best candidate
+    matchingResults.maxVal = std::max(bestRefinedVal, 0.0);
+    matchingResults.maxLoc = bestRefinedLoc;
+    matchingResults.roi.setScaled(
+            bestRefinedLoc.x, bestRefinedLoc.y, scaledCondition.cols, scaledCondition.rows, scaleRatio);
+    return false;
+}
+
+bool Detector::matchPrefiltered(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                                double backendCost) const {
+
+    // The backend is already about as cheap as the prefiltering itself
+    const cv::Mat& conditionGray = *condition.image.scaledGray;
+    const double resultsCount = (double) (context.croppedScaledGray.cols - conditionGray.cols + 1)
+            * (double) (context.croppedScaledGray.rows - conditionGray.rows + 1);
+    if (backendCost <= resultsCount * PREFILTER_POSITION_COST) return false;
+
+    cv::Mat sums, squaredSums;
+    screenImage->getScaledGrayIntegrals(sums, squaredSums);
+
+    // The color difference of a candidate is the sum of its channels differences, in percents of 3 * 255
+    const double maxMeanDiff = threshold * 255.0 * 3 / 100 + PREFILTER_MEAN_MARGIN;
+    const std::vector<cv::Point>& positions = context.positionPrefilter.filter(
+            sums, squaredSums, context.detectionRoi.scaled, conditionGray.size(), condition.grayStatistics,
+            maxMeanDiff);
+
+    const double correlationCost = (double) positions.size() * (double) conditionGray.total() * INTEGER_COST_FACTOR;
+    if (correlationCost >= backendCost) return false;
+
+    TRACE_SECTION("matchPrefiltered");
+    cv::Mat& results = *context.matchingResults.initResults(context.croppedScaledGray, conditionGray,
+                                                            context.scratchArena);
+    results.setTo(cv::Scalar(0));
+    for (const cv::Point& position : positions) {
+        results.at<float>(position) = IntegerMatcher::matchPosition(
+                context.croppedScaledGray, position, conditionGray, condition.grayStatistics);
     }
+    context.matchBackendType = MatchBackendType::PREFILTERED;
 
-    // Read condition bitmap image
-    conditionImage.processBitmap(env, conditionBitmap, scaleRatioManager.getScaleRatio());
+    return true;
+}
 
-    // Crop the scaled gray current image to only get the detection area and verify it is equals or bigger than the condition
-    screenImage.setCropping(detectionRoi);
-    if (!screenImage.isCroppedScaledContains(conditionImage.scaledSize)) {
-        LOGE(LOG_TAG, "Condition is bigger than screen image, skipping it");
-        detectionResult.clearResults(env);
-        return;
+bool Detector::proveAbsence(const ConditionTemplate& condition, MatchingContext& context, int threshold,
+                            double scaleRatio, const MatchHistory& history, bool isAbsenceExpected) const {
+
+    // The proof only covers the condition at its own orientation
+    if (!templateScales.empty() || history.rotationCount > 1) return false;
+
+    const cv::Mat& conditionGray = *condition.image.scaledGray;
+    const bool isPrefilteredAbsent = history.absentFrameIndex == screenSignature.getFrameIndex()
+            && history.absentThreshold == threshold && history.absentRoi == context.detectionRoi.scaled;
+    if (!isPrefilteredAbsent) {
+        if (!isAbsenceExpected) return false;
+
+        cv::Mat sums, squaredSums;
+        screenImage->getScaledGrayIntegrals(sums, squaredSums);
+
+        const double maxMeanDiff = threshold * 255.0 * 3 / 100 + PREFILTER_MEAN_MARGIN;
+        if (PositionPrefilter::hasPosition(sums, squaredSums, context.detectionRoi.scaled, conditionGray.size(),
+                                           condition.grayStatistics, maxMeanDiff)) {
+            return false;
+        }
+    }
+
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+    matchingResults.maxVal = 0;
+    matchingResults.maxLoc = cv::Point(0, 0);
+    matchingResults.roi.setScaled(0, 0, conditionGray.cols, conditionGray.rows, scaleRatio);
+    return true;
+}
+
+void Detector::addExactAreaJitter(const ConditionTemplate& condition, ScalableRoi& detectionRoi,
+                                  double scaleRatio) const {
+
+    // The scaled sizes of the area and of the condition are rounded separately
+    const cv::Size& conditionSize = condition.image.scaledGray->size();
+    const int marginX = detectionRoi.scaled.width - conditionSize.width;
+    const int marginY = detectionRoi.scaled.height - conditionSize.height;
+    if (marginX < 0 || marginX > EXACT_AREA_MAX_MARGIN || marginY < 0 || marginY > EXACT_AREA_MAX_MARGIN) return;
+
+    const int jitter = std::min(cvCeil(exactMatchingJitter * scaleRatio), EXACT_MATCHING_MAX_JITTER);
+    const cv::Rect area = cv::Rect(
+            detectionRoi.scaled.x - jitter,
+            detectionRoi.scaled.y - jitter,
+            detectionRoi.scaled.width + jitter * 2,
+            detectionRoi.scaled.height + jitter * 2) & screenImage->scaledRoi;
+
+    detectionRoi.setScaled(area.x, area.y, area.width, area.height, scaleRatio);
+    detectionRoi.fullSize &= screenImage->fullSizeRoi;
+}
+
+bool Detector::matchDirect(const ConditionTemplate& condition, MatchingContext& context,
+                           int threshold, double scaleRatio, bool& isFound) const {
+
+    const cv::Mat& image = context.croppedScaledGray;
+    const cv::Mat& conditionGray = *condition.image.scaledGray;
+    const int positionCols = image.cols - conditionGray.cols + 1;
+    const int positionRows = image.rows - conditionGray.rows + 1;
+    if (positionCols > DIRECT_MATCHING_MAX_POSITIONS || positionRows > DIRECT_MATCHING_MAX_POSITIONS) return false;
+
+    TRACE_SECTION("matchDirect");
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+    matchingResults.maxVal = -1;
+    for (int y = 0; y < positionRows; y++) {
+        for (int x = 0; x < positionCols; x++) {
+            const cv::Point position(x, y);
+            const float value = IntegerMatcher::matchPosition(image, position, conditionGray, condition.grayStatistics);
+            if (value <= matchingResults.maxVal) continue;
+
+            matchingResults.maxVal = value;
+            matchingResults.maxLoc = position;
+        }
+    }
+    matchingResults.roi.setScaled(
+            matchingResults.maxLoc.x, matchingResults.maxLoc.y, conditionGray.cols, conditionGray.rows, scaleRatio);
+    context.candidateCount++;
+
+    isFound = isResultAboveThreshold(matchingResults, threshold)
+            && isCandidateColorMatching(condition, context, threshold);
+    return true;
+}
+
+bool Detector::matchExactPixels(const ConditionTemplate& condition, MatchingContext& context,
+                                int threshold, double scaleRatio, bool& isFound) const {
+
+    // The color pixels of a screen captured downscaled are not the condition ones
+    if (!isExactPixelMatchingEnabled || threshold > EXACT_PIXEL_MATCHING_MAX_THRESHOLD
+            || condition.exactPixelsHash.isEmpty() || screenImage->colorScale != 1.0) {
+        return false;
+    }
+
+    TRACE_SECTION("matchExactPixels");
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+    context.candidateCount++;
+
+    // The screen tiles are indexed once for all conditions, only the conditions with plain tiles search their area
+    cv::Point location;
+    const cv::Rect& area = context.detectionRoi.fullSize;
+    if (!condition.exactTiles.isEmpty() && screenImage->getTileIndex().find(
+            *screenImage->fullSizeColor, condition.exactTiles, condition.exactPixelsHash, area,
+            context.tileCandidates, location, isFound)) {
+        location -= area.tl();
+    } else {
+        isFound = context.exactPixelMatcher.find(context.croppedFullSizeColor, condition.exactPixelsHash, location);
+    }
+    if (isFound) {
+        matchingResults.maxVal = 1;
+        matchingResults.roi.setFullSize(location.x, location.y, condition.exactPixelsHash.size.width,
+                                        condition.exactPixelsHash.size.height, scaleRatio);
+        matchingResults.maxLoc = matchingResults.roi.scaled.tl();
+    }
+
+    return true;
+}
+
+bool Detector::matchFeatures(const ConditionTemplate& condition, MatchingContext& context,
+                             int threshold, double scaleRatio, uint64_t frameIndex) const {
+
+    MatchingResults& matchingResults = context.matchingResults;
+    matchingResults.clear();
+
+    FeatureMatch match;
+    if (!context.featureMatcher.match(context.croppedScaledGray, frameIndex, context.detectionRoi.scaled,
+                                      condition.getFeatures(), match)) {
+        return false;
     }
+    context.candidateCount++;
 
-    // Get the matching results
+    // The found condition can be scaled or rotated, its colors can't be compared with the template ones
+    matchingResults.maxVal = match.confidence;
+    matchingResults.maxLoc = match.area.tl();
+    matchingResults.roi.setScaled(match.area.x, match.area.y, match.area.width, match.area.height, scaleRatio);
+    return isResultAboveThreshold(matchingResults, threshold);
+}
+
+bool Detector::refineCandidate(const ConditionTemplate& condition, MatchingContext& context,
+                               int threshold, double scaleRatio, const cv::Rect& refineWindow) const {
+
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    context.refinedResults = context.scratchArena.allocate(
+            refineWindow.height - scaledCondition.rows + 1,
+            refineWindow.width - scaledCondition.cols + 1,
+            CV_32F);
     cv::matchTemplate(
-            *screenImage.croppedScaledGray,
-            *conditionImage.scaledGray,
-            *matchingResults.initResults(*screenImage.croppedScaledGray, *conditionImage.scaledGray),
+            context.croppedScaledGray(refineWindow),
+            scaledCondition,
+            context.refinedResults,
             cv::TM_CCOEFF_NORMED);
 
-    // Until a condition is detected or none fits
-    bool isFound = false;
-    int repeatCycle = 0;
-    while (true) {
-        // Find new best matching candidate location
-        matchingResults.locateNextMinMax(*conditionImage.scaledGray, scaleRatioManager.getScaleRatio());
+    MatchingResults& matchingResults = context.matchingResults;
+    cv::Point refinedMaxLoc;
+    cv::minMaxLoc(context.refinedResults, nullptr, &matchingResults.maxVal, nullptr, &refinedMaxLoc);
+    matchingResults.maxLoc = refinedMaxLoc + refineWindow.tl();
+    matchingResults.roi.setScaled(
+            matchingResults.maxLoc.x, matchingResults.maxLoc.y, scaledCondition.cols, scaledCondition.rows, scaleRatio);
+
+    // Same validation as the single scale candidates
+    context.candidateCount++;
+    return screenImage->isScaledContains(matchingResults.roi.scaled)
+           && isResultAboveThreshold(matchingResults, threshold)
+           && isCandidateColorMatching(condition, context, threshold);
+}
+
+ConditionResult Detector::match(int64_t conditionId, const PixelsBuffer* conditionPixels,
+                                const std::string& identifying, const OcrOptions* ocrOptions) {
+
+    const ConditionTemplate* condition = getTemplate(conditionId, conditionPixels);
+    if (condition == nullptr) return {};
+
+    // Text conditions have no history to reuse, it only holds their statistics and matching duration
+    return matchText(*condition, mainContext, identifying, ocrOptions, getMatchHistory(conditionId));
+}
+
+ConditionResult Detector::matchText(const ConditionTemplate& condition, MatchingContext& context,
+                                    const std::string& identifying, const OcrOptions* ocrOptions,
+                                    MatchHistory& history) {
+
+    TRACE_SECTION("matchText");
+    const int64_t matchingStart = ConditionStatistics::getTimeNanos();
+
+    ScalableRoi& detectionRoi = context.detectionRoi;
+    MatchingResults& matchingResults = context.matchingResults;
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+
+    // Check of dimensions are valid
+    if (!screenImage->isFullSizeContains(detectionRoi.fullSize)
+            || !screenImage->isScaledContains(detectionRoi.scaled)) {
+        LOGE_LIMITED(LOG_TAG, "Detection ROI is invalid, skipping condition");
+        return {};
+    }
+
+    // Crop the scaled gray current image to only get the detection area and verify it is equals or bigger than the condition
+    screenImage->getCropping(detectionRoi, context.croppedScaledGray, context.croppedFullSizeColor);
+    if (!context.isCroppedScaledContains(condition.image.scaledSize)) {
+        LOGE_LIMITED(LOG_TAG, "Condition is bigger than screen image, skipping it");
+        return {};
+    }
+
+    // Get the matching results, all candidates may contain the text
+    const cv::Mat& scaledCondition = *condition.image.scaledGray;
+    context.scratchArena.reset();
+    const MatchRequest request = { &context.croppedScaledGray, &condition, 0 };
+    const MatchBackend& backend = matchBackends.select(request, context);
+    backend.match(
+            request,
+            context,
+            *matchingResults.initResults(context.croppedScaledGray, scaledCondition, context.scratchArena));
+    matchingResults.extractCandidates(0);
+
+    // Ranked for the recognition by the template gray mean, the prefilter descriptor of the condition
+    cv::Mat sums, squaredSums;
+    if (isConditionPrefilterEnabled) screenImage->getScaledGrayIntegrals(sums, squaredSums);
+    const double templateMean = (double) condition.grayStatistics.getSum() / (double) scaledCondition.total();
 
+    // Until the text is found in the cached text of a candidate, or the best ones have been located
+    const uint64_t optionsHash = ocrOptions != nullptr ? ocrOptions->hash() : 0;
+    std::vector<TextCandidate>& textCandidates = context.textCandidates;
+    textCandidates.clear();
+    int foundIndex = -1;
+    for (int i = 0; i < OCR_MAX_CANDIDATES && matchingResults.locateNextCandidate(scaledCondition, scaleRatio); i++) {
+        if (isDetectionStopped()) return {};
         // If the found Roi is out of bounds, invalid match, keep looking
-        if (!screenImage.isScaledContains(matchingResults.roi.scaled)) {
+        if (!screenImage->isScaledContains(matchingResults.roi.scaled)) {
             continue;
         }
 
-        auto image = screenImage.fullSizeColor;
-        // Convert OpenCV image to Leptonica Pix format
-        Pix *pix = pixCreate(image.size().width, image.size().height, 32);
-        // Copy image data to Pix
-        memcpy(pixGetData(pix), image.data, image.total() * image.elemSize());
-
-        // Perform OCR
-        tessBaseAPI->SetImage(pix);
-        std::string ocrText = tessBaseAPI->GetUTF8Text();
-        // compare result
-        string::size_type idx = ocrText.find(identifying);
-        if (idx != string::npos) {
-            // Cleanup
-            pixDestroy(&pix);
-            isFound = true;
+        if (addTextCandidate(context, matchingResults.roi, matchingResults.maxVal, optionsHash, identifying)) {
+            foundIndex = (int) textCandidates.size() - 1;
             break;
         }
-        repeatCycle ++;
-        if (repeatCycle >= 100) {
-            LOGE(LOG_TAG, "RepeatCycle great than 100, means timeout");
-            detectionResult.clearResults(env);
-            return;
+        if (!sums.empty()) {
+            textCandidates.back().meanDistance = getWindowMeanDistance(
+                    sums, matchingResults.roi.scaled + detectionRoi.scaled.tl(), templateMean);
         }
     }
 
-    // Set the results to the java object
-    detectionResult.setResults(
-            env,
-            isFound,
+    // Only the cached texts of the candidates are checked when the recognition would exceed the time budget
+    int64_t ocrNanos = 0;
+    const bool isDegraded = foundIndex < 0 && isOverTimeBudget(history, matchingStart);
+    if (foundIndex < 0 && !isDegraded) {
+        const int64_t ocrStart = ConditionStatistics::getTimeNanos();
+        foundIndex = recognizeTextCandidates(context, identifying, ocrConfig.withOptions(ocrOptions));
+        ocrNanos = ConditionStatistics::getTimeNanos() - ocrStart;
+
+        if (foundIndex == OCR_ENGINE_MISSING) {
+            LOGE_LIMITED(LOG_TAG, "OCR engine can't be initialized, skipping condition");
+            return {};
+        }
+    }
+    const auto candidateCount = (int64_t) textCandidates.size();
+
+    const int64_t matchingNanos = ConditionStatistics::getTimeNanos() - matchingStart;
+    updateCompleteMatching(history, matchingNanos, isDegraded);
+    history.statistics.addMatching(matchingNanos, candidateCount, ocrNanos, backend.getType(), screenDetectionQuality);
+    frameTelemetry.onMatchComputed(backend.getType(), matchingNanos);
+    TRACE_COUNTERS(
+            history.counters.matchingCount++;
+            history.counters.candidateCount += candidateCount;
+            history.counters.matchingNanos += matchingNanos);
+
+    if (foundIndex >= 0) return textCandidates[foundIndex].result;
+    return {
+            false,
             detectionRoi.fullSize.x + matchingResults.roi.fullSizeCenterX(),
             detectionRoi.fullSize.y + matchingResults.roi.fullSizeCenterY(),
-            matchingResults.maxVal);
+            matchingResults.maxVal,
+            isDegraded,
+    };
+}
+
+ConditionResult Detector::matchText(MatchingContext& context, const std::string& identifying,
+                                    const OcrOptions* ocrOptions, MatchHistory& history) {
+
+    TRACE_SECTION("matchTextInArea");
+    const int64_t matchingStart = ConditionStatistics::getTimeNanos();
+
+    const ScalableRoi& detectionRoi = context.detectionRoi;
+    if (!screenImage->isFullSizeContains(detectionRoi.fullSize)
+            || !screenImage->isScaledContains(detectionRoi.scaled)) {
+        LOGE_LIMITED(LOG_TAG, "Detection ROI is invalid, skipping condition");
+        return {};
+    }
+    screenImage->getCropping(detectionRoi, context.croppedScaledGray, context.croppedFullSizeColor);
+
+    // An area the height of a text line is recognized as a whole. In a bigger one, only the regions looking like text
+    // lines are recognized, instead of the whole area.
+    const uint64_t optionsHash = ocrOptions != nullptr ? ocrOptions->hash() : 0;
+    const bool isSingleLine = detectionRoi.fullSize.height <= OCR_SINGLE_LINE_AREA_MAX_HEIGHT;
+    std::vector<TextCandidate>& textCandidates = context.textCandidates;
+    textCandidates.clear();
+    int foundIndex = -1;
+    if (isSingleLine) {
+        ScalableRoi areaRoi;
+        areaRoi.fullSize = cv::Rect(cv::Point(0, 0), detectionRoi.fullSize.size());
+        areaRoi.scaled = cv::Rect(cv::Point(0, 0), detectionRoi.scaled.size());
+        if (addTextCandidate(context, areaRoi, 1.0, optionsHash, identifying)) foundIndex = 0;
+    } else {
+        // The lines layout is kept while the area is the same, each line being cached by its content: only the lines
+        // whose pixels have changed are recognized again. Once none of them is cached, the content has moved and the
+        // layout is located again.
+        const bool isLayoutCached = history.textArea == detectionRoi.scaled && !history.textLines.empty();
+        if (!isLayoutCached) updateTextLayout(context, history);
+        foundIndex = addTextLineCandidates(context, history.textLines, optionsHash, identifying);
+
+        const auto isLineCached = [](const TextCandidate& line) { return line.isRecognized; };
+        if (foundIndex < 0 && isLayoutCached
+                && std::none_of(textCandidates.begin(), textCandidates.end(), isLineCached)) {
+            updateTextLayout(context, history);
+            textCandidates.clear();
+            foundIndex = addTextLineCandidates(context, history.textLines, optionsHash, identifying);
+        }
+    }
+
+    // Only the cached texts of the lines are checked when the recognition would exceed the time budget
+    int64_t ocrNanos = 0;
+    const bool isDegraded = foundIndex < 0 && isOverTimeBudget(history, matchingStart);
+    if (foundIndex < 0 && !isDegraded) {
+        const int64_t ocrStart = ConditionStatistics::getTimeNanos();
+        foundIndex = recognizeTextCandidates(context, identifying, ocrConfig.withOptions(ocrOptions));
+        ocrNanos = ConditionStatistics::getTimeNanos() - ocrStart;
+
+        if (foundIndex == OCR_ENGINE_MISSING) {
+            LOGE_LIMITED(LOG_TAG, "OCR engine can't be initialized, skipping condition");
+            return {};
+        }
+    }
+
+    // The text can be wrapped over several lines, search it in the text of the whole area as well
+    bool isFoundInArea = false;
+    if (foundIndex < 0 && !isSingleLine) isFoundInArea = isTextInLines(context, identifying);
+    const auto candidateCount = (int64_t) textCandidates.size();
+
+    const int64_t matchingNanos = ConditionStatistics::getTimeNanos() - matchingStart;
+    updateCompleteMatching(history, matchingNanos, isDegraded);
+    history.statistics.addMatching(
+            matchingNanos, candidateCount, ocrNanos, MatchBackendType::NONE, screenDetectionQuality);
+    frameTelemetry.onMatchComputed(MatchBackendType::NONE, matchingNanos);
+    TRACE_COUNTERS(
+            history.counters.matchingCount++;
+            history.counters.candidateCount += candidateCount;
+            history.counters.matchingNanos += matchingNanos);
+
+    if (foundIndex >= 0) return textCandidates[foundIndex].result;
+    return {
+            isFoundInArea,
+            detectionRoi.fullSize.x + detectionRoi.fullSize.width / 2,
+            detectionRoi.fullSize.y + detectionRoi.fullSize.height / 2,
+            isFoundInArea ? 1.0 : 0.0,
+            isDegraded && !isFoundInArea,
+    };
+}
+
+void Detector::updateTextLayout(MatchingContext& context, MatchHistory& history) {
+    history.textArea = context.detectionRoi.scaled;
+    history.textLines = context.textRegionProposer.propose(context.croppedScaledGray);
+
+    // In reading order, for the assembly of the text of the whole area
+    std::sort(history.textLines.begin(), history.textLines.end(), [](const cv::Rect& first, const cv::Rect& second) {
+        return first.y != second.y ? first.y < second.y : first.x < second.x;
+    });
+}
+
+int Detector::addTextLineCandidates(MatchingContext& context, const std::vector<cv::Rect>& lines,
+                                    uint64_t optionsHash, const std::string& identifying) {
+
+    const double scaleRatio = scaleRatioManager.getScaleRatio();
+    ScalableRoi lineRoi;
+    for (const cv::Rect& line : lines) {
+        lineRoi.setScaled(line.x, line.y, line.width, line.height, scaleRatio);
+        if (addTextCandidate(context, lineRoi, 1.0, optionsHash, identifying)) {
+            return (int) context.textCandidates.size() - 1;
+        }
+    }
+
+    return -1;
+}
+
+bool Detector::isTextInLines(MatchingContext& context, const std::string& identifying) {
+    std::string& textAreaContent = context.textAreaContent;
+    textAreaContent.clear();
+    for (const TextCandidate& line : context.textCandidates) {
+        if (!line.isRecognized) return false;
+
+        // Each line is recognized with its trailing line break
+        size_t length = line.text.size();
+        while (length > 0 && std::isspace((unsigned char) line.text[length - 1])) length--;
+        if (!textAreaContent.empty()) textAreaContent.push_back(' ');
+        textAreaContent.append(line.text, 0, length);
+    }
+
+    return textAreaContent.find(identifying) != std::string::npos;
+}
+
+bool Detector::addTextCandidate(MatchingContext& context, const ScalableRoi& candidateRoi, double confidence,
+                                uint64_t optionsHash, const std::string& identifying) {
+
+    const cv::Rect croppedColorRect(0, 0, context.croppedFullSizeColor.cols, context.croppedFullSizeColor.rows);
+    const ScalableRoi& detectionRoi = context.detectionRoi;
+
+    TextCandidate& candidate = context.textCandidates.emplace_back();
+    candidate.colorRoi = screenImage->toColorRoi(candidateRoi.fullSize) & croppedColorRect;
+    candidate.result = {
+            true,
+            detectionRoi.fullSize.x + candidateRoi.fullSizeCenterX(),
+            detectionRoi.fullSize.y + candidateRoi.fullSizeCenterY(),
+            confidence,
+    };
+
+    // Only the candidate area is recognized, read directly from the screen pixels
+    if (candidate.colorRoi.empty()) {
+        candidate.isRecognized = true;
+    } else {
+        candidate.hash = OcrTextCache::hash(context.croppedFullSizeColor(candidate.colorRoi), optionsHash);
+        // Copied while locked, the cached text is dropped by the puts of the other workers
+        std::lock_guard<std::mutex> lock(ocrTextCacheMutex);
+        const std::string* cachedText = ocrTextCache.find(candidate.hash);
+        if (cachedText != nullptr) {
+            candidate.text = *cachedText;
+            candidate.isRecognized = true;
+        }
+    }
+
+    return candidate.isRecognized && candidate.text.find(identifying) != std::string::npos;
+}
+
+double Detector::getWindowMeanDistance(const cv::Mat& sums, const cv::Rect& window, double templateMean) {
+    const int64_t windowSum = (int64_t) sums.at<int>(window.y + window.height, window.x + window.width)
+            - sums.at<int>(window.y, window.x + window.width)
+            - sums.at<int>(window.y + window.height, window.x)
+            + sums.at<int>(window.y, window.x);
+
+    return std::abs((double) windowSum / (double) std::max(window.area(), 1) - templateMean);
+}
+
+int Detector::recognizeTextCandidates(MatchingContext& context, const std::string& identifying,
+                                      const OcrEnginePool::Config& config) {
+
+    std::vector<TextCandidate>& textCandidates = context.textCandidates;
+    std::vector<int>& pendingTextCandidates = context.pendingTextCandidates;
+    pendingTextCandidates.clear();
+    for (int i = 0; i < (int) textCandidates.size(); i++) {
+        if (!textCandidates[i].isRecognized) pendingTextCandidates.push_back(i);
+    }
+    if (pendingTextCandidates.empty()) return -1;
+
+    // The closest candidates to their template are the most plausible, the recognition stops at the first with the
+    // text. Without any ranking, all distances are 0 and the candidates keep their confidence order.
+    std::stable_sort(pendingTextCandidates.begin(), pendingTextCandidates.end(), [&](int first, int second) {
+        return textCandidates[first].meanDistance < textCandidates[second].meanDistance;
+    });
+
+    // The workers matching a parallel batch can't dispatch on the pool they are running on
+    std::atomic<bool> isFound = false;
+    std::atomic<bool> isEngineMissing = false;
+    if (threadPool == nullptr || pendingTextCandidates.size() == 1 || &context != &mainContext) {
+        // Engines are loaded on the first recognition only, it takes seconds
+        OcrEnginePool::Lease ocrEngine = OcrEnginePool::getInstance().acquire(config);
+        if (!ocrEngine) return OCR_ENGINE_MISSING;
+
+        for (int index : pendingTextCandidates) {
+            if (isDetectionStopped()) break;
+
+            TextCandidate& candidate = textCandidates[index];
+            const cv::Mat& image = context.ocrPreprocessor.process(context.croppedFullSizeColor(candidate.colorRoi));
+            candidate.isRecognized = recognizeText(*ocrEngine, image, &isDetectionCancelled, candidate.text);
+            if (candidate.text.find(identifying) != std::string::npos) break;
+        }
+    } else {
+        // Each worker recognizes with its own engine and preprocessor. Once a candidate contains the text, the
+        // recognitions in progress are cancelled and the pending ones are skipped.
+        prepareWorkerContexts();
+        const int workerCount = threadPool->getWorkerCount();
+        if ((int) workerOcrEngines.size() < workerCount) workerOcrEngines.resize(workerCount);
+
+        threadPool->parallelFor((int) pendingTextCandidates.size(), [&](int taskIndex, int workerIndex) {
+            if (isFound.load(std::memory_order_relaxed) || isDetectionStopped()) return;
+
+            OcrEnginePool::Lease& ocrEngine = workerOcrEngines[workerIndex];
+            if (!ocrEngine) ocrEngine = OcrEnginePool::getInstance().acquire(config);
+            if (!ocrEngine) {
+                isEngineMissing.store(true, std::memory_order_relaxed);
+                return;
+            }
+
+            TextCandidate& candidate = textCandidates[pendingTextCandidates[taskIndex]];
+            const cv::Mat& image = workerContexts[workerIndex].ocrPreprocessor.process(
+                    context.croppedFullSizeColor(candidate.colorRoi));
+            candidate.isRecognized = recognizeText(*ocrEngine, image, &isFound, candidate.text, &isDetectionCancelled);
+            if (candidate.isRecognized && candidate.text.find(identifying) != std::string::npos) {
+                isFound.store(true, std::memory_order_relaxed);
+            }
+        });
+
+        // Given back to the pool, the other detectors can use them
+        for (OcrEnginePool::Lease& ocrEngine : workerOcrEngines) ocrEngine = OcrEnginePool::Lease();
+    }
+
+    // Only the complete recognitions are cached, a cancelled one holds a part of the candidate text. The first
+    // candidate containing the text in the ranking is kept, whatever the order the recognitions have completed in.
+    int foundIndex = -1;
+    std::lock_guard<std::mutex> lock(ocrTextCacheMutex);
+    for (int index : pendingTextCandidates) {
+        const TextCandidate& candidate = textCandidates[index];
+        if (!candidate.isRecognized) continue;
+
+        ocrTextCache.put(candidate.hash, candidate.text);
+        if (foundIndex < 0 && candidate.text.find(identifying) != std::string::npos) foundIndex = index;
+    }
+
+    if (foundIndex < 0 && isEngineMissing.load(std::memory_order_relaxed)) return OCR_ENGINE_MISSING;
+    return foundIndex;
+}
+
+bool Detector::recognizeText(tesseract::TessBaseAPI& ocrEngine, const cv::Mat& image,
+                             const std::atomic<bool>* isCancelled, std::string& text,
+                             const std::atomic<bool>* isAlsoCancelled) {
+
+    TRACE_SECTION("ocr");
+    ocrEngine.SetImage(image.data, image.cols, image.rows, (int) image.elemSize(), (int) image.step);
+
+    // Tesseract polls the cancellation between the words it recognizes
+    using CancelFlags = std::array<const std::atomic<bool>*, 2>;
+    CancelFlags cancelFlags = { isCancelled, isAlsoCancelled };
+    tesseract::ETEXT_DESC monitor;
+    if (isCancelled != nullptr || isAlsoCancelled != nullptr) {
+        monitor.cancel = [](void* cancelThis, int) {
+            for (const std::atomic<bool>* flag : *static_cast<const CancelFlags*>(cancelThis)) {
+                if (flag != nullptr && flag->load(std::memory_order_relaxed)) return true;
+            }
+            return false;
+        };
+        monitor.cancel_this = &cancelFlags;
+    }
+    if (ocrEngine.Recognize(&monitor) != 0) {
+        text.clear();
+        return false;
+    }
+
+    char* recognizedText = ocrEngine.GetUTF8Text();
+    text = recognizedText != nullptr ? std::string(recognizedText) : std::string();
+    delete[] recognizedText;
+
+    return true;
 }
 
 bool Detector::isResultAboveThreshold(const MatchingResults& results, const int threshold) {
-    return results.maxVal > ((double) (100 - threshold) / 100);
+    return results.maxVal > getMinConfidence(threshold);
+}
+
+double Detector::getMinConfidence(int threshold) {
+    return (double) (100 - threshold) / 100;
+}
+
+bool Detector::isCandidateColorMatching(const ConditionTemplate& condition, const MatchingContext& context,
+                                        int threshold) const {
+
+    TRACE_SECTION("colorVerification");
+    if (condition.isMasked()) return isMaskedCandidateColorMatching(condition, context, threshold);
+
+    // Cheap verification first, most wrong candidates are rejected by it
+    if (getCandidateColorDiff(condition, context) >= threshold) return false;
+    if (!isHistogramColorVerificationEnabled) return true;
+
+    const cv::Mat& croppedColor = context.croppedFullSizeColor;
+    const cv::Rect candidateRoi = screenImage->toColorRoi(context.matchingResults.roi.fullSize)
+            & cv::Rect(0, 0, croppedColor.cols, croppedColor.rows);
+    if (candidateRoi.empty()) return false;
+
+    ColorHistogram candidateHistogram;
+    candidateHistogram.compute(croppedColor(candidateRoi));
+    const double histogramThreshold = std::max((double) threshold, HISTOGRAM_COLOR_DIFF_MIN_THRESHOLD);
+    return candidateHistogram.getDiff(condition.colorHistogram) < histogramThreshold;
+}
+
+bool Detector::isMaskedCandidateColorMatching(const ConditionTemplate& condition, const MatchingContext& context,
+                                              int threshold) const {
+
+    // The means of the whole candidate area include the background, only its opaque pixels are compared
+    const cv::Mat& croppedColor = context.croppedFullSizeColor;
+    const cv::Rect colorRoi = screenImage->toColorRoi(context.matchingResults.roi.fullSize);
+    if (colorRoi.empty() || (colorRoi & cv::Rect(0, 0, croppedColor.cols, croppedColor.rows)) != colorRoi) {
+        return false;
+    }
+
+    const cv::Mat candidate = croppedColor(colorRoi);
+    // A screen captured downscaled has smaller candidates than the condition
+    cv::Mat resizedMask;
+    if (condition.fullSizeMask.size() != candidate.size()) {
+        cv::resize(condition.fullSizeMask, resizedMask, candidate.size(), 0, 0, cv::INTER_NEAREST);
+    }
+    const cv::Mat& mask = resizedMask.empty() ? condition.fullSizeMask : resizedMask;
+
+    if (getColorDiff(cv::mean(candidate, mask), condition.colorMeans) >= threshold) return false;
+    if (!isHistogramColorVerificationEnabled) return true;
+
+    ColorHistogram candidateHistogram;
+    candidateHistogram.compute(candidate, mask);
+    const double histogramThreshold = std::max((double) threshold, HISTOGRAM_COLOR_DIFF_MIN_THRESHOLD);
+    return candidateHistogram.getDiff(condition.colorHistogram) < histogramThreshold;
 }
 
-double Detector::getColorDiff(const cv::Mat& image, const cv::Mat& condition) {
-    auto imageColorMeans = mean(image);
-    auto conditionColorMeans = mean(condition);
+double Detector::getCandidateColorDiff(const ConditionTemplate& condition, const MatchingContext& context) const {
+    // Computed on the first verification of the frame only, each candidate is then constant time.
+    // A screen captured downscaled is already close to the scaled size, there is no full size color to sum.
+    if (isScaledColorVerificationEnabled || screenImage->colorScale != 1.0) {
+        screenColorIntegral.update(*screenImage->fullSizeColor, screenImage->frameIndex, screenImage->scaledSize);
+
+        const cv::Rect candidateRoi = context.matchingResults.roi.scaled + context.detectionRoi.scaled.tl();
+        return getColorDiff(screenColorIntegral.getMeans(candidateRoi), condition.colorMeans);
+    }
+
+    screenColorIntegral.update(*screenImage->fullSizeColor, screenImage->frameIndex);
+
+    const cv::Rect candidateRoi = context.matchingResults.roi.fullSize + context.detectionRoi.fullSize.tl();
+    return getColorDiff(screenColorIntegral.getMeans(candidateRoi), condition.colorMeans);
+}
 
+double Detector::getColorDiff(const cv::Scalar& imageColorMeans, const cv::Scalar& conditionColorMeans) {
     double diff = 0;
     for (int i = 0; i < 3; i++) {
         diff += abs(imageColorMeans.val[i] - conditionColorMeans.val[i]);
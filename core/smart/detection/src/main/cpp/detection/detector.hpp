@@ -18,147 +18,1932 @@
 #ifndef KLICK_R_DETECTOR_HPP
 #define KLICK_R_DETECTOR_HPP
 
-#include <jni.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <tesseract/baseapi.h>
 
+#include "animated_tiles_mask.hpp"
+#include "color_integral.hpp"
+#include "condition_file.hpp"
+#include "condition_prefilter_index.hpp"
+#include "condition_tile_index.hpp"
+#include "detection_capture.hpp"
 #include "detection_image.hpp"
+#include "frame_broker.hpp"
+#include "frame_signature.hpp"
+#include "global_motion.hpp"
+#include "match_backend.hpp"
+#include "match_backend_selector.hpp"
+#include "match_memo.hpp"
+#include "matching_context.hpp"
 #include "matching_results.hpp"
-#include "../types/detection_result.hpp"
+#include "ocr_engine_pool.hpp"
+#include "ocr_preprocessor.hpp"
+#include "ocr_text_cache.hpp"
+#include "region_change_waiter.hpp"
+#include "screen_image_preparer.hpp"
+#include "screen_state_classifier.hpp"
+#include "template_cache.hpp"
+#include "text_region_proposer.hpp"
+#include "../types/cache_statistics.hpp"
+#include "../types/condition_counters.hpp"
+#include "../types/condition_result.hpp"
+#include "../types/condition_statistics.hpp"
+#include "../types/detection_request.hpp"
+#include "../types/matching_metric.hpp"
+#include "../types/memory_usage.hpp"
+#include "../types/pixels_buffer.hpp"
 #include "../types/scalable_roi.hpp"
+#include "../types/scenario_plan.hpp"
+#include "../utils/frame_pacer.hpp"
+#include "../utils/frame_telemetry.hpp"
+#include "../utils/performance_hint_session.hpp"
 #include "../utils/scaling.hpp"
+#include "../utils/thread_policy.hpp"
+#include "../utils/thread_pool.hpp"
 
 namespace smartautoclicker {
 
-    /** Detect if an image is found within another one. */
+    /** Operators between the conditions of a batch, same values as the kotlin ones. */
+    static constexpr int BATCH_OPERATOR_AND = 1;
+    static constexpr int BATCH_OPERATOR_OR = 2;
+
+    /** Returned by [Detector::detectScenario] when a plan condition can't be detected without its pixels. */
+    static constexpr int SCENARIO_PIXELS_NEEDED = -1;
+    /** Returned by [Detector::detectScenario] when the plan deadline is passed before the screen image is decided. */
+    static constexpr int SCENARIO_FRAME_EXPIRED = -2;
+    /** Maximum number of events evaluated speculatively by [Detector::detectScenario]. */
+    static constexpr int SCENARIO_MAX_SPECULATIVE_EVENTS = 8;
+
+    /** Number of screen images of the detector: the one searched by the detections, and the next one being filled. */
+    static constexpr size_t SCREEN_IMAGES_COUNT = 2;
+
+    /** Number of candidates of the coarse level refined at scaled resolution by the pyramid matching. */
+    static constexpr int PYRAMID_CANDIDATES_COUNT = 3;
+    /** Margin around a coarse candidate, in coarse pixels, searched at scaled resolution when refining it. */
+    static constexpr int PYRAMID_REFINE_MARGIN = 2;
+
+    /** Number of candidates of the sparse matching verified with the dense matching. */
+    static constexpr int SPARSE_CANDIDATES_COUNT = 5;
+    /** Margin around a sparse candidate, in scaled pixels, searched when verifying it. */
+    static constexpr int SPARSE_REFINE_MARGIN = 2;
+    /** Number of candidates of the binary matching verified with the dense matching. */
+    static constexpr int BINARY_CANDIDATES_COUNT = 5;
+    /** Margin around a binary candidate, in scaled pixels, searched when verifying it. */
+    static constexpr int BINARY_REFINE_MARGIN = 2;
+    /** Number of candidates of the chamfer matching verified with the dense matching. */
+    static constexpr int CHAMFER_CANDIDATES_COUNT = 5;
+    /** Margin around a chamfer candidate, in scaled pixels, searched when verifying it. */
+    static constexpr int CHAMFER_REFINE_MARGIN = 2;
+    /**
+     * Maximum number of screen edge pixels around a chamfer candidate found on its shape only, relative to the
+     * condition edge pixels. Above, the shape is lost in the clutter of the screen edges.
+     */
+    static constexpr double CHAMFER_MAX_CLUTTER_RATIO = 2.0;
+
+    /** Number of cells on each side of the heatmap of the positions a condition have been found at. */
+    static constexpr int FIRST_HIT_HEATMAP_SIZE = 8;
+    /**
+     * Size of the tiles of the first hit matching, in positions, as a factor of the condition size. Each tile window
+     * overlaps its neighbours by the condition size, bigger tiles keep the cost of scanning them all reasonable.
+     */
+    static constexpr int FIRST_HIT_TILE_FACTOR = 4;
+    /** Minimum size of the tiles of the first hit matching, in positions. */
+    static constexpr int FIRST_HIT_MIN_TILE_SIZE = 16;
+    /** Minimum number of tiles of the first hit matching. Below, correlating the whole area at once is cheaper. */
+    static constexpr int FIRST_HIT_MIN_TILES = 4;
+
+    /** Minimum number of hits in the heatmap of a condition before searching its learned area. */
+    static constexpr int LEARNED_AREA_MIN_HITS = 32;
+    /** The heatmap cells with less than this part of the hits of a condition are not in its learned area. */
+    static constexpr int LEARNED_AREA_NOISE_DIVISOR = 32;
+    /** Maximum part of the positions of a detection area in a learned area. Above, the complete area is searched. */
+    static constexpr double LEARNED_AREA_MAX_RATIO = 0.25;
+
+    /** Maximum size difference between an exact detection area and its condition, in scaled pixels. */
+    static constexpr int EXACT_AREA_MAX_MARGIN = 1;
+    /** Maximum jitter around an exact area, in scaled pixels, see [Detector::setExactMatchingJitter]. */
+    static constexpr int EXACT_MATCHING_MAX_JITTER = 8;
+    /**
+     * Maximum number of positions on each axis of a detection area for the direct matching. Covers the exact areas
+     * with their jitter.
+     */
+    static constexpr int DIRECT_MATCHING_MAX_POSITIONS = EXACT_MATCHING_MAX_JITTER * 2 + EXACT_AREA_MAX_MARGIN + 1;
+
+    /**
+     * Margin added to the gray mean difference rejecting a position in the prefiltering, as the scaled gray image and
+     * the condition color means are not computed from the same pixels.
+     */
+    static constexpr double PREFILTER_MEAN_MARGIN = 4;
+    /** Cost of the prefiltering of a position, in the [MatchBackend::getCost] unit. */
+    static constexpr double PREFILTER_POSITION_COST = 8;
+
+    /**
+     * Minimum cost of a single condition matching split in bands of results between the [ThreadPool] workers, in the
+     * [MatchBackend::getCost] unit. Below it, dispatching the bands costs more than it saves.
+     */
+    static constexpr double RESULT_BANDS_MIN_COST = 1e7;
+    /** Minimum number of results rows of each band, the template rows overlapping two bands are correlated twice. */
+    static constexpr int RESULT_BAND_MIN_ROWS = 16;
+
+    /** Maximum threshold of the conditions searched by their exact pixels, see [Detector::matchExactPixels]. */
+    static constexpr int EXACT_PIXEL_MATCHING_MAX_THRESHOLD = 1;
+
+    /** Maximum number of candidates of a text condition recognized by the OCR engine. */
+    static constexpr int OCR_MAX_CANDIDATES = 10;
+    /** Returned by [Detector::recognizeTextCandidates] when the OCR engine can't be initialized. */
+    static constexpr int OCR_ENGINE_MISSING = -2;
+    /** Text areas up to this height, in full size pixels, are a single line recognized as a whole. */
+    static constexpr int OCR_SINGLE_LINE_AREA_MAX_HEIGHT = 96;
+    /** The size of the image matched by [Detector::prewarm]. */
+    static constexpr int PREWARM_IMAGE_SIZE = 32;
+
+    /** Maximum number of orientations of a condition, see [Detector::setConditionRotations]. */
+    static constexpr int CONDITION_MAX_ROTATIONS = 36;
+
+    /** Histogram color differences below this are always accepted, the screen rendering spreads colors on close bins. */
+    static constexpr double HISTOGRAM_COLOR_DIFF_MIN_THRESHOLD = 20;
+
+    /** Margin around the previous match of a condition, in scaled pixels, re-verified when its tiles are unchanged. */
+    static constexpr int HISTORY_NEIGHBOURHOOD_MARGIN = FrameSignature::TILE_SIZE / 2;
+    /**
+     * Minimum margin around the previous match of a moving condition, in scaled pixels. The window searched before the
+     * complete detection area is at least the condition size on each side.
+     */
+    static constexpr int TRACKING_MIN_MARGIN = FrameSignature::TILE_SIZE;
+    /**
+     * Maximum part of the detection area searched in the parts exposed by a scroll, for a condition not found on the
+     * previous screen image. Above, the complete detection area is searched.
+     */
+    static constexpr double GLOBAL_MOTION_MAX_SEARCH_RATIO = 0.5;
+
+    /**
+     * Duration a memory pressure level is kept without being reported again, in nanoseconds. The caches then regrow
+     * by one level, and by one more after each following period.
+     */
+    static constexpr int64_t MEMORY_PRESSURE_HOLD_NANOS = 30000000000;
+
+    /** Target frame duration reported to the performance hint session without frame pacing, 30 frames per second. */
+    static constexpr int64_t PERFORMANCE_HINT_DEFAULT_TARGET_NANOS = 1000000000 / 30;
+
+    /**
+     * Detect if an image is found within another one.
+     * The images are RGBA pixels provided by the caller, the detector doesn't depend on the JNI and can be used outside
+     * of the application, such as by the native benchmark. See [JniDetector] for the java detector adapter.
+     */
     class Detector {
 
+        /** The native benchmark drives the matching steps directly, without the JNI. */
+        friend class DetectorBenchmark;
+        /** The native replay of a [DetectionCapture] drives the matching steps the same way. */
+        friend class DetectionReplay;
+        /** The native sweep of the detection options over a corpus drives them the same way. */
+        friend class DetectionSweep;
+        /** The native scaling benchmark on synthetic workloads drives them the same way. */
+        friend class ScalingBenchmark;
+
     private:
         /** Tag for the Android logcat. */
         static constexpr char const* LOG_TAG = "Detector";
 
         /** Manages the scaling ratio for the processing depending on the scenario quality and screen size.*/
         ScaleRatioManager scaleRatioManager = ScaleRatioManager();
+        /** The size of the screen from the last screen metrics, the full size of the screen images. */
+        cv::Size screenSize = cv::Size(0, 0);
+
+        /** The distances of the system bars and display cutout to the edges of the screen, in full size pixels. */
+        struct ScreenInsets {
+            int left = 0;
+            int top = 0;
+            int right = 0;
+            int bottom = 0;
+        };
+        /** The insets excluded from the detections on the whole screen, see [setScreenInsets]. */
+        ScreenInsets screenInsets = ScreenInsets();
+        /** The detection quality from the last screen metrics, reported in the condition statistics. */
+        int64_t screenDetectionQuality = 0;
+        /** The metrics tag from the last screen metrics, for the scale ratios of the detection quality tuning. */
+        std::string screenMetricsTag;
+
+        /**
+         * The screen images. The front one, [screenImage], is read by the matchings, while the next screen image is
+         * filled in a back one. The front image is never written, even by a concurrent preparation. Shared with the
+         * other detectors through the [FrameBroker] while it is the front one.
+         */
+        std::array<std::shared_ptr<DetectionImage>, SCREEN_IMAGES_COUNT> screenImages = {
+                std::make_shared<DetectionImage>(), std::make_shared<DetectionImage>() };
+        /** The index in [screenImages] of the last one set as the front image. */
+        size_t frontScreenImageIndex = 0;
+        /** The image published by another detector, when it is the current screen image. Kept while it is read. */
+        std::shared_ptr<DetectionImage> brokerScreenImage;
+        /**
+         * Details of the current screen image, the front one in [screenImages] or [brokerScreenImage]. Conditions will
+         * be search in it.
+         */
+        DetectionImage* screenImage = screenImages[0].get();
+        /** Processes the next screen image in a back buffer, while the conditions are searched in [screenImage]. */
+        ScreenImagePreparer screenImagePreparer = ScreenImagePreparer();
+        /** The signature of [screenImage], allowing to know when the screen content haven't changed. */
+        FrameSignature screenSignature = FrameSignature();
+        /** The shift of the content of [screenImage] since the previous one, with the motion compensation. */
+        GlobalMotion globalMotion = GlobalMotion();
+        /** The tiles of [screenSignature] whose changes don't make the screen changed, outside of [planTileIndex]. */
+        AnimatedTilesMask animatedTilesMask = AnimatedTilesMask();
+        /** The states of the application the screen images have been classified in, see [classifyScreenState]. */
+        ScreenStateClassifier screenStates = ScreenStateClassifier();
+        /** Wakes the caller of [waitForRegionChange] from the changes of [screenSignature]. */
+        RegionChangeWaiter regionChangeWaiter;
+        /** The color sums of [screenImage], for the color verification of the candidates. Computed lazily per frame. */
+        mutable ColorIntegral screenColorIntegral = ColorIntegral();
+        /** The preprocessed condition images to search in [screenImage]. */
+        TemplateCache templateCache = TemplateCache();
+        /** Records the last screen images and their image conditions detections, when enabled. */
+        DetectionCapture detectionCapture = DetectionCapture();
+        /** Measures the cost of each screen image detection, and computes the delay to wait before the next one. */
+        FramePacer framePacer = FramePacer();
+        /** The records of the last detected screen images, updated by the matchings of the workers. */
+        mutable FrameTelemetry frameTelemetry;
+        /**
+         * The results of the conditions reused from a previous matching, on the same or on an unchanged area. Never
+         * evicted, they are replaced by the next matching of their condition.
+         */
+        mutable CacheStatistics frameDiffStatistics;
+        /** The scheduling policy of the detection threads, the workers of [threadPool] and the calling threads. */
+        ThreadPolicy threadPolicy = ThreadPolicy();
+        /** True to report the cost of each frame to a [performanceHintSession]. */
+        bool isPerformanceHintEnabled = false;
+        /** Reports the frame costs to the system, opened on the first frame completed once enabled. */
+        PerformanceHintSession performanceHintSession = PerformanceHintSession();
+        /** The memory the detector degrades to fit in, in bytes. 0 if unbounded. */
+        size_t memoryBudget = 0;
+        /** True while the memory needed by the detection alone exceeds [memoryBudget], to log it once. */
+        bool isOverMemoryBudget = false;
+        /** The [MemoryPressure] reported by the system, applied on the next screen image. -1 if none is pending. */
+        std::atomic<int> requestedMemoryPressure = -1;
+        /** The [MemoryPressure] the caches are shed for. Read by the matchings and the screen image preparation. */
+        std::atomic<int> memoryPressure = MEMORY_PRESSURE_NONE;
+        /** The time [memoryPressure] was last reported or lowered, from [FramePacer::getTimeNanos]. */
+        int64_t memoryPressureNanos = 0;
+        /** The time each condition matching degrades to fit in, in nanoseconds. 0 if unbounded. */
+        int64_t conditionTimeBudgetNanos = 0;
+
+        /** True to match the conditions coarse to fine, false to match on the whole scaled image. */
+        bool isPyramidMatchingEnabled = false;
+        /** True to rank the positions with the informative pixels of the conditions first, when they have some. */
+        bool isSparseMatchingEnabled = false;
+        /** True to rank the positions with the bits of the high contrast conditions first, when they have some. */
+        bool isBinaryMatchingEnabled = false;
+        /** True to rank the positions with the edges of the shaped conditions first, when they have some. */
+        bool isChamferMatchingEnabled = false;
+        /** True to reuse the matchings of the previous screen image at their shifted position on scrolls. */
+        bool isMotionCompensationEnabled = false;
+        /** True to search the conditions usually found where they have been found before, tile by tile. */
+        bool isFirstHitMatchingEnabled = false;
+        /** True to search the conditions in the part of their detection area they are usually found in first. */
+        bool isLearnedAreaMatchingEnabled = false;
+        /** True to prefilter the plan conditions and rank the text candidates, see [prefilterPlanConditions]. */
+        bool isConditionPrefilterEnabled = false;
+        /** True to snap the scale ratio to the integer downscale factors close to it, see [ScaleRatioManager]. */
+        bool isIntegerScaleRatioEnabled = false;
+        /** Set from any thread by [setDetectionCancelled], stopping the running detection as soon as possible. */
+        std::atomic<bool> isDetectionCancelled = false;
+        /** The resize factors of the conditions tried when they are not found at their size. Empty to disable. */
+        std::vector<double> templateScales;
+        /** The margin added around the exact detection areas, in full size pixels. 0 to search the exact position. */
+        int exactMatchingJitter = 0;
+        /** True to search the conditions with a threshold demanding near exact pixels with their exact pixels only. */
+        bool isExactPixelMatchingEnabled = false;
+        /** True to also compare the color histograms of the candidates passing the color means verification. */
+        bool isHistogramColorVerificationEnabled = false;
+        /** True to compare the color means of the candidates on the screen image downscaled at the scale ratio. */
+        bool isScaledColorVerificationEnabled = false;
+        /** Chooses the backend computing the results of each condition matching. Integer and GPU ones are opt-in. */
+        MatchBackendSelector matchBackends = MatchBackendSelector();
+        /** The jobs of the current batch backend computation. Kept between detections to avoid allocations. */
+        std::vector<MatchBackend::Job> backendJobs;
+
+        /** The configuration of the OCR engines used for the text conditions. */
+        OcrEnginePool::Config ocrConfig = OcrEnginePool::Config();
+        /** The texts recognized on the previous screen images, avoiding to recognize an unchanged area again. */
+        OcrTextCache ocrTextCache = OcrTextCache();
+        /** Protects the [ocrTextCache] while the workers of a parallel batch are matching text conditions. */
+        std::mutex ocrTextCacheMutex;
+        /** The OCR engine of each [threadPool] worker, only leased during the concurrent recognition. */
+        std::vector<OcrEnginePool::Lease> workerOcrEngines;
 
-        /** Details of the current screen image. [conditionImage] will be search in it. */
-        DetectionImage screenImage = DetectionImage();
-        /** Details of the image to detect in [screenImage]. */
-        DetectionImage conditionImage = DetectionImage();
-        /** The region of [screenImage] in which [conditionImage] will be searched. */
-        ScalableRoi detectionRoi = ScalableRoi();
+        /** The last threshold matching of a condition, reused while the screen tiles it depends on are unchanged. */
+        struct MatchHistory {
+            bool isValid = false;
+            /** The index of the screen image this result applies to, from [FrameSignature::getFrameIndex]. */
+            uint64_t frameIndex = 0;
+            /** The area the condition was searched in, in scaled screen coordinates. */
+            cv::Rect detectionRoi = cv::Rect();
+            int threshold = 0;
+            /** The area of the best candidate, in scaled screen coordinates. */
+            cv::Rect matchRoi = cv::Rect();
+            /** The resize factor of the condition for the best candidate, from [templateScales]. */
+            double templateScale = 1.0;
+            /** The number of orientations the condition is searched at, from [conditionRotations]. */
+            int rotationCount = 1;
+            /** The similarity the condition is matched with, from [conditionMetrics]. */
+            MatchingMetric metric = MatchingMetric::CCOEFF_NORMED;
+            ConditionResult result = ConditionResult();
+            /**
+             * True once the condition have been found at another position than on the previous screen image, until it
+             * is not found anymore. It is then searched around its previous match first, even if those tiles changed.
+             */
+            bool isTracking = false;
+            /** For a text in area condition, the area its [textLines] have been located in, in scaled coordinates. */
+            cv::Rect textArea = cv::Rect();
+            /** For a text in area condition, the text lines of its area in reading order, relative to [textArea]. */
+            std::vector<cv::Rect> textLines;
+            /**
+             * The number of times the condition have been found in each cell of [heatmapRoi], row by row, halved when
+             * one of them saturates. Reset when the detection area changes.
+             */
+            std::array<uint16_t, FIRST_HIT_HEATMAP_SIZE * FIRST_HIT_HEATMAP_SIZE> hitHeatmap {};
+            /** The detection area of [hitHeatmap], in scaled screen coordinates. */
+            cv::Rect heatmapRoi = cv::Rect();
+            /**
+             * The index of the last screen image whose changes don't touch the condition area, according to the
+             * [planTileIndex]. Its result on the previous screen image is still valid on this one.
+             */
+            uint64_t unchangedFrameIndex = 0;
+            /**
+             * The index of the last screen image the condition have been proven absent on by the
+             * [planPrefilterIndex], for the [absentRoi] and [absentThreshold] search.
+             */
+            uint64_t absentFrameIndex = 0;
+            /** The detection area of the proof of [absentFrameIndex], in scaled screen coordinates. */
+            cv::Rect absentRoi = cv::Rect();
+            /** The threshold of the proof of [absentFrameIndex]. */
+            int absentThreshold = 0;
+            /** The durations of the recent matchings of the condition, since the last matching configuration change. */
+            ConditionStatistics statistics = ConditionStatistics();
+            /**
+             * The duration of the last matching of the condition that wasn't degraded, to degrade the next one before
+             * it exceeds the time budget. Halved at each degraded matching, so a complete one is tried again.
+             */
+            int64_t completeMatchingNanos = 0;
+#ifdef SMART_DETECTION_TRACING
+            /** The counters of all matchings of the condition, since the last matching configuration change. */
+            ConditionCounters counters = ConditionCounters();
+#endif
+        };
 
-        /** The results of the OpenCv template matching. */
-        MatchingResults matchingResults = MatchingResults();
-        /** The results of the condition detection. */
-        DetectionResult detectionResult = DetectionResult();
+        /** The last matching of each condition, keyed by condition identifier. Get them with [getMatchHistory]. */
+        std::unordered_map<int64_t, MatchHistory> matchHistories;
+        /** The number of orientations of the rotation tolerant conditions, keyed by condition identifier. */
+        std::unordered_map<int64_t, int> conditionRotations;
+        /** The similarity of the conditions not matched with the correlation, keyed by condition identifier. */
+        std::unordered_map<int64_t, MatchingMetric> conditionMetrics;
+        /** The matchings of the current screen image, shared by the conditions with the same template. */
+        mutable MatchMemo matchMemo = MatchMemo();
 
-        /** Tesseract OCR engine */
-        tesseract::TessBaseAPI *tessBaseAPI;
+        /** A condition of a batch, prepared on the calling thread before being matched by the workers. */
+        struct BatchCondition {
+            const ConditionTemplate* conditionTemplate = nullptr;
+            MatchHistory* history = nullptr;
+            ScalableRoi detectionRoi = ScalableRoi();
+            int threshold = 0;
+            bool shouldBeDetected = true;
+            bool isFeatureMatching = false;
+            /** The text to recognise, or null for a threshold matching. */
+            const std::string* identifying = nullptr;
+            const OcrOptions* ocrOptions = nullptr;
+            /** True to recognize the text of the area directly, [conditionTemplate] is then null. */
+            bool isTextInArea = false;
+            /** True if the anchor of the condition isn't detected, it is then not detected either. */
+            bool isAnchorMissing = false;
+            /** True if other conditions of the batch are searched in the same area, sharing its preprocessing. */
+            bool isAreaShared = false;
+            /** The results computed by the batch backend for this condition. Empty if it must be matched otherwise. */
+            cv::Mat backendResults = cv::Mat();
+        };
 
         /**
-         * Check if the provided condition is found in the current screen image.
-         * The screen image should be set with [setScreenImage], and the detection roi should be up to date before
-         * executing this method.
+         * The conditions of the last detected plan, one column per value. The passes over all conditions of each screen
+         * image read contiguous values only, instead of the requests and the history map.
+         */
+        struct PlanConditionTable {
+            /** The [ScenarioPlan::revision] the table have been built for, 0 if it is not built. */
+            uint64_t revision = 0;
+            std::vector<int64_t> conditionIds;
+            std::vector<int> thresholds;
+            /** The PLAN_CONDITION_* flags of each condition. */
+            std::vector<uint8_t> flags;
+            /** The history of each condition, null until it is matched once. Reset with the histories. */
+            std::vector<MatchHistory*> histories;
+            /** 1 if the event of the condition is scheduled for the current screen image, 0 if it is skipped. */
+            std::vector<uint8_t> isScheduled;
+        };
+        /** Flags of [PlanConditionTable::flags]. */
+        static constexpr uint8_t PLAN_CONDITION_TEXT = 1 << 0;
+        static constexpr uint8_t PLAN_CONDITION_TEXT_IN_AREA = 1 << 1;
+        static constexpr uint8_t PLAN_CONDITION_FEATURES = 1 << 2;
+        static constexpr uint8_t PLAN_CONDITION_ANCHORED = 1 << 3;
+
+        /** An event evaluated speculatively, updated concurrently by the workers matching its conditions. */
+        struct SpeculativeEvent {
+            /** Lowest index in the event of a condition deciding the operator result, the condition count if none. */
+            std::atomic<int> decidingIndex = 0;
+            /** The number of conditions matched with a fulfilled result. */
+            std::atomic<int> fulfilledCount = 0;
+        };
+
+        /** The threads matching the conditions of a batch concurrently. Null if the device have a single core. */
+        std::unique_ptr<ThreadPool> threadPool = nullptr;
+        /** The matching scratch state for single condition detection and serial batches. */
+        MatchingContext mainContext = MatchingContext();
+        /**
+         * The matching scratch state of each [threadPool] worker. Also used for the bands of a [mainContext]
+         * matching, see [matchInBands].
+         */
+        mutable std::vector<MatchingContext> workerContexts;
+        /** The size of the scratch arena of each matching context, for the current screen metrics. */
+        size_t scratchArenaSize = 0;
+        /** The conditions of the batch being detected. Kept between batches to avoid allocations. */
+        std::vector<BatchCondition> batchConditions;
+        /** The conditions of the scenario event being detected, and their results. Kept to avoid allocations. */
+        std::vector<DetectionRequest> eventRequests;
+        std::vector<ConditionResult> eventResults;
+        /** The index of the event of each condition detected by [detectEventsSpeculative]. */
+        std::vector<int> speculativeEventIndexes;
+        /** The conditions of the plan with the areas derived from their anchor detection, see [resolveAnchors]. */
+        std::vector<DetectionRequest> anchoredRequests;
+        /** The detection of each anchor of the plan on the current screen image, at the index of its condition. */
+        std::vector<ConditionResult> anchorResults;
+        /** True for the plan conditions whose [anchorResults] is set for the current screen image. */
+        std::vector<bool> isAnchorDetected;
+        /** The conditions of the last detected plan, see [updatePlanConditions]. */
+        PlanConditionTable planConditions;
+        /** The screen tiles touched by each condition of the last detected plan, see [markUnchangedConditions]. */
+        ConditionTileIndex planTileIndex;
+        /** The indexed area of each condition of the plan. Kept to avoid allocations when rebuilding the index. */
+        std::vector<cv::Rect> planTileAreas;
+        /** The plan conditions searched in the same areas, see [prefilterPlanConditions]. */
+        ConditionPrefilterIndex planPrefilterIndex;
+        /** The detection area of each condition of the [planPrefilterIndex], in scaled screen coordinates. */
+        std::vector<cv::Rect> planPrefilterAreas;
+        /** True for each plan condition that must be matched on the current screen image. */
+        std::vector<bool> isPlanConditionNeeded;
+        /** The plan conditions proven absent on the current screen image by the [planPrefilterIndex]. */
+        std::vector<int> planAbsentConditions;
+
+        /**
+         * @return the full size of a screen buffer: [screenSize] if the buffer is smaller because the screen is
+         *         captured downscaled, the buffer size if not.
+         */
+        cv::Size getScreenFullSize(int width, int height) const;
+        /**
+         * @return the screen image following the front one in [screenImages], the next one to be filled. Replaced by
+         *         a new image if another detector is still reading it.
+         */
+        DetectionImage& getBackScreenImage();
+        /**
+         * Set the filled back screen image as the front one, updating [screenSignature] with its content, and start
+         * the [framePacer] frame that began at [startNanos].
+         *
+         * @param frameKey the key to publish the image with in the [FrameBroker], null to keep it for this detector.
+         */
+        bool swapScreenImages(DetectionImage& image, int64_t startNanos, const FrameBroker::Key* frameKey = nullptr);
+        /**
+         * Set an image published by another detector as the front one, updating [screenSignature] with its content,
+         * and start the [framePacer] frame that began at [startNanos]. The image is only read.
+         */
+        bool useBrokerScreenImage(std::shared_ptr<DetectionImage> image, int64_t startNanos);
+        /** Start the frame of a new front screen image, once [screenImage] is set. */
+        void onScreenImageSet(bool isUnchanged, int64_t startNanos);
+        /**
+         * Update [screenSignature] with a new screen image, from its tile hashes when they have been computed during
+         * its processing.
+         *
+         * @return true if the image is identical to the previous one.
+         */
+        bool updateScreenSignature(DetectionImage& image);
+
+        /** Report the cost of the last completed frame to the [performanceHintSession], opening it if needed. */
+        void reportFrameCost();
+
+        /**
+         * Replay the [detectionCapture] image conditions detections from an empty detector state, with the matching
+         * options of this detector, at another detection quality.
+         *
+         * @param quality the detection quality of the replay.
+         * @param results receives the result of each captured detection, frame after frame. Not captured conditions
+         *                are never detected.
+         */
+        void replayCapture(double quality, std::vector<ConditionResult>& results) const;
+
+        /** @return the memory held by this detector, by category. */
+        MemoryUsage computeMemoryUsage() const;
+        /**
+         * Degrade the caches to fit in the [memoryBudget]: the template cache gets what remains once the memory of
+         * the other categories is counted, and the recognized texts are dropped if nothing remains.
+         */
+        void enforceMemoryBudget();
+        /**
+         * Apply the reported memory pressure, or lower it by a level once it was held long enough, and shed the
+         * caches for it. Called between two screen images, when no template is referenced.
+         */
+        void updateMemoryPressure();
+        /** Change the [memoryPressure], logging the shed or regrown caches. */
+        void setMemoryPressureLevel(int pressure);
+
+        /**
+         * Get the template for a condition from the cache, processing the condition pixels if needed.
+         * Must be called from the thread calling the detector.
+         */
+        const ConditionTemplate* getTemplate(int64_t conditionId, const PixelsBuffer* conditionPixels);
+
+        /**
+         * Search a condition template in the screen image, in the roi defined in the context.
+         * Do not modify the detector state, and can be called concurrently with different contexts.
          *
-         * @param env current java env.
-         * @param conditionImage the image to search in the screen
+         * @param conditionTemplate the condition to search.
+         * @param context the matching scratch state, with the detection roi set.
          * @param threshold the detection threshold, expressed in [0..1].
+         * @param scaleRatio the current scale ratio.
+         * @param history the previous matching of this condition. Reused if the screen tiles it depends on haven't
+         *                changed, and updated with the new matching.
+         * @param isFeatureMatching true to search the condition with [matchFeatures] instead of its pixels.
+         * @param isAbsenceExpected true if the condition should not be detected. Its absence is then first proven
+         *                          with [proveAbsence], before any correlation.
+         *
+         * @return the results of the detection.
          */
-        void match(JNIEnv *env, jobject conditionImage, int threshold);
+        ConditionResult matchTemplate(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                                      int threshold, double scaleRatio, MatchHistory& history,
+                                      bool isFeatureMatching, bool isAbsenceExpected = false) const;
 
-        void match(JNIEnv *env, jobject conditionImage, std::string identifying);
+        /**
+         * Get the learned area of a condition: the part of its detection area covered by the heatmap cells with most
+         * of its hits.
+         *
+         * @param history the history of the condition.
+         * @param detectionRoi the detection area of the condition, in scaled screen coordinates.
+         * @param conditionSize the size of the condition, in scaled pixels.
+         * @param area set to the learned area, in scaled screen coordinates.
+         *
+         * @return false if the condition has no learned area: it haven't been found enough times in this detection
+         * area, or it is found in too much of it for the learned area to be worth searching first.
+         */
+        static bool getLearnedArea(const MatchHistory& history, const cv::Rect& detectionRoi,
+                                   const cv::Size& conditionSize, cv::Rect& area);
 
-        /** Verify if the matching result is above the provided threshold. */
-        static bool isResultAboveThreshold(const MatchingResults& results, int threshold);
-        /** Get the percentage of color difference between two images. Result is expressed in [0..1]. */
-        static double getColorDiff(const cv::Mat& image, const cv::Mat& condition);
+        /** Add a position the condition have been found at to its [MatchHistory::hitHeatmap]. */
+        static void addHeatmapHit(MatchHistory& history, const cv::Rect& detectionRoi, const cv::Rect& matchRoi);
 
+        /**
+         * @param position a matching position, relative to the detection area.
+         * @param positionsSize the number of matching positions of the detection area on each axis.
+         *
+         * @return the index of the cell of the position in the [MatchHistory::hitHeatmap].
+         */
+        static int getHeatmapCell(const cv::Point& position, const cv::Size& positionsSize);
 
-    public:
+        /** Set the history of a condition with a matching on the screen image with the provided index. */
+        static void setHistory(MatchHistory& history, uint64_t frameIndex, const cv::Rect& detectionRoi, int threshold,
+                               const MatchMemo::Entry& matching);
 
         /**
-         * Initialize the detector.
+         * Search a condition only around its previous match, when those screen tiles are unchanged. For a tracked
+         * condition, a wider window around it is searched if they have changed.
          *
-         * @param env current java env.
-         * @param results the result java object to update upon [detectCondition] calls.
+         * @return true if the condition is still found there, false if a complete matching is required.
          */
-        void initialize(JNIEnv *env, jobject results);
+        bool matchHistoryNeighbourhood(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                                       int threshold, double scaleRatio, const MatchHistory& history) const;
 
         /**
-         * Release the detector.
+         * Reuse the matching of a condition on the previous screen image when the screen content moved since, see
+         * [GlobalMotion]. A condition found on it is found at its shifted position if its content moved with the
+         * screen. A condition not found on it is only searched at the positions touching the exposed parts of the
+         * detection area. The matching results of the context are updated with the found position, or with the best
+         * candidate.
+         *
+         * @param isFound set to true if the condition is found.
          *
-         * @param env current java env.
+         * @return false if the screen content didn't move, or if a complete matching is required.
          */
-        void release(JNIEnv *env);
+        bool matchGlobalMotion(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                               double scaleRatio, const MatchHistory& history, bool& isFound) const;
 
         /**
-         * Determine the scale ratio depending on the screen size.
-         * We reduce the size to improve the processing time, but we don't want it to be too small because it will impact
-         * the performance of the detection. In order to detect correctly, this should be called everytime the screen is
-         * resized or rotated.
+         * Search a condition in a window of the detection area. The matching results of the context are updated with
+         * the best candidate in it.
          *
-         * @param env current java env.
-         * @param metricsTag the debugging tag for logging.
-         * @param screenBitmap the bitmap containing what's currently displayed on the screen. Used for sizing purposes.
-         * @param detectionQuality the quality of the detection.
+         * @param window the area to search in, in scaled screen coordinates, contained by the detection area.
+         *
+         * @return true if the best candidate is validated, false if not.
          */
-        void setScreenMetrics(JNIEnv *env, jstring metricsTag, jobject screenBitmap, double detectionQuality);
+        bool matchWindow(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                         int threshold, double scaleRatio, const cv::Rect& window) const;
 
         /**
-         * Set the image where all following detection requests via [detectCondition] will search in.
+         * Search the best candidate in the whole cropped scaled image, until one is validated or the threshold is not
+         * reached anymore. The matching results of the context are updated with the last candidate.
          *
-         * @param env current java env.
-         * @param screenBitmap the debugging tag for logging.
+         * @return true if the condition is found, false if not.
          */
-        void setScreenImage(JNIEnv *env, jobject screenBitmap);
+        bool matchSingleScale(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                              int threshold, double scaleRatio) const;
 
         /**
-         * Check if the provided image is contained in the image defined with [setScreenImage].
-         * [detectionResult] structure will be updated accordingly.
+         * Compute the results of a request with a backend. The results of a costly [mainContext] request are split in
+         * horizontal bands computed concurrently by the [threadPool] workers, each one writing its own rows of the
+         * results, so a single big condition doesn't keep the other cores idle. The candidates are then extracted
+         * from the complete results, as if they were computed at once.
          *
-         * @param env current java env.
-         * @param conditionImage the image to search.
-         * @param threshold the minimum detection confidence to consider the detection position.
+         * @param backend the backend selected for the request.
+         * @param request the matching to compute.
+         * @param context the matching context of the request.
+         * @param results the matching results, already allocated to [MatchRequest::getResultsSize].
          */
-        void detectCondition(JNIEnv *env, jobject conditionImage, int threshold);
+        void matchInBands(const MatchBackend& backend, const MatchRequest& request, MatchingContext& context,
+                          cv::Mat& results) const;
 
         /**
-         * Check if the provided image is contained in the image defined with [setScreenImage].
-         * [detectionResult] structure will be updated accordingly.
+         * Verify the colors of the candidates extracted in the matching results of the context, best first, until one
+         * is validated or none is left. The matching results of the context are updated with the last candidate.
          *
-         * @param env current java env.
-         * @param conditionImage the image to search.
-         * @param identifying the recognised information to consider the detection position.
+         * @return true if a candidate is validated, false if not.
          */
-        void detectCondition(JNIEnv *env, jobject conditionImage, std::string identifying);
+        bool verifyCandidates(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                              int threshold, double scaleRatio) const;
 
         /**
-         * Check if the provided image is contained in a specific area within the image defined with [setScreenImage].
-         * [detectionResult] structure will be updated accordingly.
-         *
-         * @param env current java env.
-         * @param conditionImage the image to search.
-         * @param x the left position of the area to search in.
-         * @param y the top position of the area to search in.
-         * @param width the width of the area to search in.
-         * @param height the height of the area to search in.
-         * @param threshold the minimum detection confidence to consider the detection position.
+         * Match a condition with transparent pixels on its opaque pixels only, with its
+         * [ConditionTemplate::maskedGray]. The background around an irregular condition is not part of it, and doesn't lower its confidence.
+         *
+         * @return true if the condition is found, false if not.
          */
-        void detectCondition(JNIEnv *env, jobject conditionImage, int x, int y, int width, int height, int threshold);
+        bool matchMasked(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                         int threshold, double scaleRatio) const;
 
         /**
-         * Check if the provided image is contained in a specific area within the image defined with [setScreenImage].
-         * [detectionResult] structure will be updated accordingly.
-         *
-         * @param env current java env.
-         * @param conditionImage the image to search.
-         * @param x the left position of the area to search in.
-         * @param y the top position of the area to search in.
-         * @param width the width of the area to search in.
-         * @param height the height of the area to search in.
-         * @param identifying the recognised information to consider the detection position.
+         * Match a condition with another [MatchingMetric] than the correlation, with the [DifferenceMatcher]. Its
+         * candidates are verified as the correlation ones, the threshold having the same meaning for all metrics.
+         *
+         * @return true if the condition is found, false if not.
+         */
+        bool matchDifference(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                             int threshold, double scaleRatio, MatchingMetric metric) const;
+
+        /**
+         * Set the coarse level of the detection area of the context: a view on the blocks of the screen pyramid level
+         * starting in the area, never resized for a single condition. Computed in the context scratch arena only when
+         * the area is not in the screen image.
+         *
+         * @param factor the downscale factor of the coarse level, the one of the matched condition.
+         *
+         * @return the position of the coarse level origin in the detection area, in scaled pixels.
+         */
+        cv::Point getCoarseScaledGray(MatchingContext& context, int factor) const;
+
+        /**
+         * Search the best candidates in the coarse level of the image pyramid, and refine them at scaled resolution
+         * around their position only. The matching results of the context are updated with the best refined candidate.
+         * Each condition is searched at its own level, the cheapest one keeping enough of its details.
+         *
+         * @param isFound set to true if the condition is found, false if not.
+         *
+         * @return false if the condition or the detection area are too small for the pyramid matching.
+         */
+        bool matchPyramid(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                          int threshold, double scaleRatio, bool& isFound) const;
+
+        /**
+         * Correlate the detection area tile by tile, starting with the tiles where the condition has been found the
+         * most, and stop at the first tile with a detection. The condition history heatmap gives the tiles order.
+         * The matching results of the context are updated with the detection, or the best result of all tiles.
+         *
+         * @param isFound set to true if the condition is found.
+         *
+         * @return false if the first hit matching can't be used: the condition isn't found regularly in this detection
+         * area, the area is too small to be split in tiles, or a tile best position only fails the color verification
+         * and the other positions of the tile must be checked by the complete matching.
+         */
+        bool matchFirstHit(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                           double scaleRatio, const MatchHistory& history, bool& isFound) const;
+
+        /**
+         * Search the condition in its learned area only, see [getLearnedArea]. The matching results of the context
+         * are updated with the best candidate in it. On a miss, the heatmap of the condition decays: a condition
+         * that is no longer found there loses its learned area after a few misses, and the complete detection area
+         * is searched again until it is learned anew.
+         *
+         * @return true if the condition is found in its learned area, false if it has none or isn't found in it.
+         */
+        bool matchLearnedArea(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                              double scaleRatio, MatchHistory& history) const;
+
+        /**
+         * Match the condition with its informative pixels only, then verify the best positions with the dense
+         * matching. The matching results of the context are updated with the best verified candidate.
+         *
+         * @param isFound set to true if the condition is found.
+         *
+         * @return false if the condition has no informative pixels for the sparse matching.
+         */
+        bool matchSparse(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                         int threshold, double scaleRatio, bool& isFound) const;
+
+        /**
+         * Match the bits of the high contrast condition binarized with an adaptive threshold, then verify the best
+         * positions with the dense matching. The matching results of the context are updated with the best verified
+         * candidate.
+         *
+         * @param isFound set to true if the condition is found.
+         *
+         * @return false if the condition has no bits for the binary matching.
+         */
+        bool matchBinary(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                         int threshold, double scaleRatio, bool& isFound) const;
+
+        /**
+         * Match the edge points of the condition with the edge distances of the screen, then verify the best positions
+         * with the dense matching. If none is verified, the best position is still found when its shape alone is above
+         * the threshold and is not lost in the screen edges, for the recolored conditions. The matching results of the
+         * context are updated with the found position, or with the best verified candidate.
+         *
+         * @param isFound set to true if the condition is found.
+         *
+         * @return false if the condition has no edge points for the chamfer matching.
+         */
+        bool matchChamfer(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                          int threshold, double scaleRatio, bool& isFound) const;
+
+        /**
+         * Verify the best positions of a ranking of the cropped detection area with the dense matching, best first,
+         * until one is validated. The matching results of the context are updated with the best verified candidate.
+         *
+         * @param ranking the ranking of each position, in the cv::matchTemplate results size. Changed by the call.
+         * @param candidateCount the maximum number of positions to verify.
+         * @param refineMargin the margin around each position searched when verifying it, in scaled pixels.
+         *
+         * @return true if a candidate is validated, false if not.
+         */
+        bool verifyRankedCandidates(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                                    int threshold, double scaleRatio, cv::Mat& ranking, int candidateCount,
+                                    int refineMargin) const;
+
+        /**
+         * Correlate the condition only at the positions whose window mean and variance allow a detection, when it is
+         * cheaper than computing all results with the match backend. The other results are set to 0.
+         *
+         * A window mean too far from the condition one can't pass the color verification: the sum of the color
+         * channel differences is above the gray difference. A window without variance has a null correlation.
+         *
+         * @param backendCost the cost of the results with the backend selected for this matching.
+         *
+         * @return true if the results have been computed in [MatchingResults::initResults], false if the backend
+         *         must compute them.
+         */
+        bool matchPrefiltered(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                              double backendCost) const;
+
+        /**
+         * Prove that a condition can't be detected in the detection area of the context, with the same window
+         * statistics bounds as [matchPrefiltered]: if no window mean is close enough to the condition one to pass the
+         * color verification, or if no close window has any variance, no position can be detected. Each position is
+         * checked in constant time, and the proof stops at the first one that could be detected.
+         * Not used with the scale variants, they would need a proof per template size.
+         * A condition already proven absent for the same search by [prefilterPlanConditions] isn't checked again.
+         *
+         * @param history the matching history of the condition.
+         * @param isAbsenceExpected true if the condition should not be detected. The proof is only computed for
+         *                          these ones, the others are only checked against the plan prefiltering.
+         *
+         * @return true if the condition is proven absent, with the empty results set in the context, false if it
+         *         must be matched.
+         */
+        bool proveAbsence(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                          double scaleRatio, const MatchHistory& history, bool isAbsenceExpected) const;
+
+        /**
+         * Add the [exactMatchingJitter] around a detection area of the condition size, where only the exact condition
+         * position can be matched. The other areas are unchanged.
+         */
+        void addExactAreaJitter(const ConditionTemplate& conditionTemplate, ScalableRoi& detectionRoi,
+                                double scaleRatio) const;
+
+        /**
+         * Correlate the condition at each position of a detection area barely bigger than it, such as the exact areas,
+         * directly and without any allocation. The matching results of the context are updated with the best position.
+         *
+         * @param isFound set to true if the condition is found.
+         *
+         * @return false if the detection area has more than [DIRECT_MATCHING_MAX_POSITIONS] positions on an axis.
+         */
+        bool matchDirect(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                         int threshold, double scaleRatio, bool& isFound) const;
+
+        /**
+         * Search the exact full size color pixels of the condition when [isExactPixelMatchingEnabled], with the
+         * screen [TileHashIndex], or with a rolling hash of the detection area for the conditions it can't find. The
+         * found pixels are the condition ones, they are not verified again. The matching results of the context are
+         * updated with the first occurrence in reading order.
+         *
+         * @param isFound set to true if the condition is found.
+         *
+         * @return false if the threshold allows other pixels, or if the condition or screen pixels are not available.
+         */
+        bool matchExactPixels(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                              int threshold, double scaleRatio, bool& isFound) const;
+
+        /**
+         * Search the condition with its feature points, found even if it is scaled, slightly rotated or partially
+         * covered. The confidence is the part of the condition feature points found at their expected position, and
+         * the matching results of the context are updated with the bounding box of the found condition.
+         *
+         * @return true if the condition is found, false if not.
+         */
+        bool matchFeatures(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                           int threshold, double scaleRatio, uint64_t frameIndex) const;
+
+        /**
+         * Match the condition densely in a window around a candidate, and validate the best position. The matching
+         * results of the context are updated with that position.
+         *
+         * @param refineWindow the window to search, in the cropped detection area. At least the condition size.
+         *
+         * @return true if the best position is a valid detection.
+         */
+        bool refineCandidate(const ConditionTemplate& conditionTemplate, MatchingContext& context,
+                             int threshold, double scaleRatio, const cv::Rect& refineWindow) const;
+
+        /**
+         * Search the condition resized by each factor of [templateScales], once it has not been found at its size.
+         * The matching results of the context are updated with the best candidate, including the one at the condition
+         * size already in them.
+         *
+         * @param matchedScale set to the resize factor of the best candidate.
+         *
+         * @return true if the condition is found at one of the scales.
+         */
+        bool matchScaleVariants(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                                double scaleRatio, double& matchedScale) const;
+
+        /**
+         * Search the condition rotated at each of its other orientations, once it has not been found at its own one.
+         * The orientations are evenly spread over a turn. The matching results of the context are updated with the
+         * best candidate, including the one at the condition orientation already in them.
+         *
+         * @param rotationCount the number of orientations of the condition, its own one included.
+         * @param matchedAngle set to the counterclockwise rotation of the best candidate, in degrees.
+         *
+         * @return true if the condition is found at one of the orientations.
+         */
+        bool matchRotationVariants(const ConditionTemplate& conditionTemplate, MatchingContext& context, int threshold,
+                                   double scaleRatio, int rotationCount, int& matchedAngle) const;
+
+        /** @return the counterclockwise rotation of the orientation at [index] of [rotationCount], in degrees. */
+        static int getRotationAngle(int index, int rotationCount);
+
+        /** Create the rotation variants of the cached templates of some conditions, ahead of their first matching. */
+        void prepareRotationVariants(const std::vector<int64_t>& conditionIds);
+
+        /**
+         * Detect the conditions of a batch one after another, on the calling thread. No condition is started once the
+         * deadline is passed, see [detectBatch].
+         */
+        int detectBatchSerial(const std::vector<DetectionRequest>& requests, int conditionOperator,
+                              std::vector<ConditionResult>& results, int64_t deadlineNanos);
+
+        /**
+         * Detect the conditions of a batch concurrently on the [threadPool] workers. No condition is started once the
+         * deadline is passed, see [detectBatch].
+         */
+        int detectBatchParallel(const std::vector<DetectionRequest>& requests, int conditionOperator,
+                                std::vector<ConditionResult>& results, int64_t deadlineNanos);
+
+        /**
+         * Prepare the [batchConditions] of requests matched on the workers, and their batch backend results.
+         * Must be called on the calling thread, the templates and histories are not shared with the workers.
+         */
+        void prepareBatchConditions(const DetectionRequest* requests, int count);
+
+        /** Ensure there is a [workerContexts] per [threadPool] worker. */
+        void prepareWorkerContexts() const;
+
+        /** Detect a single condition of a batch on the calling thread, with the [mainContext]. */
+        ConditionResult detectRequest(const DetectionRequest& request);
+
+        /**
+         * Detect a condition of the [batchConditions] on a [threadPool] worker, threshold matched or with its text.
+         *
+         * @param condition the condition to detect, prepared by [prepareBatchConditions].
+         * @param context the scratch state of the worker.
+         * @param scaleRatio the current scale ratio.
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult detectBatchCondition(const BatchCondition& condition, MatchingContext& context,
+                                             double scaleRatio);
+
+        /**
+         * Detect the anchors of the not skipped events of a plan, once for all their dependent conditions, and derive
+         * the areas of these conditions from the anchors detections.
+         *
+         * @return the conditions of the plan to detect: [anchoredRequests], or the plan ones if it has no anchor.
+         */
+        const std::vector<DetectionRequest>& resolveAnchors(const ScenarioPlan& plan);
+
+        /**
+         * Update the [planConditions] for the current screen image: rebuilt if the plan have been compiled again, the
+         * schedule of its events and the histories of the conditions matched since then are set.
+         */
+        void updatePlanConditions(const ScenarioPlan& plan);
+
+        /** Clear the [matchHistories], and the history pointers of the [planConditions] with them. */
+        void clearMatchHistories();
+
+        /** @return the history of a condition in [matchHistories], created with its [conditionRotations] if needed. */
+        MatchHistory& getMatchHistory(int64_t conditionId);
+
+        /**
+         * Set the [MatchHistory::unchangedFrameIndex] of the plan conditions not touched by the changes of the current
+         * screen image, from their [planTileIndex] bits. The index is rebuilt first if the plan or the screen metrics
+         * changed since it was built.
+         */
+        void markUnchangedConditions(const ScenarioPlan& plan);
+
+        /**
+         * Prove the absence of the plan conditions searched with the same template size in the same area as many
+         * others, with a single pass over the windows of that area for all of them. The conditions proven absent have
+         * their [MatchHistory::absentFrameIndex] set, and are not matched at all on this screen image.
+         * The [planPrefilterIndex] is rebuilt first if the plan or the screen metrics changed since it was built.
+         * Not used with the scale variants, as for [proveAbsence].
+         */
+        void prefilterPlanConditions(const ScenarioPlan& plan);
+
+        /**
+         * @return the number of first events of the plan to evaluate with [detectEventsSpeculative], 0 if they must
+         * be evaluated one after another.
+         */
+        int getSpeculativeEventCount(const ScenarioPlan& plan) const;
+
+        /**
+         * Match all conditions of the first events of a plan concurrently on the [threadPool] workers. The conditions
+         * of an event are not matched anymore once its operator is decided, and the ones of the lower priority events
+         * once a higher priority event that doesn't keep detecting is fulfilled.
+         *
+         * @param plan the plan to evaluate.
+         * @param conditions the conditions of the plan, with their anchored areas resolved.
+         * @param eventCount the number of first events to evaluate, at most SCENARIO_MAX_SPECULATIVE_EVENTS.
+         * @param results receives the result of each processed condition, at the same index than its plan condition.
+         * @param processedCounts receives the number of conditions processed for each evaluated event.
+         *
+         * @return the index of the fulfilled event stopping the evaluation, or -1 if the next events must be evaluated.
+         */
+        int detectEventsSpeculative(const ScenarioPlan& plan, const std::vector<DetectionRequest>& conditions,
+                                    int eventCount, std::vector<ConditionResult>& results,
+                                    std::vector<int>& processedCounts);
+
+        /** Set the detection roi from the condition area of a batch request. Empty area means the whole screen. */
+        void setBatchDetectionRoi(const cv::Rect& conditionRoi, ScalableRoi& roi) const;
+
+        /**
+         * @return the area searched by the detections on the whole screen: the current screen image without the
+         * [screenInsets], or the whole image if the insets leave nothing of it.
+         */
+        cv::Rect getWholeScreenRoi() const;
+
+        /** @return true if the result of a condition decides the result of the whole batch operator. */
+        static bool isBatchOperatorDecided(const ConditionResult& result, bool shouldBeDetected, int conditionOperator);
+
+        /** @return true if the conditions processed by [detectBatch] fulfill the batch operator. */
+        static bool isBatchFulfilled(const DetectionRequest* requests, int conditionOperator,
+                                     const ConditionResult* results, int processedCount);
+
+        /**
+         * Check if the provided condition is found in the current screen image.
+         * The screen image should be set with [setScreenImage], and the detection roi should be up to date before
+         * executing this method.
+         *
+         * @param conditionId the unique identifier of the condition, used as key for the template cache.
+         * @param conditionPixels the image to search in the screen, can be null if its template is cached.
+         * @param threshold the detection threshold, expressed in [0..1].
+         * @param isFeatureMatching true to search the condition with its feature points instead of its pixels.
+         * @param isAbsenceExpected true if the condition should not be detected, see [matchTemplate].
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult match(int64_t conditionId, const PixelsBuffer* conditionPixels, int threshold,
+                              bool isFeatureMatching, bool isAbsenceExpected = false);
+
+        /**
+         * Check if the provided condition is found in the current screen image, and contains the provided text.
+         * Only the [OCR_MAX_CANDIDATES] best candidates of the template matching are recognized, with the detector OCR
+         * configuration overridden by the condition options, if any.
+         */
+        ConditionResult match(int64_t conditionId, const PixelsBuffer* conditionPixels, const std::string& identifying,
+                              const OcrOptions* ocrOptions);
+
+        /**
+         * Check if a condition is found in the detection area of a context, and contains the provided text. Can be
+         * called from the [threadPool] workers, with their own context.
+         *
+         * @param condition the condition to match.
+         * @param context the scratch state of the matching, with the detection area.
+         * @param identifying the text to find.
+         * @param ocrOptions the OCR options of the condition, or null to use the detector OCR configuration.
+         * @param history the history of the condition, holding its statistics.
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult matchText(const ConditionTemplate& condition, MatchingContext& context,
+                                  const std::string& identifying, const OcrOptions* ocrOptions, MatchHistory& history);
+
+        /**
+         * Add the matching of a condition to [backendJobs], if the batch backend supports it.
+         *
+         * @param batchBackend the backend computing the jobs, with [MatchBackend::CAPABILITY_BATCH].
+         * @param conditionTemplate the condition to match.
+         * @param detectionRoi the area of the screen in which the condition is searched.
+         * @param results receives the matching results, released if the condition must be matched otherwise.
+         */
+        void addBackendJob(const MatchBackend& batchBackend, const ConditionTemplate* conditionTemplate,
+                           const ScalableRoi& detectionRoi, cv::Mat& results);
+
+        /** Compute the results of all [backendJobs] with the batch backend, releasing them if it fails. */
+        void runBackendJobs(MatchBackend& batchBackend);
+
+        /**
+         * Check if a text is found in the detection area of a context, without any condition template. An area the
+         * height of a text line is recognized as a whole, the context text region proposer locates the lines of
+         * bigger ones. Can be called from the [threadPool] workers, with their own context.
+         */
+        ConditionResult matchText(MatchingContext& context, const std::string& identifying,
+                                  const OcrOptions* ocrOptions, MatchHistory& history);
+
+        /** Locate the text lines of the context detection area, and keep them in the condition history. */
+        static void updateTextLayout(MatchingContext& context, MatchHistory& history);
+
+        /**
+         * Add the text lines of the context detection area to its text candidates, until one of them is cached with
+         * the text.
+         *
+         * @return the index of the candidate with the text, or -1 if none.
+         */
+        int addTextLineCandidates(MatchingContext& context, const std::vector<cv::Rect>& lines, uint64_t optionsHash,
+                                  const std::string& identifying);
+
+        /**
+         * Search a text in the whole text of the context text candidates, assembled line by line in reading order.
+         * @return true if it is found, false if not or if a line is not recognized.
+         */
+        static bool isTextInLines(MatchingContext& context, const std::string& identifying);
+
+        /**
+         * Add an area of the context detection area to its text candidates, with its text if it is already in the
+         * [ocrTextCache].
+         *
+         * @param context the scratch state of the text matching.
+         * @param candidateRoi the area of the candidate, relative to the detection area.
+         * @param confidence the confidence of the detection if the candidate contains the text.
+         * @param optionsHash the hash of the OCR options of the condition.
+         * @param identifying the text to find.
+         *
+         * @return true if the cached text of the candidate contains the text.
+         */
+        bool addTextCandidate(MatchingContext& context, const ScalableRoi& candidateRoi, double confidence,
+                              uint64_t optionsHash, const std::string& identifying);
+
+        /**
+         * Get the distance between the gray mean of a candidate window and the one of its condition template, the
+         * prefilter descriptor of the condition. Not bound by any threshold, it only ranks the candidates.
+         *
+         * @param sums the integral of the scaled gray screen image.
+         * @param window the candidate window, in scaled screen coordinates.
+         * @param templateMean the gray mean of the condition template.
+         */
+        static double getWindowMeanDistance(const cv::Mat& sums, const cv::Rect& window, double templateMean);
+
+        /**
+         * Recognize the text of the context text candidates not found in the [ocrTextCache]. For the [mainContext],
+         * they are recognized concurrently on the [threadPool] workers when there are several of them. The workers
+         * contexts are matching a parallel batch and recognize them serially, the pool can't dispatch from its own
+         * tasks. Once a candidate contains the text, the recognitions in progress are cancelled and the pending ones
+         * are skipped. The complete recognitions are put in the [ocrTextCache]. With the conditions prefiltering, the
+         * candidates closest to their template gray mean are recognized first.
+         *
+         * @param context the scratch state of the text matching, with the text candidates.
+         * @param identifying the text to find.
+         * @param config the configuration of the OCR engines, with the condition options applied.
+         *
+         * @return the index of the first candidate containing the text in the recognition order, -1 if none, or
+         *         [OCR_ENGINE_MISSING] if no engine can be initialized with this configuration.
+         */
+        int recognizeTextCandidates(MatchingContext& context, const std::string& identifying,
+                                    const OcrEnginePool::Config& config);
+
+        /**
+         * Recognize the text of a single channel image with the OCR engine.
+         *
+         * @param ocrEngine the engine recognizing the text.
+         * @param image the image to recognize.
+         * @param isCancelled polled during the recognition, stopping it once true. Can be null.
+         * @param text receives the recognized text.
+         * @param isAlsoCancelled polled as [isCancelled], for a second cancellation source. Can be null.
+         *
+         * @return true if the whole image has been recognized, false if it was cancelled.
+         */
+        static bool recognizeText(tesseract::TessBaseAPI& ocrEngine, const cv::Mat& image,
+                                  const std::atomic<bool>* isCancelled, std::string& text,
+                                  const std::atomic<bool>* isAlsoCancelled = nullptr);
+
+        /** @return true if the detections are cancelled, or if a deadline is set and passed. 0 means no deadline. */
+        bool isDetectionStopped(int64_t deadlineNanos = 0) const;
+
+        /**
+         * @return true if the matching started at [matchingStart] would exceed the [conditionTimeBudgetNanos] by
+         * lasting as long as the previous complete matching of its condition.
+         */
+        bool isOverTimeBudget(const MatchHistory& history, int64_t matchingStart) const;
+
+        /** Update the [MatchHistory::completeMatchingNanos] of a condition with the duration of its last matching. */
+        static void updateCompleteMatching(MatchHistory& history, int64_t matchingNanos, bool isDegraded);
+
+        /** Verify if the matching result is above the provided threshold. */
+        static bool isResultAboveThreshold(const MatchingResults& results, int threshold);
+        /** Get the confidence a matching result must be above to be detected with the provided threshold. */
+        static double getMinConfidence(int threshold);
+        /**
+         * Verify the colors of the current candidate of a context against the condition ones.
+         * The color means are always compared, and the color histograms if [isHistogramColorVerificationEnabled].
+         * Can be called concurrently with different contexts.
+         *
+         * @return true if the colors are matching within the threshold.
+         */
+        bool isCandidateColorMatching(const ConditionTemplate& conditionTemplate, const MatchingContext& context,
+                                      int threshold) const;
+        /**
+         * Same as [isCandidateColorMatching] for a masked condition, in its [ConditionTemplate::fullSizeMask] only.
+         * Computed on the candidate pixels, as the screen color integrals include the background.
+         */
+        bool isMaskedCandidateColorMatching(const ConditionTemplate& conditionTemplate,
+                                            const MatchingContext& context, int threshold) const;
+        /**
+         * Get the percentage of color difference between the current candidate of a context and the condition.
+         * Can be called concurrently with different contexts. Result is expressed in [0..1].
+         */
+        double getCandidateColorDiff(const ConditionTemplate& conditionTemplate, const MatchingContext& context) const;
+        /** Get the percentage of color difference between two color means. Result is expressed in [0..1]. */
+        static double getColorDiff(const cv::Scalar& imageColorMeans, const cv::Scalar& conditionColorMeans);
+
+
+    public:
+
+        /** Initialize the detector, creating the detection threads. */
+        void initialize();
+
+        /** Release the detector, stopping the detection threads and dropping all cached values. */
+        void release();
+
+        /**
+         * Determine the scale ratio depending on the screen size.
+         * We reduce the size to improve the processing time, but we don't want it to be too small because it will impact
+         * the performance of the detection. In order to detect correctly, this should be called everytime the screen is
+         * resized or rotated.
+         *
+         * @param metricsTag the debugging tag for logging.
+         * @param width the width of the screen, in pixels.
+         * @param height the height of the screen, in pixels.
+         * @param detectionQuality the quality of the detection.
+         */
+        void setScreenMetrics(const std::string& metricsTag, int width, int height, double detectionQuality);
+
+        /**
+         * Set the image where all following detection requests will search in, copying its pixels. They can be
+         * released once this call returns.
+         *
+         * @param screenPixels the RGBA pixels of the screen. An invalid buffer resets the screen signature.
+         *
+         * @return true if the content of the image is identical to the previous one, false if not.
+         */
+        bool copyScreenImage(const PixelsBuffer& screenPixels);
+
+        /**
+         * Set the image where all following detection requests will search in.
+         * The pixels are not copied, they must remain valid until the next screen image is set.
+         *
+         * @param screenPixels the RGBA pixels of the screen. An invalid buffer resets the screen signature.
+         * @param frameId the identifier of the captured frame, such as its timestamp, the same for all detectors it is
+         *                set in. Its processing is then shared with them through the [FrameBroker]. 0 to process the
+         *                pixels for this detector only.
+         *
+         * @return true if the content of the image is identical to the previous one, false if not.
+         */
+        bool setScreenImage(const PixelsBuffer& screenPixels, int64_t frameId = 0);
+
+        /**
+         * Start processing the pixels of the next screen image in the background, while the conditions are detected in
+         * the current one. The next [setScreenImage] call with the same pixels will use the prepared image.
+         * The pixels are not copied, they must remain valid until the screen image set after them.
+         *
+         * @param screenPixels the RGBA pixels of the next screen image.
+         * @param frameId the identifier of the captured frame, see [setScreenImage]. Not prepared if another detector
+         *                have already published its processing.
+         *
+         * @return true if the preparation have been started, false if the buffer is invalid.
+         */
+        bool prepareScreenImage(const PixelsBuffer& screenPixels, int64_t frameId = 0);
+
+        /**
+         * Drop the screen image prepared with [prepareScreenImage], waiting for its processing to stop. Its buffer can
+         * be released after this call.
+         */
+        void cancelScreenImagePreparation();
+
+        /**
+         * Limit the processing of the next screen images to some areas, when all conditions are searched in an area.
+         * The scaled gray image is only computed in those areas, the following detections must stay within them.
+         * Waits for the screen image being prepared in the background, as it is processed with the previous areas.
+         *
+         * @param regions the areas of the screen to process, in full size coordinates. Empty to process the whole
+         *                screen images.
+         */
+        void setScreenRegions(const std::vector<cv::Rect>& regions);
+
+        /**
+         * Set the areas of the screen whose changes don't make the next screen images changed, such as a clock or an
+         * animation. Their tiles are only ignored outside of the areas of the conditions of the detected plan.
+         *
+         * @param areas the areas to ignore, in full size coordinates. Empty to ignore none.
+         */
+        void setExcludedAreas(const std::vector<cv::Rect>& areas);
+
+        /**
+         * Set the parts of the screen along its edges where the applications are not displayed, such as the status
+         * bar, the navigation bar and the display cutout. They are not searched by the detections on the whole
+         * screen, the ones with an area are searched in it as is. Kept for the next screen metrics, it must be set
+         * again when the screen is rotated.
+         *
+         * @param left the width of the inset on the left edge, in full size pixels.
+         * @param top the height of the inset on the top edge, in full size pixels.
+         * @param right the width of the inset on the right edge, in full size pixels.
+         * @param bottom the height of the inset on the bottom edge, in full size pixels.
+         */
+        void setScreenInsets(int left, int top, int right, int bottom);
+
+        /**
+         * Classify the image defined with [setScreenImage] in a state of the detected application, such as its menu
+         * or its shop, see [ScreenStateClassifier]. The states are learned from the classified images, and forgotten
+         * with the next screen metrics.
+         *
+         * @return the identifier of the state of the screen image, or ScreenStateClassifier::UNKNOWN_STATE if there is
+         * no screen image.
+         */
+        int classifyScreenState();
+
+        /**
+         * Tells if the pixels of a condition are read by its next detection: its template is neither cached nor in the
+         * template pack, or the detection capture hasn't recorded them yet. They can be null for the other conditions.
+         */
+        bool isConditionPixelsNeeded(int64_t conditionId) const;
+
+        /**
+         * Check if the provided image is contained in the image defined with [setScreenImage].
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionPixels the image to search, can be null if [isConditionPixelsNeeded] is false.
+         * @param threshold the minimum detection confidence to consider the detection position.
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels, int threshold);
+
+        /**
+         * Check if the provided image is contained in the image defined with [setScreenImage].
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionPixels the image to search, can be null if [isConditionPixelsNeeded] is false.
+         * @param identifying the recognised information to consider the detection position.
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels,
+                                        const std::string& identifying);
+
+        /**
+         * Check if the provided image is contained in a specific area within the image defined with [setScreenImage].
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionPixels the image to search, can be null if [isConditionPixelsNeeded] is false.
+         * @param roi the area to search in, in full size coordinates.
+         * @param threshold the minimum detection confidence to consider the detection position.
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels, const cv::Rect& roi,
+                                        int threshold);
+
+        /**
+         * Check if the provided image is contained in a specific area within the image defined with [setScreenImage].
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionPixels the image to search, can be null if [isConditionPixelsNeeded] is false.
+         * @param roi the area to search in, in full size coordinates.
+         * @param identifying the recognised information to consider the detection position.
+         *
+         * @return the results of the detection.
+         */
+        ConditionResult detectCondition(int64_t conditionId, const PixelsBuffer* conditionPixels, const cv::Rect& roi,
+                                        const std::string& identifying);
+
+        /**
+         * Check if a text is found in an area of the image defined with [setScreenImage], without any condition image.
+         * The text lines of the area are located, and recognized directly.
+         *
+         * @param conditionId the unique identifier of the condition, for its statistics.
+         * @param roi the area to search in, in full size coordinates. Empty to search in the whole screen.
+         * @param identifying the text to find.
+         * @param ocrOptions the OCR options of the condition, or null for the detector OCR configuration.
+         *
+         * @return the results of the detection, centered on the text line containing the text if found.
+         */
+        ConditionResult detectText(int64_t conditionId, const cv::Rect& roi, const std::string& identifying,
+                                   const OcrOptions* ocrOptions = nullptr);
+
+        /**
+         * Find all occurrences of the provided image in an area of the image defined with [setScreenImage], from a
+         * single template matching: every candidate above the threshold, not overlapping a better one and with
+         * matching colors is an occurrence. The condition history is not used, each call matches the whole area.
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionPixels the image to search, can be null if [isConditionPixelsNeeded] is false.
+         * @param roi the area to search in, in full size coordinates. Empty to search in the whole screen.
+         * @param threshold the minimum detection confidence to consider the detection position.
+         * @param occurrences receives the detected occurrences, best first. At most [MATCHING_MAX_CANDIDATES].
+         *
+         * @return the number of occurrences found.
+         */
+        int detectAllOccurrences(int64_t conditionId, const PixelsBuffer* conditionPixels, const cv::Rect& roi,
+                                 int threshold, std::vector<ConditionResult>& occurrences);
+
+        /**
+         * Check if a condition with a cached template is contained in an area of the image defined with
+         * [setScreenImage], without writing the detector state: the matching scratch state is owned by the call, and
+         * the condition history, the detection capture and the template cache are left untouched. Only the per screen
+         * image caches, safe for the concurrent batch workers, are shared.
+         *
+         * Can be called from several threads at once, and concurrently with the other detections, as long as the
+         * screen image, the screen metrics and the template cache are not changed during the call. Text conditions are
+         * not supported, the OCR engines can't be shared.
+         *
+         * @param conditionId the unique identifier of the condition, with a template cached by a previous detection
+         *                    or [prepareTemplates].
+         * @param roi the area to search in, in full size coordinates. Empty to search in the whole screen.
+         * @param threshold the minimum detection confidence to consider the detection position.
+         *
+         * @return the results of the detection, not detected if the template of the condition is not cached.
+         */
+        ConditionResult detectConditionConcurrently(int64_t conditionId, const cv::Rect& roi, int threshold) const;
+
+        /**
+         * Enable or disable the pyramid matching.
+         * When enabled, conditions are first searched in a downscaled screen image, and only the best candidates are
+         * refined at the detection quality. This is a lot faster on big images, but may miss very small details.
+         * The downscale factor of each condition is the biggest one keeping enough of its pixels and variance.
+         *
+         * @param enabled true to enable the pyramid matching, false to match on the whole image.
+         */
+        void setPyramidMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the sparse matching.
+         * When enabled, the big conditions are first matched on their pixels with the highest gradients only, and the
+         * best positions are then verified with the complete condition. Most of the conditions are a small shape on a
+         * flat background, and their flat pixels are not needed to find the candidates.
+         *
+         * @param enabled true to enable the sparse matching, false to match the complete conditions.
+         */
+        void setSparseMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the binary matching.
+         * When enabled, the high contrast conditions, such as texts, icons and outlines, are first matched on their
+         * bits binarized with an adaptive threshold and packed by 64, and the best positions are then verified with
+         * the complete condition. The bits of 64 pixels are compared at once, an order of magnitude cheaper than the
+         * correlation of their gray values.
+         *
+         * @param enabled true to enable the binary matching, false to correlate the gray values only.
+         */
+        void setBinaryMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the chamfer matching.
+         * When enabled, the conditions with a shape, such as buttons and icons, are first matched on the distances of
+         * their edge points to the closest screen edges, computed once per frame for all conditions. The best
+         * positions are verified with the complete condition, and the best one is kept when its shape matches even
+         * if its colors do not, for the games recoloring their buttons.
+         *
+         * @param enabled true to enable the chamfer matching, false to correlate the gray values only.
+         */
+        void setChamferMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the motion compensation.
+         * When enabled, the translation of the screen content since the previous screen image is estimated with a
+         * phase correlation of both images downscaled. When a list or a map scrolls, the conditions found on the
+         * previous screen image are found at their shifted positions without any matching, and the other ones are only
+         * searched in the newly exposed parts of their detection area.
+         *
+         * @param enabled true to enable the motion compensation, false to search the changed areas again.
+         */
+        void setMotionCompensationEnabled(bool enabled);
+
+        /**
+         * Enable or disable the animated areas exclusion.
+         * When enabled, the tiles of the screen changing in most screen images, such as a blinking cursor or an idle
+         * animation, are learned. Outside of the areas of the conditions of the detected plan, their changes don't
+         * make the screen images changed, nor wake up [waitForRegionChange].
+         *
+         * @param enabled true to learn the animated areas, false to only ignore the ones of [setExcludedAreas].
+         */
+        void setAnimatedAreasExclusionEnabled(bool enabled);
+
+        /**
+         * Enable or disable the first hit matching.
+         * When enabled, the conditions expected to be detected are correlated tile by tile, starting with the tiles
+         * where they have been found the most, and the matching stops at the first verified detection. A condition
+         * usually on screen is then found for a fraction of the cost of matching its whole detection area.
+         *
+         * @param enabled true to enable the first hit matching, false to always match the whole detection areas.
+         */
+        void setFirstHitMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the learned area matching.
+         * When enabled, a condition found almost always in the same part of its detection area is searched there
+         * first, and in the complete detection area only when not found in it. Most conditions detected in the whole
+         * screen only ever appear in one corner of it.
+         *
+         * @param enabled true to enable the learned area matching, false to always match the whole detection areas.
+         */
+        void setLearnedAreaMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the conditions prefiltering of the scenario plans.
+         * When enabled, the conditions of a plan searched in the same area with the same template size are indexed
+         * by the window gray means that could pass their color verification. On each screen image, the gray means of
+         * the windows of that area are computed once, and all the conditions without any of them are proven absent
+         * without being matched. Large scenarios often have dozens of conditions searched in the whole screen.
+         * The text conditions can't be proven absent, their candidates are not bound by the threshold. Their candidates
+         * are ranked by the distance of their gray mean to the template one instead, and the closest ones are
+         * recognized first: most of the OCR of the candidates that can't contain the text is skipped.
+         *
+         * @param enabled true to prefilter the plans conditions, false to match each one of them.
+         */
+        void setConditionPrefilterEnabled(bool enabled);
+
+        /**
+         * Enable or disable the integer scale ratio.
+         * When enabled, the scale ratio of the detection quality is snapped to 1/2, 1/3 or 1/4 when it is close to it.
+         * The screen images are then downscaled by averaging blocks of pixels, a lot faster than an arbitrary ratio.
+         * Applied from the next [setScreenMetrics].
+         *
+         * @param enabled true to snap the scale ratio, false to always use the ratio of the detection quality.
+         */
+        void setIntegerScaleRatioEnabled(bool enabled);
+
+        /**
+         * Cancel or resume the detections. Can be called from any thread, while a detection is running.
+         * While cancelled, the running detection stops between two conditions, two candidates or two recognized words,
+         * and the following ones return right away. Their conditions are not detected, and the scenario detections
+         * return [SCENARIO_FRAME_EXPIRED].
+         *
+         * @param cancelled true to cancel the detections, false to resume them.
+         */
+        void setDetectionCancelled(bool cancelled);
+
+        /**
+         * Wait for an area of the screen to change in the screen images set after this call by another thread, from
+         * their tile signatures. Returns right away while the detections are cancelled with [setDetectionCancelled].
+         *
+         * @param roi the area to wait for, in full size coordinates.
+         * @param changeThreshold the part of the tiles of the area that must have changed since the call, between 0
+         *                        and 1. 0 to return on the first change.
+         * @param timeoutNanos the maximum duration of the wait, in nanoseconds.
+         *
+         * @return true if the area has changed, false if the wait has timed out or has been cancelled.
+         */
+        bool waitForRegionChange(const cv::Rect& roi, double changeThreshold, int64_t timeoutNanos);
+
+        /**
+         * Set the resize factors of the conditions for the multi scale matching.
+         * When a condition is not found at its size, it is searched resized by each factor, and the best candidate is
+         * reported. This allows to detect conditions captured on a screen with another resolution or density.
+         *
+         * @param scales the resize factors to try, empty to disable the multi scale matching.
+         */
+        void setTemplateScales(const std::vector<double>& scales);
+
+        /**
+         * Set the jitter of the exact conditions, whose detection area is the condition area.
+         * Their area is extended by the jitter on each side, so they are still found when their UI shifts slightly.
+         *
+         * @param pixels the jitter in full size pixels, 0 to only search the exact position. The scaled jitter is
+         *               capped to [EXACT_MATCHING_MAX_JITTER].
+         */
+        void setExactMatchingJitter(int pixels);
+
+        /**
+         * Enable or disable the exact pixel matching.
+         * When enabled, the conditions with a threshold up to [EXACT_PIXEL_MATCHING_MAX_THRESHOLD] are only found
+         * where the screen has their exact full size pixels, with a rolling hash whose cost doesn't depend on the
+         * condition size. A condition slightly different on the screen, such as with a compressed image, isn't found.
+         *
+         * @param enabled true to search the near exact conditions with their pixels, false to correlate them.
+         */
+        void setExactPixelMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the histogram color verification.
+         * When enabled, the candidates with the same color means as the condition must also have a similar color
+         * distribution. This rejects more wrong candidates, allowing looser thresholds.
+         *
+         * @param enabled true to compare the color histograms, false to compare the color means only.
+         */
+        void setHistogramColorVerificationEnabled(bool enabled);
+
+        /**
+         * Enable or disable the scaled color verification.
+         * When enabled, the color means of the candidates are computed on the screen image downscaled at the scale
+         * ratio instead of the full size one. This is a lot less memory to write for each screen image, but the means
+         * of the small candidates are less accurate on their borders.
+         * The screen pixels copied by [copyScreenImage] are then only kept downscaled, as for a screen captured
+         * downscaled: the full size color plane isn't allocated, but the exact pixel matching is skipped and the text
+         * is recognized on the downscaled pixels.
+         *
+         * @param enabled true to compare the color means at the scale ratio, false to compare them at full size.
+         */
+        void setScaledColorVerificationEnabled(bool enabled);
+
+        /**
+         * Enable or disable the frame allocator for the screen images planes.
+         * When enabled, the copied color pixels and the scaled gray image are allocated by the [FrameAllocator]: their
+         * rows are padded to a cache line, the frame sized planes are advised as huge pages when supported, and their
+         * memory is reused from one frame to the next instead of being freed. Applied from the next screen image.
+         *
+         * @param enabled true to allocate the planes with the frame allocator, false to use the OpenCv default one.
+         */
+        void setFrameAllocatorEnabled(bool enabled);
+
+        /**
+         * Enable or disable the integer matching.
+         * When enabled, the conditions not matched with the FFT or small templates kernels are correlated directly in
+         * integers instead of with the OpenCv float matching. The results are the same up to the float rounding.
+         * The small conditions of a detection searched in the same area are correlated at once by the batched
+         * [GemmMatchBackend], unless the GPU matching is enabled.
+         *
+         * @param enabled true to correlate in integers, false to use the OpenCv matching.
+         */
+        void setIntegerMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the GPU matching.
+         * When enabled, the matching results of the conditions are computed with a Vulkan compute shader, all
+         * conditions of a batch in a single dispatch, keeping the screen and condition images in the GPU memory. The
+         * CPU matching is used for the conditions the GPU can't match, and when the GPU fails.
+         *
+         * @param enabled true to match on the GPU when possible, false to match on the CPU only.
+         *
+         * @return true if the GPU matching is enabled, false if disabled or if there is no GPU compute support.
+         */
+        bool setGpuMatchingEnabled(bool enabled);
+
+        /**
+         * Enable or disable the NNAPI matching.
+         * When enabled, the conditions of a batch searched in the same area with the same size are correlated by a
+         * single convolution on the neural networks accelerator of the device, in half floats. Only the positions
+         * that might reach the threshold are correlated again in integers by the CPU, as with the other backends.
+         * The last enabled of the GPU and NNAPI matching computes the batches.
+         *
+         * @param enabled true to match on the accelerator when possible, false to match without it.
+         *
+         * @return true if the NNAPI matching is enabled, false if disabled or if there is no accelerator.
+         */
+        bool setNnapiMatchingEnabled(bool enabled);
+
+        /**
+         * Set the number of screen images to detect per second with [getFrameDelayMs].
+         *
+         * @param detectionsPerSecond the target detection rate, or 0 to detect the screen images as fast as possible.
+         */
+        void setTargetDetectionRate(double detectionsPerSecond);
+
+        /**
+         * Complete the detection of the current screen image, and get the delay to wait before setting the next one to
+         * reach the target detection rate. The delay is computed from the measured cost of the last screen images and
+         * is increased while the screen is unchanged.
+         *
+         * @return the delay in milliseconds, 0 to set the next screen image immediately.
+         */
+        int64_t getFrameDelayMs();
+
+        /**
+         * Format the records of the last detected screen images, one per line, with their setup, matching and total
+         * durations, their matched and reused conditions counts and the matching backends used.
+         * Can be called from any thread, concurrently with the detection.
+         *
+         * @param maxCount the maximum number of screen images to format, from the newest one.
+         */
+        std::string getFrameTelemetry(size_t maxCount) const { return frameTelemetry.dump(maxCount); }
+
+        /**
+         * Set the number of threads preprocessing the screen images and matching the batches concurrently, replacing
+         * the pool threads. The screen image rows are split between them. Must not be called during a detection.
+         *
+         * @param threadCount the number of threads in addition to the calling one, clamped to the cores count. 0 to
+         *                    detect on the calling thread only, negative for the default count.
+         */
+        void setThreadCount(int threadCount);
+
+        /**
+         * Set the scheduling policy of the detection threads. The workers keep it, while the threads calling the
+         * detector only have it during the calls.
+         *
+         * @param policy the cores preference and the priority of the threads.
+         */
+        void setThreadPolicy(const ThreadPolicy& policy);
+
+        /**
+         * Enable or disable the performance hints.
+         * When enabled, the actual cost of each frame is reported against the target detection interval to an Android
+         * performance hint session for the detection threads, letting the system adapt the cores frequencies to it.
+         *
+         * @param enabled true to report the frame costs, false to stop.
+         *
+         * @return true if the performance hints are enabled, false if disabled or not supported by the device.
+         */
+        bool setPerformanceHintEnabled(bool enabled);
+
+        /**
+         * Set the memory budget of the detector. Instead of growing, the detector then degrades to fit in it by
+         * evicting the processed conditions, which are processed again from their pixels when needed. Applied from
+         * the next screen image.
+         *
+         * @param budget the budget in bytes, or 0 for unbounded with the default template cache budget.
+         */
+        void setMemoryBudget(size_t budget);
+
+        /**
+         * Report the memory pressure of the system. The detector sheds its caches for it from the next screen image,
+         * and regrows them progressively once the pressure is no longer reported, see [MEMORY_PRESSURE_HOLD_NANOS].
+         * Can be called from any thread.
+         *
+         * @param pressure the [MemoryPressure], from [MEMORY_PRESSURE_NONE] to [MEMORY_PRESSURE_FRAMES].
+         */
+        void setMemoryPressure(int pressure);
+
+        /**
+         * Set the time budget of each condition matching. When the previous complete matching of a condition shows
+         * it would exceed it, the matching degrades: only on the coarse pyramid level, without the template scale
+         * variants, or without recognizing text. The candidates verification also stops once the budget is spent. The
+         * degraded results are flagged with [ConditionResult::isDegraded], and matched again on the next screen image.
+         *
+         * @param budgetNanos the budget in nanoseconds, or 0 for unbounded.
+         */
+        void setConditionTimeBudget(int64_t budgetNanos);
+
+        /**
+         * Get the memory held by this detector, by category.
+         * Must not be called while a screen image is prepared in the background.
+         *
+         * @return [MEMORY_USAGE_VALUES_COUNT] values, the fields of the [MemoryUsage] in declaration order.
+         */
+        std::vector<int64_t> getMemoryUsage() const;
+
+        /**
+         * Set the number of screen images recorded by the detection capture, for a replay outside of the application.
+         * The last screen images are kept with the image conditions detected on them, and with the conditions pixels.
+         * Applied from the next screen image, the conditions must then be provided with their pixels at least once.
+         *
+         * @param frameCount the number of the last screen images to keep, 0 to disable the capture.
+         */
+        void setCaptureFrameCount(int frameCount);
+
+        /**
+         * Write the detection capture into a file, replayed by the native benchmark.
+         *
+         * @param path the path of the capture file.
+         *
+         * @return true if the capture has been written, false if it is disabled or can't be written.
+         */
+        bool writeCapture(const std::string& path) const;
+
+        /**
+         * Find the lowest detection quality giving the same results than the quality of the detection capture, by
+         * replaying its image conditions detections at decreasing qualities. Each detection must have the same detected
+         * state, and a detected condition must be found around the same position.
+         * Slow, the captured detections are replayed once per quality. The capture must be enabled with
+         * [setCaptureFrameCount] during a detection session.
+         *
+         * @param qualities the detection qualities to try, the ones above the capture quality are ignored.
+         * @param positionTolerance the maximum distance with the position at the capture quality, in full size pixels.
+         *
+         * @return the lowest quality with the same results, the capture quality if none. 0 if nothing is captured.
+         */
+        double suggestDetectionQuality(const std::vector<double>& qualities, int positionTolerance) const;
+
+        /**
+         * Set the configuration of the OCR engines for the text conditions.
+         * The engines are shared by all detectors and only loaded on the first text condition detection.
+         *
+         * @param config the configuration of the engines.
+         */
+        void setOcrConfig(const OcrEnginePool::Config& config);
+
+        /**
+         * Warm up the process before any detector is used: the OpenCV lazy initialization is triggered, and the OCR
+         * engines of the configurations are loaded in the [OcrEnginePool], to be kept for the first text detections.
+         * Slow, should be called from a background thread. Can be called from any thread.
+         *
+         * @param ocrConfigs the configurations of the engines to load, empty if the scenario has no text conditions.
+         *
+         * @return the number of OCR engines ready in the pool.
+         */
+        static int prewarm(const std::vector<OcrEnginePool::Config>& ocrConfigs);
+
+        /**
+         * Open the template pack of a scenario. The conditions in the pack are no longer processed from their pixels
+         * when the scale ratio is the same than the one the pack was written for.
+         *
+         * @param path the path of the pack file.
+         *
+         * @return true if the pack is valid, false if not.
+         */
+        bool openTemplatePack(const std::string& path);
+
+        /**
+         * Write all processed conditions templates into a template pack, for the next runs of the scenario.
+         *
+         * @param path the path of the pack file.
+         *
+         * @return true if the pack has been written.
+         */
+        bool writeTemplatePack(const std::string& path) const;
+
+        /** @return the identifiers of the conditions that can be loaded from the pack at the current scale ratio. */
+        std::vector<int64_t> getPackedConditionIds() const;
+
+        /**
+         * Tells if the template of a condition is cached at the current scale ratio. Its pixels can be null when
+         * detecting it, until it is evicted from the cache.
+         */
+        bool isTemplateCached(int64_t conditionId) const;
+
+        /**
+         * Process the templates of conditions for the current screen metrics, before their first detection.
+         * The pixels are processed concurrently on the [threadPool] workers, and the first detection of the conditions
+         * is then as fast as the next ones.
+         *
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param conditionPixels the condition pixels, at the same index than their identifier. Can be null when
+         *                        [isConditionPixelsNeeded] is false. Only read during this call.
+         *
+         * @return the number of conditions ready to be detected.
+         */
+        int prepareTemplates(const std::vector<int64_t>& conditionIds,
+                             const std::vector<const PixelsBuffer*>& conditionPixels);
+
+        /**
+         * Process the templates of conditions for the current screen metrics from their image files, see
+         * [prepareTemplates]. The files are mapped instead of being decoded, and their pages are read concurrently by
+         * the workers processing them. Only the files of the conditions needing their pixels are opened.
+         *
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param conditionPaths the paths of the condition files, see [ConditionFile], at the same index than their
+         *                       identifier. Can be empty for the conditions already cached or packed.
+         * @param conditionSizes the size of the condition images, at the same index than their identifier.
+         *
+         * @return the number of conditions ready to be detected.
+         */
+        int prepareTemplateFiles(const std::vector<int64_t>& conditionIds,
+                                 const std::vector<std::string>& conditionPaths,
+                                 const std::vector<cv::Size>& conditionSizes);
+
+        /**
+         * Drop the templates and the match histories of some conditions, keeping the ones of all other conditions, the
+         * screen image and the statistics. Called when the bitmap of conditions have been edited, or when they have
+         * been deleted, without creating a new detector: the edited ones are processed again by [prepareTemplates] or
+         * during their next detection.
+         *
+         * @param conditionIds the unique identifiers of the conditions.
+         */
+        void removeTemplates(const std::vector<int64_t>& conditionIds);
+
+        /**
+         * Set the conditions that can't be detected until an other event enables them, such as the ones of the
+         * disabled events not enabled by the actions of the enabled events. Their templates are kept compacted, with
+         * their images compressed and without the values derived from them, and the ones of the conditions that are
+         * not idle anymore are restored on the [threadPool] workers. See [TemplateCache::setIdleConditions].
+         *
+         * @param conditionIds the unique identifiers of all idle conditions, replacing the previous ones.
+         */
+        void setIdleTemplates(const std::vector<int64_t>& conditionIds);
+
+        /**
+         * Set the conditions searched at several orientations, such as a dial or a rotating icon. Once not found at
+         * its own orientation, such a condition is searched rotated around its center at the other ones, evenly spread
+         * over a turn, and the best one is reported with [ConditionResult::angle]. The rotated templates are created
+         * with the condition template, see [ConditionTemplate::getRotationVariant].
+         *
+         * @param conditionIds the unique identifiers of the rotation tolerant conditions, replacing the previous ones.
+         * @param rotationCounts the number of orientations of each condition, at the same index than its identifier,
+         *                       up to [CONDITION_MAX_ROTATIONS]. 1 to search it at its own orientation only.
+         */
+        void setConditionRotations(const std::vector<int64_t>& conditionIds, const std::vector<int>& rotationCounts);
+
+        /**
+         * Set the similarity the conditions are matched with, see [MatchingMetric]. The pixel differences are cheaper
+         * than the default correlation, but don't tolerate any brightness change. With another metric, a condition is
+         * matched with the [DifferenceMatcher] only, at its own scale and orientation, instead of the correlation
+         * backends.
+         *
+         * @param conditionIds the unique identifiers of the conditions, replacing the previous ones.
+         * @param metrics the [MatchingMetric] of each condition, at the same index than its identifier.
+         */
+        void setConditionMetrics(const std::vector<int64_t>& conditionIds, const std::vector<int>& metrics);
+
+        /**
+         * Get the counters of the detected conditions, only maintained when the tracing is enabled.
+         *
+         * @return [CONDITION_COUNTERS_STRIDE] values per condition: its identifier and its [ConditionCounters], in
+         * declaration order. Empty if the tracing is disabled.
+         */
+        std::vector<int64_t> getConditionCounters() const;
+
+        /**
+         * Get the statistics of the recent matchings of the detected conditions.
+         *
+         * @return [CONDITION_STATISTICS_STRIDE] values per condition: its identifier, its [ConditionStatisticsSummary]
+         * in declaration order, and its learned area in full size screen coordinates (x, y, width and height, empty
+         * if it has none, see [getLearnedArea]). Conditions never matched are not included.
+         */
+        std::vector<int64_t> getConditionStatistics() const;
+
+        /**
+         * Get the lookups of the detector caches since its creation, to size them from real scenarios.
+         *
+         * @return [CACHE_STATISTICS_STRIDE] values per [CacheType], in declaration order: its hit, miss and eviction
+         * counts, and the memory it holds in bytes.
+         */
+        std::vector<int64_t> getCacheStatistics() const;
+
+        /**
+         * Get the text recognition engines created by the process, shared by all detectors.
+         *
+         * @return [OCR_ENGINE_STATISTICS_VALUES_COUNT] values: the number of engines, the number of them initialized
+         * from a mapped trained data file, and the total and maximum initialization times in nanoseconds.
+         */
+        static std::vector<int64_t> getOcrEngineStatistics();
+
+        /**
+         * Check a batch of conditions against the image defined with [setScreenImage].
+         * Conditions are detected in order, and the detection stops as soon as the operator result is known.
+         *
+         * @param requests the conditions of the batch.
+         * @param conditionOperator the operator between the conditions, BATCH_OPERATOR_AND or BATCH_OPERATOR_OR.
+         * @param results receives the result of each processed condition, at the same index than its request.
+         * @param deadlineNanos the time after which no condition is started, as [ConditionStatistics::getTimeNanos].
+         *                      The results are then incomplete, and must be dropped. 0 for no deadline.
+         *
+         * @return the number of conditions processed.
+         */
+        int detectBatch(const std::vector<DetectionRequest>& requests, int conditionOperator,
+                        std::vector<ConditionResult>& results, int64_t deadlineNanos = 0);
+
+        /**
+         * Evaluate the image events of a scenario against the image defined with [setScreenImage], in a single call.
+         * Each event is detected as a batch, in order, and the evaluation stops after the first fulfilled event
+         * without [PlannedEvent::keepDetecting]. The events with [PlannedEvent::isSkipped] are passed over.
+         * Once the [ScenarioPlan::deadlineNanos] is passed, the evaluation is aborted between two conditions.
+         * The conditions with an anchor are searched in an area around its detection only, the anchors being detected
+         * once before the events, see [DetectionRequest::anchorIndex].
+         *
+         * @param plan the compiled events.
+         * @param results receives the result of each processed condition, at the same index than its plan condition.
+         * @param processedCounts receives the number of conditions processed for each event, 0 if not evaluated or
+         *                        skipped with [PlannedEvent::isSkipped].
+         *
+         * @return the number of events evaluated, or SCENARIO_PIXELS_NEEDED if the template of a plan condition is
+         * no longer available (evicted from the cache, or requested by the capture) and the plan can't be evaluated
+         * without its pixels, or SCENARIO_FRAME_EXPIRED if the deadline is passed or the detections are cancelled
+         * before the end of the evaluation.
          */
-        void detectCondition(JNIEnv *env, jobject conditionImage, int x, int y, int width, int height, std::string identifying);
+        int detectScenario(const ScenarioPlan& plan, std::vector<ConditionResult>& results,
+                           std::vector<int>& processedCounts);
     };
 }
 
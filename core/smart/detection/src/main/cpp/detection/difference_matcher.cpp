@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdlib>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "difference_matcher.hpp"
+#include "../types/memory_usage.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The maximum difference between two gray pixels. */
+static constexpr double MAX_PIXEL_DIFFERENCE = 255.0;
+
+void DifferenceMatcher::match(const cv::Mat& image, const cv::Mat& templ, MatchingMetric metric,
+                              double minConfidence, cv::Mat& results) {
+
+    if (metric == MatchingMetric::SQDIFF_NORMED) matchSquaredDifferences(image, templ, results);
+    else matchAbsoluteDifferences(image, templ, minConfidence, results);
+}
+
+void DifferenceMatcher::matchSquaredDifferences(const cv::Mat& image, const cv::Mat& templ, cv::Mat& results) {
+    // Normalized by OpenCv with the integral of the image squares. A difference of 0 is a similarity of 1.
+    cv::matchTemplate(image, templ, results, cv::TM_SQDIFF_NORMED);
+    cv::subtract(cv::Scalar(1), results, results);
+}
+
+void DifferenceMatcher::matchAbsoluteDifferences(const cv::Mat& image, const cv::Mat& templ, double minConfidence,
+                                                 cv::Mat& results) {
+
+    const double maxDifference = MAX_PIXEL_DIFFERENCE * (double) templ.total();
+    // The sum of absolute differences above which a position can't reach the minimum confidence
+    const auto bound = (int64_t) ((1.0 - minConfidence) * maxDifference);
+    const auto templSum = (int64_t) cv::sum(templ)[0];
+
+    // The screen scaled images are small enough for the 32 bits sums
+    cv::integral(image, sums, CV_32S);
+
+    for (int y = 0; y < results.rows; y++) {
+        const auto* top = sums.ptr<int32_t>(y);
+        const auto* bottom = sums.ptr<int32_t>(y + templ.rows);
+        auto* resultRow = results.ptr<float>(y);
+
+        for (int x = 0; x < results.cols; x++) {
+            const int right = x + templ.cols;
+            const int64_t windowSum = bottom[right] - bottom[x] - top[right] + top[x];
+
+            // The difference of the sums is a lower bound of the sum of the absolute differences
+            int64_t difference = std::abs(windowSum - templSum);
+            if (difference <= bound) difference = sumAbsoluteDifferences(image, templ, x, y, bound);
+
+            resultRow[x] = (float) (1.0 - (double) difference / maxDifference);
+        }
+    }
+}
+
+int64_t DifferenceMatcher::sumAbsoluteDifferences(const cv::Mat& image, const cv::Mat& templ, int x, int y,
+                                                  int64_t bound) {
+
+    int64_t sum = 0;
+    for (int row = 0; row < templ.rows && sum <= bound; row++) {
+        const uint8_t* imageRow = image.ptr<uint8_t>(y + row) + x;
+        const uint8_t* templRow = templ.ptr<uint8_t>(row);
+
+        // Kept in 32 bits, vectorized by the compiler
+        int32_t rowSum = 0;
+        for (int col = 0; col < templ.cols; col++) rowSum += std::abs(imageRow[col] - templRow[col]);
+        sum += rowSum;
+    }
+
+    return sum;
+}
+
+size_t DifferenceMatcher::getMemorySize() const {
+    return getMatMemorySize(sums);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DIFFERENCE_MATCHER_HPP
+#define KLICK_R_DIFFERENCE_MATCHER_HPP
+
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+
+#include "../types/matching_metric.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Template matching with the pixel difference metrics, cheaper than the correlation for the conditions captured on
+     * the same device without any lighting change. See [MatchingMetric].
+     *
+     * The results are similarities between 0 and 1, higher being better as with TM_CCOEFF_NORMED, so the candidates
+     * are extracted and verified the same way. The sum of absolute differences prunes the positions whose window sum,
+     * from an integral image, is too far from the template one, and stops summing a position once it exceeds the
+     * difference allowed by the minimum confidence.
+     */
+    class DifferenceMatcher {
+
+    private:
+        /** Integral image of the image, for the sum of absolute differences lower bound. */
+        cv::Mat sums;
+
+        void matchSquaredDifferences(const cv::Mat& image, const cv::Mat& templ, cv::Mat& results);
+        void matchAbsoluteDifferences(const cv::Mat& image, const cv::Mat& templ, double minConfidence,
+                                      cv::Mat& results);
+
+        /** @return the sum of absolute differences at a position, or a partial sum above [bound] once exceeded. */
+        static int64_t sumAbsoluteDifferences(const cv::Mat& image, const cv::Mat& templ, int x, int y,
+                                              int64_t bound);
+
+    public:
+        /**
+         * Match the template in the image.
+         * For the positions skipped by the sum of absolute differences, an upper bound of their similarity, below the
+         * minimum confidence, is set instead.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the template to search, in 8 bits gray.
+         * @param metric the similarity to compute, any other than [MatchingMetric::CCOEFF_NORMED].
+         * @param minConfidence the minimum confidence of the positions to keep, in ]0..1].
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const cv::Mat& templ, MatchingMetric metric, double minConfidence,
+                   cv::Mat& results);
+
+        /** @return the memory of the integral image kept between the matchings, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_DIFFERENCE_MATCHER_HPP
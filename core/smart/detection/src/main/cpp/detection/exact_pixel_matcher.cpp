@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "exact_pixel_matcher.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The hash bases along the rows and the columns of the images, odd for the primary and the secondary hashes. */
+static constexpr uint64_t PRIMARY_ROW_BASE = 0x9e3779b97f4a7c15ULL;
+static constexpr uint64_t PRIMARY_COLUMN_BASE = 0xc2b2ae3d27d4eb4fULL;
+static constexpr uint64_t SECONDARY_ROW_BASE = 0x165667b19e3779f9ULL;
+static constexpr uint64_t SECONDARY_COLUMN_BASE = 0x27d4eb2f165667c5ULL;
+/** Keeps the RGB values of a little endian RGBA pixel. */
+static constexpr uint32_t RGB_MASK = 0x00FFFFFFu;
+
+/** @return base^exponent, modulo 2^64. */
+static uint64_t power(uint64_t base, int exponent) {
+    uint64_t result = 1;
+    for (int i = 0; i < exponent; i++) result *= base;
+    return result;
+}
+
+/** @return the RGB values of a pixel of a CV_8UC4 row. */
+static inline uint64_t getPixelValue(const uint8_t* row, int x) {
+    uint32_t value;
+    std::memcpy(&value, row + x * 4, sizeof(value));
+    return value & RGB_MASK;
+}
+
+void PixelsHash::compute(const cv::Mat& rgba) {
+    size = rgba.size();
+    primary = 0;
+    secondary = 0;
+
+    // Same as the window hashes of [ExactPixelMatcher], for a single window
+    for (int y = 0; y < rgba.rows; y++) {
+        const auto* row = rgba.ptr<uint8_t>(y);
+        uint64_t rowPrimary = 0;
+        uint64_t rowSecondary = 0;
+        for (int x = 0; x < rgba.cols; x++) {
+            const uint64_t value = getPixelValue(row, x);
+            rowPrimary = rowPrimary * PRIMARY_ROW_BASE + value;
+            rowSecondary = rowSecondary * SECONDARY_ROW_BASE + value;
+        }
+        primary = primary * PRIMARY_COLUMN_BASE + rowPrimary;
+        secondary = secondary * SECONDARY_COLUMN_BASE + rowSecondary;
+    }
+}
+
+void ExactPixelMatcher::hashRow(const cv::Mat& image, int y, int width) {
+    const auto* row = image.ptr<uint8_t>(y);
+    const int positionCols = image.cols - width + 1;
+    const uint64_t primaryLeaving = power(PRIMARY_ROW_BASE, width - 1);
+    const uint64_t secondaryLeaving = power(SECONDARY_ROW_BASE, width - 1);
+
+    uint64_t primary = 0;
+    uint64_t secondary = 0;
+    for (int x = 0; x < width - 1; x++) {
+        const uint64_t value = getPixelValue(row, x);
+        primary = primary * PRIMARY_ROW_BASE + value;
+        secondary = secondary * SECONDARY_ROW_BASE + value;
+    }
+    for (int x = 0; x < positionCols; x++) {
+        const uint64_t entering = getPixelValue(row, x + width - 1);
+        primary = primary * PRIMARY_ROW_BASE + entering;
+        secondary = secondary * SECONDARY_ROW_BASE + entering;
+        rowHashes[x * 2] = primary;
+        rowHashes[x * 2 + 1] = secondary;
+
+        // Removed after being multiplied by the base for the next pixel
+        const uint64_t leaving = getPixelValue(row, x);
+        primary -= leaving * primaryLeaving;
+        secondary -= leaving * secondaryLeaving;
+    }
+}
+
+bool ExactPixelMatcher::find(const cv::Mat& image, const PixelsHash& templHash, cv::Point& location) {
+    const int width = templHash.size.width;
+    const int height = templHash.size.height;
+    const int positionCols = image.cols - width + 1;
+    const int positionRows = image.rows - height + 1;
+    if (templHash.isEmpty() || positionCols <= 0 || positionRows <= 0) return false;
+
+    TRACE_SECTION("findExactPixels");
+    windowHashes.assign((size_t) positionCols * 2, 0);
+    rowHashes.resize((size_t) positionCols * 2);
+    const uint64_t primaryLeaving = power(PRIMARY_COLUMN_BASE, height - 1);
+    const uint64_t secondaryLeaving = power(SECONDARY_COLUMN_BASE, height - 1);
+
+    for (int y = 0; y < image.rows; y++) {
+        // Remove the row leaving the windows, its hashes are computed again instead of being kept for each row
+        if (y >= height) {
+            hashRow(image, y - height, width);
+            for (int x = 0; x < positionCols; x++) {
+                windowHashes[x * 2] -= rowHashes[x * 2] * primaryLeaving;
+                windowHashes[x * 2 + 1] -= rowHashes[x * 2 + 1] * secondaryLeaving;
+            }
+        }
+
+        hashRow(image, y, width);
+        for (int x = 0; x < positionCols; x++) {
+            windowHashes[x * 2] = windowHashes[x * 2] * PRIMARY_COLUMN_BASE + rowHashes[x * 2];
+            windowHashes[x * 2 + 1] = windowHashes[x * 2 + 1] * SECONDARY_COLUMN_BASE + rowHashes[x * 2 + 1];
+        }
+        if (y < height - 1) continue;
+
+        for (int x = 0; x < positionCols; x++) {
+            if (windowHashes[x * 2] != templHash.primary || windowHashes[x * 2 + 1] != templHash.secondary) continue;
+
+            location = cv::Point(x, y - height + 1);
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_EXACT_PIXEL_MATCHER_HPP
+#define KLICK_R_EXACT_PIXEL_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * The 2D rolling hashes of the RGB values of an image, as computed by [ExactPixelMatcher] for each window of the
+     * image size. Two independent hashes are kept, the second one verifying the hits of the first one.
+     */
+    struct PixelsHash {
+        /** The size of the hashed image. Empty if not computed. */
+        cv::Size size = cv::Size(0, 0);
+        uint64_t primary = 0;
+        uint64_t secondary = 0;
+
+        /** Compute the hashes of a CV_8UC4 image. The alpha channel is ignored. */
+        void compute(const cv::Mat& rgba);
+
+        bool isEmpty() const { return size.empty(); }
+    };
+
+    /**
+     * Finds the exact occurrences of an image with a Rabin-Karp rolling hash over the RGB values.
+     *
+     * The hash of each window is updated from the previous one by adding the entering row and removing the leaving
+     * one, so searching an area costs a few operations per pixel of the area, whatever the size of the image
+     * searched. Only the exact pixels are found: a single different value changes the hashes.
+     *
+     * The buffers are kept between the matchings to avoid allocations, this isn't thread safe.
+     */
+    class ExactPixelMatcher {
+
+    private:
+        /** The hashes of the windows of the current row of positions, for the primary and the secondary hashes. */
+        std::vector<uint64_t> windowHashes;
+        /** The row hashes of a row of the area, same layout as [windowHashes]. */
+        std::vector<uint64_t> rowHashes;
+
+        /** Compute the hashes of each window of a row of pixels into [rowHashes]. */
+        void hashRow(const cv::Mat& image, int y, int width);
+
+    public:
+        /**
+         * Find the first occurrence of an image, in reading order.
+         *
+         * @param image the CV_8UC4 area to search.
+         * @param templHash the hashes of the image to find, from [PixelsHash::compute].
+         * @param location set to the top left corner of the occurrence, relative to [image].
+         *
+         * @return true if the image has been found.
+         */
+        bool find(const cv::Mat& image, const PixelsHash& templHash, cv::Point& location);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const { return (windowHashes.capacity() + rowHashes.capacity()) * sizeof(uint64_t); }
+    };
+}
+
+#endif //KLICK_R_EXACT_PIXEL_MATCHER_HPP
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#include "feature_extractor.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+/** Radius of the pixel pairs of the descriptor pattern. They stay in the patch once rotated. */
+static constexpr int PATTERN_RADIUS = FEATURE_PATCH_RADIUS - 1;
+/** Number of pixel pairs of the descriptor pattern, one per descriptor bit. */
+static constexpr int PATTERN_SIZE = 256;
+/** Seed of the descriptor pattern, the same for all images so their descriptors can be compared. */
+static constexpr uint64_t PATTERN_SEED = 0x4b6c69636b52ull;
+
+/** A pair of the descriptor pattern, relative to the feature point. */
+struct PatternPair {
+    float x1, y1, x2, y2;
+};
+
+/** @return the descriptor pattern, pairs of random pixels of the patch with a gaussian distribution. */
+static const std::array<PatternPair, PATTERN_SIZE>& getPattern() {
+    static const std::array<PatternPair, PATTERN_SIZE> pattern = [] {
+        std::array<PatternPair, PATTERN_SIZE> pairs{};
+        cv::RNG rng(PATTERN_SEED);
+        const auto randomPoint = [&rng](float& x, float& y) {
+            do {
+                x = (float) cvRound(rng.gaussian(PATTERN_RADIUS / 2.0));
+                y = (float) cvRound(rng.gaussian(PATTERN_RADIUS / 2.0));
+            } while (x * x + y * y > PATTERN_RADIUS * PATTERN_RADIUS);
+        };
+
+        for (PatternPair& pair : pairs) {
+            do {
+                randomPoint(pair.x1, pair.y1);
+                randomPoint(pair.x2, pair.y2);
+            } while (pair.x1 == pair.x2 && pair.y1 == pair.y2);
+        }
+        return pairs;
+    }();
+
+    return pattern;
+}
+
+
+void FeatureExtractor::extract(const cv::Mat& gray, int maxPoints, FeatureSet& features) {
+    TRACE_SECTION("extractFeatures");
+    features.clear();
+    if (gray.empty() || maxPoints <= 0) return;
+
+    cv::goodFeaturesToTrack(gray, corners, maxPoints, FEATURE_QUALITY_LEVEL, FEATURE_MIN_DISTANCE);
+    if (corners.empty()) return;
+
+    cv::copyMakeBorder(gray, bordered, FEATURE_PATCH_RADIUS, FEATURE_PATCH_RADIUS, FEATURE_PATCH_RADIUS,
+                       FEATURE_PATCH_RADIUS, cv::BORDER_REFLECT_101);
+    cv::GaussianBlur(bordered, smoothed, cv::Size(5, 5), 1.5);
+
+    features.points.reserve(corners.size());
+    features.descriptors.resize(corners.size());
+    for (size_t i = 0; i < corners.size(); i++) {
+        const cv::Point2f& corner = corners[i];
+        const int x = cvRound(corner.x) + FEATURE_PATCH_RADIUS;
+        const int y = cvRound(corner.y) + FEATURE_PATCH_RADIUS;
+
+        describe(x, y, getOrientation(x, y), features.descriptors[i]);
+        features.points.push_back(corner);
+    }
+}
+
+float FeatureExtractor::getOrientation(int x, int y) const {
+    int64_t momentX = 0, momentY = 0;
+    for (int dy = -FEATURE_PATCH_RADIUS; dy <= FEATURE_PATCH_RADIUS; dy++) {
+        const uint8_t* row = smoothed.ptr<uint8_t>(y + dy) + x;
+        const int rowRadius = (int) std::sqrt(FEATURE_PATCH_RADIUS * FEATURE_PATCH_RADIUS - dy * dy);
+
+        int64_t rowSum = 0;
+        for (int dx = -rowRadius; dx <= rowRadius; dx++) {
+            momentX += dx * row[dx];
+            rowSum += row[dx];
+        }
+        momentY += dy * rowSum;
+    }
+
+    return (float) std::atan2((double) momentY, (double) momentX);
+}
+
+void FeatureExtractor::describe(int x, int y, float angle, FeatureDescriptor& descriptor) const {
+    const float cosAngle = std::cos(angle);
+    const float sinAngle = std::sin(angle);
+    const uint8_t* center = smoothed.ptr<uint8_t>(y) + x;
+    const auto step = (int) smoothed.step;
+    const auto getPixel = [&](float patternX, float patternY) {
+        const int rotatedX = cvRound(cosAngle * patternX - sinAngle * patternY);
+        const int rotatedY = cvRound(sinAngle * patternX + cosAngle * patternY);
+        return center[rotatedY * step + rotatedX];
+    };
+
+    descriptor.fill(0);
+    const std::array<PatternPair, PATTERN_SIZE>& pattern = getPattern();
+    for (int bit = 0; bit < PATTERN_SIZE; bit++) {
+        const PatternPair& pair = pattern[bit];
+        if (getPixel(pair.x1, pair.y1) < getPixel(pair.x2, pair.y2)) descriptor[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+size_t FeatureExtractor::getMemorySize() const {
+    return getMatMemorySize(bordered) + getMatMemorySize(smoothed) + corners.capacity() * sizeof(cv::Point2f);
+}
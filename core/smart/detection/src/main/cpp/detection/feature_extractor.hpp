@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FEATURE_EXTRACTOR_HPP
+#define KLICK_R_FEATURE_EXTRACTOR_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /** Radius of the patch described around each feature point, in scaled pixels. */
+    static constexpr int FEATURE_PATCH_RADIUS = 12;
+    /** Minimum distance between two feature points, in scaled pixels. */
+    static constexpr double FEATURE_MIN_DISTANCE = 3;
+    /** Minimum corner response of a feature point, relative to the strongest one of the image. */
+    static constexpr double FEATURE_QUALITY_LEVEL = 0.01;
+
+    /** A binary descriptor of 256 bits, compared with the hamming distance. */
+    using FeatureDescriptor = std::array<uint64_t, 4>;
+
+    /** @return the number of different bits between two descriptors. */
+    inline int getHammingDistance(const FeatureDescriptor& first, const FeatureDescriptor& second) {
+        return __builtin_popcountll(first[0] ^ second[0]) + __builtin_popcountll(first[1] ^ second[1])
+                + __builtin_popcountll(first[2] ^ second[2]) + __builtin_popcountll(first[3] ^ second[3]);
+    }
+
+    /** The feature points of an image, with the descriptor of each of them at the same index. */
+    struct FeatureSet {
+        std::vector<cv::Point2f> points;
+        std::vector<FeatureDescriptor> descriptors;
+
+        void clear() {
+            points.clear();
+            descriptors.clear();
+        }
+
+        size_t size() const { return points.size(); }
+
+        /** @return the memory of the points and descriptors, in bytes. */
+        size_t getMemorySize() const {
+            return points.capacity() * sizeof(cv::Point2f) + descriptors.capacity() * sizeof(FeatureDescriptor);
+        }
+    };
+
+    /**
+     * Extracts the feature points of a gray image, and describes them with oriented binary descriptors.
+     *
+     * The points are the strongest corners of the image. Each one is described by 256 intensity comparisons between
+     * pixel pairs of its smoothed patch, with a fixed pattern rotated by the patch orientation given by its intensity
+     * centroid. The descriptors of the same point are then close even if the image is rotated or scaled a bit.
+     *
+     * The buffers are kept between the images to avoid allocations, this isn't thread safe.
+     */
+    class FeatureExtractor {
+
+    private:
+        /** The image with a [FEATURE_PATCH_RADIUS] border, so the points near the edges can be described. */
+        cv::Mat bordered = cv::Mat();
+        /** [bordered] smoothed, making the comparisons robust to the noise. */
+        cv::Mat smoothed = cv::Mat();
+        /** The corners of the last image. */
+        std::vector<cv::Point2f> corners;
+
+        /** @return the orientation of the patch around a point of [smoothed], in radians. */
+        float getOrientation(int x, int y) const;
+
+        /** Compute the descriptor of the patch around a point of [smoothed], with the pattern rotated by an angle. */
+        void describe(int x, int y, float angle, FeatureDescriptor& descriptor) const;
+
+    public:
+        /**
+         * Extract the feature points of an image.
+         *
+         * @param gray the image, in 8 bits gray.
+         * @param maxPoints the maximum number of points, the strongest ones are kept.
+         * @param features receives the points in [gray] coordinates, and their descriptors. Empty for a flat image.
+         */
+        void extract(const cv::Mat& gray, int maxPoints, FeatureSet& features);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_FEATURE_EXTRACTOR_HPP
@@ -0,0 +1,263 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <opencv2/imgproc.hpp>
+
+#include "feature_matcher.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+/** Number of buckets of each hash table of the [FeatureIndex]. */
+static constexpr uint32_t FEATURE_INDEX_BUCKET_COUNT = 1u << FEATURE_INDEX_KEY_BITS;
+/** Odd multiplier spreading the key bits of the hash tables over the whole descriptor. */
+static constexpr int FEATURE_INDEX_BIT_STRIDE = 37;
+/** Minimum distance between the two condition points of a RANSAC pair, in scaled pixels. */
+static constexpr float RANSAC_MIN_PAIR_DISTANCE = 4;
+/** Seed of the RANSAC pairs, the same for each matching so the results are reproducible. */
+static constexpr uint64_t RANSAC_SEED = 0x46656174ull;
+
+/** A similarity transform, the multiplication by a complex number followed by a translation. */
+struct SimilarityTransform {
+    float real = 1, imaginary = 0;
+    float x = 0, y = 0;
+
+    cv::Point2f apply(const cv::Point2f& point) const {
+        return { real * point.x - imaginary * point.y + x, imaginary * point.x + real * point.y + y };
+    }
+
+    float getScale() const { return std::sqrt(real * real + imaginary * imaginary); }
+};
+
+/** @return the number of matches for which the transformed condition point is close to the area point. */
+static int countInliers(const SimilarityTransform& transform, const std::vector<cv::Point2f>& templatePoints,
+                        const std::vector<cv::Point2f>& areaPoints) {
+
+    int count = 0;
+    for (size_t i = 0; i < templatePoints.size(); i++) {
+        const cv::Point2f error = transform.apply(templatePoints[i]) - areaPoints[i];
+        if (error.dot(error) <= FEATURE_INLIER_DISTANCE * FEATURE_INLIER_DISTANCE) count++;
+    }
+
+    return count;
+}
+
+/** Fit a transform on the matches agreeing with it, with the least squares. */
+static SimilarityTransform refine(const SimilarityTransform& transform, const std::vector<cv::Point2f>& templatePoints,
+                                  const std::vector<cv::Point2f>& areaPoints) {
+
+    cv::Point2f templateMean(0, 0), areaMean(0, 0);
+    int count = 0;
+    for (size_t i = 0; i < templatePoints.size(); i++) {
+        const cv::Point2f error = transform.apply(templatePoints[i]) - areaPoints[i];
+        if (error.dot(error) > FEATURE_INLIER_DISTANCE * FEATURE_INLIER_DISTANCE) continue;
+        templateMean += templatePoints[i];
+        areaMean += areaPoints[i];
+        count++;
+    }
+    if (count == 0) return transform;
+    templateMean /= (float) count;
+    areaMean /= (float) count;
+
+    double real = 0, imaginary = 0, norm = 0;
+    for (size_t i = 0; i < templatePoints.size(); i++) {
+        const cv::Point2f error = transform.apply(templatePoints[i]) - areaPoints[i];
+        if (error.dot(error) > FEATURE_INLIER_DISTANCE * FEATURE_INLIER_DISTANCE) continue;
+        const cv::Point2f templ = templatePoints[i] - templateMean;
+        const cv::Point2f area = areaPoints[i] - areaMean;
+        real += area.x * templ.x + area.y * templ.y;
+        imaginary += area.y * templ.x - area.x * templ.y;
+        norm += templ.dot(templ);
+    }
+    if (norm <= 0) return transform;
+
+    SimilarityTransform refined;
+    refined.real = (float) (real / norm);
+    refined.imaginary = (float) (imaginary / norm);
+    const cv::Point2f transformedMean = refined.apply(templateMean);
+    refined.x = areaMean.x - transformedMean.x;
+    refined.y = areaMean.y - transformedMean.y;
+    return refined;
+}
+
+
+uint32_t FeatureIndex::getKey(const FeatureDescriptor& descriptor, int table) {
+    uint32_t key = 0;
+    for (int i = 0; i < FEATURE_INDEX_KEY_BITS; i++) {
+        const int bit = ((table * FEATURE_INDEX_KEY_BITS + i) * FEATURE_INDEX_BIT_STRIDE) % 256;
+        key |= (uint32_t) ((descriptor[bit / 64] >> (bit % 64)) & 1u) << i;
+    }
+
+    return key;
+}
+
+void FeatureIndex::build(const std::vector<FeatureDescriptor>& descriptors) {
+    for (int table = 0; table < FEATURE_INDEX_TABLE_COUNT; table++) {
+        std::vector<uint32_t>& starts = bucketStarts[table];
+        std::vector<uint32_t>& tableEntries = entries[table];
+
+        // Count the descriptors of each bucket, then place them after the ones of the previous buckets
+        starts.assign(FEATURE_INDEX_BUCKET_COUNT + 1, 0);
+        for (const FeatureDescriptor& descriptor : descriptors) starts[getKey(descriptor, table) + 1]++;
+        for (uint32_t bucket = 0; bucket < FEATURE_INDEX_BUCKET_COUNT; bucket++) starts[bucket + 1] += starts[bucket];
+
+        tableEntries.resize(descriptors.size());
+        std::vector<uint32_t> positions(starts.begin(), starts.end() - 1);
+        for (uint32_t i = 0; i < descriptors.size(); i++) {
+            tableEntries[positions[getKey(descriptors[i], table)]++] = i;
+        }
+    }
+}
+
+int FeatureIndex::findNearest(const FeatureDescriptor& descriptor, const std::vector<FeatureDescriptor>& descriptors,
+                              int& distance, int& secondDistance) const {
+
+    int nearestIndex = -1;
+    distance = INT_MAX;
+    secondDistance = INT_MAX;
+    for (int table = 0; table < FEATURE_INDEX_TABLE_COUNT; table++) {
+        const std::vector<uint32_t>& starts = bucketStarts[table];
+        if (starts.empty()) return -1;
+
+        const uint32_t key = getKey(descriptor, table);
+        for (uint32_t entry = starts[key]; entry < starts[key + 1]; entry++) {
+            // A descriptor can be in the same bucket than the searched one in several tables
+            const auto index = (int) entries[table][entry];
+            if (index == nearestIndex) continue;
+
+            const int candidateDistance = getHammingDistance(descriptor, descriptors[index]);
+            if (candidateDistance < distance) {
+                secondDistance = distance;
+                distance = candidateDistance;
+                nearestIndex = index;
+            } else if (candidateDistance < secondDistance) {
+                secondDistance = candidateDistance;
+            }
+        }
+    }
+
+    return nearestIndex;
+}
+
+size_t FeatureIndex::getMemorySize() const {
+    size_t size = 0;
+    for (int table = 0; table < FEATURE_INDEX_TABLE_COUNT; table++) {
+        size += (bucketStarts[table].capacity() + entries[table].capacity()) * sizeof(uint32_t);
+    }
+
+    return size;
+}
+
+void TemplateFeatures::compute(const cv::Mat& scaledGray) {
+    FeatureExtractor extractor;
+    size = scaledGray.size();
+    extractor.extract(scaledGray, TEMPLATE_MAX_FEATURES, features);
+    index.build(features.descriptors);
+}
+
+bool FeatureMatcher::match(const cv::Mat& image, uint64_t frameIndex, const cv::Rect& imageArea,
+                           const TemplateFeatures& templ, FeatureMatch& result) {
+
+    TRACE_SECTION("matchFeatures");
+    if ((int) templ.features.size() < FEATURE_MIN_INLIERS) return false;
+
+    // The features of an area are the same for all conditions searched in it on this screen image
+    if (!isAreaFeaturesValid || areaFrameIndex != frameIndex || area != imageArea) {
+        extractor.extract(image, AREA_MAX_FEATURES, areaFeatures);
+        areaFrameIndex = frameIndex;
+        area = imageArea;
+        isAreaFeaturesValid = true;
+    }
+
+    matchedTemplatePoints.clear();
+    matchedAreaPoints.clear();
+    for (size_t i = 0; i < areaFeatures.size(); i++) {
+        int distance, secondDistance;
+        const int templateIndex = templ.index.findNearest(
+                areaFeatures.descriptors[i], templ.features.descriptors, distance, secondDistance);
+
+        // Ambiguous matches, with another condition feature almost as close, are most likely wrong
+        if (templateIndex < 0 || distance > FEATURE_MAX_DISTANCE
+                || distance >= FEATURE_MAX_DISTANCE_RATIO * secondDistance) continue;
+
+        matchedTemplatePoints.push_back(templ.features.points[templateIndex]);
+        matchedAreaPoints.push_back(areaFeatures.points[i]);
+    }
+
+    const auto matchCount = (int) matchedTemplatePoints.size();
+    if (matchCount < FEATURE_MIN_INLIERS) return false;
+
+    // Each pair of matches gives a similarity transform, keep the one most matches agree with
+    TRACE_SECTION("ransac");
+    cv::RNG rng(RANSAC_SEED);
+    SimilarityTransform bestTransform;
+    int bestInlierCount = 0;
+    for (int iteration = 0; iteration < FEATURE_RANSAC_ITERATIONS; iteration++) {
+        const int first = rng.uniform(0, matchCount);
+        const int second = rng.uniform(0, matchCount);
+
+        const cv::Point2f templateVector = matchedTemplatePoints[second] - matchedTemplatePoints[first];
+        const cv::Point2f areaVector = matchedAreaPoints[second] - matchedAreaPoints[first];
+        const float norm = templateVector.dot(templateVector);
+        if (norm < RANSAC_MIN_PAIR_DISTANCE * RANSAC_MIN_PAIR_DISTANCE) continue;
+
+        SimilarityTransform transform;
+        transform.real = (areaVector.x * templateVector.x + areaVector.y * templateVector.y) / norm;
+        transform.imaginary = (areaVector.y * templateVector.x - areaVector.x * templateVector.y) / norm;
+        const float scale = transform.getScale();
+        if (scale < FEATURE_MIN_SCALE || scale > FEATURE_MAX_SCALE) continue;
+
+        const cv::Point2f transformedFirst = transform.apply(matchedTemplatePoints[first]);
+        transform.x = matchedAreaPoints[first].x - transformedFirst.x;
+        transform.y = matchedAreaPoints[first].y - transformedFirst.y;
+
+        const int inlierCount = countInliers(transform, matchedTemplatePoints, matchedAreaPoints);
+        if (inlierCount > bestInlierCount) {
+            bestInlierCount = inlierCount;
+            bestTransform = transform;
+        }
+    }
+    if (bestInlierCount < FEATURE_MIN_INLIERS) return false;
+
+    const SimilarityTransform refined = refine(bestTransform, matchedTemplatePoints, matchedAreaPoints);
+    const int refinedInlierCount = countInliers(refined, matchedTemplatePoints, matchedAreaPoints);
+    if (refinedInlierCount >= bestInlierCount) {
+        bestTransform = refined;
+        bestInlierCount = refinedInlierCount;
+    }
+
+    const auto width = (float) templ.size.width;
+    const auto height = (float) templ.size.height;
+    transformedCorners.clear();
+    transformedCorners.push_back(bestTransform.apply(cv::Point2f(0, 0)));
+    transformedCorners.push_back(bestTransform.apply(cv::Point2f(width, 0)));
+    transformedCorners.push_back(bestTransform.apply(cv::Point2f(0, height)));
+    transformedCorners.push_back(bestTransform.apply(cv::Point2f(width, height)));
+
+    result.area = cv::boundingRect(transformedCorners) & cv::Rect(0, 0, image.cols, image.rows);
+    result.confidence = std::min(1.0, (double) bestInlierCount / (double) templ.features.size());
+    return !result.area.empty();
+}
+
+size_t FeatureMatcher::getMemorySize() const {
+    return extractor.getMemorySize() + areaFeatures.getMemorySize()
+            + (matchedTemplatePoints.capacity() + matchedAreaPoints.capacity() + transformedCorners.capacity())
+            * sizeof(cv::Point2f);
+}
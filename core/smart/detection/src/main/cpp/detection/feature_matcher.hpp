@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FEATURE_MATCHER_HPP
+#define KLICK_R_FEATURE_MATCHER_HPP
+
+#include <array>
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "feature_extractor.hpp"
+
+namespace smartautoclicker {
+
+    /** Maximum number of feature points of a condition, the strongest ones are kept. */
+    static constexpr int TEMPLATE_MAX_FEATURES = 128;
+    /** Maximum number of feature points of a detection area, the strongest ones are kept. */
+    static constexpr int AREA_MAX_FEATURES = 512;
+    /** Number of hash tables of the [FeatureIndex]. More tables find more neighbours, for more lookups. */
+    static constexpr int FEATURE_INDEX_TABLE_COUNT = 8;
+    /** Number of descriptor bits in the keys of each hash table of the [FeatureIndex]. */
+    static constexpr int FEATURE_INDEX_KEY_BITS = 10;
+    /** Maximum hamming distance between the descriptors of a feature match. */
+    static constexpr int FEATURE_MAX_DISTANCE = 64;
+    /** Maximum ratio between the distances to the nearest and to the second nearest descriptors of a feature match. */
+    static constexpr double FEATURE_MAX_DISTANCE_RATIO = 0.8;
+    /** Minimum number of feature matches agreeing on the condition position to detect it. */
+    static constexpr int FEATURE_MIN_INLIERS = 6;
+    /** Maximum distance between a matched point and its expected position to agree with it, in scaled pixels. */
+    static constexpr float FEATURE_INLIER_DISTANCE = 3;
+    /** Bounds of the scale of a condition found with its feature points, relative to its image. */
+    static constexpr float FEATURE_MIN_SCALE = 0.5f;
+    static constexpr float FEATURE_MAX_SCALE = 2.0f;
+    /** Number of random match pairs tested for the condition position. */
+    static constexpr int FEATURE_RANSAC_ITERATIONS = 128;
+
+    /**
+     * Locality sensitive hashing index on binary descriptors, finding the nearest neighbours of a descriptor without
+     * comparing it with all indexed ones.
+     *
+     * Each hash table is keyed by a different subset of the descriptor bits: close descriptors are likely to have the
+     * same key in at least one table, and only the descriptors in the buckets of the searched one are compared.
+     */
+    class FeatureIndex {
+
+    private:
+        /** For each table, the index in [entries] of the first descriptor of each bucket, and the end of the last. */
+        std::array<std::vector<uint32_t>, FEATURE_INDEX_TABLE_COUNT> bucketStarts;
+        /** For each table, the index of the indexed descriptors, ordered by bucket. */
+        std::array<std::vector<uint32_t>, FEATURE_INDEX_TABLE_COUNT> entries;
+
+        /** @return the key of a descriptor in a hash table. */
+        static uint32_t getKey(const FeatureDescriptor& descriptor, int table);
+
+    public:
+        /** Index the descriptors, replacing the previous ones. */
+        void build(const std::vector<FeatureDescriptor>& descriptors);
+
+        /**
+         * Find the nearest indexed descriptor of a descriptor.
+         *
+         * @param descriptor the descriptor to search.
+         * @param descriptors the indexed descriptors, the ones given to [build].
+         * @param distance receives the hamming distance to the nearest descriptor.
+         * @param secondDistance receives the hamming distance to the second nearest one, INT_MAX if none.
+         *
+         * @return the index of the nearest descriptor, or -1 if none shares a bucket with the descriptor.
+         */
+        int findNearest(const FeatureDescriptor& descriptor, const std::vector<FeatureDescriptor>& descriptors,
+                        int& distance, int& secondDistance) const;
+
+        /** @return the memory of the hash tables, in bytes. */
+        size_t getMemorySize() const;
+    };
+
+    /** The feature points of a condition image, with their index. */
+    struct TemplateFeatures {
+        /** The size of the condition image the features have been extracted from. */
+        cv::Size size = cv::Size(0, 0);
+        FeatureSet features = FeatureSet();
+        FeatureIndex index = FeatureIndex();
+
+        /** Extract and index the features of a condition image. */
+        void compute(const cv::Mat& scaledGray);
+
+        /** @return the memory of the features and their index, in bytes. */
+        size_t getMemorySize() const {
+            return features.getMemorySize() + index.getMemorySize();
+        }
+    };
+
+    /** A condition found with its feature points. */
+    struct FeatureMatch {
+        /** The bounding box of the transformed condition, in the searched image coordinates. */
+        cv::Rect area = cv::Rect();
+        /** The part of the condition feature points found at their expected position, between 0 and 1. */
+        double confidence = 0.0;
+    };
+
+    /**
+     * Finds a condition with its feature points instead of its pixels, so it is found even if scaled, slightly
+     * rotated or partially covered, where the template correlation fails.
+     *
+     * The features of the searched area are extracted once per screen image and area, and shared by all conditions
+     * searched in it. Each area feature is matched with its nearest condition feature in the condition
+     * [FeatureIndex], and the similarity transform agreed by most matches is found by RANSAC.
+     *
+     * The buffers are kept between the matchings to avoid allocations, this isn't thread safe.
+     */
+    class FeatureMatcher {
+
+    private:
+        FeatureExtractor extractor = FeatureExtractor();
+
+        /** The features of the last searched area. */
+        FeatureSet areaFeatures = FeatureSet();
+        /** The screen image and the area [areaFeatures] have been extracted from. */
+        uint64_t areaFrameIndex = 0;
+        cv::Rect area = cv::Rect();
+        bool isAreaFeaturesValid = false;
+
+        /** The condition and area points of the feature matches, at the same index. */
+        std::vector<cv::Point2f> matchedTemplatePoints;
+        std::vector<cv::Point2f> matchedAreaPoints;
+        /** The corners of the condition, transformed in the area. */
+        std::vector<cv::Point2f> transformedCorners;
+
+    public:
+        /**
+         * Find a condition in an area of the screen.
+         *
+         * @param image the area of the screen scaled gray image.
+         * @param frameIndex identifies the content of the screen image, see [FrameSignature::getFrameIndex].
+         * @param imageArea the area of [image] in the screen image, identifying it with [frameIndex].
+         * @param templ the features of the condition to search.
+         * @param result receives the position of the condition, if found.
+         *
+         * @return true if enough feature matches agree on a position of the condition.
+         */
+        bool match(const cv::Mat& image, uint64_t frameIndex, const cv::Rect& imageArea, const TemplateFeatures& templ,
+                   FeatureMatch& result);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_FEATURE_MATCHER_HPP
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "fft_matcher.hpp"
+
+using namespace smartautoclicker;
+
+
+double FftMatcher::getCost(const cv::Size& imageSize) {
+    const auto transformArea = (double) getTransformSize(imageSize).area();
+    return FFT_COST_FACTOR * transformArea * std::log2(transformArea);
+}
+
+cv::Size FftMatcher::getTransformSize(const cv::Size& imageSize) {
+    // The valid positions never wrap around, the transform only needs to contain the image
+    return { cv::getOptimalDFTSize(imageSize.width), cv::getOptimalDFTSize(imageSize.height) };
+}
+
+void FftMatcher::computeTemplateSpectrum(const cv::Mat& templ, const cv::Size& transformSize, cv::Mat& result) {
+    cv::Mat paddedTempl = cv::Mat::zeros(transformSize, CV_32F);
+    templ.convertTo(paddedTempl(cv::Rect(0, 0, templ.cols, templ.rows)), CV_32F, 1, -cv::mean(templ)[0]);
+    cv::dft(paddedTempl, result, 0, templ.rows);
+}
+
+void FftMatcher::computeImageTransforms(const cv::Mat& image, const cv::Size& transformSize, cv::Mat& paddedImage,
+                                        FftImageTransforms& result) {
+    paddedImage.create(transformSize, CV_32F);
+    paddedImage.setTo(cv::Scalar(0));
+    image.convertTo(paddedImage(cv::Rect(0, 0, image.cols, image.rows)), CV_32F);
+    cv::dft(paddedImage, result.spectrum, 0, image.rows);
+    cv::integral(image, result.sums, result.squaredSums, CV_64F, CV_64F);
+}
+
+void FftMatcher::match(const cv::Mat& image, const cv::Mat& templ, const cv::Mat& templSpectrum, cv::Mat& results) {
+    computeImageTransforms(image, templSpectrum.size(), paddedImage, imageTransforms);
+    match(imageTransforms, templ, templSpectrum, results);
+}
+
+void FftMatcher::match(const FftImageTransforms& imageTransforms, const cv::Mat& templ, const cv::Mat& templSpectrum,
+                       cv::Mat& results) {
+    cv::Scalar templMean, templStdDev;
+    cv::meanStdDev(templ, templMean, templStdDev);
+
+    // Same as OpenCv, a template without variance matches everywhere
+    const double templVariance = templStdDev[0] * templStdDev[0];
+    if (templVariance < DBL_EPSILON) {
+        results.setTo(cv::Scalar(1));
+        return;
+    }
+
+    const auto area = (double) templ.total();
+    const double templNorm = std::sqrt(templVariance * area);
+
+    // Correlation of the image with the zero mean template, giving directly the TM_CCOEFF numerator
+    cv::mulSpectrums(imageTransforms.spectrum, templSpectrum, spectrum, 0, true);
+    cv::idft(spectrum, correlation, cv::DFT_REAL_OUTPUT | cv::DFT_SCALE, results.rows);
+
+    // Same normalization as OpenCv, including for the windows without variance
+    const cv::Mat& sums = imageTransforms.sums;
+    const cv::Mat& squaredSums = imageTransforms.squaredSums;
+    for (int y = 0; y < results.rows; y++) {
+        const auto* sumsTop = sums.ptr<double>(y);
+        const auto* sumsBottom = sums.ptr<double>(y + templ.rows);
+        const auto* squaredSumsTop = squaredSums.ptr<double>(y);
+        const auto* squaredSumsBottom = squaredSums.ptr<double>(y + templ.rows);
+        const auto* correlationRow = correlation.ptr<float>(y);
+        auto* resultRow = results.ptr<float>(y);
+
+        for (int x = 0; x < results.cols; x++) {
+            const int right = x + templ.cols;
+            const double windowSum = sumsBottom[right] - sumsBottom[x] - sumsTop[right] + sumsTop[x];
+            const double windowSquaredSum =
+                    squaredSumsBottom[right] - squaredSumsBottom[x] - squaredSumsTop[right] + squaredSumsTop[x];
+            const double norm = std::sqrt(std::max(windowSquaredSum - windowSum * windowSum / area, 0.0)) * templNorm;
+
+            const double value = correlationRow[x];
+            if (std::fabs(value) < norm) resultRow[x] = (float) (value / norm);
+            else if (std::fabs(value) < norm * 1.125) resultRow[x] = value > 0 ? 1.f : -1.f;
+            else resultRow[x] = 0.f;
+        }
+    }
+}
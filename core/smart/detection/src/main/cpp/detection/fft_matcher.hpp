@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FFT_MATCHER_HPP
+#define KLICK_R_FFT_MATCHER_HPP
+
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /** Minimum template area for the FFT matching, below the direct correlation is always faster. */
+    static constexpr int FFT_MATCHING_MIN_TEMPLATE_AREA = 32 * 32;
+
+    /**
+     * The transforms of an image for the FFT matching. They don't depend on the template, and can be shared by all the
+     * conditions searched in the same image, see [DetectionImage::getFftTransforms].
+     */
+    struct FftImageTransforms {
+        /** The spectrum of the image converted to float and zero padded to the transform size. */
+        cv::Mat spectrum = cv::Mat();
+        /** Integral images of the image and its square, in CV_64F. */
+        cv::Mat sums = cv::Mat();
+        cv::Mat squaredSums = cv::Mat();
+    };
+
+    /**
+     * Template matching with the TM_CCOEFF_NORMED semantics, correlating in the frequency domain.
+     *
+     * The whole image is transformed at once, and the spectrum of the zero mean template is provided by the caller,
+     * allowing to compute it once per condition. This scales with the image size only, and is a lot faster than the
+     * direct correlation for big templates.
+     */
+    class FftMatcher {
+
+    private:
+        /** Estimated cost of the transforms per pixel and per log2 of the transform area, relative to a correlation. */
+        static constexpr double FFT_COST_FACTOR = 6.0;
+
+        /** The image converted to float and zero padded to the transform size. */
+        cv::Mat paddedImage;
+        /** The transforms of the image, when they are not provided by the caller. */
+        FftImageTransforms imageTransforms;
+        /** The product of the image and template spectrums. */
+        cv::Mat spectrum;
+        /** The correlation of the image with the zero mean template, in the spatial domain. */
+        cv::Mat correlation;
+
+    public:
+        /**
+         * @return the estimated cost of the FFT matching in an image of this size, in direct correlation multiply
+         * adds. It doesn't depends on the template size.
+         */
+        static double getCost(const cv::Size& imageSize);
+
+        /** @return the size of the transforms for an image size. */
+        static cv::Size getTransformSize(const cv::Size& imageSize);
+
+        /**
+         * Compute the spectrum of a template, as expected by [match].
+         *
+         * @param templ the template, in 8 bits gray.
+         * @param transformSize the size of the transform, from [getTransformSize].
+         * @param result the spectrum of the zero mean template.
+         */
+        static void computeTemplateSpectrum(const cv::Mat& templ, const cv::Size& transformSize, cv::Mat& result);
+
+        /**
+         * Compute the transforms of an image, as expected by [match].
+         *
+         * @param image the image, in 8 bits gray.
+         * @param transformSize the size of the transform, from [getTransformSize].
+         * @param paddedImage the scratch matrix for the zero padded image.
+         * @param result set to the transforms of the image.
+         */
+        static void computeImageTransforms(const cv::Mat& image, const cv::Size& transformSize, cv::Mat& paddedImage,
+                                           FftImageTransforms& result);
+
+        /**
+         * Match the template in the image.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the template to search, in 8 bits gray.
+         * @param templSpectrum the spectrum of the template, for the transform size of the image.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const cv::Mat& templ, const cv::Mat& templSpectrum, cv::Mat& results);
+
+        /**
+         * Match the template in an image, from its transforms computed beforehand.
+         *
+         * @param imageTransforms the transforms of the image, from [computeImageTransforms].
+         * @param templ the template to search, in 8 bits gray.
+         * @param templSpectrum the spectrum of the template, for the transform size of the image.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const FftImageTransforms& imageTransforms, const cv::Mat& templ, const cv::Mat& templSpectrum,
+                   cv::Mat& results);
+    };
+}
+
+#endif //KLICK_R_FFT_MATCHER_HPP
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "frame_broker.hpp"
+
+using namespace smartautoclicker;
+
+bool FrameBroker::Key::operator==(const Key& other) const {
+    return frameId == other.frameId && pixels == other.pixels && width == other.width && height == other.height
+            && rowStride == other.rowStride && fullSize == other.fullSize && scaleRatio == other.scaleRatio
+            && regions == other.regions && isScaledColorOnly == other.isScaledColorOnly;
+}
+
+FrameBroker& FrameBroker::getInstance() {
+    static FrameBroker instance;
+    return instance;
+}
+
+FrameBroker::Key FrameBroker::getKey(int64_t frameId, const PixelsBuffer& pixels, const cv::Size& fullSize,
+                                     double scaleRatio, const DetectionImage& settings) {
+    return {
+        frameId,
+        pixels.pixels,
+        pixels.width,
+        pixels.height,
+        pixels.rowStride,
+        fullSize,
+        scaleRatio,
+        settings.getRegions(),
+        settings.isScaledColorOnly,
+    };
+}
+
+uint64_t FrameBroker::newFrameIndex() {
+    return lastFrameIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+std::shared_ptr<DetectionImage> FrameBroker::find(const Key& key) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (const Entry& entry : entries) {
+        if (entry.key == key) return entry.image.lock();
+    }
+    return nullptr;
+}
+
+void FrameBroker::publish(const Key& key, const std::shared_ptr<DetectionImage>& image) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // The images of the destroyed detectors are never withdrawn, they are removed once released
+    entries.erase(
+            std::remove_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.image.expired(); }),
+            entries.end());
+
+    for (const Entry& entry : entries) {
+        if (entry.key == key) return;
+    }
+    entries.push_back({ key, image, image.get() });
+}
+
+void FrameBroker::withdraw(const DetectionImage* image) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    entries.erase(
+            std::remove_if(entries.begin(), entries.end(), [image](const Entry& entry) {
+                return entry.address == image || entry.image.expired();
+            }),
+            entries.end());
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FRAME_BROKER_HPP
+#define KLICK_R_FRAME_BROKER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <opencv2/core/types.hpp>
+
+#include "detection_image.hpp"
+#include "../types/pixels_buffer.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Process wide registry of the processed screen images, shared by all detectors detecting the same frames.
+     *
+     * The detection, the tries of the scenario config and the debug sessions each have their own detector, but they
+     * can be provided the same captured frame. The first detector setting it processes it into a [DetectionImage] and
+     * publishes it, the other ones read that image instead of converting the same pixels again. A published image is
+     * never written anymore: only its lazily computed data is added, under its own locks, by the concurrent matchings.
+     *
+     * The images are only referenced weakly and withdrawn by their detector once it stops using them, the memory of
+     * the broker stays the one of the detectors.
+     */
+    class FrameBroker {
+
+    public:
+        /** Identifies the processing of a frame: the same pixels, processed with the same settings. */
+        struct Key {
+            /** The identifier of the captured frame, such as its timestamp. Never 0. */
+            int64_t frameId = 0;
+            const uint8_t* pixels = nullptr;
+            int width = 0;
+            int height = 0;
+            size_t rowStride = 0;
+            cv::Size fullSize = cv::Size();
+            double scaleRatio = 0;
+            std::vector<cv::Rect> regions;
+            bool isScaledColorOnly = false;
+
+            bool operator==(const Key& other) const;
+        };
+
+    private:
+        struct Entry {
+            Key key = Key();
+            std::weak_ptr<DetectionImage> image;
+            /** The address of [image], to withdraw it without locking it. */
+            const DetectionImage* address = nullptr;
+        };
+
+        /** The last index returned by [newFrameIndex]. */
+        std::atomic<uint64_t> lastFrameIndex = 0;
+
+        /** Protects the fields below. */
+        std::mutex mutex;
+        /** The published images, at most the current one of each detector. */
+        std::vector<Entry> entries;
+
+        FrameBroker() = default;
+
+    public:
+        FrameBroker(const FrameBroker&) = delete;
+        FrameBroker& operator=(const FrameBroker&) = delete;
+
+        /** @return the broker of the process. */
+        static FrameBroker& getInstance();
+
+        /**
+         * Get the key of a frame processing.
+         *
+         * @param frameId the identifier of the captured frame, never 0.
+         * @param pixels the pixels of the frame.
+         * @param fullSize the size of the screen, bigger than the pixels size when it is captured downscaled.
+         * @param scaleRatio the scale ratio of the processing.
+         * @param settings an image with the processing settings of the detector: its regions and color pixels.
+         */
+        static Key getKey(int64_t frameId, const PixelsBuffer& pixels, const cv::Size& fullSize, double scaleRatio,
+                          const DetectionImage& settings);
+
+        /**
+         * @return a new index for the [DetectionImage::frameIndex] of a processed image. Unique in the process, the
+         *         images being read by several detectors. Can be called from any thread.
+         */
+        uint64_t newFrameIndex();
+
+        /**
+         * Find the image published by another detector for a frame processing. Can be called from any thread.
+         *
+         * @return the image, to keep while it is read, or nullptr if this frame processing is not published.
+         */
+        std::shared_ptr<DetectionImage> find(const Key& key);
+
+        /**
+         * Publish a processed image for the other detectors. It must not be written until it is withdrawn, and its
+         * pixels must remain valid while the frame can be set in another detector. Ignored if another detector have
+         * published this frame processing in the meantime. Can be called from any thread.
+         */
+        void publish(const Key& key, const std::shared_ptr<DetectionImage>& image);
+
+        /**
+         * Stop publishing an image. Once withdrawn, it is only read by the detectors that found it before, and if
+         * none does, its owner can write it again. Can be called from any thread.
+         */
+        void withdraw(const DetectionImage* image);
+    };
+}
+
+#endif //KLICK_R_FRAME_BROKER_HPP
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "frame_signature.hpp"
+
+using namespace smartautoclicker;
+
+/** FNV-1a 64 bits constants. */
+static constexpr uint64_t HASH_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static constexpr uint64_t HASH_PRIME = 0x100000001b3ULL;
+
+
+bool FrameSignature::update(const cv::Mat& image) {
+    computingHashes.resize(getTileCount(image.size()));
+    computeTileHashes(image, 0, image.rows, computingHashes.data());
+
+    return update(image.size(), computingHashes);
+}
+
+bool FrameSignature::update(const cv::Mat& image, const std::vector<cv::Rect>& regions) {
+    if (regions.empty()) return update(image);
+
+    const int columns = (image.cols + TILE_SIZE - 1) / TILE_SIZE;
+    const size_t tileCount = getTileCount(image.size());
+    const cv::Rect imageRoi(0, 0, image.cols, image.rows);
+    regionTiles.assign(tileCount, 0);
+    for (const cv::Rect& region : regions) {
+        const cv::Rect roi = region & imageRoi;
+        if (roi.empty()) continue;
+
+        for (int tileY = roi.y / TILE_SIZE; tileY <= (roi.y + roi.height - 1) / TILE_SIZE; tileY++) {
+            for (int tileX = roi.x / TILE_SIZE; tileX <= (roi.x + roi.width - 1) / TILE_SIZE; tileX++) {
+                regionTiles[(size_t) tileY * columns + tileX] = 1;
+            }
+        }
+    }
+
+    // Same hashes as computeTileHashes for the tiles of the regions, the others keep the same value on each image
+    computingHashes.assign(tileCount, HASH_OFFSET_BASIS);
+    for (size_t tile = 0; tile < tileCount; tile++) {
+        if (regionTiles[tile] == 0) continue;
+
+        const int segmentStart = (int) (tile % columns) * TILE_SIZE;
+        const int segmentLength = std::min(TILE_SIZE, image.cols - segmentStart);
+        const int firstRow = (int) (tile / columns) * TILE_SIZE;
+        const int endRow = std::min(firstRow + TILE_SIZE, image.rows);
+        uint64_t hash = HASH_OFFSET_BASIS;
+        for (int y = firstRow; y < endRow; y++) {
+            hash = hashRowSegment(hash, image.ptr<uint8_t>(y) + segmentStart, segmentLength);
+        }
+        computingHashes[tile] = hash;
+    }
+
+    return update(image.size(), computingHashes);
+}
+
+bool FrameSignature::update(const cv::Size& size, std::vector<uint64_t>& hashes) {
+    const bool isSameSize = size == imageSize && !tileHashes.empty();
+
+    bool isUnchanged = isSameSize;
+    if (isSameSize) {
+        dirtyTiles.resize(hashes.size());
+        for (size_t i = 0; i < hashes.size(); i++) {
+            dirtyTiles[i] = hashes[i] != tileHashes[i] ? 1 : 0;
+            isUnchanged = isUnchanged && dirtyTiles[i] == 0;
+        }
+    }
+    hasPreviousImage = isSameSize;
+    frameIndex++;
+
+    tileHashes.swap(hashes);
+    tileColumns = (size.width + TILE_SIZE - 1) / TILE_SIZE;
+    imageSize = size;
+
+    return isUnchanged;
+}
+
+size_t FrameSignature::getTileCount(const cv::Size& size) {
+    return (size_t) ((size.width + TILE_SIZE - 1) / TILE_SIZE) * ((size.height + TILE_SIZE - 1) / TILE_SIZE);
+}
+
+void FrameSignature::computeTileHashes(const cv::Mat& image, int firstRow, int endRow, uint64_t* hashes) {
+    const int columns = (image.cols + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Hash each row once, splitting it in the segments belonging to each tile
+    for (int y = firstRow; y < endRow; y++) {
+        const uint8_t* row = image.ptr<uint8_t>(y);
+        uint64_t* rowTileHashes = hashes + (size_t) (y / TILE_SIZE) * columns;
+        if (y % TILE_SIZE == 0) std::fill(rowTileHashes, rowTileHashes + columns, HASH_OFFSET_BASIS);
+
+        for (int tileX = 0; tileX < columns; tileX++) {
+            const int segmentStart = tileX * TILE_SIZE;
+            const int segmentLength = std::min(TILE_SIZE, image.cols - segmentStart);
+            rowTileHashes[tileX] = hashRowSegment(rowTileHashes[tileX], row + segmentStart, segmentLength);
+        }
+    }
+}
+
+bool FrameSignature::isDirty(const cv::Rect& roi) const {
+    if (!hasPreviousImage) return true;
+
+    const cv::Rect imageRoi = roi & cv::Rect(0, 0, imageSize.width, imageSize.height);
+    if (imageRoi.empty()) return true;
+
+    const int firstColumn = imageRoi.x / TILE_SIZE;
+    const int lastColumn = (imageRoi.x + imageRoi.width - 1) / TILE_SIZE;
+    const int firstRow = imageRoi.y / TILE_SIZE;
+    const int lastRow = (imageRoi.y + imageRoi.height - 1) / TILE_SIZE;
+
+    for (int tileY = firstRow; tileY <= lastRow; tileY++) {
+        const uint8_t* rowDirtyTiles = dirtyTiles.data() + (size_t) tileY * tileColumns;
+        for (int tileX = firstColumn; tileX <= lastColumn; tileX++) {
+            if (rowDirtyTiles[tileX] != 0) return true;
+        }
+    }
+
+    return false;
+}
+
+size_t FrameSignature::getMemorySize() const {
+    return (tileHashes.capacity() + computingHashes.capacity()) * sizeof(uint64_t) + dirtyTiles.capacity();
+}
+
+void FrameSignature::clear() {
+    frameIndex++;
+    hasPreviousImage = false;
+    dirtyTiles.clear();
+    tileHashes.clear();
+    tileColumns = 0;
+    imageSize.width = 0;
+    imageSize.height = 0;
+}
+
+uint64_t FrameSignature::hashRowSegment(uint64_t hash, const uint8_t* data, int length) {
+    // Consume 8 bytes at once, as the segments are way bigger than a word
+    int i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * HASH_PRIME;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ data[i]) * HASH_PRIME;
+    }
+
+    return hash;
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FRAME_SIGNATURE_HPP
+#define KLICK_R_FRAME_SIGNATURE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+#include <opencv2/core/types.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * Cheap signature of a gray image, made of one hash per tile of [TILE_SIZE] pixels.
+     * It allows to know if a screen image is identical to the previous one without running any detection on it.
+     */
+    class FrameSignature {
+
+    public:
+        /** Size of the side of a tile, in pixels. */
+        static constexpr int TILE_SIZE = 32;
+
+    private:
+        /** The size of the image the signature have been computed for. */
+        cv::Size imageSize = cv::Size(0, 0);
+        /** The number of tiles on each row of the signature. */
+        int tileColumns = 0;
+        /** The hash of each tile, row by row. */
+        std::vector<uint64_t> tileHashes;
+        /** The hash of each tile being computed. Kept to avoid allocations. */
+        std::vector<uint64_t> computingHashes;
+        /** For each tile, 1 if it intersects the regions being hashed. Kept to avoid allocations. */
+        std::vector<uint8_t> regionTiles;
+        /** For each tile, 1 if its content is different from the previous image, 0 if not. */
+        std::vector<uint8_t> dirtyTiles;
+        /** True if [dirtyTiles] have been computed against a previous image of the same size. */
+        bool hasPreviousImage = false;
+        /** Incremented for each new image, or when the signature is dropped. */
+        uint64_t frameIndex = 0;
+
+        static uint64_t hashRowSegment(uint64_t hash, const uint8_t* data, int length);
+
+    public:
+        FrameSignature() = default;
+
+        /**
+         * Compute the signature of a new image, replacing the previous one.
+         *
+         * @param image the gray image to compute the signature of.
+         *
+         * @return true if the image is identical to the previous one, false if not or if there was no previous image.
+         */
+        bool update(const cv::Mat& image);
+
+        /**
+         * Same as [update], only hashing the tiles intersecting some regions of the image. The other tiles are
+         * considered as never changing: the image must only be read in those regions.
+         *
+         * @param image the gray image to compute the signature of.
+         * @param regions the regions of the image to hash, in the image coordinates. Empty to hash the whole image.
+         *
+         * @return true if the regions are identical to the previous image, false if not or if there was no previous
+         *         image.
+         */
+        bool update(const cv::Mat& image, const std::vector<cv::Rect>& regions);
+
+        /**
+         * Same as [update], with the tile hashes of the new image already computed with [computeTileHashes].
+         *
+         * @param size the size of the new image.
+         * @param hashes the tile hashes of the new image. Swapped with the previous ones, its content is undefined
+         *               after the call.
+         *
+         * @return true if the image is identical to the previous one, false if not or if there was no previous image.
+         */
+        bool update(const cv::Size& size, std::vector<uint64_t>& hashes);
+
+        /** @return the number of tile hashes of an image of this size. */
+        static size_t getTileCount(const cv::Size& size);
+
+        /**
+         * Compute the tile hashes of some rows of an image, allowing to hash them while they are still in the cache
+         * after being written. Can be called concurrently for different rows.
+         *
+         * @param image the gray image to hash.
+         * @param firstRow the first row to hash. Must be the first row of a tile.
+         * @param endRow the row after the last one to hash. Must be the first row of a tile, or the image height.
+         * @param hashes the hashes of all tiles of the image, [getTileCount] values. Only the tiles of the rows are
+         *               written.
+         */
+        static void computeTileHashes(const cv::Mat& image, int firstRow, int endRow, uint64_t* hashes);
+
+        /** @return the index of the last image. Images with consecutive indexes can be compared with [isDirty]. */
+        uint64_t getFrameIndex() const { return frameIndex; }
+
+        /** @return the size of the last image. */
+        const cv::Size& getImageSize() const { return imageSize; }
+
+        /** @return true if the last image have been compared with a previous one of the same size. */
+        bool hasPrevious() const { return hasPreviousImage; }
+
+        /**
+         * @return for each tile of [TILE_SIZE] pixels, row by row, 1 if its content is different from the previous
+         *         image, 0 if not. Only valid if [hasPrevious].
+         */
+        const std::vector<uint8_t>& getDirtyTiles() const { return dirtyTiles; }
+
+        /**
+         * Tells if a region of the last image have changed since the previous one.
+         *
+         * @param roi the region to check, in the image coordinates.
+         *
+         * @return true if at least one tile intersecting the roi have changed, or if there was no previous image.
+         */
+        bool isDirty(const cv::Rect& roi) const;
+
+        /** @return the memory of the tile hashes of this signature, in bytes. */
+        size_t getMemorySize() const;
+
+        /** Drop the current signature. Next call to [update] will always report a different image. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_FRAME_SIGNATURE_HPP
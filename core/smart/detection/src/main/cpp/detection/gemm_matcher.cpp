@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "gemm_matcher.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/cpu_features.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+/** @return the dot product of two rows of the matrices. Exact in 32 bits for the batch template areas. */
+static inline uint32_t getDotProduct(const uint8_t* first, const uint8_t* second, int length) {
+    uint32_t product = 0;
+    int i = 0;
+
+#if defined(__ARM_NEON)
+    uint32x4_t products = vdupq_n_u32(0);
+    for (; i + 16 <= length; i += 16) {
+        const uint8x16_t firstValues = vld1q_u8(first + i);
+        const uint8x16_t secondValues = vld1q_u8(second + i);
+        products = vpadalq_u16(products, vmull_u8(vget_low_u8(firstValues), vget_low_u8(secondValues)));
+        products = vpadalq_u16(products, vmull_u8(vget_high_u8(firstValues), vget_high_u8(secondValues)));
+    }
+    const uint64x2_t pairs = vpaddlq_u32(products);
+    product = (uint32_t) (vgetq_lane_u64(pairs, 0) + vgetq_lane_u64(pairs, 1));
+#endif
+
+    for (; i < length; i++) product += (uint32_t) first[i] * second[i];
+    return product;
+}
+
+#if defined(SMART_DETECTION_DOTPROD_KERNELS)
+/** Same as [getDotProduct], with the dot product instructions: 16 products per instruction instead of 4. */
+DOTPROD_TARGET static uint32_t getDotProductWithDotInstructions(const uint8_t* first, const uint8_t* second,
+                                                                int length) {
+
+    uint32x4_t products = vdupq_n_u32(0);
+    int i = 0;
+    for (; i + 16 <= length; i += 16) products = vdotq_u32(products, vld1q_u8(first + i), vld1q_u8(second + i));
+
+    uint32_t product = vaddvq_u32(products);
+    for (; i < length; i++) product += (uint32_t) first[i] * second[i];
+    return product;
+}
+#endif
+
+cv::Size GemmMatcher::getBatchSize(const cv::Size& templSize) {
+    return {
+        (templSize.width + GEMM_SIZE_STEP - 1) / GEMM_SIZE_STEP * GEMM_SIZE_STEP,
+        (templSize.height + GEMM_SIZE_STEP - 1) / GEMM_SIZE_STEP * GEMM_SIZE_STEP,
+    };
+}
+
+bool GemmMatcher::isSupported(const cv::Size& templSize) {
+    return !templSize.empty() && getBatchSize(templSize).area() <= GEMM_MAX_TEMPLATE_AREA;
+}
+
+void GemmMatcher::match(const cv::Mat& image, std::vector<Job>& jobs) {
+    if (jobs.empty()) return;
+    TRACE_SECTION("gemmMatch");
+
+    // The smallest template has the most positions, the padded windows of all of them must be in the image
+    const cv::Size batchSize = getBatchSize(jobs.front().templ->size());
+    const int batchArea = batchSize.area();
+    cv::Size minSize = batchSize;
+    for (Job& job : jobs) {
+        const cv::Mat& templ = *job.templ;
+        minSize = cv::Size(std::min(minSize.width, templ.cols), std::min(minSize.height, templ.rows));
+        job.results->create(image.rows - templ.rows + 1, image.cols - templ.cols + 1, CV_32F);
+    }
+    const int positionCols = image.cols - minSize.width + 1;
+    const int positionRows = image.rows - minSize.height + 1;
+    if (positionCols <= 0 || positionRows <= 0) return;
+
+    cv::copyMakeBorder(image, paddedImage, 0, batchSize.height - minSize.height, 0, batchSize.width - minSize.width,
+                       cv::BORDER_CONSTANT, cv::Scalar(0));
+    // The squared sums are exact integers in double up to 2^53, far above the screen sizes
+    cv::integral(image, sums, squaredSums, CV_32S, CV_64F);
+
+    templatesMatrix.assign(jobs.size() * batchArea, 0);
+    for (size_t n = 0; n < jobs.size(); n++) {
+        const cv::Mat& templ = *jobs[n].templ;
+        for (int y = 0; y < templ.rows; y++) {
+            std::memcpy(&templatesMatrix[n * batchArea + y * batchSize.width], templ.ptr<uint8_t>(y), templ.cols);
+        }
+    }
+    windowsMatrix.resize((size_t) TILE_POSITIONS * batchArea);
+    correlations.resize(jobs.size() * TILE_POSITIONS);
+
+    uint32_t (*dotProduct)(const uint8_t*, const uint8_t*, int) = getDotProduct;
+#if defined(SMART_DETECTION_DOTPROD_KERNELS)
+    if (CpuFeatures::hasDotProduct()) dotProduct = getDotProductWithDotInstructions;
+#endif
+
+    for (int y = 0; y < positionRows; y++) {
+        for (int tileX = 0; tileX < positionCols; tileX += TILE_POSITIONS) {
+            const int tileCount = std::min(TILE_POSITIONS, positionCols - tileX);
+
+            // Unfold the windows of the tile, read from the screen once for all templates
+            for (int i = 0; i < tileCount; i++) {
+                uint8_t* window = &windowsMatrix[(size_t) i * batchArea];
+                for (int row = 0; row < batchSize.height; row++) {
+                    std::memcpy(window + row * batchSize.width, paddedImage.ptr<uint8_t>(y + row) + tileX + i,
+                                batchSize.width);
+                }
+            }
+
+            for (size_t n = 0; n < jobs.size(); n++) {
+                const uint8_t* templRow = &templatesMatrix[n * batchArea];
+                for (int i = 0; i < tileCount; i++) {
+                    correlations[n * TILE_POSITIONS + i] = dotProduct(
+                            templRow, &windowsMatrix[(size_t) i * batchArea], batchArea);
+                }
+            }
+
+            // Normalized with the window of each template, its padding is outside of it
+            for (size_t n = 0; n < jobs.size(); n++) {
+                const Job& job = jobs[n];
+                cv::Mat& results = *job.results;
+                if (y >= results.rows) continue;
+
+                const int height = job.templ->rows;
+                const int width = job.templ->cols;
+                const int* sumsTop = sums.ptr<int>(y);
+                const int* sumsBottom = sums.ptr<int>(y + height);
+                const auto* squaredSumsTop = squaredSums.ptr<double>(y);
+                const auto* squaredSumsBottom = squaredSums.ptr<double>(y + height);
+                auto* resultsRow = results.ptr<float>(y);
+                const int tileEnd = std::min(tileX + tileCount, results.cols);
+
+                for (int x = tileX; x < tileEnd; x++) {
+                    if (job.statistics->isFlat()) {
+                        resultsRow[x] = 1;
+                        continue;
+                    }
+
+                    const int64_t windowSum = (int64_t) sumsBottom[x + width] - sumsBottom[x]
+                            - sumsTop[x + width] + sumsTop[x];
+                    const auto windowSquaredSum = (int64_t) (squaredSumsBottom[x + width] - squaredSumsBottom[x]
+                            - squaredSumsTop[x + width] + squaredSumsTop[x]);
+                    resultsRow[x] = job.statistics->getNormedValue(
+                            correlations[n * TILE_POSITIONS + x - tileX], windowSum, windowSquaredSum);
+                }
+            }
+        }
+    }
+}
+
+size_t GemmMatcher::getMemorySize() const {
+    return getMatMemorySize(paddedImage) + getMatMemorySize(sums) + getMatMemorySize(squaredSums)
+            + templatesMatrix.capacity() + windowsMatrix.capacity() + correlations.capacity() * sizeof(uint32_t);
+}
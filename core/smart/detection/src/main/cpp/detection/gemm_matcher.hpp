@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_GEMM_MATCHER_HPP
+#define KLICK_R_GEMM_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "template_statistics.hpp"
+
+namespace smartautoclicker {
+
+    /** Maximum template area of the batched matching, padded to the batch size. Above, the transforms are faster. */
+    static constexpr int GEMM_MAX_TEMPLATE_AREA = 32 * 32;
+    /** The template sizes of a batch are rounded up to a multiple of this step, and padded with zeros to it. */
+    static constexpr int GEMM_SIZE_STEP = 4;
+    /** Minimum number of templates in a batch. Below, the screen pixels are not read enough times to gain anything. */
+    static constexpr size_t GEMM_MIN_BATCH_SIZE = 2;
+
+    /**
+     * Template matching of several templates in the same image at once, with the TM_CCOEFF_NORMED semantics.
+     *
+     * The templates are packed, padded with zeros to the same size, as the rows of a matrix. The windows of a tile of
+     * positions are unfolded once in another matrix (im2col), and the correlations of all templates with them are
+     * the product of both matrices, computed with integer dot products, with the ARMv8.2 dot product instructions
+     * when the CPU has them. Each screen pixel is then read once per tile
+     * for all templates, instead of once per template.
+     *
+     * The buffers are kept between the matchings to avoid allocations, this isn't thread safe.
+     */
+    class GemmMatcher {
+
+    public:
+        /** A template of a batch, with its results. */
+        struct Job {
+            /** The template to match, in 8 bits gray. Its area padded to the batch size is below the maximum. */
+            const cv::Mat* templ = nullptr;
+            /** The statistics of the template. */
+            const TemplateStatistics* statistics = nullptr;
+            /** The matching results, allocated by [match] to the cv::matchTemplate results size. */
+            cv::Mat* results = nullptr;
+        };
+
+    private:
+        /** Number of positions unfolded at once. */
+        static constexpr int TILE_POSITIONS = 64;
+
+        /** The image padded with zeros, so the padded windows of all positions are in it. */
+        cv::Mat paddedImage;
+        /** Integral images of the image and its square. */
+        cv::Mat sums;
+        cv::Mat squaredSums;
+        /** The padded templates, one per row. */
+        std::vector<uint8_t> templatesMatrix;
+        /** The unfolded windows of a tile of positions, one per row. */
+        std::vector<uint8_t> windowsMatrix;
+        /** The raw correlations of each template with each window of the tile. */
+        std::vector<uint32_t> correlations;
+
+    public:
+        /** @return the size of the batch containing a template of this size. */
+        static cv::Size getBatchSize(const cv::Size& templSize);
+
+        /** @return true if a template of this size can be matched in a batch. */
+        static bool isSupported(const cv::Size& templSize);
+
+        /**
+         * Match all templates of a batch in the image. The results have the same values as cv::matchTemplate with
+         * TM_CCOEFF_NORMED, with an exact correlation.
+         *
+         * @param image the image to search in, in 8 bits gray. All templates must fit in it.
+         * @param jobs the templates, all with the same [getBatchSize].
+         */
+        void match(const cv::Mat& image, std::vector<Job>& jobs);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_GEMM_MATCHER_HPP
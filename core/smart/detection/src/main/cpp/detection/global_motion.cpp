@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <opencv2/imgproc.hpp>
+
+#include "global_motion.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+void GlobalMotion::update(const cv::Mat& scaledGray, const FrameSignature& signature) {
+    TRACE_SECTION("globalMotion");
+    isShifted = false;
+    frameIndex = signature.getFrameIndex();
+
+    // Nothing moved, the previous image is still the same as this one
+    const bool isComparable = signature.hasPrevious() && previousScaledGray.size() == scaledGray.size();
+    const std::vector<uint8_t>& dirtyTiles = signature.getDirtyTiles();
+    const int dirtyCount = isComparable ? (int) std::count(dirtyTiles.begin(), dirtyTiles.end(), 1) : 0;
+    if (isComparable && dirtyCount == 0) return;
+
+    imageSize = scaledGray.size();
+    tileColumns = (imageSize.width + FrameSignature::TILE_SIZE - 1) / FrameSignature::TILE_SIZE;
+    const cv::Size downscaledSize(scaledGray.cols / DOWNSCALE_FACTOR, scaledGray.rows / DOWNSCALE_FACTOR);
+    if (downscaledSize.width < MIN_DOWNSCALED_SIZE || downscaledSize.height < MIN_DOWNSCALED_SIZE) {
+        clear();
+        return;
+    }
+
+    cv::Mat downscaledGray;
+    cv::resize(scaledGray, downscaledGray, downscaledSize, 0, 0, cv::INTER_AREA);
+    downscaledGray.convertTo(downscaled, CV_32F);
+
+    cv::Point correlatedShift;
+    if (isComparable && correlate(correlatedShift)) {
+        shift = refine(scaledGray, correlatedShift);
+        if (shift != cv::Point(0, 0)) {
+            const int movedCount = computeMovedTiles(scaledGray, signature);
+            isShifted = movedCount > 0 && movedCount >= dirtyCount * MIN_MOVED_TILES_RATIO;
+        }
+    }
+
+    scaledGray.copyTo(previousScaledGray);
+    std::swap(previousDownscaled, downscaled);
+}
+
+bool GlobalMotion::correlate(cv::Point& coarseShift) {
+    if (previousDownscaled.size() != downscaled.size()) return false;
+    if (window.size() != downscaled.size()) cv::createHanningWindow(window, downscaled.size(), CV_32F);
+
+    // The shift of the current image relative to the previous one, in downscaled pixels
+    double response = 0;
+    const cv::Point2d phaseShift = cv::phaseCorrelate(previousDownscaled, downscaled, window, &response);
+    if (response < MIN_RESPONSE
+            || std::abs(phaseShift.x) > downscaled.cols * MAX_SHIFT_RATIO
+            || std::abs(phaseShift.y) > downscaled.rows * MAX_SHIFT_RATIO) return false;
+
+    coarseShift = cv::Point(cvRound(phaseShift.x * DOWNSCALE_FACTOR), cvRound(phaseShift.y * DOWNSCALE_FACTOR));
+    return true;
+}
+
+cv::Point GlobalMotion::refine(const cv::Mat& scaledGray, const cv::Point& correlatedShift) const {
+    cv::Point bestShift = correlatedShift;
+    double bestDiff = DBL_MAX;
+
+    // The sign of the correlated shift is not specified by OpenCv, both directions are compared
+    const cv::Point centers[] = { correlatedShift, -correlatedShift };
+    for (const cv::Point& center : centers) {
+        for (int dy = -REFINE_RADIUS; dy <= REFINE_RADIUS; dy++) {
+            for (int dx = -REFINE_RADIUS; dx <= REFINE_RADIUS; dx++) {
+                const cv::Point candidate = center + cv::Point(dx, dy);
+
+                // The part of the current image whose previous content is in the previous image
+                const cv::Rect overlap(
+                        std::max(0, candidate.x),
+                        std::max(0, candidate.y),
+                        imageSize.width - std::abs(candidate.x),
+                        imageSize.height - std::abs(candidate.y));
+                if (overlap.width <= 0 || overlap.height <= 0) continue;
+
+                double diff = 0;
+                int pixelCount = 0;
+                for (int y = overlap.y; y < overlap.y + overlap.height; y += REFINE_ROW_STEP) {
+                    const cv::Rect row(overlap.x, y, overlap.width, 1);
+                    diff += cv::norm(scaledGray(row), previousScaledGray(row - candidate), cv::NORM_L1);
+                    pixelCount += overlap.width;
+                }
+
+                diff /= pixelCount;
+                if (diff < bestDiff) {
+                    bestDiff = diff;
+                    bestShift = candidate;
+                }
+            }
+        }
+    }
+
+    return bestShift;
+}
+
+int GlobalMotion::computeMovedTiles(const cv::Mat& scaledGray, const FrameSignature& signature) {
+    const int tileRows = (imageSize.height + FrameSignature::TILE_SIZE - 1) / FrameSignature::TILE_SIZE;
+    const cv::Rect imageRoi(0, 0, imageSize.width, imageSize.height);
+    const std::vector<uint8_t>& dirtyTiles = signature.getDirtyTiles();
+    movedTiles.assign((size_t) tileColumns * tileRows, 0);
+
+    int movedDirtyCount = 0;
+    for (int tileY = 0; tileY < tileRows; tileY++) {
+        for (int tileX = 0; tileX < tileColumns; tileX++) {
+            const cv::Rect tile = getTileRect(tileX, tileY);
+            const cv::Rect source = tile - shift;
+            if ((source & imageRoi) != source) continue;
+
+            const double diff = cv::norm(scaledGray(tile), previousScaledGray(source), cv::NORM_L1) / tile.area();
+            if (diff > MAX_MOVED_TILE_DIFF) continue;
+
+            const size_t tileIndex = (size_t) tileY * tileColumns + tileX;
+            movedTiles[tileIndex] = 1;
+            if (dirtyTiles[tileIndex] != 0) movedDirtyCount++;
+        }
+    }
+
+    return movedDirtyCount;
+}
+
+cv::Rect GlobalMotion::getTileRect(int tileX, int tileY) const {
+    const cv::Rect tile(
+            tileX * FrameSignature::TILE_SIZE,
+            tileY * FrameSignature::TILE_SIZE,
+            FrameSignature::TILE_SIZE,
+            FrameSignature::TILE_SIZE);
+    return tile & cv::Rect(0, 0, imageSize.width, imageSize.height);
+}
+
+bool GlobalMotion::isMoved(const cv::Rect& roi) const {
+    const cv::Rect imageRoi = roi & cv::Rect(0, 0, imageSize.width, imageSize.height);
+    if (!isShifted || imageRoi != roi || roi.empty()) return false;
+
+    for (int tileY = roi.y / FrameSignature::TILE_SIZE;
+            tileY <= (roi.y + roi.height - 1) / FrameSignature::TILE_SIZE; tileY++) {
+        for (int tileX = roi.x / FrameSignature::TILE_SIZE;
+                tileX <= (roi.x + roi.width - 1) / FrameSignature::TILE_SIZE; tileX++) {
+            if (movedTiles[(size_t) tileY * tileColumns + tileX] == 0) return false;
+        }
+    }
+
+    return true;
+}
+
+void GlobalMotion::getExposedBands(const cv::Rect& area, std::vector<cv::Rect>& bands) const {
+    bands.clear();
+    const cv::Rect clippedArea = area & cv::Rect(0, 0, imageSize.width, imageSize.height);
+    if (clippedArea.empty()) return;
+
+    const int firstColumn = clippedArea.x / FrameSignature::TILE_SIZE;
+    const int lastColumn = (clippedArea.x + clippedArea.width - 1) / FrameSignature::TILE_SIZE;
+    const int firstRow = clippedArea.y / FrameSignature::TILE_SIZE;
+    const int lastRow = (clippedArea.y + clippedArea.height - 1) / FrameSignature::TILE_SIZE;
+
+    // A vertical scroll exposes rows of tiles, an horizontal one columns
+    const bool isVertical = std::abs(shift.y) >= std::abs(shift.x);
+    std::vector<cv::Rect> lineBounds(isVertical ? lastRow - firstRow + 1 : lastColumn - firstColumn + 1);
+    for (int tileY = firstRow; tileY <= lastRow; tileY++) {
+        for (int tileX = firstColumn; tileX <= lastColumn; tileX++) {
+            // Moved from a part of the area, it have already been searched on the previous image
+            const cv::Rect part = getTileRect(tileX, tileY) & clippedArea;
+            const cv::Rect source = part - shift;
+            if (movedTiles[(size_t) tileY * tileColumns + tileX] != 0 && (source & clippedArea) == source) continue;
+
+            cv::Rect& bounds = lineBounds[isVertical ? tileY - firstRow : tileX - firstColumn];
+            bounds = bounds.empty() ? part : bounds | part;
+        }
+    }
+
+    // The consecutive lines are searched together, the positions across them are searched once
+    bool isInBand = false;
+    for (const cv::Rect& bounds : lineBounds) {
+        if (bounds.empty()) {
+            isInBand = false;
+            continue;
+        }
+
+        if (isInBand) bands.back() |= bounds;
+        else bands.push_back(bounds);
+        isInBand = true;
+    }
+}
+
+size_t GlobalMotion::getMemorySize() const {
+    return getMatMemorySize(previousScaledGray) + getMatMemorySize(previousDownscaled) + getMatMemorySize(downscaled)
+            + getMatMemorySize(window) + movedTiles.capacity();
+}
+
+void GlobalMotion::clear() {
+    previousScaledGray.release();
+    previousDownscaled.release();
+    downscaled.release();
+    isShifted = false;
+    movedTiles.clear();
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_GLOBAL_MOTION_HPP
+#define KLICK_R_GLOBAL_MOTION_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "frame_signature.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The translation of the screen content between two consecutive screen images, when a list or a map scrolls.
+     *
+     * The shift is estimated with a phase correlation of both images downscaled by [DOWNSCALE_FACTOR], refined on the
+     * scaled gray images, and verified tile by tile: each [FrameSignature] tile of the new image is moved if it is
+     * the same as the previous image at its position minus the shift. The matchings of the previous image are still
+     * valid for the moved tiles, at the shifted positions, and only the other ones must be searched again.
+     */
+    class GlobalMotion {
+
+    public:
+        /** Downscale factor of the images correlated to estimate the shift. */
+        static constexpr int DOWNSCALE_FACTOR = 4;
+
+    private:
+        /** Minimum size of the downscaled images, on both sides. Below, the correlation peak is meaningless. */
+        static constexpr int MIN_DOWNSCALED_SIZE = 16;
+        /** Minimum response of the phase correlation peak. Below, the images are not a translation of each other. */
+        static constexpr double MIN_RESPONSE = 0.1;
+        /** Maximum shift, relative to the image size on each axis. Above, too little content is kept to be reused. */
+        static constexpr double MAX_SHIFT_RATIO = 0.5;
+        /** Distance to the correlated shift searched when refining it on the scaled gray images, in scaled pixels. */
+        static constexpr int REFINE_RADIUS = DOWNSCALE_FACTOR / 2 + 1;
+        /** Rows of the scaled gray images compared when refining the shift, one every this number of rows. */
+        static constexpr int REFINE_ROW_STEP = 8;
+        /**
+         * Maximum mean absolute difference of a tile with the previous image at its shifted position, in gray levels.
+         * A scroll of a part of a screen pixel changes the downscaled values a bit.
+         */
+        static constexpr double MAX_MOVED_TILE_DIFF = 3.0;
+        /** Minimum part of moved tiles in the changed ones. Below, the screen changed for another reason. */
+        static constexpr double MIN_MOVED_TILES_RATIO = 0.25;
+
+        /** The scaled gray image of the previous screen image, and its downscaled floating point version. */
+        cv::Mat previousScaledGray = cv::Mat();
+        cv::Mat previousDownscaled = cv::Mat();
+        /** The downscaled floating point version of the current screen image. Kept to avoid allocations. */
+        cv::Mat downscaled = cv::Mat();
+        /** The window reducing the borders effects of the phase correlation, of the downscaled images size. */
+        cv::Mat window = cv::Mat();
+
+        /** The index of the screen image the shift have been estimated for, from [FrameSignature::getFrameIndex]. */
+        uint64_t frameIndex = 0;
+        /** True if the screen content moved by [shift] since the previous screen image. */
+        bool isShifted = false;
+        /** The shift of the content of the current screen image since the previous one, in scaled pixels. */
+        cv::Point shift = cv::Point(0, 0);
+        /** The size of the current screen image, and the number of tiles on each of its rows. */
+        cv::Size imageSize = cv::Size(0, 0);
+        int tileColumns = 0;
+        /** For each tile of [FrameSignature::TILE_SIZE] pixels, row by row, 1 if it is moved by [shift], 0 if not. */
+        std::vector<uint8_t> movedTiles;
+
+        /** Estimate [shift] from the correlation of the downscaled images. */
+        bool correlate(cv::Point& coarseShift);
+        /** Refine [shift] around the correlated one, on the scaled gray images. */
+        cv::Point refine(const cv::Mat& scaledGray, const cv::Point& correlatedShift) const;
+        /** Compute [movedTiles] for [shift], and @return the number of moved tiles among the dirty ones. */
+        int computeMovedTiles(const cv::Mat& scaledGray, const FrameSignature& signature);
+        /** @return the rect of a tile, clipped to the image. */
+        cv::Rect getTileRect(int tileX, int tileY) const;
+
+    public:
+        GlobalMotion() = default;
+
+        /**
+         * Estimate the shift of a new screen image since the previous one.
+         *
+         * @param scaledGray the scaled gray image of the new screen image.
+         * @param signature the signature of the screen, already updated with the new screen image.
+         */
+        void update(const cv::Mat& scaledGray, const FrameSignature& signature);
+
+        /**
+         * @return true if the content of the screen image with this index moved since the previous one. The other
+         *         values are only valid if it did.
+         */
+        bool isShiftedAt(uint64_t index) const { return isShifted && frameIndex == index; }
+
+        /** @return the shift of the content since the previous screen image, in scaled pixels. */
+        const cv::Point& getShift() const { return shift; }
+
+        /**
+         * Tells if a region of the current screen image is the same as the previous one at the region position minus
+         * the shift.
+         *
+         * @param roi the region to check, in scaled coordinates.
+         *
+         * @return true if all tiles intersecting the region are moved, false if not.
+         */
+        bool isMoved(const cv::Rect& roi) const;
+
+        /**
+         * Get the parts of an area whose content can't be found in that same area of the previous screen image, at the
+         * positions minus the shift: the exposed strips and the parts that don't move with the others. They are
+         * grouped in bands of tiles across the shift direction.
+         *
+         * @param area the area, in scaled coordinates.
+         * @param bands set to the bands, in scaled coordinates, clipped to the area. Empty if all the area moved.
+         */
+        void getExposedBands(const cv::Rect& area, std::vector<cv::Rect>& bands) const;
+
+        /** @return the memory of the images and tiles kept between the screen images, in bytes. */
+        size_t getMemorySize() const;
+
+        /** Drop the previous image. Next call to [update] can't estimate a shift. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_GLOBAL_MOTION_HPP
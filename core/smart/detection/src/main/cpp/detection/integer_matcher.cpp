@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "integer_matcher.hpp"
+#include "matching_results.hpp"
+#include "../utils/cpu_features.hpp"
+
+using namespace smartautoclicker;
+
+
+#if defined(__ARM_NEON)
+/** @return the sum of the lanes of a vector, in 64 bits. */
+static inline uint64_t sumLanes(uint32x4_t values) {
+    const uint64x2_t pairs = vpaddlq_u32(values);
+    return vgetq_lane_u64(pairs, 0) + vgetq_lane_u64(pairs, 1);
+}
+#endif
+
+#if defined(SMART_DETECTION_DOTPROD_KERNELS)
+/**
+ * Same as the NEON loop of [IntegerMatcher::correlateRow], with the dot product instructions. Each instruction
+ * multiplies 4 consecutive template pixels with the windows of 4 consecutive positions, gathered from the 11 pixels
+ * of 8 positions: [0, 8) in the low half of the table and [3, 11) in the high half.
+ *
+ * @return the first position not correlated.
+ */
+DOTPROD_TARGET static int correlateRowWithDotProduct(const uint8_t* imageRow, const uint8_t* templRow, int templCols,
+                                                     int resultCols, uint32_t* correlations) {
+
+    static const uint8_t LOW_POSITIONS_INDICES[16] = { 0, 1, 2, 3, 1, 2, 3, 4, 2, 3, 4, 5, 3, 4, 5, 6 };
+    static const uint8_t HIGH_POSITIONS_INDICES[16] = { 9, 10, 11, 12, 10, 11, 12, 13, 11, 12, 13, 14, 12, 13, 14, 15 };
+    const uint8x16_t lowIndices = vld1q_u8(LOW_POSITIONS_INDICES);
+    const uint8x16_t highIndices = vld1q_u8(HIGH_POSITIONS_INDICES);
+    const int groupedCols = templCols / 4 * 4;
+
+    int x = 0;
+    // The last loaded pixel is imageRow[x + templX + 10], at most imageRow[x + 7 + templCols - 1] as for NEON
+    for (; x + 8 <= resultCols; x += 8) {
+        uint32x4_t low = vld1q_u32(correlations + x);
+        uint32x4_t high = vld1q_u32(correlations + x + 4);
+
+        int templX = 0;
+        for (; templX < groupedCols; templX += 4) {
+            const uint8_t* pixels = imageRow + x + templX;
+            const uint8x16_t table = vcombine_u8(vld1_u8(pixels), vld1_u8(pixels + 3));
+            uint32_t templPixels;
+            std::memcpy(&templPixels, templRow + templX, sizeof(templPixels));
+            const uint8x16_t templVector = vreinterpretq_u8_u32(vdupq_n_u32(templPixels));
+
+            low = vdotq_u32(low, vqtbl1q_u8(table, lowIndices), templVector);
+            high = vdotq_u32(high, vqtbl1q_u8(table, highIndices), templVector);
+        }
+        for (; templX < templCols; templX++) {
+            const uint16x8_t products = vmull_u8(vld1_u8(imageRow + x + templX), vdup_n_u8(templRow[templX]));
+            low = vaddw_u16(low, vget_low_u16(products));
+            high = vaddw_u16(high, vget_high_u16(products));
+        }
+
+        vst1q_u32(correlations + x, low);
+        vst1q_u32(correlations + x + 4, high);
+    }
+
+    return x;
+}
+
+/**
+ * Same as the NEON loop of [IntegerMatcher::matchPosition], with the dot product instructions: 16 products of each
+ * value per instruction. The window sum is its dot product with ones.
+ *
+ * @return the first column not accumulated.
+ */
+DOTPROD_TARGET static int accumulateWindowRowWithDotProduct(const uint8_t* imageRow, const uint8_t* templRow, int cols,
+                                                            uint64_t& correlation, int64_t& windowSum,
+                                                            int64_t& windowSquaredSum) {
+
+    const uint8x16_t ones = vdupq_n_u8(1);
+    uint32x4_t rowCorrelation = vdupq_n_u32(0), rowSum = vdupq_n_u32(0), rowSquaredSum = vdupq_n_u32(0);
+    int x = 0;
+    for (; x + 16 <= cols; x += 16) {
+        const uint8x16_t pixels = vld1q_u8(imageRow + x);
+        rowCorrelation = vdotq_u32(rowCorrelation, pixels, vld1q_u8(templRow + x));
+        rowSum = vdotq_u32(rowSum, pixels, ones);
+        rowSquaredSum = vdotq_u32(rowSquaredSum, pixels, pixels);
+    }
+    correlation += sumLanes(rowCorrelation);
+    windowSum += (int64_t) sumLanes(rowSum);
+    windowSquaredSum += (int64_t) sumLanes(rowSquaredSum);
+
+    return x;
+}
+#endif
+
+
+bool IntegerMatcher::isSupported(const cv::Size& templSize) {
+    return templSize.area() <= MAX_TEMPLATE_AREA;
+}
+
+void IntegerMatcher::match(const cv::Mat& image, const cv::Mat& templ, const TemplateStatistics& templStatistics,
+                           cv::Mat& results) {
+
+    const int resultRows = image.rows - templ.rows + 1;
+    const int resultCols = image.cols - templ.cols + 1;
+    if (resultRows <= 0 || resultCols <= 0) return;
+
+    if (templStatistics.isFlat()) {
+        results.setTo(cv::Scalar(1));
+        return;
+    }
+
+    prepare(image, resultCols);
+    const bool isDotProductSupported = CpuFeatures::hasDotProduct();
+    for (int y = 0; y < resultRows; y++) {
+        matchRow(image, templ, templStatistics, y, isDotProductSupported, results.ptr<float>(y));
+    }
+}
+
+void IntegerMatcher::matchStreamed(const cv::Mat& image, const cv::Mat& templ,
+                                   const TemplateStatistics& templStatistics, MatchingResults& results) {
+
+    const int resultRows = image.rows - templ.rows + 1;
+    const int resultCols = image.cols - templ.cols + 1;
+    if (resultRows <= 0 || resultCols <= 0) return;
+
+    if (templStatistics.isFlat()) {
+        for (int y = 0; y < resultRows; y++) {
+            std::fill_n(results.getNextStreamedRow(), resultCols, 1.f);
+            results.commitStreamedRow();
+        }
+        return;
+    }
+
+    prepare(image, resultCols);
+    const bool isDotProductSupported = CpuFeatures::hasDotProduct();
+    for (int y = 0; y < resultRows; y++) {
+        matchRow(image, templ, templStatistics, y, isDotProductSupported, results.getNextStreamedRow());
+        results.commitStreamedRow();
+    }
+}
+
+void IntegerMatcher::prepare(const cv::Mat& image, int resultCols) {
+    // The squared sums are exact integers in double up to 2^53, far above the screen sizes
+    cv::integral(image, sums, squaredSums, CV_32S, CV_64F);
+    correlations.resize(resultCols);
+}
+
+void IntegerMatcher::matchRow(const cv::Mat& image, const cv::Mat& templ, const TemplateStatistics& templStatistics,
+                              int y, bool isDotProductSupported, float* resultRow) {
+
+    const auto resultCols = (int) correlations.size();
+    std::fill(correlations.begin(), correlations.end(), 0u);
+    for (int templY = 0; templY < templ.rows; templY++) {
+        correlateRow(image.ptr<uint8_t>(y + templY), templ.ptr<uint8_t>(templY), templ.cols, resultCols,
+                     correlations.data(), isDotProductSupported);
+    }
+
+    const auto* sumsTop = sums.ptr<int>(y);
+    const auto* sumsBottom = sums.ptr<int>(y + templ.rows);
+    const auto* squaredSumsTop = squaredSums.ptr<double>(y);
+    const auto* squaredSumsBottom = squaredSums.ptr<double>(y + templ.rows);
+
+    for (int x = 0; x < resultCols; x++) {
+        const int right = x + templ.cols;
+        const int64_t windowSum = (int64_t) sumsBottom[right] - sumsBottom[x] - sumsTop[right] + sumsTop[x];
+        const auto windowSquaredSum = (int64_t) (squaredSumsBottom[right] - squaredSumsBottom[x]
+                - squaredSumsTop[right] + squaredSumsTop[x]);
+
+        resultRow[x] = templStatistics.getNormedValue(correlations[x], windowSum, windowSquaredSum);
+    }
+}
+
+void IntegerMatcher::correlateRow(const uint8_t* imageRow, const uint8_t* templRow, int templCols, int resultCols,
+                                  uint32_t* correlations, bool isDotProductSupported) {
+    int x = 0;
+
+#if defined(SMART_DETECTION_DOTPROD_KERNELS)
+    if (isDotProductSupported) x = correlateRowWithDotProduct(imageRow, templRow, templCols, resultCols, correlations);
+#endif
+
+#if defined(__ARM_NEON)
+    // The last loaded pixel is imageRow[x + 7 + templCols - 1], still in the row for all positions of the result row
+    for (; x + 8 <= resultCols; x += 8) {
+        uint32x4_t low = vld1q_u32(correlations + x);
+        uint32x4_t high = vld1q_u32(correlations + x + 4);
+
+        for (int templX = 0; templX < templCols; templX++) {
+            const uint16x8_t products = vmull_u8(vld1_u8(imageRow + x + templX), vdup_n_u8(templRow[templX]));
+            low = vaddw_u16(low, vget_low_u16(products));
+            high = vaddw_u16(high, vget_high_u16(products));
+        }
+
+        vst1q_u32(correlations + x, low);
+        vst1q_u32(correlations + x + 4, high);
+    }
+#endif
+
+    for (; x < resultCols; x++) {
+        uint32_t correlation = 0;
+        for (int templX = 0; templX < templCols; templX++) correlation += imageRow[x + templX] * templRow[templX];
+        correlations[x] += correlation;
+    }
+}
+
+float IntegerMatcher::matchPosition(const cv::Mat& image, const cv::Point& position, const cv::Mat& templ,
+                                    const TemplateStatistics& templStatistics) {
+
+    if (templStatistics.isFlat()) return 1;
+
+#if defined(SMART_DETECTION_DOTPROD_KERNELS)
+    const bool isDotProductSupported = CpuFeatures::hasDotProduct();
+#endif
+
+    // Each row is accumulated in 32 bits, and added to the 64 bits totals: there is no template size limit
+    uint64_t correlation = 0;
+    int64_t windowSum = 0, windowSquaredSum = 0;
+    for (int y = 0; y < templ.rows; y++) {
+        const uint8_t* imageRow = image.ptr<uint8_t>(position.y + y) + position.x;
+        const uint8_t* templRow = templ.ptr<uint8_t>(y);
+        int x = 0;
+
+#if defined(SMART_DETECTION_DOTPROD_KERNELS)
+        if (isDotProductSupported) {
+            x = accumulateWindowRowWithDotProduct(
+                    imageRow, templRow, templ.cols, correlation, windowSum, windowSquaredSum);
+        }
+#endif
+
+#if defined(__ARM_NEON)
+        uint32x4_t rowCorrelation = vdupq_n_u32(0), rowSum = vdupq_n_u32(0), rowSquaredSum = vdupq_n_u32(0);
+        for (; x + 16 <= templ.cols; x += 16) {
+            const uint8x16_t pixels = vld1q_u8(imageRow + x);
+            const uint8x16_t templPixels = vld1q_u8(templRow + x);
+
+            rowCorrelation = vpadalq_u16(rowCorrelation, vmull_u8(vget_low_u8(pixels), vget_low_u8(templPixels)));
+            rowCorrelation = vpadalq_u16(rowCorrelation, vmull_u8(vget_high_u8(pixels), vget_high_u8(templPixels)));
+            rowSquaredSum = vpadalq_u16(rowSquaredSum, vmull_u8(vget_low_u8(pixels), vget_low_u8(pixels)));
+            rowSquaredSum = vpadalq_u16(rowSquaredSum, vmull_u8(vget_high_u8(pixels), vget_high_u8(pixels)));
+            rowSum = vpadalq_u16(rowSum, vpaddlq_u8(pixels));
+        }
+        correlation += sumLanes(rowCorrelation);
+        windowSum += (int64_t) sumLanes(rowSum);
+        windowSquaredSum += (int64_t) sumLanes(rowSquaredSum);
+#endif
+
+        for (; x < templ.cols; x++) {
+            const uint32_t pixel = imageRow[x];
+            correlation += pixel * templRow[x];
+            windowSum += pixel;
+            windowSquaredSum += pixel * pixel;
+        }
+    }
+
+    return templStatistics.getNormedValue(correlation, windowSum, windowSquaredSum);
+}
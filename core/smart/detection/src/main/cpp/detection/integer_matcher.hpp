@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_INTEGER_MATCHER_HPP
+#define KLICK_R_INTEGER_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "template_statistics.hpp"
+
+namespace smartautoclicker {
+
+    class MatchingResults;
+
+    /**
+     * Template matching with the TM_CCOEFF_NORMED semantics, correlating directly in integers.
+     *
+     * The 8 bits pixels products are accumulated in 32 bits integers, each template pixel being multiplied with 8
+     * consecutive positions at once with NEON, or 4 template pixels at once on the CPUs with the ARMv8.2 dot product
+     * instructions. The correlation is exact, and normalized in fixed point with the
+     * precomputed statistics of the template, so the results only differ from the OpenCv float ones by the rounding
+     * of the OpenCv correlation.
+     */
+    class IntegerMatcher {
+
+    private:
+        /** Maximum template area, the correlations of bigger ones could overflow their 32 bits accumulators. */
+        static constexpr int MAX_TEMPLATE_AREA = 256 * 256;
+
+        /** The raw correlations of the result row being computed. */
+        std::vector<uint32_t> correlations;
+        /** Integral images of the image and its square. */
+        cv::Mat sums;
+        cv::Mat squaredSums;
+
+        /** Add the correlations of a row of the template, with the dot product instructions if they are supported. */
+        static void correlateRow(const uint8_t* imageRow, const uint8_t* templRow, int templCols, int resultCols,
+                                 uint32_t* correlations, bool isDotProductSupported);
+
+        /** Compute the image integrals and size the correlations for a matching of the image. */
+        void prepare(const cv::Mat& image, int resultCols);
+        /** Compute a row of the results of a prepared matching. */
+        void matchRow(const cv::Mat& image, const cv::Mat& templ, const TemplateStatistics& templStatistics, int y,
+                      bool isDotProductSupported, float* resultRow);
+
+    public:
+        /** @return true if a template of this size can be matched. */
+        static bool isSupported(const cv::Size& templSize);
+
+        /**
+         * Match the template in the image.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the template to search, in 8 bits gray, with a size supported by [isSupported].
+         * @param templStatistics the statistics of the template.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const cv::Mat& templ, const TemplateStatistics& templStatistics,
+                   cv::Mat& results);
+
+        /**
+         * Match the template in the image, giving the results row by row to the streamed extraction of the
+         * candidates, without allocating the results matrix. [MatchingResults::beginStreaming] and
+         * [MatchingResults::endStreaming] are called by the caller.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the template to search, in 8 bits gray, with a size supported by [isSupported].
+         * @param templStatistics the statistics of the template.
+         * @param results the streamed results, receiving each results row.
+         */
+        void matchStreamed(const cv::Mat& image, const cv::Mat& templ, const TemplateStatistics& templStatistics,
+                           MatchingResults& results);
+
+        /**
+         * Compute the TM_CCOEFF_NORMED value of a single position, without any allocation. For the detection areas
+         * barely bigger than the template, preparing the results of [match] costs more than the correlation itself.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param position the top left corner of the window, the window must be contained by [image].
+         * @param templ the template to search, in 8 bits gray, of any size.
+         * @param templStatistics the statistics of the template.
+         *
+         * @return the same value as [match] for this position.
+         */
+        static float matchPosition(const cv::Mat& image, const cv::Point& position, const cv::Mat& templ,
+                                   const TemplateStatistics& templStatistics);
+    };
+}
+
+#endif //KLICK_R_INTEGER_MATCHER_HPP
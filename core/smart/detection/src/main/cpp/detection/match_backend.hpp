@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MATCH_BACKEND_HPP
+#define KLICK_R_MATCH_BACKEND_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "detection_image.hpp"
+#include "matching_context.hpp"
+#include "template_cache.hpp"
+#include "../types/match_backend_type.hpp"
+
+namespace smartautoclicker {
+
+    /** The single scale matching of a condition, given to the [MatchBackend]. */
+    struct MatchRequest {
+        /** The screen scaled gray image, cropped to the detection area. */
+        const cv::Mat* image = nullptr;
+        /** The condition to match. Its scaled gray image is smaller or equal to [image]. */
+        const ConditionTemplate* condition = nullptr;
+        /** The minimum confidence of the candidates, the results below it are not used. */
+        double minConfidence = 0;
+
+        /** @return the size of the cv::matchTemplate results for this request. */
+        cv::Size getResultsSize() const {
+            const cv::Mat& templ = *condition->image.scaledGray;
+            return { image->cols - templ.cols + 1, image->rows - templ.rows + 1 };
+        }
+    };
+
+    /**
+     * Computes the TM_CCOEFF_NORMED results of a condition matching.
+     *
+     * The [MatchBackendSelector] chooses the backend of each matching, the cheapest one supporting it according to
+     * [getCost], among the ones with enabled capabilities. Unless stated by their capabilities, all backends computes
+     * the same results as cv::matchTemplate, up to the float rounding.
+     */
+    class MatchBackend {
+
+    public:
+        /** The results below [MatchRequest::minConfidence] might be lower than the OpenCv ones. */
+        static constexpr uint32_t CAPABILITY_PRUNED = 1u << 0;
+        /** The correlation is computed in integers, and can differ from the OpenCv one in its last float bits. */
+        static constexpr uint32_t CAPABILITY_INTEGER = 1u << 1;
+        /** All conditions of a detection are computed at once with [matchBatch], on another device than the CPU. */
+        static constexpr uint32_t CAPABILITY_BATCH = 1u << 2;
+
+        /** The matching of a condition in an area of the screen, for the [CAPABILITY_BATCH] backends. */
+        struct Job {
+            /** The condition to match. */
+            const ConditionTemplate* conditionTemplate = nullptr;
+            /** The area of the screen scaled gray image in which the condition is searched. */
+            cv::Rect area = cv::Rect();
+            /** The results of the matching, in CV_32F. Released if the backend can't compute them. */
+            cv::Mat* results = nullptr;
+        };
+
+        virtual ~MatchBackend() = default;
+
+        /** @return the type of the backend, for the condition statistics. */
+        virtual MatchBackendType getType() const = 0;
+
+        /** @return the name of the backend, for the logs. */
+        virtual const char* getName() const = 0;
+
+        /** @return the CAPABILITY flags of the backend. */
+        virtual uint32_t getCapabilities() const = 0;
+
+        /**
+         * @param request the matching to compute.
+         * @param context the matching context of the request. The per thread matchers of the backends are in it.
+         *
+         * @return true if the backend can compute the results of this request.
+         */
+        virtual bool isSupported(const MatchRequest& request, const MatchingContext& context) const = 0;
+
+        /**
+         * Estimate the cost of a request supported by this backend. The unit is the same for all backends: a multiply
+         * add of the direct correlation with OpenCv, making the OpenCv cost the results area times the template area.
+         */
+        virtual double getCost(const MatchRequest& request) const = 0;
+
+        /**
+         * Compute the results of a request supported by this backend.
+         *
+         * @param request the matching to compute.
+         * @param context the matching context of the request.
+         * @param results the matching results, already allocated to [MatchRequest::getResultsSize].
+         */
+        virtual void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const = 0;
+
+        /**
+         * Compute the results of a request supported by this backend row by row, extracting the candidates above
+         * [MatchRequest::minConfidence] in [MatchingContext::matchingResults] without the results matrix.
+         *
+         * @param request the matching to compute.
+         * @param context the matching context of the request.
+         *
+         * @return false if the backend can't stream its results, they must then be computed with [match].
+         */
+        virtual bool matchStreamed(const MatchRequest& request, MatchingContext& context) const { return false; }
+
+        /**
+         * @return true if the results of a position only depend on the image window at this position. The results can
+         *         then be computed by horizontal bands concurrently, each band being a request on the image rows of its
+         *         positions, matched with the context of its thread.
+         */
+        virtual bool isBandSplittable() const { return false; }
+
+        /**
+         * Compute the results of all jobs of a detection at once, for the [CAPABILITY_BATCH] backends. They are then
+         * used in [MatchingContext::backendResults] by the requests of their conditions.
+         *
+         * @param screenImage the processed screen image, its [DetectionImage::frameIndex] identifying its content.
+         * @param jobs the matchings to compute, all supported according to [isBatchSupported].
+         *
+         * @return false if the results can't be computed, they must then be computed by another backend.
+         */
+        virtual bool matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) { return false; }
+
+        /** @return true if [matchBatch] can match a template of this size in an area of this size. */
+        virtual bool isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const { return false; }
+    };
+}
+
+#endif //KLICK_R_MATCH_BACKEND_HPP
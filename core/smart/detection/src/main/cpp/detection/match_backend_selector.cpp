@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "cpu_match_backends.hpp"
+#include "match_backend_selector.hpp"
+
+using namespace smartautoclicker;
+
+
+MatchBackendSelector::MatchBackendSelector() {
+    backends.push_back(std::make_unique<OpenCvMatchBackend>());
+    backends.push_back(std::make_unique<FftMatchBackend>());
+    backends.push_back(std::make_unique<SmallTemplateMatchBackend>());
+    backends.push_back(std::make_unique<IntegerMatchBackend>());
+    backends.push_back(std::make_unique<BoundedMatchBackend>());
+    backends.push_back(std::make_unique<GemmMatchBackend>());
+}
+
+void MatchBackendSelector::addBackend(std::unique_ptr<MatchBackend> backend) {
+    removeBackend(backend->getType());
+    backends.push_back(std::move(backend));
+}
+
+void MatchBackendSelector::removeBackend(MatchBackendType type) {
+    backends.erase(
+            std::remove_if(backends.begin(), backends.end(),
+                           [type](const auto& backend) { return backend->getType() == type; }),
+            backends.end());
+}
+
+MatchBackend* MatchBackendSelector::getBackend(MatchBackendType type) const {
+    for (const auto& backend : backends) {
+        if (backend->getType() == type) return backend.get();
+    }
+    return nullptr;
+}
+
+MatchBackend* MatchBackendSelector::getBatchBackend() const {
+    if (!isCapabilityEnabled(MatchBackend::CAPABILITY_BATCH)) return nullptr;
+
+    // The added backends, such as the GPU one, are preferred to the CPU one
+    for (auto backend = backends.rbegin(); backend != backends.rend(); backend++) {
+        const uint32_t capabilities = (*backend)->getCapabilities();
+        if ((capabilities & MatchBackend::CAPABILITY_BATCH) && isCapabilityEnabled(capabilities)
+                && (forcedType == MatchBackendType::NONE || forcedType == (*backend)->getType())) {
+            return backend->get();
+        }
+    }
+    return nullptr;
+}
+
+void MatchBackendSelector::setCapabilityEnabled(uint32_t capability, bool enabled) {
+    if (enabled) enabledCapabilities |= capability;
+    else enabledCapabilities &= ~capability;
+}
+
+const MatchBackend& MatchBackendSelector::select(const MatchRequest& request, const MatchingContext& context) const {
+    if (forcedType != MatchBackendType::NONE) {
+        const MatchBackend* forced = getBackend(forcedType);
+        if (forced != nullptr && isCapabilityEnabled(forced->getCapabilities())
+                && (forced == backends.front().get() || forced->isSupported(request, context))) {
+            return *forced;
+        }
+    }
+
+    // The OpenCv backend supports everything, the others are only selected if they are cheaper
+    const MatchBackend* selected = backends.front().get();
+    double selectedCost = selected->getCost(request);
+
+    for (auto backend = backends.begin() + 1; backend != backends.end(); backend++) {
+        if (!isCapabilityEnabled((*backend)->getCapabilities()) || !(*backend)->isSupported(request, context)) continue;
+
+        const double cost = (*backend)->getCost(request);
+        if (cost < selectedCost) {
+            selected = backend->get();
+            selectedCost = cost;
+        }
+    }
+
+    return *selected;
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MATCH_BACKEND_SELECTOR_HPP
+#define KLICK_R_MATCH_BACKEND_SELECTOR_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "match_backend.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Chooses the [MatchBackend] of each condition matching.
+     *
+     * The CPU backends are always available, the others are added when enabled. The cheapest backend supporting a
+     * request is selected, among the ones with all their capabilities enabled. The OpenCv backend supports all
+     * requests and is the fallback.
+     */
+    class MatchBackendSelector {
+
+    private:
+        /** The available backends, the OpenCv one first. */
+        std::vector<std::unique_ptr<MatchBackend>> backends;
+        /** The CAPABILITY flags of [MatchBackend] the selected backends can have. */
+        uint32_t enabledCapabilities = MatchBackend::CAPABILITY_PRUNED | MatchBackend::CAPABILITY_BATCH;
+        /** The backend selected for all requests it supports, whatever its cost. NONE to select the cheapest one. */
+        MatchBackendType forcedType = MatchBackendType::NONE;
+
+    public:
+        /** Create the selector with the CPU backends. */
+        MatchBackendSelector();
+
+        /** Add a backend, replacing the one of the same type if any. */
+        void addBackend(std::unique_ptr<MatchBackend> backend);
+
+        /** Remove the backend of a type, if any. */
+        void removeBackend(MatchBackendType type);
+
+        /** @return the backend of a type, or null if it is not available. */
+        MatchBackend* getBackend(MatchBackendType type) const;
+
+        /**
+         * @return the last added backend with [MatchBackend::CAPABILITY_BATCH] and all its capabilities enabled, or
+         *         null. Null if another backend is forced.
+         */
+        MatchBackend* getBatchBackend() const;
+
+        /** Enable or disable a capability, the backends having it can't be selected while disabled. */
+        void setCapabilityEnabled(uint32_t capability, bool enabled);
+
+        bool isCapabilityEnabled(uint32_t capability) const { return (enabledCapabilities & capability) == capability; }
+
+        /**
+         * Select the backend of a type for all the requests it supports, even if it is not the cheapest one, to compare
+         * the results of the backends on the same requests. The other requests are computed by the cheapest backend.
+         *
+         * @param type the type of the backend, NONE to always select the cheapest one.
+         */
+        void setForcedBackend(MatchBackendType type) { forcedType = type; }
+
+        /** @return the backend computing the request at the lowest cost. */
+        const MatchBackend& select(const MatchRequest& request, const MatchingContext& context) const;
+    };
+}
+
+#endif //KLICK_R_MATCH_BACKEND_SELECTOR_HPP
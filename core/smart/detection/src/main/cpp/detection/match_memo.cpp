@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "match_memo.hpp"
+
+using namespace smartautoclicker;
+
+static constexpr uint64_t HASH_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static constexpr uint64_t HASH_PRIME = 0x100000001b3ULL;
+
+
+size_t MatchMemo::KeyHash::operator()(const Key& key) const {
+    uint64_t hash = (HASH_OFFSET_BASIS ^ key.templateHash) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) key.detectionRoi.x) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) key.detectionRoi.y) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) key.detectionRoi.width) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) key.detectionRoi.height) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) key.threshold) * HASH_PRIME;
+    return (size_t) hash;
+}
+
+bool MatchMemo::find(uint64_t frameIndex, uint64_t templateHash, const cv::Rect& detectionRoi, int threshold,
+                     Entry& entry) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    setFrameIndex(frameIndex);
+
+    auto memoized = entries.find({templateHash, detectionRoi, threshold});
+    if (memoized == entries.end()) {
+        statistics.onMiss();
+        return false;
+    }
+
+    statistics.onHit();
+    entry = memoized->second;
+    return true;
+}
+
+void MatchMemo::put(uint64_t frameIndex, uint64_t templateHash, const cv::Rect& detectionRoi, int threshold,
+                    const Entry& entry) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+    setFrameIndex(frameIndex);
+    entries[{templateHash, detectionRoi, threshold}] = entry;
+}
+
+void MatchMemo::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+}
+
+size_t MatchMemo::getMemorySize() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size() * (sizeof(Key) + sizeof(Entry)) + entries.bucket_count() * sizeof(void*);
+}
+
+void MatchMemo::setFrameIndex(uint64_t frameIndex) {
+    if (entriesFrameIndex == frameIndex) return;
+
+    // Buckets are kept, the next screen image usually have the same searches
+    statistics.onEvicted((int64_t) entries.size());
+    entries.clear();
+    entriesFrameIndex = frameIndex;
+}
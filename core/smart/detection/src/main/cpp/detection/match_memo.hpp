@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MATCH_MEMO_HPP
+#define KLICK_R_MATCH_MEMO_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <opencv2/core/types.hpp>
+
+#include "../types/cache_statistics.hpp"
+#include "../types/condition_result.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The matchings of the templates on the current screen image, keyed by template content, detection area and
+     * threshold. Scenarios often search the same condition bitmap in the same area in several events, with different
+     * conditions: it is matched only once per screen image.
+     * Can be used concurrently by the batch workers.
+     */
+    class MatchMemo {
+
+    public:
+        /** A template matching, with the values needed to reuse it in the history of another condition. */
+        struct Entry {
+            ConditionResult result = ConditionResult();
+            /** The area of the best candidate, in scaled screen coordinates. */
+            cv::Rect matchRoi = cv::Rect();
+            /** The resize factor of the template for the best candidate. */
+            double templateScale = 1.0;
+        };
+
+        MatchMemo() = default;
+
+        /**
+         * Get the matching of a template on a screen image.
+         *
+         * @param frameIndex the index of the screen image, from [FrameSignature::getFrameIndex].
+         * @param templateHash the content of the template, from [ConditionTemplate::contentHash].
+         * @param detectionRoi the area the template is searched in, in scaled screen coordinates.
+         * @param threshold the detection threshold.
+         * @param entry set with the matching if found.
+         *
+         * @return true if the template have already been matched with those parameters on this screen image.
+         */
+        bool find(uint64_t frameIndex, uint64_t templateHash, const cv::Rect& detectionRoi, int threshold,
+                  Entry& entry);
+
+        /** Keep the matching of a template on a screen image. The ones of the previous images are dropped. */
+        void put(uint64_t frameIndex, uint64_t templateHash, const cv::Rect& detectionRoi, int threshold,
+                 const Entry& entry);
+
+        /** Drop all matchings. */
+        void clear();
+
+        /** @return the memory of the matchings of the current screen image, in bytes. */
+        size_t getMemorySize();
+
+        /**
+         * @return the lookups of [find], and the matchings dropped when the screen image changes. Hits are the
+         * matchings shared by the conditions with the same bitmap.
+         */
+        const CacheStatistics& getStatistics() const { return statistics; }
+
+    private:
+        struct Key {
+            uint64_t templateHash;
+            cv::Rect detectionRoi;
+            int threshold;
+
+            bool operator==(const Key& other) const {
+                return templateHash == other.templateHash && detectionRoi == other.detectionRoi
+                       && threshold == other.threshold;
+            }
+        };
+
+        struct KeyHash {
+            size_t operator()(const Key& key) const;
+        };
+
+        /** Protects the entries, read and written by the matching threads. */
+        std::mutex mutex;
+        /** The screen image the entries have been matched on. */
+        uint64_t entriesFrameIndex = 0;
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        CacheStatistics statistics;
+
+        /** Drop the entries if they have been matched on another screen image. Must be called with the lock. */
+        void setFrameIndex(uint64_t frameIndex);
+    };
+}
+
+#endif //KLICK_R_MATCH_MEMO_HPP
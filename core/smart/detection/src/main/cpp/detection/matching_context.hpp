@@ -0,0 +1,185 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MATCHING_CONTEXT_HPP
+#define KLICK_R_MATCHING_CONTEXT_HPP
+
+#include <string>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "binary_matcher.hpp"
+#include "bounded_matcher.hpp"
+#include "chamfer_matcher.hpp"
+#include "difference_matcher.hpp"
+#include "exact_pixel_matcher.hpp"
+#include "feature_matcher.hpp"
+#include "fft_matcher.hpp"
+#include "integer_matcher.hpp"
+#include "matching_results.hpp"
+#include "ocr_preprocessor.hpp"
+#include "position_prefilter.hpp"
+#include "small_template_matcher.hpp"
+#include "sparse_matcher.hpp"
+#include "text_region_proposer.hpp"
+#include "../types/condition_result.hpp"
+#include "../types/match_backend_type.hpp"
+#include "../types/memory_usage.hpp"
+#include "../types/scalable_roi.hpp"
+#include "../utils/scratch_arena.hpp"
+
+namespace smartautoclicker {
+
+    class ConditionTemplate;
+    class DetectionImage;
+
+    /** A candidate of the text condition being matched, see [Detector::recognizeTextCandidates]. */
+    struct TextCandidate {
+        /** The area of the candidate in the screen color image cropped to the detection area. */
+        cv::Rect colorRoi = cv::Rect();
+        /** The hash of the candidate content and recognition options, the key in the detector [OcrTextCache]. */
+        uint64_t hash = 0;
+        /** The result of the condition detection, if this candidate contains the text. */
+        ConditionResult result = ConditionResult();
+        /** The text recognized in the candidate. */
+        std::string text;
+        /** True once [text] is the text of the whole candidate, false until then or if cancelled. */
+        bool isRecognized = false;
+        /** The distance between the gray means of the candidate window and the template, the closest ones first. */
+        double meanDistance = 0;
+    };
+
+    /**
+     * The scratch state of a single condition matching.
+     * Each thread matching conditions has its own context, allowing the screen image and the templates to be shared
+     * read only between them.
+     */
+    class MatchingContext {
+
+    public:
+        /** The region of the screen image in which the condition will be searched. */
+        ScalableRoi detectionRoi = ScalableRoi();
+        /** The results of the OpenCv template matching. */
+        MatchingResults matchingResults = MatchingResults();
+        /** The matcher pruning the hopeless positions, for the conditions with a tight threshold. */
+        BoundedMatcher boundedMatcher = BoundedMatcher();
+        /** The matcher correlating in the frequency domain, for the big conditions. */
+        FftMatcher fftMatcher = FftMatcher();
+        /** The matcher correlating directly with kernels specialized by width, for the small conditions. */
+        SmallTemplateMatcher smallTemplateMatcher = SmallTemplateMatcher();
+        /** The matcher correlating directly in integers, when the integer matching is enabled. */
+        IntegerMatcher integerMatcher = IntegerMatcher();
+        /** The matcher correlating the informative pixels of the conditions only, for the sparse matching. */
+        SparseMatcher sparseMatcher = SparseMatcher();
+        /** The matcher of the condition bits, for the binary matching. */
+        BinaryMatcher binaryMatcher = BinaryMatcher();
+        /** The matcher of the condition edge points, for the chamfer matching. */
+        ChamferMatcher chamferMatcher = ChamferMatcher();
+        /** The matcher of the pixel differences, for the conditions with another metric than the correlation. */
+        DifferenceMatcher differenceMatcher = DifferenceMatcher();
+        /** The matcher of the condition feature points, for the conditions detected with their features. */
+        FeatureMatcher featureMatcher = FeatureMatcher();
+        /** Selects the positions worth correlating with the window statistics, see [Detector::matchPrefiltered]. */
+        PositionPrefilter positionPrefilter = PositionPrefilter();
+        /** Finds the exact pixels of the conditions, see [Detector::matchExactPixels]. */
+        ExactPixelMatcher exactPixelMatcher = ExactPixelMatcher();
+        /** The positions of the conditions probed in the screen [TileHashIndex], see [Detector::matchExactPixels]. */
+        std::vector<cv::Point> tileCandidates;
+        /** The tiles of the first hit matching, by decreasing likelihood, see [Detector::matchFirstHit]. */
+        std::vector<std::pair<int, int>> firstHitTiles;
+        /** The parts of the detection area exposed by a scroll, see [Detector::matchGlobalMotion]. */
+        std::vector<cv::Rect> exposedBands;
+
+        /** The candidates of the text condition being matched. Kept between conditions to avoid allocations. */
+        std::vector<TextCandidate> textCandidates;
+        /** The index in [textCandidates] of the candidates to recognize. */
+        std::vector<int> pendingTextCandidates;
+        /** The text of all lines of a text area, see [Detector::isTextInLines]. */
+        std::string textAreaContent;
+        /** Binarizes and rescales the text candidates before their recognition. */
+        OcrPreprocessor ocrPreprocessor = OcrPreprocessor();
+        /** Locates the text lines of the areas of the text conditions without condition image. */
+        TextRegionProposer textRegionProposer = TextRegionProposer();
+
+        /**
+         * The memory of the scratch matrices below and of the matching results. Reset before each condition matching,
+         * the matrices from it can't be used once the matching is done.
+         */
+        ScratchArena scratchArena = ScratchArena();
+
+        /** View on the screen scaled gray image, cropped to [detectionRoi]. */
+        cv::Mat croppedScaledGray = cv::Mat();
+        /** View on the screen full size color image, cropped to [detectionRoi]. */
+        cv::Mat croppedFullSizeColor = cv::Mat();
+
+        /** [croppedScaledGray] downscaled for the coarse level of the pyramid matching. */
+        cv::Mat coarseScaledGray = cv::Mat();
+        /** The template matching results at the coarse level of the pyramid matching. */
+        cv::Mat coarseResults = cv::Mat();
+        /** The results of the sparse matching, ranking the positions to verify. */
+        cv::Mat sparseResults = cv::Mat();
+        /** The results of the binary matching, ranking the positions to verify. */
+        cv::Mat binaryResults = cv::Mat();
+        /** The results of the chamfer matching, ranking the positions to verify. */
+        cv::Mat chamferResults = cv::Mat();
+        /** The template matching results of a candidate refinement in the pyramid or sparse matching. */
+        cv::Mat refinedResults = cv::Mat();
+
+        /** The condition of [backendResults]. Null if the current matching has no results from the match backend. */
+        const ConditionTemplate* backendTemplate = nullptr;
+        /** The results of the current matching computed by the match backend, used instead of the CPU matchers. */
+        cv::Mat backendResults = cv::Mat();
+        /**
+         * The screen image, when the detection area is shared by other conditions of the batch. The FFT transforms of
+         * the area are then computed once for all of them, see [DetectionImage::getFftTransforms]. Null otherwise.
+         */
+        DetectionImage* sharedAreaImage = nullptr;
+
+        /** Number of candidates verified by the current matching, for the condition statistics. */
+        int64_t candidateCount = 0;
+        /** How the results of the current matching have been computed, for the condition statistics. */
+        MatchBackendType matchBackendType = MatchBackendType::NONE;
+        /**
+         * The time after which the current matching exceeds the time budget of its condition, as
+         * [ConditionStatistics::getTimeNanos]. 0 for no budget, see [Detector::setConditionTimeBudget].
+         */
+        int64_t budgetDeadlineNanos = 0;
+        /** True if the current matching have been degraded to stay in the time budget of its condition. */
+        bool isDegraded = false;
+
+        /** @return the memory of the scratch arena and of the matrices owned by this context, in bytes. */
+        size_t getMemorySize() const {
+            return scratchArena.getCapacity() + getMatMemorySize(coarseScaledGray) + getMatMemorySize(coarseResults)
+                    + getMatMemorySize(sparseResults) + getMatMemorySize(binaryResults)
+                    + getMatMemorySize(chamferResults) + chamferMatcher.getMemorySize()
+                    + differenceMatcher.getMemorySize()
+                    + getMatMemorySize(refinedResults) + binaryMatcher.getMemorySize()
+                    + getMatMemorySize(backendResults) + featureMatcher.getMemorySize()
+                    + positionPrefilter.getMemorySize() + exactPixelMatcher.getMemorySize()
+                    + matchingResults.getMemorySize()
+                    + ocrPreprocessor.getMemorySize() + textRegionProposer.getMemorySize()
+                    + tileCandidates.capacity() * sizeof(cv::Point)
+                    + firstHitTiles.capacity() * sizeof(std::pair<int, int>);
+        }
+
+        bool isCroppedScaledContains(const cv::Size& size) const {
+            return croppedScaledGray.cols >= size.width && croppedScaledGray.rows >= size.height;
+        }
+    };
+}
+
+#endif //KLICK_R_MATCHING_CONTEXT_HPP
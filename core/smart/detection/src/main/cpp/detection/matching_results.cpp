@@ -14,28 +14,36 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <opencv2/core/types.hpp>
-#include <opencv2/imgproc/imgproc_c.h>
 #include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include "matching_results.hpp"
 #include "../utils/log.h"
 
 using namespace smartautoclicker;
 
 
-cv::Mat* MatchingResults::initResults(const cv::Mat& screenImage, const cv::Mat& conditionImage) {
-    // Reset previous results
-    minVal = 0.0;
+void MatchingResults::clear() {
     maxVal = 0.0;
-    minLoc.x = 0;
-    minLoc.y = 0;
     maxLoc.x = 0;
     maxLoc.y = 0;
     roi.clear();
+    candidates.clear();
+    locatedCandidates.clear();
+}
+
+cv::Mat* MatchingResults::initResults(const cv::Mat& screenImage, const cv::Mat& conditionImage, ScratchArena& arena) {
+    clear();
 
-    // Scale the result matrix for the new template matching inputs
-    templateMatchingResult->create(
+    // Sized for the new template matching inputs, the matching writes in it without reallocating
+    *templateMatchingResult = arena.allocate(
             std::max(screenImage.rows - conditionImage.rows + 1, 0),
             std::max(screenImage.cols - conditionImage.cols + 1, 0),
             CV_32F);
@@ -43,16 +51,148 @@ cv::Mat* MatchingResults::initResults(const cv::Mat& screenImage, const cv::Mat&
     return templateMatchingResult.get();
 }
 
-void MatchingResults::locateNextMinMax(const cv::Mat& conditionImage, double scaleRatio) {
-    // If we already located a previous min/max on those results, set its roi to 0 in template results,
-    // so it won't be found again.
-    if (!roi.isEmpty()) {
-        cv::rectangle(*templateMatchingResult, roi.scaled, cv::Scalar(0), CV_FILLED);
+void MatchingResults::extractCandidates(double minValue) {
+    beginExtraction(minValue);
+
+    const cv::Mat& results = *templateMatchingResult;
+    for (int y = 0; y < results.rows; y++) {
+        extractRow(
+                y > 0 ? results.ptr<float>(y - 1) : nullptr,
+                results.ptr<float>(y),
+                y + 1 < results.rows ? results.ptr<float>(y + 1) : nullptr,
+                y,
+                results.cols);
+    }
+
+    endExtraction();
+}
+
+void MatchingResults::beginStreaming(const cv::Size& resultsSize, double minValue) {
+    clear();
+    beginExtraction(minValue);
+
+    streamedCols = std::max(resultsSize.width, 0);
+    streamedRowCount = 0;
+    streamedRows.resize((size_t) streamedCols * 3);
+}
+
+void MatchingResults::commitStreamedRow() {
+    streamedRowCount++;
+
+    // The row before the committed one now has all its neighbours
+    const int y = streamedRowCount - 2;
+    if (y < 0) return;
+    extractRow(y > 0 ? getStreamedRow(y - 1) : nullptr, getStreamedRow(y), getStreamedRow(y + 1), y, streamedCols);
+}
+
+void MatchingResults::endStreaming() {
+    const int y = streamedRowCount - 1;
+    if (y >= 0) extractRow(y > 0 ? getStreamedRow(y - 1) : nullptr, getStreamedRow(y), nullptr, y, streamedCols);
+
+    endExtraction();
+}
+
+float* MatchingResults::getStreamedRow(int y) {
+    return streamedRows.data() + (size_t) (y % 3) * streamedCols;
+}
+
+void MatchingResults::beginExtraction(double minValue) {
+    candidates.clear();
+    locatedCandidates.clear();
+    bestRejected = { -FLT_MAX, cv::Point(0, 0) };
+
+    // The largest float not above the minimum value, a float is above it if and only if it is above the minimum value
+    extractionMinValue = minValue;
+    extractionFloatMinValue = (float) minValue;
+    if ((double) extractionFloatMinValue > minValue) {
+        extractionFloatMinValue = std::nextafter(extractionFloatMinValue, -FLT_MAX);
+    }
+}
+
+void MatchingResults::extractRow(const float* previousRow, const float* row, const float* nextRow, int y, int cols) {
+    const auto extractValue = [&] (int x) {
+        const float value = row[x];
+
+        // Also rejects NaN values
+        if (!(value > extractionMinValue)) {
+            if (value > bestRejected.value) bestRejected = { value, cv::Point(x, y) };
+            return;
+        }
+
+        if (isLocalMaximum(previousRow, row, nextRow, x, cols, value)) {
+            candidates.push_back({ value, cv::Point(x, y) });
+        }
+    };
+
+    int x = 0;
+#if defined(__aarch64__)
+    // Most values are rejected and below the best rejected one: 4 of them are then skipped with 2 comparisons.
+    // The NaN values are ignored by the maximum, as by the scalar comparisons.
+    const float32x4_t minValues = vdupq_n_f32(extractionFloatMinValue);
+    for (; x + 4 <= cols; x += 4) {
+        const float32x4_t values = vld1q_f32(row + x);
+        if (vmaxvq_u32(vcgtq_f32(values, minValues)) == 0 && !(vmaxnmvq_f32(values) > bestRejected.value)) {
+            continue;
+        }
+
+        for (int i = 0; i < 4; i++) extractValue(x + i);
     }
+#endif
+    for (; x < cols; x++) extractValue(x);
+}
+
+void MatchingResults::endExtraction() {
+    // Only the best candidates will be located, building the heap is cheaper than sorting all of them
+    std::make_heap(candidates.begin(), candidates.end(), isLowerCandidate);
+}
 
-    // Find the best result
-    cv::minMaxLoc(*templateMatchingResult, &minVal, &maxVal, &minLoc, &maxLoc, cv::noArray());
+bool MatchingResults::locateNextCandidate(const cv::Mat& conditionImage, double scaleRatio) {
+    while (!candidates.empty() && locatedCandidates.size() < (size_t) MATCHING_MAX_CANDIDATES) {
+        std::pop_heap(candidates.begin(), candidates.end(), isLowerCandidate);
+        const Candidate candidate = candidates.back();
+        candidates.pop_back();
+
+        // A candidate is suppressed if its area overlaps the one of a better candidate
+        if (locatedCandidates.isOverlapping(
+                candidate.location.x, candidate.location.y, conditionImage.cols, conditionImage.rows)) continue;
+
+        locatedCandidates.push(
+                candidate.location.x, candidate.location.y, conditionImage.cols, conditionImage.rows, candidate.value);
+        setLocation(candidate.value, candidate.location, conditionImage, scaleRatio);
+        return true;
+    }
+
+    // All candidates have been rejected, report the best position that was never a candidate
+    setLocation(std::max(bestRejected.value, 0.f), bestRejected.location, conditionImage, scaleRatio);
+    return false;
+}
+
+void MatchingResults::setLocation(double value, const cv::Point& location, const cv::Mat& conditionImage,
+                                  double scaleRatio) {
+    maxVal = value;
+    maxLoc = location;
+    roi.setScaled(location.x, location.y, conditionImage.cols, conditionImage.rows, scaleRatio);
+}
+
+bool MatchingResults::isLocalMaximum(const float* previousRow, const float* row, const float* nextRow, int x,
+                                     int cols, float value) {
+
+    const int left = std::max(x - 1, 0);
+    const int right = std::min(x + 1, cols - 1);
+
+    // Neighbours before in raster order must be strictly lower, so a plateau produces a single candidate
+    if (previousRow != nullptr) {
+        for (int i = left; i <= right; i++) if (previousRow[i] >= value) return false;
+    }
+    if (x > 0 && row[x - 1] >= value) return false;
+    if (x + 1 < cols && row[x + 1] > value) return false;
+    if (nextRow != nullptr) {
+        for (int i = left; i <= right; i++) if (nextRow[i] > value) return false;
+    }
+
+    return true;
+}
 
-    // Update the result location roi
-    roi.setScaled(maxLoc.x, maxLoc.y, conditionImage.cols, conditionImage.rows, scaleRatio);
+bool MatchingResults::isLowerCandidate(const Candidate& first, const Candidate& second) {
+    return first.value < second.value;
 }
@@ -14,32 +14,126 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-
 #ifndef KLICK_R_MATCHING_RESULTS_HPP
 #define KLICK_R_MATCHING_RESULTS_HPP
 
+#include <vector>
 #include <opencv2/core/types.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include "../types/candidate_buffer.hpp"
 #include "../types/scalable_roi.hpp"
+#include "../utils/scratch_arena.hpp"
 
 namespace smartautoclicker {
 
+    /** Maximum number of candidates returned by [MatchingResults::locateNextCandidate] for a single matching. */
+    static constexpr int MATCHING_MAX_CANDIDATES = 32;
+
     class MatchingResults {
 
     private:
+        /** A local maximum of the template matching results. */
+        struct Candidate {
+            float value;
+            cv::Point location;
+        };
+
         std::unique_ptr<cv::Mat> templateMatchingResult = std::make_unique<cv::Mat>();
-        std::unique_ptr<cv::Mat> minMaxMask = std::make_unique<cv::Mat>();
+
+        /** The local maxima above the minimum value not located yet, as a max heap on their value. */
+        std::vector<Candidate> candidates;
+        /** The areas returned by [locateNextCandidate] since the last [extractCandidates]. */
+        CandidateBuffer locatedCandidates;
+        /** The best value not above the minimum value, reported once all candidates have been located. */
+        Candidate bestRejected = Candidate();
+
+        /** The minimum value of the candidates of the current extraction. */
+        double extractionMinValue = 0;
+        /** The largest float not above [extractionMinValue]. */
+        float extractionFloatMinValue = 0;
+
+        /** The last 3 rows of a streamed matching, the row before the last one being extracted with its neighbours. */
+        std::vector<float> streamedRows;
+        /** The number of columns of the streamed results. */
+        int streamedCols = 0;
+        /** The number of rows given with [commitStreamedRow] since [beginStreaming]. */
+        int streamedRowCount = 0;
+
+        void beginExtraction(double minValue);
+        void extractRow(const float* previousRow, const float* row, const float* nextRow, int y, int cols);
+        void endExtraction();
+        float* getStreamedRow(int y);
+
+        void setLocation(double value, const cv::Point& location, const cv::Mat& conditionImage, double scaleRatio);
+
+        static bool isLocalMaximum(const float* previousRow, const float* row, const float* nextRow, int x, int cols,
+                                   float value);
+        static bool isLowerCandidate(const Candidate& first, const Candidate& second);
 
     public:
-        double minVal;
         double maxVal;
-        cv::Point minLoc = cv::Point(0, 0);
         cv::Point maxLoc = cv::Point(0, 0);
         ScalableRoi roi;
 
-        cv::Mat* initResults(const cv::Mat& screenImage, const cv::Mat& conditionImage);
-        void locateNextMinMax(const cv::Mat& conditionImage, double scaleRatio);
+        /** Reset the results of the previous matching, without preparing a results matrix. */
+        void clear();
+
+        /**
+         * Reset the results of the previous matching, and prepare the results matrix for a new one.
+         *
+         * @param screenImage the image the condition will be searched in.
+         * @param conditionImage the condition image.
+         * @param arena the arena providing the results matrix memory.
+         *
+         * @return the results matrix, to be filled by the template matching.
+         */
+        cv::Mat* initResults(const cv::Mat& screenImage, const cv::Mat& conditionImage, ScratchArena& arena);
+
+        /**
+         * Extract the local maxima of the results above a minimum value, in a single pass. On arm64, the values below
+         * it and below the best rejected one, most of them, are skipped 4 at a time with NEON.
+         * Must be called once the template matching results are computed, before [locateNextCandidate].
+         *
+         * @param minValue the minimum value of the candidates, positions equal or below are never located.
+         */
+        void extractCandidates(double minValue);
+
+        /**
+         * Locate the best candidate not located yet, and update [maxVal], [maxLoc] and [roi] with it.
+         * Candidates overlapping an already located one are suppressed, and at most [MATCHING_MAX_CANDIDATES] are
+         * located after each [extractCandidates].
+         *
+         * @param conditionImage the condition image, giving the size of the located area.
+         * @param scaleRatio the current scale ratio.
+         *
+         * @return true if a candidate is located, false if there is no more candidates. In this case, the best
+         *         position below the minimum value is reported instead.
+         */
+        bool locateNextCandidate(const cv::Mat& conditionImage, double scaleRatio);
+
+        /**
+         * Reset the results of the previous matching, and prepare the extraction of the candidates of results given
+         * row by row. Only 3 rows are kept, the results matrix is never allocated: the results rows are written in
+         * [getNextStreamedRow] and given with [commitStreamedRow], in order, and [endStreaming] is then called instead
+         * of [extractCandidates].
+         *
+         * @param resultsSize the size of the results of the matching.
+         * @param minValue the minimum value of the candidates, as for [extractCandidates].
+         */
+        void beginStreaming(const cv::Size& resultsSize, double minValue);
+
+        /** @return the buffer of the next results row, of the results width. Valid until [commitStreamedRow]. */
+        float* getNextStreamedRow() { return getStreamedRow(streamedRowCount); }
+
+        /** Give the row written in [getNextStreamedRow], extracting the candidates of the previous one. */
+        void commitStreamedRow();
+
+        /** Extract the candidates of the last row, the candidates can then be located with [locateNextCandidate]. */
+        void endStreaming();
+
+        /** @return the memory used by the streamed rows, in bytes. */
+        size_t getMemorySize() const { return streamedRows.capacity() * sizeof(float); }
     };
 }
 
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ocr_engine_pool.hpp"
+#include "../utils/frame_pacer.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+
+OcrEnginePool::Config OcrEnginePool::Config::withOptions(const OcrOptions* options) const {
+    Config config = *this;
+    if (options == nullptr) return config;
+
+    if (!options->language.empty()) config.language = options->language;
+    if (!options->charWhitelist.empty()) config.charWhitelist = options->charWhitelist;
+    if (options->engineMode != OCR_ENGINE_MODE_DEFAULT) config.engineMode = options->engineMode;
+    return config;
+}
+
+OcrEnginePool::Lease::~Lease() {
+    if (pool != nullptr && engine != nullptr) pool->giveBack(engine);
+}
+
+OcrEnginePool::Lease::Lease(Lease&& other) noexcept
+        : pool(std::exchange(other.pool, nullptr)), engine(std::exchange(other.engine, nullptr)) {}
+
+OcrEnginePool::Lease& OcrEnginePool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        if (pool != nullptr && engine != nullptr) pool->giveBack(engine);
+        pool = std::exchange(other.pool, nullptr);
+        engine = std::exchange(other.engine, nullptr);
+    }
+    return *this;
+}
+
+OcrEnginePool::TrainedDataMapping::TrainedDataMapping(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0) {
+        close(fd);
+        return;
+    }
+
+    // The mapping remains valid once the file is closed
+    void* mapped = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) return;
+
+    // The trained data components are read once, from the start to the end of the file
+    madvise(mapped, (size_t) fileStat.st_size, MADV_SEQUENTIAL);
+    data = mapped;
+    size = (size_t) fileStat.st_size;
+}
+
+OcrEnginePool::TrainedDataMapping::~TrainedDataMapping() {
+    if (data != nullptr) munmap(data, size);
+}
+
+OcrEnginePool::~OcrEnginePool() {
+    for (Entry& entry : entries) entry.engine->End();
+}
+
+OcrEnginePool& OcrEnginePool::getInstance() {
+    static OcrEnginePool instance;
+    return instance;
+}
+
+OcrEnginePool::Lease OcrEnginePool::acquire(const Config& config) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        for (Entry& entry : entries) {
+            if (!entry.isLeased && entry.config == config) {
+                entry.isLeased = true;
+                return { this, entry.engine.get() };
+            }
+        }
+
+        if (std::find(failedConfigs.begin(), failedConfigs.end(), config) != failedConfigs.end()) return {};
+    }
+
+    const int64_t startNanos = FramePacer::getTimeNanos();
+    bool isMapped = false;
+    std::unique_ptr<tesseract::TessBaseAPI> engine = createEngine(config, isMapped);
+    const int64_t initNanos = FramePacer::getTimeNanos() - startNanos;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (engine == nullptr) {
+        failedConfigs.push_back(config);
+        return {};
+    }
+
+    statistics.engineCount++;
+    if (isMapped) statistics.mappedEngineCount++;
+    statistics.totalInitNanos += initNanos;
+    statistics.maxInitNanos = std::max(statistics.maxInitNanos, initNanos);
+
+    tesseract::TessBaseAPI* leasedEngine = engine.get();
+    entries.push_back({ config, std::move(engine), true, getTrainedDataSize(config) });
+    LOGD(LOG_TAG, "Engine created for %1$s in %2$lldms, mapped=%3$d, %4$d engines in the pool",
+         config.language.c_str(), (long long) (initNanos / 1'000'000), isMapped, (int) entries.size());
+
+    return { this, leasedEngine };
+}
+
+std::unique_ptr<tesseract::TessBaseAPI> OcrEnginePool::createEngine(const Config& config, bool& isMapped) {
+    auto engine = std::make_unique<tesseract::TessBaseAPI>();
+
+    // The legacy engine mode requires trained data containing the legacy model, failing here if it doesn't
+    const auto engineMode = static_cast<tesseract::OcrEngineMode>(config.engineMode);
+
+    // Tesseract only reads the main language from a buffer, the other ones and the configs are read from the data path
+    if (config.language.find('+') == std::string::npos) {
+        const std::string path = findTrainedDataPath(config, config.language);
+        const TrainedDataMapping mapping(path);
+        isMapped = mapping.getData() != nullptr && engine->Init(mapping.getData(), (int) mapping.getSize(),
+                config.language.c_str(), engineMode, nullptr, 0, nullptr, nullptr, false, nullptr) == 0;
+        if (!isMapped && mapping.getData() != nullptr) engine = std::make_unique<tesseract::TessBaseAPI>();
+    }
+
+    const char* dataPath = config.dataPath.empty() ? nullptr : config.dataPath.c_str();
+    if (!isMapped && engine->Init(dataPath, config.language.c_str(), engineMode) != 0) {
+        LOGE(LOG_TAG, "Engine can't be initialized for %1$s, mode %2$d", config.language.c_str(), config.engineMode);
+        return nullptr;
+    }
+
+    engine->SetPageSegMode(static_cast<tesseract::PageSegMode>(config.pageSegMode));
+    if (!config.charWhitelist.empty()) {
+        engine->SetVariable("tessedit_char_whitelist", config.charWhitelist.c_str());
+    }
+    return engine;
+}
+
+std::string OcrEnginePool::findTrainedDataPath(const Config& config, const std::string& language) {
+    const char* prefix = config.dataPath.empty() ? std::getenv("TESSDATA_PREFIX") : config.dataPath.c_str();
+    if (prefix == nullptr) return {};
+
+    // Each language is loaded from its own file, in the tessdata directory or the prefix
+    struct stat fileStat = {};
+    for (const char* directory : { "/tessdata/", "/" }) {
+        std::string path = std::string(prefix) + directory + language + ".traineddata";
+        if (stat(path.c_str(), &fileStat) == 0) return path;
+    }
+
+    return {};
+}
+
+size_t OcrEnginePool::getTrainedDataSize(const Config& config) {
+    // Languages are separated by '+'
+    size_t size = 0;
+    std::stringstream languages(config.language);
+    std::string language;
+    while (std::getline(languages, language, '+')) {
+        const std::string path = findTrainedDataPath(config, language);
+        struct stat fileStat = {};
+        if (!path.empty() && stat(path.c_str(), &fileStat) == 0) size += (size_t) fileStat.st_size;
+    }
+
+    return size;
+}
+
+size_t OcrEnginePool::getMemorySize() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    size_t size = 0;
+    for (const Entry& entry : entries) size += entry.trainedDataSize;
+
+    return size;
+}
+
+OcrEnginePool::Statistics OcrEnginePool::getStatistics() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return statistics;
+}
+
+void OcrEnginePool::giveBack(tesseract::TessBaseAPI* engine) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    for (Entry& entry : entries) {
+        if (entry.engine.get() == engine) {
+            // Drop the last recognized image, it references the detector screen pixels
+            entry.engine->Clear();
+            entry.isLeased = false;
+            return;
+        }
+    }
+}
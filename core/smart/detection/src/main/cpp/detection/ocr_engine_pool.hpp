@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_OCR_ENGINE_POOL_HPP
+#define KLICK_R_OCR_ENGINE_POOL_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <tesseract/baseapi.h>
+
+#include "../types/ocr_options.hpp"
+
+namespace smartautoclicker {
+
+    /** Number of int64 values in the [Detector::getOcrEngineStatistics] array. */
+    static constexpr int OCR_ENGINE_STATISTICS_VALUES_COUNT = 4;
+
+    /**
+     * Process wide pool of initialized Tesseract engines.
+     *
+     * Loading the trained data of a language takes seconds, so engines are created on the first request for a
+     * configuration and kept for the whole process, shared by all detectors. An engine is used by a single thread at
+     * a time through a [Lease], concurrent requests get different engines.
+     *
+     * The trained data file of a single language configuration is mapped in memory and given to Tesseract as a
+     * buffer: it is paged in from the page cache shared by all engines of the language, instead of being read in a
+     * heap copy of the whole file on each initialization. The models are still deserialized by each engine.
+     */
+    class OcrEnginePool {
+
+    public:
+        /** The configuration of an engine. */
+        struct Config {
+            /** The directory containing the tessdata directory. Empty to use the TESSDATA_PREFIX environment variable. */
+            std::string dataPath;
+            /** The language of the trained data to load. */
+            std::string language = "chi_sim";
+            /** The tesseract::PageSegMode of the recognition. A candidate holds the single line of its condition. */
+            int pageSegMode = tesseract::PSM_SINGLE_LINE;
+            /** The only characters that can be recognized, set as tessedit_char_whitelist. Empty for all characters. */
+            std::string charWhitelist;
+            /** The tesseract::OcrEngineMode of the engine. */
+            int engineMode = tesseract::OEM_DEFAULT;
+
+            bool operator==(const Config& other) const {
+                return dataPath == other.dataPath && language == other.language && pageSegMode == other.pageSegMode
+                        && charWhitelist == other.charWhitelist && engineMode == other.engineMode;
+            }
+
+            /** @return this configuration, with the options of a text condition applied. Unchanged if null. */
+            Config withOptions(const OcrOptions* options) const;
+        };
+
+        /** The engines created by the pool since the process start, and the time spent initializing them. */
+        struct Statistics {
+            int64_t engineCount = 0;
+            /** The engines initialized from a mapped trained data file. */
+            int64_t mappedEngineCount = 0;
+            int64_t totalInitNanos = 0;
+            int64_t maxInitNanos = 0;
+        };
+
+        /** Exclusive use of an engine of the pool, given back to the pool on destruction. */
+        class Lease {
+
+        private:
+            OcrEnginePool* pool = nullptr;
+            tesseract::TessBaseAPI* engine = nullptr;
+
+        public:
+            Lease() = default;
+            Lease(OcrEnginePool* pool, tesseract::TessBaseAPI* engine) : pool(pool), engine(engine) {}
+            ~Lease();
+
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            Lease(Lease&& other) noexcept;
+            Lease& operator=(Lease&& other) noexcept;
+
+            /** @return true if an engine is leased, false if the engine can't be initialized. */
+            explicit operator bool() const { return engine != nullptr; }
+            tesseract::TessBaseAPI* operator->() const { return engine; }
+            tesseract::TessBaseAPI& operator*() const { return *engine; }
+        };
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "OcrEnginePool";
+
+        struct Entry {
+            Config config;
+            std::unique_ptr<tesseract::TessBaseAPI> engine;
+            bool isLeased = false;
+            /** The size of the trained data files of the engine, an estimation of its memory. */
+            size_t trainedDataSize = 0;
+        };
+
+        /** The trained data file of a language, mapped during the initialization of an engine. */
+        class TrainedDataMapping {
+
+        private:
+            void* data = nullptr;
+            size_t size = 0;
+
+        public:
+            explicit TrainedDataMapping(const std::string& path);
+            ~TrainedDataMapping();
+
+            TrainedDataMapping(const TrainedDataMapping&) = delete;
+            TrainedDataMapping& operator=(const TrainedDataMapping&) = delete;
+
+            /** @return the file content, nullptr if it can't be mapped. */
+            const char* getData() const { return static_cast<const char*>(data); }
+            size_t getSize() const { return size; }
+        };
+
+        /** Protects the fields below. */
+        std::mutex mutex;
+        /** All engines created by the pool. */
+        std::vector<Entry> entries;
+        /** The configurations that failed to initialize, not retried as it would fail again. */
+        std::vector<Config> failedConfigs;
+        Statistics statistics;
+
+        OcrEnginePool() = default;
+
+        /**
+         * Create and initialize a new engine. Called without holding the lock, this is slow.
+         *
+         * @param isMapped set to true if the engine is initialized from the mapped trained data file.
+         */
+        static std::unique_ptr<tesseract::TessBaseAPI> createEngine(const Config& config, bool& isMapped);
+        /** @return the path of the trained data file of a language, empty if not found. */
+        static std::string findTrainedDataPath(const Config& config, const std::string& language);
+        /** @return the size of the trained data files of all languages of a configuration, 0 if not found. */
+        static size_t getTrainedDataSize(const Config& config);
+
+        void giveBack(tesseract::TessBaseAPI* engine);
+
+    public:
+        ~OcrEnginePool();
+
+        OcrEnginePool(const OcrEnginePool&) = delete;
+        OcrEnginePool& operator=(const OcrEnginePool&) = delete;
+
+        /** @return the pool of the process. */
+        static OcrEnginePool& getInstance();
+
+        /**
+         * Get an engine for a configuration, creating it if none is available.
+         * Can be called from any thread.
+         *
+         * @param config the configuration of the engine.
+         *
+         * @return the lease of the engine, empty if it can't be initialized with this configuration.
+         */
+        Lease acquire(const Config& config);
+
+        /**
+         * Get the memory of the engines of the pool, estimated from the size of their trained data, as the Tesseract
+         * allocations can't be measured. Can be called from any thread.
+         *
+         * @return the estimated memory, in bytes.
+         */
+        size_t getMemorySize();
+
+        /** @return the engines created since the process start. Can be called from any thread. */
+        Statistics getStatistics();
+    };
+}
+
+#endif //KLICK_R_OCR_ENGINE_POOL_HPP
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+#include "ocr_preprocessor.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+const cv::Mat& OcrPreprocessor::process(const cv::Mat& candidate) {
+    TRACE_SECTION("ocrPreprocess");
+    cv::cvtColor(candidate, gray, cv::COLOR_RGBA2GRAY);
+
+    // Resized before the binarization, the interpolation keeps the edges of the glyphs smooth
+    const double scaleRatio = getScaleRatio(gray.rows);
+    const cv::Mat* toBinarize = &gray;
+    if (scaleRatio != 1.0) {
+        cv::resize(gray, scaledGray, cv::Size(), scaleRatio, scaleRatio,
+                   scaleRatio > 1.0 ? cv::INTER_CUBIC : cv::INTER_AREA);
+        toBinarize = &scaledGray;
+    }
+
+    // A candidate has the size of its condition, small enough for its background to be uniform: a global Otsu
+    // threshold separates it from the text without the cost of an adaptive one
+    cv::threshold(*toBinarize, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+
+    // The background is the most present value, Tesseract expects dark text on it
+    if (cv::countNonZero(binary) < (int) binary.total() / 2) {
+        cv::bitwise_not(binary, binary);
+    }
+
+    cv::copyMakeBorder(binary, bordered, OCR_BORDER_SIZE, OCR_BORDER_SIZE, OCR_BORDER_SIZE, OCR_BORDER_SIZE,
+                       cv::BORDER_CONSTANT, cv::Scalar(255));
+    return bordered;
+}
+
+double OcrPreprocessor::getScaleRatio(const int candidateHeight) {
+    if (candidateHeight <= 0) return 1.0;
+    return std::clamp((double) OCR_TARGET_LINE_HEIGHT / candidateHeight, OCR_MAX_DOWNSCALE, OCR_MAX_UPSCALE);
+}
+
+size_t OcrPreprocessor::getMemorySize() const {
+    return getMatMemorySize(gray) + getMatMemorySize(scaledGray) + getMatMemorySize(binary)
+            + getMatMemorySize(bordered);
+}
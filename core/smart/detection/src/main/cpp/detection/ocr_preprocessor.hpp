@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_OCR_PREPROCESSOR_HPP
+#define KLICK_R_OCR_PREPROCESSOR_HPP
+
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /** Height of the text lines given to the OCR engine, in pixels. Tesseract is trained on a ~20 pixels x-height. */
+    static constexpr int OCR_TARGET_LINE_HEIGHT = 40;
+    /** Maximum upscaling of a candidate, upscaling more only blurs the glyphs. */
+    static constexpr double OCR_MAX_UPSCALE = 4.0;
+    /** Maximum downscaling of a candidate, keeping the small glyphs of a tall candidate readable. */
+    static constexpr double OCR_MAX_DOWNSCALE = 0.5;
+    /** Width of the background border added around the candidate, Tesseract misses the glyphs touching the edges. */
+    static constexpr int OCR_BORDER_SIZE = 8;
+
+    /**
+     * Prepares the candidates of the text conditions for the OCR engine.
+     *
+     * Giving the candidate color pixels directly to Tesseract makes it binarize them itself, at a text size it isn't
+     * trained for. The candidate is instead converted to gray, rescaled so its line is [OCR_TARGET_LINE_HEIGHT] high,
+     * binarized with the Otsu threshold and set to dark text on a light background. The engine then works on a single
+     * channel image of its preferred size, recognized faster and more reliably.
+     *
+     * The buffers are kept between the candidates to avoid allocations, this isn't thread safe.
+     */
+    class OcrPreprocessor {
+
+    private:
+        /** The candidate converted to gray. */
+        cv::Mat gray = cv::Mat();
+        /** [gray] rescaled to the target line height. */
+        cv::Mat scaledGray = cv::Mat();
+        /** [scaledGray] binarized. */
+        cv::Mat binary = cv::Mat();
+        /** [binary] with its background border, given to the OCR engine. */
+        cv::Mat bordered = cv::Mat();
+
+        /** @return the scale ratio bringing the height of a candidate to [OCR_TARGET_LINE_HEIGHT]. */
+        static double getScaleRatio(int candidateHeight);
+
+    public:
+        OcrPreprocessor() = default;
+
+        /**
+         * Prepare a candidate for the OCR engine.
+         *
+         * @param candidate the candidate area of the screen color image, in RGBA.
+         *
+         * @return the binarized single channel image to recognize. Valid until the next call to this method.
+         */
+        const cv::Mat& process(const cv::Mat& candidate);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_OCR_PREPROCESSOR_HPP
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+
+#include "ocr_text_cache.hpp"
+
+using namespace smartautoclicker;
+
+/** FNV-1a 64 bits constants. */
+static constexpr uint64_t HASH_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static constexpr uint64_t HASH_PRIME = 0x100000001b3ULL;
+
+
+uint64_t OcrTextCache::hash(const cv::Mat& image, uint64_t optionsHash) {
+    uint64_t hash = HASH_OFFSET_BASIS;
+    hash = (hash ^ optionsHash) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) image.cols) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) image.rows) * HASH_PRIME;
+
+    // The image is usually a view on the screen, hash it row by row
+    const size_t rowLength = (size_t) image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; y++) {
+        const uint8_t* row = image.ptr<uint8_t>(y);
+
+        size_t i = 0;
+        for (; i + 8 <= rowLength; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, row + i, sizeof(word));
+            hash = (hash ^ word) * HASH_PRIME;
+        }
+        for (; i < rowLength; i++) {
+            hash = (hash ^ row[i]) * HASH_PRIME;
+        }
+    }
+
+    return hash;
+}
+
+const std::string* OcrTextCache::find(uint64_t hash) {
+    auto cached = entriesByHash.find(hash);
+    if (cached == entriesByHash.end()) {
+        statistics.onMiss();
+        return nullptr;
+    }
+
+    statistics.onHit();
+    entries.splice(entries.begin(), entries, cached->second);
+    return &cached->second->text;
+}
+
+void OcrTextCache::put(uint64_t hash, std::string text) {
+    auto cached = entriesByHash.find(hash);
+    if (cached != entriesByHash.end()) {
+        cached->second->text = std::move(text);
+        entries.splice(entries.begin(), entries, cached->second);
+        return;
+    }
+
+    if (entries.size() >= OCR_TEXT_CACHE_MAX_ENTRIES) {
+        entriesByHash.erase(entries.back().hash);
+        entries.pop_back();
+        statistics.onEvicted(1);
+    }
+
+    entries.push_front({hash, std::move(text)});
+    entriesByHash[hash] = entries.begin();
+}
+
+size_t OcrTextCache::getMemorySize() const {
+    size_t size = 0;
+    for (const Entry& entry : entries) size += sizeof(Entry) + entry.text.capacity();
+
+    return size;
+}
+
+void OcrTextCache::clear() {
+    statistics.onEvicted((int64_t) entries.size());
+    entries.clear();
+    entriesByHash.clear();
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_OCR_TEXT_CACHE_HPP
+#define KLICK_R_OCR_TEXT_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <opencv2/core/mat.hpp>
+
+#include "../types/cache_statistics.hpp"
+
+namespace smartautoclicker {
+
+    /** Maximum number of recognized texts kept by an [OcrTextCache]. */
+    static constexpr size_t OCR_TEXT_CACHE_MAX_ENTRIES = 32;
+
+    /**
+     * Cache for the texts recognized by the OCR engine, keyed by the hash of the recognized image content.
+     * Text conditions usually verify the same label frame after frame, and its content rarely changes.
+     * The least recently used text is dropped once [OCR_TEXT_CACHE_MAX_ENTRIES] is reached.
+     */
+    class OcrTextCache {
+
+    private:
+        struct Entry {
+            uint64_t hash;
+            std::string text;
+        };
+
+        /** The cached texts, most recently used first. */
+        std::list<Entry> entries;
+        /** The position of each entry in [entries], keyed by its hash. */
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> entriesByHash;
+        /** The lookups of [find], and the texts dropped by [put] and [clear]. */
+        CacheStatistics statistics;
+
+    public:
+        OcrTextCache() = default;
+
+        /**
+         * @param image the image to hash.
+         * @param optionsHash the hash of the OCR options the image is recognized with, see [OcrOptions::hash].
+         *
+         * @return the hash of the content of an image, of its size and of its recognition options.
+         */
+        static uint64_t hash(const cv::Mat& image, uint64_t optionsHash = 0);
+
+        /**
+         * Get the text recognized for an image content.
+         *
+         * @param hash the hash of the image, from [hash].
+         *
+         * @return the text, or nullptr if it is not cached. Valid until the next call to [put] or [clear].
+         */
+        const std::string* find(uint64_t hash);
+
+        /** Cache the text recognized for an image content, dropping the least recently used text if full. */
+        void put(uint64_t hash, std::string text);
+
+        /** @return the memory of the cached texts, in bytes. */
+        size_t getMemorySize() const;
+
+        /** @return the lookups and evictions of the cached texts. */
+        const CacheStatistics& getStatistics() const { return statistics; }
+
+        /** Drop all cached texts. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_OCR_TEXT_CACHE_HPP
@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "position_prefilter.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+template<typename OnPosition>
+bool PositionPrefilter::forEachPosition(const cv::Mat& sums, const cv::Mat& squaredSums, const cv::Rect& area,
+                                        const cv::Size& templSize, const TemplateStatistics& templStatistics,
+                                        double maxMeanDiff, OnPosition onPosition) {
+
+    const int resultCols = area.width - templSize.width + 1;
+    const int resultRows = area.height - templSize.height + 1;
+    if (resultCols <= 0 || resultRows <= 0) return true;
+
+    // Compared on the window sums, the means multiplied by the template area
+    const auto templArea = (int64_t) templSize.area();
+    const double minSum = (double) templStatistics.getSum() - maxMeanDiff * (double) templArea;
+    const double maxSum = (double) templStatistics.getSum() + maxMeanDiff * (double) templArea;
+    // A flat template matches everywhere, including the flat windows
+    const bool isVarianceNeeded = !templStatistics.isFlat();
+
+    for (int y = 0; y < resultRows; y++) {
+        const int* sumsTop = sums.ptr<int>(area.y + y) + area.x;
+        const int* sumsBottom = sums.ptr<int>(area.y + y + templSize.height) + area.x;
+        const auto* squaredSumsTop = squaredSums.ptr<double>(area.y + y) + area.x;
+        const auto* squaredSumsBottom = squaredSums.ptr<double>(area.y + y + templSize.height) + area.x;
+
+        for (int x = 0; x < resultCols; x++) {
+            const int64_t windowSum = (int64_t) sumsBottom[x + templSize.width] - sumsBottom[x]
+                    - sumsTop[x + templSize.width] + sumsTop[x];
+            if ((double) windowSum <= minSum || (double) windowSum >= maxSum) continue;
+
+            if (isVarianceNeeded) {
+                const auto windowSquaredSum = (int64_t) (squaredSumsBottom[x + templSize.width] - squaredSumsBottom[x]
+                        - squaredSumsTop[x + templSize.width] + squaredSumsTop[x]);
+                if (templArea * windowSquaredSum - windowSum * windowSum <= 0) continue;
+            }
+
+            if (!onPosition(cv::Point(x, y))) return false;
+        }
+    }
+
+    return true;
+}
+
+const std::vector<cv::Point>& PositionPrefilter::filter(const cv::Mat& sums, const cv::Mat& squaredSums,
+                                                        const cv::Rect& area, const cv::Size& templSize,
+                                                        const TemplateStatistics& templStatistics,
+                                                        double maxMeanDiff) {
+
+    TRACE_SECTION("prefilterPositions");
+    positions.clear();
+    forEachPosition(sums, squaredSums, area, templSize, templStatistics, maxMeanDiff,
+                    [this](const cv::Point& position) {
+                        positions.push_back(position);
+                        return true;
+                    });
+
+    return positions;
+}
+
+bool PositionPrefilter::hasPosition(const cv::Mat& sums, const cv::Mat& squaredSums, const cv::Rect& area,
+                                    const cv::Size& templSize, const TemplateStatistics& templStatistics,
+                                    double maxMeanDiff) {
+
+    TRACE_SECTION("proveAbsence");
+    return !forEachPosition(sums, squaredSums, area, templSize, templStatistics, maxMeanDiff,
+                            [](const cv::Point&) { return false; });
+}
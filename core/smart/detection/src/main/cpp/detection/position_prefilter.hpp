@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_POSITION_PREFILTER_HPP
+#define KLICK_R_POSITION_PREFILTER_HPP
+
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "template_statistics.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Selects the matching positions of a template that can be detected, with the statistics of their window only.
+     *
+     * The mean and the variance of each window are read in constant time from the integral images of the screen. A
+     * window without variance has a null TM_CCOEFF_NORMED value, and a window whose mean is too far from the template
+     * one would be rejected by the color verification anyway: only the other positions need to be correlated.
+     *
+     * The buffers are kept between the matchings to avoid allocations, this isn't thread safe.
+     */
+    class PositionPrefilter {
+
+    private:
+        /** The positions kept by the last [filter]. */
+        std::vector<cv::Point> positions;
+
+        /**
+         * Call [onPosition] with each position kept by the window statistics, relative to [area], until it returns
+         * false. The parameters are the ones of [filter].
+         *
+         * @return false if [onPosition] stopped the iteration, true if all positions have been visited.
+         */
+        template<typename OnPosition>
+        static bool forEachPosition(const cv::Mat& sums, const cv::Mat& squaredSums, const cv::Rect& area,
+                                    const cv::Size& templSize, const TemplateStatistics& templStatistics,
+                                    double maxMeanDiff, OnPosition onPosition);
+
+    public:
+        /**
+         * Select the positions of a template in an area of the screen.
+         *
+         * @param sums the integral image of the screen scaled gray image, in CV_32S.
+         * @param squaredSums the integral image of its square, in CV_64F.
+         * @param area the area of the screen scaled gray image searched. The template must fit in it.
+         * @param templSize the size of the template.
+         * @param templStatistics the statistics of the template.
+         * @param maxMeanDiff the gray mean difference between a window and the template rejecting the window.
+         *
+         * @return the kept positions, relative to [area]. Valid until the next call to this method.
+         */
+        const std::vector<cv::Point>& filter(const cv::Mat& sums, const cv::Mat& squaredSums, const cv::Rect& area,
+                                             const cv::Size& templSize, const TemplateStatistics& templStatistics,
+                                             double maxMeanDiff);
+
+        /**
+         * Tells if at least one position of a template in an area of the screen is kept by the window statistics.
+         * It stops at the first kept position: only an absent template has all its positions visited. The
+         * parameters are the ones of [filter].
+         *
+         * @return false if the template can't be detected anywhere in the area, true if it might be.
+         */
+        static bool hasPosition(const cv::Mat& sums, const cv::Mat& squaredSums, const cv::Rect& area,
+                                const cv::Size& templSize, const TemplateStatistics& templStatistics,
+                                double maxMeanDiff);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const { return positions.capacity() * sizeof(cv::Point); }
+    };
+}
+
+#endif //KLICK_R_POSITION_PREFILTER_HPP
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include "region_change_waiter.hpp"
+
+using namespace smartautoclicker;
+
+bool RegionChangeWaiter::wait(const cv::Rect& roi, double threshold, int64_t timeoutNanos,
+                              const std::atomic<bool>& isCancelled) {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    fullSizeRoi = roi;
+    changeThreshold = std::clamp(threshold, 0.0, 1.0);
+    tilesImageSize = cv::Size();
+    changedTiles.clear();
+    changedCount = 0;
+    isChanged = false;
+    isWaiting.store(true, std::memory_order_relaxed);
+
+    regionChanged.wait_for(lock, std::chrono::nanoseconds(std::max<int64_t>(timeoutNanos, 0)), [&] {
+        return isChanged || isCancelled.load(std::memory_order_relaxed);
+    });
+
+    isWaiting.store(false, std::memory_order_relaxed);
+    return isChanged;
+}
+
+void RegionChangeWaiter::onScreenImage(const FrameSignature& signature, const std::vector<uint8_t>& excludedTiles,
+                                       double scaleRatio) {
+    if (!isWaiting.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (isChanged) return;
+
+    const cv::Size& imageSize = signature.getImageSize();
+    const cv::Rect scaledRoi = cv::Rect(
+            (int) std::floor(fullSizeRoi.x * scaleRatio),
+            (int) std::floor(fullSizeRoi.y * scaleRatio),
+            (int) std::ceil(fullSizeRoi.width * scaleRatio),
+            (int) std::ceil(fullSizeRoi.height * scaleRatio)) & cv::Rect(0, 0, imageSize.width, imageSize.height);
+
+    // Without a comparable previous image, the changes are unknown and the area is reported as changed
+    if (!signature.hasPrevious() || scaledRoi.empty()) {
+        isChanged = true;
+        regionChanged.notify_all();
+        return;
+    }
+
+    if (tilesImageSize != imageSize) {
+        tilesImageSize = imageSize;
+        changedTiles.assign(FrameSignature::getTileCount(imageSize), 0);
+        changedCount = 0;
+    }
+
+    const int tileColumns = (imageSize.width + FrameSignature::TILE_SIZE - 1) / FrameSignature::TILE_SIZE;
+    const int firstColumn = scaledRoi.x / FrameSignature::TILE_SIZE;
+    const int lastColumn = (scaledRoi.x + scaledRoi.width - 1) / FrameSignature::TILE_SIZE;
+    const int firstRow = scaledRoi.y / FrameSignature::TILE_SIZE;
+    const int lastRow = (scaledRoi.y + scaledRoi.height - 1) / FrameSignature::TILE_SIZE;
+    const std::vector<uint8_t>& dirtyTiles = signature.getDirtyTiles();
+    const bool hasExcludedTiles = excludedTiles.size() == dirtyTiles.size();
+    for (int tileY = firstRow; tileY <= lastRow; tileY++) {
+        for (int tileX = firstColumn; tileX <= lastColumn; tileX++) {
+            const size_t tileIndex = (size_t) tileY * tileColumns + tileX;
+            if (dirtyTiles[tileIndex] == 0 || changedTiles[tileIndex] != 0) continue;
+            if (hasExcludedTiles && excludedTiles[tileIndex] != 0) continue;
+
+            changedTiles[tileIndex] = 1;
+            changedCount++;
+        }
+    }
+
+    const size_t tileCount = (size_t) (lastColumn - firstColumn + 1) * (lastRow - firstRow + 1);
+    const size_t requiredCount = std::max<size_t>(1, (size_t) std::ceil(changeThreshold * (double) tileCount));
+    if (changedCount < requiredCount) return;
+
+    isChanged = true;
+    regionChanged.notify_all();
+}
+
+void RegionChangeWaiter::wakeUp() {
+    // Under the lock, the caller can't miss it between its check and its wait
+    std::lock_guard<std::mutex> lock(mutex);
+    regionChanged.notify_all();
+}
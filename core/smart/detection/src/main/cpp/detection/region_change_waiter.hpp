@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_REGION_CHANGE_WAITER_HPP
+#define KLICK_R_REGION_CHANGE_WAITER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <opencv2/core/types.hpp>
+
+#include "frame_signature.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Blocks a caller until an area of the screen changes, from the [FrameSignature] of the screen images set by
+     * another thread. The changed tiles of the area are accumulated from one image to another: an animation moving
+     * through the area wakes the caller once enough of its tiles have changed since the wait started, even if only a
+     * few of them change with each image.
+     *
+     * Only one wait is supported at a time.
+     */
+    class RegionChangeWaiter {
+
+    private:
+        /** Guards the fields below. */
+        std::mutex mutex;
+        /** Notified when the waited area has changed, or when the wait is cancelled. */
+        std::condition_variable regionChanged;
+        /** True while a caller is waiting, checked without the lock by [onScreenImage]. */
+        std::atomic<bool> isWaiting = false;
+
+        /** The waited area, in full size coordinates. */
+        cv::Rect fullSizeRoi = cv::Rect();
+        /** The part of the tiles of the area that must have changed, between 0 and 1. 0 for any change. */
+        double changeThreshold = 0;
+        /** The size of the image of [changedTiles], the signature size when they have been accumulated. */
+        cv::Size tilesImageSize = cv::Size();
+        /** For each tile of the screen images, row by row, 1 if it has changed since the wait started, 0 if not. */
+        std::vector<uint8_t> changedTiles;
+        /** The number of tiles of the area set in [changedTiles]. */
+        size_t changedCount = 0;
+        /** True once the area has changed enough. */
+        bool isChanged = false;
+
+    public:
+        RegionChangeWaiter() = default;
+
+        RegionChangeWaiter(const RegionChangeWaiter&) = delete;
+        RegionChangeWaiter& operator=(const RegionChangeWaiter&) = delete;
+
+        /**
+         * Wait for an area of the screen to change in the screen images set after this call.
+         *
+         * @param roi the area to wait for, in full size coordinates.
+         * @param threshold the part of the tiles of the area that must have changed, between 0 and 1. 0 to wake on the
+         *                  first changed tile.
+         * @param timeoutNanos the maximum duration of the wait, in nanoseconds.
+         * @param isCancelled stops the wait when set, see [wakeUp].
+         *
+         * @return true if the area has changed, false if the wait has timed out or has been cancelled.
+         */
+        bool wait(const cv::Rect& roi, double threshold, int64_t timeoutNanos, const std::atomic<bool>& isCancelled);
+
+        /**
+         * Accumulate the changes of a new screen image, waking the caller of [wait] if the area has changed enough.
+         * Cheap without any wait in progress.
+         *
+         * @param signature the signature of the screen, updated with the new image.
+         * @param excludedTiles for each tile of the signature, 1 if its changes are ignored, see [AnimatedTilesMask].
+         *                      Empty to accumulate the changes of all tiles.
+         * @param scaleRatio the scale ratio of the image of the signature.
+         */
+        void onScreenImage(const FrameSignature& signature, const std::vector<uint8_t>& excludedTiles,
+                           double scaleRatio);
+
+        /** Wake the caller of [wait] to check its cancellation. */
+        void wakeUp();
+    };
+}
+
+#endif //KLICK_R_REGION_CHANGE_WAITER_HPP
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "screen_image_preparer.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+bool ScreenImagePreparer::Request::operator==(const Request& other) const {
+    return pixels == other.pixels && width == other.width && height == other.height && rowStride == other.rowStride
+            && fullSize == other.fullSize && scaleRatio == other.scaleRatio && image == other.image;
+}
+
+ScreenImagePreparer::~ScreenImagePreparer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        isStopping = true;
+    }
+    requestAvailable.notify_all();
+
+    if (thread.joinable()) thread.join();
+}
+
+void ScreenImagePreparer::prepare(uint8_t* pixels, int width, int height, size_t rowStride, const cv::Size& fullSize,
+                                  double scaleRatio, DetectionImage& image) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        waitForPreparation(lock);
+
+        request = { pixels, width, height, rowStride, fullSize, scaleRatio, &image };
+        state = State::PREPARING;
+        if (!thread.joinable()) thread = std::thread(&ScreenImagePreparer::threadLoop, this);
+    }
+    requestAvailable.notify_one();
+}
+
+DetectionImage* ScreenImagePreparer::take(const uint8_t* pixels, int width, int height, size_t rowStride,
+                                          const cv::Size& fullSize, double scaleRatio) {
+
+    std::unique_lock<std::mutex> lock(mutex);
+    if (state == State::IDLE) return nullptr;
+
+    const Request taken = {
+            const_cast<uint8_t*>(pixels), width, height, rowStride, fullSize, scaleRatio, request.image };
+    waitForPreparation(lock);
+    state = State::IDLE;
+
+    return taken == request ? request.image : nullptr;
+}
+
+void ScreenImagePreparer::cancel() {
+    std::unique_lock<std::mutex> lock(mutex);
+    waitForPreparation(lock);
+    state = State::IDLE;
+}
+
+void ScreenImagePreparer::waitForPreparation(std::unique_lock<std::mutex>& lock) {
+    requestCompleted.wait(lock, [this] { return state != State::PREPARING; });
+}
+
+void ScreenImagePreparer::threadLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        requestAvailable.wait(lock, [this] { return isStopping || state == State::PREPARING; });
+        if (isStopping) return;
+
+        // The image is only accessed by this thread until the state changes, the lock is not needed
+        const Request prepared = request;
+        lock.unlock();
+        {
+            TRACE_SECTION("prepareScreenImage");
+            prepared.image->processPixels(prepared.pixels, prepared.width, prepared.height, prepared.rowStride,
+                                          prepared.fullSize, prepared.scaleRatio);
+        }
+        lock.lock();
+
+        state = State::PREPARED;
+        requestCompleted.notify_all();
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCREEN_IMAGE_PREPARER_HPP
+#define KLICK_R_SCREEN_IMAGE_PREPARER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "detection_image.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Processes the next screen image on a background thread, while the conditions are matched on the current one.
+     * The image is filled in place: it is the back buffer of the detector screen images.
+     *
+     * The gray conversion and resize of a frame are the main fixed cost of each screen image. Started with [prepare]
+     * as soon as the next frame is acquired, they overlap the matching of the current frame, and the next screen image
+     * is ready when the detection ends. The background conversion doesn't use the detector thread pool, which is busy
+     * with the matching.
+     */
+    class ScreenImagePreparer {
+
+    private:
+        /** The pixels of a screen image to prepare. */
+        struct Request {
+            uint8_t* pixels = nullptr;
+            int width = 0;
+            int height = 0;
+            size_t rowStride = 0;
+            /** The size of the screen, bigger than the pixels size when it is captured downscaled. */
+            cv::Size fullSize = cv::Size();
+            double scaleRatio = 0;
+            /** The image to fill with the pixels. */
+            DetectionImage* image = nullptr;
+
+            bool operator==(const Request& other) const;
+        };
+
+        enum class State {
+            /** No screen image is prepared. */
+            IDLE,
+            /** The [request] is waiting for the background thread, or being processed by it. */
+            PREPARING,
+            /** The [request] have been processed into its image. */
+            PREPARED,
+        };
+
+        /** The background thread. Created with the first preparation. */
+        std::thread thread;
+        std::mutex mutex;
+        std::condition_variable requestAvailable;
+        std::condition_variable requestCompleted;
+
+        State state = State::IDLE;
+        /** The current preparation. Its image is only accessed by the background thread while [State::PREPARING]. */
+        Request request = Request();
+        /** True when the preparer is being destroyed. */
+        bool isStopping = false;
+
+        void threadLoop();
+        /** Wait for the background thread to be done with the current request. The lock must be held. */
+        void waitForPreparation(std::unique_lock<std::mutex>& lock);
+
+    public:
+        ScreenImagePreparer() = default;
+        ~ScreenImagePreparer();
+
+        ScreenImagePreparer(const ScreenImagePreparer&) = delete;
+        ScreenImagePreparer& operator=(const ScreenImagePreparer&) = delete;
+
+        /**
+         * Start the processing of a screen image in the background.
+         * The previous preparation is dropped if it haven't been taken with [take].
+         * The pixels are not copied, they must remain valid while the image is used. The image must not be accessed
+         * until the preparation is taken or cancelled.
+         */
+        void prepare(uint8_t* pixels, int width, int height, size_t rowStride, const cv::Size& fullSize,
+                     double scaleRatio, DetectionImage& image);
+
+        /**
+         * Get the prepared screen image, if it is the one for those pixels, waiting for its processing if needed.
+         * Any other preparation is dropped.
+         *
+         * @return the image filled with those pixels, or null if it should be processed as usual.
+         */
+        DetectionImage* take(const uint8_t* pixels, int width, int height, size_t rowStride, const cv::Size& fullSize,
+                             double scaleRatio);
+
+        /**
+         * Drop the current preparation, waiting for the background thread to have stopped reading its pixels.
+         * Must be called before the pixels of a prepared image are released.
+         */
+        void cancel();
+    };
+}
+
+#endif //KLICK_R_SCREEN_IMAGE_PREPARER_HPP
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "screen_state_classifier.hpp"
+
+using namespace smartautoclicker;
+
+
+int ScreenStateClassifier::classify(const cv::Mat& scaledGray) {
+    if (scaledGray.empty()) return UNKNOWN_STATE;
+
+    cv::resize(scaledGray, signature, cv::Size(SIGNATURE_SIZE, SIGNATURE_SIZE), 0, 0, cv::INTER_AREA);
+
+    int closestState = UNKNOWN_STATE;
+    double closestDistance = std::numeric_limits<double>::max();
+    for (size_t state = 0; state < stateSignatures.size(); state++) {
+        const double distance = cv::norm(signature, stateSignatures[state], cv::NORM_L1) / signature.total();
+        if (distance >= closestDistance) continue;
+
+        closestState = (int) state;
+        closestDistance = distance;
+    }
+
+    const bool isKnown = closestDistance <= MAX_STATE_DISTANCE || stateSignatures.size() >= MAX_STATES;
+    if (closestState != UNKNOWN_STATE && isKnown) return closestState;
+
+    stateSignatures.push_back(signature.clone());
+    return (int) stateSignatures.size() - 1;
+}
+
+void ScreenStateClassifier::clear() {
+    stateSignatures.clear();
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCREEN_STATE_CLASSIFIER_HPP
+#define KLICK_R_SCREEN_STATE_CLASSIFIER_HPP
+
+#include <cstddef>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * Group the screen images into the states of the detected application, such as its menu, its shop or a battle,
+     * from a compact signature of their content.
+     *
+     * The signature of an image is its scaled gray image downscaled to [SIGNATURE_SIZE] squared levels, insensitive to
+     * the animations and small changes of a same state. The states are clustered from the images themselves: an image
+     * closer than [MAX_STATE_DISTANCE] to the signature of a known state is in it, the other ones create a new state
+     * until [MAX_STATES] are known, and are then in the closest one.
+     */
+    class ScreenStateClassifier {
+
+    private:
+        /** The width and height of the signatures, in levels. */
+        static constexpr int SIGNATURE_SIZE = 16;
+        /** The maximum mean difference of the levels of an image signature with the one of its state. */
+        static constexpr double MAX_STATE_DISTANCE = 12;
+        /** The maximum number of states, the next images are classified in the closest one. */
+        static constexpr size_t MAX_STATES = 32;
+
+        /** The signature of each state, at the index of its identifier. */
+        std::vector<cv::Mat> stateSignatures;
+        /** The signature of the last classified image. */
+        cv::Mat signature;
+
+    public:
+        /** Returned by [classify] when the image is empty. */
+        static constexpr int UNKNOWN_STATE = -1;
+
+        ScreenStateClassifier() = default;
+
+        /**
+         * Find the state of a screen image, creating a new one if it is not close to a known state.
+         *
+         * @param scaledGray the scaled gray image of the screen.
+         *
+         * @return the identifier of the state, kept until [clear]. UNKNOWN_STATE if the image is empty.
+         */
+        int classify(const cv::Mat& scaledGray);
+
+        /** @return the number of known states. */
+        size_t getStateCount() const { return stateSignatures.size(); }
+
+        /** Forget all states, such as when the screen is rotated. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_SCREEN_STATE_CLASSIFIER_HPP
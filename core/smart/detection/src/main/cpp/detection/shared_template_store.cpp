@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "shared_template_store.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+SharedTemplateStore& SharedTemplateStore::getInstance() {
+    static SharedTemplateStore instance;
+    return instance;
+}
+
+std::shared_ptr<const ConditionTemplate> SharedTemplateStore::borrow(uint64_t pixelsHash, double scaleRatio) {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto shared = templates.find(Key { pixelsHash, scaleRatio });
+    return shared != templates.end() ? shared->second.lock() : nullptr;
+}
+
+std::shared_ptr<const ConditionTemplate> SharedTemplateStore::share(
+        uint64_t pixelsHash, double scaleRatio, std::shared_ptr<const ConditionTemplate> conditionTemplate) {
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::weak_ptr<const ConditionTemplate>& shared = templates[Key { pixelsHash, scaleRatio }];
+    if (auto sharedTemplate = shared.lock()) return sharedTemplate;
+    shared = conditionTemplate;
+
+    // The entries of the released templates are only removed once they are numerous, most are borrowed again
+    if (templates.size() >= purgeSize) {
+        for (auto it = templates.begin(); it != templates.end();) {
+            if (it->second.expired()) it = templates.erase(it);
+            else it++;
+        }
+        purgeSize = std::max(MIN_PURGE_SIZE, templates.size() * 2);
+        LOGD(LOG_TAG, "Released templates removed, %1$zu shared", templates.size());
+    }
+
+    return conditionTemplate;
+}
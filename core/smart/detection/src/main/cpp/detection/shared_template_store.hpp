@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SHARED_TEMPLATE_STORE_HPP
+#define KLICK_R_SHARED_TEMPLATE_STORE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace smartautoclicker {
+
+    class ConditionTemplate;
+
+    /**
+     * Process wide store of the processed condition images, shared by the [TemplateCache] of all detectors.
+     *
+     * The detection, the tries of the scenario config and the benchmarks each create their own detector, but they
+     * detect the same condition bitmaps: a template processed by one of them is borrowed by the other ones instead of
+     * being processed again. The templates are keyed by the hash of their condition pixels and their scale ratio, and
+     * are only referenced weakly: a template is released with the last cache using it, the memory of the store stays
+     * the one of the detectors.
+     */
+    class SharedTemplateStore {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "SharedTemplateStore";
+        /** Minimum number of entries before the released templates are removed from the store. */
+        static constexpr size_t MIN_PURGE_SIZE = 64;
+
+        struct Key {
+            uint64_t pixelsHash = 0;
+            double scaleRatio = 0;
+
+            bool operator==(const Key& other) const {
+                return pixelsHash == other.pixelsHash && scaleRatio == other.scaleRatio;
+            }
+        };
+        struct KeyHash {
+            size_t operator()(const Key& key) const {
+                return (size_t) (key.pixelsHash ^ (std::hash<double>()(key.scaleRatio) * 0x9e3779b97f4a7c15ULL));
+            }
+        };
+
+        /** Protects the fields below. */
+        std::mutex mutex;
+        /** The templates borrowed by at least one cache, or released since the last purge. */
+        std::unordered_map<Key, std::weak_ptr<const ConditionTemplate>, KeyHash> templates;
+        /** The number of entries of [templates] triggering the next removal of the released templates. */
+        size_t purgeSize = MIN_PURGE_SIZE;
+
+        SharedTemplateStore() = default;
+
+    public:
+        SharedTemplateStore(const SharedTemplateStore&) = delete;
+        SharedTemplateStore& operator=(const SharedTemplateStore&) = delete;
+
+        /** @return the store of the process. */
+        static SharedTemplateStore& getInstance();
+
+        /**
+         * Borrow the template processed by another cache for the same condition pixels and scale ratio.
+         * Can be called from any thread.
+         *
+         * @param pixelsHash the hash of the condition pixels, from [ConditionTemplate::hashPixels].
+         * @param scaleRatio the scale ratio of the template.
+         *
+         * @return the template, or nullptr if none is used by a cache.
+         */
+        std::shared_ptr<const ConditionTemplate> borrow(uint64_t pixelsHash, double scaleRatio);
+
+        /**
+         * Share a processed template with the other caches. If another one has shared a template for the same
+         * condition pixels and scale ratio in the meantime, this one is dropped and the shared one is returned.
+         * Can be called from any thread.
+         *
+         * @param pixelsHash the hash of the condition pixels, from [ConditionTemplate::hashPixels].
+         * @param scaleRatio the scale ratio of the template.
+         * @param conditionTemplate the template processed from the condition pixels.
+         *
+         * @return the shared template.
+         */
+        std::shared_ptr<const ConditionTemplate> share(uint64_t pixelsHash, double scaleRatio,
+                                                       std::shared_ptr<const ConditionTemplate> conditionTemplate);
+    };
+}
+
+#endif //KLICK_R_SHARED_TEMPLATE_STORE_HPP
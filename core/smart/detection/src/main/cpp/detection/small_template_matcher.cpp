@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "small_template_matcher.hpp"
+
+using namespace smartautoclicker;
+
+
+/**
+ * Add the raw correlations of a template row to the ones of a result row.
+ *
+ * @param imageRow the image row under the template row.
+ * @param templRow the template row, padded with zeros to [BucketWidth].
+ * @param templCols the real number of columns of the template.
+ * @param imageCols the number of columns of the image.
+ * @param resultCols the number of positions of the result row.
+ * @param correlations the correlations of the result row.
+ */
+template<int BucketWidth>
+static void correlateRow(const uint8_t* imageRow, const uint8_t* templRow, int templCols, int imageCols,
+                         int resultCols, uint32_t* correlations) {
+
+    // Positions where the padded template row is still in the image row, the others use the real width
+    const int paddedCols = std::clamp(imageCols - BucketWidth + 1, 0, resultCols);
+    int x = 0;
+
+#if defined(__ARM_NEON)
+    for (; x + 8 <= paddedCols; x += 8) {
+        uint32x4_t low = vld1q_u32(correlations + x);
+        uint32x4_t high = vld1q_u32(correlations + x + 4);
+
+        for (int templX = 0; templX < BucketWidth; templX++) {
+            const uint16x8_t products = vmull_u8(vld1_u8(imageRow + x + templX), vdup_n_u8(templRow[templX]));
+            low = vaddw_u16(low, vget_low_u16(products));
+            high = vaddw_u16(high, vget_high_u16(products));
+        }
+
+        vst1q_u32(correlations + x, low);
+        vst1q_u32(correlations + x + 4, high);
+    }
+#endif
+
+    for (; x < paddedCols; x++) {
+        uint32_t correlation = 0;
+        for (int templX = 0; templX < BucketWidth; templX++) correlation += imageRow[x + templX] * templRow[templX];
+        correlations[x] += correlation;
+    }
+
+    for (; x < resultCols; x++) {
+        uint32_t correlation = 0;
+        for (int templX = 0; templX < templCols; templX++) correlation += imageRow[x + templX] * templRow[templX];
+        correlations[x] += correlation;
+    }
+}
+
+/** Compute the raw correlations of a result row, with the kernel of [BucketWidth]. */
+template<int BucketWidth>
+static void correlate(const cv::Mat& image, const uint8_t* paddedTempl, int templRows, int templCols, int y,
+                      int resultCols, uint32_t* correlations) {
+
+    std::fill(correlations, correlations + resultCols, 0u);
+    for (int templY = 0; templY < templRows; templY++) {
+        correlateRow<BucketWidth>(image.ptr<uint8_t>(y + templY), paddedTempl + templY * BucketWidth, templCols,
+                                  image.cols, resultCols, correlations);
+    }
+}
+
+/** Computes the raw correlations of a result row, with the kernel of a bucket width. */
+using RowsCorrelation = void (*)(const cv::Mat& image, const uint8_t* paddedTempl, int templRows, int templCols, int y,
+                                 int resultCols, uint32_t* correlations);
+
+/** @return the kernel of a bucket width, one of [SmallTemplateMatcher::BUCKET_WIDTHS]. */
+static RowsCorrelation getRowsCorrelation(int bucketWidth) {
+    switch (bucketWidth) {
+        case 8: return &correlate<8>;
+        case 16: return &correlate<16>;
+        case 24: return &correlate<24>;
+        case 32: return &correlate<32>;
+        case 48: return &correlate<48>;
+        default: return &correlate<64>;
+    }
+}
+
+int SmallTemplateMatcher::getBucketWidth(int templWidth) {
+    for (int bucketWidth : BUCKET_WIDTHS) {
+        if (templWidth <= bucketWidth) return bucketWidth;
+    }
+    return 0;
+}
+
+bool SmallTemplateMatcher::isSupported(const cv::Size& templSize) {
+    const int bucketWidth = getBucketWidth(templSize.width);
+    return bucketWidth > 0 && templSize.height > 0 && bucketWidth * templSize.height <= MAX_PADDED_AREA;
+}
+
+void SmallTemplateMatcher::match(const cv::Mat& image, const cv::Mat& templ,
+                                 const TemplateStatistics& templStatistics, cv::Mat& results) {
+
+    const int resultRows = image.rows - templ.rows + 1;
+    const int resultCols = image.cols - templ.cols + 1;
+    if (resultRows <= 0 || resultCols <= 0) return;
+
+    if (templStatistics.isFlat()) {
+        results.setTo(cv::Scalar(1));
+        return;
+    }
+
+    // The template rows padded for the kernel
+    const int bucketWidth = getBucketWidth(templ.cols);
+    paddedTempl.assign(templ.rows * bucketWidth, 0);
+    for (int y = 0; y < templ.rows; y++) {
+        const auto* row = templ.ptr<uint8_t>(y);
+        std::copy(row, row + templ.cols, paddedTempl.begin() + y * bucketWidth);
+    }
+
+    cv::integral(image, sums, squaredSums, CV_32S, CV_64F);
+    correlations.resize(resultCols);
+    const RowsCorrelation correlateRows = getRowsCorrelation(bucketWidth);
+
+    for (int y = 0; y < resultRows; y++) {
+        correlateRows(image, paddedTempl.data(), templ.rows, templ.cols, y, resultCols, correlations.data());
+
+        const auto* sumsTop = sums.ptr<int>(y);
+        const auto* sumsBottom = sums.ptr<int>(y + templ.rows);
+        const auto* squaredSumsTop = squaredSums.ptr<double>(y);
+        const auto* squaredSumsBottom = squaredSums.ptr<double>(y + templ.rows);
+        auto* resultRow = results.ptr<float>(y);
+
+        for (int x = 0; x < resultCols; x++) {
+            const int right = x + templ.cols;
+            const int64_t windowSum = (int64_t) sumsBottom[right] - sumsBottom[x] - sumsTop[right] + sumsTop[x];
+            const auto windowSquaredSum = (int64_t) (squaredSumsBottom[right] - squaredSumsBottom[x]
+                    - squaredSumsTop[right] + squaredSumsTop[x]);
+
+            resultRow[x] = templStatistics.getNormedValue(correlations[x], windowSum, windowSquaredSum);
+        }
+    }
+}
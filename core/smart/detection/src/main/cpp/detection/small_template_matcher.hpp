@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SMALL_TEMPLATE_MATCHER_HPP
+#define KLICK_R_SMALL_TEMPLATE_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "template_statistics.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Template matching with the TM_CCOEFF_NORMED semantics, for the small templates.
+     *
+     * The correlation is computed directly, with integer products, by kernels specialized at compile time for a few
+     * template width buckets. The template is padded with zeros up to the width of its bucket, so the loop on its
+     * columns is unrolled and each template pixel is multiplied with 8 consecutive positions at once with NEON.
+     */
+    class SmallTemplateMatcher {
+
+    private:
+        /** The widths of the kernels. A template is matched with the narrowest one containing it. */
+        static constexpr int BUCKET_WIDTHS[] = { 8, 16, 24, 32, 48, 64 };
+        /** Maximum template area, padded to its bucket width. Above, the transforms of OpenCv are faster. */
+        static constexpr int MAX_PADDED_AREA = 32 * 32;
+
+        /** The template rows, padded with zeros to the bucket width. */
+        std::vector<uint8_t> paddedTempl;
+        /** The raw correlations of the result row being computed. */
+        std::vector<uint32_t> correlations;
+        /** Integral images of the image and its square. */
+        cv::Mat sums;
+        cv::Mat squaredSums;
+
+        /** @return the width of the narrowest kernel containing the template, or 0 if it is too wide. */
+        static int getBucketWidth(int templWidth);
+
+    public:
+        /** @return true if a kernel can match a template of this size. */
+        static bool isSupported(const cv::Size& templSize);
+
+        /**
+         * Match the template in the image.
+         * The results have the same values as cv::matchTemplate with TM_CCOEFF_NORMED, with an exact correlation.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the template to search, in 8 bits gray, with a size supported by [isSupported].
+         * @param templStatistics the statistics of the template.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const cv::Mat& templ, const TemplateStatistics& templStatistics,
+                   cv::Mat& results);
+    };
+}
+
+#endif //KLICK_R_SMALL_TEMPLATE_MATCHER_HPP
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "sparse_matcher.hpp"
+
+using namespace smartautoclicker;
+
+
+void SparseMatcher::match(const cv::Mat& image, const SparseTemplate& templ, cv::Mat& results) {
+    const int resultRows = image.rows - templ.getSize().height + 1;
+    const int resultCols = image.cols - templ.getSize().width + 1;
+    if (resultRows <= 0 || resultCols <= 0) return;
+
+    const std::vector<cv::Point>& points = templ.getPoints();
+    const uint8_t* values = templ.getValues().data();
+    const TemplateStatistics& statistics = templ.getStatistics();
+    const int count = (int) points.size();
+    pointPixels.resize(count);
+
+    for (int y = 0; y < resultRows; y++) {
+        for (int i = 0; i < count; i++) pointPixels[i] = image.ptr<uint8_t>(y + points[i].y) + points[i].x;
+        auto* resultRow = results.ptr<float>(y);
+        int x = 0;
+
+#if defined(__ARM_NEON)
+        // The last loaded pixel is at x + 7 from a template pixel, still in the row for all positions of the row
+        for (; x + 8 <= resultCols; x += 8) {
+            uint32x4_t correlationLow = vdupq_n_u32(0), correlationHigh = vdupq_n_u32(0);
+            uint32x4_t sumLow = vdupq_n_u32(0), sumHigh = vdupq_n_u32(0);
+            uint32x4_t squaredSumLow = vdupq_n_u32(0), squaredSumHigh = vdupq_n_u32(0);
+
+            for (int i = 0; i < count; i++) {
+                const uint8x8_t pixels = vld1_u8(pointPixels[i] + x);
+                const uint16x8_t products = vmull_u8(pixels, vdup_n_u8(values[i]));
+                const uint16x8_t squares = vmull_u8(pixels, pixels);
+                const uint16x8_t widened = vmovl_u8(pixels);
+
+                correlationLow = vaddw_u16(correlationLow, vget_low_u16(products));
+                correlationHigh = vaddw_u16(correlationHigh, vget_high_u16(products));
+                sumLow = vaddw_u16(sumLow, vget_low_u16(widened));
+                sumHigh = vaddw_u16(sumHigh, vget_high_u16(widened));
+                squaredSumLow = vaddw_u16(squaredSumLow, vget_low_u16(squares));
+                squaredSumHigh = vaddw_u16(squaredSumHigh, vget_high_u16(squares));
+            }
+
+            uint32_t correlations[8], sums[8], squaredSums[8];
+            vst1q_u32(correlations, correlationLow);
+            vst1q_u32(correlations + 4, correlationHigh);
+            vst1q_u32(sums, sumLow);
+            vst1q_u32(sums + 4, sumHigh);
+            vst1q_u32(squaredSums, squaredSumLow);
+            vst1q_u32(squaredSums + 4, squaredSumHigh);
+            for (int i = 0; i < 8; i++) {
+                resultRow[x + i] = statistics.getNormedValue(correlations[i], sums[i], squaredSums[i]);
+            }
+        }
+#endif
+
+        for (; x < resultCols; x++) {
+            uint32_t correlation = 0, sum = 0, squaredSum = 0;
+            for (int i = 0; i < count; i++) {
+                const uint32_t pixel = pointPixels[i][x];
+                correlation += pixel * values[i];
+                sum += pixel;
+                squaredSum += pixel * pixel;
+            }
+            resultRow[x] = statistics.getNormedValue(correlation, sum, squaredSum);
+        }
+    }
+}
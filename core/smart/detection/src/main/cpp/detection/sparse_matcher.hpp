@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SPARSE_MATCHER_HPP
+#define KLICK_R_SPARSE_MATCHER_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "sparse_template.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Template matching with the TM_CCOEFF_NORMED semantics, on the informative pixels of a template only.
+     *
+     * The correlation, the sum and the squared sum of the screen values are computed on the pixels of the
+     * [SparseTemplate] only, in integers, each template pixel being read for 8 consecutive positions at once with
+     * NEON. The results are the normalized correlation of those pixels: they rank the positions, but they are not the
+     * dense confidences, and the best positions must be verified with a dense matching.
+     */
+    class SparseMatcher {
+
+    private:
+        /** The screen pixels of each template pixel, for the first position of the result row being computed. */
+        std::vector<const uint8_t*> pointPixels;
+
+    public:
+        /**
+         * Match the sparse template in the image.
+         *
+         * @param image the image to search in, in 8 bits gray.
+         * @param templ the informative pixels of the template to search, not empty.
+         * @param results the matching results, already allocated to the cv::matchTemplate results size.
+         */
+        void match(const cv::Mat& image, const SparseTemplate& templ, cv::Mat& results);
+    };
+}
+
+#endif //KLICK_R_SPARSE_MATCHER_HPP
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <utility>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "sparse_template.hpp"
+
+using namespace smartautoclicker;
+
+
+void SparseTemplate::compute(const cv::Mat& templ) {
+    size = templ.size();
+    points.clear();
+    values.clear();
+
+    const int area = size.area();
+    if (area < MIN_TEMPLATE_AREA) return;
+    const int count = std::clamp(area / AREA_PER_POINT, MIN_POINTS, MAX_POINTS);
+
+    cv::Mat gradientX, gradientY;
+    cv::Sobel(templ, gradientX, CV_16S, 1, 0);
+    cv::Sobel(templ, gradientY, CV_16S, 0, 1);
+
+    // The gradient magnitude of each pixel, with its index in the template
+    std::vector<std::pair<int, int>> magnitudes;
+    magnitudes.reserve(area);
+    for (int y = 0; y < templ.rows; y++) {
+        const auto* rowX = gradientX.ptr<int16_t>(y);
+        const auto* rowY = gradientY.ptr<int16_t>(y);
+        for (int x = 0; x < templ.cols; x++) {
+            magnitudes.emplace_back(std::abs(rowX[x]) + std::abs(rowY[x]), y * templ.cols + x);
+        }
+    }
+
+    // The highest magnitudes, the index breaking the ties so the selection is the same for the same template
+    std::nth_element(magnitudes.begin(), magnitudes.begin() + count, magnitudes.end(),
+                     [](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        return a.first > b.first || (a.first == b.first && a.second < b.second);
+    });
+    // In row order, the matching reads the screen rows one after the other
+    std::sort(magnitudes.begin(), magnitudes.begin() + count,
+              [](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.second < b.second; });
+
+    points.reserve(count);
+    values.reserve(count);
+    for (int i = 0; i < count; i++) {
+        const cv::Point point(magnitudes[i].second % templ.cols, magnitudes[i].second / templ.cols);
+        points.push_back(point);
+        values.push_back(templ.at<uint8_t>(point));
+    }
+
+    statistics.compute(cv::Mat(1, count, CV_8U, values.data()));
+    if (statistics.isFlat()) {
+        points.clear();
+        values.clear();
+    }
+}
+
+void SparseTemplate::computeMasked(const cv::Mat& templ, const cv::Mat& mask) {
+    size = templ.size();
+    points.clear();
+    values.clear();
+
+    const int maskedCount = cv::countNonZero(mask);
+    if (maskedCount == 0) return;
+
+    // The same step on both axes, the subsampled pixels are spread over the whole mask
+    int step = 1;
+    while (maskedCount / (step * step) > MAX_MASKED_POINTS) step++;
+
+    // In row order, the matching reads the screen rows one after the other
+    points.reserve(std::min(maskedCount, MAX_MASKED_POINTS));
+    values.reserve(points.capacity());
+    for (int y = 0; y < templ.rows; y += step) {
+        const auto* maskRow = mask.ptr<uint8_t>(y);
+        const auto* templRow = templ.ptr<uint8_t>(y);
+        for (int x = 0; x < templ.cols && (int) points.size() < MAX_MASKED_POINTS; x += step) {
+            if (maskRow[x] == 0) continue;
+            points.emplace_back(x, y);
+            values.push_back(templRow[x]);
+        }
+    }
+
+    if (values.empty()) return;
+    statistics.compute(cv::Mat(1, (int) values.size(), CV_8U, values.data()));
+    if (statistics.isFlat()) {
+        points.clear();
+        values.clear();
+    }
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SPARSE_TEMPLATE_HPP
+#define KLICK_R_SPARSE_TEMPLATE_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "template_statistics.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The informative pixels of a gray template, for the sparse matching.
+     *
+     * Most conditions are a small distinctive shape on a flat background, and their flat pixels barely change the
+     * correlation. Only the pixels with the highest gradients are kept, and correlated with the screen by the
+     * [SparseMatcher], reducing the cost of each position by an order of magnitude on the big templates.
+     *
+     * A masked template keeps the pixels of its mask instead, the others are not part of the condition. Their
+     * correlation is the masked confidence of the template, not only a ranking of the positions.
+     */
+    class SparseTemplate {
+
+    private:
+        /** Minimum template area. Below, the dense matchers are fast enough. */
+        static constexpr int MIN_TEMPLATE_AREA = 48 * 48;
+        /** Number of template pixels for each kept one. */
+        static constexpr int AREA_PER_POINT = 16;
+        /** Bounds of the number of kept pixels. The upper one keeps the correlations in 32 bits. */
+        static constexpr int MIN_POINTS = 128;
+        static constexpr int MAX_POINTS = 1024;
+        /**
+         * Maximum number of kept pixels of a mask. Above, the mask is subsampled on a regular grid. Also keeps the
+         * correlations in 32 bits.
+         */
+        static constexpr int MAX_MASKED_POINTS = 16384;
+
+        /** The size of the complete template. */
+        cv::Size size = cv::Size(0, 0);
+        /** The positions of the kept pixels in the template, in row order. */
+        std::vector<cv::Point> points;
+        /** The gray values of the kept pixels. */
+        std::vector<uint8_t> values;
+        /** The statistics of [values], for the normalization. */
+        TemplateStatistics statistics = TemplateStatistics();
+
+    public:
+        /**
+         * Select the informative pixels of a template.
+         * Nothing is kept if the template is too small or if the kept pixels have no variance.
+         *
+         * @param templ the template, in 8 bits gray.
+         */
+        void compute(const cv::Mat& templ);
+
+        /**
+         * Keep the pixels of a template in its mask, whatever its size.
+         * Nothing is kept if the mask is empty or if the kept pixels have no variance.
+         *
+         * @param templ the template, in 8 bits gray.
+         * @param mask the pixels of the template to keep, in 8 bits of the template size. Non zero pixels are kept.
+         */
+        void computeMasked(const cv::Mat& templ, const cv::Mat& mask);
+
+        /** @return true if no pixel is kept, the template must be matched densely. */
+        bool isEmpty() const { return points.empty(); }
+
+        const cv::Size& getSize() const { return size; }
+        const std::vector<cv::Point>& getPoints() const { return points; }
+        const std::vector<uint8_t>& getValues() const { return values; }
+        const TemplateStatistics& getStatistics() const { return statistics; }
+    };
+}
+
+#endif //KLICK_R_SPARSE_TEMPLATE_HPP
@@ -0,0 +1,786 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "template_cache.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+static constexpr uint64_t HASH_OFFSET_BASIS = 0xcbf29ce484222325ULL;
+static constexpr uint64_t HASH_PRIME = 0x100000001b3ULL;
+
+/** @return the hash updated with the bytes of a value. */
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t length) {
+    const auto* bytes = static_cast<const uint8_t*>(data);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes + i, sizeof(word));
+        hash = (hash ^ word) * HASH_PRIME;
+    }
+    for (; i < length; i++) {
+        hash = (hash ^ bytes[i]) * HASH_PRIME;
+    }
+
+    return hash;
+}
+
+void ConditionTemplate::processPixels(uint8_t* pixels, int width, int height, size_t rowStride, double scaleRatio) {
+    image.processPixels(pixels, width, height, rowStride, scaleRatio);
+    computeDerivedValues();
+}
+
+void ConditionTemplate::processPixels(const PixelsBuffer& pixels, double scaleRatio) {
+    processPixels(pixels.pixels, pixels.width, pixels.height, pixels.rowStride, scaleRatio);
+}
+
+cv::Mat ConditionTemplate::getSpectrum(const cv::Size& transformSize) const {
+    std::lock_guard<std::mutex> lock(spectrumMutex);
+
+    // The detection area is usually the same between two frames, and so is the transform size
+    if (spectrumSize != transformSize) {
+        // A new matrix, the previous spectrum might still be used by another thread
+        spectrum = cv::Mat();
+        FftMatcher::computeTemplateSpectrum(*image.scaledGray, transformSize, spectrum);
+        spectrumSize = transformSize;
+    }
+
+    return spectrum;
+}
+
+const TemplateFeatures& ConditionTemplate::getFeatures() const {
+    std::lock_guard<std::mutex> lock(featuresMutex);
+
+    if (features == nullptr) {
+        features = std::make_unique<TemplateFeatures>();
+        features->compute(*image.scaledGray);
+    }
+
+    return *features;
+}
+
+void ConditionTemplate::processPrecomputed(const cv::Size& fullSize, const cv::Mat& precomputedScaledGray,
+                                           const cv::Scalar& precomputedColorMeans,
+                                           const ColorHistogram& precomputedColorHistogram) {
+    image.fullSizeColor->release();
+    image.fullSizeRoi = cv::Rect(0, 0, fullSize.width, fullSize.height);
+    *image.scaledGray = precomputedScaledGray;
+    image.scaledSize = precomputedScaledGray.size();
+    image.scaledRoi = cv::Rect(0, 0, precomputedScaledGray.cols, precomputedScaledGray.rows);
+
+    colorMeans = precomputedColorMeans;
+    colorHistogram = precomputedColorHistogram;
+    exactPixelsHash = PixelsHash();
+    exactTiles = TemplateTiles();
+    fullSizeMask.release();
+    maskedGray = SparseTemplate();
+    computeScaledDerivedValues();
+}
+
+/** Compress the bytes of a CV_8UC1 image. */
+static void compressImage(BlockCompressor& compressor, const cv::Mat& image, std::vector<uint8_t>& compressed) {
+    const cv::Mat continuous = image.isContinuous() ? image : image.clone();
+    compressor.compress(continuous.data, continuous.total(), compressed);
+    compressed.shrink_to_fit();
+}
+
+/** Decompress the bytes of a CV_8UC1 image of a given size. @return false if they are invalid. */
+static bool decompressImage(const std::vector<uint8_t>& compressed, const cv::Size& size, cv::Mat& image) {
+    image.create(size, CV_8UC1);
+    return BlockCompressor::decompress(compressed.data(), compressed.size(), image.data, image.total());
+}
+
+size_t CompactTemplate::getMemorySize() const {
+    return compressedScaledGray.capacity() + compressedFullSizeMask.capacity()
+            + maskedGray.getPoints().capacity() * sizeof(cv::Point) + maskedGray.getValues().capacity()
+            + exactTiles.tiles.capacity() * sizeof(TemplateTiles::Tile);
+}
+
+void ConditionTemplate::compact(BlockCompressor& compressor, CompactTemplate& compact) const {
+    compact.fullSize = image.fullSizeRoi.size();
+    compact.scaledSize = image.scaledGray->size();
+    compressImage(compressor, *image.scaledGray, compact.compressedScaledGray);
+    compact.compressedFullSizeMask.clear();
+    if (!fullSizeMask.empty()) compressImage(compressor, fullSizeMask, compact.compressedFullSizeMask);
+
+    compact.colorMeans = colorMeans;
+    compact.colorHistogram = colorHistogram;
+    compact.maskedGray = maskedGray;
+    compact.exactPixelsHash = exactPixelsHash;
+    compact.exactTiles = exactTiles;
+}
+
+bool ConditionTemplate::restore(const CompactTemplate& compact) {
+    cv::Mat scaledGray;
+    if (!decompressImage(compact.compressedScaledGray, compact.scaledSize, scaledGray)) return false;
+    fullSizeMask.release();
+    if (!compact.compressedFullSizeMask.empty()
+            && !decompressImage(compact.compressedFullSizeMask, compact.fullSize, fullSizeMask)) {
+        return false;
+    }
+
+    image.fullSizeColor->release();
+    image.fullSizeRoi = cv::Rect(0, 0, compact.fullSize.width, compact.fullSize.height);
+    *image.scaledGray = scaledGray;
+    image.scaledSize = scaledGray.size();
+    image.scaledRoi = cv::Rect(0, 0, scaledGray.cols, scaledGray.rows);
+
+    colorMeans = compact.colorMeans;
+    colorHistogram = compact.colorHistogram;
+    maskedGray = compact.maskedGray;
+    exactPixelsHash = compact.exactPixelsHash;
+    exactTiles = compact.exactTiles;
+    computeScaledDerivedValues();
+    return true;
+}
+
+const ConditionTemplate* ConditionTemplate::getScaleVariant(double templateScale) const {
+    if (templateScale == 1.0) return this;
+
+    std::lock_guard<std::mutex> lock(scaleVariantsMutex);
+    for (const auto& variant : scaleVariants) {
+        if (variant.first == templateScale) return variant.second.get();
+    }
+
+    // Resized once from the scaled gray image, the color means and histogram are the same at all scales
+    const cv::Mat& scaledGray = *image.scaledGray;
+    const cv::Size variantSize(cvRound(scaledGray.cols * templateScale), cvRound(scaledGray.rows * templateScale));
+    std::unique_ptr<ConditionTemplate> variant;
+    if (variantSize.width >= SCALE_VARIANT_MIN_SIZE && variantSize.height >= SCALE_VARIANT_MIN_SIZE) {
+        cv::Mat variantGray;
+        cv::resize(scaledGray, variantGray, variantSize, 0, 0, templateScale < 1 ? cv::INTER_AREA : cv::INTER_LINEAR);
+
+        variant = std::make_unique<ConditionTemplate>();
+        variant->processPrecomputed(
+                cv::Size(cvRound(image.fullSizeRoi.width * templateScale), cvRound(image.fullSizeRoi.height * templateScale)),
+                variantGray,
+                colorMeans,
+                colorHistogram);
+    }
+
+    scaleVariants.emplace_back(templateScale, std::move(variant));
+    return scaleVariants.back().second.get();
+}
+
+/**
+ * Rotate an image counterclockwise around its center, into the bounding box of the rotated image. The pixels of the
+ * bounding box outside of the rotated image are 0.
+ */
+static void rotateImage(const cv::Mat& image, int angle, int interpolation, cv::Mat& rotated) {
+    // Exact for the right angles, without any interpolation nor corners
+    if (angle % 90 == 0) {
+        const int rotateCode = angle == 90
+                ? cv::ROTATE_90_COUNTERCLOCKWISE
+                : angle == 180 ? cv::ROTATE_180 : cv::ROTATE_90_CLOCKWISE;
+        cv::rotate(image, rotated, rotateCode);
+        return;
+    }
+
+    const cv::Point2f center(image.cols / 2.0f, image.rows / 2.0f);
+    const cv::Rect2f bounds = cv::RotatedRect(center, image.size(), (float) -angle).boundingRect2f();
+    cv::Mat transform = cv::getRotationMatrix2D(center, angle, 1.0);
+    transform.at<double>(0, 2) += bounds.width / 2.0 - center.x;
+    transform.at<double>(1, 2) += bounds.height / 2.0 - center.y;
+
+    cv::warpAffine(image, rotated, transform, cv::Size(cvRound(bounds.width), cvRound(bounds.height)),
+                   interpolation, cv::BORDER_CONSTANT, cv::Scalar(0));
+}
+
+const ConditionTemplate* ConditionTemplate::getRotationVariant(int angle) const {
+    angle = (angle % 360 + 360) % 360;
+    if (angle == 0) return this;
+
+    std::lock_guard<std::mutex> lock(rotationVariantsMutex);
+    for (const auto& variant : rotationVariants) {
+        if (variant.first == angle) return variant.second.get();
+    }
+
+    // Rotated once from the scaled gray image, the colors of the opaque pixels are the same at all angles
+    const cv::Mat opaqueMask = fullSizeMask.empty()
+            ? cv::Mat(image.fullSizeRoi.size(), CV_8U, cv::Scalar(255))
+            : fullSizeMask;
+    cv::Mat variantGray, variantMask;
+    rotateImage(*image.scaledGray, angle, cv::INTER_LINEAR, variantGray);
+    rotateImage(opaqueMask, angle, cv::INTER_NEAREST, variantMask);
+
+    std::unique_ptr<ConditionTemplate> variant;
+    if (variantGray.cols >= SCALE_VARIANT_MIN_SIZE && variantGray.rows >= SCALE_VARIANT_MIN_SIZE) {
+        variant = std::make_unique<ConditionTemplate>();
+        variant->processPrecomputed(variantMask.size(), variantGray, colorMeans, colorHistogram);
+
+        if (cv::countNonZero(variantMask) != (int) variantMask.total()) {
+            // The same as computeMask, the scaled pixels blending a corner would not be found on the screen
+            cv::Mat scaledMask;
+            cv::resize(variantMask, scaledMask, variantGray.size(), 0, 0, cv::INTER_AREA);
+            cv::compare(scaledMask, 255, scaledMask, cv::CMP_EQ);
+            variant->maskedGray.computeMasked(variantGray, scaledMask);
+            variant->fullSizeMask = variantMask;
+
+            // Matched as a whole, its corners would be correlated with the screen content
+            if (variant->maskedGray.isEmpty()) variant.reset();
+        }
+    }
+
+    rotationVariants.emplace_back(angle, std::move(variant));
+    return rotationVariants.back().second.get();
+}
+
+void ConditionTemplate::computeCoarseScaledGray() {
+    coarseScaledGray.release();
+    coarseFactor = 0;
+    if (image.scaledGray->empty()) return;
+
+    cv::Scalar mean, deviation;
+    cv::meanStdDev(*image.scaledGray, mean, deviation);
+    const double scaledDeviation = deviation[0];
+
+    // From the cheapest level, the first one keeping enough pixels and details
+    for (int factor = PYRAMID_MAX_DOWNSCALE_FACTOR; factor >= PYRAMID_MIN_DOWNSCALE_FACTOR; factor /= 2) {
+        const cv::Size coarseSize(image.scaledSize.width / factor, image.scaledSize.height / factor);
+        if (coarseSize.width < PYRAMID_MIN_COARSE_SIZE || coarseSize.height < PYRAMID_MIN_COARSE_SIZE) continue;
+
+        cv::resize(*image.scaledGray, coarseScaledGray, coarseSize, 0, 0, cv::INTER_AREA);
+        cv::meanStdDev(coarseScaledGray, mean, deviation);
+        if (deviation[0] >= scaledDeviation * PYRAMID_MIN_DEVIATION_RATIO) {
+            coarseFactor = factor;
+            return;
+        }
+    }
+
+    coarseScaledGray.release();
+}
+
+size_t ConditionTemplate::getMemorySize() const {
+    size_t size = getMatMemorySize(*image.scaledGray) + getMatMemorySize(coarseScaledGray)
+            + sparseGray.getPoints().capacity() * sizeof(cv::Point) + sparseGray.getValues().capacity()
+            + binaryGray.getMemorySize() + chamferGray.getMemorySize()
+            + getMatMemorySize(fullSizeMask)
+            + maskedGray.getPoints().capacity() * sizeof(cv::Point) + maskedGray.getValues().capacity();
+    {
+        std::lock_guard<std::mutex> lock(spectrumMutex);
+        size += getMatMemorySize(spectrum);
+    }
+    {
+        std::lock_guard<std::mutex> lock(featuresMutex);
+        if (features != nullptr) size += features->getMemorySize();
+    }
+    {
+        std::lock_guard<std::mutex> lock(scaleVariantsMutex);
+        for (const auto& variant : scaleVariants) {
+            if (variant.second != nullptr) size += variant.second->getMemorySize();
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(rotationVariantsMutex);
+        for (const auto& variant : rotationVariants) {
+            if (variant.second != nullptr) size += variant.second->getMemorySize();
+        }
+    }
+
+    return size;
+}
+
+void ConditionTemplate::computeDerivedValues() {
+    computeMask();
+    if (isMasked()) {
+        // The transparent pixels are not part of the condition, nor of its candidates
+        colorMeans = cv::mean(*image.fullSizeColor, fullSizeMask);
+        colorHistogram.compute(*image.fullSizeColor, fullSizeMask);
+    } else {
+        colorMeans = cv::mean(*image.fullSizeColor);
+        colorHistogram.compute(*image.fullSizeColor);
+    }
+    exactPixelsHash.compute(*image.fullSizeColor);
+    exactTiles.compute(*image.fullSizeColor);
+    computeScaledDerivedValues();
+
+    // The candidates colors are compared with the values computed from it, it is not needed anymore
+    image.fullSizeColor->release();
+}
+
+void ConditionTemplate::computeMask() {
+    fullSizeMask.release();
+    maskedGray = SparseTemplate();
+
+    cv::Mat alpha;
+    cv::extractChannel(*image.fullSizeColor, alpha, 3);
+    cv::compare(alpha, 255, fullSizeMask, cv::CMP_EQ);
+    if (cv::countNonZero(fullSizeMask) == (int) fullSizeMask.total()) {
+        fullSizeMask.release();
+        return;
+    }
+
+    // The scaled pixels blending a transparent one would not be found on the screen
+    cv::Mat scaledMask;
+    cv::resize(fullSizeMask, scaledMask, image.scaledSize, 0, 0, cv::INTER_AREA);
+    cv::compare(scaledMask, 255, scaledMask, cv::CMP_EQ);
+    maskedGray.computeMasked(*image.scaledGray, scaledMask);
+
+    // Too few or too flat opaque pixels to be matched alone, the condition is matched as a whole
+    if (maskedGray.isEmpty()) fullSizeMask.release();
+}
+
+void ConditionTemplate::computeScaledDerivedValues() {
+    {
+        std::lock_guard<std::mutex> lock(spectrumMutex);
+        spectrum.release();
+        spectrumSize = cv::Size(0, 0);
+    }
+    {
+        std::lock_guard<std::mutex> lock(featuresMutex);
+        features.reset();
+    }
+    {
+        std::lock_guard<std::mutex> lock(scaleVariantsMutex);
+        scaleVariants.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(rotationVariantsMutex);
+        rotationVariants.clear();
+    }
+
+    computeCoarseScaledGray();
+    grayStatistics.compute(*image.scaledGray);
+    sparseGray.compute(*image.scaledGray);
+    binaryGray.compute(*image.scaledGray);
+    chamferGray.compute(*image.scaledGray);
+    contentHash = computeContentHash();
+}
+
+uint64_t ConditionTemplate::hashPixels(const PixelsBuffer& pixels) {
+    uint64_t hash = HASH_OFFSET_BASIS;
+    hash = (hash ^ (uint64_t) pixels.width) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) pixels.height) * HASH_PRIME;
+    for (int y = 0; y < pixels.height; y++) {
+        hash = hashBytes(hash, pixels.pixels + y * pixels.rowStride, (size_t) pixels.width * 4);
+    }
+
+    return hash;
+}
+
+uint64_t ConditionTemplate::computeContentHash() const {
+    uint64_t hash = HASH_OFFSET_BASIS;
+    hash = (hash ^ (uint64_t) image.fullSizeRoi.width) * HASH_PRIME;
+    hash = (hash ^ (uint64_t) image.fullSizeRoi.height) * HASH_PRIME;
+
+    // The full size color image is not available for the packed templates, the color is compared with its values
+    const cv::Mat& scaledGray = *image.scaledGray;
+    for (int y = 0; y < scaledGray.rows; y++) {
+        hash = hashBytes(hash, scaledGray.ptr<uint8_t>(y), (size_t) scaledGray.cols * scaledGray.elemSize());
+    }
+    hash = hashBytes(hash, colorMeans.val, sizeof(colorMeans.val));
+    hash = hashBytes(hash, colorHistogram.bins.data(), colorHistogram.bins.size() * sizeof(float));
+    for (int y = 0; y < fullSizeMask.rows; y++) {
+        hash = hashBytes(hash, fullSizeMask.ptr<uint8_t>(y), (size_t) fullSizeMask.cols);
+    }
+
+    return hash;
+}
+
+void TemplateCache::setScaleRatio(double scaleRatio) {
+    if (scaleRatio == cachedScaleRatio) return;
+
+    // Keep the current templates as the most recent ones, and restore the ones of the new ratio
+    TemplateMap ratioTemplates;
+    auto previous = std::find_if(previousTemplates.begin(), previousTemplates.end(),
+                                 [scaleRatio](const auto& ratio) { return ratio.first == scaleRatio; });
+    if (previous != previousTemplates.end()) {
+        ratioTemplates = std::move(previous->second);
+        previousTemplates.erase(previous);
+    }
+
+    // Only kept for the current ratio, the idle templates of the new one are compacted once processed
+    statistics.onEvicted((int64_t) idleTemplates.size());
+    idleTemplates.clear();
+    if (cachedScaleRatio > 0 && !templates.empty()) {
+        previousTemplates.emplace(previousTemplates.begin(), cachedScaleRatio, std::move(templates));
+        if (previousTemplates.size() > MAX_PREVIOUS_SCALE_RATIOS) {
+            statistics.onEvicted((int64_t) previousTemplates.back().second.size());
+            previousTemplates.pop_back();
+        }
+    }
+
+    LOGD(LOG_TAG, "Scale ratio changed to %1$f, %2$d templates restored", scaleRatio, (int) ratioTemplates.size());
+    templates = std::move(ratioTemplates);
+    cachedScaleRatio = scaleRatio;
+}
+
+const ConditionTemplate* TemplateCache::get(int64_t conditionId, const PixelsBuffer* conditionPixels,
+                                           double scaleRatio) {
+
+    setScaleRatio(scaleRatio);
+
+    auto cached = templates.find(conditionId);
+    if (cached != templates.end()) {
+        cached->second.lastUseTick = useTick;
+        statistics.onHit();
+        return cached->second.conditionTemplate.get();
+    }
+
+    statistics.onMiss();
+    if (const ConditionTemplate* restored = restoreIdle(conditionId)) {
+        LOGD(LOG_TAG, "Idle template restored for the detection of condition %1$lld", (long long) conditionId);
+        return restored;
+    }
+
+    auto conditionTemplate = std::make_unique<ConditionTemplate>();
+    if (isPacked(conditionId, scaleRatio) && pack.load(conditionId, *conditionTemplate)) {
+        return put(conditionId, std::move(conditionTemplate));
+    }
+
+    if (conditionPixels == nullptr || !conditionPixels->isValid()) {
+        LOGE_LIMITED(LOG_TAG, "Condition %1$lld is not in the template pack and has no pixels",
+                     (long long) conditionId);
+        return nullptr;
+    }
+
+    SharedTemplateStore& store = SharedTemplateStore::getInstance();
+    const uint64_t pixelsHash = ConditionTemplate::hashPixels(*conditionPixels);
+    if (auto shared = store.borrow(pixelsHash, scaleRatio)) {
+        LOGD(LOG_TAG, "Template borrowed for condition %1$lld", (long long) conditionId);
+        return put(conditionId, std::move(shared));
+    }
+    conditionTemplate->processPixels(*conditionPixels, scaleRatio);
+
+    LOGD(LOG_TAG, "Template processed for condition %1$lld", (long long) conditionId);
+    return put(conditionId, store.share(pixelsHash, scaleRatio, std::move(conditionTemplate)));
+}
+
+const ConditionTemplate* TemplateCache::put(int64_t conditionId,
+                                            std::shared_ptr<const ConditionTemplate> conditionTemplate) {
+    CachedTemplate& cached = templates[conditionId];
+    cached.conditionTemplate = std::move(conditionTemplate);
+    cached.lastUseTick = useTick;
+
+    return cached.conditionTemplate.get();
+}
+
+bool TemplateCache::isPacked(int64_t conditionId, double scaleRatio) const {
+    return pack.isForScaleRatio(scaleRatio) && pack.contains(conditionId)
+        && unpackedConditionIds.find(conditionId) == unpackedConditionIds.end();
+}
+
+const ConditionTemplate* TemplateCache::restoreIdle(int64_t conditionId) {
+    auto idle = idleTemplates.find(conditionId);
+    if (idle == idleTemplates.end()) return nullptr;
+
+    auto conditionTemplate = std::make_unique<ConditionTemplate>();
+    const bool isRestored = conditionTemplate->restore(idle->second);
+    idleTemplates.erase(idle);
+    if (!isRestored) {
+        LOGE(LOG_TAG, "Invalid idle template for condition %1$lld", (long long) conditionId);
+        return nullptr;
+    }
+
+    return put(conditionId, std::move(conditionTemplate));
+}
+
+void TemplateCache::compactIdleTemplates(ThreadPool* threadPool) {
+    pendingIdleTemplates.clear();
+    for (const auto& cached : templates) {
+        if (idleConditionIds.find(cached.first) == idleConditionIds.end()) continue;
+        pendingIdleTemplates.emplace_back(cached.first, cached.second.conditionTemplate);
+    }
+    if (pendingIdleTemplates.empty()) return;
+
+    const int compactCount = (int) pendingIdleTemplates.size();
+    std::vector<CompactTemplate> compacts((size_t) compactCount);
+    compressors.resize(threadPool != nullptr ? threadPool->getWorkerCount() : 1);
+    const auto compactTask = [&](int taskIndex, int workerIndex) {
+        pendingIdleTemplates[taskIndex].second->compact(compressors[workerIndex], compacts[taskIndex]);
+    };
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(compactCount, compactTask);
+    } else {
+        for (int i = 0; i < compactCount; i++) compactTask(i, 0);
+    }
+
+    // The templates shared with the other caches are only released once none of them use it anymore
+    size_t compactSize = 0;
+    for (int i = 0; i < compactCount; i++) {
+        const int64_t conditionId = pendingIdleTemplates[i].first;
+        templates.erase(conditionId);
+        compactSize += compacts[i].getMemorySize();
+        idleTemplates[conditionId] = std::move(compacts[i]);
+    }
+    pendingIdleTemplates.clear();
+
+    LOGD(LOG_TAG, "%1$d idle templates compacted, %2$zu bytes", compactCount, compactSize);
+}
+
+void TemplateCache::setIdleConditions(const std::vector<int64_t>& conditionIds, ThreadPool* threadPool) {
+    idleConditionIds.clear();
+    idleConditionIds.insert(conditionIds.begin(), conditionIds.end());
+
+    // Restored before their events are enabled, their first detection is not slowed down by it
+    std::vector<int64_t> restoredIds;
+    for (const auto& idle : idleTemplates) {
+        if (idleConditionIds.find(idle.first) == idleConditionIds.end()) restoredIds.push_back(idle.first);
+    }
+    const int restoreCount = (int) restoredIds.size();
+    std::vector<std::unique_ptr<ConditionTemplate>> restored((size_t) restoreCount);
+    const auto restoreTask = [&](int taskIndex, int) {
+        restored[taskIndex] = std::make_unique<ConditionTemplate>();
+        if (!restored[taskIndex]->restore(idleTemplates.find(restoredIds[taskIndex])->second)) {
+            restored[taskIndex].reset();
+        }
+    };
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(restoreCount, restoreTask);
+    } else {
+        for (int i = 0; i < restoreCount; i++) restoreTask(i, 0);
+    }
+
+    for (int i = 0; i < restoreCount; i++) {
+        idleTemplates.erase(restoredIds[i]);
+        if (restored[i] != nullptr) {
+            put(restoredIds[i], std::move(restored[i]));
+        } else {
+            LOGE(LOG_TAG, "Invalid idle template for condition %1$lld", (long long) restoredIds[i]);
+        }
+    }
+    if (restoreCount > 0) LOGD(LOG_TAG, "%1$d idle templates restored", restoreCount);
+
+    compactIdleTemplates(threadPool);
+}
+
+int TemplateCache::prepare(const std::vector<int64_t>& conditionIds,
+                           const std::vector<const PixelsBuffer*>& conditionPixels, double scaleRatio,
+                           ThreadPool* threadPool) {
+    setScaleRatio(scaleRatio);
+
+    // The pixels of the pending templates are kept with them, they are valid for the whole call
+    pendingTemplates.clear();
+    pendingPixels.clear();
+    pendingHashes.clear();
+    pendingDuplicates.clear();
+    SharedTemplateStore& store = SharedTemplateStore::getInstance();
+    size_t cachedSize = 0;
+    for (const auto& cached : templates) cachedSize += cached.second.conditionTemplate->getMemorySize();
+    const bool isOverBudget = memoryBudget > 0 && cachedSize >= memoryBudget;
+
+    int readyCount = 0;
+    for (size_t i = 0; i < conditionIds.size(); i++) {
+        const int64_t conditionId = conditionIds[i];
+        auto cached = templates.find(conditionId);
+        if (cached != templates.end()) {
+            cached->second.lastUseTick = useTick;
+            statistics.onHit();
+            readyCount++;
+            continue;
+        }
+        if (idleTemplates.find(conditionId) != idleTemplates.end()) {
+            statistics.onHit();
+            readyCount++;
+            continue;
+        }
+
+        statistics.onMiss();
+        auto conditionTemplate = std::make_unique<ConditionTemplate>();
+        if (isPacked(conditionId, scaleRatio) && pack.load(conditionId, *conditionTemplate)) {
+            put(conditionId, std::move(conditionTemplate));
+            readyCount++;
+            continue;
+        }
+
+        const PixelsBuffer* pixels = i < conditionPixels.size() ? conditionPixels[i] : nullptr;
+        if (isOverBudget || pixels == nullptr || !pixels->isValid()) continue;
+
+        const uint64_t pixelsHash = ConditionTemplate::hashPixels(*pixels);
+        if (auto shared = store.borrow(pixelsHash, scaleRatio)) {
+            put(conditionId, std::move(shared));
+            readyCount++;
+            continue;
+        }
+
+        // The conditions with the same bitmap are processed once, and all use the same template
+        auto pendingHash = std::find(pendingHashes.begin(), pendingHashes.end(), pixelsHash);
+        if (pendingHash != pendingHashes.end()) {
+            pendingDuplicates.emplace_back(conditionId, (size_t) (pendingHash - pendingHashes.begin()));
+            continue;
+        }
+
+        pendingTemplates.emplace_back(conditionId, std::move(conditionTemplate));
+        pendingPixels.push_back(pixels);
+        pendingHashes.push_back(pixelsHash);
+    }
+
+    const int pendingCount = (int) pendingTemplates.size();
+    if (threadPool != nullptr) {
+        threadPool->parallelFor(pendingCount, [&](int taskIndex, int) {
+            pendingTemplates[taskIndex].second->processPixels(*pendingPixels[taskIndex], scaleRatio);
+        });
+    } else {
+        for (int i = 0; i < pendingCount; i++) pendingTemplates[i].second->processPixels(*pendingPixels[i], scaleRatio);
+    }
+
+    for (int i = 0; i < pendingCount; i++) {
+        auto& pending = pendingTemplates[i];
+        put(pending.first, store.share(pendingHashes[i], scaleRatio, std::move(pending.second)));
+    }
+    for (const auto& duplicate : pendingDuplicates) {
+        put(duplicate.first, templates[pendingTemplates[duplicate.second].first].conditionTemplate);
+    }
+    const int duplicateCount = (int) pendingDuplicates.size();
+    pendingTemplates.clear();
+    pendingPixels.clear();
+    pendingHashes.clear();
+    pendingDuplicates.clear();
+    compactIdleTemplates(threadPool);
+
+    if (isOverBudget) LOGD(LOG_TAG, "Templates memory budget reached, the next ones are processed when detected");
+    LOGD(LOG_TAG, "%1$d templates prepared, %2$d duplicates", pendingCount, duplicateCount);
+    return readyCount + pendingCount + duplicateCount;
+}
+
+bool TemplateCache::openPack(const std::string& path) {
+    // Templates loaded from the previous pack are headers on its mapping
+    clear();
+    unpackedConditionIds.clear();
+    return pack.open(path);
+}
+
+bool TemplateCache::writePack(const std::string& path) const {
+    if (templates.empty() || cachedScaleRatio <= 0) return false;
+
+    std::vector<std::pair<int64_t, const ConditionTemplate*>> packTemplates;
+    packTemplates.reserve(templates.size());
+    for (const auto& cached : templates) {
+        // A packed template has no full size color image to restore its mask from, it is processed again
+        if (cached.second.conditionTemplate->isMasked()) continue;
+        packTemplates.emplace_back(cached.first, cached.second.conditionTemplate.get());
+    }
+
+    return TemplatePack::write(path, cachedScaleRatio, packTemplates);
+}
+
+std::vector<int64_t> TemplateCache::getPackedConditionIds(double scaleRatio) const {
+    if (!pack.isForScaleRatio(scaleRatio)) return {};
+
+    std::vector<int64_t> conditionIds = pack.getConditionIds();
+    if (unpackedConditionIds.empty()) return conditionIds;
+
+    conditionIds.erase(std::remove_if(conditionIds.begin(), conditionIds.end(), [this](int64_t conditionId) {
+        return unpackedConditionIds.find(conditionId) != unpackedConditionIds.end();
+    }), conditionIds.end());
+    return conditionIds;
+}
+
+bool TemplateCache::contains(int64_t conditionId, double scaleRatio) const {
+    if (scaleRatio == cachedScaleRatio) {
+        return templates.find(conditionId) != templates.end() || idleTemplates.find(conditionId) != idleTemplates.end();
+    }
+    for (const auto& previous : previousTemplates) {
+        if (previous.first == scaleRatio) return previous.second.find(conditionId) != previous.second.end();
+    }
+
+    return false;
+}
+
+const ConditionTemplate* TemplateCache::find(int64_t conditionId, double scaleRatio) const {
+    if (scaleRatio != cachedScaleRatio) return nullptr;
+
+    auto cached = templates.find(conditionId);
+    return cached != templates.end() ? cached->second.conditionTemplate.get() : nullptr;
+}
+
+bool TemplateCache::isPixelsNeeded(int64_t conditionId, double scaleRatio) const {
+    return !contains(conditionId, scaleRatio) && !isPacked(conditionId, scaleRatio);
+}
+
+size_t TemplateCache::getMemorySize() const {
+    size_t size = 0;
+    for (const auto& cached : templates) size += cached.second.conditionTemplate->getMemorySize();
+    for (const auto& idle : idleTemplates) size += idle.second.getMemorySize();
+    for (const auto& previous : previousTemplates) {
+        for (const auto& cached : previous.second) size += cached.second.conditionTemplate->getMemorySize();
+    }
+
+    return size;
+}
+
+void TemplateCache::setMemoryBudget(size_t budget) {
+    memoryBudget = budget;
+}
+
+void TemplateCache::trim() {
+    const uint64_t lastFrameTick = useTick++;
+
+    size_t size = getMemorySize();
+    if (size <= memoryBudget) return;
+
+    // The templates of the other scale ratios are only used again if the screen metrics go back to them
+    while (!previousTemplates.empty() && size > memoryBudget) {
+        for (const auto& cached : previousTemplates.back().second) {
+            size -= cached.second.conditionTemplate->getMemorySize();
+        }
+        statistics.onEvicted((int64_t) previousTemplates.back().second.size());
+        previousTemplates.pop_back();
+    }
+
+    // Then the least recently used ones, they will be processed again from their bitmap if detected again
+    std::vector<std::pair<uint64_t, int64_t>> evictables;
+    for (const auto& cached : templates) {
+        if (cached.second.lastUseTick < lastFrameTick) evictables.emplace_back(cached.second.lastUseTick, cached.first);
+    }
+    std::sort(evictables.begin(), evictables.end());
+
+    int evictedCount = 0;
+    for (const auto& evictable : evictables) {
+        if (size <= memoryBudget) break;
+
+        auto evicted = templates.find(evictable.second);
+        size -= evicted->second.conditionTemplate->getMemorySize();
+        templates.erase(evicted);
+        evictedCount++;
+    }
+    statistics.onEvicted(evictedCount);
+
+    LOGD(LOG_TAG, "Trimmed %1$d templates, %2$zu bytes used", evictedCount, size);
+}
+
+void TemplateCache::remove(const std::vector<int64_t>& conditionIds) {
+    size_t removedCount = 0;
+    for (int64_t conditionId : conditionIds) {
+        removedCount += templates.erase(conditionId);
+        removedCount += idleTemplates.erase(conditionId);
+        for (auto& previous : previousTemplates) removedCount += previous.second.erase(conditionId);
+        if (pack.contains(conditionId)) unpackedConditionIds.insert(conditionId);
+    }
+
+    LOGD(LOG_TAG, "%1$zu templates removed for %2$zu conditions", removedCount, conditionIds.size());
+}
+
+void TemplateCache::clear() {
+    templates.clear();
+    idleTemplates.clear();
+    previousTemplates.clear();
+    cachedScaleRatio = -1;
+}
+
+void TemplateCache::release() {
+    clear();
+    unpackedConditionIds.clear();
+    idleConditionIds.clear();
+    pack.close();
+}
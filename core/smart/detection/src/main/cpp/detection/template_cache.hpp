@@ -0,0 +1,449 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_TEMPLATE_CACHE_HPP
+#define KLICK_R_TEMPLATE_CACHE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <opencv2/core/types.hpp>
+
+#include "binary_template.hpp"
+#include "chamfer_template.hpp"
+#include "color_histogram.hpp"
+#include "detection_image.hpp"
+#include "exact_pixel_matcher.hpp"
+#include "feature_matcher.hpp"
+#include "fft_matcher.hpp"
+#include "shared_template_store.hpp"
+#include "sparse_template.hpp"
+#include "template_pack.hpp"
+#include "template_statistics.hpp"
+#include "tile_hash_index.hpp"
+#include "../types/cache_statistics.hpp"
+#include "../types/pixels_buffer.hpp"
+#include "../utils/block_compressor.hpp"
+#include "../utils/thread_pool.hpp"
+
+namespace smartautoclicker {
+
+    /** Smallest downscale factor between the scaled gray images and the coarse level of the pyramid matching. */
+    static constexpr int PYRAMID_MIN_DOWNSCALE_FACTOR = 2;
+    /** Biggest downscale factor between the scaled gray images and the coarse level of the pyramid matching. */
+    static constexpr int PYRAMID_MAX_DOWNSCALE_FACTOR = 8;
+    /** Minimum size of a coarse condition image. Below, there is not enough details and the pyramid is not used. */
+    static constexpr int PYRAMID_MIN_COARSE_SIZE = 8;
+    /**
+     * Minimum ratio between the standard deviations of a coarse condition image and of its scaled gray image. Below,
+     * the downscaling blurred away too much of its details to find its candidates.
+     */
+    static constexpr double PYRAMID_MIN_DEVIATION_RATIO = 0.6;
+    /** Minimum size of a scale variant of a condition image. Below, it can't be matched reliably. */
+    static constexpr int SCALE_VARIANT_MIN_SIZE = 4;
+
+    /**
+     * The values a [ConditionTemplate] of an idle condition is restored from, with its images compressed. The values
+     * derived from its scaled gray image are not kept, they are computed again by [ConditionTemplate::restore].
+     */
+    struct CompactTemplate {
+        /** The size of the full size condition image. */
+        cv::Size fullSize = cv::Size(0, 0);
+        /** The size of the scaled gray image. */
+        cv::Size scaledSize = cv::Size(0, 0);
+        /** The scaled gray image, compressed by a [BlockCompressor]. */
+        std::vector<uint8_t> compressedScaledGray;
+        /** The full size mask, compressed by a [BlockCompressor]. Empty if the condition is not masked. */
+        std::vector<uint8_t> compressedFullSizeMask;
+        cv::Scalar colorMeans = cv::Scalar();
+        ColorHistogram colorHistogram = ColorHistogram();
+        SparseTemplate maskedGray = SparseTemplate();
+        PixelsHash exactPixelsHash = PixelsHash();
+        TemplateTiles exactTiles = TemplateTiles();
+
+        /** @return the memory used by this compact template, in bytes. */
+        size_t getMemorySize() const;
+    };
+
+    /**
+     * A condition image, preprocessed once and kept ready for detection.
+     * Only the detection planes are kept: the full size color image is dropped once its color values are computed.
+     */
+    class ConditionTemplate {
+
+    public:
+        /** The condition image, at full size in color and scaled in gray. */
+        DetectionImage image = DetectionImage();
+        /** The mean of each color channel on the full size condition image. */
+        cv::Scalar colorMeans = cv::Scalar();
+        /** The histogram of the color channels on the full size condition image. */
+        ColorHistogram colorHistogram = ColorHistogram();
+        /**
+         * The scaled gray image downscaled by [coarseFactor], the biggest power of 2 factor keeping enough pixels and
+         * variance for this condition. Empty if the condition is too small for all of them.
+         */
+        cv::Mat coarseScaledGray = cv::Mat();
+        /** The downscale factor of [coarseScaledGray], 0 if it is empty. */
+        int coarseFactor = 0;
+        /** The statistics of the scaled gray image, for the integer matchers. */
+        TemplateStatistics grayStatistics = TemplateStatistics();
+        /** The informative pixels of the scaled gray image for the sparse matching, empty for the small conditions. */
+        SparseTemplate sparseGray = SparseTemplate();
+        /** The bits of the scaled gray image for the binary matching, empty for the small or low contrast ones. */
+        BinaryTemplate binaryGray = BinaryTemplate();
+        /** The edge points of the scaled gray image for the chamfer matching, empty for the small or flat ones. */
+        ChamferTemplate chamferGray = ChamferTemplate();
+        /**
+         * The opaque pixels of the full size color image, for the color verification of the masked conditions. Empty
+         * if the condition is fully opaque, or if [maskedGray] is empty.
+         */
+        cv::Mat fullSizeMask = cv::Mat();
+        /** The pixels of the scaled gray image fully covered by [fullSizeMask], for the masked matching. */
+        SparseTemplate maskedGray = SparseTemplate();
+        /**
+         * The hashes of the full size color pixels, for the exact pixel matching. Empty for the templates processed
+         * without them, such as the precomputed ones.
+         */
+        PixelsHash exactPixelsHash = PixelsHash();
+        /** The tiles of the full size color pixels probed in the screen [TileHashIndex]. Same as [exactPixelsHash]. */
+        TemplateTiles exactTiles = TemplateTiles();
+        /** Identifies the content of this template, the same for all conditions with the same bitmap. */
+        uint64_t contentHash = 0;
+
+        ConditionTemplate() = default;
+
+        /**
+         * @return true if the condition has transparent pixels. Only its opaque pixels are part of the condition, it
+         * is matched with [maskedGray] and its colors are verified in [fullSizeMask].
+         */
+        bool isMasked() const { return !maskedGray.isEmpty(); }
+
+        /**
+         * Get the spectrum of the scaled gray image for the FFT matching, computing it on the first call for a size.
+         * Can be called concurrently.
+         *
+         * @param transformSize the size of the transform, from [FftMatcher::getTransformSize].
+         */
+        cv::Mat getSpectrum(const cv::Size& transformSize) const;
+
+        /**
+         * Get the feature points of the scaled gray image for the feature matching, computing them on the first call.
+         * Can be called concurrently.
+         */
+        const TemplateFeatures& getFeatures() const;
+
+        /**
+         * Get a version of this template resized by a factor, for the multi scale matching. It is created on the first
+         * call for a factor and kept with this template. Can be called concurrently.
+         *
+         * @param templateScale the resize factor of the template, 1 for this template.
+         *
+         * @return the resized template, or nullptr if it is too small to be matched.
+         */
+        const ConditionTemplate* getScaleVariant(double templateScale) const;
+
+        /**
+         * Get a version of this template rotated around its center, for the rotation tolerant matching. It is created
+         * on the first call for an angle and kept with this template. Can be called concurrently.
+         * The rotated template is the bounding box of the rotated image, its corners are masked: it is matched with
+         * [maskedGray], and its colors verified in [fullSizeMask], unless the angle is a multiple of 90 degrees.
+         *
+         * @param angle the counterclockwise rotation of the template, in degrees. 0 for this template.
+         *
+         * @return the rotated template, or nullptr if it is too small or too flat to be matched.
+         */
+        const ConditionTemplate* getRotationVariant(int angle) const;
+
+        /** @return the memory used by the images of this template and its lazily computed values, in bytes. */
+        size_t getMemorySize() const;
+
+        /**
+         * Hash the pixels of a condition, identifying the templates processed from them in the [SharedTemplateStore].
+         * Cheaper than the processing, it reads the pixels once.
+         */
+        static uint64_t hashPixels(const PixelsBuffer& pixels);
+
+        /**
+         * Process the condition from RGBA pixels, without copying them. The full size color image is dropped once its
+         * color values are computed, the pixels are only read during this call.
+         */
+        void processPixels(uint8_t* pixels, int width, int height, size_t rowStride, double scaleRatio);
+
+        /** Same as [processPixels], with the pixels of a buffer. */
+        void processPixels(const PixelsBuffer& pixels, double scaleRatio);
+
+        /**
+         * Process the condition from already computed values, such as the ones stored in a [TemplatePack], without
+         * copying the gray image. The full size color image is not available for those templates.
+         */
+        void processPrecomputed(const cv::Size& fullSize, const cv::Mat& precomputedScaledGray,
+                                const cv::Scalar& precomputedColorMeans,
+                                const ColorHistogram& precomputedColorHistogram);
+
+        /**
+         * Keep the values this template can be restored from, compressing its images. Unlike [processPrecomputed],
+         * nothing is lost: the restored template is matched as this one, exact pixels and mask included.
+         *
+         * @param compressor the compressor of the images.
+         * @param compact receives the values of this template.
+         */
+        void compact(BlockCompressor& compressor, CompactTemplate& compact) const;
+
+        /**
+         * Process the condition from the values kept by [compact], decompressing its images and computing the values
+         * derived from them again.
+         *
+         * @return true if the template has been restored, false if the compressed images are invalid.
+         */
+        bool restore(const CompactTemplate& compact);
+
+    private:
+        /** Protects the spectrum, computed lazily by the matching threads. */
+        mutable std::mutex spectrumMutex;
+        /** The spectrum of the scaled gray image for the FFT matching, for [spectrumSize]. */
+        mutable cv::Mat spectrum = cv::Mat();
+        mutable cv::Size spectrumSize = cv::Size(0, 0);
+
+        /** Protects the features, computed lazily by the matching threads. */
+        mutable std::mutex featuresMutex;
+        /** The feature points of the scaled gray image for the feature matching, null until first needed. */
+        mutable std::unique_ptr<TemplateFeatures> features;
+
+        /** Protects the scale variants, created lazily by the matching threads. */
+        mutable std::mutex scaleVariantsMutex;
+        /** The resized versions of this template, with their resize factor. Null if too small. */
+        mutable std::vector<std::pair<double, std::unique_ptr<ConditionTemplate>>> scaleVariants;
+
+        /** Protects the rotation variants, created lazily by the matching threads. */
+        mutable std::mutex rotationVariantsMutex;
+        /** The rotated versions of this template, with their angle in degrees. Null if too small or too flat. */
+        mutable std::vector<std::pair<int, std::unique_ptr<ConditionTemplate>>> rotationVariants;
+
+        /** Compute the values derived from the processed [image]. */
+        void computeDerivedValues();
+        /** Compute [fullSizeMask] and [maskedGray] from the alpha channel of the full size color image. */
+        void computeMask();
+        /** Compute the values derived from the scaled gray image only. */
+        void computeScaledDerivedValues();
+        /** Compute [coarseScaledGray] at the cheapest downscale factor keeping enough details. */
+        void computeCoarseScaledGray();
+        /** @return the hash of the scaled gray image, the color values and the full size of this template. */
+        uint64_t computeContentHash() const;
+    };
+
+
+    /**
+     * Cache for the preprocessed condition images, keyed by condition identifier.
+     * Condition bitmaps never change during a scenario run, so they are processed only once per scale ratio. The
+     * templates of a previous run can also be loaded from a [TemplatePack], avoiding to process them at all. The
+     * templates processed from pixels are shared with the caches of the other detectors through the
+     * [SharedTemplateStore], a template processed by one of them is borrowed by the others.
+     *
+     * The templates of the last scale ratios are kept when it changes, so going back to previous screen metrics, such
+     * as when the screen is rotated back, doesn't process them again.
+     *
+     * The templates of the idle conditions, the ones of the events that can't be detected until an other event enables
+     * them, are kept as [CompactTemplate] for the current scale ratio and restored once they are not idle anymore.
+     */
+    class TemplateCache {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "TemplateCache";
+        /** Maximum number of scale ratios with cached templates, in addition to the current one. */
+        static constexpr size_t MAX_PREVIOUS_SCALE_RATIOS = 2;
+        /** A cached template, with the [useTick] it was last used at. Can be shared with the other caches. */
+        struct CachedTemplate {
+            std::shared_ptr<const ConditionTemplate> conditionTemplate;
+            uint64_t lastUseTick = 0;
+        };
+        using TemplateMap = std::unordered_map<int64_t, CachedTemplate>;
+
+        /** The scale ratio the cached templates have been processed with. */
+        double cachedScaleRatio = -1;
+        /** The pack the templates are loaded from before processing the bitmaps. Declared first to outlive them. */
+        TemplatePack pack = TemplatePack();
+        /** The cached templates, keyed by their condition identifier. */
+        TemplateMap templates;
+        /** The templates of the previous scale ratios, with their scale ratio. The most recently used first. */
+        std::vector<std::pair<double, TemplateMap>> previousTemplates;
+        /** The templates being processed by [prepare], with their condition identifier. */
+        std::vector<std::pair<int64_t, std::shared_ptr<ConditionTemplate>>> pendingTemplates;
+        /** The pixels of each template of [pendingTemplates], at the same index. */
+        std::vector<const PixelsBuffer*> pendingPixels;
+        /** The hash of the pixels of each template of [pendingTemplates], at the same index. */
+        std::vector<uint64_t> pendingHashes;
+        /** The conditions with the same pixels than a pending template, with the index of this template. */
+        std::vector<std::pair<int64_t, size_t>> pendingDuplicates;
+        /** The conditions removed by [remove] since the pack has been opened, their packed template is outdated. */
+        std::unordered_set<int64_t> unpackedConditionIds;
+        /** The conditions set by [setIdleConditions], their templates are compacted once processed. */
+        std::unordered_set<int64_t> idleConditionIds;
+        /** The compacted templates of the idle conditions at the current scale ratio, keyed by condition identifier. */
+        std::unordered_map<int64_t, CompactTemplate> idleTemplates;
+        /** The templates being compacted or restored, with their condition identifier. */
+        std::vector<std::pair<int64_t, std::shared_ptr<const ConditionTemplate>>> pendingIdleTemplates;
+        /** The compressor of each thread of the pool compacting the templates, by thread index. */
+        std::vector<BlockCompressor> compressors;
+
+        /** The memory the cached templates can use before being evicted by [trim], in bytes. */
+        size_t memoryBudget = DEFAULT_MEMORY_BUDGET;
+        /** Incremented by each [trim], the templates used since the last one have the current value. */
+        uint64_t useTick = 1;
+        /** The lookups of [get] and [prepare], and the templates evicted by the scale ratio changes and [trim]. */
+        CacheStatistics statistics;
+
+        /** Add a processed template to [templates], as used for the current tick. */
+        const ConditionTemplate* put(int64_t conditionId, std::shared_ptr<const ConditionTemplate> conditionTemplate);
+
+        /** @return true if the template of the condition can be loaded from the opened pack at this scale ratio. */
+        bool isPacked(int64_t conditionId, double scaleRatio) const;
+
+        /**
+         * Restore the compacted template of a condition, if it has one.
+         * @return the restored template, or nullptr if the condition has no compacted template or if it is invalid.
+         */
+        const ConditionTemplate* restoreIdle(int64_t conditionId);
+
+        /** Compact the cached templates of the idle conditions, concurrently on the thread pool if not null. */
+        void compactIdleTemplates(ThreadPool* threadPool);
+
+        /**
+         * Set the scale ratio of [templates]. If it is different from the one of the cached values, they are kept in
+         * [previousTemplates], and the ones for the new ratio are restored from it, if any.
+         */
+        void setScaleRatio(double scaleRatio);
+
+    public:
+        /** Default value of [memoryBudget], in bytes. */
+        static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+        /**
+         * Get the template for a condition, processing the condition pixels only if it is not cached yet for this
+         * scale ratio.
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionPixels the condition pixels. Only read on a cache miss, when the condition is not in the
+         *                        pack. Can be null for the conditions in the pack.
+         * @param scaleRatio the current scale ratio of the detection.
+         *
+         * @return the template for the condition, or nullptr if the condition pixels can't be processed.
+         */
+        const ConditionTemplate* get(int64_t conditionId, const PixelsBuffer* conditionPixels, double scaleRatio);
+
+        /**
+         * Process the templates of several conditions ahead of their detection, so their first matching is not slowed
+         * down by it. The pixels are processed concurrently on the thread pool.
+         * Once the templates of the current scale ratio exceed the memory budget, the next ones are not processed: they
+         * would evict the prepared ones, and are processed during their first detection instead.
+         *
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param conditionPixels the condition pixels, at the same index than their identifier. Only read for the
+         *                        conditions not cached nor in the pack, can be null for the other ones.
+         * @param scaleRatio the current scale ratio of the detection.
+         * @param threadPool the pool processing the pixels, null to process them on the calling thread.
+         *
+         * @return the number of conditions with a cached template.
+         */
+        int prepare(const std::vector<int64_t>& conditionIds, const std::vector<const PixelsBuffer*>& conditionPixels,
+                    double scaleRatio, ThreadPool* threadPool);
+
+        /**
+         * Open a template pack, the templates for its scale ratio will be loaded from it instead of being processed.
+         * @return true if the pack is valid, false if not.
+         */
+        bool openPack(const std::string& path);
+
+        /**
+         * Write all cached templates into a template pack, the compacted ones of the idle conditions excepted.
+         * @return true if the pack has been written, false if there is no template or on write error.
+         */
+        bool writePack(const std::string& path) const;
+
+        /** @return the identifiers of the conditions in the opened pack, if it can be used at this scale ratio. */
+        std::vector<int64_t> getPackedConditionIds(double scaleRatio) const;
+
+        /**
+         * Tells if the template of a condition is cached for a scale ratio, and can be get without its pixels.
+         * The templates in the opened pack are given by [getPackedConditionIds].
+         */
+        bool contains(int64_t conditionId, double scaleRatio) const;
+
+        /**
+         * Get the cached template of a condition without processing nor loading it, and without marking it as used.
+         * Can be called concurrently with other [find] calls, but not with the calls modifying the cache.
+         *
+         * @return the template for the condition at the cached scale ratio, or nullptr if it is not cached.
+         */
+        const ConditionTemplate* find(int64_t conditionId, double scaleRatio) const;
+
+        /** @return true if [get] needs the pixels of the condition: it is neither cached nor in the pack. */
+        bool isPixelsNeeded(int64_t conditionId, double scaleRatio) const;
+
+        /** @return the memory used by all cached templates, in bytes. The shared ones are counted by each cache. */
+        size_t getMemorySize() const;
+
+        /** @return the lookups and evictions of the cached templates. A template loaded from the pack is a miss. */
+        const CacheStatistics& getStatistics() const { return statistics; }
+
+        /**
+         * Set the memory the cached templates can use.
+         * @param budget the budget in bytes, enforced by the next [trim].
+         */
+        void setMemoryBudget(size_t budget);
+
+        /**
+         * Evict templates until their memory fits the budget: first the ones of the previous scale ratios, then the
+         * least recently used ones. The templates used since the previous call are always kept, the budget can be
+         * exceeded by them. Must be called when no template returned by [get] is still referenced.
+         */
+        void trim();
+
+        /**
+         * Drop the templates of some conditions, for all scale ratios, without touching the other ones. Their packed
+         * template, if any, is not used anymore: the next [get] or [prepare] processes their new pixels. Used when the
+         * bitmap of a condition is edited while its detector is kept.
+         */
+        void remove(const std::vector<int64_t>& conditionIds);
+
+        /**
+         * Set the conditions that are not detected until an other event enables them. Their templates are compacted,
+         * and the ones of the conditions that were idle before are restored, concurrently on the thread pool. The
+         * templates processed later for idle conditions, by [prepare] or at an other scale ratio, are compacted by
+         * the next [prepare]. An idle condition can still be detected, its template is restored by [get].
+         * Must be called when no template returned by [get] is still referenced.
+         *
+         * @param conditionIds the unique identifiers of all idle conditions, replacing the previous ones.
+         * @param threadPool the pool compacting and restoring the templates, null to process them on the calling
+         *                   thread.
+         */
+        void setIdleConditions(const std::vector<int64_t>& conditionIds, ThreadPool* threadPool);
+
+        /** Drop all cached templates, for all scale ratios. The opened pack and the idle conditions are kept. */
+        void clear();
+
+        /** Drop all cached templates, forget the idle conditions and close the opened pack. */
+        void release();
+    };
+}
+
+#endif //KLICK_R_TEMPLATE_CACHE_HPP
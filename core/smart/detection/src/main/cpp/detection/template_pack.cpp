@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "template_cache.hpp"
+#include "template_pack.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+
+static size_t alignOffset(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+TemplatePack::~TemplatePack() {
+    close();
+}
+
+bool TemplatePack::open(const std::string& path) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat fileStat = {};
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size < (off_t) sizeof(Header)) {
+        ::close(fd);
+        return false;
+    }
+
+    // The mapping remains valid once the file is closed
+    void* mapped = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        LOGE(LOG_TAG, "Can't map template pack %1$s", path.c_str());
+        return false;
+    }
+
+    mapping = static_cast<uint8_t*>(mapped);
+    mappingSize = (size_t) fileStat.st_size;
+    if (!isValid()) {
+        LOGE(LOG_TAG, "Invalid template pack %1$s, ignoring it", path.c_str());
+        close();
+        return false;
+    }
+
+    LOGD(LOG_TAG, "Template pack opened with %1$d templates", (int) getHeader().entryCount);
+    return true;
+}
+
+void TemplatePack::close() {
+    if (mapping == nullptr) return;
+
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+bool TemplatePack::isValid() const {
+    const Header& header = getHeader();
+    if (header.magic != MAGIC || header.version != VERSION || header.scaleRatio <= 0) return false;
+    if (header.entryCount > (mappingSize - sizeof(Header)) / sizeof(Entry)) return false;
+
+    const Entry* entries = getEntries();
+    for (uint32_t i = 0; i < header.entryCount; i++) {
+        const Entry& entry = entries[i];
+        if (entry.fullSizeWidth <= 0 || entry.fullSizeHeight <= 0) return false;
+        if (entry.scaledWidth <= 0 || entry.scaledHeight <= 0) return false;
+
+        const uint64_t grayLength = (uint64_t) entry.scaledWidth * (uint64_t) entry.scaledHeight;
+        if (entry.grayOffset > mappingSize || grayLength > mappingSize - entry.grayOffset) return false;
+    }
+
+    return true;
+}
+
+bool TemplatePack::isForScaleRatio(double scaleRatio) const {
+    return mapping != nullptr && getHeader().scaleRatio == scaleRatio;
+}
+
+std::vector<int64_t> TemplatePack::getConditionIds() const {
+    std::vector<int64_t> conditionIds;
+    if (mapping == nullptr) return conditionIds;
+
+    const Entry* entries = getEntries();
+    conditionIds.reserve(getHeader().entryCount);
+    for (uint32_t i = 0; i < getHeader().entryCount; i++) {
+        conditionIds.push_back(entries[i].conditionId);
+    }
+
+    return conditionIds;
+}
+
+bool TemplatePack::contains(int64_t conditionId) const {
+    if (mapping == nullptr) return false;
+
+    const Entry* entries = getEntries();
+    for (uint32_t i = 0; i < getHeader().entryCount; i++) {
+        if (entries[i].conditionId == conditionId) return true;
+    }
+
+    return false;
+}
+
+bool TemplatePack::load(int64_t conditionId, ConditionTemplate& result) const {
+    if (mapping == nullptr) return false;
+
+    // Scenarios have a few dozens of conditions at most, a linear search is enough
+    const Entry* entries = getEntries();
+    for (uint32_t i = 0; i < getHeader().entryCount; i++) {
+        const Entry& entry = entries[i];
+        if (entry.conditionId != conditionId) continue;
+
+        // The mapping is read only, the gray image is never written by the detection
+        const cv::Mat scaledGray(entry.scaledHeight, entry.scaledWidth, CV_8UC1, mapping + entry.grayOffset);
+        ColorHistogram colorHistogram;
+        std::copy(std::begin(entry.colorHistogram), std::end(entry.colorHistogram), colorHistogram.bins.begin());
+
+        result.processPrecomputed(
+                cv::Size(entry.fullSizeWidth, entry.fullSizeHeight),
+                scaledGray,
+                cv::Scalar(entry.colorMeans[0], entry.colorMeans[1], entry.colorMeans[2], entry.colorMeans[3]),
+                colorHistogram);
+        return true;
+    }
+
+    return false;
+}
+
+bool TemplatePack::write(const std::string& path, double scaleRatio,
+                         const std::vector<std::pair<int64_t, const ConditionTemplate*>>& templates) {
+
+    Header header = {MAGIC, VERSION, (uint32_t) templates.size(), 0, scaleRatio};
+    std::vector<Entry> entries(templates.size());
+
+    // The conditions with the same bitmap have the same template, their entries share a single gray image
+    std::vector<bool> isGrayWritten(templates.size(), true);
+    std::unordered_map<uint64_t, size_t> contentEntries;
+
+    size_t offset = alignOffset(sizeof(Header) + sizeof(Entry) * entries.size(), DATA_ALIGNMENT);
+    for (size_t i = 0; i < templates.size(); i++) {
+        const ConditionTemplate& conditionTemplate = *templates[i].second;
+        Entry& entry = entries[i];
+
+        entry.conditionId = (int64_t) templates[i].first;
+        entry.fullSizeWidth = conditionTemplate.image.fullSizeRoi.width;
+        entry.fullSizeHeight = conditionTemplate.image.fullSizeRoi.height;
+        entry.scaledWidth = conditionTemplate.image.scaledGray->cols;
+        entry.scaledHeight = conditionTemplate.image.scaledGray->rows;
+        for (int channel = 0; channel < 4; channel++) entry.colorMeans[channel] = conditionTemplate.colorMeans[channel];
+        std::copy(conditionTemplate.colorHistogram.bins.begin(), conditionTemplate.colorHistogram.bins.end(),
+                  entry.colorHistogram);
+
+        auto content = contentEntries.find(conditionTemplate.contentHash);
+        if (content != contentEntries.end() && entries[content->second].scaledWidth == entry.scaledWidth
+                && entries[content->second].scaledHeight == entry.scaledHeight) {
+            entry.grayOffset = entries[content->second].grayOffset;
+            isGrayWritten[i] = false;
+            continue;
+        }
+        contentEntries.emplace(conditionTemplate.contentHash, i);
+        entry.grayOffset = offset;
+
+        offset = alignOffset(offset + (size_t) entry.scaledWidth * entry.scaledHeight, DATA_ALIGNMENT);
+    }
+
+    const std::string tempPath = path + ".tmp";
+    FILE* file = fopen(tempPath.c_str(), "wb");
+    if (file == nullptr) {
+        LOGE(LOG_TAG, "Can't create template pack %1$s", tempPath.c_str());
+        return false;
+    }
+
+    bool isWritten = fwrite(&header, sizeof(Header), 1, file) == 1
+            && (entries.empty() || fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size());
+
+    static const uint8_t padding[DATA_ALIGNMENT] = {};
+    size_t position = sizeof(Header) + sizeof(Entry) * entries.size();
+    for (size_t i = 0; i < templates.size() && isWritten; i++) {
+        if (!isGrayWritten[i]) continue;
+        const cv::Mat& scaledGray = *templates[i].second->image.scaledGray;
+
+        const size_t paddingLength = entries[i].grayOffset - position;
+        isWritten = paddingLength == 0 || fwrite(padding, 1, paddingLength, file) == paddingLength;
+        for (int y = 0; y < scaledGray.rows && isWritten; y++) {
+            isWritten = fwrite(scaledGray.ptr<uint8_t>(y), 1, scaledGray.cols, file) == (size_t) scaledGray.cols;
+        }
+        position = entries[i].grayOffset + (size_t) scaledGray.cols * scaledGray.rows;
+    }
+
+    isWritten = fclose(file) == 0 && isWritten;
+
+    // Renaming replaces the file without invalidating a mapping on the previous one
+    if (!isWritten || rename(tempPath.c_str(), path.c_str()) != 0) {
+        LOGE(LOG_TAG, "Can't write template pack %1$s", path.c_str());
+        remove(tempPath.c_str());
+        return false;
+    }
+
+    LOGD(LOG_TAG, "Template pack written with %1$d templates", (int) templates.size());
+    return true;
+}
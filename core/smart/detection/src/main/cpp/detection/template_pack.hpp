@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_TEMPLATE_PACK_HPP
+#define KLICK_R_TEMPLATE_PACK_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "color_histogram.hpp"
+
+namespace smartautoclicker {
+
+    class ConditionTemplate;
+
+    /**
+     * A file containing the preprocessed condition templates of a scenario, for a single scale ratio.
+     *
+     * The pack is mapped in memory once opened, and the templates gray images are headers on the mapped pages. This
+     * avoids decoding and converting each condition bitmap at the scenario start, and they don't need to be
+     * provided by the java side at all.
+     *
+     * Layout, in native byte order: a [Header], [Header::entryCount] [Entry], and then the scaled gray images, each
+     * one starting on a [DATA_ALIGNMENT] bytes boundary and stored row by row without padding. The entries of the
+     * conditions with the same bitmap share the same gray image.
+     */
+    class TemplatePack {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "TemplatePack";
+
+        /** "KTPK" */
+        static constexpr uint32_t MAGIC = 0x4b50544b;
+        /** Incremented for each change in the layout. Packs with another version are ignored. */
+        static constexpr uint32_t VERSION = 2;
+        /** Alignment of the gray images in the file. */
+        static constexpr size_t DATA_ALIGNMENT = 16;
+
+        struct Header {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t entryCount;
+            uint32_t reserved;
+            /** The scale ratio the templates have been processed with. */
+            double scaleRatio;
+        };
+
+        struct Entry {
+            int64_t conditionId;
+            int32_t fullSizeWidth;
+            int32_t fullSizeHeight;
+            int32_t scaledWidth;
+            int32_t scaledHeight;
+            double colorMeans[4];
+            float colorHistogram[ColorHistogram::CHANNELS * COLOR_HISTOGRAM_BINS];
+            /** Offset of the scaled gray image from the start of the file. */
+            uint64_t grayOffset;
+        };
+
+        /** The mapped file, or nullptr if no pack is opened. */
+        uint8_t* mapping = nullptr;
+        size_t mappingSize = 0;
+
+        const Header& getHeader() const { return *reinterpret_cast<const Header*>(mapping); }
+        const Entry* getEntries() const { return reinterpret_cast<const Entry*>(mapping + sizeof(Header)); }
+        /** @return true if the mapped content is a valid pack. */
+        bool isValid() const;
+
+    public:
+        TemplatePack() = default;
+        ~TemplatePack();
+
+        TemplatePack(const TemplatePack&) = delete;
+        TemplatePack& operator=(const TemplatePack&) = delete;
+
+        /**
+         * Map a pack file, replacing the current one.
+         * All templates loaded from the previous pack must have been released.
+         *
+         * @return true if the file is a valid pack, false if not.
+         */
+        bool open(const std::string& path);
+
+        /** Unmap the current pack. All templates loaded from it must have been released. */
+        void close();
+
+        bool isOpened() const { return mapping != nullptr; }
+
+        /** @return true if the pack is opened and has been written for this scale ratio. */
+        bool isForScaleRatio(double scaleRatio) const;
+
+        /** @return the identifiers of all conditions in the pack. */
+        std::vector<int64_t> getConditionIds() const;
+
+        /** @return true if the pack is opened and contains the template of the condition. */
+        bool contains(int64_t conditionId) const;
+
+        /**
+         * Load a condition template from the pack, without copying its gray image.
+         *
+         * @param conditionId the unique identifier of the condition.
+         * @param result the template to load into. Valid as long as the pack is opened.
+         *
+         * @return true if the condition is in the pack, false if not.
+         */
+        bool load(int64_t conditionId, ConditionTemplate& result) const;
+
+        /**
+         * Write a pack file with the provided templates.
+         * The file is written next to the path and then renamed, so a currently mapped pack at this path remains valid.
+         *
+         * @param path the path of the pack file.
+         * @param scaleRatio the scale ratio the templates have been processed with.
+         * @param templates the templates to write, with their condition identifier.
+         *
+         * @return true if the pack has been written.
+         */
+        static bool write(const std::string& path, double scaleRatio,
+                          const std::vector<std::pair<int64_t, const ConditionTemplate*>>& templates);
+    };
+}
+
+#endif //KLICK_R_TEMPLATE_PACK_HPP
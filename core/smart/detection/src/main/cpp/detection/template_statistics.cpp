@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "template_statistics.hpp"
+
+using namespace smartautoclicker;
+
+
+void TemplateStatistics::compute(const cv::Mat& templ) {
+    int64_t squaredSum = 0;
+    sum = 0;
+    for (int y = 0; y < templ.rows; y++) {
+        const auto* row = templ.ptr<uint8_t>(y);
+        int64_t rowSum = 0, rowSquaredSum = 0;
+        for (int x = 0; x < templ.cols; x++) {
+            rowSum += row[x];
+            rowSquaredSum += row[x] * row[x];
+        }
+        sum += rowSum;
+        squaredSum += rowSquaredSum;
+    }
+
+    area = (int64_t) templ.total();
+    scaledNormSquared = area * squaredSum - sum * sum;
+    scaledNorm = std::sqrt((double) scaledNormSquared);
+}
+
+bool TemplateStatistics::isFlat() const {
+    // Same as the OpenCv (squared norm / area) < DBL_EPSILON, with the squared norm scaled by the area
+    return area == 0 || (double) scaledNormSquared / ((double) area * (double) area) < DBL_EPSILON;
+}
+
+float TemplateStatistics::getNormedValue(uint64_t correlation, int64_t windowSum, int64_t windowSquaredSum) const {
+    // Both scaled by the area, their ratio and comparisons are the same as the OpenCv ones
+    const auto value = (double) (area * (int64_t) correlation - sum * windowSum);
+    const int64_t windowVariance = area * windowSquaredSum - windowSum * windowSum;
+    const double norm = std::sqrt((double) std::max(windowVariance, (int64_t) 0)) * scaledNorm;
+
+    if (std::fabs(value) < norm) return (float) (value / norm);
+    if (std::fabs(value) < norm * 1.125) return value > 0 ? 1.f : -1.f;
+    return 0.f;
+}
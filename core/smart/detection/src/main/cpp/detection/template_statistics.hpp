@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_TEMPLATE_STATISTICS_HPP
+#define KLICK_R_TEMPLATE_STATISTICS_HPP
+
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * Integer statistics of a gray template, for the TM_CCOEFF_NORMED normalization of the integer matchers.
+     * Computed once per template.
+     *
+     * The normalization is done in fixed point: the centered correlation and the window variance are computed
+     * exactly in integers, scaled by the template area, and only their ratio is computed in floating point.
+     */
+    class TemplateStatistics {
+
+    private:
+        int64_t area = 0;
+        int64_t sum = 0;
+        /** The squared norm of the zero mean template, multiplied by [area]. */
+        int64_t scaledNormSquared = 0;
+        /** The square root of [scaledNormSquared]. */
+        double scaledNorm = 0;
+
+    public:
+        /** Compute the statistics of a template, in 8 bits gray. */
+        void compute(const cv::Mat& templ);
+
+        /** @return true if the template have no variance. Same as OpenCv, it then matches everywhere. */
+        bool isFlat() const;
+
+        /** @return the sum of the template values. */
+        int64_t getSum() const { return sum; }
+        /** @return the norm of the zero mean template, multiplied by the square root of the template area. */
+        double getScaledNorm() const { return scaledNorm; }
+
+        /**
+         * Get the TM_CCOEFF_NORMED value of a position, with the same normalization as OpenCv, including for the
+         * windows without variance.
+         *
+         * @param correlation the raw correlation of the template with the window of this position.
+         * @param windowSum the sum of the image values in the window.
+         * @param windowSquaredSum the sum of the squared image values in the window.
+         */
+        float getNormedValue(uint64_t correlation, int64_t windowSum, int64_t windowSquaredSum) const;
+    };
+}
+
+#endif //KLICK_R_TEMPLATE_STATISTICS_HPP
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+
+#include "text_region_proposer.hpp"
+#include "../types/memory_usage.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+/** Width of the kernel merging the glyphs of a line, in scaled pixels. Wider than the space between two words. */
+static constexpr int LINE_KERNEL_WIDTH = 9;
+
+
+TextRegionProposer::TextRegionProposer()
+        : gradientKernel(cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3))),
+          lineKernel(cv::getStructuringElement(cv::MORPH_RECT, cv::Size(LINE_KERNEL_WIDTH, 1))) {}
+
+const std::vector<cv::Rect>& TextRegionProposer::propose(const cv::Mat& gray) {
+    TRACE_SECTION("proposeTextRegions");
+    regions.clear();
+    if (gray.empty()) return regions;
+
+    cv::morphologyEx(gray, gradient, cv::MORPH_GRADIENT, gradientKernel);
+
+    // Otsu is thrown off by a plain background, only its faint noise would be kept
+    const double otsuThreshold = cv::threshold(gradient, edges, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+    if (otsuThreshold < TEXT_REGION_MIN_GRADIENT) {
+        cv::threshold(gradient, edges, TEXT_REGION_MIN_GRADIENT, 255, cv::THRESH_BINARY);
+    }
+
+    cv::morphologyEx(edges, lines, cv::MORPH_CLOSE, lineKernel);
+    cv::findContours(lines, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    const cv::Rect imageRect(0, 0, gray.cols, gray.rows);
+    for (const std::vector<cv::Point>& contour : contours) {
+        const cv::Rect box = cv::boundingRect(contour);
+        if (box.height < TEXT_REGION_MIN_HEIGHT || box.width < box.height) continue;
+        if (cv::countNonZero(lines(box)) < box.area() * TEXT_REGION_MIN_FILL_RATIO) continue;
+
+        regions.push_back((box + cv::Size(TEXT_REGION_MARGIN * 2, TEXT_REGION_MARGIN * 2)
+                - cv::Point(TEXT_REGION_MARGIN, TEXT_REGION_MARGIN)) & imageRect);
+    }
+
+    std::sort(regions.begin(), regions.end(), [](const cv::Rect& first, const cv::Rect& second) {
+        return first.area() > second.area();
+    });
+    if (regions.size() > TEXT_REGION_MAX_COUNT) regions.resize(TEXT_REGION_MAX_COUNT);
+
+    return regions;
+}
+
+size_t TextRegionProposer::getMemorySize() const {
+    return getMatMemorySize(gradient) + getMatMemorySize(edges) + getMatMemorySize(lines);
+}
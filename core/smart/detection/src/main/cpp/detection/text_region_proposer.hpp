@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_TEXT_REGION_PROPOSER_HPP
+#define KLICK_R_TEXT_REGION_PROPOSER_HPP
+
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /** Minimum height of a text region, in scaled pixels. Below, the glyphs can't be recognized anyway. */
+    static constexpr int TEXT_REGION_MIN_HEIGHT = 4;
+    /** Maximum number of text regions proposed in an area, the biggest ones are kept. */
+    static constexpr int TEXT_REGION_MAX_COUNT = 16;
+    /** Minimum part of a text region box covered by its glyphs strokes, telling text apart from borders and lines. */
+    static constexpr double TEXT_REGION_MIN_FILL_RATIO = 0.4;
+    /** Minimum gradient of the glyphs edges, keeping the noise of a plain background out of the regions. */
+    static constexpr double TEXT_REGION_MIN_GRADIENT = 24;
+    /** Margin added around each text region, in scaled pixels, keeping the glyphs edges in it. */
+    static constexpr int TEXT_REGION_MARGIN = 2;
+
+    /**
+     * Proposes the regions of an image likely to contain a line of text, so only them are given to the OCR engine.
+     *
+     * Glyphs have strong and dense edges: the morphological gradient of the image is binarized, and closed horizontally
+     * to merge the glyphs of a line into a single blob. The bounding boxes of the blobs high enough, wider than high
+     * and filled enough are the text lines.
+     *
+     * The buffers are kept between the images to avoid allocations, this isn't thread safe.
+     */
+    class TextRegionProposer {
+
+    private:
+        /** The kernel of the morphological gradient. */
+        cv::Mat gradientKernel = cv::Mat();
+        /** The kernel merging the glyphs of a line. */
+        cv::Mat lineKernel = cv::Mat();
+
+        /** The morphological gradient of the image. */
+        cv::Mat gradient = cv::Mat();
+        /** [gradient] binarized, the edges of the glyphs. */
+        cv::Mat edges = cv::Mat();
+        /** [edges] closed horizontally, a blob per text line. */
+        cv::Mat lines = cv::Mat();
+        /** The contours of the blobs of [lines]. */
+        std::vector<std::vector<cv::Point>> contours;
+        /** The proposed regions of the last image. */
+        std::vector<cv::Rect> regions;
+
+    public:
+        TextRegionProposer();
+
+        /**
+         * Propose the text regions of an image.
+         *
+         * @param gray the single channel image to search the text in.
+         *
+         * @return the text regions, in [gray] coordinates, biggest first. Valid until the next call to this method.
+         */
+        const std::vector<cv::Rect>& propose(const cv::Mat& gray);
+
+        /** @return the memory of the buffers, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_TEXT_REGION_PROPOSER_HPP
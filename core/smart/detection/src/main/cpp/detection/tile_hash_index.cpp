@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "tile_hash_index.hpp"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+/** @return the sum of the absolute differences between the horizontal neighbours of a CV_8UC4 tile. */
+static int getTexture(const cv::Mat& rgba) {
+    int texture = 0;
+    for (int y = 0; y < rgba.rows; y++) {
+        const auto* row = rgba.ptr<uint8_t>(y);
+        for (int x = 4; x < rgba.cols * 4; x++) {
+            if (x % 4 != 3) texture += std::abs(row[x] - row[x - 4]);
+        }
+    }
+
+    return texture;
+}
+
+/** @return the hash of a tile, the primary hash of its pixels. */
+static uint64_t getTileHash(const cv::Mat& rgba, const cv::Point& position) {
+    PixelsHash hash;
+    hash.compute(rgba(cv::Rect(position.x, position.y, TILE_INDEX_SIZE, TILE_INDEX_SIZE)));
+    return hash.primary;
+}
+
+void TemplateTiles::compute(const cv::Mat& rgba) {
+    tiles.clear();
+
+    // Each alignment must have a complete tile in the template
+    if (rgba.cols < TILE_INDEX_SIZE * 2 - 1 || rgba.rows < TILE_INDEX_SIZE * 2 - 1) return;
+
+    tiles.reserve(TILE_INDEX_SIZE * TILE_INDEX_SIZE);
+    for (int alignY = 0; alignY < TILE_INDEX_SIZE; alignY++) {
+        for (int alignX = 0; alignX < TILE_INDEX_SIZE; alignX++) {
+            // The most textured tile has the fewest occurrences on the screen, and the fewest candidates
+            Tile bestTile;
+            int bestTexture = -1;
+            for (int y = alignY; y + TILE_INDEX_SIZE <= rgba.rows; y += TILE_INDEX_SIZE) {
+                for (int x = alignX; x + TILE_INDEX_SIZE <= rgba.cols; x += TILE_INDEX_SIZE) {
+                    const int texture = getTexture(rgba(cv::Rect(x, y, TILE_INDEX_SIZE, TILE_INDEX_SIZE)));
+                    if (texture <= bestTexture) continue;
+
+                    bestTexture = texture;
+                    bestTile.offset = cv::Point(x, y);
+                }
+            }
+
+            bestTile.hash = getTileHash(rgba, bestTile.offset);
+            tiles.push_back(bestTile);
+        }
+    }
+}
+
+void TileHashIndex::build(const cv::Mat& rgba) {
+    TRACE_SECTION("buildTileHashIndex");
+
+    entries.clear();
+    entries.reserve((size_t) (rgba.cols / TILE_INDEX_SIZE) * (rgba.rows / TILE_INDEX_SIZE));
+    for (int y = 0; y + TILE_INDEX_SIZE <= rgba.rows; y += TILE_INDEX_SIZE) {
+        for (int x = 0; x + TILE_INDEX_SIZE <= rgba.cols; x += TILE_INDEX_SIZE) {
+            const cv::Point position(x, y);
+            entries.push_back({ getTileHash(rgba, position), position });
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [] (const Entry& a, const Entry& b) { return a.hash < b.hash; });
+}
+
+bool TileHashIndex::find(const cv::Mat& rgba, const TemplateTiles& templTiles, const PixelsHash& templHash,
+                         const cv::Rect& area, std::vector<cv::Point>& candidates, cv::Point& location,
+                         bool& isFound) const {
+
+    TRACE_SECTION("findIndexedTiles");
+    isFound = false;
+    candidates.clear();
+
+    const auto isHashLower = [] (const Entry& entry, uint64_t hash) { return entry.hash < hash; };
+    for (const TemplateTiles::Tile& tile : templTiles.tiles) {
+        const auto first = std::lower_bound(entries.begin(), entries.end(), tile.hash, isHashLower);
+        size_t count = 0;
+        for (auto entry = first; entry != entries.end() && entry->hash == tile.hash; entry++) {
+            if (++count > TILE_INDEX_MAX_CANDIDATES) return false;
+
+            const cv::Rect candidate(entry->position - tile.offset, templHash.size);
+            if ((candidate & area) == candidate) candidates.push_back(candidate.tl());
+        }
+    }
+
+    // Verified in reading order, as the search without the index
+    std::sort(candidates.begin(), candidates.end(), [] (const cv::Point& a, const cv::Point& b) {
+        return a.y < b.y || (a.y == b.y && a.x < b.x);
+    });
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    for (const cv::Point& candidate : candidates) {
+        PixelsHash candidateHash;
+        candidateHash.compute(rgba(cv::Rect(candidate, templHash.size)));
+        if (candidateHash.primary != templHash.primary || candidateHash.secondary != templHash.secondary) continue;
+
+        location = candidate;
+        isFound = true;
+        break;
+    }
+
+    return true;
+}
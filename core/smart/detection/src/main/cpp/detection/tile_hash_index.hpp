@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_TILE_HASH_INDEX_HPP
+#define KLICK_R_TILE_HASH_INDEX_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "exact_pixel_matcher.hpp"
+
+namespace smartautoclicker {
+
+    /** Size of the tiles of a [TileHashIndex], and offset between them, in full size pixels. */
+    static constexpr int TILE_INDEX_SIZE = 8;
+    /** Maximum number of screen tiles with the hash of a template tile. Above, the index is not used for it. */
+    static constexpr size_t TILE_INDEX_MAX_CANDIDATES = 32;
+
+    /**
+     * The tiles of a template probed in a [TileHashIndex], one per alignment of the template with the tile grid.
+     * Wherever the template is on the screen, one of its tiles is on the grid: a lookup is a probe per alignment.
+     */
+    struct TemplateTiles {
+        /** A tile of the template, with its position in the template. */
+        struct Tile {
+            uint64_t hash = 0;
+            cv::Point offset = cv::Point();
+        };
+
+        /** One tile per alignment, the most textured one. Empty if the template is too small. */
+        std::vector<Tile> tiles;
+
+        /** Select the tiles of a CV_8UC4 template. */
+        void compute(const cv::Mat& rgba);
+
+        bool isEmpty() const { return tiles.empty(); }
+    };
+
+    /**
+     * Hash table of the tiles of a screen image, on a grid of [TILE_INDEX_SIZE] pixels. Built once per frame, it is
+     * shared by all conditions: finding the exact pixels of one is a probe per tile of its [TemplateTiles], with the
+     * verification of the few candidates, instead of a search of its whole detection area.
+     */
+    class TileHashIndex {
+
+    private:
+        /** A tile of the screen, with the position of its top left corner. */
+        struct Entry {
+            uint64_t hash;
+            cv::Point position;
+        };
+
+        /** The tiles of the screen, sorted by hash. */
+        std::vector<Entry> entries;
+
+    public:
+        /** Build the index of a CV_8UC4 screen image. The incomplete border tiles are not indexed. */
+        void build(const cv::Mat& rgba);
+
+        /**
+         * Find the first occurrence of the exact pixels of a template in an area of the indexed image, in reading
+         * order. Can be called concurrently, with a candidates buffer per thread.
+         *
+         * @param rgba the indexed image.
+         * @param templTiles the tiles of the template.
+         * @param templHash the hashes of the template, verifying the candidates.
+         * @param area the area of [rgba] searched.
+         * @param location set to the top left corner of the occurrence, in [rgba] coordinates.
+         * @param candidates the buffer of the positions found by the probes, kept between the calls.
+         * @param isFound set to true if the template has been found.
+         *
+         * @return false if a template tile has more than [TILE_INDEX_MAX_CANDIDATES] candidates, such as the plain
+         *         color ones, and the area must be searched without the index.
+         */
+        bool find(const cv::Mat& rgba, const TemplateTiles& templTiles, const PixelsHash& templHash,
+                  const cv::Rect& area, std::vector<cv::Point>& candidates, cv::Point& location,
+                  bool& isFound) const;
+
+        bool isEmpty() const { return entries.empty(); }
+
+        /** @return the memory of the index, in bytes. */
+        size_t getMemorySize() const { return entries.capacity() * sizeof(Entry); }
+    };
+}
+
+#endif //KLICK_R_TILE_HASH_INDEX_HPP
@@ -0,0 +1,399 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cmath>
+#include <dlfcn.h>
+#include <tuple>
+
+#include "nnapi_matcher.hpp"
+#include "../detection/integer_matcher.hpp"
+#include "../utils/log.h"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+namespace {
+
+    /** The functions of NNAPI, resolved once from libneuralnetworks. */
+    struct NeuralNetworksApi {
+        int (*getDeviceCount)(uint32_t* count) = nullptr;
+        int (*getDevice)(uint32_t index, ANeuralNetworksDevice** device) = nullptr;
+        int (*getDeviceType)(const ANeuralNetworksDevice* device, int32_t* type) = nullptr;
+        int (*getDeviceName)(const ANeuralNetworksDevice* device, const char** name) = nullptr;
+        int (*createModel)(ANeuralNetworksModel** model) = nullptr;
+        void (*freeModel)(ANeuralNetworksModel* model) = nullptr;
+        int (*addOperand)(ANeuralNetworksModel* model, const ANeuralNetworksOperandType* type) = nullptr;
+        int (*setOperandValue)(ANeuralNetworksModel* model, int32_t index, const void* buffer, size_t length) = nullptr;
+        int (*addOperation)(ANeuralNetworksModel* model, ANeuralNetworksOperationType type, uint32_t inputCount,
+                            const uint32_t* inputs, uint32_t outputCount, const uint32_t* outputs) = nullptr;
+        int (*identifyInputsAndOutputs)(ANeuralNetworksModel* model, uint32_t inputCount, const uint32_t* inputs,
+                                        uint32_t outputCount, const uint32_t* outputs) = nullptr;
+        int (*relaxComputationFloat32toFloat16)(ANeuralNetworksModel* model, bool allow) = nullptr;
+        int (*finishModel)(ANeuralNetworksModel* model) = nullptr;
+        int (*createCompilationForDevices)(ANeuralNetworksModel* model, const ANeuralNetworksDevice* const* devices,
+                                           uint32_t deviceCount, ANeuralNetworksCompilation** compilation) = nullptr;
+        int (*setCompilationPreference)(ANeuralNetworksCompilation* compilation, int32_t preference) = nullptr;
+        int (*finishCompilation)(ANeuralNetworksCompilation* compilation) = nullptr;
+        void (*freeCompilation)(ANeuralNetworksCompilation* compilation) = nullptr;
+        int (*createExecution)(ANeuralNetworksCompilation* compilation, ANeuralNetworksExecution** execution) = nullptr;
+        int (*setExecutionInput)(ANeuralNetworksExecution* execution, int32_t index,
+                                 const ANeuralNetworksOperandType* type, const void* buffer, size_t length) = nullptr;
+        int (*setExecutionOutput)(ANeuralNetworksExecution* execution, int32_t index,
+                                  const ANeuralNetworksOperandType* type, void* buffer, size_t length) = nullptr;
+        int (*compute)(ANeuralNetworksExecution* execution) = nullptr;
+        void (*freeExecution)(ANeuralNetworksExecution* execution) = nullptr;
+
+        bool isLoaded() const {
+            return getDeviceCount != nullptr && getDevice != nullptr && getDeviceType != nullptr
+                    && getDeviceName != nullptr && createModel != nullptr && freeModel != nullptr
+                    && addOperand != nullptr && setOperandValue != nullptr && addOperation != nullptr
+                    && identifyInputsAndOutputs != nullptr && relaxComputationFloat32toFloat16 != nullptr
+                    && finishModel != nullptr && createCompilationForDevices != nullptr
+                    && setCompilationPreference != nullptr && finishCompilation != nullptr
+                    && freeCompilation != nullptr && createExecution != nullptr && setExecutionInput != nullptr
+                    && setExecutionOutput != nullptr && compute != nullptr && freeExecution != nullptr;
+        }
+    };
+
+    template <typename Function>
+    void loadSymbol(void* library, const char* name, Function& function) {
+        function = reinterpret_cast<Function>(dlsym(library, name));
+    }
+
+    const NeuralNetworksApi& getApi() {
+        static const NeuralNetworksApi api = [] {
+            NeuralNetworksApi loaded;
+
+            // Never closed, the compiled models are released with the process. Missing before Android 8.1.
+            void* library = dlopen("libneuralnetworks.so", RTLD_NOW | RTLD_LOCAL);
+            if (library == nullptr) return loaded;
+
+            // The devices functions are missing before Android 10, the matcher is then not available
+            loadSymbol(library, "ANeuralNetworks_getDeviceCount", loaded.getDeviceCount);
+            loadSymbol(library, "ANeuralNetworks_getDevice", loaded.getDevice);
+            loadSymbol(library, "ANeuralNetworksDevice_getType", loaded.getDeviceType);
+            loadSymbol(library, "ANeuralNetworksDevice_getName", loaded.getDeviceName);
+            loadSymbol(library, "ANeuralNetworksModel_create", loaded.createModel);
+            loadSymbol(library, "ANeuralNetworksModel_free", loaded.freeModel);
+            loadSymbol(library, "ANeuralNetworksModel_addOperand", loaded.addOperand);
+            loadSymbol(library, "ANeuralNetworksModel_setOperandValue", loaded.setOperandValue);
+            loadSymbol(library, "ANeuralNetworksModel_addOperation", loaded.addOperation);
+            loadSymbol(library, "ANeuralNetworksModel_identifyInputsAndOutputs", loaded.identifyInputsAndOutputs);
+            loadSymbol(library, "ANeuralNetworksModel_relaxComputationFloat32toFloat16",
+                       loaded.relaxComputationFloat32toFloat16);
+            loadSymbol(library, "ANeuralNetworksModel_finish", loaded.finishModel);
+            loadSymbol(library, "ANeuralNetworksCompilation_createForDevices", loaded.createCompilationForDevices);
+            loadSymbol(library, "ANeuralNetworksCompilation_setPreference", loaded.setCompilationPreference);
+            loadSymbol(library, "ANeuralNetworksCompilation_finish", loaded.finishCompilation);
+            loadSymbol(library, "ANeuralNetworksCompilation_free", loaded.freeCompilation);
+            loadSymbol(library, "ANeuralNetworksExecution_create", loaded.createExecution);
+            loadSymbol(library, "ANeuralNetworksExecution_setInput", loaded.setExecutionInput);
+            loadSymbol(library, "ANeuralNetworksExecution_setOutput", loaded.setExecutionOutput);
+            loadSymbol(library, "ANeuralNetworksExecution_compute", loaded.compute);
+            loadSymbol(library, "ANeuralNetworksExecution_free", loaded.freeExecution);
+            return loaded;
+        }();
+
+        return api;
+    }
+
+    /** @return the key grouping the jobs computed by the same convolution. */
+    std::tuple<int, int, int, int, int, int> getConvolutionKey(const MatchBackend::Job& job) {
+        const cv::Mat& templ = *job.conditionTemplate->image.scaledGray;
+        return std::make_tuple(job.area.x, job.area.y, job.area.width, job.area.height, templ.cols, templ.rows);
+    }
+}
+
+NnapiMatcher::CompiledModel::~CompiledModel() {
+    const NeuralNetworksApi& api = getApi();
+    if (compilation != nullptr) api.freeCompilation(compilation);
+    if (model != nullptr) api.freeModel(model);
+}
+
+std::unique_ptr<NnapiMatcher> NnapiMatcher::create() {
+    const NeuralNetworksApi& api = getApi();
+    uint32_t deviceCount = 0;
+    if (!api.isLoaded() || api.getDeviceCount(&deviceCount) != ANEURALNETWORKS_NO_ERROR) {
+        LOGW(LOG_TAG, "NNAPI is not available on this device");
+        return nullptr;
+    }
+
+    // The dedicated accelerators first, the CPU reference implementation would be slower than the CPU backends
+    ANeuralNetworksDevice* selectedDevice = nullptr;
+    int32_t selectedType = ANEURALNETWORKS_DEVICE_UNKNOWN;
+    for (uint32_t i = 0; i < deviceCount; i++) {
+        ANeuralNetworksDevice* device = nullptr;
+        int32_t type = ANEURALNETWORKS_DEVICE_UNKNOWN;
+        if (api.getDevice(i, &device) != ANEURALNETWORKS_NO_ERROR
+                || api.getDeviceType(device, &type) != ANEURALNETWORKS_NO_ERROR) continue;
+
+        if (type == ANEURALNETWORKS_DEVICE_ACCELERATOR
+                || (type == ANEURALNETWORKS_DEVICE_GPU && selectedType != ANEURALNETWORKS_DEVICE_ACCELERATOR)) {
+            selectedDevice = device;
+            selectedType = type;
+        }
+    }
+
+    if (selectedDevice == nullptr) {
+        LOGW(LOG_TAG, "No NNAPI accelerator available");
+        return nullptr;
+    }
+
+    const char* name = nullptr;
+    api.getDeviceName(selectedDevice, &name);
+    LOGI(LOG_TAG, "Matching on NNAPI device %1$s", name != nullptr ? name : "unknown");
+    return std::unique_ptr<NnapiMatcher>(new NnapiMatcher(selectedDevice));
+}
+
+bool NnapiMatcher::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return context.backendTemplate == request.condition && context.backendResults.size() == request.getResultsSize();
+}
+
+double NnapiMatcher::getCost(const MatchRequest& request) const {
+    return (double) request.getResultsSize().area();
+}
+
+void NnapiMatcher::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    context.backendResults.copyTo(results);
+
+    const ConditionTemplate& condition = *request.condition;
+    if (condition.grayStatistics.isFlat()) return;
+
+    // Below, even with the approximation error, the position can't reach the min confidence
+    const cv::Mat& templ = *condition.image.scaledGray;
+    const float minApproximated = (float) request.minConfidence - APPROXIMATION_MARGIN;
+    for (int y = 0; y < results.rows; y++) {
+        auto* row = results.ptr<float>(y);
+        for (int x = 0; x < results.cols; x++) {
+            if (row[x] < minApproximated) continue;
+            row[x] = IntegerMatcher::matchPosition(*request.image, cv::Point(x, y), templ, condition.grayStatistics);
+        }
+    }
+}
+
+bool NnapiMatcher::isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const {
+    if (templateSize.area() <= 0 || templateSize.area() > MAX_TEMPLATE_AREA
+            || areaSize.width < templateSize.width || areaSize.height < templateSize.height) return false;
+
+    const auto resultsSize = (size_t) (areaSize.width - templateSize.width + 1)
+            * (size_t) (areaSize.height - templateSize.height + 1);
+    return resultsSize <= MAX_OUTPUT_SIZE;
+}
+
+bool NnapiMatcher::matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) {
+    TRACE_SECTION("nnapiMatch");
+
+    // The models of the previous scenarios or screen metrics are not needed anymore
+    if (compiledModels.size() > MAX_COMPILED_MODELS) {
+        LOGD(LOG_TAG, "Compiled models limit reached, releasing %1$d models", (int) compiledModels.size());
+        compiledModels.clear();
+    }
+
+    std::vector<Job*> convolutionJobs;
+    convolutionJobs.reserve(jobs.size());
+    for (Job& job : jobs) {
+        const cv::Mat& templ = *job.conditionTemplate->image.scaledGray;
+        job.results->create(job.area.height - templ.rows + 1, job.area.width - templ.cols + 1, CV_32F);
+
+        // Same as OpenCv, a template without variance matches everywhere
+        if (job.conditionTemplate->grayStatistics.isFlat()) {
+            job.results->setTo(1.f);
+            continue;
+        }
+        convolutionJobs.push_back(&job);
+    }
+    std::stable_sort(convolutionJobs.begin(), convolutionJobs.end(), [] (const Job* left, const Job* right) {
+        return getConvolutionKey(*left) < getConvolutionKey(*right);
+    });
+
+    for (size_t first = 0; first < convolutionJobs.size();) {
+        const Job& firstJob = *convolutionJobs[first];
+        const cv::Size templateSize = firstJob.conditionTemplate->image.scaledGray->size();
+        const size_t resultsSize = firstJob.results->total();
+        const size_t maxCount = std::max((size_t) 1,
+                                         std::min((size_t) MAX_FILTER_COUNT, MAX_OUTPUT_SIZE / resultsSize));
+
+        size_t last = first + 1;
+        while (last < convolutionJobs.size() && last - first < maxCount
+                && getConvolutionKey(*convolutionJobs[last]) == getConvolutionKey(firstJob)) last++;
+
+        modelJobs.assign(convolutionJobs.begin() + (long) first, convolutionJobs.begin() + (long) last);
+        const CompiledModel* model = getCompiledModel(firstJob.area.size(), templateSize);
+        if (model == nullptr || !execute(*model, (*screenImage.scaledGray)(firstJob.area), templateSize)) return false;
+
+        first = last;
+    }
+
+    return true;
+}
+
+const NnapiMatcher::CompiledModel* NnapiMatcher::getCompiledModel(const cv::Size& areaSize,
+                                                                  const cv::Size& templateSize) {
+    uint64_t hash = ((uint64_t) areaSize.width << 48) ^ ((uint64_t) areaSize.height << 32)
+            ^ ((uint64_t) templateSize.width << 16) ^ (uint64_t) templateSize.height;
+    for (const Job* job : modelJobs) hash = (hash ^ job->conditionTemplate->contentHash) * 0x100000001b3ULL;
+
+    auto compiled = compiledModels.find(hash);
+    if (compiled != compiledModels.end()) return compiled->second.get();
+
+    std::unique_ptr<CompiledModel> model = compileModel(areaSize, templateSize);
+    if (!model) {
+        LOGW_LIMITED(LOG_TAG, "Can't compile the convolution of %1$d templates", (int) modelJobs.size());
+        return nullptr;
+    }
+
+    return compiledModels.emplace(hash, std::move(model)).first->second.get();
+}
+
+std::unique_ptr<NnapiMatcher::CompiledModel> NnapiMatcher::compileModel(const cv::Size& areaSize,
+                                                                       const cv::Size& templateSize) const {
+    TRACE_SECTION("nnapiCompile");
+    const NeuralNetworksApi& api = getApi();
+    auto compiled = std::make_unique<CompiledModel>();
+
+    // The zero mean templates, on normalized pixels: the results are the centered correlations divided by 255²
+    const auto filterCount = (uint32_t) modelJobs.size();
+    const auto filterSize = (size_t) templateSize.area();
+    compiled->filters.resize(filterCount * filterSize);
+    compiled->biases.assign(filterCount, 0.f);
+    for (uint32_t filter = 0; filter < filterCount; filter++) {
+        const ConditionTemplate& condition = *modelJobs[filter]->conditionTemplate;
+        const cv::Mat& templ = *condition.image.scaledGray;
+        const double mean = (double) condition.grayStatistics.getSum() / (double) filterSize;
+
+        float* filterValues = compiled->filters.data() + filter * filterSize;
+        for (int y = 0; y < templ.rows; y++) {
+            const uint8_t* templRow = templ.ptr<uint8_t>(y);
+            for (int x = 0; x < templ.cols; x++) {
+                filterValues[y * templ.cols + x] = (float) ((templRow[x] - mean) / 255.0);
+            }
+        }
+    }
+
+    const uint32_t inputDimensions[] = { 1, (uint32_t) areaSize.height, (uint32_t) areaSize.width, 1 };
+    const uint32_t filterDimensions[] = {
+            filterCount, (uint32_t) templateSize.height, (uint32_t) templateSize.width, 1 };
+    const uint32_t biasDimensions[] = { filterCount };
+    const uint32_t outputDimensions[] = {
+            1, (uint32_t) (areaSize.height - templateSize.height + 1),
+            (uint32_t) (areaSize.width - templateSize.width + 1), filterCount };
+    const ANeuralNetworksOperandType inputType = { ANEURALNETWORKS_TENSOR_FLOAT32, 4, inputDimensions, 0.f, 0 };
+    const ANeuralNetworksOperandType filterType = { ANEURALNETWORKS_TENSOR_FLOAT32, 4, filterDimensions, 0.f, 0 };
+    const ANeuralNetworksOperandType biasType = { ANEURALNETWORKS_TENSOR_FLOAT32, 1, biasDimensions, 0.f, 0 };
+    const ANeuralNetworksOperandType scalarType = { ANEURALNETWORKS_INT32, 0, nullptr, 0.f, 0 };
+    const ANeuralNetworksOperandType outputType = { ANEURALNETWORKS_TENSOR_FLOAT32, 4, outputDimensions, 0.f, 0 };
+    const int32_t padding = ANEURALNETWORKS_PADDING_VALID;
+    const int32_t stride = 1;
+    const int32_t activation = ANEURALNETWORKS_FUSED_NONE;
+
+    // Operands: input, filters, biases, padding, horizontal and vertical strides, activation and output
+    const uint32_t convolutionInputs[] = { 0, 1, 2, 3, 4, 5, 6 };
+    const uint32_t modelInput = 0;
+    const uint32_t modelOutput = 7;
+    if (api.createModel(&compiled->model) != ANEURALNETWORKS_NO_ERROR) return nullptr;
+    const bool isModelCreated = api.addOperand(compiled->model, &inputType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &filterType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &biasType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &scalarType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &scalarType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &scalarType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &scalarType) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperand(compiled->model, &outputType) == ANEURALNETWORKS_NO_ERROR
+            && api.setOperandValue(compiled->model, 1, compiled->filters.data(),
+                                   compiled->filters.size() * sizeof(float)) == ANEURALNETWORKS_NO_ERROR
+            && api.setOperandValue(compiled->model, 2, compiled->biases.data(),
+                                   compiled->biases.size() * sizeof(float)) == ANEURALNETWORKS_NO_ERROR
+            && api.setOperandValue(compiled->model, 3, &padding, sizeof(padding)) == ANEURALNETWORKS_NO_ERROR
+            && api.setOperandValue(compiled->model, 4, &stride, sizeof(stride)) == ANEURALNETWORKS_NO_ERROR
+            && api.setOperandValue(compiled->model, 5, &stride, sizeof(stride)) == ANEURALNETWORKS_NO_ERROR
+            && api.setOperandValue(compiled->model, 6, &activation, sizeof(activation)) == ANEURALNETWORKS_NO_ERROR
+            && api.addOperation(compiled->model, ANEURALNETWORKS_CONV_2D, 7, convolutionInputs, 1, &modelOutput)
+                    == ANEURALNETWORKS_NO_ERROR
+            && api.identifyInputsAndOutputs(compiled->model, 1, &modelInput, 1, &modelOutput)
+                    == ANEURALNETWORKS_NO_ERROR
+            // The half floats are enough for the candidates, they are all correlated again in integers
+            && api.relaxComputationFloat32toFloat16(compiled->model, true) == ANEURALNETWORKS_NO_ERROR
+            && api.finishModel(compiled->model) == ANEURALNETWORKS_NO_ERROR;
+    if (!isModelCreated) return nullptr;
+
+    // Compiled for the accelerator only, failing if its driver can't compute the convolution
+    const bool isCompiled = api.createCompilationForDevices(compiled->model, &device, 1, &compiled->compilation)
+                    == ANEURALNETWORKS_NO_ERROR
+            && api.setCompilationPreference(compiled->compilation, ANEURALNETWORKS_PREFER_SUSTAINED_SPEED)
+                    == ANEURALNETWORKS_NO_ERROR
+            && api.finishCompilation(compiled->compilation) == ANEURALNETWORKS_NO_ERROR;
+    if (!isCompiled) return nullptr;
+
+    return compiled;
+}
+
+bool NnapiMatcher::execute(const CompiledModel& model, const cv::Mat& area, const cv::Size& templateSize) {
+    TRACE_SECTION("nnapiExecute");
+    const NeuralNetworksApi& api = getApi();
+
+    inputPixels.resize(area.total());
+    cv::Mat input(area.rows, area.cols, CV_32F, inputPixels.data());
+    area.convertTo(input, CV_32F, 1.0 / 255.0);
+
+    const int resultCols = area.cols - templateSize.width + 1;
+    const int resultRows = area.rows - templateSize.height + 1;
+    const auto filterCount = (int) modelJobs.size();
+    outputResults.resize((size_t) resultCols * resultRows * filterCount);
+
+    ANeuralNetworksExecution* execution = nullptr;
+    if (api.createExecution(model.compilation, &execution) != ANEURALNETWORKS_NO_ERROR) return false;
+    const bool isComputed = api.setExecutionInput(execution, 0, nullptr, inputPixels.data(),
+                                                  inputPixels.size() * sizeof(float)) == ANEURALNETWORKS_NO_ERROR
+            && api.setExecutionOutput(execution, 0, nullptr, outputResults.data(),
+                                      outputResults.size() * sizeof(float)) == ANEURALNETWORKS_NO_ERROR
+            && api.compute(execution) == ANEURALNETWORKS_NO_ERROR;
+    api.freeExecution(execution);
+    if (!isComputed) return false;
+
+    // Normalized as TM_CCOEFF_NORMED with the exact window statistics, only the correlation is approximated
+    cv::integral(area, areaSums, areaSquaredSums, CV_32S, CV_64F);
+    const double templArea = (double) templateSize.area();
+    for (int filter = 0; filter < filterCount; filter++) {
+        const TemplateStatistics& statistics = modelJobs[filter]->conditionTemplate->grayStatistics;
+        const double templMean = (double) statistics.getSum() / templArea;
+        cv::Mat& results = *modelJobs[filter]->results;
+
+        for (int y = 0; y < resultRows; y++) {
+            const int* sumsTop = areaSums.ptr<int>(y);
+            const int* sumsBottom = areaSums.ptr<int>(y + templateSize.height);
+            const auto* squaredSumsTop = areaSquaredSums.ptr<double>(y);
+            const auto* squaredSumsBottom = areaSquaredSums.ptr<double>(y + templateSize.height);
+            const float* output = outputResults.data() + (size_t) y * resultCols * filterCount + filter;
+            auto* row = results.ptr<float>(y);
+
+            for (int x = 0; x < resultCols; x++) {
+                const int64_t windowSum = (int64_t) sumsBottom[x + templateSize.width] - sumsBottom[x]
+                        - sumsTop[x + templateSize.width] + sumsTop[x];
+                const auto windowSquaredSum = (int64_t) (squaredSumsBottom[x + templateSize.width]
+                        - squaredSumsBottom[x] - squaredSumsTop[x + templateSize.width] + squaredSumsTop[x]);
+
+                const double correlation = (double) output[(size_t) x * filterCount] * 255.0 * 255.0
+                        + templMean * (double) windowSum;
+                row[x] = statistics.getNormedValue(
+                        (uint64_t) std::llround(std::max(correlation, 0.0)), windowSum, windowSquaredSum);
+            }
+        }
+    }
+
+    return true;
+}
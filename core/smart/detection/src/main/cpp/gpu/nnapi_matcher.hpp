@@ -0,0 +1,120 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KLICK_R_NNAPI_MATCHER_HPP
+#define KLICK_R_NNAPI_MATCHER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <android/NeuralNetworks.h>
+
+#include "../detection/match_backend.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * [MatchBackend] correlating all the conditions of a detection with the screen on a neural networks accelerator,
+     * with [matchBatch]. The conditions searched in the same area with the same template size are the filters of a
+     * single convolution, computed once per screen image for all of them by the NPU or GPU driver of NNAPI.
+     *
+     * The accelerators compute in half floats: the convolution results are an approximation of the correlation, only
+     * used to find the candidates. Normalized with the exact window statistics, each position close enough to the
+     * minimum confidence is then correlated again in integers by [match], so all results above it are exact, and
+     * the candidates are verified by the color checks of the detector as for the other backends.
+     *
+     * The compiled models are kept between the detections, for each set of conditions. NNAPI is loaded at runtime,
+     * and the matcher is only available on the devices with an accelerator driver, since Android 10.
+     */
+    class NnapiMatcher : public MatchBackend {
+
+    private:
+        static constexpr char const* LOG_TAG = "NnapiMatcher";
+
+        /** Maximum area of a template. Above, its correlation with normalized pixels overflows the half floats. */
+        static constexpr int MAX_TEMPLATE_AREA = 64 * 64;
+        /** Maximum size of the results of a convolution, in floats. Above, its conditions are split. */
+        static constexpr size_t MAX_OUTPUT_SIZE = 16 * 1024 * 1024;
+        /** Maximum number of conditions of a convolution, its filters count. */
+        static constexpr int MAX_FILTER_COUNT = 32;
+        /** Maximum number of compiled models. Above, they are all released before the next matching. */
+        static constexpr size_t MAX_COMPILED_MODELS = 32;
+        /**
+         * Maximum difference between the approximated confidence of a position and its exact one. The positions
+         * approximated above the minimum confidence minus this margin are correlated again.
+         */
+        static constexpr float APPROXIMATION_MARGIN = 0.05f;
+
+        /** A convolution of the conditions searched in the same area with the same template size, compiled. */
+        struct CompiledModel {
+            ANeuralNetworksModel* model = nullptr;
+            ANeuralNetworksCompilation* compilation = nullptr;
+            /** The zero mean templates, filter by filter. Referenced by the model, kept as long as it is. */
+            std::vector<float> filters;
+            /** The zero biases of the filters. Referenced by the model, kept as long as it is. */
+            std::vector<float> biases;
+
+            ~CompiledModel();
+        };
+
+        /** The accelerator compiling and executing the models. */
+        ANeuralNetworksDevice* device = nullptr;
+        /** The compiled models, by hash of their area size and conditions contents. */
+        std::unordered_map<uint64_t, std::unique_ptr<CompiledModel>> compiledModels;
+
+        /** The jobs of a convolution. Kept between the matchings to avoid allocations. */
+        std::vector<Job*> modelJobs;
+        /** The normalized pixels of the area of a convolution. */
+        std::vector<float> inputPixels;
+        /** The results of a convolution, interleaved by filter. */
+        std::vector<float> outputResults;
+        /** The integral images of the area of a convolution. */
+        cv::Mat areaSums;
+        cv::Mat areaSquaredSums;
+
+        explicit NnapiMatcher(ANeuralNetworksDevice* device) : device(device) {}
+
+        /** @return the model of a convolution of the [modelJobs], compiling it if needed. Null if it can't be. */
+        const CompiledModel* getCompiledModel(const cv::Size& areaSize, const cv::Size& templateSize);
+        std::unique_ptr<CompiledModel> compileModel(const cv::Size& areaSize, const cv::Size& templateSize) const;
+
+        /** Execute the convolution of the [modelJobs] in their area, and set their normalized results. */
+        bool execute(const CompiledModel& model, const cv::Mat& area, const cv::Size& templateSize);
+
+    public:
+        /** @return the matcher on the first NNAPI accelerator, or null if there is none. */
+        static std::unique_ptr<NnapiMatcher> create();
+
+        ~NnapiMatcher() override = default;
+
+        MatchBackendType getType() const override { return MatchBackendType::NNAPI; }
+        const char* getName() const override { return "nnapi"; }
+        uint32_t getCapabilities() const override { return CAPABILITY_BATCH | CAPABILITY_PRUNED; }
+
+        /** @return true if the approximated results of the requested condition have been computed by [matchBatch]. */
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        /** @return the cost of copying the results computed by [matchBatch]. */
+        double getCost(const MatchRequest& request) const override;
+        /** Copy the approximated results, and correlate again the positions that might reach the min confidence. */
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+
+        bool matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) override;
+        bool isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const override;
+    };
+}
+
+#endif //KLICK_R_NNAPI_MATCHER_HPP
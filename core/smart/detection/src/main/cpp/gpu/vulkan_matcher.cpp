@@ -0,0 +1,455 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "vulkan_matcher.hpp"
+#include "../utils/log.h"
+#include "../utils/trace.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The SPIR-V of shaders/ccoeff_normed.comp, compiled by glslc at build time. */
+static const uint32_t CCOEFF_NORMED_SHADER[] =
+#include "ccoeff_normed.comp.inc"
+;
+
+/** Initial size of the buffers, allowing the descriptor set to be complete before the first dispatch. */
+static constexpr VkDeviceSize INITIAL_BUFFER_SIZE = 64 * 1024;
+/** Number of storage buffers bound to the shader. */
+static constexpr uint32_t BINDING_COUNT = 4;
+
+std::unique_ptr<VulkanMatcher> VulkanMatcher::create() {
+    std::unique_ptr<VulkanMatcher> matcher(new VulkanMatcher());
+    if (!matcher->initialize()) {
+        LOGW(LOG_TAG, "No Vulkan compute device available");
+        return nullptr;
+    }
+
+    return matcher;
+}
+
+VulkanMatcher::~VulkanMatcher() {
+    if (device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(device);
+
+        releaseBuffer(screenBuffer);
+        releaseBuffer(templatesBuffer);
+        releaseBuffer(jobsBuffer);
+        releaseBuffer(resultsBuffer);
+
+        if (fence != VK_NULL_HANDLE) vkDestroyFence(device, fence, nullptr);
+        if (commandPool != VK_NULL_HANDLE) vkDestroyCommandPool(device, commandPool, nullptr);
+        if (descriptorPool != VK_NULL_HANDLE) vkDestroyDescriptorPool(device, descriptorPool, nullptr);
+        if (pipeline != VK_NULL_HANDLE) vkDestroyPipeline(device, pipeline, nullptr);
+        if (pipelineLayout != VK_NULL_HANDLE) vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
+        if (descriptorSetLayout != VK_NULL_HANDLE) vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+        vkDestroyDevice(device, nullptr);
+    }
+
+    if (instance != VK_NULL_HANDLE) vkDestroyInstance(instance, nullptr);
+}
+
+bool VulkanMatcher::initialize() {
+    VkApplicationInfo applicationInfo = {};
+    applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    applicationInfo.pApplicationName = "smartautoclicker";
+    applicationInfo.apiVersion = VK_API_VERSION_1_0;
+
+    VkInstanceCreateInfo instanceInfo = {};
+    instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instanceInfo.pApplicationInfo = &applicationInfo;
+    if (vkCreateInstance(&instanceInfo, nullptr, &instance) != VK_SUCCESS) return false;
+
+    // The first device with a compute queue, usually the only GPU of the phone
+    uint32_t deviceCount = 0;
+    vkEnumeratePhysicalDevices(instance, &deviceCount, nullptr);
+    std::vector<VkPhysicalDevice> physicalDevices(deviceCount);
+    vkEnumeratePhysicalDevices(instance, &deviceCount, physicalDevices.data());
+    for (VkPhysicalDevice candidate : physicalDevices) {
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(candidate, &familyCount, families.data());
+
+        for (uint32_t i = 0; i < familyCount && physicalDevice == VK_NULL_HANDLE; i++) {
+            if (families[i].queueFlags & VK_QUEUE_COMPUTE_BIT) {
+                physicalDevice = candidate;
+                queueFamilyIndex = i;
+            }
+        }
+        if (physicalDevice != VK_NULL_HANDLE) break;
+    }
+    if (physicalDevice == VK_NULL_HANDLE) return false;
+
+    const float queuePriority = 1.f;
+    VkDeviceQueueCreateInfo queueInfo = {};
+    queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queueInfo.queueFamilyIndex = queueFamilyIndex;
+    queueInfo.queueCount = 1;
+    queueInfo.pQueuePriorities = &queuePriority;
+
+    VkDeviceCreateInfo deviceInfo = {};
+    deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    deviceInfo.queueCreateInfoCount = 1;
+    deviceInfo.pQueueCreateInfos = &queueInfo;
+    if (vkCreateDevice(physicalDevice, &deviceInfo, nullptr, &device) != VK_SUCCESS) return false;
+    vkGetDeviceQueue(device, queueFamilyIndex, 0, &queue);
+
+    if (!createPipeline()) return false;
+
+    VkCommandPoolCreateInfo commandPoolInfo = {};
+    commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    commandPoolInfo.queueFamilyIndex = queueFamilyIndex;
+    if (vkCreateCommandPool(device, &commandPoolInfo, nullptr, &commandPool) != VK_SUCCESS) return false;
+
+    VkCommandBufferAllocateInfo commandBufferInfo = {};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    commandBufferInfo.commandPool = commandPool;
+    commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    commandBufferInfo.commandBufferCount = 1;
+    if (vkAllocateCommandBuffers(device, &commandBufferInfo, &commandBuffer) != VK_SUCCESS) return false;
+
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    if (vkCreateFence(device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) return false;
+
+    return reserveBuffer(screenBuffer, INITIAL_BUFFER_SIZE, 0)
+        && reserveBuffer(templatesBuffer, INITIAL_BUFFER_SIZE, 1)
+        && reserveBuffer(jobsBuffer, INITIAL_BUFFER_SIZE, 2)
+        && reserveBuffer(resultsBuffer, INITIAL_BUFFER_SIZE, 3);
+}
+
+bool VulkanMatcher::createPipeline() {
+    VkDescriptorSetLayoutBinding bindings[BINDING_COUNT] = {};
+    for (uint32_t i = 0; i < BINDING_COUNT; i++) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+
+    VkDescriptorSetLayoutCreateInfo setLayoutInfo = {};
+    setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    setLayoutInfo.bindingCount = BINDING_COUNT;
+    setLayoutInfo.pBindings = bindings;
+    if (vkCreateDescriptorSetLayout(device, &setLayoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkPushConstantRange pushConstantRange = {};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(uint32_t);
+
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) return false;
+
+    VkShaderModuleCreateInfo shaderInfo = {};
+    shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    shaderInfo.codeSize = sizeof(CCOEFF_NORMED_SHADER);
+    shaderInfo.pCode = CCOEFF_NORMED_SHADER;
+    VkShaderModule shaderModule = VK_NULL_HANDLE;
+    if (vkCreateShaderModule(device, &shaderInfo, nullptr, &shaderModule) != VK_SUCCESS) return false;
+
+    VkComputePipelineCreateInfo pipelineInfo = {};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    pipelineInfo.stage.module = shaderModule;
+    pipelineInfo.stage.pName = "main";
+    pipelineInfo.layout = pipelineLayout;
+    VkResult pipelineResult = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &pipeline);
+    vkDestroyShaderModule(device, shaderModule, nullptr);
+    if (pipelineResult != VK_SUCCESS) return false;
+
+    VkDescriptorPoolSize poolSize = {};
+    poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    poolSize.descriptorCount = BINDING_COUNT;
+
+    VkDescriptorPoolCreateInfo poolInfo = {};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) return false;
+
+    VkDescriptorSetAllocateInfo setInfo = {};
+    setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    setInfo.descriptorPool = descriptorPool;
+    setInfo.descriptorSetCount = 1;
+    setInfo.pSetLayouts = &descriptorSetLayout;
+    return vkAllocateDescriptorSets(device, &setInfo, &descriptorSet) == VK_SUCCESS;
+}
+
+int VulkanMatcher::findMemoryType(uint32_t memoryTypeBits) const {
+    VkPhysicalDeviceMemoryProperties properties;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &properties);
+
+    // Device local memory if it can be mapped, as on the unified memory of the mobile GPUs
+    const VkMemoryPropertyFlags required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    for (VkMemoryPropertyFlags flags : { required | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, required }) {
+        for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+            if ((memoryTypeBits & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags) {
+                return (int) i;
+            }
+        }
+    }
+
+    return -1;
+}
+
+bool VulkanMatcher::reserveBuffer(Buffer& buffer, VkDeviceSize size, uint32_t binding) {
+    if (buffer.size >= size) return true;
+
+    // Grows by at least twice the previous size, limiting the number of creations
+    Buffer created;
+    created.size = std::max(size, buffer.size * 2);
+
+    VkBufferCreateInfo bufferInfo = {};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = created.size;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &created.buffer) != VK_SUCCESS) return false;
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, created.buffer, &requirements);
+    int memoryType = findMemoryType(requirements.memoryTypeBits);
+
+    VkMemoryAllocateInfo allocateInfo = {};
+    allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocateInfo.allocationSize = requirements.size;
+    allocateInfo.memoryTypeIndex = (uint32_t) memoryType;
+    void* mapped = nullptr;
+    if (memoryType < 0
+            || vkAllocateMemory(device, &allocateInfo, nullptr, &created.memory) != VK_SUCCESS
+            || vkBindBufferMemory(device, created.buffer, created.memory, 0) != VK_SUCCESS
+            || vkMapMemory(device, created.memory, 0, VK_WHOLE_SIZE, 0, &mapped) != VK_SUCCESS) {
+        releaseBuffer(created);
+        return false;
+    }
+    created.mapped = static_cast<uint8_t*>(mapped);
+
+    // The buffers are not used by the device between the dispatches, they can be replaced
+    if (buffer.mapped != nullptr) memcpy(created.mapped, buffer.mapped, buffer.size);
+    releaseBuffer(buffer);
+    buffer = created;
+
+    VkDescriptorBufferInfo descriptorBufferInfo = {};
+    descriptorBufferInfo.buffer = buffer.buffer;
+    descriptorBufferInfo.offset = 0;
+    descriptorBufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet descriptorWrite = {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = binding;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    descriptorWrite.pBufferInfo = &descriptorBufferInfo;
+    vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+
+    return true;
+}
+
+void VulkanMatcher::releaseBuffer(Buffer& buffer) {
+    if (buffer.mapped != nullptr) vkUnmapMemory(device, buffer.memory);
+    if (buffer.buffer != VK_NULL_HANDLE) vkDestroyBuffer(device, buffer.buffer, nullptr);
+    if (buffer.memory != VK_NULL_HANDLE) vkFreeMemory(device, buffer.memory, nullptr);
+    buffer = Buffer();
+}
+
+bool VulkanMatcher::isSupported(const MatchRequest& request, const MatchingContext& context) const {
+    return context.backendTemplate == request.condition && context.backendResults.size() == request.getResultsSize();
+}
+
+double VulkanMatcher::getCost(const MatchRequest& request) const {
+    return (double) request.getResultsSize().area();
+}
+
+void VulkanMatcher::match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const {
+    context.backendResults.copyTo(results);
+}
+
+bool VulkanMatcher::isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const {
+    return templateSize.area() > 0 && templateSize.area() <= MAX_TEMPLATE_AREA
+        && areaSize.width >= templateSize.width && areaSize.height >= templateSize.height;
+}
+
+bool VulkanMatcher::matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) {
+    TRACE_SECTION("vulkanMatch");
+    if (!uploadScreen(screenImage)) return false;
+
+    // The templates of the previous scenarios or screen metrics are not needed anymore. Not done while preparing the
+    // dispatch, as the templates of its previous jobs would be removed.
+    if (templatesSize > MAX_TEMPLATES_SIZE) {
+        LOGD(LOG_TAG, "Resident templates limit reached, removing %1$d templates", (int) residentTemplates.size());
+        residentTemplates.clear();
+        templatesSize = 0;
+    }
+
+    gpuJobs.clear();
+    uint32_t resultsCount = 0;
+    uint32_t maxResultCols = 0;
+    uint32_t maxResultRows = 0;
+    for (Job& job : jobs) {
+        const cv::Mat& templ = *job.conditionTemplate->image.scaledGray;
+        job.results->create(job.area.height - templ.rows + 1, job.area.width - templ.cols + 1, CV_32F);
+
+        // Same as OpenCv, a template without variance matches everywhere
+        const TemplateStatistics& statistics = job.conditionTemplate->grayStatistics;
+        if (statistics.isFlat()) {
+            job.results->setTo(1.f);
+            continue;
+        }
+
+        const ResidentTemplate* resident = getResidentTemplate(*job.conditionTemplate);
+        if (resident == nullptr) return false;
+
+        GpuJob gpuJob = {};
+        gpuJob.areaX = (uint32_t) job.area.x;
+        gpuJob.areaY = (uint32_t) job.area.y;
+        gpuJob.resultCols = (uint32_t) job.results->cols;
+        gpuJob.resultRows = (uint32_t) job.results->rows;
+        gpuJob.templateOffset = resident->offset;
+        gpuJob.templateCols = (uint32_t) templ.cols;
+        gpuJob.templateRows = (uint32_t) templ.rows;
+        gpuJob.templateStride = resident->stride;
+        gpuJob.resultsOffset = resultsCount;
+        gpuJob.templateSum = (uint32_t) statistics.getSum();
+        gpuJob.templateScaledNorm = (float) statistics.getScaledNorm();
+        gpuJobs.push_back(gpuJob);
+
+        resultsCount += gpuJob.resultCols * gpuJob.resultRows;
+        maxResultCols = std::max(maxResultCols, gpuJob.resultCols);
+        maxResultRows = std::max(maxResultRows, gpuJob.resultRows);
+    }
+    if (gpuJobs.empty()) return true;
+
+    if (!reserveBuffer(jobsBuffer, gpuJobs.size() * sizeof(GpuJob), 2)
+            || !reserveBuffer(resultsBuffer, resultsCount * sizeof(float), 3)) {
+        return false;
+    }
+    memcpy(jobsBuffer.mapped, gpuJobs.data(), gpuJobs.size() * sizeof(GpuJob));
+
+    if (!dispatch(maxResultCols, maxResultRows)) return false;
+
+    // The flat templates are not in the dispatch, the jobs order is the same otherwise
+    auto gpuJob = gpuJobs.begin();
+    for (Job& job : jobs) {
+        if (job.conditionTemplate->grayStatistics.isFlat()) continue;
+
+        const cv::Mat results(job.results->rows, job.results->cols, CV_32F,
+                              resultsBuffer.mapped + gpuJob->resultsOffset * sizeof(float));
+        results.copyTo(*job.results);
+        gpuJob++;
+    }
+
+    return true;
+}
+
+bool VulkanMatcher::uploadScreen(const DetectionImage& screenImage) {
+    if (screenImage.frameIndex != 0 && screenImage.frameIndex == screenFrameIndex) return true;
+
+    // The rows are aligned on the packed values, allowing them to be copied directly
+    const cv::Mat& scaledGray = *screenImage.scaledGray;
+    const auto stride = (uint32_t) ((scaledGray.cols + 3) & ~3);
+    if (!reserveBuffer(screenBuffer, (VkDeviceSize) stride * scaledGray.rows, 0)) return false;
+
+    for (int y = 0; y < scaledGray.rows; y++) {
+        memcpy(screenBuffer.mapped + (size_t) y * stride, scaledGray.ptr<uint8_t>(y), scaledGray.cols);
+    }
+    screenStride = stride;
+    screenFrameIndex = screenImage.frameIndex;
+
+    return true;
+}
+
+const VulkanMatcher::ResidentTemplate* VulkanMatcher::getResidentTemplate(const ConditionTemplate& conditionTemplate) {
+    auto resident = residentTemplates.find(conditionTemplate.contentHash);
+    if (resident != residentTemplates.end()) return &resident->second;
+
+    const cv::Mat& templ = *conditionTemplate.image.scaledGray;
+    const auto stride = (uint32_t) ((templ.cols + 3) & ~3);
+    const VkDeviceSize size = (VkDeviceSize) stride * templ.rows;
+    if (!reserveBuffer(templatesBuffer, templatesSize + size, 1)) return nullptr;
+
+    ResidentTemplate uploaded = { (uint32_t) templatesSize, stride };
+    for (int y = 0; y < templ.rows; y++) {
+        memcpy(templatesBuffer.mapped + uploaded.offset + (size_t) y * stride, templ.ptr<uint8_t>(y), templ.cols);
+    }
+    templatesSize += size;
+
+    return &(residentTemplates[conditionTemplate.contentHash] = uploaded);
+}
+
+bool VulkanMatcher::dispatch(uint32_t maxResultCols, uint32_t maxResultRows) {
+    if (vkResetFences(device, 1, &fence) != VK_SUCCESS
+            || vkResetCommandBuffer(commandBuffer, 0) != VK_SUCCESS) {
+        return false;
+    }
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) return false;
+
+    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdBindDescriptorSets(
+            commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdPushConstants(
+            commandBuffer, pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(screenStride), &screenStride);
+    vkCmdDispatch(
+            commandBuffer,
+            (maxResultCols + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE,
+            (maxResultRows + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE,
+            (uint32_t) gpuJobs.size());
+
+    // The results are read by the host once the dispatch is done
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(
+            commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+            1, &barrier, 0, nullptr, 0, nullptr);
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) return false;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    if (vkQueueSubmit(queue, 1, &submitInfo, fence) != VK_SUCCESS) return false;
+
+    if (vkWaitForFences(device, 1, &fence, VK_TRUE, DISPATCH_TIMEOUT_NS) != VK_SUCCESS) {
+        LOGE_LIMITED(LOG_TAG, "Dispatch of %1$d jobs failed", (int) gpuJobs.size());
+        // The buffers can't be modified until the device is done with them
+        vkQueueWaitIdle(queue);
+        return false;
+    }
+
+    return true;
+}
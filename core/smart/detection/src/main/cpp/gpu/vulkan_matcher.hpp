@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_VULKAN_MATCHER_HPP
+#define KLICK_R_VULKAN_MATCHER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+#include "../detection/match_backend.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * [MatchBackend] computing the matching results with a Vulkan compute shader, for all conditions of a detection
+     * at once with [matchBatch]. The requests of those conditions then only copies their results.
+     *
+     * The scaled gray screen image is uploaded once per frame and the condition templates once per content, they
+     * are kept in the GPU memory between the detections. All jobs of a detection are computed in a single dispatch,
+     * waited by the calling thread.
+     *
+     * The buffers are host visible, preferably in device local memory: on the unified memory of the mobile GPUs,
+     * they are read by the shader without copies.
+     */
+    class VulkanMatcher : public MatchBackend {
+
+    private:
+        static constexpr char const* LOG_TAG = "VulkanMatcher";
+
+        /** Maximum area of a template. Above, its squared sums doesn't fit in the 32 bits of the shader. */
+        static constexpr int MAX_TEMPLATE_AREA = 256 * 256;
+        /**
+         * Maximum size of the resident templates. Above, they are all removed before the next dispatch, and uploaded
+         * again when needed.
+         */
+        static constexpr VkDeviceSize MAX_TEMPLATES_SIZE = 16 * 1024 * 1024;
+        /** Size of the shader work groups, must be the same as the shader local size. */
+        static constexpr uint32_t WORK_GROUP_SIZE = 8;
+        /** Maximum duration of a dispatch. Above, the device is considered lost and the CPU is used. */
+        static constexpr uint64_t DISPATCH_TIMEOUT_NS = 1000000000;
+
+        /** A job in the shader jobs buffer, must be the same as the shader Job. */
+        struct GpuJob {
+            uint32_t areaX;
+            uint32_t areaY;
+            uint32_t resultCols;
+            uint32_t resultRows;
+            uint32_t templateOffset;
+            uint32_t templateCols;
+            uint32_t templateRows;
+            uint32_t templateStride;
+            uint32_t resultsOffset;
+            uint32_t templateSum;
+            float templateScaledNorm;
+            uint32_t padding;
+        };
+
+        /** A host visible storage buffer, mapped for its whole lifetime. */
+        struct Buffer {
+            VkBuffer buffer = VK_NULL_HANDLE;
+            VkDeviceMemory memory = VK_NULL_HANDLE;
+            VkDeviceSize size = 0;
+            uint8_t* mapped = nullptr;
+        };
+
+        /** A template resident in [templatesBuffer]. */
+        struct ResidentTemplate {
+            uint32_t offset;
+            uint32_t stride;
+        };
+
+        VkInstance instance = VK_NULL_HANDLE;
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkDevice device = VK_NULL_HANDLE;
+        VkQueue queue = VK_NULL_HANDLE;
+        uint32_t queueFamilyIndex = 0;
+
+        VkDescriptorSetLayout descriptorSetLayout = VK_NULL_HANDLE;
+        VkPipelineLayout pipelineLayout = VK_NULL_HANDLE;
+        VkPipeline pipeline = VK_NULL_HANDLE;
+        VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+        VkDescriptorSet descriptorSet = VK_NULL_HANDLE;
+        VkCommandPool commandPool = VK_NULL_HANDLE;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        VkFence fence = VK_NULL_HANDLE;
+
+        /** The screen scaled gray image, packed by 4 pixels. Bound at index 0 of the shader. */
+        Buffer screenBuffer = Buffer();
+        /** The resident templates, packed by 4 pixels. Bound at index 1 of the shader. */
+        Buffer templatesBuffer = Buffer();
+        /** The [GpuJob] of the dispatch. Bound at index 2 of the shader. */
+        Buffer jobsBuffer = Buffer();
+        /** The results of all jobs of the dispatch, in float. Bound at index 3 of the shader. */
+        Buffer resultsBuffer = Buffer();
+
+        /** The frame index of the screen image in [screenBuffer]. 0 if none. */
+        uint64_t screenFrameIndex = 0;
+        /** Size of a row of [screenBuffer], in bytes. */
+        uint32_t screenStride = 0;
+        /** The templates in [templatesBuffer], by content hash. */
+        std::unordered_map<uint64_t, ResidentTemplate> residentTemplates;
+        /** Size of the used part of [templatesBuffer], in bytes. */
+        VkDeviceSize templatesSize = 0;
+        /** The jobs of the dispatch. Kept between the dispatches to avoid allocations. */
+        std::vector<GpuJob> gpuJobs;
+
+        VulkanMatcher() = default;
+
+        /** Create the Vulkan device and the shader pipeline. @return false if there is no usable device. */
+        bool initialize();
+        bool createPipeline();
+        int findMemoryType(uint32_t memoryTypeBits) const;
+
+        /**
+         * Ensure a buffer is at least of the given size, creating it again if needed and keeping its content.
+         * @return false if the buffer can't be created.
+         */
+        bool reserveBuffer(Buffer& buffer, VkDeviceSize size, uint32_t binding);
+        void releaseBuffer(Buffer& buffer);
+
+        bool uploadScreen(const DetectionImage& screenImage);
+        /** @return the template in [templatesBuffer], uploading it if needed. Null if it can't be uploaded. */
+        const ResidentTemplate* getResidentTemplate(const ConditionTemplate& conditionTemplate);
+        bool dispatch(uint32_t maxResultCols, uint32_t maxResultRows);
+
+    public:
+        /** @return the matcher on the first device with compute capabilities, or null if there is none. */
+        static std::unique_ptr<VulkanMatcher> create();
+
+        ~VulkanMatcher() override;
+
+        MatchBackendType getType() const override { return MatchBackendType::VULKAN; }
+        const char* getName() const override { return "vulkan"; }
+        uint32_t getCapabilities() const override { return CAPABILITY_BATCH; }
+
+        /** @return true if the results of the requested condition have been computed by [matchBatch]. */
+        bool isSupported(const MatchRequest& request, const MatchingContext& context) const override;
+        /** @return the cost of copying the results computed by [matchBatch]. */
+        double getCost(const MatchRequest& request) const override;
+        void match(const MatchRequest& request, MatchingContext& context, cv::Mat& results) const override;
+
+        bool matchBatch(const DetectionImage& screenImage, std::vector<Job>& jobs) override;
+        bool isBatchSupported(const cv::Size& areaSize, const cv::Size& templateSize) const override;
+    };
+}
+
+#endif //KLICK_R_VULKAN_MATCHER_HPP
@@ -16,28 +16,32 @@
  */
 
 #include "detection_result.hpp"
+#include "../utils/log.h"
 
 using namespace smartautoclicker;
 
+/** Tag for the Android logcat. */
+static constexpr char const* LOG_TAG = "DetectionResult";
+
 
 void DetectionResult::onAttachedToJavaObject(JNIEnv *env) {
-    methodSetResults = env->GetMethodID(globalClass, "setResults", "(ZIID)V");
+    // The buffer is held by the java detector, its address remains valid until detached
+    if (env->GetDirectBufferCapacity(globalObject) < (jlong) sizeof(DetectionResultRecord)) {
+        LOGE(LOG_TAG, "Invalid result buffer, results will not be reported");
+        return;
+    }
+    record = static_cast<DetectionResultRecord*>(env->GetDirectBufferAddress(globalObject));
 }
 
 void DetectionResult::onDetachedFromJavaObject() {
-    methodSetResults = nullptr;
+    record = nullptr;
 }
 
-void DetectionResult::setResults(JNIEnv *env, bool detected, double centerX, double centerY, double maxVal) {
-    if (!methodSetResults) return;
+void DetectionResult::setResults(JNIEnv *env, bool detected, double centerX, double centerY, double maxVal,
+                                 bool degraded, int angle) {
+    if (record == nullptr) return;
 
-    env->CallVoidMethod(
-            globalObject,
-            methodSetResults,
-            detected,
-            (int) centerX,
-            (int) centerY,
-            maxVal);
+    record->set(detected, centerX, centerY, maxVal, degraded, angle);
 }
 
 void DetectionResult::clearResults(JNIEnv *env) {
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DETECTION_RESULTS
+#define KLICK_R_DETECTION_RESULTS
+
+#include <cstdint>
+#include <jni.h>
+#include "jni_java_wrapper.hpp"
+#include "../types/condition_result.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The result of a condition detection, as read by the java code from a direct ByteBuffer in native order.
+     * Must match the layout in DetectionResultBuffer.kt.
+     */
+    struct DetectionResultRecord {
+        /** Set in [flags] when the matching have been degraded to stay in its time budget. */
+        static constexpr int32_t FLAG_DEGRADED = 1;
+        /** The [ConditionResult::angle] is kept in the bits of [flags] above this one. */
+        static constexpr int32_t FLAGS_ANGLE_SHIFT = 16;
+
+        int32_t isDetected;
+        int32_t centerX;
+        int32_t centerY;
+        int32_t flags;
+        double confidenceRate;
+        int64_t detectionNanos;
+
+        void set(bool detected, double x, double y, double maxVal, bool degraded = false, int angle = 0) {
+            isDetected = detected ? 1 : 0;
+            centerX = (int32_t) x;
+            centerY = (int32_t) y;
+            flags = (degraded ? FLAG_DEGRADED : 0) | (int32_t) angle << FLAGS_ANGLE_SHIFT;
+            confidenceRate = maxVal;
+            detectionNanos = 0;
+        }
+
+        void set(const ConditionResult& result) {
+            set(result.isDetected, result.centerX, result.centerY, result.confidenceRate, result.isDegraded,
+                result.angle);
+            detectionNanos = result.detectionNanos;
+        }
+    };
+    static_assert(sizeof(DetectionResultRecord) == 32, "DetectionResultRecord layout must match the java one");
+
+    /** The result of the last single condition detection, written into the direct ByteBuffer of the java detector. */
+    class DetectionResult: public JniJavaWrapper {
+
+    private:
+        DetectionResultRecord* record = nullptr;
+
+    public:
+        void onAttachedToJavaObject(JNIEnv *env) override;
+        void onDetachedFromJavaObject() override;
+
+        void setResults(JNIEnv *env, bool detected, double centerX, double centerY, double maxVal,
+                        bool degraded = false, int angle = 0);
+        void clearResults(JNIEnv *env);
+    };
+}
+
+#endif //KLICK_R_DETECTION_RESULTS
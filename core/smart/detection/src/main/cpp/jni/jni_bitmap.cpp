@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utility>
+
+#include "jni_bitmap.hpp"
+#include "jni_registry.hpp"
+
+using namespace smartautoclicker;
+
+
+bool LockedBitmap::readInfo(JNIEnv *env, jobject bitmap, AndroidBitmapInfo& result) {
+    if (bitmap == nullptr
+            || AndroidBitmap_getInfo(env, bitmap, &result) < 0
+            || result.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+        env->ThrowNew(JniRegistry::getExceptionClass(), "Android Bitmap exception in JNI code {readInfo}");
+        return false;
+    }
+
+    return true;
+}
+
+LockedBitmap::LockedBitmap(LockedBitmap&& other) noexcept :
+        env(std::exchange(other.env, nullptr)),
+        bitmap(std::exchange(other.bitmap, nullptr)),
+        pixels(std::exchange(other.pixels, PixelsBuffer())) {}
+
+LockedBitmap& LockedBitmap::operator=(LockedBitmap&& other) noexcept {
+    if (this == &other) return *this;
+
+    unlock();
+    env = std::exchange(other.env, nullptr);
+    bitmap = std::exchange(other.bitmap, nullptr);
+    pixels = std::exchange(other.pixels, PixelsBuffer());
+    return *this;
+}
+
+bool LockedBitmap::lock(JNIEnv *jniEnv, jobject lockedBitmap) {
+    unlock();
+
+    AndroidBitmapInfo info;
+    if (!readInfo(jniEnv, lockedBitmap, info)) return false;
+
+    void* bitmapPixels = nullptr;
+    if (AndroidBitmap_lockPixels(jniEnv, lockedBitmap, &bitmapPixels) < 0 || bitmapPixels == nullptr) {
+        jniEnv->ThrowNew(JniRegistry::getExceptionClass(), "Android Bitmap exception in JNI code {lockPixels}");
+        return false;
+    }
+
+    env = jniEnv;
+    bitmap = lockedBitmap;
+    pixels.pixels = static_cast<uint8_t*>(bitmapPixels);
+    pixels.width = (int) info.width;
+    pixels.height = (int) info.height;
+    pixels.rowStride = info.stride;
+    return true;
+}
+
+void LockedBitmap::unlock() {
+    if (bitmap == nullptr) return;
+
+    AndroidBitmap_unlockPixels(env, bitmap);
+    env = nullptr;
+    bitmap = nullptr;
+    pixels = PixelsBuffer();
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_JNI_BITMAP_HPP
+#define KLICK_R_JNI_BITMAP_HPP
+
+#include <jni.h>
+#include <android/bitmap.h>
+
+#include "../types/pixels_buffer.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * The pixels of an Android bitmap, locked for the lifetime of this object or until [unlock] is called.
+     * The bitmap reference is not owned, it must remain valid while the pixels are locked.
+     */
+    class LockedBitmap {
+
+    private:
+        JNIEnv* env = nullptr;
+        jobject bitmap = nullptr;
+        PixelsBuffer pixels = PixelsBuffer();
+
+    public:
+        /**
+         * Read the info of a bitmap, checking it is a RGBA 8888 one.
+         * @return true if the info are valid, false if not. An exception is thrown in that case.
+         */
+        static bool readInfo(JNIEnv *env, jobject bitmap, AndroidBitmapInfo& result);
+
+        LockedBitmap() = default;
+        ~LockedBitmap() { unlock(); }
+
+        LockedBitmap(const LockedBitmap&) = delete;
+        LockedBitmap& operator=(const LockedBitmap&) = delete;
+        LockedBitmap(LockedBitmap&& other) noexcept;
+        LockedBitmap& operator=(LockedBitmap&& other) noexcept;
+
+        /**
+         * Lock the pixels of a bitmap, unlocking the previous one.
+         * @return true if the pixels are locked, false if not. An exception is thrown in that case.
+         */
+        bool lock(JNIEnv *env, jobject bitmap);
+
+        /** Unlock the pixels, if they are locked. */
+        void unlock();
+
+        /** @return the locked pixels, or nullptr if they are not locked. */
+        const PixelsBuffer* getPixels() const { return bitmap != nullptr ? &pixels : nullptr; }
+    };
+}
+
+#endif //KLICK_R_JNI_BITMAP_HPP
@@ -0,0 +1,509 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+
+#include "jni_detector.hpp"
+#include "jni_registry.hpp"
+
+using namespace smartautoclicker;
+
+/** @return the content of a java string, empty if it is null. */
+static std::string toString(JNIEnv *env, jstring text) {
+    if (text == nullptr) return {};
+
+    const char* chars = env->GetStringUTFChars(text, nullptr);
+    std::string result(chars);
+    env->ReleaseStringUTFChars(text, chars);
+    return result;
+}
+
+/** @return the content of a java string in an array, empty if it is null. */
+static std::string toString(JNIEnv *env, jobjectArray texts, jint index) {
+    auto text = (jstring) env->GetObjectArrayElement(texts, index);
+    std::string result = toString(env, text);
+    if (text != nullptr) env->DeleteLocalRef(text);
+    return result;
+}
+
+
+void JniDetector::initialize(JNIEnv *env, jobject resultBuffer) {
+    detectionResult.attachToJavaObject(env, resultBuffer);
+    detector.initialize();
+}
+
+void JniDetector::release(JNIEnv *env) {
+    closeScreenReader();
+    detector.release();
+    detectionResult.detachFromJavaObject(env);
+}
+
+void JniDetector::setScreenMetrics(JNIEnv *env, jstring metricsTag, jobject screenBitmap, double detectionQuality) {
+    AndroidBitmapInfo bitmapInfo;
+    if (!LockedBitmap::readInfo(env, screenBitmap, bitmapInfo)) return;
+
+    setScreenMetrics(env, metricsTag, (int) bitmapInfo.width, (int) bitmapInfo.height, detectionQuality);
+}
+
+void JniDetector::setScreenMetrics(JNIEnv *env, jstring metricsTag, int width, int height, double detectionQuality) {
+    detector.setScreenMetrics(toString(env, metricsTag), width, height, detectionQuality);
+}
+
+bool JniDetector::setScreenImage(JNIEnv *env, jobject screenBitmap) {
+    // Copied by the detector, the bitmap is only locked during the call
+    LockedBitmap lockedBitmap;
+    lockedBitmap.lock(env, screenBitmap);
+
+    const PixelsBuffer* pixels = lockedBitmap.getPixels();
+    return detector.copyScreenImage(pixels != nullptr ? *pixels : PixelsBuffer());
+}
+
+bool JniDetector::setScreenImage(JNIEnv *env, jobject screenBuffer, int width, int height, int rowStride,
+                                 int64_t frameId) {
+    return detector.setScreenImage(getBufferPixels(env, screenBuffer, width, height, rowStride), frameId);
+}
+
+bool JniDetector::prepareScreenImage(JNIEnv *env, jobject screenBuffer, int width, int height, int rowStride,
+                                     int64_t frameId) {
+    return detector.prepareScreenImage(getBufferPixels(env, screenBuffer, width, height, rowStride), frameId);
+}
+
+jobject JniDetector::openScreenReader(JNIEnv *env, int width, int height) {
+    closeScreenReader();
+    return screenReader.open(env, width, height);
+}
+
+void JniDetector::closeScreenReader() {
+    screenReader.close();
+    screenReaderPixels = PixelsBuffer();
+    screenReaderTimestampNs = 0;
+}
+
+int64_t JniDetector::acquireScreenReaderImage() {
+    if (!screenReader.acquireLatest(screenReaderPixels, screenReaderTimestampNs)) {
+        screenReaderPixels = PixelsBuffer();
+        screenReaderTimestampNs = 0;
+    }
+
+    return screenReaderTimestampNs;
+}
+
+bool JniDetector::setScreenReaderImage() {
+    return detector.setScreenImage(screenReaderPixels, screenReaderTimestampNs);
+}
+
+PixelsBuffer JniDetector::getBufferPixels(JNIEnv *env, jobject screenBuffer, int width, int height, int rowStride) {
+    auto* pixels = static_cast<uint8_t*>(env->GetDirectBufferAddress(screenBuffer));
+    jlong capacity = env->GetDirectBufferCapacity(screenBuffer);
+
+    // The last row might not be padded up to the stride
+    if (pixels == nullptr || width <= 0 || height <= 0 || rowStride < width * 4
+            || capacity < (jlong) rowStride * (height - 1) + width * 4) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(), "Invalid screen buffer in JNI code {setScreenImage}");
+        return {};
+    }
+
+    return { pixels, width, height, (size_t) rowStride };
+}
+
+const PixelsBuffer* JniDetector::lockConditionPixels(JNIEnv *env, jlong conditionId, jobject conditionBitmap,
+                                                     LockedBitmap& lockedBitmap) const {
+
+    // Cached or packed templates are detected without their bitmap, it doesn't need to be locked
+    if (conditionBitmap == nullptr || !detector.isConditionPixelsNeeded(conditionId)) return nullptr;
+
+    lockedBitmap.lock(env, conditionBitmap);
+    return lockedBitmap.getPixels();
+}
+
+void JniDetector::detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, int threshold) {
+    LockedBitmap lockedBitmap;
+    const PixelsBuffer* pixels = lockConditionPixels(env, conditionId, conditionBitmap, lockedBitmap);
+    publishResult(env, detector.detectCondition(conditionId, pixels, threshold));
+}
+
+void JniDetector::detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, jstring identifying) {
+    LockedBitmap lockedBitmap;
+    const PixelsBuffer* pixels = lockConditionPixels(env, conditionId, conditionBitmap, lockedBitmap);
+    publishResult(env, detector.detectCondition(conditionId, pixels, toString(env, identifying)));
+}
+
+void JniDetector::detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, const cv::Rect& roi,
+                                  int threshold) {
+
+    LockedBitmap lockedBitmap;
+    const PixelsBuffer* pixels = lockConditionPixels(env, conditionId, conditionBitmap, lockedBitmap);
+    publishResult(env, detector.detectCondition(conditionId, pixels, roi, threshold));
+}
+
+void JniDetector::detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, const cv::Rect& roi,
+                                  jstring identifying) {
+
+    LockedBitmap lockedBitmap;
+    const PixelsBuffer* pixels = lockConditionPixels(env, conditionId, conditionBitmap, lockedBitmap);
+    publishResult(env, detector.detectCondition(conditionId, pixels, roi, toString(env, identifying)));
+}
+
+int JniDetector::detectAllOccurrences(JNIEnv *env, jlong conditionId, jobject conditionBitmap, const cv::Rect& roi,
+                                      int threshold, jobject results) {
+
+    // Verified before detecting, as the occurrences can't be reported otherwise
+    auto* records = static_cast<DetectionResultRecord*>(env->GetDirectBufferAddress(results));
+    const auto capacity = (jlong) (MATCHING_MAX_CANDIDATES * sizeof(DetectionResultRecord));
+    if (records == nullptr || env->GetDirectBufferCapacity(results) < capacity) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                      "Invalid results buffer in JNI code {detectAllOccurrences}");
+        return 0;
+    }
+
+    LockedBitmap lockedBitmap;
+    const PixelsBuffer* pixels = lockConditionPixels(env, conditionId, conditionBitmap, lockedBitmap);
+    const int count = detector.detectAllOccurrences(conditionId, pixels, roi, threshold, occurrenceResults);
+    for (int i = 0; i < count; i++) {
+        const ConditionResult& result = occurrenceResults[i];
+        records[i].set(result);
+    }
+
+    return count;
+}
+
+void JniDetector::detectConditionConcurrently(JNIEnv *env, jlong conditionId, const cv::Rect& roi, int threshold,
+                                              jobject result) const {
+
+    // Verified before detecting, as the result can't be reported otherwise
+    auto* record = static_cast<DetectionResultRecord*>(env->GetDirectBufferAddress(result));
+    if (record == nullptr || env->GetDirectBufferCapacity(result) < (jlong) sizeof(DetectionResultRecord)) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                      "Invalid result buffer in JNI code {detectConditionConcurrently}");
+        return;
+    }
+
+    const ConditionResult conditionResult = detector.detectConditionConcurrently(conditionId, roi, threshold);
+    record->set(conditionResult.isDetected, conditionResult.centerX, conditionResult.centerY,
+                conditionResult.confidenceRate);
+}
+
+int JniDetector::prepareTemplates(JNIEnv *env, jlongArray conditionIds, jobjectArray conditionBitmaps) {
+    const jint count = env->GetArrayLength(conditionIds);
+    if (env->GetArrayLength(conditionBitmaps) != count) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                      "Invalid bitmaps array in JNI code {prepareTemplates}");
+        return 0;
+    }
+
+    // All bitmaps needed are locked during the preparation, their pixels are processed concurrently
+    if (env->EnsureLocalCapacity(count) != JNI_OK) return 0;
+    templateIds.resize(count);
+    templatePixels.resize(count);
+    batchBitmaps.resize(count);
+    batchLockedBitmaps.resize(count);
+    env->GetLongArrayRegion(conditionIds, 0, count, reinterpret_cast<jlong*>(templateIds.data()));
+    for (jint i = 0; i < count; i++) {
+        batchBitmaps[i] = env->GetObjectArrayElement(conditionBitmaps, i);
+        templatePixels[i] = lockConditionPixels(env, templateIds[i], batchBitmaps[i], batchLockedBitmaps[i]);
+    }
+
+    const int readyCount = env->ExceptionCheck() ? 0 : detector.prepareTemplates(templateIds, templatePixels);
+    releaseBatchBitmaps(env, count);
+
+    return readyCount;
+}
+
+int JniDetector::prepareTemplateFiles(JNIEnv *env, jlongArray conditionIds, jobjectArray conditionPaths,
+                                      jintArray conditionSizes) {
+
+    const jint count = env->GetArrayLength(conditionIds);
+    if (env->GetArrayLength(conditionPaths) != count || env->GetArrayLength(conditionSizes) != count * 2) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                      "Invalid paths or sizes array in JNI code {prepareTemplateFiles}");
+        return 0;
+    }
+
+    templateIds.resize(count);
+    templatePaths.resize(count);
+    templateSizes.resize(count);
+    env->GetLongArrayRegion(conditionIds, 0, count, reinterpret_cast<jlong*>(templateIds.data()));
+    jint* sizes = env->GetIntArrayElements(conditionSizes, nullptr);
+    for (jint i = 0; i < count; i++) {
+        templatePaths[i] = toString(env, conditionPaths, i);
+        templateSizes[i] = cv::Size(sizes[i * 2], sizes[i * 2 + 1]);
+    }
+    env->ReleaseIntArrayElements(conditionSizes, sizes, JNI_ABORT);
+
+    return detector.prepareTemplateFiles(templateIds, templatePaths, templateSizes);
+}
+
+void JniDetector::removeTemplates(JNIEnv *env, jlongArray conditionIds) {
+    const jint count = env->GetArrayLength(conditionIds);
+    templateIds.resize(count);
+    env->GetLongArrayRegion(conditionIds, 0, count, reinterpret_cast<jlong*>(templateIds.data()));
+
+    detector.removeTemplates(templateIds);
+}
+
+void JniDetector::setIdleTemplates(JNIEnv *env, jlongArray conditionIds) {
+    const jint count = env->GetArrayLength(conditionIds);
+    templateIds.resize(count);
+    env->GetLongArrayRegion(conditionIds, 0, count, reinterpret_cast<jlong*>(templateIds.data()));
+
+    detector.setIdleTemplates(templateIds);
+}
+
+void JniDetector::setConditionRotations(JNIEnv *env, jlongArray conditionIds, jintArray rotationCounts) {
+    // Each condition has its rotation count, a mismatch means the Kotlin side built the arrays wrong
+    const jint count = env->GetArrayLength(conditionIds);
+    if (env->GetArrayLength(rotationCounts) != count) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                      "Invalid conditions in JNI code {setConditionRotations}");
+        return;
+    }
+
+    templateIds.resize(count);
+    env->GetLongArrayRegion(conditionIds, 0, count, reinterpret_cast<jlong*>(templateIds.data()));
+    std::vector<int> counts(count);
+    env->GetIntArrayRegion(rotationCounts, 0, count, reinterpret_cast<jint*>(counts.data()));
+
+    detector.setConditionRotations(templateIds, counts);
+}
+
+void JniDetector::setConditionMetrics(JNIEnv *env, jlongArray conditionIds, jintArray metrics) {
+    // Each condition has its metric, a mismatch means the Kotlin side built the arrays wrong
+    const jint count = env->GetArrayLength(conditionIds);
+    if (env->GetArrayLength(metrics) != count) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                      "Invalid conditions in JNI code {setConditionMetrics}");
+        return;
+    }
+
+    templateIds.resize(count);
+    env->GetLongArrayRegion(conditionIds, 0, count, reinterpret_cast<jlong*>(templateIds.data()));
+    std::vector<int> conditionMetrics(count);
+    env->GetIntArrayRegion(metrics, 0, count, reinterpret_cast<jint*>(conditionMetrics.data()));
+
+    detector.setConditionMetrics(templateIds, conditionMetrics);
+}
+
+int JniDetector::detectBatch(JNIEnv *env, jint count, jlongArray conditionIds, jobjectArray conditionBitmaps,
+                             jintArray conditionParams, jobjectArray identifyings, jobjectArray ocrLanguages,
+                             jobjectArray ocrWhitelists, jint conditionOperator, jobject results) {
+
+    // Verified before detecting, as the conditions can't be reported otherwise
+    auto* records = static_cast<DetectionResultRecord*>(env->GetDirectBufferAddress(results));
+    if (records == nullptr || env->GetDirectBufferCapacity(results) < (jlong) (count * sizeof(DetectionResultRecord))) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(), "Invalid results buffer in JNI code {detectBatch}");
+        return 0;
+    }
+    // The conditions arrays are read up to count, a shorter one would be read out of its bounds
+    if (count < 0 || env->GetArrayLength(conditionIds) < count
+            || env->GetArrayLength(conditionBitmaps) < count
+            || env->GetArrayLength(conditionParams) < count * BATCH_PARAMS_STRIDE
+            || env->GetArrayLength(identifyings) < count
+            || env->GetArrayLength(ocrLanguages) < count
+            || env->GetArrayLength(ocrWhitelists) < count) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(), "Invalid conditions in JNI code {detectBatch}");
+        return 0;
+    }
+    if (env->EnsureLocalCapacity(count) != JNI_OK) return 0;
+
+    jlong* ids = env->GetLongArrayElements(conditionIds, nullptr);
+    jint* params = env->GetIntArrayElements(conditionParams, nullptr);
+
+    // Sized first, the requests points on the texts and locked pixels
+    batchRequests.resize(count);
+    batchIdentifyings.resize(count);
+    batchOcrOptions.resize(count);
+    batchBitmaps.resize(count);
+    batchLockedBitmaps.resize(count);
+    for (jint i = 0; i < count; i++) {
+        DetectionRequest& request = batchRequests[i];
+        readRequest(env, i, ids, params, identifyings, ocrLanguages, ocrWhitelists, request, batchIdentifyings[i],
+                    batchOcrOptions[i]);
+
+        batchBitmaps[i] = env->GetObjectArrayElement(conditionBitmaps, i);
+        request.conditionPixels = lockConditionPixels(env, ids[i], batchBitmaps[i], batchLockedBitmaps[i]);
+    }
+
+    const int processedCount = detector.detectBatch(batchRequests, conditionOperator, batchResults);
+    for (int i = 0; i < processedCount; i++) {
+        const ConditionResult& result = batchResults[i];
+        records[i].set(result);
+    }
+
+    releaseBatchBitmaps(env, count);
+    env->ReleaseLongArrayElements(conditionIds, ids, JNI_ABORT);
+    env->ReleaseIntArrayElements(conditionParams, params, JNI_ABORT);
+
+    return processedCount;
+}
+
+void JniDetector::compileScenario(JNIEnv *env, jlongArray eventIds, jintArray eventParams, jlongArray conditionIds,
+                                  jintArray conditionParams, jobjectArray identifyings, jobjectArray ocrLanguages,
+                                  jobjectArray ocrWhitelists, jint speculativeEventCount) {
+
+    scenarioPlan.clear();
+    scenarioPlan.revision++;
+    const jsize eventCount = env->GetArrayLength(eventIds);
+    const jsize conditionCount = env->GetArrayLength(conditionIds);
+    if (env->GetArrayLength(eventParams) < eventCount * SCENARIO_EVENT_PARAMS_STRIDE
+            || env->GetArrayLength(conditionParams) < conditionCount * BATCH_PARAMS_STRIDE) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(), "Invalid plan in JNI code {compileScenario}");
+        return;
+    }
+
+    jlong* events = env->GetLongArrayElements(eventIds, nullptr);
+    jint* eventValues = env->GetIntArrayElements(eventParams, nullptr);
+    scenarioPlan.events.resize(eventCount);
+    int firstCondition = 0;
+    for (jsize i = 0; i < eventCount; i++) {
+        const jint* eventValue = eventValues + i * SCENARIO_EVENT_PARAMS_STRIDE;
+        PlannedEvent& event = scenarioPlan.events[i];
+
+        event.eventId = events[i];
+        event.conditionOperator = eventValue[SCENARIO_EVENT_PARAM_OPERATOR];
+        event.keepDetecting = eventValue[SCENARIO_EVENT_PARAM_KEEP_DETECTING] != 0;
+        event.firstCondition = firstCondition;
+        event.conditionCount = std::clamp(eventValue[SCENARIO_EVENT_PARAM_CONDITION_COUNT], 0,
+                                          conditionCount - firstCondition);
+        firstCondition += event.conditionCount;
+    }
+    env->ReleaseLongArrayElements(eventIds, events, JNI_ABORT);
+    env->ReleaseIntArrayElements(eventParams, eventValues, JNI_ABORT);
+
+    // Sized first, the requests points on the texts and options
+    jlong* ids = env->GetLongArrayElements(conditionIds, nullptr);
+    jint* params = env->GetIntArrayElements(conditionParams, nullptr);
+    scenarioPlan.conditions.resize(conditionCount);
+    scenarioPlan.identifyings.resize(conditionCount);
+    scenarioPlan.ocrOptions.resize(conditionCount);
+    for (jsize i = 0; i < conditionCount; i++) {
+        readRequest(env, i, ids, params, identifyings, ocrLanguages, ocrWhitelists, scenarioPlan.conditions[i],
+                    scenarioPlan.identifyings[i], scenarioPlan.ocrOptions[i]);
+    }
+    env->ReleaseLongArrayElements(conditionIds, ids, JNI_ABORT);
+    env->ReleaseIntArrayElements(conditionParams, params, JNI_ABORT);
+    scenarioPlan.speculativeEventCount = speculativeEventCount;
+
+    // The anchors are detected before their dependent conditions, they can't be located by another anchor
+    for (const DetectionRequest& request : scenarioPlan.conditions) {
+        if (request.anchorIndex < 0) continue;
+
+        if (request.anchorIndex >= conditionCount || scenarioPlan.conditions[request.anchorIndex].anchorIndex >= 0) {
+            scenarioPlan.clear();
+            env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(),
+                          "Invalid anchor in JNI code {compileScenario}");
+            return;
+        }
+        scenarioPlan.hasAnchoredConditions = true;
+    }
+}
+
+int JniDetector::detectScenario(JNIEnv *env, jobject results, jbooleanArray skippedEvents, jintArray processedCounts,
+                                jlong deadlineNanos) {
+
+    // Verified before detecting, as the conditions can't be reported otherwise
+    const size_t conditionCount = scenarioPlan.conditions.size();
+    auto* records = static_cast<DetectionResultRecord*>(env->GetDirectBufferAddress(results));
+    if (records == nullptr
+            || env->GetDirectBufferCapacity(results) < (jlong) (conditionCount * sizeof(DetectionResultRecord))
+            || env->GetArrayLength(skippedEvents) < (jsize) scenarioPlan.events.size()
+            || env->GetArrayLength(processedCounts) < (jsize) scenarioPlan.events.size()) {
+        env->ThrowNew(JniRegistry::getIllegalArgumentExceptionClass(), "Invalid results in JNI code {detectScenario}");
+        return 0;
+    }
+
+    jboolean* skipped = env->GetBooleanArrayElements(skippedEvents, nullptr);
+    for (size_t i = 0; i < scenarioPlan.events.size(); i++) {
+        scenarioPlan.events[i].isSkipped = skipped[i] != JNI_FALSE;
+    }
+    env->ReleaseBooleanArrayElements(skippedEvents, skipped, JNI_ABORT);
+    scenarioPlan.deadlineNanos = deadlineNanos;
+
+    const int evaluatedCount = detector.detectScenario(scenarioPlan, scenarioResults, scenarioProcessedCounts);
+    if (evaluatedCount == SCENARIO_PIXELS_NEEDED || evaluatedCount == SCENARIO_FRAME_EXPIRED) return evaluatedCount;
+
+    for (int i = 0; i < evaluatedCount; i++) {
+        const PlannedEvent& event = scenarioPlan.events[i];
+        for (int j = 0; j < scenarioProcessedCounts[i]; j++) {
+            records[event.firstCondition + j].set(scenarioResults[event.firstCondition + j]);
+        }
+    }
+    env->SetIntArrayRegion(processedCounts, 0, (jsize) scenarioProcessedCounts.size(),
+                           reinterpret_cast<const jint*>(scenarioProcessedCounts.data()));
+
+    return evaluatedCount;
+}
+
+void JniDetector::readRequest(JNIEnv *env, jint index, const jlong* ids, const jint* params,
+                              jobjectArray identifyings, jobjectArray ocrLanguages, jobjectArray ocrWhitelists,
+                              DetectionRequest& request, std::string& identifying, OcrOptions& ocrOptions) {
+
+    const jint* conditionParam = params + index * BATCH_PARAMS_STRIDE;
+    request.conditionId = ids[index];
+    request.conditionPixels = nullptr;
+    request.roi = cv::Rect(
+            conditionParam[BATCH_PARAM_X],
+            conditionParam[BATCH_PARAM_Y],
+            conditionParam[BATCH_PARAM_WIDTH],
+            conditionParam[BATCH_PARAM_HEIGHT]);
+    request.threshold = conditionParam[BATCH_PARAM_THRESHOLD];
+    request.shouldBeDetected = conditionParam[BATCH_PARAM_SHOULD_BE_DETECTED] != 0;
+    request.isFeatureMatching = conditionParam[BATCH_PARAM_FEATURE_MATCHING] != 0;
+    request.anchorIndex = conditionParam[BATCH_PARAM_ANCHOR_INDEX];
+    request.anchorArea = cv::Rect(
+            conditionParam[BATCH_PARAM_ANCHOR_X],
+            conditionParam[BATCH_PARAM_ANCHOR_Y],
+            conditionParam[BATCH_PARAM_ANCHOR_WIDTH],
+            conditionParam[BATCH_PARAM_ANCHOR_HEIGHT]);
+    request.isAnchorMissing = false;
+
+    auto identifyingString = (jstring) env->GetObjectArrayElement(identifyings, index);
+    request.identifying = nullptr;
+    request.ocrOptions = nullptr;
+    request.isTextInArea = false;
+    if (identifyingString != nullptr) {
+        identifying = toString(env, identifyingString);
+        request.identifying = &identifying;
+        request.isTextInArea = conditionParam[BATCH_PARAM_TEXT_IN_AREA] != 0;
+        request.ocrOptions = readOcrOptions(
+                env, index, ocrLanguages, ocrWhitelists, conditionParam[BATCH_PARAM_OCR_ENGINE_MODE], ocrOptions);
+        env->DeleteLocalRef(identifyingString);
+    }
+}
+
+const OcrOptions* JniDetector::readOcrOptions(JNIEnv *env, jint index, jobjectArray ocrLanguages,
+                                              jobjectArray ocrWhitelists, jint engineMode, OcrOptions& options) {
+
+    options.language = toString(env, ocrLanguages, index);
+    options.charWhitelist = toString(env, ocrWhitelists, index);
+    options.engineMode = engineMode;
+
+    return options.isDefault() ? nullptr : &options;
+}
+
+void JniDetector::releaseBatchBitmaps(JNIEnv *env, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        batchLockedBitmaps[i].unlock();
+        if (batchBitmaps[i] != nullptr) env->DeleteLocalRef(batchBitmaps[i]);
+        batchBitmaps[i] = nullptr;
+    }
+}
+
+void JniDetector::publishResult(JNIEnv *env, const ConditionResult& result) {
+    detectionResult.setResults(
+            env, result.isDetected, result.centerX, result.centerY, result.confidenceRate, result.isDegraded,
+            result.angle);
+}
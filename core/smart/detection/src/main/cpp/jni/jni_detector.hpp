@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_JNI_DETECTOR_HPP
+#define KLICK_R_JNI_DETECTOR_HPP
+
+#include <jni.h>
+#include <string>
+#include <vector>
+
+#include "detection_result.hpp"
+#include "jni_bitmap.hpp"
+#include "screen_reader.hpp"
+#include "../detection/detector.hpp"
+#include "../types/condition_result.hpp"
+#include "../types/detection_request.hpp"
+#include "../types/ocr_options.hpp"
+#include "../types/pixels_buffer.hpp"
+#include "../types/scenario_plan.hpp"
+
+namespace smartautoclicker {
+
+    /** Number of int values describing a condition in the [JniDetector::detectBatch] params array. */
+    static constexpr int BATCH_PARAMS_STRIDE = 14;
+    static constexpr int BATCH_PARAM_X = 0;
+    static constexpr int BATCH_PARAM_Y = 1;
+    static constexpr int BATCH_PARAM_WIDTH = 2;
+    static constexpr int BATCH_PARAM_HEIGHT = 3;
+    static constexpr int BATCH_PARAM_THRESHOLD = 4;
+    static constexpr int BATCH_PARAM_SHOULD_BE_DETECTED = 5;
+    static constexpr int BATCH_PARAM_OCR_ENGINE_MODE = 6;
+    static constexpr int BATCH_PARAM_TEXT_IN_AREA = 7;
+    static constexpr int BATCH_PARAM_FEATURE_MATCHING = 8;
+    static constexpr int BATCH_PARAM_ANCHOR_INDEX = 9;
+    static constexpr int BATCH_PARAM_ANCHOR_X = 10;
+    static constexpr int BATCH_PARAM_ANCHOR_Y = 11;
+    static constexpr int BATCH_PARAM_ANCHOR_WIDTH = 12;
+    static constexpr int BATCH_PARAM_ANCHOR_HEIGHT = 13;
+
+    /** Number of int values describing an event in the [JniDetector::compileScenario] params array. */
+    static constexpr int SCENARIO_EVENT_PARAMS_STRIDE = 3;
+    static constexpr int SCENARIO_EVENT_PARAM_OPERATOR = 0;
+    static constexpr int SCENARIO_EVENT_PARAM_KEEP_DETECTING = 1;
+    static constexpr int SCENARIO_EVENT_PARAM_CONDITION_COUNT = 2;
+
+    /**
+     * The native object of the java NativeDetector, adapting the JNI calls to the [Detector].
+     * The bitmaps and direct buffers are converted into [PixelsBuffer], the condition bitmaps are only locked when
+     * their pixels are needed, and the results are written into the java buffers.
+     */
+    class JniDetector {
+
+    private:
+        /** The results of the single condition detections, read by the java detector. */
+        DetectionResult detectionResult = DetectionResult();
+
+        /** The requests of the batch being detected. Kept between batches to avoid allocations. */
+        std::vector<DetectionRequest> batchRequests;
+        /** The texts of the text conditions of the batch, at the same index than their request. */
+        std::vector<std::string> batchIdentifyings;
+        /** The OCR options of the text conditions of the batch, at the same index than their request. */
+        std::vector<OcrOptions> batchOcrOptions;
+        /** The local references on the condition bitmaps of the batch, released once it is detected. */
+        std::vector<jobject> batchBitmaps;
+        /** The pixels of the condition bitmaps of the batch, locked when the detector needs them. */
+        std::vector<LockedBitmap> batchLockedBitmaps;
+        /** The results of the batch being detected. */
+        std::vector<ConditionResult> batchResults;
+        /** The occurrences found by [detectAllOccurrences]. Kept between detections to avoid allocations. */
+        std::vector<ConditionResult> occurrenceResults;
+
+        /** The scenario compiled with [compileScenario], evaluated with [detectScenario]. */
+        ScenarioPlan scenarioPlan;
+        /** The results of the conditions of the scenario plan, at the same index than their plan condition. */
+        std::vector<ConditionResult> scenarioResults;
+        /** The number of conditions processed by each event of the scenario plan. */
+        std::vector<int> scenarioProcessedCounts;
+
+        /** The identifiers of the conditions of the templates being prepared. */
+        std::vector<int64_t> templateIds;
+        /** The pixels of the conditions of the templates being prepared, null if they are not needed. */
+        std::vector<const PixelsBuffer*> templatePixels;
+        /** The paths of the files of the templates being prepared, empty if they are not needed. */
+        std::vector<std::string> templatePaths;
+        /** The sizes of the images of the templates being prepared from their files. */
+        std::vector<cv::Size> templateSizes;
+
+        /** The native reader of the screen record frames, opened with [openScreenReader]. */
+        ScreenReader screenReader;
+        /** The pixels and the rendering time of the current image of the [screenReader]. */
+        PixelsBuffer screenReaderPixels = PixelsBuffer();
+        int64_t screenReaderTimestampNs = 0;
+
+        /**
+         * Get the pixels of a screen buffer, checking they are matching the provided dimensions.
+         * @return the pixels, invalid if the buffer is invalid. An IllegalArgumentException is thrown in that case.
+         */
+        static PixelsBuffer getBufferPixels(JNIEnv *env, jobject screenBuffer, int width, int height, int rowStride);
+
+        /**
+         * Lock the pixels of a condition bitmap, if they are needed by its detection.
+         * @return the locked pixels, or nullptr if they are not needed or can't be locked.
+         */
+        const PixelsBuffer* lockConditionPixels(JNIEnv *env, jlong conditionId, jobject conditionBitmap,
+                                                LockedBitmap& lockedBitmap) const;
+
+        /**
+         * Read a condition of the batch arrays, without its pixels.
+         *
+         * @param identifying receives the text of a text condition, [request] points on it.
+         * @param ocrOptions receives the OCR options of a text condition, [request] points on it if they are set.
+         */
+        static void readRequest(JNIEnv *env, jint index, const jlong* ids, const jint* params,
+                                jobjectArray identifyings, jobjectArray ocrLanguages, jobjectArray ocrWhitelists,
+                                DetectionRequest& request, std::string& identifying, OcrOptions& ocrOptions);
+
+        /**
+         * Read the OCR options of a text condition of the batch.
+         * @return the options, or nullptr if the condition uses the detector OCR configuration.
+         */
+        static const OcrOptions* readOcrOptions(JNIEnv *env, jint index, jobjectArray ocrLanguages,
+                                                jobjectArray ocrWhitelists, jint engineMode, OcrOptions& options);
+
+        /** Unlock the condition bitmaps of the last batch, and release their local references. */
+        void releaseBatchBitmaps(JNIEnv *env, size_t count);
+
+        /** Report the result of a single condition detection to the java result object. */
+        void publishResult(JNIEnv *env, const ConditionResult& result);
+
+    public:
+        /** The detector, for the calls that doesn't need any conversion. */
+        Detector detector = Detector();
+
+        /**
+         * Initialize the detector.
+         *
+         * @param env current java env.
+         * @param resultBuffer the direct ByteBuffer receiving a [DetectionResultRecord] upon [detectCondition] calls.
+         */
+        void initialize(JNIEnv *env, jobject resultBuffer);
+
+        /**
+         * Release the detector.
+         *
+         * @param env current java env.
+         */
+        void release(JNIEnv *env);
+
+        /** See [Detector::setScreenMetrics], with the size of the screen bitmap. */
+        void setScreenMetrics(JNIEnv *env, jstring metricsTag, jobject screenBitmap, double detectionQuality);
+
+        /** See [Detector::setScreenMetrics]. */
+        void setScreenMetrics(JNIEnv *env, jstring metricsTag, int width, int height, double detectionQuality);
+
+        /** See [Detector::copyScreenImage], with the pixels of a screen bitmap. */
+        bool setScreenImage(JNIEnv *env, jobject screenBitmap);
+
+        /** See [Detector::setScreenImage], with the pixels of a java direct byte buffer. */
+        bool setScreenImage(JNIEnv *env, jobject screenBuffer, int width, int height, int rowStride, int64_t frameId);
+
+        /** See [Detector::prepareScreenImage], with the pixels of a java direct byte buffer. */
+        bool prepareScreenImage(JNIEnv *env, jobject screenBuffer, int width, int height, int rowStride,
+                                int64_t frameId);
+
+        /**
+         * Open the native reader of the screen record frames, see [ScreenReader::open].
+         * @return a local reference on the java Surface the screen record must render into, or null if unsupported.
+         */
+        jobject openScreenReader(JNIEnv *env, int width, int height);
+
+        /** Close the native reader of the screen record frames. Its images can't be set after this call. */
+        void closeScreenReader();
+
+        /** See [ScreenReader::awaitImage]. */
+        bool awaitScreenReaderImage(int64_t timeoutNanos) { return screenReader.awaitImage(timeoutNanos); }
+
+        /**
+         * Acquire the latest image of the native screen reader, to be set with [setScreenReaderImage].
+         * @return the rendering time of the image, in the [System.nanoTime] time base. 0 if there is no image.
+         */
+        int64_t acquireScreenReaderImage();
+
+        /** See [Detector::setScreenImage], with the pixels of the image acquired by [acquireScreenReaderImage]. */
+        bool setScreenReaderImage();
+
+        /** See [Detector::detectCondition], the results are written into the result buffer. */
+        void detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, int threshold);
+
+        /** See [Detector::detectCondition], the results are written into the result buffer. */
+        void detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, jstring identifying);
+
+        /** See [Detector::detectCondition], the results are written into the result buffer. */
+        void detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, const cv::Rect& roi,
+                             int threshold);
+
+        /** See [Detector::detectCondition], the results are written into the result buffer. */
+        void detectCondition(JNIEnv *env, jlong conditionId, jobject conditionBitmap, const cv::Rect& roi,
+                             jstring identifying);
+
+        /**
+         * See [Detector::detectAllOccurrences].
+         *
+         * @param env current java env.
+         * @param conditionId the unique identifier of the condition.
+         * @param conditionBitmap the image to search, null if its template is cached.
+         * @param roi the area to search in, in full size coordinates. Empty to search in the whole screen.
+         * @param threshold the minimum detection confidence to consider the detection position.
+         * @param results a direct ByteBuffer receiving a [DetectionResultRecord] per occurrence, with room for
+         *                [MATCHING_MAX_CANDIDATES] of them.
+         *
+         * @return the number of occurrences written in the results.
+         */
+        int detectAllOccurrences(JNIEnv *env, jlong conditionId, jobject conditionBitmap, const cv::Rect& roi,
+                                 int threshold, jobject results);
+
+        /**
+         * See [Detector::detectConditionConcurrently]. Can be called from several threads at once.
+         *
+         * @param env current java env.
+         * @param conditionId the unique identifier of the condition, with a cached template.
+         * @param roi the area to search in, in full size coordinates. Empty to search in the whole screen.
+         * @param threshold the minimum detection confidence to consider the detection position.
+         * @param result a direct ByteBuffer receiving the [DetectionResultRecord], owned by the calling thread.
+         */
+        void detectConditionConcurrently(JNIEnv *env, jlong conditionId, const cv::Rect& roi, int threshold,
+                                         jobject result) const;
+
+        /**
+         * See [Detector::prepareTemplates].
+         *
+         * @param env current java env.
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param conditionBitmaps the condition bitmaps, at the same index than their identifier. Can be null for the
+         *                         conditions in the template pack.
+         */
+        int prepareTemplates(JNIEnv *env, jlongArray conditionIds, jobjectArray conditionBitmaps);
+
+        /**
+         * See [Detector::prepareTemplateFiles].
+         *
+         * @param env current java env.
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param conditionPaths the paths of the condition files, at the same index than their identifier. Can be
+         *                       null for the conditions already processed or in the template pack.
+         * @param conditionSizes the width and height of each condition image, at the same index than their identifier.
+         */
+        int prepareTemplateFiles(JNIEnv *env, jlongArray conditionIds, jobjectArray conditionPaths,
+                                 jintArray conditionSizes);
+
+        /**
+         * See [Detector::removeTemplates].
+         *
+         * @param env current java env.
+         * @param conditionIds the unique identifiers of the conditions.
+         */
+        void removeTemplates(JNIEnv *env, jlongArray conditionIds);
+
+        /**
+         * See [Detector::setIdleTemplates].
+         *
+         * @param env current java env.
+         * @param conditionIds the unique identifiers of all idle conditions.
+         */
+        void setIdleTemplates(JNIEnv *env, jlongArray conditionIds);
+
+        /**
+         * See [Detector::setConditionRotations].
+         *
+         * @param env current java env.
+         * @param conditionIds the unique identifiers of the rotation tolerant conditions.
+         * @param rotationCounts the number of orientations of each condition.
+         */
+        void setConditionRotations(JNIEnv *env, jlongArray conditionIds, jintArray rotationCounts);
+
+        /**
+         * See [Detector::setConditionMetrics].
+         *
+         * @param env current java env.
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param metrics the matching metric of each condition.
+         */
+        void setConditionMetrics(JNIEnv *env, jlongArray conditionIds, jintArray metrics);
+
+        /**
+         * See [Detector::detectBatch].
+         *
+         * @param env current java env.
+         * @param count the number of conditions in the batch.
+         * @param conditionIds the unique identifiers of the conditions.
+         * @param conditionBitmaps the images to search.
+         * @param conditionParams BATCH_PARAMS_STRIDE values per condition: the area to search in (empty for the
+         *                        whole screen), the threshold, the expected detection state, the OCR engine mode, if
+         *                        the text is recognized in the area without condition image, if the condition is
+         *                        detected with its feature points, and the index of its anchor condition with the
+         *                        area relative to it. Anchors are only used by the scenario plans.
+         * @param identifyings for each condition, the text to recognise, or null to use the threshold.
+         * @param ocrLanguages for each text condition, the OCR language, or null for the detector one.
+         * @param ocrWhitelists for each text condition, the characters that can be recognized, or null for all.
+         * @param conditionOperator the operator between the conditions, BATCH_OPERATOR_AND or BATCH_OPERATOR_OR.
+         * @param results a direct ByteBuffer receiving a [DetectionResultRecord] per condition.
+         *
+         * @return the number of conditions processed.
+         */
+        int detectBatch(JNIEnv *env, jint count, jlongArray conditionIds, jobjectArray conditionBitmaps,
+                        jintArray conditionParams, jobjectArray identifyings, jobjectArray ocrLanguages,
+                        jobjectArray ocrWhitelists, jint conditionOperator, jobject results);
+
+        /**
+         * Compile the image events of a scenario into the plan evaluated by [detectScenario], replacing the previous
+         * one. The conditions templates must be cached, no bitmap is provided.
+         *
+         * @param env current java env.
+         * @param eventIds the unique identifiers of the events, in evaluation order.
+         * @param eventParams SCENARIO_EVENT_PARAMS_STRIDE values per event: the operator between its conditions, if
+         *                    the next events are evaluated once it is fulfilled and its number of conditions.
+         * @param conditionIds the unique identifiers of the conditions of all events, grouped by event.
+         * @param conditionParams BATCH_PARAMS_STRIDE values per condition, as for [detectBatch]. An anchor must be a
+         *                        condition of the plan without anchor itself.
+         * @param identifyings for each condition, the text to recognise, or null to use the threshold.
+         * @param ocrLanguages for each text condition, the OCR language, or null for the detector one.
+         * @param ocrWhitelists for each text condition, the characters that can be recognized, or null for all.
+         * @param speculativeEventCount the number of first events evaluated speculatively, see [ScenarioPlan].
+         */
+        void compileScenario(JNIEnv *env, jlongArray eventIds, jintArray eventParams, jlongArray conditionIds,
+                             jintArray conditionParams, jobjectArray identifyings, jobjectArray ocrLanguages,
+                             jobjectArray ocrWhitelists, jint speculativeEventCount);
+
+        /**
+         * See [Detector::detectScenario], with the plan of the last [compileScenario].
+         *
+         * @param env current java env.
+         * @param results a direct ByteBuffer receiving a [DetectionResultRecord] per plan condition. Only the ones
+         *                processed are written.
+         * @param skippedEvents for each event of the plan, true if it is not detected on this screen image.
+         * @param processedCounts receives the number of conditions processed for each event.
+         * @param deadlineNanos the time after which the screen image is dropped, see [ScenarioPlan::deadlineNanos].
+         *
+         * @return the number of events evaluated, or SCENARIO_PIXELS_NEEDED if a template is no longer cached, or
+         * SCENARIO_FRAME_EXPIRED if the deadline is passed. Nothing is written in the results for both.
+         */
+        int detectScenario(JNIEnv *env, jobject results, jbooleanArray skippedEvents, jintArray processedCounts,
+                           jlong deadlineNanos);
+    };
+}
+
+#endif //KLICK_R_JNI_DETECTOR_HPP
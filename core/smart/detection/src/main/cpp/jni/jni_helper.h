@@ -19,26 +19,25 @@
 #define KLICK_R_JNI_HELPER_H
 
 #include <jni.h>
-#include "../detection/detector.hpp"
+#include "jni_detector.hpp"
+#include "jni_registry.hpp"
 
 namespace smartautoclicker {
 
     /**
      * This function is a helper providing the boiler plate code to return the native object from Java object.
-     * The "nativePtr" is reached from this code, casted to Detector's pointer and returned. This will be used in
+     * The "nativePtr" is reached from this code, casted to JniDetector's pointer and returned. This will be used in
      * all our native methods wrappers to recover the object before invoking it's methods.
+     * The field identifier is resolved once by the [JniRegistry] when the library is loaded.
      */
-    static Detector *getObject(JNIEnv *env, jobject self) {
-        jclass cls = env->GetObjectClass(self);
-        if (!cls) env->FatalError("GetObjectClass failed");
-
-        jfieldID nativeObjectPointerID = env->GetFieldID(cls, "nativePtr", "J");
-        if (!nativeObjectPointerID) env->FatalError("GetFieldID failed");
-
-        jlong nativeObjectPointer = env->GetLongField(self, nativeObjectPointerID);
+    static JniDetector *getObject(JNIEnv *env, jobject self) {
+        jlong nativeObjectPointer = env->GetLongField(self, JniRegistry::getNativeDetectorNativePtrField());
+        return reinterpret_cast<JniDetector *>(nativeObjectPointer);
+    }
 
-        env->DeleteLocalRef(cls);
-        return reinterpret_cast<Detector *>(nativeObjectPointer);
+    /** Same as [getObject], for the calls forwarded to the detector without any conversion. */
+    static Detector *getDetector(JNIEnv *env, jobject self) {
+        return &getObject(env, self)->detector;
     }
 }
 
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jni_registry.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+jclass JniRegistry::exceptionClass = nullptr;
+jclass JniRegistry::illegalArgumentExceptionClass = nullptr;
+jfieldID JniRegistry::nativeDetectorNativePtrField = nullptr;
+
+
+bool JniRegistry::load(JNIEnv *env) {
+    exceptionClass = findGlobalClass(env, "java/lang/Exception");
+    illegalArgumentExceptionClass = findGlobalClass(env, "java/lang/IllegalArgumentException");
+    if (exceptionClass == nullptr || illegalArgumentExceptionClass == nullptr) return false;
+
+    jclass nativeDetectorClass = env->FindClass(NATIVE_DETECTOR_CLASS);
+    if (nativeDetectorClass == nullptr) {
+        LOGE(LOG_TAG, "Can't find class %1$s", NATIVE_DETECTOR_CLASS);
+        return false;
+    }
+    nativeDetectorNativePtrField = env->GetFieldID(nativeDetectorClass, "nativePtr", "J");
+    env->DeleteLocalRef(nativeDetectorClass);
+
+    if (nativeDetectorNativePtrField == nullptr) {
+        LOGE(LOG_TAG, "Can't find the native detector members");
+        return false;
+    }
+
+    return true;
+}
+
+void JniRegistry::unload(JNIEnv *env) {
+    if (exceptionClass != nullptr) env->DeleteGlobalRef(exceptionClass);
+    if (illegalArgumentExceptionClass != nullptr) env->DeleteGlobalRef(illegalArgumentExceptionClass);
+
+    exceptionClass = nullptr;
+    illegalArgumentExceptionClass = nullptr;
+    nativeDetectorNativePtrField = nullptr;
+}
+
+jclass JniRegistry::findGlobalClass(JNIEnv *env, const char* name) {
+    jclass localClass = env->FindClass(name);
+    if (localClass == nullptr) {
+        LOGE(LOG_TAG, "Can't find class %1$s", name);
+        return nullptr;
+    }
+
+    auto globalClass = reinterpret_cast<jclass>(env->NewGlobalRef(localClass));
+    env->DeleteLocalRef(localClass);
+    return globalClass;
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_JNI_REGISTRY_HPP
+#define KLICK_R_JNI_REGISTRY_HPP
+
+#include <jni.h>
+
+namespace smartautoclicker {
+
+    /**
+     * The java classes, fields and methods identifiers used by the native code.
+     * They are resolved once when the library is loaded, instead of being looked up on each native call.
+     */
+    class JniRegistry {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "JniRegistry";
+
+        static jclass exceptionClass;
+        static jclass illegalArgumentExceptionClass;
+        static jfieldID nativeDetectorNativePtrField;
+
+        /** @return a global reference on the class, or nullptr if it can't be found. */
+        static jclass findGlobalClass(JNIEnv *env, const char* name);
+
+    public:
+        /** The java class of the native detector, declaring the native methods. */
+        static constexpr char const* NATIVE_DETECTOR_CLASS = "com/buzbuz/smartautoclicker/core/detection/NativeDetector";
+
+        /**
+         * Resolve all identifiers. Must be called from JNI_OnLoad.
+         * @return true if all identifiers are resolved, false if one is missing.
+         */
+        static bool load(JNIEnv *env);
+
+        /** Release the global references. Must be called from JNI_OnUnload. */
+        static void unload(JNIEnv *env);
+
+        static jclass getExceptionClass() { return exceptionClass; }
+        static jclass getIllegalArgumentExceptionClass() { return illegalArgumentExceptionClass; }
+        /** The "nativePtr" field of NativeDetector, containing the pointer on the native detector. */
+        static jfieldID getNativeDetectorNativePtrField() { return nativeDetectorNativePtrField; }
+    };
+}
+
+#endif //KLICK_R_JNI_REGISTRY_HPP
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <chrono>
+#include <dlfcn.h>
+#include <android/hardware_buffer.h>
+#include <android/native_window_jni.h>
+
+#include "screen_reader.hpp"
+#include "../utils/log.h"
+
+using namespace smartautoclicker;
+
+
+namespace {
+
+    /** The functions of the NDK image reader, resolved once from libmediandk and libandroid. */
+    struct ImageReaderApi {
+        media_status_t (*newReader)(int32_t width, int32_t height, int32_t format, uint64_t usage, int32_t maxImages,
+                                    AImageReader** reader) = nullptr;
+        void (*deleteReader)(AImageReader* reader) = nullptr;
+        media_status_t (*getWindow)(AImageReader* reader, ANativeWindow** window) = nullptr;
+        media_status_t (*setImageListener)(AImageReader* reader, AImageReader_ImageListener* listener) = nullptr;
+        media_status_t (*acquireLatestImage)(AImageReader* reader, AImage** image) = nullptr;
+        void (*deleteImage)(AImage* image) = nullptr;
+        media_status_t (*getWidth)(const AImage* image, int32_t* width) = nullptr;
+        media_status_t (*getHeight)(const AImage* image, int32_t* height) = nullptr;
+        media_status_t (*getTimestamp)(const AImage* image, int64_t* timestampNs) = nullptr;
+        media_status_t (*getPlaneRowStride)(const AImage* image, int planeIndex, int32_t* rowStride) = nullptr;
+        media_status_t (*getPlaneData)(const AImage* image, int planeIndex, uint8_t** data, int* length) = nullptr;
+        jobject (*toSurface)(JNIEnv* env, ANativeWindow* window) = nullptr;
+
+        bool isLoaded() const {
+            return newReader != nullptr && deleteReader != nullptr && getWindow != nullptr
+                    && setImageListener != nullptr && acquireLatestImage != nullptr && deleteImage != nullptr
+                    && getWidth != nullptr && getHeight != nullptr && getTimestamp != nullptr
+                    && getPlaneRowStride != nullptr && getPlaneData != nullptr && toSurface != nullptr;
+        }
+    };
+
+    template <typename Function>
+    void loadSymbol(void* library, const char* name, Function& function) {
+        function = reinterpret_cast<Function>(dlsym(library, name));
+    }
+
+    const ImageReaderApi& getApi() {
+        static const ImageReaderApi api = [] {
+            ImageReaderApi loaded;
+
+            // Never closed, the libraries are part of all application processes
+            void* mediaLibrary = dlopen("libmediandk.so", RTLD_NOW | RTLD_LOCAL);
+            void* androidLibrary = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+            if (mediaLibrary == nullptr || androidLibrary == nullptr) return loaded;
+
+            loadSymbol(mediaLibrary, "AImageReader_newWithUsage", loaded.newReader);
+            loadSymbol(mediaLibrary, "AImageReader_delete", loaded.deleteReader);
+            loadSymbol(mediaLibrary, "AImageReader_getWindow", loaded.getWindow);
+            loadSymbol(mediaLibrary, "AImageReader_setImageListener", loaded.setImageListener);
+            loadSymbol(mediaLibrary, "AImageReader_acquireLatestImage", loaded.acquireLatestImage);
+            loadSymbol(mediaLibrary, "AImage_delete", loaded.deleteImage);
+            loadSymbol(mediaLibrary, "AImage_getWidth", loaded.getWidth);
+            loadSymbol(mediaLibrary, "AImage_getHeight", loaded.getHeight);
+            loadSymbol(mediaLibrary, "AImage_getTimestamp", loaded.getTimestamp);
+            loadSymbol(mediaLibrary, "AImage_getPlaneRowStride", loaded.getPlaneRowStride);
+            loadSymbol(mediaLibrary, "AImage_getPlaneData", loaded.getPlaneData);
+            loadSymbol(androidLibrary, "ANativeWindow_toSurface", loaded.toSurface);
+            return loaded;
+        }();
+
+        return api;
+    }
+}
+
+ScreenReader::~ScreenReader() {
+    close();
+}
+
+bool ScreenReader::isSupported() {
+    return getApi().isLoaded();
+}
+
+jobject ScreenReader::open(JNIEnv* env, int width, int height) {
+    close();
+
+    const ImageReaderApi& api = getApi();
+    if (!api.isLoaded() || width <= 0 || height <= 0) return nullptr;
+
+    // The images are read by the CPU on each frame, they are mapped with a cached memory
+    AImageReader* newReader = nullptr;
+    if (api.newReader(width, height, AIMAGE_FORMAT_RGBA_8888, AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN, MAX_IMAGES,
+                      &newReader) != AMEDIA_OK || newReader == nullptr) {
+        LOGW(LOG_TAG, "Can't create a reader of %1$dx%2$d", width, height);
+        return nullptr;
+    }
+
+    ANativeWindow* window = nullptr;
+    listener.context = this;
+    listener.onImageAvailable = onImageAvailable;
+    if (api.getWindow(newReader, &window) != AMEDIA_OK || window == nullptr
+            || api.setImageListener(newReader, &listener) != AMEDIA_OK) {
+        LOGW(LOG_TAG, "Can't listen to the reader of %1$dx%2$d", width, height);
+        api.deleteReader(newReader);
+        return nullptr;
+    }
+
+    jobject surface = api.toSurface(env, window);
+    if (surface == nullptr) {
+        api.deleteReader(newReader);
+        return nullptr;
+    }
+
+    reader = newReader;
+    receivedCount = 0;
+    LOGD(LOG_TAG, "Reader opened for %1$dx%2$d", width, height);
+    return surface;
+}
+
+void ScreenReader::onImageAvailable(void* context, AImageReader* reader) {
+    auto* self = static_cast<ScreenReader*>(context);
+
+    // Acquired as soon as it arrives, the outdated images queued in the reader are dropped
+    AImage* image = nullptr;
+    if (getApi().acquireLatestImage(reader, &image) != AMEDIA_OK || image == nullptr) return;
+
+    {
+        std::lock_guard<std::mutex> lock(self->imagesMutex);
+        if (self->pendingImage != nullptr) getApi().deleteImage(self->pendingImage);
+        self->pendingImage = image;
+        self->receivedCount++;
+    }
+    self->imageAvailable.notify_all();
+}
+
+bool ScreenReader::awaitImage(int64_t timeoutNanos) {
+    std::unique_lock<std::mutex> lock(imagesMutex);
+    return imageAvailable.wait_for(lock, std::chrono::nanoseconds(timeoutNanos), [this] {
+        return pendingImage != nullptr || reader == nullptr;
+    }) && pendingImage != nullptr;
+}
+
+bool ScreenReader::acquireLatest(PixelsBuffer& pixels, int64_t& timestampNs) {
+    const ImageReaderApi& api = getApi();
+    std::lock_guard<std::mutex> lock(imagesMutex);
+
+    if (pendingImage != nullptr) {
+        if (previousImage != nullptr) api.deleteImage(previousImage);
+        previousImage = currentImage;
+        currentImage = pendingImage;
+        pendingImage = nullptr;
+    }
+    if (currentImage == nullptr) return false;
+
+    uint8_t* data = nullptr;
+    int length = 0;
+    int32_t width = 0;
+    int32_t height = 0;
+    int32_t rowStride = 0;
+    if (api.getPlaneData(currentImage, 0, &data, &length) != AMEDIA_OK
+            || api.getWidth(currentImage, &width) != AMEDIA_OK
+            || api.getHeight(currentImage, &height) != AMEDIA_OK
+            || api.getPlaneRowStride(currentImage, 0, &rowStride) != AMEDIA_OK
+            || api.getTimestamp(currentImage, &timestampNs) != AMEDIA_OK) {
+        return false;
+    }
+
+    pixels = { data, width, height, (size_t) rowStride };
+    return true;
+}
+
+void ScreenReader::releaseImages() {
+    const ImageReaderApi& api = getApi();
+    for (AImage** image : { &pendingImage, &currentImage, &previousImage }) {
+        if (*image != nullptr) api.deleteImage(*image);
+        *image = nullptr;
+    }
+}
+
+void ScreenReader::close() {
+    if (reader == nullptr) return;
+
+    AImageReader* closedReader = reader;
+    {
+        std::lock_guard<std::mutex> lock(imagesMutex);
+        releaseImages();
+        reader = nullptr;
+    }
+    imageAvailable.notify_all();
+
+    // Waits for the listener thread, an image it pends meanwhile is deleted with the reader
+    getApi().deleteReader(closedReader);
+    {
+        std::lock_guard<std::mutex> lock(imagesMutex);
+        pendingImage = nullptr;
+    }
+    LOGD(LOG_TAG, "Reader closed after %1$llu images", (unsigned long long) receivedCount);
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCREEN_READER_HPP
+#define KLICK_R_SCREEN_READER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <jni.h>
+#include <mutex>
+#include <media/NdkImageReader.h>
+
+#include "../types/pixels_buffer.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * A native image reader receiving the frames of the screen record, rendered by the virtual display into the
+     * surface of [open]. The frames are acquired on the listener thread of the reader as they arrive, without any java
+     * object, and are read without copy by the detection once [acquireLatest] makes them current.
+     *
+     * Like the java image reader of the display recorder, the current and the previous images are kept acquired: the
+     * previous one is still set in the detector until the current one replaces it. The latest received image is
+     * pending until it is acquired, replaced by the newer ones.
+     *
+     * The NDK image reader and the surface conversion are loaded at runtime, from libmediandk and libandroid. The
+     * reader can't be opened before Android 8.
+     */
+    class ScreenReader {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "ScreenReader";
+        /**
+         * Number of images of the reader. The current, previous and pending images are acquired, and acquiring the
+         * latest image requires two free ones to drop the outdated images.
+         */
+        static constexpr int MAX_IMAGES = 5;
+
+        /** The reader, null if it isn't opened. */
+        AImageReader* reader = nullptr;
+        /** The listener of the reader, pointing on this object. */
+        AImageReader_ImageListener listener = AImageReader_ImageListener();
+
+        /** Protects the images, acquired by the listener thread and by the detection thread. */
+        std::mutex imagesMutex;
+        /** Notified when a new image is pending, or when the reader is closed. */
+        std::condition_variable imageAvailable;
+        /** The latest image received, not acquired by the detection yet. Null if there is none. */
+        AImage* pendingImage = nullptr;
+        /** The image of the last [acquireLatest] call, and the one before it. */
+        AImage* currentImage = nullptr;
+        AImage* previousImage = nullptr;
+        /** The number of images received since the reader was opened. */
+        uint64_t receivedCount = 0;
+
+        static void onImageAvailable(void* context, AImageReader* reader);
+
+        /** Delete all acquired images. Must be called with the [imagesMutex]. */
+        void releaseImages();
+
+    public:
+        ScreenReader() = default;
+        ~ScreenReader();
+
+        ScreenReader(const ScreenReader&) = delete;
+        ScreenReader& operator=(const ScreenReader&) = delete;
+
+        /** @return true if the native image reader can be used on this device. */
+        static bool isSupported();
+
+        /**
+         * Open the reader for the frames of a size, closing the previous one.
+         *
+         * @param env current java env.
+         * @param width the width of the frames, in pixels.
+         * @param height the height of the frames, in pixels.
+         *
+         * @return a local reference on the java Surface of the reader, or null if it can't be opened.
+         */
+        jobject open(JNIEnv* env, int width, int height);
+
+        /** @return true if the reader is opened. */
+        bool isOpened() const { return reader != nullptr; }
+
+        /**
+         * Wait for an image to be pending, returning immediately if one was received since the last [acquireLatest].
+         *
+         * @param timeoutNanos the maximum duration of the wait, in nanoseconds.
+         *
+         * @return true if an image is pending, false if the wait has timed out or the reader is closed.
+         */
+        bool awaitImage(int64_t timeoutNanos);
+
+        /**
+         * Make the pending image the current one, and release the image before the previous one. The current image is
+         * kept if there is no pending image.
+         *
+         * @param pixels receives the pixels of the current image, mapped without copy. Valid until the second next
+         *               call to this method returning a new image, or until [close].
+         * @param timestampNs receives the rendering time of the current image, in the [System.nanoTime] time base.
+         *
+         * @return true if there is a current image, false if none was received yet.
+         */
+        bool acquireLatest(PixelsBuffer& pixels, int64_t& timestampNs);
+
+        /** Close the reader and release all its images. The virtual display must no longer render into it. */
+        void close();
+    };
+}
+
+#endif //KLICK_R_SCREEN_READER_HPP
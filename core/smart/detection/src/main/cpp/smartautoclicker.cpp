@@ -16,22 +16,27 @@
  */
 
 #include "jni/jni_helper.h"
+#include "jni/jni_registry.hpp"
+#include "utils/log.h"
 
 using namespace smartautoclicker;
 
-extern "C" {
+/** Tag for the Android logcat. */
+static constexpr char const* LOG_TAG = "SmartAutoClicker";
 
-    JNIEXPORT jlong JNICALL Java_com_buzbuz_smartautoclicker_core_detection_NativeDetector_newDetector(
+namespace {
+
+    jlong newDetector(
             JNIEnv *env,
             jobject self,
-            jobject result) {
+            jobject resultBuffer) {
 
-        auto detector = new Detector();
-        detector->initialize(env, result);
+        auto detector = new JniDetector();
+        detector->initialize(env, resultBuffer);
         return reinterpret_cast<jlong>(detector);
     }
 
-    JNIEXPORT void JNICALL Java_com_buzbuz_smartautoclicker_core_detection_NativeDetector_updateScreenMetrics(
+    void updateScreenMetrics(
             JNIEnv *env,
             jobject self,
             jstring metricsTag,
@@ -41,26 +46,658 @@ extern "C" {
         getObject(env, self)->setScreenMetrics(env, metricsTag, screenBitmap, detectionQuality);
     }
 
-    JNIEXPORT void JNICALL Java_com_buzbuz_smartautoclicker_core_detection_NativeDetector_setScreenImage(
+    void updateScreenMetricsSize(
+            JNIEnv *env,
+            jobject self,
+            jstring metricsTag,
+            jint screenWidth,
+            jint screenHeight,
+            jdouble detectionQuality) {
+
+        getObject(env, self)->setScreenMetrics(env, metricsTag, screenWidth, screenHeight, detectionQuality);
+    }
+
+    jboolean setScreenImageBuffer(
+            JNIEnv *env,
+            jobject self,
+            jobject screenBuffer,
+            jint width,
+            jint height,
+            jint rowStride,
+            jlong frameId) {
+
+        return getObject(env, self)->setScreenImage(env, screenBuffer, width, height, rowStride, frameId)
+                ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jboolean prepareScreenImageBuffer(
+            JNIEnv *env,
+            jobject self,
+            jobject screenBuffer,
+            jint width,
+            jint height,
+            jint rowStride,
+            jlong frameId) {
+
+        return getObject(env, self)->prepareScreenImage(env, screenBuffer, width, height, rowStride, frameId)
+                ? JNI_TRUE : JNI_FALSE;
+    }
+
+    void cancelScreenImagePreparation(
+            JNIEnv *env,
+            jobject self) {
+
+        getDetector(env, self)->cancelScreenImagePreparation();
+    }
+
+    jobject openScreenReader(
+            JNIEnv *env,
+            jobject self,
+            jint width,
+            jint height) {
+
+        return getObject(env, self)->openScreenReader(env, width, height);
+    }
+
+    void closeScreenReader(
+            JNIEnv *env,
+            jobject self) {
+
+        getObject(env, self)->closeScreenReader();
+    }
+
+    jboolean awaitScreenReaderImage(
+            JNIEnv *env,
+            jobject self,
+            jlong timeoutMs) {
+
+        return getObject(env, self)->awaitScreenReaderImage((int64_t) timeoutMs * 1000000) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jlong acquireScreenReaderImage(
+            JNIEnv *env,
+            jobject self) {
+
+        return getObject(env, self)->acquireScreenReaderImage();
+    }
+
+    jboolean setScreenReaderImage(
+            JNIEnv *env,
+            jobject self) {
+
+        return getObject(env, self)->setScreenReaderImage() ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jboolean setScreenImage(
             JNIEnv *env,
             jobject self,
             jobject screenBitmap) {
 
-        getObject(env, self)->setScreenImage(env, screenBitmap);
+        return getObject(env, self)->setScreenImage(env, screenBitmap) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    void setPyramidMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setPyramidMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setSparseMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setSparseMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setBinaryMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setBinaryMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setChamferMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setChamferMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setMotionCompensation(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setMotionCompensationEnabled(enabled == JNI_TRUE);
+    }
+
+    void setAnimatedAreasExclusion(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setAnimatedAreasExclusionEnabled(enabled == JNI_TRUE);
+    }
+
+    void setFirstHitMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setFirstHitMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setLearnedAreaMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setLearnedAreaMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setIntegerScaleRatio(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setIntegerScaleRatioEnabled(enabled == JNI_TRUE);
+    }
+
+    void setDetectionCancelled(
+            JNIEnv *env,
+            jobject self,
+            jboolean cancelled) {
+
+        getDetector(env, self)->setDetectionCancelled(cancelled == JNI_TRUE);
+    }
+
+    jboolean waitForRegionChange(
+            JNIEnv *env,
+            jobject self,
+            jint x,
+            jint y,
+            jint width,
+            jint height,
+            jdouble changeThreshold,
+            jlong timeoutMs) {
+
+        return getDetector(env, self)->waitForRegionChange(
+                cv::Rect(x, y, width, height), changeThreshold, (int64_t) timeoutMs * 1000000) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    void setTemplateScales(
+            JNIEnv *env,
+            jobject self,
+            jfloatArray scales) {
+
+        std::vector<double> templateScales((size_t) env->GetArrayLength(scales));
+        if (!templateScales.empty()) {
+            std::vector<jfloat> values(templateScales.size());
+            env->GetFloatArrayRegion(scales, 0, (jsize) values.size(), values.data());
+            for (size_t i = 0; i < values.size(); i++) templateScales[i] = values[i];
+        }
+
+        getDetector(env, self)->setTemplateScales(templateScales);
+    }
+
+    void setExactMatchingJitter(
+            JNIEnv *env,
+            jobject self,
+            jint pixels) {
+
+        getDetector(env, self)->setExactMatchingJitter(pixels);
+    }
+
+    void setExactPixelMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setExactPixelMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    void setHistogramColorVerification(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setHistogramColorVerificationEnabled(enabled == JNI_TRUE);
+    }
+
+    void setScaledColorVerification(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setScaledColorVerificationEnabled(enabled == JNI_TRUE);
+    }
+
+    void setFrameAllocator(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setFrameAllocatorEnabled(enabled == JNI_TRUE);
+    }
+
+    void setConditionPrefilter(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setConditionPrefilterEnabled(enabled == JNI_TRUE);
+    }
+
+    void setIntegerMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        getDetector(env, self)->setIntegerMatchingEnabled(enabled == JNI_TRUE);
+    }
+
+    jboolean setGpuMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        return getDetector(env, self)->setGpuMatchingEnabled(enabled == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jboolean setNnapiMatching(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        return getDetector(env, self)->setNnapiMatchingEnabled(enabled == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    void setDetectionRate(
+            JNIEnv *env,
+            jobject self,
+            jdouble detectionsPerSecond) {
+
+        getDetector(env, self)->setTargetDetectionRate(detectionsPerSecond);
+    }
+
+    jlong getFrameDelay(
+            JNIEnv *env,
+            jobject self) {
+
+        return getDetector(env, self)->getFrameDelayMs();
+    }
+
+    jstring getFrameTelemetry(
+            JNIEnv *env,
+            jobject self,
+            jint maxCount) {
+
+        const std::string telemetry = getDetector(env, self)->getFrameTelemetry(std::max(maxCount, 0));
+        return env->NewStringUTF(telemetry.c_str());
+    }
+
+    void setNativeThreadCount(
+            JNIEnv *env,
+            jobject self,
+            jint threadCount) {
+
+        getDetector(env, self)->setThreadCount(threadCount);
+    }
+
+    void setNativeThreadPolicy(
+            JNIEnv *env,
+            jobject self,
+            jboolean preferBigCores,
+            jint priority) {
+
+        ThreadPolicy policy;
+        policy.preferBigCores = preferBigCores == JNI_TRUE;
+        policy.priority = priority;
+        getDetector(env, self)->setThreadPolicy(policy);
+    }
+
+    jboolean setPerformanceHint(
+            JNIEnv *env,
+            jobject self,
+            jboolean enabled) {
+
+        return getDetector(env, self)->setPerformanceHintEnabled(enabled == JNI_TRUE) ? JNI_TRUE : JNI_FALSE;
+    }
+
+    void setScreenRegions(
+            JNIEnv *env,
+            jobject self,
+            jintArray regions) {
+
+        // Four values per region: left, top, width and height
+        std::vector<jint> values((size_t) env->GetArrayLength(regions));
+        if (!values.empty()) env->GetIntArrayRegion(regions, 0, (jsize) values.size(), values.data());
+
+        std::vector<cv::Rect> screenRegions;
+        for (size_t i = 0; i + 3 < values.size(); i += 4) {
+            screenRegions.emplace_back(values[i], values[i + 1], values[i + 2], values[i + 3]);
+        }
+
+        getDetector(env, self)->setScreenRegions(screenRegions);
+    }
+
+    void setScreenExcludedAreas(
+            JNIEnv *env,
+            jobject self,
+            jintArray areas) {
+
+        // Four values per area: left, top, width and height
+        std::vector<jint> values((size_t) env->GetArrayLength(areas));
+        if (!values.empty()) env->GetIntArrayRegion(areas, 0, (jsize) values.size(), values.data());
+
+        std::vector<cv::Rect> excludedAreas;
+        for (size_t i = 0; i + 3 < values.size(); i += 4) {
+            excludedAreas.emplace_back(values[i], values[i + 1], values[i + 2], values[i + 3]);
+        }
+
+        getDetector(env, self)->setExcludedAreas(excludedAreas);
+    }
+
+    void setScreenInsets(
+            JNIEnv *env,
+            jobject self,
+            jint left,
+            jint top,
+            jint right,
+            jint bottom) {
+
+        getDetector(env, self)->setScreenInsets(left, top, right, bottom);
+    }
+
+    jint classifyScreenState(
+            JNIEnv *env,
+            jobject self) {
+
+        return getDetector(env, self)->classifyScreenState();
+    }
+
+    void setOcrConfig(
+            JNIEnv *env,
+            jobject self,
+            jstring dataPath,
+            jstring language,
+            jint pageSegmentationMode) {
+
+        OcrEnginePool::Config config;
+        if (dataPath != nullptr) {
+            const char* path = env->GetStringUTFChars(dataPath, nullptr);
+            config.dataPath = path;
+            env->ReleaseStringUTFChars(dataPath, path);
+        }
+        const char* lang = env->GetStringUTFChars(language, nullptr);
+        config.language = lang;
+        env->ReleaseStringUTFChars(language, lang);
+        config.pageSegMode = pageSegmentationMode;
+
+        getDetector(env, self)->setOcrConfig(config);
+    }
+
+    jint prewarm(
+            JNIEnv *env,
+            jclass clazz,
+            jstring dataPath,
+            jobjectArray ocrLanguages,
+            jint pageSegmentationMode) {
+
+        OcrEnginePool::Config baseConfig;
+        if (dataPath != nullptr) {
+            const char* path = env->GetStringUTFChars(dataPath, nullptr);
+            baseConfig.dataPath = path;
+            env->ReleaseStringUTFChars(dataPath, path);
+        }
+        baseConfig.pageSegMode = pageSegmentationMode;
+
+        const jsize languageCount = env->GetArrayLength(ocrLanguages);
+        std::vector<OcrEnginePool::Config> configs(languageCount, baseConfig);
+        for (jsize i = 0; i < languageCount; i++) {
+            auto language = (jstring) env->GetObjectArrayElement(ocrLanguages, i);
+            const char* lang = env->GetStringUTFChars(language, nullptr);
+            configs[i].language = lang;
+            env->ReleaseStringUTFChars(language, lang);
+            env->DeleteLocalRef(language);
+        }
+
+        return Detector::prewarm(configs);
+    }
+
+    jboolean openTemplatePack(
+            JNIEnv *env,
+            jobject self,
+            jstring path) {
+
+        const char* packPath = env->GetStringUTFChars(path, nullptr);
+        bool isOpened = getDetector(env, self)->openTemplatePack(std::string(packPath));
+        env->ReleaseStringUTFChars(path, packPath);
+
+        return isOpened ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jboolean writeTemplatePack(
+            JNIEnv *env,
+            jobject self,
+            jstring path) {
+
+        const char* packPath = env->GetStringUTFChars(path, nullptr);
+        bool isWritten = getDetector(env, self)->writeTemplatePack(std::string(packPath));
+        env->ReleaseStringUTFChars(path, packPath);
+
+        return isWritten ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jint prepareTemplates(
+            JNIEnv *env,
+            jobject self,
+            jlongArray conditionIds,
+            jobjectArray conditionBitmaps) {
+
+        return getObject(env, self)->prepareTemplates(env, conditionIds, conditionBitmaps);
+    }
+
+    jint prepareTemplateFiles(
+            JNIEnv *env,
+            jobject self,
+            jlongArray conditionIds,
+            jobjectArray conditionPaths,
+            jintArray conditionSizes) {
+
+        return getObject(env, self)->prepareTemplateFiles(env, conditionIds, conditionPaths, conditionSizes);
+    }
+
+    void removeTemplates(
+            JNIEnv *env,
+            jobject self,
+            jlongArray conditionIds) {
+
+        getObject(env, self)->removeTemplates(env, conditionIds);
+    }
+
+    void setIdleTemplates(
+            JNIEnv *env,
+            jobject self,
+            jlongArray conditionIds) {
+
+        getObject(env, self)->setIdleTemplates(env, conditionIds);
+    }
+
+    void setRotatedTemplates(
+            JNIEnv *env,
+            jobject self,
+            jlongArray conditionIds,
+            jintArray rotationCounts) {
+
+        getObject(env, self)->setConditionRotations(env, conditionIds, rotationCounts);
     }
 
-    JNIEXPORT void JNICALL Java_com_buzbuz_smartautoclicker_core_detection_NativeDetector_detect(
+    void setMatchingMetrics(
             JNIEnv *env,
             jobject self,
+            jlongArray conditionIds,
+            jintArray metrics) {
+
+        getObject(env, self)->setConditionMetrics(env, conditionIds, metrics);
+    }
+
+    jlongArray getPackedConditionIds(
+            JNIEnv *env,
+            jobject self) {
+
+        const std::vector<int64_t> conditionIds = getDetector(env, self)->getPackedConditionIds();
+        jlongArray result = env->NewLongArray((jsize) conditionIds.size());
+        if (result != nullptr && !conditionIds.empty()) {
+            env->SetLongArrayRegion(result, 0, (jsize) conditionIds.size(), conditionIds.data());
+        }
+
+        return result;
+    }
+
+    jboolean isTemplateCached(
+            JNIEnv *env,
+            jobject self,
+            jlong conditionId) {
+
+        return getDetector(env, self)->isTemplateCached(conditionId);
+    }
+
+    jlongArray getConditionCounters(
+            JNIEnv *env,
+            jobject self) {
+
+        const std::vector<int64_t> counters = getDetector(env, self)->getConditionCounters();
+        jlongArray result = env->NewLongArray((jsize) counters.size());
+        if (result != nullptr && !counters.empty()) {
+            env->SetLongArrayRegion(result, 0, (jsize) counters.size(), counters.data());
+        }
+
+        return result;
+    }
+
+    void setMemoryBudget(
+            JNIEnv *env,
+            jobject self,
+            jlong budget) {
+
+        getDetector(env, self)->setMemoryBudget(budget > 0 ? (size_t) budget : 0);
+    }
+
+    void setMemoryPressure(
+            JNIEnv *env,
+            jobject self,
+            jint pressure) {
+
+        getDetector(env, self)->setMemoryPressure(pressure);
+    }
+
+    void setConditionTimeBudget(
+            JNIEnv *env,
+            jobject self,
+            jlong budgetNanos) {
+
+        getDetector(env, self)->setConditionTimeBudget(budgetNanos);
+    }
+
+    void setCaptureFrameCount(
+            JNIEnv *env,
+            jobject self,
+            jint frameCount) {
+
+        getDetector(env, self)->setCaptureFrameCount(frameCount);
+    }
+
+    jboolean writeCapture(
+            JNIEnv *env,
+            jobject self,
+            jstring path) {
+
+        const char* capturePath = env->GetStringUTFChars(path, nullptr);
+        bool isWritten = getDetector(env, self)->writeCapture(std::string(capturePath));
+        env->ReleaseStringUTFChars(path, capturePath);
+
+        return isWritten ? JNI_TRUE : JNI_FALSE;
+    }
+
+    jdouble suggestDetectionQuality(
+            JNIEnv *env,
+            jobject self,
+            jintArray qualities,
+            jint positionTolerance) {
+
+        std::vector<jint> values((size_t) env->GetArrayLength(qualities));
+        if (!values.empty()) env->GetIntArrayRegion(qualities, 0, (jsize) values.size(), values.data());
+        const std::vector<double> detectionQualities(values.begin(), values.end());
+
+        return getDetector(env, self)->suggestDetectionQuality(detectionQualities, positionTolerance);
+    }
+
+    jlongArray getMemoryUsage(
+            JNIEnv *env,
+            jobject self) {
+
+        const std::vector<int64_t> usage = getDetector(env, self)->getMemoryUsage();
+        jlongArray result = env->NewLongArray((jsize) usage.size());
+        if (result != nullptr) env->SetLongArrayRegion(result, 0, (jsize) usage.size(), usage.data());
+
+        return result;
+    }
+
+    jlongArray getConditionStatistics(
+            JNIEnv *env,
+            jobject self) {
+
+        const std::vector<int64_t> statistics = getDetector(env, self)->getConditionStatistics();
+        jlongArray result = env->NewLongArray((jsize) statistics.size());
+        if (result != nullptr && !statistics.empty()) {
+            env->SetLongArrayRegion(result, 0, (jsize) statistics.size(), statistics.data());
+        }
+
+        return result;
+    }
+
+    jlongArray getCacheStatistics(
+            JNIEnv *env,
+            jobject self) {
+
+        const std::vector<int64_t> statistics = getDetector(env, self)->getCacheStatistics();
+        jlongArray result = env->NewLongArray((jsize) statistics.size());
+        if (result != nullptr) env->SetLongArrayRegion(result, 0, (jsize) statistics.size(), statistics.data());
+
+        return result;
+    }
+
+    jlongArray getOcrEngineStatistics(
+            JNIEnv *env,
+            jobject) {
+
+        const std::vector<int64_t> statistics = Detector::getOcrEngineStatistics();
+        jlongArray result = env->NewLongArray((jsize) statistics.size());
+        if (result != nullptr) env->SetLongArrayRegion(result, 0, (jsize) statistics.size(), statistics.data());
+
+        return result;
+    }
+
+    void detect(
+            JNIEnv *env,
+            jobject self,
+            jlong conditionId,
             jobject conditionBitmap,
             jint threshold) {
 
-        getObject(env, self)->detectCondition(env, conditionBitmap, threshold);
+        getObject(env, self)->detectCondition(env, conditionId, conditionBitmap, threshold);
     }
 
-    JNIEXPORT void JNICALL Java_com_buzbuz_smartautoclicker_core_detection_NativeDetector_detectAt(
+    void detectAt(
             JNIEnv *env,
             jobject self,
+            jlong conditionId,
             jobject conditionBitmap,
             jint x,
             jint y,
@@ -68,10 +705,111 @@ extern "C" {
             jint height,
             jint threshold) {
 
-        getObject(env, self)->detectCondition(env, conditionBitmap, x, y, width, height, threshold);
+        getObject(env, self)->detectCondition(
+                env, conditionId, conditionBitmap, cv::Rect(x, y, width, height), threshold);
     }
 
-    JNIEXPORT void JNICALL Java_com_buzbuz_smartautoclicker_core_detection_NativeDetector_deleteDetector(
+    void detectText(
+            JNIEnv *env,
+            jobject self,
+            jlong conditionId,
+            jobject conditionBitmap,
+            jstring identifying) {
+
+        getObject(env, self)->detectCondition(env, conditionId, conditionBitmap, identifying);
+    }
+
+    void detectTextAt(
+            JNIEnv *env,
+            jobject self,
+            jlong conditionId,
+            jobject conditionBitmap,
+            jint x,
+            jint y,
+            jint width,
+            jint height,
+            jstring identifying) {
+
+        getObject(env, self)->detectCondition(
+                env, conditionId, conditionBitmap, cv::Rect(x, y, width, height), identifying);
+    }
+
+    jint detectAll(
+            JNIEnv *env,
+            jobject self,
+            jlong conditionId,
+            jobject conditionBitmap,
+            jint x,
+            jint y,
+            jint width,
+            jint height,
+            jint threshold,
+            jobject results) {
+
+        return getObject(env, self)->detectAllOccurrences(
+                env, conditionId, conditionBitmap, cv::Rect(x, y, width, height), threshold, results);
+    }
+
+    void detectConcurrently(
+            JNIEnv *env,
+            jobject self,
+            jlong conditionId,
+            jint x,
+            jint y,
+            jint width,
+            jint height,
+            jint threshold,
+            jobject result) {
+
+        getObject(env, self)->detectConditionConcurrently(
+                env, conditionId, cv::Rect(x, y, width, height), threshold, result);
+    }
+
+    jint detectBatch(
+            JNIEnv *env,
+            jobject self,
+            jint count,
+            jlongArray conditionIds,
+            jobjectArray conditionBitmaps,
+            jintArray conditionParams,
+            jobjectArray identifyings,
+            jobjectArray ocrLanguages,
+            jobjectArray ocrWhitelists,
+            jint conditionOperator,
+            jobject results) {
+
+        return getObject(env, self)->detectBatch(env, count, conditionIds, conditionBitmaps, conditionParams,
+                                                 identifyings, ocrLanguages, ocrWhitelists, conditionOperator, results);
+    }
+
+    void compileScenario(
+            JNIEnv *env,
+            jobject self,
+            jlongArray eventIds,
+            jintArray eventParams,
+            jlongArray conditionIds,
+            jintArray conditionParams,
+            jobjectArray identifyings,
+            jobjectArray ocrLanguages,
+            jobjectArray ocrWhitelists,
+            jint speculativeEventCount) {
+
+        getObject(env, self)->compileScenario(env, eventIds, eventParams, conditionIds, conditionParams, identifyings,
+                                              ocrLanguages, ocrWhitelists, speculativeEventCount);
+    }
+
+    jint detectScenario(
+            JNIEnv *env,
+            jobject self,
+            jobject results,
+            jbooleanArray skippedEvents,
+            jintArray processedCounts,
+            jlong deadlineNanos) {
+
+        return getObject(env, self)->detectScenario(env, results, skippedEvents, processedCounts, deadlineNanos);
+    }
+
+    void deleteDetector(
             JNIEnv *env,
             jobject self) {
 
@@ -80,3 +818,116 @@ extern "C" {
         delete detector;
     }
 }
+
+/** The native methods of NativeDetector, registered when the library is loaded. */
+static const JNINativeMethod NATIVE_DETECTOR_METHODS[] = {
+        {"newDetector", "(Ljava/nio/ByteBuffer;)J", (void*) newDetector},
+        {"deleteDetector", "()V", (void*) deleteDetector},
+        {"updateScreenMetrics", "(Ljava/lang/String;Landroid/graphics/Bitmap;D)V", (void*) updateScreenMetrics},
+        {"updateScreenMetricsSize", "(Ljava/lang/String;IID)V", (void*) updateScreenMetricsSize},
+        {"setPyramidMatching", "(Z)V", (void*) setPyramidMatching},
+        {"setSparseMatching", "(Z)V", (void*) setSparseMatching},
+        {"setBinaryMatching", "(Z)V", (void*) setBinaryMatching},
+        {"setChamferMatching", "(Z)V", (void*) setChamferMatching},
+        {"setMotionCompensation", "(Z)V", (void*) setMotionCompensation},
+        {"setAnimatedAreasExclusion", "(Z)V", (void*) setAnimatedAreasExclusion},
+        {"setFirstHitMatching", "(Z)V", (void*) setFirstHitMatching},
+        {"setLearnedAreaMatching", "(Z)V", (void*) setLearnedAreaMatching},
+        {"setIntegerScaleRatio", "(Z)V", (void*) setIntegerScaleRatio},
+        {"setDetectionCancelled", "(Z)V", (void*) setDetectionCancelled},
+        {"waitForRegionChange", "(IIIIDJ)Z", (void*) waitForRegionChange},
+        {"setTemplateScales", "([F)V", (void*) setTemplateScales},
+        {"setNativeExactMatchingJitter", "(I)V", (void*) setExactMatchingJitter},
+        {"setExactPixelMatching", "(Z)V", (void*) setExactPixelMatching},
+        {"setHistogramColorVerification", "(Z)V", (void*) setHistogramColorVerification},
+        {"setScaledColorVerification", "(Z)V", (void*) setScaledColorVerification},
+        {"setFrameAllocator", "(Z)V", (void*) setFrameAllocator},
+        {"setConditionPrefilter", "(Z)V", (void*) setConditionPrefilter},
+        {"setIntegerMatching", "(Z)V", (void*) setIntegerMatching},
+        {"setGpuMatching", "(Z)Z", (void*) setGpuMatching},
+        {"setNnapiMatching", "(Z)Z", (void*) setNnapiMatching},
+        {"setDetectionRate", "(D)V", (void*) setDetectionRate},
+        {"getFrameDelay", "()J", (void*) getFrameDelay},
+        {"getNativeFrameTelemetry", "(I)Ljava/lang/String;", (void*) getFrameTelemetry},
+        {"setNativeThreadCount", "(I)V", (void*) setNativeThreadCount},
+        {"setNativeThreadPolicy", "(ZI)V", (void*) setNativeThreadPolicy},
+        {"setPerformanceHint", "(Z)Z", (void*) setPerformanceHint},
+        {"setOcrConfig", "(Ljava/lang/String;Ljava/lang/String;I)V", (void*) setOcrConfig},
+        {"prewarmNative", "(Ljava/lang/String;[Ljava/lang/String;I)I", (void*) prewarm},
+        {"setScreenImage", "(Landroid/graphics/Bitmap;)Z", (void*) setScreenImage},
+        {"setScreenImageBuffer", "(Ljava/nio/ByteBuffer;IIIJ)Z", (void*) setScreenImageBuffer},
+        {"prepareScreenImageBuffer", "(Ljava/nio/ByteBuffer;IIIJ)Z", (void*) prepareScreenImageBuffer},
+        {"cancelScreenImagePreparation", "()V", (void*) cancelScreenImagePreparation},
+        {"openNativeScreenReader", "(II)Landroid/view/Surface;", (void*) openScreenReader},
+        {"closeNativeScreenReader", "()V", (void*) closeScreenReader},
+        {"awaitNativeScreenReaderImage", "(J)Z", (void*) awaitScreenReaderImage},
+        {"acquireNativeScreenReaderImage", "()J", (void*) acquireScreenReaderImage},
+        {"setScreenReaderImage", "()Z", (void*) setScreenReaderImage},
+        {"setScreenRegions", "([I)V", (void*) setScreenRegions},
+        {"setScreenExcludedAreas", "([I)V", (void*) setScreenExcludedAreas},
+        {"setScreenInsets", "(IIII)V", (void*) setScreenInsets},
+        {"classifyNativeScreenState", "()I", (void*) classifyScreenState},
+        {"openPack", "(Ljava/lang/String;)Z", (void*) openTemplatePack},
+        {"writePack", "(Ljava/lang/String;)Z", (void*) writeTemplatePack},
+        {"getPackedConditionIds", "()[J", (void*) getPackedConditionIds},
+        {"isTemplateCached", "(J)Z", (void*) isTemplateCached},
+        {"prepareTemplates", "([J[Landroid/graphics/Bitmap;)I", (void*) prepareTemplates},
+        {"prepareTemplateFiles", "([J[Ljava/lang/String;[I)I", (void*) prepareTemplateFiles},
+        {"removeTemplates", "([J)V", (void*) removeTemplates},
+        {"setIdleTemplates", "([J)V", (void*) setIdleTemplates},
+        {"setRotatedTemplates", "([J[I)V", (void*) setRotatedTemplates},
+        {"setMatchingMetrics", "([J[I)V", (void*) setMatchingMetrics},
+        {"getNativeConditionCounters", "()[J", (void*) getConditionCounters},
+        {"getNativeConditionStatistics", "()[J", (void*) getConditionStatistics},
+        {"getNativeCacheStatistics", "()[J", (void*) getCacheStatistics},
+        {"getNativeOcrEngineStatistics", "()[J", (void*) getOcrEngineStatistics},
+        {"setNativeMemoryBudget", "(J)V", (void*) setMemoryBudget},
+        {"setNativeMemoryPressure", "(I)V", (void*) setMemoryPressure},
+        {"setNativeConditionTimeBudget", "(J)V", (void*) setConditionTimeBudget},
+        {"getNativeMemoryUsage", "()[J", (void*) getMemoryUsage},
+        {"setNativeCaptureFrameCount", "(I)V", (void*) setCaptureFrameCount},
+        {"writeNativeCapture", "(Ljava/lang/String;)Z", (void*) writeCapture},
+        {"suggestNativeDetectionQuality", "([II)D", (void*) suggestDetectionQuality},
+        {"detect", "(JLandroid/graphics/Bitmap;I)V", (void*) detect},
+        {"detectAt", "(JLandroid/graphics/Bitmap;IIIII)V", (void*) detectAt},
+        {"detectAll", "(JLandroid/graphics/Bitmap;IIIIILjava/nio/ByteBuffer;)I", (void*) detectAll},
+        {"detectConcurrently", "(JIIIIILjava/nio/ByteBuffer;)V", (void*) detectConcurrently},
+        {"detectText", "(JLandroid/graphics/Bitmap;Ljava/lang/String;)V", (void*) detectText},
+        {"detectTextAt", "(JLandroid/graphics/Bitmap;IIIILjava/lang/String;)V", (void*) detectTextAt},
+        {"detectBatch",
+                "(I[J[Landroid/graphics/Bitmap;[I[Ljava/lang/String;[Ljava/lang/String;[Ljava/lang/String;"
+                "ILjava/nio/ByteBuffer;)I",
+                (void*) detectBatch},
+        {"compileNativeScenario",
+                "([J[I[J[I[Ljava/lang/String;[Ljava/lang/String;[Ljava/lang/String;I)V",
+                (void*) compileScenario},
+        {"detectNativeScenario", "(Ljava/nio/ByteBuffer;[Z[IJ)I", (void*) detectScenario},
+};
+
+extern "C" JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) return JNI_ERR;
+
+    // Resolved once here instead of on each native call
+    if (!JniRegistry::load(env)) return JNI_ERR;
+
+    jclass nativeDetectorClass = env->FindClass(JniRegistry::NATIVE_DETECTOR_CLASS);
+    if (nativeDetectorClass == nullptr) return JNI_ERR;
+
+    const jint methodCount = sizeof(NATIVE_DETECTOR_METHODS) / sizeof(NATIVE_DETECTOR_METHODS[0]);
+    const jint registerResult = env->RegisterNatives(nativeDetectorClass, NATIVE_DETECTOR_METHODS, methodCount);
+    env->DeleteLocalRef(nativeDetectorClass);
+    if (registerResult != JNI_OK) {
+        LOGE(LOG_TAG, "Can't register the native detector methods");
+        return JNI_ERR;
+    }
+
+    return JNI_VERSION_1_6;
+}
+
+extern "C" JNIEXPORT void JNICALL JNI_OnUnload(JavaVM* vm, void* reserved) {
+    JNIEnv* env = nullptr;
+    if (vm->GetEnv(reinterpret_cast<void**>(&env), JNI_VERSION_1_6) != JNI_OK) return;
+
+    JniRegistry::unload(env);
+}
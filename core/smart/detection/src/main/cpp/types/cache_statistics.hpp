@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CACHE_STATISTICS_HPP
+#define KLICK_R_CACHE_STATISTICS_HPP
+
+#include <atomic>
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /**
+     * Identifies a cache of the detector, for the cache statistics.
+     * Must be the same as the values of the Kotlin DetectorCacheType.
+     */
+    enum class CacheType : int32_t {
+        /** The processed condition images of the [TemplateCache]. */
+        TEMPLATES = 0,
+        /** The texts recognized on the previous screen images, in the [OcrTextCache]. */
+        OCR_TEXTS = 1,
+        /** The matchings of the same bitmap in the same area on the current screen image, in the [MatchMemo]. */
+        MATCH_MEMO = 2,
+        /** The results of the previous screen image reused in its unchanged areas, from the frame signature. */
+        FRAME_DIFF = 3,
+        /** The downscaled levels of the screen images shared by the coarse matchings. */
+        PYRAMID = 4,
+    };
+
+    /** Number of values of [CacheType]. */
+    static constexpr int CACHE_TYPE_COUNT = 5;
+    /** Number of int64 values describing a cache in the [Detector::getCacheStatistics] array. */
+    static constexpr int CACHE_STATISTICS_STRIDE = 4;
+
+    /**
+     * The lookups of a cache since the detector creation. Always maintained, whatever the native library build type.
+     * Can be updated concurrently by the matching threads.
+     */
+    class CacheStatistics {
+
+    private:
+        std::atomic<int64_t> hitCount = 0;
+        std::atomic<int64_t> missCount = 0;
+        std::atomic<int64_t> evictionCount = 0;
+
+    public:
+        CacheStatistics() = default;
+
+        CacheStatistics(const CacheStatistics&) = delete;
+        CacheStatistics& operator=(const CacheStatistics&) = delete;
+
+        /** A lookup found its value in the cache. */
+        void onHit() { hitCount.fetch_add(1, std::memory_order_relaxed); }
+        /** A lookup didn't find its value in the cache, it has to be computed. */
+        void onMiss() { missCount.fetch_add(1, std::memory_order_relaxed); }
+        /** Values have been dropped from the cache, they will be computed again if looked up. */
+        void onEvicted(int64_t count) { if (count > 0) evictionCount.fetch_add(count, std::memory_order_relaxed); }
+
+        int64_t getHitCount() const { return hitCount.load(std::memory_order_relaxed); }
+        int64_t getMissCount() const { return missCount.load(std::memory_order_relaxed); }
+        int64_t getEvictionCount() const { return evictionCount.load(std::memory_order_relaxed); }
+    };
+}
+
+#endif //KLICK_R_CACHE_STATISTICS_HPP
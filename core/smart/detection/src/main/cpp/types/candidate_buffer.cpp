@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "candidate_buffer.hpp"
+
+using namespace smartautoclicker;
+
+
+void CandidateBuffer::clear() {
+    x.clear();
+    y.clear();
+    width.clear();
+    height.clear();
+    score.clear();
+}
+
+void CandidateBuffer::push(int candidateX, int candidateY, int candidateWidth, int candidateHeight,
+                           float candidateScore) {
+    x.push_back(candidateX);
+    y.push_back(candidateY);
+    width.push_back(candidateWidth);
+    height.push_back(candidateHeight);
+    score.push_back(candidateScore);
+}
+
+bool CandidateBuffer::isOverlapping(int areaX, int areaY, int areaWidth, int areaHeight) const {
+    const int count = (int) x.size();
+    const int* xs = x.data();
+    const int* ys = y.data();
+    const int* widths = width.data();
+    const int* heights = height.data();
+
+    // Branchless on purpose, the comparisons of all candidates are or-ed into a single value
+    int overlaps = 0;
+    for (int i = 0; i < count; i++) {
+        overlaps |= (int) (xs[i] < areaX + areaWidth) & (int) (areaX < xs[i] + widths[i])
+                & (int) (ys[i] < areaY + areaHeight) & (int) (areaY < ys[i] + heights[i]);
+    }
+
+    return overlaps != 0;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CANDIDATE_BUFFER_HPP
+#define KLICK_R_CANDIDATE_BUFFER_HPP
+
+#include <vector>
+
+namespace smartautoclicker {
+
+    /**
+     * Areas of the candidates of a matching, in scaled coordinates.
+     * Stored as one array per coordinate, allowing the tests on all candidates to be vectorized by the compiler.
+     */
+    class CandidateBuffer {
+
+    private:
+        std::vector<int> x;
+        std::vector<int> y;
+        std::vector<int> width;
+        std::vector<int> height;
+        std::vector<float> score;
+
+    public:
+        void clear();
+        void push(int candidateX, int candidateY, int candidateWidth, int candidateHeight, float candidateScore);
+
+        size_t size() const { return x.size(); }
+        bool isEmpty() const { return x.empty(); }
+
+        int getX(size_t index) const { return x[index]; }
+        int getY(size_t index) const { return y[index]; }
+        int getWidth(size_t index) const { return width[index]; }
+        int getHeight(size_t index) const { return height[index]; }
+        float getScore(size_t index) const { return score[index]; }
+
+        /**
+         * Tells if an area overlaps the one of any candidate of the buffer.
+         * All candidates are tested without early exit, the loop is vectorized.
+         */
+        bool isOverlapping(int areaX, int areaY, int areaWidth, int areaHeight) const;
+    };
+}
+
+#endif //KLICK_R_CANDIDATE_BUFFER_HPP
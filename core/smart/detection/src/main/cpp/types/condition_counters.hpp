@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CONDITION_COUNTERS_HPP
+#define KLICK_R_CONDITION_COUNTERS_HPP
+
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /** Number of int64 values describing a condition in the [Detector::getConditionCounters] array. */
+    static constexpr int CONDITION_COUNTERS_STRIDE = 5;
+
+    /** The counters of the detection of a condition, maintained only when the tracing is enabled. */
+    struct ConditionCounters {
+        /** Number of times the condition have been matched on the screen image. */
+        int64_t matchingCount = 0;
+        /** Number of times the previous result of the condition have been reused instead of matching it. */
+        int64_t reusedCount = 0;
+        /** Number of candidates verified over all matchings. */
+        int64_t candidateCount = 0;
+        /** Time spent matching the condition over all matchings, in nanoseconds. */
+        int64_t matchingNanos = 0;
+    };
+}
+
+#endif //KLICK_R_CONDITION_COUNTERS_HPP
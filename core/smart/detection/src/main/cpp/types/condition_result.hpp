@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CONDITION_RESULT_HPP
+#define KLICK_R_CONDITION_RESULT_HPP
+
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /** The results of the detection of a single condition, before being reported to the java side. */
+    struct ConditionResult {
+        /** True if the condition have been detected. */
+        bool isDetected = false;
+        /** The horizontal center of the detected condition in screen coordinates. */
+        int centerX = 0;
+        /** The vertical center of the detected condition in screen coordinates. */
+        int centerY = 0;
+        /** The confidence of the best match in [0..1]. */
+        double confidenceRate = 0.0;
+        /**
+         * True if the matching have been degraded to stay in the time budget of the condition: the result is coarser,
+         * or the text was not recognized.
+         */
+        bool isDegraded = false;
+        /**
+         * The duration of the condition detection on the screen image, in nanoseconds. Measured by the batch and
+         * scenario detections only, to report their progress without a call per condition.
+         */
+        int64_t detectionNanos = 0;
+        /**
+         * The counterclockwise rotation of the condition for the best match, in degrees. 0 for the conditions searched
+         * at their own orientation only.
+         */
+        int angle = 0;
+    };
+}
+
+#endif //KLICK_R_CONDITION_RESULT_HPP
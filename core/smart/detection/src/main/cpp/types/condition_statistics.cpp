@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "condition_statistics.hpp"
+
+using namespace smartautoclicker;
+
+
+int64_t ConditionStatistics::getTimeNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ConditionStatistics::addMatching(int64_t matchingNanos, int64_t candidateCount, int64_t ocrNanos,
+                                      MatchBackendType matchBackend, int64_t detectionQuality) {
+
+    Sample& sample = samples[matchingCount % CONDITION_STATISTICS_WINDOW];
+    sample.matchingNanos = matchingNanos;
+    sample.candidateCount = candidateCount;
+    sample.ocrNanos = ocrNanos;
+    sample.matchBackend = matchBackend;
+    sample.detectionQuality = detectionQuality;
+    matchingCount++;
+}
+
+ConditionStatisticsSummary ConditionStatistics::getSummary() const {
+    ConditionStatisticsSummary summary;
+    summary.matchingCount = matchingCount;
+    summary.sampleCount = std::min(matchingCount, (int64_t) CONDITION_STATISTICS_WINDOW);
+    if (summary.sampleCount == 0) return summary;
+
+    std::array<int64_t, CONDITION_STATISTICS_WINDOW> durations {};
+    std::array<int, MATCH_BACKEND_TYPE_COUNT> backendCounts {};
+    summary.minDetectionQuality = samples[0].detectionQuality;
+    for (int i = 0; i < summary.sampleCount; i++) {
+        durations[i] = samples[i].matchingNanos;
+        summary.candidateCount += samples[i].candidateCount;
+        summary.ocrNanos += samples[i].ocrNanos;
+        backendCounts[(int) samples[i].matchBackend]++;
+        summary.minDetectionQuality = std::min(summary.minDetectionQuality, samples[i].detectionQuality);
+    }
+
+    // From the most recent sample to the oldest one, keeping the most recent backend on ties
+    int selectedCount = 0;
+    for (int i = 0; i < summary.sampleCount; i++) {
+        const Sample& sample = samples[(matchingCount - 1 - i) % CONDITION_STATISTICS_WINDOW];
+        const int count = backendCounts[(int) sample.matchBackend];
+        if (count > selectedCount) {
+            selectedCount = count;
+            summary.matchBackend = (int64_t) sample.matchBackend;
+        }
+    }
+
+    // Partial sorts are enough for the percentiles, the median one leaves the greater values after it
+    const auto begin = durations.begin();
+    const auto end = begin + summary.sampleCount;
+    const auto median = begin + (summary.sampleCount - 1) / 2;
+    const auto p95 = begin + (summary.sampleCount - 1) * 95 / 100;
+    std::nth_element(begin, median, end);
+    summary.medianNanos = *median;
+    std::nth_element(median, p95, end);
+    summary.p95Nanos = *p95;
+    summary.minNanos = *std::min_element(begin, median + 1);
+    summary.maxNanos = *std::max_element(p95, end);
+
+    return summary;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CONDITION_STATISTICS_HPP
+#define KLICK_R_CONDITION_STATISTICS_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "match_backend_type.hpp"
+
+namespace smartautoclicker {
+
+    /** Number of int64 values describing a condition in the [Detector::getConditionStatistics] array. */
+    static constexpr int CONDITION_STATISTICS_STRIDE = 15;
+    /** Number of most recent matchings the statistics of a condition are computed on. */
+    static constexpr int CONDITION_STATISTICS_WINDOW = 64;
+
+    /** The statistics of the most recent matchings of a condition, over [CONDITION_STATISTICS_WINDOW] samples. */
+    struct ConditionStatisticsSummary {
+        /** Number of times the condition have been matched on the screen image, including the older samples. */
+        int64_t matchingCount = 0;
+        /** Number of samples the other values are computed on. */
+        int64_t sampleCount = 0;
+        /** The median matching duration, in nanoseconds. */
+        int64_t medianNanos = 0;
+        /** The 95th percentile of the matching durations, in nanoseconds. */
+        int64_t p95Nanos = 0;
+        int64_t minNanos = 0;
+        int64_t maxNanos = 0;
+        /** Number of candidates verified over all samples. */
+        int64_t candidateCount = 0;
+        /** Time spent getting the text of the candidates over all samples, in nanoseconds. */
+        int64_t ocrNanos = 0;
+        /** The [MatchBackendType] of most samples, the most recent one on ties. */
+        int64_t matchBackend = 0;
+        /** The lowest detection quality of the samples, lowered when the device reduces the quality to cool down. */
+        int64_t minDetectionQuality = 0;
+    };
+
+    /**
+     * The rolling statistics of the matchings of a condition, always maintained as it only costs a clock reading per
+     * matching. Matchings reusing the previous result are not sampled.
+     */
+    class ConditionStatistics {
+
+    public:
+        /** @return the current time for the matching durations, in nanoseconds. */
+        static int64_t getTimeNanos();
+
+        /**
+         * Add the sample of a matching, replacing the oldest one once the window is full.
+         *
+         * @param matchingNanos the duration of the matching, in nanoseconds.
+         * @param candidateCount the number of candidates verified by the matching.
+         * @param ocrNanos the time spent getting the text of the candidates, in nanoseconds. 0 for image conditions.
+         * @param matchBackend how the matching results have been computed.
+         * @param detectionQuality the detection quality of the screen metrics the matching was made with.
+         */
+        void addMatching(int64_t matchingNanos, int64_t candidateCount, int64_t ocrNanos,
+                         MatchBackendType matchBackend, int64_t detectionQuality);
+
+        /** @return the statistics of the samples in the window. The percentiles are computed on each call. */
+        ConditionStatisticsSummary getSummary() const;
+
+    private:
+        struct Sample {
+            int64_t matchingNanos = 0;
+            int64_t candidateCount = 0;
+            int64_t ocrNanos = 0;
+            MatchBackendType matchBackend = MatchBackendType::NONE;
+            int64_t detectionQuality = 0;
+        };
+
+        /** Ring buffer of the most recent samples, the next one is written at [matchingCount] modulo the window. */
+        std::array<Sample, CONDITION_STATISTICS_WINDOW> samples;
+        int64_t matchingCount = 0;
+    };
+}
+
+#endif //KLICK_R_CONDITION_STATISTICS_HPP
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_DETECTION_REQUEST_HPP
+#define KLICK_R_DETECTION_REQUEST_HPP
+
+#include <cstdint>
+#include <string>
+#include <opencv2/core/types.hpp>
+
+#include "ocr_options.hpp"
+#include "pixels_buffer.hpp"
+
+namespace smartautoclicker {
+
+    /** A condition to detect in a batch, see [Detector::detectBatch]. */
+    struct DetectionRequest {
+        /** The unique identifier of the condition, used as key for the template cache. */
+        int64_t conditionId = 0;
+        /** The pixels of the condition. Can be null if its template is already cached, or in the template pack. */
+        const PixelsBuffer* conditionPixels = nullptr;
+        /** The area to search in, in full size coordinates. Empty to search in the whole screen. */
+        cv::Rect roi = cv::Rect();
+        /** The minimum detection confidence to consider the detection position. */
+        int threshold = 0;
+        /** The expected detection state of the condition, for the batch operator. */
+        bool shouldBeDetected = true;
+        /** The text to recognise, or null to detect the condition with the threshold. */
+        const std::string* identifying = nullptr;
+        /** The OCR options of a text condition, or null to use the detector OCR configuration. */
+        const OcrOptions* ocrOptions = nullptr;
+        /** True to recognize the text of [roi] directly, without condition image. See [Detector::detectText]. */
+        bool isTextInArea = false;
+        /** True to detect the condition with its feature points, see [Detector::matchFeatures]. */
+        bool isFeatureMatching = false;
+        /**
+         * The index in [ScenarioPlan::conditions] of the anchor condition locating this one, -1 if it has none. The
+         * condition is then searched in [anchorArea] around the anchor detection instead of [roi].
+         */
+        int anchorIndex = -1;
+        /** The area to search in, relative to the center of the anchor detection, in full size coordinates. */
+        cv::Rect anchorArea = cv::Rect();
+        /**
+         * Set by [Detector::detectScenario] when the anchor isn't detected on the screen image, or the area derived
+         * from its detection is outside of the screen. The condition can't be located and is not detected.
+         */
+        bool isAnchorMissing = false;
+    };
+}
+
+#endif //KLICK_R_DETECTION_REQUEST_HPP
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MATCH_BACKEND_TYPE_HPP
+#define KLICK_R_MATCH_BACKEND_TYPE_HPP
+
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /**
+     * Identifies how the results of a condition matching have been computed, for the condition statistics.
+     * Must be the same as the values of the Kotlin MatchBackendType.
+     */
+    enum class MatchBackendType : int32_t {
+        /** The condition have not been matched. */
+        NONE = 0,
+        /** The OpenCv template matching. */
+        OPENCV = 1,
+        /** The correlation in the frequency domain, for the big conditions. */
+        FFT = 2,
+        /** The kernels specialized by template width, for the small conditions. */
+        SMALL_TEMPLATE = 3,
+        /** The direct integer correlation. */
+        INTEGER = 4,
+        /** The matching pruning the positions that can't reach the threshold. */
+        BOUNDED = 5,
+        /** The Vulkan compute shader. */
+        VULKAN = 6,
+        /** Found again around its previous position, without matching the whole detection area. */
+        NEIGHBOURHOOD = 7,
+        /** Found with the coarse to fine matching. */
+        PYRAMID = 8,
+        /** Found with the informative pixels of the condition. */
+        SPARSE = 9,
+        /** Found with the feature points of the condition. */
+        FEATURES = 10,
+        /** The correlation of each position of a detection area barely bigger than the condition. */
+        DIRECT = 11,
+        /** The correlation of the positions whose window statistics are compatible with the condition only. */
+        PREFILTERED = 12,
+        /** Found with the rolling hash of the condition exact pixels. */
+        EXACT_PIXELS = 13,
+        /** The batched integer correlation of the small conditions searched in the same area. */
+        GEMM = 14,
+        /** Not detected, proven absent from the window statistics without any correlation. */
+        ABSENCE_PROOF = 15,
+        /** Found by correlating the tiles of the detection area where it is usually found first. */
+        FIRST_HIT = 16,
+        /** Found in the area of the detection area where it has been found the most. */
+        LEARNED_AREA = 17,
+        /** The convolution of the conditions searched in the same area on a neural networks accelerator. */
+        NNAPI = 18,
+        /** The correlation of the opaque pixels of a condition with transparent ones only. */
+        MASKED = 19,
+        /** Found with the bits of the condition binarized with an adaptive threshold. */
+        BINARY = 20,
+        /** Found with the distances of the condition edge points to the closest screen edges. */
+        CHAMFER = 21,
+        /** Reused from the previous screen image at its shifted position, or searched in the parts a scroll exposed. */
+        GLOBAL_MOTION = 22,
+        /** The sum of the pixel differences, for the conditions with another [MatchingMetric] than the correlation. */
+        DIFFERENCE = 23,
+    };
+
+    /** Number of values of [MatchBackendType]. */
+    static constexpr int MATCH_BACKEND_TYPE_COUNT = 24;
+}
+
+#endif //KLICK_R_MATCH_BACKEND_TYPE_HPP
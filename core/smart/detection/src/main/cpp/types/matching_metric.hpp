@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MATCHING_METRIC_HPP
+#define KLICK_R_MATCHING_METRIC_HPP
+
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /**
+     * The similarity measured between a condition and the screen content, chosen per condition.
+     * Whatever the metric, the similarity of a position is between 0 and 1, and a condition is found at a position
+     * when its similarity is above [Detector::getMinConfidence] of its threshold. Must be the same as the values of
+     * the Kotlin MatchingMetric.
+     */
+    enum class MatchingMetric : int32_t {
+        /** The normalized correlation coefficient, tolerating the brightness and contrast changes. */
+        CCOEFF_NORMED = 0,
+        /** One minus the normalized sum of squared differences, for the same brightness but not the same pixels. */
+        SQDIFF_NORMED = 1,
+        /**
+         * One minus the mean absolute difference over the gray range, for the conditions captured with the same
+         * colors. A threshold of 10 tolerates a mean difference of 10% of the gray range.
+         */
+        SAD = 2,
+    };
+
+    /** Number of values of [MatchingMetric]. */
+    static constexpr int MATCHING_METRIC_COUNT = 3;
+}
+
+#endif //KLICK_R_MATCHING_METRIC_HPP
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_MEMORY_USAGE_HPP
+#define KLICK_R_MEMORY_USAGE_HPP
+
+#include <cstdint>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * The memory pressure the detector sheds its caches for, same values as the kotlin ones. Each level sheds the
+     * caches of the lower ones in addition to its own, from the cheapest to rebuild to the most costly.
+     */
+    enum MemoryPressure {
+        /** All caches are kept. */
+        MEMORY_PRESSURE_NONE = 0,
+        /** The texts recognized on the previous screen images are dropped. */
+        MEMORY_PRESSURE_OCR_TEXTS = 1,
+        /** The pyramid levels of the screen images are released, and the coarse matchings skipped. */
+        MEMORY_PRESSURE_PYRAMID = 2,
+        /** Only the templates of the conditions matched on the last screen image are kept. */
+        MEMORY_PRESSURE_TEMPLATES = 3,
+        /** Only the front screen image is kept between two frames, without background preparation. */
+        MEMORY_PRESSURE_FRAMES = 4,
+    };
+
+    /** Number of int64 values in the [Detector::getMemoryUsage] array. */
+    static constexpr int MEMORY_USAGE_VALUES_COUNT = 7;
+
+    /** The memory held by a detector, by category, in bytes. */
+    struct MemoryUsage {
+        /**
+         * The pixels of the screen images owned by the detector, their scaled gray images and the row buffers of
+         * their conversion. No full size gray image is kept, the pixels are converted and downscaled row by row.
+         * Includes the released planes kept for reuse by the [FrameAllocator] of the process.
+         */
+        int64_t screenImages = 0;
+        /** The color sums of the current screen image, for the color verification. */
+        int64_t colorIntegral = 0;
+        /** The processed conditions of the template cache, with their lazily computed variants. */
+        int64_t templates = 0;
+        /** The scratch arenas and the result matrices of the matching contexts. */
+        int64_t matchingScratch = 0;
+        /** The trained data loaded by the OCR engines of the process, estimated from their file sizes. */
+        int64_t ocrEngines = 0;
+        /** The texts recognized on the previous screen images. */
+        int64_t ocrTexts = 0;
+        /** The budget the detector degrades to fit in, 0 if unbounded. */
+        int64_t budget = 0;
+
+        /** @return the memory of all categories, in bytes. */
+        int64_t getTotal() const {
+            return screenImages + colorIntegral + templates + matchingScratch + ocrEngines + ocrTexts;
+        }
+    };
+
+    /** @return the memory used by the data of a matrix, 0 if it doesn't own it. */
+    inline size_t getMatMemorySize(const cv::Mat& mat) {
+        return mat.u != nullptr ? mat.total() * mat.elemSize() : 0;
+    }
+}
+
+#endif //KLICK_R_MEMORY_USAGE_HPP
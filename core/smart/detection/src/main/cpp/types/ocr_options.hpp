@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_OCR_OPTIONS_HPP
+#define KLICK_R_OCR_OPTIONS_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace smartautoclicker {
+
+    /** Value of [OcrOptions::engineMode] keeping the engine mode of the detector OCR configuration. */
+    static constexpr int OCR_ENGINE_MODE_DEFAULT = -1;
+
+    /**
+     * The OCR options of a single text condition, overriding the detector OCR configuration.
+     * A condition looking for digits or short words in a small language model is recognized much faster than with the
+     * detector language, each set of options gets its own engines in the [OcrEnginePool].
+     */
+    struct OcrOptions {
+        /** The language of the trained data to load. Empty to use the detector configuration one. */
+        std::string language;
+        /** The only characters that can be recognized, set as tessedit_char_whitelist. Empty for all characters. */
+        std::string charWhitelist;
+        /** The tesseract::OcrEngineMode, LSTM only or legacy. [OCR_ENGINE_MODE_DEFAULT] for the configuration one. */
+        int engineMode = OCR_ENGINE_MODE_DEFAULT;
+
+        /** @return true if no option is overridden. */
+        bool isDefault() const {
+            return language.empty() && charWhitelist.empty() && engineMode == OCR_ENGINE_MODE_DEFAULT;
+        }
+
+        /** @return the hash of the options, telling apart the texts recognized with different options. */
+        uint64_t hash() const {
+            const std::hash<std::string> hasher;
+            return (hasher(language) * 31 + hasher(charWhitelist)) * 31 + (uint64_t) (engineMode + 1);
+        }
+    };
+}
+
+#endif //KLICK_R_OCR_OPTIONS_HPP
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_PIXELS_BUFFER_HPP
+#define KLICK_R_PIXELS_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /**
+     * RGBA 8888 pixels of an image provided to the detector, such as a locked Android bitmap or a screen capture
+     * buffer. The pixels are owned by the caller.
+     */
+    struct PixelsBuffer {
+        uint8_t* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        /** The number of bytes between the start of two consecutive rows. */
+        size_t rowStride = 0;
+
+        /** @return true if the buffer have pixels, and a stride containing its rows. */
+        bool isValid() const { return pixels != nullptr && width > 0 && height > 0 && rowStride >= (size_t) width * 4; }
+    };
+}
+
+#endif //KLICK_R_PIXELS_BUFFER_HPP
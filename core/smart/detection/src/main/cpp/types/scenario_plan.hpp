@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCENARIO_PLAN_HPP
+#define KLICK_R_SCENARIO_PLAN_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "detection_request.hpp"
+#include "ocr_options.hpp"
+
+namespace smartautoclicker {
+
+    /** An image event of a [ScenarioPlan], with its conditions. */
+    struct PlannedEvent {
+        /** The unique identifier of the event, reported with its results. */
+        int64_t eventId = 0;
+        /** The operator between the conditions, BATCH_OPERATOR_AND or BATCH_OPERATOR_OR. */
+        int conditionOperator = 0;
+        /** True to keep evaluating the next events once this one is fulfilled. */
+        bool keepDetecting = false;
+        /** The index of the first condition of the event in [ScenarioPlan::conditions]. */
+        int firstCondition = 0;
+        /** The number of conditions of the event, they are consecutive in [ScenarioPlan::conditions]. */
+        int conditionCount = 0;
+        /** True if the event is not scheduled for the current screen image. Set before each detection. */
+        bool isSkipped = false;
+    };
+
+    /**
+     * The enabled image events of a scenario, in priority order, compiled once and evaluated for each screen image
+     * with [Detector::detectScenario]. The conditions templates must be cached, their pixels are never provided.
+     */
+    struct ScenarioPlan {
+        /** The events, in evaluation order. */
+        std::vector<PlannedEvent> events;
+        /** The conditions of all events, grouped by event. */
+        std::vector<DetectionRequest> conditions;
+        /** The texts of the text conditions, at the same index than their request. */
+        std::vector<std::string> identifyings;
+        /** The OCR options of the text conditions, at the same index than their request. */
+        std::vector<OcrOptions> ocrOptions;
+        /**
+         * The number of first events evaluated speculatively: their conditions are all matched concurrently, and the
+         * fulfilled event with the highest priority is kept. 0 or 1 to evaluate all events one after another.
+         */
+        int speculativeEventCount = 0;
+        /** True if some conditions are located by an anchor condition, see [DetectionRequest::anchorIndex]. */
+        bool hasAnchoredConditions = false;
+        /**
+         * Incremented each time the plan is compiled, so the detector knows when to rebuild the structures derived from
+         * its conditions. Kept by [clear]. 0 if the plan is never compiled, the detector then derives nothing from it.
+         */
+        uint64_t revision = 0;
+        /**
+         * The time after which the screen image is too old for its results to be used, in the steady clock time base
+         * of [ConditionStatistics::getTimeNanos] (System.nanoTime on Android). 0 for no deadline. Set before each
+         * detection.
+         */
+        int64_t deadlineNanos = 0;
+
+        void clear() {
+            events.clear();
+            conditions.clear();
+            identifyings.clear();
+            ocrOptions.clear();
+            speculativeEventCount = 0;
+            hasAnchoredConditions = false;
+            deadlineNanos = 0;
+        }
+    };
+}
+
+#endif //KLICK_R_SCENARIO_PLAN_HPP
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <cstring>
+
+#include "block_compressor.hpp"
+
+using namespace smartautoclicker;
+
+/** Value of the literal or match length of a token followed by length bytes. */
+static constexpr size_t TOKEN_LENGTH_MAX = 15;
+/** Value of a length byte followed by other length bytes. */
+static constexpr size_t LENGTH_BYTE_MAX = 255;
+/** Multiplier of the Knuth multiplicative hash of the sequences. */
+static constexpr uint32_t HASH_MULTIPLIER = 2654435761U;
+
+static uint32_t readSequence(const uint8_t* bytes) {
+    uint32_t sequence;
+    std::memcpy(&sequence, bytes, sizeof(sequence));
+    return sequence;
+}
+
+static void writeLength(std::vector<uint8_t>& compressed, size_t length) {
+    for (; length >= LENGTH_BYTE_MAX; length -= LENGTH_BYTE_MAX) compressed.push_back((uint8_t) LENGTH_BYTE_MAX);
+    compressed.push_back((uint8_t) length);
+}
+
+/** Add the length bytes following a token to [length]. @return false if the block ends before the last one. */
+static bool readLength(const uint8_t* compressed, size_t compressedSize, size_t& position, size_t& length) {
+    uint8_t byte;
+    do {
+        if (position >= compressedSize) return false;
+        byte = compressed[position++];
+        length += byte;
+    } while (byte == LENGTH_BYTE_MAX);
+
+    return true;
+}
+
+void BlockCompressor::writeSequence(std::vector<uint8_t>& compressed, const uint8_t* literals, size_t literalLength,
+                                    size_t offset, size_t matchLength) {
+
+    const size_t matchToken = matchLength == 0 ? 0 : matchLength - MIN_MATCH;
+    compressed.push_back((uint8_t) ((std::min(literalLength, TOKEN_LENGTH_MAX) << 4)
+                                    | std::min(matchToken, TOKEN_LENGTH_MAX)));
+    if (literalLength >= TOKEN_LENGTH_MAX) writeLength(compressed, literalLength - TOKEN_LENGTH_MAX);
+    compressed.insert(compressed.end(), literals, literals + literalLength);
+    if (matchLength == 0) return;
+
+    compressed.push_back((uint8_t) (offset & 0xFF));
+    compressed.push_back((uint8_t) (offset >> 8));
+    if (matchToken >= TOKEN_LENGTH_MAX) writeLength(compressed, matchToken - TOKEN_LENGTH_MAX);
+}
+
+void BlockCompressor::compress(const uint8_t* source, size_t size, std::vector<uint8_t>& compressed) {
+    compressed.clear();
+    compressed.reserve(size + size / LENGTH_BYTE_MAX + 16);
+    positions.fill(0);
+
+    size_t anchor = 0;
+    if (size >= MATCH_FIND_LIMIT) {
+        const size_t searchEnd = size - MATCH_FIND_LIMIT;
+        const size_t matchEnd = size - LAST_LITERALS;
+        size_t position = 0;
+        while (position <= searchEnd) {
+            const uint32_t sequence = readSequence(source + position);
+            uint32_t& hashed = positions[(sequence * HASH_MULTIPLIER) >> (32 - HASH_BITS)];
+            const size_t candidate = hashed;
+            hashed = (uint32_t) position + 1;
+            if (candidate == 0 || position + 1 - candidate > MAX_OFFSET
+                    || readSequence(source + candidate - 1) != sequence) {
+                position++;
+                continue;
+            }
+
+            // The match can overlap its own bytes, they are copied one after the other by the decompression
+            const size_t matchStart = candidate - 1;
+            size_t matchLength = MIN_MATCH;
+            while (position + matchLength < matchEnd
+                    && source[matchStart + matchLength] == source[position + matchLength]) {
+                matchLength++;
+            }
+
+            writeSequence(compressed, source + anchor, position - anchor, position - matchStart, matchLength);
+            position += matchLength;
+            anchor = position;
+        }
+    }
+
+    writeSequence(compressed, source + anchor, size - anchor, 0, 0);
+}
+
+bool BlockCompressor::decompress(const uint8_t* compressed, size_t compressedSize, uint8_t* destination,
+                                 size_t size) {
+
+    size_t input = 0;
+    size_t output = 0;
+    while (input < compressedSize) {
+        const uint8_t token = compressed[input++];
+
+        size_t literalLength = token >> 4;
+        if (literalLength == TOKEN_LENGTH_MAX && !readLength(compressed, compressedSize, input, literalLength)) {
+            return false;
+        }
+        if (literalLength > compressedSize - input || literalLength > size - output) return false;
+        if (literalLength > 0) std::memcpy(destination + output, compressed + input, literalLength);
+        input += literalLength;
+        output += literalLength;
+
+        // The last sequence has no match
+        if (input == compressedSize) break;
+
+        if (compressedSize - input < 2) return false;
+        const size_t offset = compressed[input] | ((size_t) compressed[input + 1] << 8);
+        input += 2;
+        if (offset == 0 || offset > output) return false;
+
+        size_t matchLength = token & TOKEN_LENGTH_MAX;
+        if (matchLength == TOKEN_LENGTH_MAX && !readLength(compressed, compressedSize, input, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (matchLength > size - output) return false;
+
+        const uint8_t* match = destination + output - offset;
+        for (size_t i = 0; i < matchLength; i++) destination[output + i] = match[i];
+        output += matchLength;
+    }
+
+    return output == size;
+}
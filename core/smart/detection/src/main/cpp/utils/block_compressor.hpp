@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef KLICK_R_BLOCK_COMPRESSOR_HPP
+#define KLICK_R_BLOCK_COMPRESSOR_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace smartautoclicker {
+
+    /**
+     * Compresses bytes in the LZ4 block format, favoring the decompression speed over the compression ratio.
+     *
+     * Each sequence is a run of literal bytes followed by a copy of at least [MIN_MATCH] bytes already decompressed,
+     * at most [MAX_OFFSET] bytes before. The matches are found with a single hash table of the last position of each
+     * [MIN_MATCH] bytes. The flat areas of the condition images, and of their masks, are compressed to a few bytes.
+     *
+     * The hash table is kept between the compressions to avoid allocations, this isn't thread safe.
+     */
+    class BlockCompressor {
+
+    private:
+        /** Minimum length of a match, also the length of the sequences hashed to find them. */
+        static constexpr size_t MIN_MATCH = 4;
+        /** Maximum distance of a match, its offset is written on 2 bytes. */
+        static constexpr size_t MAX_OFFSET = 65535;
+        /** Number of bytes always written as literals at the end of a block, as required by the format. */
+        static constexpr size_t LAST_LITERALS = 5;
+        /** Minimum distance between the start of the last match and the end of a block, as required by the format. */
+        static constexpr size_t MATCH_FIND_LIMIT = 12;
+        /** Number of bits of the hash of the sequences. */
+        static constexpr int HASH_BITS = 12;
+
+        /** The position + 1 of the last sequence with each hash, 0 if none. */
+        std::array<uint32_t, 1 << HASH_BITS> positions = {};
+
+        /** Write a sequence: its literals and, if [matchLength] is not 0, its match. */
+        static void writeSequence(std::vector<uint8_t>& compressed, const uint8_t* literals, size_t literalLength,
+                                  size_t offset, size_t matchLength);
+
+    public:
+        /**
+         * Compress bytes into a block.
+         *
+         * @param source the bytes to compress.
+         * @param size the number of bytes to compress.
+         * @param compressed receives the block, replacing its content.
+         */
+        void compress(const uint8_t* source, size_t size, std::vector<uint8_t>& compressed);
+
+        /**
+         * Decompress a block, verifying that it fits the destination.
+         *
+         * @param compressed the block, from [compress].
+         * @param compressedSize the size of the block, in bytes.
+         * @param destination receives the decompressed bytes.
+         * @param size the number of decompressed bytes, the size given to [compress].
+         *
+         * @return true if the block has been decompressed, false if it is invalid or if its size is not [size].
+         */
+        static bool decompress(const uint8_t* compressed, size_t compressedSize, uint8_t* destination, size_t size);
+    };
+}
+
+#endif //KLICK_R_BLOCK_COMPRESSOR_HPP
@@ -15,26 +15,25 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#ifndef KLICK_R_DETECTION_RESULTS
-#define KLICK_R_DETECTION_RESULTS
+#if defined(__aarch64__) && defined(__linux__)
+#include <sys/auxv.h>
+#endif
 
-#include <jni.h>
-#include "../jni/jni_java_wrapper.hpp"
+#include "cpu_features.hpp"
 
-namespace smartautoclicker {
+// Not defined by the oldest NDK headers
+#if defined(__aarch64__) && !defined(HWCAP_ASIMDDP)
+#define HWCAP_ASIMDDP (1 << 20)
+#endif
 
-    class DetectionResult: public JniJavaWrapper {
+using namespace smartautoclicker;
 
-    private:
-        jmethodID methodSetResults = nullptr;
 
-    public:
-        void onAttachedToJavaObject(JNIEnv *env) override;
-        void onDetachedFromJavaObject() override;
-
-        void setResults(JNIEnv *env, bool detected, double centerX, double centerY, double maxVal);
-        void clearResults(JNIEnv *env);
-    };
+bool CpuFeatures::hasDotProduct() {
+#if defined(SMART_DETECTION_DOTPROD_KERNELS) && defined(__linux__)
+    static const bool isSupported = (getauxval(AT_HWCAP) & HWCAP_ASIMDDP) != 0;
+    return isSupported;
+#else
+    return false;
+#endif
 }
-
-#endif //KLICK_R_DETECTION_RESULTS
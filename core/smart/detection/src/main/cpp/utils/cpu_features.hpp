@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_CPU_FEATURES_HPP
+#define KLICK_R_CPU_FEATURES_HPP
+
+/**
+ * Defined when the kernels using the ARMv8.2 dot product instructions are compiled. Those are compiled with
+ * [DOTPROD_TARGET] whatever the baseline of the ABI, and must only be called when [CpuFeatures::hasDotProduct].
+ */
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define SMART_DETECTION_DOTPROD_KERNELS
+#define DOTPROD_TARGET __attribute__((target("dotprod")))
+#endif
+
+namespace smartautoclicker {
+
+    /** The optional instructions of the CPU, detected at runtime for the kernels specialized for them. */
+    class CpuFeatures {
+
+    public:
+        /** @return true if the CPU has the ARMv8.2 dot product instructions. Read once from the auxiliary vector. */
+        static bool hasDotProduct();
+    };
+}
+
+#endif //KLICK_R_CPU_FEATURES_HPP
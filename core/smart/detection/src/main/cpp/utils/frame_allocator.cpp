@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sys/mman.h>
+
+#include <opencv2/core/utility.hpp>
+
+#include "frame_allocator.hpp"
+
+using namespace smartautoclicker;
+
+
+FrameAllocator& FrameAllocator::getInstance() {
+    static FrameAllocator* instance = new FrameAllocator();
+    return *instance;
+}
+
+size_t FrameAllocator::getBlockSize(size_t size) {
+    return size < LARGE_PAGE_SIZE ? size : cv::alignSize(size, LARGE_PAGE_SIZE);
+}
+
+uint8_t* FrameAllocator::allocateBlock(size_t size) const {
+    const size_t blockSize = getBlockSize(size);
+    if (blockSize < LARGE_PAGE_SIZE) return static_cast<uint8_t*>(cv::fastMalloc(blockSize));
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        for (auto it = cachedBlocks.begin(); it != cachedBlocks.end(); it++) {
+            if (it->size != blockSize) continue;
+
+            uint8_t* data = it->data;
+            cachedBlocks.erase(it);
+            return data;
+        }
+    }
+
+    // Mapped bigger, then trimmed to start and end on a huge page boundary
+    const size_t mappedSize = blockSize + LARGE_PAGE_SIZE;
+    void* mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) CV_Error(cv::Error::StsNoMem, "Can't map the frame memory");
+
+    auto* start = static_cast<uint8_t*>(mapped);
+    uint8_t* data = cv::alignPtr(start, (int) LARGE_PAGE_SIZE);
+    if (data > start) munmap(start, data - start);
+    const size_t tailSize = start + mappedSize - (data + blockSize);
+    if (tailSize > 0) munmap(data + blockSize, tailSize);
+
+#ifdef MADV_HUGEPAGE
+    // Only a hint, the kernel might not support transparent huge pages
+    madvise(data, blockSize, MADV_HUGEPAGE);
+#endif
+
+    return data;
+}
+
+void FrameAllocator::releaseBlock(uint8_t* data, size_t size) const {
+    const size_t blockSize = getBlockSize(size);
+    if (blockSize < LARGE_PAGE_SIZE) {
+        cv::fastFree(data);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (cachedBlocks.size() < MAX_CACHED_BLOCKS) {
+            cachedBlocks.push_back({ data, blockSize });
+            return;
+        }
+    }
+
+    munmap(data, blockSize);
+}
+
+cv::UMatData* FrameAllocator::allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                                       cv::AccessFlag, cv::UMatUsageFlags) const {
+
+    // Same as the OpenCv standard allocator, with the rows padded when the data is allocated here
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step != nullptr) {
+            if (data != nullptr && step[i] != cv::Mat::AUTO_STEP) {
+                CV_Assert(total <= step[i]);
+                total = step[i];
+            } else {
+                if (data == nullptr && i == dims - 2) total = cv::alignSize(total, ROW_ALIGNMENT);
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    auto* matData = new cv::UMatData(this);
+    matData->data = matData->origdata = data != nullptr ? static_cast<uint8_t*>(data) : allocateBlock(total);
+    matData->size = total;
+    if (data != nullptr) matData->flags |= cv::UMatData::USER_ALLOCATED;
+
+    return matData;
+}
+
+bool FrameAllocator::allocate(cv::UMatData* data, cv::AccessFlag, cv::UMatUsageFlags) const {
+    return data != nullptr;
+}
+
+void FrameAllocator::deallocate(cv::UMatData* data) const {
+    if (data == nullptr) return;
+
+    CV_Assert(data->urefcount == 0);
+    CV_Assert(data->refcount == 0);
+    if (!(data->flags & cv::UMatData::USER_ALLOCATED)) {
+        releaseBlock(data->origdata, data->size);
+        data->origdata = nullptr;
+    }
+
+    delete data;
+}
+
+void FrameAllocator::trim() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (const Block& block : cachedBlocks) munmap(block.data, block.size);
+    cachedBlocks.clear();
+}
+
+size_t FrameAllocator::getCachedSize() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    size_t size = 0;
+    for (const Block& block : cachedBlocks) size += block.size;
+    return size;
+}
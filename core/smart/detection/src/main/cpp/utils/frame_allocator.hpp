@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FRAME_ALLOCATOR_HPP
+#define KLICK_R_FRAME_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * OpenCv allocator for the planes of the screen images.
+     *
+     * The rows of the matrices it creates are padded to a multiple of [ROW_ALIGNMENT] bytes, so each row starts on a
+     * cache line and the vectorized loops never split their last loads between two lines. The frame sized planes are
+     * mapped aligned on [LARGE_PAGE_SIZE] and advised as huge pages where the kernel supports it, reducing the TLB
+     * misses when walking them. As their sizes are the same from one frame to the next, the released ones are kept
+     * and given back to the next allocation of the same size instead of being unmapped.
+     */
+    class FrameAllocator : public cv::MatAllocator {
+
+    private:
+        /** Alignment of the rows of the matrices, a cache line and the widest SIMD register used. */
+        static constexpr size_t ROW_ALIGNMENT = 64;
+        /** Size of a transparent huge page, the allocations at least this big are mapped aligned on it. */
+        static constexpr size_t LARGE_PAGE_SIZE = 2 * 1024 * 1024;
+        /** Maximum number of released large blocks kept for reuse. */
+        static constexpr size_t MAX_CACHED_BLOCKS = 4;
+
+        struct Block {
+            uint8_t* data;
+            size_t size;
+        };
+
+        mutable std::mutex cacheMutex;
+        /** The released large blocks, reused by the next allocation of the same size. */
+        mutable std::vector<Block> cachedBlocks;
+
+        FrameAllocator() = default;
+
+        /** @return the size of the memory allocated for a matrix of the provided size. */
+        static size_t getBlockSize(size_t size);
+        uint8_t* allocateBlock(size_t size) const;
+        void releaseBlock(uint8_t* data, size_t size) const;
+
+    public:
+        /** Never destroyed, as matrices created with it can outlive the static objects. */
+        static FrameAllocator& getInstance();
+
+        FrameAllocator(const FrameAllocator&) = delete;
+        FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+        cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step, cv::AccessFlag flags,
+                               cv::UMatUsageFlags usageFlags) const override;
+        bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags, cv::UMatUsageFlags usageFlags) const override;
+        void deallocate(cv::UMatData* data) const override;
+
+        /** Unmap the cached blocks. */
+        void trim();
+
+        /** @return the number of bytes of the cached blocks. */
+        size_t getCachedSize() const;
+    };
+}
+
+#endif //KLICK_R_FRAME_ALLOCATOR_HPP
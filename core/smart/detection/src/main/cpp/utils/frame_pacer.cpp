@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "frame_pacer.hpp"
+
+using namespace smartautoclicker;
+
+
+int64_t FramePacer::getTimeNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void FramePacer::setTargetRate(double detectionsPerSecond) {
+    targetIntervalNanos = detectionsPerSecond > 0 ? (int64_t) (1e9 / detectionsPerSecond) : 0;
+}
+
+void FramePacer::onFrameStarted(int64_t startNanos, bool isUnchanged) {
+    frameStartNanos = startNanos;
+    unchangedCount = isUnchanged ? unchangedCount + 1 : 0;
+}
+
+int64_t FramePacer::completeFrame() {
+    if (frameStartNanos < 0) return 0;
+
+    lastCostNanos = getTimeNanos() - frameStartNanos;
+    frameStartNanos = -1;
+
+    const auto frameCostNanos = (double) lastCostNanos;
+    averageCostNanos = averageCostNanos < 0 ? frameCostNanos
+            : averageCostNanos + (frameCostNanos - averageCostNanos) * COST_SMOOTHING;
+
+    if (targetIntervalNanos == 0) return 0;
+
+    // A changed screen image resets the interval, the next ones are detected at the target rate again
+    const int doublings = std::min(unchangedCount / UNCHANGED_FRAMES_PER_STEP, MAX_INTERVAL_DOUBLINGS);
+    const double delayNanos = (double) (targetIntervalNanos << doublings) - averageCostNanos;
+
+    return delayNanos > 0 ? (int64_t) (delayNanos / 1e6) : 0;
+}
+
+void FramePacer::clear() {
+    averageCostNanos = -1;
+    lastCostNanos = 0;
+    frameStartNanos = -1;
+    unchangedCount = 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FRAME_PACER_HPP
+#define KLICK_R_FRAME_PACER_HPP
+
+#include <cstdint>
+
+namespace smartautoclicker {
+
+    /**
+     * Compute the delay to wait between two screen images to detect them at a target rate.
+     *
+     * The cost of a frame is measured from the start of its screen image setup to the request of the next delay, and
+     * averaged over the last frames. The delay is the remaining time of the frame interval once this cost is paid, the
+     * frames captured meanwhile are skipped. While the screen stays unchanged, the interval is progressively
+     * doubled up to [MAX_INTERVAL_DOUBLINGS] times, and reset on the first changed screen image.
+     */
+    class FramePacer {
+
+    private:
+        /** Weight of the cost of the last frame in the rolling frame cost. */
+        static constexpr double COST_SMOOTHING = 0.2;
+        /** Number of consecutive unchanged screen images before each doubling of the frame interval. */
+        static constexpr int UNCHANGED_FRAMES_PER_STEP = 4;
+        /** Maximum number of doublings of the target frame interval while the screen is unchanged. */
+        static constexpr int MAX_INTERVAL_DOUBLINGS = 2;
+
+        /** The target interval between two frames, in nanoseconds. 0 if the pacing is disabled. */
+        int64_t targetIntervalNanos = 0;
+        /** The rolling cost of the frames, in nanoseconds. Negative if no frame has been completed yet. */
+        double averageCostNanos = -1;
+        /** The cost of the last completed frame, in nanoseconds. */
+        int64_t lastCostNanos = 0;
+        /** The time the current frame has been started at, in nanoseconds. Negative if there is no current frame. */
+        int64_t frameStartNanos = -1;
+        /** The number of consecutive unchanged screen images, including the current one. */
+        int unchangedCount = 0;
+
+    public:
+        /** @return the current time of the monotonic clock used for the frame costs, in nanoseconds. */
+        static int64_t getTimeNanos();
+
+        /**
+         * Set the number of screen images to detect per second.
+         *
+         * @param detectionsPerSecond the target detection rate, or 0 to detect as fast as possible.
+         */
+        void setTargetRate(double detectionsPerSecond);
+
+        /**
+         * Start a new frame.
+         *
+         * @param startNanos the time the screen image setup of this frame started at, from [getTimeNanos].
+         * @param isUnchanged true if the screen image is identical to the previous one.
+         */
+        void onFrameStarted(int64_t startNanos, bool isUnchanged);
+
+        /**
+         * Complete the current frame, adding its cost to the rolling one.
+         *
+         * @return the delay to wait before the next screen image, in milliseconds. 0 if the pacing is disabled, or if
+         * the frames costs more than the target interval.
+         */
+        int64_t completeFrame();
+
+        /** @return true if a frame have been started and not completed yet. */
+        bool isFrameStarted() const { return frameStartNanos >= 0; }
+
+        /** @return the cost of the last completed frame, in nanoseconds. 0 if there is none. */
+        int64_t getLastFrameCost() const { return lastCostNanos; }
+
+        /** @return the target interval between two frames, in nanoseconds. 0 if the pacing is disabled. */
+        int64_t getTargetInterval() const { return targetIntervalNanos; }
+
+        /** Drop the measured frame cost, when the work of the next frames is no longer comparable. */
+        void clear();
+    };
+}
+
+#endif //KLICK_R_FRAME_PACER_HPP
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+#include "frame_telemetry.hpp"
+
+using namespace smartautoclicker;
+
+
+/** The names of the [MatchBackendType], in declaration order. */
+static constexpr char const* BACKEND_TYPE_NAMES[MATCH_BACKEND_TYPE_COUNT] = {
+        "none", "opencv", "fft", "small", "integer", "bounded", "vulkan", "neighbourhood", "pyramid", "sparse",
+        "features", "direct", "prefiltered", "exact", "gemm", "absence",
+        "firstHit", "learnedArea", "nnapi", "masked", "binary", "chamfer", "globalMotion", "difference",
+};
+
+void FrameTelemetry::beginFrame(uint64_t frameIndex, int64_t startNanos, int64_t readyNanos, bool isUnchanged) {
+    if (isFrameStarted) writeCurrentRecord();
+
+    currentRecord = Record();
+    currentRecord.frameIndex = frameIndex;
+    currentRecord.startNanos = startNanos;
+    currentRecord.readyNanos = readyNanos;
+    currentRecord.isUnchanged = isUnchanged;
+    currentRecord.memoryPressure = memoryPressure;
+    currentMatchingNanos.store(0, std::memory_order_relaxed);
+    currentMatchedCount.store(0, std::memory_order_relaxed);
+    currentReusedCount.store(0, std::memory_order_relaxed);
+    currentBackendMask.store(0, std::memory_order_relaxed);
+    isFrameStarted = true;
+}
+
+void FrameTelemetry::setMemoryPressure(int pressure) {
+    memoryPressure = (uint8_t) pressure;
+    currentRecord.memoryPressure = memoryPressure;
+}
+
+void FrameTelemetry::onMatchComputed(MatchBackendType backendType, int64_t matchingNanos) {
+    currentMatchingNanos.fetch_add(matchingNanos, std::memory_order_relaxed);
+    currentMatchedCount.fetch_add(1, std::memory_order_relaxed);
+    currentBackendMask.fetch_or(1u << (uint32_t) backendType, std::memory_order_relaxed);
+}
+
+void FrameTelemetry::completeFrame(int64_t completedNanos) {
+    if (!isFrameStarted) return;
+
+    currentRecord.completedNanos = completedNanos;
+    writeCurrentRecord();
+}
+
+void FrameTelemetry::writeCurrentRecord() {
+    isFrameStarted = false;
+    currentRecord.matchingNanos = currentMatchingNanos.load(std::memory_order_relaxed);
+    currentRecord.matchedCount = currentMatchedCount.load(std::memory_order_relaxed);
+    currentRecord.reusedCount = currentReusedCount.load(std::memory_order_relaxed);
+    currentRecord.backendMask = currentBackendMask.load(std::memory_order_relaxed);
+
+    if (slots == nullptr) slots = std::make_unique<Slot[]>(CAPACITY);
+
+    const uint64_t index = writtenCount.load(std::memory_order_relaxed);
+    Slot& slot = slots[index % CAPACITY];
+    const uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.record = currentRecord;
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    writtenCount.store(index + 1, std::memory_order_release);
+}
+
+std::vector<FrameTelemetry::Record> FrameTelemetry::getRecords(size_t maxCount) const {
+    std::vector<Record> records;
+    const uint64_t count = writtenCount.load(std::memory_order_acquire);
+    if (slots == nullptr || count == 0) return records;
+
+    const uint64_t readCount = std::min<uint64_t>({ count, CAPACITY, maxCount });
+    records.reserve(readCount);
+    for (uint64_t index = count - readCount; index < count; index++) {
+        const Slot& slot = slots[index % CAPACITY];
+        const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence % 2 != 0) continue;
+
+        const Record record = slot.record;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Overwritten by a newer frame during the copy
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+        records.push_back(record);
+    }
+
+    return records;
+}
+
+std::string FrameTelemetry::dump(size_t maxCount) const {
+    const std::vector<Record> records = getRecords(maxCount);
+
+    std::string result;
+    char line[256];
+    for (const Record& record : records) {
+        const double totalMs = record.completedNanos > 0
+                ? (double) (record.completedNanos - record.startNanos) / 1e6 : -1;
+        int length = snprintf(
+                line, sizeof(line),
+                "frame=%" PRIu64 " start=%" PRId64 "ms setup=%.2fms matching=%.2fms total=%.2fms matched=%u "
+                "reused=%u unchanged=%d pressure=%u backends=",
+                record.frameIndex, record.startNanos / 1000000, (double) (record.readyNanos - record.startNanos) / 1e6,
+                (double) record.matchingNanos / 1e6, totalMs, record.matchedCount, record.reusedCount,
+                record.isUnchanged, record.memoryPressure);
+        result.append(line, std::min<size_t>(length, sizeof(line) - 1));
+
+        bool isFirstBackend = true;
+        for (int type = 0; type < MATCH_BACKEND_TYPE_COUNT; type++) {
+            if ((record.backendMask & (1u << type)) == 0) continue;
+            if (!isFirstBackend) result += '|';
+            result += BACKEND_TYPE_NAMES[type];
+            isFirstBackend = false;
+        }
+        result += '\n';
+    }
+
+    return result;
+}
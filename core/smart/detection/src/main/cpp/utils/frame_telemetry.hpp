@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_FRAME_TELEMETRY_HPP
+#define KLICK_R_FRAME_TELEMETRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../types/match_backend_type.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Ring of the records of the last detected frames, kept during the whole detection to be dumped on demand when a
+     * detection gets slow, without having to reproduce it.
+     *
+     * The records are written by the detection thread only, the matching counters of the current frame can be updated
+     * by the workers matching its conditions. Each slot of the ring is a sequence lock: the records can be read from
+     * any thread without blocking the detection, a record being overwritten during its read is skipped.
+     */
+    class FrameTelemetry {
+
+    public:
+        /** A detected frame. The times are from [FramePacer::getTimeNanos]. */
+        struct Record {
+            /** The index of the screen image, from [FrameSignature::getFrameIndex]. */
+            uint64_t frameIndex = 0;
+            /** The time the screen image setup started at. */
+            int64_t startNanos = 0;
+            /** The time the screen image was ready to be detected. */
+            int64_t readyNanos = 0;
+            /** The time the frame was completed, when its next delay was requested. 0 if it never was. */
+            int64_t completedNanos = 0;
+            /** The duration of the conditions matchings of the frame, not reused from a previous one. */
+            int64_t matchingNanos = 0;
+            /** The number of conditions matched on the frame. */
+            uint32_t matchedCount = 0;
+            /** The number of conditions whose result was reused from a previous matching, the matching caches hits. */
+            uint32_t reusedCount = 0;
+            /** The [MatchBackendType] used by the matchings, one bit per type. */
+            uint32_t backendMask = 0;
+            /** True if the screen image is identical to the previous one. */
+            bool isUnchanged = false;
+            /** The [MemoryPressure] the caches of the detector were shed for during the frame. */
+            uint8_t memoryPressure = 0;
+        };
+
+        /** Number of records kept: a few minutes of detection at the usual detection rates. */
+        static constexpr size_t CAPACITY = 4096;
+
+    private:
+        struct Slot {
+            /** Odd while the record is written, incremented twice by each write. */
+            std::atomic<uint32_t> sequence = 0;
+            Record record;
+        };
+
+        /** The ring of records, allocated on the first frame. */
+        std::unique_ptr<Slot[]> slots = nullptr;
+        /** The number of records written since the creation of the detector. */
+        std::atomic<uint64_t> writtenCount = 0;
+
+        /** The record of the current frame, until it is written. */
+        Record currentRecord;
+        bool isFrameStarted = false;
+        /** The memory pressure of the next frames, see [setMemoryPressure]. */
+        uint8_t memoryPressure = 0;
+        std::atomic<int64_t> currentMatchingNanos = 0;
+        std::atomic<uint32_t> currentMatchedCount = 0;
+        std::atomic<uint32_t> currentReusedCount = 0;
+        std::atomic<uint32_t> currentBackendMask = 0;
+
+        void writeCurrentRecord();
+
+    public:
+        FrameTelemetry() = default;
+
+        FrameTelemetry(const FrameTelemetry&) = delete;
+        FrameTelemetry& operator=(const FrameTelemetry&) = delete;
+
+        /**
+         * Start the record of a new frame, writing the previous one if it was not completed.
+         * Called from the detection thread.
+         */
+        void beginFrame(uint64_t frameIndex, int64_t startNanos, int64_t readyNanos, bool isUnchanged);
+
+        /** Set the memory pressure recorded for the current and next frames. Called from the detection thread. */
+        void setMemoryPressure(int pressure);
+
+        /** Count a condition whose result is reused from a previous matching. Can be called from any thread. */
+        void onMatchReused() { currentReusedCount.fetch_add(1, std::memory_order_relaxed); }
+
+        /** Count a condition matching of the current frame. Can be called from any thread. */
+        void onMatchComputed(MatchBackendType backendType, int64_t matchingNanos);
+
+        /** Complete the current frame and write its record. Called from the detection thread. */
+        void completeFrame(int64_t completedNanos);
+
+        /**
+         * Get the last records. Can be called from any thread, concurrently with the detection.
+         *
+         * @param maxCount the maximum number of records to get.
+         *
+         * @return the records, from the oldest to the newest one.
+         */
+        std::vector<Record> getRecords(size_t maxCount) const;
+
+        /**
+         * Format the last records, one frame per line. Can be called from any thread, concurrently with the detection.
+         *
+         * @param maxCount the maximum number of records to format.
+         */
+        std::string dump(size_t maxCount) const;
+    };
+}
+
+#endif //KLICK_R_FRAME_TELEMETRY_HPP
@@ -16,11 +16,39 @@
  */
 
 #include "log.h"
+#include <chrono>
 #include <cstdarg>
+#include <cstdio>
 
 void logMessage(int priority, const char* tag, const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
+#ifdef __ANDROID__
     __android_log_vprint(priority, tag, fmt, args);
+#else
+    static constexpr char PRIORITY_CHARS[] = "??VDIWE";
+    fprintf(stderr, "%c/%s: ", priority >= 0 && priority <= ANDROID_LOG_ERROR ? PRIORITY_CHARS[priority] : '?', tag);
+    vfprintf(stderr, fmt, args);
+    fputc('\n', stderr);
+#endif
     va_end(args);
-}
\ No newline at end of file
+}
+void logSuppressedMessages(int priority, const char* tag, uint32_t count) {
+    logMessage(priority, tag, "%1$u similar messages suppressed before this one", count);
+}
+
+bool LogRateLimiter::tryAcquire(uint32_t& suppressed) {
+    const int64_t nowNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    // Only one of the concurrent callers wins the next message
+    int64_t nextNanos = nextMessageNanos.load(std::memory_order_relaxed);
+    if (nowNanos < nextNanos || !nextMessageNanos.compare_exchange_strong(
+            nextNanos, nowNanos + LOG_RATE_LIMIT_INTERVAL_NANOS, std::memory_order_relaxed)) {
+        suppressedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+    return true;
+}
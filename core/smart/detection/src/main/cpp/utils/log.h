@@ -18,21 +18,81 @@
 #ifndef KLICK_R_LOG_H
 #define KLICK_R_LOG_H
 
+#ifdef __ANDROID__
 #include <android/log.h>
+#else
+// Outside of Android, such as in the host build of the detection core, logs are written on the standard error
+#define ANDROID_LOG_VERBOSE 2
+#define ANDROID_LOG_DEBUG 3
+#define ANDROID_LOG_INFO 4
+#define ANDROID_LOG_WARN 5
+#define ANDROID_LOG_ERROR 6
+#endif
 
-// Macros to filter verbose and debug logs in Release mode
+#include <atomic>
+#include <cstdint>
+
+// Minimum priority of the compiled logs, verbose and debug logs are removed in Release mode unless defined by the build
+#ifndef SMART_DETECTION_LOG_LEVEL
 #ifdef NDEBUG
-#define LOGV(...)   ((void)0)  // Disable verbose logs in Release
-#define LOGD(...)   ((void)0)  // Disable debug logs in Release
+#define SMART_DETECTION_LOG_LEVEL ANDROID_LOG_INFO
 #else
-#define LOGV(tag, fmt, ...) logMessage(ANDROID_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
-#define LOGD(tag, fmt, ...) logMessage(ANDROID_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define SMART_DETECTION_LOG_LEVEL ANDROID_LOG_VERBOSE
+#endif
 #endif
 
-#define LOGI(tag, fmt, ...) logMessage(ANDROID_LOG_INFO, tag, fmt, ##__VA_ARGS__)
-#define LOGW(tag, fmt, ...) logMessage(ANDROID_LOG_WARN, tag, fmt, ##__VA_ARGS__)
-#define LOGE(tag, fmt, ...) logMessage(ANDROID_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+static constexpr int MIN_LOG_PRIORITY = SMART_DETECTION_LOG_LEVEL;
+
+/** Minimum delay between two messages of a rate limited log call site. */
+static constexpr int64_t LOG_RATE_LIMIT_INTERVAL_NANOS = 5'000'000'000;
+
+/**
+ * Limits the messages of a log call site to one per [LOG_RATE_LIMIT_INTERVAL_NANOS], for the logs of the detection
+ * hot paths that could be written for each condition of each frame. The suppressed messages are never formatted.
+ */
+class LogRateLimiter {
+
+private:
+    std::atomic<int64_t> nextMessageNanos { 0 };
+    std::atomic<uint32_t> suppressedCount { 0 };
+
+public:
+    /**
+     * @param suppressed set to the number of messages suppressed since the previous one, if one can be written.
+     * @return true if a message can be written now, false if it is suppressed.
+     */
+    bool tryAcquire(uint32_t& suppressed);
+};
+
+// The arguments of the filtered logs are still compiled, but never evaluated
+#define LOG_AT(priority, tag, fmt, ...) do {                                                                         \
+    if constexpr ((priority) >= MIN_LOG_PRIORITY) logMessage(priority, tag, fmt, ##__VA_ARGS__);                    \
+} while (0)
+
+#define LOG_RATE_LIMITED(priority, tag, fmt, ...) do {                                                               \
+    if constexpr ((priority) >= MIN_LOG_PRIORITY) {                                                                 \
+        static LogRateLimiter logRateLimiter;                                                                       \
+        uint32_t suppressedLogCount = 0;                                                                            \
+        if (logRateLimiter.tryAcquire(suppressedLogCount)) {                                                        \
+            logMessage(priority, tag, fmt, ##__VA_ARGS__);                                                          \
+            if (suppressedLogCount > 0) logSuppressedMessages(priority, tag, suppressedLogCount);                   \
+        }                                                                                                           \
+    }                                                                                                               \
+} while (0)
+
+#define LOGV(tag, fmt, ...) LOG_AT(ANDROID_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
+#define LOGD(tag, fmt, ...) LOG_AT(ANDROID_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define LOGI(tag, fmt, ...) LOG_AT(ANDROID_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define LOGW(tag, fmt, ...) LOG_AT(ANDROID_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOGE(tag, fmt, ...) LOG_AT(ANDROID_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+
+// Rate limited logs, for the call sites of the hot paths
+#define LOGD_LIMITED(tag, fmt, ...) LOG_RATE_LIMITED(ANDROID_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define LOGW_LIMITED(tag, fmt, ...) LOG_RATE_LIMITED(ANDROID_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOGE_LIMITED(tag, fmt, ...) LOG_RATE_LIMITED(ANDROID_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
 
 void logMessage(int priority, const char* tag, const char* fmt, ...);
+/** Log the number of messages suppressed by a rate limited call site before its last message. */
+void logSuppressedMessages(int priority, const char* tag, uint32_t count);
 
 #endif // KLICK_R_LOG_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <dlfcn.h>
+
+#include "log.h"
+#include "performance_hint_session.hpp"
+
+using namespace smartautoclicker;
+
+
+namespace {
+
+    /** The functions of the NDK performance hint API, resolved once from libandroid. */
+    struct PerformanceHintApi {
+        void* (*getManager)() = nullptr;
+        void* (*createSession)(void* manager, const int32_t* threadIds, size_t size, int64_t targetNanos) = nullptr;
+        int (*updateTargetWorkDuration)(void* session, int64_t targetNanos) = nullptr;
+        int (*reportActualWorkDuration)(void* session, int64_t actualNanos) = nullptr;
+        void (*closeSession)(void* session) = nullptr;
+
+        bool isLoaded() const {
+            return getManager != nullptr && createSession != nullptr && updateTargetWorkDuration != nullptr
+                    && reportActualWorkDuration != nullptr && closeSession != nullptr;
+        }
+    };
+
+    template <typename Function>
+    void loadSymbol(void* library, const char* name, Function& function) {
+        function = reinterpret_cast<Function>(dlsym(library, name));
+    }
+
+    const PerformanceHintApi& getApi() {
+        static const PerformanceHintApi api = [] {
+            PerformanceHintApi loaded;
+
+            // Never closed, the library is part of all application processes
+            void* library = dlopen("libandroid.so", RTLD_NOW | RTLD_LOCAL);
+            if (library == nullptr) return loaded;
+
+            loadSymbol(library, "APerformanceHint_getManager", loaded.getManager);
+            loadSymbol(library, "APerformanceHint_createSession", loaded.createSession);
+            loadSymbol(library, "APerformanceHint_updateTargetWorkDuration", loaded.updateTargetWorkDuration);
+            loadSymbol(library, "APerformanceHint_reportActualWorkDuration", loaded.reportActualWorkDuration);
+            loadSymbol(library, "APerformanceHint_closeSession", loaded.closeSession);
+            return loaded;
+        }();
+
+        return api;
+    }
+}
+
+PerformanceHintSession::~PerformanceHintSession() {
+    close();
+}
+
+bool PerformanceHintSession::isSupported() {
+    return getApi().isLoaded();
+}
+
+bool PerformanceHintSession::open(const std::vector<int32_t>& threadIds, int64_t targetDurationNanos) {
+    close();
+
+    const PerformanceHintApi& api = getApi();
+    if (!api.isLoaded() || threadIds.empty() || targetDurationNanos <= 0) return false;
+
+    void* manager = api.getManager();
+    if (manager == nullptr) return false;
+
+    session = api.createSession(manager, threadIds.data(), threadIds.size(), targetDurationNanos);
+    if (session == nullptr) {
+        LOGW(LOG_TAG, "Can't create a session for %1$zu threads", threadIds.size());
+        return false;
+    }
+
+    targetNanos = targetDurationNanos;
+    LOGD(LOG_TAG, "Session opened for %1$zu threads, target=%2$lldns", threadIds.size(), (long long) targetNanos);
+    return true;
+}
+
+void PerformanceHintSession::setTargetDuration(int64_t targetDurationNanos) {
+    if (session == nullptr || targetDurationNanos <= 0 || targetDurationNanos == targetNanos) return;
+
+    getApi().updateTargetWorkDuration(session, targetDurationNanos);
+    targetNanos = targetDurationNanos;
+}
+
+void PerformanceHintSession::reportActualDuration(int64_t actualDurationNanos) const {
+    if (session == nullptr || actualDurationNanos <= 0) return;
+
+    getApi().reportActualWorkDuration(session, actualDurationNanos);
+}
+
+void PerformanceHintSession::close() {
+    if (session == nullptr) return;
+
+    getApi().closeSession(session);
+    session = nullptr;
+    targetNanos = 0;
+}
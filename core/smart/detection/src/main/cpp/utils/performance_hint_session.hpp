@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_PERFORMANCE_HINT_SESSION_HPP
+#define KLICK_R_PERFORMANCE_HINT_SESSION_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace smartautoclicker {
+
+    /**
+     * An Android Dynamic Performance Framework session, reporting the actual duration of each detected frame against
+     * the target one. It lets the system adapt the frequency of the cores running the detection threads to the
+     * detection workload, instead of boosting them only once the frames are late.
+     *
+     * The performance hint API is only available since Android 13, it is loaded at runtime from libandroid and the
+     * session can't be opened on older versions.
+     */
+    class PerformanceHintSession {
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "PerformanceHintSession";
+
+        /** The opened APerformanceHintSession, or null if there is none. */
+        void* session = nullptr;
+        /** The target duration given to the session, in nanoseconds. */
+        int64_t targetNanos = 0;
+
+    public:
+        PerformanceHintSession() = default;
+        ~PerformanceHintSession();
+
+        PerformanceHintSession(const PerformanceHintSession&) = delete;
+        PerformanceHintSession& operator=(const PerformanceHintSession&) = delete;
+
+        /** @return true if the performance hint API is available on this device. */
+        static bool isSupported();
+
+        /**
+         * Open a session for a set of threads, closing the previous one.
+         *
+         * @param threadIds the ids of the threads doing the work of the session.
+         * @param targetDurationNanos the target duration of the work, in nanoseconds.
+         *
+         * @return true if the session is opened.
+         */
+        bool open(const std::vector<int32_t>& threadIds, int64_t targetDurationNanos);
+
+        /** @return true if the session is opened. */
+        bool isOpened() const { return session != nullptr; }
+
+        /** Update the target duration of the work, if it has changed. */
+        void setTargetDuration(int64_t targetDurationNanos);
+
+        /** Report the actual duration of the last work. */
+        void reportActualDuration(int64_t actualDurationNanos) const;
+
+        /** Close the session, if any. */
+        void close();
+    };
+}
+
+#endif //KLICK_R_PERFORMANCE_HINT_SESSION_HPP
@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "scaled_gray_converter.hpp"
+#include "../types/memory_usage.hpp"
+
+using namespace smartautoclicker;
+
+/** Fixed point coefficients of the gray conversion, same as OpenCv ones to get the exact same gray values. */
+static constexpr int GRAY_SHIFT = 14;
+static constexpr int GRAY_R = 4899;
+static constexpr int GRAY_G = 9617;
+static constexpr int GRAY_B = 1868;
+/** Fixed point reciprocal of 9 in 16 bits, exact for the rounded sums of the 3x3 blocks. */
+static constexpr int RECIPROCAL_9 = 7282;
+
+/** Minimum number of destination rows bands per thread pool worker, allowing the work stealing to balance the load. */
+static constexpr int BANDS_PER_WORKER = 2;
+/** Maximum size of the source pixels of a band, keeping them in the L2 cache of mid-range SoCs with its output. */
+static constexpr size_t BAND_MAX_SOURCE_BYTES = 256 * 1024;
+
+
+void ScaledGrayConverter::convert(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize,
+                                  ThreadPool* threadPool) {
+
+    convertArea(rgba, scaledGray, scaledSize, cv::Rect(0, 0, scaledSize.width, scaledSize.height), threadPool, 1,
+                nullptr);
+}
+
+void ScaledGrayConverter::convert(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize,
+                                  ThreadPool* threadPool, int bandAlignment, const BandCallback& onBandConverted) {
+
+    convertArea(rgba, scaledGray, scaledSize, cv::Rect(0, 0, scaledSize.width, scaledSize.height), threadPool,
+                bandAlignment, &onBandConverted);
+}
+
+void ScaledGrayConverter::convert(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize,
+                                  const cv::Rect& area, ThreadPool* threadPool) {
+
+    convertArea(rgba, scaledGray, scaledSize, area, threadPool, 1, nullptr);
+}
+
+void ScaledGrayConverter::convertArea(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize,
+                                      const cv::Rect& area, ThreadPool* threadPool, int bandAlignment,
+                                      const BandCallback* onBandConverted) {
+
+    scaledGray.create(scaledSize, CV_8UC1);
+    if (area.empty()) return;
+
+    // Area interpolation only reduces, keep the OpenCv implementation for upscaling
+    if (scaledSize.width > rgba.cols || scaledSize.height > rgba.rows) {
+        cv::cvtColor(rgba, fullSizeGray, cv::COLOR_RGBA2GRAY);
+        cv::resize(fullSizeGray, scaledGray, scaledSize, 0, 0, cv::INTER_AREA);
+        if (onBandConverted != nullptr) (*onBandConverted)(area.y, area.y + area.height);
+        return;
+    }
+    fullSizeGray.release();
+
+    const int decimationFactor = getDecimationFactor(rgba.size(), scaledSize);
+    if (decimationFactor == 0) updateWeights(rgba.size(), scaledSize);
+
+    const int workerCount = threadPool != nullptr ? threadPool->getWorkerCount() : 1;
+    if (bandBuffers.size() != (size_t) workerCount) bandBuffers.resize(workerCount);
+
+    // Bands start on aligned rows, the first and last ones can be shorter
+    const int bandRows = getBandRows(rgba, scaledSize, area, bandAlignment, workerCount);
+    const int firstBandRow = area.y / bandRows * bandRows;
+    const int bandCount = (area.y + area.height - firstBandRow + bandRows - 1) / bandRows;
+    const auto convertBandAt = [&](int bandIndex, int workerIndex) {
+        const int firstRow = std::max(area.y, firstBandRow + bandIndex * bandRows);
+        const int endRow = std::min(area.y + area.height, firstBandRow + (bandIndex + 1) * bandRows);
+        const cv::Rect bandArea(area.x, firstRow, area.width, endRow - firstRow);
+        if (decimationFactor != 0) {
+            convertBandDecimated(rgba, scaledGray, bandArea, decimationFactor, bandBuffers[workerIndex]);
+        } else {
+            convertBand(rgba, scaledGray, bandArea, bandBuffers[workerIndex]);
+        }
+        if (onBandConverted != nullptr) (*onBandConverted)(firstRow, endRow);
+    };
+
+    if (threadPool == nullptr || bandCount <= 1) {
+        for (int bandIndex = 0; bandIndex < bandCount; bandIndex++) convertBandAt(bandIndex, 0);
+        return;
+    }
+
+    threadPool->parallelFor(bandCount, convertBandAt);
+}
+
+int ScaledGrayConverter::getBandRows(const cv::Mat& rgba, const cv::Size& scaledSize, const cv::Rect& area,
+                                     int bandAlignment, int workerCount) {
+
+    // Enough bands for the work stealing, and small enough for their source rows to stay in the cache
+    const size_t sourceBytesPerRow = (size_t) rgba.cols * 4 * rgba.rows / scaledSize.height + 1;
+    const int cacheRows = (int) (BAND_MAX_SOURCE_BYTES / sourceBytesPerRow);
+    const int balancedRows = (area.height + workerCount * BANDS_PER_WORKER - 1) / (workerCount * BANDS_PER_WORKER);
+    const int rows = std::max(1, std::min(cacheRows, balancedRows));
+
+    return (rows + bandAlignment - 1) / bandAlignment * bandAlignment;
+}
+
+size_t ScaledGrayConverter::getMemorySize() const {
+    size_t size = getMatMemorySize(fullSizeGray)
+            + (horizontalWeights.capacity() + verticalWeights.capacity()) * sizeof(AreaWeight)
+            + (destinationColumnFirstWeight.capacity() + destinationRowFirstWeight.capacity()) * sizeof(int);
+    for (const BandBuffers& buffers : bandBuffers) {
+        size += buffers.grayRow.capacity()
+                + (buffers.scaledRow.capacity() + buffers.accumulatedRow.capacity()) * sizeof(float)
+                + buffers.columnSums.capacity() * sizeof(uint16_t);
+    }
+
+    return size;
+}
+
+void ScaledGrayConverter::updateWeights(const cv::Size& source, const cv::Size& destination) {
+    if (source == sourceSize && destination == destinationSize) return;
+
+    computeAreaWeights(source.width, destination.width, horizontalWeights);
+    computeAreaWeights(source.height, destination.height, verticalWeights);
+
+    computeFirstWeights(horizontalWeights, destination.width, destinationColumnFirstWeight);
+    computeFirstWeights(verticalWeights, destination.height, destinationRowFirstWeight);
+
+    sourceSize = source;
+    destinationSize = destination;
+}
+
+void ScaledGrayConverter::convertBand(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Rect& area,
+                                      BandBuffers& buffers) const {
+
+    const int firstColumn = area.x;
+    const int endColumn = area.x + area.width;
+    buffers.grayRow.resize(rgba.cols);
+    buffers.scaledRow.resize(scaledGray.cols);
+    buffers.accumulatedRow.resize(scaledGray.cols);
+    std::fill(buffers.accumulatedRow.begin() + firstColumn, buffers.accumulatedRow.begin() + endColumn, 0.f);
+
+    // Only the source columns contributing to the area are converted
+    const int firstColumnWeight = destinationColumnFirstWeight[firstColumn];
+    const int endColumnWeight = destinationColumnFirstWeight[endColumn];
+    const int firstSourceColumn = horizontalWeights[firstColumnWeight].source;
+    const int endSourceColumn = horizontalWeights[endColumnWeight - 1].source + 1;
+
+    int scaledSourceRow = -1;
+    int currentDestinationRow = area.y;
+
+    const int endWeight = destinationRowFirstWeight[area.y + area.height];
+    for (int i = destinationRowFirstWeight[area.y]; i < endWeight; i++) {
+        const AreaWeight& rowWeight = verticalWeights[i];
+
+        // All contributions to the previous destination row are accumulated, write it
+        if (rowWeight.destination != currentDestinationRow) {
+            uint8_t* destination = scaledGray.ptr<uint8_t>(currentDestinationRow);
+            for (int x = firstColumn; x < endColumn; x++) {
+                destination[x] = cv::saturate_cast<uint8_t>(buffers.accumulatedRow[x]);
+                buffers.accumulatedRow[x] = 0.f;
+            }
+            currentDestinationRow = rowWeight.destination;
+        }
+
+        // A source row contributes to up to two destination rows, convert and reduce it only once
+        if (rowWeight.source != scaledSourceRow) {
+            convertRowToGray(rgba.ptr<uint8_t>(rowWeight.source) + firstSourceColumn * 4,
+                             buffers.grayRow.data() + firstSourceColumn, endSourceColumn - firstSourceColumn);
+
+            std::fill(buffers.scaledRow.begin() + firstColumn, buffers.scaledRow.begin() + endColumn, 0.f);
+            for (int j = firstColumnWeight; j < endColumnWeight; j++) {
+                const AreaWeight& columnWeight = horizontalWeights[j];
+                buffers.scaledRow[columnWeight.destination] +=
+                        (float) buffers.grayRow[columnWeight.source] * columnWeight.weight;
+            }
+            scaledSourceRow = rowWeight.source;
+        }
+
+        for (int x = firstColumn; x < endColumn; x++) {
+            buffers.accumulatedRow[x] += buffers.scaledRow[x] * rowWeight.weight;
+        }
+    }
+
+    uint8_t* destination = scaledGray.ptr<uint8_t>(currentDestinationRow);
+    for (int x = firstColumn; x < endColumn; x++) {
+        destination[x] = cv::saturate_cast<uint8_t>(buffers.accumulatedRow[x]);
+    }
+}
+
+int ScaledGrayConverter::getDecimationFactor(const cv::Size& source, const cv::Size& destination) {
+    for (int factor = 1; factor <= DECIMATION_MAX_FACTOR; factor++) {
+        if (source.width == destination.width * factor && source.height == destination.height * factor) return factor;
+    }
+    return 0;
+}
+
+void ScaledGrayConverter::convertBandDecimated(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Rect& area,
+                                               int factor, BandBuffers& buffers) {
+
+    const int firstSourceColumn = area.x * factor;
+    const int sourceWidth = area.width * factor;
+    buffers.grayRow.resize(rgba.cols);
+    buffers.columnSums.resize(rgba.cols);
+    uint8_t* gray = buffers.grayRow.data() + firstSourceColumn;
+    uint16_t* sums = buffers.columnSums.data() + firstSourceColumn;
+
+    for (int y = area.y; y < area.y + area.height; y++) {
+        uint8_t* destination = scaledGray.ptr<uint8_t>(y) + area.x;
+        if (factor == 1) {
+            convertRowToGray(rgba.ptr<uint8_t>(y) + firstSourceColumn * 4, destination, area.width);
+            continue;
+        }
+
+        // The sums of a block are at most 16 x 255, they fit in 16 bits
+        std::fill(sums, sums + sourceWidth, 0);
+        for (int row = 0; row < factor; row++) {
+            convertRowToGray(rgba.ptr<uint8_t>(y * factor + row) + firstSourceColumn * 4, gray, sourceWidth);
+            addRowToSums(gray, sums, sourceWidth);
+        }
+        reduceBlockSums(sums, destination, area.width, factor);
+    }
+}
+
+void ScaledGrayConverter::addRowToSums(const uint8_t* gray, uint16_t* sums, int width) {
+    int x = 0;
+
+#if defined(__ARM_NEON)
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16_t values = vld1q_u8(gray + x);
+        vst1q_u16(sums + x, vaddw_u8(vld1q_u16(sums + x), vget_low_u8(values)));
+        vst1q_u16(sums + x + 8, vaddw_u8(vld1q_u16(sums + x + 8), vget_high_u8(values)));
+    }
+#endif
+
+    for (; x < width; x++) sums[x] += gray[x];
+}
+
+void ScaledGrayConverter::reduceBlockSums(const uint16_t* sums, uint8_t* destination, int width, int factor) {
+    int x = 0;
+
+#if defined(__ARM_NEON)
+    // Columns of the blocks deinterleaved by the loads, and rounded mean of their sums
+    if (factor == 2) {
+        for (; x + 8 <= width; x += 8) {
+            const uint16x8x2_t columns = vld2q_u16(sums + x * 2);
+            vst1_u8(destination + x, vrshrn_n_u16(vaddq_u16(columns.val[0], columns.val[1]), 2));
+        }
+    } else if (factor == 3) {
+        for (; x + 8 <= width; x += 8) {
+            const uint16x8x3_t columns = vld3q_u16(sums + x * 3);
+            const uint16x8_t blocks = vaddq_u16(vaddq_u16(columns.val[0], columns.val[1]), columns.val[2]);
+            const uint16x8_t rounded = vaddq_u16(blocks, vdupq_n_u16(4));
+            const uint32x4_t low = vmull_n_u16(vget_low_u16(rounded), RECIPROCAL_9);
+            const uint32x4_t high = vmull_n_u16(vget_high_u16(rounded), RECIPROCAL_9);
+            vst1_u8(destination + x, vmovn_u16(vcombine_u16(vshrn_n_u32(low, 16), vshrn_n_u32(high, 16))));
+        }
+    } else if (factor == 4) {
+        for (; x + 8 <= width; x += 8) {
+            const uint16x8x4_t columns = vld4q_u16(sums + x * 4);
+            const uint16x8_t blocks = vaddq_u16(
+                    vaddq_u16(columns.val[0], columns.val[1]), vaddq_u16(columns.val[2], columns.val[3]));
+            vst1_u8(destination + x, vrshrn_n_u16(blocks, 4));
+        }
+    }
+#endif
+
+    const int blockArea = factor * factor;
+    for (; x < width; x++) {
+        int sum = 0;
+        for (int i = 0; i < factor; i++) sum += sums[x * factor + i];
+        destination[x] = (uint8_t) ((sum + blockArea / 2) / blockArea);
+    }
+}
+
+void ScaledGrayConverter::computeAreaWeights(int sourceLength, int destinationLength, std::vector<AreaWeight>& weights) {
+    weights.clear();
+
+    // Same computation as OpenCv resize area tables
+    const double scale = (double) sourceLength / destinationLength;
+    for (int destination = 0; destination < destinationLength; destination++) {
+        const double sourceStart = destination * scale;
+        const double sourceEnd = sourceStart + scale;
+        const double cellLength = std::min(scale, sourceLength - sourceStart);
+
+        int firstFull = (int) std::ceil(sourceStart);
+        int endFull = (int) std::floor(sourceEnd);
+        endFull = std::min(endFull, sourceLength - 1);
+        firstFull = std::min(firstFull, endFull);
+
+        if (firstFull - sourceStart > 1e-3) {
+            weights.push_back({firstFull - 1, destination, (float) ((firstFull - sourceStart) / cellLength)});
+        }
+        for (int source = firstFull; source < endFull; source++) {
+            weights.push_back({source, destination, (float) (1.0 / cellLength)});
+        }
+        if (sourceEnd - endFull > 1e-3) {
+            weights.push_back({
+                endFull,
+                destination,
+                (float) (std::min(std::min(sourceEnd - endFull, 1.0), cellLength) / cellLength),
+            });
+        }
+    }
+}
+
+void ScaledGrayConverter::computeFirstWeights(const std::vector<AreaWeight>& weights, int destinationLength,
+                                              std::vector<int>& firstWeights) {
+    firstWeights.assign(destinationLength + 1, (int) weights.size());
+    for (int i = (int) weights.size() - 1; i >= 0; i--) {
+        firstWeights[weights[i].destination] = i;
+    }
+}
+
+void ScaledGrayConverter::convertRowToGray(const uint8_t* rgba, uint8_t* gray, int width) {
+    int x = 0;
+
+#if defined(__ARM_NEON)
+    for (; x + 16 <= width; x += 16) {
+        const uint8x16x4_t pixels = vld4q_u8(rgba + x * 4);
+
+        const uint16x8_t rLow = vmovl_u8(vget_low_u8(pixels.val[0]));
+        const uint16x8_t gLow = vmovl_u8(vget_low_u8(pixels.val[1]));
+        const uint16x8_t bLow = vmovl_u8(vget_low_u8(pixels.val[2]));
+        const uint16x8_t rHigh = vmovl_u8(vget_high_u8(pixels.val[0]));
+        const uint16x8_t gHigh = vmovl_u8(vget_high_u8(pixels.val[1]));
+        const uint16x8_t bHigh = vmovl_u8(vget_high_u8(pixels.val[2]));
+
+        uint32x4_t gray0 = vmull_n_u16(vget_low_u16(rLow), GRAY_R);
+        gray0 = vmlal_n_u16(gray0, vget_low_u16(gLow), GRAY_G);
+        gray0 = vmlal_n_u16(gray0, vget_low_u16(bLow), GRAY_B);
+        uint32x4_t gray1 = vmull_n_u16(vget_high_u16(rLow), GRAY_R);
+        gray1 = vmlal_n_u16(gray1, vget_high_u16(gLow), GRAY_G);
+        gray1 = vmlal_n_u16(gray1, vget_high_u16(bLow), GRAY_B);
+        uint32x4_t gray2 = vmull_n_u16(vget_low_u16(rHigh), GRAY_R);
+        gray2 = vmlal_n_u16(gray2, vget_low_u16(gHigh), GRAY_G);
+        gray2 = vmlal_n_u16(gray2, vget_low_u16(bHigh), GRAY_B);
+        uint32x4_t gray3 = vmull_n_u16(vget_high_u16(rHigh), GRAY_R);
+        gray3 = vmlal_n_u16(gray3, vget_high_u16(gHigh), GRAY_G);
+        gray3 = vmlal_n_u16(gray3, vget_high_u16(bHigh), GRAY_B);
+
+        // Rounding shift, same as the OpenCv descale
+        const uint16x8_t grayLow = vcombine_u16(vrshrn_n_u32(gray0, GRAY_SHIFT), vrshrn_n_u32(gray1, GRAY_SHIFT));
+        const uint16x8_t grayHigh = vcombine_u16(vrshrn_n_u32(gray2, GRAY_SHIFT), vrshrn_n_u32(gray3, GRAY_SHIFT));
+        vst1q_u8(gray + x, vcombine_u8(vmovn_u16(grayLow), vmovn_u16(grayHigh)));
+    }
+#endif
+
+    for (; x < width; x++) {
+        const uint8_t* pixel = rgba + x * 4;
+        gray[x] = (uint8_t) ((pixel[0] * GRAY_R + pixel[1] * GRAY_G + pixel[2] * GRAY_B + (1 << (GRAY_SHIFT - 1)))
+                >> GRAY_SHIFT);
+    }
+}
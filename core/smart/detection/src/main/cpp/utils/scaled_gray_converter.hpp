@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCALED_GRAY_CONVERTER_HPP
+#define KLICK_R_SCALED_GRAY_CONVERTER_HPP
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include <opencv2/core/mat.hpp>
+
+#include "thread_pool.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Converts a RGBA image into a downscaled gray image in a single pass.
+     *
+     * Equivalent to a cvtColor(RGBA2GRAY) followed by a resize(INTER_AREA), but each source row is converted to gray
+     * and reduced horizontally right away, without the intermediate full size gray image. The destination rows are
+     * split in bands whose source rows fit in the L2 cache, converted concurrently when a thread pool is provided.
+     * Each band can be processed further once converted, while it is still in the cache.
+     *
+     * Only an area of the destination image can be converted, reading only the source pixels contributing to it.
+     *
+     * When the source size is an integer multiple of the destination one, up to [DECIMATION_MAX_FACTOR], each
+     * destination pixel is the mean of a block of gray pixels rounded half up, without weights, as the OpenCv area
+     * interpolation of integer factors.
+     */
+    class ScaledGrayConverter {
+
+    public:
+        /** Called with the destination rows of each band once converted, on the thread converting it. */
+        using BandCallback = std::function<void(int firstRow, int endRow)>;
+
+        /** Maximum integer downscale factor converted by block means. */
+        static constexpr int DECIMATION_MAX_FACTOR = 4;
+
+    private:
+        /** Contribution of a source pixel (or row) to a destination pixel (or row). */
+        struct AreaWeight {
+            int source;
+            int destination;
+            float weight;
+        };
+
+        /** The buffers of a band conversion. One per thread pool worker. */
+        struct BandBuffers {
+            std::vector<uint8_t> grayRow;
+            std::vector<float> scaledRow;
+            std::vector<float> accumulatedRow;
+            /** The sums of the gray block columns, for the integer factors. */
+            std::vector<uint16_t> columnSums;
+        };
+
+        /** The sizes the weights have been computed for. */
+        cv::Size sourceSize = cv::Size(0, 0);
+        cv::Size destinationSize = cv::Size(0, 0);
+
+        /** The horizontal contributions, ordered by source column. */
+        std::vector<AreaWeight> horizontalWeights;
+        /** For each destination column, the index of its first weight in [horizontalWeights]. */
+        std::vector<int> destinationColumnFirstWeight;
+        /** The vertical contributions, ordered by source row. */
+        std::vector<AreaWeight> verticalWeights;
+        /** For each destination row, the index of its first weight in [verticalWeights]. */
+        std::vector<int> destinationRowFirstWeight;
+
+        std::vector<BandBuffers> bandBuffers;
+        /**
+         * Full size gray image, only used when one of the dimensions is upscaled. It is then smaller than the scaled
+         * gray image, and released as soon as a reducing conversion is made.
+         */
+        cv::Mat fullSizeGray = cv::Mat();
+
+        void convertArea(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize, const cv::Rect& area,
+                         ThreadPool* threadPool, int bandAlignment, const BandCallback* onBandConverted);
+        void updateWeights(const cv::Size& source, const cv::Size& destination);
+        /** @return the number of destination rows of each band, a multiple of the alignment. */
+        static int getBandRows(const cv::Mat& rgba, const cv::Size& scaledSize, const cv::Rect& area, int bandAlignment,
+                               int workerCount);
+        void convertBand(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Rect& area, BandBuffers& buffers) const;
+        static void convertBandDecimated(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Rect& area, int factor,
+                                         BandBuffers& buffers);
+        /** @return the integer downscale factor from the source to the destination size, 0 if there is none. */
+        static int getDecimationFactor(const cv::Size& source, const cv::Size& destination);
+
+        static void computeAreaWeights(int sourceLength, int destinationLength, std::vector<AreaWeight>& weights);
+        static void computeFirstWeights(const std::vector<AreaWeight>& weights, int destinationLength,
+                                        std::vector<int>& firstWeights);
+        static void convertRowToGray(const uint8_t* rgba, uint8_t* gray, int width);
+        static void addRowToSums(const uint8_t* gray, uint16_t* sums, int width);
+        static void reduceBlockSums(const uint16_t* sums, uint8_t* destination, int width, int factor);
+
+    public:
+        /**
+         * Convert a RGBA image into a scaled gray image.
+         *
+         * @param rgba the source image, in CV_8UC4.
+         * @param scaledGray the destination image. Allocated if needed.
+         * @param scaledSize the size of the destination image.
+         * @param threadPool the pool to convert the bands on. Can be null to convert on the calling thread only.
+         */
+        void convert(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize, ThreadPool* threadPool);
+
+        /**
+         * Convert a RGBA image into a scaled gray image, notifying each converted band.
+         *
+         * @param rgba the source image, in CV_8UC4.
+         * @param scaledGray the destination image. Allocated if needed.
+         * @param scaledSize the size of the destination image.
+         * @param threadPool the pool to convert the bands on. Can be null to convert on the calling thread only.
+         * @param bandAlignment the first row of each band is a multiple of it.
+         * @param onBandConverted called for each band once converted, possibly concurrently for different bands.
+         */
+        void convert(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize, ThreadPool* threadPool,
+                     int bandAlignment, const BandCallback& onBandConverted);
+
+        /**
+         * Convert an area of a RGBA image into a scaled gray image. The pixels of [scaledGray] outside of the area are
+         * not written.
+         *
+         * @param rgba the source image, in CV_8UC4.
+         * @param scaledGray the destination image. Allocated if needed.
+         * @param scaledSize the size of the destination image.
+         * @param area the area of the destination image to convert, contained in [scaledSize].
+         * @param threadPool the pool to convert the bands on. Can be null to convert on the calling thread only.
+         */
+        void convert(const cv::Mat& rgba, cv::Mat& scaledGray, const cv::Size& scaledSize, const cv::Rect& area,
+                     ThreadPool* threadPool);
+
+        /** @return the memory of the conversion buffers and weights, in bytes. */
+        size_t getMemorySize() const;
+    };
+}
+
+#endif //KLICK_R_SCALED_GRAY_CONVERTER_HPP
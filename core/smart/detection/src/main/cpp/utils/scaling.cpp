@@ -15,6 +15,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
 #include <string>
 #include "log.h"
 #include "scaling.hpp"
@@ -40,6 +41,15 @@ void ScaleRatioManager::computeScaleRatio(const u_int32_t width, const u_int32_t
     } else {
         scaleRatio =  detectionQuality / maxImageDim;
     }
+
+    if (!isIntegerRatioEnabled || scaleRatio == 1) return;
+    for (int factor = INTEGER_RATIO_MIN_FACTOR; factor <= INTEGER_RATIO_MAX_FACTOR; factor++) {
+        const double integerRatio = 1.0 / factor;
+        if (std::abs(scaleRatio - integerRatio) <= integerRatio * INTEGER_RATIO_TOLERANCE) {
+            scaleRatio = integerRatio;
+            return;
+        }
+    }
 }
 
 double ScaleRatioManager::getScaleRatio() const {
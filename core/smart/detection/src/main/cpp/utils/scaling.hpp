@@ -26,6 +26,12 @@ namespace smartautoclicker {
     };
 
 
+    /** The downscale factors the scale ratio can be snapped to, see [ScaleRatioManager::setIntegerRatioEnabled]. */
+    static constexpr int INTEGER_RATIO_MIN_FACTOR = 2;
+    static constexpr int INTEGER_RATIO_MAX_FACTOR = 4;
+    /** Maximum relative difference between the requested scale ratio and the integer one it is snapped to. */
+    static constexpr double INTEGER_RATIO_TOLERANCE = 0.1;
+
     class ScaleRatioManager {
 
     private:
@@ -33,12 +39,22 @@ namespace smartautoclicker {
         long scalingTimeUpdateMs = -1;
         /** Uncorrected scale ratio */
         double scaleRatio = 1;
+        /** True to snap the scale ratio to 1 / n when it is close to it. */
+        bool isIntegerRatioEnabled = false;
 
         static long getUnixTimestampMs();
 
     public:
         void computeScaleRatio(u_int32_t width, u_int32_t height, double detectionQuality, const char* metricsTag);
         double getScaleRatio() const;
+
+        /**
+         * Enable or disable the snapping of the scale ratio to 1/2, 1/3 or 1/4, when it is within
+         * [INTEGER_RATIO_TOLERANCE] of the ratio of the requested detection quality. The screen images are then
+         * downscaled by averaging blocks of pixels, a lot faster than an arbitrary ratio.
+         * Applied from the next [computeScaleRatio].
+         */
+        void setIntegerRatioEnabled(bool enabled) { isIntegerRatioEnabled = enabled; }
     };
 }
 
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <opencv2/core/utility.hpp>
+
+#include "scratch_arena.hpp"
+
+using namespace smartautoclicker;
+
+
+size_t ScratchArena::getMatSize(int rows, int cols, int type) {
+    const size_t size = (size_t) std::max(rows, 0) * (size_t) std::max(cols, 0) * CV_ELEM_SIZE(type);
+    return (size + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+void ScratchArena::reserve(size_t size) {
+    usedSize = 0;
+    requestedSize = 0;
+    if (size <= capacity) return;
+
+    buffer = std::make_unique<uint8_t[]>(size + ALIGNMENT);
+    data = cv::alignPtr(buffer.get(), (int) ALIGNMENT);
+    capacity = size;
+}
+
+void ScratchArena::reset() {
+    // Only grows while the matchings are bigger than all previous ones, allocations are then stable
+    if (requestedSize > capacity) reserve(requestedSize);
+
+    usedSize = 0;
+    requestedSize = 0;
+}
+
+cv::Mat ScratchArena::allocate(int rows, int cols, int type) {
+    const size_t size = getMatSize(rows, cols, type);
+    requestedSize += size;
+
+    if (usedSize + size > capacity) return { rows, cols, type };
+
+    cv::Mat mat(rows, cols, type, data + usedSize);
+    usedSize += size;
+    return mat;
+}
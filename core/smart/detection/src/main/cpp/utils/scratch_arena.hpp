@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_SCRATCH_ARENA_HPP
+#define KLICK_R_SCRATCH_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <opencv2/core/mat.hpp>
+
+namespace smartautoclicker {
+
+    /**
+     * Bump allocator for the scratch matrices of a matching.
+     *
+     * The matrices sizes change with each condition and detection area, and creating them with OpenCv reallocates
+     * their memory each time. The arena memory is allocated once and the matrices are headers on it, valid until the
+     * next [reset]. If a matching needs more than the arena capacity, the matrices are allocated on the heap as
+     * usual, and the arena grows to the required size on the next [reset].
+     */
+    class ScratchArena {
+
+    private:
+        /** Alignment of each matrix data, same as the OpenCv allocator. */
+        static constexpr size_t ALIGNMENT = 64;
+
+        std::unique_ptr<uint8_t[]> buffer = nullptr;
+        /** The first aligned byte of [buffer]. */
+        uint8_t* data = nullptr;
+        size_t capacity = 0;
+
+        /** Number of bytes given to the matrices since the last [reset]. */
+        size_t usedSize = 0;
+        /** Number of bytes requested since the last [reset], including the ones allocated on the heap. */
+        size_t requestedSize = 0;
+
+    public:
+        ScratchArena() = default;
+
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+        ScratchArena(ScratchArena&&) = default;
+        ScratchArena& operator=(ScratchArena&&) = default;
+
+        /** @return the number of bytes taken in the arena by a matrix. */
+        static size_t getMatSize(int rows, int cols, int type);
+
+        /**
+         * Ensure the arena can hold at least the provided number of bytes.
+         * Invalidates all matrices given since the last [reset].
+         */
+        void reserve(size_t size);
+
+        /**
+         * Release all matrices given by the arena, growing it if the previous use didn't fit in it.
+         * Their memory will be reused by the next [allocate] calls.
+         */
+        void reset();
+
+        /**
+         * Get a matrix from the arena, or from the heap if the arena is full.
+         * The content of the matrix is not initialized, and it is valid until the next [reset] or [reserve].
+         */
+        cv::Mat allocate(int rows, int cols, int type);
+
+        size_t getCapacity() const { return capacity; }
+    };
+}
+
+#endif //KLICK_R_SCRATCH_ARENA_HPP
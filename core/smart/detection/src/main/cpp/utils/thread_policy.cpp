@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "thread_policy.hpp"
+
+using namespace smartautoclicker;
+
+
+/** Tag for the Android logcat. */
+static constexpr char const* LOG_TAG = "ThreadPolicy";
+
+/** @return the maximum frequency of a core, in kHz, or 0 if it is unknown. */
+static long getCoreMaxFrequency(int core) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", core);
+
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) return 0;
+
+    long frequency = 0;
+    if (fscanf(file, "%ld", &frequency) != 1) frequency = 0;
+    fclose(file);
+
+    return frequency;
+}
+
+/** @return the cores that are not in the slowest cluster, or all cores if they all have the same speed. */
+static const cpu_set_t& getBigCores() {
+    static const cpu_set_t bigCores = [] {
+        const int coreCount = std::min((int) sysconf(_SC_NPROCESSORS_CONF), CPU_SETSIZE);
+
+        long minFrequency = -1;
+        for (int core = 0; core < coreCount; core++) {
+            const long frequency = getCoreMaxFrequency(core);
+            if (frequency > 0 && (minFrequency < 0 || frequency < minFrequency)) minFrequency = frequency;
+        }
+
+        cpu_set_t cores;
+        CPU_ZERO(&cores);
+        for (int core = 0; core < coreCount; core++) {
+            if (getCoreMaxFrequency(core) > minFrequency) CPU_SET(core, &cores);
+        }
+
+        // Homogeneous cores, or unreadable frequencies: there is nothing to prefer
+        if (CPU_COUNT(&cores) == 0) {
+            for (int core = 0; core < coreCount; core++) CPU_SET(core, &cores);
+        }
+
+        LOGD(LOG_TAG, "Big cores: %1$d/%2$d", CPU_COUNT(&cores), coreCount);
+        return cores;
+    }();
+
+    return bigCores;
+}
+
+/** @return all cores of the device. */
+static cpu_set_t getAllCores() {
+    const int coreCount = std::min((int) sysconf(_SC_NPROCESSORS_CONF), CPU_SETSIZE);
+
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    for (int core = 0; core < coreCount; core++) CPU_SET(core, &cores);
+
+    return cores;
+}
+
+bool ThreadPolicy::applyToCurrentThread() const {
+    const pid_t threadId = gettid();
+    bool isApplied = true;
+
+    const cpu_set_t cores = preferBigCores ? getBigCores() : getAllCores();
+    if (sched_setaffinity(threadId, sizeof(cores), &cores) != 0) {
+        LOGW(LOG_TAG, "Can't set the affinity of thread %1$d", threadId);
+        isApplied = false;
+    }
+
+    if (setpriority(PRIO_PROCESS, (id_t) threadId, priority) != 0) {
+        LOGW(LOG_TAG, "Can't set the priority %1$d of thread %2$d", priority, threadId);
+        isApplied = false;
+    }
+
+    return isApplied;
+}
+
+ScopedThreadPolicy::ScopedThreadPolicy(const ThreadPolicy& policy) {
+    if (policy.isDefault()) return;
+
+    const pid_t threadId = gettid();
+    if (sched_getaffinity(threadId, sizeof(previousAffinity), &previousAffinity) != 0) return;
+    previousPriority = getpriority(PRIO_PROCESS, (id_t) threadId);
+
+    policy.applyToCurrentThread();
+    isApplied = true;
+}
+
+ScopedThreadPolicy::~ScopedThreadPolicy() {
+    if (!isApplied) return;
+
+    const pid_t threadId = gettid();
+    sched_setaffinity(threadId, sizeof(previousAffinity), &previousAffinity);
+    setpriority(PRIO_PROCESS, (id_t) threadId, previousPriority);
+}
@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_THREAD_POLICY_HPP
+#define KLICK_R_THREAD_POLICY_HPP
+
+#include <sched.h>
+
+namespace smartautoclicker {
+
+    /**
+     * The scheduling policy of the native detection threads: the cores they can run on and their priority.
+     * The default policy lets the system schedule the threads as any other.
+     */
+    struct ThreadPolicy {
+        /** True to run only on the cores of the fastest clusters, when the device has cores of different speeds. */
+        bool preferBigCores = false;
+        /** The nice value of the threads, from -20 for the highest priority to 19 for the lowest one. */
+        int priority = 0;
+
+        bool operator==(const ThreadPolicy& other) const {
+            return preferBigCores == other.preferBigCores && priority == other.priority;
+        }
+        bool operator!=(const ThreadPolicy& other) const { return !(*this == other); }
+
+        /** @return true if this is the default policy, leaving the threads as they are. */
+        bool isDefault() const { return *this == ThreadPolicy(); }
+
+        /**
+         * Apply this policy to the calling thread.
+         * @return true if the policy is applied, false if the system refused a part of it.
+         */
+        bool applyToCurrentThread() const;
+    };
+
+    /**
+     * Applies a [ThreadPolicy] to the calling thread for the scope it is declared in, and restores the previous core
+     * affinity and priority of the thread at its end. It does nothing for the default policy.
+     *
+     * The detection calls are made from the threads of a shared dispatcher, they are not kept with the detection
+     * policy once the call returns.
+     */
+    class ScopedThreadPolicy {
+
+    private:
+        /** True if the policy have been applied, and the previous state should be restored. */
+        bool isApplied = false;
+        /** The core affinity of the thread before the policy. */
+        cpu_set_t previousAffinity;
+        /** The priority of the thread before the policy. */
+        int previousPriority = 0;
+
+    public:
+        explicit ScopedThreadPolicy(const ThreadPolicy& policy);
+        ~ScopedThreadPolicy();
+
+        ScopedThreadPolicy(const ScopedThreadPolicy&) = delete;
+        ScopedThreadPolicy& operator=(const ScopedThreadPolicy&) = delete;
+    };
+}
+
+#endif //KLICK_R_THREAD_POLICY_HPP
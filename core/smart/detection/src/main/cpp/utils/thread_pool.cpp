@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <unistd.h>
+
+#include "log.h"
+#include "thread_pool.hpp"
+
+using namespace smartautoclicker;
+
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    for (unsigned int i = 0; i <= threadCount; i++) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    threadIds.resize(threadCount, 0);
+    for (unsigned int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, (int) i);
+    }
+
+    LOGD(LOG_TAG, "Created with %1$d threads", threadCount);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        isStopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+unsigned int ThreadPool::getDefaultThreadCount() {
+    unsigned int coreCount = std::thread::hardware_concurrency();
+    if (coreCount <= 1) return 0;
+
+    return std::min(coreCount - 1, MAX_DEFAULT_THREAD_COUNT);
+}
+
+unsigned int ThreadPool::getMaxThreadCount() {
+    unsigned int coreCount = std::thread::hardware_concurrency();
+    return coreCount > 1 ? coreCount - 1 : 0;
+}
+
+int ThreadPool::getWorkerCount() const {
+    return (int) queues.size();
+}
+
+void ThreadPool::setThreadPolicy(const ThreadPolicy& policy) {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (threadPolicy == policy) return;
+
+    threadPolicy = policy;
+    threadPolicyGeneration++;
+}
+
+std::vector<int32_t> ThreadPool::getThreadIds() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+
+    std::vector<int32_t> startedIds;
+    for (int32_t threadId : threadIds) {
+        if (threadId != 0) startedIds.push_back(threadId);
+    }
+    return startedIds;
+}
+
+void ThreadPool::parallelFor(int taskCount, const Task& task) {
+    if (taskCount <= 0) return;
+
+    std::lock_guard<std::mutex> dispatchLock(dispatchMutex);
+    const int callerIndex = getWorkerCount() - 1;
+
+    // No threads, no need to dispatch anything
+    if (threads.empty()) {
+        for (int i = 0; i < taskCount; i++) task(i, callerIndex);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        currentTask.store(&task);
+        pendingTaskCount = taskCount;
+
+        for (int i = 0; i < taskCount; i++) {
+            WorkerQueue& queue = *queues[i % queues.size()];
+            std::lock_guard<std::mutex> queueLock(queue.mutex);
+            queue.taskIndexes.push_back(i);
+        }
+
+        generation++;
+    }
+    workAvailable.notify_all();
+
+    // The calling thread works too, and then waits for the others
+    executeTasks(callerIndex);
+
+    std::unique_lock<std::mutex> lock(stateMutex);
+    workCompleted.wait(lock, [this] { return pendingTaskCount == 0; });
+    currentTask.store(nullptr);
+}
+
+void ThreadPool::workerLoop(int workerIndex) {
+    uint64_t lastGeneration = 0;
+    uint64_t lastPolicyGeneration = 0;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        threadIds[workerIndex] = (int32_t) gettid();
+    }
+
+    while (true) {
+        ThreadPolicy policy;
+        bool isPolicyChanged;
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            workAvailable.wait(lock, [&] { return isStopping || generation != lastGeneration; });
+            if (isStopping) return;
+            lastGeneration = generation;
+
+            isPolicyChanged = threadPolicyGeneration != lastPolicyGeneration;
+            lastPolicyGeneration = threadPolicyGeneration;
+            policy = threadPolicy;
+        }
+
+        // Applied outside of the lock, the system calls can take some time
+        if (isPolicyChanged) policy.applyToCurrentThread();
+
+        executeTasks(workerIndex);
+    }
+}
+
+void ThreadPool::executeTasks(int workerIndex) {
+    int taskIndex;
+    while (popOrSteal(workerIndex, taskIndex)) {
+        (*currentTask.load())(taskIndex, workerIndex);
+
+        std::lock_guard<std::mutex> lock(stateMutex);
+        if (--pendingTaskCount == 0) workCompleted.notify_all();
+    }
+}
+
+bool ThreadPool::popOrSteal(int workerIndex, int& taskIndex) {
+    // First, try from our own queue
+    {
+        WorkerQueue& ownQueue = *queues[workerIndex];
+        std::lock_guard<std::mutex> lock(ownQueue.mutex);
+        if (!ownQueue.taskIndexes.empty()) {
+            taskIndex = ownQueue.taskIndexes.front();
+            ownQueue.taskIndexes.pop_front();
+            return true;
+        }
+    }
+
+    // Our queue is empty, steal from the back of the others
+    const int queueCount = (int) queues.size();
+    for (int offset = 1; offset < queueCount; offset++) {
+        WorkerQueue& otherQueue = *queues[(workerIndex + offset) % queueCount];
+        std::lock_guard<std::mutex> lock(otherQueue.mutex);
+        if (!otherQueue.taskIndexes.empty()) {
+            taskIndex = otherQueue.taskIndexes.back();
+            otherQueue.taskIndexes.pop_back();
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_THREAD_POOL_HPP
+#define KLICK_R_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "thread_policy.hpp"
+
+namespace smartautoclicker {
+
+    /**
+     * Work-stealing pool of native threads.
+     *
+     * The tasks of a [parallelFor] are dispatched between the workers queues. Each worker executes the tasks of its
+     * own queue, and steal the tasks from the back of the other queues once it is empty. The calling thread also
+     * participates and is identified by the last worker index.
+     */
+    class ThreadPool {
+
+    public:
+        /** A task, called with the index of the task and the index of the worker executing it. */
+        using Task = std::function<void(int taskIndex, int workerIndex)>;
+
+    private:
+        /** Tag for the Android logcat. */
+        static constexpr char const* LOG_TAG = "ThreadPool";
+        /** Maximum number of threads created by [getDefaultThreadCount]. */
+        static constexpr unsigned int MAX_DEFAULT_THREAD_COUNT = 3;
+
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<int> taskIndexes;
+        };
+
+        /** The worker threads. */
+        std::vector<std::thread> threads;
+        /** The task queues, one per thread, plus one for the calling thread. */
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+        /** Ensure only one [parallelFor] is executed at a time. */
+        std::mutex dispatchMutex;
+        /** Protects the pool state below. */
+        std::mutex stateMutex;
+        std::condition_variable workAvailable;
+        std::condition_variable workCompleted;
+
+        /** The task of the current [parallelFor]. Read by the workers after a successful pop. */
+        std::atomic<const Task*> currentTask = nullptr;
+        /** Incremented for each [parallelFor], allows the workers to know there is new work. */
+        uint64_t generation = 0;
+        /** The number of tasks of the current [parallelFor] not completed yet. */
+        int pendingTaskCount = 0;
+        /** True when the pool is being destroyed. */
+        bool isStopping = false;
+        /** The scheduling policy of the worker threads, applied by each worker before its next tasks. */
+        ThreadPolicy threadPolicy = ThreadPolicy();
+        /** Incremented for each [setThreadPolicy], allows the workers to know the policy has changed. */
+        uint64_t threadPolicyGeneration = 0;
+        /** The system id of each worker thread, 0 until the thread is started. */
+        std::vector<int32_t> threadIds;
+
+        void workerLoop(int workerIndex);
+        void executeTasks(int workerIndex);
+        bool popOrSteal(int workerIndex, int& taskIndex);
+
+    public:
+        /** @param threadCount the number of threads to create, in addition to the calling thread. */
+        explicit ThreadPool(unsigned int threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** @return the number of threads to use depending on the device cores count. */
+        static unsigned int getDefaultThreadCount();
+        /** @return the maximum number of threads worth creating, one per core in addition to the calling thread. */
+        static unsigned int getMaxThreadCount();
+
+        /** @return the number of workers, including the calling thread. */
+        int getWorkerCount() const;
+
+        /**
+         * Set the scheduling policy of the worker threads. It is applied by each worker before executing its next
+         * tasks, the calling thread is not affected.
+         *
+         * @param policy the new policy of the workers.
+         */
+        void setThreadPolicy(const ThreadPolicy& policy);
+
+        /** @return the system ids of the started worker threads, excluding the calling thread. */
+        std::vector<int32_t> getThreadIds();
+
+        /**
+         * Execute a task for each index in [0..taskCount[, and wait for all of them to complete.
+         *
+         * @param taskCount the number of tasks to execute.
+         * @param task the task to execute.
+         */
+        void parallelFor(int taskCount, const Task& task);
+    };
+}
+
+#endif //KLICK_R_THREAD_POOL_HPP
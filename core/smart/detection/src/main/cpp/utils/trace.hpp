@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KLICK_R_TRACE_HPP
+#define KLICK_R_TRACE_HPP
+
+// Instrumentation of the detection, only compiled with the SMART_DETECTION_TRACING cmake option
+#ifdef SMART_DETECTION_TRACING
+
+#ifdef __ANDROID__
+#include <android/trace.h>
+#endif
+
+namespace smartautoclicker {
+
+    /**
+     * A trace section lasting for the scope it is declared in, visible in the systrace and Perfetto captures.
+     * Outside of Android, the sections are ignored and only the counters are maintained.
+     */
+    class ScopedTraceSection {
+
+    public:
+#ifdef __ANDROID__
+        explicit ScopedTraceSection(const char* name) { ATrace_beginSection(name); }
+        ~ScopedTraceSection() { ATrace_endSection(); }
+#else
+        explicit ScopedTraceSection(const char*) {}
+#endif
+
+        ScopedTraceSection(const ScopedTraceSection&) = delete;
+        ScopedTraceSection& operator=(const ScopedTraceSection&) = delete;
+    };
+}
+
+#define TRACE_CONCAT_INNER(first, second) first##second
+#define TRACE_CONCAT(first, second) TRACE_CONCAT_INNER(first, second)
+
+/** Trace the rest of the current scope in a section with the provided name. */
+#define TRACE_SECTION(name) smartautoclicker::ScopedTraceSection TRACE_CONCAT(traceSection, __LINE__)(name)
+/** Statements maintaining the detection counters, removed when the tracing is disabled. */
+#define TRACE_COUNTERS(...) __VA_ARGS__
+
+#else
+
+#define TRACE_SECTION(name) ((void)0)
+#define TRACE_COUNTERS(...) ((void)0)
+
+#endif // SMART_DETECTION_TRACING
+
+#endif //KLICK_R_TRACE_HPP
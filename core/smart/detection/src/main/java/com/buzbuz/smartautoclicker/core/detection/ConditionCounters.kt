@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+/**
+ * The counters of the detection of a condition, maintained by the native detector.
+ * They are only available when the native library is built with the tracing enabled, with the
+ * detectionNativeTracing build parameter.
+ *
+ * @param conditionId the unique identifier of the condition.
+ * @param matchingCount the number of times the condition have been searched on the screen.
+ * @param reusedCount the number of times the previous result have been reused, as the screen haven't changed.
+ * @param candidateCount the number of candidates verified over all searches.
+ * @param matchingDurationNs the time spent searching the condition over all searches, in nanoseconds.
+ */
+data class ConditionCounters(
+    val conditionId: Long,
+    val matchingCount: Long,
+    val reusedCount: Long,
+    val candidateCount: Long,
+    val matchingDurationNs: Long,
+)
+
+/** Number of values per condition in the native counters array. Must match CONDITION_COUNTERS_STRIDE in native code. */
+internal const val CONDITION_COUNTERS_STRIDE = 5
+
+/** @return the counters of each condition in an array filled by the native detector. */
+internal fun LongArray.toConditionCounters(): List<ConditionCounters> =
+    (0 until size / CONDITION_COUNTERS_STRIDE).map { index ->
+        val offset = index * CONDITION_COUNTERS_STRIDE
+        ConditionCounters(
+            conditionId = get(offset),
+            matchingCount = get(offset + 1),
+            reusedCount = get(offset + 2),
+            candidateCount = get(offset + 3),
+            matchingDurationNs = get(offset + 4),
+        )
+    }
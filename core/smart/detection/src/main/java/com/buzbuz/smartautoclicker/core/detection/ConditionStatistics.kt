@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import android.graphics.Rect
+
+/**
+ * The statistics of the most recent searches of a condition, maintained by the native detector.
+ * The durations are computed on the last [sampleCount] searches only, reused results of an unchanged screen are not
+ * included.
+ *
+ * @param conditionId the unique identifier of the condition.
+ * @param matchingCount the number of times the condition have been searched on the screen.
+ * @param sampleCount the number of most recent searches the other values are computed on.
+ * @param medianDurationNs the median duration of a search, in nanoseconds.
+ * @param p95DurationNs the 95th percentile of the search durations, in nanoseconds.
+ * @param minDurationNs the shortest search, in nanoseconds.
+ * @param maxDurationNs the longest search, in nanoseconds.
+ * @param candidateCount the number of candidates verified over the sampled searches.
+ * @param ocrDurationNs the time spent recognizing the text of the candidates over the sampled searches, in
+ *                      nanoseconds. Always 0 for the image conditions.
+ * @param matchBackend how the results of most sampled searches have been computed.
+ * @param minDetectionQuality the lowest detection quality of the sampled searches. Lower than the scenario one when
+ *                            the quality has been reduced to cool down the device.
+ * @param learnedArea the part of the detection area the condition has almost always been found in, in screen
+ *                    coordinates. Null if it is found all over its detection area, or not often enough to tell. A
+ *                    condition detected in the whole screen can then be converted to a condition detected in this area.
+ */
+data class ConditionStatistics(
+    val conditionId: Long,
+    val matchingCount: Long,
+    val sampleCount: Long,
+    val medianDurationNs: Long,
+    val p95DurationNs: Long,
+    val minDurationNs: Long,
+    val maxDurationNs: Long,
+    val candidateCount: Long,
+    val ocrDurationNs: Long,
+    val matchBackend: MatchBackendType = MatchBackendType.NONE,
+    val minDetectionQuality: Long = 0,
+    val learnedArea: Rect? = null,
+) {
+
+    /** The average number of candidates verified per search. */
+    val averageCandidateCount: Double
+        get() = if (sampleCount > 0) candidateCount.toDouble() / sampleCount else 0.0
+
+    /** The average time spent recognizing text per search, in nanoseconds. */
+    val averageOcrDurationNs: Long
+        get() = if (sampleCount > 0) ocrDurationNs / sampleCount else 0
+}
+
+/**
+ * How the native detector computed the matching results of a condition, selected per search by the native backend
+ * selector. Must match the native MatchBackendType.
+ */
+enum class MatchBackendType(internal val nativeValue: Long) {
+    /** The condition have not been matched. */
+    NONE(0),
+    /** The OpenCv template matching. */
+    OPENCV(1),
+    /** The correlation in the frequency domain, for the big conditions. */
+    FFT(2),
+    /** The kernels specialized by template width, for the small conditions. */
+    SMALL_TEMPLATE(3),
+    /** The direct integer correlation, when the integer matching is enabled. */
+    INTEGER(4),
+    /** The matching pruning the positions that can't reach the threshold. */
+    BOUNDED(5),
+    /** The Vulkan compute shader, when the GPU matching is enabled. */
+    VULKAN(6),
+    /** Found again around its previous position. */
+    NEIGHBOURHOOD(7),
+    /** Found with the coarse to fine matching. */
+    PYRAMID(8),
+    /** Found with the informative pixels of the condition. */
+    SPARSE(9),
+    /** Found with the feature points of the condition, for the conditions detected with their features. */
+    FEATURES(10),
+    /** Correlated at each position of a detection area barely bigger than the condition, such as the exact ones. */
+    DIRECT(11),
+    /** Correlated only at the positions whose mean and variance are compatible with the condition. */
+    PREFILTERED(12),
+    /** Found with the rolling hash of the condition exact pixels, when the exact pixel matching is enabled. */
+    EXACT_PIXELS(13),
+    /** The batched correlation of the small conditions searched in the same area, with the integer matching. */
+    GEMM(14),
+    /** Not detected, proven absent from the statistics of the screen areas, for the conditions expected absent. */
+    ABSENCE_PROOF(15),
+    /** Found in the tiles of its detection area ordered by its previous positions, when the first hit is enabled. */
+    FIRST_HIT(16),
+    /** Found in the part of its detection area it is usually found in, when the learned areas are enabled. */
+    LEARNED_AREA(17),
+    /** The convolution of the conditions searched in the same area on the NPU, when the NNAPI matching is enabled. */
+    NNAPI(18),
+    /** Correlated on the opaque pixels of the condition only, for the condition bitmaps with transparent pixels. */
+    MASKED(19),
+    /** Found with the bits of the high contrast condition first, when the binary matching is enabled. */
+    BINARY(20),
+    /** Found with the edges of the condition, whatever their colors, when the chamfer matching is enabled. */
+    CHAMFER(21),
+    /** Reused from the previous frame when the screen scrolls, when the motion compensation is enabled. */
+    GLOBAL_MOTION(22),
+    /** Found with the pixel differences, when another metric is set with [ImageDetector.setConditionMetrics]. */
+    DIFFERENCE(23);
+
+    internal companion object {
+        fun fromNative(value: Long): MatchBackendType =
+            entries.firstOrNull { it.nativeValue == value } ?: NONE
+    }
+}
+
+/** Number of values per condition in the native statistics array. Must match CONDITION_STATISTICS_STRIDE in native code. */
+internal const val CONDITION_STATISTICS_STRIDE = 15
+
+/** @return the statistics of each condition in an array filled by the native detector. */
+internal fun LongArray.toConditionStatistics(): List<ConditionStatistics> =
+    (0 until size / CONDITION_STATISTICS_STRIDE).map { index ->
+        val offset = index * CONDITION_STATISTICS_STRIDE
+        ConditionStatistics(
+            conditionId = get(offset),
+            matchingCount = get(offset + 1),
+            sampleCount = get(offset + 2),
+            medianDurationNs = get(offset + 3),
+            p95DurationNs = get(offset + 4),
+            minDurationNs = get(offset + 5),
+            maxDurationNs = get(offset + 6),
+            candidateCount = get(offset + 7),
+            ocrDurationNs = get(offset + 8),
+            matchBackend = MatchBackendType.fromNative(get(offset + 9)),
+            minDetectionQuality = get(offset + 10),
+            learnedArea = toLearnedArea(offset + 11),
+        )
+    }
+
+/** @return the learned area at [offset] in an array filled by the native detector, null if it has none. */
+private fun LongArray.toLearnedArea(offset: Int): Rect? {
+    val width = get(offset + 2).toInt()
+    val height = get(offset + 3).toInt()
+    if (width <= 0 || height <= 0) return null
+
+    val left = get(offset).toInt()
+    val top = get(offset + 1).toInt()
+    return Rect(left, top, left + width, top + height)
+}
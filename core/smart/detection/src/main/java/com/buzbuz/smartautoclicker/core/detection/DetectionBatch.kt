@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import android.graphics.Bitmap
+import android.graphics.Rect
+
+import java.nio.ByteBuffer
+
+/**
+ * A batch of conditions to be detected in a single native call with [ImageDetector.detectConditions].
+ *
+ * All conditions are stored in primitive arrays and the results in a direct buffer, allowing the native code to read
+ * the conditions and write the results without any allocation or call back to the JVM. The batch is meant to be reused between detections: call [clear],
+ * [add] each condition, and then read the results for the first [processedCount] conditions.
+ *
+ * @param initialCapacity the initial number of conditions the batch can hold without growing its arrays.
+ */
+class DetectionBatch(initialCapacity: Int = DEFAULT_CAPACITY) {
+
+    /** The operator between the conditions of the batch. Must be [OPERATOR_AND] or [OPERATOR_OR]. */
+    var operator: Int = OPERATOR_AND
+    /** The number of conditions in the batch. */
+    var size: Int = 0
+        private set
+    /**
+     * The number of conditions processed during the last detection.
+     * As the native code short-circuits the [operator], it can be lower than [size].
+     */
+    var processedCount: Int = 0
+        internal set
+
+    internal var conditionIds: LongArray = LongArray(initialCapacity)
+        private set
+    internal var conditionBitmaps: Array<Bitmap?> = arrayOfNulls(initialCapacity)
+        private set
+    internal var conditionParams: IntArray = IntArray(initialCapacity * PARAMS_STRIDE)
+        private set
+    internal var identifyings: Array<String?> = arrayOfNulls(initialCapacity)
+        private set
+    internal var textLanguages: Array<String?> = arrayOfNulls(initialCapacity)
+        private set
+    internal var textWhitelists: Array<String?> = arrayOfNulls(initialCapacity)
+        private set
+    internal var results: ByteBuffer = allocateDetectionResults(initialCapacity)
+        private set
+
+    /** Remove all conditions from the batch. Arrays are kept to be reused. */
+    fun clear() {
+        conditionBitmaps.fill(null, 0, size)
+        identifyings.fill(null, 0, size)
+        textLanguages.fill(null, 0, size)
+        textWhitelists.fill(null, 0, size)
+        size = 0
+        processedCount = 0
+    }
+
+    /**
+     * Add a condition to the batch.
+     *
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if the condition is in the detector
+     *                        template pack, see [ImageDetector.isConditionPacked].
+     * @param area the area of the screen to detect the condition in, null for the whole screen.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the [operator].
+     * @param identifying the recognised information to consider the detection position, or null to use [threshold].
+     * @param textOptions the text recognition options of the condition, or null for the detector configuration.
+     *                    Only used when [identifying] is set.
+     */
+    fun add(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        area: Rect?,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+        identifying: String? = null,
+        textOptions: TextRecognitionOptions? = null,
+    ) {
+        addCondition(
+            conditionId, conditionBitmap, area, threshold, shouldBeDetected, identifying, textOptions,
+            isTextInArea = false,
+            isFeatureMatching = false,
+        )
+    }
+
+    /**
+     * Add a condition located by another condition of the batch, its anchor. The condition is only searched in an
+     * area at a fixed offset from the anchor detection, and is not detected if the anchor isn't.
+     * The anchors are only resolved by the [ScenarioPlan], see [ScenarioPlan.addAnchoredCondition].
+     *
+     * @param conditionId the unique identifier of the condition.
+     * @param anchorIndex the index of the anchor condition in the batch. It can't be anchored itself.
+     * @param anchorArea the area to detect the condition in, relative to the center of the anchor detection.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the [operator].
+     * @param identifying the recognised information to consider the detection position, or null to use [threshold].
+     * @param textOptions the text recognition options of the condition, or null for the detector configuration.
+     *                    Only used when [identifying] is set.
+     */
+    internal fun addAnchored(
+        conditionId: Long,
+        anchorIndex: Int,
+        anchorArea: Rect,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+        identifying: String? = null,
+        textOptions: TextRecognitionOptions? = null,
+    ) {
+        addCondition(
+            conditionId, null, null, threshold, shouldBeDetected, identifying, textOptions,
+            isTextInArea = false,
+            isFeatureMatching = false,
+            anchorIndex = anchorIndex,
+            anchorArea = anchorArea,
+        )
+    }
+
+    /**
+     * Add a condition detected with its feature points instead of its pixels. It is found even if it is scaled,
+     * slightly rotated or partially covered on the screen, where the default detection requires loose thresholds.
+     * The confidence rate is the part of the condition feature points found at their expected position.
+     *
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if the condition is in the detector
+     *                        template pack, see [ImageDetector.isConditionPacked].
+     * @param area the area of the screen to detect the condition in, null for the whole screen.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the [operator].
+     */
+    fun addFeatures(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        area: Rect?,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+    ) {
+        addCondition(
+            conditionId, conditionBitmap, area, threshold, shouldBeDetected, null, null,
+            isTextInArea = false,
+            isFeatureMatching = true,
+        )
+    }
+
+    /**
+     * Add a text condition searched directly in an area of the screen, without any condition bitmap. The text lines
+     * of the area are located and recognized, the detected position is the center of the line containing the text.
+     *
+     * @param conditionId the unique identifier of the condition.
+     * @param area the area of the screen to search the text in, null for the whole screen.
+     * @param identifying the text to find.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the [operator].
+     * @param textOptions the text recognition options of the condition, or null for the detector configuration.
+     */
+    fun addTextInArea(
+        conditionId: Long,
+        area: Rect?,
+        identifying: String,
+        shouldBeDetected: Boolean,
+        textOptions: TextRecognitionOptions? = null,
+    ) {
+        addCondition(
+            conditionId, null, area, 0, shouldBeDetected, identifying, textOptions,
+            isTextInArea = true,
+            isFeatureMatching = false,
+        )
+    }
+
+    private fun addCondition(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        area: Rect?,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+        identifying: String?,
+        textOptions: TextRecognitionOptions?,
+        isTextInArea: Boolean,
+        isFeatureMatching: Boolean,
+        anchorIndex: Int = NO_ANCHOR,
+        anchorArea: Rect? = null,
+    ) {
+        if (size == conditionIds.size) grow()
+
+        conditionIds[size] = conditionId
+        conditionBitmaps[size] = conditionBitmap
+        identifyings[size] = identifying
+        textLanguages[size] = textOptions?.language
+        textWhitelists[size] = textOptions?.charWhitelist
+
+        val paramsIndex = size * PARAMS_STRIDE
+        conditionParams[paramsIndex] = area?.left ?: 0
+        conditionParams[paramsIndex + 1] = area?.top ?: 0
+        conditionParams[paramsIndex + 2] = area?.width() ?: 0
+        conditionParams[paramsIndex + 3] = area?.height() ?: 0
+        conditionParams[paramsIndex + 4] = threshold
+        conditionParams[paramsIndex + 5] = if (shouldBeDetected) 1 else 0
+        conditionParams[paramsIndex + 6] = textOptions?.engineMode ?: TEXT_RECOGNITION_ENGINE_MODE_DEFAULT
+        conditionParams[paramsIndex + 7] = if (isTextInArea) 1 else 0
+        conditionParams[paramsIndex + 8] = if (isFeatureMatching) 1 else 0
+        conditionParams[paramsIndex + 9] = anchorIndex
+        conditionParams[paramsIndex + 10] = anchorArea?.left ?: 0
+        conditionParams[paramsIndex + 11] = anchorArea?.top ?: 0
+        conditionParams[paramsIndex + 12] = anchorArea?.width() ?: 0
+        conditionParams[paramsIndex + 13] = anchorArea?.height() ?: 0
+
+        size++
+    }
+
+    /** @return true if the condition at [index] have been detected during the last detection. */
+    fun isDetected(index: Int): Boolean =
+        results.isDetected(index)
+
+    /** @return the horizontal center of the condition at [index], in screen coordinates. */
+    fun getPositionX(index: Int): Int =
+        results.getCenterX(index)
+
+    /** @return the vertical center of the condition at [index], in screen coordinates. */
+    fun getPositionY(index: Int): Int =
+        results.getCenterY(index)
+
+    /** @return the confidence rate of the condition at [index]. */
+    fun getConfidenceRate(index: Int): Double =
+        results.getConfidenceRate(index)
+
+    /** @return true if the detection of the condition at [index] have been degraded to stay in its time budget. */
+    fun isDegraded(index: Int): Boolean =
+        results.isDegraded(index)
+
+    /** @return the counterclockwise orientation the condition at [index] have been found at, in degrees. */
+    fun getAngle(index: Int): Int =
+        results.getAngle(index)
+
+    /** @return the duration of the detection of the condition at [index] during the last detection, in nanoseconds. */
+    fun getDetectionDurationNs(index: Int): Long =
+        results.getDetectionDurationNs(index)
+
+    private fun grow() {
+        val newCapacity = conditionIds.size * 2
+        conditionIds = conditionIds.copyOf(newCapacity)
+        conditionBitmaps = conditionBitmaps.copyOf(newCapacity)
+        conditionParams = conditionParams.copyOf(newCapacity * PARAMS_STRIDE)
+        identifyings = identifyings.copyOf(newCapacity)
+        textLanguages = textLanguages.copyOf(newCapacity)
+        textWhitelists = textWhitelists.copyOf(newCapacity)
+        // Results are only valid after a detection, there is nothing to copy
+        results = allocateDetectionResults(newCapacity)
+    }
+
+    companion object {
+        /** All conditions of the batch must be fulfilled. */
+        const val OPERATOR_AND = 1
+        /** Only one of the conditions of the batch must be fulfilled. */
+        const val OPERATOR_OR = 2
+
+        private const val DEFAULT_CAPACITY = 8
+        /** Number of values per condition in [conditionParams]. Must match BATCH_PARAMS_STRIDE in native code. */
+        private const val PARAMS_STRIDE = 14
+        /** The anchor index of the conditions located by their own area. */
+        private const val NO_ANCHOR = -1
+    }
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import java.nio.ByteBuffer
+
+/**
+ * The occurrences of a condition found by [ImageDetector.detectAllOccurrences], best first.
+ *
+ * The results are written by the native code in a direct buffer, without any allocation or call back to the JVM. The
+ * instance is meant to be reused between detections, the results of the first [count] occurrences are valid until the
+ * next one.
+ */
+class DetectionOccurrences {
+
+    /** The number of occurrences found by the last detection. */
+    var count: Int = 0
+        internal set
+
+    internal val results: ByteBuffer = allocateDetectionResults(MAX_COUNT)
+
+    /** @return the horizontal center of the occurrence at [index], in screen coordinates. */
+    fun getPositionX(index: Int): Int =
+        results.getCenterX(index)
+
+    /** @return the vertical center of the occurrence at [index], in screen coordinates. */
+    fun getPositionY(index: Int): Int =
+        results.getCenterY(index)
+
+    /** @return the confidence rate of the occurrence at [index]. */
+    fun getConfidenceRate(index: Int): Double =
+        results.getConfidenceRate(index)
+
+    companion object {
+        /** Maximum number of occurrences found by a detection. Must match MATCHING_MAX_CANDIDATES in native code. */
+        const val MAX_COUNT = 32
+    }
+}
@@ -17,28 +17,41 @@
 package com.buzbuz.smartautoclicker.core.detection
 
 import android.graphics.Point
-import androidx.annotation.Keep
 
 /**
  * The results of a condition detection.
  * @param isDetected true if the condition have been detected. false if not.
  * @param position contains the center of the detected condition in screen coordinates.
  * @param confidenceRate
+ * @param isDegraded true if the detection have been degraded to stay in the condition time budget, see
+ *                   [ImageDetector.setConditionTimeBudget]. Its result is less accurate.
+ * @param angle the counterclockwise orientation the condition have been found at, in degrees. Always 0 for the
+ *              conditions searched at their own orientation only, see [ImageDetector.setConditionRotations].
  */
 data class DetectionResult(
     var isDetected: Boolean = false,
     val position: Point = Point(),
-    var confidenceRate: Double = 0.0
+    var confidenceRate: Double = 0.0,
+    var isDegraded: Boolean = false,
+    var angle: Int = 0,
 ) {
 
     /**
      * Set the results of the detection.
-     * Used by native code only.
+     * Used by the native detector only, when reading the results from the native buffer.
      */
-    @Keep
-    fun setResults(isDetected: Boolean, centerX: Int, centerY: Int, confidenceRate: Double) {
+    internal fun setResults(
+        isDetected: Boolean,
+        centerX: Int,
+        centerY: Int,
+        confidenceRate: Double,
+        isDegraded: Boolean = false,
+        angle: Int = 0,
+    ) {
         this.isDetected = isDetected
         position.set(centerX, centerY)
         this.confidenceRate = confidenceRate
+        this.isDegraded = isDegraded
+        this.angle = angle
     }
 }
\ No newline at end of file
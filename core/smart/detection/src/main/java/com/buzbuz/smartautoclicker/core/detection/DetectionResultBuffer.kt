@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+
+/*
+ * Detection results written by the native code into a direct ByteBuffer, read without any call back to the JVM.
+ * Each result is DETECTION_RESULT_BYTES long, with the layout of DetectionResultRecord in native code:
+ * isDetected (Int), centerX (Int), centerY (Int), flags (Int), confidenceRate (Double), detectionDurationNs (Long).
+ */
+
+/** Size in bytes of a single detection result. Must match sizeof(DetectionResultRecord) in native code. */
+internal const val DETECTION_RESULT_BYTES = 32
+
+private const val OFFSET_IS_DETECTED = 0
+private const val OFFSET_CENTER_X = 4
+private const val OFFSET_CENTER_Y = 8
+private const val OFFSET_FLAGS = 12
+private const val OFFSET_CONFIDENCE_RATE = 16
+private const val OFFSET_DETECTION_DURATION = 24
+
+/** Flag of a result degraded to stay in its time budget. Must match DetectionResultRecord::FLAG_DEGRADED. */
+private const val FLAG_DEGRADED = 1
+/** Bit position of the angle in the flags. Must match DetectionResultRecord::FLAGS_ANGLE_SHIFT. */
+private const val FLAGS_ANGLE_SHIFT = 16
+
+/** @return a new buffer for [count] detection results, in the native byte order. */
+internal fun allocateDetectionResults(count: Int): ByteBuffer =
+    ByteBuffer.allocateDirect(count * DETECTION_RESULT_BYTES).order(ByteOrder.nativeOrder())
+
+internal fun ByteBuffer.isDetected(index: Int): Boolean =
+    getInt(index * DETECTION_RESULT_BYTES + OFFSET_IS_DETECTED) != 0
+
+internal fun ByteBuffer.getCenterX(index: Int): Int =
+    getInt(index * DETECTION_RESULT_BYTES + OFFSET_CENTER_X)
+
+internal fun ByteBuffer.getCenterY(index: Int): Int =
+    getInt(index * DETECTION_RESULT_BYTES + OFFSET_CENTER_Y)
+
+internal fun ByteBuffer.getConfidenceRate(index: Int): Double =
+    getDouble(index * DETECTION_RESULT_BYTES + OFFSET_CONFIDENCE_RATE)
+
+internal fun ByteBuffer.isDegraded(index: Int): Boolean =
+    (getInt(index * DETECTION_RESULT_BYTES + OFFSET_FLAGS) and FLAG_DEGRADED) != 0
+
+internal fun ByteBuffer.getAngle(index: Int): Int =
+    getInt(index * DETECTION_RESULT_BYTES + OFFSET_FLAGS) ushr FLAGS_ANGLE_SHIFT
+
+internal fun ByteBuffer.getDetectionDurationNs(index: Int): Long =
+    getLong(index * DETECTION_RESULT_BYTES + OFFSET_DETECTION_DURATION)
+
+/** Read the detection result at [index] into [result]. */
+internal fun ByteBuffer.readDetectionResult(index: Int, result: DetectionResult) {
+    result.setResults(
+        isDetected(index), getCenterX(index), getCenterY(index), getConfidenceRate(index), isDegraded(index),
+        getAngle(index))
+}
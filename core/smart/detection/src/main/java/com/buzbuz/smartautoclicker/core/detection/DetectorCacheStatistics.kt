@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+/**
+ * The lookups of a cache of the native detector since its creation, to size the caches from real scenarios.
+ *
+ * @param type the cache.
+ * @param hitCount the number of lookups finding their value in the cache.
+ * @param missCount the number of lookups computing their value.
+ * @param evictionCount the number of values dropped from the cache before being looked up again. The caches scoped
+ *                      to a screen image drop all their values on each new one.
+ * @param sizeBytes the memory held by the cache when the statistics have been read, in bytes.
+ */
+data class DetectorCacheStatistics(
+    val type: DetectorCacheType,
+    val hitCount: Long = 0,
+    val missCount: Long = 0,
+    val evictionCount: Long = 0,
+    val sizeBytes: Long = 0,
+) {
+
+    /** The ratio of the lookups finding their value in the cache, between 0 and 1. */
+    val hitRate: Double
+        get() = if (hitCount + missCount > 0) hitCount.toDouble() / (hitCount + missCount) else 0.0
+}
+
+/** The caches of the native detector. Must match the native CacheType. */
+enum class DetectorCacheType(internal val nativeValue: Int) {
+    /** The processed condition images. A condition loaded from the template pack is a miss. */
+    TEMPLATES(0),
+    /** The texts recognized on the previous screen images. */
+    OCR_TEXTS(1),
+    /** The matchings of the same condition bitmap in the same area, shared on the current screen image. */
+    MATCH_MEMO(2),
+    /** The results of the previous screen image reused in its unchanged areas. */
+    FRAME_DIFF(3),
+    /** The downscaled levels of the screen image shared by the coarse matchings. */
+    PYRAMID(4),
+}
+
+/** Number of values per cache in the native statistics array. Must match CACHE_STATISTICS_STRIDE in native code. */
+internal const val CACHE_STATISTICS_STRIDE = 4
+
+/** @return the statistics of each cache in an array filled by the native detector, in [DetectorCacheType] order. */
+internal fun LongArray.toDetectorCacheStatistics(): List<DetectorCacheStatistics> =
+    DetectorCacheType.entries
+        .filter { type -> (type.nativeValue + 1) * CACHE_STATISTICS_STRIDE <= size }
+        .map { type ->
+            val offset = type.nativeValue * CACHE_STATISTICS_STRIDE
+            DetectorCacheStatistics(
+                type = type,
+                hitCount = get(offset),
+                missCount = get(offset + 1),
+                evictionCount = get(offset + 2),
+                sizeBytes = get(offset + 3),
+            )
+        }
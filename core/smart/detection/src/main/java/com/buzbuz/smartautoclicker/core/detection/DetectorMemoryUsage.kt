@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+/**
+ * The memory held by the native detector, by category, in bytes.
+ *
+ * @param screenImages the screen pixels copied by the detector, and their processed gray images.
+ * @param colorIntegral the color sums of the current screen image, for the color verification of the candidates.
+ * @param templates the processed conditions kept in the detector cache.
+ * @param matchingScratch the scratch memory of the matching threads.
+ * @param ocrEngines the trained data loaded by the OCR engines, estimated from their file sizes. Shared by all
+ *                   detectors of the process.
+ * @param ocrTexts the texts recognized on the previous screen images.
+ * @param budget the memory budget the detector degrades to fit in, 0 if unbounded.
+ */
+data class DetectorMemoryUsage(
+    val screenImages: Long = 0,
+    val colorIntegral: Long = 0,
+    val templates: Long = 0,
+    val matchingScratch: Long = 0,
+    val ocrEngines: Long = 0,
+    val ocrTexts: Long = 0,
+    val budget: Long = 0,
+) {
+
+    /** The memory of all categories, in bytes. */
+    val total: Long
+        get() = screenImages + colorIntegral + templates + matchingScratch + ocrEngines + ocrTexts
+}
+
+/**
+ * The memory pressure the native detector sheds its caches for. Each level sheds the caches of the lower ones in
+ * addition to its own, from the cheapest to rebuild to the most costly. Must match MemoryPressure in native code.
+ */
+enum class DetectorMemoryPressure(internal val value: Int) {
+    /** All caches are kept. */
+    NONE(0),
+    /** The texts recognized on the previous screen images are dropped. */
+    OCR_TEXTS(1),
+    /** The pyramid levels of the screen images are released, and the coarse detections skipped. */
+    PYRAMID(2),
+    /** Only the processed conditions detected on the last screen image are kept. */
+    TEMPLATES(3),
+    /** Only the current screen image is kept, the next one is no longer prepared in the background. */
+    FRAMES(4),
+}
+
+/** Number of values in the native memory usage array. Must match MEMORY_USAGE_VALUES_COUNT in native code. */
+internal const val MEMORY_USAGE_VALUES_COUNT = 7
+
+/** @return the memory usage in an array filled by the native detector. */
+internal fun LongArray.toDetectorMemoryUsage(): DetectorMemoryUsage =
+    if (size < MEMORY_USAGE_VALUES_COUNT) DetectorMemoryUsage()
+    else DetectorMemoryUsage(
+        screenImages = get(0),
+        colorIntegral = get(1),
+        templates = get(2),
+        matchingScratch = get(3),
+        ocrEngines = get(4),
+        ocrTexts = get(5),
+        budget = get(6),
+    )
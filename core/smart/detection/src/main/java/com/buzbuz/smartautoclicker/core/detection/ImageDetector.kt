@@ -18,6 +18,8 @@ package com.buzbuz.smartautoclicker.core.detection
 
 import android.graphics.Bitmap
 import android.graphics.Rect
+import android.view.Surface
+import java.nio.ByteBuffer
 
 /**
  * Detects bitmaps within other bitmaps for conditions detection on the screen.
@@ -40,60 +42,793 @@ interface ImageDetector : AutoCloseable {
      */
     fun setScreenMetrics(metricsKey: String, screenBitmap: Bitmap, detectionQuality: Double)
 
+    /**
+     * Set the current metrics of the screen.
+     * Same as the [Bitmap] version, for a screen provided via a pixel buffer.
+     *
+     * @param screenWidth the width of the screen, in pixels.
+     * @param screenHeight the height of the screen, in pixels.
+     * @param detectionQuality the quality of the detection. The higher the preciser, the lower the faster. Must be
+     *                         contained in [DETECTION_QUALITY_MIN] and [DETECTION_QUALITY_MAX].
+     */
+    fun setScreenMetrics(metricsKey: String, screenWidth: Int, screenHeight: Int, detectionQuality: Double)
+
+    /**
+     * Enable or disable the pyramid matching.
+     * When enabled, conditions are first searched in a downscaled screen image, and only the best candidates are
+     * refined at the detection quality. It is a lot faster on high resolution screens, but small conditions with few
+     * details are more likely to be missed. Each condition is downscaled as much as its size and details allow.
+     *
+     * @param enabled true to enable the pyramid matching, false to match on the whole screen image. Default is false.
+     */
+    fun setPyramidMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the sparse matching.
+     * When enabled, big conditions are first searched using only their most detailed pixels, and only the best
+     * candidates are verified with the complete condition. It is a lot faster for big conditions with a plain
+     * background, but conditions with few details are more likely to be missed.
+     *
+     * @param enabled true to enable the sparse matching, false to match the complete conditions. Default is false.
+     */
+    fun setSparseMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the binary matching.
+     * When enabled, high contrast conditions such as texts, icons and outlines are first searched using only their
+     * pixels brighter than their surroundings, compared 64 at once, and only the best candidates are verified with the
+     * complete condition. It is a lot faster for those conditions, but conditions made of soft gradients are matched
+     * as usual.
+     *
+     * @param enabled true to enable the binary matching, false to match the complete conditions. Default is false.
+     */
+    fun setBinaryMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the chamfer matching.
+     * When enabled, conditions with a clear shape such as buttons and icons are first searched using only their
+     * edges, and the best candidates are verified with the complete condition. If the colors of a condition have been
+     * changed, as games often do with their buttons, it is still detected on its shape alone, with the shape
+     * similarity as confidence.
+     *
+     * @param enabled true to enable the chamfer matching, false to match the complete conditions. Default is false.
+     */
+    fun setChamferMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the motion compensation.
+     * When enabled, the scrolling of the screen content between two frames is estimated. When a list or a map scrolls,
+     * the conditions detected on the previous frame are detected at their scrolled position without being searched
+     * again, and the other ones are only searched in the newly visible parts of their detection area.
+     *
+     * @param enabled true to enable the motion compensation, false to search the changed areas again. Default is false.
+     */
+    fun setMotionCompensationEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the animated areas exclusion.
+     * When enabled, the parts of the screen changing on most screen images, such as a blinking cursor or an idle
+     * animation, are learned. When they are not in the detection area of a condition, their changes no longer make the
+     * screen changed for [setupDetection], nor end [waitForRegionChange].
+     *
+     * @param enabled true to learn the animated areas, false to only ignore the [setExcludedAreas].
+     * Default is false.
+     */
+    fun setAnimatedAreasExclusionEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the first hit matching.
+     * When enabled, the conditions expected to be detected are searched tile by tile in their detection area,
+     * starting where they have been found the most, and the search stops at the first detection. It is a lot faster
+     * for the conditions usually on screen, but the reported position is the first one found, not the best one.
+     *
+     * @param enabled true to enable the first hit matching, false to search the whole detection areas.
+     * Default is false.
+     */
+    fun setFirstHitMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the learned area matching.
+     * When enabled, a condition almost always found in the same part of its detection area is searched there first,
+     * and in its whole detection area only when not found in it. The learned areas are reported with the
+     * [getConditionStatistics], see [ConditionStatistics.learnedArea].
+     *
+     * @param enabled true to enable the learned area matching, false to search the whole detection areas.
+     * Default is false.
+     */
+    fun setLearnedAreaMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the integer scale ratio.
+     * When enabled, the scale ratio of the detection quality is snapped to 1/2, 1/3 or 1/4 of the screen size when it
+     * is close to it, allowing a lot faster screen image downscaling. Applied from the next [setScreenMetrics].
+     *
+     * @param enabled true to snap the scale ratio, false to always use the detection quality one.
+     * Default is false.
+     */
+    fun setIntegerScaleRatioEnabled(enabled: Boolean)
+
+    /**
+     * Cancel or resume the detections. Can be called from any thread, while another one is detecting.
+     * While cancelled, the running detection returns within a few milliseconds, between two conditions, two
+     * candidates or two recognized words, and the following ones return right away. Their conditions are not detected.
+     *
+     * @param cancelled true to cancel the detections, false to resume them.
+     */
+    fun setCancelled(cancelled: Boolean)
+
+    /**
+     * Wait for an area of the screen to change, from the tile signatures of the screen images set with
+     * [setupDetection] after this call. They must be set by another thread during the wait. The changed tiles are
+     * accumulated from one image to another, an animation crossing the area is detected once it has changed enough
+     * of them. Returns right away while the detections are cancelled with [setCancelled].
+     *
+     * @param area the area of the screen to wait for.
+     * @param changeThreshold the part of the area that must have changed since the call, between 0 and 1. 0 to
+     * return on the first change.
+     * @param timeoutMs the maximum duration of the wait, in milliseconds.
+     *
+     * @return true if the area has changed, false if the wait has timed out or has been cancelled.
+     */
+    fun waitForRegionChange(area: Rect, changeThreshold: Double, timeoutMs: Long): Boolean
+
+    /**
+     * Set the resize factors of the conditions for the multi scale matching.
+     * When a condition is not found at its size, it is searched resized by each of those factors, and the best result
+     * is reported. This allows to detect conditions captured on a screen with another resolution or density, at the
+     * cost of a detection per factor for the conditions not found.
+     *
+     * @param scales the resize factors of the conditions, empty to disable the multi scale matching. Default is empty.
+     *               [MULTI_SCALE_MATCHING_DEFAULT_SCALES] covers the usual density differences between devices.
+     */
+    fun setMultiScaleMatching(scales: FloatArray)
+
+    /**
+     * Set the jitter of the exact conditions, detected in an area of their own size.
+     * Their area is extended by the jitter on each side, so they are still found when their UI shifts slightly. Those
+     * small areas are correlated directly at each position, without the cost of a complete matching.
+     *
+     * @param pixels the jitter in screen pixels, 0 to only search the exact position of the conditions. Default is 0.
+     */
+    fun setExactMatchingJitter(pixels: Int)
+
+    /**
+     * Enable or disable the exact pixel matching.
+     * When enabled, the conditions with a threshold of 1 or less are only detected where the screen has their exact
+     * pixels, searched with a rolling hash whose cost doesn't depend on the condition size. A condition slightly
+     * different on the screen, such as in a compressed video, is not detected anymore.
+     *
+     * @param enabled true to search the near exact conditions with their pixels, false to correlate them. Default is
+     *                false.
+     */
+    fun setExactPixelMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the histogram color verification.
+     * When enabled, the candidates with the same average color as a condition must also have a similar color
+     * distribution to be detected. It rejects more wrong candidates, allowing looser thresholds, at the cost of a few
+     * more computations for each candidate.
+     *
+     * @param enabled true to compare the color histograms, false to compare the average colors only. Default is false.
+     */
+    fun setHistogramColorVerificationEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the scaled color verification.
+     * When enabled, the average colors of the candidates are computed on the screen downscaled at the detection
+     * quality instead of the full size screen. It reduces a lot the memory written for each screen image, but the
+     * average color of the small conditions is less accurate.
+     *
+     * @param enabled true to compare the average colors at the detection quality, false to compare them at full size.
+     *                Default is false.
+     */
+    fun setScaledColorVerificationEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the frame allocator.
+     * When enabled, the screen images kept by the detector are allocated with rows aligned on the cache lines, in
+     * huge pages when the device supports them, and their memory is reused from one frame to the next.
+     *
+     * @param enabled true to allocate the screen images with the frame allocator. Default is false.
+     */
+    fun setFrameAllocatorEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the conditions prefiltering.
+     * When enabled, the conditions of a scenario searched in the same area with the same size are all checked at once
+     * against the brightness of that area on each frame, and the ones that can't be there are not searched at all.
+     * The text of the conditions with an identifying text can be recognized at any candidate position, even one below
+     * the threshold, so they are never skipped. Their candidates are ranked by how close their brightness is to the
+     * condition one instead, and the most plausible ones are recognized first.
+     *
+     * @param enabled true to prefilter the scenario conditions. Default is false.
+     */
+    fun setConditionPrefilterEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the integer matching.
+     * When enabled, the conditions are correlated with the screen using integer computations instead of floating
+     * point ones, except for the biggest conditions. It is faster on most devices, and the confidence rates only
+     * differ from the floating point ones by their rounding. The small conditions searched in the same area are also
+     * correlated together, reading the screen pixels once for all of them.
+     *
+     * @param enabled true to correlate in integers, false to use the floating point matching. Default is false.
+     */
+    fun setIntegerMatchingEnabled(enabled: Boolean)
+
+    /**
+     * Enable or disable the GPU matching.
+     * When enabled, the conditions are correlated with the screen by a Vulkan compute shader, all conditions of a
+     * batch at once, instead of on the CPU. The conditions the GPU can't match are still matched on the CPU.
+     * Only available when the native library is built with the detectionNativeVulkan build parameter.
+     *
+     * @param enabled true to match on the GPU when possible, false to match on the CPU only. Default is false.
+     *
+     * @return true if the GPU matching is enabled, false if disabled or not supported by the device or the build.
+     */
+    fun setGpuMatchingEnabled(enabled: Boolean): Boolean
+
+    /**
+     * Enable or disable the NNAPI matching.
+     * When enabled, the conditions searched in the same area with the same size are correlated together by a single
+     * convolution on the neural networks accelerator of the device, and only their best positions are verified on the
+     * CPU. The conditions the accelerator can't match are still matched on the CPU.
+     * Only available when the native library is built with the detectionNativeNnapi build parameter, on Android 10
+     * and above.
+     *
+     * @param enabled true to match on the accelerator when possible, false to match without it. Default is false.
+     *
+     * @return true if the NNAPI matching is enabled, false if disabled or not supported by the device or the build.
+     */
+    fun setNnapiMatchingEnabled(enabled: Boolean): Boolean
+
+    /**
+     * Set the number of screen images to detect per second, used to compute the [getFrameDelayMs] pacing.
+     *
+     * @param detectionsPerSecond the target detection rate, or 0 to detect the screen images as fast as possible.
+     *                            Default is 0.
+     */
+    fun setTargetDetectionRate(detectionsPerSecond: Double)
+
+    /**
+     * Complete the detection of the current screen image, and get the delay to wait before setting up the next one.
+     * The delay is the remaining time of the target detection interval once the measured cost of the last screen
+     * images is paid. It grows while the screen is unchanged, and is reset as soon as it changes.
+     *
+     * @return the delay in milliseconds, 0 to set up the next screen image immediately.
+     */
+    fun getFrameDelayMs(): Long
+
+    /**
+     * Get the telemetry of the last detected screen images, one per line: their setup, conditions matching and total
+     * durations, their matched and reused conditions counts, and the matching backends used. The records are kept in
+     * a fixed size ring during the whole detection, and can be read from any thread without blocking it.
+     *
+     * @param maxCount the maximum number of screen images to get, from the newest one.
+     *
+     * @return the formatted records, from the oldest to the newest screen image.
+     */
+    fun getFrameTelemetry(maxCount: Int): String
+
+    /**
+     * Set the number of native threads processing the screen images and the detection batches concurrently, in
+     * addition to the calling thread. The rows of each screen image are split between them.
+     *
+     * @param threadCount the number of threads, clamped to the cores count. 0 to use the calling thread only, negative
+     *                    for the default count depending on the device, which is the default.
+     */
+    fun setThreadCount(threadCount: Int)
+
+    /**
+     * Set the scheduling policy of the detection threads. The native workers keep it, while the threads calling this
+     * detector only have it during the calls.
+     *
+     * @param preferBigCores true to run the detection on the fastest cores of the device only. Default is false.
+     * @param threadPriority the Linux priority of the detection threads, from -20 (highest) to 19 (lowest), such as
+     *                       the [android.os.Process] THREAD_PRIORITY values. Default is 0.
+     */
+    fun setThreadPolicy(preferBigCores: Boolean, threadPriority: Int)
+
+    /**
+     * Enable or disable the performance hints.
+     * When enabled, the cost of each detected frame is reported against the target detection interval to an Android
+     * performance hint session, letting the system adapt the cores frequencies to the detection workload.
+     * Only available since Android 13.
+     *
+     * @param enabled true to report the frame costs, false to stop. Default is false.
+     *
+     * @return true if the performance hints are enabled, false if disabled or not supported by the device.
+     */
+    fun setPerformanceHintEnabled(enabled: Boolean): Boolean
+
+    /**
+     * Set the configuration of the text recognition engine used by the text conditions.
+     * The engines are shared by all detectors of the process, and only loaded on the first text condition detection.
+     *
+     * @param dataPath the directory containing the tessdata directory, or null to use the TESSDATA_PREFIX environment
+     *                 variable.
+     * @param language the language of the trained data to load. Default is [TEXT_RECOGNITION_DEFAULT_LANGUAGE].
+     * @param pageSegmentationMode the Tesseract page segmentation mode. Default is
+     *                             [TEXT_RECOGNITION_DEFAULT_PAGE_SEGMENTATION_MODE].
+     */
+    fun setTextRecognitionConfig(dataPath: String?, language: String, pageSegmentationMode: Int)
+
+    /**
+     * Open the template pack of a scenario, written by [writeTemplatePack] during a previous run.
+     * The conditions in the pack are loaded from it instead of being processed from their bitmap, as long as the
+     * screen metrics are the same as when the pack was written.
+     *
+     * A pack is identified by the conditions ids only: it must not be opened if a condition bitmap has changed
+     * since it was written.
+     *
+     * @param path the path of the pack file.
+     *
+     * @return true if the pack has been opened, false if it doesn't exist or is invalid.
+     */
+    fun openTemplatePack(path: String): Boolean
+
+    /**
+     * Write all conditions processed since the last [setScreenMetrics] call into a template pack.
+     *
+     * @param path the path of the pack file. Replaced if it already exists.
+     *
+     * @return true if the pack has been written.
+     */
+    fun writeTemplatePack(path: String): Boolean
+
+    /**
+     * Tells if a condition can be loaded from the opened template pack with the current screen metrics.
+     * If true, the condition bitmap is not needed in a [DetectionBatch].
+     *
+     * @param conditionId the unique identifier of the condition.
+     */
+    fun isConditionPacked(conditionId: Long): Boolean
+
+    /**
+     * Tells if a condition can be detected without its bitmap with the current screen metrics, because it is in the
+     * opened template pack or its processed template is still in the detector cache.
+     * The cache is trimmed to its memory budget by [setupDetection], this must be called after it for each frame.
+     *
+     * @param conditionId the unique identifier of the condition.
+     */
+    fun isConditionCached(conditionId: Long): Boolean
+
+    /**
+     * Process conditions for the current screen metrics before their first detection.
+     * Conditions are otherwise processed during their first detection, slowing down the first detections after a
+     * [setScreenMetrics] call. The bitmaps are processed concurrently by the detector threads.
+     *
+     * @param conditionIds the unique identifiers of the conditions.
+     * @param conditionBitmaps the conditions bitmaps, at the same index than their identifier. Can be null for the
+     *                         conditions already processed or loaded from the template pack.
+     *
+     * @return the number of conditions ready to be detected, already processed ones included.
+     */
+    fun prepareConditions(conditionIds: LongArray, conditionBitmaps: Array<Bitmap?>): Int
+
+    /**
+     * Process conditions for the current screen metrics from their image files, as for [prepareConditions], without
+     * creating their bitmaps. The files are read natively, concurrently by the detector threads.
+     *
+     * @param conditionIds the unique identifiers of the conditions.
+     * @param conditionPaths the absolute paths of the conditions files, holding their raw ARGB_8888 pixels, at the
+     *                       same index than their identifier. Can be null for the conditions already processed or
+     *                       loaded from the template pack.
+     * @param conditionSizes the width and height of each condition, at the same index than their identifier.
+     *
+     * @return the number of conditions ready to be detected, already processed ones included.
+     */
+    fun prepareConditionFiles(conditionIds: LongArray, conditionPaths: Array<String?>, conditionSizes: IntArray): Int
+
+    /**
+     * Drop the processed conditions and their detection history, keeping all other conditions, the current screen
+     * image and the statistics. Their template in the opened template pack is not used anymore.
+     * Call it when the bitmap of conditions have been edited or when they have been deleted, to keep using this
+     * detector: the edited ones are processed again from their new bitmap by [prepareConditions] or by their next
+     * detection.
+     *
+     * @param conditionIds the unique identifiers of the conditions.
+     */
+    fun removeConditions(conditionIds: LongArray)
+
+    /**
+     * Set the conditions that can't be detected until an event is enabled, such as the ones of the disabled events
+     * that the actions of the enabled events can't enable. Their processed images are kept compressed, and the ones of
+     * the conditions not idle anymore are restored at once, before their first detection.
+     * An idle condition can still be detected, its processed images are then restored during this detection.
+     *
+     * @param conditionIds the unique identifiers of all idle conditions, replacing the previous ones.
+     */
+    fun setIdleConditions(conditionIds: LongArray)
+
+    /**
+     * Set the conditions searched at several orientations, such as a dial or a rotating icon. Once not found at its own
+     * orientation, such a condition is searched rotated around its center at the other ones, evenly spread over a turn,
+     * and the best one is reported with [DetectionResult.angle]. The rotated images are created with the condition
+     * ones, each orientation costing about as much as another condition.
+     *
+     * @param conditionIds the unique identifiers of the rotation tolerant conditions, replacing the previous ones.
+     * @param rotationCounts the number of orientations of each condition, at the same index than its identifier.
+     */
+    fun setConditionRotations(conditionIds: LongArray, rotationCounts: IntArray)
+
+    /**
+     * Set the similarity measured for the conditions, instead of the normalized correlation. The normalized sum of
+     * squared differences (1) and the sum of absolute differences (2) are cheaper, but tolerate no brightness change:
+     * they are for the conditions captured on the same device, with the same colors. The threshold keeps its meaning,
+     * the tolerated difference in percent, and such a condition is only searched at its own scale and orientation.
+     *
+     * @param conditionIds the unique identifiers of the conditions, replacing the previous ones.
+     * @param metrics the metric of each condition, at the same index than its identifier. 0 for the correlation.
+     */
+    fun setConditionMetrics(conditionIds: LongArray, metrics: IntArray)
+
+    /**
+     * Get the counters of the detection of each condition, to find the costly ones.
+     * Only maintained when the native library is built with the tracing enabled.
+     *
+     * @return the counters of the conditions detected since the detector creation, or an empty list if the tracing is
+     *         disabled.
+     */
+    fun getConditionCounters(): List<ConditionCounters>
+
+    /**
+     * Get the statistics of the recent searches of each condition, to find the costly ones.
+     * Always maintained, whatever the native library build type.
+     *
+     * @return the statistics of the conditions searched at least once since the detector creation.
+     */
+    fun getConditionStatistics(): List<ConditionStatistics>
+
+    /**
+     * Get the hit, miss and eviction counts of each native cache, and the memory it holds, to size them from real
+     * scenarios. Always maintained, whatever the native library build type.
+     *
+     * @return the statistics of each cache since the detector creation, empty if the detector is closed.
+     */
+    fun getCacheStatistics(): List<DetectorCacheStatistics>
+
+    /**
+     * Get the text recognition engines created by the process and their initialization times. The engines are shared
+     * by all detectors.
+     *
+     * @return the statistics of the engines since the process start, empty if the detector is closed.
+     */
+    fun getOcrEngineStatistics(): OcrEngineStatistics
+
+    /**
+     * Set the memory budget of the detector. Instead of growing, the detector degrades to fit in it by evicting the
+     * processed conditions from its cache, they are then processed again from their bitmap when detected.
+     * Applied from the next [setupDetection].
+     *
+     * @param budgetBytes the budget in bytes, or 0 for the default unbounded detector.
+     */
+    fun setMemoryBudget(budgetBytes: Long)
+
+    /**
+     * Report the memory pressure of the system. The detector sheds its caches for it from the next screen image, and
+     * regrows them progressively once the pressure is no longer reported. Can be called from any thread.
+     *
+     * @param pressure the pressure to shed the caches for.
+     */
+    fun setMemoryPressure(pressure: DetectorMemoryPressure)
+
+    /**
+     * Set the time budget of each condition detection. A condition whose detection would exceed it is detected with
+     * a degraded accuracy: with its coarse matching only, or without recognizing its text. Its result is then flagged
+     * with [DetectionResult.isDegraded].
+     *
+     * @param budgetNs the budget in nanoseconds, or 0 for unbounded detections.
+     */
+    fun setConditionTimeBudget(budgetNs: Long)
+
+    /**
+     * Get the memory held by the detector, by category.
+     *
+     * @return the memory usage, all empty if the detector is closed.
+     */
+    fun getMemoryUsage(): DetectorMemoryUsage
+
+    /**
+     * Set the number of screen images recorded by the detection capture. The last screen images are kept with the
+     * image conditions detected on them, and can be written with [writeCapture] to be replayed by the native benchmark.
+     * The conditions detected during the capture must be provided with their bitmap at least once, the template pack
+     * should not be opened.
+     *
+     * @param frameCount the number of the last screen images to keep, 0 to disable the capture.
+     */
+    fun setCaptureFrameCount(frameCount: Int)
+
+    /**
+     * Write the detection capture into a file.
+     *
+     * @param path the path of the capture file.
+     *
+     * @return true if the capture has been written, false if it is disabled or can't be written.
+     */
+    fun writeCapture(path: String): Boolean
+
+    /**
+     * Suggest the lowest detection quality detecting the image conditions like the current one, by replaying the
+     * detection capture at decreasing qualities. Each captured detection must have the same result, at most
+     * [positionTolerance] pixels away from the position found at the current quality.
+     * Slow, the captured detections are replayed once per quality: it should be called once the detection is stopped.
+     *
+     * @param qualities the detection qualities to try, the ones above the current quality are ignored.
+     * @param positionTolerance the maximum distance with the position at the current quality, in screen pixels.
+     *
+     * @return the suggested quality, the current one if none of the qualities gives the same results. Null if the
+     *         capture is disabled or empty.
+     */
+    fun suggestDetectionQuality(qualities: IntArray, positionTolerance: Int): Int?
+
     /**
      * Set the bitmap for the screen.
-     * All following calls to [detectCondition] methods will be verified against this bitmap.
+     * All following calls to [detectCondition] methods will be verified against this bitmap. Its pixels are copied,
+     * as they are only locked during this call: the frames of the screen record should be provided without copy with
+     * the buffer variant of this method instead.
      *
      * @param screenBitmap the content of the screen as a bitmap.
+     *
+     * @return true if the content of the screen is identical to the previous one provided to this method, false if
+     *         not. Always false for the first bitmap after a [setScreenMetrics] call.
+     */
+    fun setupDetection(screenBitmap: Bitmap): Boolean
+
+    /**
+     * Set the pixels of the screen, without copying them.
+     * All following calls to [detectCondition] methods will be verified against this buffer, so it must not be
+     * modified or released until the next call to a setupDetection method.
+     *
+     * @param screenBuffer a direct buffer containing the screen pixels in RGBA_8888.
+     * @param width the width of the screen, in pixels.
+     * @param height the height of the screen, in pixels.
+     * @param rowStride the number of bytes between the start of two consecutive rows.
+     * @param frameId the identifier of the captured frame, such as its timestamp. The detectors set with the same
+     * frame share its processing instead of converting its pixels again each. 0 if the frame is not shared.
+     *
+     * @return true if the content of the screen is identical to the previous one provided to this method, false if
+     *         not. Always false for the first buffer after a [setScreenMetrics] call.
      */
-    fun setupDetection(screenBitmap: Bitmap)
+    fun setupDetection(screenBuffer: ByteBuffer, width: Int, height: Int, rowStride: Int, frameId: Long = 0L): Boolean
+
+    /**
+     * Start processing the pixels of the next screen in the background, while the conditions are detected on the
+     * current one. The next [setupDetection] call with the same buffer will be almost immediate.
+     * The pixels are not copied, so the buffer must not be modified or released until the call to a setupDetection
+     * method following the one for this buffer, or until [cancelDetectionPreparation].
+     *
+     * @param screenBuffer a direct buffer containing the next screen pixels in RGBA_8888.
+     * @param width the width of the screen, in pixels.
+     * @param height the height of the screen, in pixels.
+     * @param rowStride the number of bytes between the start of two consecutive rows.
+     * @param frameId the identifier of the captured frame, see [setupDetection]. Not processed again if another
+     * detector have already processed it.
+     */
+    fun prepareDetection(screenBuffer: ByteBuffer, width: Int, height: Int, rowStride: Int, frameId: Long = 0L)
+
+    /**
+     * Drop the screen pixels provided to [prepareDetection], waiting for their processing to stop. Their buffer can be
+     * released once this method returns.
+     */
+    fun cancelDetectionPreparation()
+
+    /**
+     * Open a native reader for the frames of the screen record, replacing the previous one.
+     * The screen record must render into the returned surface: its frames are then acquired natively as they arrive,
+     * without any java object per frame, and are set for the detection with [setupDetectionFromScreenReader]. The
+     * screen record must stop rendering into the surface before [closeScreenReader].
+     *
+     * @param width the width of the frames, in pixels.
+     * @param height the height of the frames, in pixels.
+     *
+     * @return the surface of the reader, or null if the native reader isn't supported on this device.
+     */
+    fun openScreenReader(width: Int, height: Int): Surface?
+
+    /** Close the native reader opened with [openScreenReader], and release its frames. */
+    fun closeScreenReader()
+
+    /**
+     * Wait for a new frame in the native screen reader, returning immediately if one was received since the last
+     * [acquireScreenReaderFrame] call.
+     *
+     * @param timeoutMs the maximum duration of the wait, in milliseconds.
+     *
+     * @return true if a new frame is available, false if the wait has timed out.
+     */
+    fun awaitScreenReaderFrame(timeoutMs: Long): Boolean
+
+    /**
+     * Acquire the latest frame of the native screen reader, to be set with [setupDetectionFromScreenReader]. The
+     * previous frame is acquired again if no new frame was received.
+     *
+     * @return the rendering time of the frame in the [System.nanoTime] time base, or 0 if no frame was received yet.
+     */
+    fun acquireScreenReaderFrame(): Long
+
+    /**
+     * Set the frame acquired by [acquireScreenReaderFrame] for the detection, without copying its pixels. It remains
+     * valid until the second next frame acquisition, like the frames of the screen record.
+     *
+     * @return true if the content of the screen is identical to the previous one, see [setupDetection].
+     */
+    fun setupDetectionFromScreenReader(): Boolean
+
+    /**
+     * Limit the processing of the following screen images to some areas.
+     * When all conditions are searched in an area of the screen, only those areas are converted for the detection
+     * instead of the whole screen. The following [detectCondition] calls must then only search in those areas, or
+     * their conditions will not be found.
+     *
+     * @param areas the areas of the screen to process, in screen coordinates. Empty to process the whole screen,
+     *              which is the default.
+     */
+    fun setDetectionAreas(areas: List<Rect>)
+
+    /**
+     * Set the areas of the screen whose changes are ignored, such as the clock of the status bar.
+     * Same as the learned ones of [setAnimatedAreasExclusionEnabled], they are only ignored when they are not in the
+     * detection area of a condition.
+     *
+     * @param areas the areas of the screen to ignore, in screen coordinates. Empty to ignore none, which is the
+     *              default.
+     */
+    fun setExcludedAreas(areas: List<Rect>)
+
+    /**
+     * Set the parts of the screen along its edges where the applications are not displayed, such as the status bar,
+     * the navigation bar and the display cutout.
+     * They are not searched by the conditions detected on the whole screen, the conditions with an area are searched
+     * in it as is. Must be set again when the screen is rotated.
+     *
+     * @param insets the distance of the content of the applications to each edge of the screen, in screen pixels.
+     *               Empty to search the whole screen, which is the default.
+     */
+    fun setScreenInsets(insets: Rect)
+
+    /**
+     * Classify the current screen image in a state of the detected application, such as its menu, its shop or a
+     * battle. [setupDetection] must have been called first with the content of the screen.
+     * The states are clustered from the classified images by a compact signature of their content, the images close
+     * to the one of a known state being in it. They are forgotten with the next [setScreenMetrics].
+     *
+     * @return the identifier of the state of the screen image, or [SCREEN_STATE_UNKNOWN] if there is no image.
+     */
+    fun classifyScreenState(): Int
 
     /**
      * Detect if the bitmap is in the whole current screen bitmap.
      * [setupDetection] must have been called first with the content of the screen.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition. The processed condition bitmap is cached using this
+     *                    identifier, it must remain the same as long as the bitmap doesn't change.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if [isConditionCached] is true.
      * @param threshold the allowed error threshold allowed for the condition.
      *
      * @return the results of the detection.
      */
-    fun detectCondition(conditionBitmap: Bitmap, threshold: Int): DetectionResult
+    fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, threshold: Int): DetectionResult
 
     /**
      * Detect if the bitmap is in the whole current screen bitmap.
      * [setupDetection] must have been called first with the content of the screen.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition. The processed condition bitmap is cached using this
+     *                    identifier, it must remain the same as long as the bitmap doesn't change.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if [isConditionCached] is true.
      * @param identifying the recognised information to consider the detection position.
      *
      * @return the results of the detection.
      */
-    fun detectCondition(conditionBitmap: Bitmap, identifying: String): DetectionResult
+    fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, identifying: String): DetectionResult
 
     /**
      * Detect if the bitmap is at a specific position in the current screen bitmap.
      * [setupDetection] must have been called first with the content of the screen.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition. The processed condition bitmap is cached using this
+     *                    identifier, it must remain the same as long as the bitmap doesn't change.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if [isConditionCached] is true.
      * @param position the position on the screen where the condition should be detected.
      * @param threshold the allowed error threshold allowed for the condition.
      *
      * @return the results of the detection.
      */
-    fun detectCondition(conditionBitmap: Bitmap, position: Rect, threshold: Int): DetectionResult
+    fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, position: Rect, threshold: Int): DetectionResult
 
     /**
      * Detect if the bitmap is at a specific position in the current screen bitmap.
      * [setupDetection] must have been called first with the content of the screen.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition. The processed condition bitmap is cached using this
+     *                    identifier, it must remain the same as long as the bitmap doesn't change.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if [isConditionCached] is true.
      * @param position the position on the screen where the condition should be detected.
      * @param identifying the recognised information to consider the detection position.
      *
      * @return the results of the detection.
      */
-    fun detectCondition(conditionBitmap: Bitmap, position: Rect, identifying: String): DetectionResult
+    fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, position: Rect, identifying: String): DetectionResult
+
+    /**
+     * Detect all conditions of a batch in the current screen bitmap, in order, until the batch operator result is
+     * known. The results are written in the batch.
+     * [setupDetection] must have been called first with the content of the screen.
+     *
+     * @param batch the conditions to detect.
+     */
+    fun detectConditions(batch: DetectionBatch)
+
+    /**
+     * Find all occurrences of a condition in an area of the current screen bitmap, from a single matching. The
+     * occurrences are all the distinct positions above the threshold, at most [DetectionOccurrences.MAX_COUNT].
+     * [setupDetection] must have been called first with the content of the screen.
+     *
+     * @param conditionId the unique identifier of the condition. The processed condition bitmap is cached using this
+     *                    identifier, it must remain the same as long as the bitmap doesn't change.
+     * @param conditionBitmap the condition to detect in the screen. Can be null if [isConditionCached] is true.
+     * @param position the position on the screen where the condition should be detected, null for the whole screen.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param occurrences receives the occurrences found.
+     */
+    fun detectAllOccurrences(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        position: Rect?,
+        threshold: Int,
+        occurrences: DetectionOccurrences,
+    )
+
+    /**
+     * Detect if a condition is in an area of the current screen bitmap, without altering the state of the detector.
+     * Unlike the other detection methods, it can be called from several threads at once, and concurrently with them,
+     * as long as the screen bitmap, the screen metrics and the cached conditions are not changed during the call.
+     * Text conditions are not supported.
+     *
+     * @param conditionId the unique identifier of the condition. It must be cached, see [isConditionCached].
+     * @param position the position on the screen where the condition should be detected, null for the whole screen.
+     * @param threshold the allowed error threshold allowed for the condition.
+     *
+     * @return the results of the detection. Not detected if the condition is not cached.
+     */
+    fun detectConditionConcurrently(conditionId: Long, position: Rect?, threshold: Int): DetectionResult
+
+    /**
+     * Compile the image events of a scenario into a native plan, replacing the previous one. The plan is then
+     * evaluated for each screen image with [detectScenario], until it is compiled again.
+     *
+     * @param plan the events to evaluate, with their conditions. All condition templates must be cached.
+     *
+     * @throws IllegalArgumentException if the anchor of a condition is not in the plan, or is anchored itself.
+     */
+    fun compileScenario(plan: ScenarioPlan)
+
+    /**
+     * Evaluate the last compiled plan in the current screen bitmap, in a single call. The events are detected in order
+     * as batches, until the first fulfilled event that doesn't keep detecting. The results are written in the plan.
+     * [setupDetection] must have been called first with the content of the screen.
+     *
+     * Templates unused for a while can be evicted from the cache: the plan is then not evaluated and
+     * [ScenarioPlan.isPixelsNeeded] is set, the events must be detected with their bitmaps instead.
+     * The evaluation is aborted once the [ScenarioPlan.deadlineNs] is passed, and [ScenarioPlan.isFrameExpired] is
+     * set.
+     *
+     * @param plan the plan provided to the last [compileScenario].
+     */
+    fun detectScenario(plan: ScenarioPlan)
 }
 
+/** The default resize factors of the multi scale matching. */
+val MULTI_SCALE_MATCHING_DEFAULT_SCALES: FloatArray = floatArrayOf(0.67f, 0.8f, 1.25f, 1.5f)
+
+/** The default language of the text recognition. */
+const val TEXT_RECOGNITION_DEFAULT_LANGUAGE = "chi_sim"
+/** The default page segmentation mode of the text recognition, the single text line of a candidate. */
+const val TEXT_RECOGNITION_DEFAULT_PAGE_SEGMENTATION_MODE = 7
+
 /** The minimum detection quality for the algorithm. */
-const val DETECTION_QUALITY_MIN = 400L
\ No newline at end of file
+const val DETECTION_QUALITY_MIN = 400L
+
+/** Returned by [ImageDetector.classifyScreenState] when the screen image is not known. */
+const val SCREEN_STATE_UNKNOWN = -1
\ No newline at end of file
@@ -18,144 +18,1365 @@ package com.buzbuz.smartautoclicker.core.detection
 
 import android.graphics.Bitmap
 import android.graphics.Rect
+import android.os.Process
+import android.os.Trace
+import android.view.Surface
 import androidx.annotation.Keep
 
+import java.nio.ByteBuffer
+import java.util.concurrent.locks.ReentrantReadWriteLock
+
+import kotlin.concurrent.read
+import kotlin.concurrent.write
+
 /**
  * Native implementation of the image detector.
  * It uses OpenCv template matching algorithms to achieve condition detection on the screen.
  *
  * Debug flavour of the library is build against build artifacts of OpenCv in the debug folder.
  * Release flavour of the library is build against the sources of the OpenCv project, downloaded from github.
+ *
+ * The detection methods are expected to be called from a single coroutine, except [detectConditionConcurrently].
+ * [close] can be called from any thread: it waits for the native calls in progress before deleting the detector.
  */
 class NativeDetector private constructor() : ImageDetector {
 
-    companion object {
-        fun newInstance(): NativeDetector? = try {
-            System.loadLibrary("smartautoclicker")
-            NativeDetector()
-        } catch (ex: UnsatisfiedLinkError) {
-            null
-        }
-    }
+    companion object {
+
+        /** Name of the trace section of [newInstance], loading the native library on its first call. */
+        const val TRACE_SECTION_NEW_INSTANCE = "SmartDetection:newInstance"
+
+        fun newInstance(): NativeDetector? = try {
+            Trace.beginSection(TRACE_SECTION_NEW_INSTANCE)
+            System.loadLibrary("smartautoclicker")
+            NativeDetector()
+        } catch (ex: UnsatisfiedLinkError) {
+            null
+        } finally {
+            Trace.endSection()
+        }
+
+        /**
+         * Warm up the native detection before the first detector is created, to keep the slow first time
+         * initializations out of the first detected frames: the library is loaded, the OpenCV lazy initialization is
+         * triggered and the text recognition engines are loaded, shared by all detectors of the process.
+         * Slow, call it from a background thread. The thread priority is lowered during the warm up.
+         *
+         * @param ocrLanguages the languages of the text conditions of the scenario, nothing is loaded if empty.
+         * @param dataPath the directory containing the tessdata directory, or null to use the TESSDATA_PREFIX
+         *                 environment variable.
+         * @param pageSegmentationMode the Tesseract page segmentation mode of the text conditions.
+         *
+         * @return false if the native library is not found.
+         */
+        fun prewarm(
+            ocrLanguages: Array<String> = emptyArray(),
+            dataPath: String? = null,
+            pageSegmentationMode: Int = TEXT_RECOGNITION_DEFAULT_PAGE_SEGMENTATION_MODE,
+        ): Boolean {
+            try {
+                System.loadLibrary("smartautoclicker")
+            } catch (ex: UnsatisfiedLinkError) {
+                return false
+            }
+
+            val threadId = Process.myTid()
+            val threadPriority = Process.getThreadPriority(threadId)
+            Process.setThreadPriority(threadId, Process.THREAD_PRIORITY_BACKGROUND)
+            try {
+                prewarmNative(dataPath, ocrLanguages, pageSegmentationMode)
+            } finally {
+                Process.setThreadPriority(threadId, threadPriority)
+            }
+            return true
+        }
+
+        /**
+         * Native method for warming up the detection.
+         *
+         * @param dataPath the directory containing the tessdata directory, or null for TESSDATA_PREFIX.
+         * @param ocrLanguages the languages of the text recognition engines to load.
+         * @param pageSegmentationMode the Tesseract page segmentation mode.
+         *
+         * @return the number of text recognition engines ready.
+         */
+        @JvmStatic
+        private external fun prewarmNative(
+            dataPath: String?,
+            ocrLanguages: Array<String>,
+            pageSegmentationMode: Int,
+        ): Int
+    }
+
+    /** The result of the last single condition detection, written by the native code. */
+    private val resultBuffer: ByteBuffer = allocateDetectionResults(1)
+    /** The results of the detection, read from [resultBuffer]. */
+    private val detectionResult = DetectionResult()
+    /** The result of the concurrent detections, one per calling thread. */
+    private val concurrentResultBuffer: ThreadLocal<ByteBuffer> =
+        ThreadLocal.withInitial { allocateDetectionResults(1) }
+    /** Native pointer of the detector object. */
+    @Keep
+    private var nativePtr: Long = -1
+
+    private val detectionQualityMin: Double = DETECTION_QUALITY_MIN.toDouble()
+
+    /** The conditions in the opened template pack, for the current screen metrics. */
+    private val packedConditionIds: MutableSet<Long> = mutableSetOf()
+
+    /**
+     * Held for reading by each native call, and for writing while the native detector is created or deleted.
+     * The native detector can't be deleted during a call, and no call can use it once deleted.
+     */
+    private val lifecycleLock = ReentrantReadWriteLock()
+    /** True once the native detector is deleted. Only written with the [lifecycleLock] write lock. */
+    private var isClosed: Boolean = false
+
+    override fun init() {
+        lifecycleLock.write {
+            nativePtr = newDetector(resultBuffer)
+        }
+    }
+
+    override fun close() {
+        lifecycleLock.write {
+            if (isClosed) return
+
+            isClosed = true
+            deleteDetector()
+        }
+    }
+
+    override fun setScreenMetrics(metricsKey: String, screenBitmap: Bitmap, detectionQuality: Double) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            updateScreenMetrics(
+                metricsKey,
+                screenBitmap,
+                detectionQuality.coerceIn(detectionQualityMin, 10000.0),
+            )
+            updatePackedConditionIds()
+        }
+    }
+
+    override fun setScreenMetrics(metricsKey: String, screenWidth: Int, screenHeight: Int, detectionQuality: Double) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            updateScreenMetricsSize(
+                metricsKey,
+                screenWidth,
+                screenHeight,
+                detectionQuality.coerceIn(detectionQualityMin, 10000.0),
+            )
+            updatePackedConditionIds()
+        }
+    }
+
+    override fun setPyramidMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setPyramidMatching(enabled)
+        }
+    }
+
+    override fun setSparseMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setSparseMatching(enabled)
+        }
+    }
+
+    override fun setBinaryMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setBinaryMatching(enabled)
+        }
+    }
+
+    override fun setChamferMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setChamferMatching(enabled)
+        }
+    }
+
+    override fun setMotionCompensationEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setMotionCompensation(enabled)
+        }
+    }
+
+    override fun setAnimatedAreasExclusionEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setAnimatedAreasExclusion(enabled)
+        }
+    }
+
+    override fun setFirstHitMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setFirstHitMatching(enabled)
+        }
+    }
+
+    override fun setLearnedAreaMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setLearnedAreaMatching(enabled)
+        }
+    }
+
+    override fun setIntegerScaleRatioEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setIntegerScaleRatio(enabled)
+        }
+    }
+
+    override fun setCancelled(cancelled: Boolean) {
+        // Only a read lock, it is called while another thread is detecting
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setDetectionCancelled(cancelled)
+        }
+    }
+
+    override fun waitForRegionChange(area: Rect, changeThreshold: Double, timeoutMs: Long): Boolean {
+        // Only a read lock, the screen images are set by another thread during the wait
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return waitForRegionChange(
+                area.left, area.top, area.width(), area.height(), changeThreshold.coerceIn(0.0, 1.0), timeoutMs)
+        }
+    }
+
+    override fun setMultiScaleMatching(scales: FloatArray) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setTemplateScales(scales)
+        }
+    }
+
+    override fun setExactMatchingJitter(pixels: Int) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeExactMatchingJitter(pixels)
+        }
+    }
+
+    override fun setExactPixelMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setExactPixelMatching(enabled)
+        }
+    }
+
+    override fun setHistogramColorVerificationEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setHistogramColorVerification(enabled)
+        }
+    }
+
+    override fun setScaledColorVerificationEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setScaledColorVerification(enabled)
+        }
+    }
+
+    override fun setFrameAllocatorEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setFrameAllocator(enabled)
+        }
+    }
+
+    override fun setConditionPrefilterEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setConditionPrefilter(enabled)
+        }
+    }
+
+    override fun setIntegerMatchingEnabled(enabled: Boolean) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setIntegerMatching(enabled)
+        }
+    }
+
+    override fun setGpuMatchingEnabled(enabled: Boolean): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return setGpuMatching(enabled)
+        }
+    }
+
+    override fun setNnapiMatchingEnabled(enabled: Boolean): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return setNnapiMatching(enabled)
+        }
+    }
+
+    override fun setTargetDetectionRate(detectionsPerSecond: Double) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setDetectionRate(detectionsPerSecond)
+        }
+    }
+
+    override fun getFrameDelayMs(): Long {
+        lifecycleLock.read {
+            if (isClosed) return 0
+
+            return getFrameDelay()
+        }
+    }
+
+    override fun getFrameTelemetry(maxCount: Int): String {
+        lifecycleLock.read {
+            if (isClosed) return ""
+
+            return getNativeFrameTelemetry(maxCount)
+        }
+    }
+
+    override fun setThreadCount(threadCount: Int) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeThreadCount(threadCount)
+        }
+    }
+
+    override fun setThreadPolicy(preferBigCores: Boolean, threadPriority: Int) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeThreadPolicy(preferBigCores, threadPriority)
+        }
+    }
+
+    override fun setPerformanceHintEnabled(enabled: Boolean): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return setPerformanceHint(enabled)
+        }
+    }
+
+    override fun setTextRecognitionConfig(dataPath: String?, language: String, pageSegmentationMode: Int) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setOcrConfig(dataPath, language, pageSegmentationMode)
+        }
+    }
+
+    override fun openTemplatePack(path: String): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            val isOpened = openPack(path)
+            updatePackedConditionIds()
+            return isOpened
+        }
+    }
+
+    override fun writeTemplatePack(path: String): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return writePack(path)
+        }
+    }
+
+    override fun isConditionPacked(conditionId: Long): Boolean =
+        packedConditionIds.contains(conditionId)
+
+    override fun isConditionCached(conditionId: Long): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return packedConditionIds.contains(conditionId) || isTemplateCached(conditionId)
+        }
+    }
+
+    override fun prepareConditions(conditionIds: LongArray, conditionBitmaps: Array<Bitmap?>): Int {
+        lifecycleLock.read {
+            if (isClosed) return 0
+
+            return prepareTemplates(conditionIds, conditionBitmaps)
+        }
+    }
+
+    override fun prepareConditionFiles(
+        conditionIds: LongArray,
+        conditionPaths: Array<String?>,
+        conditionSizes: IntArray,
+    ): Int {
+        lifecycleLock.read {
+            if (isClosed) return 0
+
+            return prepareTemplateFiles(conditionIds, conditionPaths, conditionSizes)
+        }
+    }
+
+    override fun removeConditions(conditionIds: LongArray) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            removeTemplates(conditionIds)
+            if (conditionIds.any(packedConditionIds::contains)) updatePackedConditionIds()
+        }
+    }
+
+    override fun setIdleConditions(conditionIds: LongArray) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setIdleTemplates(conditionIds)
+        }
+    }
+
+    override fun setConditionRotations(conditionIds: LongArray, rotationCounts: IntArray) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setRotatedTemplates(conditionIds, rotationCounts)
+        }
+    }
+
+    override fun setConditionMetrics(conditionIds: LongArray, metrics: IntArray) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setMatchingMetrics(conditionIds, metrics)
+        }
+    }
+
+    override fun getConditionCounters(): List<ConditionCounters> {
+        lifecycleLock.read {
+            if (isClosed) return emptyList()
+
+            return getNativeConditionCounters().toConditionCounters()
+        }
+    }
+
+    override fun getConditionStatistics(): List<ConditionStatistics> {
+        lifecycleLock.read {
+            if (isClosed) return emptyList()
+
+            return getNativeConditionStatistics().toConditionStatistics()
+        }
+    }
+
+    override fun getCacheStatistics(): List<DetectorCacheStatistics> {
+        lifecycleLock.read {
+            if (isClosed) return emptyList()
+
+            return getNativeCacheStatistics().toDetectorCacheStatistics()
+        }
+    }
+
+    override fun getOcrEngineStatistics(): OcrEngineStatistics {
+        lifecycleLock.read {
+            if (isClosed) return OcrEngineStatistics()
+
+            return getNativeOcrEngineStatistics().toOcrEngineStatistics()
+        }
+    }
+
+    override fun setMemoryBudget(budgetBytes: Long) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeMemoryBudget(budgetBytes)
+        }
+    }
+
+    override fun setMemoryPressure(pressure: DetectorMemoryPressure) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeMemoryPressure(pressure.value)
+        }
+    }
+
+    override fun setConditionTimeBudget(budgetNs: Long) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeConditionTimeBudget(budgetNs)
+        }
+    }
+
+    override fun getMemoryUsage(): DetectorMemoryUsage {
+        lifecycleLock.read {
+            if (isClosed) return DetectorMemoryUsage()
+
+            return getNativeMemoryUsage().toDetectorMemoryUsage()
+        }
+    }
+
+    override fun setCaptureFrameCount(frameCount: Int) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setNativeCaptureFrameCount(frameCount)
+        }
+    }
+
+    override fun writeCapture(path: String): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return writeNativeCapture(path)
+        }
+    }
+
+    override fun suggestDetectionQuality(qualities: IntArray, positionTolerance: Int): Int? {
+        lifecycleLock.read {
+            if (isClosed) return null
+
+            val quality = suggestNativeDetectionQuality(qualities, positionTolerance)
+            return if (quality > 0) quality.toInt() else null
+        }
+    }
+
+    override fun setupDetection(screenBitmap: Bitmap): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return setScreenImage(screenBitmap)
+        }
+    }
+
+    override fun setupDetection(
+        screenBuffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        rowStride: Int,
+        frameId: Long,
+    ): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+            require(screenBuffer.isDirect) { "Screen buffer must be a direct buffer" }
+
+            return setScreenImageBuffer(screenBuffer, width, height, rowStride, frameId)
+        }
+    }
+
+    override fun prepareDetection(screenBuffer: ByteBuffer, width: Int, height: Int, rowStride: Int, frameId: Long) {
+        lifecycleLock.read {
+            if (isClosed) return
+            require(screenBuffer.isDirect) { "Screen buffer must be a direct buffer" }
+
+            prepareScreenImageBuffer(screenBuffer, width, height, rowStride, frameId)
+        }
+    }
+
+    override fun cancelDetectionPreparation() {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            cancelScreenImagePreparation()
+        }
+    }
+
+    override fun openScreenReader(width: Int, height: Int): Surface? {
+        lifecycleLock.read {
+            if (isClosed) return null
+
+            return openNativeScreenReader(width, height)
+        }
+    }
+
+    override fun closeScreenReader() {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            closeNativeScreenReader()
+        }
+    }
+
+    override fun awaitScreenReaderFrame(timeoutMs: Long): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return awaitNativeScreenReaderImage(timeoutMs)
+        }
+    }
+
+    override fun acquireScreenReaderFrame(): Long {
+        lifecycleLock.read {
+            if (isClosed) return 0L
+
+            return acquireNativeScreenReaderImage()
+        }
+    }
+
+    override fun setupDetectionFromScreenReader(): Boolean {
+        lifecycleLock.read {
+            if (isClosed) return false
+
+            return setScreenReaderImage()
+        }
+    }
+
+    override fun setDetectionAreas(areas: List<Rect>) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            val regions = IntArray(areas.size * 4)
+            areas.forEachIndexed { index, area ->
+                regions[index * 4] = area.left
+                regions[index * 4 + 1] = area.top
+                regions[index * 4 + 2] = area.width()
+                regions[index * 4 + 3] = area.height()
+            }
+            setScreenRegions(regions)
+        }
+    }
+
+    override fun setExcludedAreas(areas: List<Rect>) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            val values = IntArray(areas.size * 4)
+            areas.forEachIndexed { index, area ->
+                values[index * 4] = area.left
+                values[index * 4 + 1] = area.top
+                values[index * 4 + 2] = area.width()
+                values[index * 4 + 3] = area.height()
+            }
+            setScreenExcludedAreas(values)
+        }
+    }
+
+    override fun setScreenInsets(insets: Rect) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            setScreenInsets(insets.left, insets.top, insets.right, insets.bottom)
+        }
+    }
+
+    override fun classifyScreenState(): Int {
+        lifecycleLock.read {
+            if (isClosed) return SCREEN_STATE_UNKNOWN
+
+            return classifyNativeScreenState()
+        }
+    }
+
+    override fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, threshold: Int): DetectionResult {
+        lifecycleLock.read {
+            if (isClosed) return detectionResult.copy()
+
+            detect(conditionId, conditionBitmap, threshold)
+            return readDetectionResult()
+        }
+    }
+
+    override fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, identifying: String): DetectionResult {
+        lifecycleLock.read {
+            if (isClosed) return detectionResult.copy()
+
+            detectText(conditionId, conditionBitmap, identifying)
+            return readDetectionResult()
+        }
+    }
+
+
+    override fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, position: Rect, threshold: Int): DetectionResult {
+        lifecycleLock.read {
+            if (isClosed) return detectionResult.copy()
+
+            detectAt(
+                conditionId, conditionBitmap, position.left, position.top, position.width(), position.height(), threshold)
+            return readDetectionResult()
+        }
+    }
+
+    override fun detectCondition(conditionId: Long, conditionBitmap: Bitmap?, position: Rect, identifying: String): DetectionResult {
+        lifecycleLock.read {
+            if (isClosed) return detectionResult.copy()
+
+            detectTextAt(
+                conditionId, conditionBitmap, position.left, position.top, position.width(), position.height(), identifying)
+            return readDetectionResult()
+        }
+    }
+
+    override fun detectConditions(batch: DetectionBatch) {
+        lifecycleLock.read {
+            if (isClosed) {
+                batch.processedCount = 0
+                return
+            }
+
+            batch.processedCount = detectBatch(
+                batch.size,
+                batch.conditionIds,
+                batch.conditionBitmaps,
+                batch.conditionParams,
+                batch.identifyings,
+                batch.textLanguages,
+                batch.textWhitelists,
+                batch.operator,
+                batch.results,
+            )
+        }
+    }
+
+    override fun detectAllOccurrences(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        position: Rect?,
+        threshold: Int,
+        occurrences: DetectionOccurrences,
+    ) {
+        lifecycleLock.read {
+            if (isClosed) {
+                occurrences.count = 0
+                return
+            }
+
+            occurrences.count = detectAll(
+                conditionId,
+                conditionBitmap,
+                position?.left ?: 0,
+                position?.top ?: 0,
+                position?.width() ?: 0,
+                position?.height() ?: 0,
+                threshold,
+                occurrences.results,
+            )
+        }
+    }
+
+    override fun detectConditionConcurrently(conditionId: Long, position: Rect?, threshold: Int): DetectionResult {
+        lifecycleLock.read {
+            if (isClosed) return DetectionResult()
+
+            val buffer = concurrentResultBuffer.get()!!
+            detectConcurrently(
+                conditionId,
+                position?.left ?: 0,
+                position?.top ?: 0,
+                position?.width() ?: 0,
+                position?.height() ?: 0,
+                threshold,
+                buffer,
+            )
+            return DetectionResult().apply { buffer.readDetectionResult(0, this) }
+        }
+    }
+
+    override fun compileScenario(plan: ScenarioPlan) {
+        lifecycleLock.read {
+            if (isClosed) return
+
+            val conditions = plan.conditions
+            compileNativeScenario(
+                plan.eventIds.copyOf(plan.eventCount),
+                plan.eventParams,
+                conditions.conditionIds.copyOf(conditions.size),
+                conditions.conditionParams,
+                conditions.identifyings,
+                conditions.textLanguages,
+                conditions.textWhitelists,
+                plan.speculativeEventCount,
+            )
+        }
+    }
+
+    override fun detectScenario(plan: ScenarioPlan) {
+        lifecycleLock.read {
+            if (isClosed) {
+                plan.evaluatedCount = 0
+                return
+            }
+
+            val evaluatedCount = detectNativeScenario(
+                plan.conditions.results, plan.skippedEvents, plan.processedCounts, plan.deadlineNs)
+            plan.isPixelsNeeded = evaluatedCount == SCENARIO_PIXELS_NEEDED
+            plan.isFrameExpired = evaluatedCount == SCENARIO_FRAME_EXPIRED
+            plan.evaluatedCount = evaluatedCount.coerceAtLeast(0)
+        }
+    }
+
+    /** The packed conditions depends on the scale ratio, only read them when it might have changed. */
+    private fun updatePackedConditionIds() {
+        packedConditionIds.clear()
+        getPackedConditionIds().forEach(packedConditionIds::add)
+    }
+
+    private fun readDetectionResult(): DetectionResult {
+        resultBuffer.readDetectionResult(0, detectionResult)
+        return detectionResult.copy()
+    }
+
+    /**
+     * Creates the detector. Must be called before any other methods.
+     * Call [close] to release resources once the detection process is finished.
+     *
+     * @return the pointer of the native detector object.
+     */
+    private external fun newDetector(resultBuffer: ByteBuffer): Long
+
+    /**
+     * Deletes the native detector.
+     * Once called, this object can't be used anymore.
+     */
+    private external fun deleteDetector()
+
+    /**
+     * Native method for screen metrics setup.
+     *
+     * @param screenBitmap the content of the screen as a bitmap.
+     * @param detectionQuality the quality of the detection. The higher the preciser, the lower the faster. Must be
+     *                         contained in [DETECTION_QUALITY_MIN] and [DETECTION_QUALITY_MAX].
+     */
+    private external fun updateScreenMetrics(metricsKey: String, screenBitmap: Bitmap, detectionQuality: Double)
+
+    /**
+     * Native method for screen metrics setup, from the screen size.
+     *
+     * @param screenWidth the width of the screen, in pixels.
+     * @param screenHeight the height of the screen, in pixels.
+     * @param detectionQuality the quality of the detection. The higher the preciser, the lower the faster. Must be
+     *                         contained in [DETECTION_QUALITY_MIN] and [DETECTION_QUALITY_MAX].
+     */
+    private external fun updateScreenMetricsSize(
+        metricsKey: String,
+        screenWidth: Int,
+        screenHeight: Int,
+        detectionQuality: Double,
+    )
+
+    /**
+     * Native method for the pyramid matching setup.
+     *
+     * @param enabled true to enable the pyramid matching, false to match on the whole screen image.
+     */
+    private external fun setPyramidMatching(enabled: Boolean)
+
+    /**
+     * Native method for the sparse matching setup.
+     *
+     * @param enabled true to enable the sparse matching, false to match the complete conditions.
+     */
+    private external fun setSparseMatching(enabled: Boolean)
+
+    /**
+     * Native method for the binary matching setup.
+     *
+     * @param enabled true to enable the binary matching, false to match the complete conditions.
+     */
+    private external fun setBinaryMatching(enabled: Boolean)
+
+    /**
+     * Native method for the chamfer matching setup.
+     *
+     * @param enabled true to enable the chamfer matching, false to match the complete conditions.
+     */
+    private external fun setChamferMatching(enabled: Boolean)
+
+    /**
+     * Native method for the motion compensation setup.
+     *
+     * @param enabled true to enable the motion compensation, false to search the changed areas again.
+     */
+    private external fun setMotionCompensation(enabled: Boolean)
+
+    /**
+     * Native method for the animated areas exclusion setup.
+     *
+     * @param enabled true to learn the animated areas, false to only ignore the excluded areas.
+     */
+    private external fun setAnimatedAreasExclusion(enabled: Boolean)
+
+    /**
+     * Native method for the first hit matching setup.
+     *
+     * @param enabled true to enable the first hit matching, false to search the whole detection areas.
+     */
+    private external fun setFirstHitMatching(enabled: Boolean)
+
+    /**
+     * Native method for the learned area matching setup.
+     *
+     * @param enabled true to enable the learned area matching, false to search the whole detection areas.
+     */
+    private external fun setLearnedAreaMatching(enabled: Boolean)
 
-    /** The results of the detection. Modified by native code. */
-    @Keep
-    private val detectionResult = DetectionResult()
-    /** Native pointer of the detector object. */
-    @Keep
-    private var nativePtr: Long = -1
+    /**
+     * Native method for the integer scale ratio setup.
+     *
+     * @param enabled true to snap the scale ratio to the integer downscale factors, false to keep the quality one.
+     */
+    private external fun setIntegerScaleRatio(enabled: Boolean)
 
-    private val detectionQualityMin: Double = DETECTION_QUALITY_MIN.toDouble()
+    /**
+     * Native method for the cancellation of the detections.
+     *
+     * @param cancelled true to stop the running detection and skip the following ones, false to resume them.
+     */
+    private external fun setDetectionCancelled(cancelled: Boolean)
 
-    private var isClosed: Boolean = false
+    /**
+     * Native method waiting for an area of the screen to change.
+     *
+     * @param x the left coordinate of the area.
+     * @param y the top coordinate of the area.
+     * @param width the width of the area.
+     * @param height the height of the area.
+     * @param changeThreshold the part of the tiles of the area that must have changed, between 0 and 1.
+     * @param timeoutMs the maximum duration of the wait, in milliseconds.
+     *
+     * @return true if the area has changed, false if the wait has timed out or has been cancelled.
+     */
+    private external fun waitForRegionChange(
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        changeThreshold: Double,
+        timeoutMs: Long,
+    ): Boolean
 
-    override fun init() {
-        nativePtr = newDetector(detectionResult)
-    }
+    /**
+     * Native method for the multi scale matching setup.
+     *
+     * @param scales the resize factors of the conditions, empty to disable the multi scale matching.
+     */
+    private external fun setTemplateScales(scales: FloatArray)
 
+    /**
+     * Native method for the exact conditions jitter setup.
+     *
+     * @param pixels the jitter in screen pixels, 0 to only search the exact position of the conditions.
+     */
+    private external fun setNativeExactMatchingJitter(pixels: Int)
 
-    override fun close() {
-        if (isClosed) return
+    /**
+     * Native method for the exact pixel matching setup.
+     *
+     * @param enabled true to search the near exact conditions with their exact pixels, false to correlate them.
+     */
+    private external fun setExactPixelMatching(enabled: Boolean)
 
-        isClosed = true
-        deleteDetector()
-    }
+    /**
+     * Native method for the histogram color verification setup.
+     *
+     * @param enabled true to compare the color histograms of the candidates, false to compare their color means only.
+     */
+    private external fun setHistogramColorVerification(enabled: Boolean)
 
-    override fun setScreenMetrics(metricsKey: String, screenBitmap: Bitmap, detectionQuality: Double) {
-        if (isClosed) return
+    /**
+     * Native method for the scaled color verification setup.
+     *
+     * @param enabled true to compare the color means of the candidates at the scale ratio, false to compare them at
+     *                full size.
+     */
+    private external fun setScaledColorVerification(enabled: Boolean)
 
-        updateScreenMetrics(
-            metricsKey,
-            screenBitmap,
-            detectionQuality.coerceIn(detectionQualityMin, 10000.0),
-        )
-    }
+    /**
+     * Native method for the frame allocator setup.
+     *
+     * @param enabled true to allocate the screen images planes with the frame allocator.
+     */
+    private external fun setFrameAllocator(enabled: Boolean)
 
-    override fun setupDetection(screenBitmap: Bitmap) {
-        if (isClosed) return
+    /**
+     * Native method for the conditions prefiltering setup.
+     *
+     * @param enabled true to prove the implausible conditions of the scenario plans absent at once.
+     */
+    private external fun setConditionPrefilter(enabled: Boolean)
 
-        setScreenImage(screenBitmap)
-    }
+    /**
+     * Native method for the integer matching setup.
+     *
+     * @param enabled true to correlate the conditions in integers, false to use the OpenCv matching.
+     */
+    private external fun setIntegerMatching(enabled: Boolean)
 
-    override fun detectCondition(conditionBitmap: Bitmap, threshold: Int): DetectionResult {
-        if (isClosed) return detectionResult.copy()
+    /**
+     * Native method for the GPU matching setup.
+     *
+     * @param enabled true to match the conditions on the GPU when possible, false to match on the CPU only.
+     *
+     * @return true if the GPU matching is enabled.
+     */
+    private external fun setGpuMatching(enabled: Boolean): Boolean
 
-        detect(conditionBitmap, threshold)
-        return detectionResult.copy()
-    }
+    /**
+     * Native method for the NNAPI matching setup.
+     *
+     * @param enabled true to match the conditions on the neural networks accelerator when possible.
+     *
+     * @return true if the NNAPI matching is enabled.
+     */
+    private external fun setNnapiMatching(enabled: Boolean): Boolean
 
-    override fun detectCondition(conditionBitmap: Bitmap, identifying: String): DetectionResult {
-        if (isClosed) return detectionResult.copy()
+    /**
+     * Native method for the target detection rate setup.
+     *
+     * @param detectionsPerSecond the number of screen images to detect per second, or 0 for no pacing.
+     */
+    private external fun setDetectionRate(detectionsPerSecond: Double)
 
-        detect(conditionBitmap, identifying)
-        return detectionResult.copy()
-    }
+    /**
+     * Native method completing the current screen image detection.
+     *
+     * @return the delay to wait before the next screen image, in milliseconds.
+     */
+    private external fun getFrameDelay(): Long
+
+    /**
+     * Native method formatting the telemetry of the last detected screen images.
+     *
+     * @param maxCount the maximum number of screen images to format.
+     */
+    private external fun getNativeFrameTelemetry(maxCount: Int): String
 
+    /**
+     * Native method for the detection threads count setup.
+     *
+     * @param threadCount the number of threads in addition to the calling one, negative for the default.
+     */
+    private external fun setNativeThreadCount(threadCount: Int)
 
-    override fun detectCondition(conditionBitmap: Bitmap, position: Rect, threshold: Int): DetectionResult {
-        if (isClosed) return detectionResult.copy()
+    /**
+     * Native method for the detection threads scheduling policy setup.
+     *
+     * @param preferBigCores true to run on the fastest cores only.
+     * @param threadPriority the Linux priority of the threads.
+     */
+    private external fun setNativeThreadPolicy(preferBigCores: Boolean, threadPriority: Int)
 
-        detectAt(conditionBitmap, position.left, position.top, position.width(), position.height(), threshold, detectionResult)
-        return detectionResult.copy()
-    }
+    /**
+     * Native method for the performance hints setup.
+     *
+     * @param enabled true to report the frame costs to the system.
+     *
+     * @return true if the performance hints are enabled.
+     */
+    private external fun setPerformanceHint(enabled: Boolean): Boolean
 
-    override fun detectCondition(conditionBitmap: Bitmap, position: Rect, identifying: String): DetectionResult {
-        if (isClosed) return detectionResult.copy()
+    /**
+     * Native method for the text recognition setup.
+     *
+     * @param dataPath the directory containing the tessdata directory, or null to use the default one.
+     * @param language the language of the trained data to load.
+     * @param pageSegmentationMode the Tesseract page segmentation mode.
+     */
+    private external fun setOcrConfig(dataPath: String?, language: String, pageSegmentationMode: Int)
 
-        detectAt(conditionBitmap, position.left, position.top, position.width(), position.height(), identifying, detectionResult)
-        return detectionResult.copy()
-    }
+    /**
+     * Native method for opening a template pack.
+     *
+     * @param path the path of the pack file.
+     *
+     * @return true if the pack is valid.
+     */
+    private external fun openPack(path: String): Boolean
 
     /**
-     * Creates the detector. Must be called before any other methods.
-     * Call [close] to release resources once the detection process is finished.
+     * Native method for writing the processed conditions into a template pack.
      *
-     * @return the pointer of the native detector object.
+     * @param path the path of the pack file.
+     *
+     * @return true if the pack has been written.
      */
-    private external fun newDetector(result: DetectionResult): Long
+    private external fun writePack(path: String): Boolean
+
+    /** @return the identifiers of the conditions in the opened template pack, for the current scale ratio. */
+    private external fun getPackedConditionIds(): LongArray
+
+    /** @return true if the template of the condition is in the native cache, for the current scale ratio. */
+    private external fun isTemplateCached(conditionId: Long): Boolean
 
     /**
-     * Deletes the native detector.
-     * Once called, this object can't be used anymore.
+     * Native method for the conditions processing ahead of their detection.
+     *
+     * @param conditionIds the unique identifiers of the conditions.
+     * @param conditionBitmaps the conditions bitmaps, null for the ones in the template pack.
+     *
+     * @return the number of conditions ready to be detected.
      */
-    private external fun deleteDetector()
+    private external fun prepareTemplates(conditionIds: LongArray, conditionBitmaps: Array<Bitmap?>): Int
 
     /**
-     * Native method for screen metrics setup.
+     * Native method for the conditions processing ahead of their detection, from their image files.
      *
-     * @param screenBitmap the content of the screen as a bitmap.
-     * @param detectionQuality the quality of the detection. The higher the preciser, the lower the faster. Must be
-     *                         contained in [DETECTION_QUALITY_MIN] and [DETECTION_QUALITY_MAX].
+     * @param conditionIds the unique identifiers of the conditions.
+     * @param conditionPaths the paths of the conditions files, null for the ones cached or in the template pack.
+     * @param conditionSizes the width and height of each condition.
+     *
+     * @return the number of conditions ready to be detected.
      */
-    private external fun updateScreenMetrics(metricsKey: String, screenBitmap: Bitmap, detectionQuality: Double)
+    private external fun prepareTemplateFiles(
+        conditionIds: LongArray,
+        conditionPaths: Array<String?>,
+        conditionSizes: IntArray,
+    ): Int
+
+    /**
+     * Native method dropping the processed templates and the match histories of conditions.
+     *
+     * @param conditionIds the unique identifiers of the conditions.
+     */
+    private external fun removeTemplates(conditionIds: LongArray)
+
+    /**
+     * Native method compacting the templates of the idle conditions, and restoring the ones not idle anymore.
+     *
+     * @param conditionIds the unique identifiers of all idle conditions.
+     */
+    private external fun setIdleTemplates(conditionIds: LongArray)
+
+    /**
+     * Native method defining the conditions searched at several orientations.
+     *
+     * @param conditionIds the unique identifiers of the rotation tolerant conditions.
+     * @param rotationCounts the number of orientations of each condition, at the same index than its identifier.
+     */
+    private external fun setRotatedTemplates(conditionIds: LongArray, rotationCounts: IntArray)
+
+    /**
+     * Native method defining the similarity measured for the conditions.
+     *
+     * @param conditionIds the unique identifiers of the conditions.
+     * @param metrics the matching metric of each condition, at the same index than its identifier.
+     */
+    private external fun setMatchingMetrics(conditionIds: LongArray, metrics: IntArray)
+
+    /** @return [CONDITION_COUNTERS_STRIDE] values per detected condition, empty if the tracing is disabled. */
+    private external fun getNativeConditionCounters(): LongArray
+
+    /** @return [CONDITION_STATISTICS_STRIDE] values per condition searched at least once. */
+    private external fun getNativeConditionStatistics(): LongArray
+
+    /** @return [CACHE_STATISTICS_STRIDE] values per native cache, in [DetectorCacheType] order. */
+    private external fun getNativeCacheStatistics(): LongArray
+
+    /** @return [OCR_ENGINE_STATISTICS_VALUES_COUNT] values describing the OCR engines of the process. */
+    private external fun getNativeOcrEngineStatistics(): LongArray
+
+    /**
+     * Set the memory budget the native detector degrades to fit in.
+     *
+     * @param budgetBytes the budget in bytes, 0 for unbounded.
+     */
+    private external fun setNativeMemoryBudget(budgetBytes: Long)
+
+    /**
+     * Report the memory pressure the native detector sheds its caches for.
+     *
+     * @param pressure the [DetectorMemoryPressure] value.
+     */
+    private external fun setNativeMemoryPressure(pressure: Int)
+
+    /**
+     * Set the time budget each native condition matching degrades to fit in.
+     *
+     * @param budgetNs the budget in nanoseconds, 0 for unbounded.
+     */
+    private external fun setNativeConditionTimeBudget(budgetNs: Long)
+
+    /** @return [MEMORY_USAGE_VALUES_COUNT] values, the memory of each category. */
+    private external fun getNativeMemoryUsage(): LongArray
+
+    /**
+     * Set the number of screen images recorded by the native detection capture.
+     *
+     * @param frameCount the number of the last screen images to keep, 0 to disable the capture.
+     */
+    private external fun setNativeCaptureFrameCount(frameCount: Int)
+
+    /** @return true if the native detection capture has been written at this path. */
+    private external fun writeNativeCapture(path: String): Boolean
+
+    /**
+     * Native method for the detection quality suggestion.
+     *
+     * @param qualities the detection qualities to try.
+     * @param positionTolerance the maximum distance with the captured positions, in screen pixels.
+     *
+     * @return the suggested quality, or 0 if nothing is captured.
+     */
+    private external fun suggestNativeDetectionQuality(qualities: IntArray, positionTolerance: Int): Double
 
     /**
      * Native method for detection setup.
      *
      * @param screenBitmap the content of the screen as a bitmap.
+     *
+     * @return true if the content of the screen is identical to the previous one.
+     */
+    private external fun setScreenImage(screenBitmap: Bitmap): Boolean
+
+    /**
+     * Native method for detection setup, from a pixel buffer.
+     *
+     * @param screenBuffer a direct buffer containing the screen pixels in RGBA_8888.
+     * @param width the width of the screen, in pixels.
+     * @param height the height of the screen, in pixels.
+     * @param rowStride the number of bytes between the start of two consecutive rows.
+     * @param frameId the identifier of the captured frame, shared by the detectors set with it. 0 if not shared.
+     *
+     * @return true if the content of the screen is identical to the previous one.
+     */
+    private external fun setScreenImageBuffer(
+        screenBuffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        rowStride: Int,
+        frameId: Long,
+    ): Boolean
+
+    /**
+     * Native method for the background processing of the next screen pixels.
+     *
+     * @param screenBuffer a direct buffer containing the screen pixels in RGBA_8888.
+     * @param width the width of the screen, in pixels.
+     * @param height the height of the screen, in pixels.
+     * @param rowStride the number of bytes between the start of two consecutive rows.
+     * @param frameId the identifier of the captured frame, shared by the detectors set with it. 0 if not shared.
+     *
+     * @return true if the processing have been started.
+     */
+    private external fun prepareScreenImageBuffer(
+        screenBuffer: ByteBuffer,
+        width: Int,
+        height: Int,
+        rowStride: Int,
+        frameId: Long,
+    ): Boolean
+
+    /** Native method dropping the screen pixels being processed in the background. */
+    private external fun cancelScreenImagePreparation()
+
+    /**
+     * Native method opening the reader of the screen record frames.
+     *
+     * @param width the width of the frames, in pixels.
+     * @param height the height of the frames, in pixels.
+     *
+     * @return the surface of the reader, or null if it can't be opened.
+     */
+    private external fun openNativeScreenReader(width: Int, height: Int): Surface?
+
+    /** Native method closing the reader of the screen record frames. */
+    private external fun closeNativeScreenReader()
+
+    /**
+     * Native method waiting for a new frame in the screen reader.
+     *
+     * @param timeoutMs the maximum duration of the wait, in milliseconds.
+     *
+     * @return true if a new frame is available.
+     */
+    private external fun awaitNativeScreenReaderImage(timeoutMs: Long): Boolean
+
+    /**
+     * Native method acquiring the latest frame of the screen reader.
+     * @return the rendering time of the frame, 0 if there is none.
+     */
+    private external fun acquireNativeScreenReaderImage(): Long
+
+    /**
+     * Native method for detection setup, from the frame acquired in the screen reader.
+     * @return true if the content of the screen is identical to the previous one.
+     */
+    private external fun setScreenReaderImage(): Boolean
+
+    /**
+     * Native method limiting the processing of the screen images to some areas.
+     *
+     * @param regions the left, top, width and height of each area. Empty to process the whole screen.
+     */
+    private external fun setScreenRegions(regions: IntArray)
+
+    /**
+     * Native method setting the areas of the screen whose changes are ignored.
+     *
+     * @param areas the left, top, width and height of each area. Empty to ignore none.
+     */
+    private external fun setScreenExcludedAreas(areas: IntArray)
+
+    /**
+     * Native method setting the parts of the screen excluded from the detections on the whole screen.
+     *
+     * @param left the width of the inset on the left edge of the screen.
+     * @param top the height of the inset on the top edge of the screen.
+     * @param right the width of the inset on the right edge of the screen.
+     * @param bottom the height of the inset on the bottom edge of the screen.
+     */
+    private external fun setScreenInsets(left: Int, top: Int, right: Int, bottom: Int)
+
+    /**
+     * Native method classifying the current screen image in a state of the detected application.
+     *
+     * @return the identifier of the state, or [SCREEN_STATE_UNKNOWN] if there is no screen image.
      */
-    private external fun setScreenImage(screenBitmap: Bitmap)
+    private external fun classifyNativeScreenState(): Int
 
     /**
      * Native method for detecting if the bitmap is in the whole current screen bitmap.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen, null if its template is cached.
      * @param threshold the allowed error threshold allowed for the condition.
      */
-    private external fun detect(conditionBitmap: Bitmap, threshold: Int)
+    private external fun detect(conditionId: Long, conditionBitmap: Bitmap?, threshold: Int)
 
     /**
      * Native method for detecting if the bitmap is in the whole current screen bitmap.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen, null if its template is cached.
      * @param identifying the recognised information to consider the detection position.
      */
-    private external fun detect(conditionBitmap: Bitmap, identifying: String)
+    private external fun detectText(conditionId: Long, conditionBitmap: Bitmap?, identifying: String)
 
     /**
      * Native method for detecting if the bitmap is at a specific position in the current screen bitmap.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen, null if its template is cached.
      * @param x the horizontal position of the condition.
      * @param y the vertical position of the condition.
      * @param width the width of the condition.
@@ -163,32 +1384,153 @@ class NativeDetector private constructor() : ImageDetector {
      * @param threshold the allowed error threshold allowed for the condition.
      */
     private external fun detectAt(
-        conditionBitmap: Bitmap,
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        threshold: Int,
+    )
+
+    /**
+     * Native method for finding all occurrences of a bitmap in an area of the current screen bitmap.
+     *
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen, null if its template is cached.
+     * @param x the horizontal position of the area to search in. 0 with an empty area for the whole screen.
+     * @param y the vertical position of the area to search in.
+     * @param width the width of the area to search in.
+     * @param height the height of the area to search in.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param results the direct buffer receiving the occurrences, with room for [DetectionOccurrences.MAX_COUNT].
+     *
+     * @return the number of occurrences written in the results.
+     */
+    private external fun detectAll(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
+        x: Int,
+        y: Int,
+        width: Int,
+        height: Int,
+        threshold: Int,
+        results: ByteBuffer,
+    ): Int
+
+    /**
+     * Native method for detecting a cached condition without altering the detector state, from any thread.
+     *
+     * @param conditionId the unique identifier of the condition, with a cached template.
+     * @param x the horizontal position of the area to search in. 0 with an empty area for the whole screen.
+     * @param y the vertical position of the area to search in.
+     * @param width the width of the area to search in.
+     * @param height the height of the area to search in.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param result the direct buffer receiving the detection result, owned by the calling thread.
+     */
+    private external fun detectConcurrently(
+        conditionId: Long,
         x: Int,
         y: Int,
         width: Int,
         height: Int,
         threshold: Int,
-        result: DetectionResult
+        result: ByteBuffer,
     )
 
     /**
      * Native method for detecting if the bitmap is at a specific position in the current screen bitmap.
      *
-     * @param conditionBitmap the condition to detect in the screen.
+     * @param conditionId the unique identifier of the condition.
+     * @param conditionBitmap the condition to detect in the screen, null if its template is cached.
      * @param x the horizontal position of the condition.
      * @param y the vertical position of the condition.
      * @param width the width of the condition.
      * @param height the height of the condition.
      * @param identifying the recognised information to consider the detection position.
      */
-    private external fun detectAt(
-        conditionBitmap: Bitmap,
+    private external fun detectTextAt(
+        conditionId: Long,
+        conditionBitmap: Bitmap?,
         x: Int,
         y: Int,
         width: Int,
         height: Int,
         identifying: String,
-        result: DetectionResult
     )
-}
\ No newline at end of file
+
+    /**
+     * Native method for detecting a batch of conditions in the current screen bitmap.
+     *
+     * @param count the number of conditions in the batch.
+     * @param conditionIds the unique identifiers of the conditions.
+     * @param conditionBitmaps the conditions to detect in the screen.
+     * @param conditionParams the area, threshold, expected detection state, text recognition engine mode, text in
+     *                        area mode and feature matching mode of each condition.
+     * @param identifyings the recognised information for each condition, null to use the threshold.
+     * @param textLanguages the text recognition language of each text condition, null for the detector one.
+     * @param textWhitelists the characters that can be recognized in each text condition, null for all.
+     * @param operator the operator between the conditions.
+     * @param results direct buffer filled with the result of each condition, see [DETECTION_RESULT_BYTES].
+     *
+     * @return the number of conditions processed.
+     */
+    private external fun detectBatch(
+        count: Int,
+        conditionIds: LongArray,
+        conditionBitmaps: Array<Bitmap?>,
+        conditionParams: IntArray,
+        identifyings: Array<String?>,
+        textLanguages: Array<String?>,
+        textWhitelists: Array<String?>,
+        operator: Int,
+        results: ByteBuffer,
+    ): Int
+
+    /**
+     * Native method for compiling the image events of a scenario into the plan evaluated by [detectNativeScenario].
+     *
+     * @param eventIds the unique identifiers of the events, in evaluation order.
+     * @param eventParams the condition operator, keep detecting state and condition count of each event.
+     * @param conditionIds the unique identifiers of the conditions of all events, grouped by event.
+     * @param conditionParams the parameters of each condition, as for [detectBatch].
+     * @param identifyings the recognised information for each condition, null to use the threshold.
+     * @param textLanguages the text recognition language of each text condition, null for the detector one.
+     * @param textWhitelists the characters that can be recognized in each text condition, null for all.
+     * @param speculativeEventCount the number of first events evaluated speculatively.
+     */
+    private external fun compileNativeScenario(
+        eventIds: LongArray,
+        eventParams: IntArray,
+        conditionIds: LongArray,
+        conditionParams: IntArray,
+        identifyings: Array<String?>,
+        textLanguages: Array<String?>,
+        textWhitelists: Array<String?>,
+        speculativeEventCount: Int,
+    )
+
+    /**
+     * Native method for evaluating the compiled plan in the current screen image.
+     *
+     * @param results direct buffer filled with the result of each processed condition, see [DETECTION_RESULT_BYTES].
+     * @param skippedEvents for each event, true if it is not detected on this screen image.
+     * @param processedCounts filled with the number of conditions processed for each event.
+     * @param deadlineNs the time after which the evaluation is aborted, in the [System.nanoTime] time base. 0 for none.
+     *
+     * @return the number of events evaluated, or [SCENARIO_PIXELS_NEEDED] if a condition template is no longer cached,
+     *         or [SCENARIO_FRAME_EXPIRED] if the deadline is passed.
+     */
+    private external fun detectNativeScenario(
+        results: ByteBuffer,
+        skippedEvents: BooleanArray,
+        processedCounts: IntArray,
+        deadlineNs: Long,
+    ): Int
+}
+
+/** Returned by [NativeDetector.detectNativeScenario] when a template is no longer cached. Must match native code. */
+private const val SCENARIO_PIXELS_NEEDED = -1
+/** Returned by [NativeDetector.detectNativeScenario] when the deadline is passed. Must match native code. */
+private const val SCENARIO_FRAME_EXPIRED = -2
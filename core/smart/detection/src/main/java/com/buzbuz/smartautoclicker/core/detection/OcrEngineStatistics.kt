@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+/**
+ * The text recognition engines created by the native detection since the process start. The engines are shared by
+ * all detectors of the process, and kept until it ends.
+ *
+ * @param engineCount the number of engines created.
+ * @param mappedEngineCount the number of engines initialized from a memory mapped trained data file, instead of a
+ *                          heap copy of the file.
+ * @param totalInitTimeNs the time spent initializing all engines, in nanoseconds.
+ * @param maxInitTimeNs the slowest initialization of an engine, in nanoseconds.
+ */
+data class OcrEngineStatistics(
+    val engineCount: Long = 0,
+    val mappedEngineCount: Long = 0,
+    val totalInitTimeNs: Long = 0,
+    val maxInitTimeNs: Long = 0,
+) {
+
+    /** The mean initialization time of an engine, in nanoseconds. */
+    val meanInitTimeNs: Long
+        get() = if (engineCount > 0) totalInitTimeNs / engineCount else 0
+}
+
+/** Number of values in the native OCR engines statistics array. Must match OCR_ENGINE_STATISTICS_VALUES_COUNT. */
+internal const val OCR_ENGINE_STATISTICS_VALUES_COUNT = 4
+
+/** @return the OCR engines statistics in an array filled by the native detector. */
+internal fun LongArray.toOcrEngineStatistics(): OcrEngineStatistics =
+    if (size < OCR_ENGINE_STATISTICS_VALUES_COUNT) OcrEngineStatistics()
+    else OcrEngineStatistics(
+        engineCount = get(0),
+        mappedEngineCount = get(1),
+        totalInitTimeNs = get(2),
+        maxInitTimeNs = get(3),
+    )
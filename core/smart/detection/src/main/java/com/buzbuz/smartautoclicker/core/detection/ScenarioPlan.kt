@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+import android.graphics.Rect
+
+/**
+ * The image events of a scenario, compiled with [ImageDetector.compileScenario] into a native plan evaluated for a
+ * whole screen image in a single call with [ImageDetector.detectScenario].
+ *
+ * The events are added in evaluation order with [addEvent], each one followed by its conditions. All conditions
+ * templates must be cached in the detector, see [ImageDetector.isConditionCached]: no bitmap is kept in the plan.
+ * The plan is compiled once, and detected on each screen image until the events or their order change.
+ *
+ * @param initialCapacity the initial number of events and conditions the plan can hold without growing its arrays.
+ */
+class ScenarioPlan(initialCapacity: Int = DEFAULT_CAPACITY) {
+
+    /** The number of events in the plan. */
+    var eventCount: Int = 0
+        private set
+    /**
+     * The number of events evaluated during the last detection. The evaluation stops after the first fulfilled event
+     * with [addEvent] keepDetecting false, so it can be lower than [eventCount].
+     */
+    var evaluatedCount: Int = 0
+        internal set
+    /**
+     * True if the last detection couldn't evaluate the plan because the template of one of its conditions is no
+     * longer cached in the detector. The events must then be detected with their bitmaps before using the plan again.
+     */
+    var isPixelsNeeded: Boolean = false
+        internal set
+    /**
+     * True if the last detection was aborted because the [deadlineNs] was passed before its end. No event has been
+     * evaluated, the screen image is too old for its results to be used.
+     */
+    var isFrameExpired: Boolean = false
+        internal set
+    /**
+     * The time after which the screen image is too old for its results to be used, in the [System.nanoTime] time base.
+     * The native evaluation is aborted between two conditions once it is passed. 0 for no deadline. Read by each
+     * [ImageDetector.detectScenario].
+     */
+    var deadlineNs: Long = 0
+    /**
+     * The number of first events evaluated speculatively: the conditions of all of them are detected concurrently on
+     * the detector threads, and the fulfilled event with the highest priority is kept. The detection of the lower
+     * priority events is cancelled once it is known. This lowers the latency when the first events are usually not
+     * fulfilled, at the cost of detecting conditions that might not be needed.
+     * 0 or 1 to detect the events one after another. Read by [ImageDetector.compileScenario].
+     */
+    var speculativeEventCount: Int = 0
+
+    /** The conditions of all events, grouped by event. Its operator is not used. */
+    internal val conditions: DetectionBatch = DetectionBatch(initialCapacity)
+
+    internal var eventIds: LongArray = LongArray(initialCapacity)
+        private set
+    internal var eventParams: IntArray = IntArray(initialCapacity * EVENT_PARAMS_STRIDE)
+        private set
+    internal var processedCounts: IntArray = IntArray(initialCapacity)
+        private set
+    internal var skippedEvents: BooleanArray = BooleanArray(initialCapacity)
+        private set
+    private var firstConditionIndexes: IntArray = IntArray(initialCapacity)
+
+    /** Remove all events from the plan. Arrays are kept to be reused. */
+    fun clear() {
+        conditions.clear()
+        eventCount = 0
+        evaluatedCount = 0
+        isPixelsNeeded = false
+        isFrameExpired = false
+        speculativeEventCount = 0
+        deadlineNs = 0
+    }
+
+    /**
+     * Add an event to the plan, the next conditions added being the ones of this event.
+     *
+     * @param eventId the unique identifier of the event.
+     * @param operator the operator between the conditions of the event, [DetectionBatch.OPERATOR_AND] or
+     *                 [DetectionBatch.OPERATOR_OR].
+     * @param keepDetecting true to evaluate the next events once this one is fulfilled, false to stop.
+     */
+    fun addEvent(eventId: Long, operator: Int, keepDetecting: Boolean) {
+        if (eventCount == eventIds.size) grow()
+
+        eventIds[eventCount] = eventId
+        firstConditionIndexes[eventCount] = conditions.size
+        skippedEvents[eventCount] = false
+
+        val paramsIndex = eventCount * EVENT_PARAMS_STRIDE
+        eventParams[paramsIndex] = operator
+        eventParams[paramsIndex + 1] = if (keepDetecting) 1 else 0
+        eventParams[paramsIndex + 2] = 0
+
+        eventCount++
+    }
+
+    /**
+     * Add a condition to the last added event.
+     *
+     * @param conditionId the unique identifier of the condition. Its template must be cached in the detector.
+     * @param area the area of the screen to detect the condition in, null for the whole screen.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the event operator.
+     * @param identifying the recognised information to consider the detection position, or null to use [threshold].
+     * @param textOptions the text recognition options of the condition, or null for the detector configuration.
+     *                    Only used when [identifying] is set.
+     */
+    fun addCondition(
+        conditionId: Long,
+        area: Rect?,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+        identifying: String? = null,
+        textOptions: TextRecognitionOptions? = null,
+    ) {
+        check(eventCount > 0) { "A condition must be added after its event" }
+
+        conditions.add(conditionId, null, area, threshold, shouldBeDetected, identifying, textOptions)
+        eventParams[(eventCount - 1) * EVENT_PARAMS_STRIDE + 2]++
+    }
+
+    /**
+     * Add a condition to the last added event, detected with its feature points. See [DetectionBatch.addFeatures].
+     *
+     * @param conditionId the unique identifier of the condition. Its template must be cached in the detector.
+     * @param area the area of the screen to detect the condition in, null for the whole screen.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the event operator.
+     */
+    fun addFeaturesCondition(
+        conditionId: Long,
+        area: Rect?,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+    ) {
+        check(eventCount > 0) { "A condition must be added after its event" }
+
+        conditions.addFeatures(conditionId, null, area, threshold, shouldBeDetected)
+        eventParams[(eventCount - 1) * EVENT_PARAMS_STRIDE + 2]++
+    }
+
+    /**
+     * Add a text condition to the last added event, searched directly in an area of the screen without its condition
+     * bitmap. See [DetectionBatch.addTextInArea].
+     *
+     * @param conditionId the unique identifier of the condition.
+     * @param area the area of the screen to search the text in, null for the whole screen.
+     * @param identifying the text to find.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the event operator.
+     * @param textOptions the text recognition options of the condition, or null for the detector configuration.
+     */
+    fun addTextInAreaCondition(
+        conditionId: Long,
+        area: Rect?,
+        identifying: String,
+        shouldBeDetected: Boolean,
+        textOptions: TextRecognitionOptions? = null,
+    ) {
+        check(eventCount > 0) { "A condition must be added after its event" }
+
+        conditions.addTextInArea(conditionId, area, identifying, shouldBeDetected, textOptions)
+        eventParams[(eventCount - 1) * EVENT_PARAMS_STRIDE + 2]++
+    }
+
+    /**
+     * Add a condition to the last added event, located by another condition of the plan: its anchor. The anchor is
+     * detected once per screen image, and the condition is only searched in an area at a fixed offset from the anchor
+     * detection. It is not detected if the anchor isn't. Many conditions at fixed positions in a moving dialog are
+     * then a single search of the dialog in the whole screen, and a small search for each condition.
+     *
+     * @param conditionId the unique identifier of the condition. Its template must be cached in the detector.
+     * @param anchorIndex the index of the anchor condition, in the conditions addition order. It can be added before
+     *                    or after this condition, in any event, and can't be anchored itself. Checked by
+     *                    [ImageDetector.compileScenario].
+     * @param anchorArea the area to detect the condition in, relative to the center of the anchor detection, in
+     *                   screen coordinates.
+     * @param threshold the allowed error threshold allowed for the condition.
+     * @param shouldBeDetected the expected detection state, used to short-circuit the event operator.
+     * @param identifying the recognised information to consider the detection position, or null to use [threshold].
+     * @param textOptions the text recognition options of the condition, or null for the detector configuration.
+     *                    Only used when [identifying] is set.
+     */
+    fun addAnchoredCondition(
+        conditionId: Long,
+        anchorIndex: Int,
+        anchorArea: Rect,
+        threshold: Int,
+        shouldBeDetected: Boolean,
+        identifying: String? = null,
+        textOptions: TextRecognitionOptions? = null,
+    ) {
+        check(eventCount > 0) { "A condition must be added after its event" }
+        require(anchorIndex >= 0) { "The anchor index can't be negative" }
+        require(!anchorArea.isEmpty) { "The anchor area can't be empty" }
+
+        conditions.addAnchored(
+            conditionId, anchorIndex, anchorArea, threshold, shouldBeDetected, identifying, textOptions,
+        )
+        eventParams[(eventCount - 1) * EVENT_PARAMS_STRIDE + 2]++
+    }
+
+    /**
+     * Skip an event during the next detections, without compiling the plan again. A skipped event is not detected and
+     * can't stop the evaluation, as if it wasn't fulfilled.
+     *
+     * @param eventIndex the index of the event, in the events addition order.
+     * @param isSkipped true to skip the event, false to detect it.
+     */
+    fun setEventSkipped(eventIndex: Int, isSkipped: Boolean) {
+        skippedEvents[eventIndex] = isSkipped
+    }
+
+    /** @return the index of the first condition of the event at [eventIndex], in the conditions addition order. */
+    fun getFirstConditionIndex(eventIndex: Int): Int =
+        firstConditionIndexes[eventIndex]
+
+    /**
+     * @return the number of conditions of the event at [eventIndex] processed during the last detection, 0 if the
+     *         event was not evaluated. The event operator is short-circuited, it can be lower than its condition count.
+     */
+    fun getProcessedCount(eventIndex: Int): Int =
+        if (eventIndex < evaluatedCount) processedCounts[eventIndex] else 0
+
+    /** @return true if the condition at [conditionIndex] have been detected during the last detection. */
+    fun isDetected(conditionIndex: Int): Boolean =
+        conditions.isDetected(conditionIndex)
+
+    /** @return the horizontal center of the condition at [conditionIndex], in screen coordinates. */
+    fun getPositionX(conditionIndex: Int): Int =
+        conditions.getPositionX(conditionIndex)
+
+    /** @return the vertical center of the condition at [conditionIndex], in screen coordinates. */
+    fun getPositionY(conditionIndex: Int): Int =
+        conditions.getPositionY(conditionIndex)
+
+    /** @return the confidence rate of the condition at [conditionIndex]. */
+    fun getConfidenceRate(conditionIndex: Int): Double =
+        conditions.getConfidenceRate(conditionIndex)
+
+    /** @return true if the detection of the condition at [conditionIndex] have been degraded to stay in its budget. */
+    fun isDegraded(conditionIndex: Int): Boolean =
+        conditions.isDegraded(conditionIndex)
+
+    /** @return the counterclockwise orientation the condition at [conditionIndex] have been found at, in degrees. */
+    fun getAngle(conditionIndex: Int): Int =
+        conditions.getAngle(conditionIndex)
+
+    /** @return the duration of the detection of the condition at [conditionIndex], in nanoseconds. */
+    fun getDetectionDurationNs(conditionIndex: Int): Long =
+        conditions.getDetectionDurationNs(conditionIndex)
+
+    private fun grow() {
+        val newCapacity = eventIds.size * 2
+        eventIds = eventIds.copyOf(newCapacity)
+        eventParams = eventParams.copyOf(newCapacity * EVENT_PARAMS_STRIDE)
+        firstConditionIndexes = firstConditionIndexes.copyOf(newCapacity)
+        skippedEvents = skippedEvents.copyOf(newCapacity)
+        // Counts are only valid after a detection, there is nothing to copy
+        processedCounts = IntArray(newCapacity)
+    }
+
+    private companion object {
+        const val DEFAULT_CAPACITY = 8
+        /** Number of values per event in [eventParams]. Must match SCENARIO_EVENT_PARAMS_STRIDE in native code. */
+        const val EVENT_PARAMS_STRIDE = 3
+    }
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.detection
+
+/**
+ * The text recognition options of a single text condition of a [DetectionBatch], overriding the detector
+ * configuration set with [ImageDetector.setTextRecognitionConfig].
+ *
+ * A condition looking for numbers or short words is recognized much faster with a small language and a character
+ * whitelist than with the default language. Each set of options gets its own engines, loaded on first use.
+ *
+ * @param language the language of the trained data to load, or null for the detector one.
+ * @param charWhitelist the only characters that can be recognized, or null for all characters.
+ * @param engineMode the Tesseract engine mode, [TEXT_RECOGNITION_ENGINE_MODE_LSTM_ONLY] or
+ *                   [TEXT_RECOGNITION_ENGINE_MODE_LEGACY], or [TEXT_RECOGNITION_ENGINE_MODE_DEFAULT] for the detector
+ *                   one. The legacy mode requires trained data containing the legacy model.
+ */
+data class TextRecognitionOptions(
+    val language: String? = null,
+    val charWhitelist: String? = null,
+    val engineMode: Int = TEXT_RECOGNITION_ENGINE_MODE_DEFAULT,
+)
+
+/** Keep the engine mode of the detector text recognition configuration. */
+const val TEXT_RECOGNITION_ENGINE_MODE_DEFAULT = -1
+/** The legacy Tesseract engine only. Must match tesseract::OEM_TESSERACT_ONLY. */
+const val TEXT_RECOGNITION_ENGINE_MODE_LEGACY = 0
+/** The LSTM Tesseract engine only. Must match tesseract::OEM_LSTM_ONLY. */
+const val TEXT_RECOGNITION_ENGINE_MODE_LSTM_ONLY = 1
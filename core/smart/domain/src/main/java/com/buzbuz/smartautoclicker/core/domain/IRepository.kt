@@ -176,6 +176,36 @@ interface IRepository {
      */
     suspend fun getConditionBitmap(condition: ImageCondition): Bitmap?
 
+    /**
+     * Get the thumbnail of the bitmap for the given image condition, for the condition lists.
+     * Thumbnails are cached separately from the bitmaps by the bitmap manager, showing them never evicts the bitmaps.
+     *
+     * @param condition the condition to get the thumbnail from.
+     *
+     * @return the thumbnail, or null if the path can't be found.
+     */
+    suspend fun getConditionThumbnail(condition: ImageCondition): Bitmap?
+
+    /**
+     * Load the bitmap for the given image condition, without caching it.
+     * Used by the detection, that keeps its own processed version of the bitmap.
+     *
+     * @param condition the condition to load the bitmap from.
+     *
+     * @return the bitmap, or null if the path can't be found.
+     */
+    suspend fun loadConditionBitmap(condition: ImageCondition): Bitmap?
+
+    /**
+     * Get the absolute path of the file of the bitmap for the given image condition, for the detection reading it
+     * natively instead of loading the bitmap.
+     *
+     * @param condition the condition to get the file from.
+     *
+     * @return the path of the file, or null if it can't be found.
+     */
+    fun getConditionBitmapFilePath(condition: ImageCondition): String?
+
     suspend fun cleanupUnusedBitmaps(removedPath: List<String>)
 
     fun startTutorialMode()
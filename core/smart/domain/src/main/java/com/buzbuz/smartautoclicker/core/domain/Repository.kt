@@ -139,6 +139,15 @@ internal class Repository @Inject internal constructor(
     override suspend fun getConditionBitmap(condition: ImageCondition): Bitmap? =
         bitmapManager.getImageConditionBitmap(condition.path, condition.area.width(), condition.area.height())
 
+    override suspend fun getConditionThumbnail(condition: ImageCondition): Bitmap? =
+        bitmapManager.getImageConditionThumbnail(condition.path, condition.area.width(), condition.area.height())
+
+    override suspend fun loadConditionBitmap(condition: ImageCondition): Bitmap? =
+        bitmapManager.loadImageConditionBitmap(condition.path, condition.area.width(), condition.area.height())
+
+    override fun getConditionBitmapFilePath(condition: ImageCondition): String? =
+        bitmapManager.getImageConditionFile(condition.path)?.absolutePath
+
     override suspend fun cleanupUnusedBitmaps(removedPath: List<String>) {
         dataSource.clearRemovedConditionsBitmaps(removedPath)
     }
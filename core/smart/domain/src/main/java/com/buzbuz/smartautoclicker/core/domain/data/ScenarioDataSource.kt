@@ -276,7 +276,10 @@ internal class ScenarioDataSource(
             mappingClosure = { condition ->
                 when (condition) {
                     is ImageCondition ->
-                        condition.copy(eventId = Identifier(databaseId = eventDbId)).toEntity()
+                        condition.copy(eventId = Identifier(databaseId = eventDbId)).toEntity().copy(
+                            // Anchors inserted with this update are not known yet, see updateConditionsAnchors
+                            anchorConditionId = scenarioUpdateState.getAnchorConditionDatabaseId(condition),
+                        )
                     is TriggerCondition ->
                         condition.copy(evtId = Identifier(databaseId = eventDbId)).toEntity()
                 }
@@ -294,12 +297,27 @@ internal class ScenarioDataSource(
                         scenarioUpdateState.addConditionIdMapping(domainId, dbId)
                     }
 
+                    updateConditionsAnchors(eventDbId, newConditions)
                     if (removed.isNotEmpty()) clearRemovedConditionsBitmaps(removed.mapNotNull { it.path })
                 }
             )
         }
     }
 
+    /** Set the anchors referencing conditions inserted with the event, their database ids being known now. */
+    private suspend fun updateConditionsAnchors(eventDbId: Long, conditions: List<Condition>) {
+        val anchoredConditions = conditions.mapNotNull { condition ->
+            if (condition !is ImageCondition || condition.anchorConditionId?.tempId == null) return@mapNotNull null
+
+            condition.copy(eventId = Identifier(databaseId = eventDbId)).toEntity().copy(
+                id = scenarioUpdateState.getConditionDbId(condition.id),
+                anchorConditionId = scenarioUpdateState.getAnchorConditionDatabaseId(condition),
+            )
+        }
+
+        if (anchoredConditions.isNotEmpty()) currentDatabase.value.conditionDao().updateConditions(anchoredConditions)
+    }
+
     private suspend fun updateActions(eventDbId: Long, newActions: List<Action>) {
         val currentCompleteActions = currentDatabase.value.actionDao().getCompleteActions(eventDbId)
         val currentActionsEntities = currentCompleteActions.map { it.action }
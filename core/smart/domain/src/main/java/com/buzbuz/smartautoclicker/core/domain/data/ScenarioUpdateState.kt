@@ -19,6 +19,7 @@ package com.buzbuz.smartautoclicker.core.domain.data
 import com.buzbuz.smartautoclicker.core.base.identifier.Identifier
 import com.buzbuz.smartautoclicker.core.domain.model.action.Action
 import com.buzbuz.smartautoclicker.core.domain.model.action.Click
+import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 
 internal class ScenarioUpdateState {
 
@@ -53,7 +54,17 @@ internal class ScenarioUpdateState {
         if (action is Click) action.clickOnConditionId?.let { getConditionDbId(it) }
         else null
 
-    private fun getConditionDbId(identifier: Identifier?): Long = when {
+    /**
+     * @return the database id of the anchor of the condition, or null if it has none. A condition must be inserted
+     * before being referenced as an anchor, null is also returned for an anchor removed from the event.
+     */
+    fun getAnchorConditionDatabaseId(condition: ImageCondition): Long? {
+        val identifier = condition.anchorConditionId ?: return null
+        return if (identifier.tempId == null) identifier.databaseId.takeIf { it != 0L }
+        else conditionsDomainToDbIdMap[identifier.tempId]
+    }
+
+    fun getConditionDbId(identifier: Identifier?): Long = when {
         identifier != null && identifier.tempId == null && identifier.databaseId != 0L -> identifier.databaseId
         identifier != null -> conditionsDomainToDbIdMap[identifier.tempId]
             ?: throw IllegalStateException("Identifier is not found in condition map for $identifier")
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.domain.model
+
+import androidx.annotation.IntDef
+
+/**
+ * Defines the similarity measured between an image condition and the screen content. Whatever the metric, the
+ * threshold is the tolerated difference in percent. Must match the values of the native MatchingMetric.
+ */
+@IntDef(METRIC_CCOEFF_NORMED, METRIC_SQDIFF_NORMED, METRIC_SAD)
+@Retention(AnnotationRetention.SOURCE)
+annotation class MatchingMetric
+/** The normalized correlation, tolerating the brightness and contrast changes of the screen. */
+const val METRIC_CCOEFF_NORMED = 0
+/** The normalized sum of squared differences, cheaper but for the same brightness only. */
+const val METRIC_SQDIFF_NORMED = 1
+/** The sum of absolute differences, the cheapest, for the conditions captured on the same device and colors. */
+const val METRIC_SAD = 2
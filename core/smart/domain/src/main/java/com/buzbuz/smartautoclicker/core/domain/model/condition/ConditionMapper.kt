@@ -23,6 +23,8 @@ import com.buzbuz.smartautoclicker.core.database.entity.CounterComparisonOperati
 import com.buzbuz.smartautoclicker.core.database.entity.ConditionType
 import com.buzbuz.smartautoclicker.core.database.entity.CounterOperationValueType
 import com.buzbuz.smartautoclicker.core.domain.model.CounterOperationValue
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_CCOEFF_NORMED
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_SAD
 
 
 /** @return the entity equivalent of this condition. */
@@ -44,6 +46,15 @@ internal fun ImageCondition.toEntity() = ConditionEntity(
     detectionAreaTop = detectionArea?.top,
     detectionAreaRight = detectionArea?.right,
     detectionAreaBottom = detectionArea?.bottom,
+    rotationCount = rotationCount,
+    matchingMetric = matchingMetric,
+    isTextInArea = isTextInArea,
+    isFeatureMatching = isFeatureMatching,
+    anchorConditionId = anchorConditionId?.databaseId,
+    anchorAreaLeft = anchorArea?.left,
+    anchorAreaTop = anchorArea?.top,
+    anchorAreaRight = anchorArea?.right,
+    anchorAreaBottom = anchorArea?.bottom,
 )
 
 internal fun TriggerCondition.toEntity(): ConditionEntity = when (this) {
@@ -113,6 +124,12 @@ private fun ConditionEntity.toDomainImageCondition(cleanIds: Boolean = false): I
         detectionType = detectionType!!,
         detectionArea = getDetectionArea(),
         shouldBeDetected = shouldBeDetected ?: true,
+        rotationCount = rotationCount?.coerceIn(1, IMAGE_CONDITION_MAX_ROTATIONS) ?: 1,
+        matchingMetric = matchingMetric?.takeIf { it in METRIC_CCOEFF_NORMED..METRIC_SAD } ?: METRIC_CCOEFF_NORMED,
+        isTextInArea = isTextInArea ?: false,
+        isFeatureMatching = isFeatureMatching ?: false,
+        anchorConditionId = anchorConditionId?.let { Identifier(id = it, asTemporary = cleanIds) },
+        anchorArea = getAnchorArea(),
     )
 
 private fun ConditionEntity.toDomainBroadcastReceived(cleanIds: Boolean = false): TriggerCondition =
@@ -153,5 +170,11 @@ private fun CounterComparisonOperation.toDomain(): TriggerCondition.OnCounterCou
 private fun ConditionEntity.getDetectionArea(): Rect? =
     if (detectionAreaLeft != null && detectionAreaTop != null && detectionAreaRight != null && detectionAreaBottom != null)
         Rect(detectionAreaLeft!!, detectionAreaTop!!, detectionAreaRight!!, detectionAreaBottom!!)
+    else
+        null
+
+private fun ConditionEntity.getAnchorArea(): Rect? =
+    if (anchorAreaLeft != null && anchorAreaTop != null && anchorAreaRight != null && anchorAreaBottom != null)
+        Rect(anchorAreaLeft!!, anchorAreaTop!!, anchorAreaRight!!, anchorAreaBottom!!)
     else
         null
\ No newline at end of file
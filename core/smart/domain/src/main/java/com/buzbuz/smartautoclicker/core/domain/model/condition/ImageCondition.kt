@@ -20,6 +20,8 @@ import android.graphics.Rect
 
 import com.buzbuz.smartautoclicker.core.domain.model.DetectionType
 import com.buzbuz.smartautoclicker.core.domain.model.IN_AREA
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_CCOEFF_NORMED
+import com.buzbuz.smartautoclicker.core.domain.model.MatchingMetric
 import com.buzbuz.smartautoclicker.core.base.identifier.Identifier
 import com.buzbuz.smartautoclicker.core.base.interfaces.Prioritizable
 
@@ -34,6 +36,18 @@ import com.buzbuz.smartautoclicker.core.base.interfaces.Prioritizable
  * @param threshold the accepted difference between the conditions and the screen content, in percent (0-100%).
  * @param detectionType the type of detection for this condition. Must be one of [DetectionType].
  * @param detectionArea the area to detect the condition in if [detectionType] is IN_AREA.
+ * @param rotationCount the number of orientations the condition is searched at, evenly spread over a turn. 1 to only
+ *                      search it at its own orientation, up to [IMAGE_CONDITION_MAX_ROTATIONS].
+ * @param matchingMetric the similarity measured between the condition and the screen content. Must be one of
+ *                       [MatchingMetric].
+ * @param isTextInArea true to search the [name] in the text of the [detectionArea] directly, without the condition
+ *                     bitmap. Only used if [detectionType] is IN_AREA.
+ * @param isFeatureMatching true to detect the condition with its feature points instead of its pixels. It is found
+ *                          even if scaled, slightly rotated or partially covered, but its name isn't read.
+ * @param anchorConditionId the image condition of the same event locating this one, null to detect it in its
+ *                          [detectionType] area. The anchor can't be anchored itself.
+ * @param anchorArea the area to detect the condition in, relative to the center of its anchor detection. Must be set
+ *                   if [anchorConditionId] is.
  */
 data class ImageCondition(
     override val id: Identifier,
@@ -46,19 +60,32 @@ data class ImageCondition(
     @DetectionType val detectionType: Int,
     val shouldBeDetected: Boolean,
     val detectionArea: Rect? = null,
+    val rotationCount: Int = 1,
+    @MatchingMetric val matchingMetric: Int = METRIC_CCOEFF_NORMED,
+    val isTextInArea: Boolean = false,
+    val isFeatureMatching: Boolean = false,
+    val anchorConditionId: Identifier? = null,
+    val anchorArea: Rect? = null,
 ): Condition(), Prioritizable {
 
     /** @return creates a deep copy of this condition. */
     fun deepCopy(): ImageCondition = copy(
         path = "" + path,
         area = Rect(area),
+        anchorArea = anchorArea?.let { Rect(it) },
     )
 
     /** Tells if this condition is complete and valid to be saved. */
     override fun isComplete(): Boolean =
-        super.isComplete() && (detectionType == IN_AREA && detectionArea != null || detectionType != IN_AREA)
+        super.isComplete() && (detectionType == IN_AREA && detectionArea != null || detectionType != IN_AREA) &&
+                (anchorConditionId == null || anchorArea?.isEmpty == false)
 
     override fun hashCodeNoIds(): Int =
         name.hashCode() + path.hashCode() + area.hashCode() + threshold.hashCode() + detectionType.hashCode() +
-                shouldBeDetected.hashCode() + detectionArea.hashCode() + priority.hashCode()
+                shouldBeDetected.hashCode() + detectionArea.hashCode() + priority.hashCode() +
+                rotationCount.hashCode() + matchingMetric.hashCode() + isTextInArea.hashCode() +
+                isFeatureMatching.hashCode() + anchorArea.hashCode()
 }
+
+/** The maximum number of orientations an [ImageCondition] can be searched at. */
+const val IMAGE_CONDITION_MAX_ROTATIONS = 36
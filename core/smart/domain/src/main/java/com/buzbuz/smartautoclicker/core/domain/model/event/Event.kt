@@ -72,6 +72,9 @@ sealed class Event: Identifiable, Completable {
  * Event of a scenario.
  *
  * @param priority the execution priority of the event in the scenario.
+ * @param keepDetecting true to keep detecting the next events on the same screen frame once this one is fulfilled.
+ * @param detectionFrameInterval the number of screen frames between two detections of this event, 1 for every frame.
+ * @param detectionMinIntervalMs the minimum duration in milliseconds between two detections of this event, 0 for none.
  */
 data class ImageEvent(
     override val id: Identifier,
@@ -83,6 +86,8 @@ data class ImageEvent(
     override val enabledOnStart: Boolean = true,
     override var priority: Int,
     val keepDetecting: Boolean,
+    val detectionFrameInterval: Int = 1,
+    val detectionMinIntervalMs: Long = 0,
 ): Event(), Prioritizable {
 
     /** Tells if this event is complete and valid for save. */
@@ -40,6 +40,8 @@ private fun ImageEvent.toEntity() = EventEntity(
     conditionOperator = conditionOperator,
     priority = priority,
     keepDetecting = keepDetecting,
+    detectionFrameInterval = detectionFrameInterval,
+    detectionMinIntervalMs = detectionMinIntervalMs,
     enabledOnStart = enabledOnStart,
     type = EventType.IMAGE_EVENT,
 )
@@ -73,6 +75,8 @@ internal fun CompleteEventEntity.toDomainImageEvent(cleanIds: Boolean = false):
         priority = event.priority,
         enabledOnStart = event.enabledOnStart,
         keepDetecting = event.keepDetecting == true,
+        detectionFrameInterval = event.detectionFrameInterval?.coerceAtLeast(1) ?: 1,
+        detectionMinIntervalMs = event.detectionMinIntervalMs?.coerceAtLeast(0) ?: 0,
         actions = actions.map { it.toDomain(cleanIds) }.sortedByPriority().toMutableList(),
         conditions = conditions.map { it.toDomain(cleanIds) as ImageCondition }.sortedByPriority().toMutableList(),
     )
@@ -192,6 +192,25 @@ class RepositoryTests {
         verify(mockBitmapManager).getImageConditionBitmap("toto", 20, 100)
         Unit
     }
+
+    @Test
+    fun getThumbnail() = runTest {
+        repository.getConditionThumbnail(
+            ImageCondition(
+                id = Identifier(databaseId = 1L),
+                eventId = Identifier(databaseId = 2L),
+                name = "tata",
+                threshold = 10,
+                detectionType = EXACT,
+                shouldBeDetected = true,
+                area = Rect(0, 0, 20, 100),
+                path = "toto",
+                priority = 0,
+            )
+        )
+        verify(mockBitmapManager).getImageConditionThumbnail("toto", 20, 100)
+        Unit
+    }
 }
 
 private const val DATA_FILE_DIR = "/toto/titi"
\ No newline at end of file
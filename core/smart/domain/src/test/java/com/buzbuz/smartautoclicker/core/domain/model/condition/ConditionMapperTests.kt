@@ -46,6 +46,38 @@ class ConditionMapperTests {
         )
     }
 
+    @Test
+    fun anchoredImageCondition_toEntity() {
+        assertEquals(
+            ConditionTestsData.getNewImageConditionEntity(
+                anchorId = ConditionTestsData.CONDITION_ANCHOR_ID,
+                anchorArea = ConditionTestsData.CONDITION_ANCHOR_AREA,
+                eventId = ConditionTestsData.CONDITION_EVENT_ID,
+            ),
+            ConditionTestsData.getNewImageCondition(
+                anchorId = ConditionTestsData.CONDITION_ANCHOR_ID,
+                anchorArea = ConditionTestsData.CONDITION_ANCHOR_AREA,
+                eventId = ConditionTestsData.CONDITION_EVENT_ID,
+            ).toEntity()
+        )
+    }
+
+    @Test
+    fun anchoredImageCondition_toDomain() {
+        assertEquals(
+            ConditionTestsData.getNewImageCondition(
+                anchorId = ConditionTestsData.CONDITION_ANCHOR_ID,
+                anchorArea = ConditionTestsData.CONDITION_ANCHOR_AREA,
+                eventId = ConditionTestsData.CONDITION_EVENT_ID,
+            ),
+            ConditionTestsData.getNewImageConditionEntity(
+                anchorId = ConditionTestsData.CONDITION_ANCHOR_ID,
+                anchorArea = ConditionTestsData.CONDITION_ANCHOR_AREA,
+                eventId = ConditionTestsData.CONDITION_EVENT_ID,
+            ).toDomain()
+        )
+    }
+
     @Test
     fun triggerCondition_onBroadcastReceived_toEntity() {
         assertEquals(
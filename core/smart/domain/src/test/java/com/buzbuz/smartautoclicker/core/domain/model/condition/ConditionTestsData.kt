@@ -40,6 +40,8 @@ internal object ConditionTestsData {
     const val CONDITION_BOTTOM = 89
     const val CONDITION_THRESHOLD = 25
     const val CONDITION_DETECTION_TYPE = EXACT
+    const val CONDITION_ANCHOR_ID = 26L
+    val CONDITION_ANCHOR_AREA = Rect(-50, 10, 120, 60)
 
     const val CONDITION_BROADCAST_ACTION = "com.buzbuz.broadcast"
 
@@ -59,9 +61,14 @@ internal object ConditionTestsData {
         threshold: Int = CONDITION_THRESHOLD,
         detectionType: Int = CONDITION_DETECTION_TYPE,
         shouldBeDetected: Boolean = true,
+        anchorId: Long? = null,
+        anchorArea: Rect? = null,
         eventId: Long
     ) = ConditionEntity(id, eventId, name, ConditionType.ON_IMAGE_DETECTED, priority, path, area.left, area.top, area.right,
-        area.bottom, threshold, detectionType, shouldBeDetected, detectionArea?.left, detectionArea?.top, detectionArea?.right, detectionArea?.bottom)
+        area.bottom, threshold, detectionType, shouldBeDetected, detectionArea?.left, detectionArea?.top, detectionArea?.right, detectionArea?.bottom,
+        rotationCount = 1, matchingMetric = 0, isTextInArea = false, isFeatureMatching = false, anchorConditionId = anchorId,
+        anchorAreaLeft = anchorArea?.left, anchorAreaTop = anchorArea?.top, anchorAreaRight = anchorArea?.right,
+        anchorAreaBottom = anchorArea?.bottom)
 
     fun getNewImageCondition(
         id: Long = CONDITION_ID,
@@ -73,8 +80,11 @@ internal object ConditionTestsData {
         threshold: Int = CONDITION_THRESHOLD,
         detectionType: Int = CONDITION_DETECTION_TYPE,
         shouldBeDetected: Boolean = true,
+        anchorId: Long? = null,
+        anchorArea: Rect? = null,
         eventId: Long
-    ) = ImageCondition(id.asIdentifier(), eventId.asIdentifier(), name, priority, path, area, threshold, detectionType, shouldBeDetected, detectionArea)
+    ) = ImageCondition(id.asIdentifier(), eventId.asIdentifier(), name, priority, path, area, threshold, detectionType, shouldBeDetected, detectionArea,
+        anchorConditionId = anchorId?.asIdentifier(), anchorArea = anchorArea)
 
     fun getNewBroadcastReceivedConditionEntity(
         id: Long = CONDITION_ID,
@@ -42,7 +42,8 @@ internal object EventTestsData {
         enabledOnStart: Boolean = EVENT_ENABLED_ON_START,
         scenarioId: Long,
         priority: Int = 0,
-    ) = EventEntity(id, scenarioId, name, conditionOperator, priority, enabledOnStart, EventType.IMAGE_EVENT, keepDetecting = false)
+    ) = EventEntity(id, scenarioId, name, conditionOperator, priority, enabledOnStart, EventType.IMAGE_EVENT,
+        keepDetecting = false, detectionFrameInterval = 1, detectionMinIntervalMs = 0)
 
     fun getNewTriggerEventEntity(
         id: Long = EVENT_ID,
@@ -19,10 +19,16 @@ plugins {
     alias(libs.plugins.buzbuz.androidLibrary)
     alias(libs.plugins.buzbuz.androidUnitTest)
     alias(libs.plugins.buzbuz.hilt)
+    alias(libs.plugins.buzbuz.buildParameters)
 }
 
 android {
     namespace = "com.buzbuz.smartautoclicker.core.processing"
+
+    // The orchestration benchmark is skipped by the unit tests, unless requested with -PprocessingBenchmark=true
+    testOptions.unitTests.all { test ->
+        test.systemProperty("processingBenchmark", buildParameters["processingBenchmark"].asBoolean().toString())
+    }
 }
 
 dependencies {
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data
+
+import android.content.Context
+import android.content.Intent
+import android.content.IntentFilter
+import android.os.PowerManager
+
+import com.buzbuz.smartautoclicker.core.base.SafeBroadcastReceiver
+
+import kotlinx.coroutines.flow.MutableStateFlow
+import kotlinx.coroutines.flow.combine
+import kotlinx.coroutines.flow.first
+
+/**
+ * Tells if the detection is useful, according to the screen state and the app in the foreground.
+ *
+ * The detection is suspended while the screen is off, or while another app than [targetPackage] is in the foreground.
+ *
+ * @param targetPackage the package of the app the scenario is detected on, the one in the foreground when the
+ * detection was started. Null if it is unknown, only the screen state is then considered.
+ */
+internal class DetectionGate(private val targetPackage: String?) {
+
+    private val isScreenInteractive: MutableStateFlow<Boolean> = MutableStateFlow(true)
+    private val foregroundPackage: MutableStateFlow<String?> = MutableStateFlow(targetPackage)
+
+    private val screenStateReceiver = object : SafeBroadcastReceiver(
+        IntentFilter().apply {
+            addAction(Intent.ACTION_SCREEN_ON)
+            addAction(Intent.ACTION_SCREEN_OFF)
+        }
+    ) {
+        override fun onReceive(context: Context?, intent: Intent?) {
+            when (intent?.action) {
+                Intent.ACTION_SCREEN_ON -> isScreenInteractive.value = true
+                Intent.ACTION_SCREEN_OFF -> isScreenInteractive.value = false
+            }
+        }
+    }
+
+    /** Tells if the detection can run. */
+    val isOpen: Boolean
+        get() = isOpen(isScreenInteractive.value, foregroundPackage.value)
+
+    fun start(context: Context) {
+        isScreenInteractive.value = context.getSystemService(PowerManager::class.java)?.isInteractive ?: true
+        screenStateReceiver.register(context, exported = false)
+    }
+
+    fun stop() {
+        screenStateReceiver.unregister()
+    }
+
+    /** Notify of the app in the foreground. Can be called from any thread. */
+    fun onForegroundAppChanged(packageName: String) {
+        foregroundPackage.value = packageName
+    }
+
+    /** Suspend until the detection can run again. */
+    suspend fun awaitOpen() {
+        combine(isScreenInteractive, foregroundPackage) { isInteractive, foreground ->
+            isOpen(isInteractive, foreground)
+        }.first { isOpen -> isOpen }
+    }
+
+    private fun isOpen(isInteractive: Boolean, foreground: String?): Boolean =
+        isInteractive && (targetPackage == null || foreground == targetPackage)
+
+    override fun toString(): String =
+        "DetectionGate(target=$targetPackage, foreground=${foregroundPackage.value}, " +
+                "screenInteractive=${isScreenInteractive.value})"
+}
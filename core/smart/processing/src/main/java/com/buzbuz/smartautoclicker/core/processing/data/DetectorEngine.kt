@@ -16,25 +16,36 @@
  */
 package com.buzbuz.smartautoclicker.core.processing.data
 
+import android.app.ActivityManager
 import android.content.Context
 import android.content.Intent
 import android.graphics.Bitmap
+import android.graphics.Point
+import android.graphics.Rect
 import android.media.Image
 import android.media.projection.MediaProjectionManager
+import android.os.Process
 import android.util.Log
 
 import com.buzbuz.smartautoclicker.core.base.data.AppComponentsProvider
+import com.buzbuz.smartautoclicker.core.base.identifier.Identifier
 import com.buzbuz.smartautoclicker.core.base.di.Dispatcher
 import com.buzbuz.smartautoclicker.core.base.di.HiltCoroutineDispatchers.IO
 import com.buzbuz.smartautoclicker.core.display.recorder.DisplayRecorder
+import com.buzbuz.smartautoclicker.core.display.recorder.ScreenFrame
 import com.buzbuz.smartautoclicker.core.display.config.DisplayConfigManager
+import com.buzbuz.smartautoclicker.core.detection.DETECTION_QUALITY_MIN
 import com.buzbuz.smartautoclicker.core.detection.ImageDetector
+import com.buzbuz.smartautoclicker.core.detection.MULTI_SCALE_MATCHING_DEFAULT_SCALES
 import com.buzbuz.smartautoclicker.core.detection.NativeDetector
 import com.buzbuz.smartautoclicker.core.domain.model.SmartActionExecutor
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.domain.model.event.TriggerEvent
 import com.buzbuz.smartautoclicker.core.domain.model.scenario.Scenario
+import com.buzbuz.smartautoclicker.core.processing.domain.ConditionsPreparation
+import com.buzbuz.smartautoclicker.core.processing.domain.DetectionQualitySuggestion
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStatistics
 import com.buzbuz.smartautoclicker.core.processing.domain.ScenarioProcessingListener
 import com.buzbuz.smartautoclicker.core.processing.data.processor.ScenarioProcessor
 import com.buzbuz.smartautoclicker.core.settings.SettingsRepository
@@ -43,13 +54,21 @@ import kotlinx.coroutines.CoroutineDispatcher
 import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.CoroutineStart
 import kotlinx.coroutines.Job
+import kotlinx.coroutines.NonCancellable
 import kotlinx.coroutines.cancel
 import kotlinx.coroutines.cancelAndJoin
+import kotlinx.coroutines.coroutineScope
 import kotlinx.coroutines.delay
 import kotlinx.coroutines.launch
+import kotlinx.coroutines.withContext
 import kotlinx.coroutines.flow.MutableStateFlow
 import kotlinx.coroutines.flow.StateFlow
 
+import java.io.File
+
+import kotlin.math.ceil
+import kotlin.math.max
+
 import javax.inject.Inject
 import javax.inject.Singleton
 
@@ -76,9 +95,30 @@ class DetectorEngine @Inject constructor(
     /** Process the events conditions to detect them on the screen. */
     private var scenarioProcessor: ScenarioProcessor? = null
     /** Detect the condition images on the screen image. */
-    private var imageDetector: ImageDetector? = null
+    @Volatile private var imageDetector: ImageDetector? = null
+    /** The template pack of the scenario being detected, null if it can't have one. */
+    private var templatePackFile: File? = null
+    /** The file the detection capture is written to once the detection is stopped, null if it is disabled. */
+    private var detectionCaptureFile: File? = null
+    /** The scenario detected while the detection quality tuning is enabled, null if it is disabled. */
+    private var qualityTuningScenario: Scenario? = null
     /** The executor for the actions requiring an interaction with Android. */
     private var androidExecutor: SmartActionExecutor? = null
+    /** The package of the last app in the foreground, null if it is unknown. */
+    @Volatile private var foregroundPackage: String? = null
+    /** Suspends the detection while it is useless, null if it is disabled. */
+    @Volatile private var detectionGate: DetectionGate? = null
+    /** True to pause the screen record while only the trigger events are enabled. */
+    private var isTriggerOnlyCapturePauseEnabled: Boolean = false
+    /** True to receive the frames in the native screen reader of the detector, see [processScreenReaderFrames]. */
+    private var isNativeScreenReaderEnabled: Boolean = false
+
+    /** The detector kept between the tries of the elements of a scenario, with its prepared templates. */
+    private var tryDetector: ImageDetector? = null
+    /** The scenario tried with the [tryDetector]. */
+    private var tryScenarioId: Identifier? = null
+    /** The bitmap paths of the conditions prepared by the [tryDetector], mapped by condition id. */
+    private val tryConditionPaths: MutableMap<Long, String> = mutableMapOf()
 
     /** Coroutine scope for the image processing. */
     private var processingScope: CoroutineScope? = null
@@ -92,12 +132,35 @@ class DetectorEngine @Inject constructor(
     /** Current state of the detector. */
     internal val state: StateFlow<DetectorState> = _state
 
+    /** Backing property for [conditionsPreparation]. */
+    private val _conditionsPreparation = MutableStateFlow(ConditionsPreparation())
+    /** The progress of the processing of the image conditions of the running scenario, ready once detecting. */
+    internal val conditionsPreparation: StateFlow<ConditionsPreparation> = _conditionsPreparation
+
+    private val _detectionQualitySuggestion = MutableStateFlow<DetectionQualitySuggestion?>(null)
+    /** The detection quality suggested from the last detection with the tuning enabled, null if none. */
+    internal val detectionQualitySuggestion: StateFlow<DetectionQualitySuggestion?> = _detectionQualitySuggestion
+
     /**
      * Object to notify upon start/completion of detections steps.
      * Defined at detection start, reset to null at detection end.
      */
     private var detectionProgressListener: ScenarioProcessingListener? = null
 
+    /**
+     * The detection quality of the screen capture, when it is captured downscaled during the detection. Null when it
+     * is captured at full size.
+     */
+    private var captureDetectionQuality: Double? = null
+    /** The context of the downscaled capture, to restore the full size capture once the detection is stopped. */
+    private var captureContext: Context? = null
+    /** Reduces the detection quality level when the device is hot. Null if the thermal quality scaling is disabled. */
+    private var thermalQualityScaler: ThermalQualityScaler? = null
+    /** Forwards the memory pressure of the system to the detector while detecting. */
+    private var memoryPressureMonitor: MemoryPressureMonitor? = null
+    /** The number of screen images to detect per second at the full quality level, 0 for no frame pacing. */
+    private var targetDetectionRate: Double = 0.0
+
     /**
      * Start the screen detection.
      *
@@ -136,6 +199,12 @@ class DetectorEngine @Inject constructor(
         processingScope = CoroutineScope(ioDispatcher)
         displayConfigManager.addOrientationListener(orientationListener)
 
+        // Loaded while the user selects the projection, instead of on the first detection. The scenario image
+        // conditions have no texts, no recognition engines are needed.
+        processingScope?.launch {
+            if (!NativeDetector.prewarm()) Log.w(TAG, "startScreenRecord: native library not found.")
+        }
+
         processingScope?.launch {
             displayRecorder.apply {
                 startProjection(context, resultCode, data) {
@@ -143,7 +212,12 @@ class DetectorEngine @Inject constructor(
                     this@DetectorEngine.stopScreenRecord()
                     onRecordingStopped?.invoke()
                 }
-                startScreenRecord(context, displayConfigManager.displayConfig.sizePx)
+                startScreenRecord(
+                    context = context,
+                    displaySize = displayConfigManager.displayConfig.sizePx,
+                    gpuFrameGateEnabled = settingsRepository.isGpuFrameGateEnabled(),
+                    rotatedReaderEnabled = settingsRepository.isRotatedReaderEnabled(),
+                )
             }
 
             _state.emit(DetectorState.RECORDING)
@@ -159,7 +233,10 @@ class DetectorEngine @Inject constructor(
      * [state] should be RECORDING to capture. Detection can be stopped with [stopDetection] or [stopScreenRecord].
      *
      * @param bitmapSupplier provides the conditions bitmaps.
+     * @param bitmapFileSupplier provides the path of the conditions bitmaps files, read natively when possible.
      * @param progressListener object to notify upon start/completion of detections steps.
+     * @param isTry true when trying elements of the scenario. The detector and its prepared templates are then kept
+     * for the next tries of the same scenario, and the tries are detected at a lower rate.
      */
     internal fun startDetection(
         context: Context,
@@ -167,7 +244,9 @@ class DetectorEngine @Inject constructor(
         imageEvents: List<ImageEvent>,
         triggerEvents: List<TriggerEvent>,
         bitmapSupplier: suspend (ImageCondition) -> Bitmap?,
+        bitmapFileSupplier: ((ImageCondition) -> String?)? = null,
         progressListener: ScenarioProcessingListener? = null,
+        isTry: Boolean = false,
     ) {
         val executor = androidExecutor
         if (_state.value != DetectorState.RECORDING || executor == null) {
@@ -175,7 +254,10 @@ class DetectorEngine @Inject constructor(
             return
         }
 
-        val detector = NativeDetector.newInstance()
+        val reusedDetector = if (isTry) getTryDetector(scenario, imageEvents) else null
+        if (reusedDetector == null) releaseTryDetector()
+
+        val detector = reusedDetector ?: NativeDetector.newInstance()
         if (detector == null) {
             Log.e(TAG, "startDetection: native library not found.")
             _state.value = DetectorState.ERROR_NATIVE_DETECTOR_LIB_NOT_FOUND
@@ -188,7 +270,75 @@ class DetectorEngine @Inject constructor(
 
         processingScope?.launchProcessingJob {
             imageDetector = detector
-            detector.init()
+            if (reusedDetector == null) traceSection(TRACE_SECTION_DETECTOR_INIT, detector::init)
+            if (isTry) keepTryDetector(detector, scenario, imageEvents)
+            detector.setPyramidMatchingEnabled(settingsRepository.isPyramidMatchingEnabled())
+            detector.setSparseMatchingEnabled(settingsRepository.isSparseMatchingEnabled())
+            detector.setBinaryMatchingEnabled(settingsRepository.isBinaryMatchingEnabled())
+            detector.setChamferMatchingEnabled(settingsRepository.isChamferMatchingEnabled())
+            detector.setMotionCompensationEnabled(settingsRepository.isMotionCompensationEnabled())
+            detector.setAnimatedAreasExclusionEnabled(settingsRepository.isAnimatedAreasExclusionEnabled())
+            updateScreenInsets(detector)
+            detector.setFirstHitMatchingEnabled(settingsRepository.isFirstHitMatchingEnabled())
+            detector.setLearnedAreaMatchingEnabled(settingsRepository.isLearnedAreaMatchingEnabled())
+            detector.setIntegerScaleRatioEnabled(settingsRepository.isIntegerScaleRatioEnabled())
+            detector.setMultiScaleMatching(
+                if (settingsRepository.isMultiScaleMatchingEnabled()) MULTI_SCALE_MATCHING_DEFAULT_SCALES
+                else FloatArray(0)
+            )
+            detector.setHistogramColorVerificationEnabled(settingsRepository.isHistogramColorVerificationEnabled())
+            detector.setScaledColorVerificationEnabled(settingsRepository.isScaledColorVerificationEnabled())
+            detector.setFrameAllocatorEnabled(settingsRepository.isFrameAllocatorEnabled())
+            detector.setConditionPrefilterEnabled(settingsRepository.isConditionPrefilterEnabled())
+            detector.setIntegerMatchingEnabled(settingsRepository.isIntegerMatchingEnabled())
+            detector.setGpuMatchingEnabled(settingsRepository.isGpuMatchingEnabled())
+            detector.setNnapiMatchingEnabled(settingsRepository.isNnapiMatchingEnabled())
+            targetDetectionRate = when {
+                isTry -> TRY_TARGET_DETECTION_RATE
+                settingsRepository.isAdaptiveFramePacingEnabled() -> FRAME_PACING_TARGET_DETECTION_RATE
+                else -> 0.0
+            }
+            detector.setTargetDetectionRate(targetDetectionRate)
+            if (settingsRepository.isPerformanceThreadsEnabled()) {
+                detector.setThreadPolicy(preferBigCores = true, threadPriority = Process.THREAD_PRIORITY_DISPLAY)
+                detector.setPerformanceHintEnabled(true)
+            }
+            thermalQualityScaler =
+                if (settingsRepository.isThermalQualityScalingEnabled()) ThermalQualityScaler(context) else null
+            memoryPressureMonitor = MemoryPressureMonitor { pressure ->
+                Log.i(TAG, "Memory pressure $pressure")
+                detector.setMemoryPressure(pressure)
+            }.also { monitor -> monitor.start(context) }
+            // The scenario targets the app displayed when it is started
+            detectionGate =
+                if (!isTry && settingsRepository.isDetectionGateEnabled()) {
+                    DetectionGate(foregroundPackage).also { gate -> gate.start(context) }
+                } else null
+            isTriggerOnlyCapturePauseEnabled = settingsRepository.isTriggerOnlyCapturePauseEnabled()
+            isNativeScreenReaderEnabled = settingsRepository.isNativeScreenReaderEnabled()
+            if (settingsRepository.isDetectorMemoryBudgetEnabled() || context.isLowRamDevice()) {
+                detector.setMemoryBudget(DETECTOR_MEMORY_BUDGET_BYTES)
+            }
+            if (settingsRepository.isConditionTimeBudgetEnabled()) {
+                detector.setConditionTimeBudget(DETECTOR_CONDITION_TIME_BUDGET_NS)
+            }
+            // The tries only detect a few elements of the scenario, they are not captured nor packed
+            detectionCaptureFile =
+                if (!isTry && settingsRepository.isDetectionCaptureEnabled()) context.getDetectionCaptureFile()
+                else null
+            qualityTuningScenario =
+                if (!isTry && settingsRepository.isDetectionQualityTuningEnabled()) scenario else null
+            val captureFrameCount = max(
+                if (detectionCaptureFile != null) DETECTION_CAPTURE_FRAME_COUNT else 0,
+                if (qualityTuningScenario != null) DETECTION_QUALITY_TUNING_FRAME_COUNT else 0,
+            )
+            if (captureFrameCount > 0) detector.setCaptureFrameCount(captureFrameCount)
+            // The packed conditions are never provided with their bitmap, they can't be captured
+            templatePackFile = if (isTry || captureFrameCount > 0) null else {
+                context.getTemplatePackFile(scenario, imageEvents)?.also { packFile ->
+                    if (packFile.exists()) detector.openTemplatePack(packFile.absolutePath)
+                }
+            }
 
             detectionProgressListener = progressListener
             progressListener?.onSessionStarted(context, scenario, imageEvents, triggerEvents)
@@ -201,13 +351,30 @@ class DetectorEngine @Inject constructor(
                 imageEvents = imageEvents,
                 triggerEvents = triggerEvents,
                 bitmapSupplier = bitmapSupplier,
+                bitmapFileSupplier = bitmapFileSupplier,
                 androidExecutor = executor,
                 unblockWorkaroundEnabled = settingsRepository.isInputBlockWorkaroundEnabled(),
+                gestureBatchingEnabled = settingsRepository.isGestureBatchingEnabled(),
+                actionsOverlapEnabled = settingsRepository.isActionsOverlapEnabled(),
+                speculativeEventCount =
+                    if (settingsRepository.isSpeculativeEventsEnabled()) SPECULATIVE_EVENT_COUNT else 0,
+                maxFrameAgeMs = if (settingsRepository.isStaleFrameDroppingEnabled()) MAX_FRAME_AGE_MS else 0,
+                screenChangeWaitEnabled = settingsRepository.isScreenChangeWaitEnabled(),
+                idleConditionsCompactionEnabled = settingsRepository.isIdleConditionsCompactionEnabled(),
+                screenStatesGatingEnabled = settingsRepository.isScreenStatesGatingEnabled(),
                 onStopRequested = { stopDetection() },
+                onConditionsPrepared = { preparation -> _conditionsPreparation.value = preparation },
                 progressListener  = progressListener,
             )
             scenarioProcessor?.onScenarioStart(context)
 
+            // The compositor renders the screen near the detection size, the frames are smaller than the screen
+            if (settingsRepository.isDownscaledCaptureEnabled()) {
+                captureDetectionQuality = scenario.detectionQuality.toDouble()
+                captureContext = context.applicationContext
+                resizeScreenRecord(context)
+            }
+
             processScreenImages()
         }
     }
@@ -215,6 +382,8 @@ class DetectorEngine @Inject constructor(
     /**
      * Called when the orientation of the screen changes.
      * As we now have different screen metrics, we need to stop and start the virtual display with the correct one.
+     * When the rotated reader is enabled, the virtual display only swaps to the reader prepared for this orientation,
+     * and the detector keeps its buffers and the templates of the previous orientation.
      *
      * @param context the Android context.
      */
@@ -225,11 +394,12 @@ class DetectorEngine @Inject constructor(
 
         processingScope?.launch {
             if (_state.value == DetectorState.DETECTING) {
-                processingJob?.cancelAndJoin()
+                cancelProcessingJob()
             }
 
             detectionProgressListener?.onImageEventProcessingCancelled()
-            displayRecorder.resizeDisplay(context, displayConfigManager.displayConfig.sizePx)
+            resizeScreenRecord(context)
+            imageDetector?.let(::updateScreenInsets)
 
             if (_state.value == DetectorState.DETECTING) {
                 processingScope?.launchProcessingJob {
@@ -256,12 +426,38 @@ class DetectorEngine @Inject constructor(
         processingShutdownJob = processingScope?.launch {
             Log.i(TAG, "stopDetection")
 
-            processingJob?.cancelAndJoin()
+            cancelProcessingJob()
             processingJob = null
-            imageDetector?.close()
+            restoreFullSizeScreenRecord()
+            templatePackFile?.let { packFile -> imageDetector?.writeTemplatePack(packFile.absolutePath) }
+            templatePackFile = null
+            detectionCaptureFile?.let { captureFile ->
+                if (imageDetector?.writeCapture(captureFile.absolutePath) == true) {
+                    Log.i(TAG, "Detection capture written in ${captureFile.absolutePath}")
+                }
+            }
+            detectionCaptureFile = null
+            qualityTuningScenario?.let { scenario -> suggestDetectionQuality(scenario) }
+            qualityTuningScenario = null
+            imageDetector?.getConditionCounters()?.forEach { counters -> Log.d(TAG, "Detection counters: $counters") }
+            imageDetector?.getMemoryUsage()?.let { usage -> Log.d(TAG, "Detection memory: $usage") }
+            imageDetector?.getCacheStatistics()?.forEach { statistics -> Log.d(TAG, "Detection cache: $statistics") }
+            imageDetector?.getOcrEngineStatistics()?.let { statistics -> Log.d(TAG, "OCR engines: $statistics") }
+            Log.d(TAG, "Frame arrival: ${displayRecorder.getFrameArrivalStats()}")
+            scenarioProcessor?.getLatencyStatistics()?.let { statistics ->
+                Log.d(TAG, "Detection latencies: $statistics")
+                detectionProgressListener?.onLatencyStatisticsUpdated(statistics)
+            }
+            memoryPressureMonitor?.stop()
+            memoryPressureMonitor = null
+            if (imageDetector !== tryDetector) imageDetector?.close()
             imageDetector = null
             scenarioProcessor?.onScenarioEnd()
             scenarioProcessor = null
+            _conditionsPreparation.value = ConditionsPreparation()
+            thermalQualityScaler = null
+            detectionGate?.stop()
+            detectionGate = null
             detectionProgressListener?.onSessionEnded()
             detectionProgressListener = null
 
@@ -270,6 +466,68 @@ class DetectorEngine @Inject constructor(
         }
     }
 
+    /**
+     * Get the detector kept by the previous tries, if it can be used to try the provided events of the scenario.
+     * The bitmap of a condition can be edited, and the ids of the discarded conditions of an edited scenario can be
+     * reused by new ones: the conditions prepared with another bitmap are removed from the detector, to be prepared
+     * again, while all other prepared conditions are kept.
+     */
+    private fun getTryDetector(scenario: Scenario, imageEvents: List<ImageEvent>): ImageDetector? {
+        val detector = tryDetector ?: return null
+        if (scenario.id != tryScenarioId) return null
+
+        val editedConditionIds = imageEvents.flatMap { event ->
+            event.conditions.mapNotNull { condition ->
+                val conditionId = condition.getValidId()
+                val preparedPath = tryConditionPaths[conditionId]
+                conditionId.takeIf { preparedPath != null && preparedPath != condition.path }
+            }
+        }
+        if (editedConditionIds.isNotEmpty()) {
+            Log.d(TAG, "getTryDetector: ${editedConditionIds.size} edited conditions removed")
+            detector.removeConditions(editedConditionIds.toLongArray())
+            editedConditionIds.forEach(tryConditionPaths::remove)
+        }
+
+        return detector
+    }
+
+    /** Keep the detector of a try for the next tries of the same scenario. */
+    private fun keepTryDetector(detector: ImageDetector, scenario: Scenario, imageEvents: List<ImageEvent>) {
+        tryDetector = detector
+        tryScenarioId = scenario.id
+        imageEvents.forEach { event ->
+            event.conditions.forEach { condition -> tryConditionPaths[condition.getValidId()] = condition.path }
+        }
+    }
+
+    /** Release the detector kept by the tries, if any. It must not be detecting. */
+    private fun releaseTryDetector() {
+        tryDetector?.close()
+        tryDetector = null
+        tryScenarioId = null
+        tryConditionPaths.clear()
+    }
+
+    /** Replay the captured detections of the scenario at lower qualities, and publish the suggested quality. */
+    private fun suggestDetectionQuality(scenario: Scenario) {
+        val qualities = (DETECTION_QUALITY_MIN.toInt() until scenario.detectionQuality)
+            .step(DETECTION_QUALITY_TUNING_STEP)
+            .toList()
+            .toIntArray()
+
+        val suggestedQuality = imageDetector
+            ?.suggestDetectionQuality(qualities, DETECTION_QUALITY_TUNING_POSITION_TOLERANCE)
+            ?: return
+
+        Log.i(TAG, "Detection quality suggested: $suggestedQuality, detected at ${scenario.detectionQuality}")
+        _detectionQualitySuggestion.value = DetectionQualitySuggestion(
+            scenarioId = scenario.id.databaseId,
+            detectionQuality = scenario.detectionQuality,
+            suggestedQuality = suggestedQuality,
+        )
+    }
+
     /**
      * Stop the screen recording and the detection, if any.
      *
@@ -292,6 +550,7 @@ class DetectorEngine @Inject constructor(
         displayConfigManager.removeOrientationListener(orientationListener)
         processingScope?.launch {
             processingShutdownJob?.join()
+            releaseTryDetector()
 
             displayRecorder.stopProjection()
             androidExecutor = null
@@ -302,16 +561,229 @@ class DetectorEngine @Inject constructor(
         }
     }
 
+    /** Exclude the system bars of the current display from the whole screen detections, unless disabled. */
+    private fun updateScreenInsets(detector: ImageDetector) {
+        detector.setScreenInsets(
+            if (settingsRepository.isSystemBarsExclusionEnabled()) displayConfigManager.displayConfig.systemInsetsPx
+            else Rect()
+        )
+    }
+
+    /** Resize the screen record for the current display size, downscaled if [captureDetectionQuality] is set. */
+    private suspend fun resizeScreenRecord(context: Context) {
+        val displaySize = displayConfigManager.displayConfig.sizePx
+        displayRecorder.resizeDisplay(context, displaySize, getCaptureSize(displaySize))
+    }
+
+    /** @return the size of the captured frames for a display size, downscaled if [captureDetectionQuality] is set. */
+    private fun getCaptureSize(displaySize: Point): Point =
+        captureDetectionQuality?.let { quality -> displaySize.toCaptureSize(quality) } ?: displaySize
+
+    /** Capture the screen at full size again after a downscaled capture, for the screenshots of the conditions. */
+    private suspend fun restoreFullSizeScreenRecord() {
+        val context = captureContext ?: return
+
+        captureDetectionQuality = null
+        captureContext = null
+        resizeScreenRecord(context)
+    }
+
     /** Process the latest images provided by the [DisplayRecorder]. */
     private suspend fun processScreenImages() {
         _state.emit(DetectorState.DETECTING)
 
         scenarioProcessor?.invalidateScreenMetrics()
+
+        // The frames are received by the detector itself, the ones of the display recorder are not acquired
+        val detector = imageDetector
+        if (isNativeScreenReaderEnabled && detector != null) {
+            val displaySize = displayConfigManager.displayConfig.sizePx
+            val captureSize = getCaptureSize(displaySize)
+            val readerSurface = detector.openScreenReader(captureSize.x, captureSize.y)
+            if (readerSurface != null) {
+                try {
+                    displayRecorder.setFrameConsumerSurface(readerSurface)
+                    processScreenReaderFrames(detector, displaySize)
+                } finally {
+                    withContext(NonCancellable) { displayRecorder.setFrameConsumerSurface(null) }
+                    detector.closeScreenReader()
+                    readerSurface.release()
+                }
+                return
+            }
+            Log.w(TAG, "Native screen reader is not supported, using the display recorder frames")
+        }
+
+        // Acquired during the detection of the current frame, and already processed by the detector
+        var nextScreenFrame: ScreenFrame? = null
+        try {
+            // The actions overlapping the detection are cancelled with it
+            coroutineScope {
+                while (processingJob?.isActive == true) {
+                    updateDetectionQualityLevel()
+
+                    // Nothing useful to detect, the frame prepared during the detection would be outdated on resume
+                    detectionGate?.takeIf { gate -> !gate.isOpen }?.let { gate ->
+                        if (nextScreenFrame != null) scenarioProcessor?.cancelNextFramePreparation()
+                        nextScreenFrame = null
+                        awaitDetectionGateOpen(gate)
+                    }
+
+                    // Only the trigger events are enabled, the screen images would be acquired and set for nothing
+                    val processor = scenarioProcessor
+                    if (isTriggerOnlyCapturePauseEnabled && processor?.areAllImageEventsDisabled() == true) {
+                        if (nextScreenFrame != null) processor.cancelNextFramePreparation()
+                        nextScreenFrame = null
+                        processTriggerEventsWithoutCapture(processor)
+                        continue
+                    }
+
+                    // Nothing can be detected before the screen content changes, the frames are only compared
+                    val isScreenChangeAwaited = scenarioProcessor?.awaitScreenChange(nextScreenFrame) {
+                        displayRecorder.awaitNewScreenFrame(NEW_FRAME_TIMEOUT_MS)
+                        displayRecorder.acquireLatestScreenFrame()
+                    }
+                    if (isScreenChangeAwaited == true) nextScreenFrame = null
+
+                    // Without a new frame, the last one is detected again after the timeout, the events can depend on
+                    // more than the screen content
+                    val screenFrame = nextScreenFrame ?: run {
+                        displayRecorder.awaitNewScreenFrame(NEW_FRAME_TIMEOUT_MS)
+                        displayRecorder.acquireLatestScreenFrame()
+                    }
+                    nextScreenFrame = null
+
+                    if (screenFrame == null) continue
+
+                    scenarioProcessor?.process(screenFrame, actionsScope = this) {
+                        displayRecorder.acquireLatestScreenFrame()
+                            ?.takeIf { frame -> frame !== screenFrame }
+                            ?.also { frame -> nextScreenFrame = frame }
+                    }
+
+                    // Detecting faster than the target rate heats the device, the frames captured meanwhile are
+                    // skipped
+                    val frameDelayMs = imageDetector?.getFrameDelayMs() ?: 0L
+                    if (frameDelayMs > 0) {
+                        // The frame prepared during the detection would be outdated after the delay
+                        if (nextScreenFrame != null) scenarioProcessor?.cancelNextFramePreparation()
+                        nextScreenFrame = null
+                        delay(frameDelayMs)
+                    }
+                }
+            }
+        } finally {
+            // The frames can be released by the display recorder once the detection is stopped
+            scenarioProcessor?.cancelNextFramePreparation()
+        }
+    }
+
+    /**
+     * Process the frames received by the native screen reader of the [detector], see [ImageDetector.openScreenReader].
+     * The same as the display recorder frames, without their preparation during the detection of the previous one,
+     * nor the wait for the screen changes.
+     *
+     * @param detector the detector with the opened screen reader.
+     * @param screenSize the size of the screen in the frames, bigger than them when they are downscaled.
+     */
+    private suspend fun processScreenReaderFrames(detector: ImageDetector, screenSize: Point): Unit = coroutineScope {
         while (processingJob?.isActive == true) {
-            displayRecorder.acquireLatestBitmap()?.let { screenFrame ->
-                scenarioProcessor?.process(screenFrame)
-            } ?: delay(NO_IMAGE_DELAY_MS)
+            updateDetectionQualityLevel()
+            detectionGate?.takeIf { gate -> !gate.isOpen }?.let { gate -> awaitDetectionGateOpen(gate) }
+
+            // Only the trigger events are enabled, the screen images would be acquired and set for nothing
+            val processor = scenarioProcessor ?: return@coroutineScope
+            if (isTriggerOnlyCapturePauseEnabled && processor.areAllImageEventsDisabled()) {
+                processTriggerEventsWithoutCapture(processor)
+                continue
+            }
+
+            // Without a new frame, the last one is detected again after the timeout
+            detector.awaitScreenReaderFrame(NEW_FRAME_TIMEOUT_MS)
+            val timestampNs = detector.acquireScreenReaderFrame()
+            if (timestampNs == 0L) continue
+
+            processor.processScreenReaderFrame(timestampNs, screenSize.x, screenSize.y, actionsScope = this)
+
+            // Detecting faster than the target rate heats the device, the frames received meanwhile are skipped
+            val frameDelayMs = detector.getFrameDelayMs()
+            if (frameDelayMs > 0) delay(frameDelayMs)
+        }
+    }
+
+    /**
+     * Pause the screen record until the [gate] is open. The detector and its prepared conditions are kept as is, the
+     * detection resumes without preparing them again.
+     */
+    private suspend fun awaitDetectionGateOpen(gate: DetectionGate) {
+        Log.i(TAG, "Suspending detection, $gate")
+        displayRecorder.setScreenRecordPaused(true)
+        try {
+            gate.awaitOpen()
+        } finally {
+            withContext(NonCancellable) { displayRecorder.setScreenRecordPaused(false) }
+        }
+        Log.i(TAG, "Resuming detection")
+    }
+
+    /**
+     * Pause the screen record while all image events are disabled, and process the trigger events every
+     * [TRIGGER_EVENTS_PERIOD_MS] instead of every screen image. The detector and its prepared conditions are kept as
+     * is, the detection resumes without preparing them again once an action enables an image event.
+     */
+    private suspend fun processTriggerEventsWithoutCapture(processor: ScenarioProcessor) {
+        Log.i(TAG, "Suspending screen record, only trigger events are enabled")
+        displayRecorder.setScreenRecordPaused(true)
+        try {
+            while (processingJob?.isActive == true && processor.areAllImageEventsDisabled()) {
+                // The gate pauses the trigger events too, it is awaited by the detection loop
+                if (detectionGate?.isOpen == false) break
+
+                processor.processWithoutScreen()
+                delay(TRIGGER_EVENTS_PERIOD_MS)
+            }
+        } finally {
+            withContext(NonCancellable) { displayRecorder.setScreenRecordPaused(false) }
         }
+        Log.i(TAG, "Resuming screen record")
+    }
+
+    /**
+     * Notify of the app in the foreground, used as the target of the next detection. Can be called from any thread.
+     * @param packageName the package of the app.
+     */
+    internal fun onForegroundAppChanged(packageName: String) {
+        foregroundPackage = packageName
+        detectionGate?.onForegroundAppChanged(packageName)
+    }
+
+    /** @return the latencies of the detection in progress, or null if it is not started. */
+    internal fun getLatencyStatistics(): LatencyStatistics? =
+        scenarioProcessor?.getLatencyStatistics()
+
+    /**
+     * Get the telemetry of the last detected screen images, see [ImageDetector.getFrameTelemetry].
+     * Can be called from any thread, without blocking the detection.
+     */
+    internal fun getFrameTelemetry(): String? =
+        imageDetector?.getFrameTelemetry(FRAME_TELEMETRY_DUMP_COUNT)
+
+    /**
+     * Apply the quality level of the [thermalQualityScaler] if it has changed. The reduced levels lower the scenario
+     * detection quality, and the detection rate, even if the frame pacing is disabled.
+     */
+    private fun updateDetectionQualityLevel() {
+        val scaler = thermalQualityScaler ?: return
+        if (!scaler.update()) return
+
+        val level = scaler.qualityLevel
+        Log.i(TAG, "Detection quality level changed to $level")
+
+        scenarioProcessor?.setDetectionQualityFactor(level.qualityFactor)
+        imageDetector?.setTargetDetectionRate(
+            if (level == DetectionQualityLevel.FULL) targetDetectionRate
+            else (targetDetectionRate.takeIf { it > 0 } ?: FRAME_PACING_TARGET_DETECTION_RATE) * level.rateFactor
+        )
     }
 
     /** Clear this engine. It can't be used after this call. */
@@ -327,6 +799,16 @@ class DetectorEngine @Inject constructor(
         _state.value != DetectorState.DESTROYED
     }
 
+    /**
+     * Cancel the [processingJob] and wait for its completion. The native detection in progress is cancelled too, it
+     * would otherwise complete its frame before the job could end.
+     */
+    private suspend fun cancelProcessingJob() {
+        imageDetector?.setCancelled(true)
+        processingJob?.cancelAndJoin()
+        imageDetector?.setCancelled(false)
+    }
+
     /**
      * Creates a new job executing the provided job automatically once the job is effectively created.
      * This allows to check the job state correctly within the [block], even quickly after its start, as the [launch]
@@ -345,6 +827,18 @@ class DetectorEngine @Inject constructor(
     }
 }
 
+/**
+ * Get the size of the screen capture for a detection quality, with the same aspect ratio as the display.
+ * It is rounded up, the captured frames are never smaller than the screen image used by the detection.
+ */
+private fun Point.toCaptureSize(detectionQuality: Double): Point {
+    val maxDimension = max(x, y)
+    if (maxDimension <= detectionQuality) return Point(this)
+
+    val ratio = detectionQuality / maxDimension
+    return Point(ceil(x * ratio).toInt(), ceil(y * ratio).toInt())
+}
+
 /** The different states of the [DetectorEngine]. */
 internal enum class DetectorState {
     /** The engine is created and ready to be used. */
@@ -365,10 +859,87 @@ internal enum class DetectorState {
 }
 
 /**
- * Waiting delay after getting a null image.
- * This is to avoid spamming when there is no image.
+ * Maximum waiting delay for a new frame of the screen before detecting the last one again.
+ * The screen record only renders a frame when the screen content changes.
+ */
+private const val NEW_FRAME_TIMEOUT_MS = 20L
+
+/**
+ * Period of the processing of the trigger events while the screen record is paused because all image events are
+ * disabled. The same as the detection of an unchanged screen, the timers of the triggers keep their precision.
+ */
+private const val TRIGGER_EVENTS_PERIOD_MS = 20L
+
+/**
+ * Number of screen images detected per second when the adaptive frame pacing is enabled.
+ * Lower while the screen is unchanged, see [ImageDetector.getFrameDelayMs].
+ */
+private const val FRAME_PACING_TARGET_DETECTION_RATE = 15.0
+
+/**
+ * Number of screen images detected per second when trying elements of a scenario, whatever the frame pacing setting.
+ * Enough for the results to follow the screen, and lower while the screen is unchanged.
+ */
+private const val TRY_TARGET_DETECTION_RATE = 10.0
+
+/**
+ * Memory budget of the detector when it is limited, in bytes.
+ * Enough for the screen images of a high resolution screen and a few dozens of processed conditions.
+ */
+private const val DETECTOR_MEMORY_BUDGET_BYTES = 96L * 1024 * 1024
+
+/**
+ * Time budget of each condition detection when it is limited, in nanoseconds.
+ * A few times the common matching durations, only the pathological conditions are degraded.
+ */
+private const val DETECTOR_CONDITION_TIME_BUDGET_NS = 20_000_000L
+
+/**
+ * Number of the last screen images kept by the detection capture.
+ * Each one is a full screen RGBA image, around 16MB on a high resolution screen.
  */
-private const val NO_IMAGE_DELAY_MS = 20L
+private const val DETECTION_CAPTURE_FRAME_COUNT = 5
+
+/**
+ * Number of the last screen images replayed by the detection quality tuning.
+ * Enough to cover a few screen changes, but each one is replayed once per tried quality.
+ */
+private const val DETECTION_QUALITY_TUNING_FRAME_COUNT = 10
+
+/** Difference between the detection qualities tried by the tuning, from [DETECTION_QUALITY_MIN]. */
+private const val DETECTION_QUALITY_TUNING_STEP = 100
+
+/** Maximum distance of a detection at a tuned quality with the one at the scenario quality, in screen pixels. */
+private const val DETECTION_QUALITY_TUNING_POSITION_TOLERANCE = 8
+
+/** Number of the last detected screen images in the dumps of the detection. */
+private const val FRAME_TELEMETRY_DUMP_COUNT = 300
+
+/**
+ * The file of the detection capture, replaced by each detection. In the application external files when available, it
+ * can be pulled with adb to be replayed by the native benchmark.
+ */
+private fun Context.getDetectionCaptureFile(): File =
+    File(getExternalFilesDir(null) ?: filesDir, DETECTION_CAPTURE_FILE_NAME)
+
+/** Name of the detection capture file. */
+private const val DETECTION_CAPTURE_FILE_NAME = "detection_capture.kdrc"
+
+/**
+ * Number of first image events detected speculatively when enabled.
+ * Enough to keep all detector threads busy with the conditions of a few events.
+ */
+private const val SPECULATIVE_EVENT_COUNT = 4
+
+/**
+ * Time after which a screen frame is dropped while its detection is not complete, when the stale frame dropping is
+ * enabled. A few frame intervals: the screen has likely changed since.
+ */
+private const val MAX_FRAME_AGE_MS = 100L
+
+/** @return true if the device is considered as a low memory one by the system. */
+private fun Context.isLowRamDevice(): Boolean =
+    getSystemService(ActivityManager::class.java)?.isLowRamDevice ?: false
 
 /** Tag for logs. */
 private const val TAG = "DetectorEngine"
\ No newline at end of file
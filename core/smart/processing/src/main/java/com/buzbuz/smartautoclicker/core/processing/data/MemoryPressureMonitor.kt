@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data
+
+import android.content.ComponentCallbacks2
+import android.content.Context
+import android.content.res.Configuration
+
+import com.buzbuz.smartautoclicker.core.detection.DetectorMemoryPressure
+
+/**
+ * Forward the memory pressure of the system to the detector, for it to shed its caches before the process is killed.
+ *
+ * The trim levels of the [ComponentCallbacks2] are mapped to a [DetectorMemoryPressure]. The levels notified while
+ * the process is running shed the caches progressively, up to all of them once the system is about to kill
+ * background processes. The detector regrows its caches by itself once the pressure is no longer notified.
+ *
+ * @param onMemoryPressure called with the pressure of each trim notification, on the main thread.
+ */
+internal class MemoryPressureMonitor(private val onMemoryPressure: (DetectorMemoryPressure) -> Unit) {
+
+    /** The context the callbacks are registered in, null while not monitoring. */
+    private var context: Context? = null
+
+    private val callbacks = object : ComponentCallbacks2 {
+        override fun onTrimMemory(level: Int) {
+            level.toDetectorMemoryPressure()?.let(onMemoryPressure)
+        }
+
+        @Deprecated("Deprecated in Java")
+        override fun onLowMemory() {
+            onMemoryPressure(DetectorMemoryPressure.FRAMES)
+        }
+
+        override fun onConfigurationChanged(newConfig: Configuration) = Unit
+    }
+
+    fun start(context: Context) {
+        val appContext = context.applicationContext
+        appContext.registerComponentCallbacks(callbacks)
+        this.context = appContext
+    }
+
+    fun stop() {
+        context?.unregisterComponentCallbacks(callbacks)
+        context = null
+    }
+}
+
+/** @return the pressure for a [ComponentCallbacks2] trim level, null if it isn't a memory pressure. */
+@Suppress("DEPRECATION")
+private fun Int.toDetectorMemoryPressure(): DetectorMemoryPressure? = when {
+    this >= ComponentCallbacks2.TRIM_MEMORY_COMPLETE -> DetectorMemoryPressure.FRAMES
+    this >= ComponentCallbacks2.TRIM_MEMORY_MODERATE -> DetectorMemoryPressure.TEMPLATES
+    this >= ComponentCallbacks2.TRIM_MEMORY_BACKGROUND -> DetectorMemoryPressure.PYRAMID
+    // Only the UI of the process is hidden: the overlay menu, while the detection continues
+    this >= ComponentCallbacks2.TRIM_MEMORY_UI_HIDDEN -> null
+    this >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_CRITICAL -> DetectorMemoryPressure.FRAMES
+    this >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_LOW -> DetectorMemoryPressure.TEMPLATES
+    this >= ComponentCallbacks2.TRIM_MEMORY_RUNNING_MODERATE -> DetectorMemoryPressure.OCR_TEXTS
+    else -> null
+}
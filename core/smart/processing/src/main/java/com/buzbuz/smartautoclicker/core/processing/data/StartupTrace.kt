@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data
+
+import android.os.Build
+import android.os.Trace
+
+/**
+ * Trace sections of the cold start of a scenario detection, from the detector creation to the end of the first
+ * processed screen image. Their names are stable, for the Macrobenchmark TraceSectionMetric and the Perfetto queries.
+ */
+internal const val TRACE_SECTION_DETECTOR_INIT = "SmartDetection:detectorInit"
+internal const val TRACE_SECTION_SCREEN_METRICS = "SmartDetection:setScreenMetrics"
+internal const val TRACE_SECTION_PREPARE_CONDITIONS = "SmartDetection:prepareConditions"
+internal const val TRACE_SECTION_LOAD_BITMAPS = "SmartDetection:loadConditionBitmaps"
+internal const val TRACE_SECTION_FIRST_FRAME = "SmartDetection:firstFrame"
+
+/** Trace [block] in a section named [name]. [block] must not suspend, the section is ended on the same thread. */
+internal inline fun <T> traceSection(name: String, block: () -> T): T {
+    Trace.beginSection(name)
+    try {
+        return block()
+    } finally {
+        Trace.endSection()
+    }
+}
+
+/**
+ * Trace [block] in an asynchronous section named [name], that can be resumed on another thread after a suspension.
+ * Not traced before Android Q, where asynchronous sections are not available.
+ */
+internal inline fun <T> traceAsyncSection(name: String, block: () -> T): T {
+    if (Build.VERSION.SDK_INT < Build.VERSION_CODES.Q) return block()
+
+    Trace.beginAsyncSection(name, 0)
+    try {
+        return block()
+    } finally {
+        Trace.endAsyncSection(name, 0)
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data
+
+import android.content.Context
+import android.util.Log
+
+import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
+import com.buzbuz.smartautoclicker.core.domain.model.scenario.Scenario
+
+import java.io.File
+
+/**
+ * Get the template pack file of a scenario, and delete its outdated ones.
+ *
+ * The packs are in the cache directory, as they can always be rebuilt from the conditions bitmaps. As the detector
+ * identifies the packed conditions by their ids only, the file name contains a hash of the ids and bitmaps paths of
+ * all image conditions: a condition with a new bitmap gives a new pack.
+ *
+ * @return the pack file, or null if the scenario is not in the database.
+ */
+internal fun Context.getTemplatePackFile(scenario: Scenario, imageEvents: List<ImageEvent>): File? {
+    if (!scenario.id.isInDatabase()) return null
+
+    val conditionsHash = imageEvents
+        .flatMap { event -> event.conditions }
+        .map { condition -> "${condition.getValidId()}:${condition.path}" }
+        .sorted()
+        .hashCode()
+
+    val packsDirectory = File(cacheDir, TEMPLATE_PACKS_DIRECTORY)
+    if (!packsDirectory.exists() && !packsDirectory.mkdirs()) {
+        Log.w(TAG, "Can't create the template packs directory")
+        return null
+    }
+
+    val scenarioPrefix = "${scenario.id.databaseId}_"
+    val packFile = File(packsDirectory, "$scenarioPrefix${Integer.toHexString(conditionsHash)}$TEMPLATE_PACK_EXTENSION")
+    packsDirectory.listFiles { file -> file.name.startsWith(scenarioPrefix) && file != packFile }
+        ?.forEach { outdatedPack -> outdatedPack.delete() }
+
+    return packFile
+}
+
+/** The directory of the template packs, in the cache directory. */
+private const val TEMPLATE_PACKS_DIRECTORY = "template_packs"
+/** The extension of the template pack files. */
+private const val TEMPLATE_PACK_EXTENSION = ".pack"
+/** Tag for logs. */
+private const val TAG = "TemplatePackFiles"
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data
+
+import android.content.Context
+import android.os.Build
+import android.os.PowerManager
+import android.os.SystemClock
+
+/**
+ * Reduce the detection workload when the device is heating or saving its battery.
+ *
+ * The thermal status and headroom, and the battery saver state, are read at most once every
+ * [THERMAL_CHECK_INTERVAL_MS]. The [DetectionQualityLevel] is stepped a single level at a time towards the one of the
+ * current state, keeping the detection latency steady instead of collapsing once the device is throttled.
+ *
+ * @param context the Android context.
+ */
+internal class ThermalQualityScaler(context: Context) {
+
+    private val powerManager: PowerManager? = context.getSystemService(PowerManager::class.java)
+
+    /** The time of the last state check, in the [SystemClock.elapsedRealtime] base. */
+    private var lastCheckMs: Long = -THERMAL_CHECK_INTERVAL_MS
+
+    /** The current quality level of the detection. */
+    var qualityLevel: DetectionQualityLevel = DetectionQualityLevel.FULL
+        private set
+
+    /**
+     * Check the device state if the last check is old enough, and update the [qualityLevel].
+     *
+     * @return true if the [qualityLevel] has changed.
+     */
+    fun update(): Boolean {
+        val nowMs = SystemClock.elapsedRealtime()
+        if (nowMs - lastCheckMs < THERMAL_CHECK_INTERVAL_MS) return false
+        lastCheckMs = nowMs
+
+        val targetLevel = getTargetLevel()
+        val levels = DetectionQualityLevel.entries
+        val newLevel = when {
+            targetLevel > qualityLevel -> levels[qualityLevel.ordinal + 1]
+            targetLevel < qualityLevel -> levels[qualityLevel.ordinal - 1]
+            else -> return false
+        }
+
+        qualityLevel = newLevel
+        return true
+    }
+
+    private fun getTargetLevel(): DetectionQualityLevel {
+        val manager = powerManager ?: return DetectionQualityLevel.FULL
+
+        val thermalStatus =
+            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.Q) manager.currentThermalStatus
+            else PowerManager.THERMAL_STATUS_NONE
+        // The forecast headroom reaches 1 when the device is expected to be throttled
+        val headroom =
+            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.R) manager.getThermalHeadroom(THERMAL_HEADROOM_FORECAST_S)
+            else Float.NaN
+
+        return when {
+            thermalStatus >= PowerManager.THERMAL_STATUS_SEVERE || headroom >= 1f -> DetectionQualityLevel.LOW
+            thermalStatus >= PowerManager.THERMAL_STATUS_MODERATE || headroom >= THERMAL_HEADROOM_REDUCED
+                    || manager.isPowerSaveMode -> DetectionQualityLevel.REDUCED
+            else -> DetectionQualityLevel.FULL
+        }
+    }
+}
+
+/**
+ * The quality levels of the detection, from the best to the cheapest one.
+ *
+ * @param qualityFactor the factor applied to the scenario detection quality.
+ * @param rateFactor the factor applied to the target detection rate.
+ */
+internal enum class DetectionQualityLevel(val qualityFactor: Double, val rateFactor: Double) {
+    FULL(1.0, 1.0),
+    REDUCED(0.75, 0.66),
+    LOW(0.5, 0.33),
+}
+
+/** The minimum delay between two checks of the device thermal and battery state. */
+private const val THERMAL_CHECK_INTERVAL_MS = 5_000L
+/** The delay in the future of the forecast thermal headroom, in seconds. */
+private const val THERMAL_HEADROOM_FORECAST_S = 10
+/** The forecast thermal headroom above which the detection quality is reduced. */
+private const val THERMAL_HEADROOM_REDUCED = 0.85f
@@ -22,6 +22,9 @@ import android.graphics.Path
 import android.graphics.Point
 import android.util.Log
 
+import java.util.IdentityHashMap
+
+import com.buzbuz.smartautoclicker.core.base.extensions.GestureSequenceBuilder
 import com.buzbuz.smartautoclicker.core.base.extensions.buildSingleStroke
 import com.buzbuz.smartautoclicker.core.base.extensions.nextIntInOffset
 import com.buzbuz.smartautoclicker.core.base.extensions.nextLongInOffset
@@ -32,6 +35,7 @@ import com.buzbuz.smartautoclicker.core.base.workarounds.buildUnblockGesture
 import com.buzbuz.smartautoclicker.core.domain.model.CounterOperationValue
 import com.buzbuz.smartautoclicker.core.domain.model.OR
 import com.buzbuz.smartautoclicker.core.domain.model.SmartActionExecutor
+import com.buzbuz.smartautoclicker.core.domain.model.action.Action
 import com.buzbuz.smartautoclicker.core.domain.model.action.Intent
 import com.buzbuz.smartautoclicker.core.domain.model.action.Click
 import com.buzbuz.smartautoclicker.core.domain.model.action.Pause
@@ -45,8 +49,11 @@ import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.processing.data.processor.state.ProcessingState
 import com.buzbuz.smartautoclicker.core.domain.model.NotificationRequest
 
+import kotlinx.coroutines.CoroutineScope
 import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.Job
 import kotlinx.coroutines.delay
+import kotlinx.coroutines.launch
 import kotlinx.coroutines.withContext
 import kotlin.random.Random
 
@@ -56,12 +63,17 @@ import kotlin.random.Random
  * @param androidExecutor the executor for the actions requiring an interaction with Android.
  * @param processingState the state of the current processing (counters, enabled events...).
  * @param randomize true to randomize the actions values a bit (positions, timers...), false to be precise.
+ * @param latencyTracker notified when the gestures are dispatched, null if the latencies are not measured.
+ * @param gestureBatchingEnabled true to dispatch the consecutive clicks and swipes of an event, and the pauses between
+ * them, as a single multi-stroke gesture.
  */
 internal class ActionExecutor(
     private val androidExecutor: SmartActionExecutor,
     private val processingState: ProcessingState,
     randomize: Boolean,
     unblockWorkaroundEnabled: Boolean = false,
+    private val latencyTracker: LatencyTracker? = null,
+    gestureBatchingEnabled: Boolean = false,
 ) {
 
     init { androidExecutor.clearState() }
@@ -73,9 +85,53 @@ internal class ActionExecutor(
         if (unblockWorkaroundEnabled) UnblockGestureScheduler()
         else null
 
+    /** Coalesces the consecutive gestures of an event into a single dispatch, null if batching is disabled. */
+    private val gestureSequenceBuilder: GestureSequenceBuilder? =
+        if (gestureBatchingEnabled) GestureSequenceBuilder(MAX_BATCHED_GESTURE_DURATION_MS)
+        else null
+    /** The duration of the pauses following the last stroke of [gestureSequenceBuilder]. */
+    private var pendingBatchDelayMs: Long = 0L
+    /** The execution of the actions overlapping the detection, see [executeActionsOverlapped]. */
+    private var overlappingActionsJob: Job? = null
+    /**
+     * The strokes of the clicks at a fixed position and of the swipes, built once by [prepareGestures] and dispatched
+     * again with each execution. Keyed by action instance, never filled when the actions are randomized.
+     */
+    private val fixedStrokes: MutableMap<Action, FixedStroke> = IdentityHashMap()
+    /** The path of the clicks on a detected condition, set again for each click. Each stroke copies its path. */
+    private val conditionClickPath: Path = Path()
+
+    /**
+     * Build the gestures of the actions that are the same for each execution: the clicks at a fixed position and the
+     * swipes, when the actions are not randomized. The clicks on a detected condition are built with each execution.
+     *
+     * @param events all events of the scenario.
+     */
+    fun prepareGestures(events: Collection<Event>) {
+        if (random != null) return
+
+        events.forEach { event ->
+            event.actions.forEach { action ->
+                val (path, durationMs) = when (action) {
+                    is Click ->
+                        if (action.positionType != Click.PositionType.USER_SELECTED) return@forEach
+                        else (getClickPath(event, action, null) ?: return@forEach) to action.getPressDurationMs()
+                    is Swipe -> (getSwipePath(action) ?: return@forEach) to action.getSwipeDurationMs()
+                    else -> return@forEach
+                }
+
+                // An invalid gesture is built again with each execution, reporting its error then
+                val gesture = runCatching { GestureDescription.Builder().buildSingleStroke(path, durationMs) }
+                    .getOrNull() ?: return@forEach
+                fixedStrokes[action] = FixedStroke(path, gesture)
+            }
+        }
+    }
+
 
     suspend fun onScenarioLoopFinished() {
         if (unblockGestureScheduler?.shouldTrigger() == true) {
+            awaitOverlappingActions()
             withContext(Dispatchers.Main) {
                 Log.i(TAG, "Injecting unblock gesture")
                 androidExecutor.executeGesture(
@@ -85,8 +141,44 @@ internal class ActionExecutor(
         }
     }
 
+    /** Execute the actions of the event, once the overlapping actions of the previous one are completed. */
     suspend fun executeActions(event: Event, results: ConditionsResult? = null) {
+        awaitOverlappingActions()
+        executeEventActions(event, results)
+    }
+
+    /**
+     * Execute the actions of the event in the background, letting the caller detect the next screen images meanwhile.
+     *
+     * Only the events with actions that can't change the processing state are executed this way, the other ones are
+     * executed before returning. The following actions, and the gestures of this executor, always wait for the
+     * completion of the overlapping ones.
+     *
+     * @param scope the scope the actions are executed in, cancelling them with the detection.
+     * @param event the event to execute the actions of.
+     * @param results the results of the event conditions, copied as they are only valid during the call.
+     */
+    suspend fun executeActionsOverlapped(scope: CoroutineScope, event: Event, results: ConditionsResult) {
+        if (!event.canOverlapDetection()) return executeActions(event, results)
+
+        awaitOverlappingActions()
+        val resultsCopy = results.copy()
+        overlappingActionsJob = scope.launch { executeEventActions(event, resultsCopy) }
+    }
+
+    /** Wait for the completion of the actions started by [executeActionsOverlapped], if any. */
+    suspend fun awaitOverlappingActions() {
+        overlappingActionsJob?.join()
+        overlappingActionsJob = null
+    }
+
+    private suspend fun executeEventActions(event: Event, results: ConditionsResult?) {
         event.actions.forEach { action ->
+            if (gestureSequenceBuilder != null && batchAction(gestureSequenceBuilder, event, action, results)) {
+                return@forEach
+            }
+            flushGestureSequence()
+
             when (action) {
                 is Click -> executeClick(event, action, results)
                 is Swipe -> executeSwipe(action)
@@ -97,10 +189,72 @@ internal class ActionExecutor(
                 is Notification -> executeNotification(event, action)
             }
         }
+
+        flushGestureSequence()
+    }
+
+    /**
+     * Add the provided action to the current gesture sequence, if possible.
+     *
+     * Clicks and swipes are added as strokes, and pauses are added as the delay before the next stroke as long as the
+     * sequence is not empty. A full sequence is dispatched before adding the new stroke.
+     *
+     * @return true if the action have been handled, false if it must be executed normally.
+     */
+    private suspend fun batchAction(
+        builder: GestureSequenceBuilder,
+        event: Event,
+        action: Action,
+        results: ConditionsResult?,
+    ): Boolean {
+        val (path, durationMs) = when (action) {
+            is Click -> (fixedStrokes[action]?.path ?: getClickPath(event, action, results) ?: return true) to
+                    action.getPressDurationMs()
+            is Swipe -> (fixedStrokes[action]?.path ?: getSwipePath(action) ?: return true) to
+                    action.getSwipeDurationMs()
+            is Pause -> {
+                if (builder.strokeCount == 0) return false
+                pendingBatchDelayMs += action.getPauseDurationMs()
+                return true
+            }
+            else -> return false
+        }
+
+        if (builder.strokeCount > 0 && !builder.canAdd(durationMs, pendingBatchDelayMs)) flushGestureSequence()
+        builder.add(path, durationMs, pendingBatchDelayMs)
+        pendingBatchDelayMs = 0L
+
+        return true
+    }
+
+    /** Dispatch the current gesture sequence, if any, and wait for the pauses following it. */
+    private suspend fun flushGestureSequence() {
+        val builder = gestureSequenceBuilder ?: return
+        if (builder.strokeCount > 0) dispatchGesture(builder.build())
+
+        if (pendingBatchDelayMs > 0) {
+            delay(pendingBatchDelayMs)
+            pendingBatchDelayMs = 0L
+        }
     }
 
     private suspend fun executeClick(event: Event, click: Click, results: ConditionsResult?) {
-        val clickPath = when (click.positionType) {
+        fixedStrokes[click]?.let { stroke -> return dispatchGesture(stroke.gesture) }
+        val clickPath = getClickPath(event, click, results) ?: return
+
+        dispatchGesture(GestureDescription.Builder().buildSingleStroke(clickPath, click.getPressDurationMs()))
+    }
+
+    private suspend fun dispatchGesture(gesture: GestureDescription) {
+        withContext(Dispatchers.Main) {
+            // Before the call, it only returns once the gesture is completed
+            latencyTracker?.onGestureDispatched()
+            androidExecutor.executeGesture(gesture)
+        }
+    }
+
+    private fun getClickPath(event: Event, click: Click, results: ConditionsResult?): Path? =
+        when (click.positionType) {
             Click.PositionType.USER_SELECTED -> {
                 click.position?.let { position ->
                     Path().apply { moveTo(position) }
@@ -109,16 +263,7 @@ internal class ActionExecutor(
 
             Click.PositionType.ON_DETECTED_CONDITION ->
                 getOnConditionClickPath(event, click, results)
-        } ?: return
-
-        val clickGesture = GestureDescription.Builder().buildSingleStroke(
-            clickPath, random.nextLongInOffsetIfNeeded(click.pressDuration!!, RANDOMIZATION_DURATION_MAX_OFFSET_MS)
-        )
-
-        withContext(Dispatchers.Main) {
-            androidExecutor.executeGesture(clickGesture)
         }
-    }
 
     private fun getOnConditionClickPath(event: Event, click: Click, results: ConditionsResult?): Path? {
         if (event !is ImageEvent) return null
@@ -134,7 +279,8 @@ internal class ActionExecutor(
             return null
         }
 
-        return Path().apply {
+        return conditionClickPath.apply {
+            reset()
             moveTo(
                 Point(
                     result.position.x + (click.clickOffset?.x ?: 0),
@@ -149,24 +295,22 @@ internal class ActionExecutor(
      * @param swipe the swipe to be executed.
      */
     private suspend fun executeSwipe(swipe: Swipe) {
-        val swipeGesture = GestureDescription.Builder().buildSingleStroke(
-            path =
-                if (swipe.from == null || swipe.to == null) return
-                else Path().apply { line(swipe.from, swipe.to) },
-            durationMs = random.nextLongInOffsetIfNeeded(swipe.swipeDuration!!, RANDOMIZATION_DURATION_MAX_OFFSET_MS),
-        )
+        fixedStrokes[swipe]?.let { stroke -> return dispatchGesture(stroke.gesture) }
+        val swipePath = getSwipePath(swipe) ?: return
 
-        withContext(Dispatchers.Main) {
-            androidExecutor.executeGesture(swipeGesture)
-        }
+        dispatchGesture(GestureDescription.Builder().buildSingleStroke(swipePath, swipe.getSwipeDurationMs()))
     }
 
+    private fun getSwipePath(swipe: Swipe): Path? =
+        if (swipe.from == null || swipe.to == null) null
+        else Path().apply { line(swipe.from, swipe.to) }
+
     /**
      * Execute the provided pause.
      * @param pause the pause to be executed.
      */
     private suspend fun executePause(pause: Pause) {
-        delay(random.nextLongInOffsetIfNeeded(pause.pauseDuration!!, RANDOMIZATION_DURATION_MAX_OFFSET_MS))
+        delay(pause.getPauseDurationMs())
     }
 
     /**
@@ -290,8 +434,24 @@ internal class ActionExecutor(
         )
     }
 
+    /** @return true if the actions of this event can't change the events or the counters of the processing state. */
+    private fun Event.canOverlapDetection(): Boolean =
+        actions.none { action -> action is ToggleEvent || action is ChangeCounter }
+
+    private fun Click.getPressDurationMs(): Long =
+        random.nextLongInOffsetIfNeeded(pressDuration!!, RANDOMIZATION_DURATION_MAX_OFFSET_MS)
+
+    private fun Swipe.getSwipeDurationMs(): Long =
+        random.nextLongInOffsetIfNeeded(swipeDuration!!, RANDOMIZATION_DURATION_MAX_OFFSET_MS)
+
+    private fun Pause.getPauseDurationMs(): Long =
+        random.nextLongInOffsetIfNeeded(pauseDuration!!, RANDOMIZATION_DURATION_MAX_OFFSET_MS)
+
     private fun Random?.nextLongInOffsetIfNeeded(value: Long, offset: Long): Long =
         this?.nextLongInOffset(value, offset) ?: value
+
+    /** The path of a fixed action, for the batched gestures, and its gesture when dispatched alone. */
+    private class FixedStroke(val path: Path, val gesture: GestureDescription)
 }
 
 /** Tag for logs. */
@@ -300,6 +460,8 @@ private const val TAG = "ActionExecutor"
 private const val INTENT_START_ACTIVITY_DELAY = 1000L
 /** Waiting delay after a broadcast to avoid overflowing the system. */
 private const val INTENT_BROADCAST_DELAY = 100L
+/** Bounds the time a batched gesture keeps being executed after the detection is stopped. */
+private const val MAX_BATCHED_GESTURE_DURATION_MS = 1_000L
 
 private const val RANDOMIZATION_POSITION_MAX_OFFSET_PX = 5
 private const val RANDOMIZATION_DURATION_MAX_OFFSET_MS = 5L
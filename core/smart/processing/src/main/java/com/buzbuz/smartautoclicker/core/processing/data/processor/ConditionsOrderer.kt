@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2024 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data.processor
+
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+import com.buzbuz.smartautoclicker.core.domain.model.AND
+import com.buzbuz.smartautoclicker.core.domain.model.ConditionOperator
+import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
+
+/**
+ * Order the image conditions of an event to reduce the expected cost of their verification, using the duration of
+ * their native searches and how often they are fulfilled.
+ *
+ * With the AND operator, the verification stops on the first unfulfilled condition: the cheap conditions rarely
+ * fulfilled are verified first. With the OR operator, it stops on the first fulfilled one: the cheap conditions often
+ * fulfilled are verified first. The operator result is the same whatever the order.
+ */
+internal class ConditionsOrderer {
+
+    /** The median duration of the native searches of each condition, in nanoseconds, keyed by condition id. */
+    private var conditionsCostNs: Map<Long, Long> = emptyMap()
+    /** The verifications of each condition, keyed by condition id. */
+    private val conditionsHitRate: MutableMap<Long, HitRate> = mutableMapOf()
+    /** The ordered conditions of each event, keyed by event id. Computed again after each costs update. */
+    private val orderedConditions: MutableMap<Long, List<ImageCondition>> = mutableMapOf()
+
+    /** Update the costs of the conditions with the statistics of their recent native searches. */
+    fun onConditionStatisticsUpdated(statistics: List<ConditionStatistics>) {
+        conditionsCostNs = statistics.associate { it.conditionId to it.medianDurationNs }
+        orderedConditions.clear()
+    }
+
+    /** Record the result of the verification of an image condition, for its hit rate. */
+    fun onConditionVerified(conditionId: Long, isFulfilled: Boolean) {
+        conditionsHitRate.getOrPut(conditionId) { HitRate() }.apply {
+            verifiedCount++
+            if (isFulfilled) fulfilledCount++
+        }
+    }
+
+    /**
+     * Get the image conditions of an event in verification order.
+     *
+     * @param operator the operator between the conditions.
+     * @param conditions the conditions of the event, in declaration order.
+     *
+     * @return the conditions ordered by expected cost. The provided list while they haven't all been searched once.
+     */
+    fun getOrderedConditions(
+        @ConditionOperator operator: Int,
+        conditions: List<ImageCondition>,
+    ): List<ImageCondition> {
+        if (conditions.size < 2) return conditions
+
+        return orderedConditions.getOrPut(conditions.first().eventId.databaseId) {
+            // Without the cost of every condition, there is no way to compare them
+            if (conditions.any { !conditionsCostNs.containsKey(it.getValidId()) }) conditions
+            // Stable sort, conditions with the same score keep their declaration order
+            else conditions.sortedBy { condition -> getScore(operator, condition) }
+        }
+    }
+
+    /** @return the cost of the condition divided by the probability it ends the verification. Lowest goes first. */
+    private fun getScore(@ConditionOperator operator: Int, condition: ImageCondition): Double {
+        val costNs = conditionsCostNs[condition.getValidId()] ?: 0L
+        val fulfilledProbability = conditionsHitRate[condition.getValidId()]?.getFulfilledProbability() ?: 0.5
+        val stopProbability = if (operator == AND) 1 - fulfilledProbability else fulfilledProbability
+
+        return costNs / stopProbability
+    }
+
+    /** The verifications of a condition. */
+    private class HitRate {
+        var verifiedCount: Long = 0
+        var fulfilledCount: Long = 0
+
+        /** @return the smoothed probability of the condition to be fulfilled, never 0 nor 1. */
+        fun getFulfilledProbability(): Double =
+            (fulfilledCount + 1.0) / (verifiedCount + 2.0)
+    }
+}
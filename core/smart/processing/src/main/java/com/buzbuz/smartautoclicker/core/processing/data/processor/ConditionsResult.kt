@@ -56,6 +56,12 @@ internal class ConditionsResult : IConditionsResult {
     fun setFulfilledState(state: Boolean) {
         fulfilled = state
     }
+
+    /** @return a copy of the current results, kept after the next [reset]. */
+    fun copy(): ConditionsResult = ConditionsResult().also { copy ->
+        copy._results.putAll(_results)
+        copy.fulfilled = fulfilled
+    }
 }
 
 internal data class DefaultResult(
@@ -68,6 +74,7 @@ internal data class ImageResult(
     override val condition: ImageCondition,
     override val position: Point = Point(),
     override var confidenceRate: Double = 0.0,
+    override val detectionDurationNs: Long = 0L,
 ) : ImageConditionResult
 
 
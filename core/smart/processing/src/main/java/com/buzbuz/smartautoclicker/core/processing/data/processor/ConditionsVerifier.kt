@@ -18,8 +18,12 @@ package com.buzbuz.smartautoclicker.core.processing.data.processor
 
 import android.graphics.Bitmap
 import android.graphics.Point
+import android.graphics.Rect
 
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+import com.buzbuz.smartautoclicker.core.detection.DetectionBatch
 import com.buzbuz.smartautoclicker.core.detection.ImageDetector
+import com.buzbuz.smartautoclicker.core.detection.ScenarioPlan
 import com.buzbuz.smartautoclicker.core.domain.model.AND
 import com.buzbuz.smartautoclicker.core.domain.model.ConditionOperator
 import com.buzbuz.smartautoclicker.core.domain.model.CounterOperationValue
@@ -30,17 +34,22 @@ import com.buzbuz.smartautoclicker.core.domain.model.WHOLE_SCREEN
 import com.buzbuz.smartautoclicker.core.domain.model.condition.Condition
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.condition.TriggerCondition
+import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.processing.data.processor.state.ProcessingState
 import com.buzbuz.smartautoclicker.core.processing.domain.ConditionResult
 import com.buzbuz.smartautoclicker.core.processing.domain.ScenarioProcessingListener
 
-import kotlinx.coroutines.yield
-
 internal class ConditionsVerifier(
     private val state: ProcessingState,
     private val imageDetector: ImageDetector,
     private val bitmapSupplier: suspend (ImageCondition) -> Bitmap?,
-    private val progressListener: ScenarioProcessingListener? = null,
+    /** Yield the verification between the events and conditions, shared with the processing of the events. */
+    private val yielder: CooperativeYielder = CooperativeYielder(),
+    private val speculativeEventCount: Int = 0,
+    /** The area of the whole screen, updated by the processing. The anchored detection areas are kept in it. */
+    private val screenArea: Rect = Rect(),
+    /** Notified of the progress of each condition. Set for each screen image, null when its progress isn't listened. */
+    var progressListener: ScenarioProcessingListener? = null,
 ) {
 
     private companion object {
@@ -49,21 +58,236 @@ internal class ConditionsVerifier(
     }
 
     private val verificationResults: ConditionsResult = ConditionsResult()
+    /** Results of the image conditions detected on the current screen image, keyed by condition id. */
+    private val imageResultsCache: MutableMap<Long, ImageResult> = mutableMapOf()
+    /** Reused between verifications to detect all image conditions of an event in a single native call. */
+    private val detectionBatch: DetectionBatch = DetectionBatch()
+    /** Order the image conditions of each event by expected verification cost. */
+    private val conditionsOrderer: ConditionsOrderer = ConditionsOrderer()
+    /** Native plan evaluating all image events of a screen image in a single call, see [verifyImageEvents]. */
+    private val scenarioPlan: ScenarioPlan = ScenarioPlan()
+    /** The events compiled in [scenarioPlan], in evaluation order. Null if the plan must be compiled again. */
+    private var compiledEvents: List<ImageEvent>? = null
+    /**
+     * The events collection [compiledEvents] have been copied from. The processing state keeps the same collection
+     * until an event is enabled or disabled, it is not compared event by event with each screen image.
+     */
+    private var compiledEventsSource: Collection<ImageEvent>? = null
+    /** The conditions compiled in [scenarioPlan], at the index of their plan condition. */
+    private val compiledConditions: MutableList<ImageCondition> = mutableListOf()
     /**
      * Set only during a [verifyConditions], it contains the system time at verification start.
      * This allows to use the same reference time for all conditions during the same verification loop.
      */
     private var currentVerificationTsMs: Long? = null
 
+    /**
+     * Notify for a new screen image.
+     * @param isUnchanged true if the content of the screen is identical to the previous image, false if not.
+     */
+    fun onScreenImageChanged(isUnchanged: Boolean) {
+        if (!isUnchanged) imageResultsCache.clear()
+    }
+
+    /** Notify for new statistics of the native searches of the image conditions, used to order them. */
+    fun onConditionStatisticsUpdated(statistics: List<ConditionStatistics>) {
+        conditionsOrderer.onConditionStatisticsUpdated(statistics)
+        // The conditions order might have changed, it is compiled in the plan
+        compiledEvents = null
+    }
+
+    /**
+     * Verify the image events of the current screen image with a single detection call, notifying each fulfilled
+     * event in order. As with the verification of each event, the verification stops after the first fulfilled event
+     * that doesn't keep detecting.
+     *
+     * @param events the enabled image events, in verification order.
+     * @param scheduler tells which events are detected on this screen image, notified of their detection.
+     * @param deadlineNs the time after which the screen image is dropped without notifying any event, in the
+     *                   [System.nanoTime] time base. 0 for no deadline.
+     * @param onVerified called for each verified event with its results, valid only during the call. Can be null.
+     * @param onFulfilled called for each fulfilled event, with its results.
+     *
+     * @return true if the events have been verified or the screen image dropped, false if they must be verified one by
+     *         one with [verifyConditions]: a condition template isn't cached or the results of the screen image are
+     *         already known.
+     *
+     * Image events only have image conditions, the trigger conditions are verified with the trigger events before the
+     * screen image: the plan never needs a condition evaluated in Kotlin.
+     */
+    suspend fun verifyImageEvents(
+        events: Collection<ImageEvent>,
+        scheduler: ImageEventsScheduler,
+        deadlineNs: Long,
+        onVerified: ((ImageEvent, ConditionsResult) -> Unit)?,
+        onFulfilled: suspend (ImageEvent, ConditionsResult) -> Unit,
+    ): Boolean {
+        // Screen haven't changed, results are read from the cache
+        if (imageResultsCache.isNotEmpty()) return false
+        if (!isCompiled(events) && !compileImageEvents(events)) return false
+
+        // The plan isn't compiled again for the events not scheduled, they are skipped
+        for ((eventIndex, imageEvent) in events.withIndex()) {
+            scenarioPlan.setEventSkipped(eventIndex, !scheduler.isScheduled(imageEvent))
+        }
+
+        scenarioPlan.deadlineNs = deadlineNs
+        imageDetector.detectScenario(scenarioPlan)
+        if (scenarioPlan.isPixelsNeeded) return false
+        // Too old to act upon, the events are still due for the next screen image
+        if (scenarioPlan.isFrameExpired) return true
+
+        for ((eventIndex, imageEvent) in events.withIndex()) {
+            if (eventIndex >= scenarioPlan.evaluatedCount) break
+            if (!scheduler.isScheduled(imageEvent)) continue
+
+            scheduler.onEventDetected(imageEvent)
+            verificationResults.reset()
+            setImageEventResults(eventIndex, imageEvent.conditionOperator)
+            onVerified?.invoke(imageEvent, verificationResults)
+
+            if (verificationResults.fulfilled == true) {
+                scheduler.onEventFulfilled(imageEvent)
+                onFulfilled(imageEvent, verificationResults)
+            }
+            yielder.onItemProcessed()
+        }
+
+        return true
+    }
+
+    private fun isCompiled(events: Collection<ImageEvent>): Boolean {
+        val compiled = compiledEvents ?: return false
+        if (events === compiledEventsSource) return true
+        if (compiled.size != events.size) return false
+
+        // Events instances are kept by the processing state, comparing them is enough
+        for ((index, imageEvent) in events.withIndex()) {
+            if (compiled[index] !== imageEvent) return false
+        }
+        // Enabled back in the same order, the plan is still valid for the new collection
+        compiledEventsSource = events
+        return true
+    }
+
+    private fun compileImageEvents(events: Collection<ImageEvent>): Boolean {
+        compiledEvents = null
+        compiledConditions.clear()
+        scenarioPlan.clear()
+
+        for (imageEvent in events) {
+            // The plan have no bitmap, all templates must be loaded natively
+            if (imageEvent.conditions.any { !imageDetector.isConditionCached(it.getValidId()) }) return false
+
+            scenarioPlan.addEvent(
+                eventId = imageEvent.getValidId(),
+                operator = if (imageEvent.conditionOperator == OR) DetectionBatch.OPERATOR_OR
+                    else DetectionBatch.OPERATOR_AND,
+                keepDetecting = imageEvent.keepDetecting,
+            )
+
+            // Verified cheapest and most likely to decide the operator result first
+            val conditions = conditionsOrderer.getOrderedConditions(imageEvent.conditionOperator, imageEvent.conditions)
+            val firstConditionIndex = compiledConditions.size
+            for (condition in conditions) {
+                val anchor = condition.getAnchor(conditions)
+
+                if (anchor != null) scenarioPlan.addAnchoredCondition(
+                    conditionId = condition.getValidId(),
+                    anchorIndex = firstConditionIndex + conditions.indexOf(anchor),
+                    anchorArea = condition.anchorArea!!,
+                    threshold = condition.threshold,
+                    shouldBeDetected = condition.shouldBeDetected,
+                    identifying = condition.name,
+                ) else if (condition.isSearchedAsTextInArea()) scenarioPlan.addTextInAreaCondition(
+                    conditionId = condition.getValidId(),
+                    area = condition.getDetectionArea(),
+                    identifying = condition.name,
+                    shouldBeDetected = condition.shouldBeDetected,
+                ) else if (condition.isFeatureMatching) scenarioPlan.addFeaturesCondition(
+                    conditionId = condition.getValidId(),
+                    area = condition.getDetectionArea(),
+                    threshold = condition.threshold,
+                    shouldBeDetected = condition.shouldBeDetected,
+                ) else scenarioPlan.addCondition(
+                    conditionId = condition.getValidId(),
+                    area = condition.getDetectionArea(),
+                    threshold = condition.threshold,
+                    shouldBeDetected = condition.shouldBeDetected,
+                    identifying = condition.name,
+                )
+                compiledConditions.add(condition)
+            }
+        }
+
+        scenarioPlan.speculativeEventCount = speculativeEventCount
+        imageDetector.compileScenario(scenarioPlan)
+        compiledEvents = events.toList()
+        compiledEventsSource = events
+        return true
+    }
+
+    private fun setImageEventResults(eventIndex: Int, @ConditionOperator operator: Int) {
+        val processedCount = scenarioPlan.getProcessedCount(eventIndex)
+        if (processedCount == 0) {
+            verificationResults.setFulfilledState(false)
+            return
+        }
+
+        val firstConditionIndex = scenarioPlan.getFirstConditionIndex(eventIndex)
+        for (index in firstConditionIndex until firstConditionIndex + processedCount) {
+            val condition = compiledConditions[index]
+            val isDetected = scenarioPlan.isDetected(index)
+            val result = ImageResult(
+                isFulfilled = isDetected == condition.shouldBeDetected,
+                haveBeenDetected = isDetected,
+                condition = condition,
+                position = Point(scenarioPlan.getPositionX(index), scenarioPlan.getPositionY(index)),
+                confidenceRate = scenarioPlan.getConfidenceRate(index),
+                detectionDurationNs = scenarioPlan.getDetectionDurationNs(index),
+            )
+            imageResultsCache[condition.getValidId()] = result
+            verificationResults.addResult(condition.getValidId(), result)
+            conditionsOrderer.onConditionVerified(condition.getValidId(), result.isFulfilled)
+
+            if (operator == OR && result.isFulfilled) {
+                verificationResults.setFulfilledState(true)
+                return
+            }
+            if (operator == AND && !result.isFulfilled) {
+                verificationResults.setFulfilledState(false)
+                return
+            }
+        }
+
+        verificationResults.setFulfilledState(operator == AND)
+    }
+
     suspend fun verifyConditions(@ConditionOperator operator: Int, conditions: List<Condition>): ConditionsResult {
         verificationResults.reset()
         currentVerificationTsMs = System.currentTimeMillis()
 
+        var verifiedConditions = conditions
+        if (conditions.all { it is ImageCondition }) {
+            // Verified cheapest and most likely to decide the operator result first
+            @Suppress("UNCHECKED_CAST")
+            val imageConditions = conditionsOrderer.getOrderedConditions(operator, conditions as List<ImageCondition>)
+
+            // Without listener, there is no need to get the per condition progress, all can be detected at once
+            if (progressListener == null && verifyImageConditionsBatch(operator, imageConditions)) {
+                return verificationResults
+            }
+            verifiedConditions = imageConditions
+        }
+
         var verificationResult: ConditionResult
 
-        for (condition in conditions) {
-            verificationResult = verifyCondition(condition)
+        for (condition in verifiedConditions) {
+            verificationResult = verifyCondition(condition, verifiedConditions)
             verificationResults.addResult(condition.getValidId(), verificationResult)
+            if (condition is ImageCondition) {
+                conditionsOrderer.onConditionVerified(condition.getValidId(), verificationResult.isFulfilled)
+            }
 
             if (operator == OR && verificationResult.isFulfilled) {
                 verificationResults.setFulfilledState(true)
@@ -74,16 +298,121 @@ internal class ConditionsVerifier(
                 return verificationResults
             }
 
-            yield()
+            yielder.onItemProcessed()
         }
 
         verificationResults.setFulfilledState(operator == AND)
         return verificationResults
     }
 
-    private suspend fun verifyCondition(condition: Condition): ConditionResult =
+    /**
+     * Verify all image conditions with a single detection call.
+     * @return true if the verification has been made, false if a condition bitmap is missing or if a condition is
+     *         located by an anchor: the anchors are only resolved by the [scenarioPlan].
+     */
+    private suspend fun verifyImageConditionsBatch(
+        @ConditionOperator operator: Int,
+        conditions: List<ImageCondition>,
+    ): Boolean {
+        // Screen haven't changed since those conditions were detected, the detector verdict is the same
+        if (conditions.all { imageResultsCache.containsKey(it.getValidId()) }) {
+            verifyImageConditionsFromCache(operator, conditions)
+            return true
+        }
+        if (conditions.any { it.getAnchor(conditions) != null }) return false
+
+        detectionBatch.clear()
+        detectionBatch.operator = if (operator == OR) DetectionBatch.OPERATOR_OR else DetectionBatch.OPERATOR_AND
+
+        for (condition in conditions) {
+            // Read in the text of the area, the condition bitmap isn't used
+            if (condition.isSearchedAsTextInArea()) {
+                detectionBatch.addTextInArea(
+                    conditionId = condition.getValidId(),
+                    area = condition.getDetectionArea(),
+                    identifying = condition.name,
+                    shouldBeDetected = condition.shouldBeDetected,
+                )
+                continue
+            }
+
+            // Packed and cached conditions are loaded natively, their bitmap doesn't need to be decoded
+            val conditionBitmap =
+                if (imageDetector.isConditionCached(condition.getValidId())) null
+                else bitmapSupplier(condition) ?: return false
+            if (condition.isFeatureMatching) detectionBatch.addFeatures(
+                conditionId = condition.getValidId(),
+                conditionBitmap = conditionBitmap,
+                area = condition.getDetectionArea(),
+                threshold = condition.threshold,
+                shouldBeDetected = condition.shouldBeDetected,
+            ) else detectionBatch.add(
+                conditionId = condition.getValidId(),
+                conditionBitmap = conditionBitmap,
+                area = condition.getDetectionArea(),
+                threshold = condition.threshold,
+                shouldBeDetected = condition.shouldBeDetected,
+                identifying = condition.name,
+            )
+        }
+
+        imageDetector.detectConditions(detectionBatch)
+        if (detectionBatch.processedCount == 0) {
+            verificationResults.setFulfilledState(false)
+            return true
+        }
+
+        for (index in 0 until detectionBatch.processedCount) {
+            val condition = conditions[index]
+            val isDetected = detectionBatch.isDetected(index)
+            val result = ImageResult(
+                isFulfilled = isDetected == condition.shouldBeDetected,
+                haveBeenDetected = isDetected,
+                condition = condition,
+                position = Point(detectionBatch.getPositionX(index), detectionBatch.getPositionY(index)),
+                confidenceRate = detectionBatch.getConfidenceRate(index),
+                detectionDurationNs = detectionBatch.getDetectionDurationNs(index),
+            )
+            imageResultsCache[condition.getValidId()] = result
+            verificationResults.addResult(condition.getValidId(), result)
+            conditionsOrderer.onConditionVerified(condition.getValidId(), result.isFulfilled)
+
+            if (operator == OR && result.isFulfilled) {
+                verificationResults.setFulfilledState(true)
+                return true
+            }
+            if (operator == AND && !result.isFulfilled) {
+                verificationResults.setFulfilledState(false)
+                return true
+            }
+        }
+
+        verificationResults.setFulfilledState(operator == AND)
+        return true
+    }
+
+    private fun verifyImageConditionsFromCache(@ConditionOperator operator: Int, conditions: List<ImageCondition>) {
+        for (condition in conditions) {
+            val result = imageResultsCache[condition.getValidId()] ?: continue
+            verificationResults.addResult(condition.getValidId(), result)
+            conditionsOrderer.onConditionVerified(condition.getValidId(), result.isFulfilled)
+
+            if (operator == OR && result.isFulfilled) {
+                verificationResults.setFulfilledState(true)
+                return
+            }
+            if (operator == AND && !result.isFulfilled) {
+                verificationResults.setFulfilledState(false)
+                return
+            }
+        }
+
+        verificationResults.setFulfilledState(operator == AND)
+    }
+
+    private suspend fun verifyCondition(condition: Condition, eventConditions: List<Condition>): ConditionResult =
         when (condition) {
-            is ImageCondition -> verifyImageCondition(condition)
+            is ImageCondition -> verifyImageCondition(condition, condition.getAnchor(eventConditions))
             is TriggerCondition -> if (verifyTriggerCondition(condition)) POSITIVE_RESULT else NEGATIVE_RESULT
         }
 
@@ -134,20 +463,60 @@ internal class ConditionsVerifier(
         } else false
     }
 
-    private suspend fun verifyImageCondition(condition: ImageCondition): ConditionResult {
+    private suspend fun verifyImageCondition(
+        condition: ImageCondition,
+        anchor: ImageCondition? = null,
+    ): ConditionResult {
         progressListener?.onImageConditionProcessingStarted(condition)
 
-        val result = bitmapSupplier(condition)?.let { conditionBitmap ->
+        imageResultsCache[condition.getValidId()]?.let { cachedResult ->
+            progressListener?.onImageConditionProcessingCompleted(cachedResult)
+            return cachedResult
+        }
+
+        if (anchor != null) {
+            val result = verifyAnchoredCondition(condition, anchor)
+            progressListener?.onImageConditionProcessingCompleted(result)
+            return result
+        }
+
+        if (condition.isSearchedAsTextInArea()) {
+            val result = verifyConditionInBatch(condition) {
+                addTextInArea(
+                    conditionId = condition.getValidId(),
+                    area = condition.getDetectionArea(),
+                    identifying = condition.name,
+                    shouldBeDetected = condition.shouldBeDetected,
+                )
+            }
+            progressListener?.onImageConditionProcessingCompleted(result)
+            return result
+        }
+
+        // Packed and cached conditions are loaded natively, their bitmap doesn't need to be decoded
+        val isCached = imageDetector.isConditionCached(condition.getValidId())
+        val conditionBitmap = if (isCached) null else bitmapSupplier(condition)
+
+        val result = if (!isCached && conditionBitmap == null) NEGATIVE_RESULT
+        else if (condition.isFeatureMatching) verifyConditionInBatch(condition) {
+            addFeatures(
+                conditionId = condition.getValidId(),
+                conditionBitmap = conditionBitmap,
+                area = condition.getDetectionArea(),
+                threshold = condition.threshold,
+                shouldBeDetected = condition.shouldBeDetected,
+            )
+        } else {
             val detectionResult = when (condition.detectionType) {
                 EXACT ->
-                    imageDetector.detectCondition(conditionBitmap, condition.area, condition.name)
+                    imageDetector.detectCondition(condition.getValidId(), conditionBitmap, condition.area, condition.name)
 
                 WHOLE_SCREEN ->
-                    imageDetector.detectCondition(conditionBitmap, condition.name)
+                    imageDetector.detectCondition(condition.getValidId(), conditionBitmap, condition.name)
 
                 IN_AREA ->
                     condition.detectionArea?.let { area ->
-                        imageDetector.detectCondition(conditionBitmap, area, condition.name)
+                        imageDetector.detectCondition(condition.getValidId(), conditionBitmap, area, condition.name)
                     } ?: throw IllegalArgumentException("Invalid IN_AREA condition, no area defined")
 
                 else -> throw IllegalArgumentException("Unexpected detection type")
@@ -159,10 +528,111 @@ internal class ConditionsVerifier(
                 condition = condition,
                 position = Point(detectionResult.position.x, detectionResult.position.y),
                 confidenceRate = detectionResult.confidenceRate,
-            )
-        } ?: NEGATIVE_RESULT
+            ).also { imageResult -> imageResultsCache[condition.getValidId()] = imageResult }
+        }
 
         progressListener?.onImageConditionProcessingCompleted(result)
         return result
     }
-}
\ No newline at end of file
+
+    /**
+     * Detect a condition located by its anchor, in its anchor area around the anchor detection. It is not detected if
+     * the anchor isn't, or if this area is outside of the screen.
+     */
+    private suspend fun verifyAnchoredCondition(condition: ImageCondition, anchor: ImageCondition): ConditionResult {
+        val anchorResult = verifyImageCondition(anchor) as? ImageResult
+        val area = anchorResult?.takeIf { it.haveBeenDetected }?.let { getAnchoredArea(condition, it.position) }
+
+        val detectionResult = area?.let {
+            // Packed and cached conditions are loaded natively, their bitmap doesn't need to be decoded
+            val conditionBitmap =
+                if (imageDetector.isConditionCached(condition.getValidId())) null
+                else bitmapSupplier(condition) ?: return NEGATIVE_RESULT
+            imageDetector.detectCondition(condition.getValidId(), conditionBitmap, area, condition.name)
+        }
+
+        val isDetected = detectionResult?.isDetected == true
+        return ImageResult(
+            isFulfilled = isDetected == condition.shouldBeDetected,
+            haveBeenDetected = isDetected,
+            condition = condition,
+            position = detectionResult?.let { Point(it.position.x, it.position.y) } ?: Point(),
+            confidenceRate = detectionResult?.confidenceRate ?: 0.0,
+        ).also { imageResult -> imageResultsCache[condition.getValidId()] = imageResult }
+    }
+
+    /** @return the area to detect the condition in for its anchor detected at [anchorPosition], null if off screen. */
+    private fun getAnchoredArea(condition: ImageCondition, anchorPosition: Point): Rect? {
+        val area = Rect(condition.anchorArea ?: return null)
+        area.offset(anchorPosition.x, anchorPosition.y)
+
+        return if (screenArea.isEmpty || area.intersect(screenArea)) area else null
+    }
+
+    /**
+     * Detect a condition alone with the [detectionBatch], for the detections without single condition call: the text
+     * in area and the feature points ones.
+     */
+    private fun verifyConditionInBatch(
+        condition: ImageCondition,
+        addCondition: DetectionBatch.() -> Unit,
+    ): ConditionResult {
+        detectionBatch.clear()
+        detectionBatch.addCondition()
+        imageDetector.detectConditions(detectionBatch)
+        if (detectionBatch.processedCount == 0) return NEGATIVE_RESULT
+
+        val isDetected = detectionBatch.isDetected(0)
+        return ImageResult(
+            isFulfilled = isDetected == condition.shouldBeDetected,
+            haveBeenDetected = isDetected,
+            condition = condition,
+            position = Point(detectionBatch.getPositionX(0), detectionBatch.getPositionY(0)),
+            confidenceRate = detectionBatch.getConfidenceRate(0),
+            detectionDurationNs = detectionBatch.getDetectionDurationNs(0),
+        ).also { imageResult -> imageResultsCache[condition.getValidId()] = imageResult }
+    }
+}
+
+/** @return true if the name of the condition is searched in the text of its area, without its bitmap. */
+internal fun ImageCondition.isSearchedAsTextInArea(): Boolean =
+    isTextInArea && detectionType == IN_AREA
+
+/**
+ * @return the anchor locating this condition in [eventConditions], the conditions of its event. Null if it has none,
+ *         or if it can't be located by it: the anchor is anchored itself, or this condition isn't detected with its
+ *         bitmap.
+ */
+internal fun ImageCondition.getAnchor(eventConditions: List<Condition>): ImageCondition? {
+    val anchorId = anchorConditionId ?: return null
+    if (anchorArea?.isEmpty != false || isSearchedAsTextInArea() || isFeatureMatching) return null
+
+    return eventConditions.find { condition ->
+        condition is ImageCondition && condition.id == anchorId && condition.anchorConditionId == null
+    } as? ImageCondition
+}
+
+/**
+ * @return the area the condition can be detected in when located by [anchor], every position of the anchor in its own
+ *         detection area included. Null for the whole screen.
+ */
+internal fun ImageCondition.getAnchoredDetectionArea(anchor: ImageCondition): Rect? {
+    val offsets = anchorArea ?: return null
+    val anchorDetectionArea = anchor.getDetectionArea() ?: return null
+
+    return Rect(
+        anchorDetectionArea.left + offsets.left,
+        anchorDetectionArea.top + offsets.top,
+        anchorDetectionArea.right + offsets.right,
+        anchorDetectionArea.bottom + offsets.bottom,
+    )
+}
+
+/** @return the area to detect the condition in, or null for the whole screen. */
+internal fun ImageCondition.getDetectionArea(): Rect? =
+    when (detectionType) {
+        EXACT -> area
+        WHOLE_SCREEN -> null
+        IN_AREA -> detectionArea ?: throw IllegalArgumentException("Invalid IN_AREA condition, no area defined")
+        else -> throw IllegalArgumentException("Unexpected detection type")
+    }
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data.processor
+
+import kotlinx.coroutines.currentCoroutineContext
+import kotlinx.coroutines.ensureActive
+import kotlinx.coroutines.yield
+
+/**
+ * Yield the processing coroutine once a slice of work has elapsed, instead of after each processed item.
+ *
+ * Each yield is a dispatch of the coroutine, possibly on another thread, evicting the native caches between two short
+ * detections. The cancellation is still checked after each item, it doesn't need any dispatch.
+ *
+ * @param sliceNs the duration of work between two yields, in nanoseconds.
+ */
+internal class CooperativeYielder(private val sliceNs: Long = DEFAULT_SLICE_NS) {
+
+    /** The start of the current slice of work, in the [System.nanoTime] time base. */
+    private var sliceStartNs: Long = System.nanoTime()
+
+    /** Start a new slice of work, after the processing was suspended for a while, such as between two screen images. */
+    fun startSlice() {
+        sliceStartNs = System.nanoTime()
+    }
+
+    /** Notify for the end of the processing of an item, yielding if the current slice of work has elapsed. */
+    suspend fun onItemProcessed() {
+        currentCoroutineContext().ensureActive()
+        if (System.nanoTime() - sliceStartNs < sliceNs) return
+
+        yield()
+        sliceStartNs = System.nanoTime()
+    }
+}
+
+/** The default duration of work between two yields of the processing, in nanoseconds. */
+private const val DEFAULT_SLICE_NS = 4_000_000L
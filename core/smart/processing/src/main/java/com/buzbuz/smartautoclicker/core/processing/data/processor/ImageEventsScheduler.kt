@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data.processor
+
+import androidx.annotation.VisibleForTesting
+
+import com.buzbuz.smartautoclicker.core.detection.SCREEN_STATE_UNKNOWN
+import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
+
+/**
+ * Decide which image events are detected on each screen image, from their detection frame interval and minimum
+ * interval.
+ *
+ * An event is scheduled once both intervals have elapsed since its last detection. It stays scheduled until it is
+ * detected: an event not reached because a previous one stopped the detection of the image is detected on the next
+ * ones. The events without intervals are always scheduled.
+ *
+ * With the screen states gating, the events are also only scheduled on the states of the application they have been
+ * fulfilled on, see [com.buzbuz.smartautoclicker.core.detection.ImageDetector.classifyScreenState]. All events are
+ * scheduled on the first [SCREEN_STATE_LEARNING_IMAGES] images of a state, and then once every
+ * [SCREEN_STATE_EXPLORATION_INTERVAL] images, to learn the events fulfilled on it.
+ *
+ * @param screenStatesGatingEnabled true to only schedule the events on the screen states they are fulfilled on.
+ */
+internal class ImageEventsScheduler(private val screenStatesGatingEnabled: Boolean = false) {
+
+    /** The index of the current screen image, incremented by [onScreenImageChanged]. */
+    private var imageIndex: Long = 0
+    /** The time of the current screen image, in milliseconds. */
+    private var imageTimestampMs: Long = 0
+    /** The last detection of each event with intervals, keyed by event id. */
+    private val lastDetections: MutableMap<Long, LastDetection> = mutableMapOf()
+    /** The states of the screen images, keyed by their identifier. Empty without the screen states gating. */
+    private val screenStates: MutableMap<Int, ScreenState> = mutableMapOf()
+    /** The state of the current screen image, null if it is unknown or without the screen states gating. */
+    private var screenState: ScreenState? = null
+
+    /** @return true if the screen state of each image must be provided to [onScreenImageChanged]. */
+    fun isScreenStateNeeded(): Boolean = screenStatesGatingEnabled
+
+    /**
+     * Notify for a new screen image to detect the events on.
+     * @param timestampMs the time of the image, in milliseconds.
+     * @param screenStateId the state of the image, see [isScreenStateNeeded].
+     */
+    fun onScreenImageChanged(timestampMs: Long, screenStateId: Int = SCREEN_STATE_UNKNOWN) {
+        imageIndex++
+        imageTimestampMs = timestampMs
+        screenState =
+            if (!screenStatesGatingEnabled || screenStateId == SCREEN_STATE_UNKNOWN) null
+            else screenStates.getOrPut(screenStateId, ::ScreenState).apply { imageCount++ }
+    }
+
+    /** Notify for new screen metrics, the identifiers of the screen states are no longer the same. */
+    fun onScreenMetricsChanged() {
+        screenStates.clear()
+        screenState = null
+    }
+
+    /** @return true if the event must be detected on the current screen image. */
+    fun isScheduled(event: ImageEvent): Boolean {
+        if (!isScheduledOnScreenState(event)) return false
+        if (!event.hasDetectionIntervals()) return true
+        val lastDetection = lastDetections[event.getValidId()] ?: return true
+
+        return imageIndex - lastDetection.imageIndex >= event.detectionFrameInterval
+                && imageTimestampMs - lastDetection.timestampMs >= event.detectionMinIntervalMs
+    }
+
+    /** @return true if all those events are detected on each screen image, whatever their previous detections. */
+    fun isAlwaysScheduled(events: Collection<ImageEvent>): Boolean =
+        !screenStatesGatingEnabled && events.none { event -> event.hasDetectionIntervals() }
+
+    /** Notify for the detection of an event on the current screen image. */
+    fun onEventDetected(event: ImageEvent) {
+        if (!event.hasDetectionIntervals()) return
+
+        lastDetections.getOrPut(event.getValidId()) { LastDetection() }.apply {
+            imageIndex = this@ImageEventsScheduler.imageIndex
+            timestampMs = imageTimestampMs
+        }
+    }
+
+    /** Notify for the fulfillment of an event on the current screen image. */
+    fun onEventFulfilled(event: ImageEvent) {
+        screenState?.fulfilledEventIds?.add(event.getValidId())
+    }
+
+    private fun isScheduledOnScreenState(event: ImageEvent): Boolean {
+        val state = screenState ?: return true
+        return state.isLearning() || event.getValidId() in state.fulfilledEventIds
+    }
+
+    private fun ImageEvent.hasDetectionIntervals(): Boolean =
+        detectionFrameInterval > 1 || detectionMinIntervalMs > 0
+
+    private class ScreenState {
+        /** The number of screen images classified in this state. */
+        var imageCount: Long = 0
+        /** The events fulfilled at least once on this state. */
+        val fulfilledEventIds: MutableSet<Long> = mutableSetOf()
+
+        /** @return true if all events must be detected on the current image, to learn the ones fulfilled on it. */
+        fun isLearning(): Boolean =
+            imageCount <= SCREEN_STATE_LEARNING_IMAGES || imageCount % SCREEN_STATE_EXPLORATION_INTERVAL == 0L
+    }
+
+    private class LastDetection {
+        var imageIndex: Long = 0
+        var timestampMs: Long = 0
+    }
+}
+
+/** The number of first images of a screen state where all events are detected. */
+@VisibleForTesting internal const val SCREEN_STATE_LEARNING_IMAGES = 30
+/** The number of images of a screen state between two detections of all events, once it is learned. */
+@VisibleForTesting internal const val SCREEN_STATE_EXPLORATION_INTERVAL = 20
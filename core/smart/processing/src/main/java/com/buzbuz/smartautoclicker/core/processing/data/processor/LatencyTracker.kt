@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.data.processor
+
+import com.buzbuz.smartautoclicker.core.processing.domain.LATENCY_BUCKET_BOUNDS_NS
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStage
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStatistics
+import com.buzbuz.smartautoclicker.core.processing.domain.StageLatency
+
+/**
+ * Measures the latency of each [LatencyStage] of the processed screen frames.
+ *
+ * The times are in the [System.nanoTime] time base, the one of the frames timestamps. Only the first fulfilled event
+ * and the first gesture of each frame are measured, the following ones are not a reaction to the frame anymore.
+ * Updated by the processing, and read from any thread with [getStatistics].
+ */
+internal class LatencyTracker {
+
+    /** The histogram of each stage. */
+    private val histograms: Map<LatencyStage, LatencyHistogram> =
+        LatencyStage.entries.associateWith { LatencyHistogram() }
+
+    /** The rendering time of the current frame, [NO_TIME] if it is unknown. */
+    private var captureNs: Long = NO_TIME
+    /** The rendering time of the previous frame, to ignore the capture latency of the frames processed again. */
+    private var lastCaptureNs: Long = NO_TIME
+    /** The start time of the processing of the current frame, [NO_TIME] if there is none. */
+    private var processingStartNs: Long = NO_TIME
+    /** The time the current frame has been set up in the detector, [NO_TIME] if it is not yet. */
+    private var ingestedNs: Long = NO_TIME
+    /** The time the detection of the current frame decided of its reaction, [NO_TIME] if it is not yet. */
+    private var detectedNs: Long = NO_TIME
+    /** Tells if a gesture has been dispatched for the current frame. */
+    private var isDispatched: Boolean = false
+
+    /**
+     * Start the measures of a new frame.
+     *
+     * @param captureTimestampNs the rendering time of the frame, or [NO_TIME] if it is unknown.
+     */
+    @Synchronized
+    fun onFrameProcessingStarted(captureTimestampNs: Long = NO_TIME) {
+        val nowNs = System.nanoTime()
+        // The same frame is processed again while the screen is unchanged, it is not a new reaction
+        captureNs = if (captureTimestampNs == lastCaptureNs) NO_TIME else captureTimestampNs
+        lastCaptureNs = captureTimestampNs
+        processingStartNs = nowNs
+        ingestedNs = NO_TIME
+        detectedNs = NO_TIME
+        isDispatched = false
+
+        if (captureNs != NO_TIME) record(LatencyStage.CAPTURE, captureNs, nowNs)
+    }
+
+    /** The current frame is set up in the detector. */
+    @Synchronized
+    fun onFrameIngested() {
+        if (processingStartNs == NO_TIME || ingestedNs != NO_TIME) return
+
+        ingestedNs = System.nanoTime()
+        record(LatencyStage.INGEST, processingStartNs, ingestedNs)
+    }
+
+    /** An event is fulfilled on the current frame, or its detection is completed without any. */
+    @Synchronized
+    fun onFrameDetected() {
+        if (ingestedNs == NO_TIME || detectedNs != NO_TIME) return
+
+        detectedNs = System.nanoTime()
+        record(LatencyStage.DETECT, ingestedNs, detectedNs)
+    }
+
+    /** A gesture of the actions of an event fulfilled on the current frame has been dispatched. */
+    @Synchronized
+    fun onGestureDispatched() {
+        if (detectedNs == NO_TIME || isDispatched) return
+
+        val nowNs = System.nanoTime()
+        isDispatched = true
+        record(LatencyStage.DISPATCH, detectedNs, nowNs)
+        if (captureNs != NO_TIME) record(LatencyStage.END_TO_END, captureNs, nowNs)
+    }
+
+    /** @return the latencies measured since the creation of this tracker. */
+    @Synchronized
+    fun getStatistics(): LatencyStatistics =
+        LatencyStatistics(
+            stages = buildMap {
+                histograms.forEach { (stage, histogram) ->
+                    histogram.toStageLatency()?.let { latency -> put(stage, latency) }
+                }
+            }
+        )
+
+    private fun record(stage: LatencyStage, startNs: Long, endNs: Long) {
+        histograms[stage]?.add((endNs - startNs).coerceAtLeast(0))
+    }
+}
+
+/** Histogram of latencies, with the buckets of [LATENCY_BUCKET_BOUNDS_NS]. */
+private class LatencyHistogram {
+
+    /** The number of latencies in each bucket, with the last one for the latencies above the last bound. */
+    private val bucketCounts = LongArray(LATENCY_BUCKET_BOUNDS_NS.size + 1)
+    /** The number of latencies added. */
+    private var count = 0L
+    /** The sum of the latencies added, in nanoseconds. */
+    private var sumNs = 0L
+    /** The maximum latency added, in nanoseconds. */
+    private var maxNs = 0L
+
+    fun add(latencyNs: Long) {
+        val bucket = LATENCY_BUCKET_BOUNDS_NS.indexOfFirst { bound -> latencyNs <= bound }
+        bucketCounts[if (bucket < 0) LATENCY_BUCKET_BOUNDS_NS.size else bucket]++
+        count++
+        sumNs += latencyNs
+        if (latencyNs > maxNs) maxNs = latencyNs
+    }
+
+    fun toStageLatency(): StageLatency? {
+        if (count == 0L) return null
+
+        return StageLatency(
+            count = count,
+            meanNs = sumNs / count,
+            medianNs = getPercentileNs(0.5),
+            p95Ns = getPercentileNs(0.95),
+            maxNs = maxNs,
+            bucketCounts = bucketCounts.toList(),
+        )
+    }
+
+    /** @return the upper bound of the bucket containing the percentile, limited by the maximum latency. */
+    private fun getPercentileNs(percentile: Double): Long {
+        val rank = (count * percentile).toLong().coerceIn(1, count)
+        var cumulatedCount = 0L
+        bucketCounts.forEachIndexed { bucket, bucketCount ->
+            cumulatedCount += bucketCount
+            if (cumulatedCount >= rank) return LATENCY_BUCKET_BOUNDS_NS.getOrElse(bucket) { maxNs }.coerceAtMost(maxNs)
+        }
+
+        return maxNs
+    }
+}
+
+/** Time value when a measure of the [LatencyTracker] is not available. */
+internal const val NO_TIME = -1L
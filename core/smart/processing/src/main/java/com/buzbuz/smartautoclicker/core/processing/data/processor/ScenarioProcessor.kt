@@ -18,16 +18,36 @@ package com.buzbuz.smartautoclicker.core.processing.data.processor
 
 import android.content.Context
 import android.graphics.Bitmap
+import android.graphics.Rect
 import androidx.annotation.VisibleForTesting
 
+import com.buzbuz.smartautoclicker.core.detection.DETECTION_QUALITY_MIN
 import com.buzbuz.smartautoclicker.core.detection.ImageDetector
+import com.buzbuz.smartautoclicker.core.detection.SCREEN_STATE_UNKNOWN
+import com.buzbuz.smartautoclicker.core.display.recorder.ScreenFrame
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_CCOEFF_NORMED
 import com.buzbuz.smartautoclicker.core.domain.model.SmartActionExecutor
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.domain.model.event.TriggerEvent
+import com.buzbuz.smartautoclicker.core.processing.data.TRACE_SECTION_FIRST_FRAME
+import com.buzbuz.smartautoclicker.core.processing.data.TRACE_SECTION_LOAD_BITMAPS
+import com.buzbuz.smartautoclicker.core.processing.data.TRACE_SECTION_PREPARE_CONDITIONS
+import com.buzbuz.smartautoclicker.core.processing.data.TRACE_SECTION_SCREEN_METRICS
+import com.buzbuz.smartautoclicker.core.processing.data.traceAsyncSection
+import com.buzbuz.smartautoclicker.core.processing.data.traceSection
 import com.buzbuz.smartautoclicker.core.processing.data.processor.state.ProcessingState
+import com.buzbuz.smartautoclicker.core.processing.domain.ConditionsPreparation
+import com.buzbuz.smartautoclicker.core.processing.domain.ImageEventResult
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStatistics
 import com.buzbuz.smartautoclicker.core.processing.domain.ScenarioProcessingListener
 
+import kotlinx.coroutines.CompletableDeferred
+import kotlinx.coroutines.CoroutineScope
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.awaitAll
+import kotlinx.coroutines.coroutineScope
 import kotlinx.coroutines.yield
 
 /**
@@ -38,8 +58,25 @@ import kotlinx.coroutines.yield
  * @param randomize true to randomize the actions values a bit to avoid being taken for a bot.
  * @param imageEvents the list of scenario events to be detected.
  * @param bitmapSupplier provides the conditions bitmaps.
+ * @param bitmapFileSupplier provides the path of the conditions bitmaps files, read natively when preparing the
+ *                           conditions instead of loading their bitmaps. Null to always load the bitmaps.
  * @param androidExecutor execute the actions requiring an interaction with Android..
+ * @param gestureBatchingEnabled true to dispatch the consecutive gestures of an event as a single one.
+ * @param actionsOverlapEnabled true to detect the next screen images while the actions of the events that can't
+ *                              change the processing state are executed, see [ActionExecutor.executeActionsOverlapped].
+ * @param speculativeEventCount the number of first image events detected at the same time, see
+ *                              [com.buzbuz.smartautoclicker.core.detection.ScenarioPlan.speculativeEventCount].
+ * @param maxFrameAgeMs the time after which a screen frame is dropped if its events are not decided yet, starting when
+ *                      it was last acquired as the latest one. 0 to always complete the detection of the frames.
+ * @param screenChangeWaitEnabled true to only check the detection areas for changes while the screen content can't
+ *                                fulfil any event, see [awaitScreenChange].
+ * @param idleConditionsCompactionEnabled true to keep the conditions of the events that can't be enabled by the
+ *                                        actions of the enabled ones compacted in the detector, see
+ *                                        [updateIdleConditions].
+ * @param screenStatesGatingEnabled true to only detect the image events on the states of the screen they have been
+ *                                  fulfilled on, see [ImageEventsScheduler].
  * @param onStopRequested called when a end condition of the scenario have been reached or all events are disabled.
+ * @param onConditionsPrepared called with the progress of the processing of the image conditions by the detector.
  * @param progressListener the object to notify for detection progress. Can be null if not required.
  */
 internal class ScenarioProcessor(
@@ -50,26 +87,74 @@ internal class ScenarioProcessor(
     imageEvents: List<ImageEvent>,
     triggerEvents: List<TriggerEvent>,
     private val bitmapSupplier: suspend (ImageCondition) -> Bitmap?,
+    private val bitmapFileSupplier: ((ImageCondition) -> String?)? = null,
     androidExecutor: SmartActionExecutor,
     unblockWorkaroundEnabled: Boolean = false,
+    gestureBatchingEnabled: Boolean = false,
+    private val actionsOverlapEnabled: Boolean = false,
+    speculativeEventCount: Int = 0,
+    private val maxFrameAgeMs: Long = 0,
+    private val screenChangeWaitEnabled: Boolean = false,
+    private val idleConditionsCompactionEnabled: Boolean = false,
+    screenStatesGatingEnabled: Boolean = false,
     private val onStopRequested: () -> Unit,
+    private val onConditionsPrepared: ((ConditionsPreparation) -> Unit)? = null,
     private val progressListener: ScenarioProcessingListener? = null,
 ) {
 
     /** Handle the processing state of the scenario. */
     @VisibleForTesting internal val processingState: ProcessingState = ProcessingState(imageEvents, triggerEvents)
+    /** Yield the processing between the events and conditions of a screen image, once its slice of work elapsed. */
+    private val yielder = CooperativeYielder()
+    /** The area of the whole screen, from the last screen metrics of a [ScreenFrame]. */
+    private val screenArea: Rect = Rect()
     /** Check conditions and tell if they are fulfilled. */
-    private val conditionsVerifier = ConditionsVerifier(processingState, imageDetector, bitmapSupplier, progressListener)
+    private val conditionsVerifier =
+        ConditionsVerifier(processingState, imageDetector, bitmapSupplier, yielder, speculativeEventCount, screenArea)
+    /** Tells which image events are detected on each screen image. */
+    private val imageEventsScheduler = ImageEventsScheduler(screenStatesGatingEnabled)
+    /** Measures the latency of the reaction to each screen image. */
+    private val latencyTracker = LatencyTracker()
     /** Execute the detected event actions. */
     private val actionExecutor = ActionExecutor(
         androidExecutor = androidExecutor,
         processingState = processingState,
         randomize = randomize,
         unblockWorkaroundEnabled = unblockWorkaroundEnabled,
-    )
+        latencyTracker = latencyTracker,
+        gestureBatchingEnabled = gestureBatchingEnabled,
+    ).apply { prepareGestures(imageEvents + triggerEvents) }
 
     /** Tells if the screen metrics have been invalidated and should be updated. */
     private var invalidateScreenMetrics = true
+    /** The quality of the screen metrics, the [detectionQuality] reduced by [setDetectionQualityFactor]. */
+    private var effectiveDetectionQuality: Double = detectionQuality.toDouble()
+    /** Number of images processed, for the periodic update of the conditions order. */
+    private var processedImageCount = 0L
+    /** The listener of the image events processing of the current screen image, null if it is not sampled. */
+    private var frameListener: ScenarioProcessingListener? = null
+    /** The image events processed on the current screen image, for a [ScenarioProcessingListener.isBatchedProgress]. */
+    private val frameEventResults: MutableList<ImageEventResult> = mutableListOf()
+    /** The areas of the screen processed by the detector, empty for the whole screen. */
+    private var detectionAreas: List<Rect> = emptyList()
+    /** True if an event has been fulfilled on the current screen image. */
+    private var isEventFulfilled = false
+    /**
+     * True if the last screen image has been completely verified without any fulfilled event, and only a change of the
+     * screen content can fulfil one. See [awaitScreenChange].
+     */
+    private var isScreenChangeAwaitable = false
+    /** True if screen images have been set in the detector by [awaitScreenChange] since the last verification. */
+    private var isScreenIngestedWhileWaiting = false
+    /** All image conditions of the scenario, prepared by the detector each time the screen metrics are updated. */
+    private val imageConditions: List<ImageCondition> =
+        imageEvents.flatMap { it.conditions }.distinctBy { it.getValidId() }
+    /** The image conditions set as idle in the detector by [updateIdleConditions]. */
+    private var idleConditionIds: Set<Long> = emptySet()
+    /** The events state version [areEnabledImageEventsAlwaysScheduled] have been computed for. */
+    private var alwaysScheduledEventsVersion: Long = -1
+    /** True if all enabled image events are detected on each screen image, see [isScreenChangeAwaitable]. */
+    private var areEnabledImageEventsAlwaysScheduled: Boolean = false
 
     fun onScenarioStart(context: Context) {
         processingState.onProcessingStarted(context)
@@ -84,6 +169,37 @@ internal class ScenarioProcessor(
         invalidateScreenMetrics = true
     }
 
+    /** @return the latencies of the stages of the reaction to the screen images processed so far. */
+    fun getLatencyStatistics(): LatencyStatistics =
+        latencyTracker.getStatistics()
+
+    /**
+     * Reduce the quality of the detection, the screen metrics are updated for the next image.
+     *
+     * @param factor the factor applied to the scenario detection quality, 1 for the scenario one.
+     */
+    fun setDetectionQualityFactor(factor: Double) {
+        val quality = (detectionQuality * factor).coerceAtLeast(DETECTION_QUALITY_MIN.toDouble())
+        if (quality == effectiveDetectionQuality) return
+
+        effectiveDetectionQuality = quality
+        invalidateScreenMetrics()
+    }
+
+    /** @return true if no image event is enabled, the screen images are then not used by the processing. */
+    fun areAllImageEventsDisabled(): Boolean =
+        processingState.areAllImageEventsDisabled()
+
+    /**
+     * Process the trigger events without any screen image, while all image events are disabled.
+     * The screen metrics and the conditions prepared in the detector are kept as is for the next image.
+     */
+    suspend fun processWithoutScreen(): Unit = process(
+        setScreenMetrics = {},
+        setupDetection = { true },
+        prepareNextDetection = {},
+    )
+
     /**
      * Find an event with the conditions fulfilled on the current image.
      *
@@ -91,12 +207,183 @@ internal class ScenarioProcessor(
      *
      * @return the first Event with all conditions fulfilled, or null if none has been found.
      */
-    suspend fun process(screenFrame: Bitmap) {
+    suspend fun process(screenFrame: Bitmap): Unit = process(
+        setScreenMetrics = {
+            imageDetector.setScreenMetrics(processingTag, screenFrame, effectiveDetectionQuality)
+        },
+        setupDetection = {
+            imageDetector.setupDetection(screenFrame)
+        },
+        prepareNextDetection = {},
+    )
+
+    /**
+     * Find an event with the conditions fulfilled on the current image.
+     * The pixels of the frame are read directly by the detector, without copy.
+     *
+     * @param screenFrame the frame containing the current screen display.
+     * @param actionsScope the scope executing the actions overlapping the detection of the next frames. Null to
+     *                     always execute the actions before returning.
+     * @param acquireNextFrame acquire the next frame, once the current one is set in the detector. The returned frame
+     *                         is processed in the background while the conditions are detected on the current one, and
+     *                         should be the next frame provided to this method.
+     */
+    suspend fun process(
+        screenFrame: ScreenFrame,
+        actionsScope: CoroutineScope? = null,
+        acquireNextFrame: suspend () -> ScreenFrame? = { null },
+    ): Unit = process(
+        captureTimestampNs = screenFrame.timestampNs,
+        actionsScope = actionsScope?.takeIf { actionsOverlapEnabled },
+        deadlineNs = if (maxFrameAgeMs > 0) screenFrame.latestTimeNs + maxFrameAgeMs * NANOS_PER_MILLI else 0,
+        setScreenMetrics = {
+            screenArea.set(0, 0, screenFrame.screenWidth, screenFrame.screenHeight)
+            imageDetector.setScreenMetrics(
+                processingTag, screenFrame.screenWidth, screenFrame.screenHeight, effectiveDetectionQuality)
+        },
+        setupDetection = {
+            imageDetector.setupDetection(
+                screenFrame.buffer,
+                screenFrame.width,
+                screenFrame.height,
+                screenFrame.rowStride,
+                screenFrame.timestampNs,
+            )
+        },
+        prepareNextDetection = {
+            acquireNextFrame()?.let { nextFrame ->
+                imageDetector.prepareDetection(
+                    nextFrame.buffer, nextFrame.width, nextFrame.height, nextFrame.rowStride, nextFrame.timestampNs)
+            }
+        },
+    )
+
+    /**
+     * Find an event with the conditions fulfilled on the frame acquired in the native screen reader of the detector,
+     * see [ImageDetector.openScreenReader]. No java object is created for the frame.
+     *
+     * @param timestampNs the rendering time of the frame, returned by [ImageDetector.acquireScreenReaderFrame].
+     * @param screenWidth the width of the screen in the frame, in pixels.
+     * @param screenHeight the height of the screen in the frame, in pixels.
+     * @param actionsScope the scope executing the actions overlapping the detection of the next frames. Null to
+     *                     always execute the actions before returning.
+     */
+    suspend fun processScreenReaderFrame(
+        timestampNs: Long,
+        screenWidth: Int,
+        screenHeight: Int,
+        actionsScope: CoroutineScope? = null,
+    ): Unit = process(
+        captureTimestampNs = timestampNs,
+        actionsScope = actionsScope?.takeIf { actionsOverlapEnabled },
+        deadlineNs = if (maxFrameAgeMs > 0) System.nanoTime() + maxFrameAgeMs * NANOS_PER_MILLI else 0,
+        setScreenMetrics = {
+            screenArea.set(0, 0, screenWidth, screenHeight)
+            imageDetector.setScreenMetrics(processingTag, screenWidth, screenHeight, effectiveDetectionQuality)
+        },
+        setupDetection = imageDetector::setupDetectionFromScreenReader,
+        prepareNextDetection = {},
+    )
+
+    /**
+     * Wait for the screen content to change in the detection areas, if the events can't be fulfilled before.
+     *
+     * Once the last frame has been completely verified without any fulfilled event, with no trigger events and no
+     * detection intervals, detecting the events again on the same content would give the same results. The following
+     * frames are then only set in the detector for their tile signatures, without detecting any condition, until the
+     * detection areas change or [SCREEN_CHANGE_TIMEOUT_MS] have elapsed. The next [process] call detects all events
+     * again.
+     *
+     * @param firstFrame the frame acquired during the last [process] call, if any. Set in the detector first.
+     * @param acquireNextFrame wait for the next frame and acquire it, null if there is none yet.
+     *
+     * @return true if the frames have been waited for, [firstFrame] is then already set. False if the events can be
+     *         fulfilled on the current content.
+     */
+    suspend fun awaitScreenChange(firstFrame: ScreenFrame?, acquireNextFrame: suspend () -> ScreenFrame?): Boolean {
+        if (!isScreenChangeAwaitable || invalidateScreenMetrics || screenArea.isEmpty) return false
+        isScreenChangeAwaitable = false
+
+        val waitArea =
+            if (detectionAreas.isEmpty()) Rect(screenArea)
+            else Rect(detectionAreas.first()).apply { detectionAreas.forEach { area -> union(area) } }
+
+        coroutineScope {
+            // The frames must be set once the wait has started, their changes would be missed otherwise
+            val waitStarted = CompletableDeferred<Unit>()
+            val screenChange = async(Dispatchers.IO) {
+                waitStarted.complete(Unit)
+                imageDetector.waitForRegionChange(waitArea, SCREEN_CHANGE_THRESHOLD, SCREEN_CHANGE_TIMEOUT_MS)
+            }
+            waitStarted.await()
+
+            var lastFrame: ScreenFrame? = null
+            var frame = firstFrame ?: acquireNextFrame()
+            while (screenChange.isActive) {
+                if (frame != null && frame !== lastFrame) {
+                    imageDetector.setupDetection(
+                        frame.buffer, frame.width, frame.height, frame.rowStride, frame.timestampNs)
+                    isScreenIngestedWhileWaiting = true
+                    lastFrame = frame
+                }
+                frame = acquireNextFrame()
+            }
+        }
+
+        return true
+    }
+
+    /**
+     * Drop the next frame acquired during the last [process] call. Must be called before releasing it without
+     * processing it.
+     */
+    fun cancelNextFramePreparation() {
+        imageDetector.cancelDetectionPreparation()
+    }
+
+    /**
+     * Find an event with the conditions fulfilled on the current image.
+     *
+     * @param captureTimestampNs the rendering time of the current image in the [System.nanoTime] time base, or
+     *                           [NO_TIME] if it is unknown.
+     * @param deadlineNs the time after which the image is dropped, in the [System.nanoTime] time base. 0 for none.
+     * @param actionsScope the scope executing the actions of the image events overlapping the detection, if any.
+     * @param setScreenMetrics set the screen metrics of the detector for the current image.
+     * @param setupDetection set the current image in the detector, returning true if it is unchanged.
+     * @param prepareNextDetection start the preparation of the next image in the detector, if any.
+     */
+    private suspend fun process(
+        captureTimestampNs: Long = NO_TIME,
+        deadlineNs: Long = 0,
+        actionsScope: CoroutineScope? = null,
+        setScreenMetrics: () -> Unit,
+        setupDetection: () -> Boolean,
+        prepareNextDetection: suspend () -> Unit,
+    ) {
+        // The first image includes the preparation of the conditions, traced for the detection cold start
+        if (processedImageCount != 0L) {
+            processFrame(captureTimestampNs, deadlineNs, actionsScope, setScreenMetrics, setupDetection,
+                prepareNextDetection)
+        } else traceAsyncSection(TRACE_SECTION_FIRST_FRAME) {
+            processFrame(captureTimestampNs, deadlineNs, actionsScope, setScreenMetrics, setupDetection,
+                prepareNextDetection)
+        }
+    }
+
+    private suspend fun processFrame(
+        captureTimestampNs: Long,
+        deadlineNs: Long,
+        actionsScope: CoroutineScope?,
+        setScreenMetrics: () -> Unit,
+        setupDetection: () -> Boolean,
+        prepareNextDetection: suspend () -> Unit,
+    ) {
         // No more events enabled, there is nothing more to do. Stop the detection.
         if (processingState.areAllEventsDisabled()) {
             onStopRequested()
             return
         }
+        latencyTracker.onFrameProcessingStarted(captureTimestampNs)
 
         // Handle all trigger events enabled during previous processing
         if (!processingState.areAllTriggerEventsDisabled()) {
@@ -104,19 +391,49 @@ internal class ScenarioProcessor(
                 actionExecutor.executeActions(triggerEvent, results)
             }
         }
+        isEventFulfilled = false
 
         // Reset any values that needs to be reset for each iteration
         // After the triggers to let them handle changes, before the image processing to start capturing values before
         processingState.clearIterationState()
 
-        // Handle the image detection
-        progressListener?.onImageEventsProcessingStarted()
+        // Handle the image detection, only listened on the sampled screen images
+        frameListener = progressListener?.takeIf { listener ->
+            processedImageCount % listener.progressSamplingPeriod.coerceAtLeast(1) == 0L
+        }
+        conditionsVerifier.progressListener = frameListener?.takeUnless { it.isBatchedProgress }
+        frameListener?.onImageEventsProcessingStarted()
         if (!processingState.areAllImageEventsDisabled()) {
-            processImageEvents(screenFrame, processingState.getEnabledImageEvents()) { imageEvent, results ->
-                actionExecutor.executeActions(imageEvent, results)
+            processImageEvents(
+                setScreenMetrics,
+                setupDetection,
+                prepareNextDetection,
+                processingState.getEnabledImageEvents(),
+                deadlineNs,
+            ) { imageEvent, results ->
+                isEventFulfilled = true
+                latencyTracker.onFrameDetected()
+                if (actionsScope == null) actionExecutor.executeActions(imageEvent, results)
+                else actionExecutor.executeActionsOverlapped(actionsScope, imageEvent, results)
+            }
+        }
+        latencyTracker.onFrameDetected()
+        updateConditionStatistics()
+        isScreenChangeAwaitable = screenChangeWaitEnabled && !isEventFulfilled
+                && (deadlineNs <= 0 || System.nanoTime() <= deadlineNs)
+                && processingState.areAllTriggerEventsDisabled()
+                && !processingState.areAllImageEventsDisabled()
+                && areEnabledImageEventsAlwaysScheduled()
+        frameListener?.let { listener ->
+            if (listener.isBatchedProgress) {
+                listener.onImageEventsProcessed(frameEventResults.toList())
+                frameEventResults.clear()
             }
+            listener.onImageEventsProcessingCompleted()
         }
-        progressListener?.onImageEventsProcessingCompleted()
+
+        // Once the actions have changed the events state, before the next image
+        updateIdleConditions()
 
         // Loop is completed
         actionExecutor.onScenarioLoopFinished()
@@ -124,13 +441,26 @@ internal class ScenarioProcessor(
         return
     }
 
+    private fun areEnabledImageEventsAlwaysScheduled(): Boolean {
+        val eventsVersion = processingState.getEnabledEventsVersion()
+        if (eventsVersion != alwaysScheduledEventsVersion) {
+            areEnabledImageEventsAlwaysScheduled =
+                imageEventsScheduler.isAlwaysScheduled(processingState.getEnabledImageEvents())
+            alwaysScheduledEventsVersion = eventsVersion
+        }
+
+        return areEnabledImageEventsAlwaysScheduled
+    }
+
     private suspend fun processTriggerEvents(
         events: Collection<TriggerEvent>,
         onFulfilled: suspend (TriggerEvent, ConditionsResult) -> Unit,
     ) {
+        val eventsVersion = processingState.getEnabledEventsVersion()
         for (triggerEvent in events) {
             // Enabled state of the event might have changed during the loop
-            if (!processingState.isEventEnabled(triggerEvent.id.databaseId)) continue
+            if (processingState.getEnabledEventsVersion() != eventsVersion
+                && !processingState.isEventEnabled(triggerEvent.id.databaseId)) continue
 
             // No conditions ? This should not happen, skip this event
             if (triggerEvent.conditions.isEmpty()) continue
@@ -145,33 +475,209 @@ internal class ScenarioProcessor(
     }
 
     private suspend fun processImageEvents(
-        screenFrame: Bitmap,
+        setScreenMetrics: () -> Unit,
+        setupDetection: () -> Boolean,
+        prepareNextDetection: suspend () -> Unit,
         events: Collection<ImageEvent>,
+        deadlineNs: Long,
         onFulfilled: suspend (ImageEvent, ConditionsResult) -> Unit,
     ) {
         // Set the current screen image
         if (invalidateScreenMetrics) {
-            imageDetector.setScreenMetrics(processingTag, screenFrame, detectionQuality.toDouble())
+            traceSection(TRACE_SECTION_SCREEN_METRICS, setScreenMetrics)
             invalidateScreenMetrics = false
+            imageEventsScheduler.onScreenMetricsChanged()
+            // With the new metrics, the conditions can be processed before their first detection
+            prepareConditions()
         }
-        imageDetector.setupDetection(screenFrame)
+        // Before the screen image, it is only processed in the areas of the enabled conditions
+        updateDetectionAreas(events)
+        // When the screen haven't changed, the image conditions results of the previous frame are still valid. The
+        // images set while waiting for a change are compared with each other, not with the previous frame.
+        val isUnchanged = setupDetection() && !isScreenIngestedWhileWaiting
+        isScreenIngestedWhileWaiting = false
+        conditionsVerifier.onScreenImageChanged(isUnchanged = isUnchanged)
+        latencyTracker.onFrameIngested()
+        val screenState =
+            if (imageEventsScheduler.isScreenStateNeeded()) imageDetector.classifyScreenState()
+            else SCREEN_STATE_UNKNOWN
+        // The next image is processed in the background while the conditions are searched in this one
+        prepareNextDetection()
+        imageEventsScheduler.onScreenImageChanged(System.currentTimeMillis(), screenState)
+        yielder.startSlice()
+
+        // Without per event listener, all events can be verified at once. Their results are kept for the batched one.
+        val eventListener = conditionsVerifier.progressListener
+        val onVerified = if (frameListener?.isBatchedProgress == true) ::addFrameEventResult else null
+        if (eventListener == null && conditionsVerifier.verifyImageEvents(
+                events, imageEventsScheduler, deadlineNs, onVerified, onFulfilled)) return
 
         // Check all events
         for (imageEvent in events) {
             // No conditions ? This should not happen, skip this event
             if (imageEvent.conditions.isEmpty()) continue
+            // Detected less often than each screen image, it is not its turn
+            if (!imageEventsScheduler.isScheduled(imageEvent)) continue
+            // Too old to act upon, the next events are still due for the next screen image
+            if (deadlineNs > 0 && System.nanoTime() > deadlineNs) return
 
-            progressListener?.onImageEventProcessingStarted(imageEvent)
+            imageEventsScheduler.onEventDetected(imageEvent)
+            eventListener?.onImageEventProcessingStarted(imageEvent)
             val results = conditionsVerifier.verifyConditions(imageEvent.conditionOperator, imageEvent.conditions)
-            progressListener?.onImageEventProcessingCompleted(imageEvent, results)
+            eventListener?.onImageEventProcessingCompleted(imageEvent, results)
+            onVerified?.invoke(imageEvent, results)
 
             if (results.fulfilled == true) {
+                imageEventsScheduler.onEventFulfilled(imageEvent)
                 onFulfilled(imageEvent, results)
                 if (!imageEvent.keepDetecting) return
             }
 
+            // Stop processing if requested, letting the other coroutines run once in a while
+            yielder.onItemProcessed()
+        }
+    }
+
+    private fun addFrameEventResult(event: ImageEvent, results: ConditionsResult) {
+        frameEventResults.add(ImageEventResult(event, results.copy()))
+    }
+
+    /**
+     * Process all image conditions of the scenario in the detector for the current screen metrics, by batches of
+     * [CONDITIONS_PREPARATION_BATCH_SIZE], notifying the progress after each batch. The bitmaps are only loaded for
+     * the conditions that can't be read from their file, all bitmaps of a batch at once.
+     */
+    private suspend fun prepareConditions(): Unit = traceAsyncSection(TRACE_SECTION_PREPARE_CONDITIONS) {
+        // Defined first, the rotated images of these conditions are created with their processed images
+        val rotatedConditions = imageConditions.filter { condition -> condition.rotationCount > 1 }
+        if (rotatedConditions.isNotEmpty()) {
+            imageDetector.setConditionRotations(
+                LongArray(rotatedConditions.size) { index -> rotatedConditions[index].getValidId() },
+                IntArray(rotatedConditions.size) { index -> rotatedConditions[index].rotationCount },
+            )
+        }
+        // The conditions matched with the pixel differences instead of the correlation
+        val differenceConditions =
+            imageConditions.filter { condition -> condition.matchingMetric != METRIC_CCOEFF_NORMED }
+        if (differenceConditions.isNotEmpty()) {
+            imageDetector.setConditionMetrics(
+                LongArray(differenceConditions.size) { index -> differenceConditions[index].getValidId() },
+                IntArray(differenceConditions.size) { index -> differenceConditions[index].matchingMetric },
+            )
+        }
+
+        var preparedCount = 0
+        onConditionsPrepared?.invoke(ConditionsPreparation(totalCount = imageConditions.size))
+        imageConditions.chunked(CONDITIONS_PREPARATION_BATCH_SIZE).forEach { conditions ->
+            val conditionIds = LongArray(conditions.size) { index -> conditions[index].getValidId() }
+            // Read natively from their files when possible, without any bitmap
+            if (bitmapFileSupplier != null) prepareConditionFiles(conditionIds, conditions, bitmapFileSupplier)
+
+            // Packed and cached conditions are loaded natively, their bitmap doesn't need to be decoded
+            val isCached = conditions.map { condition -> imageDetector.isConditionCached(condition.getValidId()) }
+            val conditionBitmaps = traceAsyncSection(TRACE_SECTION_LOAD_BITMAPS) {
+                coroutineScope {
+                    conditions.mapIndexed { index, condition ->
+                        async { if (isCached[index]) null else bitmapSupplier(condition) }
+                    }.awaitAll()
+                }
+            }.toTypedArray()
+
+            preparedCount += imageDetector.prepareConditions(conditionIds, conditionBitmaps)
+            progressListener?.onConditionsPrepared(preparedCount, imageConditions.size)
+            onConditionsPrepared?.invoke(ConditionsPreparation(preparedCount, imageConditions.size))
+
             // Stop processing if requested
             yield()
         }
+        onConditionsPrepared?.invoke(ConditionsPreparation(preparedCount, imageConditions.size, isReady = true))
+    }
+
+    private fun prepareConditionFiles(
+        conditionIds: LongArray,
+        conditions: List<ImageCondition>,
+        fileSupplier: (ImageCondition) -> String?,
+    ) {
+        val conditionPaths = conditions.map { condition ->
+            if (imageDetector.isConditionCached(condition.getValidId())) null
+            else fileSupplier(condition)
+        }.toTypedArray()
+        if (conditionPaths.all { it == null }) return
+
+        val conditionSizes = IntArray(conditions.size * 2)
+        conditions.forEachIndexed { index, condition ->
+            conditionSizes[index * 2] = condition.area.width()
+            conditionSizes[index * 2 + 1] = condition.area.height()
+        }
+        imageDetector.prepareConditionFiles(conditionIds, conditionPaths, conditionSizes)
+    }
+
+    /**
+     * Keep the image conditions that can't be detected until the events state changes compacted in the detector.
+     * The conditions of the disabled events that can be enabled by a ToggleEvent action of an enabled event are not
+     * idle: their processed images are restored ahead of their first detection, enabling their event never delays the
+     * detection of a screen image. Updated once the events state has changed, at the end of the screen image.
+     */
+    private fun updateIdleConditions() {
+        if (!idleConditionsCompactionEnabled || !processingState.consumeEventsStateChange()) return
+
+        val conditionIds = processingState.getIdleImageConditionIds()
+        if (conditionIds == idleConditionIds) return
+
+        imageDetector.setIdleConditions(conditionIds.toLongArray())
+        idleConditionIds = conditionIds
+    }
+
+    /**
+     * Limit the processing of the screen images to the areas of the conditions of the enabled events, if none of them
+     * is detected on the whole screen.
+     */
+    private fun updateDetectionAreas(events: Collection<ImageEvent>) {
+        val areas = mutableListOf<Rect>()
+        events.forEach { imageEvent ->
+            imageEvent.conditions.forEach { condition ->
+                // An anchored condition can be anywhere its anchor can locate it
+                val anchor = condition.getAnchor(imageEvent.conditions)
+                val area =
+                    if (anchor != null) condition.getAnchoredDetectionArea(anchor)
+                    else condition.getDetectionArea()
+                // A condition detected on the whole screen requires the whole screen image
+                if (area == null) return setDetectionAreas(emptyList())
+                if (area !in areas) areas.add(area)
+            }
+        }
+        setDetectionAreas(areas)
+    }
+
+    private fun setDetectionAreas(areas: List<Rect>) {
+        if (areas == detectionAreas) return
+
+        imageDetector.setDetectionAreas(areas)
+        detectionAreas = areas
+    }
+
+    /** Get the native conditions statistics for the conditions order, and for each sampled image if it is listened. */
+    private suspend fun updateConditionStatistics() {
+        processedImageCount++
+        val isOrderUpdated = processedImageCount % CONDITIONS_ORDER_UPDATE_PERIOD == 0L
+        if (!isOrderUpdated && frameListener == null) return
+
+        val statistics = imageDetector.getConditionStatistics()
+        if (isOrderUpdated) conditionsVerifier.onConditionStatisticsUpdated(statistics)
+        frameListener?.let { listener ->
+            listener.onConditionStatisticsUpdated(statistics)
+            listener.onCacheStatisticsUpdated(imageDetector.getCacheStatistics())
+        }
     }
 }
+
+/** Number of processed images between two updates of the conditions verification order. */
+private const val CONDITIONS_ORDER_UPDATE_PERIOD = 30L
+/** Number of conditions processed at once by the detector threads when the screen metrics are updated. */
+private const val CONDITIONS_PREPARATION_BATCH_SIZE = 8
+/** The part of the detection areas that must change to stop [ScenarioProcessor.awaitScreenChange]: any change. */
+private const val SCREEN_CHANGE_THRESHOLD = 0.0
+/** The maximum duration of [ScenarioProcessor.awaitScreenChange], the events are detected again after it. */
+private const val SCREEN_CHANGE_TIMEOUT_MS = 1_000L
+/** Number of nanoseconds in a millisecond. */
+private const val NANOS_PER_MILLI = 1_000_000L
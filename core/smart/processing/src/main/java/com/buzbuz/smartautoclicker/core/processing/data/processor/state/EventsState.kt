@@ -17,6 +17,7 @@
 package com.buzbuz.smartautoclicker.core.processing.data.processor.state
 
 import com.buzbuz.smartautoclicker.core.base.interfaces.sortedByPriority
+import com.buzbuz.smartautoclicker.core.domain.model.action.ToggleEvent
 import com.buzbuz.smartautoclicker.core.domain.model.event.Event
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.domain.model.event.TriggerEvent
@@ -30,6 +31,8 @@ interface IEventsState {
 
     fun getEnabledImageEvents(): Collection<ImageEvent>
     fun getEnabledTriggerEvents(): Collection<TriggerEvent>
+    fun getEnabledEventsVersion(): Long
+    fun getIdleImageConditionIds(): Set<Long>
 
     fun enableAll()
     fun enableEvent(eventId: Long)
@@ -52,6 +55,10 @@ interface EventStateListener {
  *  - the enabled events map: those are the events that will be processed.
  *  - the disabled events map: those are the events that will be skipped.
  * Handles the ToggleEvent actions and move the events between those maps accordingly.
+ *
+ * The enabled events lists are kept in processing order until an event is enabled or disabled, they are not filtered
+ * and sorted again for each screen image. A new list is created after each change, the previous one can still be
+ * iterated while the events state changes.
  */
 internal class EventsState(
     imageEvents: List<ImageEvent>,
@@ -59,9 +66,9 @@ internal class EventsState(
 ) : IEventsState {
 
     /** Monitor the state of all image events. */
-    private val imageEventList: EventList<ImageEvent> = EventList(imageEvents)
+    private val imageEventList: EventList<ImageEvent> = EventList(imageEvents) { events -> events.sortedByPriority() }
     /** Monitor the state of all trigger events. */
-    private val triggerEventList: EventList<TriggerEvent> = EventList(triggerEvents)
+    private val triggerEventList: EventList<TriggerEvent> = EventList(triggerEvents) { events -> events.toList() }
 
     override fun setEventStateListener(listener: EventStateListener) {
         triggerEventList.eventEnabledListener = listener
@@ -78,13 +85,51 @@ internal class EventsState(
         imageEventList.areAllEventsDisabled()
 
     override fun getEnabledImageEvents(): Collection<ImageEvent> =
-        imageEventList.getEnabledEvents().sortedByPriority()
+        imageEventList.getEnabledEvents()
 
     override fun areAllTriggerEventsDisabled(): Boolean =
         triggerEventList.areAllEventsDisabled()
 
     override fun getEnabledTriggerEvents(): Collection<TriggerEvent> =
-        triggerEventList.getEnabledEvents().toList()
+        triggerEventList.getEnabledEvents()
+
+    /** @return a value changing each time an event is enabled or disabled, and the enabled events lists with it. */
+    override fun getEnabledEventsVersion(): Long =
+        imageEventList.version + triggerEventList.version
+
+    /**
+     * Get the image conditions that can't be detected before the next change of the events state: the ones of the
+     * disabled image events that the [ToggleEvent] actions of the enabled events can't enable.
+     * A condition shared with an event that can be detected is not idle.
+     */
+    override fun getIdleImageConditionIds(): Set<Long> {
+        val enableableEventIds = mutableSetOf<Long>()
+        (imageEventList.getEnabledEvents() + triggerEventList.getEnabledEvents()).forEach { event ->
+            event.actions.forEach { action ->
+                if (action !is ToggleEvent) return@forEach
+
+                if (action.toggleAll) {
+                    if (action.toggleAllType.isEnabling()) return emptySet()
+                } else action.eventToggles.forEach { eventToggle ->
+                    if (eventToggle.toggleType.isEnabling()) {
+                        eventToggle.targetEventId?.let { enableableEventIds.add(it.databaseId) }
+                    }
+                }
+            }
+        }
+
+        val detectableConditionIds = mutableSetOf<Long>()
+        val idleConditionIds = mutableSetOf<Long>()
+        imageEventList.getAllEvents().forEach { event ->
+            val eventId = event.getValidId()
+            val conditionIds =
+                if (imageEventList.isEventEnabled(eventId) || eventId in enableableEventIds) detectableConditionIds
+                else idleConditionIds
+            event.conditions.forEach { condition -> conditionIds.add(condition.getValidId()) }
+        }
+
+        return idleConditionIds - detectableConditionIds
+    }
 
     override fun enableEvent(eventId: Long) {
         imageEventList.enableEvent(eventId)
@@ -117,7 +162,11 @@ internal class EventsState(
     }
 }
 
-private class EventList<T : Event>(events: List<T>) {
+private class EventList<T : Event>(
+    events: List<T>,
+    /** Put the enabled events in their processing order. */
+    private val order: (Collection<T>) -> Collection<T>,
+) {
 
     /** Set of enabled events ids. */
     private val enabledEventsMap: MutableMap<Long, T> = mutableMapOf()
@@ -129,8 +178,15 @@ private class EventList<T : Event>(events: List<T>) {
         }
     }
 
+    /** The enabled events, in processing order. Null once an event has been enabled or disabled. */
+    private var orderedEnabledEvents: Collection<T>? = null
+
     var eventEnabledListener: EventStateListener? = null
 
+    /** Incremented each time an event is enabled or disabled. */
+    var version: Long = 0
+        private set
+
     fun isEventEnabled(eventDbId: Long): Boolean =
         enabledEventsMap.containsKey(eventDbId)
 
@@ -138,13 +194,17 @@ private class EventList<T : Event>(events: List<T>) {
         enabledEventsMap.isEmpty()
 
     fun getEnabledEvents(): Collection<T> =
-        enabledEventsMap.values
+        orderedEnabledEvents ?: order(enabledEventsMap.values).also { orderedEnabledEvents = it }
+
+    fun getAllEvents(): Collection<T> =
+        eventsMap.values
 
     fun enableEvent(eventId: Long) {
         if (enabledEventsMap.containsKey(eventId)) return
         val event = eventsMap[eventId] ?: return
 
         enabledEventsMap[eventId] = event
+        onEnabledEventsChanged()
         eventEnabledListener?.onEventEnabled(event)
     }
 
@@ -153,6 +213,7 @@ private class EventList<T : Event>(events: List<T>) {
         val event = eventsMap[eventId] ?: return
 
         enabledEventsMap.remove(eventId)
+        onEnabledEventsChanged()
         eventEnabledListener?.onEventDisabled(event)
     }
 
@@ -172,4 +233,13 @@ private class EventList<T : Event>(events: List<T>) {
     fun toggleAll() {
         eventsMap.keys.forEach(::toggleEvent)
     }
+
+    private fun onEnabledEventsChanged() {
+        orderedEnabledEvents = null
+        version++
+    }
 }
+
+/** @return true if this toggle type can enable a disabled event. */
+private fun ToggleEvent.ToggleType?.isEnabling(): Boolean =
+    this == ToggleEvent.ToggleType.ENABLE || this == ToggleEvent.ToggleType.TOGGLE
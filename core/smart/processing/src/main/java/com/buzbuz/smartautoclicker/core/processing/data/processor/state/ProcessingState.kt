@@ -32,6 +32,9 @@ internal class ProcessingState(
     private val timersState: TimersState = TimersState(triggerEvents),
 ) : IBroadcastsState by broadcastsState, ICountersState by countersState, ITimersState by timersState, IEventsState by eventsState {
 
+    /** True if an event has been enabled or disabled since the last [consumeEventsStateChange]. */
+    private var isEventsStateChanged: Boolean = true
+
     init {
         eventsState.setEventStateListener(object : EventStateListener {
             override fun onEventEnabled(event: Event): Unit = this@ProcessingState.onEventEnabled(event)
@@ -53,13 +56,19 @@ internal class ProcessingState(
         broadcastsState.clearReceivedBroadcast()
     }
 
+    /** @return true if an event has been enabled or disabled since the previous call, always true for the first one. */
+    fun consumeEventsStateChange(): Boolean =
+        isEventsStateChanged.also { isEventsStateChanged = false }
+
     private fun onEventEnabled(event: Event) {
+        isEventsStateChanged = true
         event.conditions.forEach { condition ->
             if (condition is TriggerCondition.OnTimerReached) timersState.setTimerStartToNow(condition)
         }
     }
 
     private fun onEventDisabled(event: Event) {
+        isEventsStateChanged = true
         event.conditions.forEach { condition ->
             if (condition is TriggerCondition.OnTimerReached) timersState.setTimerToDisabled(condition.getValidId())
         }
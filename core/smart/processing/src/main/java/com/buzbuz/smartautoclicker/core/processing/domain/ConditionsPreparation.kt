@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.domain
+
+/**
+ * The progress of the processing of the image conditions by the detector, done before the first screen image is
+ * detected and each time the screen metrics change.
+ *
+ * @param preparedCount the number of conditions ready to be detected.
+ * @param totalCount the number of image conditions of the scenario.
+ * @param isReady true once all conditions that can be prepared are, and the screen images are detected.
+ */
+data class ConditionsPreparation(
+    val preparedCount: Int = 0,
+    val totalCount: Int = 0,
+    val isReady: Boolean = false,
+)
@@ -0,0 +1,31 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.domain
+
+/**
+ * The detection quality suggested for a scenario, computed from the last screen images of its last detection when
+ * the detection quality tuning is enabled.
+ *
+ * @param scenarioId the database identifier of the detected scenario.
+ * @param detectionQuality the detection quality of the scenario during the detection.
+ * @param suggestedQuality the lowest detection quality giving the same detection results.
+ */
+data class DetectionQualitySuggestion(
+    val scenarioId: Long,
+    val detectionQuality: Int,
+    val suggestedQuality: Int,
+)
@@ -93,6 +93,15 @@ class DetectionRepository @Inject constructor(
     val detectionState: Flow<DetectionState> = detectorEngine.state
         .mapNotNull { it.toDetectionState() }
 
+    /** The progress of the processing of the image conditions, before the first screen image is detected. */
+    val conditionsPreparation: Flow<ConditionsPreparation> = detectorEngine.conditionsPreparation
+
+    /**
+     * The detection quality suggested for the last scenario detected with the detection quality tuning setting
+     * enabled. Computed once its detection is stopped, null until then.
+     */
+    val detectionQualitySuggestion: Flow<DetectionQualitySuggestion?> = detectorEngine.detectionQualitySuggestion
+
     /**
      * Tells if the detection can be started or not.
      * It requires at least one event enabled on start to be started.
@@ -128,9 +137,26 @@ class DetectionRepository @Inject constructor(
 
     fun getScenarioId(): Identifier? = _scenarioId.value
 
+    /**
+     * Notify of the app displayed in the foreground. The detection is suspended while the app it was started on is
+     * not displayed, if enabled in the settings. Can be called from any thread.
+     *
+     * @param packageName the package of the app.
+     */
+    fun onForegroundAppChanged(packageName: String) {
+        detectorEngine.onForegroundAppChanged(packageName)
+    }
+
     fun isRunning(): Boolean =
         detectorEngine.state.value == DetectorState.DETECTING
 
+    /**
+     * Get the latencies of the reaction to the screen frames, from their rendering to the dispatch of the gestures.
+     * @return the latencies since the start of the running detection, or null if it is not running.
+     */
+    fun getLatencyStatistics(): LatencyStatistics? =
+        detectorEngine.getLatencyStatistics()
+
     fun startScreenRecord(context: Context, resultCode: Int, data: Intent) {
         actionExecutor?.let { executor ->
             detectorEngine.startScreenRecord(context, resultCode, data, executor) {
@@ -150,7 +176,8 @@ class DetectionRepository @Inject constructor(
             scenario = scenario,
             imageEvents = events,
             triggerEvents = triggerEvents,
-            bitmapSupplier = scenarioRepository::getConditionBitmap,
+            bitmapSupplier = scenarioRepository::loadConditionBitmap,
+            bitmapFileSupplier = scenarioRepository::getConditionBitmapFilePath,
             progressListener = progressListener,
         )
 
@@ -219,8 +246,10 @@ class DetectionRepository @Inject constructor(
             scenario = elementTry.scenario,
             imageEvents = elementTry.imageEvents,
             triggerEvents = elementTry.triggerEvents,
-            bitmapSupplier = scenarioRepository::getConditionBitmap,
+            bitmapSupplier = scenarioRepository::loadConditionBitmap,
+            bitmapFileSupplier = scenarioRepository::getConditionBitmapFilePath,
             progressListener = listener,
+            isTry = true,
         )
     }
 
@@ -235,6 +264,13 @@ class DetectionRepository @Inject constructor(
                 .append("canStartDetection=${canStartDetection.dumpWithTimeout() ?: false}; ")
                 .append("detectionState=${detectionState.dumpWithTimeout() ?: DetectionState.INACTIVE}; ")
                 .println()
+
+            detectorEngine.getFrameTelemetry()?.let { telemetry ->
+                append(contentPrefix).println("- frameTelemetry:")
+                telemetry.lineSequence()
+                    .filter { line -> line.isNotEmpty() }
+                    .forEach { line -> append(contentPrefix).append("    ").println(line) }
+            }
         }
     }
 }
@@ -18,6 +18,7 @@ package com.buzbuz.smartautoclicker.core.processing.domain
 
 import android.graphics.Point
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
+import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 
 interface IConditionsResult {
 
@@ -37,4 +38,27 @@ interface ImageConditionResult : ConditionResult {
     val condition: ImageCondition
     val position: Point
     val confidenceRate: Double
+
+    /**
+     * The duration of the native detection of the condition, on the screen image it has been detected on, in
+     * nanoseconds. Only measured for the conditions detected all at once, 0 for the others.
+     */
+    val detectionDurationNs: Long
+        get() = 0L
+}
+
+/**
+ * The processing of an image event on a screen image, see [ScenarioProcessingListener.onImageEventsProcessed].
+ *
+ * @param event the processed image event.
+ * @param results the results of its processed conditions.
+ */
+data class ImageEventResult(
+    val event: ImageEvent,
+    val results: IConditionsResult,
+) {
+
+    /** The duration of the native detection of the processed conditions, in nanoseconds. */
+    val detectionDurationNs: Long
+        get() = results.getAllResults().sumOf { result -> (result as? ImageConditionResult)?.detectionDurationNs ?: 0L }
 }
@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.domain
+
+/** The stages of the reaction to a screen frame, from its rendering to the dispatch of the gesture it triggers. */
+enum class LatencyStage {
+    /** From the rendering of the frame by the compositor to the start of its processing. */
+    CAPTURE,
+    /** From the start of the processing of the frame to its setup in the detector. */
+    INGEST,
+    /** From the setup of the frame in the detector to its first fulfilled event, or to the end of its detection. */
+    DETECT,
+    /** From the first fulfilled event of the frame to the dispatch of the first gesture of its actions. */
+    DISPATCH,
+    /** From the rendering of the frame to the dispatch of the first gesture it triggers. */
+    END_TO_END,
+}
+
+/**
+ * The latency histogram of a [LatencyStage].
+ * The percentiles are estimated with the upper bound of their bucket, limited by the maximum measured latency.
+ *
+ * @param count the number of measures.
+ * @param meanNs the mean latency, in nanoseconds.
+ * @param medianNs the median latency, in nanoseconds.
+ * @param p95Ns the 95th percentile of the latency, in nanoseconds.
+ * @param maxNs the maximum latency, in nanoseconds.
+ * @param bucketCounts the number of measures in each bucket of [LATENCY_BUCKET_BOUNDS_NS], with a last one for the
+ *                     measures above the last bound.
+ */
+data class StageLatency(
+    val count: Long,
+    val meanNs: Long,
+    val medianNs: Long,
+    val p95Ns: Long,
+    val maxNs: Long,
+    val bucketCounts: List<Long>,
+)
+
+/**
+ * The latencies of the stages of a detection session.
+ *
+ * @param stages the histogram of each stage. A stage without measures is omitted.
+ */
+data class LatencyStatistics(
+    val stages: Map<LatencyStage, StageLatency>,
+)
+
+/** The upper bounds of the latency histograms buckets, in nanoseconds. Doubles from 250 microseconds to 512ms. */
+val LATENCY_BUCKET_BOUNDS_NS: List<Long> =
+    List(LATENCY_BUCKET_COUNT) { index -> LATENCY_FIRST_BUCKET_BOUND_NS shl index }
+
+/** The number of bounded buckets in the latency histograms. */
+private const val LATENCY_BUCKET_COUNT = 12
+/** The upper bound of the first latency bucket, in nanoseconds. */
+private const val LATENCY_FIRST_BUCKET_BOUND_NS = 250_000L
@@ -18,6 +18,9 @@ package com.buzbuz.smartautoclicker.core.processing.domain
 
 import android.content.Context
 
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+import com.buzbuz.smartautoclicker.core.detection.DetectorCacheStatistics
+
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.domain.model.event.TriggerEvent
@@ -25,6 +28,21 @@ import com.buzbuz.smartautoclicker.core.domain.model.scenario.Scenario
 
 interface ScenarioProcessingListener {
 
+    /**
+     * The listener is notified of the image events processing of one screen image out of this number. The other ones
+     * are processed as without listener, keeping the measured workload close to the one of a detection without it.
+     */
+    val progressSamplingPeriod: Int
+        get() = 1
+
+    /**
+     * True to be notified of the image events processing once per screen image, with [onImageEventsProcessed],
+     * instead of the per event and per condition callbacks. The conditions are then detected as without listener, and
+     * their durations are measured by the native detector.
+     */
+    val isBatchedProgress: Boolean
+        get() = false
+
     suspend fun onSessionStarted(
         context: Context,
         scenario: Scenario,
@@ -32,6 +50,14 @@ interface ScenarioProcessingListener {
         triggerEvents: List<TriggerEvent>,
     ) = Unit
 
+    /**
+     * Called while the image conditions are processed for new screen metrics, before their detection.
+     *
+     * @param preparedCount the number of conditions ready to be detected.
+     * @param totalCount the number of image conditions of the scenario.
+     */
+    suspend fun onConditionsPrepared(preparedCount: Int, totalCount: Int) = Unit
+
     suspend fun onTriggerEventProcessingStarted(event: TriggerEvent) = Unit
     suspend fun onTriggerEventProcessingCompleted(event: TriggerEvent, results: List<ConditionResult>) = Unit
 
@@ -48,5 +74,20 @@ interface ScenarioProcessingListener {
 
     suspend fun onImageEventsProcessingCompleted() = Unit
 
+    /**
+     * Called before [onImageEventsProcessingCompleted] when [isBatchedProgress] is true, with the image events
+     * processed on the screen image in processing order.
+     */
+    suspend fun onImageEventsProcessed(results: List<ImageEventResult>) = Unit
+
+    /** Called after each image events processing with the statistics of the recent searches of each condition. */
+    suspend fun onConditionStatisticsUpdated(statistics: List<ConditionStatistics>) = Unit
+
+    /** Called after each [onConditionStatisticsUpdated], with the statistics of the native detector caches. */
+    suspend fun onCacheStatisticsUpdated(statistics: List<DetectorCacheStatistics>) = Unit
+
+    /** Called once the detection is stopped, before [onSessionEnded], with the latencies of the whole session. */
+    suspend fun onLatencyStatisticsUpdated(statistics: LatencyStatistics) = Unit
+
     suspend fun onSessionEnded() = Unit
 }
\ No newline at end of file
@@ -206,6 +206,21 @@ class ActionExecutorTests {
         assertActionGesture(gestureCaptor.lastValue)
     }
 
+    @Test
+    fun execute_prepared_gestures_reused() = runTest {
+        val event = getNewDefaultEvent(actions = listOf(getNewDefaultClickUserPos(1), getNewDefaultSwipe(2)))
+        actionExecutor.prepareGestures(listOf(event))
+
+        actionExecutor.executeActions(event, ConditionsResult())
+        actionExecutor.executeActions(event, ConditionsResult())
+
+        val gestureCaptor = argumentCaptor<GestureDescription>()
+        verify(mockAndroidExecutor, times(4)).executeGesture(gestureCaptor.capture())
+        gestureCaptor.allValues.forEach(::assertActionGesture)
+        assertSame("Click gesture built again", gestureCaptor.allValues[0], gestureCaptor.allValues[2])
+        assertSame("Swipe gesture built again", gestureCaptor.allValues[1], gestureCaptor.allValues[3])
+    }
+
     @Test
     fun execute_onePause() = runTest {
         val pause = getNewDefaultPause(1)
@@ -239,6 +254,35 @@ class ActionExecutorTests {
         assertActionGesture(gestureCaptor.lastValue)
     }
 
+    @Test
+    fun execute_mixed_batched() = runTest {
+        val click = getNewDefaultClickUserPos(1)
+        val pause = getNewDefaultPause(2)
+        val swipe = getNewDefaultSwipe(3)
+        val gestureCaptor = argumentCaptor<GestureDescription>()
+        actionExecutor = ActionExecutor(
+            mockAndroidExecutor,
+            mockProcessingState,
+            randomize = false,
+            gestureBatchingEnabled = true,
+        )
+
+        // Execute the actions.
+        actionExecutor.executeActions(
+            getNewDefaultEvent(actions = listOf(click, pause, swipe)),
+            ConditionsResult(),
+        )
+
+        // Verify the gestures have been dispatched at once, the pause being the delay between the strokes
+        verify(mockAndroidExecutor, times(1)).executeGesture(gestureCaptor.capture())
+        gestureCaptor.lastValue.let { gesture ->
+            assertEquals("Gesture should contains two strokes", 2, gesture.strokeCount)
+            assertEquals("First stroke start time is invalid", 0, gesture.getStroke(0).startTime)
+            assertEquals("Second stroke start time is invalid", TEST_DURATION * 2, gesture.getStroke(1).startTime)
+            assertEquals("Second stroke duration is invalid", TEST_DURATION, gesture.getStroke(1).duration)
+        }
+    }
+
     @Test
     fun execute_click_delay() = runTest {
         val executionDurationMs = 10L
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.tests
+
+import android.graphics.Rect
+import android.os.Build
+
+import androidx.test.ext.junit.runners.AndroidJUnit4
+
+import com.buzbuz.smartautoclicker.core.base.identifier.Identifier
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+import com.buzbuz.smartautoclicker.core.domain.model.AND
+import com.buzbuz.smartautoclicker.core.domain.model.EXACT
+import com.buzbuz.smartautoclicker.core.domain.model.OR
+import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
+import com.buzbuz.smartautoclicker.core.processing.data.processor.ConditionsOrderer
+
+import org.junit.Assert.assertEquals
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+
+import org.robolectric.annotation.Config
+
+/** Test the [ConditionsOrderer] class. */
+@RunWith(AndroidJUnit4::class)
+@Config(sdk = [Build.VERSION_CODES.Q])
+class ConditionsOrdererTests {
+
+    private companion object {
+        private val TEST_EVENT_ID = Identifier(databaseId = 42L)
+        private const val TEST_NAME = "Condition name"
+
+        private const val CHEAP_CONDITION_ID = 1L
+        private const val EXPENSIVE_CONDITION_ID = 2L
+
+        private const val CHEAP_COST_NS = 1_000_000L
+        private const val EXPENSIVE_COST_NS = 10_000_000L
+
+        fun newCondition(id: Long) = ImageCondition(
+            Identifier(databaseId = id), TEST_EVENT_ID, TEST_NAME, 0, "path", Rect(), 10, EXACT, true, null)
+
+        fun newStatistics(id: Long, medianDurationNs: Long) =
+            ConditionStatistics(id, 1, 1, medianDurationNs, medianDurationNs, medianDurationNs, medianDurationNs, 1, 0)
+    }
+
+    private val expensiveCondition = newCondition(EXPENSIVE_CONDITION_ID)
+    private val cheapCondition = newCondition(CHEAP_CONDITION_ID)
+    private val conditions = listOf(expensiveCondition, cheapCondition)
+
+    private lateinit var conditionsOrderer: ConditionsOrderer
+
+    @Before
+    fun setUp() {
+        conditionsOrderer = ConditionsOrderer()
+    }
+
+    @Test
+    fun declarationOrder_withoutStatistics() {
+        assertEquals(conditions, conditionsOrderer.getOrderedConditions(AND, conditions))
+        assertEquals(conditions, conditionsOrderer.getOrderedConditions(OR, conditions))
+    }
+
+    @Test
+    fun declarationOrder_withPartialStatistics() {
+        conditionsOrderer.onConditionStatisticsUpdated(listOf(newStatistics(CHEAP_CONDITION_ID, CHEAP_COST_NS)))
+
+        assertEquals(conditions, conditionsOrderer.getOrderedConditions(AND, conditions))
+    }
+
+    @Test
+    fun cheapestFirst_sameHitRate() {
+        conditionsOrderer.onConditionStatisticsUpdated(listOf(
+            newStatistics(CHEAP_CONDITION_ID, CHEAP_COST_NS),
+            newStatistics(EXPENSIVE_CONDITION_ID, EXPENSIVE_COST_NS),
+        ))
+
+        assertEquals(listOf(cheapCondition, expensiveCondition), conditionsOrderer.getOrderedConditions(AND, conditions))
+    }
+
+    @Test
+    fun and_rarelyFulfilledFirst() {
+        // Same cost, the cheap one is always fulfilled and never stops the AND verification
+        repeat(20) {
+            conditionsOrderer.onConditionVerified(CHEAP_CONDITION_ID, isFulfilled = true)
+            conditionsOrderer.onConditionVerified(EXPENSIVE_CONDITION_ID, isFulfilled = false)
+        }
+        conditionsOrderer.onConditionStatisticsUpdated(listOf(
+            newStatistics(CHEAP_CONDITION_ID, CHEAP_COST_NS),
+            newStatistics(EXPENSIVE_CONDITION_ID, CHEAP_COST_NS * 2),
+        ))
+
+        assertEquals(
+            listOf(expensiveCondition, cheapCondition),
+            conditionsOrderer.getOrderedConditions(AND, conditions),
+        )
+    }
+
+    @Test
+    fun or_oftenFulfilledFirst() {
+        repeat(20) {
+            conditionsOrderer.onConditionVerified(CHEAP_CONDITION_ID, isFulfilled = false)
+            conditionsOrderer.onConditionVerified(EXPENSIVE_CONDITION_ID, isFulfilled = true)
+        }
+        conditionsOrderer.onConditionStatisticsUpdated(listOf(
+            newStatistics(CHEAP_CONDITION_ID, CHEAP_COST_NS),
+            newStatistics(EXPENSIVE_CONDITION_ID, CHEAP_COST_NS * 2),
+        ))
+
+        assertEquals(
+            listOf(expensiveCondition, cheapCondition),
+            conditionsOrderer.getOrderedConditions(OR, conditions),
+        )
+    }
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.tests
+
+import com.buzbuz.smartautoclicker.core.processing.data.processor.CooperativeYielder
+
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.cancel
+import kotlinx.coroutines.launch
+import kotlinx.coroutines.test.runTest
+
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Test
+
+/** Test the [CooperativeYielder] class. */
+@OptIn(ExperimentalCoroutinesApi::class)
+class CooperativeYielderTests {
+
+    private companion object {
+        private const val LONG_SLICE_NS = 60_000_000_000L
+    }
+
+    @Test
+    fun noYieldBeforeSliceEnd() = runTest {
+        val yielder = CooperativeYielder(LONG_SLICE_NS)
+        var otherCoroutineRan = false
+        launch { otherCoroutineRan = true }
+
+        repeat(3) { yielder.onItemProcessed() }
+
+        assertFalse(otherCoroutineRan)
+    }
+
+    @Test
+    fun yieldAfterSliceEnd() = runTest {
+        val yielder = CooperativeYielder(0)
+        var otherCoroutineRan = false
+        launch { otherCoroutineRan = true }
+
+        yielder.onItemProcessed()
+
+        assertTrue(otherCoroutineRan)
+    }
+
+    @Test
+    fun cancellationBeforeSliceEnd() = runTest {
+        val yielder = CooperativeYielder(LONG_SLICE_NS)
+        var itemProcessed = false
+
+        launch {
+            cancel()
+            yielder.onItemProcessed()
+            itemProcessed = true
+        }.join()
+
+        assertFalse(itemProcessed)
+    }
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.tests
+
+import com.buzbuz.smartautoclicker.core.detection.SCREEN_STATE_UNKNOWN
+import com.buzbuz.smartautoclicker.core.processing.data.processor.ImageEventsScheduler
+import com.buzbuz.smartautoclicker.core.processing.data.processor.SCREEN_STATE_EXPLORATION_INTERVAL
+import com.buzbuz.smartautoclicker.core.processing.data.processor.SCREEN_STATE_LEARNING_IMAGES
+import com.buzbuz.smartautoclicker.core.processing.utils.ProcessingData
+
+import org.junit.Assert.assertEquals
+import org.junit.Assert.assertFalse
+import org.junit.Assert.assertTrue
+import org.junit.Test
+
+/** Test the screen states gating of the [ImageEventsScheduler] class. */
+class ImageEventsSchedulerTests {
+
+    private companion object {
+        private const val STATE_MENU = 1
+        private const val STATE_GAME = 2
+    }
+
+    private val fulfilledEvent = ProcessingData.newEvent(id = 1L)
+    private val otherEvent = ProcessingData.newEvent(id = 2L)
+
+    /** Notify the scheduler for one image of the state, fulfilling [fulfilledEvent] on it. */
+    private fun ImageEventsScheduler.onImage(screenState: Int, fulfill: Boolean = false) {
+        onScreenImageChanged(0L, screenState)
+        if (fulfill) onEventFulfilled(fulfilledEvent)
+    }
+
+    /** Notify the scheduler for the learning images of the state, fulfilling [fulfilledEvent] on the first one. */
+    private fun ImageEventsScheduler.learnState(screenState: Int) {
+        onImage(screenState, fulfill = true)
+        repeat(SCREEN_STATE_LEARNING_IMAGES - 1) { onImage(screenState) }
+    }
+
+    @Test
+    fun allEventsScheduledWhileLearning() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = true)
+
+        repeat(SCREEN_STATE_LEARNING_IMAGES) {
+            scheduler.onImage(STATE_MENU)
+            assertTrue(scheduler.isScheduled(fulfilledEvent))
+            assertTrue(scheduler.isScheduled(otherEvent))
+        }
+    }
+
+    @Test
+    fun onlyFulfilledEventsScheduledOnceLearned() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = true)
+        scheduler.learnState(STATE_MENU)
+
+        scheduler.onImage(STATE_MENU)
+        assertTrue(scheduler.isScheduled(fulfilledEvent))
+        assertFalse(scheduler.isScheduled(otherEvent))
+        assertFalse(scheduler.isAlwaysScheduled(listOf(fulfilledEvent, otherEvent)))
+    }
+
+    @Test
+    fun allEventsScheduledOnExploration() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = true)
+        scheduler.learnState(STATE_MENU)
+
+        var exploredImages = 0
+        repeat(SCREEN_STATE_EXPLORATION_INTERVAL) {
+            scheduler.onImage(STATE_MENU)
+            if (scheduler.isScheduled(otherEvent)) exploredImages++
+        }
+        assertEquals(1, exploredImages)
+    }
+
+    @Test
+    fun fulfilledEventsAreKeptPerState() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = true)
+        scheduler.learnState(STATE_MENU)
+
+        // A new state learns its own events
+        scheduler.onImage(STATE_GAME)
+        assertTrue(scheduler.isScheduled(otherEvent))
+
+        scheduler.onImage(STATE_MENU)
+        assertFalse(scheduler.isScheduled(otherEvent))
+    }
+
+    @Test
+    fun unknownStateSchedulesAllEvents() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = true)
+        scheduler.learnState(STATE_MENU)
+
+        scheduler.onImage(SCREEN_STATE_UNKNOWN)
+        assertTrue(scheduler.isScheduled(fulfilledEvent))
+        assertTrue(scheduler.isScheduled(otherEvent))
+    }
+
+    @Test
+    fun screenMetricsChangeForgetsStates() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = true)
+        scheduler.learnState(STATE_MENU)
+
+        scheduler.onScreenMetricsChanged()
+        scheduler.onImage(STATE_MENU)
+        assertTrue(scheduler.isScheduled(otherEvent))
+    }
+
+    @Test
+    fun gatingDisabled() {
+        val scheduler = ImageEventsScheduler(screenStatesGatingEnabled = false)
+        scheduler.learnState(STATE_MENU)
+
+        scheduler.onImage(STATE_MENU)
+        assertFalse(scheduler.isScreenStateNeeded())
+        assertTrue(scheduler.isScheduled(otherEvent))
+        assertTrue(scheduler.isAlwaysScheduled(listOf(fulfilledEvent, otherEvent)))
+    }
+}
@@ -55,12 +55,16 @@ import org.junit.Assert
 import org.junit.Before
 import org.junit.Test
 import org.junit.runner.RunWith
+import org.mockito.ArgumentMatchers.anyList
 import org.mockito.Mock
 import org.mockito.Mockito
 import org.mockito.Mockito.mock
+import org.mockito.Mockito.never
+import org.mockito.Mockito.times
 import org.mockito.Mockito.verify
 import org.mockito.Mockito.verifyNoInteractions
 import org.mockito.MockitoAnnotations
+import org.mockito.kotlin.any
 import org.mockito.kotlin.argumentCaptor
 import org.robolectric.annotation.Config
 import org.mockito.Mockito.`when` as mockWhen
@@ -136,8 +140,8 @@ class ScenarioProcessorTests {
 
         val pass = if (isDetected) TEST_DETECTION_OK else TEST_DETECTION_KO
         when (detectionType) {
-            EXACT -> mockWhen(mockImageDetector.detectCondition(conditionBitmap, area, threshold)).thenReturn(pass)
-            WHOLE_SCREEN -> mockWhen(mockImageDetector.detectCondition(conditionBitmap, threshold)).thenReturn(pass)
+            EXACT -> mockWhen(mockImageDetector.detectCondition(condition.getValidId(), conditionBitmap, area, threshold)).thenReturn(pass)
+            WHOLE_SCREEN -> mockWhen(mockImageDetector.detectCondition(condition.getValidId(), conditionBitmap, threshold)).thenReturn(pass)
         }
 
         condition
@@ -1165,4 +1169,136 @@ class ScenarioProcessorTests {
         verify(mockImageDetector).setupDetection(mockScreenBitmap)
         verifyNoInteractions(mockAndroidExecutor, mockEndListener)
     }
+
+    @Test
+    fun detectionAreas_allConditionsInArea() = runTest {
+        val condition1 = createTestCondition(
+            TEST_CONDITION_PATH_1,
+            TEST_CONDITION_AREA_1,
+            TEST_CONDITION_THRESHOLD_1,
+            EXACT,
+            isDetected = false,
+            shouldBeOnScreen = true,
+        )
+        val condition2 = createTestCondition(
+            TEST_CONDITION_PATH_2,
+            TEST_CONDITION_AREA_2,
+            TEST_CONDITION_THRESHOLD_2,
+            EXACT,
+            isDetected = false,
+            shouldBeOnScreen = true,
+        )
+        val event = newEvent(
+            operator = AND,
+            conditions = listOf(condition1, condition2),
+            actions = listOf(newDefaultClickAction()),
+        )
+
+        scenarioProcessor = createNewScenarioProcessor(listOf(event), emptyList())
+        scenarioProcessor.process(mockScreenBitmap)
+        scenarioProcessor.process(mockScreenBitmap)
+
+        verify(mockImageDetector).setDetectionAreas(listOf(TEST_CONDITION_AREA_1, TEST_CONDITION_AREA_2))
+    }
+
+    @Test
+    fun detectionAreas_oneConditionOnWholeScreen() = runTest {
+        val condition1 = createTestCondition(
+            TEST_CONDITION_PATH_1,
+            TEST_CONDITION_AREA_1,
+            TEST_CONDITION_THRESHOLD_1,
+            EXACT,
+            isDetected = false,
+            shouldBeOnScreen = true,
+        )
+        val condition2 = createTestCondition(
+            TEST_CONDITION_PATH_2,
+            TEST_CONDITION_AREA_2,
+            TEST_CONDITION_THRESHOLD_2,
+            WHOLE_SCREEN,
+            isDetected = false,
+            shouldBeOnScreen = true,
+        )
+        val event = newEvent(
+            operator = AND,
+            conditions = listOf(condition1, condition2),
+            actions = listOf(newDefaultClickAction()),
+        )
+
+        scenarioProcessor = createNewScenarioProcessor(listOf(event), emptyList())
+        scenarioProcessor.process(mockScreenBitmap)
+
+        verify(mockImageDetector, never()).setDetectionAreas(anyList())
+    }
+
+    @Test
+    fun prepareConditions_onScreenMetricsUpdate() = runTest {
+        val condition1 = createTestCondition(
+            TEST_CONDITION_PATH_1,
+            TEST_CONDITION_AREA_1,
+            TEST_CONDITION_THRESHOLD_1,
+            EXACT,
+            isDetected = false,
+            shouldBeOnScreen = true,
+        )
+        val event = newEvent(
+            operator = AND,
+            conditions = listOf(condition1),
+            actions = listOf(newDefaultClickAction()),
+        )
+
+        scenarioProcessor = createNewScenarioProcessor(listOf(event), emptyList())
+        scenarioProcessor.process(mockScreenBitmap)
+        scenarioProcessor.process(mockScreenBitmap)
+        scenarioProcessor.invalidateScreenMetrics()
+        scenarioProcessor.process(mockScreenBitmap)
+
+        val conditionIdsCaptor = argumentCaptor<LongArray>()
+        verify(mockImageDetector, times(2)).prepareConditions(conditionIdsCaptor.capture(), any())
+        conditionIdsCaptor.allValues.forEach { conditionIds ->
+            Assert.assertArrayEquals(longArrayOf(condition1.getValidId()), conditionIds)
+        }
+    }
+
+    @Test
+    fun areAllImageEventsDisabled_enabledEvent() = runTest {
+        val condition1 = createTestCondition(
+            TEST_CONDITION_PATH_1,
+            TEST_CONDITION_AREA_1,
+            TEST_CONDITION_THRESHOLD_1,
+            EXACT,
+            isDetected = false,
+            shouldBeOnScreen = true,
+        )
+        val event1 = newEvent(conditions = listOf(condition1), actions = listOf(newDefaultClickAction()))
+
+        scenarioProcessor = createNewScenarioProcessor(listOf(event1), emptyList())
+
+        Assert.assertFalse(scenarioProcessor.areAllImageEventsDisabled())
+    }
+
+    @Test
+    fun processWithoutScreen_allImageEventsDisabled() = runTest {
+        val condition1 = createTestCondition(
+            TEST_CONDITION_PATH_1,
+            TEST_CONDITION_AREA_1,
+            TEST_CONDITION_THRESHOLD_1,
+            EXACT,
+            isDetected = true,
+            shouldBeOnScreen = true,
+        )
+        val event1 = newEvent(
+            conditions = listOf(condition1),
+            actions = listOf(newDefaultClickAction()),
+            enableOnStart = false,
+        )
+
+        scenarioProcessor = createNewScenarioProcessor(listOf(event1), emptyList())
+        Assert.assertTrue(scenarioProcessor.areAllImageEventsDisabled())
+        scenarioProcessor.processWithoutScreen()
+
+        verify(mockImageDetector, never()).setupDetection(any<Bitmap>())
+        verify(mockImageDetector, never()).prepareConditions(any(), any())
+        verify(mockEndListener).onStopRequested()
+    }
 }
\ No newline at end of file
@@ -16,10 +16,14 @@
  */
 package com.buzbuz.smartautoclicker.core.processing.tests
 
+import android.graphics.Rect
 import android.os.Build
 
 import androidx.test.ext.junit.runners.AndroidJUnit4
 
+import com.buzbuz.smartautoclicker.core.domain.model.EXACT
+import com.buzbuz.smartautoclicker.core.domain.model.action.ToggleEvent
+import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.processing.data.processor.state.EventsState
 import com.buzbuz.smartautoclicker.core.processing.utils.ProcessingData
 
@@ -168,4 +172,97 @@ class ScenarioStateTests {
 
         Assert.assertTrue("Event not enabled", scenarioState.getEnabledImageEvents().contains(changingEvent))
     }
+
+    @Test
+    fun idle_conditions_of_disabled_events() {
+        val eventList = listOf(
+            newConditionEvent(id = 1L, conditionId = 11L, enableOnStart = true),
+            newConditionEvent(id = 2L, conditionId = 12L, enableOnStart = false),
+        )
+
+        val scenarioState = EventsState(eventList, emptyList())
+
+        Assert.assertEquals("Invalid idle conditions", setOf(12L), scenarioState.getIdleImageConditionIds())
+    }
+
+    @Test
+    fun idle_conditions_enableable_by_toggle() {
+        val eventList = listOf(
+            newConditionEvent(id = 1L, conditionId = 11L, enableOnStart = true, actions = listOf(
+                ProcessingData.newToggleEvent(ToggleEvent.ToggleType.ENABLE, targetEventId = 2L),
+                ProcessingData.newToggleEvent(ToggleEvent.ToggleType.DISABLE, targetEventId = 3L),
+            )),
+            newConditionEvent(id = 2L, conditionId = 12L, enableOnStart = false),
+            newConditionEvent(id = 3L, conditionId = 13L, enableOnStart = false),
+        )
+
+        val scenarioState = EventsState(eventList, emptyList())
+
+        Assert.assertEquals("Invalid idle conditions", setOf(13L), scenarioState.getIdleImageConditionIds())
+    }
+
+    @Test
+    fun idle_conditions_updated_on_state_change() {
+        val eventList = listOf(
+            newConditionEvent(id = 1L, conditionId = 11L, enableOnStart = true),
+            newConditionEvent(id = 2L, conditionId = 12L, enableOnStart = false, actions = listOf(
+                ProcessingData.newToggleEvent(ToggleEvent.ToggleType.TOGGLE, targetEventId = 3L),
+            )),
+            newConditionEvent(id = 3L, conditionId = 13L, enableOnStart = false),
+        )
+
+        val scenarioState = EventsState(eventList, emptyList())
+        Assert.assertEquals("Invalid idle conditions", setOf(12L, 13L), scenarioState.getIdleImageConditionIds())
+
+        scenarioState.enableEvent(2L)
+        Assert.assertEquals("Invalid idle conditions", emptySet<Long>(), scenarioState.getIdleImageConditionIds())
+    }
+
+    @Test
+    fun no_idle_conditions_with_toggle_all() {
+        val eventList = listOf(
+            newConditionEvent(id = 1L, conditionId = 11L, enableOnStart = true, actions = listOf(
+                ProcessingData.newToggleEvent(ToggleEvent.ToggleType.ENABLE),
+            )),
+            newConditionEvent(id = 2L, conditionId = 12L, enableOnStart = false),
+        )
+
+        val scenarioState = EventsState(eventList, emptyList())
+
+        Assert.assertEquals("Invalid idle conditions", emptySet<Long>(), scenarioState.getIdleImageConditionIds())
+    }
+
+    @Test
+    fun enabled_events_kept_until_state_change() {
+        val eventList = listOf(
+            ProcessingData.newEvent(id = 1L, enableOnStart = true),
+            ProcessingData.newEvent(id = 2L, enableOnStart = false),
+        )
+
+        val scenarioState = EventsState(eventList, emptyList())
+        val enabledEvents = scenarioState.getEnabledImageEvents()
+        val version = scenarioState.getEnabledEventsVersion()
+        scenarioState.enableEvent(1L)
+
+        Assert.assertSame("Enabled events computed again", enabledEvents, scenarioState.getEnabledImageEvents())
+        Assert.assertEquals("Invalid events version", version, scenarioState.getEnabledEventsVersion())
+
+        scenarioState.enableEvent(2L)
+
+        Assert.assertNotEquals("Invalid events version", version, scenarioState.getEnabledEventsVersion())
+        Assert.assertEquals("Previous enabled events modified", 1, enabledEvents.size)
+        Assert.assertEquals("Invalid enabled events count", 2, scenarioState.getEnabledImageEvents().size)
+    }
+
+    private fun newConditionEvent(
+        id: Long,
+        conditionId: Long,
+        enableOnStart: Boolean,
+        actions: List<ToggleEvent> = emptyList(),
+    ): ImageEvent = ProcessingData.newEvent(
+        id = id,
+        actions = actions,
+        conditions = listOf(ProcessingData.newCondition("toto", Rect(), 0, EXACT, id = conditionId)),
+        enableOnStart = enableOnStart,
+    )
 }
\ No newline at end of file
@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.core.processing.tests.benchmark
+
+import android.graphics.Bitmap
+import android.os.Build
+import androidx.test.ext.junit.runners.AndroidJUnit4
+import com.buzbuz.smartautoclicker.core.detection.DetectionResult
+import com.buzbuz.smartautoclicker.core.detection.ImageDetector
+import com.buzbuz.smartautoclicker.core.domain.model.SmartActionExecutor
+import com.buzbuz.smartautoclicker.core.domain.model.action.ChangeCounter.OperationType
+import com.buzbuz.smartautoclicker.core.processing.data.processor.ScenarioProcessor
+import com.buzbuz.smartautoclicker.core.processing.domain.ScenarioProcessingListener
+import com.buzbuz.smartautoclicker.core.processing.tests.processor.ProcessingTestData
+import com.buzbuz.smartautoclicker.core.processing.tests.processor.TestImageCondition
+import com.buzbuz.smartautoclicker.core.processing.tests.processor.TestScenario
+import java.lang.management.ManagementFactory
+import kotlin.time.Duration.Companion.minutes
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.ExperimentalCoroutinesApi
+import kotlinx.coroutines.test.StandardTestDispatcher
+import kotlinx.coroutines.test.resetMain
+import kotlinx.coroutines.test.runTest
+import kotlinx.coroutines.test.setMain
+import org.junit.After
+import org.junit.Assume.assumeTrue
+import org.junit.Before
+import org.junit.Test
+import org.junit.runner.RunWith
+import org.mockito.Mock
+import org.mockito.Mockito.RETURNS_DEFAULTS
+import org.mockito.Mockito.mock
+import org.mockito.MockitoAnnotations
+import org.mockito.stubbing.Answer
+import org.robolectric.annotation.Config
+
+
+/**
+ * Benchmark of the Kotlin orchestration cost of each screen image, without any native matching.
+ *
+ * The [ScenarioProcessor] runs on the mocks of the processing tests, with a detector answering each detection at once.
+ * The time of each frame is the one of [ScenarioProcessor.process], verifying the conditions of all events and
+ * executing the actions of the last one, and its allocations are the ones of the test thread. The workload is split
+ * across the events like a real scenario, so the cost can be compared with the native matching one as the number of
+ * conditions grows.
+ *
+ * Skipped by the unit tests, run it with:
+ *   ./gradlew :core:smart:processing:testDebugUnitTest -PprocessingBenchmark=true \
+ *       --tests "*OrchestrationBenchmarkTests"
+ */
+@OptIn(ExperimentalCoroutinesApi::class)
+@RunWith(AndroidJUnit4::class)
+@Config(sdk = [Build.VERSION_CODES.Q])
+class OrchestrationBenchmarkTests {
+
+    private companion object {
+        /** The system property enabling the benchmark, set from the build parameter of the same name. */
+        const val BENCHMARK_PROPERTY = "processingBenchmark"
+        /** Number of conditions of each event of the benchmarked scenarios. */
+        const val CONDITIONS_PER_EVENT = 5
+        /** Number of frames processed before measuring, so the JIT and the processing caches are warm. */
+        const val WARM_UP_FRAME_COUNT = 200
+        /** Number of measured frames. */
+        const val MEASURED_FRAME_COUNT = 1000
+        /** The counter incremented by the actions of the fulfilled events. */
+        const val COUNTER_NAME = "benchmark"
+    }
+
+    /** Provides the benchmarked scenarios.  */
+    private val testsData: ProcessingTestData = ProcessingTestData
+
+    @Mock private lateinit var mockAndroidExecutor: SmartActionExecutor
+
+    /** The conditions detected as absent, one per event so they are all verified. */
+    private val absentConditionIds: MutableSet<Long> = mutableSetOf()
+    /** The bitmaps supplied for each condition. */
+    private val conditionBitmaps: MutableMap<Long, Bitmap> = mutableMapOf()
+
+    /**
+     * Answers any detection with the same result, instead of the per condition stubs of the processing tests: the
+     * lookup of those stubs grows with the number of conditions, and would be measured as orchestration.
+     */
+    private val benchmarkImageDetector: ImageDetector = mock(ImageDetector::class.java, Answer { invocation ->
+        if (invocation.method.returnType == DetectionResult::class.java) {
+            DetectionResult(isDetected = invocation.getArgument<Long>(0) !in absentConditionIds)
+        } else {
+            RETURNS_DEFAULTS.answer(invocation)
+        }
+    })
+
+    /** The listener requesting the per condition progress, so the detections go through the mocked detector. */
+    private val progressListener: ScenarioProcessingListener = object : ScenarioProcessingListener {}
+
+    @Before
+    fun setUp() {
+        assumeTrue("Benchmark disabled", System.getProperty(BENCHMARK_PROPERTY).toBoolean())
+        MockitoAnnotations.openMocks(this)
+        Dispatchers.setMain(StandardTestDispatcher())
+    }
+
+    @After
+    fun tearDown() {
+        Dispatchers.resetMain()
+        testsData.reset()
+        absentConditionIds.clear()
+        conditionBitmaps.clear()
+    }
+
+    @Test
+    fun `Orchestration of 10 conditions`() = benchmarkOrchestration(conditionCount = 10)
+
+    @Test
+    fun `Orchestration of 100 conditions`() = benchmarkOrchestration(conditionCount = 100)
+
+    @Test
+    fun `Orchestration of 1000 conditions`() = benchmarkOrchestration(conditionCount = 1000)
+
+    private fun benchmarkOrchestration(conditionCount: Int) = runTest(timeout = 10.minutes) {
+        val scenarioProcessor = createScenarioProcessor(newBenchmarkScenario(conditionCount))
+        val screenBitmap = testsData.newMockedScreenBitmap()
+        repeat(WARM_UP_FRAME_COUNT) { scenarioProcessor.process(screenBitmap) }
+
+        // The processing runs on the test thread with the standard test dispatcher
+        val threadBean = ManagementFactory.getThreadMXBean() as com.sun.management.ThreadMXBean
+        val threadId = Thread.currentThread().id
+        val startBytes = threadBean.getThreadAllocatedBytes(threadId)
+        val startNs = System.nanoTime()
+        repeat(MEASURED_FRAME_COUNT) { scenarioProcessor.process(screenBitmap) }
+        val durationNs = System.nanoTime() - startNs
+        val allocatedBytes = threadBean.getThreadAllocatedBytes(threadId) - startBytes
+
+        println(
+            "Orchestration of $conditionCount conditions: " +
+                    "${durationNs / MEASURED_FRAME_COUNT / 1000} us/frame, " +
+                    "${allocatedBytes / MEASURED_FRAME_COUNT} bytes/frame"
+        )
+    }
+
+    private fun createScenarioProcessor(testScenario: TestScenario) =
+        ScenarioProcessor(
+            processingTag = "benchmark",
+            detectionQuality = testScenario.scenario.detectionQuality,
+            randomize = testScenario.scenario.randomize,
+            imageEvents = testScenario.imageEvents,
+            triggerEvents = testScenario.triggerEvents,
+            imageDetector = benchmarkImageDetector,
+            androidExecutor = mockAndroidExecutor,
+            bitmapSupplier = { condition -> conditionBitmaps[condition.getValidId()] },
+            onStopRequested = {},
+            progressListener = progressListener,
+        )
+
+    /**
+     * Create a scenario of image events with [CONDITIONS_PER_EVENT] conditions each. The last condition of all events
+     * but the last one is absent, so all events are verified for each frame and the last one executes its action.
+     */
+    private fun newBenchmarkScenario(conditionCount: Int): TestScenario {
+        val scenarioId = testsData.newScenarioId()
+        val eventCount = (conditionCount + CONDITIONS_PER_EVENT - 1) / CONDITIONS_PER_EVENT
+
+        val imageEvents = (0 until eventCount).map { eventIndex ->
+            val eventId = testsData.newEventId()
+            val eventConditionCount = minOf(CONDITIONS_PER_EVENT, conditionCount - eventIndex * CONDITIONS_PER_EVENT)
+            val conditions = (0 until eventConditionCount).map { testsData.newTestImageCondition(eventId) }
+            conditions.forEach { condition -> conditionBitmaps[condition.conditionId()] = condition.mockedBitmap }
+            if (eventIndex < eventCount - 1) absentConditionIds.add(conditions.last().conditionId())
+
+            testsData.newTestImageEvent(
+                eventId = eventId,
+                scenarioId = scenarioId,
+                conditions = conditions,
+                actions = listOf(testsData.newCounterAction(eventId, COUNTER_NAME, OperationType.ADD, 1)),
+            )
+        }
+
+        return testsData.newTestScenario(scenarioId = scenarioId, imageEvents = imageEvents)
+    }
+
+    private fun TestImageCondition.conditionId(): Long =
+        imageCondition.getValidId()
+}
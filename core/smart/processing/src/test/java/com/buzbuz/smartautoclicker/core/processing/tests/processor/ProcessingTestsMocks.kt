@@ -49,6 +49,7 @@ internal fun ImageDetector.mockDetectionResult(testCondition: TestImageCondition
     when (testCondition.imageCondition.detectionType) {
         EXACT -> `when`(
             detectCondition(
+                testCondition.imageCondition.getValidId(),
                 testCondition.mockedBitmap,
                 testCondition.imageCondition.area,
                 testCondition.imageCondition.threshold,
@@ -57,6 +58,7 @@ internal fun ImageDetector.mockDetectionResult(testCondition: TestImageCondition
 
         WHOLE_SCREEN -> `when`(
             detectCondition(
+                testCondition.imageCondition.getValidId(),
                 testCondition.mockedBitmap,
                 testCondition.imageCondition.threshold,
             )
@@ -64,6 +66,7 @@ internal fun ImageDetector.mockDetectionResult(testCondition: TestImageCondition
 
         IN_AREA -> `when`(
             detectCondition(
+                testCondition.imageCondition.getValidId(),
                 testCondition.mockedBitmap,
                 testCondition.imageCondition.detectionArea!!,
                 testCondition.imageCondition.threshold,
@@ -98,6 +101,7 @@ internal fun ImageDetector.verifyConditionNeverProcessed(testCondition: TestImag
     when (testCondition.imageCondition.detectionType) {
         EXACT -> verify(this, never())
             .detectCondition(
+                testCondition.imageCondition.getValidId(),
                 testCondition.mockedBitmap,
                 testCondition.imageCondition.area,
                 testCondition.imageCondition.threshold,
@@ -105,12 +109,14 @@ internal fun ImageDetector.verifyConditionNeverProcessed(testCondition: TestImag
 
         WHOLE_SCREEN -> verify(this, never())
             .detectCondition(
+                testCondition.imageCondition.getValidId(),
                 testCondition.mockedBitmap,
                 testCondition.imageCondition.threshold,
             )
 
         IN_AREA -> verify(this, never())
             .detectCondition(
+                testCondition.imageCondition.getValidId(),
                 testCondition.mockedBitmap,
                 testCondition.imageCondition.detectionArea!!,
                 testCondition.imageCondition.threshold,
@@ -23,6 +23,8 @@ import com.buzbuz.smartautoclicker.core.domain.model.ConditionOperator
 import com.buzbuz.smartautoclicker.core.domain.model.DetectionType
 import com.buzbuz.smartautoclicker.core.base.identifier.Identifier
 import com.buzbuz.smartautoclicker.core.domain.model.action.Action
+import com.buzbuz.smartautoclicker.core.domain.model.action.ToggleEvent
+import com.buzbuz.smartautoclicker.core.domain.model.action.toggleevent.EventToggle
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 
@@ -55,8 +57,9 @@ internal object ProcessingData {
         threshold: Int,
         @DetectionType detectionType: Int,
         shouldBeDetected: Boolean = true,
+        id: Long = 1L,
     ) = ImageCondition(
-        Identifier(databaseId = 1L),
+        Identifier(databaseId = id),
         Identifier(databaseId = 1L),
         "TOTO",
         0,
@@ -67,4 +70,24 @@ internal object ProcessingData {
         shouldBeDetected,
         null
     )
+
+    /** Instantiates a new toggle event action, toggling all events if [targetEventId] is null. */
+    fun newToggleEvent(
+        toggleType: ToggleEvent.ToggleType,
+        targetEventId: Long? = null,
+    ) = ToggleEvent(
+        id = Identifier(databaseId = 1L),
+        eventId = Identifier(databaseId = 1L),
+        priority = 0,
+        toggleAll = targetEventId == null,
+        toggleAllType = toggleType.takeIf { targetEventId == null },
+        eventToggles = targetEventId?.let { eventId ->
+            listOf(EventToggle(
+                id = Identifier(databaseId = 1L),
+                actionId = Identifier(databaseId = 1L),
+                targetEventId = Identifier(databaseId = eventId),
+                toggleType = toggleType,
+            ))
+        } ?: emptyList(),
+    )
 }
\ No newline at end of file
@@ -66,20 +66,15 @@ internal class BackupEngine(appDataDir: File, private val contentResolver: Conte
         withContext(Dispatchers.IO) {
             try {
                 ZipOutputStream(contentResolver.openOutputStream(zipFileUri)).use { zipStream ->
-                    dumbScenarios.forEach { dumbScenario ->
-                        Log.d(TAG, "Backup dumb scenario ${dumbScenario.scenario.id}")
-
-                        dumbBackupDataSource.addScenarioToZipFile(zipStream, dumbScenario, screenSize)
-
+                    // The json files of both types are named after the scenario id, they are not serialized together
+                    Log.d(TAG, "Backup ${dumbScenarios.size} dumb scenarios")
+                    dumbBackupDataSource.addScenariosToZipFile(zipStream, dumbScenarios, screenSize) {
                         currentProgress++
                         progress.onProgressChanged(currentProgress, smartScenarios.size)
                     }
 
-                    smartScenarios.forEach { completeScenario ->
-                        Log.d(TAG, "Backup smart scenario ${completeScenario.scenario.id}")
-
-                        smartBackupDataSource.addScenarioToZipFile(zipStream, completeScenario, screenSize)
-
+                    Log.d(TAG, "Backup ${smartScenarios.size} smart scenarios")
+                    smartBackupDataSource.addScenariosToZipFile(zipStream, smartScenarios, screenSize) {
                         currentProgress++
                         progress.onProgressChanged(currentProgress, smartScenarios.size)
                     }
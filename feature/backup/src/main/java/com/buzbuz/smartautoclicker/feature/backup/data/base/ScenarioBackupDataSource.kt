@@ -20,10 +20,17 @@ import android.graphics.Point
 import android.util.Log
 import androidx.annotation.CallSuper
 
+import com.buzbuz.smartautoclicker.core.bitmaps.ConditionContentHash
 import com.buzbuz.smartautoclicker.feature.backup.data.ext.readAndCopyEntryFile
 import com.buzbuz.smartautoclicker.feature.backup.data.ext.writeEntryFile
 
+import kotlinx.coroutines.Deferred
+import kotlinx.coroutines.Dispatchers
+import kotlinx.coroutines.async
+import kotlinx.coroutines.coroutineScope
+
 import java.io.File
+import java.util.zip.Deflater
 import java.util.zip.ZipEntry
 import java.util.zip.ZipInputStream
 import java.util.zip.ZipOutputStream
@@ -38,6 +45,12 @@ internal abstract class ScenarioBackupDataSource<Backup, BackupScenario>(private
     var failureCount = 0
         private set
 
+    /**
+     * The additional files of the backup already on the device under another name, with this name, mapped by their
+     * name in the backup.
+     */
+    private val _deduplicatedFileNames: MutableMap<String, String> = mutableMapOf()
+    protected val deduplicatedFileNames: Map<String, String> = _deduplicatedFileNames
 
     protected abstract val serializer: ScenarioBackupSerializer<Backup>
 
@@ -52,22 +65,58 @@ internal abstract class ScenarioBackupDataSource<Backup, BackupScenario>(private
     protected abstract fun getBackupZipFolderName(scenario: BackupScenario): String
     protected abstract fun getBackupAdditionalFilesPaths(scenario: BackupScenario): Set<String>
 
+    /**
+     * Get the name an additional file would have on the device if it was saved with this content, to find the one
+     * already saved with it.
+     *
+     * @param contentHash the hash of the content of the file, from [ConditionContentHash].
+     * @return the name of the file, or null if the additional files of this backup are not named after their content.
+     */
+    protected open fun getContentFileName(contentHash: Long): String? = null
+
     @CallSuper
     open fun reset() {
         loadedBackups.clear()
         _validBackups.clear()
+        _deduplicatedFileNames.clear()
         failureCount = 0
     }
 
-    fun addScenarioToZipFile(zipStream: ZipOutputStream, scenario: BackupScenario, screenSize: Point) {
-        Log.d(TAG, "Backup scenario $scenario")
+    /**
+     * Add scenarios to the zip file, in the list order.
+     *
+     * The json files of the next scenarios are serialized on worker threads while the current one is written into the
+     * zip stream, which can only be written sequentially. They are serialized at most [PARALLEL_SERIALIZATION_COUNT]
+     * scenarios ahead, and each one is deleted once added: the temporary files stay few, whatever the backup size.
+     *
+     * @param onScenarioAdded called once each scenario is added to the zip file.
+     */
+    suspend fun addScenariosToZipFile(
+        zipStream: ZipOutputStream,
+        scenarios: List<BackupScenario>,
+        screenSize: Point,
+        onScenarioAdded: () -> Unit,
+    ) = coroutineScope {
+        val serializations = ArrayDeque<Deferred<File>>(PARALLEL_SERIALIZATION_COUNT)
+        var nextSerializedIndex = 0
+
+        scenarios.forEach { scenario ->
+            Log.d(TAG, "Backup scenario $scenario")
+
+            while (nextSerializedIndex < scenarios.size && serializations.size < PARALLEL_SERIALIZATION_COUNT) {
+                val serializedScenario = scenarios[nextSerializedIndex++]
+                serializations.addLast(async(Dispatchers.Default) {
+                    createScenarioJsonBackupFile(serializedScenario, screenSize)
+                })
+            }
 
-        // Create json file from the data of the scenario
-        val jsonFile = createScenarioJsonBackupFile(scenario, screenSize)
+            // Add the json file to the archive and delete it.
+            val jsonFile = serializations.removeFirst().await()
+            addScenarioFilesToZip(zipStream, scenario, jsonFile, getBackupAdditionalFilesPaths(scenario))
+            jsonFile.delete()
 
-        // Add it to the archive and delete it.
-        addScenarioFilesToZip(zipStream, scenario, jsonFile, getBackupAdditionalFilesPaths(scenario))
-        jsonFile.delete()
+            onScenarioAdded()
+        }
     }
 
     private fun createScenarioJsonBackupFile(scenario: BackupScenario, screenSize: Point): File =
@@ -99,12 +148,15 @@ internal abstract class ScenarioBackupDataSource<Backup, BackupScenario>(private
 
             // Put json file in the archive
             Log.d(TAG, "Add scenario JSON to archive")
+            setLevel(Deflater.DEFAULT_COMPRESSION)
             putNextEntry(
                 ZipEntry("$entryPrefix${scenarioJsonFile.name}")
             )
             writeEntryFile(scenarioJsonFile)
 
-            // Copy all additional files in the scenario folder of the zip archive
+            // Copy all additional files in the scenario folder of the zip archive. The condition files are raw pixels,
+            // most of the default level compression time is spent for a few percents of their size.
+            setLevel(Deflater.BEST_SPEED)
             additionalFilesPaths.forEach { additionalPath ->
                 Log.d(TAG, "Add backup additional file to archive $additionalPath")
                 putNextEntry(ZipEntry("$entryPrefix$additionalPath"))
@@ -158,7 +210,24 @@ internal abstract class ScenarioBackupDataSource<Backup, BackupScenario>(private
             return true
         }
 
-        zipStream.readAndCopyEntryFile(additionalFile)
+        // Hashed while extracted: the same content may already be on the device, saved under another name
+        val extractingFile = File(appDataDir, "${additionalFile.name}$EXTRACTING_FILE_SUFFIX")
+        val contentHash = ConditionContentHash()
+        zipStream.readAndCopyEntryFile(extractingFile, contentHash)
+
+        val contentFile = getContentFileName(contentHash.getValue())?.let { name -> File(appDataDir, name) }
+        if (contentFile != null && contentFile.exists() && contentFile.length() == extractingFile.length()) {
+            Log.d(TAG, "Additional file $fileName already exist as ${contentFile.name}, skip it.")
+            extractingFile.delete()
+            _deduplicatedFileNames[additionalFile.name] = contentFile.name
+            return true
+        }
+
+        if (!extractingFile.renameTo(additionalFile)) {
+            Log.w(TAG, "Can't extract additional file $fileName")
+            extractingFile.delete()
+            return false
+        }
         return true
     }
 
@@ -177,4 +246,8 @@ internal abstract class ScenarioBackupDataSource<Backup, BackupScenario>(private
 
 
 const val SCENARIO_BACKUP_EXTENSION = ".json"
+/** Suffix of the additional files while they are extracted, before being renamed or deleted. */
+private const val EXTRACTING_FILE_SUFFIX = ".extracting"
+/** Number of scenarios with a json file serialized ahead of their addition to the zip file. */
+private const val PARALLEL_SERIALIZATION_COUNT = 4
 private const val TAG = "ScenarioBackupEngine"
\ No newline at end of file
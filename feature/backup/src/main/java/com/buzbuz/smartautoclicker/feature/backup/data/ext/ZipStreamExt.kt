@@ -16,6 +16,8 @@
  */
 package com.buzbuz.smartautoclicker.feature.backup.data.ext
 
+import com.buzbuz.smartautoclicker.core.bitmaps.ConditionContentHash
+
 import java.io.File
 import java.util.zip.ZipInputStream
 import java.util.zip.ZipOutputStream
@@ -26,16 +28,26 @@ import java.util.zip.ZipOutputStream
  */
 internal fun ZipOutputStream.writeEntryFile(entry: File) {
     entry.inputStream().use { input ->
-        input.copyTo(this)
+        input.copyTo(this, ENTRY_COPY_BUFFER_SIZE)
     }
 }
 
 /**
  * Read a file into from this zip stream.
  * @param output the file to put the content into.
+ * @param contentHash hashes the content while it is copied, null to only copy it.
  */
-internal fun ZipInputStream.readAndCopyEntryFile(output: File) =
+internal fun ZipInputStream.readAndCopyEntryFile(output: File, contentHash: ConditionContentHash? = null) =
     output.outputStream().use { outputStream ->
-        copyTo(outputStream)
+        val buffer = ByteArray(ENTRY_COPY_BUFFER_SIZE)
+        var length = read(buffer)
+        while (length >= 0) {
+            contentHash?.update(buffer, 0, length)
+            outputStream.write(buffer, 0, length)
+            length = read(buffer)
+        }
     }
+
+/** Size of the buffer copying a file into the zip stream, the big condition files are written with fewer calls. */
+private const val ENTRY_COPY_BUFFER_SIZE = 64 * 1024
     
\ No newline at end of file
@@ -20,6 +20,7 @@ import android.graphics.Point
 import android.util.Log
 
 import com.buzbuz.smartautoclicker.core.bitmaps.CONDITION_FILE_PREFIX
+import com.buzbuz.smartautoclicker.core.bitmaps.getConditionFileName
 import com.buzbuz.smartautoclicker.core.database.CLICK_DATABASE_VERSION
 import com.buzbuz.smartautoclicker.core.database.entity.CompleteScenario
 import com.buzbuz.smartautoclicker.core.database.entity.ConditionType
@@ -74,6 +75,9 @@ internal class SmartBackupDataSource(
             }
         }
 
+    override fun getContentFileName(contentHash: Long): String =
+        getConditionFileName(contentHash)
+
     override fun getBackupZipFolderName(scenario: CompleteScenario): String =
         "${scenario.scenario.id}"
 
@@ -92,6 +96,11 @@ internal class SmartBackupDataSource(
         Log.i(TAG, "Verifying smart scenario ${backup.scenario.scenario.id}")
 
         backup.scenario.events.forEach { event ->
+            // The condition files skipped at extraction are used under their name on the device
+            event.conditions.forEach { condition ->
+                condition.path?.let { path -> deduplicatedFileNames[path]?.let { condition.path = it } }
+            }
+
             if (event.actions.isEmpty()) {
                 Log.w(TAG, "Invalid scenario, action list is empty.")
                 return null
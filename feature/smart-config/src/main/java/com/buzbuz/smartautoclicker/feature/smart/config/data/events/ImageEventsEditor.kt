@@ -34,6 +34,13 @@ internal class ImageEventsEditor(
     override fun onEditedEventConditionsUpdated(conditions: List<ImageCondition>) {
         val editedEvent = editedItem.value ?: return
 
+        // Anchor was removed or is now anchored itself, delete the reference. Called again by the update.
+        val validAnchorsConditions = conditions.withValidAnchors()
+        if (validAnchorsConditions != conditions) {
+            conditionsEditor.updateList(validAnchorsConditions)
+            return
+        }
+
         actionsEditor.editedList.value?.let { actions ->
             val newActions = actions.toMutableList()
             actions.forEach { action ->
@@ -68,4 +75,13 @@ internal class ImageEventsEditor(
         actions: List<Action>,
     ): ImageEvent = event.copy(conditions = conditions, actions = actions)
 
+    private fun List<ImageCondition>.withValidAnchors(): List<ImageCondition> {
+        val anchorsIds = filter { it.anchorConditionId == null }.map { it.id }.toSet()
+
+        return map { condition ->
+            if (condition.anchorConditionId == null || condition.anchorConditionId in anchorsIds) condition
+            else condition.copy(anchorConditionId = null, anchorArea = null)
+        }
+    }
+
 }
\ No newline at end of file
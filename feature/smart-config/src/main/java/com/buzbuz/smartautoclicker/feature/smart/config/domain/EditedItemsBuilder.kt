@@ -104,11 +104,15 @@ class EditedItemsBuilder internal constructor(
             id = eventId,
             scenarioId = scenarioId,
             name = "" + from.name,
-            conditions = from.conditions.map { conditionOrig ->
-                val conditionCopy = createNewImageConditionFrom(conditionOrig, eventId)
-                eventCopyConditionIdMap[conditionOrig.id] = conditionCopy.id
-                conditionCopy
-            },
+            conditions = from.conditions
+                .map { conditionOrig ->
+                    val conditionCopy = createNewImageConditionFrom(conditionOrig, eventId)
+                    eventCopyConditionIdMap[conditionOrig.id] = conditionCopy.id
+                    conditionCopy
+                }
+                .zip(from.conditions) { conditionCopy, conditionOrig ->
+                    conditionCopy.withAnchorCopyFrom(conditionOrig)
+                },
             actions = from.actions.map { createNewActionFrom(it, eventId) }
         ).also { eventCopyConditionIdMap.clear() }
     }
@@ -147,13 +151,25 @@ class EditedItemsBuilder internal constructor(
         )
     }
 
-    fun createNewImageConditionFrom(condition: ImageCondition, eventId: Identifier = getEditedEventIdOrThrow()): ImageCondition =
-        condition.copy(
+    fun createNewImageConditionFrom(condition: ImageCondition, eventId: Identifier = getEditedEventIdOrThrow()): ImageCondition {
+        // The anchor is a condition of the same event, it is only kept in it
+        val isAnchorKept = condition.eventId == eventId
+
+        return condition.copy(
             id = conditionsIdCreator.generateNewIdentifier(),
             eventId = eventId,
             name = "" + condition.name,
             path = "" + condition.path,
+            anchorConditionId = if (isAnchorKept) condition.anchorConditionId else null,
+            anchorArea = if (isAnchorKept) condition.anchorArea?.let { Rect(it) } else null,
         )
+    }
+
+    /** Reference the copy of the anchor of [from], once all conditions of its event have been copied. */
+    private fun ImageCondition.withAnchorCopyFrom(from: ImageCondition): ImageCondition {
+        val anchorId = from.anchorConditionId?.let { eventCopyConditionIdMap[it] } ?: return this
+        return copy(anchorConditionId = anchorId, anchorArea = from.anchorArea?.let { Rect(it) })
+    }
 
     fun createNewOnBroadcastReceived(context: Context): TriggerCondition.OnBroadcastReceived =
         TriggerCondition.OnBroadcastReceived(
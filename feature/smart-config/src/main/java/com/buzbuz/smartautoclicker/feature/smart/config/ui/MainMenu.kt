@@ -18,6 +18,7 @@ package com.buzbuz.smartautoclicker.feature.smart.config.ui
 
 import android.content.DialogInterface
 import android.util.Size
+import android.view.Choreographer
 import android.view.KeyEvent
 import android.view.LayoutInflater
 import android.view.ViewGroup
@@ -40,11 +41,13 @@ import com.buzbuz.smartautoclicker.feature.smart.config.ui.common.starters.newRe
 import com.buzbuz.smartautoclicker.feature.smart.config.ui.scenario.ScenarioDialog
 import com.buzbuz.smartautoclicker.feature.smart.debugging.di.DebuggingViewModelsEntryPoint
 import com.buzbuz.smartautoclicker.feature.smart.debugging.ui.overlay.DebugModel
+import com.buzbuz.smartautoclicker.feature.smart.debugging.ui.overlay.LastPositiveDebugInfo
 import com.buzbuz.smartautoclicker.feature.tutorial.ui.dialogs.createStopWithVolumeDownTutorialDialog
 
 import com.google.android.material.dialog.MaterialAlertDialogBuilder
 
 import kotlinx.coroutines.Job
+import kotlinx.coroutines.awaitCancellation
 import kotlinx.coroutines.launch
 
 /**
@@ -289,17 +292,33 @@ class MainMenu(private val onStopClicked: () -> Unit) : OverlayMenu() {
 
     /**
      * Observe the values for the debug and update the debug views.
+     * The values are read at each display frame, the detection never waits for the views to be updated.
      * @return the coroutine job for the observable. Can be cancelled to stop the observation.
      */
     private fun observeDebugValues() = lifecycleScope.launch {
         repeatOnLifecycle(Lifecycle.State.STARTED) {
-            launch {
-                debuggingViewModel.debugLastPositive.collect { debugInfo ->
-                    viewBinding.debugEventName.text = debugInfo.eventName
-                    viewBinding.debugConditionName.text = debugInfo.conditionName
-                    viewBinding.debugConfidenceRate.text = debugInfo.confidenceRateText
+            val choreographer = Choreographer.getInstance()
+            var displayedInfo: LastPositiveDebugInfo? = null
+
+            val frameCallback = object : Choreographer.FrameCallback {
+                override fun doFrame(frameTimeNanos: Long) {
+                    val debugInfo = debuggingViewModel.getDebugLastPositive(frameTimeNanos)
+                    if (debugInfo !== displayedInfo) {
+                        displayedInfo = debugInfo
+                        viewBinding.debugEventName.text = debugInfo.eventName
+                        viewBinding.debugConditionName.text = debugInfo.conditionName
+                        viewBinding.debugConfidenceRate.text = debugInfo.confidenceRateText
+                    }
+                    choreographer.postFrameCallback(this)
                 }
             }
+
+            choreographer.postFrameCallback(frameCallback)
+            try {
+                awaitCancellation()
+            } finally {
+                choreographer.removeFrameCallback(frameCallback)
+            }
         }
     }
 
@@ -19,6 +19,7 @@ package com.buzbuz.smartautoclicker.feature.smart.config.ui.condition.image
 import android.graphics.Bitmap
 import android.graphics.Color
 import android.text.InputFilter
+import android.text.InputType
 import android.util.Log
 import android.view.LayoutInflater
 import android.view.View
@@ -33,7 +34,12 @@ import com.buzbuz.smartautoclicker.core.common.overlays.base.viewModels
 import com.buzbuz.smartautoclicker.core.common.overlays.dialog.OverlayDialog
 import com.buzbuz.smartautoclicker.core.domain.model.EXACT
 import com.buzbuz.smartautoclicker.core.domain.model.IN_AREA
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_CCOEFF_NORMED
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_SAD
+import com.buzbuz.smartautoclicker.core.domain.model.METRIC_SQDIFF_NORMED
+import com.buzbuz.smartautoclicker.core.domain.model.MatchingMetric
 import com.buzbuz.smartautoclicker.core.domain.model.WHOLE_SCREEN
+import com.buzbuz.smartautoclicker.core.domain.model.condition.IMAGE_CONDITION_MAX_ROTATIONS
 import com.buzbuz.smartautoclicker.core.ui.bindings.buttons.MultiStateButtonConfig
 import com.buzbuz.smartautoclicker.core.ui.bindings.dialogs.DialogNavigationButton
 import com.buzbuz.smartautoclicker.core.ui.bindings.dialogs.setButtonEnabledState
@@ -42,6 +48,7 @@ import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setChecked
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setDescription
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setEnabled
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setError
+import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setIconBitmap
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setLabel
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setOnCheckedListener
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setOnClickListener
@@ -53,6 +60,7 @@ import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setText
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setTitle
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setValueLabelState
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setupDescriptions
+import com.buzbuz.smartautoclicker.core.ui.utils.MinMaxInputFilter
 import com.buzbuz.smartautoclicker.feature.smart.config.R
 import com.buzbuz.smartautoclicker.feature.smart.config.databinding.DialogConfigConditionImageBinding
 import com.buzbuz.smartautoclicker.feature.smart.config.di.ScenarioConfigViewModelsEntryPoint
@@ -144,12 +152,84 @@ class ImageConditionDialog(
                 setOnClickListener { debounceUserInteraction { showDetectionAreaSelector() } }
             }
 
+            fieldTextInArea.apply {
+                setTitle(context.getString(R.string.field_condition_text_in_area_title))
+                setupDescriptions(
+                    listOf(
+                        context.getString(R.string.field_condition_text_in_area_desc_image),
+                        context.getString(R.string.field_condition_text_in_area_desc_text),
+                    )
+                )
+                setOnClickListener { viewModel.toggleTextInArea() }
+            }
+
+            fieldAnchored.apply {
+                setTitle(context.getString(R.string.field_anchored_title))
+                setupDescriptions(
+                    listOf(
+                        context.getString(R.string.field_anchored_desc_none),
+                        context.getString(R.string.field_anchored_desc_anchored),
+                    )
+                )
+                setOnClickListener {
+                    if (viewModel.isAnchored()) viewModel.clearAnchor()
+                    else debounceUserInteraction { showAnchorSelector() }
+                }
+            }
+
+            fieldSelectAnchor.apply {
+                setTitle(context.getString(R.string.field_select_anchor_title))
+                setOnClickListener { debounceUserInteraction { showAnchorSelector() } }
+            }
+
             fieldSliderThreshold.apply {
                 setTitle(context.getString(R.string.field_title_condition_threshold))
                 setValueLabelState(isEnabled = true, prefix = "%")
                 setSliderRange(0f, MAX_THRESHOLD)
                 setOnValueChangedFromUserListener { value -> viewModel.setThreshold(value.roundToInt()) }
             }
+
+            fieldFeatureMatching.apply {
+                setTitle(context.getString(R.string.field_feature_matching_title))
+                setupDescriptions(
+                    listOf(
+                        context.getString(R.string.field_feature_matching_desc_pixels),
+                        context.getString(R.string.field_feature_matching_desc_features),
+                    )
+                )
+                setOnClickListener { viewModel.toggleFeatureMatching() }
+            }
+
+            fieldMatchingMetric.apply {
+                setTitle(context.getString(R.string.field_matching_metric_title))
+                setButtonConfig(
+                    MultiStateButtonConfig(
+                        icons = listOf(
+                            R.drawable.ic_detection_quality,
+                            R.drawable.ic_equals,
+                            R.drawable.ic_minus,
+                        ),
+                        selectionRequired = true,
+                    )
+                )
+                setupDescriptions(
+                    listOf(
+                        context.getString(R.string.field_matching_metric_desc_correlation),
+                        context.getString(R.string.field_matching_metric_desc_squared),
+                        context.getString(R.string.field_matching_metric_desc_absolute),
+                    )
+                )
+                setOnCheckedListener { index -> viewModel.setMatchingMetric(index.fromIndexToMatchingMetric()) }
+            }
+
+            fieldRotationCount.apply {
+                textField.filters = arrayOf(MinMaxInputFilter(min = 1, max = IMAGE_CONDITION_MAX_ROTATIONS))
+                setLabel(R.string.input_field_label_condition_rotation_count)
+                setOnTextChangedListener {
+                    viewModel.setRotationCount(if (it.isNotEmpty()) it.toString().toInt() else null)
+                }
+            }
+            hideSoftInputOnFocusLoss(fieldRotationCount.textField)
         }
 
         return viewBinding.root
@@ -168,7 +248,12 @@ class ImageConditionDialog(
                 launch { viewModel.conditionBitmap.collect(::updateConditionBitmap) }
                 launch { viewModel.shouldBeDetected.collect(::updateShouldBeDetected) }
                 launch { viewModel.detectionType.collect(::updateDetectionType) }
+                launch { viewModel.isTextInArea.collect(::updateTextInArea) }
+                launch { viewModel.anchor.collect(::updateAnchor) }
                 launch { viewModel.threshold.collect(::updateThreshold) }
+                launch { viewModel.isFeatureMatching.collect(::updateFeatureMatching) }
+                launch { viewModel.matchingMetric.collect(::updateMatchingMetric) }
+                launch { viewModel.rotationCount.collect(::updateRotationCount) }
                 launch { viewModel.conditionCanBeSaved.collect(::updateSaveButton) }
             }
         }
@@ -247,12 +332,64 @@ class ImageConditionDialog(
             setEnabled(detectionTypeState.type == IN_AREA)
             setDescription(detectionTypeState.areaText)
         }
+
+        // The text is only searched without the bitmap in a selected area
+        val isInArea = detectionTypeState.type == IN_AREA
+        viewBinding.dividerTextInArea.visibility = if (isInArea) View.VISIBLE else View.GONE
+        viewBinding.fieldTextInArea.root.visibility = if (isInArea) View.VISIBLE else View.GONE
+    }
+
+    private fun updateTextInArea(isTextInArea: Boolean) {
+        viewBinding.fieldTextInArea.apply {
+            setChecked(isTextInArea)
+            setDescription(if (isTextInArea) 1 else 0)
+        }
+    }
+
+    private fun updateAnchor(anchorState: AnchorUiState) {
+        viewBinding.cardAnchor.visibility = if (anchorState.isVisible) View.VISIBLE else View.GONE
+
+        viewBinding.fieldAnchored.apply {
+            setChecked(anchorState.isAnchored)
+            setDescription(if (anchorState.isAnchored) 1 else 0)
+        }
+
+        viewBinding.fieldSelectAnchor.apply {
+            setEnabled(anchorState.isAnchored)
+            setDescription(anchorState.anchorName)
+            setIconBitmap(anchorState.anchorBitmap)
+        }
     }
 
     private fun updateThreshold(newThreshold: Int) {
         viewBinding.fieldSliderThreshold.setSliderValue(newThreshold.toFloat())
     }
 
+    private fun updateFeatureMatching(isFeatureMatching: Boolean) {
+        viewBinding.fieldFeatureMatching.apply {
+            setChecked(isFeatureMatching)
+            setDescription(if (isFeatureMatching) 1 else 0)
+        }
+    }
+
+    private fun updateMatchingMetric(@MatchingMetric matchingMetric: Int) {
+        val index = when (matchingMetric) {
+            METRIC_CCOEFF_NORMED -> 0
+            METRIC_SQDIFF_NORMED -> 1
+            METRIC_SAD -> 2
+            else -> return
+        }
+
+        viewBinding.fieldMatchingMetric.apply {
+            setChecked(index)
+            setDescription(index)
+        }
+    }
+
+    private fun updateRotationCount(rotationCount: String?) {
+        viewBinding.fieldRotationCount.setText(rotationCount, InputType.TYPE_CLASS_NUMBER)
+    }
+
     private fun updateSaveButton(isValidCondition: Boolean) {
         viewBinding.layoutTopBar.setButtonEnabledState(DialogNavigationButton.SAVE, isValidCondition)
     }
@@ -267,6 +404,17 @@ class ImageConditionDialog(
         )
     }
 
+    private fun showAnchorSelector() =
+        overlayManager.navigateTo(
+            context = context,
+            newOverlay = ImageConditionSelectionDialog(
+                conditionList = viewModel.availableAnchors.value,
+                bitmapProvider = viewModel::getConditionBitmap,
+                onConditionSelected = viewModel::setAnchor,
+            ),
+            hideCurrent = false,
+        )
+
     private fun confirmDelete() {
         listener.onDeleteClicked()
         super.back()
@@ -279,6 +427,13 @@ class ImageConditionDialog(
         }
     }
 
+    private fun Int?.fromIndexToMatchingMetric() : Int =
+        when (this) {
+            1 -> METRIC_SQDIFF_NORMED
+            2 -> METRIC_SAD
+            else -> METRIC_CCOEFF_NORMED
+        }
+
     private fun Int?.fromIndexToDetectionType() : Int =
         when (this) {
             0 -> EXACT
@@ -27,15 +27,22 @@ import androidx.lifecycle.viewModelScope
 import com.buzbuz.smartautoclicker.core.domain.IRepository
 import com.buzbuz.smartautoclicker.core.domain.model.DetectionType
 import com.buzbuz.smartautoclicker.core.domain.model.IN_AREA
+import com.buzbuz.smartautoclicker.core.domain.model.MatchingMetric
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
+import com.buzbuz.smartautoclicker.core.domain.model.condition.IMAGE_CONDITION_MAX_ROTATIONS
 import com.buzbuz.smartautoclicker.core.ui.monitoring.MonitoredViewType
 import com.buzbuz.smartautoclicker.core.ui.monitoring.MonitoredViewsManager
 import com.buzbuz.smartautoclicker.feature.smart.config.R
 import com.buzbuz.smartautoclicker.feature.smart.config.domain.EditionRepository
+import com.buzbuz.smartautoclicker.feature.smart.config.ui.common.model.condition.UiImageCondition
+import com.buzbuz.smartautoclicker.feature.smart.config.ui.common.model.condition.toUiImageCondition
+import com.buzbuz.smartautoclicker.feature.smart.config.utils.getImageConditionBitmap
 import dagger.hilt.android.qualifiers.ApplicationContext
 
 import kotlinx.coroutines.Dispatchers
 import kotlinx.coroutines.FlowPreview
+import kotlinx.coroutines.Job
+import kotlinx.coroutines.flow.combine
 import kotlinx.coroutines.flow.debounce
 import kotlinx.coroutines.flow.distinctUntilChanged
 import kotlinx.coroutines.flow.Flow
@@ -88,12 +95,48 @@ class ImageConditionViewModel @Inject constructor(
         }
         .filterNotNull()
 
+    /** True if the name of the configured condition is searched in the text of its detection area. */
+    val isTextInArea: Flow<Boolean> = configuredCondition.map { it.isTextInArea }
     /** The condition threshold value currently edited by the user. */
     val threshold: Flow<Int> = configuredCondition.mapNotNull { it.threshold }
+    /** True if the configured condition is detected with its feature points. */
+    val isFeatureMatching: Flow<Boolean> = configuredCondition.map { it.isFeatureMatching }
+    /** The similarity measured for the configured condition. */
+    val matchingMetric: Flow<Int> = configuredCondition.map { it.matchingMetric }
+    /** The number of orientations the configured condition is searched at. */
+    val rotationCount: Flow<String?> = configuredCondition.map { it.rotationCount.toString() }.take(1)
     /** The bitmap for the configured condition. */
     val conditionBitmap: Flow<Bitmap?> = configuredCondition.map { condition ->
         repository.getConditionBitmap(condition)
     }.flowOn(Dispatchers.IO)
+    /** The other conditions of the event the configured condition can be located with. */
+    val availableAnchors: StateFlow<List<UiImageCondition>> = combine(
+        configuredCondition,
+        editionRepository.editionState.editedEventImageConditionsState,
+    ) { condition, eventConditions ->
+        eventConditions.value
+            ?.filter { it.id != condition.id && it.anchorConditionId == null }
+            ?.map { it.toUiImageCondition(context = context, shortThreshold = true, inError = !it.isComplete()) }
+            ?: emptyList()
+    }.stateIn(viewModelScope, SharingStarted.Eagerly, emptyList())
+    /** The state of the anchor of the configured condition. */
+    val anchor: Flow<AnchorUiState> = combine(
+        configuredCondition,
+        editionRepository.editionState.editedEventImageConditionsState,
+    ) { condition, eventConditions ->
+        val conditions = eventConditions.value ?: emptyList()
+        val anchor = condition.anchorConditionId?.let { anchorId -> conditions.find { it.id == anchorId } }
+
+        AnchorUiState(
+            // An anchor can't be anchored itself, and the text in area and feature points are not located
+            isVisible = !condition.isFeatureMatching
+                    && !(condition.isTextInArea && condition.detectionType == IN_AREA)
+                    && conditions.none { it.anchorConditionId == condition.id },
+            isAnchored = anchor != null,
+            anchorName = anchor?.name ?: context.getString(R.string.field_select_anchor_desc_none),
+            anchorBitmap = anchor?.let { repository.getConditionBitmap(it) },
+        )
+    }.flowOn(Dispatchers.IO).distinctUntilChanged()
     /** Tells if the configured condition is valid and can be saved. */
     val conditionCanBeSaved: Flow<Boolean> = editionRepository.editionState.editedImageConditionState.map { condition ->
         condition.canBeSaved
@@ -117,6 +160,13 @@ class ImageConditionViewModel @Inject constructor(
         }
     }
 
+    /** Toggle the search of the condition name in the text of its detection area, without its bitmap. */
+    fun toggleTextInArea() {
+        updateEditedCondition { oldCondition ->
+            oldCondition.copy(isTextInArea = !oldCondition.isTextInArea)
+        }
+    }
+
     /** Set the detection type. */
     fun setDetectionType(newType: Int) {
         updateEditedCondition { oldCondition ->
@@ -135,6 +185,34 @@ class ImageConditionViewModel @Inject constructor(
         }
     }
 
+    /** @return true if the configured condition is located with another condition of its event. */
+    fun isAnchored(): Boolean =
+        editionRepository.editionState.getEditedCondition<ImageCondition>()?.anchorConditionId != null
+
+    /**
+     * Locate the configured condition with another condition of its event. It is then searched around the anchor
+     * detection, at the offset between their captured areas.
+     * @param anchor the condition to locate the configured one with.
+     */
+    fun setAnchor(anchor: ImageCondition) {
+        updateEditedCondition { oldCondition ->
+            oldCondition.copy(
+                anchorConditionId = anchor.id,
+                anchorArea = getAnchorArea(oldCondition.area, anchor.area),
+            )
+        }
+    }
+
+    /** Detect the configured condition in its own detection area again. */
+    fun clearAnchor() {
+        updateEditedCondition { oldCondition ->
+            oldCondition.copy(anchorConditionId = null, anchorArea = null)
+        }
+    }
+
+    fun getConditionBitmap(condition: ImageCondition, onBitmapLoaded: (Bitmap?) -> Unit): Job =
+        getImageConditionBitmap(repository, condition, onBitmapLoaded)
+
     /**
      * Set the threshold of the configured condition.
      * @param value the new threshold value.
@@ -145,6 +223,31 @@ class ImageConditionViewModel @Inject constructor(
         }
     }
 
+    /** Toggle the detection of the configured condition with its feature points instead of its pixels. */
+    fun toggleFeatureMatching() {
+        updateEditedCondition { oldCondition ->
+            oldCondition.copy(isFeatureMatching = !oldCondition.isFeatureMatching)
+        }
+    }
+
+    /**
+     * Set the similarity measured for the configured condition.
+     * @param metric the new metric, one of [MatchingMetric].
+     */
+    fun setMatchingMetric(@MatchingMetric metric: Int) {
+        updateEditedCondition { oldCondition -> oldCondition.copy(matchingMetric = metric) }
+    }
+
+    /**
+     * Set the number of orientations the configured condition is searched at.
+     * @param count the new number of orientations, null to search it at its own orientation only.
+     */
+    fun setRotationCount(count: Int?) {
+        updateEditedCondition { oldCondition ->
+            oldCondition.copy(rotationCount = count?.coerceIn(1, IMAGE_CONDITION_MAX_ROTATIONS) ?: 1)
+        }
+    }
+
     fun isConditionRelatedToClick(): Boolean =
         editionRepository.editionState.isEditedConditionReferencedByClick()
 
@@ -176,6 +279,12 @@ class ImageConditionViewModel @Inject constructor(
         )
     }
 
+    private fun getAnchorArea(conditionArea: Rect, anchorArea: Rect): Rect =
+        Rect(conditionArea).apply {
+            offset(-anchorArea.centerX(), -anchorArea.centerY())
+            inset(-ANCHOR_AREA_MARGIN_PX, -ANCHOR_AREA_MARGIN_PX)
+        }
+
     private fun updateEditedCondition(closure: (oldValue: ImageCondition) -> ImageCondition?) {
         editionRepository.editionState.getEditedCondition<ImageCondition>()?.let { condition ->
             closure(condition)?.let { newValue ->
@@ -195,5 +304,15 @@ data class DetectionTypeState(
     val areaText: String,
 )
 
+data class AnchorUiState(
+    val isVisible: Boolean,
+    val isAnchored: Boolean,
+    val anchorName: String,
+    val anchorBitmap: Bitmap?,
+)
+
+/** The margin around the captured area of an anchored condition, for the small moves of its anchor detection. */
+private const val ANCHOR_AREA_MARGIN_PX = 16
+
 /** The maximum threshold value selectable by the user. */
 const val MAX_THRESHOLD = 20f
\ No newline at end of file
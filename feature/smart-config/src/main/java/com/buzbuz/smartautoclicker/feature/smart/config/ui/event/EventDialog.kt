@@ -17,6 +17,7 @@
 package com.buzbuz.smartautoclicker.feature.smart.config.ui.event
 
 import android.text.InputFilter
+import android.text.InputType
 import android.util.Log
 import android.view.LayoutInflater
 import android.view.View
@@ -47,6 +48,7 @@ import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setOnTextChangedListe
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setText
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setTitle
 import com.buzbuz.smartautoclicker.core.ui.bindings.fields.setupDescriptions
+import com.buzbuz.smartautoclicker.core.ui.utils.MinMaxInputFilter
 import com.buzbuz.smartautoclicker.feature.smart.config.R
 import com.buzbuz.smartautoclicker.feature.smart.config.databinding.DialogEventConfigBinding
 import com.buzbuz.smartautoclicker.feature.smart.config.di.ScenarioConfigViewModelsEntryPoint
@@ -142,6 +144,24 @@ class EventDialog(
             setOnClickListener(viewModel::toggleKeepDetectingState)
         }
 
+        fieldDetectionFrameInterval.apply {
+            textField.filters = arrayOf(MinMaxInputFilter(min = 1))
+            setLabel(R.string.input_field_label_event_detection_frame_interval)
+            setOnTextChangedListener {
+                viewModel.setDetectionFrameInterval(if (it.isNotEmpty()) it.toString().toInt() else null)
+            }
+        }
+        hideSoftInputOnFocusLoss(fieldDetectionFrameInterval.textField)
+
+        fieldDetectionMinInterval.apply {
+            textField.filters = arrayOf(MinMaxInputFilter(min = 0))
+            setLabel(R.string.input_field_label_event_detection_min_interval)
+            setOnTextChangedListener {
+                viewModel.setDetectionMinInterval(if (it.isNotEmpty()) it.toString().toLong() else null)
+            }
+        }
+        hideSoftInputOnFocusLoss(fieldDetectionMinInterval.textField)
+
         fieldTestEvent.apply {
             setTitle(
                 context.getString(
@@ -243,6 +263,8 @@ class EventDialog(
                 launch { viewModel.conditionOperator.collect(::updateConditionOperator) }
                 launch { viewModel.eventEnabledOnStart.collect(::updateEnabledOnStart) }
                 launch { viewModel.keepDetecting.collect(::updateKeepDetecting) }
+                launch { viewModel.detectionFrameInterval.collect(::updateDetectionFrameInterval) }
+                launch { viewModel.detectionMinInterval.collect(::updateDetectionMinInterval) }
                 launch { viewModel.isImageEvent.collect(::updateImageEventSpecificViewsVisibility) }
                 launch { viewModel.canTryEvent.collect(::updateTryFieldEnabledState) }
                 launch { viewModel.actionsDescriptions.collect(viewBinding.fieldActionsSelector::setItems) }
@@ -321,10 +343,20 @@ class EventDialog(
         }
     }
 
+    private fun updateDetectionFrameInterval(interval: String?) {
+        viewBinding.fieldDetectionFrameInterval.setText(interval, InputType.TYPE_CLASS_NUMBER)
+    }
+
+    private fun updateDetectionMinInterval(intervalMs: String?) {
+        viewBinding.fieldDetectionMinInterval.setText(intervalMs, InputType.TYPE_CLASS_NUMBER)
+    }
+
     private fun updateImageEventSpecificViewsVisibility(isEnabled: Boolean) {
         viewBinding.apply {
             fieldKeepDetecting.root.visibility =  if (isEnabled) View.VISIBLE else View.GONE
             dividerKeepDetecting.visibility =  if (isEnabled) View.VISIBLE else View.GONE
+            layoutDetectionIntervals.visibility = if (isEnabled) View.VISIBLE else View.GONE
+            dividerDetectionIntervals.visibility = if (isEnabled) View.VISIBLE else View.GONE
             fieldTestEvent.root.visibility = if (isEnabled) View.VISIBLE else View.GONE
             dividerTrySelector.visibility = if (isEnabled) View.VISIBLE else View.GONE
         }
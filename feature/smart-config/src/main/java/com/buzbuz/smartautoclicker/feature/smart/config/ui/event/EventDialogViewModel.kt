@@ -125,6 +125,16 @@ class EventDialogViewModel @Inject constructor(
         .filterIsInstance<ImageEvent>()
         .map { event -> event.keepDetecting }
 
+    val detectionFrameInterval: Flow<String?> = configuredEvent
+        .filterIsInstance<ImageEvent>()
+        .map { event -> event.detectionFrameInterval.toString() }
+        .take(1)
+
+    val detectionMinInterval: Flow<String?> = configuredEvent
+        .filterIsInstance<ImageEvent>()
+        .map { event -> event.detectionMinIntervalMs.toString() }
+        .take(1)
+
     val canTryEvent: Flow<Boolean> = configuredEvent
         .filterIsInstance<ImageEvent>()
         .map { it.isComplete() }
@@ -172,6 +182,20 @@ class EventDialogViewModel @Inject constructor(
         }
     }
 
+    fun setDetectionFrameInterval(interval: Int?) {
+        updateEditedEvent { oldValue ->
+            if (oldValue is ImageEvent) oldValue.copy(detectionFrameInterval = interval ?: 1)
+            else oldValue
+        }
+    }
+
+    fun setDetectionMinInterval(intervalMs: Long?) {
+        updateEditedEvent { oldValue ->
+            if (oldValue is ImageEvent) oldValue.copy(detectionMinIntervalMs = intervalMs ?: 0)
+            else oldValue
+        }
+    }
+
     fun isLegacyActionUiEnabled(): Boolean =
         settingsRepository.isLegacyActionUiEnabled()
 
@@ -22,6 +22,7 @@ import android.text.InputFilter.LengthFilter
 import android.view.LayoutInflater
 import android.view.ViewGroup
 
+import androidx.core.view.isVisible
 import androidx.lifecycle.Lifecycle
 import androidx.lifecycle.lifecycleScope
 import androidx.lifecycle.repeatOnLifecycle
@@ -93,6 +94,7 @@ class ScenarioConfigContent(appContext: Context) : NavBarDialogContent(appContex
                 launch { viewModel.scenarioNameError.collect(viewBinding.fieldScenarioName::setError) }
                 launch { viewModel.randomization.collect(::updateRandomization) }
                 launch { viewModel.detectionQuality.collect(::updateQuality) }
+                launch { viewModel.suggestedDetectionQuality.collect(::updateSuggestedQuality) }
             }
         }
     }
@@ -108,6 +110,16 @@ class ScenarioConfigContent(appContext: Context) : NavBarDialogContent(appContex
         }
     }
 
+    private fun updateSuggestedQuality(quality: Int?) {
+        viewBinding.buttonSuggestedQuality.apply {
+            isVisible = quality != null
+            if (quality == null) return
+
+            text = context.getString(R.string.button_scenario_quality_suggested, quality)
+            setOnClickListener { viewModel.setDetectionQuality(quality) }
+        }
+    }
+
     private fun updateQuality(quality: UiDetectionQuality) {
         viewBinding.apply {
             textQualityValue.text = quality.displayText
@@ -24,9 +24,11 @@ import com.buzbuz.smartautoclicker.core.display.config.DisplayConfigManager
 
 import com.buzbuz.smartautoclicker.feature.smart.config.domain.EditionRepository
 import com.buzbuz.smartautoclicker.core.processing.domain.DETECTION_QUALITY_MIN
+import com.buzbuz.smartautoclicker.core.processing.domain.DetectionRepository
 import com.buzbuz.smartautoclicker.feature.smart.config.R
 import dagger.hilt.android.qualifiers.ApplicationContext
 
+import kotlinx.coroutines.flow.combine
 import kotlinx.coroutines.flow.filterNotNull
 import kotlinx.coroutines.flow.map
 import kotlinx.coroutines.flow.take
@@ -41,6 +43,7 @@ class ScenarioConfigViewModel @Inject constructor(
     @ApplicationContext context: Context,
     private val displayConfigManager: DisplayConfigManager,
     private val editionRepository: EditionRepository,
+    detectionRepository: DetectionRepository,
 ) : ViewModel() {
 
     /** Currently configured scenario. */
@@ -66,6 +69,14 @@ class ScenarioConfigViewModel @Inject constructor(
             context.getUiDetectionQuality(displayConfigManager.displayConfig.sizePx, scenario.detectionQuality)
         }
 
+    /** The detection quality suggested by the last tuning of this scenario, null if none or not lower. */
+    val suggestedDetectionQuality: Flow<Int?> =
+        combine(configuredScenario, detectionRepository.detectionQualitySuggestion) { scenario, suggestion ->
+            suggestion?.suggestedQuality?.takeIf { suggestedQuality ->
+                suggestion.scenarioId == scenario.id.databaseId && suggestedQuality < scenario.detectionQuality
+            }
+        }
+
     /** Set a new name for the scenario. */
     fun setScenarioName(name: String) {
         editionRepository.editionState.getScenario()?.let { scenario ->
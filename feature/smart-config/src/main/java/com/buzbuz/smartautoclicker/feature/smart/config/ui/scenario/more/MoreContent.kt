@@ -71,6 +71,12 @@ class MoreContent(appContext: Context) : NavBarDialogContent(appContext) {
                 setOnClickListener(viewModel::toggleIsDebugReportEnabled)
             }
 
+            fieldDebugSampling.apply {
+                setTitle(context.getString(R.string.field_debug_sampling_title))
+                setupDescriptions(listOf(context.getString(R.string.field_debug_sampling_desc)))
+                setOnClickListener(viewModel::toggleIsDebugSamplingEnabled)
+            }
+
             fieldShowReport.apply {
                 setTitle(context.getString(R.string.field_show_debug_report_title))
                 setupDescriptions(
@@ -91,6 +97,7 @@ class MoreContent(appContext: Context) : NavBarDialogContent(appContext) {
             repeatOnLifecycle(Lifecycle.State.STARTED) {
                 launch { viewModel.isDebugViewEnabled.collect(viewBinding.fieldDebugOverlay::setChecked) }
                 launch { viewModel.isDebugReportEnabled.collect(viewBinding.fieldDebugReport::setChecked) }
+                launch { viewModel.isDebugSamplingEnabled.collect(viewBinding.fieldDebugSampling::setChecked) }
                 launch { viewModel.debugReportAvailability.collect(::updateDebugReportAvailability) }
             }
         }
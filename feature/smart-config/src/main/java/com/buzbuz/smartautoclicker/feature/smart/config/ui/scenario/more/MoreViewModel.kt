@@ -44,6 +44,10 @@ class MoreViewModel @Inject constructor(
     private val _isDebugReportEnabled = MutableStateFlow(debuggingRepository.isDebugReportEnabled(context))
     val isDebugReportEnabled: Flow<Boolean> = _isDebugReportEnabled
 
+    /** Tells if only a sample of the screen images are debugged or not. */
+    private val _isDebugSamplingEnabled = MutableStateFlow(debuggingRepository.isDebugSamplingEnabled(context))
+    val isDebugSamplingEnabled: Flow<Boolean> = _isDebugSamplingEnabled
+
     /** Tells if a debug report is available. */
     val debugReportAvailability: Flow<Boolean> = debuggingRepository.debugReport
         .map { it != null }
@@ -56,8 +60,16 @@ class MoreViewModel @Inject constructor(
         _isDebugReportEnabled.value = !_isDebugReportEnabled.value
     }
 
+    fun toggleIsDebugSamplingEnabled() {
+        _isDebugSamplingEnabled.value = !_isDebugSamplingEnabled.value
+    }
+
     fun saveConfig() {
-        debuggingRepository.setDebuggingConfig(_isDebugViewEnabled.value, _isDebugReportEnabled.value)
+        debuggingRepository.setDebuggingConfig(
+            _isDebugViewEnabled.value,
+            _isDebugReportEnabled.value,
+            _isDebugSamplingEnabled.value,
+        )
     }
 
     fun getTutorialActivityComponent(): ComponentName =
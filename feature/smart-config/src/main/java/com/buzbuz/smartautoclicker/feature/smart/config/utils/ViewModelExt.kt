@@ -33,7 +33,8 @@ import kotlin.coroutines.cancellation.CancellationException
 fun ViewModel.getImageConditionBitmap(repository: IRepository, condition: ImageCondition, onCompleted: (Bitmap?) -> Unit): Job =
     viewModelScope.launch(Dispatchers.IO) {
         try {
-            val bitmap = repository.getConditionBitmap(condition)
+            // Only shown in the condition lists, the full size bitmap is not needed
+            val bitmap = repository.getConditionThumbnail(condition)
             withContext(Dispatchers.Main) {
                 onCompleted.invoke(bitmap)
             }
@@ -46,10 +46,22 @@ internal fun SharedPreferences.getIsDebugReportEnabled(context: Context) : Boole
 internal fun SharedPreferences.Editor.putIsDebugReportEnabled(enabled: Boolean) : SharedPreferences.Editor =
     putBoolean(PREF_DEBUG_REPORT_ENABLED, enabled)
 
+/** @return the isEnabled value for the sampling of the debugged screen images. */
+internal fun SharedPreferences.getIsDebugSamplingEnabled(context: Context) : Boolean = getBoolean(
+    PREF_DEBUG_SAMPLING_ENABLED,
+    context.resources.getBoolean(R.bool.default_debug_sampling_enabled),
+)
+
+/** Save a new enabled value for the sampling of the debugged screen images. */
+internal fun SharedPreferences.Editor.putIsDebugSamplingEnabled(enabled: Boolean) : SharedPreferences.Editor =
+    putBoolean(PREF_DEBUG_SAMPLING_ENABLED, enabled)
+
 
 /** Debug configuration SharedPreference name. */
 private const val DEBUG_CONFIGURATION_PREFERENCES_NAME = "DebugConfigPreferences"
 /** User selection for the debug view visibility in the SharedPreferences. */
 private const val PREF_DEBUG_VIEW_ENABLED = "Debug_View_Enabled"
 /** User selection for the debug report in the SharedPreferences. */
-private const val PREF_DEBUG_REPORT_ENABLED = "Debug_Report_Enabled"
\ No newline at end of file
+private const val PREF_DEBUG_REPORT_ENABLED = "Debug_Report_Enabled"
+/** User selection for the sampling of the debugged screen images in the SharedPreferences. */
+private const val PREF_DEBUG_SAMPLING_ENABLED = "Debug_Sampling_Enabled"
\ No newline at end of file
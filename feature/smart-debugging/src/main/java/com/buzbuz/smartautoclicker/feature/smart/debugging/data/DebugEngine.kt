@@ -17,9 +17,10 @@
 package com.buzbuz.smartautoclicker.feature.smart.debugging.data
 
 import android.content.Context
-import android.graphics.Rect
 import android.util.Log
 
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+import com.buzbuz.smartautoclicker.core.detection.DetectorCacheStatistics
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.domain.model.event.TriggerEvent
@@ -27,12 +28,14 @@ import com.buzbuz.smartautoclicker.core.domain.model.scenario.Scenario
 import com.buzbuz.smartautoclicker.core.processing.domain.ConditionResult
 import com.buzbuz.smartautoclicker.core.processing.domain.IConditionsResult
 import com.buzbuz.smartautoclicker.core.processing.domain.ImageConditionResult
+import com.buzbuz.smartautoclicker.core.processing.domain.ImageEventResult
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStatistics
 import com.buzbuz.smartautoclicker.core.processing.domain.ScenarioProcessingListener
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getDebugConfigPreferences
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugReportEnabled
+import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugSamplingEnabled
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugViewEnabled
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.ConditionProcessingDebugInfo
-import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.DebugInfo
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.DebugReport
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.ProcessingDebugInfo
 
@@ -53,11 +56,19 @@ internal class DebugEngine : ScenarioProcessingListener {
     private val eventsRecorderMap: MutableMap<Long, Recorder> = mutableMapOf()
     /** Map of condition id to their recorder. */
     private val conditionsRecorderMap: MutableMap<Long, ConditionRecorder> = mutableMapOf()
+    /** Map of condition id to the statistics of their native searches, updated after each processed image. */
+    private var conditionsStatisticsMap: Map<Long, ConditionStatistics> = emptyMap()
+    /** The statistics of the native detector caches, updated with the conditions statistics. */
+    private var cacheStatistics: List<DetectorCacheStatistics> = emptyList()
+    /** The latencies of the session, received once the detection is stopped. */
+    private var latencyStatistics: LatencyStatistics? = null
 
     /** Tells if the live debugging data should be computed. */
     private var instantData: Boolean = false
     /** Tells if the debugging report should be generated. */
     private var generateReport: Boolean = false
+    /** Tells if only one screen image out of [DEBUG_SAMPLING_PERIOD] should be debugged. */
+    @Volatile private var sampleImages: Boolean = false
     /** The scenario currently processed. */
     private var currentScenario: Scenario? = null
     /** The events for the scenario currently processed. */
@@ -76,8 +87,15 @@ internal class DebugEngine : ScenarioProcessingListener {
     private val _debugReport = MutableStateFlow<DebugReport?>(null)
     val debugReport: Flow<DebugReport?> = _debugReport
 
-    /** The DebugInfo for the current image. */
-    val currentInfo = MutableSharedFlow<DebugInfo?>()
+    /** The last positive detection, read by the debug overlay without ever blocking the detection. */
+    val lastPositiveSnapshot = DebugInfoSnapshot()
+
+    override val progressSamplingPeriod: Int
+        get() = if (sampleImages) DEBUG_SAMPLING_PERIOD else 1
+
+    /** The image events are recorded once per screen image, with the durations measured by the native detector. */
+    override val isBatchedProgress: Boolean
+        get() = true
 
     override suspend fun onSessionStarted(
         context: Context,
@@ -93,10 +111,14 @@ internal class DebugEngine : ScenarioProcessingListener {
         with(context.getDebugConfigPreferences()) {
             instantData = getIsDebugViewEnabled(context)
             generateReport = getIsDebugReportEnabled(context)
+            sampleImages = getIsDebugSamplingEnabled(context)
         }
 
         currentScenario = scenario
         currentEvents = imageEvents.toList()
+        conditionsStatisticsMap = emptyMap()
+        cacheStatistics = emptyList()
+        latencyStatistics = null
 
         if (generateReport) sessionRecorder.onProcessingStart()
     }
@@ -160,29 +182,62 @@ internal class DebugEngine : ScenarioProcessingListener {
         }
 
         // Notify current detection progress
-        val conditionResults = results.getFirstImageDetectedResult() ?: let {
-            currentInfo.emit(null)
-            return@withLock
-        }
-        if (instantData) {
-            val halfWidth = conditionResults.condition.area.width() / 2
-            val halfHeight = conditionResults.condition.area.height() / 2
-
-            val coordinates = if (conditionResults.position.x == 0 && conditionResults.position.y == 0) Rect()
-            else Rect(
-                conditionResults.position.x - halfWidth,
-                conditionResults.position.y - halfHeight,
-                conditionResults.position.x + halfWidth,
-                conditionResults.position.y + halfHeight
-            )
+        publishCurrentInfo(event, results)
+    }
 
-            val info = DebugInfo(event, conditionResults.condition, conditionResults.haveBeenDetected,
-                conditionResults.position, conditionResults.confidenceRate, coordinates)
+    override suspend fun onImageEventsProcessed(results: List<ImageEventResult>) = mutex.withLock {
+        if (generateReport) {
+            results.forEach { eventResult ->
+                eventsRecorderMap
+                    .getOrDefaultWithPut(eventResult.event.id.databaseId) { Recorder() }
+                    .onProcessed(eventResult.detectionDurationNs, eventResult.results.fulfilled == true)
+
+                eventResult.results.getAllResults().forEach { result ->
+                    if (result is ImageConditionResult) {
+                        conditionsRecorderMap
+                            .getOrDefaultWithPut(result.condition.id.databaseId) { ConditionRecorder() }
+                            .onProcessed(result.detectionDurationNs, result.haveBeenDetected, result.confidenceRate)
+                    }
+                }
+            }
+        }
 
-            currentInfo.emit(info)
+        // Notify the detection progress with the first event detecting a condition
+        results.firstOrNull { it.results.getFirstImageDetectedResult() != null }?.let { detectedResult ->
+            publishCurrentInfo(detectedResult.event, detectedResult.results)
         }
     }
 
+    private fun publishCurrentInfo(event: ImageEvent, results: IConditionsResult) {
+        if (!instantData) return
+        val conditionResults = results.getFirstImageDetectedResult() ?: return
+
+        lastPositiveSnapshot.publish(
+            eventName = event.name,
+            conditionName = conditionResults.condition.name,
+            confidenceRate = conditionResults.confidenceRate,
+            p95DurationNs = conditionsStatisticsMap[conditionResults.condition.id.databaseId]?.p95DurationNs ?: -1,
+        )
+    }
+
+    override suspend fun onConditionStatisticsUpdated(statistics: List<ConditionStatistics>) = mutex.withLock {
+        if (!instantData && !generateReport) return
+
+        conditionsStatisticsMap = statistics.associateBy { it.conditionId }
+    }
+
+    override suspend fun onCacheStatisticsUpdated(statistics: List<DetectorCacheStatistics>) = mutex.withLock {
+        if (!generateReport) return
+
+        cacheStatistics = statistics
+    }
+
+    override suspend fun onLatencyStatisticsUpdated(statistics: LatencyStatistics) = mutex.withLock {
+        if (!generateReport) return
+
+        latencyStatistics = statistics
+    }
+
     override suspend fun onImageEventsProcessingCompleted() = mutex.withLock {
         if (!generateReport) return
 
@@ -190,7 +245,7 @@ internal class DebugEngine : ScenarioProcessingListener {
     }
 
     override suspend fun onSessionEnded() = mutex.withLock {
-        currentInfo.emit(null)
+        lastPositiveSnapshot.clear()
 
         if (!generateReport) {
             _isDebugging.value = false
@@ -226,7 +281,8 @@ internal class DebugEngine : ScenarioProcessingListener {
                 processingRecorder.toConditionProcessingDebugInfo()
             } ?: ConditionProcessingDebugInfo()
 
-            conditionReport[condition.id.databaseId] = condition to debugInfo
+            conditionReport[condition.id.databaseId] =
+                condition to debugInfo.copy(detectionStatistics = conditionsStatisticsMap[condition.id.databaseId])
         }
 
         _debugReport.value = DebugReport(
@@ -237,6 +293,8 @@ internal class DebugEngine : ScenarioProcessingListener {
             eventsReport,
             conditionsDetectedCount,
             conditionReport,
+            latencyStatistics,
+            cacheStatistics,
         )
 
         currProcEvtId = null
@@ -245,6 +303,8 @@ internal class DebugEngine : ScenarioProcessingListener {
         imageRecorder.clear()
         eventsRecorderMap.clear()
         conditionsRecorderMap.clear()
+        latencyStatistics = null
+        cacheStatistics = emptyList()
 
         _isDebugging.value = false
     }
@@ -271,4 +331,7 @@ private fun <K, V> MutableMap<K, V>.getOrDefaultWithPut(key: K, newValue: () ->
         }
     }
 
+/** Number of screen images processed for each debugged one, when the debugged images are sampled. */
+private const val DEBUG_SAMPLING_PERIOD = 10
+
 private const val TAG = "DebugEngine"
\ No newline at end of file
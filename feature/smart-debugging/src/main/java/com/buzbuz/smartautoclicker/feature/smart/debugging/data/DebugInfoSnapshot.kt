@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2025 Kevin Buzeau
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+package com.buzbuz.smartautoclicker.feature.smart.debugging.data
+
+import java.util.concurrent.atomic.AtomicInteger
+
+/**
+ * The last positive detection of the debugged session, published by the detection and read by the debug overlay at
+ * each display frame.
+ *
+ * Lock free, with the detection as single writer and the overlay as single reader: the detection fills its buffer and
+ * exchanges it with the published one, the overlay exchanges its buffer with the published one when a new one is
+ * available. A third buffer lets both sides swap without ever waiting for the other, and no value is allocated by
+ * the publications or the reads.
+ */
+internal class DebugInfoSnapshot {
+
+    /** The values of a positive detection, read only for the overlay. */
+    class Values {
+        /** The name of the detected event, empty if there is none. */
+        var eventName: String = ""
+            internal set
+        /** The name of the detected condition, empty if there is none. */
+        var conditionName: String = ""
+            internal set
+        var confidenceRate: Double = 0.0
+            internal set
+        /** The 95th percentile of the recent searches durations of the condition, in nanoseconds. -1 if unknown. */
+        var p95DurationNs: Long = -1
+            internal set
+        /** The time of the detection, in the [System.nanoTime] time base. */
+        var timestampNs: Long = 0
+            internal set
+        /** Incremented at each publication, tells if the values changed since the previous read. */
+        var version: Long = 0
+            internal set
+    }
+
+    private val buffers: Array<Values> = Array(BUFFER_COUNT) { Values() }
+    /** The index of the last published buffer, with [FLAG_UNREAD] until the overlay reads it. */
+    private val publishedIndex = AtomicInteger(1)
+    /** The index of the buffer filled by the detection. Only used by the writer. */
+    private var writeIndex = 0
+    /** The index of the buffer read by the overlay. Only used by the reader. */
+    private var readIndex = 2
+    /** The version of the last publication. Only used by the writer. */
+    private var publishedVersion = 0L
+
+    /** Publish a positive detection. Must be called by the detection only. */
+    fun publish(eventName: String, conditionName: String, confidenceRate: Double, p95DurationNs: Long) {
+        buffers[writeIndex].apply {
+            this.eventName = eventName
+            this.conditionName = conditionName
+            this.confidenceRate = confidenceRate
+            this.p95DurationNs = p95DurationNs
+            timestampNs = System.nanoTime()
+            version = ++publishedVersion
+        }
+        writeIndex = publishedIndex.getAndSet(writeIndex or FLAG_UNREAD) and INDEX_MASK
+    }
+
+    /** Publish the absence of detection, once the session is over. Must be called by the detection only. */
+    fun clear() {
+        publish(eventName = "", conditionName = "", confidenceRate = 0.0, p95DurationNs = -1)
+    }
+
+    /**
+     * Read the last publication. Must be called by the overlay only.
+     * @return the last published values, unchanged until the next call.
+     */
+    fun read(): Values {
+        if (publishedIndex.get() and FLAG_UNREAD != 0) {
+            readIndex = publishedIndex.getAndSet(readIndex) and INDEX_MASK
+        }
+        return buffers[readIndex]
+    }
+}
+
+/** One buffer for the writer, one for the reader, and the published one between them. */
+private const val BUFFER_COUNT = 3
+/** Set on the published index while the buffer haven't been read. */
+private const val FLAG_UNREAD = 0x4
+/** Mask of the buffer index in the published index. */
+private const val INDEX_MASK = 0x3
@@ -41,7 +41,16 @@ internal open class Recorder {
 
     open fun onProcessingEnd(success: Boolean = true) {
         processingTimingRecorder.stopRecord()
+        countProcessing(success)
+    }
+
+    /** Record a processing whose duration have been measured elsewhere, such as by the native detector. */
+    open fun onProcessed(durationNs: Long, success: Boolean = true) {
+        processingTimingRecorder.record(durationNs)
+        countProcessing(success)
+    }
 
+    private fun countProcessing(success: Boolean) {
         count++
         if (success) successCount++
     }
@@ -74,6 +83,11 @@ internal class ConditionRecorder : Recorder() {
         if (newResult != null) detectionResultsRecorder.recordResult(newResult)
     }
 
+    fun onProcessed(durationNs: Long, success: Boolean, newResult: Double?) {
+        super.onProcessed(durationNs, success)
+        if (newResult != null) detectionResultsRecorder.recordResult(newResult)
+    }
+
     fun toConditionProcessingDebugInfo() = ConditionProcessingDebugInfo(
         processingCount = count,
         successCount = successCount,
@@ -93,6 +107,8 @@ internal class ConditionRecorder : Recorder() {
 
     override fun onProcessingEnd(success: Boolean) =
         throw UnsupportedOperationException("You must use onProcessingEnd(Boolean, Double?)")
+    override fun onProcessed(durationNs: Long, success: Boolean) =
+        throw UnsupportedOperationException("You must use onProcessed(Long, Boolean, Double?)")
     override fun toProcessingDebugInfo() =
         throw UnsupportedOperationException("You must use toConditionProcessingDebugInfo()")
 }
@@ -121,6 +137,15 @@ internal class TimingRecorder {
         val processingDurationMs =  System.currentTimeMillis() - currentRecordStartTimeMs
         currentRecordStartTimeMs = INVALID_TIME_VALUE
 
+        recordMs(processingDurationMs)
+    }
+
+    /** Record an event lasting [durationNs], measured without [startRecord]. */
+    fun record(durationNs: Long) {
+        recordMs(durationNs / NANOS_PER_MILLI)
+    }
+
+    private fun recordMs(processingDurationMs: Long) {
         totalTimeMs += processingDurationMs
         minTimeMs = min(processingDurationMs, minTimeMs)
         maxTimeMs = max(processingDurationMs, maxTimeMs)
@@ -160,4 +185,6 @@ internal class MinMaxTotalRecorder {
     }
 }
 
-internal const val INVALID_TIME_VALUE = -1L
\ No newline at end of file
+internal const val INVALID_TIME_VALUE = -1L
+/** Number of nanoseconds in a millisecond. */
+private const val NANOS_PER_MILLI = 1_000_000L
\ No newline at end of file
@@ -16,6 +16,8 @@
  */
 package com.buzbuz.smartautoclicker.feature.smart.debugging.domain
 
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+
 data class ConditionProcessingDebugInfo(
     val processingCount: Long = 0,
     val successCount: Long = 0,
@@ -26,4 +28,6 @@ data class ConditionProcessingDebugInfo(
     val avgConfidenceRate: Double = 0.0,
     val minConfidenceRate: Double = 0.0,
     val maxConfidenceRate: Double = 0.0,
+    /** The statistics of the recent native searches of the condition, null if it was never searched. */
+    val detectionStatistics: ConditionStatistics? = null,
 )
\ No newline at end of file
@@ -1,33 +0,0 @@
-/*
- * Copyright (C) 2023 Kevin Buzeau
- * 
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- * 
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- * 
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- */
-package com.buzbuz.smartautoclicker.feature.smart.debugging.domain
-
-import android.graphics.Point
-import android.graphics.Rect
-
-import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
-import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
-
-/** Debug information for the scenario processing */
-data class DebugInfo(
-    val event: ImageEvent,
-    val condition: ImageCondition,
-    val isDetected: Boolean,
-    val position: Point = Point(),
-    val confidenceRate: Double,
-    val conditionArea: Rect,
-)
\ No newline at end of file
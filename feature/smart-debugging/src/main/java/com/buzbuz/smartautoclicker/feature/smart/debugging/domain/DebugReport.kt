@@ -16,9 +16,11 @@
  */
 package com.buzbuz.smartautoclicker.feature.smart.debugging.domain
 
+import com.buzbuz.smartautoclicker.core.detection.DetectorCacheStatistics
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.model.event.ImageEvent
 import com.buzbuz.smartautoclicker.core.domain.model.scenario.Scenario
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStatistics
 
 data class DebugReport(
     val scenario: Scenario,
@@ -28,4 +30,8 @@ data class DebugReport(
     val eventsProcessedInfo: List<Pair<ImageEvent, ProcessingDebugInfo>>,
     val conditionsDetectedCount: Long,
     val conditionsProcessedInfo: Map<Long, Pair<ImageCondition, ConditionProcessingDebugInfo>>,
+    /** The latencies of the reaction to the screen frames during the session, null if they are not available. */
+    val latencyStatistics: LatencyStatistics? = null,
+    /** The lookups of the native detector caches during the session, empty if they are not available. */
+    val cacheStatistics: List<DetectorCacheStatistics> = emptyList(),
 )
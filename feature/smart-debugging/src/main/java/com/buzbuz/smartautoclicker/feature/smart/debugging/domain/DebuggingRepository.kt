@@ -21,15 +21,17 @@ import android.content.SharedPreferences
 
 import com.buzbuz.smartautoclicker.core.processing.domain.ScenarioProcessingListener
 import com.buzbuz.smartautoclicker.feature.smart.debugging.data.DebugEngine
+import com.buzbuz.smartautoclicker.feature.smart.debugging.data.DebugInfoSnapshot
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getDebugConfigPreferences
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugReportEnabled
+import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugSamplingEnabled
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugViewEnabled
 import com.buzbuz.smartautoclicker.feature.smart.debugging.putIsDebugReportEnabled
+import com.buzbuz.smartautoclicker.feature.smart.debugging.putIsDebugSamplingEnabled
 import com.buzbuz.smartautoclicker.feature.smart.debugging.putIsDebugViewEnabled
 import dagger.hilt.android.qualifiers.ApplicationContext
 
 import kotlinx.coroutines.flow.Flow
-import kotlinx.coroutines.flow.filter
 import javax.inject.Inject
 import javax.inject.Singleton
 
@@ -49,12 +51,12 @@ class DebuggingRepository @Inject constructor(
     /** The debug report. Set once the detection session is complete. */
     val debugReport: Flow<DebugReport?> = debugEngine.debugReport
 
-    /** The DebugInfo for the current image. */
-    val lastResult: Flow<DebugInfo?> = debugEngine.currentInfo
-
-    /** The DebugInfo for the last positive detection. */
-    val lastPositiveInfo: Flow<DebugInfo?> = debugEngine.currentInfo
-        .filter { it?.isDetected ?: false }
+    /**
+     * Read the last positive detection without blocking the detection.
+     * Must always be called from the same thread, the returned values are reused by the next calls.
+     */
+    internal fun readLastPositive(): DebugInfoSnapshot.Values =
+        debugEngine.lastPositiveSnapshot.read()
 
     /**
      * The listener upon scenario detection progress.
@@ -70,10 +72,14 @@ class DebuggingRepository @Inject constructor(
     fun isDebugReportEnabled(context: Context): Boolean =
         sharedPreferences.getIsDebugReportEnabled(context)
 
-    fun setDebuggingConfig(debugView: Boolean, debugReport: Boolean) =
+    fun isDebugSamplingEnabled(context: Context): Boolean =
+        sharedPreferences.getIsDebugSamplingEnabled(context)
+
+    fun setDebuggingConfig(debugView: Boolean, debugReport: Boolean, debugSampling: Boolean) =
         sharedPreferences
             .edit()
             .putIsDebugViewEnabled(debugView)
             .putIsDebugReportEnabled(debugReport)
+            .putIsDebugSamplingEnabled(debugSampling)
             .apply()
 }
\ No newline at end of file
@@ -20,23 +20,23 @@ import android.content.Context
 import android.content.SharedPreferences
 import androidx.lifecycle.ViewModel
 
+import com.buzbuz.smartautoclicker.feature.smart.debugging.R
+import com.buzbuz.smartautoclicker.feature.smart.debugging.data.DebugInfoSnapshot
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.DebuggingRepository
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getDebugConfigPreferences
 import com.buzbuz.smartautoclicker.feature.smart.debugging.getIsDebugViewEnabled
 import com.buzbuz.smartautoclicker.feature.smart.debugging.ui.report.formatConfidenceRate
+import com.buzbuz.smartautoclicker.feature.smart.debugging.ui.report.formatNanosDuration
 
 import dagger.hilt.android.qualifiers.ApplicationContext
 
-import kotlinx.coroutines.ExperimentalCoroutinesApi
-import kotlinx.coroutines.delay
 import kotlinx.coroutines.flow.*
 import javax.inject.Inject
 
 /** ViewModel for the debug features. */
-@OptIn(ExperimentalCoroutinesApi::class)
 class DebugModel @Inject constructor(
-    @ApplicationContext context: Context,
-    debuggingRepository: DebuggingRepository
+    @ApplicationContext private val context: Context,
+    private val debuggingRepository: DebuggingRepository,
 ) : ViewModel() {
 
     /** Debug configuration shared preferences. */
@@ -47,31 +47,47 @@ class DebugModel @Inject constructor(
         debugging && sharedPreferences.getIsDebugViewEnabled(context)
     }
 
-    /** The info on the last positive detection. */
-    val debugLastPositive: Flow<LastPositiveDebugInfo> = debuggingRepository.lastPositiveInfo
-        .transformLatest { debugInfo ->
-            if (debugInfo == null) {
-                emit(LastPositiveDebugInfo())
-                return@transformLatest
-            }
+    /** The version of the snapshot values used for [lastPositive]. */
+    private var lastPositiveVersion: Long = 0
+    /** The info on the last positive detection, rebuilt only when a new one is published. */
+    private var lastPositive: LastPositiveDebugInfo = EMPTY_LAST_POSITIVE
 
-            emit(
-                LastPositiveDebugInfo(
-                    debugInfo.event.name,
-                    debugInfo.condition.name,
-                    debugInfo.confidenceRate.formatConfidenceRate(),
-                )
-            )
-            delay(POSITIVE_VALUE_DISPLAY_TIMEOUT_MS)
-            emit(LastPositiveDebugInfo())
-        }
+    /**
+     * Get the info on the last positive detection, to be displayed at the given frame.
+     * Must be called from the main thread. Returns the same instance as long as the info doesn't change.
+     *
+     * @param frameTimeNs the time of the display frame, in the [System.nanoTime] time base.
+     */
+    fun getDebugLastPositive(frameTimeNs: Long): LastPositiveDebugInfo {
+        val values = debuggingRepository.readLastPositive()
+        if (frameTimeNs - values.timestampNs > POSITIVE_VALUE_DISPLAY_TIMEOUT_NS) return EMPTY_LAST_POSITIVE
+        if (values.version == lastPositiveVersion) return lastPositive
+
+        lastPositiveVersion = values.version
+        lastPositive =
+            if (values.conditionName.isEmpty()) EMPTY_LAST_POSITIVE
+            else LastPositiveDebugInfo(values.eventName, values.conditionName, values.getConfidenceRateText())
+
+        return lastPositive
+    }
+
+    // The slow searches are the ones to look for when a scenario lags
+    private fun DebugInfoSnapshot.Values.getConfidenceRateText(): String {
+        val confidenceRateText = confidenceRate.formatConfidenceRate()
+        return if (p95DurationNs < 0) confidenceRateText
+        else context.getString(
+            R.string.overlay_debug_confidence_and_p95_duration,
+            confidenceRateText,
+            p95DurationNs.formatNanosDuration(),
+        )
+    }
 }
 
 /**
  * Info on the last positive detection.
  * @param eventName name of the event
  * @param conditionName the name of the condition detected.
- * @param confidenceRateText the text to display for the confidence rate
+ * @param confidenceRateText the text to display for the confidence rate, with the slowest searches duration if known.
  */
 data class LastPositiveDebugInfo(
     val eventName: String = "",
@@ -79,5 +95,8 @@ data class LastPositiveDebugInfo(
     val confidenceRateText: String = "",
 )
 
-/** Delay before removing the last positive result display in debug. */
-private const val POSITIVE_VALUE_DISPLAY_TIMEOUT_MS = 1500L
\ No newline at end of file
+/** The info displayed when there is no recent positive detection. */
+private val EMPTY_LAST_POSITIVE = LastPositiveDebugInfo()
+
+/** Delay before removing the last positive result display in debug, in nanoseconds. */
+private const val POSITIVE_VALUE_DISPLAY_TIMEOUT_NS = 1_500_000_000L
\ No newline at end of file
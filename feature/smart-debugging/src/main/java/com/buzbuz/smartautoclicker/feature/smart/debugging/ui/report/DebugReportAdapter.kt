@@ -103,6 +103,46 @@ class ScenarioDebugInfoViewHolder(
                 R.string.item_title_report_detection_count,
                 item.conditionsDetected,
             )
+            rootCaptureLatency.setValue(
+                R.string.item_title_report_capture_latency,
+                item.captureLatency,
+            )
+            rootIngestLatency.setValue(
+                R.string.item_title_report_ingest_latency,
+                item.ingestLatency,
+            )
+            rootDetectLatency.setValue(
+                R.string.item_title_report_detect_latency,
+                item.detectLatency,
+            )
+            rootDispatchLatency.setValue(
+                R.string.item_title_report_dispatch_latency,
+                item.dispatchLatency,
+            )
+            rootEndToEndLatency.setValue(
+                R.string.item_title_report_end_to_end_latency,
+                item.endToEndLatency,
+            )
+            rootTemplatesCache.setValue(
+                R.string.item_title_report_templates_cache,
+                item.templatesCache,
+            )
+            rootOcrTextsCache.setValue(
+                R.string.item_title_report_ocr_texts_cache,
+                item.ocrTextsCache,
+            )
+            rootMatchMemoCache.setValue(
+                R.string.item_title_report_match_memo_cache,
+                item.matchMemoCache,
+            )
+            rootFrameDiffCache.setValue(
+                R.string.item_title_report_frame_diff_cache,
+                item.frameDiffCache,
+            )
+            rootPyramidCache.setValue(
+                R.string.item_title_report_pyramid_cache,
+                item.pyramidCache,
+            )
         }
     }
 }
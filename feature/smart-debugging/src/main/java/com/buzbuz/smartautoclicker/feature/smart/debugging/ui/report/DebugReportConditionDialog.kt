@@ -68,6 +68,35 @@ class DebugReportConditionDialog(private val conditionReport: ConditionReport) :
                 conditionReport.avgConfidence,
                 conditionReport.maxConfidence,
             )
+
+            rootDetectionTiming.setValues(
+                R.string.section_title_report_detection_median,
+                conditionReport.medianDetectionDuration,
+                R.string.section_title_report_detection_p95,
+                conditionReport.p95DetectionDuration,
+            )
+
+            rootDetectionCost.setValues(
+                R.string.section_title_report_detection_candidates,
+                conditionReport.avgCandidateCount,
+                R.string.section_title_report_detection_ocr,
+                conditionReport.avgOcrDuration,
+            )
+
+            rootMatchBackend.setValue(
+                R.string.section_title_report_detection_backend,
+                conditionReport.matchBackend,
+            )
+
+            rootDetectionQuality.setValue(
+                R.string.section_title_report_detection_quality,
+                conditionReport.minDetectionQuality,
+            )
+
+            rootLearnedArea.setValue(
+                R.string.section_title_report_learned_area,
+                conditionReport.learnedArea,
+            )
         }
     }
 }
\ No newline at end of file
@@ -17,12 +17,18 @@
 package com.buzbuz.smartautoclicker.feature.smart.debugging.ui.report
 
 import android.graphics.Bitmap
+import android.graphics.Rect
 
 import androidx.lifecycle.ViewModel
 import androidx.lifecycle.viewModelScope
 
+import com.buzbuz.smartautoclicker.core.detection.ConditionStatistics
+import com.buzbuz.smartautoclicker.core.detection.DetectorCacheStatistics
+import com.buzbuz.smartautoclicker.core.detection.DetectorCacheType
 import com.buzbuz.smartautoclicker.core.domain.model.condition.ImageCondition
 import com.buzbuz.smartautoclicker.core.domain.IRepository
+import com.buzbuz.smartautoclicker.core.processing.domain.LatencyStage
+import com.buzbuz.smartautoclicker.core.processing.domain.StageLatency
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.ConditionProcessingDebugInfo
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.DebugReport
 import com.buzbuz.smartautoclicker.feature.smart.debugging.domain.DebuggingRepository
@@ -37,6 +43,8 @@ import kotlinx.coroutines.flow.Flow
 import javax.inject.Inject
 import kotlin.coroutines.cancellation.CancellationException
 import kotlin.time.Duration.Companion.milliseconds
+import kotlin.time.Duration.Companion.nanoseconds
+import kotlin.time.DurationUnit
 
 /** ViewModel for the [DebugReportDialog]. */
 class DebugReportModel @Inject constructor(
@@ -80,7 +88,7 @@ class DebugReportModel @Inject constructor(
     fun getConditionBitmap(condition: ImageCondition, onBitmapLoaded: (Bitmap?) -> Unit): Job {
         return viewModelScope.launch(Dispatchers.IO) {
             try {
-                val bitmap = repository.getConditionBitmap(condition)
+                val bitmap = repository.getConditionThumbnail(condition)
                 withContext(Dispatchers.Main) {
                     onBitmapLoaded.invoke(bitmap)
                 }
@@ -99,6 +107,16 @@ class DebugReportModel @Inject constructor(
             averageImageProcessingTime = averageImageProcessingTime.formatDuration(),
             eventsTriggered = debugInfo.eventsTriggeredCount.toString(),
             conditionsDetected = debugInfo.conditionsDetectedCount.toString(),
+            captureLatency = debugInfo.latencyStatistics?.stages?.get(LatencyStage.CAPTURE).formatLatency(),
+            ingestLatency = debugInfo.latencyStatistics?.stages?.get(LatencyStage.INGEST).formatLatency(),
+            detectLatency = debugInfo.latencyStatistics?.stages?.get(LatencyStage.DETECT).formatLatency(),
+            dispatchLatency = debugInfo.latencyStatistics?.stages?.get(LatencyStage.DISPATCH).formatLatency(),
+            endToEndLatency = debugInfo.latencyStatistics?.stages?.get(LatencyStage.END_TO_END).formatLatency(),
+            templatesCache = debugInfo.cacheStatistics.formatCache(DetectorCacheType.TEMPLATES),
+            ocrTextsCache = debugInfo.cacheStatistics.formatCache(DetectorCacheType.OCR_TEXTS),
+            matchMemoCache = debugInfo.cacheStatistics.formatCache(DetectorCacheType.MATCH_MEMO),
+            frameDiffCache = debugInfo.cacheStatistics.formatCache(DetectorCacheType.FRAME_DIFF),
+            pyramidCache = debugInfo.cacheStatistics.formatCache(DetectorCacheType.PYRAMID),
         )
 
     private fun newEventItem(id: Long, name: String, debugInfo: ProcessingDebugInfo, conditionReports: List<ConditionReport>) =
@@ -133,6 +151,13 @@ class DebugReportModel @Inject constructor(
             avgConfidence = debugInfo.avgConfidenceRate.formatConfidenceRate(),
             minConfidence = debugInfo.minConfidenceRate.formatConfidenceRate(),
             maxConfidence = debugInfo.maxConfidenceRate.formatConfidenceRate(),
+            medianDetectionDuration = debugInfo.detectionStatistics?.medianDurationNs.formatNanosDuration(),
+            p95DetectionDuration = debugInfo.detectionStatistics?.p95DurationNs.formatNanosDuration(),
+            avgCandidateCount = debugInfo.detectionStatistics.formatAverageCandidateCount(),
+            avgOcrDuration = debugInfo.detectionStatistics?.averageOcrDurationNs.formatNanosDuration(),
+            matchBackend = debugInfo.detectionStatistics?.matchBackend?.name ?: "-",
+            minDetectionQuality = debugInfo.detectionStatistics?.minDetectionQuality?.toString() ?: "-",
+            learnedArea = debugInfo.detectionStatistics?.learnedArea.formatArea(),
         )
 }
 
@@ -149,6 +174,16 @@ sealed class DebugReportItem {
         val averageImageProcessingTime: String,
         val eventsTriggered: String,
         val conditionsDetected: String,
+        val captureLatency: String,
+        val ingestLatency: String,
+        val detectLatency: String,
+        val dispatchLatency: String,
+        val endToEndLatency: String,
+        val templatesCache: String,
+        val ocrTextsCache: String,
+        val matchMemoCache: String,
+        val frameDiffCache: String,
+        val pyramidCache: String,
     ) : DebugReportItem()
 
     data class EventReportItem(
@@ -174,6 +209,13 @@ data class ConditionReport(
     val avgConfidence: String,
     val minConfidence: String,
     val maxConfidence: String,
+    val medianDetectionDuration: String,
+    val p95DetectionDuration: String,
+    val avgCandidateCount: String,
+    val avgOcrDuration: String,
+    val matchBackend: String,
+    val minDetectionQuality: String,
+    val learnedArea: String,
 )
 
 /** Format this value as a displayable confidence rate. */
@@ -181,4 +223,32 @@ fun Double.formatConfidenceRate(): String = "${String.format("%.2f", this * 100)
 
 private fun Long.formatDuration(): String =
     if (this < 1) "< 1ms"
-    else milliseconds.toString()
\ No newline at end of file
+    else milliseconds.toString()
+
+/** Format this native duration as a displayable one, with a sub millisecond precision. */
+fun Long?.formatNanosDuration(): String =
+    if (this == null) "-"
+    else nanoseconds.toString(DurationUnit.MILLISECONDS, decimals = 2)
+
+/** Format the latency of a stage as its median, 95th percentile and maximum durations. */
+private fun StageLatency?.formatLatency(): String =
+    if (this == null) "-"
+    else "${medianNs.formatNanosDuration()} / ${p95Ns.formatNanosDuration()} / ${maxNs.formatNanosDuration()}"
+
+/** Format the statistics of a native cache as its hit rate, eviction count and size. */
+private fun List<DetectorCacheStatistics>.formatCache(type: DetectorCacheType): String {
+    val statistics = firstOrNull { it.type == type } ?: return "-"
+    if (statistics.hitCount + statistics.missCount == 0L) return "-"
+
+    return "${String.format("%.1f", statistics.hitRate * 100)} % / ${statistics.evictionCount} / " +
+            "${statistics.sizeBytes / 1024} KiB"
+}
+
+/** Format this screen area as its top left corner and its size, in pixels. */
+private fun Rect?.formatArea(): String =
+    if (this == null) "-"
+    else "$left, $top / ${width()} x ${height()}"
+
+private fun ConditionStatistics?.formatAverageCandidateCount(): String =
+    if (this == null) "-"
+    else String.format("%.1f", averageCandidateCount)
\ No newline at end of file
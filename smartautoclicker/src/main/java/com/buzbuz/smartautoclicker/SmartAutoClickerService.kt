@@ -157,6 +157,7 @@ class SmartAutoClickerService : AccessibilityService(), SmartActionExecutor {
 
         displayConfigManager.startMonitoring(this)
         tileRepository.setTileScenario(scenarioId = scenarioId, isSmart = isSmart)
+        setForegroundAppMonitored(isSmart && settingsRepository.isDetectionGateEnabled())
     }
 
     private fun onLocalServiceStopped() {
@@ -173,12 +174,23 @@ class SmartAutoClickerService : AccessibilityService(), SmartActionExecutor {
         }
 
         requestFilterKeyEvents(false)
+        setForegroundAppMonitored(false)
         stopForeground(STOP_FOREGROUND_REMOVE)
 
         displayConfigManager.stopMonitoring()
         bitmapManager.releaseCache()
     }
 
+    /**
+     * Listen to the windows changes to know the app in the foreground. Not declared in the service configuration, to
+     * avoid receiving the events when they are not needed.
+     */
+    private fun setForegroundAppMonitored(monitored: Boolean) {
+        val info = serviceInfo ?: return
+        info.eventTypes = if (monitored) AccessibilityEvent.TYPE_WINDOW_STATE_CHANGED else 0
+        serviceInfo = info
+    }
+
     override fun onKeyEvent(event: KeyEvent?): Boolean =
         localService?.onKeyEvent(event) ?: super.onKeyEvent(event)
 
@@ -227,8 +239,18 @@ class SmartAutoClickerService : AccessibilityService(), SmartActionExecutor {
     }
 
     override fun onInterrupt() { /* Unused */ }
-    override fun onAccessibilityEvent(event: AccessibilityEvent?) { /* Unused */ }
+    override fun onAccessibilityEvent(event: AccessibilityEvent?) {
+        if (event?.eventType != AccessibilityEvent.TYPE_WINDOW_STATE_CHANGED || !event.isFullScreen) return
+
+        // The overlays and the system ui (notification shade, dialogs...) are displayed over the app in the foreground
+        val packageName = event.packageName?.toString() ?: return
+        if (packageName == this.packageName || packageName == SYSTEM_UI_PACKAGE_NAME) return
+
+        detectionRepository.onForegroundAppChanged(packageName)
+    }
 }
 
 /** Tag for the logs. */
-private const val TAG = "SmartAutoClickerService"
\ No newline at end of file
+private const val TAG = "SmartAutoClickerService"
+/** The package of the Android system ui. */
+private const val SYSTEM_UI_PACKAGE_NAME = "com.android.systemui"
\ No newline at end of file
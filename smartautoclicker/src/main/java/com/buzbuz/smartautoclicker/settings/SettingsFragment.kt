@@ -81,6 +81,240 @@ class SettingsFragment : Fragment() {
             setOnClickListener(viewModel::toggleInputBlockWorkaround)
         }
 
+        viewBinding.fieldPyramidMatching.apply {
+            setTitle(requireContext().getString(R.string.field_pyramid_matching_title))
+            setDescription(requireContext().getString(R.string.field_pyramid_matching_desc))
+            setOnClickListener(viewModel::togglePyramidMatching)
+        }
+
+        viewBinding.fieldMultiScaleMatching.apply {
+            setTitle(requireContext().getString(R.string.field_multi_scale_matching_title))
+            setDescription(requireContext().getString(R.string.field_multi_scale_matching_desc))
+            setOnClickListener(viewModel::toggleMultiScaleMatching)
+        }
+
+        viewBinding.fieldHistogramColorVerification.apply {
+            setTitle(requireContext().getString(R.string.field_histogram_color_verification_title))
+            setDescription(requireContext().getString(R.string.field_histogram_color_verification_desc))
+            setOnClickListener(viewModel::toggleHistogramColorVerification)
+        }
+
+        viewBinding.fieldScaledColorVerification.apply {
+            setTitle(requireContext().getString(R.string.field_scaled_color_verification_title))
+            setDescription(requireContext().getString(R.string.field_scaled_color_verification_desc))
+            setOnClickListener(viewModel::toggleScaledColorVerification)
+        }
+
+        viewBinding.fieldDownscaledCapture.apply {
+            setTitle(requireContext().getString(R.string.field_downscaled_capture_title))
+            setDescription(requireContext().getString(R.string.field_downscaled_capture_desc))
+            setOnClickListener(viewModel::toggleDownscaledCapture)
+        }
+
+        viewBinding.fieldIntegerMatching.apply {
+            setTitle(requireContext().getString(R.string.field_integer_matching_title))
+            setDescription(requireContext().getString(R.string.field_integer_matching_desc))
+            setOnClickListener(viewModel::toggleIntegerMatching)
+        }
+
+        viewBinding.fieldSparseMatching.apply {
+            setTitle(requireContext().getString(R.string.field_sparse_matching_title))
+            setDescription(requireContext().getString(R.string.field_sparse_matching_desc))
+            setOnClickListener(viewModel::toggleSparseMatching)
+        }
+
+        viewBinding.fieldBinaryMatching.apply {
+            setTitle(requireContext().getString(R.string.field_binary_matching_title))
+            setDescription(requireContext().getString(R.string.field_binary_matching_desc))
+            setOnClickListener(viewModel::toggleBinaryMatching)
+        }
+
+        viewBinding.fieldChamferMatching.apply {
+            setTitle(requireContext().getString(R.string.field_chamfer_matching_title))
+            setDescription(requireContext().getString(R.string.field_chamfer_matching_desc))
+            setOnClickListener(viewModel::toggleChamferMatching)
+        }
+
+        viewBinding.fieldMotionCompensation.apply {
+            setTitle(requireContext().getString(R.string.field_motion_compensation_title))
+            setDescription(requireContext().getString(R.string.field_motion_compensation_desc))
+            setOnClickListener(viewModel::toggleMotionCompensation)
+        }
+
+        viewBinding.fieldRotatedReader.apply {
+            setTitle(requireContext().getString(R.string.field_rotated_reader_title))
+            setDescription(requireContext().getString(R.string.field_rotated_reader_desc))
+            setOnClickListener(viewModel::toggleRotatedReader)
+        }
+
+        viewBinding.fieldIdleConditionsCompaction.apply {
+            setTitle(requireContext().getString(R.string.field_idle_conditions_compaction_title))
+            setDescription(requireContext().getString(R.string.field_idle_conditions_compaction_desc))
+            setOnClickListener(viewModel::toggleIdleConditionsCompaction)
+        }
+
+        viewBinding.fieldTriggerOnlyCapturePause.apply {
+            setTitle(requireContext().getString(R.string.field_trigger_only_capture_pause_title))
+            setDescription(requireContext().getString(R.string.field_trigger_only_capture_pause_desc))
+            setOnClickListener(viewModel::toggleTriggerOnlyCapturePause)
+        }
+
+        viewBinding.fieldNativeScreenReader.apply {
+            setTitle(requireContext().getString(R.string.field_native_screen_reader_title))
+            setDescription(requireContext().getString(R.string.field_native_screen_reader_desc))
+            setOnClickListener(viewModel::toggleNativeScreenReader)
+        }
+
+        viewBinding.fieldAnimatedAreasExclusion.apply {
+            setTitle(requireContext().getString(R.string.field_animated_areas_exclusion_title))
+            setDescription(requireContext().getString(R.string.field_animated_areas_exclusion_desc))
+            setOnClickListener(viewModel::toggleAnimatedAreasExclusion)
+        }
+
+        viewBinding.fieldSystemBarsExclusion.apply {
+            setTitle(requireContext().getString(R.string.field_system_bars_exclusion_title))
+            setDescription(requireContext().getString(R.string.field_system_bars_exclusion_desc))
+            setOnClickListener(viewModel::toggleSystemBarsExclusion)
+        }
+
+        viewBinding.fieldScreenStatesGating.apply {
+            setTitle(requireContext().getString(R.string.field_screen_states_gating_title))
+            setDescription(requireContext().getString(R.string.field_screen_states_gating_desc))
+            setOnClickListener(viewModel::toggleScreenStatesGating)
+        }
+
+        viewBinding.fieldGpuMatching.apply {
+            setTitle(requireContext().getString(R.string.field_gpu_matching_title))
+            setDescription(requireContext().getString(R.string.field_gpu_matching_desc))
+            setOnClickListener(viewModel::toggleGpuMatching)
+        }
+
+        viewBinding.fieldNnapiMatching.apply {
+            setTitle(requireContext().getString(R.string.field_nnapi_matching_title))
+            setDescription(requireContext().getString(R.string.field_nnapi_matching_desc))
+            setOnClickListener(viewModel::toggleNnapiMatching)
+        }
+
+        viewBinding.fieldAdaptiveFramePacing.apply {
+            setTitle(requireContext().getString(R.string.field_adaptive_frame_pacing_title))
+            setDescription(requireContext().getString(R.string.field_adaptive_frame_pacing_desc))
+            setOnClickListener(viewModel::toggleAdaptiveFramePacing)
+        }
+
+        viewBinding.fieldThermalQualityScaling.apply {
+            setTitle(requireContext().getString(R.string.field_thermal_quality_scaling_title))
+            setDescription(requireContext().getString(R.string.field_thermal_quality_scaling_desc))
+            setOnClickListener(viewModel::toggleThermalQualityScaling)
+        }
+
+        viewBinding.fieldPerformanceThreads.apply {
+            setTitle(requireContext().getString(R.string.field_performance_threads_title))
+            setDescription(requireContext().getString(R.string.field_performance_threads_desc))
+            setOnClickListener(viewModel::togglePerformanceThreads)
+        }
+
+        viewBinding.fieldDetectorMemoryBudget.apply {
+            setTitle(requireContext().getString(R.string.field_detector_memory_budget_title))
+            setDescription(requireContext().getString(R.string.field_detector_memory_budget_desc))
+            setOnClickListener(viewModel::toggleDetectorMemoryBudget)
+        }
+
+        viewBinding.fieldDetectionCapture.apply {
+            setTitle(requireContext().getString(R.string.field_detection_capture_title))
+            setDescription(requireContext().getString(R.string.field_detection_capture_desc))
+            setOnClickListener(viewModel::toggleDetectionCapture)
+        }
+
+        viewBinding.fieldSpeculativeEvents.apply {
+            setTitle(requireContext().getString(R.string.field_speculative_events_title))
+            setDescription(requireContext().getString(R.string.field_speculative_events_desc))
+            setOnClickListener(viewModel::toggleSpeculativeEvents)
+        }
+
+        viewBinding.fieldStaleFrameDropping.apply {
+            setTitle(requireContext().getString(R.string.field_stale_frame_dropping_title))
+            setDescription(requireContext().getString(R.string.field_stale_frame_dropping_desc))
+            setOnClickListener(viewModel::toggleStaleFrameDropping)
+        }
+
+        viewBinding.fieldDetectionQualityTuning.apply {
+            setTitle(requireContext().getString(R.string.field_detection_quality_tuning_title))
+            setDescription(requireContext().getString(R.string.field_detection_quality_tuning_desc))
+            setOnClickListener(viewModel::toggleDetectionQualityTuning)
+        }
+
+        viewBinding.fieldFirstHitMatching.apply {
+            setTitle(requireContext().getString(R.string.field_first_hit_matching_title))
+            setDescription(requireContext().getString(R.string.field_first_hit_matching_desc))
+            setOnClickListener(viewModel::toggleFirstHitMatching)
+        }
+
+        viewBinding.fieldLearnedAreaMatching.apply {
+            setTitle(requireContext().getString(R.string.field_learned_area_matching_title))
+            setDescription(requireContext().getString(R.string.field_learned_area_matching_desc))
+            setOnClickListener(viewModel::toggleLearnedAreaMatching)
+        }
+
+        viewBinding.fieldIntegerScaleRatio.apply {
+            setTitle(requireContext().getString(R.string.field_integer_scale_ratio_title))
+            setDescription(requireContext().getString(R.string.field_integer_scale_ratio_desc))
+            setOnClickListener(viewModel::toggleIntegerScaleRatio)
+        }
+
+        viewBinding.fieldConditionTimeBudget.apply {
+            setTitle(requireContext().getString(R.string.field_condition_time_budget_title))
+            setDescription(requireContext().getString(R.string.field_condition_time_budget_desc))
+            setOnClickListener(viewModel::toggleConditionTimeBudget)
+        }
+
+        viewBinding.fieldPreciseDumbTiming.apply {
+            setTitle(requireContext().getString(R.string.field_precise_dumb_timing_title))
+            setDescription(requireContext().getString(R.string.field_precise_dumb_timing_desc))
+            setOnClickListener(viewModel::togglePreciseDumbTiming)
+        }
+
+        viewBinding.fieldGestureBatching.apply {
+            setTitle(requireContext().getString(R.string.field_gesture_batching_title))
+            setDescription(requireContext().getString(R.string.field_gesture_batching_desc))
+            setOnClickListener(viewModel::toggleGestureBatching)
+        }
+
+        viewBinding.fieldActionsOverlap.apply {
+            setTitle(requireContext().getString(R.string.field_actions_overlap_title))
+            setDescription(requireContext().getString(R.string.field_actions_overlap_desc))
+            setOnClickListener(viewModel::toggleActionsOverlap)
+        }
+
+        viewBinding.fieldDetectionGate.apply {
+            setTitle(requireContext().getString(R.string.field_detection_gate_title))
+            setDescription(requireContext().getString(R.string.field_detection_gate_desc))
+            setOnClickListener(viewModel::toggleDetectionGate)
+        }
+
+        viewBinding.fieldGpuFrameGate.apply {
+            setTitle(requireContext().getString(R.string.field_gpu_frame_gate_title))
+            setDescription(requireContext().getString(R.string.field_gpu_frame_gate_desc))
+            setOnClickListener(viewModel::toggleGpuFrameGate)
+        }
+
+        viewBinding.fieldScreenChangeWait.apply {
+            setTitle(requireContext().getString(R.string.field_screen_change_wait_title))
+            setDescription(requireContext().getString(R.string.field_screen_change_wait_desc))
+            setOnClickListener(viewModel::toggleScreenChangeWait)
+        }
+
+        viewBinding.fieldFrameAllocator.apply {
+            setTitle(requireContext().getString(R.string.field_frame_allocator_title))
+            setDescription(requireContext().getString(R.string.field_frame_allocator_desc))
+            setOnClickListener(viewModel::toggleFrameAllocator)
+        }
+
+        viewBinding.fieldConditionPrefilter.apply {
+            setTitle(requireContext().getString(R.string.field_condition_prefilter_title))
+            setDescription(requireContext().getString(R.string.field_condition_prefilter_desc))
+            setOnClickListener(viewModel::toggleConditionPrefilter)
+        }
+
         viewBinding.fieldPrivacySettings.apply {
             setTitle(requireContext().getString(R.string.field_privacy))
             setOnClickListener { viewModel.showPrivacySettings(requireActivity()) }
@@ -103,6 +337,156 @@ class SettingsFragment : Fragment() {
                 launch { viewModel.isLegacyNotificationUiEnabled.collect(viewBinding.fieldLegacyNotificationUi::setChecked) }
                 launch { viewModel.isEntireScreenCaptureForced.collect(viewBinding.fieldForceEntireScreen::setChecked) }
                 launch { viewModel.isInputWorkaroundEnabled.collect(viewBinding.fieldInputBlockWorkaround::setChecked) }
+                launch { viewModel.isPyramidMatchingEnabled.collect(viewBinding.fieldPyramidMatching::setChecked) }
+                launch { viewModel.isMultiScaleMatchingEnabled.collect(viewBinding.fieldMultiScaleMatching::setChecked) }
+                launch {
+                    viewModel.isHistogramColorVerificationEnabled
+                        .collect(viewBinding.fieldHistogramColorVerification::setChecked)
+                }
+                launch {
+                    viewModel.isScaledColorVerificationEnabled
+                        .collect(viewBinding.fieldScaledColorVerification::setChecked)
+                }
+                launch {
+                    viewModel.isDownscaledCaptureEnabled
+                        .collect(viewBinding.fieldDownscaledCapture::setChecked)
+                }
+                launch {
+                    viewModel.isIntegerMatchingEnabled
+                        .collect(viewBinding.fieldIntegerMatching::setChecked)
+                }
+                launch {
+                    viewModel.isSparseMatchingEnabled
+                        .collect(viewBinding.fieldSparseMatching::setChecked)
+                }
+                launch {
+                    viewModel.isBinaryMatchingEnabled
+                        .collect(viewBinding.fieldBinaryMatching::setChecked)
+                }
+                launch {
+                    viewModel.isChamferMatchingEnabled
+                        .collect(viewBinding.fieldChamferMatching::setChecked)
+                }
+                launch {
+                    viewModel.isMotionCompensationEnabled
+                        .collect(viewBinding.fieldMotionCompensation::setChecked)
+                }
+                launch {
+                    viewModel.isRotatedReaderEnabled
+                        .collect(viewBinding.fieldRotatedReader::setChecked)
+                }
+                launch {
+                    viewModel.isIdleConditionsCompactionEnabled
+                        .collect(viewBinding.fieldIdleConditionsCompaction::setChecked)
+                }
+                launch {
+                    viewModel.isTriggerOnlyCapturePauseEnabled
+                        .collect(viewBinding.fieldTriggerOnlyCapturePause::setChecked)
+                }
+                launch {
+                    viewModel.isNativeScreenReaderEnabled
+                        .collect(viewBinding.fieldNativeScreenReader::setChecked)
+                }
+                launch {
+                    viewModel.isAnimatedAreasExclusionEnabled
+                        .collect(viewBinding.fieldAnimatedAreasExclusion::setChecked)
+                }
+                launch {
+                    viewModel.isSystemBarsExclusionEnabled
+                        .collect(viewBinding.fieldSystemBarsExclusion::setChecked)
+                }
+                launch {
+                    viewModel.isScreenStatesGatingEnabled
+                        .collect(viewBinding.fieldScreenStatesGating::setChecked)
+                }
+                launch {
+                    viewModel.isGpuMatchingEnabled
+                        .collect(viewBinding.fieldGpuMatching::setChecked)
+                }
+                launch {
+                    viewModel.isNnapiMatchingEnabled
+                        .collect(viewBinding.fieldNnapiMatching::setChecked)
+                }
+                launch {
+                    viewModel.isAdaptiveFramePacingEnabled
+                        .collect(viewBinding.fieldAdaptiveFramePacing::setChecked)
+                }
+                launch {
+                    viewModel.isThermalQualityScalingEnabled
+                        .collect(viewBinding.fieldThermalQualityScaling::setChecked)
+                }
+                launch {
+                    viewModel.isPerformanceThreadsEnabled
+                        .collect(viewBinding.fieldPerformanceThreads::setChecked)
+                }
+                launch {
+                    viewModel.isDetectorMemoryBudgetEnabled
+                        .collect(viewBinding.fieldDetectorMemoryBudget::setChecked)
+                }
+                launch {
+                    viewModel.isDetectionCaptureEnabled
+                        .collect(viewBinding.fieldDetectionCapture::setChecked)
+                }
+                launch {
+                    viewModel.isSpeculativeEventsEnabled
+                        .collect(viewBinding.fieldSpeculativeEvents::setChecked)
+                }
+                launch {
+                    viewModel.isStaleFrameDroppingEnabled
+                        .collect(viewBinding.fieldStaleFrameDropping::setChecked)
+                }
+                launch {
+                    viewModel.isDetectionQualityTuningEnabled
+                        .collect(viewBinding.fieldDetectionQualityTuning::setChecked)
+                }
+                launch {
+                    viewModel.isFirstHitMatchingEnabled
+                        .collect(viewBinding.fieldFirstHitMatching::setChecked)
+                }
+                launch {
+                    viewModel.isLearnedAreaMatchingEnabled
+                        .collect(viewBinding.fieldLearnedAreaMatching::setChecked)
+                }
+                launch {
+                    viewModel.isIntegerScaleRatioEnabled
+                        .collect(viewBinding.fieldIntegerScaleRatio::setChecked)
+                }
+                launch {
+                    viewModel.isConditionTimeBudgetEnabled
+                        .collect(viewBinding.fieldConditionTimeBudget::setChecked)
+                }
+                launch {
+                    viewModel.isPreciseDumbTimingEnabled
+                        .collect(viewBinding.fieldPreciseDumbTiming::setChecked)
+                }
+                launch {
+                    viewModel.isGestureBatchingEnabled
+                        .collect(viewBinding.fieldGestureBatching::setChecked)
+                }
+                launch {
+                    viewModel.isActionsOverlapEnabled
+                        .collect(viewBinding.fieldActionsOverlap::setChecked)
+                }
+                launch {
+                    viewModel.isDetectionGateEnabled
+                        .collect(viewBinding.fieldDetectionGate::setChecked)
+                }
+                launch {
+                    viewModel.isGpuFrameGateEnabled
+                        .collect(viewBinding.fieldGpuFrameGate::setChecked)
+                }
+                launch {
+                    viewModel.isScreenChangeWaitEnabled
+                        .collect(viewBinding.fieldScreenChangeWait::setChecked)
+                }
+                launch {
+                    viewModel.isFrameAllocatorEnabled
+                        .collect(viewBinding.fieldFrameAllocator::setChecked)
+                }
+                launch {
+                    viewModel.isConditionPrefilterEnabled
+                        .collect(viewBinding.fieldConditionPrefilter::setChecked)
+                }
                 launch { viewModel.shouldShowInputBlockWorkaround.collect(::updateInputBlockWorkaroundVisibility) }
                 launch { viewModel.shouldShowEntireScreenCapture.collect(::updateForceEntireScreenVisibility) }
                 launch { viewModel.shouldShowPrivacySettings.collect(::updatePrivacySettingsVisibility) }
@@ -55,6 +55,123 @@ class SettingsViewModel @Inject constructor(
     val isInputWorkaroundEnabled: Flow<Boolean> =
         settingsRepository.isInputBlockWorkaroundEnabledFlow
 
+    val isPyramidMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isPyramidMatchingEnabledFlow
+
+    val isMultiScaleMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isMultiScaleMatchingEnabledFlow
+
+    val isHistogramColorVerificationEnabled: Flow<Boolean> =
+        settingsRepository.isHistogramColorVerificationEnabledFlow
+
+    val isScaledColorVerificationEnabled: Flow<Boolean> =
+        settingsRepository.isScaledColorVerificationEnabledFlow
+
+    val isDownscaledCaptureEnabled: Flow<Boolean> =
+        settingsRepository.isDownscaledCaptureEnabledFlow
+
+    val isIntegerMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isIntegerMatchingEnabledFlow
+
+    val isSparseMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isSparseMatchingEnabledFlow
+
+    val isBinaryMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isBinaryMatchingEnabledFlow
+
+    val isChamferMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isChamferMatchingEnabledFlow
+
+    val isMotionCompensationEnabled: Flow<Boolean> =
+        settingsRepository.isMotionCompensationEnabledFlow
+
+    val isRotatedReaderEnabled: Flow<Boolean> =
+        settingsRepository.isRotatedReaderEnabledFlow
+
+    val isIdleConditionsCompactionEnabled: Flow<Boolean> =
+        settingsRepository.isIdleConditionsCompactionEnabledFlow
+
+    val isTriggerOnlyCapturePauseEnabled: Flow<Boolean> =
+        settingsRepository.isTriggerOnlyCapturePauseEnabledFlow
+
+    val isNativeScreenReaderEnabled: Flow<Boolean> =
+        settingsRepository.isNativeScreenReaderEnabledFlow
+
+    val isAnimatedAreasExclusionEnabled: Flow<Boolean> =
+        settingsRepository.isAnimatedAreasExclusionEnabledFlow
+
+    val isSystemBarsExclusionEnabled: Flow<Boolean> =
+        settingsRepository.isSystemBarsExclusionEnabledFlow
+
+    val isScreenStatesGatingEnabled: Flow<Boolean> =
+        settingsRepository.isScreenStatesGatingEnabledFlow
+
+    val isGpuMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isGpuMatchingEnabledFlow
+
+    val isNnapiMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isNnapiMatchingEnabledFlow
+
+    val isAdaptiveFramePacingEnabled: Flow<Boolean> =
+        settingsRepository.isAdaptiveFramePacingEnabledFlow
+
+    val isThermalQualityScalingEnabled: Flow<Boolean> =
+        settingsRepository.isThermalQualityScalingEnabledFlow
+
+    val isPerformanceThreadsEnabled: Flow<Boolean> =
+        settingsRepository.isPerformanceThreadsEnabledFlow
+
+    val isDetectorMemoryBudgetEnabled: Flow<Boolean> =
+        settingsRepository.isDetectorMemoryBudgetEnabledFlow
+
+    val isDetectionCaptureEnabled: Flow<Boolean> =
+        settingsRepository.isDetectionCaptureEnabledFlow
+
+    val isSpeculativeEventsEnabled: Flow<Boolean> =
+        settingsRepository.isSpeculativeEventsEnabledFlow
+
+    val isStaleFrameDroppingEnabled: Flow<Boolean> =
+        settingsRepository.isStaleFrameDroppingEnabledFlow
+
+    val isDetectionQualityTuningEnabled: Flow<Boolean> =
+        settingsRepository.isDetectionQualityTuningEnabledFlow
+
+    val isFirstHitMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isFirstHitMatchingEnabledFlow
+
+    val isLearnedAreaMatchingEnabled: Flow<Boolean> =
+        settingsRepository.isLearnedAreaMatchingEnabledFlow
+
+    val isIntegerScaleRatioEnabled: Flow<Boolean> =
+        settingsRepository.isIntegerScaleRatioEnabledFlow
+
+    val isConditionTimeBudgetEnabled: Flow<Boolean> =
+        settingsRepository.isConditionTimeBudgetEnabledFlow
+
+    val isPreciseDumbTimingEnabled: Flow<Boolean> =
+        settingsRepository.isPreciseDumbTimingEnabledFlow
+
+    val isGestureBatchingEnabled: Flow<Boolean> =
+        settingsRepository.isGestureBatchingEnabledFlow
+
+    val isActionsOverlapEnabled: Flow<Boolean> =
+        settingsRepository.isActionsOverlapEnabledFlow
+
+    val isDetectionGateEnabled: Flow<Boolean> =
+        settingsRepository.isDetectionGateEnabledFlow
+
+    val isGpuFrameGateEnabled: Flow<Boolean> =
+        settingsRepository.isGpuFrameGateEnabledFlow
+
+    val isScreenChangeWaitEnabled: Flow<Boolean> =
+        settingsRepository.isScreenChangeWaitEnabledFlow
+
+    val isFrameAllocatorEnabled: Flow<Boolean> =
+        settingsRepository.isFrameAllocatorEnabledFlow
+
+    val isConditionPrefilterEnabled: Flow<Boolean> =
+        settingsRepository.isConditionPrefilterEnabledFlow
+
     val shouldShowEntireScreenCapture: Flow<Boolean> =
         flowOf(Build.VERSION.SDK_INT >= Build.VERSION_CODES.VANILLA_ICE_CREAM)
 
@@ -90,6 +207,162 @@ class SettingsViewModel @Inject constructor(
         settingsRepository.toggleInputBlockWorkaround()
     }
 
+    fun togglePyramidMatching() {
+        settingsRepository.togglePyramidMatching()
+    }
+
+    fun toggleMultiScaleMatching() {
+        settingsRepository.toggleMultiScaleMatching()
+    }
+
+    fun toggleHistogramColorVerification() {
+        settingsRepository.toggleHistogramColorVerification()
+    }
+
+    fun toggleScaledColorVerification() {
+        settingsRepository.toggleScaledColorVerification()
+    }
+
+    fun toggleDownscaledCapture() {
+        settingsRepository.toggleDownscaledCapture()
+    }
+
+    fun toggleIntegerMatching() {
+        settingsRepository.toggleIntegerMatching()
+    }
+
+    fun toggleSparseMatching() {
+        settingsRepository.toggleSparseMatching()
+    }
+
+    fun toggleBinaryMatching() {
+        settingsRepository.toggleBinaryMatching()
+    }
+
+    fun toggleChamferMatching() {
+        settingsRepository.toggleChamferMatching()
+    }
+
+    fun toggleMotionCompensation() {
+        settingsRepository.toggleMotionCompensation()
+    }
+
+    fun toggleRotatedReader() {
+        settingsRepository.toggleRotatedReader()
+    }
+
+    fun toggleIdleConditionsCompaction() {
+        settingsRepository.toggleIdleConditionsCompaction()
+    }
+
+    fun toggleTriggerOnlyCapturePause() {
+        settingsRepository.toggleTriggerOnlyCapturePause()
+    }
+
+    fun toggleNativeScreenReader() {
+        settingsRepository.toggleNativeScreenReader()
+    }
+
+    fun toggleAnimatedAreasExclusion() {
+        settingsRepository.toggleAnimatedAreasExclusion()
+    }
+
+    fun toggleSystemBarsExclusion() {
+        settingsRepository.toggleSystemBarsExclusion()
+    }
+
+    fun toggleScreenStatesGating() {
+        settingsRepository.toggleScreenStatesGating()
+    }
+
+    fun toggleGpuMatching() {
+        settingsRepository.toggleGpuMatching()
+    }
+
+    fun toggleNnapiMatching() {
+        settingsRepository.toggleNnapiMatching()
+    }
+
+    fun toggleAdaptiveFramePacing() {
+        settingsRepository.toggleAdaptiveFramePacing()
+    }
+
+    fun toggleThermalQualityScaling() {
+        settingsRepository.toggleThermalQualityScaling()
+    }
+
+    fun togglePerformanceThreads() {
+        settingsRepository.togglePerformanceThreads()
+    }
+
+    fun toggleDetectorMemoryBudget() {
+        settingsRepository.toggleDetectorMemoryBudget()
+    }
+
+    fun toggleDetectionCapture() {
+        settingsRepository.toggleDetectionCapture()
+    }
+
+    fun toggleSpeculativeEvents() {
+        settingsRepository.toggleSpeculativeEvents()
+    }
+
+    fun toggleStaleFrameDropping() {
+        settingsRepository.toggleStaleFrameDropping()
+    }
+
+    fun toggleDetectionQualityTuning() {
+        settingsRepository.toggleDetectionQualityTuning()
+    }
+
+    fun toggleFirstHitMatching() {
+        settingsRepository.toggleFirstHitMatching()
+    }
+
+    fun toggleLearnedAreaMatching() {
+        settingsRepository.toggleLearnedAreaMatching()
+    }
+
+    fun toggleIntegerScaleRatio() {
+        settingsRepository.toggleIntegerScaleRatio()
+    }
+
+    fun toggleConditionTimeBudget() {
+        settingsRepository.toggleConditionTimeBudget()
+    }
+
+    fun togglePreciseDumbTiming() {
+        settingsRepository.togglePreciseDumbTiming()
+    }
+
+    fun toggleGestureBatching() {
+        settingsRepository.toggleGestureBatching()
+    }
+
+    fun toggleActionsOverlap() {
+        settingsRepository.toggleActionsOverlap()
+    }
+
+    fun toggleDetectionGate() {
+        settingsRepository.toggleDetectionGate()
+    }
+
+    fun toggleGpuFrameGate() {
+        settingsRepository.toggleGpuFrameGate()
+    }
+
+    fun toggleScreenChangeWait() {
+        settingsRepository.toggleScreenChangeWait()
+    }
+
+    fun toggleFrameAllocator() {
+        settingsRepository.toggleFrameAllocator()
+    }
+
+    fun toggleConditionPrefilter() {
+        settingsRepository.toggleConditionPrefilter()
+    }
+
     fun showPrivacySettings(activity: Activity) {
         revenueRepository.startPrivacySettingUiFlow(activity)
     }